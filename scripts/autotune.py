@@ -0,0 +1,159 @@
+import argparse
+import configparser
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+# Picks per-game settings by benchmarking each game with the regression test runner. Every candidate combination of
+# renderer, CPU execution mode and resolution scale is measured over the same frames after boot, and the first one in
+# preference order whose frame times hold the game's frame rate is written to the game's settings INI. Candidates are
+# ordered by resolution scale first, so the highest scale which runs at full speed wins.
+
+
+def is_game_path(path):
+    idx = path.rfind('.')
+    if idx < 0:
+        return False
+
+    extension = path[idx + 1:].strip().lower()
+    return extension in ["cue", "chd", "pbp", "m3u", "ecm", "mds", "img"]
+
+
+def get_candidates(renderers, cpu_modes, scales):
+    candidates = []
+    for scale in sorted(set(scales), reverse=True):
+        for renderer in renderers:
+            # The software renderer always draws at native resolution.
+            if renderer.lower() == "software" and scale != 1:
+                continue
+            for cpu_mode in cpu_modes:
+                candidates.append((renderer, cpu_mode, scale))
+    return candidates
+
+
+def run_benchmark(runner, path, candidate, frames, warmup):
+    renderer, cpu_mode, scale = candidate
+    fd, out_path = tempfile.mkstemp(suffix=".json")
+    os.close(fd)
+
+    args = [runner,
+            "-log", "error",
+            "-renderer", renderer,
+            "-cpu", cpu_mode,
+            "-upscale", str(scale),
+            "-frames", str(frames),
+            "-warmup", str(warmup),
+            "-benchmarkout", out_path,
+            "--", path
+    ]
+
+    try:
+        subprocess.run(args, stdout=subprocess.DEVNULL)
+        with open(out_path, "r") as f:
+            return json.load(f)
+    except (OSError, ValueError):
+        return None
+    finally:
+        os.remove(out_path)
+
+
+def holds_target(result, percentile, margin):
+    if result is None or not result["runs"] or result["frame_rate"] <= 0.0:
+        return False, 0.0
+
+    # Frame times are unthrottled, so the percentile has to fit in the frame time the game runs at, with some headroom
+    # for the host being busier than it was while tuning.
+    budget = 1000.0 / result["frame_rate"] * (1.0 - margin / 100.0)
+    frame_time = max(run["frame_time_ms"][percentile] for run in result["runs"])
+    return frame_time <= budget, frame_time
+
+
+def write_game_settings(settings_dir, serial, candidate):
+    renderer, cpu_mode, scale = candidate
+    path = os.path.join(settings_dir, "%s.ini" % serial)
+
+    ini = configparser.ConfigParser(interpolation=None)
+    ini.optionxform = str
+    if os.path.isfile(path):
+        ini.read(path, encoding="utf-8")
+
+    for section, key, value in (("GPU", "Renderer", renderer), ("CPU", "ExecutionMode", cpu_mode),
+                                ("GPU", "ResolutionScale", str(scale))):
+        if not ini.has_section(section):
+            ini.add_section(section)
+        ini.set(section, key, value)
+
+    with open(path, "w", encoding="utf-8") as f:
+        ini.write(f, space_around_delimiters=True)
+    print("  Wrote %s" % path)
+
+
+def autotune_game(runner, path, candidates, frames, warmup, percentile, margin, settings_dir, dry_run):
+    print("Tuning %s" % path)
+    for candidate in candidates:
+        result = run_benchmark(runner, path, candidate, frames, warmup)
+        ok, frame_time = holds_target(result, percentile, margin)
+        print("  %-10s %-18s %2ux: %s" % (candidate[0], candidate[1], candidate[2],
+                                          ("%.2f ms %s" % (frame_time, percentile)) if result else "failed"))
+        if not ok:
+            continue
+
+        serial = result.get("game_serial", "")
+        if not serial:
+            print("  No serial, not writing settings")
+            return False
+
+        print("  Selected %s/%s/%ux at %.1f fps" % (candidate[0], candidate[1], candidate[2], result["frame_rate"]))
+        if not dry_run:
+            write_game_settings(settings_dir, serial, candidate)
+        return True
+
+    print("  No candidate holds the target")
+    return False
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Pick per-game settings which hold full speed")
+    parser.add_argument("-runner", action="store", required=True, help="Path to regression test runner")
+    parser.add_argument("-gamedir", action="store", required=True, help="Directory containing game images")
+    parser.add_argument("-settingsdir", action="store", required=True,
+                        help="Game settings directory to write INIs to (gamesettings in the user directory)")
+    parser.add_argument("-renderers", action="store", default="Vulkan,OpenGL,Software",
+                        help="Comma separated renderers, in order of preference")
+    parser.add_argument("-cpumodes", action="store", default="Recompiler,CachedInterpreter",
+                        help="Comma separated CPU execution modes, in order of preference")
+    parser.add_argument("-scales", action="store", default="1,2,3,4,5,6,8",
+                        help="Comma separated resolution scales to try")
+    parser.add_argument("-frames", action="store", type=int, default=60 * 30, help="Number of frames to measure")
+    parser.add_argument("-warmup", action="store", type=int, default=60 * 30,
+                        help="Number of frames to run after boot before measuring")
+    parser.add_argument("-percentile", action="store", default="p99", choices=["p50", "p90", "p95", "p99", "max"],
+                        help="Frame time percentile which has to hold the target")
+    parser.add_argument("-margin", action="store", type=float, default=10.0,
+                        help="Percentage of the frame time kept as headroom")
+    parser.add_argument("-dryrun", action="store_true", help="Don't write any settings")
+
+    args = parser.parse_args()
+
+    gamepaths = sorted(filter(is_game_path, glob.glob(os.path.realpath(args.gamedir) + "/*.*")))
+    candidates = get_candidates(args.renderers.split(","), args.cpumodes.split(","),
+                                [int(scale) for scale in args.scales.split(",")])
+    if not gamepaths or not candidates:
+        print("Nothing to tune")
+        sys.exit(1)
+
+    if not args.dryrun and not os.path.isdir(args.settingsdir):
+        os.makedirs(args.settingsdir)
+
+    # Games are measured one at a time, anything running alongside would skew the frame times.
+    tuned = 0
+    for path in gamepaths:
+        if autotune_game(os.path.realpath(args.runner), path, candidates, args.frames, args.warmup, args.percentile,
+                         args.margin, args.settingsdir, args.dryrun):
+            tuned += 1
+
+    print("Tuned %u of %u games" % (tuned, len(gamepaths)))
+    sys.exit(0 if tuned == len(gamepaths) else 1)
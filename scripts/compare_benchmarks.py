@@ -0,0 +1,59 @@
+import argparse
+import json
+import sys
+
+
+def load_results(path):
+    with open(path, "r") as f:
+        data = json.load(f)
+
+    return data.get("version", "unknown"), {b["name"]: b for b in data["benchmarks"]}
+
+
+def compare_benchmarks(baseline_path, test_path, threshold):
+    baseline_version, baseline = load_results(baseline_path)
+    test_version, test = load_results(test_path)
+    print("Comparing %s against baseline %s, regression threshold %.1f%%" % (test_version, baseline_version,
+                                                                             threshold))
+
+    regressions = 0
+    for name, result in test.items():
+        if name not in baseline:
+            print("  %-48s %10.2f ns/op  (new)" % (name, result["ns_per_op"]["median"]))
+            continue
+
+        base = baseline[name]
+        base_ns = base["ns_per_op"]["median"]
+        test_ns = result["ns_per_op"]["median"]
+        change = ((test_ns - base_ns) / base_ns * 100.0) if base_ns > 0.0 else 0.0
+
+        notes = []
+        if change > threshold:
+            notes.append("REGRESSION")
+            regressions += 1
+
+        # Inputs are fixed, so a different checksum means the kernel's output changed.
+        if base["ops_per_sample"] == result["ops_per_sample"] and base["checksum"] != result["checksum"]:
+            notes.append("OUTPUT CHANGED")
+            regressions += 1
+
+        print("  %-48s %10.2f -> %10.2f ns/op  %+7.1f%%  %s" % (name, base_ns, test_ns, change, " ".join(notes)))
+
+    for name in baseline:
+        if name not in test:
+            print("  %-48s (missing)" % name)
+
+    return regressions == 0
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Compare core-benchmarks results against a baseline")
+    parser.add_argument("-threshold", action="store", type=float, default=5.0, help="Slowdown in percent which is treated as a regression")
+    parser.add_argument("baseline", action="store", help="Results from the baseline build")
+    parser.add_argument("test", action="store", help="Results from the build to check")
+
+    args = parser.parse_args()
+    if not compare_benchmarks(args.baseline, args.test, args.threshold):
+        sys.exit(1)
+    else:
+        sys.exit(0)
@@ -0,0 +1,187 @@
+import sys
+import struct
+
+# Turns the binary CPU trace written by the debugger (cpu_trace.bin in the dumps directory) back into text. The record
+# layout matches CPU::Trace::Record in src/core/cpu_trace.h, and the disassembly follows src/core/cpu_disasm.cpp.
+
+FILE_MAGIC = 0x54435344
+FILE_VERSION = 1
+HEADER = struct.Struct("<IIII")
+RECORD = struct.Struct("<IIIBBH")
+
+RECORD_INSTRUCTION = 0
+RECORD_REGISTER = 1
+RECORD_BLOCK_CODE = 2
+RECORD_BLOCK_ENTRY = 3
+
+REG_NAMES = ("zero", "at", "v0", "v1", "a0", "a1", "a2", "a3", "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+             "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra",
+             "hi", "lo")
+
+BASE_TABLE = {
+    2: "j $jt", 3: "jal $jt", 4: "beq $rs, $rt, $rel", 5: "bne $rs, $rt, $rel", 6: "blez $rs, $rel",
+    7: "bgtz $rs, $rel", 8: "addi $rt, $rs, $imm", 9: "addiu $rt, $rs, $imm", 10: "slti $rt, $rs, $imm",
+    11: "sltiu $rt, $rs, $immu", 12: "andi $rt, $rs, $immu", 13: "ori $rt, $rs, $immu", 14: "xori $rt, $rs, $immu",
+    15: "lui $rt, $imm", 32: "lb $rt, $offsetrs", 33: "lh $rt, $offsetrs", 34: "lwl $rt, $offsetrs",
+    35: "lw $rt, $offsetrs", 36: "lbu $rt, $offsetrs", 37: "lhu $rt, $offsetrs", 38: "lwr $rt, $offsetrs",
+    40: "sb $rt, $offsetrs", 41: "sh $rt, $offsetrs", 42: "swl $rt, $offsetrs", 43: "sw $rt, $offsetrs",
+    46: "swr $rt, $offsetrs", 48: "lwc0 $coprt, $offsetrs", 49: "lwc1 $coprt, $offsetrs",
+    50: "lwc2 $coprt, $offsetrs", 51: "lwc3 $coprt, $offsetrs", 56: "swc0 $coprt, $offsetrs",
+    57: "swc1 $coprt, $offsetrs", 58: "swc2 $coprt, $offsetrs", 59: "swc3 $coprt, $offsetrs",
+}
+
+SPECIAL_TABLE = {
+    0: "sll $rd, $rt, $shamt", 2: "srl $rd, $rt, $shamt", 3: "sra $rd, $rt, $shamt", 4: "sllv $rd, $rt, $rs",
+    6: "srlv $rd, $rt, $rs", 7: "srav $rd, $rt, $rs", 8: "jr $rs", 9: "jalr $rd, $rs", 12: "syscall", 13: "break",
+    16: "mfhi $rd", 17: "mthi $rs", 18: "mflo $rd", 19: "mtlo $rs", 24: "mult $rs, $rt", 25: "multu $rs, $rt",
+    26: "div $rs, $rt", 27: "divu $rs, $rt", 32: "add $rd, $rs, $rt", 33: "addu $rd, $rs, $rt",
+    34: "sub $rd, $rs, $rt", 35: "subu $rd, $rs, $rt", 36: "and $rd, $rs, $rt", 37: "or $rd, $rs, $rt",
+    38: "xor $rd, $rs, $rt", 39: "nor $rd, $rs, $rt", 42: "slt $rd, $rs, $rt", 43: "sltu $rd, $rs, $rt",
+}
+
+COP_COMMON_TABLE = {0b0000: "mfc$cop $rt, $coprd", 0b0010: "cfc$cop $rt, $coprd", 0b0100: "mtc$cop $rt, $coprd",
+                    0b0110: "ctc$cop $rt, $coprd"}
+
+OPERANDS = ("offsetrs", "shamt", "immu", "copcc", "coprd", "coprt", "imm", "rel", "cop", "rs", "rt", "rd", "jt")
+
+
+def sign_extend16(value):
+    return value - 0x10000 if (value & 0x8000) else value
+
+
+def format_instruction(pc, bits, fmt):
+    rs = (bits >> 21) & 0x1F
+    rt = (bits >> 16) & 0x1F
+    rd = (bits >> 11) & 0x1F
+    imm = bits & 0xFFFF
+    values = {
+        "rs": REG_NAMES[rs],
+        "rt": REG_NAMES[rt],
+        "rd": REG_NAMES[rd],
+        "shamt": "%u" % ((bits >> 6) & 0x1F),
+        "immu": "%u" % imm,
+        "imm": "%04x" % imm,
+        "rel": "%08x" % ((pc + 4 + (sign_extend16(imm) << 2)) & 0xFFFFFFFF),
+        "offsetrs": "%d(%s)" % (sign_extend16(imm), REG_NAMES[rs]),
+        "jt": "%08x" % (((pc + 4) & 0xF0000000) | ((bits & 0x3FFFFFF) << 2)),
+        "copcc": "t" if (bits & (1 << 24)) else "f",
+        "coprd": "%u" % rd,
+        "coprt": "%u" % rt,
+        "cop": "%u" % ((bits >> 26) & 3),
+    }
+
+    out = []
+    pos = 0
+    while pos < len(fmt):
+        ch = fmt[pos]
+        pos += 1
+        if ch != "$":
+            out.append(ch)
+            continue
+
+        for operand in OPERANDS:
+            if fmt.startswith(operand, pos):
+                out.append(values[operand])
+                pos += len(operand)
+                break
+        else:
+            raise ValueError("Unknown operand in '%s'" % fmt)
+
+    return "".join(out)
+
+
+def disassemble(pc, bits):
+    op = bits >> 26
+    if op == 0:
+        return format_instruction(pc, bits, SPECIAL_TABLE.get(bits & 0x3F, "UNKNOWN"))
+    elif op == 1:
+        rt = (bits >> 16) & 0x1F
+        name = ("bgez" if (rt & 1) else "bltz") + ("al" if (rt & 0x10) else "")
+        return format_instruction(pc, bits, name + " $rs, $rel")
+    elif 16 <= op <= 19:
+        if (bits & (1 << 25)) == 0 and ((bits >> 21) & 0xF) in COP_COMMON_TABLE:
+            return format_instruction(pc, bits, COP_COMMON_TABLE[(bits >> 21) & 0xF])
+        elif op == 16 and (bits & (1 << 25)) != 0 and (bits & 0x3F) == 0x10:
+            return "rfe"
+        else:
+            return "<cop%u 0x%08X>" % (op & 3, bits & 0x1FFFFFF)
+    else:
+        return format_instruction(pc, bits, BASE_TABLE.get(op, "UNKNOWN"))
+
+
+def format_line(pc, bits):
+    return "%08x: %08x %s" % (pc, bits, disassemble(pc, bits))
+
+
+def format_registers(changes):
+    return ", ".join("%s=0x%08X" % (REG_NAMES[reg], value) for reg, value in changes)
+
+
+def disassemble_trace(in_name, out):
+    with open(in_name, "rb") as f:
+        header = f.read(HEADER.size)
+        if len(header) != HEADER.size:
+            raise ValueError("File is too short")
+
+        magic, version, record_size, _ = HEADER.unpack(header)
+        if magic != FILE_MAGIC or version != FILE_VERSION or record_size != RECORD.size:
+            raise ValueError("Not a CPU trace, or an unsupported version")
+
+        # Blocks are keyed by start address, a recompile replaces the code for the following entries.
+        blocks = {}
+        pending_line = None
+        changes = []
+
+        # Register changes are recorded before the next instruction, so they belong to the line printed last.
+        def flush():
+            nonlocal pending_line
+            if pending_line is not None:
+                if changes:
+                    pending_line = pending_line.ljust(50) + " ; " + format_registers(changes)
+                out.write(pending_line + "\n")
+                pending_line = None
+            elif changes:
+                out.write("registers: " + format_registers(changes) + "\n")
+            changes.clear()
+
+        while True:
+            data = f.read(RECORD.size * 4096)
+            if not data:
+                break
+
+            for pc, bits, value, rtype, reg, _ in RECORD.iter_unpack(data[:len(data) - (len(data) % RECORD.size)]):
+                if rtype == RECORD_REGISTER:
+                    changes.append((reg, value))
+                elif rtype == RECORD_INSTRUCTION:
+                    flush()
+                    pending_line = format_line(pc, bits)
+                elif rtype == RECORD_BLOCK_CODE:
+                    code = blocks.setdefault(value, [])
+                    if pc == value:
+                        code.clear()
+                    code.append((pc, bits))
+                elif rtype == RECORD_BLOCK_ENTRY:
+                    flush()
+                    code = blocks.get(pc)
+                    if not code:
+                        out.write("block %08x: <code not in trace>\n" % pc)
+                        continue
+
+                    out.write("block %08x:\n" % pc)
+                    for ipc, ibits in code[:-1]:
+                        out.write("  " + format_line(ipc, ibits) + "\n")
+                    pending_line = "  " + format_line(*code[-1])
+
+        flush()
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("Usage: %s <cpu_trace.bin> [output.txt]" % sys.argv[0])
+        sys.exit(1)
+
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w") as out:
+            disassemble_trace(sys.argv[1], out)
+    else:
+        disassemble_trace(sys.argv[1], sys.stdout)
@@ -0,0 +1,62 @@
+import sys
+import hashlib
+import zipfile
+
+# Builds a delta update package from two release zips, for the updater to apply on top of an installation of the old
+# release. Only files which were added or changed are included. update_delta.txt lists the hash of every file the
+# delta relies on, so the updater can refuse an installation which doesn't match, and the files which were removed.
+# On macOS the zips contain the app bundle, pass its directory (e.g. DuckStation.app/) as the prefix.
+MANIFEST_NAME = "update_delta.txt"
+
+# The application extracts the updater from the package before running it, so it's always included, and the installed
+# copy has already been replaced by the time the updater checks hashes.
+ALWAYS_INCLUDED_FILES = ("updater.exe",)
+
+
+def read_zip(path, prefix):
+    files = {}
+    with zipfile.ZipFile(path, "r") as zf:
+        for info in zf.infolist():
+            if info.is_dir() or not info.filename.startswith(prefix):
+                continue
+
+            name = info.filename[len(prefix):]
+            data = zf.read(info)
+            files[name] = (info, data, hashlib.sha1(data).hexdigest().upper())
+
+    return files
+
+
+def make_delta_update(old_name, new_name, out_name, prefix):
+    old_files = read_zip(old_name, prefix)
+    new_files = read_zip(new_name, prefix)
+
+    changed = []
+    for name, (info, data, digest) in sorted(new_files.items()):
+        old = old_files.get(name)
+        if old is None or old[2] != digest or name.lower() in ALWAYS_INCLUDED_FILES:
+            changed.append((info, data))
+
+    # Every old file which is still in the release is checked, so a delta is never applied on top of another version.
+    manifest = []
+    for name, (info, data, digest) in sorted(old_files.items()):
+        if name not in new_files:
+            manifest.append("remove %s" % name)
+        elif name.lower() not in ALWAYS_INCLUDED_FILES:
+            manifest.append("base %s %s" % (digest, name))
+
+    with zipfile.ZipFile(out_name, "w") as zf:
+        for info, data in changed:
+            zf.writestr(info, data, compress_type=zipfile.ZIP_DEFLATED, compresslevel=9)
+        zf.writestr(MANIFEST_NAME, "\n".join(manifest) + "\n", compress_type=zipfile.ZIP_DEFLATED)
+
+    print("%u changed files, %u unchanged, %u removed" %
+          (len(changed), len(new_files) - len(changed), len(old_files.keys() - new_files.keys())))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 4:
+        print("Usage: %s <old release zip> <new release zip> <output zip> [path prefix]" % sys.argv[0])
+        sys.exit(1)
+
+    make_delta_update(sys.argv[1], sys.argv[2], sys.argv[3], sys.argv[4] if len(sys.argv) > 4 else "")
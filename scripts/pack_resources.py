@@ -0,0 +1,39 @@
+import sys
+import os
+import zipfile
+
+# Packs the resources directory into resources.zip, which is read in place by ResourcePack.
+# Files which are already compressed are stored, so reading them doesn't cost an inflate.
+STORED_EXTENSIONS = (".png", ".jpg", ".jpeg", ".webp", ".ogg", ".mp3")
+PACK_NAME = "resources.zip"
+
+def pack_resources(in_dir, out_name):
+    files = []
+    for root, dirs, filenames in os.walk(in_dir):
+        dirs.sort()
+        for filename in sorted(filenames):
+            path = os.path.join(root, filename)
+            name = os.path.relpath(path, in_dir).replace(os.sep, "/")
+            if name == PACK_NAME:
+                continue
+            files.append((path, name))
+
+    print("Packing %u files from %s..." % (len(files), in_dir))
+    # The reader doesn't handle zip64, so fail rather than writing a pack it can't use.
+    with zipfile.ZipFile(out_name, "w", allowZip64=False) as zf:
+        for path, name in files:
+            if name.lower().endswith(STORED_EXTENSIONS):
+                zf.write(path, name, compress_type=zipfile.ZIP_STORED)
+            else:
+                zf.write(path, name, compress_type=zipfile.ZIP_DEFLATED, compresslevel=9)
+
+    print("Wrote %s (%u bytes)" % (out_name, os.path.getsize(out_name)))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 2:
+        print("Usage: %s <resources directory> [output zip]" % sys.argv[0])
+        sys.exit(1)
+
+    out_name = sys.argv[2] if len(sys.argv) > 2 else os.path.join(sys.argv[1], PACK_NAME)
+    pack_resources(sys.argv[1], out_name)
@@ -0,0 +1,81 @@
+import argparse
+import glob
+import os
+import subprocess
+import multiprocessing
+from functools import partial
+
+# Renders PSF rips to WAV files with the regression test runner, faster than real time. The emulator can only run one
+# system per process, so the files are split into one manifest per worker and the workers run in parallel. Songs run
+# for the length in their tags and the fade is applied to the end of the dump.
+
+
+def is_psf_path(path):
+    return os.path.splitext(path)[1].lower() in (".psf", ".minipsf")
+
+
+def render_chunk(runner, destdir, frames, fade, chunk):
+    index, paths = chunk
+    manifest_path = os.path.join(destdir, "psf_manifest_%u.txt" % index)
+    with open(manifest_path, "w") as f:
+        f.write("\n".join(paths) + "\n")
+
+    args = [runner,
+            "-log", "error",
+            "-nulldevice",
+            "-frames", str(frames),
+            "-fade", str(fade),
+            "-audiodump", destdir,
+            "-manifest", manifest_path
+    ]
+
+    print("Running '%s'" % (" ".join(args)))
+    subprocess.run(args)
+    os.remove(manifest_path)
+    return [path for path in paths if not os.path.isfile(os.path.join(destdir, os.path.splitext(
+        os.path.basename(path))[0] + ".wav"))]
+
+
+def render_psfs(runner, psfdir, destdir, frames, fade, parallel):
+    paths = sorted(filter(is_psf_path, glob.glob(psfdir + "/**/*.*", recursive=True)))
+    if not os.path.isdir(destdir):
+        os.makedirs(destdir)
+
+    print("Found %u PSF files" % len(paths))
+    if not paths:
+        return True
+
+    parallel = max(min(parallel, len(paths)), 1)
+    chunks = [(i, paths[i::parallel]) for i in range(parallel)]
+    func = partial(render_chunk, runner, destdir, frames, fade)
+    if parallel <= 1:
+        failed = [func(chunk) for chunk in chunks]
+    else:
+        print("Rendering %u files on %u processors" % (len(paths), parallel))
+        with multiprocessing.Pool(parallel) as pool:
+            failed = pool.map(func, chunks, chunksize=1)
+
+    failed = [path for chunk in failed for path in chunk]
+    for path in failed:
+        print("Failed to render '%s'" % path)
+
+    return not failed
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Render PSF files to WAV with the regression test runner")
+    parser.add_argument("-runner", action="store", required=True, help="Path to regression test runner")
+    parser.add_argument("-psfdir", action="store", required=True, help="Directory containing PSF files")
+    parser.add_argument("-destdir", action="store", required=True, help="Directory to write WAV files to")
+    parser.add_argument("-frames", action="store", type=int, default=60 * 60 * 3,
+                        help="Number of frames to run files without a length tag for")
+    parser.add_argument("-fade", action="store", type=float, default=10.0,
+                        help="Fade out length for files without a fade tag")
+    parser.add_argument("-parallel", action="store", type=int, default=multiprocessing.cpu_count(),
+                        help="Number of processes to run")
+
+    args = parser.parse_args()
+
+    if not render_psfs(os.path.realpath(args.runner), os.path.realpath(args.psfdir), os.path.realpath(args.destdir),
+                       args.frames, args.fade, args.parallel):
+        exit(1)
@@ -1,5 +1,6 @@
 import argparse
 import glob
+import json
 import sys
 import os
 import subprocess
@@ -15,21 +16,43 @@ def is_game_path(path):
     return extension in ["cue", "chd"]
 
 
-def run_regression_test(runner, destdir, dump_interval, frames, renderer, gamepath):
+def run_regression_test(runner, destdir, dump_interval, frames, renderer, checkpoint_interval, hash_args, chunk):
+    # Each worker runs a whole chunk of games in one process, so startup costs are only paid once per worker.
+    index, gamepaths = chunk
+    manifest_path = os.path.join(destdir, "manifest_%u.txt" % index)
+    results_path = os.path.join(destdir, "results_%u.json" % index)
+    with open(manifest_path, "w") as f:
+        f.write("\n".join(gamepaths) + "\n")
+
     args = [runner,
             "-log", "error",
             "-dumpdir", destdir,
             "-dumpinterval", str(dump_interval),
             "-frames", str(frames),
             "-renderer", ("Software" if renderer is None else renderer),
-            "--", gamepath
+            "-manifest", manifest_path,
+            "-results", results_path
     ]
+    if checkpoint_interval > 0:
+        args += ["-checkpointinterval", str(checkpoint_interval)]
+    args += hash_args
 
     print("Running '%s'" % (" ".join(args)))
     subprocess.run(args)
+    os.remove(manifest_path)
+
+    try:
+        with open(results_path, "r") as f:
+            results = json.load(f)["games"]
+        os.remove(results_path)
+        return results
+    except (OSError, ValueError, KeyError):
+        print("Worker %u did not produce results" % index)
+        return [{"path": path, "booted": False} for path in gamepaths]
 
 
-def run_regression_tests(runner, gamedir, destdir, dump_interval, frames, parallel, renderer):
+def run_regression_tests(runner, gamedir, destdir, dump_interval, frames, parallel, renderer, checkpoint_interval,
+                         hash_args):
     paths = glob.glob(gamedir + "/*.*", recursive=True)
     gamepaths = list(filter(is_game_path, paths))
 
@@ -39,17 +62,31 @@ def run_regression_tests(runner, gamedir, destdir, dump_interval, frames, parall
 
     print("Found %u games" % len(gamepaths))
 
+    parallel = max(min(parallel, len(gamepaths)), 1)
+    chunks = [(i, gamepaths[i::parallel]) for i in range(parallel)]
+    func = partial(run_regression_test, runner, destdir, dump_interval, frames, renderer, checkpoint_interval,
+                   hash_args)
     if parallel <= 1:
-        for game in gamepaths:
-            run_regression_test(runner, destdir, dump_interval, frames, game)
+        results = [func(chunk) for chunk in chunks]
     else:
         print("Processing %u games on %u processors" % (len(gamepaths), parallel))
-        func = partial(run_regression_test, runner, destdir, dump_interval, frames, renderer)
         pool = multiprocessing.Pool(parallel)
-        pool.map(func, gamepaths, chunksize=1)
+        results = pool.map(func, chunks, chunksize=1)
         pool.close()
 
+    games = sorted([game for chunk in results for game in chunk], key=lambda game: game["path"])
+    with open(os.path.join(destdir, "results.json"), "w") as f:
+        json.dump({"frames": frames, "games": games}, f, indent=2)
+
+    failed = [game["path"] for game in games if not game.get("booted", False)]
+    for path in failed:
+        print("Failed to boot '%s'" % path)
 
+    print("%u/%u games booted" % (len(games) - len(failed), len(games)))
+
+    mismatched = [game for game in games if game.get("frame_hash_mismatches", 0) > 0]
+    for game in mismatched:
+        print("%u frames differ from the baseline in '%s'" % (game["frame_hash_mismatches"], game["path"]))
     return True
 
 
@@ -62,10 +99,19 @@ if __name__ == "__main__":
     parser.add_argument("-frames", action="store", type=int, default=36000, help="Number of frames to run")
     parser.add_argument("-parallel", action="store", type=int, default=1, help="Number of processes to run")
     parser.add_argument("-renderer", action="store", type=str, help="Renderer to use")
+    parser.add_argument("-checkpointinterval", action="store", type=int, default=0, help="Interval to hash VRAM at")
+    parser.add_argument("-dumphashes", action="store_true", help="Write hashes of dumped frames instead of images")
+    parser.add_argument("-baseline", action="store", type=str, help="Only write images for frames which differ from the hashes in this directory")
 
     args = parser.parse_args()
 
-    if not run_regression_tests(args.runner, os.path.realpath(args.gamedir), os.path.realpath(args.destdir), args.dumpinterval, args.frames, args.parallel, args.renderer):
+    hash_args = []
+    if args.baseline is not None:
+        hash_args = ["-baseline", os.path.realpath(args.baseline)]
+    elif args.dumphashes:
+        hash_args = ["-dumphashes"]
+
+    if not run_regression_tests(args.runner, os.path.realpath(args.gamedir), os.path.realpath(args.destdir), args.dumpinterval, args.frames, args.parallel, args.renderer, args.checkpointinterval, hash_args):
         sys.exit(1)
     else:
         sys.exit(0)
@@ -0,0 +1,138 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/mdec_kernels.h"
+#include "gtest/gtest.h"
+#include <random>
+
+using namespace MDEC::Kernels;
+
+static constexpr u32 NUM_ITERATIONS = 20000;
+
+// The BIOS default table, plus fully random ones to stress the extremes.
+static void FillScaleTable(std::mt19937& rng, u32 iteration, s16* scale_table)
+{
+  for (u32 i = 0; i < 64; i++)
+  {
+    if (iteration & 1)
+      scale_table[i] = static_cast<s16>(rng());
+    else
+      scale_table[i] = static_cast<s16>(static_cast<s32>(rng() % 0x5A83) - 0x2D41);
+  }
+}
+
+static void FillCoefficients(std::mt19937& rng, u32 iteration, s16* blk)
+{
+  // Mostly sparse like real data, sometimes saturated at the range limits.
+  for (u32 i = 0; i < 64; i++)
+  {
+    if ((iteration % 3) == 0)
+      blk[i] = (rng() & 1) ? 0x3FF : -0x400;
+    else if ((rng() % 4) == 0 || i == 0)
+      blk[i] = static_cast<s16>(static_cast<s32>(rng() % 0x800) - 0x400);
+    else
+      blk[i] = 0;
+  }
+}
+
+TEST(MDECKernels, IDCTMatchesScalar)
+{
+  std::mt19937 rng(0x4D444543);
+  IDCTTable table;
+  std::array<s16, 64> scale_table;
+  std::array<s16, 64> scalar_blk, vector_blk;
+  for (u32 iteration = 0; iteration < NUM_ITERATIONS; iteration++)
+  {
+    FillScaleTable(rng, iteration, scale_table.data());
+    BuildIDCTTable(&table, scale_table.data());
+    FillCoefficients(rng, iteration, scalar_blk.data());
+    vector_blk = scalar_blk;
+
+    IDCTScalar(scalar_blk.data(), table);
+    IDCT(vector_blk.data(), table);
+    ASSERT_EQ(scalar_blk, vector_blk) << "iteration " << iteration;
+  }
+}
+
+TEST(MDECKernels, YUVToRGBMatchesScalar)
+{
+  std::mt19937 rng(0x59555600);
+  std::array<s16, 64> cr, cb, y;
+  std::array<u32, 256> scalar_rgb, vector_rgb;
+  for (u32 iteration = 0; iteration < NUM_ITERATIONS; iteration++)
+  {
+    for (u32 i = 0; i < 64; i++)
+    {
+      cr[i] = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+      cb[i] = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+      y[i] = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+    }
+
+    const s16 addval = (iteration & 1) ? 0 : 0x80;
+    scalar_rgb.fill(0);
+    vector_rgb.fill(0);
+    for (u32 block = 0; block < 4; block++)
+    {
+      const u32 xx = (block & 1) * 8;
+      const u32 yy = (block >> 1) * 8;
+      YUVToRGBScalar(scalar_rgb.data(), xx, yy, cr.data(), cb.data(), y.data(), addval);
+      YUVToRGB(vector_rgb.data(), xx, yy, cr.data(), cb.data(), y.data(), addval);
+    }
+
+    ASSERT_EQ(scalar_rgb, vector_rgb) << "iteration " << iteration;
+  }
+}
+
+TEST(MDECKernels, YUVToRGBAllChroma)
+{
+  // Every chroma pair, against luma at the extremes and the middle.
+  std::array<s16, 64> cr, cb, y;
+  std::array<u32, 256> scalar_rgb, vector_rgb;
+  for (s32 r = -128; r < 128; r++)
+  {
+    for (s32 b = -128; b < 128; b += 4)
+    {
+      for (u32 i = 0; i < 64; i++)
+      {
+        cr[i] = static_cast<s16>(r);
+        cb[i] = static_cast<s16>(b + static_cast<s32>(i & 3));
+        y[i] = static_cast<s16>((i % 3) == 0 ? -128 : ((i % 3) == 1 ? 127 : 0));
+      }
+
+      YUVToRGBScalar(scalar_rgb.data(), 0, 0, cr.data(), cb.data(), y.data(), 0);
+      YUVToRGB(vector_rgb.data(), 0, 0, cr.data(), cb.data(), y.data(), 0);
+      for (u32 row = 0; row < 8; row++)
+      {
+        for (u32 col = 0; col < 8; col++)
+          ASSERT_EQ(scalar_rgb[row * 16 + col], vector_rgb[row * 16 + col]) << "cr " << r << " cb " << b;
+      }
+    }
+  }
+}
+
+TEST(MDECKernels, PackRGB15MatchesScalar)
+{
+  // Colours come from YUVToRGB, so include the overlapping channels of signed output.
+  std::mt19937 rng(0x52474235);
+  std::array<s16, 64> cr, cb, y;
+  std::array<u32, 256> rgb;
+  std::array<u32, 128> scalar_words, vector_words;
+  for (u32 iteration = 0; iteration < NUM_ITERATIONS; iteration++)
+  {
+    for (u32 i = 0; i < 64; i++)
+    {
+      cr[i] = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+      cb[i] = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+      y[i] = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+    }
+
+    const s16 addval = (iteration & 1) ? 0 : 0x80;
+    for (u32 block = 0; block < 4; block++)
+      YUVToRGBScalar(rgb.data(), (block & 1) * 8, (block >> 1) * 8, cr.data(), cb.data(), y.data(), addval);
+
+    const u32 alpha = (iteration & 2) ? 0x8000 : 0;
+    PackRGB15Scalar(scalar_words.data(), rgb.data(), alpha);
+    PackRGB15(vector_words.data(), rgb.data(), alpha);
+    ASSERT_EQ(scalar_words, vector_words) << "iteration " << iteration;
+  }
+}
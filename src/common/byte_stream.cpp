@@ -742,7 +742,7 @@ void GrowableMemoryByteStream::ResizeMemory(u32 new_size)
 
 void GrowableMemoryByteStream::EnsureSpace(u32 space)
 {
-  if ((m_iSize + space) >= m_iMemorySize)
+  if ((m_iSize + space) <= m_iMemorySize)
     return;
 
   Grow((m_iSize + space) - m_iMemorySize);
@@ -6,7 +6,9 @@
 #include "types.h"
 #include <algorithm>
 #include <cstring>
+#include <span>
 #include <type_traits>
+#include <utility>
 
 #ifdef _MSC_VER
 #include <malloc.h> // _aligned_malloc
@@ -70,25 +72,28 @@ public:
     return ref;
   }
 
+  /// Adds count elements to the tail, and returns their storage for the caller to fill in. The second range is only
+  /// non-empty when the elements wrap around the end of the storage.
+  template<class Y = T, std::enable_if_t<std::is_standard_layout_v<Y> && std::is_trivial_v<Y>, int> = 0>
+  std::pair<std::span<T>, std::span<T>> PushSpans(u32 count)
+  {
+    DebugAssert((m_size + count) <= CAPACITY);
+    const u32 count_before_end = std::min(count, CAPACITY - m_tail);
+    const std::pair<std::span<T>, std::span<T>> ret(std::span<T>(&m_ptr[m_tail], count_before_end),
+                                                    std::span<T>(m_ptr, count - count_before_end));
+    m_tail = (m_tail + count) % CAPACITY;
+    m_size += count;
+    return ret;
+  }
+
   // faster version of push_back_range for POD types which can be memcpy()ed
   template<class Y = T, std::enable_if_t<std::is_standard_layout_v<Y>&& std::is_trivial_v<Y>, int> = 0>
   void PushRange(const T* data, u32 size)
   {
-    DebugAssert((m_size + size) <= CAPACITY);
-    const u32 space_before_end = CAPACITY - m_tail;
-    const u32 size_before_end = (size > space_before_end) ? space_before_end : size;
-    const u32 size_after_end = size - size_before_end;
-
-    std::memcpy(&m_ptr[m_tail], data, sizeof(T) * size_before_end);
-    m_tail = (m_tail + size_before_end) % CAPACITY;
-
-    if (size_after_end > 0)
-    {
-      std::memcpy(&m_ptr[m_tail], data + size_before_end, sizeof(T) * size_after_end);
-      m_tail = (m_tail + size_after_end) % CAPACITY;
-    }
-
-    m_size += size;
+    const auto [first, second] = PushSpans(size);
+    std::memcpy(first.data(), data, first.size_bytes());
+    if (!second.empty())
+      std::memcpy(second.data(), data + first.size(), second.size_bytes());
   }
 
   template<class Y = T, std::enable_if_t<!std::is_standard_layout_v<Y> || !std::is_trivial_v<Y>, int> = 0>
@@ -107,14 +112,41 @@ public:
   const T& Peek() const { return m_ptr[m_head]; }
   const T& Peek(u32 offset) { return m_ptr[(m_head + offset) % CAPACITY]; }
 
+  /// Returns the first count elements without removing them, as up to two contiguous ranges like PushSpans().
+  std::pair<std::span<const T>, std::span<const T>> PeekSpans(u32 count) const
+  {
+    DebugAssert(m_size >= count);
+    const u32 count_before_end = std::min(count, CAPACITY - m_head);
+    return std::pair<std::span<const T>, std::span<const T>>(std::span<const T>(&m_ptr[m_head], count_before_end),
+                                                             std::span<const T>(m_ptr, count - count_before_end));
+  }
+
+  /// Removes the first count elements, and returns the ranges they were in. These stay valid until the next push.
+  template<class Y = T, std::enable_if_t<std::is_standard_layout_v<Y> && std::is_trivial_v<Y>, int> = 0>
+  std::pair<std::span<const T>, std::span<const T>> PopSpans(u32 count)
+  {
+    const auto ret = PeekSpans(count);
+    m_head = (m_head + count) % CAPACITY;
+    m_size -= count;
+    return ret;
+  }
+
   void Remove(u32 count)
   {
     DebugAssert(m_size >= count);
-    for (u32 i = 0; i < count; i++)
+    if constexpr (std::is_trivially_destructible_v<T>)
     {
-      m_ptr[m_head].~T();
-      m_head = (m_head + 1) % CAPACITY;
-      m_size--;
+      m_head = (m_head + count) % CAPACITY;
+      m_size -= count;
+    }
+    else
+    {
+      for (u32 i = 0; i < count; i++)
+      {
+        m_ptr[m_head].~T();
+        m_head = (m_head + 1) % CAPACITY;
+        m_size--;
+      }
     }
   }
 
@@ -137,6 +169,16 @@ public:
     return val;
   }
 
+  template<class Y = T, std::enable_if_t<std::is_standard_layout_v<Y> && std::is_trivial_v<Y>, int> = 0>
+  void PopRange(T* out_data, u32 count)
+  {
+    const auto [first, second] = PopSpans(count);
+    std::memcpy(out_data, first.data(), first.size_bytes());
+    if (!second.empty())
+      std::memcpy(out_data + first.size(), second.data(), second.size_bytes());
+  }
+
+  template<class Y = T, std::enable_if_t<!std::is_standard_layout_v<Y> || !std::is_trivial_v<Y>, int> = 0>
   void PopRange(T* out_data, u32 count)
   {
     DebugAssert(m_size >= count);
@@ -25,6 +25,7 @@
 
 #if defined(_WIN32)
 #include "windows_headers.h"
+#include <io.h>
 #include <share.h>
 #include <shlobj.h>
 #include <winioctl.h>
@@ -734,6 +735,47 @@ s64 FileSystem::FSize64(std::FILE* fp)
   return -1;
 }
 
+bool FileSystem::FTruncate64(std::FILE* fp, s64 size)
+{
+  if (std::fflush(fp) != 0)
+    return false;
+
+#ifdef _WIN32
+  const int fd = _fileno(fp);
+  return (fd >= 0 && _chsize_s(fd, size) == 0);
+#else
+  // Prevent truncation on platforms which don't have a 64-bit off_t.
+  if constexpr (sizeof(off_t) != sizeof(s64))
+  {
+    if (size > std::numeric_limits<off_t>::max())
+      return false;
+  }
+
+  return (ftruncate(fileno(fp), static_cast<off_t>(size)) == 0);
+#endif
+}
+
+void FileSystem::FReadahead64(std::FILE* fp, s64 offset, s64 size)
+{
+  if (offset < 0 || size <= 0)
+    return;
+
+#if defined(__linux__) || defined(__FreeBSD__)
+  if constexpr (sizeof(off_t) != sizeof(s64))
+  {
+    if (offset > std::numeric_limits<off_t>::max() || size > std::numeric_limits<off_t>::max())
+      return;
+  }
+
+  posix_fadvise(fileno(fp), static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+#elif defined(__APPLE__)
+  struct radvisory ra;
+  ra.ra_offset = static_cast<off_t>(offset);
+  ra.ra_count = static_cast<int>(std::min<s64>(size, std::numeric_limits<int>::max()));
+  fcntl(fileno(fp), F_RDADVISE, &ra);
+#endif
+}
+
 s64 FileSystem::GetPathFileSize(const char* Path)
 {
   FILESYSTEM_STAT_DATA sd;
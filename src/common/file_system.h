@@ -109,6 +109,13 @@ int FSeek64(std::FILE* fp, s64 offset, int whence);
 s64 FTell64(std::FILE* fp);
 s64 FSize64(std::FILE* fp);
 
+/// Sets the size of the file, after flushing any buffered writes. The file pointer isn't moved.
+bool FTruncate64(std::FILE* fp, s64 size);
+
+/// Hints that a range of the file is about to be read, so the kernel can queue the reads now rather than when the
+/// caller blocks on them. Doesn't move the file pointer, and does nothing where the platform can't do it.
+void FReadahead64(std::FILE* fp, s64 offset, s64 size);
+
 int OpenFDFile(const char* filename, int flags, int mode, Error* error = nullptr);
 
 /// Sharing modes for OpenSharedCFile().
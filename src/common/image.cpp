@@ -11,6 +11,13 @@
 #include "stb_image_resize.h"
 #include "stb_image_write.h"
 #include "string_util.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 Log_SetChannel(Image);
 
 using namespace Common;
@@ -29,10 +36,10 @@ static bool JPEGFileSaver(const RGBA8Image& image, const char* filename, std::FI
 
 static bool STBBufferLoader(RGBA8Image* image, const void* buffer, size_t buffer_size);
 static bool STBFileLoader(RGBA8Image* image, const char* filename, std::FILE* fp);
-static bool STBBufferSaverPNG(const RGBA8Image& image, std::vector<u8>* buffer, int quality);
 static bool STBBufferSaverJPEG(const RGBA8Image& image, std::vector<u8>* buffer, int quality);
-static bool STBFileSaverPNG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality);
 static bool STBFileSaverJPEG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality);
+static bool ZlibBufferSaverPNG(const RGBA8Image& image, std::vector<u8>* buffer, int quality);
+static bool ZlibFileSaverPNG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality);
 
 struct FormatHandler
 {
@@ -49,7 +56,7 @@ static constexpr FormatHandler s_format_handlers[] = {
   {"jpg", JPEGBufferLoader, JPEGBufferSaver, JPEGFileLoader, JPEGFileSaver},
   {"jpeg", JPEGBufferLoader, JPEGBufferSaver, JPEGFileLoader, JPEGFileSaver},
 #else
-  {"png", STBBufferLoader, STBBufferSaverPNG, STBFileLoader, STBFileSaverPNG},
+  {"png", STBBufferLoader, ZlibBufferSaverPNG, STBFileLoader, ZlibFileSaverPNG},
   {"jpg", STBBufferLoader, STBBufferSaverJPEG, STBFileLoader, STBFileSaverJPEG},
   {"jpeg", STBBufferLoader, STBBufferSaverJPEG, STBFileLoader, STBFileSaverJPEG},
 #endif
@@ -597,19 +604,6 @@ bool STBFileLoader(RGBA8Image* image, const char* filename, std::FILE* fp)
   return true;
 }
 
-bool STBBufferSaverPNG(const RGBA8Image& image, std::vector<u8>* buffer, int quality)
-{
-  const auto write_func = [](void* context, void* data, int size) {
-    std::vector<u8>* buffer = reinterpret_cast<std::vector<u8>*>(data);
-    const u32 len = static_cast<u32>(size);
-    buffer->resize(buffer->size() + len);
-    std::memcpy(buffer->data(), data, len);
-  };
-
-  return (stbi_write_png_to_func(write_func, buffer, image.GetWidth(), image.GetHeight(), 4, image.GetPixels(),
-                                 image.GetPitch()) != 0);
-}
-
 bool STBBufferSaverJPEG(const RGBA8Image& image, std::vector<u8>* buffer, int quality)
 {
   const auto write_func = [](void* context, void* data, int size) {
@@ -623,22 +617,142 @@ bool STBBufferSaverJPEG(const RGBA8Image& image, std::vector<u8>* buffer, int qu
                                  quality) != 0);
 }
 
-bool STBFileSaverPNG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality)
+bool STBFileSaverJPEG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality)
 {
   const auto write_func = [](void* context, void* data, int size) {
     std::fwrite(data, 1, size, static_cast<std::FILE*>(context));
   };
 
-  return (stbi_write_png_to_func(write_func, fp, image.GetWidth(), image.GetHeight(), 4, image.GetPixels(),
-                                 image.GetPitch()) != 0);
+  return (stbi_write_jpg_to_func(write_func, fp, image.GetWidth(), image.GetHeight(), 4, image.GetPixels(), quality) !=
+          0);
 }
 
-bool STBFileSaverJPEG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality)
+// stb's PNG compression level is a process-wide global, so concurrent saves couldn't each pick their own. Deflating
+// with zlib directly lets the quality select the level per call, which keeps dumps cheap without affecting screenshots.
+template<typename T>
+static bool ZlibPNGSaver(const RGBA8Image& image, int quality, const T& write_func)
 {
-  const auto write_func = [](void* context, void* data, int size) {
-    std::fwrite(data, 1, size, static_cast<std::FILE*>(context));
+  const int level = std::clamp(quality / 10, 1, 9);
+  const u32 width = image.GetWidth();
+  const u32 height = image.GetHeight();
+  if (width == 0 || height == 0)
+    return false;
+
+  const u32 row_size = width * sizeof(u32);
+
+  const auto write_u32 = [](u8* dst, u32 value) {
+    dst[0] = static_cast<u8>(value >> 24);
+    dst[1] = static_cast<u8>(value >> 16);
+    dst[2] = static_cast<u8>(value >> 8);
+    dst[3] = static_cast<u8>(value);
+  };
+  const auto write_chunk = [&write_func, &write_u32](const char* type, const u8* data, u32 size) {
+    u8 header[8];
+    write_u32(header, size);
+    std::memcpy(&header[4], type, 4);
+    u8 footer[4];
+    uLong crc = crc32(0, &header[4], 4);
+    if (size > 0)
+      crc = crc32(crc, data, size);
+    write_u32(footer, static_cast<u32>(crc));
+    write_func(header, sizeof(header));
+    if (size > 0)
+      write_func(data, size);
+    write_func(footer, sizeof(footer));
   };
 
-  return (stbi_write_jpg_to_func(write_func, fp, image.GetWidth(), image.GetHeight(), 4, image.GetPixels(), quality) !=
-          0);
-}
\ No newline at end of file
+  static constexpr u8 signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  write_func(signature, sizeof(signature));
+
+  u8 ihdr[13];
+  write_u32(&ihdr[0], width);
+  write_u32(&ihdr[4], height);
+  ihdr[8] = 8;  // bit depth
+  ihdr[9] = 6;  // RGBA
+  ihdr[10] = 0; // deflate
+  ihdr[11] = 0; // adaptive filtering
+  ihdr[12] = 0; // no interlace
+  write_chunk("IHDR", ihdr, sizeof(ihdr));
+
+  z_stream zs = {};
+  if (deflateInit(&zs, level) != Z_OK)
+    return false;
+  ScopedGuard zs_guard([&zs]() { deflateEnd(&zs); });
+
+  // Up is nearly free and enough at the fast levels, Paeth costs more but usually compresses best.
+  const u8 filter = (level <= 3) ? 2 : 4;
+  std::vector<u8> filtered_row(row_size + 1);
+  std::vector<u8> zero_row(row_size);
+  std::vector<u8> out_buffer(64 * 1024);
+  zs.next_out = out_buffer.data();
+  zs.avail_out = static_cast<uInt>(out_buffer.size());
+
+  const u8* prev_row = zero_row.data();
+  for (u32 y = 0; y < height; y++)
+  {
+    const u8* row = reinterpret_cast<const u8*>(image.GetRowPixels(y));
+    u8* dst = &filtered_row[1];
+    filtered_row[0] = filter;
+    if (filter == 2)
+    {
+      for (u32 x = 0; x < row_size; x++)
+        dst[x] = static_cast<u8>(row[x] - prev_row[x]);
+    }
+    else
+    {
+      for (u32 x = 0; x < row_size; x++)
+      {
+        const s32 a = (x >= 4) ? row[x - 4] : 0;
+        const s32 b = prev_row[x];
+        const s32 c = (x >= 4) ? prev_row[x - 4] : 0;
+        const s32 p = a + b - c;
+        const s32 pa = std::abs(p - a);
+        const s32 pb = std::abs(p - b);
+        const s32 pc = std::abs(p - c);
+        const s32 pred = (pa <= pb && pa <= pc) ? a : ((pb <= pc) ? b : c);
+        dst[x] = static_cast<u8>(row[x] - pred);
+      }
+    }
+    prev_row = row;
+
+    zs.next_in = filtered_row.data();
+    zs.avail_in = static_cast<uInt>(filtered_row.size());
+    const int flush = (y == (height - 1)) ? Z_FINISH : Z_NO_FLUSH;
+    for (;;)
+    {
+      const int res = deflate(&zs, flush);
+      if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR)
+        return false;
+
+      if (zs.avail_out == 0 || res == Z_STREAM_END)
+      {
+        write_chunk("IDAT", out_buffer.data(), static_cast<u32>(out_buffer.size() - zs.avail_out));
+        zs.next_out = out_buffer.data();
+        zs.avail_out = static_cast<uInt>(out_buffer.size());
+      }
+
+      if (res == Z_STREAM_END || (flush == Z_NO_FLUSH && zs.avail_in == 0))
+        break;
+    }
+  }
+
+  write_chunk("IEND", nullptr, 0);
+  return true;
+}
+
+bool ZlibBufferSaverPNG(const RGBA8Image& image, std::vector<u8>* buffer, int quality)
+{
+  return ZlibPNGSaver(image, quality, [buffer](const void* data, size_t size) {
+    const u8* bytes = static_cast<const u8*>(data);
+    buffer->insert(buffer->end(), bytes, bytes + size);
+  });
+}
+
+bool ZlibFileSaverPNG(const RGBA8Image& image, const char* filename, std::FILE* fp, int quality)
+{
+  bool result = true;
+  const bool encoded = ZlibPNGSaver(image, quality, [fp, &result](const void* data, size_t size) {
+    result &= (std::fwrite(data, 1, size, fp) == size);
+  });
+  return (encoded && result);
+}
@@ -113,6 +113,9 @@ class RGBA8Image : public Image<u32>
 public:
   static constexpr int DEFAULT_SAVE_QUALITY = 85;
 
+  /// Lowest PNG compression level, for dumps where encode time matters more than file size.
+  static constexpr int FAST_SAVE_QUALITY = 10;
+
   RGBA8Image();
   RGBA8Image(u32 width, u32 height, const u32* pixels);
   RGBA8Image(const RGBA8Image& copy);
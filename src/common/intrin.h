@@ -27,6 +27,16 @@
 #include <malloc.h> // alloca
 #endif
 
+/// Hints that ptr will be read soon. No-op where the compiler has no way of expressing it.
+ALWAYS_INLINE static void PrefetchForRead(const void* ptr)
+{
+#if defined(CPU_ARCH_SSE)
+  _mm_prefetch(static_cast<const char*>(ptr), _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr, 0, 3);
+#endif
+}
+
 template<typename T>
 ALWAYS_INLINE_RELEASE static void MemsetPtrs(T* ptr, T value, u32 count)
 {
@@ -19,9 +19,47 @@ void LayeredSettingsInterface::Clear()
   Panic("Attempting to clear layered settings interface");
 }
 
-bool LayeredSettingsInterface::GetIntValue(const char* section, const char* key, s32* value) const
+u32 LayeredSettingsInterface::FindFirstLayer(const char* section, const char* key) const
 {
+  bool valid = true;
+  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  {
+    SettingsInterface* sif = m_layers[layer];
+    const u32 counter = sif ? sif->GetChangeCounter() : 0;
+    if (m_layer_cache_layers[layer] != sif || m_layer_cache_counters[layer] != counter)
+    {
+      m_layer_cache_layers[layer] = sif;
+      m_layer_cache_counters[layer] = counter;
+      valid = false;
+    }
+  }
+  if (!valid)
+    m_layer_cache.clear();
+
+  // Reuse the key buffer, so hits don't allocate.
+  m_layer_cache_key.assign(section);
+  m_layer_cache_key.push_back('\0');
+  m_layer_cache_key.append(key);
+  if (const auto iter = m_layer_cache.find(m_layer_cache_key); iter != m_layer_cache.end())
+    return iter->second;
+
+  u32 found = NUM_LAYERS;
   for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  {
+    if (SettingsInterface* sif = m_layers[layer]; sif != nullptr && sif->ContainsValue(section, key))
+    {
+      found = layer;
+      break;
+    }
+  }
+
+  m_layer_cache.emplace(m_layer_cache_key, found);
+  return found;
+}
+
+bool LayeredSettingsInterface::GetIntValue(const char* section, const char* key, s32* value) const
+{
+  for (u32 layer = FindFirstLayer(section, key); layer <= LAST_LAYER; layer++)
   {
     if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
     {
@@ -35,7 +73,7 @@ bool LayeredSettingsInterface::GetIntValue(const char* section, const char* key,
 
 bool LayeredSettingsInterface::GetUIntValue(const char* section, const char* key, u32* value) const
 {
-  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  for (u32 layer = FindFirstLayer(section, key); layer <= LAST_LAYER; layer++)
   {
     if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
     {
@@ -49,7 +87,7 @@ bool LayeredSettingsInterface::GetUIntValue(const char* section, const char* key
 
 bool LayeredSettingsInterface::GetFloatValue(const char* section, const char* key, float* value) const
 {
-  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  for (u32 layer = FindFirstLayer(section, key); layer <= LAST_LAYER; layer++)
   {
     if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
     {
@@ -63,7 +101,7 @@ bool LayeredSettingsInterface::GetFloatValue(const char* section, const char* ke
 
 bool LayeredSettingsInterface::GetDoubleValue(const char* section, const char* key, double* value) const
 {
-  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  for (u32 layer = FindFirstLayer(section, key); layer <= LAST_LAYER; layer++)
   {
     if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
     {
@@ -77,7 +115,7 @@ bool LayeredSettingsInterface::GetDoubleValue(const char* section, const char* k
 
 bool LayeredSettingsInterface::GetBoolValue(const char* section, const char* key, bool* value) const
 {
-  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  for (u32 layer = FindFirstLayer(section, key); layer <= LAST_LAYER; layer++)
   {
     if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
     {
@@ -91,7 +129,7 @@ bool LayeredSettingsInterface::GetBoolValue(const char* section, const char* key
 
 bool LayeredSettingsInterface::GetStringValue(const char* section, const char* key, std::string* value) const
 {
-  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
+  for (u32 layer = FindFirstLayer(section, key); layer <= LAST_LAYER; layer++)
   {
     if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
     {
@@ -135,15 +173,7 @@ void LayeredSettingsInterface::SetStringValue(const char* section, const char* k
 
 bool LayeredSettingsInterface::ContainsValue(const char* section, const char* key) const
 {
-  for (u32 layer = FIRST_LAYER; layer <= LAST_LAYER; layer++)
-  {
-    if (SettingsInterface* sif = m_layers[layer]; sif != nullptr)
-    {
-      if (sif->ContainsValue(section, key))
-        return true;
-    }
-  }
-  return false;
+  return (FindFirstLayer(section, key) != NUM_LAYERS);
 }
 
 void LayeredSettingsInterface::DeleteValue(const char* section, const char* key)
@@ -4,6 +4,8 @@
 #pragma once
 #include "settings_interface.h"
 #include <array>
+#include <string>
+#include <unordered_map>
 
 class LayeredSettingsInterface final : public SettingsInterface
 {
@@ -64,5 +66,15 @@ private:
   static constexpr Layer FIRST_LAYER = LAYER_CMDLINE;
   static constexpr Layer LAST_LAYER = LAYER_BASE;
 
+  /// Returns the first layer which contains the key, or NUM_LAYERS if none do.
+  u32 FindFirstLayer(const char* section, const char* key) const;
+
   std::array<SettingsInterface*, NUM_LAYERS> m_layers{};
+
+  // Settings are read far more often than they change, so remember which layer each key was found in, and skip the
+  // layers before it. Protected by the same lock as the layers themselves, and dropped when any of them change.
+  mutable std::unordered_map<std::string, u32> m_layer_cache;
+  mutable std::array<SettingsInterface*, NUM_LAYERS> m_layer_cache_layers{};
+  mutable std::array<u32, NUM_LAYERS> m_layer_cache_counters{};
+  mutable std::string m_layer_cache_key;
 };
\ No newline at end of file
@@ -5,12 +5,18 @@
 #include "assert.h"
 #include "file_system.h"
 #include "small_string.h"
+#include "threading.h"
 #include "timer.h"
 
 #include "fmt/format.h"
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <vector>
 
 #if defined(_WIN32)
@@ -30,13 +36,50 @@ struct RegisteredCallback
   Log::CallbackFunctionType Function;
   void* Parameter;
 };
+
+// Slot in the asynchronous message queue. The channel and function names point at string literals, so they outlive
+// the message. The message string keeps its capacity when the slot is recycled, so steady-state logging doesn't
+// allocate.
+struct QueuedMessage
+{
+  std::atomic<size_t> sequence;
+  const char* channel_name;
+  const char* function_name;
+  LOGLEVEL level;
+  Common::Timer::Value timestamp;
+  std::string message;
+};
+
+struct ChannelRateLimit
+{
+  std::atomic<const char*> channel_name{nullptr};
+  std::atomic<u32> window{0};
+  std::atomic<u32> count{0};
+  std::atomic<u32> suppressed{0};
+};
 } // namespace
 
+// Must be a power of two.
+static constexpr u32 ASYNC_QUEUE_SIZE = 4096;
+static constexpr u32 RATE_LIMIT_TABLE_SIZE = 256;
+
 static void RegisterCallback(CallbackFunctionType callbackFunction, void* pUserParam,
                              const std::unique_lock<std::mutex>& lock);
 static void UnregisterCallback(CallbackFunctionType callbackFunction, void* pUserParam,
                                const std::unique_lock<std::mutex>& lock);
 static bool FilterTest(LOGLEVEL level, const char* channelName, const std::unique_lock<std::mutex>& lock);
+static bool BeginMessage(const char* channelName, LOGLEVEL level, std::unique_lock<std::mutex>& lock);
+static void DispatchMessage(const char* channelName, const char* functionName, LOGLEVEL level,
+                            std::string_view message, std::unique_lock<std::mutex>& lock);
+static bool RateLimitTest(const char* channelName, LOGLEVEL level);
+static void ReportSuppressedMessages(const std::unique_lock<std::mutex>& lock);
+static void PushAsyncMessage(const char* channelName, const char* functionName, LOGLEVEL level,
+                             std::string_view message);
+static void WakeAsyncWriter();
+static bool HasQueuedMessage();
+static void DrainAsyncQueue();
+static void AsyncWriterThreadEntryPoint();
+static void FlushAsyncOutput();
 static void ExecuteCallbacks(const char* channelName, const char* functionName, LOGLEVEL level,
                              std::string_view message, const std::unique_lock<std::mutex>& lock);
 static void FormatLogMessageForDisplay(fmt::memory_buffer& buffer, const char* channelName, const char* functionName,
@@ -67,6 +110,7 @@ static std::mutex s_callback_mutex;
 static Common::Timer::Value s_start_timestamp = Common::Timer::GetCurrentValue();
 
 static std::string s_log_filter;
+static std::atomic_bool s_log_filter_active{false};
 static LOGLEVEL s_log_level = LOGLEVEL_TRACE;
 static bool s_console_output_enabled = false;
 static bool s_console_output_timestamps = true;
@@ -74,6 +118,29 @@ static bool s_file_output_enabled = false;
 static bool s_file_output_timestamp = false;
 static bool s_debug_output_enabled = false;
 
+// Producers reserve a slot by advancing the enqueue position, then publish it by bumping its sequence. Only the writer
+// thread dequeues, under the callback mutex.
+static std::unique_ptr<QueuedMessage[]> s_async_queue;
+static std::atomic<size_t> s_async_enqueue_pos{0};
+static size_t s_async_dequeue_pos = 0;
+static std::atomic_bool s_async_output_enabled{false};
+static std::atomic_bool s_async_writer_sleeping{false};
+static std::atomic<u32> s_async_dropped_messages{0};
+static Threading::Thread s_async_writer_thread;
+static Threading::KernelSemaphore s_async_writer_semaphore;
+static std::mutex s_async_flush_mutex;
+static std::condition_variable s_async_flush_cv;
+static size_t s_async_flushed_pos = 0;
+
+// Set while the writer thread runs callbacks, so messages keep the time they were logged at.
+static thread_local Common::Timer::Value s_queued_message_timestamp = 0;
+
+static std::array<ChannelRateLimit, RATE_LIMIT_TABLE_SIZE> s_channel_rate_limits;
+static std::atomic<u32> s_channel_rate_limit{0};
+static std::atomic_bool s_has_suppressed_messages{false};
+static Common::Timer::Value s_rate_limit_window_ticks = Common::Timer::ConvertSecondsToValue(1.0);
+static Common::Timer::Value s_last_suppressed_report = 0;
+
 #ifdef _WIN32
 static HANDLE s_hConsoleStdIn = NULL;
 static HANDLE s_hConsoleStdOut = NULL;
@@ -125,7 +192,9 @@ void Log::UnregisterCallback(CallbackFunctionType callbackFunction, void* pUserP
 
 float Log::GetCurrentMessageTime()
 {
-  return static_cast<float>(Common::Timer::ConvertValueToSeconds(Common::Timer::GetCurrentValue() - s_start_timestamp));
+  const Common::Timer::Value timestamp =
+    (s_queued_message_timestamp != 0) ? s_queued_message_timestamp : Common::Timer::GetCurrentValue();
+  return static_cast<float>(Common::Timer::ConvertValueToSeconds(timestamp - s_start_timestamp));
 }
 
 bool Log::IsConsoleOutputEnabled()
@@ -420,6 +489,10 @@ void Log::FileOutputLogCallback(void* pUserParam, const char* channelName, const
 
 void Log::SetFileOutputParams(bool enabled, const char* filename, bool timestamps /* = true */)
 {
+  // Messages still in the queue belong in the file we're about to close.
+  if (!enabled)
+    FlushAsyncOutput();
+
   std::unique_lock lock(s_callback_mutex);
   if (s_file_output_enabled == enabled)
     return;
@@ -429,6 +502,7 @@ void Log::SetFileOutputParams(bool enabled, const char* filename, bool timestamp
     s_file_handle.reset(FileSystem::OpenCFile(filename, "wb"));
     if (!s_file_handle)
     {
+      lock.unlock();
       Log::Writef("Log", __FUNCTION__, LOGLEVEL_ERROR, "Failed to open log file '%s'", filename);
       return;
     }
@@ -471,6 +545,7 @@ void Log::SetLogFilter(std::string_view filter)
   std::unique_lock lock(s_callback_mutex);
   if (s_log_filter != filter)
     s_log_filter = filter;
+  s_log_filter_active.store(!s_log_filter.empty(), std::memory_order_relaxed);
 }
 
 ALWAYS_INLINE_RELEASE bool Log::FilterTest(LOGLEVEL level, const char* channelName,
@@ -479,13 +554,315 @@ ALWAYS_INLINE_RELEASE bool Log::FilterTest(LOGLEVEL level, const char* channelNa
   return (level <= s_log_level && s_log_filter.find(channelName) == std::string::npos);
 }
 
-void Log::Write(const char* channelName, const char* functionName, LOGLEVEL level, std::string_view message)
+void Log::SetAsyncOutputParams(bool enabled)
+{
+  if (s_async_output_enabled.load(std::memory_order_relaxed) == enabled)
+    return;
+
+  if (enabled)
+  {
+    if (!s_async_queue)
+    {
+      s_async_queue = std::make_unique<QueuedMessage[]>(ASYNC_QUEUE_SIZE);
+      for (u32 i = 0; i < ASYNC_QUEUE_SIZE; i++)
+        s_async_queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    const size_t pos = s_async_enqueue_pos.load(std::memory_order_relaxed);
+    s_async_dequeue_pos = pos;
+    s_async_flushed_pos = pos;
+    s_async_writer_sleeping.store(false, std::memory_order_relaxed);
+    s_async_output_enabled.store(true, std::memory_order_release);
+    s_async_writer_thread.Start(&AsyncWriterThreadEntryPoint);
+  }
+  else
+  {
+    // The writer drains the queue before it exits.
+    s_async_output_enabled.store(false, std::memory_order_release);
+    s_async_writer_sleeping.store(false, std::memory_order_relaxed);
+    s_async_writer_semaphore.Post();
+    s_async_writer_thread.Join();
+
+    // Pick up anything which was queued while the writer was exiting.
+    DrainAsyncQueue();
+  }
+}
+
+void Log::SetChannelRateLimit(u32 messages_per_second)
+{
+  s_channel_rate_limit.store(messages_per_second, std::memory_order_relaxed);
+}
+
+void Log::WakeAsyncWriter()
 {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (s_async_writer_sleeping.load(std::memory_order_relaxed) &&
+      s_async_writer_sleeping.exchange(false, std::memory_order_acq_rel))
+  {
+    s_async_writer_semaphore.Post();
+  }
+}
+
+bool Log::HasQueuedMessage()
+{
+  const QueuedMessage& slot = s_async_queue[s_async_dequeue_pos & (ASYNC_QUEUE_SIZE - 1)];
+  return (slot.sequence.load(std::memory_order_acquire) == (s_async_dequeue_pos + 1));
+}
+
+void Log::PushAsyncMessage(const char* channelName, const char* functionName, LOGLEVEL level,
+                           std::string_view message)
+{
+  const Common::Timer::Value timestamp = Common::Timer::GetCurrentValue();
+
+  QueuedMessage* slot;
+  size_t pos = s_async_enqueue_pos.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    slot = &s_async_queue[pos & (ASYNC_QUEUE_SIZE - 1)];
+    const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0)
+    {
+      if (s_async_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+    {
+      // Queue is full. Verbose messages are dropped rather than stalling the caller, anything more important waits
+      // for the writer to catch up.
+      if (level > LOGLEVEL_INFO)
+      {
+        s_async_dropped_messages.fetch_add(1, std::memory_order_relaxed);
+        s_has_suppressed_messages.store(true, std::memory_order_relaxed);
+        return;
+      }
+
+      WakeAsyncWriter();
+      std::this_thread::yield();
+      pos = s_async_enqueue_pos.load(std::memory_order_relaxed);
+    }
+    else
+    {
+      pos = s_async_enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->channel_name = channelName;
+  slot->function_name = functionName;
+  slot->level = level;
+  slot->timestamp = timestamp;
+  slot->message.assign(message);
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  WakeAsyncWriter();
+}
+
+void Log::DrainAsyncQueue()
+{
+  if (!s_async_queue)
+    return;
+
   std::unique_lock lock(s_callback_mutex);
-  if (!FilterTest(level, channelName, lock))
+
+  // Bounded, so a flood of messages can't keep the writer from reporting drops, or starve the mutex.
+  size_t pos = s_async_dequeue_pos;
+  const size_t end_pos = pos + ASYNC_QUEUE_SIZE;
+  while (pos != end_pos)
+  {
+    QueuedMessage& slot = s_async_queue[pos & (ASYNC_QUEUE_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != (pos + 1))
+      break;
+
+    s_queued_message_timestamp = slot.timestamp;
+    ExecuteCallbacks(slot.channel_name, slot.function_name, slot.level, slot.message, lock);
+    slot.sequence.store(pos + ASYNC_QUEUE_SIZE, std::memory_order_release);
+    pos++;
+  }
+  s_queued_message_timestamp = 0;
+
+  const bool wrote_messages = (pos != s_async_dequeue_pos);
+  s_async_dequeue_pos = pos;
+
+  ReportSuppressedMessages(lock);
+
+  // One flush per batch instead of relying on stdio buffering, so the file is current if we crash.
+  if (wrote_messages && s_file_output_enabled)
+    std::fflush(s_file_handle.get());
+
+  lock.unlock();
+
+  {
+    std::unique_lock flush_lock(s_async_flush_mutex);
+    s_async_flushed_pos = pos;
+  }
+  s_async_flush_cv.notify_all();
+}
+
+void Log::AsyncWriterThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Log Writer");
+
+  for (;;)
+  {
+    DrainAsyncQueue();
+    if (!s_async_output_enabled.load(std::memory_order_acquire))
+      break;
+
+    // Producers only post the semaphore when we say we're sleeping, so check again after saying so.
+    s_async_writer_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (HasQueuedMessage() || !s_async_output_enabled.load(std::memory_order_acquire))
+    {
+      // If a producer already claimed the wakeup, its post has to be consumed.
+      if (s_async_writer_sleeping.exchange(false, std::memory_order_acq_rel))
+        continue;
+    }
+
+    s_async_writer_semaphore.Wait();
+  }
+}
+
+void Log::FlushAsyncOutput()
+{
+  if (!s_async_output_enabled.load(std::memory_order_acquire))
     return;
 
-  ExecuteCallbacks(channelName, functionName, level, message, lock);
+  const size_t target_pos = s_async_enqueue_pos.load(std::memory_order_acquire);
+  WakeAsyncWriter();
+
+  std::unique_lock lock(s_async_flush_mutex);
+  s_async_flush_cv.wait(lock, [target_pos]() {
+    return (static_cast<intptr_t>(s_async_flushed_pos - target_pos) >= 0 ||
+            !s_async_output_enabled.load(std::memory_order_acquire));
+  });
+}
+
+bool Log::RateLimitTest(const char* channelName, LOGLEVEL level)
+{
+  // Errors, warnings and info are never suppressed.
+  const u32 limit = s_channel_rate_limit.load(std::memory_order_relaxed);
+  if (limit == 0 || level <= LOGLEVEL_INFO)
+    return true;
+
+  // Channel names are per-file static pointers, so the pointer itself is a good enough key.
+  u32 index = static_cast<u32>((reinterpret_cast<uintptr_t>(channelName) >> 3) * 0x9E3779B1u) >> 24;
+  ChannelRateLimit* entry = nullptr;
+  for (u32 i = 0; i < RATE_LIMIT_TABLE_SIZE; i++, index = (index + 1) % RATE_LIMIT_TABLE_SIZE)
+  {
+    ChannelRateLimit& test = s_channel_rate_limits[index];
+    const char* existing = test.channel_name.load(std::memory_order_acquire);
+    if (!existing && test.channel_name.compare_exchange_strong(existing, channelName, std::memory_order_acq_rel))
+      existing = channelName;
+
+    if (existing == channelName)
+    {
+      entry = &test;
+      break;
+    }
+  }
+
+  // More channels than slots, don't limit the overflow.
+  if (!entry)
+    return true;
+
+  // Races here only let a few extra messages through when the window rolls over.
+  const u32 window =
+    static_cast<u32>((Common::Timer::GetCurrentValue() - s_start_timestamp) / s_rate_limit_window_ticks);
+  u32 current_window = entry->window.load(std::memory_order_relaxed);
+  if (current_window != window &&
+      entry->window.compare_exchange_strong(current_window, window, std::memory_order_relaxed))
+  {
+    entry->count.store(0, std::memory_order_relaxed);
+  }
+
+  if (entry->count.fetch_add(1, std::memory_order_relaxed) < limit)
+    return true;
+
+  entry->suppressed.fetch_add(1, std::memory_order_relaxed);
+  s_has_suppressed_messages.store(true, std::memory_order_relaxed);
+  return false;
+}
+
+void Log::ReportSuppressedMessages(const std::unique_lock<std::mutex>& lock)
+{
+  // At most once a second, otherwise the reports become the flood.
+  if (!s_has_suppressed_messages.load(std::memory_order_relaxed))
+    return;
+
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  if ((current_time - s_last_suppressed_report) < s_rate_limit_window_ticks)
+    return;
+
+  s_last_suppressed_report = current_time;
+  s_has_suppressed_messages.store(false, std::memory_order_relaxed);
+
+  SmallString message;
+  const u32 dropped = s_async_dropped_messages.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0)
+  {
+    message.fmt("Log queue was full, dropped {} messages.", dropped);
+    ExecuteCallbacks("Log", __FUNCTION__, LOGLEVEL_WARNING, message, lock);
+  }
+
+  for (ChannelRateLimit& entry : s_channel_rate_limits)
+  {
+    const char* channel_name = entry.channel_name.load(std::memory_order_acquire);
+    if (!channel_name)
+      continue;
+
+    const u32 suppressed = entry.suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0)
+    {
+      message.fmt("Suppressed {} messages from channel {}, limit is {} per second.", suppressed, channel_name,
+                  s_channel_rate_limit.load(std::memory_order_relaxed));
+      ExecuteCallbacks("Log", __FUNCTION__, LOGLEVEL_WARNING, message, lock);
+    }
+  }
+}
+
+bool Log::BeginMessage(const char* channelName, LOGLEVEL level, std::unique_lock<std::mutex>& lock)
+{
+  if (level > s_log_level)
+    return false;
+
+  // Asynchronous producers only need the mutex to test the channel filter.
+  if (!s_async_output_enabled.load(std::memory_order_acquire) || s_log_filter_active.load(std::memory_order_relaxed))
+  {
+    lock = std::unique_lock(s_callback_mutex);
+    if (!FilterTest(level, channelName, lock))
+      return false;
+
+    if (s_async_output_enabled.load(std::memory_order_acquire))
+      lock.unlock();
+  }
+
+  return RateLimitTest(channelName, level);
+}
+
+void Log::DispatchMessage(const char* channelName, const char* functionName, LOGLEVEL level,
+                          std::string_view message, std::unique_lock<std::mutex>& lock)
+{
+  if (lock.owns_lock())
+  {
+    ExecuteCallbacks(channelName, functionName, level, message, lock);
+    ReportSuppressedMessages(lock);
+    return;
+  }
+
+  PushAsyncMessage(channelName, functionName, level, message);
+
+  // Errors are often the last thing logged before a crash, don't leave them in the queue.
+  if (level == LOGLEVEL_ERROR)
+    FlushAsyncOutput();
+}
+
+void Log::Write(const char* channelName, const char* functionName, LOGLEVEL level, std::string_view message)
+{
+  std::unique_lock<std::mutex> lock;
+  if (!BeginMessage(channelName, level, lock))
+    return;
+
+  DispatchMessage(channelName, functionName, level, message, lock);
 }
 
 void Log::Writef(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, ...)
@@ -498,8 +875,8 @@ void Log::Writef(const char* channelName, const char* functionName, LOGLEVEL lev
 
 void Log::Writev(const char* channelName, const char* functionName, LOGLEVEL level, const char* format, va_list ap)
 {
-  std::unique_lock lock(s_callback_mutex);
-  if (!FilterTest(level, channelName, lock))
+  std::unique_lock<std::mutex> lock;
+  if (!BeginMessage(channelName, level, lock))
     return;
 
   std::va_list apCopy;
@@ -517,14 +894,14 @@ void Log::Writev(const char* channelName, const char* functionName, LOGLEVEL lev
     char buffer[512];
     const int len = std::vsnprintf(buffer, countof(buffer), format, ap);
     if (len > 0)
-      ExecuteCallbacks(channelName, functionName, level, std::string_view(buffer, static_cast<size_t>(len)), lock);
+      DispatchMessage(channelName, functionName, level, std::string_view(buffer, static_cast<size_t>(len)), lock);
   }
   else
   {
     char* buffer = new char[requiredSize + 1];
     const int len = std::vsnprintf(buffer, requiredSize + 1, format, ap);
     if (len > 0)
-      ExecuteCallbacks(channelName, functionName, level, std::string_view(buffer, static_cast<size_t>(len)), lock);
+      DispatchMessage(channelName, functionName, level, std::string_view(buffer, static_cast<size_t>(len)), lock);
     delete[] buffer;
   }
 }
@@ -532,12 +909,12 @@ void Log::Writev(const char* channelName, const char* functionName, LOGLEVEL lev
 void Log::WriteFmtArgs(const char* channelName, const char* functionName, LOGLEVEL level, fmt::string_view fmt,
                        fmt::format_args args)
 {
-  std::unique_lock lock(s_callback_mutex);
-  if (!FilterTest(level, channelName, lock))
+  std::unique_lock<std::mutex> lock;
+  if (!BeginMessage(channelName, level, lock))
     return;
 
   fmt::memory_buffer buffer;
   fmt::vformat_to(std::back_inserter(buffer), fmt, args);
 
-  ExecuteCallbacks(channelName, functionName, level, std::string_view(buffer.data(), buffer.size()), lock);
+  DispatchMessage(channelName, functionName, level, std::string_view(buffer.data(), buffer.size()), lock);
 }
@@ -52,6 +52,14 @@ void SetDebugOutputParams(bool enabled);
 // adds a file output
 void SetFileOutputParams(bool enabled, const char* filename, bool timestamps = true);
 
+// Moves output to a background thread. Messages are formatted and queued by the caller, and the sinks run in batches
+// on the writer thread. Disabling writes out anything still queued.
+void SetAsyncOutputParams(bool enabled);
+
+// Limits how many messages more verbose than info a single channel can log per second, 0 for no limit. Suppressed
+// messages are counted and reported.
+void SetChannelRateLimit(u32 messages_per_second);
+
 // Returns the current global filtering level.
 LOGLEVEL GetLogLevel();
 
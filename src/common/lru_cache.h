@@ -85,6 +85,25 @@ public:
     }
   }
 
+  /// Removes the least recently used item, passing its value to the callback first. Used for size-based budgets.
+  template<typename Callback>
+  bool EvictOldest(const Callback& callback)
+  {
+    if (m_items.empty())
+      return false;
+
+    typename MapType::iterator lowest = m_items.begin();
+    for (auto iter = m_items.begin(); iter != m_items.end(); ++iter)
+    {
+      if (iter->second.last_access < lowest->second.last_access)
+        lowest = iter;
+    }
+
+    callback(lowest->first, lowest->second.value);
+    m_items.erase(lowest);
+    return true;
+  }
+
   template<typename KeyT>
   bool Remove(const KeyT& key)
   {
@@ -11,15 +11,17 @@
 
 #if defined(_WIN32)
 #include "windows_headers.h"
-#elif !defined(__ANDROID__)
+#else
 #include <cerrno>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
 #if defined(__APPLE__) && defined(__aarch64__)
 // pthread_jit_write_protect_np()
+#include <atomic>
 #include <pthread.h>
 #endif
 
@@ -81,6 +83,67 @@ void MemMap::UnmapSharedMemory(void* baseaddr, size_t size)
     Panic("Failed to unmap shared memory");
 }
 
+void* MemMap::MapNamedSharedMemory(const char* name, size_t size, bool* created)
+{
+  const HANDLE mapping =
+    CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                       static_cast<DWORD>(size), StringUtil::UTF8StringToWideString(name).c_str());
+  if (!mapping)
+  {
+    Log_ErrorPrintf("CreateFileMappingW() for '%s' failed: %u", name, GetLastError());
+    return nullptr;
+  }
+
+  // Must be checked before anything else touches the last error.
+  *created = (GetLastError() != ERROR_ALREADY_EXISTS);
+
+  // The view keeps the object (and its name) alive, so the handle can be closed straight away.
+  void* ret = MapViewOfFile(mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, size);
+  CloseHandle(mapping);
+  return ret;
+}
+
+void MemMap::RemoveNamedSharedMemory(const char* name)
+{
+  // Named objects go away by themselves once the last view is released.
+}
+
+void* MemMap::MapFileReadOnly(const char* path, size_t* size)
+{
+  const HANDLE file =
+    CreateFileW(StringUtil::UTF8StringToWideString(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  // The view keeps the mapping alive, so the handles can be closed straight away.
+  const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+    return nullptr;
+
+  void* ret = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!ret)
+    return nullptr;
+
+  *size = static_cast<size_t>(file_size.QuadPart);
+  return ret;
+}
+
+void MemMap::UnmapFile(void* baseaddr, size_t size)
+{
+  if (!UnmapViewOfFile(baseaddr))
+    Panic("Failed to unmap file");
+}
+
 SharedMemoryMappingArea::SharedMemoryMappingArea() = default;
 
 SharedMemoryMappingArea::~SharedMemoryMappingArea()
@@ -321,6 +384,72 @@ void* MemMap::CreateSharedMemory(const char* name, size_t size)
   return reinterpret_cast<void*>(static_cast<intptr_t>(fd));
 }
 
+static std::string GetNamedSharedMemoryPath(const char* name)
+{
+#if defined(__FreeBSD__)
+  // FreeBSD's shm_open(3) requires name to be absolute
+  return fmt::format("/tmp/{}", name);
+#else
+  return fmt::format("/{}", name);
+#endif
+}
+
+void* MemMap::MapNamedSharedMemory(const char* name, size_t size, bool* created)
+{
+  const std::string path = GetNamedSharedMemoryPath(name);
+  int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  *created = (fd >= 0);
+  if (fd < 0)
+  {
+    if (errno == EEXIST)
+      fd = shm_open(path.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+    {
+      Log_ErrorPrintf("shm_open(%s) failed: %d", path.c_str(), errno);
+      return nullptr;
+    }
+  }
+
+  if (*created)
+  {
+    if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+    {
+      Log_ErrorPrintf("ftruncate(%zu) failed: %d", size, errno);
+      close(fd);
+      shm_unlink(path.c_str());
+      return nullptr;
+    }
+  }
+  else
+  {
+    // The creator may not have sized it yet, or it's left over from something else with the same name.
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != size)
+    {
+      Log_ErrorPrintf("Existing shared memory '%s' is the wrong size", path.c_str());
+      close(fd);
+      return nullptr;
+    }
+  }
+
+  // The mapping keeps the object referenced, so the descriptor can be closed straight away.
+  void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    if (*created)
+      shm_unlink(path.c_str());
+    return nullptr;
+  }
+
+  return ptr;
+}
+
+void MemMap::RemoveNamedSharedMemory(const char* name)
+{
+  shm_unlink(GetNamedSharedMemoryPath(name).c_str());
+}
+
 void MemMap::DestroySharedMemory(void* ptr)
 {
   close(static_cast<int>(reinterpret_cast<intptr_t>(ptr)));
@@ -404,9 +533,81 @@ bool SharedMemoryMappingArea::Unmap(void* map_base, size_t map_size)
 
 #endif
 
+#ifndef _WIN32
+
+// Also used on Android, unlike the shared memory functions above.
+void* MemMap::MapFileReadOnly(const char* path, size_t* size)
+{
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  // The mapping keeps the file referenced, so the descriptor can be closed straight away.
+  void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+
+  *size = static_cast<size_t>(st.st_size);
+  return ptr;
+}
+
+void MemMap::UnmapFile(void* baseaddr, size_t size)
+{
+  if (munmap(baseaddr, size) != 0)
+    Panic("Failed to unmap file");
+}
+
+#endif
+
+bool MemMap::AdviseHugePages(void* baseaddr, size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const uintptr_t start = Common::AlignUpPow2(reinterpret_cast<uintptr_t>(baseaddr), HOST_PAGE_SIZE);
+  const uintptr_t end = Common::AlignDownPow2(reinterpret_cast<uintptr_t>(baseaddr) + size, HOST_PAGE_SIZE);
+  if (end <= start)
+    return false;
+
+  if (madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE) != 0)
+  {
+    Log_DevPrintf("madvise(MADV_HUGEPAGE) failed: %d", errno);
+    return false;
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+void MemMap::Readahead(const void* baseaddr, size_t size)
+{
+  const uintptr_t start = Common::AlignDownPow2(reinterpret_cast<uintptr_t>(baseaddr), HOST_PAGE_SIZE);
+  const uintptr_t end = Common::AlignUpPow2(reinterpret_cast<uintptr_t>(baseaddr) + size, HOST_PAGE_SIZE);
+  if (end <= start)
+    return;
+
+#if defined(_WIN32)
+  WIN32_MEMORY_RANGE_ENTRY range = {reinterpret_cast<void*>(start), end - start};
+  if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0))
+    Log_DevPrintf("PrefetchVirtualMemory() failed: %u", GetLastError());
+#elif defined(MADV_WILLNEED)
+  if (madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED) != 0)
+    Log_DevPrintf("madvise(MADV_WILLNEED) failed: %d", errno);
+#endif
+}
+
 #if defined(__APPLE__) && defined(__aarch64__)
 
 static thread_local int s_code_write_depth = 0;
+static std::atomic<u32> s_code_write_toggle_count{0};
 
 void MemMap::BeginCodeWrite()
 {
@@ -415,6 +616,7 @@ void MemMap::BeginCodeWrite()
   {
     // Log_DebugPrint("  pthread_jit_write_protect_np(0)");
     pthread_jit_write_protect_np(0);
+    s_code_write_toggle_count.fetch_add(1, std::memory_order_relaxed);
   }
 }
 
@@ -430,4 +632,9 @@ void MemMap::EndCodeWrite()
   }
 }
 
+u32 MemMap::GetCodeWriteToggleCount()
+{
+  return s_code_write_toggle_count.load(std::memory_order_relaxed);
+}
+
 #endif
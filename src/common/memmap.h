@@ -40,17 +40,41 @@ void* CreateSharedMemory(const char* name, size_t size);
 void DestroySharedMemory(void* ptr);
 void* MapSharedMemory(void* handle, size_t offset, void* baseaddr, size_t size, PageProtect mode);
 void UnmapSharedMemory(void* baseaddr, size_t size);
+
+/// Creates and maps a named shared memory object which other processes can open, or maps the existing one if another
+/// process got there first. The object outlives this process until RemoveNamedSharedMemory() is called, and views are
+/// released with UnmapFile(). Not available on Android.
+void* MapNamedSharedMemory(const char* name, size_t size, bool* created);
+void RemoveNamedSharedMemory(const char* name);
+
+/// Maps an entire file as read-only. Returns null on failure, or if the file is empty. The file can still be appended
+/// to through other handles, but the view only covers the size it had when it was mapped.
+void* MapFileReadOnly(const char* path, size_t* size);
+void UnmapFile(void* baseaddr, size_t size);
 bool MemProtect(void* baseaddr, size_t size, PageProtect mode);
 
-/// JIT write protect for Apple Silicon. Needs to be called prior to writing to any RWX pages.
+/// Hints that a private anonymous range should be backed by huge pages (transparent huge pages on Linux), cutting TLB
+/// misses for large, randomly accessed buffers. Only whole pages inside the range are covered. Returns false if the
+/// platform has no such hint or the kernel refused it, in which case the range keeps using normal pages.
+bool AdviseHugePages(void* baseaddr, size_t size);
+
+/// Asks the kernel to start paging in part of a file mapping in the background, so a later read of it doesn't block on
+/// the disk. Purely a hint, it doesn't wait, and does nothing where the platform can't do it.
+void Readahead(const void* baseaddr, size_t size);
+
+/// JIT write protect for Apple Silicon. Needs to be called prior to writing to any RWX pages. Calls nest, and only the
+/// outermost pair toggles protection, so wrapping a batch of writes in another pair makes it toggle once.
+/// GetCodeWriteToggleCount() returns how many times writes have been enabled, since startup.
 #if !defined(__APPLE__) || !defined(__aarch64__)
 // clang-format off
 ALWAYS_INLINE static void BeginCodeWrite() { }
 ALWAYS_INLINE static void EndCodeWrite() { }
+ALWAYS_INLINE static u32 GetCodeWriteToggleCount() { return 0; }
 // clang-format on
 #else
 void BeginCodeWrite();
 void EndCodeWrite();
+u32 GetCodeWriteToggleCount();
 #endif
 } // namespace MemMap
 
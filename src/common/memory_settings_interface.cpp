@@ -17,6 +17,7 @@ bool MemorySettingsInterface::Save()
 void MemorySettingsInterface::Clear()
 {
   m_sections.clear();
+  m_change_counter++;
 }
 
 bool MemorySettingsInterface::GetIntValue(const char* section, const char* key, s32* value) const
@@ -168,6 +169,8 @@ std::vector<std::pair<std::string, std::string>> MemorySettingsInterface::GetKey
 void MemorySettingsInterface::SetKeyValueList(const char* section,
                                               const std::vector<std::pair<std::string, std::string>>& items)
 {
+  m_change_counter++;
+
   auto sit = m_sections.find(section);
   sit->second.clear();
   for (const auto& [key, value] : items)
@@ -176,6 +179,8 @@ void MemorySettingsInterface::SetKeyValueList(const char* section,
 
 void MemorySettingsInterface::SetValue(const char* section, const char* key, std::string value)
 {
+  m_change_counter++;
+
   auto sit = m_sections.find(section);
   if (sit == m_sections.end())
     sit = m_sections.emplace(std::make_pair(std::string(section), KeyMap())).first;
@@ -216,6 +221,8 @@ std::vector<std::string> MemorySettingsInterface::GetStringList(const char* sect
 
 void MemorySettingsInterface::SetStringList(const char* section, const char* key, const std::vector<std::string>& items)
 {
+  m_change_counter++;
+
   auto sit = m_sections.find(section);
   if (sit == m_sections.end())
     sit = m_sections.emplace(std::make_pair(std::string(section), KeyMap())).first;
@@ -242,6 +249,7 @@ bool MemorySettingsInterface::RemoveFromStringList(const char* section, const ch
     if (iter->second == item)
     {
       sit->second.erase(iter++);
+      m_change_counter++;
       result = true;
     }
     else
@@ -267,6 +275,7 @@ bool MemorySettingsInterface::AddToStringList(const char* section, const char* k
   }
 
   sit->second.emplace(std::string(key), std::string(item));
+  m_change_counter++;
   return true;
 }
 
@@ -288,6 +297,8 @@ void MemorySettingsInterface::DeleteValue(const char* section, const char* key)
   const auto range = sit->second.equal_range(key);
   for (auto iter = range.first; iter != range.second;)
     sit->second.erase(iter++);
+
+  m_change_counter++;
 }
 
 void MemorySettingsInterface::ClearSection(const char* section)
@@ -297,4 +308,5 @@ void MemorySettingsInterface::ClearSection(const char* section)
     return;
 
   m_sections.erase(sit);
+  m_change_counter++;
 }
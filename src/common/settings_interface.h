@@ -13,6 +13,9 @@ class SettingsInterface
 public:
   virtual ~SettingsInterface() = default;
 
+  /// Changes whenever a value is modified, so lookups cached over this interface can tell when they are stale.
+  ALWAYS_INLINE u32 GetChangeCounter() const { return m_change_counter; }
+
   virtual bool Save() = 0;
   virtual void Clear() = 0;
 
@@ -216,4 +219,7 @@ public:
     else
       DeleteValue(section, key);
   }
+
+protected:
+  u32 m_change_counter = 0;
 };
@@ -3,6 +3,7 @@
 
 #include "threading.h"
 #include "assert.h"
+#include "trace_recorder.h"
 #include <memory>
 
 #if !defined(_WIN32) && !defined(__APPLE__)
@@ -559,6 +560,8 @@ void Threading::SetNameOfCurrentThread(const char* name)
 #else
   pthread_set_name_np(pthread_self(), name);
 #endif
+
+  TraceRecorder::SetCurrentThreadName(name);
 }
 
 Threading::KernelSemaphore::KernelSemaphore()
@@ -3,6 +3,7 @@
 
 #include "timer.h"
 #include "types.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 
@@ -13,10 +14,15 @@
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
 #endif
 
 namespace Common {
 
+static void ExactSleepUntil(Timer::Value value);
+
 #ifdef _WIN32
 
 static double s_counter_frequency;
@@ -98,18 +104,7 @@ void Timer::SleepUntil(Value value, bool exact)
 {
   if (exact)
   {
-    // Even with the high-precision timer, it's not precise enough to wake us up *exactly* when we want
-    // to. Dropping off the last 0.5ms and spinning for it seems enough on my system (Win11 22H2).
-    const Value wake_at = value - ConvertMillisecondsToValue(0.5);
-    Value current = GetCurrentValue();
-    if (wake_at > current)
-      SleepUntil(wake_at, false);
-
-    // And spin off whatever time is left.
-    do
-    {
-      current = GetCurrentValue();
-    } while (current < value);
+    ExactSleepUntil(value);
   }
   else
   {
@@ -187,20 +182,20 @@ void Timer::SleepUntil(Value value, bool exact)
 {
   if (exact)
   {
-    static constexpr Value min_sleep_time = static_cast<Value>(0.5 * 1000000);
-    const Value wake_at = value - min_sleep_time;
-    Value current = GetCurrentValue();
-    if (wake_at > current)
-      SleepUntil(wake_at, false);
-
-    // And spin off whatever time is left.
-    do
-    {
-      current = GetCurrentValue();
-    } while (current < value);
+    ExactSleepUntil(value);
   }
   else
   {
+#ifdef __linux__
+    // The default timer slack of 50us is added to every sleep, which is most of what we'd otherwise have to spin.
+    static thread_local bool s_timer_slack_set = false;
+    if (!s_timer_slack_set)
+    {
+      s_timer_slack_set = true;
+      prctl(PR_SET_TIMERSLACK, 1, 0, 0, 0);
+    }
+#endif
+
     // Apple doesn't have TIMER_ABSTIME, so fall back to nanosleep in such a case.
 #ifdef __APPLE__
     for (;;)
@@ -239,6 +234,42 @@ void Timer::SleepUntil(Value value, bool exact)
 
 #endif
 
+// How late the sleeps on this thread have been waking up, which is the part we have to spin for. Starts out
+// pessimistic, then follows what the OS actually delivers, so quiet systems spin for tens of microseconds, not 0.5ms.
+static thread_local Timer::Value s_sleep_overshoot = 0;
+static thread_local bool s_sleep_overshoot_initialized = false;
+
+void ExactSleepUntil(Timer::Value value)
+{
+  const Timer::Value min_spin_time = Timer::ConvertNanosecondsToValue(20000.0);
+  const Timer::Value max_spin_time = Timer::ConvertMillisecondsToValue(2.0);
+  if (!s_sleep_overshoot_initialized)
+  {
+    s_sleep_overshoot = Timer::ConvertMillisecondsToValue(0.5);
+    s_sleep_overshoot_initialized = true;
+  }
+
+  const Timer::Value spin_time = std::clamp(s_sleep_overshoot + min_spin_time, min_spin_time, max_spin_time);
+  Timer::Value current = Timer::GetCurrentValue();
+  if (value > current && (value - current) > spin_time)
+  {
+    const Timer::Value wake_at = value - spin_time;
+    Timer::SleepUntil(wake_at, false);
+
+    // Jump straight up to a later wake, so the next frame doesn't miss too, but only come down slowly.
+    current = Timer::GetCurrentValue();
+    const Timer::Value overshoot = (current > wake_at) ? (current - wake_at) : 0;
+    if (overshoot > s_sleep_overshoot)
+      s_sleep_overshoot = overshoot;
+    else
+      s_sleep_overshoot -= (s_sleep_overshoot - overshoot) / 16;
+  }
+
+  // And spin off whatever time is left.
+  while (current < value)
+    current = Timer::GetCurrentValue();
+}
+
 Timer::Timer()
 {
   Reset();
@@ -0,0 +1,228 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "trace_recorder.h"
+#include "error.h"
+#include "file_system.h"
+#include "log.h"
+#include "timer.h"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+Log_SetChannel(TraceRecorder);
+
+namespace TraceRecorder {
+namespace {
+struct Event
+{
+  const char* name;
+  u64 start_time;
+  u64 end_time;
+};
+
+struct ThreadBuffer
+{
+  std::string name;
+  u32 id;
+  std::atomic<u64> write_count{0};
+  std::atomic_bool exited{false};
+  std::unique_ptr<Event[]> events;
+};
+
+// Marks the buffer as finished when the thread exits, so it can be freed once it has been written.
+struct ThreadBufferOwner
+{
+  ThreadBuffer* buffer = nullptr;
+
+  ~ThreadBufferOwner()
+  {
+    if (buffer)
+      buffer->exited.store(true, std::memory_order_release);
+  }
+};
+} // namespace
+
+// Events from scopes which began before recording stopped can still be landing when the buffers are written, and
+// overwrite the oldest entries of a full buffer. Skip that many, rather than synchronizing with every thread.
+static constexpr u32 WRAPPED_BUFFER_SLACK = 256;
+
+static ThreadBuffer* CreateThreadBuffer();
+static void AppendEscapedString(fmt::memory_buffer& buffer, std::string_view str);
+
+static std::mutex s_mutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> s_thread_buffers;
+static u32 s_next_thread_id = 1;
+static u64 s_start_time = 0;
+
+static thread_local ThreadBufferOwner s_thread_buffer;
+static thread_local std::string s_thread_name;
+} // namespace TraceRecorder
+
+std::atomic_bool TraceRecorder::Internal::g_recording{false};
+
+u64 TraceRecorder::Internal::GetTimestamp()
+{
+  return Common::Timer::GetCurrentValue();
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::CreateThreadBuffer()
+{
+  std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+  buffer->events = std::make_unique<Event[]>(EVENTS_PER_THREAD);
+
+  std::unique_lock lock(s_mutex);
+  buffer->id = s_next_thread_id++;
+  buffer->name = s_thread_name.empty() ? fmt::format("Thread {}", buffer->id) : s_thread_name;
+  s_thread_buffer.buffer = buffer.get();
+  s_thread_buffers.push_back(std::move(buffer));
+  return s_thread_buffer.buffer;
+}
+
+void TraceRecorder::Internal::RecordEvent(const char* name, u64 start_time, u64 end_time)
+{
+  ThreadBuffer* buffer = s_thread_buffer.buffer;
+  if (!buffer) [[unlikely]]
+    buffer = CreateThreadBuffer();
+
+  // Only this thread writes the buffer, the release pairs with the reader in Stop().
+  const u64 index = buffer->write_count.load(std::memory_order_relaxed);
+  Event& event = buffer->events[index & (EVENTS_PER_THREAD - 1)];
+  event.name = name;
+  event.start_time = start_time;
+  event.end_time = end_time;
+  buffer->write_count.store(index + 1, std::memory_order_release);
+}
+
+void TraceRecorder::SetCurrentThreadName(const char* name)
+{
+  s_thread_name = name;
+
+  if (s_thread_buffer.buffer)
+  {
+    std::unique_lock lock(s_mutex);
+    s_thread_buffer.buffer->name = name;
+  }
+}
+
+void TraceRecorder::Start()
+{
+  std::unique_lock lock(s_mutex);
+  if (Internal::g_recording.load(std::memory_order_relaxed))
+    return;
+
+  // Buffers of threads which have gone are no longer needed.
+  s_thread_buffers.erase(std::remove_if(s_thread_buffers.begin(), s_thread_buffers.end(),
+                                        [](const std::unique_ptr<ThreadBuffer>& buffer) {
+                                          return buffer->exited.load(std::memory_order_acquire);
+                                        }),
+                         s_thread_buffers.end());
+  for (const std::unique_ptr<ThreadBuffer>& buffer : s_thread_buffers)
+    buffer->write_count.store(0, std::memory_order_relaxed);
+
+  s_start_time = Internal::GetTimestamp();
+  Internal::g_recording.store(true, std::memory_order_release);
+  Log_InfoPrint("Trace recording started.");
+}
+
+void TraceRecorder::AppendEscapedString(fmt::memory_buffer& buffer, std::string_view str)
+{
+  for (const char ch : str)
+  {
+    if (ch == '"' || ch == '\\')
+      buffer.push_back('\\');
+    if (static_cast<unsigned char>(ch) >= 0x20)
+      buffer.push_back(ch);
+  }
+}
+
+bool TraceRecorder::Stop(const char* path, Error* error)
+{
+  std::unique_lock lock(s_mutex);
+  if (!Internal::g_recording.load(std::memory_order_relaxed))
+  {
+    Error::SetString(error, "Trace recording is not active.");
+    return false;
+  }
+
+  Internal::g_recording.store(false, std::memory_order_release);
+
+  FileSystem::ManagedCFilePtr fp = FileSystem::OpenManagedCFile(path, "wb", error);
+  if (!fp)
+    return false;
+
+  // Timestamps are written in microseconds, the fraction keeps the nanoseconds.
+  static constexpr size_t FLUSH_SIZE = 1024 * 1024;
+  fmt::memory_buffer buffer;
+  auto appender = std::back_inserter(buffer);
+  bool first = true;
+  u64 num_events = 0;
+  bool okay = true;
+
+  const auto flush = [&buffer, &fp, &okay]() {
+    if (buffer.size() > 0 && std::fwrite(buffer.data(), buffer.size(), 1, fp.get()) != 1)
+      okay = false;
+    buffer.clear();
+  };
+
+  fmt::format_to(appender, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  for (const std::unique_ptr<ThreadBuffer>& tb : s_thread_buffers)
+  {
+    const u64 count = tb->write_count.load(std::memory_order_acquire);
+    if (count == 0)
+      continue;
+
+    fmt::format_to(appender, "{}\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"",
+                   first ? "" : ",", tb->id);
+    AppendEscapedString(buffer, tb->name);
+    fmt::format_to(appender, "\"}}}}");
+    first = false;
+
+    const u64 first_index = (count > EVENTS_PER_THREAD) ? (count - EVENTS_PER_THREAD + WRAPPED_BUFFER_SLACK) : 0;
+    for (u64 i = first_index; i < count; i++)
+    {
+      const Event& event = tb->events[i & (EVENTS_PER_THREAD - 1)];
+      const bool instant = (event.end_time == 0);
+      if (event.start_time < s_start_time || (!instant && event.end_time < event.start_time))
+        continue;
+
+      const double ts = Common::Timer::ConvertValueToNanoseconds(event.start_time - s_start_time) / 1000.0;
+      fmt::format_to(appender, ",\n{{\"name\":\"");
+      AppendEscapedString(buffer, event.name);
+      if (instant)
+      {
+        fmt::format_to(appender, "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}", tb->id, ts);
+      }
+      else
+      {
+        const double dur = Common::Timer::ConvertValueToNanoseconds(event.end_time - event.start_time) / 1000.0;
+        fmt::format_to(appender, "\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", tb->id,
+                       ts, dur);
+      }
+      num_events++;
+
+      if (buffer.size() >= FLUSH_SIZE)
+        flush();
+    }
+  }
+
+  fmt::format_to(appender, "\n]}}\n");
+  flush();
+
+  if (!okay || std::fflush(fp.get()) != 0)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %" PRIu64 " trace events to '%s'.", num_events, path);
+  return true;
+}
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "types.h"
+
+#include <atomic>
+
+class Error;
+
+/// Records timed events from any thread, and writes them in the Chrome trace event format, which can be opened in
+/// chrome://tracing or Perfetto. Each thread records into its own ring buffer without taking locks, so only the most
+/// recent events are kept, and a stutter can be captured after the fact.
+namespace TraceRecorder {
+
+/// Events kept per thread, older events are overwritten. Must be a power of two.
+static constexpr u32 EVENTS_PER_THREAD = 1 << 19;
+
+namespace Internal {
+extern std::atomic_bool g_recording;
+
+u64 GetTimestamp();
+/// An end time of zero records an instant event.
+void RecordEvent(const char* name, u64 start_time, u64 end_time);
+} // namespace Internal
+
+ALWAYS_INLINE static bool IsRecording()
+{
+  return Internal::g_recording.load(std::memory_order_relaxed);
+}
+
+/// Marks a point in time across all threads, e.g. the end of a frame. The name must be a string literal.
+ALWAYS_INLINE static void RecordInstant(const char* name)
+{
+  if (IsRecording())
+    Internal::RecordEvent(name, Internal::GetTimestamp(), 0);
+}
+
+/// Discards anything previously recorded, and starts recording.
+void Start();
+
+/// Stops recording, and writes the events which are still in the buffers to path.
+bool Stop(const char* path, Error* error);
+
+/// Names the calling thread in traces. Called by Threading::SetNameOfCurrentThread().
+void SetCurrentThreadName(const char* name);
+
+/// Records the time between construction and destruction. The name must be a string literal, since it is only
+/// stored as a pointer. When not recording, this costs a single load.
+class ScopedEvent
+{
+public:
+  ALWAYS_INLINE explicit ScopedEvent(const char* name)
+    : m_name(name), m_start_time(IsRecording() ? Internal::GetTimestamp() : 0)
+  {
+  }
+
+  ALWAYS_INLINE ~ScopedEvent()
+  {
+    if (m_start_time != 0)
+      Internal::RecordEvent(m_name, m_start_time, Internal::GetTimestamp());
+  }
+
+  ScopedEvent(const ScopedEvent&) = delete;
+  ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+  const char* m_name;
+  u64 m_start_time;
+};
+
+} // namespace TraceRecorder
+
+#define TRACE_SCOPE_CONCAT_(a, b) a##b
+#define TRACE_SCOPE_CONCAT(a, b) TRACE_SCOPE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceRecorder::ScopedEvent TRACE_SCOPE_CONCAT(trace_scope_, __LINE__)(name)
@@ -0,0 +1,38 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/types.h"
+
+#include <string>
+#include <vector>
+
+class Error;
+
+namespace Benchmarks {
+
+/// A single kernel measurement. Each sample calls run once, which performs ops operations on inputs generated from a
+/// fixed seed in setup, so every run of the benchmark executes the same work. The value run returns is folded into a
+/// checksum, which keeps the work from being optimized out, and changes if the kernel's output does.
+struct Benchmark
+{
+  const char* name;
+  u32 ops;
+  bool (*setup)(Error* error);
+  u64 (*run)();
+  void (*teardown)();
+};
+
+struct Options
+{
+  std::string chd_path;
+};
+
+void AddGTEBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options);
+void AddMDECBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options);
+void AddCDBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options);
+void AddGPUBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options);
+void AddStateWrapperBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options);
+
+} // namespace Benchmarks
@@ -0,0 +1,214 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+// The benchmarks never start a system, these only exist to satisfy the core's references to the host.
+
+#include "core/achievements.h"
+#include "core/game_list.h"
+#include "core/host.h"
+#include "core/system.h"
+
+#include "util/gpu_device.h"
+#include "util/input_manager.h"
+#include "util/platform_misc.h"
+
+#include "common/log.h"
+
+#include <cstring>
+
+Log_SetChannel(BenchmarkHost);
+
+void Host::ReportErrorAsync(const std::string_view& title, const std::string_view& message)
+{
+  Log_ErrorPrintf("ReportErrorAsync: %.*s: %.*s", static_cast<int>(title.size()), title.data(),
+                  static_cast<int>(message.size()), message.data());
+}
+
+bool Host::ConfirmMessage(const std::string_view& title, const std::string_view& message)
+{
+  Log_ErrorPrintf("ConfirmMessage: %.*s: %.*s", static_cast<int>(title.size()), title.data(),
+                  static_cast<int>(message.size()), message.data());
+  return true;
+}
+
+void Host::ReportDebuggerMessage(const std::string_view& message)
+{
+  Log_ErrorPrintf("ReportDebuggerMessage: %.*s", static_cast<int>(message.size()), message.data());
+}
+
+s32 Host::Internal::GetTranslatedStringImpl(const std::string_view& context, const std::string_view& msg, char* tbuf,
+                                            size_t tbuf_space)
+{
+  if (msg.size() > tbuf_space)
+    return -1;
+  else if (msg.empty())
+    return 0;
+
+  std::memcpy(tbuf, msg.data(), msg.size());
+  return static_cast<s32>(msg.size());
+}
+
+void Host::LoadSettings(SettingsInterface& si, std::unique_lock<std::mutex>& lock)
+{
+}
+
+void Host::CheckForSettingsChanges(const Settings& old_settings)
+{
+}
+
+void Host::CommitBaseSettingChanges()
+{
+}
+
+std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
+{
+  return std::nullopt;
+}
+
+std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
+{
+  return std::nullopt;
+}
+
+std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
+{
+  return std::nullopt;
+}
+
+void Host::OnSystemStarting()
+{
+}
+
+void Host::OnSystemStarted()
+{
+}
+
+void Host::OnSystemDestroyed()
+{
+}
+
+void Host::OnSystemPaused()
+{
+}
+
+void Host::OnSystemResumed()
+{
+}
+
+void Host::OnPerformanceCountersUpdated()
+{
+}
+
+void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name)
+{
+}
+
+void Host::PumpMessagesOnCPUThread()
+{
+}
+
+void Host::RunOnCPUThread(std::function<void()> function, bool block /* = false */)
+{
+  function();
+}
+
+void Host::RequestResizeHostDisplay(s32 width, s32 height)
+{
+}
+
+void Host::RequestExit(bool save_state_if_running)
+{
+}
+
+void Host::RequestSystemShutdown(bool allow_confirm, bool save_state)
+{
+}
+
+bool Host::IsFullscreen()
+{
+  return false;
+}
+
+void Host::SetFullscreen(bool enabled)
+{
+}
+
+std::optional<WindowInfo> Host::AcquireRenderWindow(bool recreate_window)
+{
+  return std::nullopt;
+}
+
+void Host::ReleaseRenderWindow()
+{
+}
+
+void Host::BeginPresentFrame()
+{
+}
+
+void Host::OpenURL(const std::string_view& url)
+{
+}
+
+bool Host::CopyTextToClipboard(const std::string_view& text)
+{
+  return false;
+}
+
+void Host::SetMouseMode(bool relative, bool hide_cursor)
+{
+}
+
+void Host::OnAchievementsLoginRequested(Achievements::LoginRequestReason reason)
+{
+}
+
+void Host::OnAchievementsLoginSuccess(const char* username, u32 points, u32 sc_points, u32 unread_messages)
+{
+}
+
+void Host::OnAchievementsRefreshed()
+{
+}
+
+void Host::OnAchievementsHardcoreModeChanged(bool enabled)
+{
+}
+
+std::optional<u32> InputManager::ConvertHostKeyboardStringToCode(const std::string_view& str)
+{
+  return std::nullopt;
+}
+
+std::optional<std::string> InputManager::ConvertHostKeyboardCodeToString(u32 code)
+{
+  return std::nullopt;
+}
+
+void Host::AddFixedInputBindings(SettingsInterface& si)
+{
+}
+
+void Host::OnInputDeviceConnected(const std::string_view& identifier, const std::string_view& device_name)
+{
+}
+
+void Host::OnInputDeviceDisconnected(const std::string_view& identifier)
+{
+}
+
+std::optional<WindowInfo> Host::GetTopLevelWindowInfo()
+{
+  return std::nullopt;
+}
+
+void Host::RefreshGameListAsync(bool invalidate_cache)
+{
+}
+
+void Host::CancelGameListRefresh()
+{
+}
+
+BEGIN_HOTKEY_LIST(g_host_hotkeys)
+END_HOTKEY_LIST()
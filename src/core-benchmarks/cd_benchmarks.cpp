@@ -0,0 +1,129 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "benchmark.h"
+
+#include "util/cd_image.h"
+#include "util/cd_xa.h"
+
+#include "common/error.h"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+
+namespace Benchmarks {
+
+static constexpr u32 XA_OPS = 2000;
+static constexpr u32 XA_NUM_SECTORS = 16;
+static constexpr u32 XA_CHUNK_SIZE = 128;
+static constexpr u32 XA_CHUNK_HEADER_SIZE = 16;
+static constexpr u32 XA_CHUNKS_PER_SECTOR = 18;
+
+static constexpr u32 CHD_OPS = 1000;
+
+static std::array<std::array<u8, CDImage::RAW_SECTOR_SIZE>, XA_NUM_SECTORS> s_xa_sectors;
+static std::array<s16, CDXA::XA_ADPCM_SAMPLES_PER_SECTOR_4BIT> s_xa_samples;
+
+static std::string s_chd_path;
+static std::unique_ptr<CDImage> s_chd_image;
+
+template<bool Stereo, bool EightBit>
+static bool SetupXA(Error* error)
+{
+  std::mt19937 rng(0x58414450);
+  for (std::array<u8, CDImage::RAW_SECTOR_SIZE>& sector : s_xa_sectors)
+  {
+    for (u8& value : sector)
+      value = static_cast<u8>(rng());
+
+    CDXA::XASubHeader subheader = {};
+    subheader.submode.audio = true;
+    subheader.submode.form2 = true;
+    subheader.codinginfo.mono_stereo = Stereo ? 1 : 0;
+    subheader.codinginfo.bits_per_sample = EightBit ? 1 : 0;
+    u8* subheader_ptr = sector.data() + CDImage::SECTOR_SYNC_SIZE + sizeof(CDImage::SectorHeader);
+    std::memcpy(subheader_ptr, &subheader, sizeof(subheader));
+    std::memcpy(subheader_ptr + sizeof(subheader), &subheader, sizeof(subheader));
+
+    // Real encoders only produce the valid filters, and keep the shift in range.
+    u8* chunk_ptr = subheader_ptr + sizeof(subheader) * 2;
+    for (u32 chunk = 0; chunk < XA_CHUNKS_PER_SECTOR; chunk++)
+    {
+      for (u32 i = 0; i < XA_CHUNK_HEADER_SIZE; i++)
+        chunk_ptr[chunk * XA_CHUNK_SIZE + i] = static_cast<u8>((rng() % 13) | ((rng() % 4) << 4));
+    }
+  }
+
+  return true;
+}
+
+static u64 RunXADecode()
+{
+  std::array<s32, 4> last_samples = {};
+  u64 checksum = 0;
+  for (u32 i = 0; i < XA_OPS; i++)
+  {
+    CDXA::DecodeADPCMSector(s_xa_sectors[i % XA_NUM_SECTORS].data(), s_xa_samples.data(), last_samples.data());
+    checksum += static_cast<u16>(s_xa_samples[i % s_xa_samples.size()]);
+  }
+
+  return checksum;
+}
+
+static bool SetupCHD(Error* error)
+{
+  s_chd_image = CDImage::OpenCHDImage(s_chd_path.c_str(), error);
+  if (!s_chd_image)
+    return false;
+
+  if (!s_chd_image->Seek(static_cast<CDImage::LBA>(0)))
+  {
+    Error::SetString(error, "Failed to seek to the start of the image.");
+    s_chd_image.reset();
+    return false;
+  }
+
+  return true;
+}
+
+// Reads carry on from where the last sample stopped, so the hunk cache doesn't hide the decompression.
+static u64 RunCHDRead()
+{
+  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
+  u64 checksum = 0;
+  for (u32 i = 0; i < CHD_OPS; i++)
+  {
+    if (!s_chd_image->ReadRawSector(sector.data(), nullptr))
+    {
+      s_chd_image->Seek(static_cast<CDImage::LBA>(0));
+      s_chd_image->ReadRawSector(sector.data(), nullptr);
+    }
+
+    checksum += sector[CDImage::SECTOR_SYNC_SIZE + sizeof(CDImage::SectorHeader) + (i % CDImage::DATA_SECTOR_SIZE)];
+  }
+
+  return checksum;
+}
+
+static void TeardownCHD()
+{
+  s_chd_image.reset();
+}
+
+void AddCDBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options)
+{
+  benchmarks->push_back({"xa/decode_4bit_stereo", XA_OPS, &SetupXA<true, false>, &RunXADecode, nullptr});
+  benchmarks->push_back({"xa/decode_4bit_mono", XA_OPS, &SetupXA<false, false>, &RunXADecode, nullptr});
+  benchmarks->push_back({"xa/decode_8bit_stereo", XA_OPS, &SetupXA<true, true>, &RunXADecode, nullptr});
+
+  // There's no way to make a representative CHD without an encoder, so this needs a real image.
+  if (!options.chd_path.empty())
+  {
+    s_chd_path = options.chd_path;
+    benchmarks->push_back({"chd/read_sectors", CHD_OPS, &SetupCHD, &RunCHDRead, &TeardownCHD});
+  }
+}
+
+} // namespace Benchmarks
@@ -0,0 +1,285 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "benchmark.h"
+
+#include "core/settings.h"
+
+#include "scmversion/scmversion.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include "common/timer.h"
+
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+Log_SetChannel(CoreBenchmarks);
+
+namespace CoreBenchmarks {
+namespace {
+struct Result
+{
+  const Benchmarks::Benchmark* benchmark;
+  std::vector<double> sample_ns;
+  u64 checksum;
+};
+} // namespace
+
+static bool ParseCommandLineParameters(int argc, char* argv[]);
+static void PrintCommandLineVersion();
+static void PrintCommandLineHelp(const char* progname);
+static bool RunBenchmark(const Benchmarks::Benchmark& benchmark, Result* result);
+static bool WriteResults(const std::vector<Result>& results);
+} // namespace CoreBenchmarks
+
+static Benchmarks::Options s_options;
+static std::string s_filter;
+static std::string s_output_path;
+static u32 s_repetitions = 10;
+static bool s_list_only = false;
+
+void CoreBenchmarks::PrintCommandLineVersion()
+{
+  std::fprintf(stderr, "DuckStation Core Benchmarks Version %s (%s)\n", g_scm_tag_str, g_scm_branch_str);
+  std::fprintf(stderr, "https://github.com/stenzek/duckstation\n");
+  std::fprintf(stderr, "\n");
+}
+
+void CoreBenchmarks::PrintCommandLineHelp(const char* progname)
+{
+  PrintCommandLineVersion();
+  std::fprintf(stderr, "Usage: %s [parameters]\n", progname);
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "  -help: Displays this information and exits.\n");
+  std::fprintf(stderr, "  -version: Displays version information and exits.\n");
+  std::fprintf(stderr, "  -list: Lists the benchmarks which would run, and exits.\n");
+  std::fprintf(stderr, "  -filter <text>: Only runs benchmarks with this text in their name.\n");
+  std::fprintf(stderr, "  -repeat <count>: Measures each benchmark this many times. Defaults to 10.\n");
+  std::fprintf(stderr, "  -output <path>: Writes the results as JSON to this file instead of stdout.\n");
+  std::fprintf(stderr, "  -chd <path>: Also measures reading sectors from this CHD image.\n");
+  std::fprintf(stderr, "\n");
+}
+
+bool CoreBenchmarks::ParseCommandLineParameters(int argc, char* argv[])
+{
+  for (int i = 1; i < argc; i++)
+  {
+#define CHECK_ARG(str) !std::strcmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) (!std::strcmp(argv[i], str) && ((i + 1) < argc))
+
+    if (CHECK_ARG("-help"))
+    {
+      PrintCommandLineHelp(argv[0]);
+      return false;
+    }
+    else if (CHECK_ARG("-version"))
+    {
+      PrintCommandLineVersion();
+      return false;
+    }
+    else if (CHECK_ARG("-list"))
+    {
+      s_list_only = true;
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-filter"))
+    {
+      s_filter = argv[++i];
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-repeat"))
+    {
+      s_repetitions = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+      if (s_repetitions == 0)
+      {
+        Log_ErrorPrintf("Invalid repeat count specified: %s", argv[i]);
+        return false;
+      }
+
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-output"))
+    {
+      s_output_path = argv[++i];
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-chd"))
+    {
+      s_options.chd_path = argv[++i];
+      continue;
+    }
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+
+    Log_ErrorPrintf("Unknown parameter: '%s'", argv[i]);
+    return false;
+  }
+
+  return true;
+}
+
+bool CoreBenchmarks::RunBenchmark(const Benchmarks::Benchmark& benchmark, Result* result)
+{
+  Error error;
+  if (benchmark.setup && !benchmark.setup(&error))
+  {
+    Log_ErrorPrintf("Failed to set up %s: %s", benchmark.name, error.GetDescription().c_str());
+    return false;
+  }
+
+  // The first sample warms the caches and branch predictors, and isn't measured. Its checksum is recorded instead of
+  // a later one, because some kernels keep changing their state, and the first is the same every run.
+  result->benchmark = &benchmark;
+  result->checksum = benchmark.run();
+  result->sample_ns.reserve(s_repetitions);
+  for (u32 i = 0; i < s_repetitions; i++)
+  {
+    const Common::Timer::Value start = Common::Timer::GetCurrentValue();
+    benchmark.run();
+    const Common::Timer::Value end = Common::Timer::GetCurrentValue();
+    result->sample_ns.push_back(Common::Timer::ConvertValueToNanoseconds(end - start) /
+                                static_cast<double>(benchmark.ops));
+  }
+
+  if (benchmark.teardown)
+    benchmark.teardown();
+
+  std::vector<double> sorted(result->sample_ns);
+  std::sort(sorted.begin(), sorted.end());
+  Log_InfoPrintf("%s: %.2f ns/op", benchmark.name, sorted[sorted.size() / 2]);
+  return true;
+}
+
+bool CoreBenchmarks::WriteResults(const std::vector<Result>& results)
+{
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+  writer.StartObject();
+  writer.Key("version");
+  writer.String(g_scm_tag_str);
+  writer.Key("repetitions");
+  writer.Uint(s_repetitions);
+
+  writer.Key("benchmarks");
+  writer.StartArray();
+  for (const Result& result : results)
+  {
+    std::vector<double> sorted(result.sample_ns);
+    std::sort(sorted.begin(), sorted.end());
+
+    double mean = 0.0;
+    for (const double value : sorted)
+      mean += value;
+    mean /= static_cast<double>(sorted.size());
+
+    double variance = 0.0;
+    for (const double value : sorted)
+      variance += (value - mean) * (value - mean);
+    variance /= static_cast<double>(sorted.size());
+
+    // Median of each sample's rate, less sensitive to a preempted sample than the mean.
+    const double median = sorted[sorted.size() / 2];
+
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(result.benchmark->name);
+    writer.Key("ops_per_sample");
+    writer.Uint(result.benchmark->ops);
+    writer.Key("ns_per_op");
+    writer.StartObject();
+    writer.Key("min");
+    writer.Double(sorted.front());
+    writer.Key("median");
+    writer.Double(median);
+    writer.Key("mean");
+    writer.Double(mean);
+    writer.Key("max");
+    writer.Double(sorted.back());
+    writer.Key("stddev");
+    writer.Double(std::sqrt(variance));
+    writer.EndObject();
+    writer.Key("ops_per_second");
+    writer.Double((median > 0.0) ? (1.0e9 / median) : 0.0);
+    writer.Key("checksum");
+    writer.Uint64(result.checksum);
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+
+  const std::string_view json(buffer.GetString(), buffer.GetSize());
+  if (s_output_path.empty())
+  {
+    std::fwrite(json.data(), json.size(), 1, stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+    return true;
+  }
+
+  if (!FileSystem::WriteStringToFile(s_output_path.c_str(), json))
+  {
+    Log_ErrorPrintf("Failed to write benchmark results to '%s'.", s_output_path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Benchmark results written to '%s'.", s_output_path.c_str());
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true);
+  Log::SetLogLevel(LOGLEVEL_INFO);
+
+  if (!CoreBenchmarks::ParseCommandLineParameters(argc, argv))
+    return EXIT_FAILURE;
+
+  // Everything runs on this thread, so results don't depend on how the workers get scheduled.
+  g_settings.gpu_use_thread = false;
+  g_settings.gpu_sw_worker_threads = 0;
+
+  std::vector<Benchmarks::Benchmark> benchmarks;
+  Benchmarks::AddGTEBenchmarks(&benchmarks, s_options);
+  Benchmarks::AddMDECBenchmarks(&benchmarks, s_options);
+  Benchmarks::AddCDBenchmarks(&benchmarks, s_options);
+  Benchmarks::AddGPUBenchmarks(&benchmarks, s_options);
+  Benchmarks::AddStateWrapperBenchmarks(&benchmarks, s_options);
+
+  if (!s_filter.empty())
+  {
+    benchmarks.erase(std::remove_if(benchmarks.begin(), benchmarks.end(),
+                                    [](const Benchmarks::Benchmark& benchmark) {
+                                      return std::strstr(benchmark.name, s_filter.c_str()) == nullptr;
+                                    }),
+                     benchmarks.end());
+  }
+
+  if (s_list_only)
+  {
+    for (const Benchmarks::Benchmark& benchmark : benchmarks)
+      std::fprintf(stdout, "%s\n", benchmark.name);
+    return EXIT_SUCCESS;
+  }
+
+  std::vector<CoreBenchmarks::Result> results;
+  results.reserve(benchmarks.size());
+  for (const Benchmarks::Benchmark& benchmark : benchmarks)
+  {
+    if (!CoreBenchmarks::RunBenchmark(benchmark, &results.emplace_back()))
+      return EXIT_FAILURE;
+  }
+
+  return CoreBenchmarks::WriteResults(results) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "benchmark.h"
+
+#include "core/gpu_sw_backend.h"
+
+#include "common/error.h"
+
+#include <array>
+#include <memory>
+#include <random>
+
+namespace Benchmarks {
+
+static constexpr u32 GPU_POLYGON_OPS = 5000;
+static constexpr u32 GPU_RECTANGLE_OPS = 20000;
+static constexpr u32 GPU_NUM_INPUTS = 1024;
+
+// Roughly the size of a character model's polygons at native resolution.
+static constexpr u32 GPU_MAX_POLYGON_SIZE = 48;
+static constexpr u16 GPU_RECTANGLE_SIZE = 16;
+
+// Drawing stays within a 320x240 display, and textures and palettes live off the right of it like games put them,
+// so the texels read are the same in every sample.
+static constexpr u32 GPU_DISPLAY_WIDTH = 320;
+static constexpr u32 GPU_DISPLAY_HEIGHT = 240;
+static constexpr u8 GPU_TEXTURE_PAGE_X = 5;
+static constexpr u16 GPU_PALETTE_X = 20;
+static constexpr u16 GPU_PALETTE_Y = 480;
+
+namespace {
+struct PolygonInput
+{
+  std::array<s32, 3> x;
+  std::array<s32, 3> y;
+  std::array<u32, 3> color;
+  std::array<u16, 3> texcoord;
+};
+} // namespace
+
+static std::unique_ptr<GPU_SW_Backend> s_sw_backend;
+static std::array<PolygonInput, GPU_NUM_INPUTS> s_polygon_inputs;
+
+static bool SetupGPUSW(Error* error)
+{
+  s_sw_backend = std::make_unique<GPU_SW_Backend>();
+  if (!s_sw_backend->Initialize(false))
+  {
+    Error::SetString(error, "Failed to initialize software renderer.");
+    s_sw_backend.reset();
+    return false;
+  }
+
+  // Random texels are almost never the transparent zero value, so every pixel gets shaded.
+  std::mt19937 rng(0x47505553);
+  u16* vram = s_sw_backend->GetVRAM();
+  for (u32 i = 0; i < VRAM_WIDTH * VRAM_HEIGHT; i++)
+    vram[i] = static_cast<u16>(rng());
+
+  for (PolygonInput& input : s_polygon_inputs)
+  {
+    const s32 base_x = static_cast<s32>(rng() % (GPU_DISPLAY_WIDTH - GPU_MAX_POLYGON_SIZE));
+    const s32 base_y = static_cast<s32>(rng() % (GPU_DISPLAY_HEIGHT - GPU_MAX_POLYGON_SIZE));
+    for (u32 i = 0; i < 3; i++)
+    {
+      input.x[i] = base_x + static_cast<s32>(rng() % GPU_MAX_POLYGON_SIZE);
+      input.y[i] = base_y + static_cast<s32>(rng() % GPU_MAX_POLYGON_SIZE);
+      input.color[i] = rng() & 0xFFFFFFu;
+      const u32 u = rng() % 256;
+      input.texcoord[i] = static_cast<u16>(u | ((rng() % 256) << 8));
+    }
+  }
+
+  GPUBackendSetDrawingAreaCommand* cmd = s_sw_backend->NewSetDrawingAreaCommand();
+  cmd->new_area = Common::Rectangle<u32>(0, 0, GPU_DISPLAY_WIDTH - 1, GPU_DISPLAY_HEIGHT - 1);
+  s_sw_backend->PushCommand(cmd);
+  return true;
+}
+
+static void TeardownGPUSW()
+{
+  s_sw_backend->Shutdown();
+  s_sw_backend.reset();
+}
+
+static void FillDrawCommand(GPUBackendDrawCommand* cmd, GPUPrimitive primitive, bool shaded, bool textured,
+                            GPUTextureMode texture_mode, bool transparent)
+{
+  cmd->params.bits = 0;
+  cmd->rc.bits = 0;
+  cmd->rc.primitive = primitive;
+  cmd->rc.shading_enable = shaded;
+  cmd->rc.texture_enable = textured;
+  cmd->rc.transparency_enable = transparent;
+  cmd->rc.color_for_first_vertex = 0x808080;
+  cmd->draw_mode.bits = 0;
+  cmd->draw_mode.texture_page_x_base = GPU_TEXTURE_PAGE_X;
+  cmd->draw_mode.texture_mode = texture_mode;
+  cmd->draw_mode.transparency_mode = GPUTransparencyMode::HalfBackgroundPlusHalfForeground;
+  cmd->draw_mode.dither_enable = true;
+  cmd->palette.bits = 0;
+  cmd->palette.x = GPU_PALETTE_X;
+  cmd->palette.y = GPU_PALETTE_Y;
+  cmd->window = {0xFF, 0xFF, 0x00, 0x00};
+}
+
+static u64 GetVRAMChecksum()
+{
+  const u16* vram = s_sw_backend->GetVRAM();
+  u64 checksum = 0;
+  for (u32 y = 0; y < GPU_DISPLAY_HEIGHT; y++)
+  {
+    for (u32 x = 0; x < GPU_DISPLAY_WIDTH; x++)
+      checksum += vram[y * VRAM_WIDTH + x];
+  }
+
+  return checksum;
+}
+
+template<bool Shaded, bool Textured, GPUTextureMode TextureMode, bool Transparent>
+static u64 RunDrawTriangles()
+{
+  for (u32 i = 0; i < GPU_POLYGON_OPS; i++)
+  {
+    const PolygonInput& input = s_polygon_inputs[i % GPU_NUM_INPUTS];
+    GPUBackendDrawPolygonCommand* cmd = s_sw_backend->NewDrawPolygonCommand(3);
+    FillDrawCommand(cmd, GPUPrimitive::Polygon, Shaded, Textured, TextureMode, Transparent);
+    for (u32 j = 0; j < 3; j++)
+    {
+      cmd->vertices[j].Set(input.x[j], input.y[j], Shaded ? input.color[j] : input.color[0],
+                           Textured ? input.texcoord[j] : 0);
+    }
+
+    s_sw_backend->PushCommand(cmd);
+  }
+
+  s_sw_backend->Sync(true);
+  return GetVRAMChecksum();
+}
+
+static u64 RunDrawSprites()
+{
+  for (u32 i = 0; i < GPU_RECTANGLE_OPS; i++)
+  {
+    const PolygonInput& input = s_polygon_inputs[i % GPU_NUM_INPUTS];
+    GPUBackendDrawRectangleCommand* cmd = s_sw_backend->NewDrawRectangleCommand();
+    FillDrawCommand(cmd, GPUPrimitive::Rectangle, false, true, GPUTextureMode::Palette4Bit, false);
+    cmd->x = input.x[0];
+    cmd->y = input.y[0];
+    cmd->width = GPU_RECTANGLE_SIZE;
+    cmd->height = GPU_RECTANGLE_SIZE;
+    cmd->texcoord = input.texcoord[0];
+    cmd->color = cmd->rc.color_for_first_vertex;
+    s_sw_backend->PushCommand(cmd);
+  }
+
+  s_sw_backend->Sync(true);
+  return GetVRAMChecksum();
+}
+
+void AddGPUBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options)
+{
+  static constexpr GPUTextureMode NoTexture = GPUTextureMode::Direct16Bit;
+  benchmarks->push_back({"gpu_sw/triangle_flat", GPU_POLYGON_OPS, &SetupGPUSW,
+                         &RunDrawTriangles<false, false, NoTexture, false>, &TeardownGPUSW});
+  benchmarks->push_back({"gpu_sw/triangle_gouraud", GPU_POLYGON_OPS, &SetupGPUSW,
+                         &RunDrawTriangles<true, false, NoTexture, false>, &TeardownGPUSW});
+  benchmarks->push_back({"gpu_sw/triangle_textured_4bit", GPU_POLYGON_OPS, &SetupGPUSW,
+                         &RunDrawTriangles<true, true, GPUTextureMode::Palette4Bit, false>, &TeardownGPUSW});
+  benchmarks->push_back({"gpu_sw/triangle_textured_16bit_blended", GPU_POLYGON_OPS, &SetupGPUSW,
+                         &RunDrawTriangles<true, true, GPUTextureMode::Direct16Bit, true>, &TeardownGPUSW});
+  benchmarks->push_back({"gpu_sw/sprite_4bit", GPU_RECTANGLE_OPS, &SetupGPUSW, &RunDrawSprites, &TeardownGPUSW});
+}
+
+} // namespace Benchmarks
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "benchmark.h"
+
+#include "core/gte.h"
+
+#include <array>
+#include <random>
+
+namespace Benchmarks {
+
+static constexpr u32 GTE_OPS = 100000;
+static constexpr u32 GTE_NUM_INPUTS = 1024;
+
+// Command words as games issue them, with sf set, so results are fixed-point.
+static constexpr u32 GTE_RTPT = 0x0280030;
+static constexpr u32 GTE_NCLIP = 0x1400006;
+static constexpr u32 GTE_AVSZ3 = 0x158002D;
+static constexpr u32 GTE_NCDT = 0x0F80416;
+static constexpr u32 GTE_NCCT = 0x118043F;
+static constexpr u32 GTE_MVMVA_RT_V0_TR = 0x0480012;
+
+// Data registers 0-5 hold V0-V2, written before each command like a game's mtc2s would.
+static std::array<std::array<u32, 6>, GTE_NUM_INPUTS> s_gte_inputs;
+
+static bool SetupGTE(Error* error)
+{
+  GTE::Initialize();
+
+  // Model-space vertices within +/-1024, z in front of the camera after translation.
+  std::mt19937 rng(0x47544530);
+  const auto coordinate = [&rng]() { return static_cast<u32>(static_cast<s32>(rng() % 2048) - 1024) & 0xFFFFu; };
+  for (std::array<u32, 6>& input : s_gte_inputs)
+  {
+    for (u32 i = 0; i < 6; i++)
+    {
+      // Separate statements, so the order values are drawn in doesn't depend on the compiler.
+      const u32 low = coordinate();
+      input[i] = low | (coordinate() << 16);
+    }
+  }
+
+  // Rotation close to identity in 4.12, a translation which puts the model in view, and typical projection setup.
+  static constexpr std::array<std::pair<u32, u32>, 24> control_regs = {{
+    {32, 0x00000F80}, {33, 0x00000100}, {34, 0x0F80FF00}, {35, 0x00000100}, {36, 0x00000F80},
+    {37, 0},          {38, 0},          {39, 4096},       {40, 0x08000800}, {41, 0x08000800},
+    {42, 0x08000800}, {43, 0x08000800}, {44, 0x00000800}, {45, 0x200},      {46, 0x200},
+    {47, 0x200},      {48, 0x10000000}, {49, 0x00001000}, {50, 0x10000000}, {51, 0x00001000},
+    {52, 0x1000},     {56, 160 << 16},  {57, 120 << 16},  {58, 300},
+  }};
+  for (const auto& [index, value] : control_regs)
+    GTE::WriteRegister(index, value);
+  GTE::WriteRegister(59, static_cast<u32>(-0x10A2 & 0xFFFF));
+  GTE::WriteRegister(60, 0x01400000);
+  GTE::WriteRegister(61, 0x155);
+  GTE::WriteRegister(62, 0x100);
+
+  // Vertex colour for the lighting commands.
+  GTE::WriteRegister(6, 0x30808080);
+  return true;
+}
+
+template<u32 Command>
+static u64 RunGTECommand()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < GTE_OPS; i++)
+  {
+    const std::array<u32, 6>& input = s_gte_inputs[i % GTE_NUM_INPUTS];
+    for (u32 j = 0; j < 6; j++)
+      GTE::WriteRegister(j, input[j]);
+
+    GTE::ExecuteInstruction(Command);
+
+    // SXY2 for the geometry commands, RGB2 for lighting, MAC1 for MVMVA.
+    checksum += GTE::ReadRegister(14) + GTE::ReadRegister(22) + GTE::ReadRegister(25);
+  }
+
+  return checksum;
+}
+
+// NCLIP and AVSZ3 consume RTPT's results, so they're measured as the usual per-polygon sequence.
+static u64 RunGTETransformPolygon()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < GTE_OPS; i++)
+  {
+    const std::array<u32, 6>& input = s_gte_inputs[i % GTE_NUM_INPUTS];
+    for (u32 j = 0; j < 6; j++)
+      GTE::WriteRegister(j, input[j]);
+
+    GTE::ExecuteInstruction(GTE_RTPT);
+    GTE::ExecuteInstruction(GTE_NCLIP);
+    GTE::ExecuteInstruction(GTE_AVSZ3);
+    checksum += GTE::ReadRegister(24) + GTE::ReadRegister(7);
+  }
+
+  return checksum;
+}
+
+void AddGTEBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options)
+{
+  benchmarks->push_back({"gte/rtpt", GTE_OPS, &SetupGTE, &RunGTECommand<GTE_RTPT>, nullptr});
+  benchmarks->push_back({"gte/ncdt", GTE_OPS, &SetupGTE, &RunGTECommand<GTE_NCDT>, nullptr});
+  benchmarks->push_back({"gte/ncct", GTE_OPS, &SetupGTE, &RunGTECommand<GTE_NCCT>, nullptr});
+  benchmarks->push_back({"gte/mvmva", GTE_OPS, &SetupGTE, &RunGTECommand<GTE_MVMVA_RT_V0_TR>, nullptr});
+  benchmarks->push_back({"gte/rtpt_nclip_avsz3", GTE_OPS, &SetupGTE, &RunGTETransformPolygon, nullptr});
+}
+
+} // namespace Benchmarks
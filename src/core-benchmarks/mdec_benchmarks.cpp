@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "benchmark.h"
+
+#include "core/mdec_kernels.h"
+
+#include <array>
+#include <random>
+
+namespace Benchmarks {
+
+using namespace MDEC::Kernels;
+
+static constexpr u32 MDEC_OPS = 20000;
+static constexpr u32 MDEC_NUM_BLOCKS = 256;
+
+static IDCTTable s_idct_table;
+alignas(16) static std::array<std::array<s16, 64>, MDEC_NUM_BLOCKS> s_mdec_coefficients;
+alignas(16) static std::array<std::array<s16, 64>, MDEC_NUM_BLOCKS> s_mdec_blocks;
+alignas(16) static std::array<u32, 256> s_mdec_rgb;
+alignas(16) static std::array<u32, 128> s_mdec_words;
+
+static bool SetupMDEC(Error* error)
+{
+  std::mt19937 rng(0x4D444543);
+
+  // The BIOS default quantization table is all positive, and within this range.
+  std::array<s16, 64> scale_table;
+  for (s16& value : scale_table)
+    value = static_cast<s16>(rng() % 0x5A83);
+  BuildIDCTTable(&s_idct_table, scale_table.data());
+
+  // Mostly sparse like real data, with a DC coefficient in every block.
+  for (std::array<s16, 64>& blk : s_mdec_coefficients)
+  {
+    for (u32 i = 0; i < 64; i++)
+    {
+      if (i == 0 || (rng() % 4) == 0)
+        blk[i] = static_cast<s16>(static_cast<s32>(rng() % 0x800) - 0x400);
+      else
+        blk[i] = 0;
+    }
+  }
+
+  // Decoded blocks for colour conversion, already in the signed range the IDCT produces.
+  for (std::array<s16, 64>& blk : s_mdec_blocks)
+  {
+    for (s16& value : blk)
+      value = static_cast<s16>(static_cast<s32>(rng() % 256) - 128);
+  }
+
+  return true;
+}
+
+static u64 RunIDCT()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < MDEC_OPS; i++)
+  {
+    alignas(16) std::array<s16, 64> blk = s_mdec_coefficients[i % MDEC_NUM_BLOCKS];
+    IDCT(blk.data(), s_idct_table);
+    checksum += static_cast<u16>(blk[i % 64]);
+  }
+
+  return checksum;
+}
+
+// One macroblock is the Cr and Cb blocks, and four Y blocks.
+static u64 RunYUVToRGB()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < MDEC_OPS; i++)
+  {
+    const s16* cr = s_mdec_blocks[(i * 6) % MDEC_NUM_BLOCKS].data();
+    const s16* cb = s_mdec_blocks[(i * 6 + 1) % MDEC_NUM_BLOCKS].data();
+    for (u32 block = 0; block < 4; block++)
+    {
+      const s16* y = s_mdec_blocks[(i * 6 + 2 + block) % MDEC_NUM_BLOCKS].data();
+      YUVToRGB(s_mdec_rgb.data(), (block & 1) * 8, (block >> 1) * 8, cr, cb, y, 0x80);
+    }
+
+    checksum += s_mdec_rgb[i % 256];
+  }
+
+  return checksum;
+}
+
+static u64 RunPackRGB15()
+{
+  const s16* cr = s_mdec_blocks[0].data();
+  const s16* cb = s_mdec_blocks[1].data();
+  for (u32 block = 0; block < 4; block++)
+    YUVToRGB(s_mdec_rgb.data(), (block & 1) * 8, (block >> 1) * 8, cr, cb, s_mdec_blocks[2 + block].data(), 0x80);
+
+  u64 checksum = 0;
+  for (u32 i = 0; i < MDEC_OPS; i++)
+  {
+    PackRGB15(s_mdec_words.data(), s_mdec_rgb.data(), (i & 1) ? 0x8000 : 0);
+    checksum += s_mdec_words[i % 128];
+  }
+
+  return checksum;
+}
+
+void AddMDECBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options)
+{
+  benchmarks->push_back({"mdec/idct", MDEC_OPS, &SetupMDEC, &RunIDCT, nullptr});
+  benchmarks->push_back({"mdec/yuv_to_rgb", MDEC_OPS, &SetupMDEC, &RunYUVToRGB, nullptr});
+  benchmarks->push_back({"mdec/pack_rgb15", MDEC_OPS, &SetupMDEC, &RunPackRGB15, nullptr});
+}
+
+} // namespace Benchmarks
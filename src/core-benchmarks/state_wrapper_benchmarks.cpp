@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "benchmark.h"
+
+#include "util/state_wrapper.h"
+
+#include "common/byte_stream.h"
+#include "common/error.h"
+#include "common/heap_array.h"
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace Benchmarks {
+
+static constexpr u32 STATE_OPS = 20;
+static constexpr u32 STATE_VERSION = 1;
+
+// Shaped like a save state: the big memories, then many devices made of a few hundred small fields each.
+static constexpr u32 STATE_RAM_SIZE = 2 * 1024 * 1024;
+static constexpr u32 STATE_VRAM_SIZE = 1024 * 512 * sizeof(u16);
+static constexpr u32 STATE_SPU_RAM_SIZE = 512 * 1024;
+static constexpr u32 STATE_NUM_DEVICES = 16;
+static constexpr u32 STATE_DEVICE_FIELDS = 256;
+
+namespace {
+struct DeviceRegisters
+{
+  std::array<u32, 64> words;
+  std::array<u16, 32> halfwords;
+};
+
+struct DeviceState
+{
+  DeviceRegisters registers;
+  std::array<u32, STATE_DEVICE_FIELDS> u32_fields;
+  std::array<u8, STATE_DEVICE_FIELDS> u8_fields;
+  std::array<bool, STATE_DEVICE_FIELDS> bool_fields;
+  std::vector<u32> fifo;
+};
+} // namespace
+
+static FixedHeapArray<u8, STATE_RAM_SIZE> s_state_ram;
+static FixedHeapArray<u8, STATE_VRAM_SIZE> s_state_vram;
+static FixedHeapArray<u8, STATE_SPU_RAM_SIZE> s_state_spu_ram;
+static std::array<DeviceState, STATE_NUM_DEVICES> s_state_devices;
+static std::string s_state_serial;
+
+static std::vector<u8> s_state_buffer;
+static std::unique_ptr<GrowableMemoryByteStream> s_state_stream;
+
+static void DoBenchmarkState(StateWrapper& sw)
+{
+  sw.Do(&s_state_serial);
+  sw.DoBytes(s_state_ram.data(), s_state_ram.size());
+  sw.DoBytes(s_state_vram.data(), s_state_vram.size());
+  sw.DoBytes(s_state_spu_ram.data(), s_state_spu_ram.size());
+
+  // Fields are done one at a time, as the devices do.
+  for (DeviceState& device : s_state_devices)
+  {
+    sw.DoPOD(&device.registers);
+    for (u32 i = 0; i < STATE_DEVICE_FIELDS; i++)
+    {
+      sw.Do(&device.u32_fields[i]);
+      sw.Do(&device.u8_fields[i]);
+      sw.Do(&device.bool_fields[i]);
+    }
+
+    sw.Do(&device.fifo);
+  }
+}
+
+static bool SetupStateWrapper(Error* error)
+{
+  std::mt19937 rng(0x53544154);
+  for (u8& value : s_state_ram)
+    value = static_cast<u8>(rng());
+  for (u8& value : s_state_vram)
+    value = static_cast<u8>(rng());
+  for (u8& value : s_state_spu_ram)
+    value = static_cast<u8>(rng());
+
+  for (DeviceState& device : s_state_devices)
+  {
+    for (u32& value : device.registers.words)
+      value = rng();
+    for (u16& value : device.registers.halfwords)
+      value = static_cast<u16>(rng());
+    for (u32 i = 0; i < STATE_DEVICE_FIELDS; i++)
+    {
+      device.u32_fields[i] = rng();
+      device.u8_fields[i] = static_cast<u8>(rng());
+      device.bool_fields[i] = (rng() & 1) != 0;
+    }
+
+    device.fifo.resize(rng() % 64);
+    for (u32& value : device.fifo)
+      value = rng();
+  }
+
+  s_state_serial = "SLUS-00000";
+
+  // Sized by a first save, so the measured saves never grow the buffer.
+  s_state_stream = ByteStream::CreateGrowableMemoryStream();
+  StateWrapper sw(s_state_stream.get(), StateWrapper::Mode::Write, STATE_VERSION);
+  DoBenchmarkState(sw);
+  if (sw.HasError())
+  {
+    Error::SetString(error, "Failed to size state.");
+    return false;
+  }
+
+  s_state_buffer.resize(static_cast<size_t>(s_state_stream->GetSize()));
+  std::memcpy(s_state_buffer.data(), s_state_stream->GetMemoryPointer(), s_state_buffer.size());
+  return true;
+}
+
+static void TeardownStateWrapper()
+{
+  s_state_buffer = {};
+  s_state_stream.reset();
+}
+
+static u64 RunSaveMemory()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < STATE_OPS; i++)
+  {
+    StateWrapper sw(s_state_buffer.data(), s_state_buffer.size(), StateWrapper::Mode::Write, STATE_VERSION);
+    DoBenchmarkState(sw);
+    checksum += sw.GetPosition() + s_state_buffer[i];
+  }
+
+  return checksum;
+}
+
+static u64 RunLoadMemory()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < STATE_OPS; i++)
+  {
+    StateWrapper sw(s_state_buffer.data(), s_state_buffer.size(), StateWrapper::Mode::Read, STATE_VERSION);
+    DoBenchmarkState(sw);
+    checksum += sw.GetPosition() + s_state_ram[i] + s_state_devices[i % STATE_NUM_DEVICES].u32_fields[i];
+  }
+
+  return checksum;
+}
+
+static u64 RunSaveStream()
+{
+  u64 checksum = 0;
+  for (u32 i = 0; i < STATE_OPS; i++)
+  {
+    s_state_stream->SeekAbsolute(0);
+    StateWrapper sw(s_state_stream.get(), StateWrapper::Mode::Write, STATE_VERSION);
+    DoBenchmarkState(sw);
+    checksum += sw.GetPosition();
+  }
+
+  return checksum;
+}
+
+void AddStateWrapperBenchmarks(std::vector<Benchmark>* benchmarks, const Options& options)
+{
+  benchmarks->push_back({"state_wrapper/save_memory", STATE_OPS, &SetupStateWrapper, &RunSaveMemory,
+                         &TeardownStateWrapper});
+  benchmarks->push_back({"state_wrapper/load_memory", STATE_OPS, &SetupStateWrapper, &RunLoadMemory,
+                         &TeardownStateWrapper});
+  benchmarks->push_back({"state_wrapper/save_stream", STATE_OPS, &SetupStateWrapper, &RunSaveStream,
+                         &TeardownStateWrapper});
+}
+
+} // namespace Benchmarks
@@ -596,6 +596,13 @@ void Achievements::ClientMessageCallback(const char* message, const rc_client_t*
 
 uint32_t Achievements::ClientReadMemory(uint32_t address, uint8_t* buffer, uint32_t num_bytes, rc_client_t* client)
 {
+  // Nearly every peek is to RAM, which can be read directly instead of going through the bus.
+  if (address < Bus::g_ram_size && num_bytes <= (Bus::g_ram_size - address))
+  {
+    std::memcpy(buffer, &Bus::g_unprotected_ram[address], num_bytes);
+    return num_bytes;
+  }
+
   switch (num_bytes)
   {
     case 1:
@@ -4,6 +4,7 @@
 #include "bios.h"
 #include "common/assert.h"
 #include "common/file_system.h"
+#include "common/heterogeneous_containers.h"
 #include "common/log.h"
 #include "common/md5_digest.h"
 #include "common/path.h"
@@ -11,8 +12,21 @@
 #include "host.h"
 #include "settings.h"
 #include <cerrno>
+#include <mutex>
 Log_SetChannel(BIOS);
 
+namespace BIOS {
+struct CachedImageHash
+{
+  s64 size;
+  std::time_t modification_time;
+  Hash hash;
+};
+
+static std::mutex s_image_hash_cache_mutex;
+static PreferUnorderedStringMap<CachedImageHash> s_image_hash_cache;
+} // namespace BIOS
+
 static constexpr BIOS::Hash MakeHashFromString(const char str[])
 {
   BIOS::Hash h{};
@@ -104,7 +118,7 @@ BIOS::Hash BIOS::GetImageHash(const BIOS::Image& image)
   return hash;
 }
 
-std::optional<BIOS::Image> BIOS::LoadImageFromFile(const char* filename)
+std::optional<BIOS::Image> BIOS::LoadImageFromFile(const char* filename, Hash* hash)
 {
   Image ret(BIOS_SIZE);
   auto fp = FileSystem::OpenManagedCFile(filename, "rb");
@@ -114,9 +128,14 @@ std::optional<BIOS::Image> BIOS::LoadImageFromFile(const char* filename)
     return std::nullopt;
   }
 
-  std::fseek(fp.get(), 0, SEEK_END);
-  const u32 size = static_cast<u32>(std::ftell(fp.get()));
-  std::fseek(fp.get(), 0, SEEK_SET);
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(fp.get(), &sd))
+  {
+    Log_ErrorPrintf("Failed to stat BIOS image '%s'", filename);
+    return std::nullopt;
+  }
+
+  const u32 size = static_cast<u32>(sd.Size);
 
   if (size != BIOS_SIZE && size != BIOS_SIZE_PS2 && size != BIOS_SIZE_PS3)
   {
@@ -131,9 +150,32 @@ std::optional<BIOS::Image> BIOS::LoadImageFromFile(const char* filename)
     return std::nullopt;
   }
 
-  Log_DevPrint(
-    fmt::format("Hash for BIOS '{}': {}", FileSystem::GetDisplayNameFromPath(filename), GetImageHash(ret).ToString())
-      .c_str());
+  // The scans below load every image in the directory each time a game starts, these are the same files every time.
+  Hash image_hash;
+  std::unique_lock lock(s_image_hash_cache_mutex);
+  auto iter = s_image_hash_cache.find(filename);
+  if (iter != s_image_hash_cache.end() && iter->second.size == sd.Size &&
+      iter->second.modification_time == sd.ModificationTime)
+  {
+    image_hash = iter->second.hash;
+  }
+  else
+  {
+    image_hash = GetImageHash(ret);
+    const CachedImageHash cached = {sd.Size, sd.ModificationTime, image_hash};
+    if (iter != s_image_hash_cache.end())
+      iter->second = cached;
+    else
+      s_image_hash_cache.emplace(filename, cached);
+
+    Log_DevPrintf("Hash for BIOS '%s': %s", FileSystem::GetDisplayNameFromPath(filename).c_str(),
+                  image_hash.ToString().c_str());
+  }
+  lock.unlock();
+
+  if (hash)
+    *hash = image_hash;
+
   return ret;
 }
 
@@ -266,7 +308,7 @@ DiscRegion BIOS::GetPSExeDiscRegion(const PSEXEHeader& header)
     return DiscRegion::Other;
 }
 
-std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region)
+std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region, Hash* hash)
 {
   std::string bios_name;
   switch (region)
@@ -288,11 +330,12 @@ std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region)
   if (bios_name.empty())
   {
     // auto-detect
-    return FindBIOSImageInDirectory(region, EmuFolders::Bios.c_str());
+    return FindBIOSImageInDirectory(region, EmuFolders::Bios.c_str(), hash);
   }
 
   // try the configured path
-  std::optional<Image> image = LoadImageFromFile(Path::Combine(EmuFolders::Bios, bios_name).c_str());
+  Hash image_hash;
+  std::optional<Image> image = LoadImageFromFile(Path::Combine(EmuFolders::Bios, bios_name).c_str(), &image_hash);
   if (!image.has_value())
   {
     Host::ReportFormattedErrorAsync("Error", TRANSLATE("HostInterface", "Failed to load configured BIOS file '%s'"),
@@ -300,14 +343,18 @@ std::optional<std::vector<u8>> BIOS::GetBIOSImage(ConsoleRegion region)
     return std::nullopt;
   }
 
-  const ImageInfo* ii = GetInfoForImage(image.value());
+  if (hash)
+    *hash = image_hash;
+
+  const ImageInfo* ii = GetInfoForImage(image.value(), image_hash);
   if (!ii || !IsValidBIOSForRegion(region, ii->region))
     Log_WarningPrintf("BIOS '%s' does not match region. This may cause issues.", bios_name.c_str());
 
   return image;
 }
 
-std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion region, const char* directory)
+std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion region, const char* directory,
+                                                               Hash* hash)
 {
   Log_InfoPrintf("Searching for a %s BIOS in '%s'...", Settings::GetConsoleRegionDisplayName(region), directory);
 
@@ -318,6 +365,7 @@ std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion regi
   std::string fallback_path;
   std::optional<Image> fallback_image;
   const ImageInfo* fallback_info = nullptr;
+  Hash fallback_hash = {};
 
   for (const FILESYSTEM_FIND_DATA& fd : results)
   {
@@ -328,14 +376,17 @@ std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion regi
     }
 
     std::string full_path(Path::Combine(directory, fd.FileName));
-    std::optional<Image> found_image = LoadImageFromFile(full_path.c_str());
+    Hash found_hash;
+    std::optional<Image> found_image = LoadImageFromFile(full_path.c_str(), &found_hash);
     if (!found_image)
       continue;
 
-    const ImageInfo* ii = GetInfoForImage(found_image.value());
+    const ImageInfo* ii = GetInfoForImage(found_image.value(), found_hash);
     if (ii && IsValidBIOSForRegion(region, ii->region))
     {
       Log_InfoPrintf("Using BIOS '%s': %s", fd.FileName.c_str(), ii->description);
+      if (hash)
+        *hash = found_hash;
       return found_image;
     }
 
@@ -346,6 +397,7 @@ std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion regi
     fallback_path = std::move(full_path);
     fallback_image = std::move(found_image);
     fallback_info = ii;
+    fallback_hash = found_hash;
   }
 
   if (!fallback_image.has_value())
@@ -365,6 +417,9 @@ std::optional<std::vector<u8>> BIOS::FindBIOSImageInDirectory(ConsoleRegion regi
                       fallback_info->description);
   }
 
+  if (hash)
+    *hash = fallback_hash;
+
   return fallback_image;
 }
 
@@ -382,11 +437,11 @@ std::string BIOS::FindBIOSPathWithHash(const char* directory, const Hash& hash)
       continue;
 
     std::string full_path(Path::Combine(directory, fd.FileName));
-    std::optional<Image> found_image = LoadImageFromFile(full_path.c_str());
+    BIOS::Hash found_hash;
+    std::optional<Image> found_image = LoadImageFromFile(full_path.c_str(), &found_hash);
     if (!found_image)
       continue;
 
-    const BIOS::Hash found_hash = GetImageHash(found_image.value());
     if (found_hash == hash)
     {
       ret = std::move(full_path);
@@ -411,11 +466,12 @@ std::vector<std::pair<std::string, const BIOS::ImageInfo*>> BIOS::FindBIOSImages
       continue;
 
     std::string full_path(Path::Combine(directory, fd.FileName));
-    std::optional<Image> found_image = LoadImageFromFile(full_path.c_str());
+    Hash found_hash;
+    std::optional<Image> found_image = LoadImageFromFile(full_path.c_str(), &found_hash);
     if (!found_image)
       continue;
 
-    const ImageInfo* ii = GetInfoForImage(found_image.value());
+    const ImageInfo* ii = GetInfoForImage(found_image.value(), found_hash);
     results.emplace_back(std::move(fd.FileName), ii);
   }
 
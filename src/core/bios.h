@@ -58,7 +58,9 @@ struct PSEXEHeader
 static_assert(sizeof(PSEXEHeader) == 0x800);
 #pragma pack(pop)
 
-std::optional<Image> LoadImageFromFile(const char* filename);
+/// Loads an image, and optionally returns its hash. Hashes are remembered for each file until its size or modification
+/// time changes, so loading the same BIOS again doesn't hash it again.
+std::optional<Image> LoadImageFromFile(const char* filename, Hash* hash = nullptr);
 Hash GetImageHash(const Image& image);
 
 const ImageInfo* GetInfoForImage(const Image& image);
@@ -74,11 +76,12 @@ bool IsValidPSExeHeader(const PSEXEHeader& header, u32 file_size);
 DiscRegion GetPSExeDiscRegion(const PSEXEHeader& header);
 
 /// Loads the BIOS image for the specified region.
-std::optional<std::vector<u8>> GetBIOSImage(ConsoleRegion region);
+std::optional<std::vector<u8>> GetBIOSImage(ConsoleRegion region, Hash* hash = nullptr);
 
 /// Searches for a BIOS image for the specified region in the specified directory. If no match is found, the first
 /// BIOS image within 512KB and 4MB will be used.
-std::optional<std::vector<u8>> FindBIOSImageInDirectory(ConsoleRegion region, const char* directory);
+std::optional<std::vector<u8>> FindBIOSImageInDirectory(ConsoleRegion region, const char* directory,
+                                                        Hash* hash = nullptr);
 
 /// Returns a BIOS image which matches the specified hash.
 std::string FindBIOSPathWithHash(const char* directory, const BIOS::Hash& hash);
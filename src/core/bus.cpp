@@ -28,9 +28,14 @@
 #include "common/log.h"
 #include "common/memmap.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 Log_SetChannel(Bus);
 
@@ -114,6 +119,12 @@ u8* g_bios = nullptr;
 void** g_memory_handlers = nullptr;
 void** g_memory_handlers_isc = nullptr;
 
+// First level of the handler LUTs, normal and isolated. Second level pages are only created for regions with
+// something mapped, the rest point at the shared unmapped pages.
+static std::array<void*, MEMORY_LUT_SLOTS * 2> s_memory_lut_regions;
+static std::array<std::array<void*, MEMORY_LUT_REGION_PAGES>, 3 * 2> s_unmapped_handler_pages; // [size][read_write]
+static std::vector<std::unique_ptr<void*[]>> s_memory_lut_pages;
+
 std::array<TickCount, 3> g_exp1_access_time = {};
 std::array<TickCount, 3> g_exp2_access_time = {};
 std::array<TickCount, 3> g_bios_access_time = {};
@@ -148,7 +159,10 @@ static void SetRAMPageWritable(u32 page_index, bool writable);
 static void SetHandlers();
 
 template<typename FP>
-static FP* OffsetHandlerArray(void** handlers, MemoryAccessSize size, MemoryAccessType type);
+static FP* GetWritableHandlerPage(void** handlers, MemoryAccessSize size, MemoryAccessType type, u32 region);
+template<typename FP>
+static void SetHandlerPages(void** handlers, MemoryAccessSize size, MemoryAccessType type, u32 start_page,
+                            u32 num_pages, FP handler);
 } // namespace Bus
 
 namespace MemoryMap {
@@ -156,9 +170,7 @@ static constexpr size_t RAM_OFFSET = 0;
 static constexpr size_t RAM_SIZE = Bus::RAM_8MB_SIZE;
 static constexpr size_t BIOS_OFFSET = RAM_OFFSET + RAM_SIZE;
 static constexpr size_t BIOS_SIZE = Bus::BIOS_SIZE;
-static constexpr size_t LUT_OFFSET = BIOS_OFFSET + BIOS_SIZE;
-static constexpr size_t LUT_SIZE = (sizeof(void*) * Bus::MEMORY_LUT_SLOTS) * 2; // normal and isolated
-static constexpr size_t TOTAL_SIZE = LUT_OFFSET + LUT_SIZE;
+static constexpr size_t TOTAL_SIZE = BIOS_OFFSET + BIOS_SIZE;
 } // namespace MemoryMap
 
 #define FIXUP_HALFWORD_OFFSET(size, offset) ((size >= MemoryAccessSize::HalfWord) ? (offset) : ((offset) & ~1u))
@@ -206,18 +218,10 @@ bool Bus::AllocateMemory()
 
   Log_VerboseFmt("BIOS is mapped at {}.", static_cast<void*>(g_bios));
 
-  g_memory_handlers = static_cast<void**>(MemMap::MapSharedMemory(s_shmem_handle, MemoryMap::LUT_OFFSET, nullptr,
-                                                                  MemoryMap::LUT_SIZE, PageProtect::ReadWrite));
-  if (!g_memory_handlers)
-  {
-    Host::ReportErrorAsync("Error", "Failed to map memory for LUTs");
-    ReleaseMemory();
-    return false;
-  }
-
-  Log_VerboseFmt("LUTs are mapped at {}.", static_cast<void*>(g_memory_handlers));
+  g_memory_handlers = s_memory_lut_regions.data();
   g_memory_handlers_isc = g_memory_handlers + MEMORY_LUT_SLOTS;
   SetHandlers();
+  Log_VerboseFmt("Memory LUTs use {} pages.", s_memory_lut_pages.size());
 
 #ifdef ENABLE_MMAP_FASTMEM
   if (!s_fastmem_arena.Create(FASTMEM_ARENA_SIZE))
@@ -255,11 +259,8 @@ void Bus::ReleaseMemory()
   s_fastmem_lut = nullptr;
 
   g_memory_handlers_isc = nullptr;
-  if (g_memory_handlers)
-  {
-    MemMap::UnmapSharedMemory(g_memory_handlers, MemoryMap::LUT_SIZE);
-    g_memory_handlers = nullptr;
-  }
+  g_memory_handlers = nullptr;
+  s_memory_lut_pages.clear();
 
   if (g_bios)
   {
@@ -365,11 +366,12 @@ void Bus::AddTTYString(const std::string_view& str)
     AddTTYCharacter(ch);
 }
 
-bool Bus::DoState(StateWrapper& sw)
+bool Bus::DoState(StateWrapper& sw, bool is_memory_state)
 {
   u32 ram_size = g_ram_size;
   sw.DoEx(&ram_size, 52, static_cast<u32>(RAM_2MB_SIZE));
-  if (ram_size != g_ram_size)
+  const bool ram_size_changed = (ram_size != g_ram_size);
+  if (ram_size_changed)
   {
     const bool using_8mb_ram = (ram_size == RAM_8MB_SIZE);
     SetRAMSize(using_8mb_ram);
@@ -382,7 +384,30 @@ bool Bus::DoState(StateWrapper& sw)
   sw.Do(&g_bios_access_time);
   sw.Do(&g_cdrom_access_time);
   sw.Do(&g_spu_access_time);
-  sw.DoBytes(g_ram, g_ram_size);
+
+  // Rewind and runahead load memory states constantly, and most of the code in RAM is the same each time. Only drop
+  // the blocks in pages which the state actually changes, rather than revalidating and reprotecting every block.
+  const u8* new_ram = (sw.IsReading() && is_memory_state && !ram_size_changed) ? sw.PeekBytes(g_ram_size) : nullptr;
+  if (new_ram)
+  {
+    CPU::CodeCache::InvalidateChangedRAMBlocks(new_ram);
+
+    // Pages which are still protected are unchanged, and writing them would fault.
+    for (u32 i = 0; i < (g_ram_size / HOST_PAGE_SIZE); i++)
+    {
+      if (!g_ram_code_bits[i])
+        std::memcpy(&g_ram[i * HOST_PAGE_SIZE], &new_ram[i * HOST_PAGE_SIZE], HOST_PAGE_SIZE);
+    }
+
+    sw.SkipBytes(g_ram_size);
+  }
+  else
+  {
+    if (sw.IsReading() && is_memory_state)
+      CPU::CodeCache::InvalidateAllRAMBlocks();
+
+    sw.DoBytes(g_ram, g_ram_size);
+  }
 
   if (sw.GetVersion() < 58)
   {
@@ -540,7 +565,10 @@ void Bus::UpdateFastmemViews(CPUFastmemMode mode)
     s_fastmem_lut = static_cast<u8**>(std::malloc(sizeof(u8*) * FASTMEM_LUT_SLOTS));
     Assert(s_fastmem_lut);
 
-    Log_InfoPrintf("Fastmem base (software): %p", s_fastmem_lut);
+    // 16MB of pointers indexed by guest page, every access touches a different host page without huge pages.
+    const bool huge_pages = MemMap::AdviseHugePages(s_fastmem_lut, sizeof(u8*) * FASTMEM_LUT_SLOTS);
+    Log_InfoPrintf("Fastmem base (software): %p, huge pages %s", s_fastmem_lut,
+                   huge_pages ? "requested" : "not available");
   }
 
   // This assumes the top 4KB of address space is not mapped. It shouldn't be on any sane OSes.
@@ -939,19 +967,27 @@ void Bus::RAMWriteHandler(VirtualMemoryAddress address, u32 value)
 {
   const u32 offset = address & g_ram_mask;
 
+  // Writes to code pages go through the unprotected mapping instead of faulting, so that data sharing the page with
+  // code can be written without invalidating the blocks.
+  const bool code_page = g_ram_code_bits[offset / HOST_PAGE_SIZE];
+  u8* const ram = code_page ? g_unprotected_ram : g_ram;
+
   if constexpr (size == MemoryAccessSize::Byte)
   {
-    g_ram[offset] = Truncate8(value);
+    ram[offset] = Truncate8(value);
   }
   else if constexpr (size == MemoryAccessSize::HalfWord)
   {
     const u16 temp = Truncate16(value);
-    std::memcpy(&g_ram[offset], &temp, sizeof(u16));
+    std::memcpy(&ram[offset], &temp, sizeof(u16));
   }
   else if constexpr (size == MemoryAccessSize::Word)
   {
-    std::memcpy(&g_ram[offset], &value, sizeof(u32));
+    std::memcpy(&ram[offset], &value, sizeof(u32));
   }
+
+  if (code_page)
+    CPU::CodeCache::InvalidateBlocksWithRAMWrite(offset, 1u << static_cast<u32>(size));
 }
 
 template<MemoryAccessSize size>
@@ -1058,6 +1094,7 @@ void Bus::ICacheWriteHandler(VirtualMemoryAddress address, u32 value)
   const u32 line = CPU::GetICacheLine(address);
   const u32 offset = CPU::GetICacheLineOffset(address);
   CPU::g_state.icache_tags[line] = CPU::GetICacheTagForAddress(address) | CPU::ICACHE_INVALID_BITS;
+  CPU::g_state.icache_generation++;
   if constexpr (size == MemoryAccessSize::Byte)
     std::memcpy(&CPU::g_state.icache_data[line * CPU::ICACHE_LINE_SIZE + offset], &value, sizeof(u8));
   else if constexpr (size == MemoryAccessSize::HalfWord)
@@ -1602,28 +1639,63 @@ static constexpr std::array<RT, 256> GetHardwareRegisterHandlerTable()
 
   return ret;
 }
+
+// Indexed by [size][register].
+static constexpr const std::array<std::array<MemoryReadHandler, 256>, 3> s_read_handlers = {
+  GetHardwareRegisterHandlerTable<MemoryAccessType::Read, MemoryAccessSize::Byte>(),
+  GetHardwareRegisterHandlerTable<MemoryAccessType::Read, MemoryAccessSize::HalfWord>(),
+  GetHardwareRegisterHandlerTable<MemoryAccessType::Read, MemoryAccessSize::Word>(),
+};
+static constexpr const std::array<std::array<MemoryWriteHandler, 256>, 3> s_write_handlers = {
+  GetHardwareRegisterHandlerTable<MemoryAccessType::Write, MemoryAccessSize::Byte>(),
+  GetHardwareRegisterHandlerTable<MemoryAccessType::Write, MemoryAccessSize::HalfWord>(),
+  GetHardwareRegisterHandlerTable<MemoryAccessType::Write, MemoryAccessSize::Word>(),
+};
+
+static bool IsHardwareRegisterAddress(VirtualMemoryAddress address)
+{
+  // Only KUSEG/KSEG0/KSEG1 map the registers, the other KUSEG mirrors are unmapped.
+  const u32 seg = (address >> 29);
+  const PhysicalMemoryAddress paddr = address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+  return ((seg == 0 || seg == 4 || seg == 5) && paddr >= HW_BASE && paddr < (HW_BASE + HW_SIZE));
+}
 } // namespace Bus::HWHandlers
 
 template<MemoryAccessSize size>
 u32 Bus::HardwareReadHandler(VirtualMemoryAddress address)
 {
-  static constexpr const auto table = HWHandlers::GetHardwareRegisterHandlerTable<MemoryAccessType::Read, size>();
   const u32 table_index = (address >> 4) & 0xFFu;
-  return table[table_index](address);
+  return HWHandlers::s_read_handlers[static_cast<u32>(size)][table_index](address);
 }
 
 template<MemoryAccessSize size>
 void Bus::HardwareWriteHandler(VirtualMemoryAddress address, u32 value)
 {
-  static constexpr const auto table = HWHandlers::GetHardwareRegisterHandlerTable<MemoryAccessType::Write, size>();
   const u32 table_index = (address >> 4) & 0xFFu;
-  return table[table_index](address, value);
+  return HWHandlers::s_write_handlers[static_cast<u32>(size)][table_index](address, value);
+}
+
+Bus::MemoryReadHandler Bus::GetHardwareRegisterReadHandler(VirtualMemoryAddress address, MemoryAccessSize size)
+{
+  if (!HWHandlers::IsHardwareRegisterAddress(address))
+    return nullptr;
+
+  return HWHandlers::s_read_handlers[static_cast<u32>(size)][(address >> 4) & 0xFFu];
+}
+
+Bus::MemoryWriteHandler Bus::GetHardwareRegisterWriteHandler(VirtualMemoryAddress address, MemoryAccessSize size)
+{
+  if (!HWHandlers::IsHardwareRegisterAddress(address))
+    return nullptr;
+
+  return HWHandlers::s_write_handlers[static_cast<u32>(size)][(address >> 4) & 0xFFu];
 }
 
 //////////////////////////////////////////////////////////////////////////
 
 void Bus::SetHandlers()
 {
+  s_memory_lut_pages.clear();
   ClearHandlers(g_memory_handlers);
   ClearHandlers(g_memory_handlers_isc);
 
@@ -1697,21 +1769,56 @@ void Bus::ClearHandlers(void** handlers)
 {
   for (u32 size = 0; size < 3; size++)
   {
-    MemoryReadHandler* read_handlers =
-      OffsetHandlerArray<MemoryReadHandler>(handlers, static_cast<MemoryAccessSize>(size), MemoryAccessType::Read);
+    MemoryReadHandler* unmapped_read_page =
+      reinterpret_cast<MemoryReadHandler*>(s_unmapped_handler_pages[(size * 2) + 0].data());
     const MemoryReadHandler read_handler =
       (size == 0) ?
         UnmappedReadHandler<MemoryAccessSize::Byte> :
         ((size == 1) ? UnmappedReadHandler<MemoryAccessSize::HalfWord> : UnmappedReadHandler<MemoryAccessSize::Word>);
-    MemsetPtrs(read_handlers, read_handler, MEMORY_LUT_SIZE);
+    MemsetPtrs(unmapped_read_page, read_handler, MEMORY_LUT_REGION_PAGES);
+    MemsetPtrs(handlers + (((size * 2) + 0) * MEMORY_LUT_REGION_COUNT), static_cast<void*>(unmapped_read_page),
+               MEMORY_LUT_REGION_COUNT);
 
-    MemoryWriteHandler* write_handlers =
-      OffsetHandlerArray<MemoryWriteHandler>(handlers, static_cast<MemoryAccessSize>(size), MemoryAccessType::Write);
+    MemoryWriteHandler* unmapped_write_page =
+      reinterpret_cast<MemoryWriteHandler*>(s_unmapped_handler_pages[(size * 2) + 1].data());
     const MemoryWriteHandler write_handler =
       (size == 0) ?
         UnmappedWriteHandler<MemoryAccessSize::Byte> :
         ((size == 1) ? UnmappedWriteHandler<MemoryAccessSize::HalfWord> : UnmappedWriteHandler<MemoryAccessSize::Word>);
-    MemsetPtrs(write_handlers, write_handler, MEMORY_LUT_SIZE);
+    MemsetPtrs(unmapped_write_page, write_handler, MEMORY_LUT_REGION_PAGES);
+    MemsetPtrs(handlers + (((size * 2) + 1) * MEMORY_LUT_REGION_COUNT), static_cast<void*>(unmapped_write_page),
+               MEMORY_LUT_REGION_COUNT);
+  }
+}
+
+template<typename FP>
+FP* Bus::GetWritableHandlerPage(void** handlers, MemoryAccessSize size, MemoryAccessType type, u32 region)
+{
+  const u32 slot = (static_cast<u32>(size) * 2) + static_cast<u32>(type);
+  void*& page = handlers[(slot * MEMORY_LUT_REGION_COUNT) + region];
+  if (page == s_unmapped_handler_pages[slot].data())
+  {
+    std::unique_ptr<void*[]> new_page = std::make_unique<void*[]>(MEMORY_LUT_REGION_PAGES);
+    std::memcpy(new_page.get(), page, sizeof(void*) * MEMORY_LUT_REGION_PAGES);
+    page = new_page.get();
+    s_memory_lut_pages.push_back(std::move(new_page));
+  }
+
+  return static_cast<FP*>(page);
+}
+
+template<typename FP>
+void Bus::SetHandlerPages(void** handlers, MemoryAccessSize size, MemoryAccessType type, u32 start_page,
+                          u32 num_pages, FP handler)
+{
+  const u32 end_page = start_page + num_pages;
+  for (u32 page = start_page; page < end_page;)
+  {
+    const u32 region = page / MEMORY_LUT_REGION_PAGES;
+    const u32 offset = page % MEMORY_LUT_REGION_PAGES;
+    const u32 count = std::min<u32>(end_page - page, MEMORY_LUT_REGION_PAGES - offset);
+    MemsetPtrs(GetWritableHandlerPage<FP>(handlers, size, type, region) + offset, handler, count);
+    page += count;
   }
 }
 
@@ -1728,41 +1835,15 @@ void Bus::SetHandlerForRegion(void** handlers, VirtualMemoryAddress address, u32
 
   for (u32 acc_size = 0; acc_size < 3; acc_size++)
   {
-    MemoryReadHandler* read_handlers =
-      OffsetHandlerArray<MemoryReadHandler>(handlers, static_cast<MemoryAccessSize>(acc_size), MemoryAccessType::Read) +
-      start_page;
     const MemoryReadHandler read_handler =
       (acc_size == 0) ? read_byte_handler : ((acc_size == 1) ? read_halfword_handler : read_word_handler);
-#if 0
-    for (u32 i = 0; i < num_pages; i++)
-    {
-      DebugAssert((acc_size == 0 && read_handlers[i] == UnmappedReadHandler<MemoryAccessSize::Byte>) ||
-                  (acc_size == 1 && read_handlers[i] == UnmappedReadHandler<MemoryAccessSize::HalfWord>) ||
-                  (acc_size == 2 && read_handlers[i] == UnmappedReadHandler<MemoryAccessSize::Word>));
+    SetHandlerPages(handlers, static_cast<MemoryAccessSize>(acc_size), MemoryAccessType::Read, start_page, num_pages,
+                    read_handler);
 
-      read_handlers[i] = read_handler;
-    }
-#else
-    MemsetPtrs(read_handlers, read_handler, num_pages);
-#endif
-
-    MemoryWriteHandler* write_handlers = OffsetHandlerArray<MemoryWriteHandler>(
-                                           handlers, static_cast<MemoryAccessSize>(acc_size), MemoryAccessType::Write) +
-                                         start_page;
     const MemoryWriteHandler write_handler =
       (acc_size == 0) ? write_byte_handler : ((acc_size == 1) ? write_halfword_handler : write_word_handler);
-#if 0
-    for (u32 i = 0; i < num_pages; i++)
-    {
-      DebugAssert((acc_size == 0 && write_handlers[i] == UnmappedWriteHandler<MemoryAccessSize::Byte>) ||
-                  (acc_size == 1 && write_handlers[i] == UnmappedWriteHandler<MemoryAccessSize::HalfWord>) ||
-                  (acc_size == 2 && write_handlers[i] == UnmappedWriteHandler<MemoryAccessSize::Word>));
-
-      write_handlers[i] = write_handler;
-    }
-#else
-    MemsetPtrs(write_handlers, write_handler, num_pages);
-#endif
+    SetHandlerPages(handlers, static_cast<MemoryAccessSize>(acc_size), MemoryAccessType::Write, start_page, num_pages,
+                    write_handler);
   }
 }
 
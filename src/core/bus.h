@@ -91,8 +91,10 @@ enum : u32
   MEMORY_LUT_PAGE_SIZE = 4096,
   MEMORY_LUT_PAGE_SHIFT = 12,
   MEMORY_LUT_PAGE_MASK = MEMORY_LUT_PAGE_SIZE - 1,
-  MEMORY_LUT_SIZE = 0x100000,                 // 0x100000000 >> 12
-  MEMORY_LUT_SLOTS = MEMORY_LUT_SIZE * 3 * 2, // [size][read_write]
+  MEMORY_LUT_REGION_SHIFT = 22,
+  MEMORY_LUT_REGION_COUNT = 0x400,                    // 0x100000000 >> 22
+  MEMORY_LUT_REGION_PAGES = 0x400,                    // 0x400000 >> 12
+  MEMORY_LUT_SLOTS = MEMORY_LUT_REGION_COUNT * 3 * 2, // [size][read_write]
 
   FASTMEM_LUT_PAGE_SIZE = 4096,
   FASTMEM_LUT_PAGE_MASK = FASTMEM_LUT_PAGE_SIZE - 1,
@@ -112,18 +114,28 @@ void ReleaseMemory();
 bool Initialize();
 void Shutdown();
 void Reset();
-bool DoState(StateWrapper& sw);
+bool DoState(StateWrapper& sw, bool is_memory_state);
 
 using MemoryReadHandler = u32 (*)(VirtualMemoryAddress address);
 using MemoryWriteHandler = void (*)(VirtualMemoryAddress, u32);
 
 void** GetMemoryHandlers(bool isolate_cache, bool swap_caches);
 
+/// Returns the device handler for a hardware register, so accesses to a known address can skip the register table.
+/// Returns nullptr if the address isn't a hardware register. Writes are only valid while the cache isn't isolated.
+MemoryReadHandler GetHardwareRegisterReadHandler(VirtualMemoryAddress address, MemoryAccessSize size);
+MemoryWriteHandler GetHardwareRegisterWriteHandler(VirtualMemoryAddress address, MemoryAccessSize size);
+
+/// Handlers are looked up in two levels, each 4MB region points to the handlers for its 4K pages. Regions without
+/// anything mapped share a page of unmapped handlers.
 template<typename FP>
-ALWAYS_INLINE_RELEASE static FP* OffsetHandlerArray(void** handlers, MemoryAccessSize size, MemoryAccessType type)
+ALWAYS_INLINE_RELEASE static FP GetHandlerForAddress(void** handlers, MemoryAccessSize size, MemoryAccessType type,
+                                                     VirtualMemoryAddress address)
 {
-  return reinterpret_cast<FP*>(handlers +
-                               (((static_cast<size_t>(size) * 2) + static_cast<size_t>(type)) * MEMORY_LUT_SIZE));
+  void* const* regions =
+    handlers + (((static_cast<size_t>(size) * 2) + static_cast<size_t>(type)) * MEMORY_LUT_REGION_COUNT);
+  const FP* pages = static_cast<const FP*>(regions[address >> MEMORY_LUT_REGION_SHIFT]);
+  return pages[(address >> MEMORY_LUT_PAGE_SHIFT) & (MEMORY_LUT_REGION_PAGES - 1)];
 }
 
 CPUFastmemMode GetFastmemMode();
@@ -23,6 +23,7 @@
 #include "common/heap_array.h"
 #include "common/intrin.h"
 #include "common/log.h"
+#include "common/trace_recorder.h"
 
 #include "imgui.h"
 
@@ -776,6 +777,7 @@ std::unique_ptr<CDImage> CDROM::RemoveMedia(bool for_disc_swap)
 
 bool CDROM::PrecacheMedia()
 {
+  TRACE_SCOPE("CDROM::PrecacheMedia");
   if (!m_reader.HasMedia())
     return false;
 
@@ -788,7 +790,7 @@ bool CDROM::PrecacheMedia()
   }
 
   HostInterfaceProgressCallback callback;
-  if (!m_reader.Precache(&callback))
+  if (!m_reader.Precache(&callback, g_settings.cdrom_share_precache))
   {
     Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Precaching CD image failed, it may be unreliable."), 15.0f);
     return false;
@@ -2888,7 +2890,10 @@ void CDROM::ProcessDataSector(const u8* raw_sector, const CDImage::SubChannelQ&
   SetAsyncInterrupt(Interrupt::DataReady);
 }
 
-static std::array<std::array<s16, 29>, 7> s_zigzag_table = {
+namespace CDROM {
+
+static constexpr std::array<std::array<s16, XA_RESAMPLE_ZIGZAG_TABLE_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES>
+  s_zigzag_table = {
   {{0,      0x0,     0x0,     0x0,    0x0,     -0x0002, 0x000A,  -0x0022, 0x0041, -0x0054,
     0x0034, 0x0009,  -0x010A, 0x0400, -0x0A78, 0x234C,  0x6794,  -0x1780, 0x0BCD, -0x0623,
     0x0350, -0x016D, 0x006B,  0x000A, -0x0010, 0x0011,  -0x0008, 0x0003,  -0x0001},
@@ -2911,15 +2916,72 @@ static std::array<std::array<s16, 29>, 7> s_zigzag_table = {
     0x3C07,  0x53E0,  -0x16FA, 0x0AFA, -0x0548, 0x027B,  -0x00EB, 0x001A,  0x002B, -0x0023,
     0x0010,  -0x0008, 0x0002,  0x0,    0x0,     0x0,     0x0,     0x0,     0x0}}};
 
-static s16 ZigZagInterpolate(const s16* ringbuf, const s16* table, u8 p)
+// The ring buffer is read backwards from the write position, so the tables are reversed and padded to a whole number
+// of vectors. Combined with a copy of the ring buffer which is duplicated after itself, each output is then a straight
+// dot product over a window of the buffer.
+static constexpr u32 XA_RESAMPLE_WINDOW_SIZE = 32;
+static constexpr u32 XA_RESAMPLE_WINDOW_OFFSET = XA_RESAMPLE_RING_BUFFER_SIZE - (XA_RESAMPLE_ZIGZAG_TABLE_SIZE - 1);
+static constexpr u32 XA_RESAMPLE_LINEAR_BUFFER_SIZE =
+  XA_RESAMPLE_RING_BUFFER_SIZE + XA_RESAMPLE_WINDOW_OFFSET + XA_RESAMPLE_WINDOW_SIZE;
+
+alignas(16) static constexpr std::array<std::array<s16, XA_RESAMPLE_WINDOW_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES>
+  s_zigzag_window_table = []() {
+    std::array<std::array<s16, XA_RESAMPLE_WINDOW_SIZE>, XA_RESAMPLE_NUM_ZIGZAG_TABLES> ret = {};
+    for (u32 i = 0; i < XA_RESAMPLE_NUM_ZIGZAG_TABLES; i++)
+    {
+      for (u32 j = 0; j < XA_RESAMPLE_ZIGZAG_TABLE_SIZE; j++)
+        ret[i][j] = s_zigzag_table[i][XA_RESAMPLE_ZIGZAG_TABLE_SIZE - 1 - j];
+    }
+    return ret;
+  }();
+
+/// Equivalent to summing (ringbuf[(p - i) & 0x1F] * table[i]) / 0x8000 for each tap, where window starts at
+/// ringbuf[p] in the linear copy of the ring buffer, offset by XA_RESAMPLE_WINDOW_OFFSET.
+static s16 ZigZagInterpolate(const s16* window, const s16* table)
 {
-  s32 sum = 0;
-  for (u8 i = 0; i < 29; i++)
-    sum += (s32(ringbuf[(p - i) & 0x1F]) * s32(table[i])) / 0x8000;
+#if defined(CPU_ARCH_SSE)
+  // Each product needs to be divided (truncating towards zero) before they're summed, a bias of 0x7FFF for negative
+  // products makes the arithmetic shift match.
+  const __m128i bias = _mm_set1_epi32(0x7FFF);
+  __m128i sum = _mm_setzero_si128();
+  for (u32 i = 0; i < XA_RESAMPLE_WINDOW_SIZE; i += 8)
+  {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&window[i]));
+    const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(&table[i]));
+    const __m128i lo = _mm_mullo_epi16(a, b);
+    const __m128i hi = _mm_mulhi_epi16(a, b);
+    const __m128i p0 = _mm_unpacklo_epi16(lo, hi);
+    const __m128i p1 = _mm_unpackhi_epi16(lo, hi);
+    sum = _mm_add_epi32(sum, _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 15));
+    sum = _mm_add_epi32(sum, _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 15));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  const s32 result = _mm_cvtsi128_si32(sum);
+#elif defined(CPU_ARCH_NEON)
+  const int32x4_t bias = vdupq_n_s32(0x7FFF);
+  int32x4_t sum = vdupq_n_s32(0);
+  for (u32 i = 0; i < XA_RESAMPLE_WINDOW_SIZE; i += 8)
+  {
+    const int16x8_t a = vld1q_s16(&window[i]);
+    const int16x8_t b = vld1q_s16(&table[i]);
+    const int32x4_t p0 = vmull_s16(vget_low_s16(a), vget_low_s16(b));
+    const int32x4_t p1 = vmull_high_s16(a, b);
+    sum = vaddq_s32(sum, vshrq_n_s32(vaddq_s32(p0, vandq_s32(vshrq_n_s32(p0, 31), bias)), 15));
+    sum = vaddq_s32(sum, vshrq_n_s32(vaddq_s32(p1, vandq_s32(vshrq_n_s32(p1, 31), bias)), 15));
+  }
+  const s32 result = vaddvq_s32(sum);
+#else
+  s32 result = 0;
+  for (u32 i = 0; i < XA_RESAMPLE_ZIGZAG_TABLE_SIZE; i++)
+    result += (s32(window[i]) * s32(table[i])) / 0x8000;
+#endif
 
-  return static_cast<s16>(std::clamp<s32>(sum, -0x8000, 0x7FFF));
+  return static_cast<s16>(std::clamp<s32>(result, -0x8000, 0x7FFF));
 }
 
+} // namespace CDROM
+
 std::tuple<s16, s16> CDROM::GetAudioFrame()
 {
   const u32 frame = s_audio_fifo.IsEmpty() ? 0u : s_audio_fifo.Pop();
@@ -2959,8 +3021,18 @@ void CDROM::ResampleXAADPCM(const s16* frames_in, u32 num_frames_in)
     return;
   }
 
-  s16* left_ringbuf = s_xa_resample_ring_buffer[0].data();
-  s16* right_ringbuf = s_xa_resample_ring_buffer[1].data();
+  // Work on a linear copy of the ring buffers, with each sample written twice, so the window never wraps.
+  alignas(16) std::array<std::array<s16, XA_RESAMPLE_LINEAR_BUFFER_SIZE>, 2> linear_buffer;
+  for (u32 i = 0; i < (STEREO ? 2u : 1u); i++)
+  {
+    std::copy(s_xa_resample_ring_buffer[i].begin(), s_xa_resample_ring_buffer[i].end(), linear_buffer[i].begin());
+    std::copy(s_xa_resample_ring_buffer[i].begin(), s_xa_resample_ring_buffer[i].end(),
+              linear_buffer[i].begin() + XA_RESAMPLE_RING_BUFFER_SIZE);
+    std::fill(linear_buffer[i].begin() + XA_RESAMPLE_RING_BUFFER_SIZE * 2, linear_buffer[i].end(), 0);
+  }
+
+  s16* left_buf = linear_buffer[0].data();
+  s16* right_buf = linear_buffer[1].data();
   u8 p = s_xa_resample_p;
   u8 sixstep = s_xa_resample_sixstep;
   for (u32 in_sample_index = 0; in_sample_index < num_frames_in; in_sample_index++)
@@ -2975,25 +3047,37 @@ void CDROM::ResampleXAADPCM(const s16* frames_in, u32 num_frames_in)
 
     for (u32 sample_dup = 0; sample_dup < (SAMPLE_RATE ? 2 : 1); sample_dup++)
     {
-      left_ringbuf[p] = left;
+      left_buf[p] = left;
+      left_buf[p + XA_RESAMPLE_RING_BUFFER_SIZE] = left;
       if constexpr (STEREO)
-        right_ringbuf[p] = right;
+      {
+        right_buf[p] = right;
+        right_buf[p + XA_RESAMPLE_RING_BUFFER_SIZE] = right;
+      }
       p = (p + 1) % 32;
       sixstep--;
 
       if (sixstep == 0)
       {
         sixstep = 6;
+        const u32 window = p + XA_RESAMPLE_WINDOW_OFFSET;
         for (u32 j = 0; j < 7; j++)
         {
-          const s16 left_interp = ZigZagInterpolate(left_ringbuf, s_zigzag_table[j].data(), p);
-          const s16 right_interp = STEREO ? ZigZagInterpolate(right_ringbuf, s_zigzag_table[j].data(), p) : left_interp;
+          const s16 left_interp = ZigZagInterpolate(&left_buf[window], s_zigzag_window_table[j].data());
+          const s16 right_interp =
+            STEREO ? ZigZagInterpolate(&right_buf[window], s_zigzag_window_table[j].data()) : left_interp;
           AddCDAudioFrame(left_interp, right_interp);
         }
       }
     }
   }
 
+  for (u32 i = 0; i < (STEREO ? 2u : 1u); i++)
+  {
+    std::copy(linear_buffer[i].begin(), linear_buffer[i].begin() + XA_RESAMPLE_RING_BUFFER_SIZE,
+              s_xa_resample_ring_buffer[i].begin());
+  }
+
   s_xa_resample_p = p;
   s_xa_resample_sixstep = sixstep;
 }
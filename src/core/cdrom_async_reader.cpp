@@ -2,9 +2,16 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "cdrom_async_reader.h"
+#include "system.h"
+#include "util/iso_reader.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/threading.h"
 #include "common/timer.h"
+#include "common/trace_recorder.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
 Log_SetChannel(CDROMAsyncReader);
 
 CDROMAsyncReader::CDROMAsyncReader() = default;
@@ -20,8 +27,15 @@ void CDROMAsyncReader::StartThread(u32 readahead_count)
     StopThread();
 
   m_buffers.clear();
-  m_buffers.resize(readahead_count);
+  m_buffers.resize(std::max(readahead_count, MAX_READAHEAD_COUNT));
+  m_readahead_count = readahead_count;
+  m_readahead_depth.store(readahead_count);
+  m_average_read_time.store(0.0f);
+  m_average_queue_interval = 0.0f;
+  m_last_queue_time = 0;
   EmptyBuffers();
+  ClearSectorCache();
+  QueueFilePrefetch();
 
   m_shutdown_flag.store(false);
   m_read_thread = std::thread(&CDROMAsyncReader::WorkerThreadEntryPoint, this);
@@ -41,7 +55,9 @@ void CDROMAsyncReader::StopThread()
 
   m_read_thread.join();
   EmptyBuffers();
+  ClearSectorCache();
   m_buffers.clear();
+  m_readahead_count = 0;
 }
 
 void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
@@ -50,6 +66,16 @@ void CDROMAsyncReader::SetMedia(std::unique_ptr<CDImage> media)
     CancelReadahead();
 
   m_media = std::move(media);
+
+  if (IsUsingThread())
+  {
+    std::unique_lock lock(m_mutex);
+    m_readahead_hint_start = 0;
+    m_readahead_hint_end = 0;
+    QueueFilePrefetch();
+    if (!m_prefetch_queue.empty())
+      m_do_read_cv.notify_one();
+  }
 }
 
 std::unique_ptr<CDImage> CDROMAsyncReader::RemoveMedia()
@@ -60,7 +86,7 @@ std::unique_ptr<CDImage> CDROMAsyncReader::RemoveMedia()
   return std::move(m_media);
 }
 
-bool CDROMAsyncReader::Precache(ProgressCallback* callback)
+bool CDROMAsyncReader::Precache(ProgressCallback* callback, bool shared)
 {
   WaitForIdle();
 
@@ -72,11 +98,12 @@ bool CDROMAsyncReader::Precache(ProgressCallback* callback)
 
   EmptyBuffers();
 
-  const CDImage::PrecacheResult res = m_media->Precache(callback);
+  // images which precache themselves (i.e. CHD) would end up with a private copy, so copy those too when sharing
+  const CDImage::PrecacheResult res = shared ? CDImage::PrecacheResult::Unsupported : m_media->Precache(callback);
   if (res == CDImage::PrecacheResult::Unsupported)
   {
     // fall back to copy precaching
-    std::unique_ptr<CDImage> memory_image = CDImage::CreateMemoryImage(m_media.get(), callback);
+    std::unique_ptr<CDImage> memory_image = CDImage::CreateMemoryImage(m_media.get(), callback, shared);
     if (memory_image)
     {
       const CDImage::LBA lba = m_media->GetPositionOnDisc();
@@ -88,6 +115,8 @@ bool CDROMAsyncReader::Precache(ProgressCallback* callback)
 
       m_media.reset();
       m_media = std::move(memory_image);
+      m_prefetch_queue.clear();
+      m_prefetched_sectors.clear();
       return true;
     }
     else
@@ -96,7 +125,15 @@ bool CDROMAsyncReader::Precache(ProgressCallback* callback)
     }
   }
 
-  return (res == CDImage::PrecacheResult::Success);
+  if (res == CDImage::PrecacheResult::Success)
+  {
+    // everything's in memory now, no point prefetching
+    m_prefetch_queue.clear();
+    m_prefetched_sectors.clear();
+    return true;
+  }
+
+  return false;
 }
 
 void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
@@ -107,6 +144,8 @@ void CDROMAsyncReader::QueueReadSector(CDImage::LBA lba)
     return;
   }
 
+  UpdateReadaheadDepth();
+
   const u32 buffer_count = m_buffer_count.load();
   if (buffer_count > 0)
   {
@@ -165,6 +204,8 @@ bool CDROMAsyncReader::ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ
 
 bool CDROMAsyncReader::InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data)
 {
+  TRACE_SCOPE("CDROMAsyncReader::ReadSector");
+
   if (m_media->GetPositionOnDisc() != lba && !m_media->Seek(lba))
   {
     Log_WarningPrintf("Seek to LBA %u failed", lba);
@@ -226,24 +267,195 @@ void CDROMAsyncReader::EmptyBuffers()
   m_buffer_count.store(0);
 }
 
+void CDROMAsyncReader::ClearSectorCache()
+{
+  m_sector_cache.Clear();
+  m_prefetched_sectors.clear();
+  m_prefetch_queue.clear();
+}
+
+void CDROMAsyncReader::UpdateReadaheadDepth()
+{
+  // Sectors are requested at a fixed rate when reading, so gaps longer than this mean the drive was paused or idle.
+  static constexpr float MAX_QUEUE_INTERVAL = 100.0f;
+  static constexpr float SMOOTHING = 0.1f;
+
+  const u64 now = Common::Timer::GetCurrentValue();
+  const float interval =
+    (m_last_queue_time != 0) ? static_cast<float>(Common::Timer::ConvertValueToMilliseconds(now - m_last_queue_time)) :
+                               MAX_QUEUE_INTERVAL;
+  m_last_queue_time = now;
+  if (interval >= MAX_QUEUE_INTERVAL)
+    return;
+
+  m_average_queue_interval = (m_average_queue_interval == 0.0f) ?
+                               interval :
+                               (m_average_queue_interval + (interval - m_average_queue_interval) * SMOOTHING);
+
+  // Keep enough sectors in flight to cover two reads' worth of latency on top of the configured count.
+  const float read_time = m_average_read_time.load(std::memory_order_relaxed);
+  const u32 extra = static_cast<u32>(std::ceil((read_time * 2.0f) / std::max(m_average_queue_interval, 0.1f)));
+  const u32 depth = std::clamp(m_readahead_count + extra, m_readahead_count, static_cast<u32>(m_buffers.size()));
+  if (m_readahead_depth.load(std::memory_order_relaxed) != depth)
+  {
+    Log_DevPrintf("Readahead depth now %u sectors (read %.2f msec, interval %.2f msec)", depth, read_time,
+                  m_average_queue_interval);
+    m_readahead_depth.store(depth);
+  }
+}
+
+bool CDROMAsyncReader::ReadSectorFromCache(CDImage::LBA lba)
+{
+  const BufferSlot* cached = m_sector_cache.Lookup(lba);
+  if (!cached)
+  {
+    const auto iter = m_prefetched_sectors.find(lba);
+    if (iter == m_prefetched_sectors.end())
+      return false;
+
+    cached = &iter->second;
+  }
+
+  Log_TracePrintf("Sector cache hit for LBA %u", lba);
+
+  const u32 slot = m_buffer_back.load();
+  m_buffer_back.store((slot + 1) % static_cast<u32>(m_buffers.size()));
+  m_buffers[slot] = *cached;
+  m_buffer_count.fetch_add(1);
+  m_notify_read_complete_cv.notify_all();
+  return true;
+}
+
+void CDROMAsyncReader::QueueFilePrefetch()
+{
+  m_prefetch_queue.clear();
+  m_prefetched_sectors.clear();
+  if (!m_media || m_media->IsPrecached() || m_media->GetTrackCount() == 0)
+    return;
+
+  // Games seek to the start of files far more than anywhere else, so those are the sectors to have ready.
+  const CDImage::LBA prev_lba = m_media->GetPositionOnDisc();
+  ISOReader iso;
+  if (iso.Open(m_media.get(), 1))
+  {
+    const CDImage::LBA track_start = m_media->GetTrackStartPosition(1);
+    std::deque<std::string> directories;
+    directories.emplace_back();
+
+    u32 num_files = 0;
+    while (!directories.empty() && num_files < MAX_PREFETCH_FILES)
+    {
+      const std::string dir = std::move(directories.front());
+      directories.pop_front();
+
+      for (const auto& [path, de] : iso.GetEntriesInDirectory(dir.c_str()))
+      {
+        if (de.flags & ISOReader::ISODirectoryEntryFlag_Directory)
+        {
+          directories.push_back(path);
+          continue;
+        }
+
+        for (u32 i = 0; i < PREFETCH_SECTORS_PER_FILE; i++)
+          m_prefetch_queue.push_back(track_start + de.location_le + i);
+
+        if ((++num_files) == MAX_PREFETCH_FILES)
+          break;
+      }
+    }
+
+    // Read in disc order to keep seeking down, the queue is consumed from the back.
+    std::sort(m_prefetch_queue.begin(), m_prefetch_queue.end(), std::greater<CDImage::LBA>());
+    m_prefetch_queue.erase(std::unique(m_prefetch_queue.begin(), m_prefetch_queue.end()), m_prefetch_queue.end());
+    Log_DevPrintf("Queued %zu sectors from %u files for prefetching", m_prefetch_queue.size(), num_files);
+  }
+
+  if (!m_media->Seek(prev_lba))
+    Log_ErrorPrintf("Failed to re-seek to LBA %u after listing files", prev_lba);
+}
+
+void CDROMAsyncReader::PrefetchSector(std::unique_lock<std::mutex>& lock)
+{
+  const CDImage::LBA lba = m_prefetch_queue.back();
+  m_prefetch_queue.pop_back();
+  if (m_sector_cache.Lookup(lba) || m_prefetched_sectors.find(lba) != m_prefetched_sectors.end())
+    return;
+
+  BufferSlot buffer;
+  buffer.lba = lba;
+  m_is_reading.store(true);
+  lock.unlock();
+
+  // put the image back where readahead left it, it may be resumed
+  const CDImage::LBA prev_lba = m_media->GetPositionOnDisc();
+  buffer.result = InternalReadSectorUncached(lba, &buffer.subq, &buffer.data);
+  const bool reseek_result = m_media->Seek(prev_lba);
+
+  lock.lock();
+  m_is_reading.store(false);
+  if (!reseek_result)
+  {
+    Log_ErrorPrintf("Failed to re-seek to LBA %u after prefetching", prev_lba);
+    m_can_readahead.store(false);
+  }
+
+  if (buffer.result)
+    m_prefetched_sectors.emplace(lba, buffer);
+  m_notify_read_complete_cv.notify_all();
+}
+
+void CDROMAsyncReader::HintReadahead(std::unique_lock<std::mutex>& lock)
+{
+  // Only re-hinted once the position is halfway through the last window, or has left it, so sequential reads don't
+  // make a call into the kernel for every batch.
+  const CDImage::LBA lba = m_media->GetPositionOnDisc();
+  if (lba >= m_readahead_hint_start && (lba + READAHEAD_HINT_SECTORS / 2) <= m_readahead_hint_end)
+    return;
+
+  m_readahead_hint_start = lba;
+  m_readahead_hint_end = lba + READAHEAD_HINT_SECTORS;
+  m_is_reading.store(true);
+  lock.unlock();
+
+  Log_TracePrintf("Hinting readahead of LBA %u-%u", lba, lba + READAHEAD_HINT_SECTORS - 1);
+  m_media->Readahead(READAHEAD_HINT_SECTORS);
+
+  lock.lock();
+  m_is_reading.store(false);
+  m_notify_read_complete_cv.notify_all();
+}
+
 bool CDROMAsyncReader::ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock)
 {
   Common::Timer timer;
 
+  const CDImage::LBA lba = m_media->GetPositionOnDisc();
+  if (ReadSectorFromCache(lba))
+  {
+    // still have to move the image past it
+    m_is_reading.store(true);
+    lock.unlock();
+    const bool seek_result = m_media->Seek(lba + 1);
+    lock.lock();
+    m_is_reading.store(false);
+    m_notify_read_complete_cv.notify_all();
+    return seek_result;
+  }
+
   const u32 slot = m_buffer_back.load();
   m_buffer_back.store((slot + 1) % static_cast<u32>(m_buffers.size()));
 
   BufferSlot& buffer = m_buffers[slot];
-  buffer.lba = m_media->GetPositionOnDisc();
+  buffer.lba = lba;
   m_is_reading.store(true);
   lock.unlock();
 
   Log_TracePrintf("Reading LBA %u...", buffer.lba);
 
   buffer.result = m_media->ReadRawSector(buffer.data.data(), &buffer.subq);
+  const double read_time = timer.GetTimeMilliseconds();
   if (buffer.result)
   {
-    const double read_time = timer.GetTimeMilliseconds();
     if (read_time > 1.0f)
       Log_DevPrintf("Read LBA %u took %.2f msec", buffer.lba, read_time);
   }
@@ -252,8 +464,15 @@ bool CDROMAsyncReader::ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock)
     Log_ErrorPrintf("Read of LBA %u failed", buffer.lba);
   }
 
+  // only the worker writes this, so no need for a compare-exchange loop
+  const float prev_read_time = m_average_read_time.load(std::memory_order_relaxed);
+  m_average_read_time.store(prev_read_time + (static_cast<float>(read_time) - prev_read_time) * 0.1f,
+                            std::memory_order_relaxed);
+
   lock.lock();
   m_is_reading.store(false);
+  if (buffer.result)
+    m_sector_cache.Insert(buffer.lba, buffer);
   m_buffer_count.fetch_add(1);
   m_notify_read_complete_cv.notify_all();
   return true;
@@ -306,16 +525,22 @@ void CDROMAsyncReader::CancelReadahead()
   // prevent it from doing any more when it re-acquires the lock
   m_can_readahead.store(false);
   EmptyBuffers();
+  ClearSectorCache();
 }
 
 void CDROMAsyncReader::WorkerThreadEntryPoint()
 {
+  Threading::SetNameOfCurrentThread("CDROM Reader");
+  System::ApplyThreadCorePlacement(false);
+
   std::unique_lock lock(m_mutex);
 
   for (;;)
   {
-    m_do_read_cv.wait(
-      lock, [this]() { return (m_shutdown_flag.load() || m_next_position_set.load() || m_can_readahead.load()); });
+    m_do_read_cv.wait(lock, [this]() {
+      return (m_shutdown_flag.load() || m_next_position_set.load() || m_can_readahead.load() ||
+              !m_prefetch_queue.empty());
+    });
     if (m_shutdown_flag.load())
       break;
 
@@ -328,12 +553,16 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
         EmptyBuffers();
         m_next_position_set.store(false);
         m_seek_error.store(false);
+
+        // recently read or prefetched sectors can be returned straight away, and readahead starts after them
+        const bool cached = ReadSectorFromCache(seek_location);
+        const CDImage::LBA read_location = cached ? (seek_location + 1) : seek_location;
         m_is_reading.store(true);
         lock.unlock();
 
         // seek without lock held in case it takes time
-        Log_DebugPrintf("Seeking to LBA %u...", seek_location);
-        const bool seek_result = (m_media->GetPositionOnDisc() == seek_location || m_media->Seek(seek_location));
+        Log_DebugPrintf("Seeking to LBA %u...", read_location);
+        const bool seek_result = (m_media->GetPositionOnDisc() == read_location || m_media->Seek(read_location));
 
         lock.lock();
         m_is_reading.store(false);
@@ -342,6 +571,10 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
         if (m_next_position_set.load())
           continue;
 
+        // past the end of the disc, but we still have the sector which was asked for
+        if (!seek_result && cached)
+          break;
+
         // did we fail the seek?
         if (!seek_result)
         {
@@ -359,9 +592,11 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
       if (!m_can_readahead.load())
         break;
 
-      // readahead time! read as many sectors as we have space for
-      Log_DebugPrintf("Reading ahead %u sectors...", static_cast<u32>(m_buffers.size()) - m_buffer_count.load());
-      while (m_buffer_count.load() < static_cast<u32>(m_buffers.size()))
+      // readahead time! read as many sectors as the current depth allows
+      Log_DebugPrintf("Reading ahead %u sectors...", m_readahead_depth.load() - std::min(m_buffer_count.load(),
+                                                                                         m_readahead_depth.load()));
+      HintReadahead(lock);
+      while (m_buffer_count.load() < m_readahead_depth.load())
       {
         if (m_next_position_set.load())
         {
@@ -378,5 +613,9 @@ void CDROMAsyncReader::WorkerThreadEntryPoint()
       m_can_readahead.store(false);
       break;
     }
+
+    // nothing else to do, so fill in the likely seek targets a sector at a time
+    if (!m_next_position_set.load() && !m_can_readahead.load() && !m_prefetch_queue.empty())
+      PrefetchSector(lock);
   }
 }
@@ -3,11 +3,14 @@
 
 #pragma once
 #include "util/cd_image.h"
+#include "common/lru_cache.h"
 #include "types.h"
 #include <array>
 #include <atomic>
 #include <condition_variable>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 class ProgressCallback;
 
@@ -32,13 +35,14 @@ public:
   const CDImage::SubChannelQ& GetSectorSubQ() const { return m_buffers[m_buffer_front.load()].subq; }
   u32 GetBufferedSectorCount() const { return m_buffer_count.load(); }
   bool HasBufferedSectors() const { return (m_buffer_count.load() > 0); }
-  u32 GetReadaheadCount() const { return static_cast<u32>(m_buffers.size()); }
+  u32 GetReadaheadCount() const { return m_readahead_count; }
 
   bool HasMedia() const { return static_cast<bool>(m_media); }
   const CDImage* GetMedia() const { return m_media.get(); }
   const std::string& GetMediaFileName() const { return m_media->GetFileName(); }
 
   bool IsUsingThread() const { return m_read_thread.joinable(); }
+  /// Readahead count is the minimum depth, it grows when reads are slow compared to how fast sectors are used.
   void StartThread(u32 readahead_count = 8);
   void StopThread();
 
@@ -46,7 +50,7 @@ public:
   std::unique_ptr<CDImage> RemoveMedia();
 
   /// Precaches image, either to memory, or using the underlying image precache.
-  bool Precache(ProgressCallback* callback);
+  bool Precache(ProgressCallback* callback, bool shared);
 
   void QueueReadSector(CDImage::LBA lba);
 
@@ -57,8 +61,28 @@ public:
   bool ReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
 
 private:
+  /// Upper limit for the readahead depth when it's adapting to slow storage.
+  static constexpr u32 MAX_READAHEAD_COUNT = 64;
+
+  /// Recently-read sectors, so short seeks back (e.g. re-reading a file header) don't go to the image.
+  static constexpr u32 SECTOR_CACHE_SIZE = 128;
+
+  /// Number of sectors prefetched at the start of each file on the disc, and the maximum number of files.
+  static constexpr u32 PREFETCH_SECTORS_PER_FILE = 2;
+  static constexpr u32 MAX_PREFETCH_FILES = 512;
+
+  /// Number of sectors past the read position which the image is asked to fetch in the background. Much deeper than
+  /// the readahead buffers, so the reads are queued at the disk well before the worker blocks on them.
+  static constexpr u32 READAHEAD_HINT_SECTORS = 256;
+
   void EmptyBuffers();
+  void ClearSectorCache();
+  bool ReadSectorFromCache(CDImage::LBA lba);
   bool ReadSectorIntoBuffer(std::unique_lock<std::mutex>& lock);
+  void PrefetchSector(std::unique_lock<std::mutex>& lock);
+  void HintReadahead(std::unique_lock<std::mutex>& lock);
+  void QueueFilePrefetch();
+  void UpdateReadaheadDepth();
   void ReadSectorNonThreaded(CDImage::LBA lba);
   bool InternalReadSectorUncached(CDImage::LBA lba, CDImage::SubChannelQ* subq, SectorBuffer* data);
   void CancelReadahead();
@@ -84,4 +108,18 @@ private:
   std::atomic<u32> m_buffer_front{0};
   std::atomic<u32> m_buffer_back{0};
   std::atomic<u32> m_buffer_count{0};
+
+  // Buffers are allocated for the maximum depth, the worker only fills up to the current depth.
+  u32 m_readahead_count = 0;
+  std::atomic<u32> m_readahead_depth{0};
+  std::atomic<float> m_average_read_time{0.0f};
+  float m_average_queue_interval = 0.0f;
+  u64 m_last_queue_time = 0;
+
+  // Protected by m_mutex.
+  LRUCache<CDImage::LBA, BufferSlot> m_sector_cache{SECTOR_CACHE_SIZE};
+  std::unordered_map<CDImage::LBA, BufferSlot> m_prefetched_sectors;
+  std::vector<CDImage::LBA> m_prefetch_queue;
+  CDImage::LBA m_readahead_hint_start = 0;
+  CDImage::LBA m_readahead_hint_end = 0;
 };
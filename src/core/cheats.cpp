@@ -6,21 +6,79 @@
 #include "common/assert.h"
 #include "common/byte_stream.h"
 #include "common/file_system.h"
+#include "common/heterogeneous_containers.h"
+#include "common/intrin.h"
 #include "common/log.h"
+#include "common/memmap.h"
+#include "common/path.h"
 #include "common/small_string.h"
 #include "common/string_util.h"
 #include "controller.h"
 #include "cpu_code_cache.h"
 #include "cpu_core.h"
 #include "host.h"
+#include "settings.h"
 #include "system.h"
+#include "xxhash.h"
+#include <atomic>
 #include <cctype>
 #include <iomanip>
+#include <mutex>
+#include <span>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 Log_SetChannel(Cheats);
 static std::array<u32, 256> cht_register; // Used for D7 ,51 & 52 cheat types
 
+namespace {
+enum : u32
+{
+  CHEAT_DATABASE_CACHE_SIGNATURE = 0x42444843,
+  CHEAT_DATABASE_CACHE_VERSION = 1,
+};
+
+// Index of the games in chtdb.txt, so a lookup doesn't have to parse the whole database. Like the game database cache,
+// it's used in-place. It consists of a header, one entry per serial, an open-addressed hash table of entry indices
+// keyed by serial, and the serials and each game's block of codes copied out of the database.
+struct CheatDatabaseCacheHeader
+{
+  u32 signature;
+  u32 version;
+  u64 chtdb_timestamp;
+  u32 entry_count;
+  u32 index_size; // power of two, entries are entry index + 1, zero for an empty bucket
+  u32 entries_offset;
+  u32 index_offset;
+  u32 data_offset;
+  u32 data_size;
+};
+
+struct CheatDatabaseCacheEntry
+{
+  u64 serial_hash;
+  u32 serial_offset;
+  u32 serial_length;
+  u32 block_offset;
+  u32 block_length;
+};
+static_assert(sizeof(CheatDatabaseCacheHeader) == 40 && sizeof(CheatDatabaseCacheEntry) == 24);
+} // namespace
+
+static void EnsureCheatDatabaseLoaded();
+static bool LoadCheatDatabaseCache(u64 chtdb_ts);
+static void ReleaseCheatDatabaseCache();
+static void BuildCheatDatabaseCache(const std::string& db, u64 chtdb_ts);
+static bool SaveCheatDatabaseCache();
+static std::optional<std::string_view> FindCheatDatabaseBlock(std::string_view serial);
+
+static std::atomic_bool s_cheat_database_loaded{false};
+static std::mutex s_cheat_database_mutex;
+static std::span<const u8> s_cheat_database_cache;
+static std::vector<u8> s_cheat_database_cache_data;
+static void* s_cheat_database_cache_mapping = nullptr;
+static size_t s_cheat_database_cache_mapping_size = 0;
+
 using KeyValuePairVector = std::vector<std::pair<std::string, std::string>>;
 
 static bool IsValidScanAddress(PhysicalMemoryAddress address)
@@ -58,6 +116,35 @@ static T DoMemoryRead(VirtualMemoryAddress address)
     return CPU::SafeReadMemoryWord(address, &result) ? result : static_cast<T>(0);
 }
 
+/// Returns true if the scan value at this address can be read straight out of RAM, skipping the bus.
+template<typename T>
+ALWAYS_INLINE static bool IsDirectScanAddress(PhysicalMemoryAddress address)
+{
+  // KSEG2 doesn't map to RAM, the lower segments mirror it.
+  return (address < 0xC0000000u && (address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK) < Bus::RAM_MIRROR_END &&
+          (address % sizeof(T)) == 0);
+}
+
+template<typename T>
+static T DoScanRead(PhysicalMemoryAddress address)
+{
+  if (!IsDirectScanAddress<T>(address))
+    return DoMemoryRead<T>(address);
+
+  T value;
+  std::memcpy(&value, &Bus::g_unprotected_ram[address & Bus::g_ram_mask], sizeof(T));
+  return value;
+}
+
+template<typename T>
+ALWAYS_INLINE static u32 ExtendScanValue(T value, bool is_signed)
+{
+  if constexpr (std::is_same_v<T, u32>)
+    return value;
+  else
+    return is_signed ? SignExtend32(value) : ZeroExtend32(value);
+}
+
 template<typename T>
 static void DoMemoryWrite(PhysicalMemoryAddress address, T value)
 {
@@ -687,17 +774,279 @@ bool CheatList::SaveToPCSXRFile(const char* filename)
   return (std::ferror(fp.get()) == 0);
 }
 
+static std::string GetCheatDatabaseCacheFile()
+{
+  return Path::Combine(EmuFolders::Cache, "chtdb.cache");
+}
+
+void EnsureCheatDatabaseLoaded()
+{
+  if (s_cheat_database_loaded.load(std::memory_order_acquire))
+    return;
+
+  std::unique_lock lock(s_cheat_database_mutex);
+  if (s_cheat_database_loaded.load(std::memory_order_relaxed))
+    return;
+
+  const u64 chtdb_ts = Host::GetResourceFileTimestamp("chtdb.txt").value_or(0);
+  if (!LoadCheatDatabaseCache(chtdb_ts))
+  {
+    ReleaseCheatDatabaseCache();
+
+    const std::optional<std::string> db_string(Host::ReadResourceFileToString("chtdb.txt"));
+    if (db_string.has_value())
+    {
+      BuildCheatDatabaseCache(db_string.value(), chtdb_ts);
+      SaveCheatDatabaseCache();
+    }
+  }
+
+  s_cheat_database_loaded.store(true, std::memory_order_release);
+}
+
+bool LoadCheatDatabaseCache(u64 chtdb_ts)
+{
+  s_cheat_database_cache_mapping =
+    MemMap::MapFileReadOnly(GetCheatDatabaseCacheFile().c_str(), &s_cheat_database_cache_mapping_size);
+  if (!s_cheat_database_cache_mapping)
+  {
+    Log_DevPrintf("Cheat database cache does not exist, indexing database.");
+    return false;
+  }
+
+  s_cheat_database_cache = std::span<const u8>(static_cast<const u8*>(s_cheat_database_cache_mapping),
+                                               s_cheat_database_cache_mapping_size);
+
+  // only the layout is checked here, entries are bounds checked when they're looked up
+  CheatDatabaseCacheHeader header;
+  if (s_cheat_database_cache.size() < sizeof(header))
+    return false;
+
+  std::memcpy(&header, s_cheat_database_cache.data(), sizeof(header));
+  if (header.signature != CHEAT_DATABASE_CACHE_SIGNATURE || header.version != CHEAT_DATABASE_CACHE_VERSION ||
+      header.chtdb_timestamp != chtdb_ts)
+  {
+    Log_DevPrintf("Cheat database cache is out of date, recreating.");
+    return false;
+  }
+
+  const u64 entries_offset = sizeof(CheatDatabaseCacheHeader);
+  const u64 index_offset = entries_offset + (static_cast<u64>(header.entry_count) * sizeof(CheatDatabaseCacheEntry));
+  const u64 data_offset = index_offset + (static_cast<u64>(header.index_size) * sizeof(u32));
+  if (header.entries_offset != entries_offset || header.index_offset != index_offset ||
+      header.data_offset != data_offset ||
+      (static_cast<u64>(header.data_offset) + header.data_size) != s_cheat_database_cache.size() ||
+      header.index_size == 0 || (header.index_size & (header.index_size - 1)) != 0 ||
+      header.index_size < header.entry_count)
+  {
+    Log_DevPrintf("Cheat database cache layout is corrupted.");
+    return false;
+  }
+
+  return true;
+}
+
+void ReleaseCheatDatabaseCache()
+{
+  s_cheat_database_cache = {};
+  s_cheat_database_cache_data = {};
+  if (s_cheat_database_cache_mapping)
+  {
+    MemMap::UnmapFile(s_cheat_database_cache_mapping, s_cheat_database_cache_mapping_size);
+    s_cheat_database_cache_mapping = nullptr;
+    s_cheat_database_cache_mapping_size = 0;
+  }
+}
+
+void BuildCheatDatabaseCache(const std::string& db, u64 chtdb_ts)
+{
+  std::vector<CheatDatabaseCacheEntry> entries;
+  std::string data;
+  PreferUnorderedStringSet serials;
+
+  // Several serials can share one block of codes, by listing their headers one after another. A block runs until the
+  // next header which follows some codes.
+  std::vector<std::pair<u32, std::string_view>> pending_serials;
+  size_t block_start = 0;
+  bool block_has_codes = false;
+  const auto flush_block = [&](size_t block_end) {
+    if (!pending_serials.empty())
+    {
+      const std::string_view block(db.data() + block_start, block_end - block_start);
+      const u32 block_offset = static_cast<u32>(data.size());
+      data.append(block);
+      for (const auto& [serial_offset, serial] : pending_serials)
+      {
+        entries.push_back(CheatDatabaseCacheEntry{XXH64(serial.data(), serial.length(), 0), serial_offset,
+                                                  static_cast<u32>(serial.length()), block_offset,
+                                                  static_cast<u32>(block.length())});
+      }
+    }
+
+    pending_serials.clear();
+    block_has_codes = false;
+  };
+
+  for (size_t pos = 0; pos < db.size();)
+  {
+    const size_t line_start = pos;
+    size_t line_end = db.find('\n', pos);
+    if (line_end == std::string::npos)
+      line_end = db.size();
+    pos = line_end + 1;
+
+    const std::string_view line =
+      StringUtil::StripWhitespace(std::string_view(db).substr(line_start, line_end - line_start));
+    if (line.empty() || line[0] == ';')
+      continue;
+
+    if (line[0] != ':')
+    {
+      block_has_codes = true;
+      continue;
+    }
+
+    if (block_has_codes)
+      flush_block(line_start);
+
+    // Serials which appear more than once use their first block, same as searching the database from the top.
+    const std::string_view serial = line.substr(1);
+    if (!serial.empty() && serials.emplace(serial).second)
+    {
+      pending_serials.emplace_back(static_cast<u32>(data.size()), serial);
+      data.append(serial);
+    }
+
+    block_start = std::min(pos, db.size());
+  }
+  flush_block(db.size());
+
+  u32 index_size = 16;
+  while (index_size < (entries.size() * 2))
+    index_size *= 2;
+
+  std::vector<u32> index(index_size, 0);
+  for (size_t i = 0; i < entries.size(); i++)
+  {
+    u32 bucket = static_cast<u32>(entries[i].serial_hash) & (index_size - 1);
+    while (index[bucket] != 0)
+      bucket = (bucket + 1) & (index_size - 1);
+    index[bucket] = static_cast<u32>(i + 1);
+  }
+
+  CheatDatabaseCacheHeader header = {};
+  header.signature = CHEAT_DATABASE_CACHE_SIGNATURE;
+  header.version = CHEAT_DATABASE_CACHE_VERSION;
+  header.chtdb_timestamp = chtdb_ts;
+  header.entry_count = static_cast<u32>(entries.size());
+  header.index_size = index_size;
+  header.entries_offset = sizeof(CheatDatabaseCacheHeader);
+  header.index_offset = header.entries_offset + static_cast<u32>(entries.size() * sizeof(CheatDatabaseCacheEntry));
+  header.data_offset = header.index_offset + static_cast<u32>(index.size() * sizeof(u32));
+  header.data_size = static_cast<u32>(data.size());
+
+  s_cheat_database_cache_data.resize(header.data_offset + data.size());
+  u8* ptr = s_cheat_database_cache_data.data();
+  std::memcpy(ptr, &header, sizeof(header));
+  std::memcpy(ptr + header.entries_offset, entries.data(), entries.size() * sizeof(CheatDatabaseCacheEntry));
+  std::memcpy(ptr + header.index_offset, index.data(), index.size() * sizeof(u32));
+  std::memcpy(ptr + header.data_offset, data.data(), data.size());
+  s_cheat_database_cache = s_cheat_database_cache_data;
+
+  Log_DevPrintf("Indexed %zu games in cheat database.", entries.size());
+}
+
+bool SaveCheatDatabaseCache()
+{
+  const std::string cache_filename(GetCheatDatabaseCacheFile());
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(cache_filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE |
+                                                   BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_ATOMIC_UPDATE);
+  if (!stream)
+    return false;
+
+  if (!stream->Write2(s_cheat_database_cache.data(), static_cast<u32>(s_cheat_database_cache.size())) ||
+      !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to write cheat database cache '%s'", cache_filename.c_str());
+    stream->Discard();
+    return false;
+  }
+
+  return true;
+}
+
+std::optional<std::string_view> FindCheatDatabaseBlock(std::string_view serial)
+{
+  if (serial.empty())
+    return std::nullopt;
+
+  EnsureCheatDatabaseLoaded();
+  if (s_cheat_database_cache.empty())
+    return std::nullopt;
+
+  CheatDatabaseCacheHeader header;
+  std::memcpy(&header, s_cheat_database_cache.data(), sizeof(header));
+
+  const u8* entries = s_cheat_database_cache.data() + header.entries_offset;
+  const u8* index = s_cheat_database_cache.data() + header.index_offset;
+  const char* data = reinterpret_cast<const char*>(s_cheat_database_cache.data()) + header.data_offset;
+  const auto in_data = [&header](u32 offset, u32 length) {
+    return (offset <= header.data_size && length <= (header.data_size - offset));
+  };
+
+  const u64 serial_hash = XXH64(serial.data(), serial.length(), 0);
+  const u32 index_mask = header.index_size - 1;
+  for (u32 bucket = static_cast<u32>(serial_hash) & index_mask, probes = 0; probes < header.index_size;
+       bucket = (bucket + 1) & index_mask, probes++)
+  {
+    u32 slot;
+    std::memcpy(&slot, index + (bucket * sizeof(u32)), sizeof(slot));
+    if (slot == 0 || slot > header.entry_count)
+      break;
+
+    CheatDatabaseCacheEntry entry;
+    std::memcpy(&entry, entries + ((slot - 1) * sizeof(CheatDatabaseCacheEntry)), sizeof(entry));
+    if (entry.serial_hash != serial_hash || !in_data(entry.serial_offset, entry.serial_length) ||
+        std::string_view(data + entry.serial_offset, entry.serial_length) != serial)
+    {
+      continue;
+    }
+
+    if (!in_data(entry.block_offset, entry.block_length))
+    {
+      Log_WarningPrintf("Cheat database cache entry is corrupted");
+      return std::nullopt;
+    }
+
+    return std::string_view(data + entry.block_offset, entry.block_length);
+  }
+
+  return std::nullopt;
+}
+
+bool CheatList::HasPackageCodes(const std::string_view& serial)
+{
+  return FindCheatDatabaseBlock(serial).has_value();
+}
+
 bool CheatList::LoadFromPackage(const std::string& serial)
 {
-  const std::optional<std::string> db_string(Host::ReadResourceFileToString("chtdb.txt"));
-  if (!db_string.has_value())
+  const std::optional<std::string_view> block = FindCheatDatabaseBlock(serial);
+  if (!block.has_value())
+  {
+    Log_WarningPrintf("No codes found in package for %s", serial.c_str());
     return false;
+  }
 
-  std::istringstream iss(db_string.value());
+  std::istringstream iss{std::string(block.value())};
   std::string line;
+  char* start;
+  char* end;
+  CheatCode current_code;
   while (std::getline(iss, line))
   {
-    char* start = line.data();
+    start = line.data();
     while (*start != '\0' && std::isspace(SignedCharToInt(*start)))
       start++;
 
@@ -705,7 +1054,7 @@ bool CheatList::LoadFromPackage(const std::string& serial)
     if (*start == '\0' || *start == ';')
       continue;
 
-    char* end = start + std::strlen(start) - 1;
+    end = start + std::strlen(start) - 1;
     while (end > start && std::isspace(SignedCharToInt(*end)))
     {
       *end = '\0';
@@ -715,88 +1064,64 @@ bool CheatList::LoadFromPackage(const std::string& serial)
     if (start == end)
       continue;
 
-    if (start[0] != ':' || std::strcmp(&start[1], serial.c_str()) != 0)
+    // stop adding codes when we hit a different game, other serials sharing this block come before any codes
+    if (start[0] == ':')
+    {
+      if (!m_codes.empty() || current_code.Valid())
+        break;
+
       continue;
+    }
 
-    // game code match
-    CheatCode current_code;
-    while (std::getline(iss, line))
+    if (start[0] == '#')
     {
-      start = line.data();
-      while (*start != '\0' && std::isspace(SignedCharToInt(*start)))
-        start++;
-
-      // skip empty lines
-      if (*start == '\0' || *start == ';')
-        continue;
+      start++;
 
-      end = start + std::strlen(start) - 1;
-      while (end > start && std::isspace(SignedCharToInt(*end)))
+      if (current_code.Valid())
       {
-        *end = '\0';
-        end--;
+        m_codes.push_back(std::move(current_code));
+        current_code = CheatCode();
       }
 
-      if (start == end)
-        continue;
-
-      // stop adding codes when we hit a different game
-      if (start[0] == ':' && (!m_codes.empty() || current_code.Valid()))
-        break;
-
-      if (start[0] == '#')
+      // new code
+      char* slash = std::strrchr(start, '\\');
+      if (slash)
       {
-        start++;
-
-        if (current_code.Valid())
-        {
-          m_codes.push_back(std::move(current_code));
-          current_code = CheatCode();
-        }
-
-        // new code
-        char* slash = std::strrchr(start, '\\');
-        if (slash)
-        {
-          *slash = '\0';
-          current_code.group = start;
-          start = slash + 1;
-        }
-        if (current_code.group.empty())
-          current_code.group = "Ungrouped";
-
-        current_code.description = start;
-        continue;
+        *slash = '\0';
+        current_code.group = start;
+        start = slash + 1;
       }
+      if (current_code.group.empty())
+        current_code.group = "Ungrouped";
 
-      while (!IsHexCharacter(*start) && start != end)
-        start++;
-      if (start == end)
-        continue;
-
-      char* end_ptr;
-      CheatCode::Instruction inst;
-      inst.first = static_cast<u32>(std::strtoul(start, &end_ptr, 16));
-      inst.second = 0;
-      if (end_ptr)
-      {
-        while (!IsHexCharacter(*end_ptr) && end_ptr != end)
-          end_ptr++;
-        if (end_ptr != end)
-          inst.second = static_cast<u32>(std::strtoul(end_ptr, nullptr, 16));
-      }
-      current_code.instructions.push_back(inst);
+      current_code.description = start;
+      continue;
     }
 
-    if (current_code.Valid())
-      m_codes.push_back(std::move(current_code));
+    while (!IsHexCharacter(*start) && start != end)
+      start++;
+    if (start == end)
+      continue;
 
-    Log_InfoPrintf("Loaded %zu codes from package for %s", m_codes.size(), serial.c_str());
-    return !m_codes.empty();
+    char* end_ptr;
+    CheatCode::Instruction inst;
+    inst.first = static_cast<u32>(std::strtoul(start, &end_ptr, 16));
+    inst.second = 0;
+    if (end_ptr)
+    {
+      while (!IsHexCharacter(*end_ptr) && end_ptr != end)
+        end_ptr++;
+      if (end_ptr != end)
+        inst.second = static_cast<u32>(std::strtoul(end_ptr, nullptr, 16));
+    }
+    current_code.instructions.push_back(inst);
   }
 
-  Log_WarningPrintf("No codes found in package for %s", serial.c_str());
-  return false;
+  if (current_code.Valid())
+    m_codes.push_back(std::move(current_code));
+
+  Log_InfoPrintf("Loaded %zu codes from package for %s", m_codes.size(), serial.c_str());
+  return !m_codes.empty();
 }
 
 u32 CheatList::GetEnabledCodeCount() const
@@ -948,6 +1273,8 @@ bool CheatCode::SetInstructionsFromString(const std::string& str)
     return false;
 
   instructions = std::move(new_instructions);
+  compile_state = CompileState::NotCompiled;
+  compiled_instructions.clear();
   return true;
 }
 
@@ -990,8 +1317,193 @@ u32 CheatCode::GetNextNonConditionalInstruction(u32 index) const
   return index;
 }
 
+ALWAYS_INLINE static u8* GetCompiledInstructionPointer(const CheatCode::CompiledInstruction& ci)
+{
+  return ci.scratchpad ? &CPU::g_state.scratchpad[ci.offset] : &Bus::g_unprotected_ram[ci.offset & Bus::g_ram_mask];
+}
+
+template<typename T>
+ALWAYS_INLINE static T ReadCompiledInstruction(const CheatCode::CompiledInstruction& ci)
+{
+  T value;
+  std::memcpy(&value, GetCompiledInstructionPointer(ci), sizeof(T));
+  return value;
+}
+
+template<typename T>
+ALWAYS_INLINE static void WriteCompiledInstruction(const CheatCode::CompiledInstruction& ci, T value)
+{
+  // Same as a safe write, recompiled code in the page has to be thrown away if the value changes.
+  u8* ptr = GetCompiledInstructionPointer(ci);
+  T old_value;
+  std::memcpy(&old_value, ptr, sizeof(T));
+  if (old_value == value)
+    return;
+
+  std::memcpy(ptr, &value, sizeof(T));
+  if (!ci.scratchpad)
+  {
+    const u32 offset = ci.offset & Bus::g_ram_mask;
+    if (Bus::g_ram_code_bits[offset / HOST_PAGE_SIZE])
+      CPU::CodeCache::InvalidateBlocksWithRAMWrite(offset, sizeof(T));
+  }
+}
+
+template<typename T>
+ALWAYS_INLINE static u32 ExecuteCompiledInstruction(const CheatCode::CompiledInstruction& ci, u32 index)
+{
+  using Op = CheatCode::CompiledInstruction::Op;
+  const T value = static_cast<T>(ci.value);
+  switch (ci.op)
+  {
+    case Op::Write:
+      WriteCompiledInstruction<T>(ci, value);
+      break;
+    case Op::BitSet:
+      WriteCompiledInstruction<T>(ci, ReadCompiledInstruction<T>(ci) | value);
+      break;
+    case Op::BitClear:
+      WriteCompiledInstruction<T>(ci, ReadCompiledInstruction<T>(ci) & static_cast<T>(~value));
+      break;
+    case Op::Add:
+      WriteCompiledInstruction<T>(ci, static_cast<T>(ReadCompiledInstruction<T>(ci) + value));
+      break;
+    case Op::Subtract:
+      WriteCompiledInstruction<T>(ci, static_cast<T>(ReadCompiledInstruction<T>(ci) - value));
+      break;
+    case Op::ContinueIfEqual:
+      return (ReadCompiledInstruction<T>(ci) == value) ? (index + 1) : ci.skip_index;
+    case Op::ContinueIfNotEqual:
+      return (ReadCompiledInstruction<T>(ci) != value) ? (index + 1) : ci.skip_index;
+    case Op::ContinueIfLess:
+      return (ReadCompiledInstruction<T>(ci) < value) ? (index + 1) : ci.skip_index;
+    case Op::ContinueIfGreater:
+      return (ReadCompiledInstruction<T>(ci) > value) ? (index + 1) : ci.skip_index;
+    default:
+      break;
+  }
+
+  return index + 1;
+}
+
+bool CheatCode::Compile() const
+{
+  using Op = CompiledInstruction::Op;
+
+  compile_state = CompileState::Unsupported;
+  compiled_instructions.clear();
+  compiled_instructions.reserve(instructions.size());
+
+  const u32 count = static_cast<u32>(instructions.size());
+  for (u32 index = 0; index < count; index++)
+  {
+    const Instruction& inst = instructions[index];
+    CompiledInstruction ci = {};
+    u32 address = inst.address;
+
+    switch (inst.code)
+    {
+      // clang-format off
+      case InstructionCode::Nop:                    ci.op = Op::Nop; ci.size = 1; break;
+      case InstructionCode::ConstantWrite8:         ci.op = Op::Write; ci.size = 1; break;
+      case InstructionCode::ConstantWrite16:        ci.op = Op::Write; ci.size = 2; break;
+      case InstructionCode::ExtConstantWrite32:     ci.op = Op::Write; ci.size = 4; break;
+      case InstructionCode::ExtConstantBitSet8:     ci.op = Op::BitSet; ci.size = 1; break;
+      case InstructionCode::ExtConstantBitSet16:    ci.op = Op::BitSet; ci.size = 2; break;
+      case InstructionCode::ExtConstantBitSet32:    ci.op = Op::BitSet; ci.size = 4; break;
+      case InstructionCode::ExtConstantBitClear8:   ci.op = Op::BitClear; ci.size = 1; break;
+      case InstructionCode::ExtConstantBitClear16:  ci.op = Op::BitClear; ci.size = 2; break;
+      case InstructionCode::ExtConstantBitClear32:  ci.op = Op::BitClear; ci.size = 4; break;
+      case InstructionCode::Increment8:             ci.op = Op::Add; ci.size = 1; break;
+      case InstructionCode::Increment16:            ci.op = Op::Add; ci.size = 2; break;
+      case InstructionCode::ExtIncrement32:         ci.op = Op::Add; ci.size = 4; break;
+      case InstructionCode::Decrement8:             ci.op = Op::Subtract; ci.size = 1; break;
+      case InstructionCode::Decrement16:            ci.op = Op::Subtract; ci.size = 2; break;
+      case InstructionCode::ExtDecrement32:         ci.op = Op::Subtract; ci.size = 4; break;
+      case InstructionCode::CompareEqual8:          ci.op = Op::ContinueIfEqual; ci.size = 1; break;
+      case InstructionCode::CompareEqual16:         ci.op = Op::ContinueIfEqual; ci.size = 2; break;
+      case InstructionCode::ExtCompareEqual32:      ci.op = Op::ContinueIfEqual; ci.size = 4; break;
+      case InstructionCode::CompareNotEqual8:       ci.op = Op::ContinueIfNotEqual; ci.size = 1; break;
+      case InstructionCode::CompareNotEqual16:      ci.op = Op::ContinueIfNotEqual; ci.size = 2; break;
+      case InstructionCode::ExtCompareNotEqual32:   ci.op = Op::ContinueIfNotEqual; ci.size = 4; break;
+      case InstructionCode::CompareLess8:           ci.op = Op::ContinueIfLess; ci.size = 1; break;
+      case InstructionCode::CompareLess16:          ci.op = Op::ContinueIfLess; ci.size = 2; break;
+      case InstructionCode::ExtCompareLess32:       ci.op = Op::ContinueIfLess; ci.size = 4; break;
+      case InstructionCode::CompareGreater8:        ci.op = Op::ContinueIfGreater; ci.size = 1; break;
+      case InstructionCode::CompareGreater16:       ci.op = Op::ContinueIfGreater; ci.size = 2; break;
+      case InstructionCode::ExtCompareGreater32:    ci.op = Op::ContinueIfGreater; ci.size = 4; break;
+      // clang-format on
+
+      case InstructionCode::ScratchpadWrite16:
+      case InstructionCode::ExtScratchpadWrite32:
+      {
+        ci.op = Op::Write;
+        ci.size = (inst.code == InstructionCode::ScratchpadWrite16) ? 2 : 4;
+        address = CPU::SCRATCHPAD_ADDR | (inst.address & CPU::SCRATCHPAD_OFFSET_MASK);
+      }
+      break;
+
+      default:
+        return false;
+    }
+
+    // Unaligned accesses get split up by the safe accessors, leave them to the interpreter.
+    if ((address % ci.size) != 0)
+      return false;
+
+    if ((address & CPU::SCRATCHPAD_ADDR_MASK) == CPU::SCRATCHPAD_ADDR)
+    {
+      if ((address & CPU::SCRATCHPAD_OFFSET_MASK) + ci.size > CPU::SCRATCHPAD_SIZE)
+        return false;
+
+      ci.scratchpad = true;
+      ci.offset = address & CPU::SCRATCHPAD_OFFSET_MASK;
+    }
+    else if ((address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK) < Bus::RAM_MIRROR_END)
+    {
+      ci.offset = address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+    }
+    else
+    {
+      return false;
+    }
+
+    ci.value = (ci.size == 1) ? inst.value8 : ((ci.size == 2) ? inst.value16 : inst.value32);
+    if (IsConditionalInstruction(inst.code))
+      ci.skip_index = GetNextNonConditionalInstruction(index);
+
+    compiled_instructions.push_back(ci);
+  }
+
+  compile_state = CompileState::Compiled;
+  return true;
+}
+
+void CheatCode::ApplyCompiled() const
+{
+  const u32 count = static_cast<u32>(compiled_instructions.size());
+  for (u32 index = 0; index < count;)
+  {
+    const CompiledInstruction& ci = compiled_instructions[index];
+    if (ci.size == 1)
+      index = ExecuteCompiledInstruction<u8>(ci, index);
+    else if (ci.size == 2)
+      index = ExecuteCompiledInstruction<u16>(ci, index);
+    else
+      index = ExecuteCompiledInstruction<u32>(ci, index);
+  }
+}
+
 void CheatCode::Apply() const
 {
+  if (compile_state == CompileState::NotCompiled)
+    Compile();
+  if (compile_state == CompileState::Compiled)
+  {
+    ApplyCompiled();
+    return;
+  }
+
   const u32 count = static_cast<u32>(instructions.size());
   u32 index = 0;
   for (; index < count;)
@@ -2831,15 +3343,15 @@ void MemoryScan::Search()
   switch (m_size)
   {
     case MemoryAccessSize::Byte:
-      SearchBytes();
+      SearchValues<u8>();
       break;
 
     case MemoryAccessSize::HalfWord:
-      SearchHalfwords();
+      SearchValues<u16>();
       break;
 
     case MemoryAccessSize::Word:
-      SearchWords();
+      SearchValues<u32>();
       break;
 
     default:
@@ -2847,82 +3359,179 @@ void MemoryScan::Search()
   }
 }
 
-void MemoryScan::SearchBytes()
+template<typename T>
+void MemoryScan::SearchValues()
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address++)
+  static constexpr u32 STRIDE = static_cast<u32>(sizeof(T));
+
+  PhysicalMemoryAddress address = m_start_address;
+  while (address < m_end_address)
   {
-    if (!IsValidScanAddress(address))
+    if (IsDirectScanAddress<T>(address))
+    {
+      // Scan up to the end of this mirror of RAM in one go.
+      const u32 offset = address & Bus::g_ram_mask;
+      const u32 count = std::min((Bus::g_ram_size - offset) / STRIDE, (m_end_address - address + STRIDE - 1) / STRIDE);
+      SearchRAMValues<T>(address, offset, count);
+      address += count * STRIDE;
       continue;
+    }
 
-    const u8 bvalue = DoMemoryRead<u8>(address);
+    if (IsValidScanAddress(address))
+    {
+      Result res;
+      res.address = address;
+      res.value = ExtendScanValue(DoMemoryRead<T>(address), m_signed);
+      res.last_value = res.value;
+      res.value_changed = false;
 
-    Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    res.last_value = res.value;
-    res.value_changed = false;
+      if (res.Filter(m_operator, m_value, m_signed))
+        m_results.push_back(res);
+    }
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+    address += STRIDE;
   }
 }
 
-void MemoryScan::SearchHalfwords()
+template<typename T>
+void MemoryScan::SearchRAMValues(PhysicalMemoryAddress address, u32 offset, u32 count)
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 2)
-  {
-    if (!IsValidScanAddress(address))
-      continue;
-
-    const u16 bvalue = DoMemoryRead<u16>(address);
+  const u8* ram = &Bus::g_unprotected_ram[offset];
+  u32 i = 0;
 
+  const auto add_result = [this, address](u32 index, T value) {
     Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
+    res.address = address + index * static_cast<u32>(sizeof(T));
+    res.value = ExtendScanValue(value, m_signed);
     res.last_value = res.value;
     res.value_changed = false;
-
     if (res.Filter(m_operator, m_value, m_signed))
       m_results.push_back(res);
-  }
-}
+  };
 
-void MemoryScan::SearchWords()
-{
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 4)
+  if (m_operator == Operator::Equal)
   {
-    if (!IsValidScanAddress(address))
-      continue;
+    // Searching for a value that doesn't fit in the access size can't match anything.
+    const T needle = static_cast<T>(m_value);
+    if (ExtendScanValue(needle, m_signed) != m_value)
+      return;
+
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+    // Find a match anywhere in 16 bytes at once, they're rare enough that the lanes can be checked afterwards.
+    static constexpr u32 VALUES_PER_VECTOR = 16 / sizeof(T);
+    const u32 vector_count = count & ~(VALUES_PER_VECTOR - 1);
+
+#if defined(CPU_ARCH_SSE)
+    __m128i vneedle;
+    if constexpr (sizeof(T) == 1)
+      vneedle = _mm_set1_epi8(static_cast<s8>(needle));
+    else if constexpr (sizeof(T) == 2)
+      vneedle = _mm_set1_epi16(static_cast<s16>(needle));
+    else
+      vneedle = _mm_set1_epi32(static_cast<s32>(needle));
+#endif
+
+    for (; i < vector_count; i += VALUES_PER_VECTOR)
+    {
+      const u8* ptr = ram + i * sizeof(T);
+      bool any_match;
+#if defined(CPU_ARCH_SSE)
+      const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+      __m128i eq;
+      if constexpr (sizeof(T) == 1)
+        eq = _mm_cmpeq_epi8(v, vneedle);
+      else if constexpr (sizeof(T) == 2)
+        eq = _mm_cmpeq_epi16(v, vneedle);
+      else
+        eq = _mm_cmpeq_epi32(v, vneedle);
+      any_match = (_mm_movemask_epi8(eq) != 0);
+#elif defined(CPU_ARCH_NEON)
+      if constexpr (sizeof(T) == 1)
+        any_match = (vmaxvq_u8(vceqq_u8(vld1q_u8(ptr), vdupq_n_u8(needle))) != 0);
+      else if constexpr (sizeof(T) == 2)
+        any_match = (vmaxvq_u16(vceqq_u16(vld1q_u16(reinterpret_cast<const u16*>(ptr)), vdupq_n_u16(needle))) != 0);
+      else
+        any_match = (vmaxvq_u32(vceqq_u32(vld1q_u32(reinterpret_cast<const u32*>(ptr)), vdupq_n_u32(needle))) != 0);
+#endif
+      if (!any_match)
+        continue;
 
-    Result res;
-    res.address = address;
-    res.value = DoMemoryRead<u32>(address);
-    res.last_value = res.value;
-    res.value_changed = false;
+      for (u32 j = 0; j < VALUES_PER_VECTOR; j++)
+      {
+        T value;
+        std::memcpy(&value, ptr + j * sizeof(T), sizeof(T));
+        if (value == needle)
+          add_result(i + j, value);
+      }
+    }
+#endif
+  }
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+  for (; i < count; i++)
+  {
+    T value;
+    std::memcpy(&value, ram + i * sizeof(T), sizeof(T));
+    add_result(i, value);
   }
 }
 
 void MemoryScan::SearchAgain()
 {
+  // Splitting only pays off for really broad searches, e.g. after the first scan at byte granularity.
+  static constexpr size_t PARALLEL_FILTER_THRESHOLD = 1000000;
+  const u32 num_threads =
+    (m_results.size() > PARALLEL_FILTER_THRESHOLD) ? std::max(std::thread::hardware_concurrency(), 1u) : 1u;
+
   ResultVector new_results;
-  new_results.reserve(m_results.size());
-  for (Result& res : m_results)
+  if (num_threads == 1)
   {
-    res.UpdateValue(m_size, m_signed);
+    new_results.reserve(m_results.size());
+    FilterResults(m_results.data(), m_results.data() + m_results.size(), &new_results);
+  }
+  else
+  {
+    const size_t chunk_size = (m_results.size() + num_threads - 1) / num_threads;
+    std::vector<ResultVector> chunk_results(num_threads);
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (u32 i = 0; i < num_threads; i++)
+    {
+      Result* begin = m_results.data() + std::min(i * chunk_size, m_results.size());
+      Result* end = m_results.data() + std::min((i + 1) * chunk_size, m_results.size());
+      threads.emplace_back([this, begin, end, out_results = &chunk_results[i]]() {
+        FilterResults(begin, end, out_results);
+      });
+    }
 
-    if (res.Filter(m_operator, m_value, m_signed))
+    size_t total_results = 0;
+    for (u32 i = 0; i < num_threads; i++)
     {
-      res.last_value = res.value;
-      new_results.push_back(res);
+      threads[i].join();
+      total_results += chunk_results[i].size();
     }
+
+    new_results.reserve(total_results);
+    for (const ResultVector& results : chunk_results)
+      new_results.insert(new_results.end(), results.begin(), results.end());
   }
 
   m_results.swap(new_results);
 }
 
+void MemoryScan::FilterResults(Result* begin, Result* end, ResultVector* out_results) const
+{
+  for (Result* res = begin; res != end; ++res)
+  {
+    res->UpdateValue(m_size, m_signed);
+
+    if (res->Filter(m_operator, m_value, m_signed))
+    {
+      res->last_value = res->value;
+      out_results->push_back(*res);
+    }
+  }
+}
+
 void MemoryScan::UpdateResultsValues()
 {
   for (Result& res : m_results)
@@ -3056,24 +3665,16 @@ void MemoryScan::Result::UpdateValue(MemoryAccessSize size, bool is_signed)
   switch (size)
   {
     case MemoryAccessSize::Byte:
-    {
-      u8 bvalue = DoMemoryRead<u8>(address);
-      value = is_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    }
-    break;
+      value = ExtendScanValue(DoScanRead<u8>(address), is_signed);
+      break;
 
     case MemoryAccessSize::HalfWord:
-    {
-      u16 bvalue = DoMemoryRead<u16>(address);
-      value = is_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    }
-    break;
+      value = ExtendScanValue(DoScanRead<u16>(address), is_signed);
+      break;
 
     case MemoryAccessSize::Word:
-    {
-      CPU::SafeReadMemoryWord(address, &value);
-    }
-    break;
+      value = DoScanRead<u32>(address);
+      break;
   }
 
   value_changed = (value != old_value);
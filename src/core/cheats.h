@@ -6,6 +6,7 @@
 #include "types.h"
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct CheatCode
@@ -107,6 +108,38 @@ struct CheatCode
     BitField<u64, u8, 0, 8> value8;
   };
 
+  /// Pre-decoded instruction for codes which only touch RAM and the scratchpad with simple operations.
+  struct CompiledInstruction
+  {
+    enum class Op : u8
+    {
+      Nop,
+      Write,
+      BitSet,
+      BitClear,
+      Add,
+      Subtract,
+      ContinueIfEqual,
+      ContinueIfNotEqual,
+      ContinueIfLess,
+      ContinueIfGreater,
+    };
+
+    Op op;
+    u8 size;         // access size in bytes
+    bool scratchpad; // offset is into the scratchpad instead of RAM
+    u32 offset;
+    u32 value;
+    u32 skip_index; // where conditionals go when they fail
+  };
+
+  enum class CompileState : u8
+  {
+    NotCompiled,
+    Compiled,
+    Unsupported,
+  };
+
   std::string group;
   std::string description;
   std::vector<Instruction> instructions;
@@ -115,6 +148,10 @@ struct CheatCode
   Activation activation = Activation::EndFrame;
   bool enabled = false;
 
+  // Built on the first Apply(), since most codes are constant writes that don't need the full interpreter.
+  mutable CompileState compile_state = CompileState::NotCompiled;
+  mutable std::vector<CompiledInstruction> compiled_instructions;
+
   ALWAYS_INLINE bool Valid() const { return !instructions.empty() && !description.empty(); }
   ALWAYS_INLINE bool IsManuallyActivated() const { return (activation == Activation::Manual); }
 
@@ -126,6 +163,10 @@ struct CheatCode
   void Apply() const;
   void ApplyOnDisable() const;
 
+  /// Tries to build compiled_instructions, falling back to the interpreter if any instruction isn't supported.
+  bool Compile() const;
+  void ApplyCompiled() const;
+
   static const char* GetTypeName(Type type);
   static const char* GetTypeDisplayName(Type type);
   static std::optional<Type> ParseTypeName(const char* str);
@@ -188,6 +229,10 @@ public:
 
   bool LoadFromPackage(const std::string& serial);
 
+  /// Returns true if the built-in database has codes for the serial. Only looks at the index, so it's cheap enough to
+  /// call for every entry in the game list.
+  static bool HasPackageCodes(const std::string_view& serial);
+
   void Apply();
 
   void ApplyCode(u32 index);
@@ -263,9 +308,11 @@ public:
   void SetResultValue(u32 index, u32 value);
 
 private:
-  void SearchBytes();
-  void SearchHalfwords();
-  void SearchWords();
+  template<typename T>
+  void SearchValues();
+  template<typename T>
+  void SearchRAMValues(PhysicalMemoryAddress address, u32 offset, u32 count);
+  void FilterResults(Result* begin, Result* end, ResultVector* out_results) const;
 
   u32 m_value = 0;
   MemoryAccessSize m_size = MemoryAccessSize::HalfWord;
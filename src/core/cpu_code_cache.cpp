@@ -7,14 +7,20 @@
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
 #include "cpu_recompiler_types.h"
+#include "cpu_trace.h"
 #include "settings.h"
 #include "system.h"
 #include "timing_event.h"
 
 #include "common/assert.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
 #include "common/intrin.h"
 #include "common/log.h"
 #include "common/memmap.h"
+#include "common/path.h"
+#include "common/timer.h"
+#include "common/trace_recorder.h"
 
 Log_SetChannel(CPU::CodeCache);
 
@@ -26,7 +32,11 @@ Log_SetChannel(CPU::CodeCache);
 #include "cpu_newrec_compiler.h"
 #endif
 
-#include <unordered_set>
+#include <algorithm>
+#include <cinttypes>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
 #include <zlib.h>
 
 namespace CPU::CodeCache {
@@ -52,6 +62,9 @@ static CodeLUT OffsetCodeLUTPointer(CodeLUT fake_ptr, u32 pc);
 static void AllocateLUTs();
 static void DeallocateLUTs();
 static void ResetCodeLUT();
+static void ClearBlockLUT();
+static CodeLUT AllocateCodeLUTTable(u32 table);
+static Block** AllocateBlockLUTTable(u32 table);
 static void SetCodeLUT(u32 pc, const void* function);
 static void InvalidateBlock(Block* block, BlockState new_state);
 static void ClearBlocks();
@@ -63,11 +76,15 @@ static bool RevalidateBlock(Block* block);
 PageProtectionMode GetProtectionModeForPC(u32 pc);
 PageProtectionMode GetProtectionModeForBlock(const Block* block);
 static bool ReadBlockInstructions(u32 start_pc, BlockInstructionList* instructions, BlockMetadata* metadata);
+static bool IsIdleLoop(u32 start_pc, const BlockInstructionList& instructions);
 static void FillBlockRegInfo(Block* block);
+static void PredecodeCachedInterpreterInstruction(const Instruction& inst, InstructionInfo* info);
 static void CopyRegInfo(InstructionInfo* dst, const InstructionInfo* src);
 static void SetRegAccess(InstructionInfo* inst, Reg reg, bool write);
 static void AddBlockToPageList(Block* block);
 static void RemoveBlockFromPageList(Block* block);
+static u64 GetCodeSubPageMask(u32 offset, u32 size);
+static bool IsCodeSubPageWrite(u32 offset, u32 size);
 
 static Common::PageFaultHandler::HandlerResult ExceptionHandler(void* exception_pc, void* fault_address, bool is_write);
 
@@ -80,8 +97,15 @@ template<PGXPMode pgxp_mode>
 // Function pointers are offset so that you don't need to subtract
 CodeLUTArray g_code_lut;
 static BlockLUTArray s_block_lut;
-static std::unique_ptr<const void*[]> s_lut_code_pointers;
-static std::unique_ptr<Block*[]> s_lut_block_pointers;
+
+// Tables are only allocated once a block is compiled in that 64KB region. Until then, reachable regions share a table
+// which goes to the compiler, unreachable regions share one which goes to the interpreter, and block lookups share an
+// empty table.
+static std::unique_ptr<const void*[]> s_lut_unreachable_code;
+static std::unique_ptr<const void*[]> s_lut_uncompiled_code;
+static std::unique_ptr<Block*[]> s_lut_empty_blocks;
+static std::vector<std::unique_ptr<const void*[]>> s_lut_code_tables;
+static std::vector<std::unique_ptr<Block*[]>> s_lut_block_tables;
 static PageProtectionArray s_page_protection = {};
 static std::vector<Block*> s_blocks;
 
@@ -92,6 +116,7 @@ static BlockInstructionList s_block_instructions;
 
 static void BacklinkBlocks(u32 pc, const void* dst);
 static void UnlinkBlockExits(Block* block);
+static BlockLink* TakePendingBlockLinks(u32 pc);
 
 static void ClearASMFunctions();
 static void CompileASMFunctions();
@@ -100,9 +125,57 @@ static Common::PageFaultHandler::HandlerResult HandleFastmemException(void* exce
                                                                       bool is_write);
 static void BackpatchLoadStore(void* host_pc, const LoadstoreBackpatchInfo& info);
 
-static BlockLinkMap s_block_links;
-static std::unordered_map<const void*, LoadstoreBackpatchInfo> s_fastmem_backpatch_info;
-static std::unordered_set<u32> s_fastmem_faulting_pcs;
+// Links to PCs which don't have a block yet, moved to the block when it's created. Blocks are kept in the LUT when
+// they're invalidated, so only the first compile of a PC touches this.
+static std::unordered_map<u32, BlockLink*> s_pending_block_links;
+
+// With deferred compilation, new blocks are interpreted this many times before being compiled. Code which only runs
+// once or twice, e.g. during loading, is never compiled, and bursts of new code get compiled over several frames.
+static constexpr u8 DEFERRED_COMPILE_INTERPRET_COUNT = 2;
+static std::unordered_map<u32, u8> s_deferred_compile_counts;
+
+// Persistent block cache, records the guest code of compiled blocks across sessions, so they can be compiled up-front
+// instead of whenever execution reaches them. The PCs of loads/stores which faulted on fastmem are kept with it, so
+// they are compiled as slowmem from the start, rather than faulting and being backpatched again every session.
+static constexpr u32 BLOCK_CACHE_SIGNATURE = 0x43424344; // DCBC
+static constexpr u32 BLOCK_CACHE_VERSION = 2;
+static constexpr u32 BLOCK_CACHE_MAX_ENTRIES = 65536;
+
+static std::string GetBlockCacheDirectory();
+static std::string GetBlockCacheFileName(System::GameHash hash);
+static const u8* GetBlockCacheCodePointer(u32 pc, u32 size);
+static void RecordBlocksInBlockCache();
+static void LoadBlockCache(System::GameHash hash);
+static void SaveBlockCache();
+
+static std::unordered_map<u32, std::vector<u32>> s_block_cache_entries;
+static std::vector<u32> s_block_cache_fastmem_faulting_pcs; // sorted
+static System::GameHash s_block_cache_game_hash = 0;
+static bool s_block_cache_loaded = false;
+static bool s_block_cache_dirty = false;
+
+// Block profiling, counts entries and approximate host time per guest block. Entries are keyed by PC, and survive the
+// blocks themselves being freed, so that invalidation/recompile storms show up in the report.
+struct BlockProfileEntry
+{
+  u32 pc;
+  u32 compiles;
+  u32 invalidations;
+  u32 interpreter_fallbacks;
+  u64 entries;
+  Common::Timer::Value host_time;
+  std::vector<u32> code;
+};
+
+static BlockProfileEntry& GetBlockProfileEntry(u32 pc);
+static void RecordBlockProfileInvalidation(u32 pc);
+static void RecordBlockProfileFallback(u32 pc);
+static void ClearBlockProfile();
+
+static std::vector<BlockProfileEntry> s_block_profile;
+static std::unordered_map<u32, u32> s_block_profile_lookup;
+static u32 s_block_profile_last_index = std::numeric_limits<u32>::max();
+static Common::Timer::Value s_block_profile_last_time = 0;
 
 NORETURN_FUNCTION_POINTER void (*g_enter_recompiler)();
 const void* g_compile_or_revalidate_block;
@@ -138,6 +211,44 @@ alignas(HOST_PAGE_SIZE) static u8 s_code_storage[RECOMPILER_CODE_CACHE_SIZE + RE
 #endif
 
 static JitCodeBuffer s_code_buffer;
+static u32 s_compiled_block_count = 0;
+
+// The code buffer is split into segments which are filled in turn. Once the last one is full, allocation wraps around
+// to the oldest, and only the blocks in it are evicted. Blocks which are still running get recompiled into the newest
+// segment, instead of the whole cache being flushed at once.
+static constexpr u32 CODE_BUFFER_SEGMENTS = 8;
+static constexpr u8 NO_CODE_SEGMENT = 0xFF;
+
+static void ResetCodeSegments();
+static bool AllocateCodeSpace(u32 near_size, u32 far_size);
+static void EvictCodeSegment(u32 segment, bool far_code);
+
+// Backpatch info for each fastmem load/store, in a sorted array per segment. Code is only ever appended to the current
+// segment, so new entries go on the end, and the entries for a segment are dropped along with its code.
+struct FastmemBackpatchEntry
+{
+  u32 code_offset; // from the start of the first segment
+  LoadstoreBackpatchInfo info;
+};
+using FastmemBackpatchList = std::vector<FastmemBackpatchEntry>;
+
+static FastmemBackpatchList* GetFastmemBackpatchList(const void* code_address, u32* code_offset);
+static const LoadstoreBackpatchInfo* FindFastmemBackpatchInfo(const void* code_address);
+static void AddFastmemBackpatchInfo(const void* code_address, const LoadstoreBackpatchInfo& info);
+static void RemoveFastmemBackpatchInfo(const void* code_address, u32 code_size);
+
+static std::array<FastmemBackpatchList, CODE_BUFFER_SEGMENTS> s_fastmem_backpatch_info;
+static std::vector<u32> s_fastmem_faulting_pcs; // sorted
+
+static const u8* s_code_segment_base = nullptr;
+static u32 s_code_segment_start = 0;
+static u32 s_code_segment_size = 0;
+static u32 s_far_code_segment_size = 0;
+static u8 s_code_segment = 0;
+static u8 s_far_code_segment = 0;
+static bool s_code_wrapped = false;
+static bool s_far_code_wrapped = false;
+static u32 s_evicted_block_count = 0;
 
 #ifdef _DEBUG
 static u32 s_total_instructions_compiled = 0;
@@ -162,8 +273,55 @@ bool CPU::CodeCache::IsUsingFastmem()
   return IsUsingAnyRecompiler() && g_settings.cpu_fastmem_mode != CPUFastmemMode::Disabled;
 }
 
+u32 CPU::CodeCache::GetCompiledBlockCount()
+{
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  return s_compiled_block_count;
+#else
+  return 0;
+#endif
+}
+
+u32 CPU::CodeCache::GetBlockCount()
+{
+  return static_cast<u32>(s_blocks.size());
+}
+
+u32 CPU::CodeCache::GetCodeBufferUsed()
+{
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  // After wrapping around, everything but the unused part of the current segment holds code.
+  const u32 near_used = s_code_wrapped ? (s_code_buffer.GetCodeSize() - s_code_buffer.GetFreeCodeSpace()) :
+                                         s_code_buffer.GetCodeUsed();
+  const u32 far_used = s_far_code_wrapped ? (s_code_buffer.GetFarCodeSize() - s_code_buffer.GetFreeFarCodeSpace()) :
+                                            s_code_buffer.GetFarCodeUsed();
+  return near_used + far_used;
+#else
+  return 0;
+#endif
+}
+
+u32 CPU::CodeCache::GetCodeBufferSize()
+{
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  return s_code_buffer.GetTotalSize();
+#else
+  return 0;
+#endif
+}
+
+u32 CPU::CodeCache::GetEvictedBlockCount()
+{
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  return s_evicted_block_count;
+#else
+  return 0;
+#endif
+}
+
 void CPU::CodeCache::ProcessStartup()
 {
+  TRACE_SCOPE("CodeCache::ProcessStartup");
   AllocateLUTs();
 
 #ifdef ENABLE_RECOMPILER_SUPPORT
@@ -203,6 +361,7 @@ void CPU::CodeCache::Initialize()
   {
     s_code_buffer.Reset();
     CompileASMFunctions();
+    ResetCodeSegments();
     ResetCodeLUT();
   }
 #endif
@@ -215,6 +374,22 @@ void CPU::CodeCache::Shutdown()
 {
   ClearBlocks();
 
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  if (s_block_cache_loaded)
+  {
+    SaveBlockCache();
+    s_block_cache_entries.clear();
+    s_block_cache_fastmem_faulting_pcs.clear();
+    s_block_cache_loaded = false;
+  }
+
+  if (!s_block_profile.empty())
+  {
+    DumpBlockProfile();
+    ClearBlockProfile();
+  }
+#endif
+
 #ifdef ENABLE_RECOMPILER_SUPPORT
   ClearASMFunctions();
 #endif
@@ -225,6 +400,8 @@ void CPU::CodeCache::Shutdown()
 
 void CPU::CodeCache::Reset()
 {
+  MemMap::BeginCodeWrite();
+
   ClearBlocks();
 
 #ifdef ENABLE_RECOMPILER_SUPPORT
@@ -233,9 +410,12 @@ void CPU::CodeCache::Reset()
     ClearASMFunctions();
     s_code_buffer.Reset();
     CompileASMFunctions();
+    ResetCodeSegments();
     ResetCodeLUT();
   }
 #endif
+
+  MemMap::EndCodeWrite();
 }
 
 void CPU::CodeCache::Execute()
@@ -278,14 +458,6 @@ static constexpr LUTRangeList GetLUTRanges()
   return ranges;
 }
 
-static constexpr u32 GetLUTSlotCount(bool include_unreachable)
-{
-  u32 tables = include_unreachable ? 1 : 0; // unreachable table
-  for (const auto& [start, end] : GetLUTRanges())
-    tables += GetLUTTableCount(start, end);
-
-  return tables * LUT_TABLE_SIZE;
-}
 } // namespace CPU::CodeCache
 
 CPU::CodeCache::CodeLUT CPU::CodeCache::DecodeCodeLUTPointer(u32 slot, CodeLUT ptr)
@@ -315,31 +487,24 @@ CPU::CodeCache::CodeLUT CPU::CodeCache::OffsetCodeLUTPointer(CodeLUT fake_ptr, u
 
 void CPU::CodeCache::AllocateLUTs()
 {
-  constexpr u32 num_code_slots = GetLUTSlotCount(true);
-  constexpr u32 num_block_slots = GetLUTSlotCount(false);
-
-  Assert(!s_lut_code_pointers && !s_lut_block_pointers);
-  s_lut_code_pointers = std::make_unique<const void*[]>(num_code_slots);
-  s_lut_block_pointers = std::make_unique<Block*[]>(num_block_slots);
-  std::memset(s_lut_block_pointers.get(), 0, sizeof(Block*) * num_block_slots);
+  Assert(!s_lut_unreachable_code && !s_lut_uncompiled_code && !s_lut_empty_blocks);
+  s_lut_unreachable_code = std::make_unique<const void*[]>(LUT_TABLE_SIZE);
+  s_lut_uncompiled_code = std::make_unique<const void*[]>(LUT_TABLE_SIZE);
+  s_lut_empty_blocks = std::make_unique<Block*[]>(LUT_TABLE_SIZE);
 
-  CodeLUT code_table_ptr = s_lut_code_pointers.get();
-  Block** block_table_ptr = s_lut_block_pointers.get();
-  CodeLUT const code_table_ptr_end = code_table_ptr + num_code_slots;
-  Block** const block_table_ptr_end = block_table_ptr + num_block_slots;
-
-  // Make the unreachable table jump to the invalid code callback.
-  MemsetPtrs(code_table_ptr, static_cast<const void*>(nullptr), LUT_TABLE_COUNT);
+  // Make the shared tables jump to the invalid code callback.
+  MemsetPtrs(s_lut_unreachable_code.get(), static_cast<const void*>(nullptr), LUT_TABLE_SIZE);
+  MemsetPtrs(s_lut_uncompiled_code.get(), static_cast<const void*>(nullptr), LUT_TABLE_SIZE);
+  MemsetPtrs(s_lut_empty_blocks.get(), static_cast<Block*>(nullptr), LUT_TABLE_SIZE);
 
   // Mark everything as unreachable to begin with.
   for (u32 i = 0; i < LUT_TABLE_COUNT; i++)
   {
-    g_code_lut[i] = EncodeCodeLUTPointer(i, code_table_ptr);
+    g_code_lut[i] = EncodeCodeLUTPointer(i, s_lut_unreachable_code.get());
     s_block_lut[i] = nullptr;
   }
-  code_table_ptr += LUT_TABLE_SIZE;
 
-  // Allocate ranges.
+  // Reachable ranges get the shared tables until something is compiled there.
   for (const auto& [start, end] : GetLUTRanges())
   {
     const u32 start_slot = start >> LUT_TABLE_SHIFT;
@@ -347,57 +512,91 @@ void CPU::CodeCache::AllocateLUTs()
     for (u32 i = 0; i < count; i++)
     {
       const u32 slot = start_slot + i;
-
-      g_code_lut[slot] = EncodeCodeLUTPointer(slot, code_table_ptr);
-      code_table_ptr += LUT_TABLE_SIZE;
-
-      s_block_lut[slot] = block_table_ptr;
-      block_table_ptr += LUT_TABLE_SIZE;
+      g_code_lut[slot] = EncodeCodeLUTPointer(slot, s_lut_uncompiled_code.get());
+      s_block_lut[slot] = s_lut_empty_blocks.get();
     }
   }
-
-  Assert(code_table_ptr == code_table_ptr_end);
-  Assert(block_table_ptr == block_table_ptr_end);
 }
 
 void CPU::CodeCache::DeallocateLUTs()
 {
-  s_lut_block_pointers.reset();
-  s_lut_code_pointers.reset();
+  s_lut_block_tables.clear();
+  s_lut_code_tables.clear();
+  s_lut_empty_blocks.reset();
+  s_lut_uncompiled_code.reset();
+  s_lut_unreachable_code.reset();
+}
+
+CPU::CodeCache::CodeLUT CPU::CodeCache::AllocateCodeLUTTable(u32 table)
+{
+  std::unique_ptr<const void*[]> ptr = std::make_unique_for_overwrite<const void*[]>(LUT_TABLE_SIZE);
+  MemsetPtrs(ptr.get(), g_compile_or_revalidate_block, LUT_TABLE_SIZE);
+  g_code_lut[table] = EncodeCodeLUTPointer(table, ptr.get());
+  return s_lut_code_tables.emplace_back(std::move(ptr)).get();
+}
+
+CPU::CodeCache::Block** CPU::CodeCache::AllocateBlockLUTTable(u32 table)
+{
+  std::unique_ptr<Block*[]> ptr = std::make_unique<Block*[]>(LUT_TABLE_SIZE);
+  s_block_lut[table] = ptr.get();
+  return s_lut_block_tables.emplace_back(std::move(ptr)).get();
 }
 
 void CPU::CodeCache::ResetCodeLUT()
 {
-  if (!s_lut_code_pointers)
+  if (!s_lut_unreachable_code)
     return;
 
   // Make the unreachable table jump to the invalid code callback.
-  MemsetPtrs(s_lut_code_pointers.get(), g_interpret_block, LUT_TABLE_COUNT);
+  MemsetPtrs(s_lut_unreachable_code.get(), g_interpret_block, LUT_TABLE_SIZE);
+  MemsetPtrs(s_lut_uncompiled_code.get(), g_compile_or_revalidate_block, LUT_TABLE_SIZE);
 
-  for (u32 i = 0; i < LUT_TABLE_COUNT; i++)
+  // No blocks are compiled at this point, so the shared table is equivalent to any of the allocated ones.
+  for (const auto& [start, end] : GetLUTRanges())
   {
-    CodeLUT ptr = DecodeCodeLUTPointer(i, g_code_lut[i]);
-    if (ptr == s_lut_code_pointers.get())
-      continue;
+    const u32 start_slot = start >> LUT_TABLE_SHIFT;
+    const u32 count = GetLUTTableCount(start, end);
+    for (u32 i = 0; i < count; i++)
+    {
+      const u32 slot = start_slot + i;
+      g_code_lut[slot] = EncodeCodeLUTPointer(slot, s_lut_uncompiled_code.get());
+    }
+  }
+
+  s_lut_code_tables.clear();
+}
 
-    MemsetPtrs(ptr, g_compile_or_revalidate_block, LUT_TABLE_SIZE);
+void CPU::CodeCache::ClearBlockLUT()
+{
+  for (const auto& [start, end] : GetLUTRanges())
+  {
+    const u32 start_slot = start >> LUT_TABLE_SHIFT;
+    const u32 count = GetLUTTableCount(start, end);
+    for (u32 i = 0; i < count; i++)
+      s_block_lut[start_slot + i] = s_lut_empty_blocks.get();
   }
+
+  s_lut_block_tables.clear();
 }
 
 void CPU::CodeCache::SetCodeLUT(u32 pc, const void* function)
 {
-  if (!s_lut_code_pointers)
+  if (!s_lut_unreachable_code)
     return;
 
   const u32 table = pc >> LUT_TABLE_SHIFT;
-  CodeLUT encoded_ptr = g_code_lut[table];
+  const CodeLUT table_ptr = DecodeCodeLUTPointer(table, g_code_lut[table]);
+  DebugAssert(table_ptr != nullptr && table_ptr != s_lut_unreachable_code.get());
+  if (table_ptr == s_lut_uncompiled_code.get())
+  {
+    // Shared table already goes to the compiler.
+    if (function == g_compile_or_revalidate_block)
+      return;
 
-#ifdef _DEBUG
-  const CodeLUT table_ptr = DecodeCodeLUTPointer(table, encoded_ptr);
-  DebugAssert(table_ptr != nullptr && table_ptr != s_lut_code_pointers.get());
-#endif
+    AllocateCodeLUTTable(table);
+  }
 
-  *OffsetCodeLUTPointer(encoded_ptr, pc) = function;
+  *OffsetCodeLUTPointer(g_code_lut[table], pc) = function;
 }
 
 CPU::CodeCache::Block* CPU::CodeCache::LookupBlock(u32 pc)
@@ -416,6 +615,8 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
   const u32 size = static_cast<u32>(instructions.size());
   const u32 table = pc >> LUT_TABLE_SHIFT;
   Assert(s_block_lut[table]);
+  if (s_block_lut[table] == s_lut_empty_blocks.get())
+    AllocateBlockLUTTable(table);
 
   // retain from old block
   const u32 frame_number = System::GetFrameNumber();
@@ -424,11 +625,16 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
 
   const u32 idx = (pc & 0xFFFF) >> 2;
   Block* block = s_block_lut[table][idx];
+  BlockLink* incoming_links = nullptr;
   if (block)
   {
     // shouldn't be in the page list.. since we should come here after invalidating
     Assert(!block->next_block_in_page);
 
+#ifdef ENABLE_RECOMPILER_SUPPORT
+    UnlinkBlockExits(block);
+#endif
+
     // keep recompile stats before resetting, that way we actually count recompiles
     recompile_frame = block->compile_frame;
     recompile_count = block->compile_count;
@@ -442,10 +648,17 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
       Assert(it != s_blocks.end());
       s_blocks.erase(it);
 
+      incoming_links = block->incoming_links;
       std::free(block);
       block = nullptr;
     }
   }
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  else
+  {
+    incoming_links = TakePendingBlockLinks(pc);
+  }
+#endif
 
   if (!block)
   {
@@ -453,6 +666,11 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
       static_cast<Block*>(std::malloc(sizeof(Block) + (sizeof(Instruction) * size) + (sizeof(InstructionInfo) * size)));
     Assert(block);
     s_blocks.push_back(block);
+
+    // links into the old block, or to the PC before it had one, now belong to this block
+    block->incoming_links = incoming_links;
+    if (incoming_links)
+      incoming_links->prev = &block->incoming_links;
   }
 
   block->pc = pc;
@@ -465,6 +683,7 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
   block->protection = GetProtectionModeForBlock(block);
   block->uncached_fetch_ticks = metadata.uncached_fetch_ticks;
   block->icache_line_count = metadata.icache_line_count;
+  block->icache_generation = g_state.icache_generation - 1;
   block->compile_frame = recompile_frame;
   block->compile_count = recompile_count + 1;
 
@@ -478,9 +697,13 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
     {
       dsti->bits = ip->first.bits;
       *dstii = ip->second;
+      PredecodeCachedInterpreterInstruction(*dsti, dstii);
     }
   }
 
+  if (Trace::IsActive()) [[unlikely]]
+    Trace::LogBlockCode(pc, block->Instructions(), size);
+
   s_block_lut[table][idx] = block;
 
   // if the block is being recompiled too often, leave it in the list, but don't compile it.
@@ -495,6 +718,11 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateBlock(u32 pc, const BlockInstructio
     Log_DevFmt("{} recompiles in {} frames to block 0x{:08X}, not caching.", block->compile_count, frame_delta,
                block->pc);
     block->size = 0;
+
+#ifdef ENABLE_RECOMPILER_SUPPORT
+    if (g_settings.cpu_recompiler_block_profiling) [[unlikely]]
+      RecordBlockProfileFallback(pc);
+#endif
   }
 
   // cached interpreter creates empty blocks when falling back
@@ -558,6 +786,7 @@ void CPU::CodeCache::AddBlockToPageList(Block* block)
   const u32 page_idx = block->StartPageIndex();
   PageProtectionInfo& entry = s_page_protection[page_idx];
   Bus::SetRAMCodePage(page_idx);
+  entry.code_subpage_mask |= GetCodeSubPageMask(block->pc & Bus::g_ram_mask, block->size * sizeof(Instruction));
 
   if (entry.last_block_in_page)
   {
@@ -643,10 +872,36 @@ void CPU::CodeCache::InvalidateBlocksWithPageIndex(u32 index)
 
   ppi.first_block_in_page = nullptr;
   ppi.last_block_in_page = nullptr;
+  ppi.code_subpage_mask = 0;
 
   MemMap::EndCodeWrite();
 }
 
+u64 CPU::CodeCache::GetCodeSubPageMask(u32 offset, u32 size)
+{
+  // Blocks on write-protected pages never cross into the next page.
+  const u32 page_offset = offset % HOST_PAGE_SIZE;
+  const u32 first = page_offset / CODE_SUBPAGE_SIZE;
+  const u32 last = (std::min(page_offset + size, HOST_PAGE_SIZE) - 1) / CODE_SUBPAGE_SIZE;
+  const u64 upto_last = (last == 63) ? ~static_cast<u64>(0) : ((static_cast<u64>(1) << (last + 1)) - 1);
+  return upto_last & ~((static_cast<u64>(1) << first) - 1);
+}
+
+bool CPU::CodeCache::IsCodeSubPageWrite(u32 offset, u32 size)
+{
+  const PageProtectionInfo& ppi = s_page_protection[Bus::GetRAMCodePageIndex(offset)];
+  return ((ppi.code_subpage_mask & GetCodeSubPageMask(offset, size)) != 0);
+}
+
+void CPU::CodeCache::InvalidateBlocksWithRAMWrite(u32 offset, u32 size)
+{
+  // Data next to code can be written without disturbing the blocks, the page stays protected.
+  if (!IsCodeSubPageWrite(offset, size))
+    return;
+
+  InvalidateBlocksWithPageIndex(Bus::GetRAMCodePageIndex(offset));
+}
+
 CPU::CodeCache::PageProtectionMode CPU::CodeCache::GetProtectionModeForPC(u32 pc)
 {
   if (!AddressInRAM(pc))
@@ -673,6 +928,9 @@ void CPU::CodeCache::InvalidateBlock(Block* block, BlockState new_state)
   {
     SetCodeLUT(block->pc, g_compile_or_revalidate_block);
     BacklinkBlocks(block->pc, g_compile_or_revalidate_block);
+
+    if (g_settings.cpu_recompiler_block_profiling) [[unlikely]]
+      RecordBlockProfileInvalidation(block->pc);
   }
 #endif
 
@@ -683,17 +941,42 @@ void CPU::CodeCache::InvalidateAllRAMBlocks()
 {
   // TODO: maybe combine the backlink into one big instruction flush cache?
 
+  MemMap::BeginCodeWrite();
+
   for (Block* block : s_blocks)
   {
     if (AddressInRAM(block->pc))
       InvalidateBlock(block, BlockState::Invalidated);
   }
 
+  MemMap::EndCodeWrite();
+
   Bus::ClearRAMCodePageFlags();
 }
 
+void CPU::CodeCache::InvalidateChangedRAMBlocks(const u8* new_ram)
+{
+  // Blocks in manually checked pages verify themselves when they run.
+  const u32 num_pages = Bus::g_ram_size / HOST_PAGE_SIZE;
+  MemMap::BeginCodeWrite();
+  for (u32 i = 0; i < num_pages; i++)
+  {
+    if (Bus::g_ram_code_bits[i] &&
+        std::memcmp(&Bus::g_ram[i * HOST_PAGE_SIZE], &new_ram[i * HOST_PAGE_SIZE], HOST_PAGE_SIZE) != 0)
+    {
+      InvalidateBlocksWithPageIndex(i);
+    }
+  }
+  MemMap::EndCodeWrite();
+}
+
 void CPU::CodeCache::ClearBlocks()
 {
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  if (s_block_cache_loaded)
+    RecordBlocksInBlockCache();
+#endif
+
   for (u32 i = 0; i < Bus::RAM_8MB_CODE_PAGE_COUNT; i++)
   {
     PageProtectionInfo& ppi = s_page_protection[i];
@@ -704,16 +987,21 @@ void CPU::CodeCache::ClearBlocks()
   }
 
 #ifdef ENABLE_RECOMPILER_SUPPORT
-  s_fastmem_backpatch_info.clear();
-  s_fastmem_faulting_pcs.clear();
-  s_block_links.clear();
+  for (FastmemBackpatchList& list : s_fastmem_backpatch_info)
+    list.clear();
+  if (s_block_cache_loaded)
+    s_fastmem_faulting_pcs = s_block_cache_fastmem_faulting_pcs;
+  else
+    s_fastmem_faulting_pcs.clear();
+  s_pending_block_links.clear();
+  s_deferred_compile_counts.clear();
 #endif
 
   for (Block* block : s_blocks)
     std::free(block);
   s_blocks.clear();
 
-  std::memset(s_lut_block_pointers.get(), 0, sizeof(Block*) * GetLUTSlotCount(false));
+  ClearBlockLUT();
 }
 
 Common::PageFaultHandler::HandlerResult CPU::CodeCache::ExceptionHandler(void* exception_pc, void* fault_address,
@@ -726,6 +1014,14 @@ Common::PageFaultHandler::HandlerResult CPU::CodeCache::ExceptionHandler(void* e
     DebugAssert(is_write);
     const u32 guest_address = static_cast<u32>(static_cast<const u8*>(fault_address) - Bus::g_ram);
     const u32 page_index = Bus::GetRAMCodePageIndex(guest_address);
+
+#ifdef ENABLE_RECOMPILER_SUPPORT
+    // A fastmem store to data which shares the page with code gets backpatched to slowmem, which doesn't fault, and
+    // checks the sub-page instead. Otherwise the page would need to be unprotected, taking all of its blocks with it.
+    if (!IsCodeSubPageWrite(guest_address, 1) && FindFastmemBackpatchInfo(exception_pc))
+      return HandleFastmemException(exception_pc, fault_address, is_write);
+#endif
+
     Log_DevFmt("Page fault on protected RAM @ 0x{:08X} (page #{}), invalidating code cache.", guest_address,
                page_index);
     InvalidateBlocksWithPageIndex(page_index);
@@ -750,6 +1046,63 @@ CPU::CodeCache::Block* CPU::CodeCache::CreateCachedInterpreterBlock(u32 pc)
   return CreateBlock(pc, s_block_instructions, metadata);
 }
 
+void CPU::CodeCache::PredecodeCachedInterpreterInstruction(const Instruction& inst, InstructionInfo* info)
+{
+  CachedInterpreterOp op = CachedInterpreterOp::Generic;
+  Reg rd = inst.r.rd;
+  u32 imm = inst.r.shamt;
+
+  if (inst.bits == 0)
+  {
+    op = CachedInterpreterOp::Nop;
+  }
+  else if (inst.op == InstructionOp::funct)
+  {
+    switch (inst.r.funct)
+    {
+      // clang-format off
+      case InstructionFunct::sll: op = CachedInterpreterOp::Sll; break;
+      case InstructionFunct::srl: op = CachedInterpreterOp::Srl; break;
+      case InstructionFunct::sra: op = CachedInterpreterOp::Sra; break;
+      case InstructionFunct::addu: op = CachedInterpreterOp::Addu; break;
+      case InstructionFunct::subu: op = CachedInterpreterOp::Subu; break;
+      case InstructionFunct::and_: op = CachedInterpreterOp::And; break;
+      case InstructionFunct::or_: op = CachedInterpreterOp::Or; break;
+      case InstructionFunct::xor_: op = CachedInterpreterOp::Xor; break;
+      case InstructionFunct::nor: op = CachedInterpreterOp::Nor; break;
+      case InstructionFunct::slt: op = CachedInterpreterOp::Slt; break;
+      case InstructionFunct::sltu: op = CachedInterpreterOp::Sltu; break;
+      default: break;
+      // clang-format on
+    }
+  }
+  else
+  {
+    rd = inst.i.rt;
+    imm = inst.i.imm_sext32();
+
+    switch (inst.op)
+    {
+      // clang-format off
+      case InstructionOp::addiu: op = CachedInterpreterOp::Addiu; break;
+      case InstructionOp::slti: op = CachedInterpreterOp::Slti; break;
+      case InstructionOp::sltiu: op = CachedInterpreterOp::Sltiu; break;
+      case InstructionOp::andi: op = CachedInterpreterOp::Andi; imm = inst.i.imm_zext32(); break;
+      case InstructionOp::ori: op = CachedInterpreterOp::Ori; imm = inst.i.imm_zext32(); break;
+      case InstructionOp::xori: op = CachedInterpreterOp::Xori; imm = inst.i.imm_zext32(); break;
+      case InstructionOp::lui: op = CachedInterpreterOp::Lui; imm = inst.i.imm_zext32() << 16; break;
+      default: break;
+      // clang-format on
+    }
+  }
+
+  info->interpreter_op = op;
+  info->interpreter_rd = rd;
+  info->interpreter_rs = inst.r.rs;
+  info->interpreter_rt = inst.r.rt;
+  info->interpreter_imm = imm;
+}
+
 template<PGXPMode pgxp_mode>
 [[noreturn]] void CPU::CodeCache::ExecuteCachedInterpreterImpl()
 {
@@ -810,6 +1163,12 @@ template<PGXPMode pgxp_mode>
       if (g_settings.cpu_recompiler_icache)
         CheckAndUpdateICacheTags(block->icache_line_count, block->uncached_fetch_ticks);
 
+      if (Trace::IsActive()) [[unlikely]]
+      {
+        g_state.trace_block_pc = block->pc;
+        Trace::LogBlockEntry();
+      }
+
       InterpretCachedBlock<pgxp_mode>(block);
 
       CHECK_DOWNCOUNT();
@@ -894,6 +1253,11 @@ bool CPU::CodeCache::ReadBlockInstructions(u32 start_pc, BlockInstructionList* i
   u32 last_cache_line = ICACHE_LINES;
   u32 last_page = (protection == PageProtectionMode::WriteProtected) ? Bus::GetRAMCodePageIndex(start_pc) : 0;
 
+  // Fetch ticks are charged up-front for the whole block, so don't form traces when they'd be overestimated.
+  const bool allow_trace = (g_settings.cpu_execution_mode == CPUExecutionMode::NewRec &&
+                            !g_settings.cpu_recompiler_icache && GetSegmentForAddress(start_pc) < Segment::KSEG1);
+  u32 trace_branches = 0;
+
   for (;;)
   {
     if (protection == PageProtectionMode::WriteProtected)
@@ -978,8 +1342,20 @@ bool CPU::CodeCache::ReadBlockInstructions(u32 start_pc, BlockInstructionList* i
 
     // if we're in a branch delay slot, the block is now done
     // except if this is a branch in a branch delay slot, then we grab the one after that, and so on...
+    // or if it's a forward conditional branch, which we assume isn't taken, then we continue with the fallthrough.
     if (is_branch_delay_slot && !info.is_branch_instruction)
-      break;
+    {
+      const BlockInstructionInfoPair& branch = instructions->at(instructions->size() - 2);
+      if (!allow_trace || trace_branches == MAX_TRACE_CONDITIONAL_BRANCHES ||
+          branch.second.is_unconditional_branch_instruction || !branch.second.is_direct_branch_instruction ||
+          GetDirectBranchTarget(branch.first, branch.second.pc) <= branch.second.pc)
+      {
+        break;
+      }
+
+      Log_DebugFmt("Continuing block 0x{:08X} through branch at 0x{:08X}", start_pc, branch.second.pc);
+      trace_branches++;
+    }
 
     // if this is a branch, we grab the next instruction (delay slot), and then exit
     is_branch_delay_slot = info.is_branch_instruction;
@@ -1000,6 +1376,13 @@ bool CPU::CodeCache::ReadBlockInstructions(u32 start_pc, BlockInstructionList* i
 
   instructions->back().second.is_last_instruction = true;
 
+  if (g_settings.cpu_recompiler_idle_loop_skipping && g_settings.cpu_execution_mode == CPUExecutionMode::NewRec &&
+      IsIdleLoop(start_pc, *instructions))
+  {
+    Log_DevFmt("Block 0x{:08X} is an idle loop", start_pc);
+    metadata->flags |= BlockFlags::IsIdleLoop;
+  }
+
 #ifdef _DEBUG
   SmallString disasm;
   Log_DebugPrintf("Block at 0x%08X", start_pc);
@@ -1014,6 +1397,133 @@ bool CPU::CodeCache::ReadBlockInstructions(u32 start_pc, BlockInstructionList* i
   return true;
 }
 
+bool CPU::CodeCache::IsIdleLoop(u32 start_pc, const BlockInstructionList& instructions)
+{
+  // Looking for a block which branches back to itself, and only does loads and ALU ops, e.g. polling VSync:
+  //   loop: lw $v0, 0($a0)
+  //         nop
+  //         beq $v0, $zero, loop
+  //         nop
+  // If no register is carried between iterations, every iteration computes the same thing, until memory is changed.
+  // Which can only happen when an event runs, so the loop can skip straight to the next event.
+  if (instructions.size() < 2)
+    return false;
+
+  const BlockInstructionInfoPair& branch = instructions[instructions.size() - 2];
+  if (!branch.second.is_direct_branch_instruction || GetDirectBranchTarget(branch.first, branch.second.pc) != start_pc)
+    return false;
+
+  u32 written = 0;
+  u32 read_before_written = 0;
+  u32 load_delay = 0;
+  u32 next_load_delay = 0;
+  const auto read = [&written, &read_before_written, &load_delay](Reg reg) {
+    // reading in a load delay slot gets the old value, which is the same as reading it before it's written
+    const u32 bit = (1u << static_cast<u8>(reg));
+    read_before_written |= (bit & (~written | load_delay));
+  };
+  const auto write = [&written](Reg reg) { written |= (1u << static_cast<u8>(reg)); };
+
+  for (const BlockInstructionInfoPair& it : instructions)
+  {
+    const Instruction inst = it.first;
+    load_delay = std::exchange(next_load_delay, 0);
+    switch (inst.op)
+    {
+      case InstructionOp::funct:
+      {
+        switch (inst.r.funct)
+        {
+          case InstructionFunct::sll:
+          case InstructionFunct::srl:
+          case InstructionFunct::sra:
+            read(inst.r.rt);
+            write(inst.r.rd);
+            break;
+
+          case InstructionFunct::sllv:
+          case InstructionFunct::srlv:
+          case InstructionFunct::srav:
+          case InstructionFunct::addu:
+          case InstructionFunct::subu:
+          case InstructionFunct::and_:
+          case InstructionFunct::or_:
+          case InstructionFunct::xor_:
+          case InstructionFunct::nor:
+          case InstructionFunct::slt:
+          case InstructionFunct::sltu:
+            read(inst.r.rs);
+            read(inst.r.rt);
+            write(inst.r.rd);
+            break;
+
+          default:
+            return false;
+        }
+      }
+      break;
+
+      case InstructionOp::addiu:
+      case InstructionOp::slti:
+      case InstructionOp::sltiu:
+      case InstructionOp::andi:
+      case InstructionOp::ori:
+      case InstructionOp::xori:
+        read(inst.i.rs);
+        write(inst.i.rt);
+        break;
+
+      case InstructionOp::lui:
+        write(inst.i.rt);
+        break;
+
+      case InstructionOp::lb:
+      case InstructionOp::lbu:
+      case InstructionOp::lh:
+      case InstructionOp::lhu:
+      case InstructionOp::lw:
+      case InstructionOp::lwl:
+      case InstructionOp::lwr:
+        read(inst.i.rs);
+        if (inst.op == InstructionOp::lwl || inst.op == InstructionOp::lwr)
+          read(inst.i.rt);
+        write(inst.i.rt);
+        next_load_delay = (1u << static_cast<u8>(inst.i.rt.GetValue()));
+        break;
+
+      case InstructionOp::beq:
+      case InstructionOp::bne:
+        read(inst.i.rs);
+        read(inst.i.rt);
+        break;
+
+      case InstructionOp::blez:
+      case InstructionOp::bgtz:
+        read(inst.i.rs);
+        break;
+
+      case InstructionOp::b:
+      {
+        // no linking variants
+        if ((static_cast<u8>(inst.i.rt.GetValue()) & u8(0x1E)) == u8(0x10))
+          return false;
+        read(inst.i.rs);
+      }
+      break;
+
+      case InstructionOp::j:
+        break;
+
+      default:
+        return false;
+    }
+  }
+
+  // $zero is never really written
+  written &= ~1u;
+  return ((read_before_written & written) == 0);
+}
+
 void CPU::CodeCache::CopyRegInfo(InstructionInfo* dst, const InstructionInfo* src)
 {
   std::memcpy(dst->reg_flags, src->reg_flags, sizeof(dst->reg_flags));
@@ -1272,6 +1782,13 @@ void CPU::CodeCache::FillBlockRegInfo(Block* block)
       }
     } // end switch
 
+    // blocks can continue past conditional branches, everything has to be live on the taken path's exit
+    if (prev->is_branch_delay_slot)
+    {
+      for (u32 i = 0; i < static_cast<u32>(Reg::count); i++)
+        prev->reg_flags[i] |= RI_LIVE;
+    }
+
     inst--;
     iinst--;
   } // end while
@@ -1285,11 +1802,28 @@ void CPU::CodeCache::FillBlockRegInfo(Block* block)
 
 void CPU::CodeCache::CompileOrRevalidateBlock(u32 start_pc)
 {
-  // TODO: this doesn't currently handle when the cache overflows...
   DebugAssert(IsUsingAnyRecompiler());
-  MemMap::BeginCodeWrite();
 
   Block* block = LookupBlock(start_pc);
+  if (!block && g_settings.cpu_recompiler_deferred_compile && !s_block_cache_entries.contains(start_pc))
+  {
+    // Blocks which were run in a previous session are compiled straight away. Nothing is written when interpreting,
+    // so leave the code protected.
+    const auto it = s_deferred_compile_counts.try_emplace(start_pc, static_cast<u8>(0)).first;
+    if (it->second < DEFERRED_COMPILE_INTERPRET_COUNT)
+    {
+      it->second++;
+
+      // The LUT still points at the compiler, so we'll be back here next time.
+      reinterpret_cast<void (*)()>(GetInterpretUncachedBlockFunction())();
+      return;
+    }
+
+    s_deferred_compile_counts.erase(it);
+  }
+
+  MemMap::BeginCodeWrite();
+
   if (block)
   {
     // we should only be here if the block got invalidated
@@ -1311,17 +1845,19 @@ void CPU::CodeCache::CompileOrRevalidateBlock(u32 start_pc)
   if (!ReadBlockInstructions(start_pc, &s_block_instructions, &metadata))
   {
     Log_ErrorFmt("Failed to read block at 0x{:08X}, falling back to uncached interpreter", start_pc);
+    if (g_settings.cpu_recompiler_block_profiling) [[unlikely]]
+      RecordBlockProfileFallback(start_pc);
     SetCodeLUT(start_pc, g_interpret_block);
     BacklinkBlocks(start_pc, g_interpret_block);
     MemMap::EndCodeWrite();
     return;
   }
 
-  // Ensure we're not going to run out of space while compiling this block.
-  // We could definitely do better here... TODO: far code is no longer needed for newrec
+  // Ensure we're not going to run out of space while compiling this block, evicting the oldest code if needed.
+  // TODO: far code is no longer needed for newrec
   const u32 block_size = static_cast<u32>(s_block_instructions.size());
-  if (s_code_buffer.GetFreeCodeSpace() < (block_size * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
-      s_code_buffer.GetFreeFarCodeSpace() < (block_size * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+  if (!AllocateCodeSpace(block_size * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION,
+                         block_size * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
   {
     Log_ErrorFmt("Out of code space while compiling {:08X}. Resetting code cache.", start_pc);
     CodeCache::Reset();
@@ -1331,6 +1867,8 @@ void CPU::CodeCache::CompileOrRevalidateBlock(u32 start_pc)
       !CompileBlock(block))
   {
     Log_ErrorFmt("Failed to compile block at 0x{:08X}, falling back to uncached interpreter", start_pc);
+    if (g_settings.cpu_recompiler_block_profiling && block && block->size > 0) [[unlikely]]
+      RecordBlockProfileFallback(start_pc);
     SetCodeLUT(start_pc, g_interpret_block);
     BacklinkBlocks(start_pc, g_interpret_block);
     MemMap::EndCodeWrite();
@@ -1363,7 +1901,7 @@ const void* CPU::CodeCache::CreateBlockLink(Block* block, void* code, u32 newpc)
   const void* dst = g_dispatcher;
   if (g_settings.cpu_recompiler_block_linking)
   {
-    const Block* next_block = LookupBlock(newpc);
+    Block* next_block = LookupBlock(newpc);
     if (next_block)
     {
       dst = (next_block->state == BlockState::Valid) ?
@@ -1377,9 +1915,16 @@ const void* CPU::CodeCache::CreateBlockLink(Block* block, void* code, u32 newpc)
       dst = g_compile_or_revalidate_block;
     }
 
-    BlockLinkMap::iterator iter = s_block_links.emplace(newpc, code);
+    // blocks are never freed while they're in the LUT, so the head stays put
+    BlockLink** head = next_block ? &next_block->incoming_links : &s_pending_block_links[newpc];
     DebugAssert(block->num_exit_links < MAX_BLOCK_EXIT_LINKS);
-    block->exit_links[block->num_exit_links++] = iter;
+    BlockLink* link = &block->exit_links[block->num_exit_links++];
+    link->code = code;
+    link->next = *head;
+    link->prev = head;
+    if (link->next)
+      link->next->prev = &link->next;
+    *head = link;
   }
 
   Log_DebugPrintf("Linking %p with dst pc %08X to %p%s", code, newpc, dst,
@@ -1392,12 +1937,23 @@ void CPU::CodeCache::BacklinkBlocks(u32 pc, const void* dst)
   if (!g_settings.cpu_recompiler_block_linking)
     return;
 
-  const auto link_range = s_block_links.equal_range(pc);
-  for (auto it = link_range.first; it != link_range.second; ++it)
+  const Block* block = LookupBlock(pc);
+  BlockLink* link;
+  if (block)
+  {
+    link = block->incoming_links;
+  }
+  else
+  {
+    const auto it = s_pending_block_links.find(pc);
+    link = (it != s_pending_block_links.end()) ? it->second : nullptr;
+  }
+
+  for (; link; link = link->next)
   {
-    Log_DebugPrintf("Backlinking %p with dst pc %08X to %p%s", it->second, pc, dst,
+    Log_DebugPrintf("Backlinking %p with dst pc %08X to %p%s", link->code, pc, dst,
                     (dst == g_compile_or_revalidate_block) ? "[compiler]" : "");
-    EmitJump(it->second, dst, true);
+    EmitJump(link->code, dst, true);
   }
 }
 
@@ -1405,10 +1961,275 @@ void CPU::CodeCache::UnlinkBlockExits(Block* block)
 {
   const u32 num_exit_links = block->num_exit_links;
   for (u32 i = 0; i < num_exit_links; i++)
-    s_block_links.erase(block->exit_links[i]);
+  {
+    BlockLink* link = &block->exit_links[i];
+    *link->prev = link->next;
+    if (link->next)
+      link->next->prev = link->prev;
+  }
   block->num_exit_links = 0;
 }
 
+CPU::CodeCache::BlockLink* CPU::CodeCache::TakePendingBlockLinks(u32 pc)
+{
+  const auto it = s_pending_block_links.find(pc);
+  if (it == s_pending_block_links.end())
+    return nullptr;
+
+  BlockLink* links = it->second;
+  s_pending_block_links.erase(it);
+  return links;
+}
+
+std::string CPU::CodeCache::GetBlockCacheDirectory()
+{
+  return Path::Combine(EmuFolders::Cache, "blocks");
+}
+
+std::string CPU::CodeCache::GetBlockCacheFileName(System::GameHash hash)
+{
+  return Path::Combine(GetBlockCacheDirectory(), TinyString::from_fmt("{:016X}.bin", hash));
+}
+
+const u8* CPU::CodeCache::GetBlockCacheCodePointer(u32 pc, u32 size)
+{
+  const PhysicalMemoryAddress phys_addr = VirtualAddressToPhysical(pc);
+  const u32 size_in_bytes = size * sizeof(Instruction);
+  if (AddressInRAM(pc))
+    return ((phys_addr + size_in_bytes) <= Bus::g_ram_size) ? (Bus::g_ram + phys_addr) : nullptr;
+  else if (phys_addr >= Bus::BIOS_BASE && (phys_addr + size_in_bytes) <= (Bus::BIOS_BASE + Bus::BIOS_SIZE))
+    return Bus::g_bios + (phys_addr - Bus::BIOS_BASE);
+  else
+    return nullptr;
+}
+
+void CPU::CodeCache::RecordBlocksInBlockCache()
+{
+  for (const Block* block : s_blocks)
+  {
+    if (block->size == 0 || block->state == BlockState::FallbackToInterpreter || !block->host_code)
+      continue;
+
+    auto it = s_block_cache_entries.find(block->pc);
+    if (it == s_block_cache_entries.end())
+    {
+      if (s_block_cache_entries.size() >= BLOCK_CACHE_MAX_ENTRIES)
+        continue;
+
+      it = s_block_cache_entries.emplace(block->pc, std::vector<u32>()).first;
+    }
+    else if (it->second.size() == block->size &&
+             std::memcmp(it->second.data(), block->Instructions(), sizeof(Instruction) * block->size) == 0)
+    {
+      continue;
+    }
+
+    // new block, or the code at this address has changed since it was recorded
+    it->second.resize(block->size);
+    std::memcpy(it->second.data(), block->Instructions(), sizeof(Instruction) * block->size);
+    s_block_cache_dirty = true;
+  }
+
+  // Both lists are sorted, and PCs which have faulted once are never removed.
+  if (s_fastmem_faulting_pcs != s_block_cache_fastmem_faulting_pcs)
+  {
+    std::vector<u32> merged;
+    merged.reserve(s_fastmem_faulting_pcs.size() + s_block_cache_fastmem_faulting_pcs.size());
+    std::set_union(s_fastmem_faulting_pcs.begin(), s_fastmem_faulting_pcs.end(),
+                   s_block_cache_fastmem_faulting_pcs.begin(), s_block_cache_fastmem_faulting_pcs.end(),
+                   std::back_inserter(merged));
+    if (merged.size() != s_block_cache_fastmem_faulting_pcs.size())
+    {
+      s_block_cache_fastmem_faulting_pcs = std::move(merged);
+      s_block_cache_dirty = true;
+    }
+  }
+}
+
+void CPU::CodeCache::LoadBlockCache(System::GameHash hash)
+{
+  s_block_cache_entries.clear();
+  s_block_cache_fastmem_faulting_pcs.clear();
+  s_block_cache_game_hash = hash;
+  s_block_cache_loaded = true;
+  s_block_cache_dirty = false;
+
+  const std::string filename = GetBlockCacheFileName(hash);
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+    return;
+
+  u32 signature, version, count;
+  u64 file_hash;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU64(&file_hash) ||
+      !stream->ReadU32(&count) || signature != BLOCK_CACHE_SIGNATURE || version != BLOCK_CACHE_VERSION ||
+      file_hash != hash || count > BLOCK_CACHE_MAX_ENTRIES)
+  {
+    Log_WarningFmt("Block cache '{}' is invalid, ignoring.", Path::GetFileName(filename));
+    return;
+  }
+
+  s_block_cache_entries.reserve(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    u32 pc, size;
+    if (!stream->ReadU32(&pc) || !stream->ReadU32(&size) || size == 0 || size > (Bus::RAM_8MB_SIZE / sizeof(u32)))
+    {
+      Log_WarningFmt("Block cache '{}' is corrupted, ignoring.", Path::GetFileName(filename));
+      s_block_cache_entries.clear();
+      return;
+    }
+
+    std::vector<u32> code(size);
+    if (!stream->Read2(code.data(), size * sizeof(u32)))
+    {
+      Log_WarningFmt("Block cache '{}' is truncated, ignoring.", Path::GetFileName(filename));
+      s_block_cache_entries.clear();
+      return;
+    }
+
+    s_block_cache_entries.emplace(pc, std::move(code));
+  }
+
+  u32 faulting_pc_count;
+  if (!stream->ReadU32(&faulting_pc_count) || faulting_pc_count > BLOCK_CACHE_MAX_ENTRIES)
+  {
+    Log_WarningFmt("Block cache '{}' is corrupted, ignoring.", Path::GetFileName(filename));
+    s_block_cache_entries.clear();
+    return;
+  }
+
+  s_block_cache_fastmem_faulting_pcs.resize(faulting_pc_count);
+  if (faulting_pc_count > 0 &&
+      (!stream->Read2(s_block_cache_fastmem_faulting_pcs.data(), faulting_pc_count * sizeof(u32)) ||
+       !std::is_sorted(s_block_cache_fastmem_faulting_pcs.begin(), s_block_cache_fastmem_faulting_pcs.end())))
+  {
+    Log_WarningFmt("Block cache '{}' is corrupted, ignoring.", Path::GetFileName(filename));
+    s_block_cache_entries.clear();
+    s_block_cache_fastmem_faulting_pcs.clear();
+    return;
+  }
+
+  // Blocks compiled from now on will use slowmem for these straight away.
+  s_fastmem_faulting_pcs = s_block_cache_fastmem_faulting_pcs;
+
+  Log_InfoFmt("Loaded {} blocks and {} fastmem faulting PCs from block cache for game {:016X}.",
+              s_block_cache_entries.size(), s_block_cache_fastmem_faulting_pcs.size(), hash);
+}
+
+void CPU::CodeCache::SaveBlockCache()
+{
+  if (!s_block_cache_dirty || (s_block_cache_entries.empty() && s_block_cache_fastmem_faulting_pcs.empty()))
+    return;
+
+  const std::string directory = GetBlockCacheDirectory();
+  if (!FileSystem::EnsureDirectoryExists(directory.c_str(), false))
+  {
+    Log_ErrorFmt("Failed to create block cache directory '{}'.", directory);
+    return;
+  }
+
+  const std::string filename = GetBlockCacheFileName(s_block_cache_game_hash);
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(
+    filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                        BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_ErrorFmt("Failed to open block cache '{}' for writing.", filename);
+    return;
+  }
+
+  bool result = stream->WriteU32(BLOCK_CACHE_SIGNATURE);
+  result &= stream->WriteU32(BLOCK_CACHE_VERSION);
+  result &= stream->WriteU64(s_block_cache_game_hash);
+  result &= stream->WriteU32(static_cast<u32>(s_block_cache_entries.size()));
+  for (const auto& [pc, code] : s_block_cache_entries)
+  {
+    result &= stream->WriteU32(pc);
+    result &= stream->WriteU32(static_cast<u32>(code.size()));
+    result &= stream->Write2(code.data(), static_cast<u32>(code.size() * sizeof(u32)));
+  }
+  result &= stream->WriteU32(static_cast<u32>(s_block_cache_fastmem_faulting_pcs.size()));
+  if (!s_block_cache_fastmem_faulting_pcs.empty())
+  {
+    result &= stream->Write2(s_block_cache_fastmem_faulting_pcs.data(),
+                             static_cast<u32>(s_block_cache_fastmem_faulting_pcs.size() * sizeof(u32)));
+  }
+
+  if (!result || !stream->Commit())
+  {
+    Log_ErrorFmt("Failed to write block cache '{}'.", filename);
+    stream->Discard();
+    return;
+  }
+
+  Log_InfoFmt("Saved {} blocks and {} fastmem faulting PCs to block cache for game {:016X}.",
+              s_block_cache_entries.size(), s_block_cache_fastmem_faulting_pcs.size(), s_block_cache_game_hash);
+  s_block_cache_dirty = false;
+}
+
+#endif // ENABLE_RECOMPILER_SUPPORT
+
+void CPU::CodeCache::PrecompileCachedBlocks()
+{
+#ifdef ENABLE_RECOMPILER_SUPPORT
+  TRACE_SCOPE("CodeCache::PrecompileCachedBlocks");
+  if (!IsUsingAnyRecompiler() || !g_settings.cpu_recompiler_block_cache)
+    return;
+
+  const System::GameHash hash = System::GetGameHash();
+  if (!s_block_cache_loaded || s_block_cache_game_hash != hash)
+  {
+    if (s_block_cache_loaded)
+    {
+      RecordBlocksInBlockCache();
+      SaveBlockCache();
+    }
+
+    LoadBlockCache(hash);
+  }
+
+  Common::Timer timer;
+  u32 compiled = 0;
+  u32 stale = 0;
+
+  // Keep the code writable for the whole batch, rather than toggling it for every block.
+  MemMap::BeginCodeWrite();
+  for (const auto& [pc, code] : s_block_cache_entries)
+  {
+    // Leave plenty of room for blocks which aren't in the cache, running out will start evicting.
+    if (s_code_wrapped || s_far_code_wrapped || s_code_segment >= (CODE_BUFFER_SEGMENTS * 3 / 4) ||
+        s_far_code_segment >= (CODE_BUFFER_SEGMENTS * 3 / 4))
+    {
+      Log_WarningPrint("Code buffer is getting full, not precompiling any more blocks.");
+      break;
+    }
+
+    if (LookupBlock(pc))
+      continue;
+
+    // Only compile blocks whose code is already in memory, i.e. the same check IsBlockCodeCurrent() does.
+    const u32 size = static_cast<u32>(code.size());
+    const u8* ptr = GetBlockCacheCodePointer(pc, size);
+    if (!ptr || std::memcmp(ptr, code.data(), size * sizeof(Instruction)) != 0)
+    {
+      stale++;
+      continue;
+    }
+
+    CompileOrRevalidateBlock(pc);
+    compiled++;
+  }
+  MemMap::EndCodeWrite();
+
+  Log_InfoFmt("Precompiled {} blocks from block cache in {:.2f} ms, {} not present in memory.", compiled,
+              timer.GetTimeMilliseconds(), stale);
+#endif
+}
+
+#ifdef ENABLE_RECOMPILER_SUPPORT
+
 JitCodeBuffer& CPU::CodeCache::GetCodeBuffer()
 {
   return s_code_buffer;
@@ -1459,8 +2280,152 @@ void CPU::CodeCache::CompileASMFunctions()
   MemMap::EndCodeWrite();
 }
 
+void CPU::CodeCache::ResetCodeSegments()
+{
+  // The ASM functions are never evicted.
+  s_code_segment_base = s_code_buffer.GetFreeCodePointer();
+  s_code_segment_start = s_code_buffer.GetCodeUsed();
+  s_code_segment_size = (s_code_buffer.GetCodeSize() - s_code_segment_start) / CODE_BUFFER_SEGMENTS;
+  s_far_code_segment_size = s_code_buffer.GetFarCodeSize() / CODE_BUFFER_SEGMENTS;
+  s_code_segment = 0;
+  s_far_code_segment = 0;
+  s_code_wrapped = false;
+  s_far_code_wrapped = false;
+
+  s_code_buffer.SetCodeRange(s_code_segment_start, s_code_segment_size);
+  s_code_buffer.SetFarCodeRange(0, s_far_code_segment_size);
+}
+
+bool CPU::CodeCache::AllocateCodeSpace(u32 near_size, u32 far_size)
+{
+  if (near_size > s_code_segment_size || far_size > s_far_code_segment_size)
+    return false;
+
+  if (s_code_buffer.GetFreeCodeSpace() < near_size)
+  {
+    s_code_segment = static_cast<u8>((s_code_segment + 1) % CODE_BUFFER_SEGMENTS);
+    s_code_wrapped |= (s_code_segment == 0);
+    EvictCodeSegment(s_code_segment, false);
+    s_code_buffer.SetCodeRange(s_code_segment_start + (s_code_segment * s_code_segment_size), s_code_segment_size);
+  }
+
+  if (s_code_buffer.GetFreeFarCodeSpace() < far_size)
+  {
+    s_far_code_segment = static_cast<u8>((s_far_code_segment + 1) % CODE_BUFFER_SEGMENTS);
+    s_far_code_wrapped |= (s_far_code_segment == 0);
+    EvictCodeSegment(s_far_code_segment, true);
+    s_code_buffer.SetFarCodeRange(s_far_code_segment * s_far_code_segment_size, s_far_code_segment_size);
+  }
+
+  return true;
+}
+
+void CPU::CodeCache::EvictCodeSegment(u32 segment, bool far_code)
+{
+  u32 count = 0;
+  for (Block* block : s_blocks)
+  {
+    if (!block->host_code || (far_code ? block->far_code_segment : block->code_segment) != segment)
+      continue;
+
+    if (block->state == BlockState::Valid)
+    {
+      RemoveBlockFromPageList(block);
+      InvalidateBlock(block, BlockState::NeedsRecompile);
+    }
+    else
+    {
+      // Already pointing at the compiler, just make sure it doesn't get revalidated.
+      block->state = BlockState::NeedsRecompile;
+    }
+
+    // The links out of this block are in the code which is about to be overwritten.
+    UnlinkBlockExits(block);
+
+    // Backpatch info is keyed by the near code, which may be in another segment when evicting far code.
+    if (far_code)
+      RemoveFastmemBackpatchInfo(block->host_code, block->host_code_size);
+
+    block->host_code = nullptr;
+    count++;
+  }
+
+  if (!far_code)
+    s_fastmem_backpatch_info[segment].clear();
+
+  s_evicted_block_count += count;
+  if (count > 0)
+    Log_DevFmt("Evicted {} blocks from {}code segment {}.", count, far_code ? "far " : "", segment);
+}
+
+CPU::CodeCache::FastmemBackpatchList* CPU::CodeCache::GetFastmemBackpatchList(const void* code_address,
+                                                                                u32* code_offset)
+{
+  const u8* ptr = static_cast<const u8*>(code_address);
+  if (ptr < s_code_segment_base || s_code_segment_size == 0)
+    return nullptr;
+
+  const size_t offset = static_cast<size_t>(ptr - s_code_segment_base);
+  const size_t segment = offset / s_code_segment_size;
+  if (segment >= CODE_BUFFER_SEGMENTS)
+    return nullptr;
+
+  *code_offset = static_cast<u32>(offset);
+  return &s_fastmem_backpatch_info[segment];
+}
+
+const CPU::CodeCache::LoadstoreBackpatchInfo* CPU::CodeCache::FindFastmemBackpatchInfo(const void* code_address)
+{
+  u32 code_offset;
+  const FastmemBackpatchList* list = GetFastmemBackpatchList(code_address, &code_offset);
+  if (!list)
+    return nullptr;
+
+  const auto it = std::lower_bound(
+    list->begin(), list->end(), code_offset,
+    [](const FastmemBackpatchEntry& entry, u32 offset) { return entry.code_offset < offset; });
+  return (it != list->end() && it->code_offset == code_offset) ? &it->info : nullptr;
+}
+
+void CPU::CodeCache::AddFastmemBackpatchInfo(const void* code_address, const LoadstoreBackpatchInfo& info)
+{
+  u32 code_offset;
+  FastmemBackpatchList* list = GetFastmemBackpatchList(code_address, &code_offset);
+  Assert(list);
+
+  // Fast path, code is emitted in increasing address order.
+  if (list->empty() || list->back().code_offset < code_offset)
+  {
+    list->push_back(FastmemBackpatchEntry{code_offset, info});
+    return;
+  }
+
+  const auto it = std::lower_bound(
+    list->begin(), list->end(), code_offset,
+    [](const FastmemBackpatchEntry& entry, u32 offset) { return entry.code_offset < offset; });
+  if (it != list->end() && it->code_offset == code_offset)
+    it->info = info;
+  else
+    list->insert(it, FastmemBackpatchEntry{code_offset, info});
+}
+
+void CPU::CodeCache::RemoveFastmemBackpatchInfo(const void* code_address, u32 code_size)
+{
+  u32 code_offset;
+  FastmemBackpatchList* list = GetFastmemBackpatchList(code_address, &code_offset);
+  if (!list)
+    return;
+
+  const auto pred = [](const FastmemBackpatchEntry& entry, u32 offset) { return entry.code_offset < offset; };
+  const auto first = std::lower_bound(list->begin(), list->end(), code_offset, pred);
+  const auto last = std::lower_bound(first, list->end(), code_offset + code_size, pred);
+  list->erase(first, last);
+}
+
 bool CPU::CodeCache::CompileBlock(Block* block)
 {
+  TRACE_SCOPE("CodeCache::CompileBlock");
+
   const void* host_code = nullptr;
   u32 host_code_size = 0;
   u32 host_far_code_size = 0;
@@ -1478,6 +2443,9 @@ bool CPU::CodeCache::CompileBlock(Block* block)
 #endif
 
   block->host_code = host_code;
+  block->host_code_size = host_code_size;
+  block->code_segment = s_code_segment;
+  block->far_code_segment = (host_far_code_size > 0) ? s_far_code_segment : NO_CODE_SEGMENT;
 
   if (!host_code)
   {
@@ -1486,6 +2454,8 @@ bool CPU::CodeCache::CompileBlock(Block* block)
     return false;
   }
 
+  s_compiled_block_count++;
+
 #ifdef _DEBUG
   const u32 host_instructions = GetHostInstructionCount(host_code, host_code_size);
   s_total_instructions_compiled += block->size;
@@ -1520,16 +2490,12 @@ void CPU::CodeCache::AddLoadStoreInfo(void* code_address, u32 code_size, u32 gue
 {
   DebugAssert(code_size < std::numeric_limits<u8>::max());
 
-  auto iter = s_fastmem_backpatch_info.find(code_address);
-  if (iter != s_fastmem_backpatch_info.end())
-    s_fastmem_backpatch_info.erase(iter);
-
   LoadstoreBackpatchInfo info;
   info.thunk_address = thunk_address;
   info.guest_pc = guest_pc;
   info.guest_block = 0;
   info.code_size = static_cast<u8>(code_size);
-  s_fastmem_backpatch_info.emplace(code_address, info);
+  AddFastmemBackpatchInfo(code_address, info);
 }
 
 void CPU::CodeCache::AddLoadStoreInfo(void* code_address, u32 code_size, u32 guest_pc, u32 guest_block,
@@ -1539,10 +2505,6 @@ void CPU::CodeCache::AddLoadStoreInfo(void* code_address, u32 code_size, u32 gue
   DebugAssert(code_size < std::numeric_limits<u8>::max());
   DebugAssert(cycles >= 0 && cycles < std::numeric_limits<u16>::max());
 
-  auto iter = s_fastmem_backpatch_info.find(code_address);
-  if (iter != s_fastmem_backpatch_info.end())
-    s_fastmem_backpatch_info.erase(iter);
-
   LoadstoreBackpatchInfo info;
   info.thunk_address = nullptr;
   info.guest_pc = guest_pc;
@@ -1555,7 +2517,7 @@ void CPU::CodeCache::AddLoadStoreInfo(void* code_address, u32 code_size, u32 gue
   info.is_signed = is_signed;
   info.is_load = is_load;
   info.code_size = static_cast<u8>(code_size);
-  s_fastmem_backpatch_info.emplace(code_address, info);
+  AddFastmemBackpatchInfo(code_address, info);
 }
 
 Common::PageFaultHandler::HandlerResult CPU::CodeCache::HandleFastmemException(void* exception_pc, void* fault_address,
@@ -1587,8 +2549,8 @@ Common::PageFaultHandler::HandlerResult CPU::CodeCache::HandleFastmemException(v
   Log_DevFmt("Page fault handler invoked at PC={} Address={} {}, fastmem offset {:08X}", exception_pc, fault_address,
              is_write ? "(write)" : "(read)", guest_address);
 
-  auto iter = s_fastmem_backpatch_info.find(exception_pc);
-  if (iter == s_fastmem_backpatch_info.end())
+  const LoadstoreBackpatchInfo* info_ptr = FindFastmemBackpatchInfo(exception_pc);
+  if (!info_ptr)
   {
     Log_ErrorFmt("No backpatch info found for {}", exception_pc);
     return Common::PageFaultHandler::HandlerResult::ExecuteNextHandler;
@@ -1596,8 +2558,9 @@ Common::PageFaultHandler::HandlerResult CPU::CodeCache::HandleFastmemException(v
 
   // if we're writing to ram, let it go through a few times, and use manual block protection to sort it out
   // TODO: path for manual protection to return back to read-only pages
-  LoadstoreBackpatchInfo& info = iter->second;
-  if (is_write && !g_state.cop0_regs.sr.Isc && AddressInRAM(guest_address))
+  const LoadstoreBackpatchInfo info = *info_ptr;
+  if (is_write && !g_state.cop0_regs.sr.Isc && AddressInRAM(guest_address) &&
+      IsCodeSubPageWrite(guest_address & Bus::g_ram_mask, info.AccessSizeInBytes()))
   {
     Log_DevFmt("Ignoring fault due to RAM write @ 0x{:08X}", guest_address);
     InvalidateBlocksWithPageIndex(Bus::GetRAMCodePageIndex(guest_address));
@@ -1633,14 +2596,136 @@ Common::PageFaultHandler::HandlerResult CPU::CodeCache::HandleFastmemException(v
   MemMap::EndCodeWrite();
 
   // and store the pc in the faulting list, so that we don't emit another fastmem loadstore
-  s_fastmem_faulting_pcs.insert(info.guest_pc);
-  s_fastmem_backpatch_info.erase(iter);
+  if (const auto it = std::lower_bound(s_fastmem_faulting_pcs.begin(), s_fastmem_faulting_pcs.end(), info.guest_pc);
+      it == s_fastmem_faulting_pcs.end() || *it != info.guest_pc)
+  {
+    s_fastmem_faulting_pcs.insert(it, info.guest_pc);
+  }
+  RemoveFastmemBackpatchInfo(exception_pc, 1);
   return Common::PageFaultHandler::HandlerResult::ContinueExecution;
 }
 
+CPU::CodeCache::BlockProfileEntry& CPU::CodeCache::GetBlockProfileEntry(u32 pc)
+{
+  const auto [it, inserted] = s_block_profile_lookup.emplace(pc, static_cast<u32>(s_block_profile.size()));
+  if (inserted)
+    s_block_profile.push_back(BlockProfileEntry{pc, 0, 0, 0, 0, 0, {}});
+
+  return s_block_profile[it->second];
+}
+
+u32 CPU::CodeCache::RegisterProfiledBlock(const Block* block)
+{
+  BlockProfileEntry& entry = GetBlockProfileEntry(block->pc);
+  entry.compiles++;
+  entry.code.resize(block->size);
+  for (u32 i = 0; i < block->size; i++)
+    entry.code[i] = block->Instructions()[i].bits;
+
+  return s_block_profile_lookup[block->pc];
+}
+
+void CPU::CodeCache::RecordBlockProfileInvalidation(u32 pc)
+{
+  GetBlockProfileEntry(pc).invalidations++;
+}
+
+void CPU::CodeCache::RecordBlockProfileFallback(u32 pc)
+{
+  GetBlockProfileEntry(pc).interpreter_fallbacks++;
+}
+
+void CPU::CodeCache::ProfileBlockEntry()
+{
+  // The time since the last block was entered is attributed to that block. This includes any time spent in event
+  // handlers or the dispatcher afterwards, so it's only an approximation, but good enough to find hot spots.
+  const Common::Timer::Value now = Common::Timer::GetCurrentValue();
+  if (s_block_profile_last_index < s_block_profile.size())
+    s_block_profile[s_block_profile_last_index].host_time += now - s_block_profile_last_time;
+
+  const u32 index = g_state.profile_block_index;
+  s_block_profile[index].entries++;
+  s_block_profile_last_index = index;
+  s_block_profile_last_time = now;
+}
+
+void CPU::CodeCache::SkipIdleLoop()
+{
+  // The cycles for the current iteration are added after this, so we'll still overshoot the downcount slightly,
+  // same as when the loop runs normally.
+  if (g_state.pending_ticks < g_state.downcount)
+    g_state.pending_ticks = g_state.downcount;
+}
+
+void CPU::CodeCache::ClearBlockProfile()
+{
+  s_block_profile.clear();
+  s_block_profile_lookup.clear();
+  s_block_profile_last_index = std::numeric_limits<u32>::max();
+  s_block_profile_last_time = 0;
+}
+
+void CPU::CodeCache::DumpBlockProfile()
+{
+  if (s_block_profile.empty())
+    return;
+
+  const std::string filename = Path::Combine(EmuFolders::Dumps, "block_profile.txt");
+  auto fp = FileSystem::OpenManagedCFile(filename.c_str(), "wb");
+  if (!fp)
+  {
+    Log_ErrorFmt("Failed to open block profile '{}' for writing.", filename);
+    return;
+  }
+
+  std::vector<const BlockProfileEntry*> sorted;
+  sorted.reserve(s_block_profile.size());
+  Common::Timer::Value total_time = 0;
+  u64 total_entries = 0;
+  for (const BlockProfileEntry& entry : s_block_profile)
+  {
+    sorted.push_back(&entry);
+    total_time += entry.host_time;
+    total_entries += entry.entries;
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const BlockProfileEntry* lhs, const BlockProfileEntry* rhs) {
+    return (lhs->host_time != rhs->host_time) ? (lhs->host_time > rhs->host_time) : (lhs->entries > rhs->entries);
+  });
+
+  std::fprintf(fp.get(), "# %zu blocks, %" PRIu64 " entries, %.2f ms total host time\n", sorted.size(), total_entries,
+               Common::Timer::ConvertValueToMilliseconds(total_time));
+  std::fprintf(fp.get(), "# host time is measured between block entries, and includes events/dispatcher time\n\n");
+
+  SmallString disasm;
+  for (const BlockProfileEntry* entry : sorted)
+  {
+    const double time_ms = Common::Timer::ConvertValueToMilliseconds(entry->host_time);
+    std::fprintf(fp.get(),
+                 "Block 0x%08X: %" PRIu64 " entries, %.3f ms (%.2f%%), %u instructions, %u compiles, "
+                 "%u invalidations, %u interpreter fallbacks\n",
+                 entry->pc, entry->entries, time_ms,
+                 (total_time > 0) ? (static_cast<double>(entry->host_time) * 100.0 / static_cast<double>(total_time)) :
+                                    0.0,
+                 static_cast<u32>(entry->code.size()), entry->compiles, entry->invalidations,
+                 entry->interpreter_fallbacks);
+
+    u32 pc = entry->pc;
+    for (const u32 bits : entry->code)
+    {
+      DisassembleInstruction(&disasm, pc, bits);
+      std::fprintf(fp.get(), "  %08X: %08X  %s\n", pc, bits, disasm.c_str());
+      pc += sizeof(Instruction);
+    }
+
+    std::fputc('\n', fp.get());
+  }
+
+  Log_InfoFmt("Wrote profile for {} blocks to '{}'.", sorted.size(), filename);
+}
+
 bool CPU::CodeCache::HasPreviouslyFaultedOnPC(u32 guest_pc)
 {
-  return (s_fastmem_faulting_pcs.find(guest_pc) != s_fastmem_faulting_pcs.end());
+  return std::binary_search(s_fastmem_faulting_pcs.begin(), s_fastmem_faulting_pcs.end(), guest_pc);
 }
 
 void CPU::CodeCache::BackpatchLoadStore(void* host_pc, const LoadstoreBackpatchInfo& info)
@@ -35,7 +35,30 @@ void Reset();
 /// Invalidates all blocks which are in the range of the specified code page.
 void InvalidateBlocksWithPageIndex(u32 page_index);
 
+/// Invalidates the blocks in the page written to, if the write touched a part of it which contains code. offset is
+/// relative to the start of RAM, and the write must have gone through the unprotected mapping.
+void InvalidateBlocksWithRAMWrite(u32 offset, u32 size);
+
 /// Invalidates all blocks in the cache.
 void InvalidateAllRAMBlocks();
 
+/// Invalidates the blocks in write-protected pages whose contents differ in new_ram, which is about to replace RAM.
+void InvalidateChangedRAMBlocks(const u8* new_ram);
+
+/// Compiles blocks recorded in the persistent block cache for the running game, if their code is in memory.
+void PrecompileCachedBlocks();
+
+/// Returns the number of blocks which have been compiled to host code since startup.
+u32 GetCompiledBlockCount();
+
+/// Returns the number of blocks currently in the cache.
+u32 GetBlockCount();
+
+/// Returns the number of bytes of host code in the code buffer, and its capacity.
+u32 GetCodeBufferUsed();
+u32 GetCodeBufferSize();
+
+/// Returns the number of blocks whose host code has been evicted to make room for new code since startup.
+u32 GetEvictedBlockCount();
+
 } // namespace CPU::CodeCache
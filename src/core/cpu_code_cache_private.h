@@ -31,12 +31,15 @@ enum : u32
   LUT_TABLE_SIZE = 0x10000 / sizeof(u32), // 16384, one for each PC
   LUT_TABLE_SHIFT = 16,
 
-  MAX_BLOCK_EXIT_LINKS = 2,
+  // Newrec blocks continue through the fallthrough path of up to this many forward conditional branches, i.e. the
+  // not-taken path is compiled inline, and the taken path becomes a side exit.
+  MAX_TRACE_CONDITIONAL_BRANCHES = 4,
+
+  MAX_BLOCK_EXIT_LINKS = 2 + MAX_TRACE_CONDITIONAL_BRANCHES,
 };
 
 using CodeLUT = const void**;
 using CodeLUTArray = std::array<CodeLUT, LUT_TABLE_COUNT>;
-using BlockLinkMap = std::unordered_multimap<u32, void*>; // TODO: try ordered?
 
 enum RegInfoFlags : u8
 {
@@ -45,6 +48,32 @@ enum RegInfoFlags : u8
   RI_LASTUSE = (1 << 2),
 };
 
+// Predecoded instructions for the cached interpreter. Simple ALU ops, which can't raise exceptions, are executed
+// directly from the operands extracted when the block was created. Generic goes through the full interpreter.
+enum class CachedInterpreterOp : u8
+{
+  Generic,
+  Nop,
+  Sll,
+  Srl,
+  Sra,
+  Addu,
+  Subu,
+  And,
+  Or,
+  Xor,
+  Nor,
+  Slt,
+  Sltu,
+  Addiu,
+  Slti,
+  Sltiu,
+  Andi,
+  Ori,
+  Xori,
+  Lui,
+};
+
 struct InstructionInfo
 {
   u32 pc; // TODO: Remove this, old recs still depend on it.
@@ -64,6 +93,13 @@ struct InstructionInfo
   // Reg write_reg[3];
   Reg read_reg[3];
 
+  // for the cached interpreter, rt is unused for immediate ops, imm is the extended immediate or shift amount
+  CachedInterpreterOp interpreter_op;
+  Reg interpreter_rd;
+  Reg interpreter_rs;
+  Reg interpreter_rt;
+  u32 interpreter_imm;
+
   // If unset, values which are not live will not be written back to memory.
   // Tends to break stuff at the moment.
   static constexpr bool WRITE_DEAD_VALUES = true;
@@ -100,6 +136,7 @@ enum class BlockFlags : u8
   ContainsLoadStoreInstructions = (1 << 0),
   SpansPages = (1 << 1),
   BranchDelaySpansPages = (1 << 2),
+  IsIdleLoop = (1 << 3),
 };
 IMPLEMENT_ENUM_CLASS_BITWISE_OPERATORS(BlockFlags);
 
@@ -117,6 +154,16 @@ struct BlockMetadata
   BlockFlags flags;
 };
 
+// A jump in a block's code to another block. Links are kept in an intrusive list of the links into their target, so
+// a block can be relinked or have its exits removed without searching. prev points at the previous link's next, or the
+// head of the list, which is the target block's incoming_links, or the pending list while the target isn't compiled.
+struct BlockLink
+{
+  void* code;
+  BlockLink* next;
+  BlockLink** prev;
+};
+
 #ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4324) // C4324: 'CPU::CodeCache::Block': structure was padded due to alignment specifier)
@@ -131,7 +178,9 @@ struct alignas(16) Block
   // links to previous/next block within page
   Block* next_block_in_page;
 
-  BlockLinkMap::iterator exit_links[MAX_BLOCK_EXIT_LINKS];
+  // links from this block's code, and the head of the list of links in other blocks which jump to this one
+  BlockLink exit_links[MAX_BLOCK_EXIT_LINKS];
+  BlockLink* incoming_links;
   u8 num_exit_links;
 
   // TODO: Move up so it's part of the same cache line
@@ -142,9 +191,17 @@ struct alignas(16) Block
   TickCount uncached_fetch_ticks;
   u32 icache_line_count;
 
+  // g_state.icache_generation when the block last checked its lines, no tags have changed since if it still matches
+  u32 icache_generation;
+
   u32 compile_frame;
   u8 compile_count;
 
+  // code buffer segments holding the host code, for eviction
+  u8 code_segment;
+  u8 far_code_segment;
+  u32 host_code_size;
+
   // followed by Instruction * size, InstructionRegInfo * size
   ALWAYS_INLINE const Instruction* Instructions() const { return reinterpret_cast<const Instruction*>(this + 1); }
   ALWAYS_INLINE Instruction* Instructions() { return reinterpret_cast<Instruction*>(this + 1); }
@@ -213,6 +270,10 @@ static inline bool AddressInRAM(VirtualMemoryAddress pc)
   return VirtualAddressToPhysical(pc) < Bus::g_ram_size;
 }
 
+// Code pages are split into sub-pages, so that writes to data which shares a page with code can be told apart.
+static constexpr u32 CODE_SUBPAGE_SIZE = 256;
+static_assert((HOST_PAGE_SIZE / CODE_SUBPAGE_SIZE) <= 64);
+
 struct PageProtectionInfo
 {
   Block* first_block_in_page;
@@ -221,8 +282,11 @@ struct PageProtectionInfo
   PageProtectionMode mode;
   u16 invalidate_count;
   u32 invalidate_frame;
+
+  // bit per sub-page containing the code of a block in the list, may include blocks which have since left it
+  u64 code_subpage_mask;
 };
-static_assert(sizeof(PageProtectionInfo) == (sizeof(Block*) * 2 + 8));
+static_assert(sizeof(PageProtectionInfo) == (sizeof(Block*) * 2 + 16));
 
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const Block* block);
@@ -258,6 +322,16 @@ void AddLoadStoreInfo(void* code_address, u32 code_size, u32 guest_pc, u32 guest
                       bool is_load);
 bool HasPreviouslyFaultedOnPC(u32 guest_pc);
 
+/// Block profiling, enabled with cpu_recompiler_block_profiling. Recompilers call RegisterProfiledBlock() when
+/// compiling a block, and emit a store of the returned index to g_state.profile_block_index followed by a call to
+/// ProfileBlockEntry() in the block prologue.
+u32 RegisterProfiledBlock(const Block* block);
+void ProfileBlockEntry();
+void DumpBlockProfile();
+
+/// Called on the back edge of blocks flagged as idle loops, moves time forward to the next event.
+void SkipIdleLoop();
+
 u32 EmitASMFunctions(void* code, u32 code_size);
 u32 EmitJump(void* code, const void* dst, bool flush_icache);
 
@@ -4,13 +4,16 @@
 #include "cpu_core.h"
 #include "bus.h"
 #include "common/align.h"
+#include "common/error.h"
 #include "common/fastjmp.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/path.h"
 #include "cpu_code_cache_private.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
 #include "cpu_recompiler_thunks.h"
+#include "cpu_trace.h"
 #include "gte.h"
 #include "host.h"
 #include "pcdrv.h"
@@ -51,7 +54,7 @@ static void TracePrintInstruction();
 
 static void DisassembleAndPrint(u32 addr, const char* prefix);
 static void PrintInstruction(u32 bits, u32 pc, Registers* regs, const char* prefix);
-static void LogInstruction(u32 bits, u32 pc, Registers* regs);
+static void TraceExecutionModeChanged();
 
 static void HandleWriteSyscall();
 static void HandlePutcSyscall();
@@ -87,6 +90,7 @@ static fastjmp_buf s_jmp_buf;
 static std::FILE* s_log_file = nullptr;
 static bool s_log_file_opened = false;
 static bool s_trace_to_log = false;
+static bool s_flush_blocks_for_trace = false;
 
 static constexpr u32 INVALID_BREAKPOINT_PC = UINT32_C(0xFFFFFFFF);
 static std::vector<Breakpoint> s_breakpoints;
@@ -106,8 +110,16 @@ void CPU::StartTrace()
   if (s_trace_to_log)
     return;
 
+  const std::string path = Path::Combine(EmuFolders::Dumps, TRACE_FILENAME);
+  Error error;
+  if (!Trace::Start(path.c_str(), &error))
+  {
+    Log_ErrorPrintf("Failed to start CPU trace to '%s': %s", path.c_str(), error.GetDescription().c_str());
+    return;
+  }
+
   s_trace_to_log = true;
-  UpdateDebugDispatcherFlag();
+  TraceExecutionModeChanged();
 }
 
 void CPU::StopTrace()
@@ -115,12 +127,29 @@ void CPU::StopTrace()
   if (!s_trace_to_log)
     return;
 
+  Trace::Stop();
+
   if (s_log_file)
     std::fclose(s_log_file);
 
   s_log_file_opened = false;
   s_trace_to_log = false;
+  TraceExecutionModeChanged();
+}
+
+void CPU::TraceExecutionModeChanged()
+{
   UpdateDebugDispatcherFlag();
+
+  // The interpreter traces every instruction through the debug dispatcher. Everything else traces block entries, so
+  // blocks compiled before now have to be thrown away and rebuilt with, or without, the entry hook. That can't happen
+  // while one is running, so it's left for the next time execution starts.
+  if (g_settings.cpu_execution_mode != CPUExecutionMode::Interpreter)
+  {
+    s_flush_blocks_for_trace = true;
+    if (System::IsExecuting())
+      ExitExecution();
+  }
 }
 
 void CPU::WriteToExecutionLog(const char* format, ...)
@@ -150,6 +179,7 @@ void CPU::Initialize()
   g_state.cop0_regs.PRID = UINT32_C(0x00000002);
 
   g_state.use_debug_dispatcher = false;
+  s_flush_blocks_for_trace = false;
   s_breakpoints.clear();
   s_breakpoint_counter = 1;
   s_last_breakpoint_check_pc = INVALID_BREAKPOINT_PC;
@@ -255,6 +285,7 @@ bool CPU::DoState(StateWrapper& sw)
   {
     sw.Do(&g_state.icache_tags);
     sw.Do(&g_state.icache_data);
+    g_state.icache_generation++;
   }
 
   if (sw.IsReading())
@@ -650,23 +681,6 @@ void CPU::PrintInstruction(u32 bits, u32 pc, Registers* regs, const char* prefix
   Log_DevPrintf("%s%08x: %08x %s", prefix, pc, bits, instr.c_str());
 }
 
-void CPU::LogInstruction(u32 bits, u32 pc, Registers* regs)
-{
-  TinyString instr;
-  TinyString comment;
-  DisassembleInstruction(&instr, pc, bits);
-  DisassembleInstructionComment(&comment, pc, bits, regs);
-  if (!comment.empty())
-  {
-    for (u32 i = instr.length(); i < 30; i++)
-      instr.append(' ');
-    instr.append("; ");
-    instr.append(comment);
-  }
-
-  WriteToExecutionLog("%08x: %08x %s\n", pc, bits, instr.c_str());
-}
-
 void CPU::HandleWriteSyscall()
 {
   const auto& regs = g_state.regs;
@@ -1878,7 +1892,8 @@ void CPU::UpdateDebugDispatcherFlag()
     dcic.super_master_enable_1 && dcic.super_master_enable_2 && dcic.execution_breakpoint_enable;
 
   const bool use_debug_dispatcher =
-    has_any_breakpoints || has_cop0_breakpoints || s_trace_to_log ||
+    has_any_breakpoints || has_cop0_breakpoints ||
+    (s_trace_to_log && g_settings.cpu_execution_mode == CPUExecutionMode::Interpreter) ||
     (g_settings.cpu_execution_mode == CPUExecutionMode::Interpreter && g_settings.bios_tty_logging);
   if (use_debug_dispatcher == g_state.use_debug_dispatcher)
     return;
@@ -2167,8 +2182,7 @@ template<PGXPMode pgxp_mode, bool debug>
       // trace functionality
       if constexpr (debug)
       {
-        if (s_trace_to_log)
-          LogInstruction(g_state.current_instruction.bits, g_state.current_instruction_pc, &g_state.regs);
+        Trace::LogInstruction(g_state.current_instruction_pc, g_state.current_instruction.bits);
 
         if (g_state.current_instruction_pc == 0xA0) [[unlikely]]
           HandleA0Syscall();
@@ -2210,6 +2224,12 @@ void CPU::ExecuteDebug()
 
 void CPU::Execute()
 {
+  if (s_flush_blocks_for_trace) [[unlikely]]
+  {
+    s_flush_blocks_for_trace = false;
+    CodeCache::Reset();
+  }
+
   const CPUExecutionMode exec_mode = g_settings.cpu_execution_mode;
   const bool use_debug_dispatcher = g_state.use_debug_dispatcher;
   if (fastjmp_set(&s_jmp_buf) != 0)
@@ -2263,6 +2283,46 @@ void CPU::SingleStep()
   Host::ReportFormattedDebuggerMessage("Stepped to 0x%08X.", g_state.pc);
 }
 
+// Returns false if the instruction needs the full interpreter.
+ALWAYS_INLINE_RELEASE static bool ExecuteCachedInterpreterOp(const CPU::CodeCache::InstructionInfo* info)
+{
+  using CPU::CodeCache::CachedInterpreterOp;
+
+  const u32 rs = CPU::ReadReg(info->interpreter_rs);
+  const u32 rt = CPU::ReadReg(info->interpreter_rt);
+  const u32 imm = info->interpreter_imm;
+  u32 value;
+
+  switch (info->interpreter_op)
+  {
+      // clang-format off
+    case CachedInterpreterOp::Nop: return true;
+    case CachedInterpreterOp::Sll: value = rt << imm; break;
+    case CachedInterpreterOp::Srl: value = rt >> imm; break;
+    case CachedInterpreterOp::Sra: value = static_cast<u32>(static_cast<s32>(rt) >> imm); break;
+    case CachedInterpreterOp::Addu: value = rs + rt; break;
+    case CachedInterpreterOp::Subu: value = rs - rt; break;
+    case CachedInterpreterOp::And: value = rs & rt; break;
+    case CachedInterpreterOp::Or: value = rs | rt; break;
+    case CachedInterpreterOp::Xor: value = rs ^ rt; break;
+    case CachedInterpreterOp::Nor: value = ~(rs | rt); break;
+    case CachedInterpreterOp::Slt: value = BoolToUInt32(static_cast<s32>(rs) < static_cast<s32>(rt)); break;
+    case CachedInterpreterOp::Sltu: value = BoolToUInt32(rs < rt); break;
+    case CachedInterpreterOp::Addiu: value = rs + imm; break;
+    case CachedInterpreterOp::Slti: value = BoolToUInt32(static_cast<s32>(rs) < static_cast<s32>(imm)); break;
+    case CachedInterpreterOp::Sltiu: value = BoolToUInt32(rs < imm); break;
+    case CachedInterpreterOp::Andi: value = rs & imm; break;
+    case CachedInterpreterOp::Ori: value = rs | imm; break;
+    case CachedInterpreterOp::Xori: value = rs ^ imm; break;
+    case CachedInterpreterOp::Lui: value = imm; break;
+    default: return false;
+      // clang-format on
+  }
+
+  CPU::WriteReg(info->interpreter_rd, value);
+  return true;
+}
+
 template<PGXPMode pgxp_mode>
 void CPU::CodeCache::InterpretCachedBlock(const Block* block)
 {
@@ -2290,8 +2350,9 @@ void CPU::CodeCache::InterpretCachedBlock(const Block* block)
     g_state.pc = g_state.npc;
     g_state.npc += 4;
 
-    // execute the instruction we previously fetched
-    ExecuteInstruction<pgxp_mode, false>();
+    // execute the instruction we previously fetched, PGXP needs to see every ALU op
+    if (pgxp_mode != PGXPMode::Disabled || !ExecuteCachedInterpreterOp(info))
+      ExecuteInstruction<pgxp_mode, false>();
 
     // next load delay
     UpdateLoadDelay();
@@ -2334,6 +2395,9 @@ void CPU::CodeCache::InterpretUncachedBlock()
     g_state.branch_was_taken = false;
     g_state.exception_raised = false;
 
+    // Blocks which fall back to this don't have any code to trace on entry.
+    Trace::LogInstruction(g_state.current_instruction_pc, g_state.current_instruction.bits);
+
     // Fetch the next instruction, except if we're in a branch delay slot. The "fetch" is done in the next block.
     const bool branch = IsBranchInstruction(g_state.current_instruction);
     if (!g_state.current_instruction_in_branch_delay_slot || branch)
@@ -2381,17 +2445,15 @@ bool CPU::Recompiler::Thunks::InterpretInstructionPGXP()
 ALWAYS_INLINE_RELEASE Bus::MemoryReadHandler CPU::GetMemoryReadHandler(VirtualMemoryAddress address,
                                                                        MemoryAccessSize size)
 {
-  Bus::MemoryReadHandler* base =
-    Bus::OffsetHandlerArray<Bus::MemoryReadHandler>(g_state.memory_handlers, size, MemoryAccessType::Read);
-  return base[address >> Bus::MEMORY_LUT_PAGE_SHIFT];
+  return Bus::GetHandlerForAddress<Bus::MemoryReadHandler>(g_state.memory_handlers, size, MemoryAccessType::Read,
+                                                          address);
 }
 
 ALWAYS_INLINE_RELEASE Bus::MemoryWriteHandler CPU::GetMemoryWriteHandler(VirtualMemoryAddress address,
                                                                          MemoryAccessSize size)
 {
-  Bus::MemoryWriteHandler* base =
-    Bus::OffsetHandlerArray<Bus::MemoryWriteHandler>(g_state.memory_handlers, size, MemoryAccessType::Write);
-  return base[address >> Bus::MEMORY_LUT_PAGE_SHIFT];
+  return Bus::GetHandlerForAddress<Bus::MemoryWriteHandler>(g_state.memory_handlers, size, MemoryAccessType::Write,
+                                                           address);
 }
 
 void CPU::UpdateMemoryPointers()
@@ -2492,6 +2554,7 @@ void CPU::CheckAndUpdateICacheTags(u32 line_count, TickCount uncached_ticks)
       if (g_state.icache_tags[line] != current_pc)
       {
         g_state.icache_tags[line] = current_pc;
+        g_state.icache_generation++;
         ticks += cached_ticks_per_line;
       }
     }
@@ -2530,6 +2593,7 @@ u32 CPU::FillICache(VirtualMemoryAddress address)
       break;
   }
   g_state.icache_tags[line] = line_tag;
+  g_state.icache_generation++;
 
   const u32 offset = GetICacheLineOffset(address);
   u32 result;
@@ -2541,6 +2605,7 @@ void CPU::ClearICache()
 {
   std::memset(g_state.icache_data.data(), 0, ICACHE_SIZE);
   g_state.icache_tags.fill(ICACHE_INVALID_BITS);
+  g_state.icache_generation++;
 }
 
 namespace CPU {
@@ -2765,7 +2830,7 @@ ALWAYS_INLINE bool CPU::DoSafeMemoryAccess(VirtualMemoryAddress address, u32& va
         {
           g_unprotected_ram[offset] = Truncate8(value);
           if (g_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithRAMWrite(offset, sizeof(u8));
         }
       }
       else if constexpr (size == MemoryAccessSize::HalfWord)
@@ -2777,7 +2842,7 @@ ALWAYS_INLINE bool CPU::DoSafeMemoryAccess(VirtualMemoryAddress address, u32& va
         {
           std::memcpy(&g_unprotected_ram[offset], &new_value, sizeof(u16));
           if (g_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithRAMWrite(offset, sizeof(u16));
         }
       }
       else if constexpr (size == MemoryAccessSize::Word)
@@ -2788,7 +2853,7 @@ ALWAYS_INLINE bool CPU::DoSafeMemoryAccess(VirtualMemoryAddress address, u32& va
         {
           std::memcpy(&g_unprotected_ram[offset], &value, sizeof(u32));
           if (g_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithRAMWrite(offset, sizeof(u32));
         }
       }
     }
@@ -85,6 +85,15 @@ struct State
   // 4 bytes of padding here on x64
   bool use_debug_dispatcher = false;
 
+  // index of the block being entered, written by recompiled code when block profiling is enabled
+  u32 profile_block_index = 0;
+
+  // start of the block being entered, written by recompiled code when tracing
+  u32 trace_block_pc = 0;
+
+  // bumped whenever an icache tag changes, so recompiled blocks can tell their lines are still resident
+  u32 icache_generation = 0;
+
   void* fastmem_base = nullptr;
   void** memory_handlers = nullptr;
 
@@ -166,7 +175,8 @@ void DisassembleAndPrint(u32 addr, u32 instructions_before, u32 instructions_aft
 // Write to CPU execution log file.
 void WriteToExecutionLog(const char* format, ...) printflike(1, 2);
 
-// Trace Routines
+// Trace Routines, written to TRACE_FILENAME in the dumps directory.
+static constexpr const char* TRACE_FILENAME = "cpu_trace.bin";
 bool IsTraceEnabled();
 void StartTrace();
 void StopTrace();
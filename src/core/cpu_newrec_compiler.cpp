@@ -6,10 +6,13 @@
 #include "common/log.h"
 #include "common/small_string.h"
 #include "cpu_code_cache.h"
+#include "cpu_code_cache_private.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
+#include "cpu_trace.h"
 #include "pgxp.h"
 #include "settings.h"
+#include <algorithm>
 #include <cstdint>
 #include <limits>
 Log_SetChannel(NewRec::Compiler);
@@ -60,6 +63,10 @@ void CPU::NewRec::Compiler::Reset(CodeCache::Block* block, u8* code_buffer, u32
   m_load_delay_register = Reg::count;
   m_load_delay_value_register = NUM_HOST_REGS;
 
+  m_self_link_entry = nullptr;
+  m_self_link_reg_count = 0;
+  m_self_link_ready = false;
+
   InitSpeculativeRegs();
 }
 
@@ -69,6 +76,8 @@ void CPU::NewRec::Compiler::BeginBlock()
   GenerateCall(reinterpret_cast<const void*>(&CPU::CodeCache::LogCurrentState));
 #endif
 
+  PreloadSelfLinkRegisters();
+
   if (m_block->protection == CodeCache::PageProtectionMode::ManualCheck)
   {
     Log_DebugPrintf("Generate manual protection for PC %08X", m_block->pc);
@@ -77,6 +86,18 @@ void CPU::NewRec::Compiler::BeginBlock()
     GenerateBlockProtectCheck(ram_ptr, shadow_ptr, m_block->size * sizeof(Instruction));
   }
 
+  if (g_settings.cpu_recompiler_block_profiling)
+  {
+    StoreConstantToCPUPointer(CodeCache::RegisterProfiledBlock(m_block), &g_state.profile_block_index);
+    GenerateCall(reinterpret_cast<const void*>(&CPU::CodeCache::ProfileBlockEntry));
+  }
+
+  if (Trace::IsActive())
+  {
+    StoreConstantToCPUPointer(m_block->pc, &g_state.trace_block_pc);
+    GenerateCall(reinterpret_cast<const void*>(&CPU::Trace::LogBlockEntry));
+  }
+
   if (m_block->uncached_fetch_ticks > 0 || m_block->icache_line_count > 0)
     GenerateICacheCheckAndUpdate();
 
@@ -206,6 +227,10 @@ void CPU::NewRec::Compiler::UpdateLoadDelay()
       if (ra.type != HR_TYPE_CPU_REG || !IsHostRegAllocated(i) || ((ra.flags & req_flags) == req_flags))
         continue;
 
+      // preloaded registers are patched up by the flush instead, otherwise the self link would be pointless
+      if (IsSelfLinkHostReg(i))
+        continue;
+
       Log_DebugPrintf("Freeing non-dirty cached register %s in %s", GetRegName(ra.reg), GetHostRegName(i));
       DebugAssert(!(ra.flags & HR_MODE_WRITE));
       ClearHostReg(i);
@@ -339,6 +364,229 @@ u32 CPU::NewRec::Compiler::GetBranchReturnAddress(CompileFlags cf) const
   return m_compiler_pc + (cf.delay_slot_swapped ? 0 : sizeof(Instruction));
 }
 
+CPU::NewRec::Compiler::BranchCondition CPU::NewRec::Compiler::GetInvertedBranchCondition(BranchCondition cond)
+{
+  switch (cond)
+  {
+    case BranchCondition::Equal:
+      return BranchCondition::NotEqual;
+    case BranchCondition::NotEqual:
+      return BranchCondition::Equal;
+    case BranchCondition::GreaterThanZero:
+      return BranchCondition::LessEqualZero;
+    case BranchCondition::GreaterEqualZero:
+      return BranchCondition::LessThanZero;
+    case BranchCondition::LessThanZero:
+      return BranchCondition::GreaterEqualZero;
+    case BranchCondition::LessEqualZero:
+    default:
+      return BranchCondition::GreaterThanZero;
+  }
+}
+
+bool CPU::NewRec::Compiler::IsBranchFallthroughInBlock(CompileFlags cf) const
+{
+  // iinfo has already been advanced when swapping branch delay slots
+  const CodeCache::InstructionInfo* delay_slot_info = cf.delay_slot_swapped ? iinfo : (iinfo + 1);
+  return !delay_slot_info->is_last_instruction;
+}
+
+void CPU::NewRec::Compiler::ContinueAfterBranch(CompileFlags cf)
+{
+  DebugAssert(!m_block_ended);
+
+  // the main loop expects to be on the delay slot, which isn't the case if it was compiled before the branch
+  if (cf.delay_slot_swapped)
+  {
+    inst++;
+    m_current_instruction_pc += sizeof(Instruction);
+  }
+}
+
+void CPU::NewRec::Compiler::GenerateIdleLoopSkip(const std::optional<u32>& newpc, bool do_event_test)
+{
+  if (!do_event_test || !newpc.has_value() || newpc.value() != m_block->pc ||
+      !m_block->HasFlag(CodeCache::BlockFlags::IsIdleLoop))
+  {
+    return;
+  }
+
+  Flush(FLUSH_FOR_C_CALL);
+  GenerateCall(reinterpret_cast<const void*>(&CPU::CodeCache::SkipIdleLoop));
+}
+
+void CPU::NewRec::Compiler::PreloadSelfLinkRegisters()
+{
+  if (m_block->size < 2)
+    return;
+
+  // only worth doing for loops, i.e. the last branch goes back to the start of the block
+  const u32 branch_index = m_block->size - 2;
+  const CodeCache::InstructionInfo& branch_info = m_block->InstructionsInfo()[branch_index];
+  if (!branch_info.is_direct_branch_instruction ||
+      GetDirectBranchTarget(m_block->Instructions()[branch_index], branch_info.pc) != m_block->pc)
+  {
+    return;
+  }
+
+  std::array<u32, static_cast<size_t>(Reg::count)> read_counts = {};
+  const CodeCache::InstructionInfo* info = m_block->InstructionsInfo();
+  for (u32 i = 0; i < m_block->size; i++, info++)
+  {
+    for (const Reg rr : info->read_reg)
+    {
+      if (rr > Reg::zero && rr < Reg::hi)
+        read_counts[static_cast<u8>(rr)]++;
+    }
+  }
+
+  // leave at least half of the callee-saved registers for the block itself
+  u32 max_regs = 0;
+  for (u32 i = 0; i < NUM_HOST_REGS; i++)
+  {
+    if ((m_host_regs[i].flags & (HR_USABLE | HR_CALLEE_SAVED)) == (HR_USABLE | HR_CALLEE_SAVED))
+      max_regs++;
+  }
+  max_regs = std::min(max_regs / 2, MAX_SELF_LINK_REGS);
+
+  while (m_self_link_reg_count < max_regs)
+  {
+    u32 best = 0;
+    for (u32 i = 1; i < static_cast<u32>(Reg::hi); i++)
+    {
+      if (read_counts[i] > read_counts[best])
+        best = i;
+    }
+    if (read_counts[best] == 0)
+      break;
+
+    read_counts[best] = 0;
+
+    const Reg reg = static_cast<Reg>(best);
+    const u32 hreg = AllocateHostReg(HR_MODE_READ | HR_CALLEE_SAVED, HR_TYPE_CPU_REG, reg);
+    Log_DebugPrintf("Preloading guest reg %s in %s for self link", GetRegName(reg), GetHostRegName(hreg));
+    m_self_link_guest_regs[m_self_link_reg_count] = reg;
+    m_self_link_host_regs[m_self_link_reg_count] = static_cast<u8>(hreg);
+    m_self_link_reg_count++;
+  }
+
+  if (m_self_link_reg_count == 0)
+    return;
+
+  ClearHostRegsNeeded();
+  m_self_link_entry = GetCurrentCodePointer();
+}
+
+bool CPU::NewRec::Compiler::IsSelfLinkHostReg(u32 reg) const
+{
+  // only while it still holds the unmodified preloaded value
+  const HostRegAlloc& ra = m_host_regs[reg];
+  if (!m_self_link_entry || !IsHostRegAllocated(reg) || ra.type != HR_TYPE_CPU_REG || (ra.flags & HR_MODE_WRITE))
+    return false;
+
+  for (u32 i = 0; i < m_self_link_reg_count; i++)
+  {
+    if (m_self_link_host_regs[i] == reg)
+      return (m_self_link_guest_regs[i] == ra.reg);
+  }
+
+  return false;
+}
+
+void CPU::NewRec::Compiler::FlushForEndBlock(const std::optional<u32>& newpc, bool do_event_test)
+{
+  GenerateIdleLoopSkip(newpc, do_event_test);
+
+  m_self_link_ready = false;
+  if (!m_self_link_entry || !do_event_test || !newpc.has_value() || newpc.value() != m_block->pc)
+  {
+    Flush(FLUSH_END_BLOCK);
+    return;
+  }
+
+  // Find where each preloaded register lives before the flush releases them. Anything involved in a load delay
+  // is reloaded from the state after the flush instead, since that's where the correct value will be.
+  static constexpr u32 IN_STATE = NUM_HOST_REGS;
+  static constexpr u32 IN_CONSTANT = NUM_HOST_REGS + 1;
+  std::array<u32, MAX_SELF_LINK_REGS> sources;
+  for (u32 i = 0; i < m_self_link_reg_count; i++)
+  {
+    const Reg reg = m_self_link_guest_regs[i];
+    sources[i] = IN_STATE;
+    if (m_load_delay_dirty || reg == m_load_delay_register || reg == m_next_load_delay_register)
+      continue;
+
+    if (HasConstantReg(reg))
+    {
+      sources[i] = IN_CONSTANT;
+      continue;
+    }
+
+    for (u32 j = 0; j < NUM_HOST_REGS; j++)
+    {
+      const HostRegAlloc& ra = m_host_regs[j];
+      if (IsHostRegAllocated(j) && ra.type == HR_TYPE_CPU_REG && ra.reg == reg)
+      {
+        sources[i] = j;
+        break;
+      }
+    }
+  }
+
+  std::array<u32, MAX_SELF_LINK_REGS> constant_values;
+  for (u32 i = 0; i < m_self_link_reg_count; i++)
+  {
+    if (sources[i] == IN_CONSTANT)
+      constant_values[i] = GetConstantRegU32(m_self_link_guest_regs[i]);
+  }
+
+  Flush(FLUSH_END_BLOCK);
+
+  // Moves can't be into a register which is the source of another move, so only copy from registers outside the
+  // preloaded set. Everything else is reloaded after, when no more sources can be overwritten.
+  const auto is_destination = [this](u32 reg) {
+    for (u32 i = 0; i < m_self_link_reg_count; i++)
+    {
+      if (m_self_link_host_regs[i] == reg)
+        return true;
+    }
+    return false;
+  };
+  for (u32 i = 0; i < m_self_link_reg_count; i++)
+  {
+    const u32 dst = m_self_link_host_regs[i];
+    if (sources[i] < NUM_HOST_REGS && sources[i] != dst)
+    {
+      if (is_destination(sources[i]))
+      {
+        sources[i] = IN_STATE;
+        continue;
+      }
+
+      CopyHostReg(dst, sources[i]);
+    }
+  }
+  for (u32 i = 0; i < m_self_link_reg_count; i++)
+  {
+    const u32 dst = m_self_link_host_regs[i];
+    if (sources[i] == IN_CONSTANT)
+      LoadHostRegWithConstant(dst, constant_values[i]);
+    else if (sources[i] == IN_STATE)
+      LoadHostRegFromCPUPointer(dst, &g_state.regs.r[static_cast<u8>(m_self_link_guest_regs[i])]);
+  }
+
+  m_self_link_ready = true;
+}
+
+const void* CPU::NewRec::Compiler::GetSelfLinkTarget(const void* block_start)
+{
+  if (!m_self_link_ready)
+    return block_start;
+
+  m_self_link_ready = false;
+  return m_self_link_entry;
+}
+
 bool CPU::NewRec::Compiler::TrySwapDelaySlot(Reg rs, Reg rt, Reg rd)
 {
   if constexpr (!SWAP_BRANCH_DELAY_SLOTS)
@@ -1110,6 +1358,7 @@ void CPU::NewRec::Compiler::BackupHostState()
   bu.dirty_gte_done_cycle = m_dirty_gte_done_cycle;
   bu.block_ended = m_block_ended;
   bu.inst = inst;
+  bu.iinfo = iinfo;
   bu.current_instruction_pc = m_current_instruction_pc;
   bu.current_instruction_delay_slot = m_current_instruction_branch_delay_slot;
   bu.const_regs_valid = m_constant_regs_valid;
@@ -1138,6 +1387,7 @@ void CPU::NewRec::Compiler::RestoreHostState()
   m_current_instruction_branch_delay_slot = bu.current_instruction_delay_slot;
   m_current_instruction_pc = bu.current_instruction_pc;
   inst = bu.inst;
+  iinfo = bu.iinfo;
   m_block_ended = bu.block_ended;
   m_dirty_gte_done_cycle = bu.dirty_gte_done_cycle;
   m_dirty_instruction_bits = bu.dirty_instruction_bits;
@@ -1682,6 +1932,21 @@ void CPU::NewRec::Compiler::FlushForLoadStore(const std::optional<VirtualMemoryA
   Flush(FLUSH_FOR_C_CALL | FLUSH_FOR_LOADSTORE);
 }
 
+bool CPU::NewRec::Compiler::CanUseDirectScratchpadLoad(const std::optional<VirtualMemoryAddress>& address,
+                                                       MemoryAccessSize size)
+{
+  return (address.has_value() && (address.value() & SCRATCHPAD_ADDR_MASK) == SCRATCHPAD_ADDR &&
+          (address.value() & ((1u << static_cast<u32>(size)) - 1)) == 0);
+}
+
+bool CPU::NewRec::Compiler::CanUseDirectRAMLoad(const std::optional<VirtualMemoryAddress>& address,
+                                                MemoryAccessSize size)
+{
+  return (address.has_value() && CodeCache::AddressInRAM(address.value()) &&
+          (address.value() & ((1u << static_cast<u32>(size)) - 1)) == 0 && !SpecIsCacheIsolated() &&
+          !CodeCache::HasPreviouslyFaultedOnPC(m_current_instruction_pc));
+}
+
 void CPU::NewRec::Compiler::CompileMoveRegTemplate(Reg dst, Reg src, bool pgxp_move)
 {
   if (dst == src || dst == Reg::zero)
@@ -1706,12 +1971,17 @@ void CPU::NewRec::Compiler::CompileMoveRegTemplate(Reg dst, Reg src, bool pgxp_m
   // TODO: This could be made better if we only did it for registers where there was a previous MFC2.
   if (g_settings.gpu_pgxp_enable && pgxp_move)
   {
-    // might've been renamed, so use dst here
-    GeneratePGXPCallWithMIPSRegs(reinterpret_cast<const void*>(&PGXP::CPU_MOVE),
-                                 (static_cast<u32>(dst) << 8) | (static_cast<u32>(src)), dst);
+    GeneratePGXPMove(dst, src);
   }
 }
 
+void CPU::NewRec::Compiler::GeneratePGXPMove(Reg dst, Reg src)
+{
+  // might've been renamed, so use dst here
+  GeneratePGXPCallWithMIPSRegs(reinterpret_cast<const void*>(&PGXP::CPU_MOVE),
+                               (static_cast<u32>(dst) << 8) | (static_cast<u32>(src)), dst);
+}
+
 void CPU::NewRec::Compiler::Compile_j()
 {
   const u32 newpc = (m_compiler_pc & UINT32_C(0xF0000000)) | (inst->j.target << 2);
@@ -1780,8 +2050,12 @@ void CPU::NewRec::Compiler::Compile_b_const(CompileFlags cf)
   if (link)
     SetConstantReg(Reg::ra, GetBranchReturnAddress(cf));
 
+  const bool fallthrough_in_block = IsBranchFallthroughInBlock(cf);
   CompileBranchDelaySlot();
-  EndBlock(taken ? taken_pc : m_compiler_pc, true);
+  if (!taken && fallthrough_in_block)
+    ContinueAfterBranch(cf);
+  else
+    EndBlock(taken ? taken_pc : m_compiler_pc, true);
 }
 
 void CPU::NewRec::Compiler::Compile_b(CompileFlags cf)
@@ -1873,8 +2147,12 @@ void CPU::NewRec::Compiler::Compile_bxx_const(CompileFlags cf, BranchCondition c
   }
 
   const u32 taken_pc = GetConditionalBranchTarget(cf);
+  const bool fallthrough_in_block = IsBranchFallthroughInBlock(cf);
   CompileBranchDelaySlot();
-  EndBlock(taken ? taken_pc : m_compiler_pc, true);
+  if (!taken && fallthrough_in_block)
+    ContinueAfterBranch(cf);
+  else
+    EndBlock(taken ? taken_pc : m_compiler_pc, true);
 }
 
 void CPU::NewRec::Compiler::Compile_sll_const(CompileFlags cf)
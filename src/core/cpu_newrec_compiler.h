@@ -178,6 +178,8 @@ protected:
     LessEqualZero,
   };
 
+  static BranchCondition GetInvertedBranchCondition(BranchCondition cond);
+
   ALWAYS_INLINE bool HasConstantReg(Reg r) const { return m_constant_regs_valid.test(static_cast<u32>(r)); }
   ALWAYS_INLINE bool HasDirtyConstantReg(Reg r) const { return m_constant_regs_dirty.test(static_cast<u32>(r)); }
   ALWAYS_INLINE bool HasConstantRegValue(Reg r, u32 val) const
@@ -198,6 +200,24 @@ protected:
   u32 GetConditionalBranchTarget(CompileFlags cf) const;
   u32 GetBranchReturnAddress(CompileFlags cf) const;
   bool TrySwapDelaySlot(Reg rs = Reg::zero, Reg rt = Reg::zero, Reg rd = Reg::zero);
+
+  /// Returns true if the block continues after the delay slot of the current conditional branch, i.e. it is part of
+  /// a trace. The not-taken path should then be compiled last, followed by ContinueAfterBranch().
+  bool IsBranchFallthroughInBlock(CompileFlags cf) const;
+  void ContinueAfterBranch(CompileFlags cf);
+
+  /// Emits a call to skip to the next event if this is the back edge of an idle loop. Called by EndBlock().
+  void GenerateIdleLoopSkip(const std::optional<u32>& newpc, bool do_event_test);
+
+  /// Preloads the most frequently read guest registers into callee-saved host registers for blocks which link back
+  /// to themselves, so the back edge can jump past the loads instead of re-reading them from the CPU state.
+  void PreloadSelfLinkRegisters();
+  bool IsSelfLinkHostReg(u32 reg) const;
+
+  /// Flushes all registers at the end of the block. If this is the back edge of a self-linked block, the preloaded
+  /// registers are then restored, and GetSelfLinkTarget() returns the entry point after the preloads.
+  void FlushForEndBlock(const std::optional<u32>& newpc, bool do_event_test);
+  const void* GetSelfLinkTarget(const void* block_start);
   void SetCompilerPC(u32 newpc);
 
   virtual const void* GetCurrentCodePointer() = 0;
@@ -272,11 +292,22 @@ protected:
                                                        const std::optional<VirtualMemoryAddress>&),
                                 MemoryAccessSize size, bool store, bool sign, u32 tflags);
   void FlushForLoadStore(const std::optional<VirtualMemoryAddress>& address, bool store, bool use_fastmem);
+
+  /// Loads from the scratchpad at a known, aligned address can't fault, and read the same regardless of cache
+  /// isolation, so backends can read straight out of g_state instead of going through fastmem or a handler.
+  static bool CanUseDirectScratchpadLoad(const std::optional<VirtualMemoryAddress>& address, MemoryAccessSize size);
+
+  /// Same again for RAM, which backends read through the host mapping. Relies on the cache not being isolated, like
+  /// fastmem does, so PCs which have faulted before still go through the handlers.
+  bool CanUseDirectRAMLoad(const std::optional<VirtualMemoryAddress>& address, MemoryAccessSize size);
   void CompileMoveRegTemplate(Reg dst, Reg src, bool pgxp_move);
 
   virtual void GeneratePGXPCallWithMIPSRegs(const void* func, u32 arg1val, Reg arg2reg = Reg::count,
                                             Reg arg3reg = Reg::count) = 0;
 
+  /// Copies the PGXP state of src to dst after a register move. Backends can inline this instead of calling out.
+  virtual void GeneratePGXPMove(Reg dst, Reg src);
+
   virtual void Compile_Fallback() = 0;
 
   void Compile_j();
@@ -426,6 +457,13 @@ protected:
   Reg m_next_load_delay_register = Reg::count;
   u32 m_next_load_delay_value_register = 0;
 
+  static constexpr u32 MAX_SELF_LINK_REGS = 4;
+  const void* m_self_link_entry = nullptr;
+  std::array<Reg, MAX_SELF_LINK_REGS> m_self_link_guest_regs = {};
+  std::array<u8, MAX_SELF_LINK_REGS> m_self_link_host_regs = {};
+  u32 m_self_link_reg_count = 0;
+  bool m_self_link_ready = false;
+
   struct HostStateBackup
   {
     TickCount cycles;
@@ -366,7 +366,7 @@ void CPU::NewRec::AArch32Compiler::EndBlock(const std::optional<u32>& newpc, boo
   m_dirty_pc = false;
 
   // flush regs
-  Flush(FLUSH_END_BLOCK);
+  FlushForEndBlock(newpc, do_event_test);
   EndAndLinkBlock(newpc, do_event_test);
 }
 
@@ -430,7 +430,7 @@ void CPU::NewRec::AArch32Compiler::EndAndLinkBlock(const std::optional<u32>& new
     {
       // Special case: ourselves! No need to backlink then.
       Log_DebugPrintf("Linking block at %08X to self", m_block->pc);
-      armEmitJmp(armAsm, armAsm->GetBuffer()->GetStartAddress<const void*>(), true);
+      armEmitJmp(armAsm, GetSelfLinkTarget(armAsm->GetBuffer()->GetStartAddress<const void*>()), true);
     }
     else
     {
@@ -647,6 +647,14 @@ void CPU::NewRec::AArch32Compiler::Flush(u32 flags)
     // TODO: make it a function?
     armAsm->ldrb(RARG1, PTR(&g_state.load_delay_reg));
     armAsm->ldr(RARG2, PTR(&g_state.load_delay_value));
+    for (u32 i = 0; i < NUM_HOST_REGS; i++)
+    {
+      if (IsSelfLinkHostReg(i))
+      {
+        armAsm->cmp(RARG1, static_cast<u32>(m_host_regs[i].reg));
+        armAsm->mov(eq, Register(i), RARG2);
+      }
+    }
     EmitMov(RSCRATCH, offsetof(CPU::State, regs.r[0]));
     armAsm->add(RARG1, RSCRATCH, vixl::aarch32::Operand(RARG1, LSL, 2));
     armAsm->str(RARG2, MemOperand(RSTATE, RARG1));
@@ -782,14 +790,19 @@ void CPU::NewRec::AArch32Compiler::Compile_bxx(CompileFlags cf, BranchCondition
 
   Flush(FLUSH_FOR_BRANCH);
 
+  // If the block continues after this branch, the not-taken path has to be compiled last, so that it can fall
+  // through to the next instruction. Invert the condition, making the taken path the side exit instead.
+  const bool fallthrough_in_block = IsBranchFallthroughInBlock(cf);
+  const BranchCondition jump_cond = fallthrough_in_block ? GetInvertedBranchCondition(cond) : cond;
+
   DebugAssert(cf.valid_host_s);
 
   // MipsT() here should equal zero for zero branches.
   DebugAssert(cond == BranchCondition::Equal || cond == BranchCondition::NotEqual || cf.MipsT() == Reg::zero);
 
-  Label taken;
+  Label jump;
   const Register rs = CFGetRegS(cf);
-  switch (cond)
+  switch (jump_cond)
   {
     case BranchCondition::Equal:
     case BranchCondition::NotEqual:
@@ -800,35 +813,35 @@ void CPU::NewRec::AArch32Compiler::Compile_bxx(CompileFlags cf, BranchCondition
       else if (cf.const_t)
         armAsm->cmp(rs, armCheckCompareConstant(GetConstantRegU32(cf.MipsT())));
 
-      armAsm->b((cond == BranchCondition::Equal) ? eq : ne, &taken);
+      armAsm->b((jump_cond == BranchCondition::Equal) ? eq : ne, &jump);
     }
     break;
 
     case BranchCondition::GreaterThanZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(gt, &taken);
+      armAsm->b(gt, &jump);
     }
     break;
 
     case BranchCondition::GreaterEqualZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(ge, &taken);
+      armAsm->b(ge, &jump);
     }
     break;
 
     case BranchCondition::LessThanZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(lt, &taken);
+      armAsm->b(lt, &jump);
     }
     break;
 
     case BranchCondition::LessEqualZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(le, &taken);
+      armAsm->b(le, &jump);
     }
     break;
   }
@@ -837,15 +850,18 @@ void CPU::NewRec::AArch32Compiler::Compile_bxx(CompileFlags cf, BranchCondition
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(m_compiler_pc, true);
+  EndBlock(fallthrough_in_block ? taken_pc : m_compiler_pc, true);
 
-  armAsm->bind(&taken);
+  armAsm->bind(&jump);
 
   RestoreHostState();
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(taken_pc, true);
+  if (fallthrough_in_block)
+    ContinueAfterBranch(cf);
+  else
+    EndBlock(taken_pc, true);
 }
 
 void CPU::NewRec::AArch32Compiler::Compile_addi(CompileFlags cf, bool overflow)
@@ -283,6 +283,14 @@ void CPU::NewRec::AArch64Compiler::GenerateICacheCheckAndUpdate()
     const auto& current_tag_reg = RWARG2;
     const auto& existing_tag_reg = RWARG3;
 
+    // Nothing to check if no tags have changed since the last time this block ran, its lines are all still resident.
+    Label all_resident;
+    armMoveAddressToReg(armAsm, RXSCRATCH, &m_block->icache_generation);
+    armAsm->ldr(existing_tag_reg, PTR(&g_state.icache_generation));
+    armAsm->ldr(current_tag_reg, MemOperand(RXSCRATCH));
+    armAsm->cmp(existing_tag_reg, current_tag_reg);
+    armAsm->b(&all_resident, eq);
+
     VirtualMemoryAddress current_pc = m_block->pc & ICACHE_TAG_ADDRESS_MASK;
     armAsm->ldr(ticks_reg, PTR(&g_state.pending_ticks));
     armEmitMov(armAsm, current_tag_reg, current_pc);
@@ -303,6 +311,9 @@ void CPU::NewRec::AArch64Compiler::GenerateICacheCheckAndUpdate()
 
       armAsm->str(current_tag_reg, MemOperand(RSTATE, offset));
       armAsm->add(ticks_reg, ticks_reg, armCheckAddSubConstant(static_cast<u32>(fill_ticks)));
+      armAsm->ldr(existing_tag_reg, PTR(&g_state.icache_generation));
+      armAsm->add(existing_tag_reg, existing_tag_reg, 1);
+      armAsm->str(existing_tag_reg, PTR(&g_state.icache_generation));
       armAsm->bind(&cache_hit);
 
       if (i != (m_block->icache_line_count - 1))
@@ -310,6 +321,11 @@ void CPU::NewRec::AArch64Compiler::GenerateICacheCheckAndUpdate()
     }
 
     armAsm->str(ticks_reg, PTR(&g_state.pending_ticks));
+
+    armAsm->ldr(existing_tag_reg, PTR(&g_state.icache_generation));
+    armMoveAddressToReg(armAsm, RXSCRATCH, &m_block->icache_generation);
+    armAsm->str(existing_tag_reg, MemOperand(RXSCRATCH));
+    armAsm->bind(&all_resident);
   }
 }
 
@@ -338,7 +354,7 @@ void CPU::NewRec::AArch64Compiler::EndBlock(const std::optional<u32>& newpc, boo
   m_dirty_pc = false;
 
   // flush regs
-  Flush(FLUSH_END_BLOCK);
+  FlushForEndBlock(newpc, do_event_test);
   EndAndLinkBlock(newpc, do_event_test);
 }
 
@@ -402,7 +418,7 @@ void CPU::NewRec::AArch64Compiler::EndAndLinkBlock(const std::optional<u32>& new
     {
       // Special case: ourselves! No need to backlink then.
       Log_DebugPrintf("Linking block at %08X to self", m_block->pc);
-      armEmitJmp(armAsm, armAsm->GetBuffer()->GetStartAddress<const void*>(), true);
+      armEmitJmp(armAsm, GetSelfLinkTarget(armAsm->GetBuffer()->GetStartAddress<const void*>()), true);
     }
     else
     {
@@ -590,6 +606,27 @@ void CPU::NewRec::AArch64Compiler::GeneratePGXPCallWithMIPSRegs(const void* func
   EmitCall(func);
 }
 
+void CPU::NewRec::AArch64Compiler::GeneratePGXPMove(Reg dst, Reg src)
+{
+  // Same as PGXP::CPU_MOVE(), but only touches the argument/scratch registers, so nothing needs to be flushed.
+  Label validated;
+  armMoveAddressToReg(armAsm, RXARG1, PGXP::GetCPURegisterState(static_cast<u32>(src)));
+  MoveMIPSRegToReg(RWARG2, dst);
+  armAsm->ldr(RWARG3, MemOperand(RXARG1, PGXP::CPU_REG_STATE_VALUE_OFFSET));
+  armAsm->cmp(RWARG2, RWARG3);
+  armAsm->b(&validated, eq);
+  armAsm->ldr(RWARG3, MemOperand(RXARG1, PGXP::CPU_REG_STATE_FLAGS_OFFSET));
+  armAsm->and_(RWARG3, RWARG3, PGXP::CPU_REG_STATE_INVALIDATE_MASK);
+  armAsm->str(RWARG3, MemOperand(RXARG1, PGXP::CPU_REG_STATE_FLAGS_OFFSET));
+  armAsm->bind(&validated);
+
+  armMoveAddressToReg(armAsm, RXARG2, PGXP::GetCPURegisterState(static_cast<u32>(dst)));
+  armAsm->ldp(RXARG3, RXSCRATCH, MemOperand(RXARG1));
+  armAsm->stp(RXARG3, RXSCRATCH, MemOperand(RXARG2));
+  armAsm->ldr(RWARG3, MemOperand(RXARG1, 16));
+  armAsm->str(RWARG3, MemOperand(RXARG2, 16));
+}
+
 void CPU::NewRec::AArch64Compiler::Flush(u32 flags)
 {
   Compiler::Flush(flags);
@@ -617,6 +654,14 @@ void CPU::NewRec::AArch64Compiler::Flush(u32 flags)
     // TODO: make it a function?
     armAsm->ldrb(RWARG1, PTR(&g_state.load_delay_reg));
     armAsm->ldr(RWARG2, PTR(&g_state.load_delay_value));
+    for (u32 i = 0; i < NUM_HOST_REGS; i++)
+    {
+      if (IsSelfLinkHostReg(i))
+      {
+        armAsm->cmp(RWARG1, static_cast<u32>(m_host_regs[i].reg));
+        armAsm->csel(WRegister(i), RWARG2, WRegister(i), eq);
+      }
+    }
     EmitMov(RWSCRATCH, offsetof(CPU::State, regs.r[0]));
     armAsm->add(RWARG1, RWSCRATCH, vixl::aarch64::Operand(RWARG1, LSL, 2));
     armAsm->str(RWARG2, MemOperand(RSTATE, RXARG1));
@@ -752,14 +797,19 @@ void CPU::NewRec::AArch64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
 
   Flush(FLUSH_FOR_BRANCH);
 
+  // If the block continues after this branch, the not-taken path has to be compiled last, so that it can fall
+  // through to the next instruction. Invert the condition, making the taken path the side exit instead.
+  const bool fallthrough_in_block = IsBranchFallthroughInBlock(cf);
+  const BranchCondition jump_cond = fallthrough_in_block ? GetInvertedBranchCondition(cond) : cond;
+
   DebugAssert(cf.valid_host_s);
 
   // MipsT() here should equal zero for zero branches.
   DebugAssert(cond == BranchCondition::Equal || cond == BranchCondition::NotEqual || cf.MipsT() == Reg::zero);
 
-  Label taken;
+  Label jump;
   const WRegister rs = CFGetRegS(cf);
-  switch (cond)
+  switch (jump_cond)
   {
     case BranchCondition::Equal:
     case BranchCondition::NotEqual:
@@ -767,7 +817,7 @@ void CPU::NewRec::AArch64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
       AssertRegOrConstT(cf);
       if (cf.const_t && HasConstantRegValue(cf.MipsT(), 0))
       {
-        (cond == BranchCondition::Equal) ? armAsm->cbz(rs, &taken) : armAsm->cbnz(rs, &taken);
+        (jump_cond == BranchCondition::Equal) ? armAsm->cbz(rs, &jump) : armAsm->cbnz(rs, &jump);
       }
       else
       {
@@ -776,7 +826,7 @@ void CPU::NewRec::AArch64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
         else if (cf.const_t)
           armAsm->cmp(rs, armCheckCompareConstant(GetConstantRegU32(cf.MipsT())));
 
-        armAsm->b(&taken, (cond == BranchCondition::Equal) ? eq : ne);
+        armAsm->b(&jump, (jump_cond == BranchCondition::Equal) ? eq : ne);
       }
     }
     break;
@@ -784,28 +834,28 @@ void CPU::NewRec::AArch64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
     case BranchCondition::GreaterThanZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(&taken, gt);
+      armAsm->b(&jump, gt);
     }
     break;
 
     case BranchCondition::GreaterEqualZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(&taken, ge);
+      armAsm->b(&jump, ge);
     }
     break;
 
     case BranchCondition::LessThanZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(&taken, lt);
+      armAsm->b(&jump, lt);
     }
     break;
 
     case BranchCondition::LessEqualZero:
     {
       armAsm->cmp(rs, 0);
-      armAsm->b(&taken, le);
+      armAsm->b(&jump, le);
     }
     break;
   }
@@ -814,15 +864,18 @@ void CPU::NewRec::AArch64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(m_compiler_pc, true);
+  EndBlock(fallthrough_in_block ? taken_pc : m_compiler_pc, true);
 
-  armAsm->bind(&taken);
+  armAsm->bind(&jump);
 
   RestoreHostState();
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(taken_pc, true);
+  if (fallthrough_in_block)
+    ContinueAfterBranch(cf);
+  else
+    EndBlock(taken_pc, true);
 }
 
 void CPU::NewRec::AArch64Compiler::Compile_addi(CompileFlags cf, bool overflow)
@@ -1521,18 +1574,62 @@ void CPU::NewRec::AArch64Compiler::Compile_lxx(CompileFlags cf, MemoryAccessSize
   const std::optional<WRegister> addr_reg =
     g_settings.gpu_pgxp_enable ? std::optional<WRegister>(WRegister(AllocateTempHostReg(HR_CALLEE_SAVED))) :
                                  std::optional<WRegister>();
-  FlushForLoadStore(address, false, use_fastmem);
+  const bool direct_scratchpad = CanUseDirectScratchpadLoad(address, size);
+  const bool direct_ram = !direct_scratchpad && CanUseDirectRAMLoad(address, size);
+  FlushForLoadStore(address, false, use_fastmem || direct_scratchpad || direct_ram);
   const WRegister addr = ComputeLoadStoreAddressArg(cf, address, addr_reg);
-  const WRegister data = GenerateLoad(addr, size, sign, use_fastmem, [this, cf]() {
+  const auto dst_reg_alloc = [this, cf]() {
     if (cf.MipsT() == Reg::zero)
       return RWRET;
 
     return WRegister(AllocateHostReg(GetFlagsForNewLoadDelayedReg(),
                                      EMULATE_LOAD_DELAYS ? HR_TYPE_NEXT_LOAD_DELAY_VALUE : HR_TYPE_CPU_REG,
                                      cf.MipsT()));
-  });
+  };
 
-  if (g_settings.gpu_pgxp_enable)
+  WRegister data;
+  if (direct_scratchpad || direct_ram)
+  {
+    data = dst_reg_alloc();
+
+    // scratchpad is too far into the state struct for the immediate offset forms, and RAM isn't in it at all
+    if (direct_ram)
+    {
+      m_cycles += Bus::RAM_READ_TICKS;
+      armMoveAddressToReg(armAsm, RXSCRATCH, &Bus::g_ram[VirtualAddressToPhysical(address.value())]);
+    }
+    else
+    {
+      armMoveAddressToReg(armAsm, RXSCRATCH, &g_state.scratchpad[address.value() & SCRATCHPAD_OFFSET_MASK]);
+    }
+    const MemOperand mem = MemOperand(RXSCRATCH);
+    switch (size)
+    {
+      case MemoryAccessSize::Byte:
+        sign ? armAsm->ldrsb(data, mem) : armAsm->ldrb(data, mem);
+        break;
+      case MemoryAccessSize::HalfWord:
+        sign ? armAsm->ldrsh(data, mem) : armAsm->ldrh(data, mem);
+        break;
+      case MemoryAccessSize::Word:
+        armAsm->ldr(data, mem);
+        break;
+    }
+  }
+  else
+  {
+    data = GenerateLoad(addr, size, sign, use_fastmem, dst_reg_alloc);
+  }
+
+  if (g_settings.gpu_pgxp_enable && size == MemoryAccessSize::Byte)
+  {
+    // Byte loads just invalidate the register, no need for a call (PGXP::CPU_LBx).
+    armMoveAddressToReg(armAsm, RXARG1, PGXP::GetCPURegisterState(static_cast<u32>(inst->i.rt.GetValue())));
+    armAsm->stp(xzr, xzr, MemOperand(RXARG1));
+    armAsm->str(wzr, MemOperand(RXARG1, 16));
+    FreeHostReg(addr_reg.value().GetCode());
+  }
+  else if (g_settings.gpu_pgxp_enable)
   {
     Flush(FLUSH_FOR_C_CALL);
 
@@ -2070,13 +2167,100 @@ void CPU::NewRec::AArch64Compiler::Compile_cop2(CompileFlags cf)
   TickCount func_ticks;
   GTE::InstructionImpl func = GTE::GetInstructionImpl(inst->bits, &func_ticks);
 
-  Flush(FLUSH_FOR_C_CALL);
-  EmitMov(RWARG1, inst->bits & GTE::Instruction::REQUIRED_BITS_MASK);
-  EmitCall(reinterpret_cast<const void*>(func));
+  // simple commands which only touch GTE registers are generated inline, everything else goes through the handler
+  const GTE::Instruction ginst{inst->bits & GTE::Instruction::REQUIRED_BITS_MASK};
+  if (ginst.command == 0x06 && !(g_settings.gpu_pgxp_enable && g_settings.gpu_pgxp_culling))
+  {
+    Compile_gte_nclip();
+  }
+  else if (ginst.command == 0x2D || ginst.command == 0x2E)
+  {
+    Compile_gte_avsz(ginst.command == 0x2E);
+  }
+  else
+  {
+    Flush(FLUSH_FOR_C_CALL);
+    EmitMov(RWARG1, ginst.bits);
+    EmitCall(reinterpret_cast<const void*>(func));
+  }
 
   AddGTETicks(func_ticks);
 }
 
+void CPU::NewRec::AArch64Compiler::Compile_gte_nclip()
+{
+  // MAC0 = SX0*SY1 + SX1*SY2 + SX2*SY0 - SX0*SY2 - SX1*SY0 - SX2*SY1
+  const auto load_pair = [this](const s16* sx, const s16* sy) {
+    armAsm->ldrsh(RWARG2, PTR(sx));
+    armAsm->ldrsh(RWARG3, PTR(sy));
+  };
+
+  GTE::Regs& gr = g_state.gte_regs;
+  load_pair(&gr.SXY0[0], &gr.SXY1[1]);
+  armAsm->smull(RXARG1, RWARG2, RWARG3);
+  load_pair(&gr.SXY1[0], &gr.SXY2[1]);
+  armAsm->smaddl(RXARG1, RWARG2, RWARG3, RXARG1);
+  load_pair(&gr.SXY2[0], &gr.SXY0[1]);
+  armAsm->smaddl(RXARG1, RWARG2, RWARG3, RXARG1);
+  load_pair(&gr.SXY0[0], &gr.SXY2[1]);
+  armAsm->smsubl(RXARG1, RWARG2, RWARG3, RXARG1);
+  load_pair(&gr.SXY1[0], &gr.SXY0[1]);
+  armAsm->smsubl(RXARG1, RWARG2, RWARG3, RXARG1);
+  load_pair(&gr.SXY2[0], &gr.SXY1[1]);
+  armAsm->smsubl(RXARG1, RWARG2, RWARG3, RXARG1);
+
+  GenerateGTEMAC0Result(false);
+}
+
+void CPU::NewRec::AArch64Compiler::Compile_gte_avsz(bool avsz4)
+{
+  // MAC0 = ZSF3*(SZ1+SZ2+SZ3) or ZSF4*(SZ0+SZ1+SZ2+SZ3), OTZ = MAC0/1000h
+  armAsm->ldrh(RWARG1, PTR(&g_state.gte_regs.SZ1));
+  armAsm->ldrh(RWARG2, PTR(&g_state.gte_regs.SZ2));
+  armAsm->add(RWARG1, RWARG1, RWARG2);
+  armAsm->ldrh(RWARG2, PTR(&g_state.gte_regs.SZ3));
+  armAsm->add(RWARG1, RWARG1, RWARG2);
+  if (avsz4)
+  {
+    armAsm->ldrh(RWARG2, PTR(&g_state.gte_regs.SZ0));
+    armAsm->add(RWARG1, RWARG1, RWARG2);
+  }
+
+  armAsm->ldrsh(RWARG2, avsz4 ? PTR(&g_state.gte_regs.ZSF4) : PTR(&g_state.gte_regs.ZSF3));
+  armAsm->smull(RXARG1, RWARG1, RWARG2);
+
+  GenerateGTEMAC0Result(true);
+}
+
+void CPU::NewRec::AArch64Compiler::GenerateGTEMAC0Result(bool set_otz)
+{
+  // 64-bit result is in RXARG1, the flags are rebuilt from scratch since these commands clear FLAG
+  armAsm->str(RWARG1, PTR(&g_state.gte_regs.MAC0));
+  EmitMov(RWARG2, GTE::FLAGS::MAC0_OVERFLOW_BITS);
+  EmitMov(RWARG3, GTE::FLAGS::MAC0_UNDERFLOW_BITS);
+  armAsm->cmp(RXARG1, 0);
+  armAsm->csel(RWARG2, RWARG3, RWARG2, lt);
+  armAsm->cmp(RXARG1, Operand(RWARG1, SXTW));
+  armAsm->csel(RWARG2, RWARG2, wzr, ne);
+
+  if (set_otz)
+  {
+    // OTZ = clamp(MAC0 SAR 12, 0, FFFFh)
+    armAsm->asr(RXARG1, RXARG1, 12);
+    EmitMov(RWARG3, GTE::FLAGS::OTZ_SATURATED_BITS);
+    armAsm->orr(RWARG3, RWARG2, RWARG3);
+    EmitMov(RWSCRATCH, 0xFFFF);
+    armAsm->cmp(RXARG1, RXSCRATCH);
+    armAsm->csel(RWARG2, RWARG3, RWARG2, hi);
+    armAsm->csel(RXARG1, RXSCRATCH, RXARG1, gt);
+    armAsm->cmp(RXARG1, 0);
+    armAsm->csel(RWARG1, wzr, RWARG1, lt);
+    armAsm->str(RWARG1, PTR(&g_state.gte_regs.dr32[7]));
+  }
+
+  armAsm->str(RWARG2, PTR(&g_state.gte_regs.FLAG.bits));
+}
+
 u32 CPU::NewRec::CompileLoadStoreThunk(void* thunk_code, u32 thunk_space, void* code_address, u32 code_size,
                                        TickCount cycles_to_add, TickCount cycles_to_remove, u32 gpr_bitmask,
                                        u8 address_register, u8 data_register, MemoryAccessSize size, bool is_signed,
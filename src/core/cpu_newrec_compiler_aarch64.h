@@ -121,9 +121,13 @@ protected:
   void Compile_mfc2(CompileFlags cf) override;
   void Compile_mtc2(CompileFlags cf) override;
   void Compile_cop2(CompileFlags cf) override;
+  void Compile_gte_nclip();
+  void Compile_gte_avsz(bool avsz4);
+  void GenerateGTEMAC0Result(bool set_otz);
 
   void GeneratePGXPCallWithMIPSRegs(const void* func, u32 arg1val, Reg arg2reg = Reg::count,
                                     Reg arg3reg = Reg::count) override;
+  void GeneratePGXPMove(Reg dst, Reg src) override;
 
 private:
   void EmitMov(const vixl::aarch64::WRegister& dst, u32 val);
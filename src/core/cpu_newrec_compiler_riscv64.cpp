@@ -220,10 +220,7 @@ u32 CPU::CodeCache::EmitASMFunctions(void* code, u32 code_size)
       rvAsm->LD(RMEMBASE, PTR(&g_state.fastmem_base));
 
     // Downcount isn't set on entry, so we need to initialize it
-    rvMoveAddressToReg(rvAsm, RARG1, TimingEvents::GetHeadEventPtr());
-    rvAsm->LD(RARG1, 0, RARG1);
-    rvAsm->LW(RARG1, offsetof(TimingEvent, m_downcount), RARG1);
-    rvAsm->SW(RARG1, PTR(&g_state.downcount));
+    rvEmitCall(rvAsm, reinterpret_cast<const void*>(&TimingEvents::UpdateCPUDowncount));
 
     // Fall through to event dispatcher
   }
@@ -585,7 +582,7 @@ void CPU::NewRec::RISCV64Compiler::EndBlock(const std::optional<u32>& newpc, boo
   m_dirty_pc = false;
 
   // flush regs
-  Flush(FLUSH_END_BLOCK);
+  FlushForEndBlock(newpc, do_event_test);
   EndAndLinkBlock(newpc, do_event_test);
 }
 
@@ -656,7 +653,7 @@ void CPU::NewRec::RISCV64Compiler::EndAndLinkBlock(const std::optional<u32>& new
     {
       // Special case: ourselves! No need to backlink then.
       Log_DebugPrintf("Linking block at %08X to self", m_block->pc);
-      rvEmitJmp(rvAsm, rvAsm->GetBufferPointer(0));
+      rvEmitJmp(rvAsm, GetSelfLinkTarget(rvAsm->GetBufferPointer(0)));
     }
     else
     {
@@ -890,6 +887,17 @@ void CPU::NewRec::RISCV64Compiler::Flush(u32 flags)
     // TODO: make it a function?
     rvAsm->LBU(RARG1, PTR(&g_state.load_delay_reg));
     rvAsm->LW(RARG2, PTR(&g_state.load_delay_value));
+    for (u32 i = 0; i < NUM_HOST_REGS; i++)
+    {
+      if (IsSelfLinkHostReg(i))
+      {
+        Label skip;
+        rvAsm->LI(RSCRATCH, static_cast<u32>(m_host_regs[i].reg));
+        rvAsm->BNE(RARG1, RSCRATCH, &skip);
+        rvAsm->MV(GPR(i), RARG2);
+        rvAsm->Bind(&skip);
+      }
+    }
     rvAsm->SLLI(RARG1, RARG1, 2); // *4
     rvAsm->ADD(RARG1, RARG1, RSTATE);
     rvAsm->SW(RARG2, offsetof(CPU::State, regs.r[0]), RARG1);
@@ -1031,14 +1039,19 @@ void CPU::NewRec::RISCV64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
 
   Flush(FLUSH_FOR_BRANCH);
 
+  // If the block continues after this branch, the not-taken path has to be compiled last, so that it can fall
+  // through to the next instruction. Invert the condition, making the taken path the side exit instead.
+  const bool fallthrough_in_block = IsBranchFallthroughInBlock(cf);
+  const BranchCondition jump_cond = fallthrough_in_block ? GetInvertedBranchCondition(cond) : cond;
+
   DebugAssert(cf.valid_host_s);
 
   // MipsT() here should equal zero for zero branches.
   DebugAssert(cond == BranchCondition::Equal || cond == BranchCondition::NotEqual || cf.MipsT() == Reg::zero);
 
-  Label taken;
+  Label jump;
   const GPR rs = CFGetRegS(cf);
-  switch (cond)
+  switch (jump_cond)
   {
     case BranchCondition::Equal:
     case BranchCondition::NotEqual:
@@ -1046,42 +1059,42 @@ void CPU::NewRec::RISCV64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
       AssertRegOrConstT(cf);
       if (cf.const_t && HasConstantRegValue(cf.MipsT(), 0))
       {
-        (cond == BranchCondition::Equal) ? rvAsm->BEQZ(rs, &taken) : rvAsm->BNEZ(rs, &taken);
+        (jump_cond == BranchCondition::Equal) ? rvAsm->BEQZ(rs, &jump) : rvAsm->BNEZ(rs, &jump);
       }
       else
       {
         const GPR rt = cf.valid_host_t ? CFGetRegT(cf) : RARG1;
         if (!cf.valid_host_t)
           MoveTToReg(RARG1, cf);
-        if (cond == Compiler::BranchCondition::Equal)
-          rvAsm->BEQ(rs, rt, &taken);
+        if (jump_cond == Compiler::BranchCondition::Equal)
+          rvAsm->BEQ(rs, rt, &jump);
         else
-          rvAsm->BNE(rs, rt, &taken);
+          rvAsm->BNE(rs, rt, &jump);
       }
     }
     break;
 
     case BranchCondition::GreaterThanZero:
     {
-      rvAsm->BGTZ(rs, &taken);
+      rvAsm->BGTZ(rs, &jump);
     }
     break;
 
     case BranchCondition::GreaterEqualZero:
     {
-      rvAsm->BGEZ(rs, &taken);
+      rvAsm->BGEZ(rs, &jump);
     }
     break;
 
     case BranchCondition::LessThanZero:
     {
-      rvAsm->BLTZ(rs, &taken);
+      rvAsm->BLTZ(rs, &jump);
     }
     break;
 
     case BranchCondition::LessEqualZero:
     {
-      rvAsm->BLEZ(rs, &taken);
+      rvAsm->BLEZ(rs, &jump);
     }
     break;
   }
@@ -1090,15 +1103,18 @@ void CPU::NewRec::RISCV64Compiler::Compile_bxx(CompileFlags cf, BranchCondition
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(m_compiler_pc, true);
+  EndBlock(fallthrough_in_block ? taken_pc : m_compiler_pc, true);
 
-  rvAsm->Bind(&taken);
+  rvAsm->Bind(&jump);
 
   RestoreHostState();
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(taken_pc, true);
+  if (fallthrough_in_block)
+    ContinueAfterBranch(cf);
+  else
+    EndBlock(taken_pc, true);
 }
 
 void CPU::NewRec::RISCV64Compiler::Compile_addi(CompileFlags cf, bool overflow)
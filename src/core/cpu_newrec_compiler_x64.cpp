@@ -175,6 +175,13 @@ void CPU::NewRec::X64Compiler::GenerateICacheCheckAndUpdate()
   }
   else if (m_block->icache_line_count > 0)
   {
+    // Nothing to check if no tags have changed since the last time this block ran, its lines are all still resident.
+    Xbyak::Label all_resident;
+    cg->mov(RXARG2, static_cast<size_t>(reinterpret_cast<uintptr_t>(&m_block->icache_generation)));
+    cg->mov(RWARG3, cg->dword[PTR(&g_state.icache_generation)]);
+    cg->cmp(RWARG3, cg->dword[RXARG2]);
+    cg->je(all_resident, CodeGenerator::T_NEAR);
+
     cg->lea(RXARG1, cg->dword[PTR(&g_state.icache_tags)]);
 
     // TODO: Vectorize this...
@@ -194,8 +201,13 @@ void CPU::NewRec::X64Compiler::GenerateICacheCheckAndUpdate()
       cg->je(cache_hit);
       cg->mov(cg->dword[RXARG1 + offset], tag);
       cg->add(cg->dword[PTR(&g_state.pending_ticks)], static_cast<u32>(fill_ticks));
+      cg->inc(cg->dword[PTR(&g_state.icache_generation)]);
       cg->L(cache_hit);
     }
+
+    cg->mov(RWARG3, cg->dword[PTR(&g_state.icache_generation)]);
+    cg->mov(cg->dword[RXARG2], RWARG3);
+    cg->L(all_resident);
   }
 }
 
@@ -221,7 +233,7 @@ void CPU::NewRec::X64Compiler::EndBlock(const std::optional<u32>& newpc, bool do
   m_dirty_pc = false;
 
   // flush regs
-  Flush(FLUSH_END_BLOCK);
+  FlushForEndBlock(newpc, do_event_test);
   EndAndLinkBlock(newpc, do_event_test);
 }
 
@@ -295,7 +307,7 @@ void CPU::NewRec::X64Compiler::EndAndLinkBlock(const std::optional<u32>& newpc,
     {
       // Special case: ourselves! No need to backlink then.
       Log_DebugPrintf("Linking block at %08X to self", m_block->pc);
-      cg->jmp(cg->getCode());
+      cg->jmp(GetSelfLinkTarget(cg->getCode()));
     }
     else
     {
@@ -509,6 +521,29 @@ void CPU::NewRec::X64Compiler::GeneratePGXPCallWithMIPSRegs(const void* func, u3
   cg->call(func);
 }
 
+void CPU::NewRec::X64Compiler::GeneratePGXPMove(Reg dst, Reg src)
+{
+  // Same as PGXP::CPU_MOVE(), but only touches the argument registers, so nothing needs to be flushed.
+  const u8* src_state = PGXP::GetCPURegisterState(static_cast<u32>(src));
+  const u8* dst_state = PGXP::GetCPURegisterState(static_cast<u32>(dst));
+
+  Xbyak::Label validated;
+  cg->mov(RXARG1, static_cast<size_t>(reinterpret_cast<uintptr_t>(src_state)));
+  MoveMIPSRegToReg(RWARG2, dst);
+  cg->cmp(RWARG2, cg->dword[RXARG1 + PGXP::CPU_REG_STATE_VALUE_OFFSET]);
+  cg->je(validated);
+  cg->and_(cg->dword[RXARG1 + PGXP::CPU_REG_STATE_FLAGS_OFFSET], PGXP::CPU_REG_STATE_INVALIDATE_MASK);
+  cg->L(validated);
+
+  cg->mov(RXARG2, static_cast<size_t>(reinterpret_cast<uintptr_t>(dst_state)));
+  cg->mov(RXARG3, cg->qword[RXARG1]);
+  cg->mov(cg->qword[RXARG2], RXARG3);
+  cg->mov(RXARG3, cg->qword[RXARG1 + 8]);
+  cg->mov(cg->qword[RXARG2 + 8], RXARG3);
+  cg->mov(RWARG3, cg->dword[RXARG1 + 16]);
+  cg->mov(cg->dword[RXARG2 + 16], RWARG3);
+}
+
 void CPU::NewRec::X64Compiler::Flush(u32 flags)
 {
   Compiler::Flush(flags);
@@ -533,6 +568,14 @@ void CPU::NewRec::X64Compiler::Flush(u32 flags)
     cg->movzx(RWARG1, cg->byte[PTR(&g_state.load_delay_reg)]);
     cg->mov(RWARG2, cg->dword[PTR(&g_state.load_delay_value)]);
     cg->mov(cg->dword[PTR(&g_state.regs.r[0]) + RXARG1 * 4], RWARG2);
+    for (u32 i = 0; i < NUM_HOST_REGS; i++)
+    {
+      if (IsSelfLinkHostReg(i))
+      {
+        cg->cmp(RWARG1, static_cast<u32>(m_host_regs[i].reg));
+        cg->cmove(Reg32(i), RWARG2);
+      }
+    }
     cg->mov(cg->byte[PTR(&g_state.load_delay_reg)], static_cast<u8>(Reg::count));
     m_load_delay_dirty = false;
   }
@@ -666,6 +709,11 @@ void CPU::NewRec::X64Compiler::Compile_bxx(CompileFlags cf, BranchCondition cond
 
   Flush(FLUSH_FOR_BRANCH);
 
+  // If the block continues after this branch, the not-taken path has to be compiled last, so that it can fall
+  // through to the next instruction. Invert the condition, making the taken path the side exit instead.
+  const bool fallthrough_in_block = IsBranchFallthroughInBlock(cf);
+  const BranchCondition jump_cond = fallthrough_in_block ? GetInvertedBranchCondition(cond) : cond;
+
   DebugAssert(cf.valid_host_s);
 
   // MipsT() here should equal zero for zero branches.
@@ -673,8 +721,8 @@ void CPU::NewRec::X64Compiler::Compile_bxx(CompileFlags cf, BranchCondition cond
 
   // TODO: Swap this back to near once instructions don't blow up
   constexpr CodeGenerator::LabelType type = CodeGenerator::T_NEAR;
-  Label taken;
-  switch (cond)
+  Label jump;
+  switch (jump_cond)
   {
     case BranchCondition::Equal:
     case BranchCondition::NotEqual:
@@ -688,35 +736,35 @@ void CPU::NewRec::X64Compiler::Compile_bxx(CompileFlags cf, BranchCondition cond
       else
         cg->cmp(CFGetRegS(cf), MipsPtr(cf.MipsT()));
 
-      (cond == BranchCondition::Equal) ? cg->je(taken, type) : cg->jne(taken, type);
+      (jump_cond == BranchCondition::Equal) ? cg->je(jump, type) : cg->jne(jump, type);
     }
     break;
 
     case BranchCondition::GreaterThanZero:
     {
       cg->cmp(CFGetRegS(cf), 0);
-      cg->jg(taken, type);
+      cg->jg(jump, type);
     }
     break;
 
     case BranchCondition::GreaterEqualZero:
     {
       cg->test(CFGetRegS(cf), CFGetRegS(cf));
-      cg->jns(taken, type);
+      cg->jns(jump, type);
     }
     break;
 
     case BranchCondition::LessThanZero:
     {
       cg->test(CFGetRegS(cf), CFGetRegS(cf));
-      cg->js(taken, type);
+      cg->js(jump, type);
     }
     break;
 
     case BranchCondition::LessEqualZero:
     {
       cg->cmp(CFGetRegS(cf), 0);
-      cg->jle(taken, type);
+      cg->jle(jump, type);
     }
     break;
   }
@@ -725,15 +773,18 @@ void CPU::NewRec::X64Compiler::Compile_bxx(CompileFlags cf, BranchCondition cond
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(m_compiler_pc, true);
+  EndBlock(fallthrough_in_block ? taken_pc : m_compiler_pc, true);
 
-  cg->L(taken);
+  cg->L(jump);
 
   RestoreHostState();
   if (!cf.delay_slot_swapped)
     CompileBranchDelaySlot();
 
-  EndBlock(taken_pc, true);
+  if (fallthrough_in_block)
+    ContinueAfterBranch(cf);
+  else
+    EndBlock(taken_pc, true);
 }
 
 void CPU::NewRec::X64Compiler::Compile_addi(CompileFlags cf)
@@ -1472,18 +1523,67 @@ void CPU::NewRec::X64Compiler::Compile_lxx(CompileFlags cf, MemoryAccessSize siz
   const std::optional<Reg32> addr_reg = g_settings.gpu_pgxp_enable ?
                                           std::optional<Reg32>(Reg32(AllocateTempHostReg(HR_CALLEE_SAVED))) :
                                           std::optional<Reg32>();
-  FlushForLoadStore(address, false, use_fastmem);
+  const bool direct_scratchpad = CanUseDirectScratchpadLoad(address, size);
+  const bool direct_ram = !direct_scratchpad && CanUseDirectRAMLoad(address, size);
+  FlushForLoadStore(address, false, use_fastmem || direct_scratchpad || direct_ram);
   const Reg32 addr = ComputeLoadStoreAddressArg(cf, address, addr_reg);
 
-  const Reg32 data = GenerateLoad(addr, size, sign, use_fastmem, [this, cf]() {
+  const auto dst_reg_alloc = [this, cf]() {
     if (cf.MipsT() == Reg::zero)
       return RWRET;
 
     return Reg32(AllocateHostReg(GetFlagsForNewLoadDelayedReg(),
                                  EMULATE_LOAD_DELAYS ? HR_TYPE_NEXT_LOAD_DELAY_VALUE : HR_TYPE_CPU_REG, cf.MipsT()));
-  });
+  };
 
-  if (g_settings.gpu_pgxp_enable)
+  Reg32 data;
+  if (direct_scratchpad || direct_ram)
+  {
+    data = dst_reg_alloc();
+
+    // RAM is mapped too far away from the state struct for a displacement
+    Xbyak::RegExp ptr;
+    if (direct_ram)
+    {
+      m_cycles += Bus::RAM_READ_TICKS;
+      cg->mov(RXARG3, static_cast<size_t>(
+                        reinterpret_cast<uintptr_t>(&Bus::g_ram[VirtualAddressToPhysical(address.value())])));
+      ptr = RXARG3;
+    }
+    else
+    {
+      ptr = PTR(&g_state.scratchpad[address.value() & SCRATCHPAD_OFFSET_MASK]);
+    }
+
+    switch (size)
+    {
+      case MemoryAccessSize::Byte:
+        sign ? cg->movsx(data, cg->byte[ptr]) : cg->movzx(data, cg->byte[ptr]);
+        break;
+      case MemoryAccessSize::HalfWord:
+        sign ? cg->movsx(data, cg->word[ptr]) : cg->movzx(data, cg->word[ptr]);
+        break;
+      case MemoryAccessSize::Word:
+        cg->mov(data, cg->dword[ptr]);
+        break;
+    }
+  }
+  else
+  {
+    data = GenerateLoad(addr, size, sign, use_fastmem, dst_reg_alloc);
+  }
+
+  if (g_settings.gpu_pgxp_enable && size == MemoryAccessSize::Byte)
+  {
+    // Byte loads just invalidate the register, no need for a call (PGXP::CPU_LBx).
+    const u8* rt_state = PGXP::GetCPURegisterState(static_cast<u32>(inst->i.rt.GetValue()));
+    cg->mov(RXARG1, static_cast<size_t>(reinterpret_cast<uintptr_t>(rt_state)));
+    cg->mov(cg->qword[RXARG1], 0);
+    cg->mov(cg->qword[RXARG1 + 8], 0);
+    cg->mov(cg->dword[RXARG1 + 16], 0);
+    FreeHostReg(addr_reg.value().getIdx());
+  }
+  else if (g_settings.gpu_pgxp_enable)
   {
     Flush(FLUSH_FOR_C_CALL);
 
@@ -2058,13 +2158,104 @@ void CPU::NewRec::X64Compiler::Compile_cop2(CompileFlags cf)
   TickCount func_ticks;
   GTE::InstructionImpl func = GTE::GetInstructionImpl(inst->bits, &func_ticks);
 
-  Flush(FLUSH_FOR_C_CALL);
-  cg->mov(RWARG1, inst->bits & GTE::Instruction::REQUIRED_BITS_MASK);
-  cg->call(reinterpret_cast<const void*>(func));
+  // simple commands which only touch GTE registers are generated inline, everything else goes through the handler
+  const GTE::Instruction ginst{inst->bits & GTE::Instruction::REQUIRED_BITS_MASK};
+  if (ginst.command == 0x06 && !(g_settings.gpu_pgxp_enable && g_settings.gpu_pgxp_culling))
+  {
+    Compile_gte_nclip();
+  }
+  else if (ginst.command == 0x2D || ginst.command == 0x2E)
+  {
+    Compile_gte_avsz(ginst.command == 0x2E);
+  }
+  else
+  {
+    Flush(FLUSH_FOR_C_CALL);
+    cg->mov(RWARG1, ginst.bits);
+    cg->call(reinterpret_cast<const void*>(func));
+  }
 
   AddGTETicks(func_ticks);
 }
 
+void CPU::NewRec::X64Compiler::Compile_gte_nclip()
+{
+  // MAC0 = SX0*SY1 + SX1*SY2 + SX2*SY0 - SX0*SY2 - SX1*SY0 - SX2*SY1
+  const auto load_product = [this](const Xbyak::Reg64& dst, const s16* sx, const s16* sy) {
+    cg->movsx(dst, cg->word[PTR(sx)]);
+    cg->movsx(RXARG3, cg->word[PTR(sy)]);
+    cg->imul(dst, RXARG3);
+  };
+
+  GTE::Regs& gr = g_state.gte_regs;
+  load_product(RXARG1, &gr.SXY0[0], &gr.SXY1[1]);
+  load_product(RXARG2, &gr.SXY1[0], &gr.SXY2[1]);
+  cg->add(RXARG1, RXARG2);
+  load_product(RXARG2, &gr.SXY2[0], &gr.SXY0[1]);
+  cg->add(RXARG1, RXARG2);
+  load_product(RXARG2, &gr.SXY0[0], &gr.SXY2[1]);
+  cg->sub(RXARG1, RXARG2);
+  load_product(RXARG2, &gr.SXY1[0], &gr.SXY0[1]);
+  cg->sub(RXARG1, RXARG2);
+  load_product(RXARG2, &gr.SXY2[0], &gr.SXY1[1]);
+  cg->sub(RXARG1, RXARG2);
+
+  GenerateGTEMAC0Result(false);
+}
+
+void CPU::NewRec::X64Compiler::Compile_gte_avsz(bool avsz4)
+{
+  // MAC0 = ZSF3*(SZ1+SZ2+SZ3) or ZSF4*(SZ0+SZ1+SZ2+SZ3), OTZ = MAC0/1000h
+  cg->movzx(RWARG1, cg->word[PTR(&g_state.gte_regs.SZ1)]);
+  cg->movzx(RWARG2, cg->word[PTR(&g_state.gte_regs.SZ2)]);
+  cg->add(RWARG1, RWARG2);
+  cg->movzx(RWARG2, cg->word[PTR(&g_state.gte_regs.SZ3)]);
+  cg->add(RWARG1, RWARG2);
+  if (avsz4)
+  {
+    cg->movzx(RWARG2, cg->word[PTR(&g_state.gte_regs.SZ0)]);
+    cg->add(RWARG1, RWARG2);
+  }
+
+  cg->movsx(RXARG2, cg->word[avsz4 ? PTR(&g_state.gte_regs.ZSF4) : PTR(&g_state.gte_regs.ZSF3)]);
+  cg->imul(RXARG1, RXARG2);
+
+  GenerateGTEMAC0Result(true);
+}
+
+void CPU::NewRec::X64Compiler::GenerateGTEMAC0Result(bool set_otz)
+{
+  // 64-bit result is in RXARG1, the flags are rebuilt from scratch since these commands clear FLAG
+  Xbyak::Label mac_in_range;
+  cg->mov(cg->dword[PTR(&g_state.gte_regs.MAC0)], RWARG1);
+  cg->xor_(RWARG3, RWARG3);
+  cg->movsxd(RXARG2, RWARG1);
+  cg->cmp(RXARG1, RXARG2);
+  cg->je(mac_in_range);
+  cg->mov(RWARG3, GTE::FLAGS::MAC0_OVERFLOW_BITS);
+  cg->mov(RWARG2, GTE::FLAGS::MAC0_UNDERFLOW_BITS);
+  cg->test(RXARG1, RXARG1);
+  cg->cmovs(RWARG3, RWARG2);
+  cg->L(mac_in_range);
+
+  if (set_otz)
+  {
+    // OTZ = clamp(MAC0 SAR 12, 0, FFFFh)
+    Xbyak::Label otz_in_range;
+    cg->sar(RXARG1, 12);
+    cg->cmp(RXARG1, 0xFFFF);
+    cg->jbe(otz_in_range);
+    cg->or_(RWARG3, GTE::FLAGS::OTZ_SATURATED_BITS);
+    cg->sar(RXARG1, 63);
+    cg->not_(RWARG1);
+    cg->and_(RWARG1, 0xFFFF);
+    cg->L(otz_in_range);
+    cg->mov(cg->dword[PTR(&g_state.gte_regs.dr32[7])], RWARG1);
+  }
+
+  cg->mov(cg->dword[PTR(&g_state.gte_regs.FLAG.bits)], RWARG3);
+}
+
 u32 CPU::NewRec::CompileLoadStoreThunk(void* thunk_code, u32 thunk_space, void* code_address, u32 code_size,
                                        TickCount cycles_to_add, TickCount cycles_to_remove, u32 gpr_bitmask,
                                        u8 address_register, u8 data_register, MemoryAccessSize size, bool is_signed,
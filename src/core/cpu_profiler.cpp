@@ -0,0 +1,292 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "cpu_profiler.h"
+#include "cpu_core.h"
+#include "system.h"
+#include "timing_event.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+Log_SetChannel(CPU::Profiler);
+
+namespace CPU::Profiler {
+namespace {
+struct CachedFunctionStart
+{
+  u32 start;
+  u32 instruction;
+};
+
+struct Prologue
+{
+  u32 instruction;
+  u32 allocate_frame_address;
+  u32 frame_size;
+  u32 save_ra_address;
+  s32 ra_offset;
+};
+} // namespace
+
+// How far to look back from a PC for the start of its function, and forward from the start for the prologue.
+static constexpr u32 MAX_FUNCTION_SCAN = 1024;
+static constexpr u32 MAX_PROLOGUE_SCAN = 64;
+
+// addiu sp, sp, -imm
+static constexpr u32 INSTRUCTION_ALLOCATE_FRAME_MASK = 0xFFFF8000u;
+static constexpr u32 INSTRUCTION_ALLOCATE_FRAME = 0x27BD8000u;
+
+// sw ra, imm(sp)
+static constexpr u32 INSTRUCTION_SAVE_RA_MASK = 0xFFFF0000u;
+static constexpr u32 INSTRUCTION_SAVE_RA = 0xAFBF0000u;
+
+// jr ra
+static constexpr u32 INSTRUCTION_RETURN = 0x03E00008u;
+
+static u32 FindFunctionStart(u32 pc);
+static const Prologue& GetPrologue(u32 start);
+static u32 UnwindStack(std::array<u32, MAX_STACK_DEPTH>& frames);
+static std::string GetFunctionName(u32 address);
+
+static u32 s_sample_interval = 0;
+static u32 s_next_sample_time = 0;
+static u32 s_sample_count = 0;
+
+// Keyed by the raw frame addresses, leaf first.
+static std::unordered_map<std::string, u32> s_stacks;
+
+// Overlays replace code at the same address, so the instruction at the PC is checked before the result is reused.
+static std::unordered_map<u32, CachedFunctionStart> s_function_start_cache;
+static std::unordered_map<u32, Prologue> s_prologue_cache;
+} // namespace CPU::Profiler
+
+bool CPU::Profiler::Internal::g_active = false;
+
+void CPU::Profiler::Start()
+{
+  if (Internal::g_active)
+    return;
+
+  s_stacks.clear();
+  s_function_start_cache.clear();
+  s_prologue_cache.clear();
+  s_sample_count = 0;
+  s_sample_interval = std::max<u32>(System::GetTicksPerSecond() / SAMPLE_RATE, 1);
+  s_next_sample_time = TimingEvents::GetGlobalTickCounter() + s_sample_interval;
+  Internal::g_active = true;
+  Log_InfoPrintf("Guest profiler started, sampling every %u cycles.", s_sample_interval);
+}
+
+u32 CPU::Profiler::GetSampleCount()
+{
+  return s_sample_count;
+}
+
+u32 CPU::Profiler::FindFunctionStart(u32 pc)
+{
+  u32 instruction;
+  if (!SafeReadMemoryWord(pc, &instruction))
+    return 0;
+
+  if (const auto iter = s_function_start_cache.find(pc);
+      iter != s_function_start_cache.end() && iter->second.instruction == instruction)
+  {
+    return iter->second.start;
+  }
+
+  // The nearest stack allocation before the PC is usually the prologue. A return reached first means a leaf function
+  // without one starts after the previous function's delay slot.
+  u32 start = 0;
+  for (u32 i = 0; i < MAX_FUNCTION_SCAN; i++)
+  {
+    const u32 address = pc - (i * sizeof(u32));
+    u32 word;
+    if (!SafeReadMemoryWord(address, &word))
+      break;
+
+    if ((word & INSTRUCTION_ALLOCATE_FRAME_MASK) == INSTRUCTION_ALLOCATE_FRAME)
+    {
+      start = address;
+      break;
+    }
+    else if (word == INSTRUCTION_RETURN && i >= 2)
+    {
+      start = address + 8;
+      break;
+    }
+  }
+
+  s_function_start_cache.emplace(pc, CachedFunctionStart{start, instruction});
+  return start;
+}
+
+const CPU::Profiler::Prologue& CPU::Profiler::GetPrologue(u32 start)
+{
+  u32 instruction = 0;
+  SafeReadMemoryWord(start, &instruction);
+
+  auto iter = s_prologue_cache.find(start);
+  if (iter != s_prologue_cache.end() && iter->second.instruction == instruction)
+    return iter->second;
+
+  Prologue prologue = {instruction, 0, 0, 0, -1};
+  for (u32 i = 0; i < MAX_PROLOGUE_SCAN; i++)
+  {
+    const u32 address = start + (i * sizeof(u32));
+    u32 word;
+    if (!SafeReadMemoryWord(address, &word) || word == INSTRUCTION_RETURN)
+      break;
+
+    if ((word & INSTRUCTION_ALLOCATE_FRAME_MASK) == INSTRUCTION_ALLOCATE_FRAME && prologue.frame_size == 0)
+    {
+      prologue.allocate_frame_address = address;
+      prologue.frame_size = static_cast<u32>(-static_cast<s32>(static_cast<s16>(word & 0xFFFFu)));
+    }
+    else if ((word & INSTRUCTION_SAVE_RA_MASK) == INSTRUCTION_SAVE_RA && prologue.ra_offset < 0)
+    {
+      prologue.save_ra_address = address;
+      prologue.ra_offset = static_cast<s16>(word & 0xFFFFu);
+    }
+  }
+
+  if (iter != s_prologue_cache.end())
+    iter->second = prologue;
+  else
+    iter = s_prologue_cache.emplace(start, prologue).first;
+
+  return iter->second;
+}
+
+u32 CPU::Profiler::UnwindStack(std::array<u32, MAX_STACK_DEPTH>& frames)
+{
+  u32 pc = g_state.pc;
+  u32 sp = g_state.regs.sp;
+  u32 ra = g_state.regs.ra;
+  u32 depth = 0;
+
+  while (depth < MAX_STACK_DEPTH)
+  {
+    const u32 start = FindFunctionStart(pc);
+    frames[depth++] = (start != 0) ? start : pc;
+    if (start == 0)
+      break;
+
+    // Only the part of the prologue which has executed matters.
+    const Prologue& prologue = GetPrologue(start);
+    const u32 frame_size = (prologue.frame_size != 0 && prologue.allocate_frame_address < pc) ? prologue.frame_size : 0;
+    const s32 ra_offset = (prologue.ra_offset >= 0 && prologue.save_ra_address < pc) ? prologue.ra_offset : -1;
+
+    u32 return_address;
+    if (ra_offset >= 0)
+    {
+      if (!SafeReadMemoryWord(sp + static_cast<u32>(ra_offset), &return_address))
+        break;
+    }
+    else if (depth == 1)
+    {
+      // Leaf, or ra not saved yet, it's still in the register.
+      return_address = ra;
+    }
+    else
+    {
+      // Outer frames have always saved ra, this one can't be followed.
+      break;
+    }
+
+    // Step back to the call, so the PC is inside the caller even when the call was its last instruction.
+    if (return_address < 8 || (return_address & 3) != 0)
+      break;
+
+    pc = return_address - 8;
+    sp += frame_size;
+  }
+
+  return depth;
+}
+
+void CPU::Profiler::Internal::Sample()
+{
+  const u32 current_time = TimingEvents::GetGlobalTickCounter() + static_cast<u32>(GetPendingTicks());
+  if (static_cast<s32>(current_time - s_next_sample_time) < 0)
+    return;
+
+  s_next_sample_time = current_time + s_sample_interval;
+  s_sample_count++;
+
+  std::array<u32, MAX_STACK_DEPTH> frames;
+  const u32 depth = UnwindStack(frames);
+
+  std::string key(reinterpret_cast<const char*>(frames.data()), depth * sizeof(u32));
+  s_stacks[std::move(key)]++;
+}
+
+std::string CPU::Profiler::GetFunctionName(u32 address)
+{
+  // Kernel code lives in the first 64KB of RAM once the BIOS has copied it there, or in the ROM itself.
+  const u32 physical_address = address & 0x1FFFFFFFu;
+  if (physical_address < 0x10000u || (physical_address >= 0x1FC00000u && physical_address < 0x1FC80000u))
+    return fmt::format("BIOS_{:08X}", address);
+
+  return fmt::format("{:08X}", address);
+}
+
+bool CPU::Profiler::Stop(const char* path, Error* error)
+{
+  if (!Internal::g_active)
+  {
+    Error::SetString(error, "Guest profiler is not active.");
+    return false;
+  }
+
+  Internal::g_active = false;
+
+  FileSystem::ManagedCFilePtr fp = FileSystem::OpenManagedCFile(path, "wb", error);
+  if (!fp)
+    return false;
+
+  // One line per unique stack, root first: "root;caller;leaf count".
+  std::unordered_map<u32, std::string> names;
+  std::string line;
+  for (const auto& [key, count] : s_stacks)
+  {
+    const u32 depth = static_cast<u32>(key.size() / sizeof(u32));
+    const u32* frames = reinterpret_cast<const u32*>(key.data());
+
+    line.clear();
+    for (u32 i = depth; i > 0; i--)
+    {
+      const u32 address = frames[i - 1];
+      auto iter = names.find(address);
+      if (iter == names.end())
+        iter = names.emplace(address, GetFunctionName(address)).first;
+
+      if (i != depth)
+        line.push_back(';');
+      line.append(iter->second);
+    }
+
+    fmt::format_to(std::back_inserter(line), " {}\n", count);
+    if (std::fwrite(line.data(), line.size(), 1, fp.get()) != 1)
+    {
+      Error::SetErrno(error, errno);
+      return false;
+    }
+  }
+
+  Log_InfoPrintf("Wrote %u samples in %zu unique stacks to '%s'.", s_sample_count, s_stacks.size(), path);
+  s_stacks.clear();
+  s_function_start_cache.clear();
+  s_prologue_cache.clear();
+  return true;
+}
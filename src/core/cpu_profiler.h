@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "types.h"
+
+class Error;
+
+/// Sampling profiler for guest code. The PC is sampled from the event loop at a fixed rate of emulated time, and the
+/// call stack is recovered by walking function prologues, since games don't ship with symbols or frame pointers.
+/// Results are written as folded stacks, the input format of flamegraph.pl, speedscope and similar tools.
+namespace CPU::Profiler {
+
+/// Samples per second of emulated time. The event loop runs at least this often, driven by the SPU.
+static constexpr u32 SAMPLE_RATE = 2000;
+
+/// Frames beyond this depth are dropped from the root of the stack.
+static constexpr u32 MAX_STACK_DEPTH = 32;
+
+namespace Internal {
+extern bool g_active;
+
+void Sample();
+} // namespace Internal
+
+ALWAYS_INLINE static bool IsActive()
+{
+  return Internal::g_active;
+}
+
+/// Called each time events run, takes a sample if one is due. Only valid on the CPU thread.
+ALWAYS_INLINE static void Update()
+{
+  if (Internal::g_active) [[unlikely]]
+    Internal::Sample();
+}
+
+/// Discards previous samples, and starts sampling.
+void Start();
+
+/// Stops sampling, and writes the aggregated stacks to path.
+bool Stop(const char* path, Error* error);
+
+u32 GetSampleCount();
+
+} // namespace CPU::Profiler
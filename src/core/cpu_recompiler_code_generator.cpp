@@ -6,6 +6,7 @@
 #include "cpu_core.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
+#include "cpu_trace.h"
 #include "gte.h"
 #include "pgxp.h"
 #include "settings.h"
@@ -984,6 +985,19 @@ void CodeGenerator::BlockPrologue()
 
   EmitStoreCPUStructField(offsetof(State, exception_raised), Value::FromConstantU8(0));
 
+  if (g_settings.cpu_recompiler_block_profiling)
+  {
+    EmitStoreCPUStructField(offsetof(State, profile_block_index),
+                            Value::FromConstantU32(CodeCache::RegisterProfiledBlock(m_block)));
+    EmitFunctionCall(nullptr, &CodeCache::ProfileBlockEntry);
+  }
+
+  if (Trace::IsActive())
+  {
+    EmitStoreCPUStructField(offsetof(State, trace_block_pc), Value::FromConstantU32(m_block->pc));
+    EmitFunctionCall(nullptr, &Trace::LogBlockEntry);
+  }
+
   if (g_settings.bios_tty_logging)
   {
     if (m_pc == 0xa0)
@@ -34,12 +34,11 @@ Value CodeGenerator::EmitLoadGuestMemory(Instruction instruction, const CodeCach
 {
   if (address.IsConstant() && !SpeculativeIsCacheIsolated())
   {
-    TickCount read_ticks;
-    void* ptr = GetDirectReadMemoryPointer(
-      static_cast<u32>(address.constant_value),
+    const MemoryAccessSize access_size =
       (size == RegSize_8) ? MemoryAccessSize::Byte :
-                            ((size == RegSize_16) ? MemoryAccessSize::HalfWord : MemoryAccessSize::Word),
-      &read_ticks);
+                            ((size == RegSize_16) ? MemoryAccessSize::HalfWord : MemoryAccessSize::Word);
+    TickCount read_ticks;
+    void* ptr = GetDirectReadMemoryPointer(static_cast<u32>(address.constant_value), access_size, &read_ticks);
     if (ptr)
     {
       Value result = m_register_cache.AllocateScratch(size);
@@ -59,6 +58,19 @@ Value CodeGenerator::EmitLoadGuestMemory(Instruction instruction, const CodeCach
       m_delayed_cycles_add += read_ticks;
       return result;
     }
+
+    // Aligned register reads can't fault, so call the device directly instead of going through the thunk.
+    const Bus::MemoryReadHandler handler =
+      Bus::GetHardwareRegisterReadHandler(static_cast<u32>(address.constant_value), access_size);
+    if (handler && (address.constant_value & ((1u << static_cast<u32>(access_size)) - 1)) == 0)
+    {
+      Value result = m_register_cache.AllocateScratch(HostPointerSize);
+      AddPendingCycles(true);
+      m_register_cache.FlushCallerSavedGuestRegisters(true, true);
+      EmitFunctionCallPtr(&result, reinterpret_cast<const void*>(handler), address);
+      ConvertValueSizeInPlace(&result, size, false);
+      return result;
+    }
   }
 
   Value result = m_register_cache.AllocateScratch(HostPointerSize);
@@ -122,10 +134,10 @@ void CodeGenerator::EmitStoreGuestMemory(Instruction instruction, const CodeCach
 {
   if (address.IsConstant() && !SpeculativeIsCacheIsolated())
   {
-    void* ptr = GetDirectWriteMemoryPointer(
-      static_cast<u32>(address.constant_value),
+    const MemoryAccessSize access_size =
       (size == RegSize_8) ? MemoryAccessSize::Byte :
-                            ((size == RegSize_16) ? MemoryAccessSize::HalfWord : MemoryAccessSize::Word));
+                            ((size == RegSize_16) ? MemoryAccessSize::HalfWord : MemoryAccessSize::Word);
+    void* ptr = GetDirectWriteMemoryPointer(static_cast<u32>(address.constant_value), access_size);
     if (ptr)
     {
       if (value.size != size)
@@ -135,6 +147,16 @@ void CodeGenerator::EmitStoreGuestMemory(Instruction instruction, const CodeCach
 
       return;
     }
+
+    const Bus::MemoryWriteHandler handler =
+      Bus::GetHardwareRegisterWriteHandler(static_cast<u32>(address.constant_value), access_size);
+    if (handler && (address.constant_value & ((1u << static_cast<u32>(access_size)) - 1)) == 0)
+    {
+      AddPendingCycles(true);
+      m_register_cache.FlushCallerSavedGuestRegisters(true, true);
+      EmitFunctionCallPtr(nullptr, reinterpret_cast<const void*>(handler), address, value);
+      return;
+    }
   }
 
   const bool use_fastmem = !g_settings.cpu_recompiler_memory_exceptions &&
@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "cpu_trace.h"
+#include "cpu_core.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/threading.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+Log_SetChannel(CPU::Trace);
+
+namespace CPU::Trace {
+static constexpr u32 BUFFER_MASK = BUFFER_RECORDS - 1;
+static_assert((BUFFER_RECORDS & BUFFER_MASK) == 0, "Buffer size is a power of two");
+
+static constexpr u32 NUM_TRACED_REGS = static_cast<u32>(Reg::count);
+
+static void PushRecord(const Record& record);
+static void WaitForSpace(u32 write_pos);
+static void LogRegisterChanges();
+static void WriterThread();
+
+// Positions are free running and only masked when indexing, so a full buffer can be told apart from an empty one.
+// Only the CPU thread writes s_write_pos, and only the writer thread writes s_read_pos.
+static std::unique_ptr<Record[]> s_buffer;
+static std::atomic<u32> s_write_pos{0};
+static std::atomic<u32> s_read_pos{0};
+static u32 s_cached_read_pos = 0;
+static std::atomic_bool s_stop_writer{false};
+static std::thread s_writer_thread;
+static std::FILE* s_file = nullptr;
+
+// Register values as of the last record, changes are written as deltas against these.
+static std::array<u32, NUM_TRACED_REGS> s_last_regs = {};
+} // namespace CPU::Trace
+
+bool CPU::Trace::Internal::g_active = false;
+
+bool CPU::Trace::Start(const char* path, Error* error)
+{
+  if (Internal::g_active)
+    return true;
+
+  s_file = FileSystem::OpenCFile(path, "wb", error);
+  if (!s_file)
+    return false;
+
+  const FileHeader header = {FILE_MAGIC, FILE_VERSION, sizeof(Record), 0};
+  if (std::fwrite(&header, sizeof(header), 1, s_file) != 1)
+  {
+    Error::SetErrno(error, errno);
+    std::fclose(s_file);
+    s_file = nullptr;
+    return false;
+  }
+
+  if (!s_buffer)
+    s_buffer = std::make_unique<Record[]>(BUFFER_RECORDS);
+  s_write_pos.store(0, std::memory_order_relaxed);
+  s_read_pos.store(0, std::memory_order_relaxed);
+  s_cached_read_pos = 0;
+  s_stop_writer.store(false, std::memory_order_relaxed);
+  s_writer_thread = std::thread(WriterThread);
+
+  // The first records hold the whole register file, everything after is relative to it.
+  for (u32 i = 1; i < NUM_TRACED_REGS; i++)
+  {
+    s_last_regs[i] = g_state.regs.r[i];
+    PushRecord(Record{0, 0, s_last_regs[i], RecordType::Register, static_cast<u8>(i), 0});
+  }
+
+  Internal::g_active = true;
+  Log_InfoPrintf("CPU trace started to '%s'.", path);
+  return true;
+}
+
+void CPU::Trace::Stop()
+{
+  if (!Internal::g_active)
+    return;
+
+  Internal::g_active = false;
+  s_stop_writer.store(true, std::memory_order_release);
+  s_writer_thread.join();
+
+  if (s_file)
+  {
+    std::fclose(s_file);
+    s_file = nullptr;
+  }
+  s_buffer.reset();
+  Log_InfoPrintf("CPU trace stopped after %u records.", s_write_pos.load(std::memory_order_relaxed));
+}
+
+void CPU::Trace::PushRecord(const Record& record)
+{
+  const u32 write_pos = s_write_pos.load(std::memory_order_relaxed);
+  if ((write_pos - s_cached_read_pos) == BUFFER_RECORDS) [[unlikely]]
+    WaitForSpace(write_pos);
+
+  s_buffer[write_pos & BUFFER_MASK] = record;
+  s_write_pos.store(write_pos + 1, std::memory_order_release);
+}
+
+void CPU::Trace::WaitForSpace(u32 write_pos)
+{
+  // Dropping records would make the trace useless, so stall the CPU thread until the writer catches up.
+  for (;;)
+  {
+    s_cached_read_pos = s_read_pos.load(std::memory_order_acquire);
+    if ((write_pos - s_cached_read_pos) < BUFFER_RECORDS)
+      return;
+
+    std::this_thread::yield();
+  }
+}
+
+void CPU::Trace::LogRegisterChanges()
+{
+  // r0 can't change.
+  for (u32 i = 1; i < NUM_TRACED_REGS; i++)
+  {
+    const u32 value = g_state.regs.r[i];
+    if (value == s_last_regs[i])
+      continue;
+
+    s_last_regs[i] = value;
+    PushRecord(Record{0, 0, value, RecordType::Register, static_cast<u8>(i), 0});
+  }
+}
+
+void CPU::Trace::Internal::LogInstruction(u32 pc, u32 bits)
+{
+  LogRegisterChanges();
+  PushRecord(Record{pc, bits, 0, RecordType::Instruction, 0, 0});
+}
+
+void CPU::Trace::LogBlockCode(u32 pc, const Instruction* instructions, u32 count)
+{
+  if (!Internal::g_active)
+    return;
+
+  for (u32 i = 0; i < count; i++)
+    PushRecord(Record{pc + (i * sizeof(Instruction)), instructions[i].bits, pc, RecordType::BlockCode, 0, 0});
+}
+
+void CPU::Trace::LogBlockEntry()
+{
+  if (!Internal::g_active)
+    return;
+
+  const u32 pc = g_state.trace_block_pc;
+  LogRegisterChanges();
+  PushRecord(Record{pc, 0, 0, RecordType::BlockEntry, 0, 0});
+}
+
+void CPU::Trace::WriterThread()
+{
+  Threading::SetNameOfCurrentThread("CPU Trace Writer");
+
+  for (;;)
+  {
+    // Stop has to be checked first, so that the records pushed before it was set are still seen.
+    const bool stopping = s_stop_writer.load(std::memory_order_acquire);
+    const u32 read_pos = s_read_pos.load(std::memory_order_relaxed);
+    const u32 write_pos = s_write_pos.load(std::memory_order_acquire);
+    if (read_pos == write_pos)
+    {
+      if (stopping)
+        break;
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      continue;
+    }
+
+    // Up to the end of the buffer, anything which wrapped around goes in the next write.
+    const u32 start = read_pos & BUFFER_MASK;
+    const u32 count = std::min(write_pos - read_pos, BUFFER_RECORDS - start);
+    if (s_file && std::fwrite(&s_buffer[start], sizeof(Record), count, s_file) != count)
+    {
+      // Keep draining, otherwise the CPU thread would wait forever.
+      Log_ErrorPrintf("Failed to write CPU trace (errno %d), the rest will be discarded.", errno);
+      std::fclose(s_file);
+      s_file = nullptr;
+    }
+
+    s_read_pos.store(read_pos + count, std::memory_order_release);
+  }
+}
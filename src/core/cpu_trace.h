@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "cpu_types.h"
+#include "types.h"
+
+class Error;
+
+/// Binary execution trace. Records are stored into a ring buffer on the CPU thread and written out by a worker thread,
+/// so tracing costs a few stores per instruction instead of disassembling and formatting each one. The interpreter
+/// records every instruction and the registers it changed. The recompilers and cached interpreter record each block as
+/// it is entered, with the block's code written once when it is compiled. scripts/disassemble_cpu_trace.py turns a
+/// trace back into text.
+namespace CPU::Trace {
+
+static constexpr u32 FILE_MAGIC = 0x54435344; // DSCT
+static constexpr u32 FILE_VERSION = 1;
+
+/// Records in the ring buffer. The CPU thread waits for the writer if it gets this far ahead.
+static constexpr u32 BUFFER_RECORDS = 1024 * 1024;
+
+enum class RecordType : u8
+{
+  Instruction, ///< Instruction bits at pc is about to be executed.
+  Register,    ///< Register reg was changed to value since the previous instruction or block entry.
+  BlockCode,   ///< Instruction bits at pc is part of the block starting at value, which was just compiled.
+  BlockEntry,  ///< Block starting at pc is about to be executed.
+};
+
+struct Record
+{
+  u32 pc;
+  u32 bits;
+  u32 value;
+  RecordType type;
+  u8 reg;
+  u16 reserved;
+};
+static_assert(sizeof(Record) == 16);
+
+/// Written at the start of the file, followed by records until the end.
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 record_size;
+  u32 reserved;
+};
+
+namespace Internal {
+extern bool g_active;
+
+void LogInstruction(u32 pc, u32 bits);
+} // namespace Internal
+
+ALWAYS_INLINE static bool IsActive()
+{
+  return Internal::g_active;
+}
+
+/// Interpreter hook, called before each instruction is executed. Only valid on the CPU thread.
+ALWAYS_INLINE static void LogInstruction(u32 pc, u32 bits)
+{
+  if (Internal::g_active) [[unlikely]]
+    Internal::LogInstruction(pc, bits);
+}
+
+/// Opens the trace file and starts the writer thread.
+bool Start(const char* path, Error* error);
+
+/// Writes out anything still buffered, and closes the file.
+void Stop();
+
+/// Writes the code of a block which was just compiled, so block entries can be disassembled without guest memory.
+void LogBlockCode(u32 pc, const Instruction* instructions, u32 count);
+
+/// Block prologue hook. Blocks store their start address to g_state.trace_block_pc before calling this.
+void LogBlockEntry();
+
+} // namespace CPU::Trace
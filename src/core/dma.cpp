@@ -19,6 +19,7 @@
 #include "util/state_wrapper.h"
 
 #include "common/bitfield.h"
+#include "common/intrin.h"
 #include "common/log.h"
 #include "common/string_util.h"
 
@@ -508,6 +509,9 @@ bool DMA::TransferChannel(Channel channel)
       Log_DebugPrintf("DMA%u: Copying linked list starting at 0x%08X to device", static_cast<u32>(channel),
                       current_address & mask);
 
+      // GP0 is the only device that takes linked lists in practice, so packets go straight into its FIFO.
+      const bool gpu_direct = (channel == Channel::GPU && g_gpu->BeginDMAWrite());
+
       u8* ram_pointer = Bus::g_ram;
       TickCount remaining_ticks = GetTransferSliceTicks();
       while (cs.request && remaining_ticks > 0)
@@ -521,13 +525,29 @@ bool DMA::TransferChannel(Channel channel)
         const u32 next_address = header & UINT32_C(0x00FFFFFF);
         Log_TracePrintf(" .. linked list entry at 0x%08X size=%u(%u words) next=0x%08X", current_address & mask,
                         word_count * UINT32_C(4), word_count, next_address);
+
+        // Ordering table nodes are scattered all over RAM, start pulling in the next one while this is processed.
+        if (!(next_address & UINT32_C(0x800000)))
+          PrefetchForRead(&ram_pointer[next_address & mask]);
+
         if (word_count > 0)
         {
           CPU::AddPendingTicks(5);
           remaining_ticks -= 5;
 
-          const TickCount block_ticks =
-            TransferMemoryToDevice(channel, (current_address + sizeof(header)) & mask, 4, word_count);
+          const u32 packet_address = (current_address + sizeof(header)) & mask;
+          TickCount block_ticks;
+          if (gpu_direct && ((packet_address + (word_count * sizeof(u32))) & mask) > packet_address)
+          {
+            g_gpu->DMAWrite(packet_address, reinterpret_cast<const u32*>(&ram_pointer[packet_address]), word_count);
+            g_gpu->EndDMAWrite();
+            block_ticks = Bus::GetDMARAMTickCount(word_count);
+          }
+          else
+          {
+            block_ticks = TransferMemoryToDevice(channel, packet_address, 4, word_count);
+          }
+
           CPU::AddPendingTicks(block_ticks);
           remaining_ticks -= block_ticks;
         }
@@ -667,8 +687,9 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
 {
   const u32* src_pointer = reinterpret_cast<u32*>(Bus::g_ram + address);
   const u32 mask = GetAddressMask();
-  if (channel != Channel::GPU &&
-      (static_cast<s32>(increment) < 0 || ((address + (increment * word_count)) & mask) <= address))
+  const bool contiguous =
+    (static_cast<s32>(increment) > 0 && ((address + (increment * word_count)) & mask) > address);
+  if (!contiguous && channel != Channel::GPU)
   {
     // Use temp buffer if it's wrapping around
     if (s_transfer_buffer.size() < word_count)
@@ -689,14 +710,22 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
     {
       if (g_gpu->BeginDMAWrite())
       {
-        u8* ram_pointer = Bus::g_ram;
-        for (u32 i = 0; i < word_count; i++)
+        if (contiguous)
+        {
+          g_gpu->DMAWrite(address, src_pointer, word_count);
+        }
+        else
         {
-          u32 value;
-          std::memcpy(&value, &ram_pointer[address], sizeof(u32));
-          g_gpu->DMAWrite(address, value);
-          address = (address + increment) & mask;
+          u8* ram_pointer = Bus::g_ram;
+          for (u32 i = 0; i < word_count; i++)
+          {
+            u32 value;
+            std::memcpy(&value, &ram_pointer[address], sizeof(u32));
+            g_gpu->DMAWrite(address, value);
+            address = (address + increment) & mask;
+          }
         }
+
         g_gpu->EndDMAWrite();
       }
     }
@@ -464,10 +464,19 @@ static void PopulateGameListEntryList();
 static GPUTexture* GetTextureForGameListEntryType(GameList::EntryType type);
 static GPUTexture* GetGameListCover(const GameList::Entry* entry);
 static GPUTexture* GetCoverForCurrentGame();
+static void PrefetchGameListCovers(u32 start, u32 end);
+
+// Rows either side of the visible area which have their covers loaded ahead of time.
+static constexpr u32 GAME_LIST_PREFETCH_ROWS = 3;
 
 // Lazily populated cover images.
 static std::unordered_map<std::string, std::string> s_cover_image_map;
+
+// Only re-sorted when the list or the sort order changes.
 static std::vector<const GameList::Entry*> s_game_list_sorted_entries;
+static std::optional<u32> s_game_list_sorted_version;
+static s32 s_game_list_sorted_sort = 0;
+static bool s_game_list_sorted_reverse = false;
 static GameListPage s_game_list_page = GameListPage::Grid;
 } // namespace FullscreenUI
 
@@ -727,6 +736,7 @@ void FullscreenUI::Shutdown()
   CloseSaveStateSelector();
   s_cover_image_map.clear();
   s_game_list_sorted_entries = {};
+  s_game_list_sorted_version.reset();
   s_game_list_directories_cache = {};
   s_postprocessing_stages = {};
   s_fullscreen_mode_list_cache = {};
@@ -876,8 +886,8 @@ void FullscreenUI::DestroyResources()
 
 ImGuiFullscreen::FileSelectorFilters FullscreenUI::GetDiscImageFilters()
 {
-  return {"*.bin",    "*.cue", "*.iso", "*.img",     "*.chd", "*.ecm", "*.mds", "*.psexe",
-          "*.ps-exe", "*.exe", "*.psf", "*.minipsf", "*.m3u", "*.pbp", "*.PBP"};
+  return {"*.bin",    "*.cue", "*.iso", "*.img",     "*.chd", "*.ecm", "*.mds", "*.zcd",
+          "*.psexe",  "*.ps-exe", "*.exe", "*.psf", "*.minipsf", "*.m3u", "*.pbp", "*.PBP"};
 }
 
 void FullscreenUI::DoStartPath(std::string path, std::string state, std::optional<bool> fast_boot)
@@ -2972,6 +2982,10 @@ void FullscreenUI::DrawConsoleSettingsPage()
     bsi, FSUI_CSTR("Preload Images to RAM"),
     FSUI_CSTR("Loads the game image into RAM. Useful for network paths that may become unreliable during gameplay."),
     "CDROM", "LoadImageToRAM", false);
+  DrawToggleSetting(bsi, FSUI_CSTR("Share Preloaded Images"),
+                    FSUI_CSTR("Instances preloading the same disc share one copy of it, rather than each holding their "
+                              "own."),
+                    "CDROM", "SharePrecache", false, bsi->GetBoolValue("CDROM", "LoadImageToRAM", false));
   DrawToggleSetting(
     bsi, FSUI_CSTR("Apply Image Patches"),
     FSUI_CSTR("Automatically applies patches to disc images when they are present, currently only PPF is supported."),
@@ -3049,6 +3063,9 @@ void FullscreenUI::DrawEmulationSettingsPage()
     bsi, FSUI_CSTR("Rewind Save Slots"),
     FSUI_CSTR("How many saves will be kept for rewinding. Higher values have greater memory requirements."), "Main",
     "RewindSaveSlots", 10, 1, 10000, "%d Frames");
+  DrawToggleSetting(bsi, FSUI_CSTR("Store Rewind VRAM At Native Resolution"),
+                    FSUI_CSTR("Greatly reduces the GPU memory used by rewind at high resolution scales."), "Main",
+                    "RewindNativeVRAM", false);
 
   const s32 runahead_frames = GetEffectiveIntSetting(bsi, "Main", "RunaheadFrameCount", 0);
   const bool runahead_enabled = (runahead_frames > 0);
@@ -3079,8 +3096,10 @@ void FullscreenUI::DrawEmulationSettingsPage()
       ((rewind_frequency <= std::numeric_limits<float>::epsilon()) ? (1.0f / 60.0f) : rewind_frequency) *
       static_cast<float>(rewind_save_slots);
 
+    const bool rewind_native_vram = GetEffectiveBoolSetting(bsi, "Main", "RewindNativeVRAM", false);
+
     u64 ram_usage, vram_usage;
-    System::CalculateRewindMemoryUsage(rewind_save_slots, &ram_usage, &vram_usage);
+    System::CalculateRewindMemoryUsage(rewind_save_slots, rewind_native_vram, &ram_usage, &vram_usage);
     rewind_summary.fmt(
       FSUI_FSTR("Rewind for {0} frames, lasting {1:.2f} seconds will require up to {3} MB of RAM and {4} MB of VRAM."),
       rewind_save_slots, duration, ram_usage / 1048576, vram_usage / 1048576);
@@ -3847,6 +3866,10 @@ void FullscreenUI::DrawDisplaySettingsPage()
       DrawToggleSetting(bsi, FSUI_CSTR("Threaded Rendering"),
                         FSUI_CSTR("Uses a second thread for drawing graphics. Speed boost, and safe to use."), "GPU",
                         "UseThread", true);
+      DrawIntRangeSetting(
+        bsi, FSUI_CSTR("Rasterizer Worker Threads"),
+        FSUI_CSTR("Splits the screen into tiles which are drawn in parallel by additional threads. 0 disables."), "GPU",
+        "SoftwareRendererWorkerThreads", 0, 0, 16, "%d threads");
     }
     break;
 
@@ -3879,6 +3902,16 @@ void FullscreenUI::DrawDisplaySettingsPage()
                               "having speed or sound issues."),
                     "Display", "DisplayAllFrames", false);
 
+  DrawToggleSetting(bsi, FSUI_CSTR("Reduce Input Latency"),
+                    FSUI_CSTR("Starts each frame as late as possible, so input is read closer to when it is displayed. "
+                              "Disable if you get stutter."),
+                    "Display", "PreFrameSleep", false);
+
+  DrawToggleSetting(bsi, FSUI_CSTR("Skip Rendering When Fast Forwarding"),
+                    FSUI_CSTR("Only draws displayed frames while fast forwarding. Areas which weren't drawn are filled "
+                              "in by the software renderer."),
+                    "GPU", "RenderSkip", false, is_hardware);
+
   MenuHeading(FSUI_CSTR("Rendering"));
 
   DrawIntListSetting(
@@ -3886,6 +3919,11 @@ void FullscreenUI::DrawDisplaySettingsPage()
     FSUI_CSTR("Scales internal VRAM resolution by the specified multiplier. Some games require 1x VRAM resolution."),
     "GPU", "ResolutionScale", 1, resolution_scales.data(), resolution_scales.size(), true, 0, is_hardware);
 
+  DrawToggleSetting(bsi, FSUI_CSTR("Dynamic Resolution"),
+                    FSUI_CSTR("Lowers the resolution scale in demanding scenes to stay at full speed, and raises it "
+                              "again up to the selected scale."),
+                    "GPU", "DynamicResolution", false, is_hardware);
+
   DrawEnumSetting(
     bsi, FSUI_CSTR("Texture Filtering"), FSUI_CSTR("Smooths out the blockiness of magnified textures on 3D objects."),
     "GPU", "TextureFilter", Settings::DEFAULT_GPU_TEXTURE_FILTER, &Settings::ParseTextureFilterName,
@@ -4010,7 +4048,7 @@ void FullscreenUI::DrawDisplaySettingsPage()
                     FSUI_CSTR("Enables the replacement of background textures in supported games."),
                     "TextureReplacements", "EnableVRAMWriteReplacements", false);
   DrawToggleSetting(bsi, FSUI_CSTR("Preload Replacement Textures"),
-                    FSUI_CSTR("Loads all replacement texture to RAM, reducing stuttering at runtime."),
+                    FSUI_CSTR("Decodes all replacement textures in the background, reducing stuttering at runtime."),
                     "TextureReplacements", "PreloadTextures", false);
 
   EndMenuButtons();
@@ -4623,16 +4661,35 @@ void FullscreenUI::DrawAdvancedSettingsPage()
                     FSUI_CSTR("Enable debugging when supported by the host's renderer API. Only for developer use."),
                     "GPU", "UseDebugDevice", false);
 
+  DrawToggleSetting(bsi, FSUI_CSTR("Lazy Pipeline Compilation"),
+                    FSUI_CSTR("Only compiles the rendering pipelines which are used, remembering them for next time."),
+                    "GPU", "LazyPipelineCompilation", false);
+
+  DrawToggleSetting(bsi, FSUI_CSTR("Use Ubershaders While Compiling"),
+                    FSUI_CSTR("Draws with slower general shaders until lazily compiled pipelines are ready, to avoid "
+                              "stuttering."),
+                    "GPU", "UseUbershaders", false,
+                    bsi->GetBoolValue("GPU", "LazyPipelineCompilation", false));
+
 #ifdef _WIN32
   DrawToggleSetting(bsi, FSUI_CSTR("Increase Timer Resolution"),
                     FSUI_CSTR("Enables more precise frame pacing at the cost of battery life."), "Main",
                     "IncreaseTimerResolution", true);
 #endif
 
+  DrawToggleSetting(bsi, FSUI_CSTR("Thread Core Placement"),
+                    FSUI_CSTR("Runs emulation threads on performance cores, and background work on efficiency cores."),
+                    "Main", "ThreadCorePlacement", false);
+
   DrawToggleSetting(bsi, FSUI_CSTR("Allow Booting Without SBI File"),
                     FSUI_CSTR("Allows loading protected games without subchannel information."), "CDROM",
                     "AllowBootingWithoutSBIFile", false);
 
+  DrawIntRangeSetting(bsi, FSUI_CSTR("CHD Hunk Cache Size"),
+                      FSUI_CSTR("Number of decompressed CHD hunks kept in memory, which avoids decompressing them "
+                                "again after seeks. Applies to discs opened after changing."),
+                      "CDROM", "CHDHunkCacheSize", Settings::DEFAULT_CDROM_CHD_HUNK_CACHE_SIZE, 1, 256, "%d");
+
   DrawToggleSetting(bsi, FSUI_CSTR("Create Save State Backups"),
                     FSUI_CSTR("Renames existing save states when saving to a backup file."), "Main",
                     "CreateSaveStateBackups", false);
@@ -4696,6 +4753,18 @@ void FullscreenUI::DrawAdvancedSettingsPage()
     bsi, FSUI_CSTR("Enable Recompiler Block Linking"),
     FSUI_CSTR("Performance enhancement - jumps directly between blocks instead of returning to the dispatcher."), "CPU",
     "RecompilerBlockLinking", true);
+  DrawToggleSetting(bsi, FSUI_CSTR("Enable Recompiler Block Cache"),
+                    FSUI_CSTR("Remembers compiled blocks across sessions, and compiles them when booting or loading "
+                              "states instead of when they're first executed."),
+                    "CPU", "RecompilerBlockCache", false);
+  DrawToggleSetting(bsi, FSUI_CSTR("Enable Recompiler Block Profiling"),
+                    FSUI_CSTR("Counts executions and host time for each recompiled block, and writes a report of the "
+                              "hottest blocks when the system shuts down. Slows down emulation."),
+                    "CPU", "RecompilerBlockProfiling", false);
+  DrawToggleSetting(bsi, FSUI_CSTR("Enable Recompiler Idle Loop Skipping"),
+                    FSUI_CSTR("Detects loops which poll memory without side effects, and skips ahead to the next event "
+                              "instead of running them. Reduces host CPU usage, only supported by the new recompiler."),
+                    "CPU", "RecompilerIdleLoopSkipping", false);
   DrawEnumSetting(bsi, FSUI_CSTR("Recompiler Fast Memory Access"),
                   FSUI_CSTR("Avoids calls to C++ code, significantly speeding up the recompiler."), "CPU",
                   "FastmemMode", Settings::DEFAULT_CPU_FASTMEM_MODE, &Settings::ParseCPUFastmemMode,
@@ -5552,6 +5621,13 @@ void FullscreenUI::PopulateGameListEntryList()
 {
   const s32 sort = Host::GetBaseIntSettingValue("Main", "FullscreenUIGameSort", 0);
   const bool reverse = Host::GetBaseBoolSettingValue("Main", "FullscreenUIGameSortReverse", false);
+  const u32 version = GameList::GetEntriesVersion();
+  if (s_game_list_sorted_version == version && s_game_list_sorted_sort == sort && s_game_list_sorted_reverse == reverse)
+    return;
+
+  s_game_list_sorted_version = version;
+  s_game_list_sorted_sort = sort;
+  s_game_list_sorted_reverse = reverse;
 
   const u32 count = GameList::GetEntryCount();
   s_game_list_sorted_entries.resize(count);
@@ -5706,7 +5782,6 @@ void FullscreenUI::DrawGameList(const ImVec2& heading_size)
 
   auto game_list_lock = GameList::GetLock();
   const GameList::Entry* selected_entry = nullptr;
-  PopulateGameListEntryList();
 
   if (BeginFullscreenColumnWindow(0.0f, -530.0f, "game_list_entries"))
   {
@@ -5718,62 +5793,75 @@ void FullscreenUI::DrawGameList(const ImVec2& heading_size)
 
     SmallString summary;
 
-    for (const GameList::Entry* entry : s_game_list_sorted_entries)
+    // Only the rows which are on screen are submitted, the clipper handles navigating to those which aren't.
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(s_game_list_sorted_entries.size()));
+    u32 visible_start = 0, visible_end = 0;
+    while (clipper.Step())
     {
-      ImRect bb;
-      bool visible, hovered;
-      bool pressed =
-        MenuButtonFrame(entry->path.c_str(), true, LAYOUT_MENU_BUTTON_HEIGHT, &visible, &hovered, &bb.Min, &bb.Max);
-      if (!visible)
-        continue;
-
-      GPUTexture* cover_texture = GetGameListCover(entry);
+      visible_start = static_cast<u32>(clipper.DisplayStart);
+      visible_end = static_cast<u32>(clipper.DisplayEnd);
+      for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+      {
+        const GameList::Entry* entry = s_game_list_sorted_entries[i];
+        ImRect bb;
+        bool visible, hovered;
+        bool pressed =
+          MenuButtonFrame(entry->path.c_str(), true, LAYOUT_MENU_BUTTON_HEIGHT, &visible, &hovered, &bb.Min, &bb.Max);
+        if (!visible)
+          continue;
 
-      if (entry->serial.empty())
-        summary.fmt("{} - ", Settings::GetDiscRegionDisplayName(entry->region));
-      else
-        summary.fmt("{} - {} - ", entry->serial, Settings::GetDiscRegionDisplayName(entry->region));
+        GPUTexture* cover_texture = GetGameListCover(entry);
 
-      summary.append(Path::GetFileName(entry->path));
+        if (entry->serial.empty())
+          summary.fmt("{} - ", Settings::GetDiscRegionDisplayName(entry->region));
+        else
+          summary.fmt("{} - {} - ", entry->serial, Settings::GetDiscRegionDisplayName(entry->region));
 
-      const ImRect image_rect(
-        CenterImage(ImRect(bb.Min, bb.Min + image_size), ImVec2(static_cast<float>(cover_texture->GetWidth()),
-                                                                static_cast<float>(cover_texture->GetHeight()))));
+        summary.append(Path::GetFileName(entry->path));
 
-      ImGui::GetWindowDrawList()->AddImage(cover_texture, image_rect.Min, image_rect.Max, ImVec2(0.0f, 0.0f),
-                                           ImVec2(1.0f, 1.0f), IM_COL32(255, 255, 255, 255));
+        const ImRect image_rect(
+          CenterImage(ImRect(bb.Min, bb.Min + image_size), ImVec2(static_cast<float>(cover_texture->GetWidth()),
+                                                                  static_cast<float>(cover_texture->GetHeight()))));
 
-      const float midpoint = bb.Min.y + g_large_font->FontSize + LayoutScale(4.0f);
-      const float text_start_x = bb.Min.x + image_size.x + LayoutScale(15.0f);
-      const ImRect title_bb(ImVec2(text_start_x, bb.Min.y), ImVec2(bb.Max.x, midpoint));
-      const ImRect summary_bb(ImVec2(text_start_x, midpoint), bb.Max);
+        ImGui::GetWindowDrawList()->AddImage(cover_texture, image_rect.Min, image_rect.Max, ImVec2(0.0f, 0.0f),
+                                             ImVec2(1.0f, 1.0f), IM_COL32(255, 255, 255, 255));
 
-      ImGui::PushFont(g_large_font);
-      ImGui::RenderTextClipped(title_bb.Min, title_bb.Max, entry->title.c_str(),
-                               entry->title.c_str() + entry->title.size(), nullptr, ImVec2(0.0f, 0.0f), &title_bb);
-      ImGui::PopFont();
+        const float midpoint = bb.Min.y + g_large_font->FontSize + LayoutScale(4.0f);
+        const float text_start_x = bb.Min.x + image_size.x + LayoutScale(15.0f);
+        const ImRect title_bb(ImVec2(text_start_x, bb.Min.y), ImVec2(bb.Max.x, midpoint));
+        const ImRect summary_bb(ImVec2(text_start_x, midpoint), bb.Max);
 
-      if (!summary.empty())
-      {
-        ImGui::PushFont(g_medium_font);
-        ImGui::RenderTextClipped(summary_bb.Min, summary_bb.Max, summary.c_str(), summary.end_ptr(), nullptr,
-                                 ImVec2(0.0f, 0.0f), &summary_bb);
+        ImGui::PushFont(g_large_font);
+        ImGui::RenderTextClipped(title_bb.Min, title_bb.Max, entry->title.c_str(),
+                                 entry->title.c_str() + entry->title.size(), nullptr, ImVec2(0.0f, 0.0f), &title_bb);
         ImGui::PopFont();
-      }
 
-      if (pressed)
-        HandleGameListActivate(entry);
+        if (!summary.empty())
+        {
+          ImGui::PushFont(g_medium_font);
+          ImGui::RenderTextClipped(summary_bb.Min, summary_bb.Max, summary.c_str(), summary.end_ptr(), nullptr,
+                                   ImVec2(0.0f, 0.0f), &summary_bb);
+          ImGui::PopFont();
+        }
 
-      if (hovered)
-        selected_entry = entry;
+        if (pressed)
+          HandleGameListActivate(entry);
 
-      if (selected_entry && (ImGui::IsItemClicked(ImGuiMouseButton_Right) ||
-                             ImGui::IsNavInputTest(ImGuiNavInput_Input, ImGuiNavReadMode_Pressed)))
-      {
-        HandleGameListOptions(selected_entry);
+        if (hovered)
+          selected_entry = entry;
+
+        if (selected_entry && (ImGui::IsItemClicked(ImGuiMouseButton_Right) ||
+                               ImGui::IsNavInputTest(ImGuiNavInput_Input, ImGuiNavReadMode_Pressed)))
+        {
+          HandleGameListOptions(selected_entry);
+        }
       }
     }
 
+    PrefetchGameListCovers((visible_start > GAME_LIST_PREFETCH_ROWS) ? (visible_start - GAME_LIST_PREFETCH_ROWS) : 0,
+                           visible_end + GAME_LIST_PREFETCH_ROWS);
+
     EndMenuButtons();
   }
   EndFullscreenColumnWindow();
@@ -5928,76 +6016,90 @@ void FullscreenUI::DrawGameGrid(const ImVec2& heading_size)
 
   SmallString draw_title;
 
-  u32 grid_x = 0;
-  ImGui::SetCursorPos(ImVec2(start_x, 0.0f));
-  for (const GameList::Entry* entry : s_game_list_sorted_entries)
+  // Only the rows which are on screen are submitted, the clipper handles navigating to those which aren't.
+  ImGuiWindow* window = ImGui::GetCurrentWindow();
+  const u32 entry_count = static_cast<u32>(s_game_list_sorted_entries.size());
+  if (grid_count_x > 0 && !window->SkipItems)
   {
-    ImGuiWindow* window = ImGui::GetCurrentWindow();
-    if (window->SkipItems)
-      continue;
+    ImGui::SetCursorPos(ImVec2(start_x, 0.0f));
 
-    const ImGuiID id = window->GetID(entry->path.c_str(), entry->path.c_str() + entry->path.length());
-    const ImVec2 pos(window->DC.CursorPos);
-    ImRect bb(pos, pos + item_size);
-    ImGui::ItemSize(item_size);
-    if (ImGui::ItemAdd(bb, id))
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>((entry_count + (grid_count_x - 1)) / grid_count_x));
+    u32 visible_start_row = 0, visible_end_row = 0;
+    while (clipper.Step())
     {
-      bool held;
-      bool hovered;
-      bool pressed = ImGui::ButtonBehavior(bb, id, &hovered, &held, 0);
-      if (hovered)
+      visible_start_row = static_cast<u32>(clipper.DisplayStart);
+      visible_end_row = static_cast<u32>(clipper.DisplayEnd);
+      for (u32 row = visible_start_row; row < visible_end_row; row++)
       {
-        const ImU32 col = ImGui::GetColorU32(held ? ImGuiCol_ButtonActive : ImGuiCol_ButtonHovered, 1.0f);
+        ImGui::SetCursorPosX(start_x);
+        for (u32 grid_x = 0, index = row * grid_count_x; grid_x < grid_count_x && index < entry_count;
+             grid_x++, index++)
+        {
+          if (grid_x > 0)
+            ImGui::SameLine(start_x + static_cast<float>(grid_x) * (item_width + item_spacing));
+
+          const GameList::Entry* entry = s_game_list_sorted_entries[index];
+          const ImGuiID id = window->GetID(entry->path.c_str(), entry->path.c_str() + entry->path.length());
+          const ImVec2 pos(window->DC.CursorPos);
+          ImRect bb(pos, pos + item_size);
+          ImGui::ItemSize(item_size);
+          if (ImGui::ItemAdd(bb, id))
+          {
+            bool held;
+            bool hovered;
+            bool pressed = ImGui::ButtonBehavior(bb, id, &hovered, &held, 0);
+            if (hovered)
+            {
+              const ImU32 col = ImGui::GetColorU32(held ? ImGuiCol_ButtonActive : ImGuiCol_ButtonHovered, 1.0f);
 
-        const float t = static_cast<float>(std::min(std::abs(std::sin(ImGui::GetTime() * 0.75) * 1.1), 1.0));
-        ImGui::PushStyleColor(ImGuiCol_Border, ImGui::GetColorU32(ImGuiCol_Border, t));
+              const float t = static_cast<float>(std::min(std::abs(std::sin(ImGui::GetTime() * 0.75) * 1.1), 1.0));
+              ImGui::PushStyleColor(ImGuiCol_Border, ImGui::GetColorU32(ImGuiCol_Border, t));
 
-        ImGui::RenderFrame(bb.Min, bb.Max, col, true, 0.0f);
+              ImGui::RenderFrame(bb.Min, bb.Max, col, true, 0.0f);
 
-        ImGui::PopStyleColor();
-      }
+              ImGui::PopStyleColor();
+            }
 
-      bb.Min += style.FramePadding;
-      bb.Max -= style.FramePadding;
+            bb.Min += style.FramePadding;
+            bb.Max -= style.FramePadding;
 
-      GPUTexture* const cover_texture = GetGameListCover(entry);
-      const ImRect image_rect(
-        CenterImage(ImRect(bb.Min, bb.Min + image_size), ImVec2(static_cast<float>(cover_texture->GetWidth()),
-                                                                static_cast<float>(cover_texture->GetHeight()))));
+            GPUTexture* const cover_texture = GetGameListCover(entry);
+            const ImRect image_rect(
+              CenterImage(ImRect(bb.Min, bb.Min + image_size), ImVec2(static_cast<float>(cover_texture->GetWidth()),
+                                                                      static_cast<float>(cover_texture->GetHeight()))));
 
-      ImGui::GetWindowDrawList()->AddImage(cover_texture, image_rect.Min, image_rect.Max, ImVec2(0.0f, 0.0f),
-                                           ImVec2(1.0f, 1.0f), IM_COL32(255, 255, 255, 255));
+            ImGui::GetWindowDrawList()->AddImage(cover_texture, image_rect.Min, image_rect.Max, ImVec2(0.0f, 0.0f),
+                                                 ImVec2(1.0f, 1.0f), IM_COL32(255, 255, 255, 255));
 
-      const ImRect title_bb(ImVec2(bb.Min.x, bb.Min.y + image_height + title_spacing), bb.Max);
-      const std::string_view title(
-        std::string_view(entry->title).substr(0, (entry->title.length() > 31) ? 31 : std::string_view::npos));
-      draw_title.fmt("{}{}", title, (title.length() == entry->title.length()) ? "" : "...");
-      ImGui::PushFont(g_medium_font);
-      ImGui::RenderTextClipped(title_bb.Min, title_bb.Max, draw_title.c_str(), draw_title.end_ptr(), nullptr,
-                               ImVec2(0.5f, 0.0f), &title_bb);
-      ImGui::PopFont();
+            const ImRect title_bb(ImVec2(bb.Min.x, bb.Min.y + image_height + title_spacing), bb.Max);
+            const std::string_view title(
+              std::string_view(entry->title).substr(0, (entry->title.length() > 31) ? 31 : std::string_view::npos));
+            draw_title.fmt("{}{}", title, (title.length() == entry->title.length()) ? "" : "...");
+            ImGui::PushFont(g_medium_font);
+            ImGui::RenderTextClipped(title_bb.Min, title_bb.Max, draw_title.c_str(), draw_title.end_ptr(), nullptr,
+                                     ImVec2(0.5f, 0.0f), &title_bb);
+            ImGui::PopFont();
 
-      if (pressed)
-        HandleGameListActivate(entry);
+            if (pressed)
+              HandleGameListActivate(entry);
 
-      if (hovered && (ImGui::IsItemClicked(ImGuiMouseButton_Right) ||
-                      ImGui::IsNavInputTest(ImGuiNavInput_Input, ImGuiNavReadMode_Pressed)))
-      {
-        HandleGameListOptions(entry);
+            if (hovered && (ImGui::IsItemClicked(ImGuiMouseButton_Right) ||
+                            ImGui::IsNavInputTest(ImGuiNavInput_Input, ImGuiNavReadMode_Pressed)))
+            {
+              HandleGameListOptions(entry);
+            }
+          }
+        }
+
+        ImGui::SetCursorPosY(ImGui::GetCursorPosY() + item_spacing);
       }
     }
 
-    grid_x++;
-    if (grid_x == grid_count_x)
-    {
-      grid_x = 0;
-      ImGui::SetCursorPosX(start_x);
-      ImGui::SetCursorPosY(ImGui::GetCursorPosY() + item_spacing);
-    }
-    else
-    {
-      ImGui::SameLine(start_x + static_cast<float>(grid_x) * (item_width + item_spacing));
-    }
+    const u32 prefetch_start_row =
+      (visible_start_row > GAME_LIST_PREFETCH_ROWS) ? (visible_start_row - GAME_LIST_PREFETCH_ROWS) : 0;
+    PrefetchGameListCovers(prefetch_start_row * grid_count_x,
+                           (visible_end_row + GAME_LIST_PREFETCH_ROWS) * grid_count_x);
   }
 
   EndMenuButtons();
@@ -6312,6 +6414,14 @@ GPUTexture* FullscreenUI::GetGameListCover(const GameList::Entry* entry)
   return tex ? tex : GetTextureForGameListEntryType(entry->type);
 }
 
+void FullscreenUI::PrefetchGameListCovers(u32 start, u32 end)
+{
+  // Queues the load, so the cover is ready by the time it scrolls into view.
+  const u32 count = static_cast<u32>(s_game_list_sorted_entries.size());
+  for (u32 i = start; i < std::min(end, count); i++)
+    GetGameListCover(s_game_list_sorted_entries[i]);
+}
+
 GPUTexture* FullscreenUI::GetTextureForGameListEntryType(GameList::EntryType type)
 {
   switch (type)
@@ -6807,6 +6917,7 @@ TRANSLATE_NOOP("FullscreenUI", "Behavior");
 TRANSLATE_NOOP("FullscreenUI", "Borderless Fullscreen");
 TRANSLATE_NOOP("FullscreenUI", "Buffer Size");
 TRANSLATE_NOOP("FullscreenUI", "CD-ROM Emulation");
+TRANSLATE_NOOP("FullscreenUI", "CHD Hunk Cache Size");
 TRANSLATE_NOOP("FullscreenUI", "CPU Emulation");
 TRANSLATE_NOOP("FullscreenUI", "CPU Mode");
 TRANSLATE_NOOP("FullscreenUI", "Cancel");
@@ -6846,6 +6957,7 @@ TRANSLATE_NOOP("FullscreenUI", "Copies the current global settings to this game.
 TRANSLATE_NOOP("FullscreenUI", "Copies the global controller configuration to this game.");
 TRANSLATE_NOOP("FullscreenUI", "Copy Global Settings");
 TRANSLATE_NOOP("FullscreenUI", "Copy Settings");
+TRANSLATE_NOOP("FullscreenUI", "Counts executions and host time for each recompiled block, and writes a report of the hottest blocks when the system shuts down. Slows down emulation.");
 TRANSLATE_NOOP("FullscreenUI", "Cover Settings");
 TRANSLATE_NOOP("FullscreenUI", "Covers Directory");
 TRANSLATE_NOOP("FullscreenUI", "Create");
@@ -6856,6 +6968,7 @@ TRANSLATE_NOOP("FullscreenUI", "Crop Mode");
 TRANSLATE_NOOP("FullscreenUI", "Culling Correction");
 TRANSLATE_NOOP("FullscreenUI", "Current Game");
 TRANSLATE_NOOP("FullscreenUI", "Debugging Settings");
+TRANSLATE_NOOP("FullscreenUI", "Decodes all replacement textures in the background, reducing stuttering at runtime.");
 TRANSLATE_NOOP("FullscreenUI", "Default");
 TRANSLATE_NOOP("FullscreenUI", "Default Boot");
 TRANSLATE_NOOP("FullscreenUI", "Default View");
@@ -6866,6 +6979,7 @@ TRANSLATE_NOOP("FullscreenUI", "Delete State");
 TRANSLATE_NOOP("FullscreenUI", "Depth Buffer");
 TRANSLATE_NOOP("FullscreenUI", "Details");
 TRANSLATE_NOOP("FullscreenUI", "Details unavailable for game not scanned in game list.");
+TRANSLATE_NOOP("FullscreenUI", "Detects loops which poll memory without side effects, and skips ahead to the next event instead of running them. Reduces host CPU usage, only supported by the new recompiler.");
 TRANSLATE_NOOP("FullscreenUI", "Determines how large the on-screen messages and monitor are.");
 TRANSLATE_NOOP("FullscreenUI", "Determines how much latency there is between the audio being picked up by the host API, and played through speakers.");
 TRANSLATE_NOOP("FullscreenUI", "Determines how much of the area typically not visible on a consumer TV set to crop/hide.");
@@ -6898,6 +7012,7 @@ TRANSLATE_NOOP("FullscreenUI", "Duck icon by icons8 (https://icons8.com/icon/748
 TRANSLATE_NOOP("FullscreenUI", "DuckStation can automatically download covers for games which do not currently have a cover set. We do not host any cover images, the user must provide their own source for images.");
 TRANSLATE_NOOP("FullscreenUI", "DuckStation is a free and open-source simulator/emulator of the Sony PlayStation(TM) console, focusing on playability, speed, and long-term maintainability.");
 TRANSLATE_NOOP("FullscreenUI", "Dump Replaceable VRAM Writes");
+TRANSLATE_NOOP("FullscreenUI", "Dynamic Resolution");
 TRANSLATE_NOOP("FullscreenUI", "Emulation Settings");
 TRANSLATE_NOOP("FullscreenUI", "Emulation Speed");
 TRANSLATE_NOOP("FullscreenUI", "Enable 8MB RAM");
@@ -6908,8 +7023,11 @@ TRANSLATE_NOOP("FullscreenUI", "Enable In-Game Overlays");
 TRANSLATE_NOOP("FullscreenUI", "Enable Overclocking");
 TRANSLATE_NOOP("FullscreenUI", "Enable PGXP Vertex Cache");
 TRANSLATE_NOOP("FullscreenUI", "Enable Post Processing");
+TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Block Cache");
 TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Block Linking");
+TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Block Profiling");
 TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler ICache");
+TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Idle Loop Skipping");
 TRANSLATE_NOOP("FullscreenUI", "Enable Recompiler Memory Exceptions");
 TRANSLATE_NOOP("FullscreenUI", "Enable Region Check");
 TRANSLATE_NOOP("FullscreenUI", "Enable Rewinding");
@@ -6977,6 +7095,7 @@ TRANSLATE_NOOP("FullscreenUI", "Genre: %s");
 TRANSLATE_NOOP("FullscreenUI", "GitHub Repository");
 TRANSLATE_NOOP("FullscreenUI", "Global Slot {0} - {1}##global_slot_{0}");
 TRANSLATE_NOOP("FullscreenUI", "Global Slot {0}##global_slot_{0}");
+TRANSLATE_NOOP("FullscreenUI", "Greatly reduces the GPU memory used by rewind at high resolution scales.");
 TRANSLATE_NOOP("FullscreenUI", "Hardcore Mode");
 TRANSLATE_NOOP("FullscreenUI", "Hardcore mode will be enabled on next game restart.");
 TRANSLATE_NOOP("FullscreenUI", "Hide Cursor In Fullscreen");
@@ -6995,6 +7114,7 @@ TRANSLATE_NOOP("FullscreenUI", "Inhibit Screensaver");
 TRANSLATE_NOOP("FullscreenUI", "Input Sources");
 TRANSLATE_NOOP("FullscreenUI", "Input profile '{}' loaded.");
 TRANSLATE_NOOP("FullscreenUI", "Input profile '{}' saved.");
+TRANSLATE_NOOP("FullscreenUI", "Instances preloading the same disc share one copy of it, rather than each holding their own.");
 TRANSLATE_NOOP("FullscreenUI", "Integration");
 TRANSLATE_NOOP("FullscreenUI", "Interface Settings");
 TRANSLATE_NOOP("FullscreenUI", "Internal Resolution Scale");
@@ -7004,6 +7124,7 @@ TRANSLATE_NOOP("FullscreenUI", "Last Played");
 TRANSLATE_NOOP("FullscreenUI", "Last Played: %s");
 TRANSLATE_NOOP("FullscreenUI", "Launch a game by selecting a file/disc image.");
 TRANSLATE_NOOP("FullscreenUI", "Launch a game from images scanned from your game directories.");
+TRANSLATE_NOOP("FullscreenUI", "Lazy Pipeline Compilation");
 TRANSLATE_NOOP("FullscreenUI", "Leaderboard Notifications");
 TRANSLATE_NOOP("FullscreenUI", "Leaderboards");
 TRANSLATE_NOOP("FullscreenUI", "Leaderboards are not enabled.");
@@ -7013,7 +7134,6 @@ TRANSLATE_NOOP("FullscreenUI", "Load Profile");
 TRANSLATE_NOOP("FullscreenUI", "Load Resume State");
 TRANSLATE_NOOP("FullscreenUI", "Load State");
 TRANSLATE_NOOP("FullscreenUI", "Loads a global save state.");
-TRANSLATE_NOOP("FullscreenUI", "Loads all replacement texture to RAM, reducing stuttering at runtime.");
 TRANSLATE_NOOP("FullscreenUI", "Loads the game image into RAM. Useful for network paths that may become unreliable during gameplay.");
 TRANSLATE_NOOP("FullscreenUI", "Log Level");
 TRANSLATE_NOOP("FullscreenUI", "Log To Debug Console");
@@ -7030,6 +7150,7 @@ TRANSLATE_NOOP("FullscreenUI", "Logs messages to duckstation.log in the user dir
 TRANSLATE_NOOP("FullscreenUI", "Logs messages to the console window.");
 TRANSLATE_NOOP("FullscreenUI", "Logs messages to the debug console where supported.");
 TRANSLATE_NOOP("FullscreenUI", "Logs out of RetroAchievements.");
+TRANSLATE_NOOP("FullscreenUI", "Lowers the resolution scale in demanding scenes to stay at full speed, and raises it again up to the selected scale.");
 TRANSLATE_NOOP("FullscreenUI", "Macro will toggle every {} frames.");
 TRANSLATE_NOOP("FullscreenUI", "Macro {} Buttons");
 TRANSLATE_NOOP("FullscreenUI", "Macro {} Frequency");
@@ -7061,9 +7182,12 @@ TRANSLATE_NOOP("FullscreenUI", "None (Double Speed)");
 TRANSLATE_NOOP("FullscreenUI", "None (Normal Speed)");
 TRANSLATE_NOOP("FullscreenUI", "Not Logged In");
 TRANSLATE_NOOP("FullscreenUI", "Not Scanning Subdirectories");
+TRANSLATE_NOOP("FullscreenUI", "Number of decompressed CHD hunks kept in memory, which avoids decompressing them again after seeks. Applies to discs opened after changing.");
 TRANSLATE_NOOP("FullscreenUI", "OK");
 TRANSLATE_NOOP("FullscreenUI", "OSD Scale");
 TRANSLATE_NOOP("FullscreenUI", "On-Screen Display");
+TRANSLATE_NOOP("FullscreenUI", "Only compiles the rendering pipelines which are used, remembering them for next time.");
+TRANSLATE_NOOP("FullscreenUI", "Only draws displayed frames while fast forwarding. Areas which weren't drawn are filled in by the software renderer.");
 TRANSLATE_NOOP("FullscreenUI", "Open in File Browser");
 TRANSLATE_NOOP("FullscreenUI", "Operations");
 TRANSLATE_NOOP("FullscreenUI", "Optimal Frame Pacing");
@@ -7105,9 +7229,11 @@ TRANSLATE_NOOP("FullscreenUI", "Provides vibration and LED control support over
 TRANSLATE_NOOP("FullscreenUI", "Push a controller button or axis now.");
 TRANSLATE_NOOP("FullscreenUI", "Quick Save");
 TRANSLATE_NOOP("FullscreenUI", "RAIntegration is being used instead of the built-in achievements implementation.");
+TRANSLATE_NOOP("FullscreenUI", "Rasterizer Worker Threads");
 TRANSLATE_NOOP("FullscreenUI", "Read Speedup");
 TRANSLATE_NOOP("FullscreenUI", "Readahead Sectors");
 TRANSLATE_NOOP("FullscreenUI", "Recompiler Fast Memory Access");
+TRANSLATE_NOOP("FullscreenUI", "Reduce Input Latency");
 TRANSLATE_NOOP("FullscreenUI", "Reduces \"wobbly\" polygons by attempting to preserve the fractional component through memory transfers.");
 TRANSLATE_NOOP("FullscreenUI", "Reduces hitches in emulation by reading/decompressing CD data asynchronously on a worker thread.");
 TRANSLATE_NOOP("FullscreenUI", "Reduces polygon Z-fighting through depth testing. Low compatibility with games.");
@@ -7116,6 +7242,7 @@ TRANSLATE_NOOP("FullscreenUI", "Region: ");
 TRANSLATE_NOOP("FullscreenUI", "Release Date: %s");
 TRANSLATE_NOOP("FullscreenUI", "Reload Shaders");
 TRANSLATE_NOOP("FullscreenUI", "Reloads the shaders from disk, applying any changes.");
+TRANSLATE_NOOP("FullscreenUI", "Remembers compiled blocks across sessions, and compiles them when booting or loading states instead of when they're first executed.");
 TRANSLATE_NOOP("FullscreenUI", "Remove From Chain");
 TRANSLATE_NOOP("FullscreenUI", "Remove From List");
 TRANSLATE_NOOP("FullscreenUI", "Removed stage {} ({}).");
@@ -7140,6 +7267,7 @@ TRANSLATE_NOOP("FullscreenUI", "Rewind for {0} frames, lasting {1:.2f} seconds w
 TRANSLATE_NOOP("FullscreenUI", "Rich presence inactive or unsupported.");
 TRANSLATE_NOOP("FullscreenUI", "Runahead");
 TRANSLATE_NOOP("FullscreenUI", "Runahead/Rewind");
+TRANSLATE_NOOP("FullscreenUI", "Runs emulation threads on performance cores, and background work on efficiency cores.");
 TRANSLATE_NOOP("FullscreenUI", "Runs the software renderer in parallel for VRAM readbacks. On some systems, this may result in greater performance.");
 TRANSLATE_NOOP("FullscreenUI", "SDL DualShock 4 / DualSense Enhanced Mode");
 TRANSLATE_NOOP("FullscreenUI", "Save Profile");
@@ -7180,6 +7308,7 @@ TRANSLATE_NOOP("FullscreenUI", "Setting {} binding {}.");
 TRANSLATE_NOOP("FullscreenUI", "Settings");
 TRANSLATE_NOOP("FullscreenUI", "Settings and Operations");
 TRANSLATE_NOOP("FullscreenUI", "Shader {} added as stage {}.");
+TRANSLATE_NOOP("FullscreenUI", "Share Preloaded Images");
 TRANSLATE_NOOP("FullscreenUI", "Shared Card Name");
 TRANSLATE_NOOP("FullscreenUI", "Show CPU Usage");
 TRANSLATE_NOOP("FullscreenUI", "Show Controller Input");
@@ -7207,6 +7336,7 @@ TRANSLATE_NOOP("FullscreenUI", "Simulates the region check present in original,
 TRANSLATE_NOOP("FullscreenUI", "Simulates the system ahead of time and rolls back/replays to reduce input lag. Very high system requirements.");
 TRANSLATE_NOOP("FullscreenUI", "Size");
 TRANSLATE_NOOP("FullscreenUI", "Size: %.2f MB");
+TRANSLATE_NOOP("FullscreenUI", "Skip Rendering When Fast Forwarding");
 TRANSLATE_NOOP("FullscreenUI", "Slow Boot");
 TRANSLATE_NOOP("FullscreenUI", "Smooths out blockyness between colour transitions in 24-bit content, usually FMVs. Only applies to the hardware renderers.");
 TRANSLATE_NOOP("FullscreenUI", "Smooths out the blockiness of magnified textures on 3D objects.");
@@ -7217,13 +7347,16 @@ TRANSLATE_NOOP("FullscreenUI", "Spectator Mode");
 TRANSLATE_NOOP("FullscreenUI", "Speed Control");
 TRANSLATE_NOOP("FullscreenUI", "Speeds up CD-ROM reads by the specified factor. May improve loading speeds in some games, and break others.");
 TRANSLATE_NOOP("FullscreenUI", "Speeds up CD-ROM seeks by the specified factor. May improve loading speeds in some games, and break others.");
+TRANSLATE_NOOP("FullscreenUI", "Splits the screen into tiles which are drawn in parallel by additional threads. 0 disables.");
 TRANSLATE_NOOP("FullscreenUI", "Stage {}: {}");
 TRANSLATE_NOOP("FullscreenUI", "Start BIOS");
 TRANSLATE_NOOP("FullscreenUI", "Start Download");
 TRANSLATE_NOOP("FullscreenUI", "Start File");
 TRANSLATE_NOOP("FullscreenUI", "Start Fullscreen");
 TRANSLATE_NOOP("FullscreenUI", "Start the console without any disc inserted.");
+TRANSLATE_NOOP("FullscreenUI", "Starts each frame as late as possible, so input is read closer to when it is displayed. Disable if you get stutter.");
 TRANSLATE_NOOP("FullscreenUI", "Starts the console from where it was before it was last closed.");
+TRANSLATE_NOOP("FullscreenUI", "Store Rewind VRAM At Native Resolution");
 TRANSLATE_NOOP("FullscreenUI", "Stores the current settings to an input profile.");
 TRANSLATE_NOOP("FullscreenUI", "Stretch Display Vertically");
 TRANSLATE_NOOP("FullscreenUI", "Stretch Mode");
@@ -7244,6 +7377,7 @@ TRANSLATE_NOOP("FullscreenUI", "The audio backend determines how frames produced
 TRANSLATE_NOOP("FullscreenUI", "The selected memory card image will be used in shared mode for this slot.");
 TRANSLATE_NOOP("FullscreenUI", "This game has no achievements.");
 TRANSLATE_NOOP("FullscreenUI", "This game has no leaderboards.");
+TRANSLATE_NOOP("FullscreenUI", "Thread Core Placement");
 TRANSLATE_NOOP("FullscreenUI", "Threaded Presentation");
 TRANSLATE_NOOP("FullscreenUI", "Threaded Rendering");
 TRANSLATE_NOOP("FullscreenUI", "Time Played");
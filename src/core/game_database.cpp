@@ -10,19 +10,30 @@
 
 #include "common/assert.h"
 #include "common/byte_stream.h"
+#include "common/file_system.h"
 #include "common/heterogeneous_containers.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 #include "common/timer.h"
+#include "common/trace_recorder.h"
 
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 
+#include "xxhash.h"
+
+#include <atomic>
+#include <cstring>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <sstream>
+#include <thread>
 
 Log_SetChannel(GameDatabase);
 
@@ -35,17 +46,111 @@ namespace GameDatabase {
 enum : u32
 {
   GAME_DATABASE_CACHE_SIGNATURE = 0x45434C48,
-  GAME_DATABASE_CACHE_VERSION = 5,
+  GAME_DATABASE_CACHE_VERSION = 6,
+};
+
+// The cache file is used in-place, and entries are only decoded when they're looked up, since most sessions only
+// touch a handful of them. It consists of a header, fixed-size entry records, code records, string refs for the disc
+// set serials, open-addressed hash tables of code/record indices keyed by code and serial, and the string table.
+// Strings are interned, since the same genre/developer/publisher is shared by many entries.
+struct CacheHeader
+{
+  u32 signature;
+  u32 version;
+  u64 gamedb_timestamp;
+  u32 record_count;
+  u32 code_count;
+  u32 disc_set_serial_count;
+  u32 code_index_size;   // power of two, entries are code index + 1, zero for an empty bucket
+  u32 serial_index_size; // power of two, entries are record index + 1, zero for an empty bucket
+  u32 codes_offset;
+  u32 disc_set_serials_offset;
+  u32 code_index_offset;
+  u32 serial_index_offset;
+  u32 strings_offset;
+  u32 strings_size;
+  u32 pad;
+};
+
+struct CacheStringRef
+{
+  u32 offset;
+  u32 length;
+};
+
+enum : u16
+{
+  CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET = (1 << 0),
+  CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET = (1 << 1),
+  CACHE_HAS_DISPLAY_LINE_START_OFFSET = (1 << 2),
+  CACHE_HAS_DISPLAY_LINE_END_OFFSET = (1 << 3),
+  CACHE_HAS_DMA_MAX_SLICE_TICKS = (1 << 4),
+  CACHE_HAS_DMA_HALT_TICKS = (1 << 5),
+  CACHE_HAS_GPU_FIFO_SIZE = (1 << 6),
+  CACHE_HAS_GPU_MAX_RUN_AHEAD = (1 << 7),
+  CACHE_HAS_GPU_PGXP_TOLERANCE = (1 << 8),
+  CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD = (1 << 9),
+};
+
+struct CacheRecord
+{
+  u64 serial_hash;
+  u64 release_date;
+  CacheStringRef serial;
+  CacheStringRef title;
+  CacheStringRef genre;
+  CacheStringRef developer;
+  CacheStringRef publisher;
+  CacheStringRef disc_set_name;
+  u32 disc_set_serials_start;
+  u32 disc_set_serials_count;
+  u32 dma_max_slice_ticks;
+  u32 dma_halt_ticks;
+  u32 gpu_fifo_size;
+  u32 gpu_max_run_ahead;
+  float gpu_pgxp_tolerance;
+  float gpu_pgxp_depth_threshold;
+  s16 display_active_start_offset;
+  s16 display_active_end_offset;
+  s8 display_line_start_offset;
+  s8 display_line_end_offset;
+  u16 supported_controllers;
+  u16 optional_fields; // CACHE_HAS_xxx for each of the optional fields which has a value
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u8 compatibility;
+  u8 traits[3];
+  u8 pad[6];
+};
+
+struct CacheCode
+{
+  u64 code_hash;
+  CacheStringRef code;
+  u32 record_index;
+  u32 pad;
 };
 
-static Entry* GetMutableEntry(const std::string_view& serial);
+static_assert(sizeof(CacheHeader) == 64 && sizeof(CacheRecord) == 120 && sizeof(CacheCode) == 24);
+static_assert(static_cast<u32>(Trait::Count) <= (sizeof(CacheRecord::traits) * 8));
 
 static bool LoadFromCache();
+static void ReleaseCache();
+static bool ValidateCache(u64 gamedb_ts);
+static void BuildCache(const std::vector<Entry>& entries, const PreferUnorderedStringMap<u32>& code_lookup,
+                       u64 gamedb_ts);
 static bool SaveToCache();
+static CacheHeader GetCacheHeader();
+static u64 GetCacheKeyHash(std::string_view key);
+static std::string_view GetCacheString(const CacheHeader& header, const CacheStringRef& ref);
+static bool ReadCacheRecord(const CacheHeader& header, const CacheRecord& record, Entry* entry);
+static const Entry* GetCacheEntry(const CacheHeader& header, u32 record_index);
 
-static bool LoadGameDBJson();
+static bool LoadGameDBJson(std::vector<Entry>* entries, PreferUnorderedStringMap<u32>* code_lookup);
 static bool ParseJsonEntry(Entry* entry, const rapidjson::Value& value);
-static bool ParseJsonCodes(u32 index, const rapidjson::Value& value);
+static bool ParseJsonCodes(PreferUnorderedStringMap<u32>* code_lookup, u32 index, const rapidjson::Value& value);
 static bool LoadTrackHashes();
 
 std::array<const char*, static_cast<u32>(GameDatabase::Trait::Count)> s_trait_names = {{
@@ -71,41 +176,88 @@ std::array<const char*, static_cast<u32>(GameDatabase::Trait::Count)> s_trait_na
   "IsLibCryptProtected",
 }};
 
-static bool s_loaded = false;
+static std::atomic_bool s_loaded{false};
+static std::mutex s_load_mutex;
+static std::thread s_background_load_thread;
 static bool s_track_hashes_loaded = false;
 
-static std::vector<GameDatabase::Entry> s_entries;
-static PreferUnorderedStringMap<u32> s_code_lookup;
+// Points at the mapped cache file, so that instances sharing a data directory also share its pages, or at
+// s_cache_data when the cache has just been built.
+static std::span<const u8> s_cache;
+static std::vector<u8> s_cache_data;
+static void* s_cache_mapping = nullptr;
+static size_t s_cache_mapping_size = 0;
+static std::vector<std::unique_ptr<Entry>> s_cache_entries;
+static std::mutex s_cache_entries_mutex;
 
 static TrackHashesMap s_track_hashes_map;
 } // namespace GameDatabase
 
 void GameDatabase::EnsureLoaded()
 {
-  if (s_loaded)
+  if (s_loaded.load(std::memory_order_acquire))
     return;
 
-  Common::Timer timer;
+  std::unique_lock lock(s_load_mutex);
+  if (s_loaded.load(std::memory_order_relaxed))
+    return;
 
-  s_loaded = true;
+  TRACE_SCOPE("GameDatabase::EnsureLoaded");
+  Common::Timer timer;
 
   if (!LoadFromCache())
   {
-    s_entries = {};
-    s_code_lookup = {};
+    ReleaseCache();
 
-    LoadGameDBJson();
-    SaveToCache();
+    std::vector<Entry> entries;
+    PreferUnorderedStringMap<u32> code_lookup;
+    if (LoadGameDBJson(&entries, &code_lookup))
+    {
+      BuildCache(entries, code_lookup, Host::GetResourceFileTimestamp("gamedb.json").value_or(0));
+      SaveToCache();
+    }
   }
 
+  if (!s_cache.empty())
+    s_cache_entries.resize(GetCacheHeader().record_count);
+
+  s_loaded.store(true, std::memory_order_release);
   Log_InfoPrintf("Database load took %.2f ms", timer.GetTimeMilliseconds());
 }
 
+void GameDatabase::StartBackgroundLoad()
+{
+  if (s_loaded.load(std::memory_order_acquire) || s_background_load_thread.joinable())
+    return;
+
+  s_background_load_thread = std::thread([]() {
+    Threading::SetNameOfCurrentThread("Game Database Loader");
+    EnsureLoaded();
+  });
+}
+
 void GameDatabase::Unload()
 {
-  s_entries = {};
-  s_code_lookup = {};
-  s_loaded = false;
+  if (s_background_load_thread.joinable())
+    s_background_load_thread.join();
+
+  std::unique_lock lock(s_load_mutex);
+  s_cache_entries.clear();
+  s_cache_entries.shrink_to_fit();
+  ReleaseCache();
+  s_loaded.store(false, std::memory_order_release);
+}
+
+void GameDatabase::ReleaseCache()
+{
+  s_cache = {};
+  s_cache_data = {};
+  if (s_cache_mapping)
+  {
+    MemMap::UnmapFile(s_cache_mapping, s_cache_mapping_size);
+    s_cache_mapping = nullptr;
+    s_cache_mapping_size = 0;
+  }
 }
 
 const GameDatabase::Entry* GameDatabase::GetEntryForId(const std::string_view& code)
@@ -114,9 +266,29 @@ const GameDatabase::Entry* GameDatabase::GetEntryForId(const std::string_view& c
     return nullptr;
 
   EnsureLoaded();
+  if (s_cache.empty())
+    return nullptr;
+
+  const CacheHeader header = GetCacheHeader();
+  const u8* codes = s_cache.data() + header.codes_offset;
+  const u8* index = s_cache.data() + header.code_index_offset;
+  const u64 code_hash = GetCacheKeyHash(code);
+  const u32 index_mask = header.code_index_size - 1;
+  for (u32 bucket = static_cast<u32>(code_hash) & index_mask, probes = 0; probes < header.code_index_size;
+       bucket = (bucket + 1) & index_mask, probes++)
+  {
+    u32 slot;
+    std::memcpy(&slot, index + (bucket * sizeof(u32)), sizeof(slot));
+    if (slot == 0)
+      break;
+
+    CacheCode cache_code;
+    std::memcpy(&cache_code, codes + ((slot - 1) * sizeof(CacheCode)), sizeof(cache_code));
+    if (cache_code.code_hash == code_hash && GetCacheString(header, cache_code.code) == code)
+      return GetCacheEntry(header, cache_code.record_index);
+  }
 
-  auto iter = s_code_lookup.find(code);
-  return (iter != s_code_lookup.end()) ? &s_entries[iter->second] : nullptr;
+  return nullptr;
 }
 
 std::string GameDatabase::GetSerialForDisc(CDImage* image)
@@ -162,16 +334,27 @@ const GameDatabase::Entry* GameDatabase::GetEntryForDisc(CDImage* image)
 const GameDatabase::Entry* GameDatabase::GetEntryForSerial(const std::string_view& serial)
 {
   EnsureLoaded();
+  if (s_cache.empty())
+    return nullptr;
 
-  return GetMutableEntry(serial);
-}
-
-GameDatabase::Entry* GameDatabase::GetMutableEntry(const std::string_view& serial)
-{
-  for (Entry& entry : s_entries)
+  // serials aren't unique, the first entry in the database wins
+  const CacheHeader header = GetCacheHeader();
+  const u8* records = s_cache.data() + sizeof(CacheHeader);
+  const u8* index = s_cache.data() + header.serial_index_offset;
+  const u64 serial_hash = GetCacheKeyHash(serial);
+  const u32 index_mask = header.serial_index_size - 1;
+  for (u32 bucket = static_cast<u32>(serial_hash) & index_mask, probes = 0; probes < header.serial_index_size;
+       bucket = (bucket + 1) & index_mask, probes++)
   {
-    if (entry.serial == serial)
-      return &entry;
+    u32 slot;
+    std::memcpy(&slot, index + (bucket * sizeof(u32)), sizeof(slot));
+    if (slot == 0)
+      break;
+
+    CacheRecord record;
+    std::memcpy(&record, records + ((slot - 1) * sizeof(CacheRecord)), sizeof(record));
+    if (record.serial_hash == serial_hash && GetCacheString(header, record.serial) == serial)
+      return GetCacheEntry(header, slot - 1);
   }
 
   return nullptr;
@@ -483,37 +666,6 @@ void GameDatabase::Entry::ApplySettings(Settings& settings, bool display_osd_mes
 #undef BIT_FOR
 }
 
-template<typename T>
-bool ReadOptionalFromStream(ByteStream* stream, std::optional<T>* dest)
-{
-  bool has_value;
-  if (!stream->Read2(&has_value, sizeof(has_value)))
-    return false;
-
-  if (!has_value)
-    return true;
-
-  T value;
-  if (!stream->Read2(&value, sizeof(T)))
-    return false;
-
-  *dest = value;
-  return true;
-}
-
-template<typename T>
-bool WriteOptionalToStream(ByteStream* stream, const std::optional<T>& src)
-{
-  const bool has_value = src.has_value();
-  if (!stream->Write2(&has_value, sizeof(has_value)))
-    return false;
-
-  if (!has_value)
-    return true;
-
-  return stream->Write2(&src.value(), sizeof(T));
-}
-
 static std::string GetCacheFile()
 {
   return Path::Combine(EmuFolders::Cache, "gamedb.cache");
@@ -521,176 +673,356 @@ static std::string GetCacheFile()
 
 bool GameDatabase::LoadFromCache()
 {
-  std::unique_ptr<ByteStream> stream(
-    ByteStream::OpenFile(GetCacheFile().c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED));
-  if (!stream)
+  s_cache_mapping = MemMap::MapFileReadOnly(GetCacheFile().c_str(), &s_cache_mapping_size);
+  if (!s_cache_mapping)
   {
     Log_DevPrintf("Cache does not exist, loading full database.");
     return false;
   }
 
-  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.json").value_or(0);
+  s_cache = std::span<const u8>(static_cast<const u8*>(s_cache_mapping), s_cache_mapping_size);
+  return ValidateCache(Host::GetResourceFileTimestamp("gamedb.json").value_or(0));
+}
 
-  u32 signature, version, num_entries, num_codes;
-  u64 file_gamedb_ts;
-  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU64(&file_gamedb_ts) ||
-      !stream->ReadU32(&num_entries) || !stream->ReadU32(&num_codes) || signature != GAME_DATABASE_CACHE_SIGNATURE ||
-      version != GAME_DATABASE_CACHE_VERSION)
+bool GameDatabase::ValidateCache(u64 gamedb_ts)
+{
+  // only the layout is checked here, records are validated when they're decoded
+  CacheHeader header;
+  if (s_cache.size() < sizeof(header))
   {
     Log_DevPrintf("Cache header is corrupted or version mismatch.");
     return false;
   }
 
-  if (gamedb_ts != file_gamedb_ts)
+  std::memcpy(&header, s_cache.data(), sizeof(header));
+  if (header.signature != GAME_DATABASE_CACHE_SIGNATURE || header.version != GAME_DATABASE_CACHE_VERSION)
   {
-    Log_DevPrintf("Cache is out of date, recreating.");
+    Log_DevPrintf("Cache header is corrupted or version mismatch.");
     return false;
   }
 
-  s_entries.reserve(num_entries);
+  if (header.gamedb_timestamp != gamedb_ts)
+  {
+    Log_DevPrintf("Cache is out of date, recreating.");
+    return false;
+  }
 
-  for (u32 i = 0; i < num_entries; i++)
+  const auto is_valid_index_size = [](u32 size, u32 count) {
+    return (size != 0 && (size & (size - 1)) == 0 && size >= count);
+  };
+
+  const u64 codes_offset = sizeof(CacheHeader) + (static_cast<u64>(header.record_count) * sizeof(CacheRecord));
+  const u64 disc_set_serials_offset = codes_offset + (static_cast<u64>(header.code_count) * sizeof(CacheCode));
+  const u64 code_index_offset =
+    disc_set_serials_offset + (static_cast<u64>(header.disc_set_serial_count) * sizeof(CacheStringRef));
+  const u64 serial_index_offset = code_index_offset + (static_cast<u64>(header.code_index_size) * sizeof(u32));
+  const u64 strings_offset = serial_index_offset + (static_cast<u64>(header.serial_index_size) * sizeof(u32));
+  if (header.codes_offset != codes_offset || header.disc_set_serials_offset != disc_set_serials_offset ||
+      header.code_index_offset != code_index_offset || header.serial_index_offset != serial_index_offset ||
+      header.strings_offset != strings_offset ||
+      (static_cast<u64>(header.strings_offset) + header.strings_size) != s_cache.size() ||
+      !is_valid_index_size(header.code_index_size, header.code_count) ||
+      !is_valid_index_size(header.serial_index_size, header.record_count))
   {
-    Entry& entry = s_entries.emplace_back();
-
-    constexpr u32 num_bytes = (static_cast<u32>(Trait::Count) + 7) / 8;
-    std::array<u8, num_bytes> bits;
-    u8 compatibility;
-    u32 num_disc_set_serials;
-
-    if (!stream->ReadSizePrefixedString(&entry.serial) || !stream->ReadSizePrefixedString(&entry.title) ||
-        !stream->ReadSizePrefixedString(&entry.genre) || !stream->ReadSizePrefixedString(&entry.developer) ||
-        !stream->ReadSizePrefixedString(&entry.publisher) || !stream->ReadU64(&entry.release_date) ||
-        !stream->ReadU8(&entry.min_players) || !stream->ReadU8(&entry.max_players) ||
-        !stream->ReadU8(&entry.min_blocks) || !stream->ReadU8(&entry.max_blocks) ||
-        !stream->ReadU16(&entry.supported_controllers) || !stream->ReadU8(&compatibility) ||
-        compatibility >= static_cast<u8>(GameDatabase::CompatibilityRating::Count) ||
-        !stream->Read2(bits.data(), num_bytes) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_active_start_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_active_end_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_line_start_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.display_line_end_offset) ||
-        !ReadOptionalFromStream(stream.get(), &entry.dma_max_slice_ticks) ||
-        !ReadOptionalFromStream(stream.get(), &entry.dma_halt_ticks) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_fifo_size) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_max_run_ahead) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_pgxp_tolerance) ||
-        !ReadOptionalFromStream(stream.get(), &entry.gpu_pgxp_depth_threshold) ||
-        !stream->ReadSizePrefixedString(&entry.disc_set_name) || !stream->ReadU32(&num_disc_set_serials))
+    Log_DevPrintf("Cache layout is corrupted.");
+    return false;
+  }
+
+  const auto is_valid_index = [](const u8* index, u32 size, u32 count) {
+    for (u32 i = 0; i < size; i++)
     {
-      Log_DevPrintf("Cache entry is corrupted.");
-      return false;
+      u32 slot;
+      std::memcpy(&slot, index + (i * sizeof(u32)), sizeof(slot));
+      if (slot > count)
+        return false;
     }
 
-    if (num_disc_set_serials > 0)
+    return true;
+  };
+  if (!is_valid_index(s_cache.data() + header.code_index_offset, header.code_index_size, header.code_count) ||
+      !is_valid_index(s_cache.data() + header.serial_index_offset, header.serial_index_size,
+                      header.record_count))
+  {
+    Log_DevPrintf("Cache index is corrupted.");
+    return false;
+  }
+
+  return true;
+}
+
+void GameDatabase::BuildCache(const std::vector<Entry>& entries, const PreferUnorderedStringMap<u32>& code_lookup,
+                              u64 gamedb_ts)
+{
+  std::string strings;
+  PreferUnorderedStringMap<CacheStringRef> string_lookup;
+  const auto add_string = [&strings, &string_lookup](const std::string& str) {
+    const auto iter = string_lookup.find(str);
+    if (iter != string_lookup.end())
+      return iter->second;
+
+    const CacheStringRef ref = {static_cast<u32>(strings.size()), static_cast<u32>(str.size())};
+    strings.append(str);
+    string_lookup.emplace(str, ref);
+    return ref;
+  };
+
+  const auto set_optional = [](const auto& src, auto* dest, u16* optional_fields, u16 bit) {
+    if (src.has_value())
     {
-      entry.disc_set_serials.reserve(num_disc_set_serials);
-      for (u32 j = 0; j < num_disc_set_serials; j++)
-      {
-        if (!stream->ReadSizePrefixedString(&entry.disc_set_serials.emplace_back()))
-        {
-          Log_DevPrintf("Cache entry is corrupted.");
-          return false;
-        }
-      }
+      *dest = src.value();
+      *optional_fields |= bit;
     }
+  };
 
-    entry.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility);
-    entry.traits.reset();
-    for (u32 j = 0; j < static_cast<int>(Trait::Count); j++)
+  std::vector<CacheRecord> records;
+  std::vector<CacheStringRef> disc_set_serials;
+  records.reserve(entries.size());
+  for (const Entry& entry : entries)
+  {
+    CacheRecord& record = records.emplace_back();
+    std::memset(&record, 0, sizeof(record));
+    record.serial_hash = GetCacheKeyHash(entry.serial);
+    record.release_date = entry.release_date;
+    record.serial = add_string(entry.serial);
+    record.title = add_string(entry.title);
+    record.genre = add_string(entry.genre);
+    record.developer = add_string(entry.developer);
+    record.publisher = add_string(entry.publisher);
+    record.disc_set_name = add_string(entry.disc_set_name);
+    record.disc_set_serials_start = static_cast<u32>(disc_set_serials.size());
+    record.disc_set_serials_count = static_cast<u32>(entry.disc_set_serials.size());
+    for (const std::string& serial : entry.disc_set_serials)
+      disc_set_serials.push_back(add_string(serial));
+
+    set_optional(entry.display_active_start_offset, &record.display_active_start_offset, &record.optional_fields,
+                 CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET);
+    set_optional(entry.display_active_end_offset, &record.display_active_end_offset, &record.optional_fields,
+                 CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET);
+    set_optional(entry.display_line_start_offset, &record.display_line_start_offset, &record.optional_fields,
+                 CACHE_HAS_DISPLAY_LINE_START_OFFSET);
+    set_optional(entry.display_line_end_offset, &record.display_line_end_offset, &record.optional_fields,
+                 CACHE_HAS_DISPLAY_LINE_END_OFFSET);
+    set_optional(entry.dma_max_slice_ticks, &record.dma_max_slice_ticks, &record.optional_fields,
+                 CACHE_HAS_DMA_MAX_SLICE_TICKS);
+    set_optional(entry.dma_halt_ticks, &record.dma_halt_ticks, &record.optional_fields, CACHE_HAS_DMA_HALT_TICKS);
+    set_optional(entry.gpu_fifo_size, &record.gpu_fifo_size, &record.optional_fields, CACHE_HAS_GPU_FIFO_SIZE);
+    set_optional(entry.gpu_max_run_ahead, &record.gpu_max_run_ahead, &record.optional_fields,
+                 CACHE_HAS_GPU_MAX_RUN_AHEAD);
+    set_optional(entry.gpu_pgxp_tolerance, &record.gpu_pgxp_tolerance, &record.optional_fields,
+                 CACHE_HAS_GPU_PGXP_TOLERANCE);
+    set_optional(entry.gpu_pgxp_depth_threshold, &record.gpu_pgxp_depth_threshold, &record.optional_fields,
+                 CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD);
+
+    record.supported_controllers = entry.supported_controllers;
+    record.min_players = entry.min_players;
+    record.max_players = entry.max_players;
+    record.min_blocks = entry.min_blocks;
+    record.max_blocks = entry.max_blocks;
+    record.compatibility = static_cast<u8>(entry.compatibility);
+    for (u32 j = 0; j < static_cast<u32>(Trait::Count); j++)
     {
-      if ((bits[j / 8] & (1u << (j % 8))) != 0)
-        entry.traits[j] = true;
+      if (entry.traits[j])
+        record.traits[j / 8] |= static_cast<u8>(1u << (j % 8));
     }
   }
 
-  for (u32 i = 0; i < num_codes; i++)
+  std::vector<CacheCode> codes;
+  codes.reserve(code_lookup.size());
+  for (const auto& it : code_lookup)
   {
-    std::string code;
-    u32 index;
-    if (!stream->ReadSizePrefixedString(&code) || !stream->ReadU32(&index) ||
-        index >= static_cast<u32>(s_entries.size()))
+    CacheCode& code = codes.emplace_back();
+    code.code_hash = GetCacheKeyHash(it.first);
+    code.code = add_string(it.first);
+    code.record_index = it.second;
+    code.pad = 0;
+  }
+
+  // keep the tables at most half full, so probe sequences stay short
+  const auto build_index = [](u32 count, auto get_hash) {
+    u32 index_size = 16;
+    while (index_size < (count * 2))
+      index_size *= 2;
+
+    // entries are inserted in order, so the first of any duplicate keys is found first
+    std::vector<u32> index(index_size, 0);
+    for (u32 i = 0; i < count; i++)
     {
-      Log_DevPrintf("Cache code entry is corrupted.");
-      return false;
+      u32 bucket = static_cast<u32>(get_hash(i)) & (index_size - 1);
+      while (index[bucket] != 0)
+        bucket = (bucket + 1) & (index_size - 1);
+      index[bucket] = i + 1;
     }
 
-    s_code_lookup.emplace(std::move(code), index);
+    return index;
+  };
+  const std::vector<u32> code_index =
+    build_index(static_cast<u32>(codes.size()), [&codes](u32 i) { return codes[i].code_hash; });
+  const std::vector<u32> serial_index =
+    build_index(static_cast<u32>(records.size()), [&records](u32 i) { return records[i].serial_hash; });
+
+  CacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.signature = GAME_DATABASE_CACHE_SIGNATURE;
+  header.version = GAME_DATABASE_CACHE_VERSION;
+  header.gamedb_timestamp = gamedb_ts;
+  header.record_count = static_cast<u32>(records.size());
+  header.code_count = static_cast<u32>(codes.size());
+  header.disc_set_serial_count = static_cast<u32>(disc_set_serials.size());
+  header.code_index_size = static_cast<u32>(code_index.size());
+  header.serial_index_size = static_cast<u32>(serial_index.size());
+  header.codes_offset = static_cast<u32>(sizeof(CacheHeader) + (records.size() * sizeof(CacheRecord)));
+  header.disc_set_serials_offset = static_cast<u32>(header.codes_offset + (codes.size() * sizeof(CacheCode)));
+  header.code_index_offset =
+    static_cast<u32>(header.disc_set_serials_offset + (disc_set_serials.size() * sizeof(CacheStringRef)));
+  header.serial_index_offset = static_cast<u32>(header.code_index_offset + (code_index.size() * sizeof(u32)));
+  header.strings_offset = static_cast<u32>(header.serial_index_offset + (serial_index.size() * sizeof(u32)));
+  header.strings_size = static_cast<u32>(strings.size());
+
+  s_cache_data.clear();
+  s_cache_data.reserve(header.strings_offset + header.strings_size);
+  const auto append = [](const void* data, size_t size) {
+    s_cache_data.insert(s_cache_data.end(), static_cast<const u8*>(data), static_cast<const u8*>(data) + size);
+  };
+  append(&header, sizeof(header));
+  append(records.data(), records.size() * sizeof(CacheRecord));
+  append(codes.data(), codes.size() * sizeof(CacheCode));
+  append(disc_set_serials.data(), disc_set_serials.size() * sizeof(CacheStringRef));
+  append(code_index.data(), code_index.size() * sizeof(u32));
+  append(serial_index.data(), serial_index.size() * sizeof(u32));
+  append(strings.data(), strings.size());
+
+  s_cache = s_cache_data;
+
+  Log_DevPrintf("Built %u entry game database cache, %zu bytes, %u unique strings", header.record_count,
+                s_cache.size(), static_cast<u32>(string_lookup.size()));
+}
+
+bool GameDatabase::SaveToCache()
+{
+  const std::string cache_filename(GetCacheFile());
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(cache_filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE |
+                                                   BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_ATOMIC_UPDATE);
+  if (!stream)
+    return false;
+
+  if (!stream->Write2(s_cache.data(), static_cast<u32>(s_cache.size())) || !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to write game database cache '%s'", cache_filename.c_str());
+    stream->Discard();
+    return false;
   }
 
   return true;
 }
 
-bool GameDatabase::SaveToCache()
+GameDatabase::CacheHeader GameDatabase::GetCacheHeader()
 {
-  const u64 gamedb_ts = Host::GetResourceFileTimestamp("gamedb.json").value_or(0);
+  CacheHeader header;
+  std::memcpy(&header, s_cache.data(), sizeof(header));
+  return header;
+}
 
-  std::unique_ptr<ByteStream> stream(
-    ByteStream::OpenFile(GetCacheFile().c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE |
-                                                   BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_STREAMED));
-  if (!stream)
-    return false;
+u64 GameDatabase::GetCacheKeyHash(std::string_view key)
+{
+  return XXH64(key.data(), key.length(), 0);
+}
 
-  bool result = stream->WriteU32(GAME_DATABASE_CACHE_SIGNATURE);
-  result = result && stream->WriteU32(GAME_DATABASE_CACHE_VERSION);
-  result = result && stream->WriteU64(static_cast<u64>(gamedb_ts));
+std::string_view GameDatabase::GetCacheString(const CacheHeader& header, const CacheStringRef& ref)
+{
+  if (ref.offset > header.strings_size || ref.length > (header.strings_size - ref.offset))
+    return std::string_view();
 
-  result = result && stream->WriteU32(static_cast<u32>(s_entries.size()));
-  result = result && stream->WriteU32(static_cast<u32>(s_code_lookup.size()));
+  return std::string_view(reinterpret_cast<const char*>(s_cache.data()) + header.strings_offset + ref.offset,
+                          ref.length);
+}
 
-  for (const Entry& entry : s_entries)
+bool GameDatabase::ReadCacheRecord(const CacheHeader& header, const CacheRecord& record, Entry* entry)
+{
+  if (record.compatibility >= static_cast<u8>(CompatibilityRating::Count) ||
+      record.disc_set_serials_start > header.disc_set_serial_count ||
+      record.disc_set_serials_count > (header.disc_set_serial_count - record.disc_set_serials_start))
   {
-    result = result && stream->WriteSizePrefixedString(entry.serial);
-    result = result && stream->WriteSizePrefixedString(entry.title);
-    result = result && stream->WriteSizePrefixedString(entry.genre);
-    result = result && stream->WriteSizePrefixedString(entry.developer);
-    result = result && stream->WriteSizePrefixedString(entry.publisher);
-    result = result && stream->WriteU64(entry.release_date);
-    result = result && stream->WriteU8(entry.min_players);
-    result = result && stream->WriteU8(entry.max_players);
-    result = result && stream->WriteU8(entry.min_blocks);
-    result = result && stream->WriteU8(entry.max_blocks);
-    result = result && stream->WriteU16(entry.supported_controllers);
-    result = result && stream->WriteU8(static_cast<u8>(entry.compatibility));
-
-    constexpr u32 num_bytes = (static_cast<u32>(Trait::Count) + 7) / 8;
-    std::array<u8, num_bytes> bits;
-    bits.fill(0);
-    for (u32 j = 0; j < static_cast<int>(Trait::Count); j++)
-    {
-      if (entry.traits[j])
-        bits[j / 8] |= (1u << (j % 8));
-    }
+    Log_WarningPrintf("Game database cache entry is corrupted");
+    return false;
+  }
 
-    result = result && stream->Write2(bits.data(), num_bytes);
-
-    result = result && WriteOptionalToStream(stream.get(), entry.display_active_start_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_active_end_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_line_start_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.display_line_end_offset);
-    result = result && WriteOptionalToStream(stream.get(), entry.dma_max_slice_ticks);
-    result = result && WriteOptionalToStream(stream.get(), entry.dma_halt_ticks);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_fifo_size);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_max_run_ahead);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_pgxp_tolerance);
-    result = result && WriteOptionalToStream(stream.get(), entry.gpu_pgxp_depth_threshold);
-
-    result = result && stream->WriteSizePrefixedString(entry.disc_set_name);
-    result = result && stream->WriteU32(static_cast<u32>(entry.disc_set_serials.size()));
-    for (const std::string& serial : entry.disc_set_serials)
-      result = result && stream->WriteSizePrefixedString(serial);
+  const auto get_optional = [&record](auto value, u16 bit) {
+    return ((record.optional_fields & bit) != 0) ? std::optional<decltype(value)>(value) : std::nullopt;
+  };
+
+  entry->serial = GetCacheString(header, record.serial);
+  entry->title = GetCacheString(header, record.title);
+  entry->genre = GetCacheString(header, record.genre);
+  entry->developer = GetCacheString(header, record.developer);
+  entry->publisher = GetCacheString(header, record.publisher);
+  entry->release_date = record.release_date;
+  entry->min_players = record.min_players;
+  entry->max_players = record.max_players;
+  entry->min_blocks = record.min_blocks;
+  entry->max_blocks = record.max_blocks;
+  entry->supported_controllers = record.supported_controllers;
+  entry->compatibility = static_cast<CompatibilityRating>(record.compatibility);
+
+  entry->traits.reset();
+  for (u32 j = 0; j < static_cast<u32>(Trait::Count); j++)
+  {
+    if ((record.traits[j / 8] & (1u << (j % 8))) != 0)
+      entry->traits[j] = true;
   }
 
-  for (const auto& it : s_code_lookup)
+  entry->display_active_start_offset =
+    get_optional(record.display_active_start_offset, CACHE_HAS_DISPLAY_ACTIVE_START_OFFSET);
+  entry->display_active_end_offset =
+    get_optional(record.display_active_end_offset, CACHE_HAS_DISPLAY_ACTIVE_END_OFFSET);
+  entry->display_line_start_offset =
+    get_optional(record.display_line_start_offset, CACHE_HAS_DISPLAY_LINE_START_OFFSET);
+  entry->display_line_end_offset = get_optional(record.display_line_end_offset, CACHE_HAS_DISPLAY_LINE_END_OFFSET);
+  entry->dma_max_slice_ticks = get_optional(record.dma_max_slice_ticks, CACHE_HAS_DMA_MAX_SLICE_TICKS);
+  entry->dma_halt_ticks = get_optional(record.dma_halt_ticks, CACHE_HAS_DMA_HALT_TICKS);
+  entry->gpu_fifo_size = get_optional(record.gpu_fifo_size, CACHE_HAS_GPU_FIFO_SIZE);
+  entry->gpu_max_run_ahead = get_optional(record.gpu_max_run_ahead, CACHE_HAS_GPU_MAX_RUN_AHEAD);
+  entry->gpu_pgxp_tolerance = get_optional(record.gpu_pgxp_tolerance, CACHE_HAS_GPU_PGXP_TOLERANCE);
+  entry->gpu_pgxp_depth_threshold = get_optional(record.gpu_pgxp_depth_threshold, CACHE_HAS_GPU_PGXP_DEPTH_THRESHOLD);
+
+  entry->disc_set_name = GetCacheString(header, record.disc_set_name);
+  entry->disc_set_serials.clear();
+  entry->disc_set_serials.reserve(record.disc_set_serials_count);
+  const u8* disc_set_serials = s_cache.data() + header.disc_set_serials_offset;
+  for (u32 i = 0; i < record.disc_set_serials_count; i++)
   {
-    result = result && stream->WriteSizePrefixedString(it.first);
-    result = result && stream->WriteU32(it.second);
+    CacheStringRef ref;
+    std::memcpy(&ref, disc_set_serials + ((record.disc_set_serials_start + i) * sizeof(CacheStringRef)), sizeof(ref));
+    entry->disc_set_serials.emplace_back(GetCacheString(header, ref));
   }
 
-  result = result && stream->Flush();
   return true;
 }
 
+const GameDatabase::Entry* GameDatabase::GetCacheEntry(const CacheHeader& header, u32 record_index)
+{
+  if (record_index >= header.record_count)
+    return nullptr;
+
+  // decoded entries are never freed until the database is unloaded, so the pointers stay valid
+  std::unique_lock lock(s_cache_entries_mutex);
+  std::unique_ptr<Entry>& entry = s_cache_entries[record_index];
+  if (!entry)
+  {
+    CacheRecord record;
+    std::memcpy(&record, s_cache.data() + sizeof(CacheHeader) + (record_index * sizeof(CacheRecord)),
+                sizeof(record));
+
+    std::unique_ptr<Entry> new_entry = std::make_unique<Entry>();
+    if (!ReadCacheRecord(header, record, new_entry.get()))
+      return nullptr;
+
+    entry = std::move(new_entry);
+  }
+
+  return entry.get();
+}
+
 //////////////////////////////////////////////////////////////////////////
 // JSON Parsing
 //////////////////////////////////////////////////////////////////////////
@@ -777,7 +1109,7 @@ static std::optional<float> GetOptionalFloatFromObject(const rapidjson::Value& o
   return member->value.GetFloat();
 }
 
-bool GameDatabase::LoadGameDBJson()
+bool GameDatabase::LoadGameDBJson(std::vector<Entry>* entries, PreferUnorderedStringMap<u32>* code_lookup)
 {
   std::optional<std::string> gamedb_data(Host::ReadResourceFileToString("gamedb.json"));
   if (!gamedb_data.has_value())
@@ -803,23 +1135,23 @@ bool GameDatabase::LoadGameDBJson()
   }
 
   const auto& jarray = json->GetArray();
-  s_entries.reserve(jarray.Size());
+  entries->reserve(jarray.Size());
 
   for (const rapidjson::Value& current : json->GetArray())
   {
     // TODO: binary sort
-    const u32 index = static_cast<u32>(s_entries.size());
-    Entry& entry = s_entries.emplace_back();
+    const u32 index = static_cast<u32>(entries->size());
+    Entry& entry = entries->emplace_back();
     if (!ParseJsonEntry(&entry, current))
     {
-      s_entries.pop_back();
+      entries->pop_back();
       continue;
     }
 
-    ParseJsonCodes(index, current);
+    ParseJsonCodes(code_lookup, index, current);
   }
 
-  Log_InfoPrintf("Loaded %zu entries and %zu codes from database", s_entries.size(), s_code_lookup.size());
+  Log_InfoPrintf("Loaded %zu entries and %zu codes from database", entries->size(), code_lookup->size());
   return true;
 }
 
@@ -981,7 +1313,7 @@ bool GameDatabase::ParseJsonEntry(Entry* entry, const rapidjson::Value& value)
   return true;
 }
 
-bool GameDatabase::ParseJsonCodes(u32 index, const rapidjson::Value& value)
+bool GameDatabase::ParseJsonCodes(PreferUnorderedStringMap<u32>* code_lookup, u32 index, const rapidjson::Value& value)
 {
   auto member = value.FindMember("codes");
   if (member == value.MemberEnd())
@@ -1006,14 +1338,14 @@ bool GameDatabase::ParseJsonCodes(u32 index, const rapidjson::Value& value)
     }
 
     const std::string_view code(current_code.GetString(), current_code.GetStringLength());
-    auto iter = s_code_lookup.find(code);
-    if (iter != s_code_lookup.end())
+    auto iter = code_lookup->find(code);
+    if (iter != code_lookup->end())
     {
       Log_WarningPrintf("Duplicate code '%.*s'", static_cast<int>(code.size()), code.data());
       continue;
     }
 
-    s_code_lookup.emplace(code, index);
+    code_lookup->emplace(code, index);
     added++;
   }
 
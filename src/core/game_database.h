@@ -89,6 +89,11 @@ struct Entry
 };
 
 void EnsureLoaded();
+
+/// Loads the database on a worker thread, so that the first lookup doesn't have to. Lookups made before it finishes
+/// wait for it.
+void StartBackgroundLoad();
+
 void Unload();
 
 const Entry* GetEntryForDisc(CDImage* image);
@@ -19,12 +19,22 @@
 #include "common/path.h"
 #include "common/progress_callback.h"
 #include "common/string_util.h"
+#include "common/threading.h"
+#include "common/timer.h"
+
+#include "xxhash.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <condition_variable>
 #include <ctime>
+#include <mutex>
+#include <optional>
 #include <string_view>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -39,13 +49,19 @@ namespace GameList {
 enum : u32
 {
   GAME_LIST_CACHE_SIGNATURE = 0x45434C47,
-  GAME_LIST_CACHE_VERSION = 34,
+  GAME_LIST_CACHE_VERSION = 35,
 
   PLAYED_TIME_SERIAL_LENGTH = 32,
   PLAYED_TIME_LAST_TIME_LENGTH = 20,  // uint64
   PLAYED_TIME_TOTAL_TIME_LENGTH = 20, // uint64
   PLAYED_TIME_LINE_LENGTH =
     PLAYED_TIME_SERIAL_LENGTH + 1 + PLAYED_TIME_LAST_TIME_LENGTH + 1 + PLAYED_TIME_TOTAL_TIME_LENGTH,
+
+  // Sessions are appended to the journal, which is folded into the played time file once it reaches this size.
+  PLAYED_TIME_JOURNAL_COMPACT_SIZE = 64 * 1024,
+
+  MAX_SCAN_THREADS = 8,
+  MAX_CONCURRENT_COVER_DOWNLOADS = 8,
 };
 
 struct PlayedTimeEntry
@@ -54,7 +70,49 @@ struct PlayedTimeEntry
   std::time_t total_played_time;
 };
 
-using CacheMap = PreferUnorderedStringMap<Entry>;
+// The cache file is laid out so it can be used in-place, without deserializing it: a header, followed by fixed-size
+// records, an open-addressed hash table of record indices keyed by path, and finally the string table.
+struct CacheHeader
+{
+  u32 signature;
+  u32 version;
+  u32 record_count;
+  u32 index_size; // power of two, entries are record index + 1, zero for an empty bucket
+  u32 strings_offset;
+  u32 strings_size;
+};
+
+struct CacheStringRef
+{
+  u32 offset;
+  u32 length;
+};
+
+struct CacheRecord
+{
+  u64 path_hash;
+  u64 hash;
+  u64 total_size;
+  u64 last_modified_time;
+  u64 release_date;
+  CacheStringRef path;
+  CacheStringRef serial;
+  CacheStringRef title;
+  CacheStringRef genre;
+  CacheStringRef publisher;
+  CacheStringRef developer;
+  u16 supported_controllers;
+  u8 type;
+  u8 region;
+  u8 min_players;
+  u8 max_players;
+  u8 min_blocks;
+  u8 max_blocks;
+  u8 compatibility;
+  u8 pad[7];
+};
+static_assert(sizeof(CacheHeader) == 24 && sizeof(CacheRecord) == 104);
+
 using PlayedTimeMap = PreferUnorderedStringMap<PlayedTimeEntry>;
 
 static_assert(std::is_same_v<decltype(Entry::hash), System::GameHash>);
@@ -66,33 +124,42 @@ static bool GetDiscListEntry(const std::string& path, Entry* entry);
 static bool GetGameListEntryFromCache(const std::string& path, Entry* entry);
 static void ScanDirectory(const char* path, bool recursive, bool only_cache,
                           const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map,
-                          ProgressCallback* progress);
+                          ProgressCallback* progress, std::vector<std::string>* scanned_directories);
+static bool IsPathWithinDirectory(const std::string_view& path, const std::string_view& dir);
+static void RemoveChangedEntries(const std::string& dir);
 static bool AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map);
-static bool ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                     const PlayedTimeMap& played_time_map);
+static void ScanFiles(std::vector<FILESYSTEM_FIND_DATA*>& files, const PlayedTimeMap& played_time_map, u32 files_scanned,
+                      ProgressCallback* progress);
 
 static std::string GetCacheFilename();
 static void LoadCache();
-static bool LoadEntriesFromCache(ByteStream* stream);
-static bool OpenCacheForWriting();
-static bool WriteEntryToCache(const Entry* entry);
-static void CloseCacheFileStream();
+static bool ValidateCache();
+static u64 GetCachePathHash(std::string_view path);
+static std::string_view GetCacheString(const CacheStringRef& ref);
+static bool ReadCacheRecord(const CacheRecord& record, Entry* entry);
+static void WriteCache();
+static void ClearCache();
 static void DeleteCacheFile();
 
 static std::string GetPlayedTimeFile();
 static bool ParsePlayedTimeLine(char* line, std::string& serial, PlayedTimeEntry& entry);
 static std::string MakePlayedTimeLine(const std::string& serial, const PlayedTimeEntry& entry);
-static PlayedTimeMap LoadPlayedTimeMap(const std::string& path);
-static PlayedTimeEntry UpdatePlayedTimeFile(const std::string& path, const std::string& serial, std::time_t last_time,
-                                            std::time_t add_time);
+static std::string GetPlayedTimeJournalFile();
+static FileSystem::ManagedCFilePtr OpenPlayedTimeFile(const std::string& path, const char* mode);
+static void ReadPlayedTimeLines(std::FILE* fp, bool journal, PlayedTimeMap* map);
+static PlayedTimeMap LoadPlayedTimeMap();
+static bool AppendPlayedTimeJournal(const std::string& serial, std::time_t last_time, std::time_t add_time);
+static void CompactPlayedTimeJournal();
 } // namespace GameList
 
 static std::vector<GameList::Entry> s_entries;
 static std::recursive_mutex s_mutex;
-static GameList::CacheMap s_cache_map;
-static std::unique_ptr<ByteStream> s_cache_write_stream;
+static std::vector<u8> s_cache_data;
+static std::vector<bool> s_cache_records_used;
+static bool s_cache_dirty = false;
 
 static bool s_game_list_loaded = false;
+static u32 s_entries_version = 0;
 
 const char* GameList::GetEntryTypeName(EntryType type)
 {
@@ -284,86 +351,84 @@ bool GameList::PopulateEntryFromPath(const std::string& path, Entry* entry)
 
 bool GameList::GetGameListEntryFromCache(const std::string& path, Entry* entry)
 {
-  auto iter = s_cache_map.find(path);
-  if (iter == s_cache_map.end())
+  if (s_cache_data.empty())
     return false;
 
-  *entry = std::move(iter->second);
-  s_cache_map.erase(iter);
-  return true;
-}
+  CacheHeader header;
+  std::memcpy(&header, s_cache_data.data(), sizeof(header));
 
-bool GameList::LoadEntriesFromCache(ByteStream* stream)
-{
-  u32 file_signature, file_version;
-  if (!stream->ReadU32(&file_signature) || !stream->ReadU32(&file_version) ||
-      file_signature != GAME_LIST_CACHE_SIGNATURE || file_version != GAME_LIST_CACHE_VERSION)
+  const u8* records = s_cache_data.data() + sizeof(CacheHeader);
+  const u8* index = records + (header.record_count * sizeof(CacheRecord));
+  const u64 path_hash = GetCachePathHash(path);
+  const u32 index_mask = header.index_size - 1;
+  for (u32 bucket = static_cast<u32>(path_hash) & index_mask, probes = 0; probes < header.index_size;
+       bucket = (bucket + 1) & index_mask, probes++)
   {
-    Log_WarningPrintf("Game list cache is corrupted");
-    return false;
-  }
+    u32 slot;
+    std::memcpy(&slot, index + (bucket * sizeof(u32)), sizeof(slot));
+    if (slot == 0)
+      break;
 
-  while (stream->GetPosition() != stream->GetSize())
-  {
-    std::string path;
-    Entry ge;
-
-    u8 type;
-    u8 region;
-    u8 compatibility_rating;
-
-    if (!stream->ReadU8(&type) || !stream->ReadU8(&region) || !stream->ReadSizePrefixedString(&path) ||
-        !stream->ReadSizePrefixedString(&ge.serial) || !stream->ReadSizePrefixedString(&ge.title) ||
-        !stream->ReadSizePrefixedString(&ge.genre) || !stream->ReadSizePrefixedString(&ge.publisher) ||
-        !stream->ReadSizePrefixedString(&ge.developer) || !stream->ReadU64(&ge.hash) ||
-        !stream->ReadU64(&ge.total_size) || !stream->ReadU64(reinterpret_cast<u64*>(&ge.last_modified_time)) ||
-        !stream->ReadU64(&ge.release_date) || !stream->ReadU16(&ge.supported_controllers) ||
-        !stream->ReadU8(&ge.min_players) || !stream->ReadU8(&ge.max_players) || !stream->ReadU8(&ge.min_blocks) ||
-        !stream->ReadU8(&ge.max_blocks) || !stream->ReadU8(&compatibility_rating) ||
-        region >= static_cast<u8>(DiscRegion::Count) || type >= static_cast<u8>(EntryType::Count) ||
-        compatibility_rating >= static_cast<u8>(GameDatabase::CompatibilityRating::Count))
-    {
-      Log_WarningPrintf("Game list cache entry is corrupted");
-      return false;
-    }
+    CacheRecord record;
+    std::memcpy(&record, records + ((slot - 1) * sizeof(CacheRecord)), sizeof(record));
+    if (record.path_hash != path_hash || GetCacheString(record.path) != path)
+      continue;
 
-    ge.path = path;
-    ge.region = static_cast<DiscRegion>(region);
-    ge.type = static_cast<EntryType>(type);
-    ge.compatibility = static_cast<GameDatabase::CompatibilityRating>(compatibility_rating);
+    // each record is only handed out once, the same as if it was removed from a map
+    if (s_cache_records_used[slot - 1] || !ReadCacheRecord(record, entry))
+      return false;
 
-    auto iter = s_cache_map.find(ge.path);
-    if (iter != s_cache_map.end())
-      iter->second = std::move(ge);
-    else
-      s_cache_map.emplace(std::move(path), std::move(ge));
+    s_cache_records_used[slot - 1] = true;
+    return true;
   }
 
-  return true;
+  return false;
 }
 
-bool GameList::WriteEntryToCache(const Entry* entry)
+u64 GameList::GetCachePathHash(std::string_view path)
 {
-  bool result = true;
-  result &= s_cache_write_stream->WriteU8(static_cast<u8>(entry->type));
-  result &= s_cache_write_stream->WriteU8(static_cast<u8>(entry->region));
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->path);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->serial);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->title);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->genre);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->publisher);
-  result &= s_cache_write_stream->WriteSizePrefixedString(entry->developer);
-  result &= s_cache_write_stream->WriteU64(entry->hash);
-  result &= s_cache_write_stream->WriteU64(entry->total_size);
-  result &= s_cache_write_stream->WriteU64(entry->last_modified_time);
-  result &= s_cache_write_stream->WriteU64(entry->release_date);
-  result &= s_cache_write_stream->WriteU16(entry->supported_controllers);
-  result &= s_cache_write_stream->WriteU8(entry->min_players);
-  result &= s_cache_write_stream->WriteU8(entry->max_players);
-  result &= s_cache_write_stream->WriteU8(entry->min_blocks);
-  result &= s_cache_write_stream->WriteU8(entry->max_blocks);
-  result &= s_cache_write_stream->WriteU8(static_cast<u8>(entry->compatibility));
-  return result;
+  return XXH64(path.data(), path.length(), 0);
+}
+
+std::string_view GameList::GetCacheString(const CacheStringRef& ref)
+{
+  CacheHeader header;
+  std::memcpy(&header, s_cache_data.data(), sizeof(header));
+  if (ref.offset > header.strings_size || ref.length > (header.strings_size - ref.offset))
+    return std::string_view();
+
+  return std::string_view(reinterpret_cast<const char*>(s_cache_data.data()) + header.strings_offset + ref.offset,
+                          ref.length);
+}
+
+bool GameList::ReadCacheRecord(const CacheRecord& record, Entry* entry)
+{
+  if (record.region >= static_cast<u8>(DiscRegion::Count) || record.type >= static_cast<u8>(EntryType::Count) ||
+      record.compatibility >= static_cast<u8>(GameDatabase::CompatibilityRating::Count))
+  {
+    Log_WarningPrintf("Game list cache entry is corrupted");
+    return false;
+  }
+
+  entry->type = static_cast<EntryType>(record.type);
+  entry->region = static_cast<DiscRegion>(record.region);
+  entry->path = GetCacheString(record.path);
+  entry->serial = GetCacheString(record.serial);
+  entry->title = GetCacheString(record.title);
+  entry->genre = GetCacheString(record.genre);
+  entry->publisher = GetCacheString(record.publisher);
+  entry->developer = GetCacheString(record.developer);
+  entry->hash = record.hash;
+  entry->total_size = record.total_size;
+  entry->last_modified_time = static_cast<std::time_t>(record.last_modified_time);
+  entry->release_date = record.release_date;
+  entry->supported_controllers = record.supported_controllers;
+  entry->min_players = record.min_players;
+  entry->max_players = record.max_players;
+  entry->min_blocks = record.min_blocks;
+  entry->max_blocks = record.max_blocks;
+  entry->compatibility = static_cast<GameDatabase::CompatibilityRating>(record.compatibility);
+  return true;
 }
 
 static std::string GameList::GetCacheFilename()
@@ -373,75 +438,187 @@ static std::string GameList::GetCacheFilename()
 
 void GameList::LoadCache()
 {
+  ClearCache();
+
   std::string filename(GetCacheFilename());
-  std::unique_ptr<ByteStream> stream =
-    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(filename.c_str());
+  if (!data.has_value())
     return;
 
-  if (!LoadEntriesFromCache(stream.get()))
+  s_cache_data = std::move(data.value());
+  if (!ValidateCache())
   {
     Log_WarningPrintf("Deleting corrupted cache file '%s'", filename.c_str());
-    stream.reset();
-    s_cache_map.clear();
+    ClearCache();
     DeleteCacheFile();
     return;
   }
+
+  CacheHeader header;
+  std::memcpy(&header, s_cache_data.data(), sizeof(header));
+  s_cache_records_used.resize(header.record_count, false);
 }
 
-bool GameList::OpenCacheForWriting()
+bool GameList::ValidateCache()
 {
-  const std::string cache_filename(GetCacheFilename());
-  Assert(!s_cache_write_stream);
+  // only the layout is checked here, records are validated when they're looked up
+  CacheHeader header;
+  if (s_cache_data.size() < sizeof(header))
+    return false;
 
-  s_cache_write_stream = ByteStream::OpenFile(cache_filename.c_str(),
-                                              BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_SEEKABLE);
-  if (s_cache_write_stream)
+  std::memcpy(&header, s_cache_data.data(), sizeof(header));
+  if (header.signature != GAME_LIST_CACHE_SIGNATURE || header.version != GAME_LIST_CACHE_VERSION)
   {
-    // check the header
-    u32 signature, version;
-    if (s_cache_write_stream->ReadU32(&signature) && signature == GAME_LIST_CACHE_SIGNATURE &&
-        s_cache_write_stream->ReadU32(&version) && version == GAME_LIST_CACHE_VERSION &&
-        s_cache_write_stream->SeekToEnd())
-    {
-      return true;
-    }
-
-    s_cache_write_stream.reset();
+    Log_WarningPrintf("Game list cache is corrupted");
+    return false;
   }
 
-  Log_InfoPrintf("Creating new game list cache file: '%s'", cache_filename.c_str());
-
-  s_cache_write_stream = ByteStream::OpenFile(
-    cache_filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE | BYTESTREAM_OPEN_WRITE);
-  if (!s_cache_write_stream)
+  const u64 records_end = sizeof(CacheHeader) + (static_cast<u64>(header.record_count) * sizeof(CacheRecord));
+  const u64 index_end = records_end + (static_cast<u64>(header.index_size) * sizeof(u32));
+  if (header.index_size == 0 || (header.index_size & (header.index_size - 1)) != 0 ||
+      header.index_size < header.record_count || header.strings_offset != index_end ||
+      (static_cast<u64>(header.strings_offset) + header.strings_size) != s_cache_data.size())
+  {
+    Log_WarningPrintf("Game list cache is corrupted");
     return false;
+  }
 
-  // new cache file, write header
-  if (!s_cache_write_stream->WriteU32(GAME_LIST_CACHE_SIGNATURE) ||
-      !s_cache_write_stream->WriteU32(GAME_LIST_CACHE_VERSION))
+  const u8* index = s_cache_data.data() + records_end;
+  for (u32 i = 0; i < header.index_size; i++)
   {
-    Log_ErrorPrintf("Failed to write game list cache header");
-    s_cache_write_stream.reset();
-    FileSystem::DeleteFile(cache_filename.c_str());
-    return false;
+    u32 slot;
+    std::memcpy(&slot, index + (i * sizeof(u32)), sizeof(slot));
+    if (slot > header.record_count)
+    {
+      Log_WarningPrintf("Game list cache index is corrupted");
+      return false;
+    }
   }
 
   return true;
 }
 
-void GameList::CloseCacheFileStream()
+void GameList::WriteCache()
 {
-  if (!s_cache_write_stream)
+  if (!s_cache_dirty)
     return;
 
-  s_cache_write_stream->Commit();
-  s_cache_write_stream.reset();
+  // Everything in the list, plus anything in the old cache which wasn't found this time (e.g. a drive which isn't
+  // connected), so it doesn't have to be scanned again later.
+  std::vector<Entry> unused_entries;
+  if (!s_cache_data.empty())
+  {
+    const u8* records = s_cache_data.data() + sizeof(CacheHeader);
+    for (u32 i = 0; i < static_cast<u32>(s_cache_records_used.size()); i++)
+    {
+      if (s_cache_records_used[i])
+        continue;
+
+      CacheRecord record;
+      std::memcpy(&record, records + (i * sizeof(CacheRecord)), sizeof(record));
+
+      Entry entry;
+      if (ReadCacheRecord(record, &entry))
+        unused_entries.push_back(std::move(entry));
+    }
+  }
+
+  std::vector<const Entry*> entries;
+  entries.reserve(s_entries.size() + unused_entries.size());
+  for (const Entry& entry : s_entries)
+    entries.push_back(&entry);
+  for (const Entry& entry : unused_entries)
+    entries.push_back(&entry);
+
+  std::string strings;
+  const auto add_string = [&strings](const std::string& str) {
+    const CacheStringRef ref = {static_cast<u32>(strings.size()), static_cast<u32>(str.size())};
+    strings.append(str);
+    return ref;
+  };
+
+  std::vector<CacheRecord> records;
+  records.reserve(entries.size());
+  for (const Entry* entry : entries)
+  {
+    CacheRecord& record = records.emplace_back();
+    std::memset(&record, 0, sizeof(record));
+    record.path_hash = GetCachePathHash(entry->path);
+    record.hash = entry->hash;
+    record.total_size = entry->total_size;
+    record.last_modified_time = static_cast<u64>(entry->last_modified_time);
+    record.release_date = entry->release_date;
+    record.path = add_string(entry->path);
+    record.serial = add_string(entry->serial);
+    record.title = add_string(entry->title);
+    record.genre = add_string(entry->genre);
+    record.publisher = add_string(entry->publisher);
+    record.developer = add_string(entry->developer);
+    record.supported_controllers = entry->supported_controllers;
+    record.type = static_cast<u8>(entry->type);
+    record.region = static_cast<u8>(entry->region);
+    record.min_players = entry->min_players;
+    record.max_players = entry->max_players;
+    record.min_blocks = entry->min_blocks;
+    record.max_blocks = entry->max_blocks;
+    record.compatibility = static_cast<u8>(entry->compatibility);
+  }
+
+  // keep the table at most half full, so probe sequences stay short
+  u32 index_size = 16;
+  while (index_size < (static_cast<u32>(records.size()) * 2))
+    index_size *= 2;
+
+  std::vector<u32> index(index_size, 0);
+  for (u32 i = 0; i < static_cast<u32>(records.size()); i++)
+  {
+    u32 bucket = static_cast<u32>(records[i].path_hash) & (index_size - 1);
+    while (index[bucket] != 0)
+      bucket = (bucket + 1) & (index_size - 1);
+    index[bucket] = i + 1;
+  }
+
+  CacheHeader header;
+  header.signature = GAME_LIST_CACHE_SIGNATURE;
+  header.version = GAME_LIST_CACHE_VERSION;
+  header.record_count = static_cast<u32>(records.size());
+  header.index_size = index_size;
+  header.strings_offset =
+    static_cast<u32>(sizeof(CacheHeader) + (records.size() * sizeof(CacheRecord)) + (index.size() * sizeof(u32)));
+  header.strings_size = static_cast<u32>(strings.size());
+
+  const std::string cache_filename(GetCacheFilename());
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(cache_filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_TRUNCATE |
+                                                   BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_ATOMIC_UPDATE);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open game list cache '%s' for writing", cache_filename.c_str());
+    return;
+  }
+
+  if (!stream->Write2(&header, sizeof(header)) ||
+      !stream->Write2(records.data(), static_cast<u32>(records.size() * sizeof(CacheRecord))) ||
+      !stream->Write2(index.data(), static_cast<u32>(index.size() * sizeof(u32))) ||
+      !stream->Write2(strings.data(), static_cast<u32>(strings.size())) || !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to write game list cache '%s'", cache_filename.c_str());
+    stream->Discard();
+    return;
+  }
+
+  Log_InfoPrintf("Wrote %u entries to game list cache", header.record_count);
+  s_cache_dirty = false;
+}
+
+void GameList::ClearCache()
+{
+  s_cache_data = {};
+  s_cache_records_used = {};
 }
 
 void GameList::DeleteCacheFile()
 {
-  Assert(!s_cache_write_stream);
 
   const std::string filename(GetCacheFilename());
   if (!FileSystem::FileExists(filename.c_str()))
@@ -460,17 +637,24 @@ static bool IsPathExcluded(const std::vector<std::string>& excluded_paths, const
 
 void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
                              const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map,
-                             ProgressCallback* progress)
+                             ProgressCallback* progress, std::vector<std::string>* scanned_directories)
 {
   Log_InfoPrintf("Scanning %s%s", path, recursive ? " (recursively)" : "");
 
   progress->SetFormattedStatusText("Scanning directory '%s'%s...", path, recursive ? " (recursively)" : "");
 
+  // Directories come out of the same search when they're wanted, so the tree is only walked once.
+  u32 find_flags = FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES;
+  if (recursive)
+    find_flags |= FILESYSTEM_FIND_RECURSIVE;
+  if (scanned_directories)
+  {
+    find_flags |= (recursive ? FILESYSTEM_FIND_FOLDERS : 0);
+    scanned_directories->push_back(path);
+  }
+
   FileSystem::FindResultsArray files;
-  FileSystem::FindFiles(path, "*",
-                        recursive ? (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES | FILESYSTEM_FIND_RECURSIVE) :
-                                    (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_HIDDEN_FILES),
-                        &files);
+  FileSystem::FindFiles(path, "*", find_flags, &files);
   if (files.empty())
     return;
 
@@ -478,14 +662,24 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
   progress->SetProgressRange(static_cast<u32>(files.size()));
   progress->SetProgressValue(0);
 
+  // Pick up everything we can from the cache first, the remaining files get scanned in parallel.
+  std::vector<FILESYSTEM_FIND_DATA*> scan_files;
   u32 files_scanned = 0;
   for (FILESYSTEM_FIND_DATA& ffd : files)
   {
-    files_scanned++;
+    if (progress->IsCancelled())
+      break;
+
+    if (ffd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY)
+    {
+      scanned_directories->push_back(std::move(ffd.FileName));
+      files_scanned++;
+      continue;
+    }
 
-    if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) ||
-        IsPathExcluded(excluded_paths, ffd.FileName))
+    if (!GameList::IsScannableFilename(ffd.FileName) || IsPathExcluded(excluded_paths, ffd.FileName))
     {
+      files_scanned++;
       continue;
     }
 
@@ -493,15 +687,19 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
     if (GetEntryForPath(ffd.FileName.c_str()) ||
         AddFileFromCache(ffd.FileName, ffd.ModificationTime, played_time_map) || only_cache)
     {
+      files_scanned++;
       continue;
     }
 
-    progress->SetFormattedStatusText("Scanning '%s'...", FileSystem::GetDisplayNameFromPath(ffd.FileName).c_str());
-    ScanFile(std::move(ffd.FileName), ffd.ModificationTime, lock, played_time_map);
-    progress->SetProgressValue(files_scanned);
+    scan_files.push_back(&ffd);
   }
 
   progress->SetProgressValue(files_scanned);
+
+  if (!scan_files.empty() && !progress->IsCancelled())
+    ScanFiles(scan_files, played_time_map, files_scanned, progress);
+
+  progress->SetProgressValue(static_cast<u32>(files.size()));
   progress->PopState();
 }
 
@@ -519,40 +717,129 @@ bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp,
   }
 
   s_entries.push_back(std::move(entry));
+  s_entries_version++;
   return true;
 }
 
-bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                        const PlayedTimeMap& played_time_map)
+void GameList::ScanFiles(std::vector<FILESYSTEM_FIND_DATA*>& files, const PlayedTimeMap& played_time_map,
+                         u32 files_scanned, ProgressCallback* progress)
 {
-  // don't block UI while scanning
-  lock.unlock();
+  const u32 num_files = static_cast<u32>(files.size());
+  const u32 num_threads =
+    std::clamp<u32>(std::thread::hardware_concurrency(), 1, std::min<u32>(num_files, MAX_SCAN_THREADS));
+
+  // the database isn't thread safe to load, make sure the workers don't race to do it
+  GameDatabase::EnsureLoaded();
+
+  // Workers populate entries in any order, but they're merged in file order, so the cache is written the same way
+  // regardless of how many threads are used.
+  std::vector<std::optional<Entry>> results(num_files);
+  std::vector<bool> results_done(num_files, false);
+  std::mutex results_mutex;
+  std::condition_variable results_cv;
+  std::atomic<u32> next_file{0};
+  std::atomic_bool cancelled{false};
+
+  auto worker = [&]() {
+    Threading::SetNameOfCurrentThread("Game List Scanner");
+
+    for (;;)
+    {
+      // check before taking a file, anything taken has to be completed for the merge loop to finish
+      if (cancelled.load(std::memory_order_relaxed))
+        break;
 
-  Log_DevPrintf("Scanning '%s'...", path.c_str());
+      const u32 index = next_file.fetch_add(1, std::memory_order_relaxed);
+      if (index >= num_files)
+        break;
 
-  Entry entry;
-  if (!PopulateEntryFromPath(path, &entry))
-    return false;
+      const std::string& path = files[index]->FileName;
+      Log_DevPrintf("Scanning '%s'...", path.c_str());
 
-  entry.path = std::move(path);
-  entry.last_modified_time = timestamp;
+      Entry entry;
+      const bool result = PopulateEntryFromPath(path, &entry);
 
-  if (s_cache_write_stream || OpenCacheForWriting())
-  {
-    if (!WriteEntryToCache(&entry))
-      Log_WarningPrintf("Failed to write entry '%s' to cache", entry.path.c_str());
-  }
+      std::unique_lock lock(results_mutex);
+      if (result)
+        results[index] = std::move(entry);
+      results_done[index] = true;
+      results_cv.notify_one();
+    }
+  };
 
-  auto iter = played_time_map.find(entry.serial);
-  if (iter != played_time_map.end())
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (u32 i = 0; i < num_threads; i++)
+    threads.emplace_back(worker);
+
+  u32 files_merged = 0;
+  std::vector<Entry> batch;
+  while (files_merged < num_files)
   {
-    entry.last_played_time = iter->second.last_played_time;
-    entry.total_played_time = iter->second.total_played_time;
+    // grab everything that's finished in order, without holding the list lock
+    u32 batch_end = files_merged;
+    {
+      std::unique_lock lock(results_mutex);
+      while (!results_done[files_merged])
+      {
+        if (!cancelled.load(std::memory_order_relaxed) && progress->IsCancelled())
+          cancelled.store(true, std::memory_order_relaxed);
+
+        // files which were never picked up by a worker won't complete
+        if (cancelled.load(std::memory_order_relaxed) && files_merged >= next_file.load(std::memory_order_relaxed))
+          break;
+
+        results_cv.wait_for(lock, std::chrono::milliseconds(100));
+      }
+
+      while (batch_end < num_files && results_done[batch_end])
+        batch_end++;
+    }
+    if (batch_end == files_merged)
+      break;
+
+    for (u32 i = files_merged; i < batch_end; i++)
+    {
+      if (!results[i].has_value())
+        continue;
+
+      Entry& entry = results[i].value();
+      entry.path = std::move(files[i]->FileName);
+      entry.last_modified_time = files[i]->ModificationTime;
+
+      s_cache_dirty = true;
+
+      auto iter = played_time_map.find(entry.serial);
+      if (iter != played_time_map.end())
+      {
+        entry.last_played_time = iter->second.last_played_time;
+        entry.total_played_time = iter->second.total_played_time;
+      }
+
+      batch.push_back(std::move(entry));
+      results[i].reset();
+    }
+
+    if (!batch.empty())
+    {
+      progress->SetFormattedStatusText("Scanning '%s'...",
+                                       FileSystem::GetDisplayNameFromPath(batch.back().path).c_str());
+
+      std::unique_lock lock(s_mutex);
+      for (Entry& entry : batch)
+        s_entries.push_back(std::move(entry));
+      s_entries_version++;
+      batch.clear();
+    }
+
+    files_scanned += batch_end - files_merged;
+    files_merged = batch_end;
+    progress->SetProgressValue(files_scanned);
   }
 
-  lock.lock();
-  s_entries.push_back(std::move(entry));
-  return true;
+  cancelled.store(true, std::memory_order_relaxed);
+  for (std::thread& thread : threads)
+    thread.join();
 }
 
 std::unique_lock<std::recursive_mutex> GameList::GetLock()
@@ -607,7 +894,13 @@ u32 GameList::GetEntryCount()
   return static_cast<u32>(s_entries.size());
 }
 
-void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback* progress /* = nullptr */)
+u32 GameList::GetEntriesVersion()
+{
+  return s_entries_version;
+}
+
+void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback* progress /* = nullptr */,
+                       std::vector<std::string>* scanned_directories /* = nullptr */)
 {
   s_game_list_loaded = true;
 
@@ -615,21 +908,27 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
     progress = ProgressCallback::NullProgressCallback;
 
   if (invalidate_cache)
+  {
+    ClearCache();
     DeleteCacheFile();
+  }
   else
+  {
     LoadCache();
+  }
 
   // don't delete the old entries, since the frontend might still access them
   std::vector<Entry> old_entries;
   {
     std::unique_lock lock(s_mutex);
     old_entries.swap(s_entries);
+    s_entries_version++;
   }
 
   const std::vector<std::string> excluded_paths(Host::GetBaseStringListSetting("GameList", "ExcludedPaths"));
   const std::vector<std::string> dirs(Host::GetBaseStringListSetting("GameList", "Paths"));
   std::vector<std::string> recursive_dirs(Host::GetBaseStringListSetting("GameList", "RecursivePaths"));
-  const PlayedTimeMap played_time(LoadPlayedTimeMap(GetPlayedTimeFile()));
+  const PlayedTimeMap played_time(LoadPlayedTimeMap());
 
 #ifdef __ANDROID__
   recursive_dirs.push_back(Path::Combine(EmuFolders::DataRoot, "games"));
@@ -647,7 +946,7 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
       if (progress->IsCancelled())
         break;
 
-      ScanDirectory(dir.c_str(), false, only_cache, excluded_paths, played_time, progress);
+      ScanDirectory(dir.c_str(), false, only_cache, excluded_paths, played_time, progress, scanned_directories);
       progress->SetProgressValue(++directory_counter);
     }
     for (const std::string& dir : recursive_dirs)
@@ -655,14 +954,134 @@ void GameList::Refresh(bool invalidate_cache, bool only_cache, ProgressCallback*
       if (progress->IsCancelled())
         break;
 
-      ScanDirectory(dir.c_str(), true, only_cache, excluded_paths, played_time, progress);
+      ScanDirectory(dir.c_str(), true, only_cache, excluded_paths, played_time, progress, scanned_directories);
       progress->SetProgressValue(++directory_counter);
     }
   }
 
-  // don't need unused cache entries
-  CloseCacheFileStream();
-  s_cache_map.clear();
+  // write out anything new, then we don't need the cache until the next refresh
+  {
+    std::unique_lock lock(s_mutex);
+    WriteCache();
+  }
+  ClearCache();
+}
+
+bool GameList::IsPathWithinDirectory(const std::string_view& path, const std::string_view& dir)
+{
+  return (path.length() > dir.length() && path.starts_with(dir) &&
+          (path[dir.length()] == FS_OSPATH_SEPARATOR_CHARACTER || path[dir.length()] == '/'));
+}
+
+void GameList::RemoveChangedEntries(const std::string& dir)
+{
+  // If the directory itself is gone, so is everything beneath it.
+  const bool dir_exists = FileSystem::DirectoryExists(dir.c_str());
+
+  std::unique_lock lock(s_mutex);
+  for (auto it = s_entries.begin(); it != s_entries.end();)
+  {
+    bool remove;
+    if (!dir_exists)
+    {
+      remove = IsPathWithinDirectory(it->path, dir);
+    }
+    else if (Path::GetDirectory(it->path) != dir)
+    {
+      remove = false;
+    }
+    else
+    {
+      FILESYSTEM_STAT_DATA sd;
+      remove = (!FileSystem::StatFile(it->path.c_str(), &sd) || sd.ModificationTime != it->last_modified_time);
+    }
+
+    if (remove)
+    {
+      Log_DevPrintf("Removing changed entry '%s'", it->path.c_str());
+      it = s_entries.erase(it);
+      s_entries_version++;
+      s_cache_dirty = true;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+std::vector<std::string> GameList::RefreshDirectories(const std::vector<std::string>& dirs,
+                                                      const std::vector<std::string>& known_dirs,
+                                                      ProgressCallback* progress /* = nullptr */)
+{
+  std::vector<std::string> new_dirs;
+  if (!progress)
+    progress = ProgressCallback::NullProgressCallback;
+
+  LoadCache();
+
+  const std::vector<std::string> excluded_paths(Host::GetBaseStringListSetting("GameList", "ExcludedPaths"));
+  const std::vector<std::string> paths(Host::GetBaseStringListSetting("GameList", "Paths"));
+  std::vector<std::string> recursive_paths(Host::GetBaseStringListSetting("GameList", "RecursivePaths"));
+  const PlayedTimeMap played_time(LoadPlayedTimeMap());
+
+#ifdef __ANDROID__
+  recursive_paths.push_back(Path::Combine(EmuFolders::DataRoot, "games"));
+#endif
+
+  // Everything else in the list was found in the cache last time, so mark it as used, otherwise it'd be written twice.
+  {
+    std::unique_lock lock(s_mutex);
+    Entry cached_entry;
+    for (const Entry& entry : s_entries)
+      GetGameListEntryFromCache(entry.path, &cached_entry);
+  }
+
+  std::vector<std::string> sorted_known_dirs(known_dirs);
+  std::sort(sorted_known_dirs.begin(), sorted_known_dirs.end());
+
+  progress->SetProgressRange(static_cast<u32>(dirs.size()));
+  progress->SetProgressValue(0);
+
+  int directory_counter = 0;
+  for (const std::string& dir : dirs)
+  {
+    if (progress->IsCancelled())
+      break;
+
+    // Ignore anything which isn't part of the list, e.g. a path which was removed since it was watched.
+    const bool in_recursive_path =
+      std::any_of(recursive_paths.begin(), recursive_paths.end(), [&dir](const std::string& path) {
+        return (dir == path || IsPathWithinDirectory(dir, path));
+      });
+    if (in_recursive_path || std::find(paths.begin(), paths.end(), dir) != paths.end())
+    {
+      RemoveChangedEntries(dir);
+      ScanDirectory(dir.c_str(), false, false, excluded_paths, played_time, progress, nullptr);
+
+      // New subdirectories haven't been seen at all, so they need a full scan.
+      if (in_recursive_path)
+      {
+        FileSystem::FindResultsArray subdirs;
+        FileSystem::FindFiles(dir.c_str(), "*", FILESYSTEM_FIND_FOLDERS | FILESYSTEM_FIND_HIDDEN_FILES, &subdirs);
+        for (const FILESYSTEM_FIND_DATA& subdir : subdirs)
+        {
+          if (!std::binary_search(sorted_known_dirs.begin(), sorted_known_dirs.end(), subdir.FileName))
+            ScanDirectory(subdir.FileName.c_str(), true, false, excluded_paths, played_time, progress, &new_dirs);
+        }
+      }
+    }
+
+    progress->SetProgressValue(++directory_counter);
+  }
+
+  {
+    std::unique_lock lock(s_mutex);
+    WriteCache();
+  }
+  ClearCache();
+
+  return new_dirs;
 }
 
 std::string GameList::GetCoverImagePathForEntry(const Entry* entry)
@@ -758,6 +1177,11 @@ std::string GameList::GetPlayedTimeFile()
   return Path::Combine(EmuFolders::DataRoot, "playtime.dat");
 }
 
+std::string GameList::GetPlayedTimeJournalFile()
+{
+  return Path::Combine(EmuFolders::DataRoot, "playtime.journal");
+}
+
 bool GameList::ParsePlayedTimeLine(char* line, std::string& serial, PlayedTimeEntry& entry)
 {
   size_t len = std::strlen(line);
@@ -794,120 +1218,162 @@ std::string GameList::MakePlayedTimeLine(const std::string& serial, const Played
                      entry.last_played_time, static_cast<unsigned>(PLAYED_TIME_LAST_TIME_LENGTH));
 }
 
-GameList::PlayedTimeMap GameList::LoadPlayedTimeMap(const std::string& path)
+FileSystem::ManagedCFilePtr GameList::OpenPlayedTimeFile(const std::string& path, const char* mode)
 {
-  PlayedTimeMap ret;
-
-  // Use write mode here, even though we're not writing, so we can lock the file from other updates.
-  auto fp = FileSystem::OpenManagedCFile(path.c_str(), "r+b");
+  auto fp = FileSystem::OpenManagedCFile(path.c_str(), mode);
 
 #ifdef _WIN32
   // On Windows, the file is implicitly locked.
   while (!fp && GetLastError() == ERROR_SHARING_VIOLATION)
   {
     Sleep(10);
-    fp = FileSystem::OpenManagedCFile(path.c_str(), "r+b");
+    fp = FileSystem::OpenManagedCFile(path.c_str(), mode);
   }
 #endif
 
-  if (fp)
+  return fp;
+}
+
+void GameList::ReadPlayedTimeLines(std::FILE* fp, bool journal, PlayedTimeMap* map)
+{
+  char line[256];
+  while (std::fgets(line, sizeof(line), fp))
   {
-#ifndef _WIN32
-    FileSystem::POSIXLock flock(fp.get());
-#endif
+    std::string serial;
+    PlayedTimeEntry entry;
+    if (!ParsePlayedTimeLine(line, serial, entry))
+      continue;
 
-    char line[256];
-    while (std::fgets(line, sizeof(line), fp.get()))
+    if (journal)
     {
-      std::string serial;
-      PlayedTimeEntry entry;
-      if (!ParsePlayedTimeLine(line, serial, entry))
-        continue;
-
-      if (ret.find(serial) != ret.end())
-      {
-        Log_WarningPrintf("Duplicate entry: '%s'", serial.c_str());
-        continue;
-      }
+      // Journal records are relative to what came before them, a zero last played time resets the serial.
+      PlayedTimeEntry& existing = (*map)[std::move(serial)];
+      existing.last_played_time = entry.last_played_time;
+      existing.total_played_time =
+        (entry.last_played_time != 0) ? (existing.total_played_time + entry.total_played_time) : 0;
+      continue;
+    }
 
-      ret.emplace(std::move(serial), entry);
+    if (map->find(serial) != map->end())
+    {
+      Log_WarningPrintf("Duplicate entry: '%s'", serial.c_str());
+      continue;
     }
-  }
 
-  return ret;
+    map->emplace(std::move(serial), entry);
+  }
 }
 
-GameList::PlayedTimeEntry GameList::UpdatePlayedTimeFile(const std::string& path, const std::string& serial,
-                                                         std::time_t last_time, std::time_t add_time)
+GameList::PlayedTimeMap GameList::LoadPlayedTimeMap()
 {
-  const PlayedTimeEntry new_entry{last_time, add_time};
-
-  auto fp = FileSystem::OpenManagedCFile(path.c_str(), "r+b");
+  PlayedTimeMap ret;
 
-#ifdef _WIN32
-  // On Windows, the file is implicitly locked.
-  while (!fp && GetLastError() == ERROR_SHARING_VIOLATION)
+  // Use write mode here, even though we're not writing, so we can lock the file from other updates.
+  // The snapshot is always locked before the journal, so this can't deadlock with a compaction.
+  auto fp = OpenPlayedTimeFile(GetPlayedTimeFile(), "r+b");
+  if (fp)
   {
-    Sleep(10);
-    fp = FileSystem::OpenManagedCFile(path.c_str(), "r+b");
+#ifndef _WIN32
+    FileSystem::POSIXLock flock(fp.get());
+#endif
+    ReadPlayedTimeLines(fp.get(), false, &ret);
   }
+
+  auto journal_fp = OpenPlayedTimeFile(GetPlayedTimeJournalFile(), "r+b");
+  if (journal_fp)
+  {
+#ifndef _WIN32
+    FileSystem::POSIXLock journal_flock(journal_fp.get());
 #endif
+    ReadPlayedTimeLines(journal_fp.get(), true, &ret);
+  }
 
-  // Doesn't exist? Create it.
-  if (!fp && errno == ENOENT)
-    fp = FileSystem::OpenManagedCFile(path.c_str(), "w+b");
+  return ret;
+}
 
+bool GameList::AppendPlayedTimeJournal(const std::string& serial, std::time_t last_time, std::time_t add_time)
+{
+  const std::string path(GetPlayedTimeJournalFile());
+  auto fp = OpenPlayedTimeFile(path, "ab");
   if (!fp)
   {
     Log_ErrorPrintf("Failed to open '%s' for update.", path.c_str());
-    return new_entry;
+    return false;
   }
 
+  s64 size;
+  {
 #ifndef _WIN32
-  FileSystem::POSIXLock flock(fp.get());
+    FileSystem::POSIXLock flock(fp.get());
 #endif
 
-  for (;;)
+    const std::string line(MakePlayedTimeLine(serial, PlayedTimeEntry{last_time, add_time}));
+    if (std::fwrite(line.data(), line.length(), 1, fp.get()) != 1 || std::fflush(fp.get()) != 0)
+    {
+      Log_ErrorPrintf("Failed to write '%s'.", path.c_str());
+      return false;
+    }
+
+    size = FileSystem::FSize64(fp.get());
+  }
+
+  fp.reset();
+  if (size >= static_cast<s64>(PLAYED_TIME_JOURNAL_COMPACT_SIZE))
+    CompactPlayedTimeJournal();
+
+  return true;
+}
+
+void GameList::CompactPlayedTimeJournal()
+{
+  const std::string path(GetPlayedTimeFile());
+  auto fp = OpenPlayedTimeFile(path, "r+b");
+  if (!fp && errno == ENOENT)
+    fp = OpenPlayedTimeFile(path, "w+b");
+  if (!fp)
   {
-    char line[256];
-    const s64 line_pos = FileSystem::FTell64(fp.get());
-    if (!std::fgets(line, sizeof(line), fp.get()))
-      break;
+    Log_ErrorPrintf("Failed to open '%s' for compaction.", path.c_str());
+    return;
+  }
 
-    std::string line_serial;
-    PlayedTimeEntry line_entry;
-    if (!ParsePlayedTimeLine(line, line_serial, line_entry))
-      continue;
+#ifndef _WIN32
+  FileSystem::POSIXLock flock(fp.get());
+#endif
 
-    if (line_serial != serial)
-      continue;
+  const std::string journal_path(GetPlayedTimeJournalFile());
+  auto journal_fp = OpenPlayedTimeFile(journal_path, "r+b");
+  if (!journal_fp)
+    return;
 
-    // found it!
-    line_entry.last_played_time = (last_time != 0) ? last_time : 0;
-    line_entry.total_played_time = (last_time != 0) ? (line_entry.total_played_time + add_time) : 0;
+#ifndef _WIN32
+  FileSystem::POSIXLock journal_flock(journal_fp.get());
+#endif
 
-    std::string new_line(MakePlayedTimeLine(serial, line_entry));
-    if (FileSystem::FSeek64(fp.get(), line_pos, SEEK_SET) != 0 ||
-        std::fwrite(new_line.data(), new_line.length(), 1, fp.get()) != 1)
-    {
-      Log_ErrorPrintf("Failed to update '%s'.", path.c_str());
-    }
+  // Another instance may have compacted the journal between our append and taking the locks.
+  PlayedTimeMap map;
+  ReadPlayedTimeLines(fp.get(), false, &map);
+  ReadPlayedTimeLines(journal_fp.get(), true, &map);
+  if (map.empty())
+    return;
 
-    return line_entry;
-  }
+  std::string data;
+  data.reserve(map.size() * (PLAYED_TIME_LINE_LENGTH + 1));
+  for (const auto& [serial, entry] : map)
+    data.append(MakePlayedTimeLine(serial, entry));
 
-  if (last_time != 0)
+  // Rewritten in place rather than replaced, so the lock stays held throughout.
+  if (FileSystem::FSeek64(fp.get(), 0, SEEK_SET) != 0 || std::fwrite(data.data(), data.length(), 1, fp.get()) != 1 ||
+      !FileSystem::FTruncate64(fp.get(), static_cast<s64>(data.length())))
   {
-    // new entry.
-    std::string new_line(MakePlayedTimeLine(serial, new_entry));
-    if (FileSystem::FSeek64(fp.get(), 0, SEEK_END) != 0 ||
-        std::fwrite(new_line.data(), new_line.length(), 1, fp.get()) != 1)
-    {
-      Log_ErrorPrintf("Failed to write '%s'.", path.c_str());
-    }
+    // The journal is kept, so nothing is lost, the next load replays it over whatever was written.
+    Log_ErrorPrintf("Failed to write '%s'.", path.c_str());
+    return;
   }
 
-  return new_entry;
+  if (!FileSystem::FTruncate64(journal_fp.get(), 0))
+    Log_ErrorPrintf("Failed to truncate '%s'.", journal_path.c_str());
+  else
+    Log_DevPrintf("Compacted played time journal into %zu entries.", map.size());
 }
 
 void GameList::AddPlayedTimeForSerial(const std::string& serial, std::time_t last_time, std::time_t add_time)
@@ -915,9 +1381,7 @@ void GameList::AddPlayedTimeForSerial(const std::string& serial, std::time_t las
   if (serial.empty())
     return;
 
-  const PlayedTimeEntry pt(UpdatePlayedTimeFile(GetPlayedTimeFile(), serial, last_time, add_time));
-  Log_VerbosePrintf("Add %u seconds play time to %s -> now %u", static_cast<unsigned>(add_time), serial.c_str(),
-                    static_cast<unsigned>(pt.total_played_time));
+  AppendPlayedTimeJournal(serial, last_time, add_time);
 
   std::unique_lock<std::recursive_mutex> lock(s_mutex);
   for (GameList::Entry& entry : s_entries)
@@ -925,9 +1389,12 @@ void GameList::AddPlayedTimeForSerial(const std::string& serial, std::time_t las
     if (entry.serial != serial)
       continue;
 
-    entry.last_played_time = pt.last_played_time;
-    entry.total_played_time = pt.total_played_time;
+    entry.last_played_time = last_time;
+    entry.total_played_time += add_time;
+    Log_VerbosePrintf("Add %u seconds play time to %s -> now %u", static_cast<unsigned>(add_time), serial.c_str(),
+                      static_cast<unsigned>(entry.total_played_time));
   }
+  s_entries_version++;
 }
 
 void GameList::ClearPlayedTimeForSerial(const std::string& serial)
@@ -935,7 +1402,7 @@ void GameList::ClearPlayedTimeForSerial(const std::string& serial)
   if (serial.empty())
     return;
 
-  UpdatePlayedTimeFile(GetPlayedTimeFile(), serial, 0, 0);
+  AppendPlayedTimeJournal(serial, 0, 0);
 
   std::unique_lock<std::recursive_mutex> lock(s_mutex);
   for (GameList::Entry& entry : s_entries)
@@ -946,6 +1413,7 @@ void GameList::ClearPlayedTimeForSerial(const std::string& serial)
     entry.last_played_time = 0;
     entry.total_played_time = 0;
   }
+  s_entries_version++;
 }
 
 std::time_t GameList::GetCachedPlayedTimeForSerial(const std::string& serial)
@@ -1145,8 +1613,19 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
   progress->SetCancellable(true);
   progress->SetProgressRange(static_cast<u32>(download_urls.size()));
 
+  // Covers mostly come from the same host, so several share its connections instead of waiting for each other.
+  downloader->SetMaxActiveRequests(MAX_CONCURRENT_COVER_DOWNLOADS);
+  u32 requests_in_flight = 0;
+
   for (auto& [entry_path, url] : download_urls)
   {
+    // Don't queue more than can be running, so cancelling doesn't have to wait for the rest of the list.
+    while (requests_in_flight >= MAX_CONCURRENT_COVER_DOWNLOADS && !progress->IsCancelled())
+    {
+      Common::Timer::NanoSleep(1000000);
+      downloader->PollRequests();
+    }
+
     if (progress->IsCancelled())
       break;
 
@@ -1163,11 +1642,15 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
       progress->SetFormattedStatusText("Downloading cover for %s...", entry->title.c_str());
     }
 
-    // we could actually do a few in parallel here...
     std::string filename(HTTPDownloader::URLDecode(url));
+    requests_in_flight++;
     downloader->CreateRequest(
-      std::move(url), [use_serial, &save_callback, entry_path = std::move(entry_path), filename = std::move(filename)](
-                        s32 status_code, std::string content_type, HTTPDownloader::Request::Data data) {
+      std::move(url), [use_serial, &save_callback, &requests_in_flight, progress, entry_path = std::move(entry_path),
+                       filename = std::move(filename)](s32 status_code, std::string content_type,
+                                                       HTTPDownloader::Request::Data data) {
+        requests_in_flight--;
+        progress->IncrementProgressValue();
+
         if (status_code != HTTPDownloader::HTTP_STATUS_OK || data.empty())
           return;
 
@@ -1198,9 +1681,8 @@ bool GameList::DownloadCovers(const std::vector<std::string>& url_templates, boo
         if (FileSystem::WriteBinaryFile(write_path.c_str(), data.data(), data.size()) && save_callback)
           save_callback(entry, std::move(write_path));
       });
-    downloader->WaitForAllRequests();
-    progress->IncrementProgressValue();
   }
 
+  downloader->WaitForAllRequests();
   return true;
 }
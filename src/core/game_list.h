@@ -79,12 +79,24 @@ const Entry* GetEntryBySerial(const std::string_view& serial);
 const Entry* GetEntryBySerialAndHash(const std::string_view& serial, u64 hash);
 u32 GetEntryCount();
 
+/// Changes whenever entries are added, removed or modified, so anything derived from the list knows to rebuild.
+u32 GetEntriesVersion();
+
 bool IsGameListLoaded();
 
 /// Populates the game list with files in the configured directories.
 /// If invalidate_cache is set, all files will be re-scanned.
 /// If only_cache is set, no new files will be scanned, only those present in the cache.
-void Refresh(bool invalidate_cache, bool only_cache = false, ProgressCallback* progress = nullptr);
+/// If scanned_directories is set, every directory which was scanned (including subdirectories) is added to it.
+void Refresh(bool invalidate_cache, bool only_cache = false, ProgressCallback* progress = nullptr,
+             std::vector<std::string>* scanned_directories = nullptr);
+
+/// Updates the list for directories which have changed, without walking the rest of the configured directories.
+/// New and modified files are scanned, and entries for files which no longer exist are removed. Subdirectories of
+/// recursive paths which aren't in known_dirs are scanned in full, and returned along with their subdirectories.
+std::vector<std::string> RefreshDirectories(const std::vector<std::string>& dirs,
+                                            const std::vector<std::string>& known_dirs,
+                                            ProgressCallback* progress = nullptr);
 
 /// Add played time for the specified serial.
 void AddPlayedTimeForSerial(const std::string& serial, std::time_t last_time, std::time_t add_time);
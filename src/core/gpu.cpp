@@ -13,6 +13,7 @@
 
 #include "util/gpu_device.h"
 #include "util/imgui_manager.h"
+#include "util/media_capture.h"
 #include "util/postprocessing.h"
 #include "util/shadergen.h"
 #include "util/state_wrapper.h"
@@ -20,14 +21,15 @@
 #include "common/align.h"
 #include "common/file_system.h"
 #include "common/heap_array.h"
+#include "common/image.h"
 #include "common/log.h"
 #include "common/string_util.h"
 
 #include "stb_image_resize.h"
 #include "stb_image_write.h"
+#include "xxhash.h"
 
 #include <cmath>
-#include <thread>
 
 Log_SetChannel(GPU);
 
@@ -66,7 +68,8 @@ bool GPU::Initialize()
     return false;
   }
 
-  g_gpu_device->SetGPUTimingEnabled(g_settings.display_show_gpu);
+  g_gpu_device->SetGPUTimingEnabled(g_settings.display_show_gpu || g_settings.debugging.dump_gpu_timings ||
+                                     g_settings.gpu_dynamic_resolution);
 
   return true;
 }
@@ -77,6 +80,9 @@ void GPU::UpdateSettings(const Settings& old_settings)
   m_fifo_size = g_settings.gpu_fifo_size;
   m_max_run_ahead = g_settings.gpu_max_run_ahead;
 
+  // Most renderer settings change what ends up in VRAM without a command being sent.
+  m_vram_write_count++;
+
   if (m_force_ntsc_timings != g_settings.gpu_force_ntsc_timings || m_console_is_pal != System::IsPALRegion())
   {
     m_force_ntsc_timings = g_settings.gpu_force_ntsc_timings;
@@ -93,7 +99,8 @@ void GPU::UpdateSettings(const Settings& old_settings)
       Panic("Failed to compile display pipeline on settings change.");
   }
 
-  g_gpu_device->SetGPUTimingEnabled(g_settings.display_show_gpu);
+  g_gpu_device->SetGPUTimingEnabled(g_settings.display_show_gpu || g_settings.debugging.dump_gpu_timings ||
+                                     g_settings.gpu_dynamic_resolution);
 }
 
 void GPU::CPUClockChanged()
@@ -105,6 +112,14 @@ void GPU::UpdateResolutionScale()
 {
 }
 
+void GPU::UpdateDynamicResolution(float gpu_time)
+{
+}
+
+void GPU::SetRenderSkip(bool skip)
+{
+}
+
 std::tuple<u32, u32> GPU::GetEffectiveDisplayResolution(bool scaled /* = true */)
 {
   return std::tie(m_crtc_state.display_vram_width, m_crtc_state.display_vram_height);
@@ -128,6 +143,7 @@ void GPU::Reset(bool clear_vram)
   m_crtc_state.in_vblank = false;
   m_crtc_state.interlaced_field = 0;
   m_crtc_state.interlaced_display_field = 0;
+  m_vram_write_count++;
   SoftReset();
   UpdateDisplay();
 }
@@ -292,12 +308,18 @@ bool GPU::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_displ
     else
     {
       ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+      m_state_vram_offset = static_cast<u32>(sw.GetPosition());
       sw.DoBytes(m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16));
     }
   }
+  else if (!sw.IsReading())
+  {
+    m_state_vram_offset = 0;
+  }
 
   if (sw.IsReading())
   {
+    m_vram_write_count++;
     UpdateCRTCConfig();
     if (update_display)
       UpdateDisplay();
@@ -425,12 +447,18 @@ void GPU::WriteRegister(u32 offset, u32 value)
   switch (offset)
   {
     case 0x00:
+      if (GPUDump::IsRecording()) [[unlikely]]
+        GPUDump::RecordGP0(&value, 1);
+
       m_fifo.Push(value);
       ExecuteCommands();
       UpdateCommandTickEvent();
       return;
 
     case 0x04:
+      if (GPUDump::IsRecording()) [[unlikely]]
+        GPUDump::RecordGP1(value);
+
       WriteGP1(value);
       return;
 
@@ -453,6 +481,108 @@ void GPU::DMARead(u32* words, u32 word_count)
     words[i] = ReadGPUREAD();
 }
 
+void GPU::DMAWrite(u32 address, const u32* words, u32 word_count)
+{
+  if (GPUDump::IsRecording()) [[unlikely]]
+    GPUDump::RecordGP0(words, word_count);
+
+  // Fill the FIFO's storage directly, one contiguous run at a time, instead of pushing each word.
+  const u32 count = std::min(word_count, m_fifo.GetSpace());
+  if (count < word_count)
+    Log_ErrorPrintf("GPU FIFO overflow, dropping %u DMA words", word_count - count);
+
+  const auto [first, second] = m_fifo.PushSpans(count);
+  for (u64& dest : first)
+  {
+    u32 value;
+    std::memcpy(&value, words++, sizeof(value));
+    dest = (ZeroExtend64(address) << 32) | ZeroExtend64(value);
+    address += sizeof(u32);
+  }
+  for (u64& dest : second)
+  {
+    u32 value;
+    std::memcpy(&value, words++, sizeof(value));
+    dest = (ZeroExtend64(address) << 32) | ZeroExtend64(value);
+    address += sizeof(u32);
+  }
+}
+
+void GPU::PlaybackGP0(const u32* words, u32 word_count)
+{
+  while (word_count > 0)
+  {
+    const u32 count = std::min(word_count, m_fifo.GetSpace());
+    if (count == 0)
+    {
+      Log_ErrorPrintf("GPU FIFO is full of an incomplete command, dropping %u dump words", word_count);
+      break;
+    }
+
+    const auto [first, second] = m_fifo.PushSpans(count);
+    std::copy_n(words, first.size(), first.begin());
+    std::copy_n(words + first.size(), second.size(), second.begin());
+    words += count;
+    word_count -= count;
+
+    // Keep going until the FIFO is drained, or the command at the front is waiting for more words.
+    for (;;)
+    {
+      const u32 fifo_size = m_fifo.GetSize();
+      const BlitterState blitter_state = m_blitter_state;
+      m_pending_command_ticks = 0;
+      ExecuteCommands();
+
+      // Nothing reads back VRAM on playback.
+      while (m_blitter_state == BlitterState::ReadingVRAM)
+        ReadGPUREAD();
+
+      if (m_fifo.IsEmpty() || (m_fifo.GetSize() == fifo_size && m_blitter_state == blitter_state))
+        break;
+    }
+  }
+
+  m_pending_command_ticks = 0;
+  UpdateCommandTickEvent();
+}
+
+void GPU::PlaybackGP1(u32 value)
+{
+  WriteGP1(value);
+}
+
+void GPU::PlaybackVSync()
+{
+  FlushRender();
+  UpdateDisplay();
+
+  if (m_GPUSTAT.InInterleaved480iMode())
+    m_crtc_state.interlaced_display_field = m_crtc_state.interlaced_field ^ 1u;
+  else
+    m_crtc_state.interlaced_display_field = 0;
+
+  PlaybackFrameStart();
+}
+
+void GPU::PlaybackFrameStart()
+{
+  if (m_GPUSTAT.vertical_interlace)
+  {
+    m_crtc_state.interlaced_field ^= 1u;
+    m_GPUSTAT.interlaced_field = !m_crtc_state.interlaced_field;
+  }
+  else
+  {
+    m_crtc_state.interlaced_field = 0;
+    m_GPUSTAT.interlaced_field = 0u;
+  }
+
+  m_crtc_state.active_line_lsb =
+    m_GPUSTAT.InInterleaved480iMode() ?
+      Truncate8((m_crtc_state.regs.Y + BoolToUInt32(m_crtc_state.interlaced_display_field)) & u32(1)) :
+      0;
+}
+
 void GPU::EndDMAWrite()
 {
   m_fifo_pushed = true;
@@ -511,6 +641,13 @@ void GPU::SynchronizeCRTC()
   m_crtc_tick_event->InvokeEarly();
 }
 
+void GPU::UpdateCRTCTimerIRQ()
+{
+  // The event only reschedules itself when it has ticks to run, and the position has to be current either way.
+  m_crtc_tick_event->InvokeEarly(true);
+  UpdateCRTCTickEvent();
+}
+
 float GPU::ComputeHorizontalFrequency() const
 {
   const CRTCState& cs = m_crtc_state;
@@ -1721,6 +1858,23 @@ bool GPU::RenderDisplay(GPUFramebuffer* target, const Common::Rectangle<s32>& dr
   const u32 target_height = target ? target->GetHeight() : g_gpu_device->GetWindowHeight();
   const bool really_postfx = (postfx && HasDisplayTexture() && PostProcessing::IsActive() &&
                               PostProcessing::CheckTargets(hdformat, target_width, target_height));
+
+  // Static screens produce the same output every frame, so when nothing feeding into the display has changed since
+  // the last one, the kept output of the post-processing chain is presented again instead of re-running it.
+  bool cache_postfx_output = false;
+  if (really_postfx && !target)
+  {
+    const DisplayCacheKey key = GetDisplayCacheKey(draw_rect, target_width, target_height);
+    cache_postfx_output = (key == m_display_cache_key);
+    m_display_cache_key = key;
+    if (cache_postfx_output && PostProcessing::HasCachedOutput())
+      return PostProcessing::PresentCachedOutput();
+  }
+  else
+  {
+    m_display_cache_key = {};
+  }
+
   if (really_postfx)
   {
     g_gpu_device->ClearRenderTarget(PostProcessing::GetInputTexture(), 0);
@@ -1762,12 +1916,14 @@ bool GPU::RenderDisplay(GPUFramebuffer* target, const Common::Rectangle<s32>& dr
   g_gpu_device->PushUniformBuffer(&uniforms, sizeof(uniforms));
 
   g_gpu_device->SetViewportAndScissor(draw_rect.left, draw_rect.top, draw_rect.GetWidth(), draw_rect.GetHeight());
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::Display);
   g_gpu_device->Draw(3, 0);
+  g_gpu_device->EndTimingScope();
 
   if (really_postfx)
   {
     return PostProcessing::Apply(target, draw_rect.left, draw_rect.top, draw_rect.GetWidth(), draw_rect.GetHeight(),
-                                 m_display_texture_view_width, m_display_texture_view_height);
+                                 m_display_texture_view_width, m_display_texture_view_height, cache_postfx_output);
   }
   else
   {
@@ -1775,6 +1931,35 @@ bool GPU::RenderDisplay(GPUFramebuffer* target, const Common::Rectangle<s32>& dr
   }
 }
 
+GPU::DisplayCacheKey GPU::GetDisplayCacheKey(const Common::Rectangle<s32>& draw_rect, u32 target_width,
+                                             u32 target_height) const
+{
+  DisplayCacheKey key = {};
+  key.vram_write_count = m_vram_write_count;
+  key.texture = m_display_texture;
+  key.texture_width = m_display_texture->GetWidth();
+  key.texture_height = m_display_texture->GetHeight();
+  key.view_x = m_display_texture_view_x;
+  key.view_y = m_display_texture_view_y;
+  key.view_width = m_display_texture_view_width;
+  key.view_height = m_display_texture_view_height;
+  key.draw_left = draw_rect.left;
+  key.draw_top = draw_rect.top;
+  key.draw_width = draw_rect.GetWidth();
+  key.draw_height = draw_rect.GetHeight();
+  key.target_width = target_width;
+  key.target_height = target_height;
+
+  // Page flipping and field changes show different VRAM without anything being written.
+  key.display_vram_left = m_crtc_state.display_vram_left;
+  key.display_vram_top = m_crtc_state.display_vram_top;
+  key.interlaced_display_field =
+    IsInterlacedDisplayEnabled() ? (ZeroExtend32(m_crtc_state.interlaced_display_field) + 1) : 0;
+  key.display_24bit = m_GPUSTAT.display_area_color_depth_24;
+  key.display_scaling = g_settings.display_scaling;
+  return key;
+}
+
 Common::Rectangle<float> GPU::CalculateDrawRect(s32 window_width, s32 window_height, float* out_left_padding,
                                                 float* out_top_padding, float* out_scale, float* out_x_scale,
                                                 bool apply_aspect_ratio /* = true */) const
@@ -1896,7 +2081,7 @@ Common::Rectangle<s32> GPU::CalculateDrawRect(s32 window_width, s32 window_heigh
 static bool CompressAndWriteTextureToFile(u32 width, u32 height, std::string filename, FileSystem::ManagedCFilePtr fp,
                                           bool clear_alpha, bool flip_y, u32 resize_width, u32 resize_height,
                                           std::vector<u32> texture_data, u32 texture_data_stride,
-                                          GPUTexture::Format texture_format)
+                                          GPUTexture::Format texture_format, int png_quality)
 {
 
   const char* extension = std::strrchr(filename.c_str(), '.');
@@ -1941,7 +2126,11 @@ static bool CompressAndWriteTextureToFile(u32 width, u32 height, std::string fil
   };
 
   bool result = false;
-  if (StringUtil::Strcasecmp(extension, ".png") == 0)
+  if (StringUtil::Strcasecmp(extension, ".png") == 0 && texture_data_stride == (sizeof(u32) * width))
+  {
+    result = Common::RGBA8Image(width, height, texture_data.data()).SaveToFile(filename.c_str(), fp.get(), png_quality);
+  }
+  else if (StringUtil::Strcasecmp(extension, ".png") == 0)
   {
     result =
       (stbi_write_png_to_func(write_func, fp.get(), width, height, 4, texture_data.data(), texture_data_stride) != 0);
@@ -2033,20 +2222,40 @@ bool GPU::WriteDisplayTextureToFile(std::string filename, bool full_resolution /
   constexpr bool clear_alpha = true;
   const bool flip_y = g_gpu_device->UsesLowerLeftOrigin();
 
+  // Only used for frame dumps, where there can be thousands of them.
+  constexpr int png_quality = Common::RGBA8Image::FAST_SAVE_QUALITY;
+
   if (!compress_on_thread)
   {
     return CompressAndWriteTextureToFile(read_width, read_height, std::move(filename), std::move(fp), clear_alpha,
                                          flip_y, resize_width, resize_height, std::move(texture_data),
-                                         texture_data_stride, m_display_texture->GetFormat());
+                                         texture_data_stride, m_display_texture->GetFormat(), png_quality);
   }
 
-  std::thread compress_thread(CompressAndWriteTextureToFile, read_width, read_height, std::move(filename),
-                              std::move(fp), clear_alpha, flip_y, resize_width, resize_height, std::move(texture_data),
-                              texture_data_stride, m_display_texture->GetFormat());
-  compress_thread.detach();
+  // std::function needs a copyable callable, so the file handle is carried across as a raw pointer.
+  System::QueueImageWrite([read_width, read_height, filename = std::move(filename), fp = fp.release(), flip_y,
+                           resize_width, resize_height, texture_data = std::move(texture_data), texture_data_stride,
+                           format = m_display_texture->GetFormat()]() mutable {
+    CompressAndWriteTextureToFile(read_width, read_height, std::move(filename), FileSystem::ManagedCFilePtr(fp),
+                                  clear_alpha, flip_y, resize_width, resize_height, std::move(texture_data),
+                                  texture_data_stride, format, png_quality);
+  });
   return true;
 }
 
+bool GPU::SendDisplayToMediaCapture(MediaCapture* cap)
+{
+  if (!m_display_texture || m_display_texture_view_width <= 0 || m_display_texture_view_height <= 0)
+    return cap->DeliverVideoFrame(nullptr, 0, 0, 0, 0, false);
+
+  const bool result =
+    cap->DeliverVideoFrame(m_display_texture, static_cast<u32>(m_display_texture_view_x),
+                           static_cast<u32>(m_display_texture_view_y), static_cast<u32>(m_display_texture_view_width),
+                           static_cast<u32>(m_display_texture_view_height), g_gpu_device->UsesLowerLeftOrigin());
+  RestoreDeviceContext();
+  return result;
+}
+
 bool GPU::RenderScreenshotToBuffer(u32 width, u32 height, const Common::Rectangle<s32>& draw_rect, bool postfx,
                                    std::vector<u32>* out_pixels, u32* out_stride, GPUTexture::Format* out_format)
 {
@@ -2157,13 +2366,16 @@ bool GPU::RenderScreenshotToFile(std::string filename, bool internal_resolution
   {
     return CompressAndWriteTextureToFile(width, height, std::move(filename), std::move(fp), true,
                                          g_gpu_device->UsesLowerLeftOrigin(), width, height, std::move(pixels),
-                                         pixels_stride, pixels_format);
+                                         pixels_stride, pixels_format, Common::RGBA8Image::DEFAULT_SAVE_QUALITY);
   }
 
-  std::thread compress_thread(CompressAndWriteTextureToFile, width, height, std::move(filename), std::move(fp), true,
-                              g_gpu_device->UsesLowerLeftOrigin(), width, height, std::move(pixels), pixels_stride,
-                              pixels_format);
-  compress_thread.detach();
+  System::QueueImageWrite([width, height, filename = std::move(filename), fp = fp.release(),
+                           flip_y = g_gpu_device->UsesLowerLeftOrigin(), pixels = std::move(pixels), pixels_stride,
+                           pixels_format]() mutable {
+    CompressAndWriteTextureToFile(width, height, std::move(filename), FileSystem::ManagedCFilePtr(fp), true, flip_y,
+                                  width, height, std::move(pixels), pixels_stride, pixels_format,
+                                  Common::RGBA8Image::DEFAULT_SAVE_QUALITY);
+  });
   return true;
 }
 
@@ -2187,19 +2399,56 @@ bool GPU::DumpVRAMToFile(const char* filename)
   }
 }
 
-bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride, const void* buffer, bool remove_alpha)
+u64 GPU::GetVRAMHash()
 {
-  auto fp = FileSystem::OpenManagedCFile(filename, "wb");
-  if (!fp)
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  return XXH64(m_vram_ptr, VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16), 0);
+}
+
+u64 GPU::GetDisplayedVRAMHash()
+{
+  if (IsDisplayDisabled())
+    return 0;
+
+  // 24-bit pixels are packed, so each displayed pixel covers one and a half halfwords of VRAM.
+  const bool is_24bit = m_GPUSTAT.display_area_color_depth_24;
+  const u32 left = is_24bit ? (m_crtc_state.regs.X + ((m_crtc_state.display_vram_left - m_crtc_state.regs.X) * 3) / 2) :
+                              m_crtc_state.display_vram_left;
+  const u32 width = std::min<u32>(
+    is_24bit ? ((m_crtc_state.display_vram_width * 3u + 1u) / 2u) : m_crtc_state.display_vram_width, VRAM_WIDTH);
+  const u32 top = m_crtc_state.display_vram_top;
+  const u32 height = std::min<u32>(m_crtc_state.display_vram_height, VRAM_HEIGHT);
+
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+
+  // Include the mode, so a resolution or depth change with the same pixels still produces a different hash.
+  const u32 header[3] = {width, height, BoolToUInt32(is_24bit)};
+  XXH64_state_t* state = XXH64_createState();
+  XXH64_reset(state, 0);
+  XXH64_update(state, header, sizeof(header));
+
+  // The display area wraps around at the edges of VRAM.
+  const u32 first_span = std::min(width, VRAM_WIDTH - (left & VRAM_WIDTH_MASK));
+  for (u32 row = 0; row < height; row++)
   {
-    Log_ErrorPrintf("Can't open file '%s'", filename);
-    return false;
+    const u16* row_ptr = &m_vram_ptr[((top + row) & VRAM_HEIGHT_MASK) * VRAM_WIDTH];
+    XXH64_update(state, row_ptr + (left & VRAM_WIDTH_MASK), first_span * sizeof(u16));
+    if (first_span < width)
+      XXH64_update(state, row_ptr, (width - first_span) * sizeof(u16));
   }
 
-  auto rgba8_buf = std::make_unique<u32[]>(width * height);
+  const u64 hash = XXH64_digest(state);
+  XXH64_freeState(state);
+  return hash;
+}
+
+bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride, const void* buffer, bool remove_alpha)
+{
+  Common::RGBA8Image image;
+  image.SetSize(width, height);
 
   const char* ptr_in = static_cast<const char*>(buffer);
-  u32* ptr_out = rgba8_buf.get();
+  u32* ptr_out = image.GetPixels();
   for (u32 row = 0; row < height; row++)
   {
     const char* row_ptr_in = ptr_in;
@@ -2215,10 +2464,9 @@ bool GPU::DumpVRAMToFile(const char* filename, u32 width, u32 height, u32 stride
     ptr_in += stride;
   }
 
-  const auto write_func = [](void* context, void* data, int size) {
-    std::fwrite(data, 1, size, static_cast<std::FILE*>(context));
-  };
-  return (stbi_write_png_to_func(write_func, fp.get(), width, height, 4, rgba8_buf.get(), sizeof(u32) * width) != 0);
+  // Only the conversion needs the buffer, the encode can happen while emulation continues.
+  System::QueueImageWrite(filename, std::move(image), Common::RGBA8Image::FAST_SAVE_QUALITY);
+  return true;
 }
 
 void GPU::DrawDebugStateWindow()
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #pragma once
+#include "gpu_dump.h"
 #include "gpu_types.h"
 #include "timers.h"
 #include "types.h"
@@ -26,6 +27,7 @@ class GPUDevice;
 class GPUFramebuffer;
 class GPUTexture;
 class GPUPipeline;
+class MediaCapture;
 
 struct Settings;
 class TimingEvent;
@@ -113,10 +115,22 @@ public:
   ALWAYS_INLINE bool BeginDMAWrite() const { return (m_GPUSTAT.dma_direction == DMADirection::CPUtoGP0); }
   ALWAYS_INLINE void DMAWrite(u32 address, u32 value)
   {
+    if (GPUDump::IsRecording()) [[unlikely]]
+      GPUDump::RecordGP0(&value, 1);
+
     m_fifo.Push((ZeroExtend64(address) << 32) | ZeroExtend64(value));
   }
+  void DMAWrite(u32 address, const u32* words, u32 word_count);
   void EndDMAWrite();
 
+  // GPU dump playback. GP0 words are executed as soon as they're written, regardless of command timing.
+  void PlaybackGP0(const u32* words, u32 word_count);
+  void PlaybackGP1(u32 value);
+  void PlaybackVSync();
+
+  /// Moves to the next field, as the CRTC does at the end of vblank. Dumps start from a state saved in vblank.
+  void PlaybackFrameStart();
+
   /// Returns true if no data is being sent from VRAM to the DAC or that no portion of VRAM would be visible on screen.
   ALWAYS_INLINE bool IsDisplayDisabled() const
   {
@@ -151,12 +165,21 @@ public:
   /// Synchronizes the CRTC, updating the hblank timer.
   void SynchronizeCRTC();
 
+  /// Reschedules the CRTC event after the dot clock or hblank timer was reprogrammed, so its IRQ isn't late.
+  void UpdateCRTCTimerIRQ();
+
   /// Recompile shaders/recreate framebuffers when needed.
   virtual void UpdateSettings(const Settings& old_settings);
 
   /// Updates the resolution scale when it's set to automatic.
   virtual void UpdateResolutionScale();
 
+  /// Called after each presented frame with the GPU time it took in milliseconds, when dynamic resolution is enabled.
+  virtual void UpdateDynamicResolution(float gpu_time);
+
+  /// Called before each frame with whether it will be displayed. Renderers can drop draws for frames which won't be.
+  virtual void SetRenderSkip(bool skip);
+
   /// Returns the effective display resolution of the GPU.
   virtual std::tuple<u32, u32> GetEffectiveDisplayResolution(bool scaled = true);
 
@@ -182,6 +205,15 @@ public:
   // Dumps raw VRAM to a file.
   bool DumpVRAMToFile(const char* filename);
 
+  // Returns a hash of the VRAM contents, used for checking determinism.
+  u64 GetVRAMHash();
+
+  // Returns where VRAM was written in the last state saved, or zero if it went to a host texture instead.
+  ALWAYS_INLINE u32 GetStateVRAMOffset() const { return m_state_vram_offset; }
+
+  // Returns a hash of the VRAM region currently being displayed, or zero if the display is disabled.
+  u64 GetDisplayedVRAMHash();
+
   // Ensures all buffered vertices are drawn.
   virtual void FlushRender();
 
@@ -198,6 +230,9 @@ public:
   bool WriteDisplayTextureToFile(std::string filename, bool full_resolution = true, bool apply_aspect_ratio = true,
                                  bool compress_on_thread = false);
 
+  /// Sends the current display texture to a capture, as a black frame if nothing is being displayed.
+  bool SendDisplayToMediaCapture(MediaCapture* cap);
+
   /// Renders the display, optionally with postprocessing to the specified image.
   bool RenderScreenshotToBuffer(u32 width, u32 height, const Common::Rectangle<s32>& draw_rect, bool postfx,
                                 std::vector<u32>* out_pixels, u32* out_stride, GPUTexture::Format* out_format);
@@ -357,6 +392,11 @@ protected:
   // Pointer to VRAM, used for reads/writes. In the hardware backends, this is the shadow buffer.
   u16* m_vram_ptr = nullptr;
 
+  u32 m_state_vram_offset = 0;
+
+  // Bumped by anything which could change what's in VRAM, so the display can tell when a frame is the same as the last.
+  u32 m_vram_write_count = 0;
+
   union GPUSTAT
   {
     u32 bits;
@@ -572,6 +612,9 @@ protected:
   ALWAYS_INLINE u32 FifoPeek() { return Truncate32(m_fifo.Peek()); }
   ALWAYS_INLINE u32 FifoPeek(u32 i) { return Truncate32(m_fifo.Peek(i)); }
 
+  /// Moves count words from the front of the FIFO to the end of the blit buffer.
+  void FifoPopToBlitBuffer(u32 count);
+
   TickCount m_max_run_ahead = 128;
   u32 m_fifo_size = 128;
 
@@ -581,11 +624,39 @@ protected:
   void SetDisplayParameters(s32 display_width, s32 display_height, s32 active_left, s32 active_top, s32 active_width,
                             s32 active_height, float display_aspect_ratio);
 
+  /// Everything feeding into the display. When it matches the last frame, the post-processed output can be reused.
+  struct DisplayCacheKey
+  {
+    u32 vram_write_count;
+    GPUTexture* texture;
+    u32 texture_width;
+    u32 texture_height;
+    s32 view_x;
+    s32 view_y;
+    s32 view_width;
+    s32 view_height;
+    s32 draw_left;
+    s32 draw_top;
+    s32 draw_width;
+    s32 draw_height;
+    u32 target_width;
+    u32 target_height;
+    u16 display_vram_left;
+    u16 display_vram_top;
+    u32 interlaced_display_field;
+    bool display_24bit;
+    DisplayScalingMode display_scaling;
+
+    bool operator==(const DisplayCacheKey&) const = default;
+  };
+
   Common::Rectangle<float> CalculateDrawRect(s32 window_width, s32 window_height, float* out_left_padding,
                                              float* out_top_padding, float* out_scale, float* out_x_scale,
                                              bool apply_aspect_ratio = true) const;
 
   bool RenderDisplay(GPUFramebuffer* target, const Common::Rectangle<s32>& draw_rect, bool postfx);
+  DisplayCacheKey GetDisplayCacheKey(const Common::Rectangle<s32>& draw_rect, u32 target_width,
+                                     u32 target_height) const;
 
   s32 m_display_width = 0;
   s32 m_display_height = 0;
@@ -602,6 +673,8 @@ protected:
   s32 m_display_texture_view_width = 0;
   s32 m_display_texture_view_height = 0;
 
+  DisplayCacheKey m_display_cache_key = {};
+
   struct Stats
   {
     u32 num_vram_reads;
@@ -4,8 +4,11 @@
 #include "gpu_backend.h"
 #include "common/align.h"
 #include "common/log.h"
+#include "common/threading.h"
 #include "common/timer.h"
+#include "common/trace_recorder.h"
 #include "settings.h"
+#include "system.h"
 #include "util/state_wrapper.h"
 Log_SetChannel(GPUBackend);
 
@@ -104,15 +107,15 @@ void* GPUBackend::AllocateCommand(GPUBackendCommandType command, u32 size)
 
   for (;;)
   {
-    u32 read_ptr = m_command_fifo_read_ptr.load();
-    u32 write_ptr = m_command_fifo_write_ptr.load();
+    u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_acquire);
+    const u32 write_ptr = m_command_fifo_pending_write_ptr;
     if (read_ptr > write_ptr)
     {
       u32 available_size = read_ptr - write_ptr;
       while (available_size < (size + sizeof(GPUBackendCommandType)))
       {
-        WakeGPUThread();
-        read_ptr = m_command_fifo_read_ptr.load();
+        WaitForCommandSpace(read_ptr);
+        read_ptr = m_command_fifo_read_ptr.load(std::memory_order_acquire);
         available_size = (read_ptr > write_ptr) ? (read_ptr - write_ptr) : (COMMAND_QUEUE_SIZE - write_ptr);
       }
     }
@@ -121,12 +124,19 @@ void* GPUBackend::AllocateCommand(GPUBackendCommandType command, u32 size)
       const u32 available_size = COMMAND_QUEUE_SIZE - write_ptr;
       if ((size + sizeof(GPUBackendCommand)) > available_size)
       {
+        // Wrapping while the GPU thread is still at the start would make the queue look empty.
+        if (read_ptr == 0)
+        {
+          WaitForCommandSpace(read_ptr);
+          continue;
+        }
+
         // allocate a dummy command to wrap the buffer around
         GPUBackendCommand* dummy_cmd = reinterpret_cast<GPUBackendCommand*>(&m_command_fifo_data[write_ptr]);
         dummy_cmd->type = GPUBackendCommandType::Wraparound;
         dummy_cmd->size = available_size;
         dummy_cmd->params.bits = 0;
-        m_command_fifo_write_ptr.store(0);
+        m_command_fifo_pending_write_ptr = 0;
         continue;
       }
     }
@@ -140,8 +150,8 @@ void* GPUBackend::AllocateCommand(GPUBackendCommandType command, u32 size)
 
 u32 GPUBackend::GetPendingCommandSize() const
 {
-  const u32 read_ptr = m_command_fifo_read_ptr.load();
-  const u32 write_ptr = m_command_fifo_write_ptr.load();
+  const u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_acquire);
+  const u32 write_ptr = m_command_fifo_write_ptr.load(std::memory_order_acquire);
   return (write_ptr >= read_ptr) ? (write_ptr - read_ptr) : (COMMAND_QUEUE_SIZE - read_ptr + write_ptr);
 }
 
@@ -155,21 +165,75 @@ void GPUBackend::PushCommand(GPUBackendCommand* cmd)
   }
   else
   {
-    const u32 new_write_ptr = m_command_fifo_write_ptr.fetch_add(cmd->size) + cmd->size;
-    DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
-    UNREFERENCED_VARIABLE(new_write_ptr);
-    if (GetPendingCommandSize() >= THRESHOLD_TO_WAKE_GPU)
-      WakeGPUThread();
+    DebugAssert(reinterpret_cast<u8*>(cmd) == &m_command_fifo_data[m_command_fifo_pending_write_ptr]);
+    const u32 published_write_ptr = m_command_fifo_write_ptr.load(std::memory_order_relaxed);
+    m_command_fifo_pending_write_ptr += cmd->size;
+    DebugAssert(m_command_fifo_pending_write_ptr <= COMMAND_QUEUE_SIZE);
+
+    // Only the CPU thread writes the pointer, so a wrapped-around pending pointer always means there's enough to send.
+    if (m_command_fifo_pending_write_ptr < published_write_ptr ||
+        (m_command_fifo_pending_write_ptr - published_write_ptr) >= THRESHOLD_TO_PUBLISH)
+    {
+      PublishCommands();
+    }
+  }
+}
+
+void GPUBackend::PublishCommands()
+{
+  m_command_fifo_write_ptr.store(m_command_fifo_pending_write_ptr);
+  WakeGPUThread();
+}
+
+void GPUBackend::WaitForCommandSpace(u32 last_read_ptr)
+{
+  static constexpr double SPIN_TIME_NS = 50 * 1000;
+
+  // Make sure the GPU thread has something to chew on while we wait.
+  PublishCommands();
+
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+  while (m_command_fifo_read_ptr.load() == last_read_ptr)
+  {
+    if (Common::Timer::ConvertValueToNanoseconds(Common::Timer::GetCurrentValue() - start_time) < SPIN_TIME_NS)
+      continue;
+
+    // Recheck after raising the flag, otherwise the wakeup could be missed.
+    m_cpu_thread_waiting.store(true);
+    if (m_command_fifo_read_ptr.load() != last_read_ptr)
+    {
+      // If the GPU thread already cleared the flag, it's posting the semaphore too.
+      if (!m_cpu_thread_waiting.exchange(false))
+        m_wake_cpu_thread_semaphore.Wait();
+      break;
+    }
+
+    m_wake_cpu_thread_semaphore.Wait();
   }
+
+  m_cpu_stall_time.fetch_add(Common::Timer::GetCurrentValue() - start_time, std::memory_order_relaxed);
 }
 
 void GPUBackend::WakeGPUThread()
 {
-  std::unique_lock<std::mutex> lock(m_sync_mutex);
-  if (!m_gpu_thread_sleeping.load())
-    return;
+  if (m_gpu_thread_sleeping.load() && m_gpu_thread_sleeping.exchange(false))
+    m_wake_gpu_thread_semaphore.Post();
+}
 
-  m_wake_gpu_thread_cv.notify_one();
+void GPUBackend::WakeCPUThread()
+{
+  if (m_cpu_thread_waiting.load() && m_cpu_thread_waiting.exchange(false))
+    m_wake_cpu_thread_semaphore.Post();
+}
+
+u64 GPUBackend::GetCPUStallTime() const
+{
+  return static_cast<u64>(Common::Timer::ConvertValueToNanoseconds(m_cpu_stall_time.load(std::memory_order_relaxed)));
+}
+
+u64 GPUBackend::GetGPUStallTime() const
+{
+  return static_cast<u64>(Common::Timer::ConvertValueToNanoseconds(m_gpu_stall_time.load(std::memory_order_relaxed)));
 }
 
 void GPUBackend::StartGPUThread()
@@ -185,25 +249,34 @@ void GPUBackend::StopGPUThread()
   if (!m_use_gpu_thread)
     return;
 
+  PublishCommands();
   m_gpu_loop_done.store(true);
   WakeGPUThread();
   m_gpu_thread.Join();
   m_use_gpu_thread = false;
-  Log_InfoPrint("GPU thread stopped.");
+  Log_InfoPrintf("GPU thread stopped (CPU stalled %.2f ms, GPU stalled %.2f ms).",
+                 static_cast<double>(GetCPUStallTime()) / 1000000.0,
+                 static_cast<double>(GetGPUStallTime()) / 1000000.0);
 }
 
 void GPUBackend::Sync(bool allow_sleep)
 {
   if (!m_use_gpu_thread)
+  {
+    FlushRender();
     return;
+  }
 
   GPUBackendSyncCommand* cmd =
     static_cast<GPUBackendSyncCommand*>(AllocateCommand(GPUBackendCommandType::Sync, sizeof(GPUBackendSyncCommand)));
   cmd->allow_sleep = allow_sleep;
   PushCommand(cmd);
-  WakeGPUThread();
+  PublishCommands();
 
+  TRACE_SCOPE("GPUBackend::Sync");
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
   m_sync_semaphore.Wait();
+  m_cpu_stall_time.fetch_add(Common::Timer::GetCurrentValue() - start_time, std::memory_order_relaxed);
 }
 
 void GPUBackend::RunGPULoop()
@@ -211,27 +284,43 @@ void GPUBackend::RunGPULoop()
   static constexpr double SPIN_TIME_NS = 1 * 1000000;
   Common::Timer::Value last_command_time = 0;
 
+  Threading::SetNameOfCurrentThread("GPU Thread");
+  System::ApplyThreadCorePlacement(true);
+
   for (;;)
   {
-    u32 write_ptr = m_command_fifo_write_ptr.load();
-    u32 read_ptr = m_command_fifo_read_ptr.load();
+    u32 write_ptr = m_command_fifo_write_ptr.load(std::memory_order_acquire);
+    u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_relaxed);
     if (read_ptr == write_ptr)
     {
       const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
       if (Common::Timer::ConvertValueToNanoseconds(current_time - last_command_time) < SPIN_TIME_NS)
         continue;
 
-      std::unique_lock<std::mutex> lock(m_sync_mutex);
+      // Recheck after raising the flag, otherwise the wakeup could be missed.
       m_gpu_thread_sleeping.store(true);
-      m_wake_gpu_thread_cv.wait(lock, [this]() { return m_gpu_loop_done.load() || GetPendingCommandSize() > 0; });
-      m_gpu_thread_sleeping.store(false);
+      if (m_gpu_loop_done.load() || m_command_fifo_write_ptr.load() != read_ptr)
+      {
+        // If the CPU thread already cleared the flag, it's posting the semaphore too.
+        if (!m_gpu_thread_sleeping.exchange(false))
+          m_wake_gpu_thread_semaphore.Wait();
+      }
+      else
+      {
+        m_wake_gpu_thread_semaphore.Wait();
+      }
 
-      if (m_gpu_loop_done.load())
+      m_gpu_stall_time.fetch_add(Common::Timer::GetCurrentValue() - current_time, std::memory_order_relaxed);
+
+      if (m_gpu_loop_done.load() && m_command_fifo_write_ptr.load() == read_ptr)
         break;
       else
         continue;
     }
 
+    // Covers one batch of commands, the gaps show when the thread was waiting for work.
+    TRACE_SCOPE("GPUBackend::RunGPULoop");
+
     if (write_ptr < read_ptr)
       write_ptr = COMMAND_QUEUE_SIZE;
 
@@ -246,7 +335,7 @@ void GPUBackend::RunGPULoop()
         case GPUBackendCommandType::Wraparound:
         {
           DebugAssert(read_ptr == COMMAND_QUEUE_SIZE);
-          write_ptr = m_command_fifo_write_ptr.load();
+          write_ptr = m_command_fifo_write_ptr.load(std::memory_order_acquire);
           read_ptr = 0;
         }
         break;
@@ -254,6 +343,7 @@ void GPUBackend::RunGPULoop()
         case GPUBackendCommandType::Sync:
         {
           DebugAssert(read_ptr == write_ptr);
+          FlushRender();
           m_sync_semaphore.Post();
           allow_sleep = static_cast<const GPUBackendSyncCommand*>(cmd)->allow_sleep;
         }
@@ -267,6 +357,7 @@ void GPUBackend::RunGPULoop()
 
     last_command_time = allow_sleep ? 0 : Common::Timer::GetCurrentValue();
     m_command_fifo_read_ptr.store(read_ptr);
+    WakeCPUThread();
   }
 }
 
@@ -6,9 +6,7 @@
 #include "common/threading.h"
 #include "gpu_types.h"
 #include <atomic>
-#include <condition_variable>
 #include <memory>
-#include <mutex>
 #include <thread>
 
 #ifdef _MSC_VER
@@ -41,13 +39,22 @@ public:
   void PushCommand(GPUBackendCommand* cmd);
   void Sync(bool allow_sleep);
 
+  /// Returns the total time in nanoseconds the CPU thread has spent waiting on the GPU thread.
+  u64 GetCPUStallTime() const;
+
+  /// Returns the total time in nanoseconds the GPU thread has spent waiting for commands.
+  u64 GetGPUStallTime() const;
+
   /// Processes all pending GPU commands.
   void RunGPULoop();
 
 protected:
   void* AllocateCommand(GPUBackendCommandType command, u32 size);
   u32 GetPendingCommandSize() const;
+  void PublishCommands();
+  void WaitForCommandSpace(u32 last_read_ptr);
   void WakeGPUThread();
+  void WakeCPUThread();
   void StartGPUThread();
   void StopGPUThread();
 
@@ -69,25 +76,29 @@ protected:
   Common::Rectangle<u32> m_drawing_area{};
 
   Threading::KernelSemaphore m_sync_semaphore;
+  Threading::KernelSemaphore m_wake_gpu_thread_semaphore;
+  Threading::KernelSemaphore m_wake_cpu_thread_semaphore;
   std::atomic_bool m_gpu_thread_sleeping{false};
+  std::atomic_bool m_cpu_thread_waiting{false};
   std::atomic_bool m_gpu_loop_done{false};
   Threading::Thread m_gpu_thread;
   bool m_use_gpu_thread = false;
 
-  std::mutex m_sync_mutex;
-  std::condition_variable m_sync_cpu_thread_cv;
-  std::condition_variable m_wake_gpu_thread_cv;
-  bool m_sync_done = false;
-
   enum : u32
   {
     COMMAND_QUEUE_SIZE = 4 * 1024 * 1024,
-    THRESHOLD_TO_WAKE_GPU = 256
+    THRESHOLD_TO_PUBLISH = 256
   };
 
+  // The FIFO has a single producer (the CPU thread) and a single consumer (the GPU thread), so the pointers are the
+  // only synchronization needed. Commands are written ahead of m_command_fifo_write_ptr, and only become visible to
+  // the GPU thread once they're published, which happens in batches of THRESHOLD_TO_PUBLISH bytes.
   FixedHeapArray<u8, COMMAND_QUEUE_SIZE> m_command_fifo_data;
   alignas(64) std::atomic<u32> m_command_fifo_read_ptr{0};
+  std::atomic<u64> m_gpu_stall_time{0};
   alignas(64) std::atomic<u32> m_command_fifo_write_ptr{0};
+  u32 m_command_fifo_pending_write_ptr = 0;
+  std::atomic<u64> m_cpu_stall_time{0};
 };
 
 #ifdef _MSC_VER
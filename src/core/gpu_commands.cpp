@@ -37,20 +37,24 @@ void GPU::ExecuteCommands()
       {
         case BlitterState::Idle:
         {
-          const u32 command = FifoPeek(0) >> 24;
-          if ((this->*s_GP0_command_handler_table[command])())
-            continue;
-          else
-            goto batch_done;
+          // Draw-heavy games send long runs of primitives, so keep dispatching until one of them leaves the idle
+          // state or stalls waiting for the rest of its words, rather than going back through the state switch.
+          do
+          {
+            const u32 command = FifoPeek(0) >> 24;
+            if (!(this->*s_GP0_command_handler_table[command])())
+              goto batch_done;
+          } while (m_blitter_state == BlitterState::Idle && !m_fifo.IsEmpty() &&
+                   m_pending_command_ticks <= m_max_run_ahead);
+
+          continue;
         }
 
         case BlitterState::WritingVRAM:
         {
           DebugAssert(m_blit_remaining_words > 0);
           const u32 words_to_copy = std::min(m_blit_remaining_words, m_fifo.GetSize());
-          m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
-          for (u32 i = 0; i < words_to_copy; i++)
-            m_blit_buffer.push_back(FifoPop());
+          FifoPopToBlitBuffer(words_to_copy);
           m_blit_remaining_words -= words_to_copy;
 
           Log_DebugPrintf("VRAM write burst of %u words, %u words remaining", words_to_copy, m_blit_remaining_words);
@@ -82,11 +86,7 @@ void GPU::ExecuteCommands()
           const bool found_terminator = (terminator_index < m_fifo.GetSize());
           const u32 words_to_copy = std::min(terminator_index, m_fifo.GetSize());
           if (words_to_copy > 0)
-          {
-            m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
-            for (u32 i = 0; i < words_to_copy; i++)
-              m_blit_buffer.push_back(FifoPop());
-          }
+            FifoPopToBlitBuffer(words_to_copy);
 
           Log_DebugPrintf("Added %u words to polyline", words_to_copy);
           if (found_terminator)
@@ -95,6 +95,7 @@ void GPU::ExecuteCommands()
             m_fifo.RemoveOne();
             Log_DebugPrintf("Drawing poly-line with %u vertices", GetPolyLineVertexCount());
             DispatchRenderCommand();
+            m_vram_write_count++;
             m_blit_buffer.clear();
             EndCommand();
             continue;
@@ -115,6 +116,19 @@ void GPU::ExecuteCommands()
   m_syncing = false;
 }
 
+void GPU::FifoPopToBlitBuffer(u32 count)
+{
+  // Entries carry the DMA address in the upper half, so only the data words are copied out.
+  const auto [first, second] = m_fifo.PopSpans(count);
+  const size_t start = m_blit_buffer.size();
+  m_blit_buffer.resize(start + count);
+  u32* dst = &m_blit_buffer[start];
+  for (const u64 value : first)
+    *(dst++) = Truncate32(value);
+  for (const u64 value : second)
+    *(dst++) = Truncate32(value);
+}
+
 void GPU::EndCommand()
 {
   m_blitter_state = BlitterState::Idle;
@@ -357,6 +371,7 @@ bool GPU::HandleRenderPolygonCommand()
   m_fifo.RemoveOne();
 
   DispatchRenderCommand();
+  m_vram_write_count++;
   EndCommand();
   return true;
 }
@@ -389,6 +404,7 @@ bool GPU::HandleRenderRectangleCommand()
   m_fifo.RemoveOne();
 
   DispatchRenderCommand();
+  m_vram_write_count++;
   EndCommand();
   return true;
 }
@@ -411,6 +427,7 @@ bool GPU::HandleRenderLineCommand()
   m_fifo.RemoveOne();
 
   DispatchRenderCommand();
+  m_vram_write_count++;
   EndCommand();
   return true;
 }
@@ -465,7 +482,10 @@ bool GPU::HandleFillRectangleCommand()
   Log_DebugPrintf("Fill VRAM rectangle offset=(%u,%u), size=(%u,%u)", dst_x, dst_y, width, height);
 
   if (width > 0 && height > 0)
+  {
     FillVRAM(dst_x, dst_y, width, height, color);
+    m_vram_write_count++;
+  }
 
   m_stats.num_vram_fills++;
   AddCommandTicks(46 + ((width / 8) + 9) * height);
@@ -506,6 +526,7 @@ void GPU::FinishVRAMWrite()
     SynchronizeCRTC();
 
   FlushRender();
+  m_vram_write_count++;
 
   if (m_blit_remaining_words == 0)
   {
@@ -613,6 +634,7 @@ bool GPU::HandleCopyRectangleVRAMToVRAMCommand()
   {
     FlushRender();
     CopyVRAM(src_x, src_y, dst_x, dst_y, width, height);
+    m_vram_write_count++;
   }
 
   m_stats.num_vram_copies++;
@@ -0,0 +1,382 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "gpu_dump.h"
+#include "gpu.h"
+#include "input_movie.h"
+#include "netplay.h"
+#include "save_state_version.h"
+#include "settings.h"
+#include "system.h"
+
+#include "util/state_wrapper.h"
+
+#include "common/byte_stream.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/string_util.h"
+
+#include "fmt/format.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+Log_SetChannel(GPUDump);
+
+namespace GPUDump {
+namespace {
+enum class PacketType : u8
+{
+  GP0,
+  GP1,
+  VSync,
+};
+
+// Followed by state_size bytes of GPU state, then the packets.
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 state_version;
+  u32 state_size;
+  char serial[32];
+};
+} // namespace
+
+static constexpr u32 FILE_MAGIC = 0x44475344; // DSGD
+static constexpr u32 FILE_VERSION = 1;
+
+// Packets start with a word holding the type in the upper 8 bits, and the number of words which follow it.
+static constexpr u32 PACKET_TYPE_SHIFT = 24;
+static constexpr u32 PACKET_LENGTH_MASK = (1u << PACKET_TYPE_SHIFT) - 1;
+
+// GP0 writes are buffered into one packet until a GP1 write or vblank, or this many words.
+static constexpr u32 MAX_GP0_PACKET_WORDS = 64 * 1024;
+
+static bool WritePacket(PacketType type, const u32* words, u32 word_count, Error* error);
+static bool FlushGP0(Error* error);
+static bool WriteHeader(Error* error);
+static bool ReadDump(const char* path, Error* error);
+static bool LoadState(Error* error);
+
+static FileSystem::ManagedCFilePtr s_file;
+static u32 s_frame = 0;
+
+// Only used for recording.
+static std::vector<u32> s_gp0_buffer;
+static u32 s_frames_to_record = 0;
+static bool s_recording_pending = false;
+
+// Only loaded for playback.
+static std::vector<u8> s_state;
+static std::vector<u32> s_packets;
+static size_t s_packet_pos = 0;
+static u32 s_frame_count = 0;
+} // namespace GPUDump
+
+bool GPUDump::Internal::g_recording = false;
+bool GPUDump::Internal::g_playing = false;
+
+bool GPUDump::WritePacket(PacketType type, const u32* words, u32 word_count, Error* error)
+{
+  const u32 header = (static_cast<u32>(type) << PACKET_TYPE_SHIFT) | word_count;
+  if (std::fwrite(&header, sizeof(header), 1, s_file.get()) != 1 ||
+      (word_count > 0 && std::fwrite(words, sizeof(u32) * word_count, 1, s_file.get()) != 1))
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  return true;
+}
+
+bool GPUDump::FlushGP0(Error* error)
+{
+  if (s_gp0_buffer.empty())
+    return true;
+
+  const bool result = WritePacket(PacketType::GP0, s_gp0_buffer.data(), static_cast<u32>(s_gp0_buffer.size()), error);
+  s_gp0_buffer.clear();
+  return result;
+}
+
+bool GPUDump::WriteHeader(Error* error)
+{
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream::CreateGrowableMemoryStream();
+  StateWrapper sw(stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  g_gpu->RestoreDeviceContext();
+  if (!g_gpu->DoState(sw, nullptr, false) || sw.HasError())
+  {
+    Error::SetString(error, "Failed to save GPU state.");
+    return false;
+  }
+
+  FileHeader header = {};
+  header.magic = FILE_MAGIC;
+  header.version = FILE_VERSION;
+  header.state_version = SAVE_STATE_VERSION;
+  header.state_size = static_cast<u32>(stream->GetSize());
+  StringUtil::Strlcpy(header.serial, System::GetGameSerial(), sizeof(header.serial));
+  if (std::fwrite(&header, sizeof(header), 1, s_file.get()) != 1 ||
+      std::fwrite(stream->GetMemoryPointer(), header.state_size, 1, s_file.get()) != 1)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  return true;
+}
+
+bool GPUDump::StartRecording(const char* path, u32 num_frames, Error* error)
+{
+  if (!System::IsValid() || g_settings.IsRunaheadEnabled())
+  {
+    Error::SetString(error, "System is not running, or is running ahead.");
+    return false;
+  }
+
+  Stop();
+
+  s_file = FileSystem::OpenManagedCFile(path, "wb", error);
+  if (!s_file)
+    return false;
+
+  // The state has to come from vblank, so the first packet is the start of a frame.
+  s_frame = 0;
+  s_frames_to_record = num_frames;
+  s_recording_pending = true;
+  Log_InfoPrintf("Recording GPU dump to '%s' from the next frame.", path);
+  return true;
+}
+
+bool GPUDump::ReadDump(const char* path, Error* error)
+{
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(path, error);
+  if (!data.has_value())
+    return false;
+
+  FileHeader header = {};
+  if (data->size() >= sizeof(header))
+    std::memcpy(&header, data->data(), sizeof(header));
+  if (header.magic != FILE_MAGIC)
+  {
+    Error::SetString(error, "Not a GPU dump.");
+    return false;
+  }
+  if (header.version != FILE_VERSION || header.state_version != SAVE_STATE_VERSION)
+  {
+    Error::SetString(error, fmt::format("Unsupported GPU dump version {}, state version {}.", header.version,
+                                        header.state_version));
+    return false;
+  }
+  if ((data->size() - sizeof(header)) < header.state_size)
+  {
+    Error::SetString(error, "GPU dump state is truncated.");
+    return false;
+  }
+
+  const u8* state_start = data->data() + sizeof(header);
+  s_state.assign(state_start, state_start + header.state_size);
+
+  const size_t packet_words = (data->size() - sizeof(header) - header.state_size) / sizeof(u32);
+  s_packets.resize(packet_words);
+  std::memcpy(s_packets.data(), state_start + header.state_size, packet_words * sizeof(u32));
+
+  // A dump which was never finished ends at its last complete frame.
+  size_t pos = 0;
+  size_t end = 0;
+  s_frame_count = 0;
+  while (pos < s_packets.size())
+  {
+    const PacketType type = static_cast<PacketType>(s_packets[pos] >> PACKET_TYPE_SHIFT);
+    const u32 length = s_packets[pos] & PACKET_LENGTH_MASK;
+    if ((s_packets.size() - pos - 1) < length || type > PacketType::VSync || (type == PacketType::GP1 && length != 1))
+      break;
+
+    pos += 1 + length;
+    if (type == PacketType::VSync)
+    {
+      end = pos;
+      s_frame_count++;
+    }
+  }
+
+  s_packets.resize(end);
+  if (s_frame_count == 0)
+  {
+    Error::SetString(error, "GPU dump has no complete frames.");
+    return false;
+  }
+
+  return true;
+}
+
+bool GPUDump::LoadState(Error* error)
+{
+  StateWrapper sw(s_state.data(), s_state.size(), StateWrapper::Mode::Read, SAVE_STATE_VERSION);
+  g_gpu->RestoreDeviceContext();
+  if (!g_gpu->DoState(sw, nullptr, true) || sw.HasError())
+  {
+    Error::SetString(error, "Failed to load GPU state.");
+    return false;
+  }
+
+  g_gpu->PlaybackFrameStart();
+  s_packet_pos = 0;
+  s_frame = 0;
+  return true;
+}
+
+bool GPUDump::StartPlayback(const char* path, Error* error)
+{
+  if (!System::IsValid() || Netplay::IsActive() || InputMovie::IsActive())
+  {
+    Error::SetString(error, "System is not running, or is playing a netplay session or input movie.");
+    return false;
+  }
+
+  Stop();
+
+  if (!ReadDump(path, error) || !LoadState(error))
+  {
+    s_state.clear();
+    s_packets.clear();
+    return false;
+  }
+
+  Internal::g_playing = true;
+  Log_InfoPrintf("Playing %u frame GPU dump '%s', %zu bytes of packets.", s_frame_count, path,
+                 s_packets.size() * sizeof(u32));
+  return true;
+}
+
+void GPUDump::Stop()
+{
+  if (Internal::g_recording)
+  {
+    Error error;
+    if (!FlushGP0(&error) || std::fflush(s_file.get()) != 0)
+      Log_ErrorPrintf("Failed to finalize GPU dump: %s", error.GetDescription().c_str());
+
+    Log_InfoPrintf("GPU dump recording stopped after %u frames.", s_frame);
+    Internal::g_recording = false;
+  }
+  else if (Internal::g_playing)
+  {
+    Log_InfoPrintf("GPU dump playback stopped at frame %u of %u.", s_frame, s_frame_count);
+    Internal::g_playing = false;
+    s_state = {};
+    s_packets = {};
+  }
+
+  s_recording_pending = false;
+  s_gp0_buffer = {};
+  s_file.reset();
+}
+
+void GPUDump::RecordGP0(const u32* words, u32 word_count)
+{
+  s_gp0_buffer.insert(s_gp0_buffer.end(), words, words + word_count);
+  if (s_gp0_buffer.size() < MAX_GP0_PACKET_WORDS)
+    return;
+
+  Error error;
+  if (!FlushGP0(&error))
+  {
+    Log_ErrorPrintf("Failed to write GPU dump, stopping recording: %s", error.GetDescription().c_str());
+    Stop();
+  }
+}
+
+void GPUDump::RecordGP1(u32 value)
+{
+  Error error;
+  if (!FlushGP0(&error) || !WritePacket(PacketType::GP1, &value, 1, &error))
+  {
+    Log_ErrorPrintf("Failed to write GPU dump, stopping recording: %s", error.GetDescription().c_str());
+    Stop();
+  }
+}
+
+void GPUDump::FrameDone()
+{
+  Error error;
+  if (s_recording_pending)
+  {
+    s_recording_pending = false;
+    if (!WriteHeader(&error))
+    {
+      Log_ErrorPrintf("Failed to start GPU dump: %s", error.GetDescription().c_str());
+      Stop();
+      return;
+    }
+
+    Internal::g_recording = true;
+    return;
+  }
+
+  if (!Internal::g_recording)
+    return;
+
+  if (!FlushGP0(&error) || !WritePacket(PacketType::VSync, nullptr, 0, &error))
+  {
+    Log_ErrorPrintf("Failed to write GPU dump, stopping recording: %s", error.GetDescription().c_str());
+    Stop();
+    return;
+  }
+
+  s_frame++;
+  if (s_frames_to_record > 0 && s_frame == s_frames_to_record)
+    Stop();
+}
+
+void GPUDump::ExecuteFrame()
+{
+  DebugAssert(Internal::g_playing);
+
+  for (;;)
+  {
+    // Every dump has at least one vblank, so looping back to the start can't spin.
+    if (s_packet_pos == s_packets.size())
+    {
+      Error error;
+      if (!LoadState(&error))
+      {
+        Log_ErrorPrintf("Failed to restart GPU dump: %s", error.GetDescription().c_str());
+        Stop();
+        return;
+      }
+    }
+
+    const u32 header = s_packets[s_packet_pos];
+    const u32 length = header & PACKET_LENGTH_MASK;
+    const u32* words = s_packets.data() + s_packet_pos + 1;
+    s_packet_pos += 1 + length;
+
+    switch (static_cast<PacketType>(header >> PACKET_TYPE_SHIFT))
+    {
+      case PacketType::GP0:
+        g_gpu->PlaybackGP0(words, length);
+        break;
+
+      case PacketType::GP1:
+        g_gpu->PlaybackGP1(words[0]);
+        break;
+
+      case PacketType::VSync:
+      {
+        g_gpu->PlaybackVSync();
+        s_frame++;
+        System::FrameDone();
+        return;
+      }
+    }
+  }
+}
+
+u32 GPUDump::GetFrameCount()
+{
+  return Internal::g_playing ? s_frame_count : s_frame;
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "types.h"
+
+class Error;
+
+/// GPU dumps, for benchmarking the renderers without emulating the CPU. The GPU state including VRAM is saved at the
+/// end of a frame, followed by every GP0/GP1 write and vblank after it. Playback writes these straight to the GPU,
+/// ignoring command timing, so frames take only as long as the renderer does. VRAM reads are discarded on playback,
+/// and DMA source addresses aren't kept, so PGXP has no effect.
+namespace GPUDump {
+
+namespace Internal {
+extern bool g_recording;
+extern bool g_playing;
+} // namespace Internal
+
+ALWAYS_INLINE static bool IsRecording()
+{
+  return Internal::g_recording;
+}
+
+ALWAYS_INLINE static bool IsPlaying()
+{
+  return Internal::g_playing;
+}
+
+/// Starts recording the running system to path at the end of the current frame. If num_frames isn't zero, recording
+/// stops by itself after that many frames.
+bool StartRecording(const char* path, u32 num_frames, Error* error);
+
+/// Loads the dump at path into the running system's GPU, which replays it instead of running the CPU. Playback loops
+/// back to the start of the dump after the last frame.
+bool StartPlayback(const char* path, Error* error);
+
+/// Stops recording or playback. Recorded dumps remain playable if this is never called.
+void Stop();
+
+/// Called by the GPU for each write while recording.
+void RecordGP0(const u32* words, u32 word_count);
+void RecordGP1(u32 value);
+
+/// Called by the system at the end of each frame.
+void FrameDone();
+
+/// Writes the next frame of the dump to the GPU, ending with a vblank. Only valid while playing.
+void ExecuteFrame();
+
+u32 GetFrameCount();
+
+} // namespace GPUDump
@@ -15,15 +15,23 @@
 
 #include "common/align.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
 #include "common/log.h"
+#include "common/path.h"
 #include "common/scoped_guard.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 
 #include "IconsFontAwesome5.h"
 #include "imgui.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <sstream>
+#include <thread>
 #include <tuple>
 
 Log_SetChannel(GPU_HW);
@@ -33,6 +41,9 @@ Log_SetChannel(GPU_HW);
 static constexpr GPUTexture::Format VRAM_RT_FORMAT = GPUTexture::Format::RGBA8;
 static constexpr GPUTexture::Format VRAM_DS_FORMAT = GPUTexture::Format::D16;
 
+static constexpr u32 USED_BATCH_PIPELINES_SIGNATURE = 0x4C505355; // USPL
+static constexpr u32 USED_BATCH_PIPELINES_VERSION = 1;
+
 #ifdef _DEBUG
 static u32 s_draw_number = 0;
 #endif
@@ -93,7 +104,6 @@ static Common::Rectangle<u32> GetVRAMTransferBounds(u32 x, u32 y, u32 width, u32
   return out_rc;
 }
 
-namespace {
 class ShaderCompileProgressTracker
 {
 public:
@@ -105,9 +115,9 @@ public:
   }
   ~ShaderCompileProgressTracker() = default;
 
-  void Increment()
+  void Increment(u32 count = 1)
   {
-    m_progress++;
+    m_progress += count;
 
     const u64 tv = Common::Timer::GetCurrentValue();
     if ((tv - m_start_time) >= m_min_time && (tv - m_last_update_time) >= m_update_interval)
@@ -126,6 +136,62 @@ private:
   u32 m_progress;
   u32 m_total;
 };
+
+namespace {
+// Linear indices of the batch pipeline/fragment shader variants, used for tracking which have been compiled.
+struct BatchPipelineKey
+{
+  u8 depth_test;
+  u8 render_mode;
+  u8 texture_mode;
+  u8 transparency_mode;
+  u8 dithering;
+  u8 interlacing;
+
+  u32 GetPipelineIndex() const
+  {
+    u32 index = (depth_test * 4u) + render_mode;
+    index = (index * 9u) + texture_mode;
+    index = (index * 5u) + transparency_mode;
+    index = (index * 2u) + dithering;
+    return (index * 2u) + interlacing;
+  }
+
+  u32 GetFragmentShaderIndex() const
+  {
+    u32 index = (render_mode * 9u) + texture_mode;
+    index = (index * 2u) + dithering;
+    return (index * 2u) + interlacing;
+  }
+
+  static BatchPipelineKey FromPipelineIndex(u32 index)
+  {
+    BatchPipelineKey key;
+    key.interlacing = static_cast<u8>(index % 2u);
+    index /= 2u;
+    key.dithering = static_cast<u8>(index % 2u);
+    index /= 2u;
+    key.transparency_mode = static_cast<u8>(index % 5u);
+    index /= 5u;
+    key.texture_mode = static_cast<u8>(index % 9u);
+    index /= 9u;
+    key.render_mode = static_cast<u8>(index % 4u);
+    key.depth_test = static_cast<u8>(index / 4u);
+    return key;
+  }
+
+  static BatchPipelineKey FromFragmentShaderIndex(u32 index)
+  {
+    BatchPipelineKey key = {};
+    key.interlacing = static_cast<u8>(index % 2u);
+    index /= 2u;
+    key.dithering = static_cast<u8>(index % 2u);
+    index /= 2u;
+    key.texture_mode = static_cast<u8>(index % 9u);
+    key.render_mode = static_cast<u8>(index / 9u);
+    return key;
+  }
+};
 } // namespace
 
 GPU_HW::GPU_HW() : GPU()
@@ -139,6 +205,9 @@ GPU_HW::GPU_HW() : GPU()
 
 GPU_HW::~GPU_HW()
 {
+  StopPipelineCompileThread();
+  SaveUsedBatchPipelines();
+
   if (m_sw_renderer)
   {
     m_sw_renderer->Shutdown();
@@ -218,6 +287,8 @@ bool GPU_HW::Initialize()
   m_downsample_mode = GetDownsampleMode(m_resolution_scale);
   m_wireframe_mode = g_settings.gpu_wireframe_mode;
   m_disable_color_perspective = features.noperspective_interpolation && ShouldDisableColorPerspective();
+  m_lazy_batch_pipelines = g_settings.gpu_lazy_pipeline_compilation;
+  m_use_ubershaders = m_lazy_batch_pipelines && g_settings.gpu_use_ubershaders;
 
   CheckSettings();
 
@@ -246,10 +317,18 @@ void GPU_HW::Reset(bool clear_vram)
   GPU::Reset(clear_vram);
 
   m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
+  m_batch_drawn_blocks.Clear();
 
   m_vram_shadow.fill(0);
+  m_vram_shadow_stale_blocks.SetAll();
+
+  // Either VRAM is cleared, or a state is about to restore it along with the host texture, which is saved complete.
+  m_render_skipped_blocks.Clear();
   if (m_sw_renderer)
+  {
     m_sw_renderer->Reset(clear_vram);
+    m_sw_renderer_pending_blocks.Clear();
+  }
 
   m_batch = {};
   m_batch_ubo_data = {};
@@ -267,8 +346,19 @@ bool GPU_HW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
 
   if (host_texture)
   {
+    if (!sw.IsReading())
+    {
+      VRAMBlockMask all_blocks;
+      all_blocks.SetAll();
+      UpdateRenderSkippedBlocks(all_blocks);
+    }
+
     GPUTexture* tex = *host_texture;
-    if (sw.IsReading())
+    if (tex && IsNativeHostTexture(tex))
+    {
+      DoNativeHostTexture(tex, sw.IsReading());
+    }
+    else if (sw.IsReading())
     {
       if (tex->GetWidth() != m_vram_texture->GetWidth() || tex->GetHeight() != m_vram_texture->GetHeight() ||
           tex->GetSamples() != m_vram_texture->GetSamples())
@@ -305,6 +395,7 @@ bool GPU_HW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   if (sw.IsReading())
   {
     m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
+    m_batch_drawn_blocks.Clear();
     SetFullVRAMDirtyRectangle();
     ResetBatchVertexDepth();
   }
@@ -312,6 +403,50 @@ bool GPU_HW::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   return true;
 }
 
+bool GPU_HW::IsNativeHostTexture(const GPUTexture* tex) const
+{
+  // Multisampled VRAM can't be drawn to with the copy pipeline, so it always keeps full copies.
+  return (m_resolution_scale > 1 && !IsUsingMultisampling() && tex->GetWidth() == VRAM_WIDTH &&
+          tex->GetHeight() == VRAM_HEIGHT && tex->GetSamples() == 1);
+}
+
+void GPU_HW::DoNativeHostTexture(GPUTexture* tex, bool reading)
+{
+  static constexpr float uniforms[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  std::unique_ptr<GPUFramebuffer> fb;
+
+  if (reading)
+  {
+    // Nearest upscale, the next frame redraws most of it at full resolution anyway.
+    g_gpu_device->SetFramebuffer(m_vram_framebuffer.get());
+    g_gpu_device->SetTextureSampler(0, tex, g_gpu_device->GetNearestSampler());
+    g_gpu_device->SetViewportAndScissor(0, 0, m_vram_texture->GetWidth(), m_vram_texture->GetHeight());
+  }
+  else
+  {
+    if (!(fb = g_gpu_device->CreateFramebuffer(tex)))
+    {
+      Log_ErrorPrint("Failed to create native host texture framebuffer.");
+      return;
+    }
+
+    // Takes one texel per native pixel, so the mask bit in alpha is kept exactly.
+    UpdateVRAMReadTexture();
+    g_gpu_device->SetFramebuffer(fb.get());
+    g_gpu_device->SetTextureSampler(0, m_vram_read_texture.get(), g_gpu_device->GetNearestSampler());
+    g_gpu_device->SetViewportAndScissor(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  }
+
+  g_gpu_device->SetPipeline(m_copy_pipeline.get());
+  g_gpu_device->PushUniformBuffer(uniforms, sizeof(uniforms));
+  g_gpu_device->Draw(3, 0);
+
+  if (!reading)
+    tex->MakeReadyForSampling();
+
+  RestoreDeviceContext();
+}
+
 void GPU_HW::RestoreDeviceContext()
 {
   g_gpu_device->SetTextureSampler(0, m_vram_read_texture.get(), g_gpu_device->GetNearestSampler());
@@ -319,12 +454,21 @@ void GPU_HW::RestoreDeviceContext()
   g_gpu_device->SetViewport(0, 0, m_vram_texture->GetWidth(), m_vram_texture->GetHeight());
   SetScissor();
   m_batch_ubo_dirty = true;
+  m_device_context_dirty = false;
 }
 
 void GPU_HW::UpdateSettings(const Settings& old_settings)
 {
   GPU::UpdateSettings(old_settings);
 
+  if (!g_settings.gpu_dynamic_resolution || g_settings.gpu_resolution_scale != old_settings.gpu_resolution_scale)
+  {
+    m_dynamic_resolution_limit = 0;
+    m_dynamic_resolution_frames = 0;
+    m_dynamic_resolution_settle_windows = 0;
+    m_dynamic_resolution_gpu_time = 0.0f;
+  }
+
   const GPUDevice::Features features = g_gpu_device->GetFeatures();
 
   const u32 resolution_scale = CalculateResolutionScale();
@@ -350,7 +494,9 @@ void GPU_HW::UpdateSettings(const Settings& old_settings)
      (m_downsample_mode == GPUDownsampleMode::Box &&
       g_settings.gpu_downsample_scale != old_settings.gpu_downsample_scale) ||
      m_wireframe_mode != wireframe_mode || m_pgxp_depth_buffer != g_settings.UsingPGXPDepthBuffer() ||
-     m_disable_color_perspective != disable_color_perspective);
+     m_disable_color_perspective != disable_color_perspective ||
+     m_lazy_batch_pipelines != g_settings.gpu_lazy_pipeline_compilation ||
+     m_use_ubershaders != (g_settings.gpu_lazy_pipeline_compilation && g_settings.gpu_use_ubershaders));
 
   if (m_resolution_scale != resolution_scale)
   {
@@ -394,6 +540,8 @@ void GPU_HW::UpdateSettings(const Settings& old_settings)
   m_downsample_mode = downsample_mode;
   m_wireframe_mode = wireframe_mode;
   m_disable_color_perspective = disable_color_perspective;
+  m_lazy_batch_pipelines = g_settings.gpu_lazy_pipeline_compilation;
+  m_use_ubershaders = m_lazy_batch_pipelines && g_settings.gpu_use_ubershaders;
 
   CheckSettings();
 
@@ -496,7 +644,7 @@ void GPU_HW::CheckSettings()
   m_pgxp_depth_buffer = g_settings.UsingPGXPDepthBuffer();
 }
 
-u32 GPU_HW::CalculateResolutionScale() const
+u32 GPU_HW::CalculateResolutionScale(bool apply_dynamic_limit /* = true */) const
 {
   const u32 max_resolution_scale = GetMaxResolutionScale();
 
@@ -520,6 +668,10 @@ u32 GPU_HW::CalculateResolutionScale() const
     scale = static_cast<u32>(std::clamp<s32>(preferred_scale, 1, max_resolution_scale));
   }
 
+  // The configured scale is the most dynamic resolution will go up to.
+  if (apply_dynamic_limit && m_dynamic_resolution_limit != 0)
+    scale = std::min(scale, m_dynamic_resolution_limit);
+
   if (g_settings.gpu_downsample_mode == GPUDownsampleMode::Adaptive && scale > 1 && !Common::IsPow2(scale))
   {
     const u32 new_scale = Common::PreviousPow2(scale);
@@ -546,6 +698,78 @@ void GPU_HW::UpdateResolutionScale()
     UpdateSettings(g_settings);
 }
 
+void GPU_HW::UpdateDynamicResolution(float gpu_time)
+{
+  // Averaged over a second or so, single frames are too noisy to act on.
+  static constexpr u32 WINDOW_FRAMES = 60;
+
+  // Frames right after a change include pipeline compiles and the VRAM copy, so they're not representative.
+  static constexpr u32 SETTLE_WINDOWS = 2;
+
+  // Only goes up when the higher scale is predicted to fit with this much to spare, so it doesn't bounce.
+  static constexpr float UPSCALE_HEADROOM = 0.9f;
+
+  m_dynamic_resolution_gpu_time += gpu_time;
+  if (++m_dynamic_resolution_frames < WINDOW_FRAMES)
+    return;
+
+  const float average_time = m_dynamic_resolution_gpu_time / static_cast<float>(m_dynamic_resolution_frames);
+  m_dynamic_resolution_gpu_time = 0.0f;
+  m_dynamic_resolution_frames = 0;
+  if (m_dynamic_resolution_settle_windows > 0)
+  {
+    m_dynamic_resolution_settle_windows--;
+    return;
+  }
+
+  const float budget = (1000.0f / System::GetThrottleFrequency()) *
+                       (static_cast<float>(g_settings.gpu_dynamic_resolution_target) / 100.0f);
+
+  // Adaptive downsampling only works with power of two scales, so step between those.
+  const bool pow2_steps = (g_settings.gpu_downsample_mode == GPUDownsampleMode::Adaptive);
+  u32 new_scale = m_resolution_scale;
+  if (average_time > budget)
+  {
+    if (m_resolution_scale > 1)
+      new_scale = pow2_steps ? (m_resolution_scale / 2) : (m_resolution_scale - 1);
+  }
+  else
+  {
+    // Most of the GPU time is spent on fill, which goes up with the square of the scale.
+    const u32 up_scale = pow2_steps ? (m_resolution_scale * 2) : (m_resolution_scale + 1);
+    const float ratio = static_cast<float>(up_scale) / static_cast<float>(m_resolution_scale);
+    if ((average_time * ratio * ratio) < (budget * UPSCALE_HEADROOM) &&
+        up_scale <= CalculateResolutionScale(false))
+    {
+      new_scale = up_scale;
+    }
+  }
+
+  if (new_scale == m_resolution_scale)
+    return;
+
+  Log_DevPrintf("Dynamic resolution: %.2fms of %.2fms budget, scale %u -> %u", average_time, budget,
+                m_resolution_scale, new_scale);
+  m_dynamic_resolution_limit = new_scale;
+  m_dynamic_resolution_settle_windows = SETTLE_WINDOWS;
+  UpdateSettings(g_settings);
+}
+
+void GPU_HW::SetRenderSkip(bool skip)
+{
+  // Skipped areas can only be restored from the software renderer.
+  skip &= (m_sw_renderer != nullptr);
+  if (m_render_skip == skip)
+    return;
+
+  FlushRender();
+  m_render_skip = skip;
+
+  // Texture pages weren't checked while skipping, so the next draw has to.
+  if (!skip)
+    m_draw_mode.SetTexturePageChanged();
+}
+
 GPUDownsampleMode GPU_HW::GetDownsampleMode(u32 resolution_scale) const
 {
   return (resolution_scale == 1) ? GPUDownsampleMode::Disabled : g_settings.gpu_downsample_mode;
@@ -561,15 +785,136 @@ bool GPU_HW::IsUsingDownsampling() const
   return (m_downsample_mode != GPUDownsampleMode::Disabled && !m_GPUSTAT.display_area_color_depth_24);
 }
 
+ALWAYS_INLINE static u32 GetVRAMBlockColumnMask(u32 first, u32 end)
+{
+  // end is exclusive, and can be one past the last column.
+  return ((end >= 32) ? 0xFFFFFFFFu : ((1u << end) - 1u)) & ~((1u << first) - 1u);
+}
+
+void GPU_HW::VRAMBlockMask::Clear()
+{
+  rows.fill(0);
+}
+
+void GPU_HW::VRAMBlockMask::SetAll()
+{
+  rows.fill(0xFFFFFFFFu);
+}
+
+void GPU_HW::VRAMBlockMask::Include(u32 left, u32 right, u32 top, u32 bottom)
+{
+  right = std::min<u32>(right, VRAM_WIDTH);
+  bottom = std::min<u32>(bottom, VRAM_HEIGHT);
+  if (left >= right || top >= bottom)
+    return;
+
+  const u32 mask = GetVRAMBlockColumnMask(left / BLOCK_WIDTH, (right - 1) / BLOCK_WIDTH + 1);
+  for (u32 row = top / BLOCK_HEIGHT; row <= (bottom - 1) / BLOCK_HEIGHT; row++)
+    rows[row] |= mask;
+}
+
+void GPU_HW::VRAMBlockMask::IncludeWrapped(const Common::Rectangle<u32>& rect)
+{
+  if (!rect.Valid())
+    return;
+
+  const u32 left = rect.left % VRAM_WIDTH;
+  const u32 top = rect.top % VRAM_HEIGHT;
+  const u32 right = left + std::min<u32>(rect.GetWidth(), VRAM_WIDTH);
+  const u32 bottom = top + std::min<u32>(rect.GetHeight(), VRAM_HEIGHT);
+  Include(left, right, top, bottom);
+  if (right > VRAM_WIDTH)
+    Include(0, right - VRAM_WIDTH, top, bottom);
+  if (bottom > VRAM_HEIGHT)
+  {
+    Include(left, right, 0, bottom - VRAM_HEIGHT);
+    if (right > VRAM_WIDTH)
+      Include(0, right - VRAM_WIDTH, 0, bottom - VRAM_HEIGHT);
+  }
+}
+
+bool GPU_HW::VRAMBlockMask::Intersects(const Common::Rectangle<u32>& rect) const
+{
+  const u32 right = std::min<u32>(rect.right, VRAM_WIDTH);
+  const u32 bottom = std::min<u32>(rect.bottom, VRAM_HEIGHT);
+  if (rect.left >= right || rect.top >= bottom)
+    return false;
+
+  const u32 mask = GetVRAMBlockColumnMask(rect.left / BLOCK_WIDTH, (right - 1) / BLOCK_WIDTH + 1);
+  u32 hit = 0;
+  for (u32 row = rect.top / BLOCK_HEIGHT; row <= (bottom - 1) / BLOCK_HEIGHT; row++)
+    hit |= rows[row];
+  return ((hit & mask) != 0);
+}
+
+bool GPU_HW::VRAMBlockMask::Intersects(const VRAMBlockMask& mask) const
+{
+  u32 hit = 0;
+  for (u32 row = 0; row < BLOCKS_Y; row++)
+    hit |= rows[row] & mask.rows[row];
+  return (hit != 0);
+}
+
+GPU_HW::VRAMBlockMask GPU_HW::VRAMBlockMask::TakeIntersection(const VRAMBlockMask& mask)
+{
+  VRAMBlockMask ret;
+  for (u32 row = 0; row < BLOCKS_Y; row++)
+  {
+    ret.rows[row] = rows[row] & mask.rows[row];
+    rows[row] &= ~mask.rows[row];
+  }
+  return ret;
+}
+
+void GPU_HW::VRAMBlockMask::ClearContained(const Common::Rectangle<u32>& rect)
+{
+  const u32 first_col = (rect.left + (BLOCK_WIDTH - 1)) / BLOCK_WIDTH;
+  const u32 end_col = std::min<u32>(rect.right, VRAM_WIDTH) / BLOCK_WIDTH;
+  const u32 first_row = (rect.top + (BLOCK_HEIGHT - 1)) / BLOCK_HEIGHT;
+  const u32 end_row = std::min<u32>(rect.bottom, VRAM_HEIGHT) / BLOCK_HEIGHT;
+  if (first_col >= end_col)
+    return;
+
+  const u32 mask = GetVRAMBlockColumnMask(first_col, end_col);
+  for (u32 row = first_row; row < end_row; row++)
+    rows[row] &= ~mask;
+}
+
+void GPU_HW::VRAMBlockMask::GetRectangles(std::vector<Common::Rectangle<u32>>* rects) const
+{
+  // Greedily take each run of blocks in a row, and extend it down while the rows below cover the same run.
+  rects->clear();
+  std::array<u32, BLOCKS_Y> remaining = rows;
+  for (u32 row = 0; row < BLOCKS_Y; row++)
+  {
+    while (remaining[row] != 0)
+    {
+      const u32 first_col = CountTrailingZeros(remaining[row]);
+      const u32 run = ~(remaining[row] >> first_col);
+      const u32 end_col = (run == 0) ? BLOCKS_X : (first_col + CountTrailingZeros(run));
+      const u32 mask = GetVRAMBlockColumnMask(first_col, end_col);
+
+      u32 end_row = row + 1;
+      while (end_row < BLOCKS_Y && (remaining[end_row] & mask) == mask)
+        end_row++;
+      for (u32 i = row; i < end_row; i++)
+        remaining[i] &= ~mask;
+
+      rects->emplace_back(first_col * BLOCK_WIDTH, row * BLOCK_HEIGHT, end_col * BLOCK_WIDTH, end_row * BLOCK_HEIGHT);
+    }
+  }
+}
+
 void GPU_HW::SetFullVRAMDirtyRectangle()
 {
-  m_vram_dirty_rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  m_vram_dirty_blocks.SetAll();
   m_draw_mode.SetTexturePageChanged();
+  m_vram_shadow_stale_blocks.SetAll();
 }
 
 void GPU_HW::ClearVRAMDirtyRectangle()
 {
-  m_vram_dirty_rect.SetInvalid();
+  m_vram_dirty_blocks.Clear();
 }
 
 std::tuple<u32, u32> GPU_HW::GetEffectiveDisplayResolution(bool scaled /* = true */)
@@ -614,17 +959,17 @@ bool GPU_HW::CreateBuffers()
                                                GPUTexture::Type::RWTexture :
                                                GPUTexture::Type::Texture;
 
-  if (!(m_vram_texture = g_gpu_device->CreateTexture(texture_width, texture_height, 1, 1, samples,
+  if (!(m_vram_texture = g_gpu_device->FetchTexture(texture_width, texture_height, 1, 1, samples,
                                                      GPUTexture::Type::RenderTarget, VRAM_RT_FORMAT)) ||
-      !(m_vram_depth_texture = g_gpu_device->CreateTexture(texture_width, texture_height, 1, 1, samples,
+      !(m_vram_depth_texture = g_gpu_device->FetchTexture(texture_width, texture_height, 1, 1, samples,
                                                            GPUTexture::Type::DepthStencil, VRAM_DS_FORMAT)) ||
       !(m_vram_read_texture =
-          g_gpu_device->CreateTexture(texture_width, texture_height, 1, 1, 1, read_texture_type, VRAM_RT_FORMAT)) ||
-      !(m_display_private_texture = g_gpu_device->CreateTexture(
+          g_gpu_device->FetchTexture(texture_width, texture_height, 1, 1, 1, read_texture_type, VRAM_RT_FORMAT)) ||
+      !(m_display_private_texture = g_gpu_device->FetchTexture(
           ((m_downsample_mode == GPUDownsampleMode::Adaptive) ? VRAM_WIDTH : GPU_MAX_DISPLAY_WIDTH) *
             m_resolution_scale,
           GPU_MAX_DISPLAY_HEIGHT * m_resolution_scale, 1, 1, 1, GPUTexture::Type::RenderTarget, VRAM_RT_FORMAT)) ||
-      !(m_vram_readback_texture = g_gpu_device->CreateTexture(VRAM_WIDTH / 2, VRAM_HEIGHT, 1, 1, 1,
+      !(m_vram_readback_texture = g_gpu_device->FetchTexture(VRAM_WIDTH / 2, VRAM_HEIGHT, 1, 1, 1,
                                                               GPUTexture::Type::RenderTarget, VRAM_RT_FORMAT)))
   {
     return false;
@@ -662,13 +1007,13 @@ bool GPU_HW::CreateBuffers()
   {
     const u32 levels = GetAdaptiveDownsamplingMipLevels();
 
-    if (!(m_downsample_texture = g_gpu_device->CreateTexture(texture_width, texture_height, 1, levels, 1,
+    if (!(m_downsample_texture = g_gpu_device->FetchTexture(texture_width, texture_height, 1, levels, 1,
                                                              GPUTexture::Type::Texture, VRAM_RT_FORMAT)) ||
-        !(m_downsample_render_texture = g_gpu_device->CreateTexture(texture_width, texture_height, 1, 1, 1,
+        !(m_downsample_render_texture = g_gpu_device->FetchTexture(texture_width, texture_height, 1, 1, 1,
                                                                     GPUTexture::Type::RenderTarget, VRAM_RT_FORMAT)) ||
         !(m_downsample_framebuffer = g_gpu_device->CreateFramebuffer(m_downsample_render_texture.get())) ||
         !(m_downsample_weight_texture =
-            g_gpu_device->CreateTexture(texture_width >> (levels - 1), texture_height >> (levels - 1), 1, 1, 1,
+            g_gpu_device->FetchTexture(texture_width >> (levels - 1), texture_height >> (levels - 1), 1, 1, 1,
                                         GPUTexture::Type::RenderTarget, GPUTexture::Format::R8)) ||
         !(m_downsample_weight_framebuffer = g_gpu_device->CreateFramebuffer(m_downsample_weight_texture.get())))
     {
@@ -679,7 +1024,7 @@ bool GPU_HW::CreateBuffers()
   {
     const u32 downsample_scale = GetBoxDownsampleScale(m_resolution_scale);
     if (!(m_downsample_render_texture =
-            g_gpu_device->CreateTexture(VRAM_WIDTH * downsample_scale, VRAM_HEIGHT * downsample_scale, 1, 1, 1,
+            g_gpu_device->FetchTexture(VRAM_WIDTH * downsample_scale, VRAM_HEIGHT * downsample_scale, 1, 1, 1,
                                         GPUTexture::Type::RenderTarget, VRAM_RT_FORMAT)) ||
         !(m_downsample_framebuffer = g_gpu_device->CreateFramebuffer(m_downsample_render_texture.get())))
     {
@@ -707,90 +1052,176 @@ void GPU_HW::DestroyBuffers()
 
   m_vram_upload_buffer.reset();
   m_downsample_weight_framebuffer.reset();
-  m_downsample_weight_texture.reset();
   m_downsample_framebuffer.reset();
-  m_downsample_render_texture.reset();
-  m_downsample_texture.reset();
   m_display_framebuffer.reset();
   m_vram_readback_framebuffer.reset();
   m_vram_update_depth_framebuffer.reset();
   m_vram_framebuffer.reset();
-  m_vram_read_texture.reset();
   m_vram_depth_view.reset();
-  m_vram_depth_texture.reset();
-  m_vram_texture.reset();
-  m_vram_readback_texture.reset();
-  m_display_private_texture.reset();
+
+  // Toggling a setting often recreates most of these at the same size.
+  g_gpu_device->RecycleTexture(std::move(m_downsample_weight_texture));
+  g_gpu_device->RecycleTexture(std::move(m_downsample_render_texture));
+  g_gpu_device->RecycleTexture(std::move(m_downsample_texture));
+  g_gpu_device->RecycleTexture(std::move(m_vram_read_texture));
+  g_gpu_device->RecycleTexture(std::move(m_vram_depth_texture));
+  g_gpu_device->RecycleTexture(std::move(m_vram_texture));
+  g_gpu_device->RecycleTexture(std::move(m_vram_readback_texture));
+  g_gpu_device->RecycleTexture(std::move(m_display_private_texture));
+}
+
+GPU_HW_ShaderGen GPU_HW::GetShaderGen() const
+{
+  return GPU_HW_ShaderGen(g_gpu_device->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
+                          m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits, m_pgxp_depth_buffer,
+                          m_disable_color_perspective, m_supports_dual_source_blend);
+}
+
+std::span<const GPUPipeline::VertexAttribute> GPU_HW::GetBatchVertexAttributes(bool textured) const
+{
+  static constexpr GPUPipeline::VertexAttribute vertex_attributes[] = {
+    GPUPipeline::VertexAttribute::Make(0, GPUPipeline::VertexAttribute::Semantic::Position, 0,
+                                       GPUPipeline::VertexAttribute::Type::Float, 4, offsetof(BatchVertex, x)),
+    GPUPipeline::VertexAttribute::Make(1, GPUPipeline::VertexAttribute::Semantic::Color, 0,
+                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, offsetof(BatchVertex, color)),
+    GPUPipeline::VertexAttribute::Make(2, GPUPipeline::VertexAttribute::Semantic::TexCoord, 0,
+                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, offsetof(BatchVertex, u)),
+    GPUPipeline::VertexAttribute::Make(3, GPUPipeline::VertexAttribute::Semantic::TexCoord, 1,
+                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, offsetof(BatchVertex, texpage)),
+    GPUPipeline::VertexAttribute::Make(4, GPUPipeline::VertexAttribute::Semantic::TexCoord, 2,
+                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, offsetof(BatchVertex, uv_limits)),
+  };
+  static constexpr u32 NUM_BATCH_VERTEX_ATTRIBUTES = 2;
+  static constexpr u32 NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES = 4;
+  static constexpr u32 NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES = 5;
+
+  return std::span<const GPUPipeline::VertexAttribute>(
+    vertex_attributes, textured ? (m_using_uv_limits ? NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES :
+                                                       NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES) :
+                                  NUM_BATCH_VERTEX_ATTRIBUTES);
+}
+
+GPU_HW::BatchPipelineSet GPU_HW::GetCommonBatchPipelines()
+{
+  // Opaque and regular blended primitives without mask/depth testing, which nearly every game draws with.
+  BatchPipelineSet ret;
+  BatchPipelineKey key = {};
+  for (key.texture_mode = 0; key.texture_mode < 9; key.texture_mode++)
+  {
+    for (key.dithering = 0; key.dithering < 2; key.dithering++)
+    {
+      key.render_mode = static_cast<u8>(BatchRenderMode::TransparencyDisabled);
+      key.transparency_mode = static_cast<u8>(GPUTransparencyMode::Disabled);
+      ret.set(key.GetPipelineIndex());
+
+      key.render_mode = static_cast<u8>(BatchRenderMode::TransparentAndOpaque);
+      for (key.transparency_mode = 0; key.transparency_mode < 4; key.transparency_mode++)
+        ret.set(key.GetPipelineIndex());
+    }
+  }
+
+  return ret;
 }
 
 bool GPU_HW::CompilePipelines()
 {
   const GPUDevice::Features features = g_gpu_device->GetFeatures();
-  GPU_HW_ShaderGen shadergen(g_gpu_device->GetRenderAPI(), m_resolution_scale, m_multisamples, m_per_sample_shading,
-                             m_true_color, m_scaled_dithering, m_texture_filtering, m_using_uv_limits,
-                             m_pgxp_depth_buffer, m_disable_color_perspective, m_supports_dual_source_blend);
+  GPU_HW_ShaderGen shadergen = GetShaderGen();
 
-  ShaderCompileProgressTracker progress("Compiling Pipelines", 2 + (4 * 9 * 2 * 2) + (3 * 4 * 5 * 9 * 2 * 2) + 1 + 2 +
-                                                                 (2 * 2) + 2 + 1 + 1 + (2 * 3) + 1);
+  // In lazy mode, only the common variants, plus any which this game used last time, are compiled up front. The rest
+  // are compiled the first time they're drawn with.
+  BatchPipelineSet batch_pipelines;
+  if (m_lazy_batch_pipelines)
+  {
+    LoadUsedBatchPipelines();
+    batch_pipelines = GetCommonBatchPipelines() | m_used_batch_pipelines;
+  }
+  else
+  {
+    batch_pipelines.set();
+  }
+
+  std::bitset<NUM_BATCH_FRAGMENT_SHADERS> batch_fragment_shaders;
+  for (u32 i = 0; i < NUM_BATCH_PIPELINES; i++)
+  {
+    if (batch_pipelines.test(i))
+      batch_fragment_shaders.set(BatchPipelineKey::FromPipelineIndex(i).GetFragmentShaderIndex());
+  }
+
+  ShaderCompileProgressTracker progress(
+    "Compiling Pipelines", 2 + static_cast<u32>(batch_fragment_shaders.count()) +
+                             static_cast<u32>(batch_pipelines.count()) + (m_use_ubershaders ? NUM_UBER_PIPELINES : 0) +
+                             1 + 2 + (2 * 2) + 2 + 1 + 1 + (2 * 3) + 1);
 
-  // vertex shaders - [textured]
-  // fragment shaders - [render_mode][texture_mode][dithering][interlacing]
   static constexpr auto destroy_shader = [](std::unique_ptr<GPUShader>& s) { s.reset(); };
-  DimensionalArray<std::unique_ptr<GPUShader>, 2> batch_vertex_shaders{};
-  DimensionalArray<std::unique_ptr<GPUShader>, 2, 2, 9, 4> batch_fragment_shaders{};
-  ScopedGuard batch_shader_guard([&batch_vertex_shaders, &batch_fragment_shaders]() {
-    batch_vertex_shaders.enumerate(destroy_shader);
-    batch_fragment_shaders.enumerate(destroy_shader);
+  ScopedGuard batch_shader_guard([this]() {
+    m_batch_vertex_shaders.enumerate(destroy_shader);
+    m_batch_fragment_shaders.enumerate(destroy_shader);
   });
 
   for (u8 textured = 0; textured < 2; textured++)
   {
     const std::string vs = shadergen.GenerateBatchVertexShader(ConvertToBoolUnchecked(textured));
-    if (!(batch_vertex_shaders[textured] = g_gpu_device->CreateShader(GPUShaderStage::Vertex, vs)))
+    if (!(m_batch_vertex_shaders[textured] = g_gpu_device->CreateShader(GPUShaderStage::Vertex, vs)))
       return false;
 
     progress.Increment();
   }
 
-  for (u8 render_mode = 0; render_mode < 4; render_mode++)
+  // Generating the fragment shader source is pure CPU work, so it's spread across threads. The shader and pipeline
+  // objects are still created on this thread, since not every API allows creating them concurrently.
+  std::vector<u32> fragment_shader_indices;
+  for (u32 i = 0; i < NUM_BATCH_FRAGMENT_SHADERS; i++)
   {
-    for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
-    {
-      for (u8 dithering = 0; dithering < 2; dithering++)
-      {
-        for (u8 interlacing = 0; interlacing < 2; interlacing++)
-        {
-          const std::string fs = shadergen.GenerateBatchFragmentShader(
-            static_cast<BatchRenderMode>(render_mode), static_cast<GPUTextureMode>(texture_mode),
-            ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
+    if (batch_fragment_shaders.test(i))
+      fragment_shader_indices.push_back(i);
+  }
 
-          if (!(batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing] =
-                  g_gpu_device->CreateShader(GPUShaderStage::Fragment, fs)))
-          {
-            return false;
-          }
+  std::array<std::string, NUM_BATCH_FRAGMENT_SHADERS> fragment_shader_sources;
+  {
+    std::atomic<u32> next_index{0};
+    const auto generate_sources = [this, &fragment_shader_indices, &fragment_shader_sources, &next_index]() {
+      GPU_HW_ShaderGen thread_shadergen = GetShaderGen();
+      for (;;)
+      {
+        const u32 i = next_index.fetch_add(1, std::memory_order_relaxed);
+        if (i >= static_cast<u32>(fragment_shader_indices.size()))
+          break;
 
-          progress.Increment();
-        }
+        const BatchPipelineKey key = BatchPipelineKey::FromFragmentShaderIndex(fragment_shader_indices[i]);
+        fragment_shader_sources[fragment_shader_indices[i]] = thread_shadergen.GenerateBatchFragmentShader(
+          static_cast<BatchRenderMode>(key.render_mode), static_cast<GPUTextureMode>(key.texture_mode),
+          ConvertToBoolUnchecked(key.dithering), ConvertToBoolUnchecked(key.interlacing));
       }
+    };
+
+    static constexpr u32 MAX_SOURCE_THREADS = 8;
+    const u32 num_threads =
+      std::min(std::clamp(std::thread::hardware_concurrency(), 1u, MAX_SOURCE_THREADS),
+               std::max(static_cast<u32>(fragment_shader_indices.size()) / 8u, 1u));
+    std::vector<std::thread> threads;
+    for (u32 i = 1; i < num_threads; i++)
+      threads.emplace_back(generate_sources);
+    generate_sources();
+    for (std::thread& thread : threads)
+      thread.join();
+  }
+
+  for (const u32 index : fragment_shader_indices)
+  {
+    const BatchPipelineKey key = BatchPipelineKey::FromFragmentShaderIndex(index);
+    if (!(m_batch_fragment_shaders[key.render_mode][key.texture_mode][key.dithering][key.interlacing] =
+            g_gpu_device->CreateShader(GPUShaderStage::Fragment, fragment_shader_sources[index])))
+    {
+      return false;
     }
+
+    fragment_shader_sources[index] = {};
+    progress.Increment();
   }
 
-  static constexpr GPUPipeline::VertexAttribute vertex_attributes[] = {
-    GPUPipeline::VertexAttribute::Make(0, GPUPipeline::VertexAttribute::Semantic::Position, 0,
-                                       GPUPipeline::VertexAttribute::Type::Float, 4, offsetof(BatchVertex, x)),
-    GPUPipeline::VertexAttribute::Make(1, GPUPipeline::VertexAttribute::Semantic::Color, 0,
-                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, offsetof(BatchVertex, color)),
-    GPUPipeline::VertexAttribute::Make(2, GPUPipeline::VertexAttribute::Semantic::TexCoord, 0,
-                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, offsetof(BatchVertex, u)),
-    GPUPipeline::VertexAttribute::Make(3, GPUPipeline::VertexAttribute::Semantic::TexCoord, 1,
-                                       GPUPipeline::VertexAttribute::Type::UInt32, 1, offsetof(BatchVertex, texpage)),
-    GPUPipeline::VertexAttribute::Make(4, GPUPipeline::VertexAttribute::Semantic::TexCoord, 2,
-                                       GPUPipeline::VertexAttribute::Type::UNorm8, 4, offsetof(BatchVertex, uv_limits)),
-  };
-  static constexpr u32 NUM_BATCH_VERTEX_ATTRIBUTES = 2;
-  static constexpr u32 NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES = 4;
-  static constexpr u32 NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES = 5;
+  if (!CompileBatchPipelines(batch_pipelines, progress) || (m_use_ubershaders && !CompileUberPipelines(progress)))
+    return false;
 
   GPUPipeline::GraphicsConfig plconfig = {};
   plconfig.layout = GPUPipeline::Layout::SingleTextureAndUBO;
@@ -803,100 +1234,6 @@ bool GPU_HW::CompilePipelines()
   plconfig.per_sample_shading = m_per_sample_shading;
   plconfig.geometry_shader = nullptr;
 
-  // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
-  for (u8 depth_test = 0; depth_test < 3; depth_test++)
-  {
-    for (u8 render_mode = 0; render_mode < 4; render_mode++)
-    {
-      for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
-      {
-        for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
-        {
-          for (u8 dithering = 0; dithering < 2; dithering++)
-          {
-            for (u8 interlacing = 0; interlacing < 2; interlacing++)
-            {
-              static constexpr std::array<GPUPipeline::DepthFunc, 3> depth_test_values = {
-                GPUPipeline::DepthFunc::Always, GPUPipeline::DepthFunc::GreaterEqual,
-                GPUPipeline::DepthFunc::LessEqual};
-              const bool textured = (static_cast<GPUTextureMode>(texture_mode) != GPUTextureMode::Disabled);
-
-              plconfig.input_layout.vertex_attributes =
-                textured ?
-                  (m_using_uv_limits ? std::span<const GPUPipeline::VertexAttribute>(
-                                         vertex_attributes, NUM_BATCH_TEXTURED_LIMITS_VERTEX_ATTRIBUTES) :
-                                       std::span<const GPUPipeline::VertexAttribute>(
-                                         vertex_attributes, NUM_BATCH_TEXTURED_VERTEX_ATTRIBUTES)) :
-                  std::span<const GPUPipeline::VertexAttribute>(vertex_attributes, NUM_BATCH_VERTEX_ATTRIBUTES);
-
-              plconfig.vertex_shader = batch_vertex_shaders[BoolToUInt8(textured)].get();
-              plconfig.fragment_shader =
-                batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing].get();
-
-              plconfig.depth.depth_test = depth_test_values[depth_test];
-              plconfig.depth.depth_write = !m_pgxp_depth_buffer || depth_test != 0;
-              plconfig.blend = GPUPipeline::BlendState::GetNoBlendingState();
-
-              if ((static_cast<GPUTransparencyMode>(transparency_mode) != GPUTransparencyMode::Disabled &&
-                   (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                    static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
-                  m_texture_filtering != GPUTextureFilter::Nearest)
-              {
-                plconfig.blend.enable = true;
-                plconfig.blend.src_alpha_blend = GPUPipeline::BlendFunc::One;
-                plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::Zero;
-                plconfig.blend.alpha_blend_op = GPUPipeline::BlendOp::Add;
-
-                if (m_supports_dual_source_blend)
-                {
-                  plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
-                  plconfig.blend.dst_blend = GPUPipeline::BlendFunc::SrcAlpha1;
-                  plconfig.blend.blend_op =
-                    (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                       GPUTransparencyMode::BackgroundMinusForeground &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                      GPUPipeline::BlendOp::ReverseSubtract :
-                      GPUPipeline::BlendOp::Add;
-                }
-                else
-                {
-                  // TODO: This isn't entirely accurate, 127.5 versus 128.
-                  // But if we use fbfetch on Mali, it doesn't matter.
-                  plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
-                  plconfig.blend.dst_blend = GPUPipeline::BlendFunc::One;
-                  if (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                        GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
-                  {
-                    plconfig.blend.dst_blend = GPUPipeline::BlendFunc::ConstantColor;
-                    plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::ConstantColor;
-                    plconfig.blend.constant = 0x00808080u;
-                  }
-
-                  plconfig.blend.blend_op =
-                    (static_cast<GPUTransparencyMode>(transparency_mode) ==
-                       GPUTransparencyMode::BackgroundMinusForeground &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                     static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque) ?
-                      GPUPipeline::BlendOp::ReverseSubtract :
-                      GPUPipeline::BlendOp::Add;
-                }
-              }
-
-              if (!(m_batch_pipelines[depth_test][render_mode][texture_mode][transparency_mode][dithering]
-                                     [interlacing] = g_gpu_device->CreatePipeline(plconfig)))
-              {
-                return false;
-              }
-
-              progress.Increment();
-            }
-          }
-        }
-      }
-    }
-  }
-
   if (m_wireframe_mode != GPUWireframeMode::Disabled)
   {
     std::unique_ptr<GPUShader> gs =
@@ -909,14 +1246,13 @@ bool GPU_HW::CompilePipelines()
     GL_OBJECT_NAME(gs, "Batch Wireframe Geometry Shader");
     GL_OBJECT_NAME(fs, "Batch Wireframe Fragment Shader");
 
-    plconfig.input_layout.vertex_attributes =
-      std::span<const GPUPipeline::VertexAttribute>(vertex_attributes, NUM_BATCH_VERTEX_ATTRIBUTES);
+    plconfig.input_layout.vertex_attributes = GetBatchVertexAttributes(false);
     plconfig.blend = (m_wireframe_mode == GPUWireframeMode::OverlayWireframe) ?
                        GPUPipeline::BlendState::GetAlphaBlendingState() :
                        GPUPipeline::BlendState::GetNoBlendingState();
     plconfig.blend.write_mask = 0x7;
     plconfig.depth = GPUPipeline::DepthState::GetNoTestsState();
-    plconfig.vertex_shader = batch_vertex_shaders[0].get();
+    plconfig.vertex_shader = m_batch_vertex_shaders[0].get();
     plconfig.geometry_shader = gs.get();
     plconfig.fragment_shader = fs.get();
 
@@ -930,7 +1266,11 @@ bool GPU_HW::CompilePipelines()
     plconfig.fragment_shader = nullptr;
   }
 
-  batch_shader_guard.Run();
+  // the shaders are only needed later if pipelines are being compiled on demand
+  if (m_lazy_batch_pipelines)
+    batch_shader_guard.Cancel();
+  else
+    batch_shader_guard.Run();
 
   std::unique_ptr<GPUShader> fullscreen_quad_vertex_shader =
     g_gpu_device->CreateShader(GPUShaderStage::Vertex, shadergen.GenerateScreenQuadVertexShader());
@@ -1096,96 +1436,513 @@ bool GPU_HW::CompilePipelines()
       return false;
   }
 
-  if (m_downsample_mode == GPUDownsampleMode::Adaptive)
+  if (m_downsample_mode == GPUDownsampleMode::Adaptive)
+  {
+    std::unique_ptr<GPUShader> vs =
+      g_gpu_device->CreateShader(GPUShaderStage::Vertex, shadergen.GenerateAdaptiveDownsampleVertexShader());
+    std::unique_ptr<GPUShader> fs =
+      g_gpu_device->CreateShader(GPUShaderStage::Fragment, shadergen.GenerateAdaptiveDownsampleMipFragmentShader(true));
+    if (!vs || !fs)
+      return false;
+    GL_OBJECT_NAME(fs, "Downsample Vertex Shader");
+    GL_OBJECT_NAME(fs, "Downsample First Pass Fragment Shader");
+    plconfig.vertex_shader = vs.get();
+    plconfig.fragment_shader = fs.get();
+    if (!(m_downsample_first_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
+      return false;
+    GL_OBJECT_NAME(m_downsample_first_pass_pipeline, "Downsample First Pass Pipeline");
+
+    fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment,
+                                    shadergen.GenerateAdaptiveDownsampleMipFragmentShader(false));
+    if (!fs)
+      return false;
+    GL_OBJECT_NAME(fs, "Downsample Mid Pass Fragment Shader");
+    plconfig.fragment_shader = fs.get();
+    if (!(m_downsample_mid_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
+      return false;
+    GL_OBJECT_NAME(m_downsample_mid_pass_pipeline, "Downsample Mid Pass Pipeline");
+
+    fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment, shadergen.GenerateAdaptiveDownsampleBlurFragmentShader());
+    if (!fs)
+      return false;
+    GL_OBJECT_NAME(fs, "Downsample Blur Pass Fragment Shader");
+    plconfig.fragment_shader = fs.get();
+    plconfig.color_format = GPUTexture::Format::R8;
+    if (!(m_downsample_blur_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
+      return false;
+    GL_OBJECT_NAME(m_downsample_blur_pass_pipeline, "Downsample Blur Pass Pipeline");
+
+    fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment,
+                                    shadergen.GenerateAdaptiveDownsampleCompositeFragmentShader());
+    if (!fs)
+      return false;
+    GL_OBJECT_NAME(fs, "Downsample Composite Pass Fragment Shader");
+    plconfig.layout = GPUPipeline::Layout::MultiTextureAndPushConstants;
+    plconfig.fragment_shader = fs.get();
+    plconfig.color_format = VRAM_RT_FORMAT;
+    if (!(m_downsample_composite_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
+      return false;
+    GL_OBJECT_NAME(m_downsample_composite_pass_pipeline, "Downsample Blur Pass Pipeline");
+
+    GPUSampler::Config config = GPUSampler::GetLinearConfig();
+    config.min_lod = 0;
+    config.max_lod = GPUSampler::Config::LOD_MAX;
+    if (!(m_downsample_lod_sampler = g_gpu_device->CreateSampler(config)))
+      return false;
+    GL_OBJECT_NAME(m_downsample_lod_sampler, "Downsample LOD Sampler");
+    config.mip_filter = GPUSampler::Filter::Linear;
+    if (!(m_downsample_composite_sampler = g_gpu_device->CreateSampler(config)))
+      return false;
+    GL_OBJECT_NAME(m_downsample_composite_sampler, "Downsample Trilinear Sampler");
+  }
+  else if (m_downsample_mode == GPUDownsampleMode::Box)
+  {
+    std::unique_ptr<GPUShader> fs = g_gpu_device->CreateShader(
+      GPUShaderStage::Fragment, shadergen.GenerateBoxSampleDownsampleFragmentShader(
+                                  m_resolution_scale / GetBoxDownsampleScale(m_resolution_scale)));
+    if (!fs)
+      return false;
+
+    GL_OBJECT_NAME(fs, "Downsample First Pass Fragment Shader");
+    plconfig.fragment_shader = fs.get();
+
+    if (!(m_downsample_first_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
+      return false;
+
+    GL_OBJECT_NAME(m_downsample_first_pass_pipeline, "Downsample First Pass Pipeline");
+  }
+
+  progress.Increment();
+
+#undef UPDATE_PROGRESS
+
+  // Drivers which compile in the background only report failures here, and this overlaps all of the compiles.
+  if (!g_gpu_device->WaitForPipelineCompiles())
+    return false;
+
+  if (m_use_ubershaders)
+    StartPipelineCompileThread();
+
+  return true;
+}
+
+bool GPU_HW::CompileBatchPipelines(const BatchPipelineSet& pipelines, ShaderCompileProgressTracker& progress)
+{
+  std::vector<u32> indices;
+  for (u32 i = 0; i < NUM_BATCH_PIPELINES; i++)
+  {
+    if (pipelines.test(i))
+      indices.push_back(i);
+  }
+
+  static constexpr u32 MAX_PIPELINE_THREADS = 8;
+  static constexpr u32 MIN_PIPELINES_PER_THREAD = 16;
+  const u32 num_threads =
+    g_gpu_device->GetFeatures().threaded_pipeline_creation ?
+      std::min(std::clamp(std::thread::hardware_concurrency(), 1u, MAX_PIPELINE_THREADS),
+               std::max(static_cast<u32>(indices.size()) / MIN_PIPELINES_PER_THREAD, 1u)) :
+      1u;
+  if (num_threads == 1)
+  {
+    for (const u32 index : indices)
+    {
+      if (!CompileBatchPipeline(index))
+        return false;
+
+      progress.Increment();
+    }
+
+    return true;
+  }
+
+  // Every fragment shader already exists at this point, so CompileBatchPipeline() only writes its own pipeline slot.
+  // Progress is reported from this thread, since it draws the loading screen.
+  Log_DevFmt("Compiling {} batch pipelines on {} threads", indices.size(), num_threads);
+  std::atomic<u32> next_index{0};
+  std::atomic<u32> num_compiled{0};
+  std::atomic_bool failed{false};
+  const auto compile_pipelines = [this, &indices, &next_index, &num_compiled, &failed]() {
+    for (;;)
+    {
+      const u32 i = next_index.fetch_add(1, std::memory_order_relaxed);
+      if (i >= static_cast<u32>(indices.size()) || failed.load(std::memory_order_relaxed))
+        break;
+
+      if (!CompileBatchPipeline(indices[i]))
+        failed.store(true, std::memory_order_relaxed);
+
+      num_compiled.fetch_add(1, std::memory_order_release);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (u32 i = 1; i < num_threads; i++)
+    threads.emplace_back(compile_pipelines);
+
+  u32 last_compiled = 0;
+  for (;;)
+  {
+    const u32 i = next_index.fetch_add(1, std::memory_order_relaxed);
+    if (i >= static_cast<u32>(indices.size()) || failed.load(std::memory_order_relaxed))
+      break;
+
+    if (!CompileBatchPipeline(indices[i]))
+      failed.store(true, std::memory_order_relaxed);
+
+    const u32 compiled = num_compiled.fetch_add(1, std::memory_order_acq_rel) + 1;
+    progress.Increment(compiled - last_compiled);
+    last_compiled = compiled;
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  progress.Increment(num_compiled.load(std::memory_order_acquire) - last_compiled);
+  return !failed.load(std::memory_order_acquire);
+}
+
+std::unique_ptr<GPUPipeline> GPU_HW::CreateBatchPipeline(u32 index)
+{
+  // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
+  const BatchPipelineKey key = BatchPipelineKey::FromPipelineIndex(index);
+  const BatchRenderMode render_mode = static_cast<BatchRenderMode>(key.render_mode);
+  const GPUTextureMode texture_mode = static_cast<GPUTextureMode>(key.texture_mode);
+
+  std::unique_ptr<GPUShader>& fragment_shader =
+    m_batch_fragment_shaders[key.render_mode][key.texture_mode][key.dithering][key.interlacing];
+  if (!fragment_shader)
+  {
+    const std::string fs = GetShaderGen().GenerateBatchFragmentShader(
+      render_mode, texture_mode, ConvertToBoolUnchecked(key.dithering), ConvertToBoolUnchecked(key.interlacing));
+    if (!(fragment_shader = g_gpu_device->CreateShader(GPUShaderStage::Fragment, fs)))
+      return {};
+  }
+
+  return CreateBatchPipeline(key.depth_test, render_mode, texture_mode != GPUTextureMode::Disabled,
+                             static_cast<GPUTransparencyMode>(key.transparency_mode), fragment_shader.get());
+}
+
+bool GPU_HW::CompileBatchPipeline(u32 index)
+{
+  const BatchPipelineKey key = BatchPipelineKey::FromPipelineIndex(index);
+  return static_cast<bool>(m_batch_pipelines[key.depth_test][key.render_mode][key.texture_mode][key.transparency_mode]
+                                            [key.dithering][key.interlacing] = CreateBatchPipeline(index));
+}
+
+std::unique_ptr<GPUPipeline> GPU_HW::CreateBatchPipeline(u8 depth_test, BatchRenderMode render_mode, bool textured,
+                                                         GPUTransparencyMode transparency_mode,
+                                                         GPUShader* fragment_shader)
+{
+  static constexpr std::array<GPUPipeline::DepthFunc, 3> depth_test_values = {
+    GPUPipeline::DepthFunc::Always, GPUPipeline::DepthFunc::GreaterEqual, GPUPipeline::DepthFunc::LessEqual};
+
+  GPUPipeline::GraphicsConfig plconfig = {};
+  plconfig.layout = GPUPipeline::Layout::SingleTextureAndUBO;
+  plconfig.input_layout.vertex_attributes = GetBatchVertexAttributes(textured);
+  plconfig.input_layout.vertex_stride = sizeof(BatchVertex);
+  plconfig.rasterization = GPUPipeline::RasterizationState::GetNoCullState();
+  plconfig.primitive = GPUPipeline::Primitive::Triangles;
+  plconfig.color_format = VRAM_RT_FORMAT;
+  plconfig.depth_format = VRAM_DS_FORMAT;
+  plconfig.samples = m_multisamples;
+  plconfig.per_sample_shading = m_per_sample_shading;
+  plconfig.vertex_shader = m_batch_vertex_shaders[BoolToUInt8(textured)].get();
+  plconfig.geometry_shader = nullptr;
+  plconfig.fragment_shader = fragment_shader;
+
+  plconfig.depth.depth_test = depth_test_values[depth_test];
+  plconfig.depth.depth_write = !m_pgxp_depth_buffer || depth_test != 0;
+  plconfig.blend = GPUPipeline::BlendState::GetNoBlendingState();
+
+  if ((transparency_mode != GPUTransparencyMode::Disabled &&
+       (render_mode != BatchRenderMode::TransparencyDisabled && render_mode != BatchRenderMode::OnlyOpaque)) ||
+      m_texture_filtering != GPUTextureFilter::Nearest)
+  {
+    plconfig.blend.enable = true;
+    plconfig.blend.src_alpha_blend = GPUPipeline::BlendFunc::One;
+    plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::Zero;
+    plconfig.blend.alpha_blend_op = GPUPipeline::BlendOp::Add;
+
+    if (m_supports_dual_source_blend)
+    {
+      plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
+      plconfig.blend.dst_blend = GPUPipeline::BlendFunc::SrcAlpha1;
+      plconfig.blend.blend_op =
+        (transparency_mode == GPUTransparencyMode::BackgroundMinusForeground &&
+         render_mode != BatchRenderMode::TransparencyDisabled && render_mode != BatchRenderMode::OnlyOpaque) ?
+          GPUPipeline::BlendOp::ReverseSubtract :
+          GPUPipeline::BlendOp::Add;
+    }
+    else
+    {
+      // TODO: This isn't entirely accurate, 127.5 versus 128.
+      // But if we use fbfetch on Mali, it doesn't matter.
+      plconfig.blend.src_blend = GPUPipeline::BlendFunc::One;
+      plconfig.blend.dst_blend = GPUPipeline::BlendFunc::One;
+      if (transparency_mode == GPUTransparencyMode::HalfBackgroundPlusHalfForeground)
+      {
+        plconfig.blend.dst_blend = GPUPipeline::BlendFunc::ConstantColor;
+        plconfig.blend.dst_alpha_blend = GPUPipeline::BlendFunc::ConstantColor;
+        plconfig.blend.constant = 0x00808080u;
+      }
+
+      plconfig.blend.blend_op =
+        (transparency_mode == GPUTransparencyMode::BackgroundMinusForeground &&
+         render_mode != BatchRenderMode::TransparencyDisabled && render_mode != BatchRenderMode::OnlyOpaque) ?
+          GPUPipeline::BlendOp::ReverseSubtract :
+          GPUPipeline::BlendOp::Add;
+    }
+  }
+
+  return g_gpu_device->CreatePipeline(plconfig);
+}
+
+bool GPU_HW::CompileUberPipelines(ShaderCompileProgressTracker& progress)
+{
+  GPU_HW_ShaderGen shadergen = GetShaderGen();
+
+  // The fragment shaders aren't needed once the pipelines exist, nothing else is created from them.
+  for (u8 render_mode = 0; render_mode < 4; render_mode++)
+  {
+    for (u8 textured = 0; textured < 2; textured++)
+    {
+      const std::string source = shadergen.GenerateBatchFragmentShader(
+        static_cast<BatchRenderMode>(render_mode), textured ? GPUTextureMode::Direct16Bit : GPUTextureMode::Disabled,
+        false, false, true);
+      std::unique_ptr<GPUShader> fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment, source);
+      if (!fs)
+        return false;
+
+      GL_OBJECT_NAME_FMT(fs, "Batch Uber Fragment Shader, render_mode={}, textured={}", render_mode, textured);
+
+      for (u8 depth_test = 0; depth_test < 3; depth_test++)
+      {
+        for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
+        {
+          if ((render_mode == static_cast<u8>(BatchRenderMode::TransparencyDisabled)) !=
+              (transparency_mode == static_cast<u8>(GPUTransparencyMode::Disabled)))
+          {
+            continue;
+          }
+
+          if (!(m_batch_uber_pipelines[depth_test][render_mode][textured][transparency_mode] = CreateBatchPipeline(
+                  depth_test, static_cast<BatchRenderMode>(render_mode), ConvertToBoolUnchecked(textured),
+                  static_cast<GPUTransparencyMode>(transparency_mode), fs.get())))
+          {
+            return false;
+          }
+
+          progress.Increment();
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void GPU_HW::StartPipelineCompileThread()
+{
+  if (!g_gpu_device->GetFeatures().threaded_pipeline_creation || m_pipeline_compile_thread.joinable())
+    return;
+
+  m_pipeline_compile_shutdown = false;
+  m_pipeline_compile_thread = std::thread(&GPU_HW::PipelineCompileThreadEntryPoint, this);
+}
+
+void GPU_HW::StopPipelineCompileThread()
+{
+  if (m_pipeline_compile_thread.joinable())
+  {
+    {
+      std::unique_lock lock(m_pipeline_compile_mutex);
+      m_pipeline_compile_shutdown = true;
+    }
+    m_pipeline_compile_cv.notify_one();
+    m_pipeline_compile_thread.join();
+  }
+
+  // Whatever was still queued is compiled again if it's drawn with.
+  m_pipeline_compile_queue.clear();
+  m_compiled_batch_pipelines.clear();
+  m_queued_batch_pipelines.reset();
+}
+
+void GPU_HW::PipelineCompileThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Pipeline Compiler");
+  System::ApplyThreadCorePlacement(false);
+
+  // Fragment shaders are only created here while the thread runs, the GPU thread draws with the ubershaders instead.
+  std::unique_lock lock(m_pipeline_compile_mutex);
+  for (;;)
+  {
+    m_pipeline_compile_cv.wait(lock,
+                               [this]() { return m_pipeline_compile_shutdown || !m_pipeline_compile_queue.empty(); });
+    if (m_pipeline_compile_shutdown)
+      break;
+
+    const u32 index = m_pipeline_compile_queue.front();
+    m_pipeline_compile_queue.pop_front();
+
+    lock.unlock();
+    std::unique_ptr<GPUPipeline> pipeline = CreateBatchPipeline(index);
+    if (!pipeline)
+      Log_ErrorPrintf("Failed to compile batch pipeline %u", index);
+    lock.lock();
+
+    m_compiled_batch_pipelines.emplace_back(index, std::move(pipeline));
+  }
+}
+
+void GPU_HW::QueueBatchPipeline(u32 index)
+{
+  if (m_queued_batch_pipelines.test(index))
+    return;
+
+  Log_DevPrintf("Queueing batch pipeline %u for compilation", index);
+  m_queued_batch_pipelines.set(index);
+  if (!m_pipeline_compile_thread.joinable())
+  {
+    m_pipeline_compile_queue.push_back(index);
+    return;
+  }
+
+  {
+    std::unique_lock lock(m_pipeline_compile_mutex);
+    m_pipeline_compile_queue.push_back(index);
+  }
+  m_pipeline_compile_cv.notify_one();
+}
+
+void GPU_HW::AddCompiledBatchPipelines()
+{
+  std::unique_lock lock(m_pipeline_compile_mutex);
+  for (auto& [index, pipeline] : m_compiled_batch_pipelines)
+  {
+    // Failed pipelines stay marked as queued, so they're drawn with the ubershader rather than compiled again.
+    if (!pipeline)
+      continue;
+
+    const BatchPipelineKey key = BatchPipelineKey::FromPipelineIndex(index);
+    m_batch_pipelines[key.depth_test][key.render_mode][key.texture_mode][key.transparency_mode][key.dithering]
+                     [key.interlacing] = std::move(pipeline);
+    m_used_batch_pipelines.set(index);
+    m_used_batch_pipelines_dirty = true;
+  }
+  m_compiled_batch_pipelines.clear();
+}
+
+void GPU_HW::CompileQueuedBatchPipeline()
+{
+  // Without a worker, one pipeline per frame is compiled here, so the hitches are spread out instead of piling up.
+  if (m_pipeline_compile_thread.joinable() || m_pipeline_compile_queue.empty())
+    return;
+
+  const u32 index = m_pipeline_compile_queue.front();
+  m_pipeline_compile_queue.pop_front();
+  if (!CompileBatchPipeline(index))
   {
-    std::unique_ptr<GPUShader> vs =
-      g_gpu_device->CreateShader(GPUShaderStage::Vertex, shadergen.GenerateAdaptiveDownsampleVertexShader());
-    std::unique_ptr<GPUShader> fs =
-      g_gpu_device->CreateShader(GPUShaderStage::Fragment, shadergen.GenerateAdaptiveDownsampleMipFragmentShader(true));
-    if (!vs || !fs)
-      return false;
-    GL_OBJECT_NAME(fs, "Downsample Vertex Shader");
-    GL_OBJECT_NAME(fs, "Downsample First Pass Fragment Shader");
-    plconfig.vertex_shader = vs.get();
-    plconfig.fragment_shader = fs.get();
-    if (!(m_downsample_first_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
-      return false;
-    GL_OBJECT_NAME(m_downsample_first_pass_pipeline, "Downsample First Pass Pipeline");
+    Log_ErrorPrintf("Failed to compile batch pipeline %u", index);
+    return;
+  }
 
-    fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment,
-                                    shadergen.GenerateAdaptiveDownsampleMipFragmentShader(false));
-    if (!fs)
-      return false;
-    GL_OBJECT_NAME(fs, "Downsample Mid Pass Fragment Shader");
-    plconfig.fragment_shader = fs.get();
-    if (!(m_downsample_mid_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
-      return false;
-    GL_OBJECT_NAME(m_downsample_mid_pass_pipeline, "Downsample Mid Pass Pipeline");
+  m_used_batch_pipelines.set(index);
+  m_used_batch_pipelines_dirty = true;
+}
 
-    fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment, shadergen.GenerateAdaptiveDownsampleBlurFragmentShader());
-    if (!fs)
-      return false;
-    GL_OBJECT_NAME(fs, "Downsample Blur Pass Fragment Shader");
-    plconfig.fragment_shader = fs.get();
-    plconfig.color_format = GPUTexture::Format::R8;
-    if (!(m_downsample_blur_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
-      return false;
-    GL_OBJECT_NAME(m_downsample_blur_pass_pipeline, "Downsample Blur Pass Pipeline");
+std::string GPU_HW::GetUsedBatchPipelinesFileName(u64 game_hash)
+{
+  return Path::Combine(EmuFolders::Cache, TinyString::from_fmt("pipelines/{:016X}.bin", game_hash));
+}
 
-    fs = g_gpu_device->CreateShader(GPUShaderStage::Fragment,
-                                    shadergen.GenerateAdaptiveDownsampleCompositeFragmentShader());
-    if (!fs)
-      return false;
-    GL_OBJECT_NAME(fs, "Downsample Composite Pass Fragment Shader");
-    plconfig.layout = GPUPipeline::Layout::MultiTextureAndPushConstants;
-    plconfig.fragment_shader = fs.get();
-    plconfig.color_format = VRAM_RT_FORMAT;
-    if (!(m_downsample_composite_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
-      return false;
-    GL_OBJECT_NAME(m_downsample_composite_pass_pipeline, "Downsample Blur Pass Pipeline");
+void GPU_HW::LoadUsedBatchPipelines()
+{
+  m_used_batch_pipelines.reset();
+  m_used_batch_pipelines_game_hash = System::GetGameHash();
+  m_used_batch_pipelines_dirty = false;
+  if (m_used_batch_pipelines_game_hash == 0)
+    return;
 
-    GPUSampler::Config config = GPUSampler::GetLinearConfig();
-    config.min_lod = 0;
-    config.max_lod = GPUSampler::Config::LOD_MAX;
-    if (!(m_downsample_lod_sampler = g_gpu_device->CreateSampler(config)))
-      return false;
-    GL_OBJECT_NAME(m_downsample_lod_sampler, "Downsample LOD Sampler");
-    config.mip_filter = GPUSampler::Filter::Linear;
-    if (!(m_downsample_composite_sampler = g_gpu_device->CreateSampler(config)))
-      return false;
-    GL_OBJECT_NAME(m_downsample_composite_sampler, "Downsample Trilinear Sampler");
+  const std::string filename = GetUsedBatchPipelinesFileName(m_used_batch_pipelines_game_hash);
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+    return;
+
+  u32 signature, version, count;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU32(&count) ||
+      signature != USED_BATCH_PIPELINES_SIGNATURE || version != USED_BATCH_PIPELINES_VERSION ||
+      count > NUM_BATCH_PIPELINES)
+  {
+    Log_WarningPrintf("Used pipeline list '%s' is corrupted or out of date", filename.c_str());
+    return;
   }
-  else if (m_downsample_mode == GPUDownsampleMode::Box)
+
+  for (u32 i = 0; i < count; i++)
   {
-    std::unique_ptr<GPUShader> fs = g_gpu_device->CreateShader(
-      GPUShaderStage::Fragment, shadergen.GenerateBoxSampleDownsampleFragmentShader(
-                                  m_resolution_scale / GetBoxDownsampleScale(m_resolution_scale)));
-    if (!fs)
-      return false;
+    u16 index;
+    if (!stream->ReadU16(&index) || index >= NUM_BATCH_PIPELINES)
+    {
+      Log_WarningPrintf("Used pipeline list '%s' is corrupted", filename.c_str());
+      m_used_batch_pipelines.reset();
+      return;
+    }
 
-    GL_OBJECT_NAME(fs, "Downsample First Pass Fragment Shader");
-    plconfig.fragment_shader = fs.get();
+    m_used_batch_pipelines.set(index);
+  }
 
-    if (!(m_downsample_first_pass_pipeline = g_gpu_device->CreatePipeline(plconfig)))
-      return false;
+  Log_DevFmt("Loaded {} used batch pipelines for {:016X}", count, m_used_batch_pipelines_game_hash);
+}
 
-    GL_OBJECT_NAME(m_downsample_first_pass_pipeline, "Downsample First Pass Pipeline");
-  }
+void GPU_HW::SaveUsedBatchPipelines()
+{
+  if (!m_used_batch_pipelines_dirty || m_used_batch_pipelines_game_hash == 0)
+    return;
 
-  progress.Increment();
+  m_used_batch_pipelines_dirty = false;
 
-#undef UPDATE_PROGRESS
+  const std::string directory = Path::Combine(EmuFolders::Cache, "pipelines");
+  if (!FileSystem::EnsureDirectoryExists(directory.c_str(), false))
+    return;
 
-  return true;
+  const std::string filename = GetUsedBatchPipelinesFileName(m_used_batch_pipelines_game_hash);
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(
+    filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                        BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+    return;
+
+  bool result = stream->WriteU32(USED_BATCH_PIPELINES_SIGNATURE);
+  result = result && stream->WriteU32(USED_BATCH_PIPELINES_VERSION);
+  result = result && stream->WriteU32(static_cast<u32>(m_used_batch_pipelines.count()));
+  for (u32 i = 0; i < NUM_BATCH_PIPELINES; i++)
+  {
+    if (m_used_batch_pipelines.test(i))
+      result = result && stream->WriteU16(static_cast<u16>(i));
+  }
+
+  if (!result || !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to write used pipeline list '%s'", filename.c_str());
+    stream->Discard();
+  }
 }
 
 void GPU_HW::DestroyPipelines()
 {
   static constexpr auto destroy = [](std::unique_ptr<GPUPipeline>& p) { p.reset(); };
+  static constexpr auto destroy_shader = [](std::unique_ptr<GPUShader>& s) { s.reset(); };
+
+  StopPipelineCompileThread();
+  SaveUsedBatchPipelines();
 
   m_wireframe_pipeline.reset();
 
   m_batch_pipelines.enumerate(destroy);
+  m_batch_uber_pipelines.enumerate(destroy);
+  m_batch_vertex_shaders.enumerate(destroy_shader);
+  m_batch_fragment_shaders.enumerate(destroy_shader);
 
   m_vram_fill_pipelines.enumerate(destroy);
 
@@ -1216,33 +1973,44 @@ GPU_HW::BatchRenderMode GPU_HW::BatchConfig::GetRenderMode() const
 }
 
 void GPU_HW::UpdateVRAMReadTexture()
+{
+  VRAMBlockMask all;
+  all.SetAll();
+  UpdateVRAMReadTexture(all);
+}
+
+void GPU_HW::UpdateVRAMReadTexture(const VRAMBlockMask& area)
 {
   GL_SCOPE("UpdateVRAMReadTexture()");
 
-  const auto scaled_rect = m_vram_dirty_rect * m_resolution_scale;
-  if (m_vram_texture->IsMultisampled())
+  if (m_vram_texture->IsMultisampled() && !g_gpu_device->GetFeatures().partial_msaa_resolve)
   {
-    if (g_gpu_device->GetFeatures().partial_msaa_resolve)
-    {
-      g_gpu_device->ResolveTextureRegion(m_vram_read_texture.get(), scaled_rect.left, scaled_rect.top, 0, 0,
-                                         m_vram_texture.get(), scaled_rect.left, scaled_rect.top,
-                                         scaled_rect.GetWidth(), scaled_rect.GetHeight());
-    }
-    else
-    {
-      g_gpu_device->ResolveTextureRegion(m_vram_read_texture.get(), 0, 0, 0, 0, m_vram_texture.get(), 0, 0,
-                                         m_vram_texture->GetWidth(), m_vram_texture->GetHeight());
-    }
+    g_gpu_device->ResolveTextureRegion(m_vram_read_texture.get(), 0, 0, 0, 0, m_vram_texture.get(), 0, 0,
+                                       m_vram_texture->GetWidth(), m_vram_texture->GetHeight());
+    ClearVRAMDirtyRectangle();
   }
   else
   {
-    g_gpu_device->CopyTextureRegion(m_vram_read_texture.get(), scaled_rect.left, scaled_rect.top, 0, 0,
-                                    m_vram_texture.get(), scaled_rect.left, scaled_rect.top, 0, 0,
-                                    scaled_rect.GetWidth(), scaled_rect.GetHeight());
+    m_vram_dirty_blocks.TakeIntersection(area).GetRectangles(&m_vram_dirty_rects);
+    for (const Common::Rectangle<u32>& rect : m_vram_dirty_rects)
+    {
+      const Common::Rectangle<u32> scaled_rect = rect * m_resolution_scale;
+      if (m_vram_texture->IsMultisampled())
+      {
+        g_gpu_device->ResolveTextureRegion(m_vram_read_texture.get(), scaled_rect.left, scaled_rect.top, 0, 0,
+                                           m_vram_texture.get(), scaled_rect.left, scaled_rect.top,
+                                           scaled_rect.GetWidth(), scaled_rect.GetHeight());
+      }
+      else
+      {
+        g_gpu_device->CopyTextureRegion(m_vram_read_texture.get(), scaled_rect.left, scaled_rect.top, 0, 0,
+                                        m_vram_texture.get(), scaled_rect.left, scaled_rect.top, 0, 0,
+                                        scaled_rect.GetWidth(), scaled_rect.GetHeight());
+      }
+    }
   }
 
   m_renderer_stats.num_vram_read_texture_updates++;
-  ClearVRAMDirtyRectangle();
 }
 
 void GPU_HW::UpdateDepthBufferFromMaskBit()
@@ -1250,6 +2018,9 @@ void GPU_HW::UpdateDepthBufferFromMaskBit()
   if (m_pgxp_depth_buffer)
     return;
 
+  if (m_device_context_dirty)
+    RestoreDeviceContext();
+
   // Viewport should already be set full, only need to fudge the scissor.
   g_gpu_device->SetScissor(0, 0, m_vram_texture->GetWidth(), m_vram_texture->GetHeight());
   g_gpu_device->SetFramebuffer(m_vram_update_depth_framebuffer.get());
@@ -1307,10 +2078,66 @@ void GPU_HW::DrawBatchVertices(BatchRenderMode render_mode, u32 num_vertices, u3
 {
   // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
   const u8 depth_test = m_batch.use_depth_buffer ? static_cast<u8>(2) : BoolToUInt8(m_batch.check_mask_before_draw);
-  g_gpu_device->SetPipeline(
+  const std::unique_ptr<GPUPipeline>& pipeline =
     m_batch_pipelines[depth_test][static_cast<u8>(render_mode)][static_cast<u8>(m_batch.texture_mode)][static_cast<u8>(
-      m_batch.transparency_mode)][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)]
-      .get());
+      m_batch.transparency_mode)][BoolToUInt8(m_batch.dithering)][BoolToUInt8(m_batch.interlacing)];
+  if (!pipeline) [[unlikely]]
+  {
+    const u32 index = BatchPipelineKey{depth_test,
+                                       static_cast<u8>(render_mode),
+                                       static_cast<u8>(m_batch.texture_mode),
+                                       static_cast<u8>(m_batch.transparency_mode),
+                                       BoolToUInt8(m_batch.dithering),
+                                       BoolToUInt8(m_batch.interlacing)}
+                        .GetPipelineIndex();
+    if (m_use_ubershaders)
+    {
+      AddCompiledBatchPipelines();
+      if (!pipeline)
+      {
+        QueueBatchPipeline(index);
+        DrawBatchVerticesWithUbershader(depth_test, render_mode, num_vertices, base_vertex);
+        return;
+      }
+    }
+    else
+    {
+      Log_DevPrintf("Compiling batch pipeline %u on demand", index);
+      if (!CompileBatchPipeline(index))
+      {
+        Log_ErrorPrintf("Failed to compile batch pipeline %u", index);
+        return;
+      }
+
+      m_used_batch_pipelines.set(index);
+      m_used_batch_pipelines_dirty = true;
+    }
+  }
+
+  g_gpu_device->SetPipeline(pipeline.get());
+  g_gpu_device->Draw(num_vertices, base_vertex);
+}
+
+void GPU_HW::DrawBatchVerticesWithUbershader(u8 depth_test, BatchRenderMode render_mode, u32 num_vertices,
+                                             u32 base_vertex)
+{
+  const u32 texture_mode = static_cast<u32>(m_batch.texture_mode);
+  const u32 dithering = BoolToUInt32(m_batch.dithering);
+  const u32 interlacing = BoolToUInt32(m_batch.interlacing);
+  if (m_batch_ubo_data.u_texture_mode != texture_mode || m_batch_ubo_data.u_dithering != dithering ||
+      m_batch_ubo_data.u_interlacing != interlacing)
+  {
+    m_batch_ubo_data.u_texture_mode = texture_mode;
+    m_batch_ubo_data.u_dithering = dithering;
+    m_batch_ubo_data.u_interlacing = interlacing;
+    g_gpu_device->UploadUniformBuffer(&m_batch_ubo_data, sizeof(m_batch_ubo_data));
+    m_renderer_stats.num_uniform_buffer_updates++;
+  }
+
+  const bool textured = (m_batch.texture_mode != GPUTextureMode::Disabled);
+  g_gpu_device->SetPipeline(m_batch_uber_pipelines[depth_test][static_cast<u8>(render_mode)][BoolToUInt8(textured)]
+                                                  [static_cast<u8>(m_batch.transparency_mode)]
+                                                    .get());
   g_gpu_device->Draw(num_vertices, base_vertex);
 }
 
@@ -1444,6 +2271,21 @@ void GPU_HW::SetBatchDepthBuffer(bool enabled)
   m_batch.use_depth_buffer = enabled;
 }
 
+void GPU_HW::CheckForBatchOverlap(u32 left, u32 right, u32 top, u32 bottom)
+{
+  if (m_batch_drawn_blocks.Intersects(Common::Rectangle<u32>(left, top, right, bottom)))
+  {
+    FlushRender();
+    EnsureVertexBufferSpaceForCurrentCommand();
+  }
+  else if (GetBatchVertexCount() > 0)
+  {
+    m_renderer_stats.num_batches_merged += NeedsTwoPassRendering() ? 2 : 1;
+  }
+
+  m_batch_drawn_blocks.Include(left, right, top, bottom);
+}
+
 void GPU_HW::CheckForDepthClear(const BatchVertex* vertices, u32 num_vertices)
 {
   DebugAssert(num_vertices == 3 || num_vertices == 4);
@@ -1641,6 +2483,25 @@ void GPU_HW::LoadVertices()
       if (!IsDrawingAreaIsValid())
         return;
 
+      if (m_batch.transparency_mode == GPUTransparencyMode::BackgroundMinusForeground)
+      {
+        s32 min_x = native_vertex_positions[0][0], max_x = min_x;
+        s32 min_y = native_vertex_positions[0][1], max_y = min_y;
+        for (u32 i = 1; i < num_vertices; i++)
+        {
+          min_x = std::min(min_x, native_vertex_positions[i][0]);
+          max_x = std::max(max_x, native_vertex_positions[i][0]);
+          min_y = std::min(min_y, native_vertex_positions[i][1]);
+          max_y = std::max(max_y, native_vertex_positions[i][1]);
+        }
+
+        CheckForBatchOverlap(
+          static_cast<u32>(std::clamp<s32>(min_x, m_drawing_area.left, m_drawing_area.right)),
+          static_cast<u32>(std::clamp<s32>(max_x, m_drawing_area.left, m_drawing_area.right)) + 1u,
+          static_cast<u32>(std::clamp<s32>(min_y, m_drawing_area.top, m_drawing_area.bottom)),
+          static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u);
+      }
+
       // Cull polygons which are too large.
       const auto [min_x_12, max_x_12] = MinMax(native_vertex_positions[1][0], native_vertex_positions[2][0]);
       const auto [min_y_12, max_y_12] = MinMax(native_vertex_positions[1][1], native_vertex_positions[2][1]);
@@ -1663,7 +2524,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawnVRAMArea(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawTriangleTicks(native_vertex_positions[0][0], native_vertex_positions[0][1],
                              native_vertex_positions[1][0], native_vertex_positions[1][1],
                              native_vertex_positions[2][0], native_vertex_positions[2][1], rc.shading_enable,
@@ -1697,7 +2558,7 @@ void GPU_HW::LoadVertices()
           const u32 clip_bottom =
             static_cast<u32>(std::clamp<s32>(max_y_123, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-          m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+          IncludeDrawnVRAMArea(clip_left, clip_right, clip_top, clip_bottom);
           AddDrawTriangleTicks(native_vertex_positions[2][0], native_vertex_positions[2][1],
                                native_vertex_positions[1][0], native_vertex_positions[1][1],
                                native_vertex_positions[3][0], native_vertex_positions[3][1], rc.shading_enable,
@@ -1773,6 +2634,16 @@ void GPU_HW::LoadVertices()
       if (!IsDrawingAreaIsValid())
         return;
 
+      const u32 clip_left = static_cast<u32>(std::clamp<s32>(pos_x, m_drawing_area.left, m_drawing_area.right));
+      const u32 clip_right =
+        static_cast<u32>(std::clamp<s32>(pos_x + rectangle_width, m_drawing_area.left, m_drawing_area.right)) + 1u;
+      const u32 clip_top = static_cast<u32>(std::clamp<s32>(pos_y, m_drawing_area.top, m_drawing_area.bottom));
+      const u32 clip_bottom =
+        static_cast<u32>(std::clamp<s32>(pos_y + rectangle_height, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
+
+      if (m_batch.transparency_mode == GPUTransparencyMode::BackgroundMinusForeground)
+        CheckForBatchOverlap(clip_left, clip_right, clip_top, clip_bottom);
+
       // we can split the rectangle up into potentially 8 quads
       SetBatchDepthBuffer(false);
       DebugAssert(GetBatchVertexSpace() >= MAX_VERTICES_FOR_RECTANGLE);
@@ -1811,14 +2682,7 @@ void GPU_HW::LoadVertices()
         tex_top = 0;
       }
 
-      const u32 clip_left = static_cast<u32>(std::clamp<s32>(pos_x, m_drawing_area.left, m_drawing_area.right));
-      const u32 clip_right =
-        static_cast<u32>(std::clamp<s32>(pos_x + rectangle_width, m_drawing_area.left, m_drawing_area.right)) + 1u;
-      const u32 clip_top = static_cast<u32>(std::clamp<s32>(pos_y, m_drawing_area.top, m_drawing_area.bottom));
-      const u32 clip_bottom =
-        static_cast<u32>(std::clamp<s32>(pos_y + rectangle_height, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
-
-      m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+      IncludeDrawnVRAMArea(clip_left, clip_right, clip_top, clip_bottom);
       AddDrawRectangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.texture_enable, rc.transparency_enable);
 
       if (m_sw_renderer)
@@ -1881,7 +2745,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawnVRAMArea(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
         // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -1948,7 +2812,7 @@ void GPU_HW::LoadVertices()
             const u32 clip_bottom =
               static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-            m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+            IncludeDrawnVRAMArea(clip_left, clip_right, clip_top, clip_bottom);
             AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
             // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -2012,7 +2876,8 @@ bool GPU_HW::BlitVRAMReplacementTexture(const TextureReplacementTexture* tex, u3
 
 void GPU_HW::IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect)
 {
-  m_vram_dirty_rect.Include(rect);
+  m_vram_dirty_blocks.Include(rect.left, rect.right, rect.top, rect.bottom);
+  m_vram_shadow_stale_blocks.Include(rect.left, rect.right, rect.top, rect.bottom);
 
   // the vram area can include the texture page, but the game can leave it as-is. in this case, set it as dirty so the
   // shadow texture is updated
@@ -2024,6 +2889,15 @@ void GPU_HW::IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect)
   }
 }
 
+void GPU_HW::IncludeDrawnVRAMArea(u32 left, u32 right, u32 top, u32 bottom)
+{
+  m_vram_dirty_blocks.Include(left, right, top, bottom);
+  m_vram_shadow_stale_blocks.Include(left, right, top, bottom);
+  m_sw_renderer_pending_blocks.Include(left, right, top, bottom);
+  if (m_render_skip)
+    m_render_skipped_blocks.Include(left, right, top, bottom);
+}
+
 ALWAYS_INLINE bool GPU_HW::IsFlushed() const
 {
   return m_batch_current_vertex_ptr == m_batch_start_vertex_ptr;
@@ -2130,10 +3004,19 @@ ALWAYS_INLINE float GPU_HW::GetCurrentNormalizedVertexDepth() const
 void GPU_HW::UpdateSoftwareRenderer(bool copy_vram_from_hw)
 {
   const bool current_enabled = (m_sw_renderer != nullptr);
-  const bool new_enabled = g_settings.gpu_use_software_renderer_for_readbacks;
+  const bool new_enabled = g_settings.gpu_use_software_renderer_for_readbacks || g_settings.gpu_render_skip;
   if (current_enabled == new_enabled)
     return;
 
+  if (!new_enabled)
+  {
+    // Anything skipped only exists in the software renderer's VRAM.
+    VRAMBlockMask all_blocks;
+    all_blocks.SetAll();
+    UpdateRenderSkippedBlocks(all_blocks);
+    m_render_skip = false;
+  }
+
   m_vram_ptr = m_vram_shadow.data();
 
   if (!new_enabled)
@@ -2141,6 +3024,7 @@ void GPU_HW::UpdateSoftwareRenderer(bool copy_vram_from_hw)
     if (m_sw_renderer)
       m_sw_renderer->Shutdown();
     m_sw_renderer.reset();
+    m_vram_shadow_stale_blocks.SetAll();
     return;
   }
 
@@ -2162,9 +3046,37 @@ void GPU_HW::UpdateSoftwareRenderer(bool copy_vram_from_hw)
   }
 
   m_sw_renderer = std::move(sw_renderer);
+  m_sw_renderer_pending_blocks.Clear();
   m_vram_ptr = m_sw_renderer->GetVRAM();
 }
 
+void GPU_HW::UpdateRenderSkippedBlocks(const VRAMBlockMask& area)
+{
+  if (!m_render_skipped_blocks.Intersects(area))
+    return;
+
+  FlushRender();
+
+  const VRAMBlockMask blocks = m_render_skipped_blocks.TakeIntersection(area);
+  if (m_sw_renderer_pending_blocks.Intersects(blocks))
+  {
+    m_sw_renderer->Sync(false);
+    m_sw_renderer_pending_blocks.Clear();
+  }
+
+  std::vector<Common::Rectangle<u32>> rects;
+  blocks.GetRectangles(&rects);
+
+  const u16* vram = m_sw_renderer->GetVRAM();
+  for (const Common::Rectangle<u32>& rect : rects)
+  {
+    Log_DebugPrintf("Restoring skipped VRAM area %u,%u %ux%u", rect.left, rect.top, rect.GetWidth(),
+                    rect.GetHeight());
+    UpdateVRAMOnGPU(rect.left, rect.top, rect.GetWidth(), rect.GetHeight(), &vram[rect.top * VRAM_WIDTH + rect.left],
+                    VRAM_WIDTH * sizeof(u16), false, false);
+  }
+}
+
 void GPU_HW::FillBackendCommandParameters(GPUBackendCommand* cmd) const
 {
   cmd->params.bits = 0;
@@ -2195,11 +3107,21 @@ void GPU_HW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
     cmd->height = static_cast<u16>(height);
     cmd->color = color;
     m_sw_renderer->PushCommand(cmd);
+    m_sw_renderer_pending_blocks.IncludeWrapped(Common::Rectangle<u32>::FromExtents(x, y, width, height));
   }
 
   IncludeVRAMDirtyRectangle(
     Common::Rectangle<u32>::FromExtents(x, y, width, height).Clamped(0, 0, VRAM_WIDTH, VRAM_HEIGHT));
 
+  // Interlaced fills only write every other line, the rest is still skipped.
+  if (!IsInterlacedRenderingEnabled())
+  {
+    m_render_skipped_blocks.ClearContained(
+      Common::Rectangle<u32>::FromExtents(x, y, width, height).Clamped(0, 0, VRAM_WIDTH, VRAM_HEIGHT));
+  }
+
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::VRAMTransfer);
+
   const bool is_oversized = (((x + width) > VRAM_WIDTH || (y + height) > VRAM_HEIGHT));
   g_gpu_device->SetPipeline(
     m_vram_fill_pipelines[BoolToUInt8(is_oversized)][BoolToUInt8(IsInterlacedRenderingEnabled())].get());
@@ -2228,22 +3150,38 @@ void GPU_HW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
   uniforms.u_interlaced_displayed_field = GetActiveLineLSB();
   g_gpu_device->PushUniformBuffer(&uniforms, sizeof(uniforms));
   g_gpu_device->Draw(3, 0);
+  g_gpu_device->EndTimingScope();
 
-  RestoreDeviceContext();
+  m_device_context_dirty = true;
 }
 
 void GPU_HW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 {
+  // Get bounds with wrap-around handled.
+  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+
   if (m_sw_renderer)
   {
-    m_sw_renderer->Sync(false);
+    // Only wait for the software renderer if it still has commands writing to the area being read.
+    if (m_sw_renderer_pending_blocks.Intersects(copy_rect))
+    {
+      m_sw_renderer->Sync(false);
+      m_sw_renderer_pending_blocks.Clear();
+    }
+
     return;
   }
 
-  // Get bounds with wrap-around handled.
-  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+  // Nothing to do if the GPU hasn't touched this area since it was last read back, e.g. repeated saves, or games
+  // reading back areas they've only uploaded to. Pending draws have already marked their area, so they must be
+  // submitted before the download clears it.
+  FlushRender();
+  if (!m_vram_shadow_stale_blocks.Intersects(copy_rect))
+    return;
+
   const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
   const u32 encoded_height = copy_rect.GetHeight();
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::Readback);
 
   // Encode the 24-bit texture as 16-bit.
   const u32 uniforms[4] = {copy_rect.left, copy_rect.top, copy_rect.GetWidth(), copy_rect.GetHeight()};
@@ -2260,6 +3198,10 @@ void GPU_HW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
                                 reinterpret_cast<u32*>(&m_vram_shadow[copy_rect.top * VRAM_WIDTH + copy_rect.left]),
                                 VRAM_WIDTH * sizeof(u16));
 
+  // Only blocks entirely inside the copy are up to date now.
+  m_vram_shadow_stale_blocks.ClearContained(copy_rect);
+  g_gpu_device->EndTimingScope();
+
   RestoreDeviceContext();
 }
 
@@ -2278,11 +3220,38 @@ void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, b
     cmd->height = static_cast<u16>(height);
     std::memcpy(cmd->data, data, sizeof(u16) * num_words);
     m_sw_renderer->PushCommand(cmd);
+    m_sw_renderer_pending_blocks.IncludeWrapped(Common::Rectangle<u32>::FromExtents(x, y, width, height));
+  }
+
+  if (!check_mask)
+  {
+    const TextureReplacementTexture* rtex =
+      g_texture_replacements.GetVRAMWriteReplacement(width, height, data, m_resolution_scale);
+    if (rtex)
+    {
+      const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(x, y, width, height);
+      IncludeVRAMDirtyRectangle(bounds);
+      m_render_skipped_blocks.ClearContained(bounds);
+
+      g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::VRAMTransfer);
+      const bool blitted = BlitVRAMReplacementTexture(rtex, x * m_resolution_scale, y * m_resolution_scale,
+                                                      width * m_resolution_scale, height * m_resolution_scale);
+      g_gpu_device->EndTimingScope();
+      if (blitted)
+        return;
+    }
   }
 
+  UpdateVRAMOnGPU(x, y, width, height, data, width * sizeof(u16), set_mask, check_mask);
+}
+
+void GPU_HW::UpdateVRAMOnGPU(u32 x, u32 y, u32 width, u32 height, const void* data, u32 data_pitch, bool set_mask,
+                             bool check_mask)
+{
   const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(x, y, width, height);
   DebugAssert(bounds.right <= VRAM_WIDTH && bounds.bottom <= VRAM_HEIGHT);
   IncludeVRAMDirtyRectangle(bounds);
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::VRAMTransfer);
 
   if (check_mask)
   {
@@ -2291,18 +3260,14 @@ void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, b
   }
   else
   {
-    const TextureReplacementTexture* rtex = g_texture_replacements.GetVRAMWriteReplacement(width, height, data);
-    if (rtex && BlitVRAMReplacementTexture(rtex, x * m_resolution_scale, y * m_resolution_scale,
-                                           width * m_resolution_scale, height * m_resolution_scale))
-    {
-      return;
-    }
+    // every pixel is replaced, so any skipped blocks covered are up to date
+    m_render_skipped_blocks.ClearContained(bounds);
   }
 
   const u32 num_pixels = width * height;
   void* map = m_vram_upload_buffer->Map(num_pixels);
   const u32 map_index = m_vram_upload_buffer->GetCurrentPosition();
-  std::memcpy(map, data, num_pixels * sizeof(u16));
+  StringUtil::StrideMemCpy(map, width * sizeof(u16), data, data_pitch, width * sizeof(u16), height);
   m_vram_upload_buffer->Unmap(num_pixels);
 
   struct VRAMWriteUBOData
@@ -2321,15 +3286,17 @@ void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, b
     (x % VRAM_WIDTH), (y % VRAM_HEIGHT), ((x + width) % VRAM_WIDTH),  ((y + height) % VRAM_HEIGHT),     width,
     height,           map_index,         (set_mask) ? 0x8000u : 0x00, GetCurrentNormalizedVertexDepth()};
 
-  // the viewport should already be set to the full vram, so just adjust the scissor
+  // full vram viewport, clipped by the scissor
   const Common::Rectangle<u32> scaled_bounds = bounds * m_resolution_scale;
+  g_gpu_device->SetViewport(0, 0, m_vram_texture->GetWidth(), m_vram_texture->GetHeight());
   g_gpu_device->SetScissor(scaled_bounds.left, scaled_bounds.top, scaled_bounds.GetWidth(), scaled_bounds.GetHeight());
   g_gpu_device->SetPipeline(m_vram_write_pipelines[BoolToUInt8(check_mask && !m_pgxp_depth_buffer)].get());
   g_gpu_device->PushUniformBuffer(&uniforms, sizeof(uniforms));
   g_gpu_device->SetTextureBuffer(0, m_vram_upload_buffer.get());
   g_gpu_device->Draw(3, 0);
+  g_gpu_device->EndTimingScope();
 
-  RestoreDeviceContext();
+  m_device_context_dirty = true;
 }
 
 void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
@@ -2345,6 +3312,23 @@ void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
     cmd->width = static_cast<u16>(width);
     cmd->height = static_cast<u16>(height);
     m_sw_renderer->PushCommand(cmd);
+    m_sw_renderer_pending_blocks.IncludeWrapped(Common::Rectangle<u32>::FromExtents(dst_x, dst_y, width, height));
+  }
+
+  VRAMBlockMask src_skipped_blocks;
+  src_skipped_blocks.IncludeWrapped(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height));
+  if (m_render_skip && m_render_skipped_blocks.Intersects(src_skipped_blocks))
+  {
+    // Copying what was never drawn would be wasted, the destination is restored along with the source.
+    m_render_skipped_blocks.IncludeWrapped(Common::Rectangle<u32>::FromExtents(dst_x, dst_y, width, height));
+    return;
+  }
+
+  UpdateRenderSkippedBlocks(src_skipped_blocks);
+  if (!m_GPUSTAT.check_mask_before_draw)
+  {
+    m_render_skipped_blocks.ClearContained(
+      Common::Rectangle<u32>::FromExtents(dst_x, dst_y, width, height).Clamped(0, 0, VRAM_WIDTH, VRAM_HEIGHT));
   }
 
   // masking enabled, oversized, or overlapping
@@ -2359,9 +3343,12 @@ void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
     const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
-    if (m_vram_dirty_rect.Intersects(src_bounds))
-      UpdateVRAMReadTexture();
+    VRAMBlockMask src_blocks;
+    src_blocks.Include(src_bounds.left, src_bounds.right, src_bounds.top, src_bounds.bottom);
+    if (m_vram_dirty_blocks.Intersects(src_blocks))
+      UpdateVRAMReadTexture(src_blocks);
     IncludeVRAMDirtyRectangle(dst_bounds);
+    g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::VRAMTransfer);
 
     struct VRAMCopyUBOData
     {
@@ -2387,15 +3374,17 @@ void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
                                       m_GPUSTAT.set_mask_while_drawing ? 1u : 0u,
                                       GetCurrentNormalizedVertexDepth()};
 
-    // VRAM read texture should already be bound.
+    // the previous transfer may have left the upload buffer bound
     const Common::Rectangle<u32> dst_bounds_scaled(dst_bounds * m_resolution_scale);
+    g_gpu_device->SetTextureSampler(0, m_vram_read_texture.get(), g_gpu_device->GetNearestSampler());
     g_gpu_device->SetViewportAndScissor(dst_bounds_scaled.left, dst_bounds_scaled.top, dst_bounds_scaled.GetWidth(),
                                         dst_bounds_scaled.GetHeight());
     g_gpu_device->SetPipeline(
       m_vram_copy_pipelines[BoolToUInt8(m_GPUSTAT.check_mask_before_draw && !m_pgxp_depth_buffer)].get());
     g_gpu_device->PushUniformBuffer(&uniforms, sizeof(uniforms));
     g_gpu_device->Draw(3, 0);
-    RestoreDeviceContext();
+    g_gpu_device->EndTimingScope();
+    m_device_context_dirty = true;
 
     if (m_GPUSTAT.check_mask_before_draw && !m_pgxp_depth_buffer)
       m_current_depth++;
@@ -2409,8 +3398,10 @@ void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
 
   // TODO: make this an optional feature, DX12 can do it
 
-  if (m_vram_dirty_rect.Intersects(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height)))
-    UpdateVRAMReadTexture();
+  VRAMBlockMask src_blocks;
+  src_blocks.Include(src_x, src_x + width, src_y, src_y + height);
+  if (m_vram_dirty_blocks.Intersects(src_blocks))
+    UpdateVRAMReadTexture(src_blocks);
 
   IncludeVRAMDirtyRectangle(
     Common::Rectangle<u32>::FromExtents(dst_x, dst_y, width, height).Clamped(0, 0, VRAM_WIDTH, VRAM_HEIGHT));
@@ -2421,9 +3412,11 @@ void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32
     m_current_depth++;
   }
 
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::VRAMTransfer);
   g_gpu_device->CopyTextureRegion(m_vram_texture.get(), dst_x * m_resolution_scale, dst_y * m_resolution_scale, 0, 0,
                                   m_vram_read_texture.get(), src_x * m_resolution_scale, src_y * m_resolution_scale, 0,
                                   0, width * m_resolution_scale, height * m_resolution_scale);
+  g_gpu_device->EndTimingScope();
   m_vram_read_texture->MakeReadyForSampling();
 }
 
@@ -2435,18 +3428,23 @@ void GPU_HW::DispatchRenderCommand()
   if (rc.IsTexturingEnabled())
   {
     // texture page changed - check that the new page doesn't intersect the drawing area
-    if (m_draw_mode.IsTexturePageChanged())
+    // skipped draws don't sample, so the page is left for the first draw after skipping
+    if (m_draw_mode.IsTexturePageChanged() && !m_render_skip)
     {
       m_draw_mode.ClearTexturePageChangedFlag();
-      if (m_vram_dirty_rect.Valid() && (m_draw_mode.mode_reg.GetTexturePageRectangle().Intersects(m_vram_dirty_rect) ||
-                                        (m_draw_mode.mode_reg.IsUsingPalette() &&
-                                         m_draw_mode.GetTexturePaletteRectangle().Intersects(m_vram_dirty_rect))))
+      // only sync what this page samples, draws elsewhere stay dirty until something reads them
+      VRAMBlockMask sampled_blocks;
+      sampled_blocks.IncludeWrapped(m_draw_mode.mode_reg.GetTexturePageRectangle());
+      if (m_draw_mode.mode_reg.IsUsingPalette())
+        sampled_blocks.IncludeWrapped(m_draw_mode.GetTexturePaletteRectangle());
+      UpdateRenderSkippedBlocks(sampled_blocks);
+      if (m_vram_dirty_blocks.Intersects(sampled_blocks))
       {
         // Log_DevPrintf("Invalidating VRAM read cache due to drawing area overlap");
         if (!IsFlushed())
           FlushRender();
 
-        UpdateVRAMReadTexture();
+        UpdateVRAMReadTexture(sampled_blocks);
       }
     }
 
@@ -2466,8 +3464,10 @@ void GPU_HW::DispatchRenderCommand()
   const GPUTransparencyMode transparency_mode =
     rc.transparency_enable ? m_draw_mode.mode_reg.transparency_mode : GPUTransparencyMode::Disabled;
   const bool dithering_enable = (!m_true_color && rc.IsDitheringEnabled()) ? m_GPUSTAT.dither_enable : false;
+  // BG-FG polygons and rectangles can share a batch as long as they don't overlap, see CheckForBatchOverlap().
   if (texture_mode != m_batch.texture_mode || transparency_mode != m_batch.transparency_mode ||
-      transparency_mode == GPUTransparencyMode::BackgroundMinusForeground || dithering_enable != m_batch.dithering)
+      (transparency_mode == GPUTransparencyMode::BackgroundMinusForeground && rc.primitive == GPUPrimitive::Line) ||
+      dithering_enable != m_batch.dithering)
   {
     FlushRender();
   }
@@ -2546,8 +3546,10 @@ void GPU_HW::FlushRender()
   if (!m_batch_current_vertex_ptr)
     return;
 
-  const u32 vertex_count = GetBatchVertexCount();
+  // Skipped batches are never uploaded, the software renderer has already drawn them.
+  const u32 vertex_count = m_render_skip ? 0 : GetBatchVertexCount();
   UnmapBatchVertexPointer(vertex_count);
+  m_batch_drawn_blocks.Clear();
 
   if (vertex_count == 0)
     return;
@@ -2556,6 +3558,11 @@ void GPU_HW::FlushRender()
   GL_SCOPE_FMT("Hardware Draw {}", ++s_draw_number);
 #endif
 
+  if (m_device_context_dirty)
+    RestoreDeviceContext();
+
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::Draw);
+
   if (m_batch_ubo_dirty)
   {
     g_gpu_device->UploadUniformBuffer(&m_batch_ubo_data, sizeof(m_batch_ubo_data));
@@ -2584,14 +3591,27 @@ void GPU_HW::FlushRender()
     g_gpu_device->SetPipeline(m_wireframe_pipeline.get());
     g_gpu_device->Draw(vertex_count, m_batch_base_vertex);
   }
+
+  g_gpu_device->EndTimingScope();
 }
 
 void GPU_HW::UpdateDisplay()
 {
   FlushRender();
 
+  if (m_use_ubershaders)
+    CompileQueuedBatchPipeline();
+
+  // The frame won't be presented, and the display area may not have been drawn.
+  if (m_render_skip)
+    return;
+
   if (g_settings.debugging.show_vram)
   {
+    VRAMBlockMask all_blocks;
+    all_blocks.SetAll();
+    UpdateRenderSkippedBlocks(all_blocks);
+
     if (IsUsingMultisampling())
     {
       UpdateVRAMReadTexture();
@@ -2624,6 +3644,22 @@ void GPU_HW::UpdateDisplay()
     const u32 scaled_display_height = display_height * resolution_scale;
     const InterlacedRenderMode interlaced = GetInterlacedRenderMode();
 
+    // 24-bit scanout starts at the register X, and reads 1.5 halfwords per pixel.
+    VRAMBlockMask displayed_blocks;
+    if (m_GPUSTAT.display_area_color_depth_24)
+    {
+      const u32 start_x = m_crtc_state.regs.X;
+      const u32 crop_left = (vram_offset_x - start_x) % VRAM_WIDTH;
+      displayed_blocks.IncludeWrapped(Common::Rectangle<u32>::FromExtents(
+        start_x, vram_offset_y, ((crop_left + display_width) * 3) / 2 + 1, display_height));
+    }
+    else
+    {
+      displayed_blocks.IncludeWrapped(
+        Common::Rectangle<u32>::FromExtents(vram_offset_x, vram_offset_y, display_width, display_height));
+    }
+    UpdateRenderSkippedBlocks(displayed_blocks);
+
     if (IsDisplayDisabled())
     {
       ClearDisplayTexture();
@@ -2680,10 +3716,12 @@ void GPU_HW::UpdateDisplay()
 
 void GPU_HW::DownsampleFramebuffer(GPUTexture* source, u32 left, u32 top, u32 width, u32 height)
 {
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::Downsample);
   if (m_downsample_mode == GPUDownsampleMode::Adaptive)
     DownsampleFramebufferAdaptive(source, left, top, width, height);
   else
     DownsampleFramebufferBoxFilter(source, left, top, width, height);
+  g_gpu_device->EndTimingScope();
 }
 
 void GPU_HW::DownsampleFramebufferAdaptive(GPUTexture* source, u32 left, u32 top, u32 width, u32 height)
@@ -2807,6 +3845,10 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
 {
   if (!is_idle_frame)
   {
+    m_renderer_stats.num_stream_buffer_wraps = GPUDevice::s_stats.num_stream_buffer_wraps;
+    m_renderer_stats.num_stream_buffer_stalls = GPUDevice::s_stats.num_stream_buffer_stalls;
+    GPUDevice::s_stats = {};
+
     m_last_renderer_stats = m_renderer_stats;
     m_renderer_stats = {};
   }
@@ -2864,7 +3906,7 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
 
     ImGui::TextUnformatted("Batches Drawn:");
     ImGui::NextColumn();
-    ImGui::Text("%u", stats.num_batches);
+    ImGui::Text("%u (%u without merging)", stats.num_batches, stats.num_batches + stats.num_batches_merged);
     ImGui::NextColumn();
 
     ImGui::TextUnformatted("VRAM Read Texture Updates:");
@@ -2877,6 +3919,12 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
     ImGui::Text("%u", stats.num_uniform_buffer_updates);
     ImGui::NextColumn();
 
+    ImGui::TextUnformatted("Stream Buffer Wraps/Stalls:");
+    ImGui::NextColumn();
+    ImGui::TextColored((stats.num_stream_buffer_stalls > 0) ? active_color : inactive_color, "%u / %u",
+                       stats.num_stream_buffer_wraps, stats.num_stream_buffer_stalls);
+    ImGui::NextColumn();
+
     ImGui::Columns(1);
   }
 }
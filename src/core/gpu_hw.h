@@ -11,12 +11,19 @@
 #include "common/dimensional_array.h"
 #include "common/heap_array.h"
 
+#include <bitset>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
 
+class GPU_HW_ShaderGen;
+class ShaderCompileProgressTracker;
 class GPU_SW_Backend;
 struct GPUBackendCommand;
 struct GPUBackendDrawCommand;
@@ -53,6 +60,8 @@ public:
 
   void UpdateSettings(const Settings& old_settings) override;
   void UpdateResolutionScale() override final;
+  void UpdateDynamicResolution(float gpu_time) override final;
+  void SetRenderSkip(bool skip) override final;
   std::tuple<u32, u32> GetEffectiveDisplayResolution(bool scaled = true) override final;
   std::tuple<u32, u32> GetFullDisplayResolution(bool scaled = true) override final;
 
@@ -108,22 +117,102 @@ private:
     float u_dst_alpha_factor;
     u32 u_interlaced_displayed_field;
     u32 u_set_mask_while_drawing;
+
+    // Only read by the ubershaders, specialized shaders have these built in.
+    u32 u_texture_mode;
+    u32 u_dithering;
+    u32 u_interlacing;
+  };
+
+  /// One bit per 32x16 block of VRAM, one word per row of blocks. Unlike a bounding box, two small areas at opposite
+  /// ends of VRAM don't mark everything in between.
+  struct VRAMBlockMask
+  {
+    static constexpr u32 BLOCK_WIDTH = 32;
+    static constexpr u32 BLOCK_HEIGHT = 16;
+    static constexpr u32 BLOCKS_X = VRAM_WIDTH / BLOCK_WIDTH;
+    static constexpr u32 BLOCKS_Y = VRAM_HEIGHT / BLOCK_HEIGHT;
+    static_assert(BLOCKS_X == 32);
+
+    std::array<u32, BLOCKS_Y> rows = {};
+
+    void Clear();
+    void SetAll();
+
+    /// Marks every block touched by the area, right/bottom are exclusive.
+    void Include(u32 left, u32 right, u32 top, u32 bottom);
+
+    /// Marks an area which can run past the edges of VRAM and wrap around, e.g. a texture page.
+    void IncludeWrapped(const Common::Rectangle<u32>& rect);
+
+    bool Intersects(const Common::Rectangle<u32>& rect) const;
+    bool Intersects(const VRAMBlockMask& mask) const;
+
+    /// Removes the blocks which are also marked in the mask, and returns them.
+    VRAMBlockMask TakeIntersection(const VRAMBlockMask& mask);
+
+    /// Clears only the blocks entirely inside the rectangle.
+    void ClearContained(const Common::Rectangle<u32>& rect);
+
+    /// Coalesces the marked blocks into rectangles, in VRAM coordinates.
+    void GetRectangles(std::vector<Common::Rectangle<u32>>* rects) const;
   };
 
   struct RendererStats
   {
     u32 num_batches;
+    u32 num_batches_merged;
     u32 num_vram_read_texture_updates;
     u32 num_uniform_buffer_updates;
+    u32 num_stream_buffer_wraps;
+    u32 num_stream_buffer_stalls;
   };
 
   bool CreateBuffers();
   void ClearFramebuffer();
   void DestroyBuffers();
 
+  /// Memory save states can hold VRAM at native resolution instead of a full copy, to save GPU memory.
+  bool IsNativeHostTexture(const GPUTexture* tex) const;
+  void DoNativeHostTexture(GPUTexture* tex, bool reading);
+
+  enum : u32
+  {
+    NUM_BATCH_PIPELINES = 3 * 4 * 5 * 9 * 2 * 2,
+    NUM_BATCH_FRAGMENT_SHADERS = 4 * 9 * 2 * 2,
+
+    // Transparency is only disabled in its own render mode, and the other render modes need it enabled.
+    NUM_UBER_PIPELINES = 3 * 2 * (1 + (3 * 4)),
+  };
+  using BatchPipelineSet = std::bitset<NUM_BATCH_PIPELINES>;
+
+  GPU_HW_ShaderGen GetShaderGen() const;
+  std::span<const GPUPipeline::VertexAttribute> GetBatchVertexAttributes(bool textured) const;
   bool CompilePipelines();
+  std::unique_ptr<GPUPipeline> CreateBatchPipeline(u8 depth_test, BatchRenderMode render_mode, bool textured,
+                                                   GPUTransparencyMode transparency_mode, GPUShader* fragment_shader);
+  std::unique_ptr<GPUPipeline> CreateBatchPipeline(u32 index);
+  bool CompileBatchPipeline(u32 index);
+  bool CompileBatchPipelines(const BatchPipelineSet& pipelines, ShaderCompileProgressTracker& progress);
+  bool CompileUberPipelines(ShaderCompileProgressTracker& progress);
   void DestroyPipelines();
 
+  /// With ubershaders, pipelines which are missing in lazy mode are compiled on a worker thread, or one per frame if
+  /// the device can't create pipelines on other threads. Draws use the ubershader until they're ready.
+  void StartPipelineCompileThread();
+  void StopPipelineCompileThread();
+  void PipelineCompileThreadEntryPoint();
+  void QueueBatchPipeline(u32 index);
+  void AddCompiledBatchPipelines();
+  void CompileQueuedBatchPipeline();
+  void DrawBatchVerticesWithUbershader(u8 depth_test, BatchRenderMode render_mode, u32 num_vertices, u32 base_vertex);
+
+  /// Per-game record of the batch pipelines which were used, so they can be precompiled in lazy mode.
+  static BatchPipelineSet GetCommonBatchPipelines();
+  static std::string GetUsedBatchPipelinesFileName(u64 game_hash);
+  void LoadUsedBatchPipelines();
+  void SaveUsedBatchPipelines();
+
   void LoadVertices();
 
   void AddVertex(const BatchVertex& v);
@@ -135,6 +224,9 @@ private:
   void CheckSettings();
 
   void UpdateVRAMReadTexture();
+
+  /// Only brings the blocks in the mask up to date, the rest of the dirty area is left for whatever samples it.
+  void UpdateVRAMReadTexture(const VRAMBlockMask& area);
   void UpdateDepthBufferFromMaskBit();
   void ClearDepthBuffer();
   void SetScissor();
@@ -142,7 +234,7 @@ private:
   void UnmapBatchVertexPointer(u32 used_vertices);
   void DrawBatchVertices(BatchRenderMode render_mode, u32 num_vertices, u32 base_vertex);
 
-  u32 CalculateResolutionScale() const;
+  u32 CalculateResolutionScale(bool apply_dynamic_limit = true) const;
   GPUDownsampleMode GetDownsampleMode(u32 resolution_scale) const;
 
   bool IsUsingMultisampling() const;
@@ -151,6 +243,7 @@ private:
   void SetFullVRAMDirtyRectangle();
   void ClearVRAMDirtyRectangle();
   void IncludeVRAMDirtyRectangle(const Common::Rectangle<u32>& rect);
+  void IncludeDrawnVRAMArea(u32 left, u32 right, u32 top, u32 bottom);
 
   bool IsFlushed() const;
   u32 GetBatchVertexSpace() const;
@@ -172,9 +265,14 @@ private:
   void FillDrawCommand(GPUBackendDrawCommand* cmd, GPURenderCommand rc) const;
   void UpdateSoftwareRenderer(bool copy_vram_from_hw);
 
+  /// Uploads the software renderer's copy of the skipped blocks in the area, at native resolution.
+  void UpdateRenderSkippedBlocks(const VRAMBlockMask& area);
+
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, bool set_mask, bool check_mask) override;
+  void UpdateVRAMOnGPU(u32 x, u32 y, u32 width, u32 height, const void* data, u32 data_pitch, bool set_mask,
+                       bool check_mask);
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
   void DispatchRenderCommand() override;
   void FlushRender() override;
@@ -193,6 +291,10 @@ private:
 
   /// Sets the depth test flag for PGXP depth buffering.
   void SetBatchDepthBuffer(bool enabled);
+
+  /// BG-FG primitives can only share a batch when they don't overlap, as textured ones are drawn in two passes.
+  /// Flushes if the area overlaps anything already in the batch.
+  void CheckForBatchOverlap(u32 left, u32 right, u32 top, u32 bottom);
   void CheckForDepthClear(const BatchVertex* vertices, u32 num_vertices);
 
   /// Returns the number of mipmap levels used for adaptive smoothing.
@@ -232,6 +334,12 @@ private:
   u32 m_resolution_scale = 1;
   u32 m_multisamples = 1;
 
+  // Dynamic resolution, the limit is zero when the configured scale is used as-is.
+  u32 m_dynamic_resolution_limit = 0;
+  u32 m_dynamic_resolution_frames = 0;
+  u32 m_dynamic_resolution_settle_windows = 0;
+  float m_dynamic_resolution_gpu_time = 0.0f;
+
   union
   {
     BitField<u8, bool, 0, 1> m_supports_dual_source_blend;
@@ -249,18 +357,63 @@ private:
   bool m_true_color = true;
   bool m_using_uv_limits = false;
   bool m_pgxp_depth_buffer = false;
+  bool m_lazy_batch_pipelines = false;
+  bool m_use_ubershaders = false;
 
   BatchConfig m_batch;
   BatchUBOData m_batch_ubo_data = {};
 
-  // Bounding box of VRAM area that the GPU has drawn into.
-  Common::Rectangle<u32> m_vram_dirty_rect;
+  // Areas of VRAM that the GPU has drawn into since the read texture was last updated.
+  VRAMBlockMask m_vram_dirty_blocks;
+
+  // Areas of VRAM written on the GPU since they were last read back into the shadow. Readbacks which only touch clean
+  // blocks can be satisfied from the shadow directly.
+  VRAMBlockMask m_vram_shadow_stale_blocks;
+
+  // Areas written by commands sent to the software renderer since it was last synced. Its thread can keep running
+  // while other parts of its VRAM are read.
+  VRAMBlockMask m_sw_renderer_pending_blocks;
+
+  // Areas which the hardware renderer didn't draw to while skipping frames, only the software renderer has them.
+  VRAMBlockMask m_render_skipped_blocks;
+  bool m_render_skip = false;
+
+  // Areas drawn by the current batch, only tracked when the order within it matters.
+  VRAMBlockMask m_batch_drawn_blocks;
+  std::vector<Common::Rectangle<u32>> m_vram_dirty_rects;
 
   // Changed state
   bool m_batch_ubo_dirty = true;
 
+  // Set by VRAM fills, writes and copies, which leave their own state bound. The batch state is only restored before
+  // the next draw that needs it, so runs of small transfers don't rebind it after each one.
+  bool m_device_context_dirty = false;
+
   // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
   DimensionalArray<std::unique_ptr<GPUPipeline>, 2, 2, 5, 9, 4, 3> m_batch_pipelines{};
+
+  // Only kept around in lazy mode, so pipelines can be created from them later.
+  // vertex shaders - [textured]
+  // fragment shaders - [render_mode][texture_mode][dithering][interlacing]
+  DimensionalArray<std::unique_ptr<GPUShader>, 2> m_batch_vertex_shaders{};
+  DimensionalArray<std::unique_ptr<GPUShader>, 2, 2, 9, 4> m_batch_fragment_shaders{};
+
+  BatchPipelineSet m_used_batch_pipelines;
+  u64 m_used_batch_pipelines_game_hash = 0;
+  bool m_used_batch_pipelines_dirty = false;
+
+  // Take texture mode, dithering and interlacing from the uniform buffer.
+  // [depth_test][render_mode][textured][transparency_mode]
+  DimensionalArray<std::unique_ptr<GPUPipeline>, 5, 2, 4, 3> m_batch_uber_pipelines{};
+
+  // Pipelines waiting to be compiled, and those which the worker has compiled, but the GPU thread hasn't picked up.
+  std::thread m_pipeline_compile_thread;
+  std::mutex m_pipeline_compile_mutex;
+  std::condition_variable m_pipeline_compile_cv;
+  std::deque<u32> m_pipeline_compile_queue;
+  std::vector<std::pair<u32, std::unique_ptr<GPUPipeline>>> m_compiled_batch_pipelines;
+  BatchPipelineSet m_queued_batch_pipelines;
+  bool m_pipeline_compile_shutdown = false;
   std::unique_ptr<GPUPipeline> m_wireframe_pipeline;
 
   // [wrapped][interlaced]
@@ -54,7 +54,8 @@ void GPU_HW_ShaderGen::WriteBatchUniformBuffer(std::stringstream& ss)
   DeclareUniformBuffer(ss,
                        {"uint2 u_texture_window_and", "uint2 u_texture_window_or", "float u_src_alpha_factor",
                         "float u_dst_alpha_factor", "uint u_interlaced_displayed_field",
-                        "bool u_set_mask_while_drawing"},
+                        "bool u_set_mask_while_drawing", "uint u_texture_mode", "bool u_dithering",
+                        "bool u_interlacing"},
                        false);
 }
 
@@ -630,7 +631,8 @@ void FilteredSampleFromVRAM(uint4 texpage, float2 coords, float4 uv_limits,
 }
 
 std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMode transparency,
-                                                          GPUTextureMode texture_mode, bool dithering, bool interlacing)
+                                                          GPUTextureMode texture_mode, bool dithering, bool interlacing,
+                                                          bool ubershader /* = false */)
 {
   const GPUTextureMode actual_texture_mode = texture_mode & ~GPUTextureMode::RawTextureBit;
   const bool raw_texture = (texture_mode & GPUTextureMode::RawTextureBit) == GPUTextureMode::RawTextureBit;
@@ -646,14 +648,30 @@ std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMod
   DefineMacro(ss, "TRANSPARENCY_ONLY_OPAQUE", transparency == GPU_HW::BatchRenderMode::OnlyOpaque);
   DefineMacro(ss, "TRANSPARENCY_ONLY_TRANSPARENT", transparency == GPU_HW::BatchRenderMode::OnlyTransparent);
   DefineMacro(ss, "TEXTURED", textured);
-  DefineMacro(ss, "PALETTE",
-              actual_texture_mode == GPUTextureMode::Palette4Bit || actual_texture_mode == GPUTextureMode::Palette8Bit);
-  DefineMacro(ss, "PALETTE_4_BIT", actual_texture_mode == GPUTextureMode::Palette4Bit);
-  DefineMacro(ss, "PALETTE_8_BIT", actual_texture_mode == GPUTextureMode::Palette8Bit);
-  DefineMacro(ss, "RAW_TEXTURE", raw_texture);
-  DefineMacro(ss, "DITHERING", dithering);
   DefineMacro(ss, "DITHERING_SCALED", m_scaled_dithering);
-  DefineMacro(ss, "INTERLACING", interlacing);
+
+  // These are tested with regular branches instead of the preprocessor, so the ubershader can take them from the
+  // uniform buffer. Specialized shaders get constants, and the compiler removes the branches.
+  if (ubershader)
+  {
+    ss << "#define PALETTE ((u_texture_mode & 2u) == 0u)\n";
+    ss << "#define PALETTE_4_BIT ((u_texture_mode & 3u) == 0u)\n";
+    ss << "#define RAW_TEXTURE ((u_texture_mode & 4u) != 0u)\n";
+    ss << "#define DITHERING u_dithering\n";
+    ss << "#define INTERLACING u_interlacing\n";
+  }
+  else
+  {
+    const auto define_constant = [&ss](const char* name, bool value) {
+      ss << "#define " << name << " " << (value ? "true" : "false") << "\n";
+    };
+    define_constant("PALETTE", actual_texture_mode == GPUTextureMode::Palette4Bit ||
+                                 actual_texture_mode == GPUTextureMode::Palette8Bit);
+    define_constant("PALETTE_4_BIT", actual_texture_mode == GPUTextureMode::Palette4Bit);
+    define_constant("RAW_TEXTURE", raw_texture);
+    define_constant("DITHERING", dithering);
+    define_constant("INTERLACING", interlacing);
+  }
   DefineMacro(ss, "TRUE_COLOR", m_true_color);
   DefineMacro(ss, "TEXTURE_FILTERING", m_texture_filter != GPUTextureFilter::Nearest);
   DefineMacro(ss, "UV_LIMITS", m_uv_limits);
@@ -722,14 +740,14 @@ uint2 FloatToIntegerCoords(float2 coords)
 
 float4 SampleFromVRAM(uint4 texpage, float2 coords)
 {
-  #if PALETTE
+  if (PALETTE)
+  {
     uint2 icoord = ApplyTextureWindow(FloatToIntegerCoords(coords));
     uint2 index_coord = icoord;
-    #if PALETTE_4_BIT
+    if (PALETTE_4_BIT)
       index_coord.x /= 4u;
-    #elif PALETTE_8_BIT
+    else
       index_coord.x /= 2u;
-    #endif
 
     // fixup coords
     uint2 vicoord = texpage.xy + (index_coord * uint2(RESOLUTION_SCALE, RESOLUTION_SCALE));
@@ -739,23 +757,29 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     uint vram_value = RGBA8ToRGBA5551(texel);
 
     // apply palette
-    #if PALETTE_4_BIT
+    uint palette_index;
+    if (PALETTE_4_BIT)
+    {
       uint subpixel = icoord.x & 3u;
-      uint palette_index = (vram_value >> (subpixel * 4u)) & 0x0Fu;
-    #elif PALETTE_8_BIT
+      palette_index = (vram_value >> (subpixel * 4u)) & 0x0Fu;
+    }
+    else
+    {
       uint subpixel = icoord.x & 1u;
-      uint palette_index = (vram_value >> (subpixel * 8u)) & 0xFFu;
-    #endif
+      palette_index = (vram_value >> (subpixel * 8u)) & 0xFFu;
+    }
 
     // sample palette
     uint2 palette_icoord = uint2(texpage.z + (palette_index * RESOLUTION_SCALE), texpage.w);
     return SAMPLE_TEXTURE(samp0, float2(palette_icoord) * RCP_VRAM_SIZE);
-  #else
+  }
+  else
+  {
     // Direct texturing. Render-to-texture effects. Use upscaled coordinates.
-    uint2 icoord = ApplyUpscaledTextureWindow(FloatToIntegerCoords(coords));    
+    uint2 icoord = ApplyUpscaledTextureWindow(FloatToIntegerCoords(coords));
     uint2 direct_icoord = texpage.xy + icoord;
     return SAMPLE_TEXTURE(samp0, float2(direct_icoord) * RCP_VRAM_SIZE);
-  #endif
+  }
 }
 
 #endif
@@ -795,28 +819,26 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
   float ialpha;
   float oalpha;
 
-  #if INTERLACING
-    if ((uint(v_pos.y) & 1u) == u_interlaced_displayed_field)
-      discard;
-  #endif
+  if (INTERLACING && (uint(v_pos.y) & 1u) == u_interlaced_displayed_field)
+    discard;
 
   #if TEXTURED
 
     // We can't currently use upscaled coordinate for palettes because of how they're packed.
     // Not that it would be any benefit anyway, render-to-texture effects don't use palettes.
     float2 coords = v_tex0;
-    #if PALETTE
+    if (PALETTE)
       coords /= float2(RESOLUTION_SCALE, RESOLUTION_SCALE);
-    #endif
 
     #if UV_LIMITS
       float4 uv_limits = v_uv_limits;
-      #if !PALETTE
-        // Extend the UV range to all "upscaled" pixels. This means 1-pixel-high polygon-based 
+      if (!PALETTE)
+      {
+        // Extend the UV range to all "upscaled" pixels. This means 1-pixel-high polygon-based
         // framebuffer effects won't be downsampled. (e.g. Mega Man Legends 2 haze effect)
         uv_limits *= float(RESOLUTION_SCALE);
         uv_limits.zw += float(RESOLUTION_SCALE - 1u);
-      #endif
+      }
     #endif
 
     float4 texcol;
@@ -841,24 +863,24 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     // If not using true color, truncate the framebuffer colors to 5-bit.
     #if !TRUE_COLOR
       icolor = uint3(texcol.rgb * float3(255.0, 255.0, 255.0)) >> 3;
-      #if !RAW_TEXTURE
+      if (!RAW_TEXTURE)
+      {
         icolor = (icolor * vertcol) >> 4;
-        #if DITHERING
+        if (DITHERING)
           icolor = ApplyDithering(uint2(v_pos.xy), icolor);
-        #else
+        else
           icolor = min(icolor >> 3, uint3(31u, 31u, 31u));
-        #endif
-      #endif
+      }
     #else
       icolor = uint3(texcol.rgb * float3(255.0, 255.0, 255.0));
-      #if !RAW_TEXTURE
+      if (!RAW_TEXTURE)
+      {
         icolor = (icolor * vertcol) >> 7;
-        #if DITHERING
+        if (DITHERING)
           icolor = ApplyDithering(uint2(v_pos.xy), icolor);
-        #else
+        else
           icolor = min(icolor, uint3(255u, 255u, 255u));
-        #endif
-      #endif
+      }
     #endif
 
     // Compute output alpha (mask bit)
@@ -869,13 +891,16 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     icolor = vertcol;
     ialpha = 1.0;
 
-    #if DITHERING
+    if (DITHERING)
+    {
       icolor = ApplyDithering(uint2(v_pos.xy), icolor);
-    #else
+    }
+    else
+    {
       #if !TRUE_COLOR
         icolor >>= 3;
       #endif
-    #endif
+    }
 
     // However, the mask bit is cleared if set mask bit is false.
     oalpha = float(u_set_mask_while_drawing);
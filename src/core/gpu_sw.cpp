@@ -230,17 +230,302 @@ ALWAYS_INLINE void CopyOutRow16<GPUTexture::Format::RGB565, u16>(const u16* src_
 template<>
 ALWAYS_INLINE void CopyOutRow16<GPUTexture::Format::RGBA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
 {
-  for (u32 col = 0; col < width; col++)
+  u32 col = 0;
+
+  // Each pixel is built as two halves, red/green and blue/alpha, which are then interleaved.
+#if defined(CPU_ARCH_SSE)
+  const __m128i g_mask = _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0xF800)));
+  const __m128i a_mask = _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0xFF00)));
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+    src_ptr += 8;
+    const __m128i r = _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(0x1F)), 3);
+    const __m128i g = _mm_and_si128(_mm_slli_epi16(value, 6), g_mask);
+    const __m128i b = _mm_and_si128(_mm_srli_epi16(value, 7), _mm_set1_epi16(0xF8));
+    const __m128i a = _mm_and_si128(_mm_srai_epi16(value, 15), a_mask);
+    const __m128i rg = _mm_or_si128(r, g);
+    const __m128i ba = _mm_or_si128(b, a);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), _mm_unpacklo_epi16(rg, ba));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + 4), _mm_unpackhi_epi16(rg, ba));
+    dst_ptr += 8;
+  }
+#elif defined(CPU_ARCH_NEON)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint16x8_t value = vld1q_u16(src_ptr);
+    src_ptr += 8;
+    const uint16x8_t r = vshlq_n_u16(vandq_u16(value, vdupq_n_u16(0x1F)), 3);
+    const uint16x8_t g = vandq_u16(vshlq_n_u16(value, 6), vdupq_n_u16(0xF800));
+    const uint16x8_t b = vandq_u16(vshrq_n_u16(value, 7), vdupq_n_u16(0xF8));
+    const uint16x8_t a =
+      vandq_u16(vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(value), 15)), vdupq_n_u16(0xFF00));
+    uint16x8x2_t rgba;
+    rgba.val[0] = vorrq_u16(r, g);
+    rgba.val[1] = vorrq_u16(b, a);
+    vst2q_u16(reinterpret_cast<u16*>(dst_ptr), rgba);
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
     *(dst_ptr++) = VRAM16ToOutput<GPUTexture::Format::RGBA8, u32>(*(src_ptr++));
 }
 
 template<>
 ALWAYS_INLINE void CopyOutRow16<GPUTexture::Format::BGRA8, u32>(const u16* src_ptr, u32* dst_ptr, u32 width)
 {
-  for (u32 col = 0; col < width; col++)
+  u32 col = 0;
+
+#if defined(CPU_ARCH_SSE)
+  const __m128i g_mask = _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0xF800)));
+  const __m128i a_bits = _mm_set1_epi16(static_cast<s16>(static_cast<u16>(0xFF00)));
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+    src_ptr += 8;
+    const __m128i b = _mm_and_si128(_mm_srli_epi16(value, 7), _mm_set1_epi16(0xF8));
+    const __m128i g = _mm_and_si128(_mm_slli_epi16(value, 6), g_mask);
+    const __m128i r = _mm_slli_epi16(_mm_and_si128(value, _mm_set1_epi16(0x1F)), 3);
+    const __m128i bg = _mm_or_si128(b, g);
+    const __m128i ra = _mm_or_si128(r, a_bits);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr + 4), _mm_unpackhi_epi16(bg, ra));
+    dst_ptr += 8;
+  }
+#elif defined(CPU_ARCH_NEON)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint16x8_t value = vld1q_u16(src_ptr);
+    src_ptr += 8;
+    const uint16x8_t b = vandq_u16(vshrq_n_u16(value, 7), vdupq_n_u16(0xF8));
+    const uint16x8_t g = vandq_u16(vshlq_n_u16(value, 6), vdupq_n_u16(0xF800));
+    const uint16x8_t r = vshlq_n_u16(vandq_u16(value, vdupq_n_u16(0x1F)), 3);
+    uint16x8x2_t bgra;
+    bgra.val[0] = vorrq_u16(b, g);
+    bgra.val[1] = vorrq_u16(r, vdupq_n_u16(0xFF00));
+    vst2q_u16(reinterpret_cast<u16*>(dst_ptr), bgra);
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
     *(dst_ptr++) = VRAM16ToOutput<GPUTexture::Format::BGRA8, u32>(*(src_ptr++));
 }
 
+template<GPUTexture::Format out_format, typename out_type>
+static void CopyOutRow24(const u8* src_ptr, out_type* dst_ptr, u32 width);
+
+#if defined(CPU_ARCH_SSE)
+/// Pixels which can be converted in groups of pixels_per_iteration, without the 16-byte loads reading past the row.
+ALWAYS_INLINE static u32 GetVectorWidth24(u32 width, u32 pixels_per_iteration)
+{
+  return (width >= (pixels_per_iteration + 2)) ? Common::AlignDownPow2(width - 2, pixels_per_iteration) : 0;
+}
+
+/// Spreads four packed 24-bit pixels to one per lane, leaving the top byte undefined.
+ALWAYS_INLINE static __m128i Load24BitPixels(const u8* src_ptr)
+{
+  const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_ptr));
+  const __m128i p01 = _mm_unpacklo_epi32(value, _mm_srli_si128(value, 3));
+  const __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(value, 6), _mm_srli_si128(value, 9));
+  return _mm_unpacklo_epi64(p01, p23);
+}
+#endif
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::RGBA8, u32>(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_ARCH_SSE)
+  const u32 vector_width = GetVectorWidth24(width, 4);
+  for (; col < vector_width; col += 4)
+  {
+    const __m128i value = _mm_or_si128(Load24BitPixels(src_ptr), _mm_set1_epi32(static_cast<s32>(0xFF000000u)));
+    src_ptr += 12;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), value);
+    dst_ptr += 4;
+  }
+#elif defined(CPU_ARCH_NEON)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint8x8x3_t rgb = vld3_u8(src_ptr);
+    src_ptr += 24;
+    uint8x8x4_t rgba;
+    rgba.val[0] = rgb.val[0];
+    rgba.val[1] = rgb.val[1];
+    rgba.val[2] = rgb.val[2];
+    rgba.val[3] = vdup_n_u8(0xFF);
+    vst4_u8(reinterpret_cast<u8*>(dst_ptr), rgba);
+    dst_ptr += 8;
+  }
+#endif
+
+  u8* dst_byte_ptr = reinterpret_cast<u8*>(dst_ptr);
+  for (; col < width; col++)
+  {
+    *(dst_byte_ptr++) = *(src_ptr++);
+    *(dst_byte_ptr++) = *(src_ptr++);
+    *(dst_byte_ptr++) = *(src_ptr++);
+    *(dst_byte_ptr++) = 0xFF;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::BGRA8, u32>(const u8* src_ptr, u32* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_ARCH_SSE)
+  const u32 vector_width = GetVectorWidth24(width, 4);
+  for (; col < vector_width; col += 4)
+  {
+    const __m128i value = Load24BitPixels(src_ptr);
+    src_ptr += 12;
+    const __m128i g = _mm_and_si128(value, _mm_set1_epi32(0x0000FF00));
+    const __m128i r = _mm_and_si128(_mm_slli_epi32(value, 16), _mm_set1_epi32(0x00FF0000));
+    const __m128i b = _mm_and_si128(_mm_srli_epi32(value, 16), _mm_set1_epi32(0x000000FF));
+    const __m128i bgra =
+      _mm_or_si128(_mm_or_si128(b, g), _mm_or_si128(r, _mm_set1_epi32(static_cast<s32>(0xFF000000u))));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), bgra);
+    dst_ptr += 4;
+  }
+#elif defined(CPU_ARCH_NEON)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint8x8x3_t rgb = vld3_u8(src_ptr);
+    src_ptr += 24;
+    uint8x8x4_t bgra;
+    bgra.val[0] = rgb.val[2];
+    bgra.val[1] = rgb.val[1];
+    bgra.val[2] = rgb.val[0];
+    bgra.val[3] = vdup_n_u8(0xFF);
+    vst4_u8(reinterpret_cast<u8*>(dst_ptr), bgra);
+    dst_ptr += 8;
+  }
+#endif
+
+  u8* dst_byte_ptr = reinterpret_cast<u8*>(dst_ptr);
+  for (; col < width; col++)
+  {
+    *(dst_byte_ptr++) = src_ptr[2];
+    *(dst_byte_ptr++) = src_ptr[1];
+    *(dst_byte_ptr++) = src_ptr[0];
+    *(dst_byte_ptr++) = 0xFF;
+    src_ptr += 3;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::RGB565, u16>(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_ARCH_SSE)
+  const u32 vector_width = GetVectorWidth24(width, 8);
+  for (; col < vector_width; col += 8)
+  {
+    // packs is signed, so the lanes are sign extended from 16 bits first to keep the top bit.
+    __m128i lo = Load24BitPixels(src_ptr);
+    __m128i hi = Load24BitPixels(src_ptr + 12);
+    src_ptr += 24;
+    lo = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0xF8)), 8),
+                                   _mm_and_si128(_mm_srli_epi32(lo, 5), _mm_set1_epi32(0x7E0))),
+                      _mm_and_si128(_mm_srli_epi32(lo, 19), _mm_set1_epi32(0x1F)));
+    hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0xF8)), 8),
+                                   _mm_and_si128(_mm_srli_epi32(hi, 5), _mm_set1_epi32(0x7E0))),
+                      _mm_and_si128(_mm_srli_epi32(hi, 19), _mm_set1_epi32(0x1F)));
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), _mm_packs_epi32(lo, hi));
+    dst_ptr += 8;
+  }
+#elif defined(CPU_ARCH_NEON)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint8x8x3_t rgb = vld3_u8(src_ptr);
+    src_ptr += 24;
+    const uint16x8_t r = vandq_u16(vshll_n_u8(rgb.val[0], 8), vdupq_n_u16(0xF800));
+    const uint16x8_t g = vandq_u16(vshll_n_u8(rgb.val[1], 3), vdupq_n_u16(0x7E0));
+    const uint16x8_t b = vshrq_n_u16(vmovl_u8(rgb.val[2]), 3);
+    vst1q_u16(dst_ptr, vorrq_u16(vorrq_u16(r, g), b));
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
+  {
+    *(dst_ptr++) = ((static_cast<u16>(src_ptr[0]) >> 3) << 11) | ((static_cast<u16>(src_ptr[1]) >> 2) << 5) |
+                   (static_cast<u16>(src_ptr[2]) >> 3);
+    src_ptr += 3;
+  }
+}
+
+template<>
+ALWAYS_INLINE void CopyOutRow24<GPUTexture::Format::RGBA5551, u16>(const u8* src_ptr, u16* dst_ptr, u32 width)
+{
+  u32 col = 0;
+
+#if defined(CPU_ARCH_SSE)
+  const u32 vector_width = GetVectorWidth24(width, 8);
+  for (; col < vector_width; col += 8)
+  {
+    __m128i lo = Load24BitPixels(src_ptr);
+    __m128i hi = Load24BitPixels(src_ptr + 12);
+    src_ptr += 24;
+    lo = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0xF8)), 7),
+                                   _mm_and_si128(_mm_srli_epi32(lo, 6), _mm_set1_epi32(0x3E0))),
+                      _mm_and_si128(_mm_srli_epi32(lo, 19), _mm_set1_epi32(0x1F)));
+    hi = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0xF8)), 7),
+                                   _mm_and_si128(_mm_srli_epi32(hi, 6), _mm_set1_epi32(0x3E0))),
+                      _mm_and_si128(_mm_srli_epi32(hi, 19), _mm_set1_epi32(0x1F)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst_ptr), _mm_packs_epi32(lo, hi));
+    dst_ptr += 8;
+  }
+#elif defined(CPU_ARCH_NEON)
+  const u32 aligned_width = Common::AlignDownPow2(width, 8);
+  for (; col < aligned_width; col += 8)
+  {
+    const uint8x8x3_t rgb = vld3_u8(src_ptr);
+    src_ptr += 24;
+    const uint16x8_t r = vandq_u16(vshll_n_u8(rgb.val[0], 7), vdupq_n_u16(0x7C00));
+    const uint16x8_t g = vandq_u16(vshll_n_u8(rgb.val[1], 2), vdupq_n_u16(0x3E0));
+    const uint16x8_t b = vshrq_n_u16(vmovl_u8(rgb.val[2]), 3);
+    vst1q_u16(dst_ptr, vorrq_u16(vorrq_u16(r, g), b));
+    dst_ptr += 8;
+  }
+#endif
+
+  for (; col < width; col++)
+  {
+    *(dst_ptr++) = ((static_cast<u16>(src_ptr[0]) >> 3) << 10) | ((static_cast<u16>(src_ptr[1]) >> 3) << 5) |
+                   (static_cast<u16>(src_ptr[2]) >> 3);
+    src_ptr += 3;
+  }
+}
+
+/// Copies count rows from the display buffer to mapped texture memory, starting at first_row.
+ALWAYS_INLINE static void CopyDisplayRows(const u8* src_ptr, u32 src_stride, u8* dst_ptr, u32 dst_stride, u32 first_row,
+                                          u32 count, u32 row_size)
+{
+  src_ptr += first_row * src_stride;
+  dst_ptr += first_row * dst_stride;
+  for (u32 i = 0; i < count; i++)
+  {
+    std::memcpy(dst_ptr, src_ptr, row_size);
+    src_ptr += src_stride;
+    dst_ptr += dst_stride;
+  }
+}
+
 template<GPUTexture::Format display_format>
 void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field, bool interlaced, bool interleaved)
 {
@@ -255,9 +540,19 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
   u32 dst_stride = GPU_MAX_DISPLAY_WIDTH * sizeof(OutputPixelType);
   u8* dst_ptr = m_display_texture_buffer.data() + (interlaced ? (field != 0 ? dst_stride : 0) : 0);
 
-  const bool mapped =
-    (!interlaced && texture->Map(reinterpret_cast<void**>(&dst_ptr), &dst_stride, 0, 0, width, height));
+  // Interlaced output still goes through the buffer, since it holds the other field. Each pair of rows is copied to
+  // the texture as soon as it's complete, rather than uploading the whole buffer in a second pass.
+  u8* map_ptr;
+  u32 map_stride;
+  const bool mapped = texture->Map(reinterpret_cast<void**>(&map_ptr), &map_stride, 0, 0, width, height);
+  if (mapped && !interlaced)
+  {
+    dst_ptr = map_ptr;
+    dst_stride = map_stride;
+  }
 
+  const bool copy_rows = (mapped && interlaced);
+  const u32 row_size = width * sizeof(OutputPixelType);
   const u32 output_stride = dst_stride;
   const u8 interlaced_shift = BoolToUInt8(interlaced);
   const u8 interleaved_shift = BoolToUInt8(interleaved);
@@ -275,6 +570,9 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
       CopyOutRow16<display_format>(src_ptr, reinterpret_cast<OutputPixelType*>(dst_ptr), width);
       src_ptr += src_step;
       dst_ptr += dst_stride;
+
+      if (copy_rows)
+        CopyDisplayRows(m_display_texture_buffer.data(), output_stride, map_ptr, map_stride, row * 2, 2, row_size);
     }
   }
   else
@@ -293,9 +591,15 @@ void GPU_SW::CopyOut15Bit(u32 src_x, u32 src_y, u32 width, u32 height, u32 field
 
       src_y += (1 << interleaved_shift);
       dst_ptr += dst_stride;
+
+      if (copy_rows)
+        CopyDisplayRows(m_display_texture_buffer.data(), output_stride, map_ptr, map_stride, row * 2, 2, row_size);
     }
   }
 
+  if (copy_rows && (height & 1u) != 0)
+    CopyDisplayRows(m_display_texture_buffer.data(), output_stride, map_ptr, map_stride, height - 1, 1, row_size);
+
   if (mapped)
     texture->Unmap();
   else
@@ -340,9 +644,18 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
 
   u32 dst_stride = Common::AlignUpPow2<u32>(width * sizeof(OutputPixelType), 4);
   u8* dst_ptr = m_display_texture_buffer.data() + (interlaced ? (field != 0 ? dst_stride : 0) : 0);
-  const bool mapped =
-    (!interlaced && texture->Map(reinterpret_cast<void**>(&dst_ptr), &dst_stride, 0, 0, width, height));
 
+  u8* map_ptr;
+  u32 map_stride;
+  const bool mapped = texture->Map(reinterpret_cast<void**>(&map_ptr), &map_stride, 0, 0, width, height);
+  if (mapped && !interlaced)
+  {
+    dst_ptr = map_ptr;
+    dst_stride = map_stride;
+  }
+
+  const bool copy_rows = (mapped && interlaced);
+  const u32 row_size = width * sizeof(OutputPixelType);
   const u32 output_stride = dst_stride;
   const u8 interlaced_shift = BoolToUInt8(interlaced);
   const u8 interleaved_shift = BoolToUInt8(interleaved);
@@ -355,56 +668,12 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
     const u32 src_stride = (VRAM_WIDTH << interleaved_shift) * sizeof(u16);
     for (u32 row = 0; row < rows; row++)
     {
-      if constexpr (display_format == GPUTexture::Format::RGBA8)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = *(src_row_ptr++);
-          *(dst_row_ptr++) = 0xFF;
-        }
-      }
-      else if constexpr (display_format == GPUTexture::Format::BGRA8)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u8* dst_row_ptr = reinterpret_cast<u8*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = src_row_ptr[2];
-          *(dst_row_ptr++) = src_row_ptr[1];
-          *(dst_row_ptr++) = src_row_ptr[0];
-          *(dst_row_ptr++) = 0xFF;
-          src_row_ptr += 3;
-        }
-      }
-      else if constexpr (display_format == GPUTexture::Format::RGB565)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u16* dst_row_ptr = reinterpret_cast<u16*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = ((static_cast<u16>(src_row_ptr[0]) >> 3) << 11) |
-                             ((static_cast<u16>(src_row_ptr[1]) >> 2) << 5) | (static_cast<u16>(src_row_ptr[2]) >> 3);
-          src_row_ptr += 3;
-        }
-      }
-      else if constexpr (display_format == GPUTexture::Format::RGBA5551)
-      {
-        const u8* src_row_ptr = src_ptr;
-        u16* dst_row_ptr = reinterpret_cast<u16*>(dst_ptr);
-        for (u32 col = 0; col < width; col++)
-        {
-          *(dst_row_ptr++) = ((static_cast<u16>(src_row_ptr[0]) >> 3) << 10) |
-                             ((static_cast<u16>(src_row_ptr[1]) >> 3) << 5) | (static_cast<u16>(src_row_ptr[2]) >> 3);
-          src_row_ptr += 3;
-        }
-      }
-
+      CopyOutRow24<display_format>(src_ptr, reinterpret_cast<OutputPixelType*>(dst_ptr), width);
       src_ptr += src_stride;
       dst_ptr += dst_stride;
+
+      if (copy_rows)
+        CopyDisplayRows(m_display_texture_buffer.data(), output_stride, map_ptr, map_stride, row * 2, 2, row_size);
     }
   }
   else
@@ -442,9 +711,15 @@ void GPU_SW::CopyOut24Bit(u32 src_x, u32 src_y, u32 skip_x, u32 width, u32 heigh
 
       src_y += (1 << interleaved_shift);
       dst_ptr += dst_stride;
+
+      if (copy_rows)
+        CopyDisplayRows(m_display_texture_buffer.data(), output_stride, map_ptr, map_stride, row * 2, 2, row_size);
     }
   }
 
+  if (copy_rows && (height & 1u) != 0)
+    CopyDisplayRows(m_display_texture_buffer.data(), output_stride, map_ptr, map_stride, height - 1, 1, row_size);
+
   if (mapped)
     texture->Unmap();
   else
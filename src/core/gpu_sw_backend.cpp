@@ -2,12 +2,18 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "gpu_sw_backend.h"
+#include "settings.h"
 #include "system.h"
 
 #include "util/gpu_device.h"
 
+#include "common/intrin.h"
+#include "common/log.h"
+
 #include <algorithm>
 
+Log_SetChannel(GPU_SW_Backend);
+
 GPU_SW_Backend::GPU_SW_Backend() : GPUBackend()
 {
   m_vram.fill(0);
@@ -18,7 +24,22 @@ GPU_SW_Backend::~GPU_SW_Backend() = default;
 
 bool GPU_SW_Backend::Initialize(bool force_thread)
 {
-  return GPUBackend::Initialize(force_thread);
+  if (!GPUBackend::Initialize(force_thread))
+    return false;
+
+  StartWorkerThreads(g_settings.gpu_sw_worker_threads);
+  return true;
+}
+
+void GPU_SW_Backend::UpdateSettings()
+{
+  GPUBackend::UpdateSettings();
+
+  if (m_worker_threads.size() != g_settings.gpu_sw_worker_threads)
+  {
+    StopWorkerThreads();
+    StartWorkerThreads(g_settings.gpu_sw_worker_threads);
+  }
 }
 
 void GPU_SW_Backend::Reset(bool clear_vram)
@@ -29,7 +50,37 @@ void GPU_SW_Backend::Reset(bool clear_vram)
     m_vram.fill(0);
 }
 
+void GPU_SW_Backend::Shutdown()
+{
+  GPUBackend::Shutdown();
+  StopWorkerThreads();
+}
+
 void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
+{
+  if (m_worker_threads.empty())
+    RasterizePolygon(cmd, m_drawing_area);
+  else
+    QueuePrimitive(cmd, GetPolygonWriteRectangle(cmd), GetTextureReadRectangle(cmd));
+}
+
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+{
+  if (m_worker_threads.empty())
+    RasterizeRectangle(cmd, m_drawing_area);
+  else
+    QueuePrimitive(cmd, GetRectangleWriteRectangle(cmd), GetTextureReadRectangle(cmd));
+}
+
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
+{
+  if (m_worker_threads.empty())
+    RasterizeLine(cmd, m_drawing_area);
+  else
+    QueuePrimitive(cmd, GetLineWriteRectangle(cmd), Common::Rectangle<u32>());
+}
+
+void GPU_SW_Backend::RasterizePolygon(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const GPURenderCommand rc{cmd->rc.bits};
   const bool dithering_enable = rc.IsDitheringEnabled() && cmd->draw_mode.dither_enable;
@@ -37,28 +88,28 @@ void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
   const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
     rc.shading_enable, rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable, dithering_enable);
 
-  (this->*DrawFunction)(cmd, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
+  (this->*DrawFunction)(cmd, area, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
   if (rc.quad_polygon)
-    (this->*DrawFunction)(cmd, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
+    (this->*DrawFunction)(cmd, area, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
 }
 
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+void GPU_SW_Backend::RasterizeRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const GPURenderCommand rc{cmd->rc.bits};
 
   const DrawRectangleFunction DrawFunction =
     GetDrawRectangleFunction(rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable);
 
-  (this->*DrawFunction)(cmd);
+  (this->*DrawFunction)(cmd, area);
 }
 
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
+void GPU_SW_Backend::RasterizeLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const DrawLineFunction DrawFunction =
     GetDrawLineFunction(cmd->rc.shading_enable, cmd->rc.transparency_enable, cmd->IsDitheringEnabled());
 
   for (u16 i = 1; i < cmd->num_vertices; i++)
-    (this->*DrawFunction)(cmd, &cmd->vertices[i - 1], &cmd->vertices[i]);
+    (this->*DrawFunction)(cmd, area, &cmd->vertices[i - 1], &cmd->vertices[i]);
 }
 
 constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
@@ -80,6 +131,41 @@ constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
 
 static constexpr GPU_SW_Backend::DitherLUT s_dither_lut = GPU_SW_Backend::ComputeDitherLUT();
 
+ALWAYS_INLINE_RELEASE u16 GPU_SW_Backend::FetchTexel(const GPUBackendDrawCommand* cmd, u8 texcoord_x,
+                                                     u8 texcoord_y) const
+{
+  // Apply texture window
+  texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
+  texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
+
+  switch (cmd->draw_mode.texture_mode)
+  {
+    case GPUTextureMode::Palette4Bit:
+    {
+      const u16 palette_value =
+        GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
+                 (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+      const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
+      return GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
+    }
+
+    case GPUTextureMode::Palette8Bit:
+    {
+      const u16 palette_value =
+        GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
+                 (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+      const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
+      return GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
+    }
+
+    default:
+    {
+      return GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
+                      (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+    }
+  }
+}
+
 template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
 void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r,
                                                       u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y)
@@ -87,44 +173,8 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
   VRAMPixel color;
   if constexpr (texture_enable)
   {
-    // Apply texture window
-    texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
-    texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
-
     VRAMPixel texture_color;
-    switch (cmd->draw_mode.texture_mode)
-    {
-      case GPUTextureMode::Palette4Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
-
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
-
-      case GPUTextureMode::Palette8Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
-
-      default:
-      {
-        texture_color.bits = GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
-                                      (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-      }
-      break;
-    }
-
+    texture_color.bits = FetchTexel(cmd, texcoord_x, texcoord_y);
     if (texture_color.bits == 0)
       return;
 
@@ -224,7 +274,7 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
 }
 
 template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const s32 origin_x = cmd->x;
   const s32 origin_y = cmd->y;
@@ -234,7 +284,7 @@ void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
   for (u32 offset_y = 0; offset_y < cmd->height; offset_y++)
   {
     const s32 y = origin_y + static_cast<s32>(offset_y);
-    if (y < static_cast<s32>(m_drawing_area.top) || y > static_cast<s32>(m_drawing_area.bottom) ||
+    if (y < static_cast<s32>(area.top) || y > static_cast<s32>(area.bottom) ||
         (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u)))
     {
       continue;
@@ -245,7 +295,7 @@ void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
     for (u32 offset_x = 0; offset_x < cmd->width; offset_x++)
     {
       const s32 x = origin_x + static_cast<s32>(offset_x);
-      if (x < static_cast<s32>(m_drawing_area.left) || x > static_cast<s32>(m_drawing_area.right))
+      if (x < static_cast<s32>(area.left) || x > static_cast<s32>(area.right))
         continue;
 
       const u8 texcoord_x = Truncate8(ZeroExtend32(origin_texcoord_x) + offset_x);
@@ -362,10 +412,226 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::AddIDeltas_DY(i_group& ig, const i_de
   }
 }
 
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+
+// Spans are shaded four pixels at a time in 32-bit lanes. 16-bit lanes would fit more pixels, but the subtractive
+// blend needs the extra headroom for its borrow bits, and keeping the same arithmetic as ShadePixel() keeps the output
+// bit-identical.
+static constexpr u32 SPAN_VECTOR_SIZE = 4;
+
+#if defined(CPU_ARCH_SSE)
+
+using SpanVector = __m128i;
+
+static ALWAYS_INLINE SpanVector SpanSet(u32 v)
+{
+  return _mm_set1_epi32(static_cast<s32>(v));
+}
+static ALWAYS_INLINE SpanVector SpanSet(u32 v0, u32 v1, u32 v2, u32 v3)
+{
+  return _mm_setr_epi32(static_cast<s32>(v0), static_cast<s32>(v1), static_cast<s32>(v2), static_cast<s32>(v3));
+}
+static ALWAYS_INLINE SpanVector SpanAdd(SpanVector a, SpanVector b)
+{
+  return _mm_add_epi32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanSub(SpanVector a, SpanVector b)
+{
+  return _mm_sub_epi32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanAnd(SpanVector a, SpanVector b)
+{
+  return _mm_and_si128(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanOr(SpanVector a, SpanVector b)
+{
+  return _mm_or_si128(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanXor(SpanVector a, SpanVector b)
+{
+  return _mm_xor_si128(a, b);
+}
+template<int n>
+static ALWAYS_INLINE SpanVector SpanSrl(SpanVector a)
+{
+  return _mm_srli_epi32(a, n);
+}
+template<int n>
+static ALWAYS_INLINE SpanVector SpanSll(SpanVector a)
+{
+  return _mm_slli_epi32(a, n);
+}
+
+// Both operands and the product must fit in 16 bits, SSE2 has no 32-bit multiply.
+static ALWAYS_INLINE SpanVector SpanMul16(SpanVector a, SpanVector b)
+{
+  return _mm_mullo_epi16(a, b);
+}
+
+// Clamps signed values which fit in 16 bits to 0..255.
+static ALWAYS_INLINE SpanVector SpanClamp8(SpanVector a)
+{
+  return _mm_min_epi16(_mm_max_epi16(a, _mm_setzero_si128()), _mm_set1_epi32(255));
+}
+static ALWAYS_INLINE SpanVector SpanEqualZero(SpanVector a)
+{
+  return _mm_cmpeq_epi32(a, _mm_setzero_si128());
+}
+
+// Returns a where mask is set, otherwise b.
+static ALWAYS_INLINE SpanVector SpanSelect(SpanVector mask, SpanVector a, SpanVector b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+static ALWAYS_INLINE SpanVector SpanLoad(const u32* ptr)
+{
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+static ALWAYS_INLINE void SpanStore(u32* ptr, SpanVector v)
+{
+  _mm_store_si128(reinterpret_cast<__m128i*>(ptr), v);
+}
+static ALWAYS_INLINE SpanVector SpanLoadPixels(const u16* ptr)
+{
+  return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)), _mm_setzero_si128());
+}
+static ALWAYS_INLINE void SpanStorePixels(u16* ptr, SpanVector v)
+{
+  // Sign extend the low halves so the saturating pack truncates instead.
+  v = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(ptr), _mm_packs_epi32(v, v));
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+using SpanVector = uint32x4_t;
+
+static ALWAYS_INLINE SpanVector SpanSet(u32 v)
+{
+  return vdupq_n_u32(v);
+}
+static ALWAYS_INLINE SpanVector SpanSet(u32 v0, u32 v1, u32 v2, u32 v3)
+{
+  alignas(16) const u32 values[SPAN_VECTOR_SIZE] = {v0, v1, v2, v3};
+  return vld1q_u32(values);
+}
+static ALWAYS_INLINE SpanVector SpanAdd(SpanVector a, SpanVector b)
+{
+  return vaddq_u32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanSub(SpanVector a, SpanVector b)
+{
+  return vsubq_u32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanAnd(SpanVector a, SpanVector b)
+{
+  return vandq_u32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanOr(SpanVector a, SpanVector b)
+{
+  return vorrq_u32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanXor(SpanVector a, SpanVector b)
+{
+  return veorq_u32(a, b);
+}
+template<int n>
+static ALWAYS_INLINE SpanVector SpanSrl(SpanVector a)
+{
+  return vshrq_n_u32(a, n);
+}
+template<int n>
+static ALWAYS_INLINE SpanVector SpanSll(SpanVector a)
+{
+  return vshlq_n_u32(a, n);
+}
+static ALWAYS_INLINE SpanVector SpanMul16(SpanVector a, SpanVector b)
+{
+  return vmulq_u32(a, b);
+}
+static ALWAYS_INLINE SpanVector SpanClamp8(SpanVector a)
+{
+  return vreinterpretq_u32_s32(vminq_s32(vmaxq_s32(vreinterpretq_s32_u32(a), vdupq_n_s32(0)), vdupq_n_s32(255)));
+}
+static ALWAYS_INLINE SpanVector SpanEqualZero(SpanVector a)
+{
+  return vceqq_u32(a, vdupq_n_u32(0));
+}
+static ALWAYS_INLINE SpanVector SpanSelect(SpanVector mask, SpanVector a, SpanVector b)
+{
+  return vbslq_u32(mask, a, b);
+}
+static ALWAYS_INLINE SpanVector SpanLoad(const u32* ptr)
+{
+  return vld1q_u32(ptr);
+}
+static ALWAYS_INLINE void SpanStore(u32* ptr, SpanVector v)
+{
+  vst1q_u32(ptr, v);
+}
+static ALWAYS_INLINE SpanVector SpanLoadPixels(const u16* ptr)
+{
+  return vmovl_u16(vld1_u16(ptr));
+}
+static ALWAYS_INLINE void SpanStorePixels(u16* ptr, SpanVector v)
+{
+  vst1_u16(ptr, vmovn_u32(v));
+}
+
+#endif
+
+// Matches s_dither_lut, (value + dither) >> 3 clamped to 0..31.
+static ALWAYS_INLINE SpanVector SpanDither(SpanVector value, SpanVector dither)
+{
+  return SpanSrl<3>(SpanClamp8(SpanAdd(value, dither)));
+}
+
+static ALWAYS_INLINE SpanVector SpanBlend(GPUTransparencyMode mode, SpanVector bg_bits, SpanVector fg_bits)
+{
+  // Same as the scalar version in ShadePixel().
+  switch (mode)
+  {
+    case GPUTransparencyMode::HalfBackgroundPlusHalfForeground:
+    {
+      bg_bits = SpanOr(bg_bits, SpanSet(0x8000u));
+      return SpanSrl<1>(SpanSub(SpanAdd(fg_bits, bg_bits), SpanAnd(SpanXor(fg_bits, bg_bits), SpanSet(0x0421u))));
+    }
+
+    case GPUTransparencyMode::BackgroundPlusForeground:
+    case GPUTransparencyMode::BackgroundPlusQuarterForeground:
+    {
+      bg_bits = SpanAnd(bg_bits, SpanSet(~0x8000u));
+      if (mode == GPUTransparencyMode::BackgroundPlusQuarterForeground)
+        fg_bits = SpanOr(SpanAnd(SpanSrl<2>(fg_bits), SpanSet(0x1CE7u)), SpanSet(0x8000u));
+
+      const SpanVector sum = SpanAdd(fg_bits, bg_bits);
+      const SpanVector carry =
+        SpanAnd(SpanSub(sum, SpanAnd(SpanXor(fg_bits, bg_bits), SpanSet(0x8421u))), SpanSet(0x8420u));
+      return SpanOr(SpanSub(sum, carry), SpanSub(carry, SpanSrl<5>(carry)));
+    }
+
+    case GPUTransparencyMode::BackgroundMinusForeground:
+    {
+      bg_bits = SpanOr(bg_bits, SpanSet(0x8000u));
+      fg_bits = SpanAnd(fg_bits, SpanSet(~0x8000u));
+
+      const SpanVector diff = SpanAdd(SpanSub(bg_bits, fg_bits), SpanSet(0x108420u));
+      const SpanVector borrow =
+        SpanAnd(SpanSub(diff, SpanAnd(SpanXor(bg_bits, fg_bits), SpanSet(0x108420u))), SpanSet(0x108420u));
+      return SpanAnd(SpanSub(diff, borrow), SpanSub(borrow, SpanSrl<5>(borrow)));
+    }
+
+    default:
+      return fg_bits;
+  }
+}
+
+#endif
+
 template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
          bool dithering_enable>
-void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                              const i_deltas& idl)
+void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area, s32 y,
+                              s32 x_start, s32 x_bound, i_group ig, const i_deltas& idl)
 {
   if (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u))
     return;
@@ -374,16 +640,16 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   s32 w = x_bound - x_start;
   s32 x = TruncateGPUVertexPosition(x_start);
 
-  if (x < static_cast<s32>(m_drawing_area.left))
+  if (x < static_cast<s32>(area.left))
   {
-    s32 delta = static_cast<s32>(m_drawing_area.left) - x;
+    s32 delta = static_cast<s32>(area.left) - x;
     x_ig_adjust += delta;
     x += delta;
     w -= delta;
   }
 
-  if ((x + w) > (static_cast<s32>(m_drawing_area.right) + 1))
-    w = static_cast<s32>(m_drawing_area.right) + 1 - x;
+  if ((x + w) > (static_cast<s32>(area.right) + 1))
+    w = static_cast<s32>(area.right) + 1 - x;
 
   if (w <= 0)
     return;
@@ -391,6 +657,115 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   AddIDeltas_DX<shading_enable, texture_enable>(ig, idl, x_ig_adjust);
   AddIDeltas_DY<shading_enable, texture_enable>(ig, idl, y);
 
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+  // Texels are fetched for a whole vector before any pixel is written, so spans which can sample themselves have to
+  // take the per-pixel path.
+  if (static_cast<u32>(w) >= SPAN_VECTOR_SIZE &&
+      (!texture_enable || !GetTextureReadRectangle(cmd).Intersects(Common::Rectangle<u32>(
+                            static_cast<u32>(x), static_cast<u32>(y), static_cast<u32>(x + w), static_cast<u32>(y + 1)))))
+  {
+    constexpr u32 shift = COORD_FBS + COORD_POST_PADDING;
+    const u32 dr = shading_enable ? idl.dr_dx : 0;
+    const u32 dg = shading_enable ? idl.dg_dx : 0;
+    const u32 db = shading_enable ? idl.db_dx : 0;
+    const u32 du = texture_enable ? idl.du_dx : 0;
+    const u32 dv = texture_enable ? idl.dv_dx : 0;
+    SpanVector rv = SpanSet(ig.r, ig.r + dr, ig.r + dr * 2, ig.r + dr * 3);
+    SpanVector gv = SpanSet(ig.g, ig.g + dg, ig.g + dg * 2, ig.g + dg * 3);
+    SpanVector bv = SpanSet(ig.b, ig.b + db, ig.b + db * 2, ig.b + db * 3);
+    SpanVector uv = SpanSet(ig.u, ig.u + du, ig.u + du * 2, ig.u + du * 3);
+    SpanVector vv = SpanSet(ig.v, ig.v + dv, ig.v + dv * 2, ig.v + dv * 3);
+    const SpanVector r_step = SpanSet(dr * SPAN_VECTOR_SIZE);
+    const SpanVector g_step = SpanSet(dg * SPAN_VECTOR_SIZE);
+    const SpanVector b_step = SpanSet(db * SPAN_VECTOR_SIZE);
+    const SpanVector u_step = SpanSet(du * SPAN_VECTOR_SIZE);
+    const SpanVector v_step = SpanSet(dv * SPAN_VECTOR_SIZE);
+
+    // The dither pattern repeats every four pixels, so the same offsets apply to every vector in the span.
+    const s32* dither_row = DITHER_MATRIX[dithering_enable ? (y & 3) : 2];
+    const SpanVector dither =
+      dithering_enable ? SpanSet(dither_row[x & 3], dither_row[(x + 1) & 3], dither_row[(x + 2) & 3],
+                                 dither_row[(x + 3) & 3]) :
+                         SpanSet(static_cast<u32>(dither_row[3]));
+
+    const SpanVector byte_mask = SpanSet(0xFFu);
+    const SpanVector channel_mask = SpanSet(0x1Fu);
+    const SpanVector mask_and = SpanSet(cmd->params.GetMaskAND());
+    const SpanVector mask_or = SpanSet(cmd->params.GetMaskOR());
+    u16* row_ptr = GetPixelPtr(0, static_cast<u32>(y));
+    const s32 vector_pixels = w & ~static_cast<s32>(SPAN_VECTOR_SIZE - 1);
+
+    for (s32 i = 0; i < vector_pixels; i += SPAN_VECTOR_SIZE)
+    {
+      const SpanVector r = SpanAnd(SpanSrl<shift>(rv), byte_mask);
+      const SpanVector g = SpanAnd(SpanSrl<shift>(gv), byte_mask);
+      const SpanVector b = SpanAnd(SpanSrl<shift>(bv), byte_mask);
+      const SpanVector bg_color = SpanLoadPixels(&row_ptr[x + i]);
+
+      SpanVector color;
+      SpanVector texture_color;
+      if constexpr (texture_enable)
+      {
+        alignas(16) u32 texcoord_x[SPAN_VECTOR_SIZE];
+        alignas(16) u32 texcoord_y[SPAN_VECTOR_SIZE];
+        alignas(16) u32 texels[SPAN_VECTOR_SIZE];
+        SpanStore(texcoord_x, SpanAnd(SpanSrl<shift>(uv), byte_mask));
+        SpanStore(texcoord_y, SpanAnd(SpanSrl<shift>(vv), byte_mask));
+        for (u32 j = 0; j < SPAN_VECTOR_SIZE; j++)
+          texels[j] = FetchTexel(cmd, Truncate8(texcoord_x[j]), Truncate8(texcoord_y[j]));
+        texture_color = SpanLoad(texels);
+
+        if constexpr (raw_texture_enable)
+        {
+          color = texture_color;
+        }
+        else
+        {
+          const SpanVector tr = SpanAnd(texture_color, channel_mask);
+          const SpanVector tg = SpanAnd(SpanSrl<5>(texture_color), channel_mask);
+          const SpanVector tb = SpanAnd(SpanSrl<10>(texture_color), channel_mask);
+          color = SpanOr(SpanOr(SpanDither(SpanSrl<4>(SpanMul16(tr, r)), dither),
+                                SpanSll<5>(SpanDither(SpanSrl<4>(SpanMul16(tg, g)), dither))),
+                         SpanOr(SpanSll<10>(SpanDither(SpanSrl<4>(SpanMul16(tb, b)), dither)),
+                                SpanAnd(texture_color, SpanSet(0x8000u))));
+        }
+      }
+      else
+      {
+        color = SpanOr(SpanOr(SpanDither(r, dither), SpanSll<5>(SpanDither(g, dither))),
+                       SpanOr(SpanSll<10>(SpanDither(b, dither)), SpanSet(transparency_enable ? 0x8000u : 0u)));
+      }
+
+      if constexpr (transparency_enable)
+      {
+        const SpanVector blended = SpanBlend(cmd->draw_mode.transparency_mode, bg_color, color);
+        if constexpr (texture_enable)
+          color = SpanSelect(SpanEqualZero(SpanAnd(color, SpanSet(0x8000u))), color, blended);
+        else
+          color = SpanAnd(blended, SpanSet(~0x8000u));
+      }
+
+      // Leave the background alone for masked pixels and fully transparent texels.
+      SpanVector result = SpanSelect(SpanEqualZero(SpanAnd(bg_color, mask_and)), SpanOr(color, mask_or), bg_color);
+      if constexpr (texture_enable)
+        result = SpanSelect(SpanEqualZero(texture_color), bg_color, result);
+      SpanStorePixels(&row_ptr[x + i], result);
+
+      rv = SpanAdd(rv, r_step);
+      gv = SpanAdd(gv, g_step);
+      bv = SpanAdd(bv, b_step);
+      uv = SpanAdd(uv, u_step);
+      vv = SpanAdd(vv, v_step);
+    }
+
+    AddIDeltas_DX<shading_enable, texture_enable>(ig, idl, static_cast<u32>(vector_pixels));
+    x += vector_pixels;
+    w -= vector_pixels;
+    if (w == 0)
+      return;
+  }
+#endif
+
   do
   {
     const u32 r = ig.r >> (COORD_FBS + COORD_POST_PADDING);
@@ -410,7 +785,7 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
 
 template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
          bool dithering_enable>
-void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
+void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area,
                                   const GPUBackendDrawPolygonCommand::Vertex* v0,
                                   const GPUBackendDrawPolygonCommand::Vertex* v1,
                                   const GPUBackendDrawPolygonCommand::Vertex* v2)
@@ -568,14 +943,21 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
 
         s32 y = TruncateGPUVertexPosition(yi);
 
-        if (y < static_cast<s32>(m_drawing_area.top))
+        if (y < static_cast<s32>(area.top))
           break;
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(area.bottom))
+        {
+          // Skip straight to the bottom of the area, the coordinates can't wrap before then.
+          const s32 skip = std::min(y - static_cast<s32>(area.bottom) - 1, yi - yb);
+          yi -= skip;
+          lc -= ls * static_cast<u64>(skip);
+          rc -= rs * static_cast<u64>(skip);
           continue;
+        }
 
         DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-          cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+          cmd, area, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
       }
     }
     else
@@ -584,16 +966,22 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
       {
         s32 y = TruncateGPUVertexPosition(yi);
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(area.bottom))
           break;
 
-        if (y >= static_cast<s32>(m_drawing_area.top))
+        if (y < static_cast<s32>(area.top))
         {
-
-          DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-            cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+          // Skip straight to the top of the area, the coordinates can't wrap before then.
+          const s32 skip = std::min(static_cast<s32>(area.top) - y, yb - yi);
+          yi += skip;
+          lc += ls * static_cast<u64>(skip);
+          rc += rs * static_cast<u64>(skip);
+          continue;
         }
 
+        DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+          cmd, area, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+
         yi++;
         lc += ls;
         rc += rs;
@@ -636,8 +1024,8 @@ static ALWAYS_INLINE_RELEASE s64 LineDivide(s64 delta, s32 dk)
 }
 
 template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                              const GPUBackendDrawLineCommand::Vertex* p1)
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area,
+                              const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1)
 {
   const s32 i_dx = std::abs(p1->x - p0->x);
   const s32 i_dy = std::abs(p1->y - p0->y);
@@ -697,8 +1085,8 @@ void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBac
     const s32 y = (cur_point.y >> Line_XY_FractBits) & 2047;
 
     if ((!cmd->params.interlaced_rendering || cmd->params.active_line_lsb != (Truncate8(static_cast<u32>(y)) & 1u)) &&
-        x >= static_cast<s32>(m_drawing_area.left) && x <= static_cast<s32>(m_drawing_area.right) &&
-        y >= static_cast<s32>(m_drawing_area.top) && y <= static_cast<s32>(m_drawing_area.bottom))
+        x >= static_cast<s32>(area.left) && x <= static_cast<s32>(area.right) && y >= static_cast<s32>(area.top) &&
+        y <= static_cast<s32>(area.bottom))
     {
       const u8 r = shading_enable ? static_cast<u8>(cur_point.r >> Line_RGB_FractBits) : p0->r;
       const u8 g = shading_enable ? static_cast<u8>(cur_point.g >> Line_RGB_FractBits) : p0->g;
@@ -874,10 +1262,308 @@ void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wi
   }
 }
 
-void GPU_SW_Backend::FlushRender() {}
+void GPU_SW_Backend::FlushRender()
+{
+  if (m_batch_primitives.empty())
+    return;
+
+  // Not worth waking the workers if there's only a single tile to draw.
+  m_batch_next_tile.store(0, std::memory_order_relaxed);
+  if (m_batch_num_tiles > 1)
+  {
+    {
+      std::unique_lock lock(m_worker_mutex);
+      m_workers_busy = static_cast<u32>(m_worker_threads.size());
+      m_worker_generation++;
+    }
+    m_worker_wake_cv.notify_all();
+
+    RasterizeBatchedTiles();
+
+    std::unique_lock lock(m_worker_mutex);
+    m_worker_done_cv.wait(lock, [this]() { return m_workers_busy == 0; });
+  }
+  else
+  {
+    RasterizeBatchedTiles();
+  }
+
+  m_batch_commands.clear();
+  m_batch_primitives.clear();
+  m_batch_write_rect.SetInvalid();
+  m_batch_read_rect.SetInvalid();
+  m_batch_num_tiles = 0;
+  m_batch_tile_mask = 0;
+}
 
 void GPU_SW_Backend::DrawingAreaChanged() {}
 
+void GPU_SW_Backend::StartWorkerThreads(u32 count)
+{
+  if (count == 0)
+    return;
+
+  m_batch_commands.reserve(MAX_BATCH_COMMAND_SIZE);
+  m_batch_write_rect.SetInvalid();
+  m_batch_read_rect.SetInvalid();
+
+  // Workers start from generation zero, so they can't miss a batch which is queued before they're running.
+  m_workers_shutdown = false;
+  m_worker_generation = 0;
+  m_worker_threads.reserve(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    Threading::Thread& thread = m_worker_threads.emplace_back();
+    thread.Start([this]() { WorkerThreadEntryPoint(); });
+  }
+
+  Log_InfoPrintf("Started %u software renderer worker threads.", count);
+}
+
+void GPU_SW_Backend::StopWorkerThreads()
+{
+  if (m_worker_threads.empty())
+    return;
+
+  FlushRender();
+
+  {
+    std::unique_lock lock(m_worker_mutex);
+    m_workers_shutdown = true;
+  }
+  m_worker_wake_cv.notify_all();
+
+  for (Threading::Thread& thread : m_worker_threads)
+    thread.Join();
+
+  m_worker_threads.clear();
+  m_batch_commands = {};
+  m_batch_primitives = {};
+  Log_InfoPrint("Stopped software renderer worker threads.");
+}
+
+void GPU_SW_Backend::WorkerThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("GPU Worker");
+  System::ApplyThreadCorePlacement(true);
+
+  std::unique_lock lock(m_worker_mutex);
+  u32 last_generation = 0;
+  for (;;)
+  {
+    m_worker_wake_cv.wait(lock,
+                          [this, last_generation]() { return m_workers_shutdown || m_worker_generation != last_generation; });
+    if (m_workers_shutdown)
+      break;
+
+    last_generation = m_worker_generation;
+    lock.unlock();
+    RasterizeBatchedTiles();
+    lock.lock();
+
+    DebugAssert(m_workers_busy > 0);
+    if ((--m_workers_busy) == 0)
+      m_worker_done_cv.notify_one();
+  }
+}
+
+void GPU_SW_Backend::QueuePrimitive(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& write_rect,
+                                    const Common::Rectangle<u32>& read_rect)
+{
+  if (!write_rect.HasExtents())
+    return;
+
+  const bool reads_vram = read_rect.HasExtents();
+  if (reads_vram && read_rect.Intersects(write_rect))
+  {
+    // Primitive samples from the area it's drawing to, so the top-to-bottom order has to be preserved.
+    FlushRender();
+    RasterizePrimitive(cmd, m_drawing_area);
+    return;
+  }
+
+  if ((reads_vram && m_batch_write_rect.HasExtents() && read_rect.Intersects(m_batch_write_rect)) ||
+      (m_batch_read_rect.HasExtents() && write_rect.Intersects(m_batch_read_rect)) ||
+      (m_batch_commands.size() + cmd->size) > MAX_BATCH_COMMAND_SIZE)
+  {
+    FlushRender();
+  }
+
+  const u32 first_tile = write_rect.top / TILE_HEIGHT;
+  const u32 last_tile = (write_rect.bottom - 1) / TILE_HEIGHT;
+  u32 tile_mask = 0;
+  for (u32 tile = first_tile; tile <= last_tile; tile++)
+  {
+    const u32 bit = 1u << tile;
+    tile_mask |= bit;
+    if (!(m_batch_tile_mask & bit))
+    {
+      m_batch_tile_mask |= bit;
+      m_batch_tiles[m_batch_num_tiles++] = static_cast<u8>(tile);
+    }
+  }
+
+  const u32 offset = static_cast<u32>(m_batch_commands.size());
+  m_batch_commands.resize(offset + cmd->size);
+  std::memcpy(&m_batch_commands[offset], cmd, cmd->size);
+  m_batch_primitives.push_back(BatchedPrimitive{offset, tile_mask});
+
+  m_batch_write_rect.Include(write_rect);
+  if (reads_vram)
+    m_batch_read_rect.Include(read_rect);
+}
+
+void GPU_SW_Backend::RasterizePrimitive(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& area)
+{
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::DrawPolygon:
+      RasterizePolygon(static_cast<const GPUBackendDrawPolygonCommand*>(cmd), area);
+      break;
+
+    case GPUBackendCommandType::DrawRectangle:
+      RasterizeRectangle(static_cast<const GPUBackendDrawRectangleCommand*>(cmd), area);
+      break;
+
+    case GPUBackendCommandType::DrawLine:
+      RasterizeLine(static_cast<const GPUBackendDrawLineCommand*>(cmd), area);
+      break;
+
+    default:
+      UnreachableCode();
+      break;
+  }
+}
+
+void GPU_SW_Backend::RasterizeBatchedTiles()
+{
+  u32 index;
+  while ((index = m_batch_next_tile.fetch_add(1, std::memory_order_relaxed)) < m_batch_num_tiles)
+  {
+    const u32 tile = m_batch_tiles[index];
+    const u32 tile_bit = 1u << tile;
+    const u32 tile_top = tile * TILE_HEIGHT;
+    const u32 tile_bottom = tile_top + TILE_HEIGHT - 1;
+
+    Common::Rectangle<u32> area = m_drawing_area;
+    area.top = std::max(area.top, tile_top);
+    area.bottom = std::min(area.bottom, tile_bottom);
+    if (area.top > area.bottom)
+      continue;
+
+    for (const BatchedPrimitive& prim : m_batch_primitives)
+    {
+      if (prim.tile_mask & tile_bit)
+        RasterizePrimitive(reinterpret_cast<const GPUBackendDrawCommand*>(&m_batch_commands[prim.offset]), area);
+    }
+  }
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetTextureReadRectangle(const GPUBackendDrawCommand* cmd)
+{
+  if (!cmd->rc.texture_enable)
+    return Common::Rectangle<u32>();
+
+  // Reads wrap around the edge of VRAM, so just assume the whole width if that happens.
+  Common::Rectangle<u32> rect = cmd->draw_mode.GetTexturePageRectangle();
+  if (rect.right > VRAM_WIDTH)
+  {
+    rect.left = 0;
+    rect.right = VRAM_WIDTH;
+  }
+
+  if (cmd->draw_mode.IsUsingPalette())
+  {
+    const u32 palette_width = (cmd->draw_mode.texture_mode == GPUTextureMode::Palette4Bit) ? 16 : 256;
+    const u32 palette_x = cmd->palette.GetXBase();
+    const u32 palette_y = cmd->palette.GetYBase();
+    if ((palette_x + palette_width) > VRAM_WIDTH)
+      rect.Include(0, VRAM_WIDTH, palette_y, palette_y + 1);
+    else
+      rect.Include(palette_x, palette_x + palette_width, palette_y, palette_y + 1);
+  }
+
+  return rect;
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetPolygonWriteRectangle(const GPUBackendDrawPolygonCommand* cmd) const
+{
+  if (!m_drawing_area.Valid())
+    return Common::Rectangle<u32>();
+
+  s32 min_x = cmd->vertices[0].x, max_x = cmd->vertices[0].x;
+  s32 min_y = cmd->vertices[0].y, max_y = cmd->vertices[0].y;
+  for (u32 i = 1; i < cmd->num_vertices; i++)
+  {
+    min_x = std::min(min_x, cmd->vertices[i].x);
+    max_x = std::max(max_x, cmd->vertices[i].x);
+    min_y = std::min(min_y, cmd->vertices[i].y);
+    max_y = std::max(max_y, cmd->vertices[i].y);
+  }
+
+  // Pad by a pixel for edge rounding. Coordinates outside the 11-bit range wrap, so fall back to the whole area.
+  Common::Rectangle<u32> rect(m_drawing_area.left, m_drawing_area.top, m_drawing_area.right + 1,
+                              m_drawing_area.bottom + 1);
+  if ((min_x - 1) >= -1024 && (max_x + 1) <= 1023)
+  {
+    rect.left = static_cast<u32>(std::clamp<s32>(min_x - 1, rect.left, rect.right));
+    rect.right = static_cast<u32>(std::clamp<s32>(max_x + 2, rect.left, rect.right));
+  }
+  if ((min_y - 1) >= -1024 && (max_y + 1) <= 1023)
+  {
+    rect.top = static_cast<u32>(std::clamp<s32>(min_y - 1, rect.top, rect.bottom));
+    rect.bottom = static_cast<u32>(std::clamp<s32>(max_y + 2, rect.top, rect.bottom));
+  }
+
+  return rect;
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetRectangleWriteRectangle(const GPUBackendDrawRectangleCommand* cmd) const
+{
+  if (!m_drawing_area.Valid())
+    return Common::Rectangle<u32>();
+
+  const s32 area_right = static_cast<s32>(m_drawing_area.right) + 1;
+  const s32 area_bottom = static_cast<s32>(m_drawing_area.bottom) + 1;
+  const s32 left = std::clamp<s32>(cmd->x, m_drawing_area.left, area_right);
+  const s32 top = std::clamp<s32>(cmd->y, m_drawing_area.top, area_bottom);
+  const s32 right = std::clamp<s32>(cmd->x + cmd->width, left, area_right);
+  const s32 bottom = std::clamp<s32>(cmd->y + cmd->height, top, area_bottom);
+  return Common::Rectangle<u32>(left, top, right, bottom);
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetLineWriteRectangle(const GPUBackendDrawLineCommand* cmd) const
+{
+  if (!m_drawing_area.Valid())
+    return Common::Rectangle<u32>();
+
+  s32 min_x = cmd->vertices[0].x, max_x = cmd->vertices[0].x;
+  s32 min_y = cmd->vertices[0].y, max_y = cmd->vertices[0].y;
+  for (u32 i = 1; i < cmd->num_vertices; i++)
+  {
+    min_x = std::min(min_x, cmd->vertices[i].x);
+    max_x = std::max(max_x, cmd->vertices[i].x);
+    min_y = std::min(min_y, cmd->vertices[i].y);
+    max_y = std::max(max_y, cmd->vertices[i].y);
+  }
+
+  // Line coordinates are masked to 11 bits, negative positions land outside the drawing area.
+  Common::Rectangle<u32> rect(m_drawing_area.left, m_drawing_area.top, m_drawing_area.right + 1,
+                              m_drawing_area.bottom + 1);
+  if ((min_x - 1) >= 0 && (max_x + 1) <= 1023)
+  {
+    rect.left = static_cast<u32>(std::clamp<s32>(min_x - 1, rect.left, rect.right));
+    rect.right = static_cast<u32>(std::clamp<s32>(max_x + 2, rect.left, rect.right));
+  }
+  if ((min_y - 1) >= 0 && (max_y + 1) <= 1023)
+  {
+    rect.top = static_cast<u32>(std::clamp<s32>(min_y - 1, rect.top, rect.bottom));
+    rect.bottom = static_cast<u32>(std::clamp<s32>(max_y + 2, rect.top, rect.bottom));
+  }
+
+  return rect;
+}
+
 GPU_SW_Backend::DrawLineFunction GPU_SW_Backend::GetDrawLineFunction(bool shading_enable, bool transparency_enable,
                                                                      bool dithering_enable)
 {
@@ -4,7 +4,10 @@
 #pragma once
 #include "gpu_backend.h"
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 class GPU_SW_Backend final : public GPUBackend
@@ -14,7 +17,9 @@ public:
   ~GPU_SW_Backend() override;
 
   bool Initialize(bool force_thread) override;
+  void UpdateSettings() override;
   void Reset(bool clear_vram) override;
+  void Shutdown() override;
 
   ALWAYS_INLINE_RELEASE u16 GetPixel(const u32 x, const u32 y) const { return m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE const u16* GetPixelPtr(const u32 x, const u32 y) const { return &m_vram[VRAM_WIDTH * y + x]; }
@@ -98,17 +103,24 @@ protected:
   void FlushRender() override;
   void DrawingAreaChanged() override;
 
+  void RasterizePolygon(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area);
+  void RasterizeRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area);
+  void RasterizeLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area);
+
   //////////////////////////////////////////////////////////////////////////
   // Rasterization
   //////////////////////////////////////////////////////////////////////////
+  u16 FetchTexel(const GPUBackendDrawCommand* cmd, u8 texcoord_x, u8 texcoord_y) const;
+
   template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
   void ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r, u8 color_g, u8 color_b, u8 texcoord_x,
                   u8 texcoord_y);
 
   template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd);
+  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area);
 
-  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd);
+  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd,
+                                                         const Common::Rectangle<u32>& area);
   DrawRectangleFunction GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable,
                                                  bool transparency_enable);
 
@@ -142,15 +154,17 @@ protected:
 
   template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
            bool dithering_enable>
-  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                const i_deltas& idl);
+  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area, s32 y, s32 x_start,
+                s32 x_bound, i_group ig, const i_deltas& idl);
 
   template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
            bool dithering_enable>
-  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const GPUBackendDrawPolygonCommand::Vertex* v0,
-                    const GPUBackendDrawPolygonCommand::Vertex* v1, const GPUBackendDrawPolygonCommand::Vertex* v2);
+  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area,
+                    const GPUBackendDrawPolygonCommand::Vertex* v0, const GPUBackendDrawPolygonCommand::Vertex* v1,
+                    const GPUBackendDrawPolygonCommand::Vertex* v2);
 
   using DrawTriangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawPolygonCommand* cmd,
+                                                        const Common::Rectangle<u32>& area,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v0,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v1,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v2);
@@ -158,13 +172,65 @@ protected:
                                                bool transparency_enable, bool dithering_enable);
 
   template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-  void DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                const GPUBackendDrawLineCommand::Vertex* p1);
+  void DrawLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area,
+                const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1);
 
   using DrawLineFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawLineCommand* cmd,
+                                                    const Common::Rectangle<u32>& area,
                                                     const GPUBackendDrawLineCommand::Vertex* p0,
                                                     const GPUBackendDrawLineCommand::Vertex* p1);
   DrawLineFunction GetDrawLineFunction(bool shading_enable, bool transparency_enable, bool dithering_enable);
 
+  //////////////////////////////////////////////////////////////////////////
+  // Tile-parallel rasterization
+  //////////////////////////////////////////////////////////////////////////
+  // VRAM is split into horizontal bands of TILE_HEIGHT lines. Each primitive is binned into the tiles it touches, and
+  // each tile is rasterized by a single worker in submission order, so mask bits and blending match the serial path.
+  // Primitives which read from VRAM that another queued primitive writes to (or vice versa) flush the batch first.
+  enum : u32
+  {
+    TILE_HEIGHT = 16,
+    NUM_TILES = VRAM_HEIGHT / TILE_HEIGHT,
+    MAX_BATCH_COMMAND_SIZE = 1024 * 1024,
+  };
+  static_assert(NUM_TILES <= 32, "Tile mask fits in 32 bits");
+
+  struct BatchedPrimitive
+  {
+    u32 offset;
+    u32 tile_mask;
+  };
+
+  void StartWorkerThreads(u32 count);
+  void StopWorkerThreads();
+  void WorkerThreadEntryPoint();
+
+  void QueuePrimitive(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& write_rect,
+                      const Common::Rectangle<u32>& read_rect);
+  void RasterizePrimitive(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& area);
+  void RasterizeBatchedTiles();
+
+  static Common::Rectangle<u32> GetTextureReadRectangle(const GPUBackendDrawCommand* cmd);
+  Common::Rectangle<u32> GetPolygonWriteRectangle(const GPUBackendDrawPolygonCommand* cmd) const;
+  Common::Rectangle<u32> GetRectangleWriteRectangle(const GPUBackendDrawRectangleCommand* cmd) const;
+  Common::Rectangle<u32> GetLineWriteRectangle(const GPUBackendDrawLineCommand* cmd) const;
+
   std::array<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram;
+
+  std::vector<Threading::Thread> m_worker_threads;
+  std::mutex m_worker_mutex;
+  std::condition_variable m_worker_wake_cv;
+  std::condition_variable m_worker_done_cv;
+  u32 m_worker_generation = 0;
+  u32 m_workers_busy = 0;
+  bool m_workers_shutdown = false;
+
+  std::vector<u8> m_batch_commands;
+  std::vector<BatchedPrimitive> m_batch_primitives;
+  Common::Rectangle<u32> m_batch_write_rect;
+  Common::Rectangle<u32> m_batch_read_rect;
+  std::array<u8, NUM_TILES> m_batch_tiles{};
+  u32 m_batch_num_tiles = 0;
+  u32 m_batch_tile_mask = 0;
+  std::atomic<u32> m_batch_next_tile{0};
 };
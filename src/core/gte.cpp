@@ -14,6 +14,7 @@
 
 #include "common/assert.h"
 #include "common/bitutils.h"
+#include "common/intrin.h"
 
 #include <algorithm>
 #include <array>
@@ -30,6 +31,9 @@ static constexpr s32 IR0_MAX_VALUE = 0x1000;
 static constexpr s32 IR123_MIN_VALUE = -(INT64_C(1) << 15);
 static constexpr s32 IR123_MAX_VALUE = (INT64_C(1) << 15) - 1;
 
+// Largest translation where T*1000h plus three 16x16 products can't leave the 44-bit MAC range at any step.
+static constexpr s32 MAX_NON_OVERFLOWING_TRANSLATION = static_cast<s32>((INT64_C(1) << 31) - (INT64_C(1) << 20));
+
 static DisplayAspectRatio s_aspect_ratio = DisplayAspectRatio::R4_3;
 static u32 s_custom_aspect_ratio_numerator;
 static u32 s_custom_aspect_ratio_denominator;
@@ -475,8 +479,105 @@ ALWAYS_INLINE static u32 UNRDivide(u32 lhs, u32 rhs)
   return std::min<u32>(0x1FFFF, result);
 }
 
+ALWAYS_INLINE static bool IsNonOverflowingTranslation(const s32 T[3])
+{
+  const auto in_range = [](s32 value) {
+    return (value >= -MAX_NON_OVERFLOWING_TRANSLATION && value <= MAX_NON_OVERFLOWING_TRANSLATION);
+  };
+  return (in_range(T[0]) && in_range(T[1]) && in_range(T[2]));
+}
+
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+
+// [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (T*1000h + M*V) SAR shift, all three rows at once. Only valid when the MAC
+// can't overflow, i.e. IsNonOverflowingTranslation(T). Each product is split into its upper and lower 12 bits, so
+// the shifted sum is exact in 32-bit lanes, even though the full sum needs 44 bits.
+ALWAYS_INLINE_RELEASE static void MulMatVecSIMD(const s16* M_, const s32 T[3], const s16 Vx, const s16 Vy,
+                                                const s16 Vz, u8 shift, bool lm)
+{
+#define M(i, j) M_[((i)*3) + (j)]
+  alignas(16) s32 mac[4];
+  alignas(16) s32 ir[4];
+
+#if defined(CPU_ARCH_SSE)
+  // madd of the sign-extended matrix element and the zero-extended vector element gives the exact product
+  const __m128i p0 = _mm_madd_epi16(_mm_setr_epi32(M(0, 0), M(1, 0), M(2, 0), 0), _mm_set1_epi32(static_cast<u16>(Vx)));
+  const __m128i p1 = _mm_madd_epi16(_mm_setr_epi32(M(0, 1), M(1, 1), M(2, 1), 0), _mm_set1_epi32(static_cast<u16>(Vy)));
+  const __m128i p2 = _mm_madd_epi16(_mm_setr_epi32(M(0, 2), M(1, 2), M(2, 2), 0), _mm_set1_epi32(static_cast<u16>(Vz)));
+  const __m128i t = _mm_setr_epi32(T[0], T[1], T[2], 0);
+
+  __m128i sum;
+  if (shift == 0)
+  {
+    sum = _mm_add_epi32(_mm_add_epi32(_mm_add_epi32(p0, p1), p2), _mm_slli_epi32(t, 12));
+  }
+  else
+  {
+    const __m128i low_mask = _mm_set1_epi32(0xFFF);
+    const __m128i high = _mm_add_epi32(_mm_add_epi32(_mm_srai_epi32(p0, 12), _mm_srai_epi32(p1, 12)),
+                                       _mm_srai_epi32(p2, 12));
+    const __m128i low = _mm_add_epi32(_mm_add_epi32(_mm_and_si128(p0, low_mask), _mm_and_si128(p1, low_mask)),
+                                      _mm_and_si128(p2, low_mask));
+    sum = _mm_add_epi32(_mm_add_epi32(high, _mm_srai_epi32(low, 12)), t);
+  }
+
+  __m128i sat = _mm_packs_epi32(sum, sum);
+  if (lm)
+    sat = _mm_max_epi16(sat, _mm_setzero_si128());
+
+  _mm_store_si128(reinterpret_cast<__m128i*>(mac), sum);
+  _mm_store_si128(reinterpret_cast<__m128i*>(ir), _mm_srai_epi32(_mm_unpacklo_epi16(sat, sat), 16));
+#elif defined(CPU_ARCH_NEON)
+  alignas(16) const s16 c0[4] = {M(0, 0), M(1, 0), M(2, 0), 0};
+  alignas(16) const s16 c1[4] = {M(0, 1), M(1, 1), M(2, 1), 0};
+  alignas(16) const s16 c2[4] = {M(0, 2), M(1, 2), M(2, 2), 0};
+  alignas(16) const s32 tv[4] = {T[0], T[1], T[2], 0};
+  const int32x4_t p0 = vmull_s16(vld1_s16(c0), vdup_n_s16(Vx));
+  const int32x4_t p1 = vmull_s16(vld1_s16(c1), vdup_n_s16(Vy));
+  const int32x4_t p2 = vmull_s16(vld1_s16(c2), vdup_n_s16(Vz));
+  const int32x4_t t = vld1q_s32(tv);
+
+  int32x4_t sum;
+  if (shift == 0)
+  {
+    sum = vaddq_s32(vaddq_s32(vaddq_s32(p0, p1), p2), vshlq_n_s32(t, 12));
+  }
+  else
+  {
+    const int32x4_t low_mask = vdupq_n_s32(0xFFF);
+    const int32x4_t high = vaddq_s32(vaddq_s32(vshrq_n_s32(p0, 12), vshrq_n_s32(p1, 12)), vshrq_n_s32(p2, 12));
+    const int32x4_t low =
+      vaddq_s32(vaddq_s32(vandq_s32(p0, low_mask), vandq_s32(p1, low_mask)), vandq_s32(p2, low_mask));
+    sum = vaddq_s32(vaddq_s32(high, vshrq_n_s32(low, 12)), t);
+  }
+
+  int16x4_t sat = vqmovn_s32(sum);
+  if (lm)
+    sat = vmax_s16(sat, vdup_n_s16(0));
+
+  vst1q_s32(mac, sum);
+  vst1q_s32(ir, vmovl_s16(sat));
+#endif
+
+  REGS.MAC1 = mac[0];
+  REGS.MAC2 = mac[1];
+  REGS.MAC3 = mac[2];
+  REGS.dr32[9] = ir[0];
+  REGS.dr32[10] = ir[1];
+  REGS.dr32[11] = ir[2];
+  REGS.FLAG.bits |= (static_cast<u32>(ir[0] != mac[0]) << 24) | (static_cast<u32>(ir[1] != mac[1]) << 23) |
+                    (static_cast<u32>(ir[2] != mac[2]) << 22);
+#undef M
+}
+
+#endif
+
 static void MulMatVec(const s16* M_, const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
 {
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+  static constexpr const s32 zero_T[3] = {};
+  MulMatVecSIMD(M_, zero_T, Vx, Vy, Vz, shift, lm);
+#else
 #define M(i, j) M_[((i)*3) + (j)]
 #define dot3(i)                                                                                                        \
   TruncateAndSetMACAndIR<i + 1>(SignExtendMACResult<i + 1>((s64(M(i, 0)) * s64(Vx)) + (s64(M(i, 1)) * s64(Vy))) +      \
@@ -489,10 +590,19 @@ static void MulMatVec(const s16* M_, const s16 Vx, const s16 Vy, const s16 Vz, u
 
 #undef dot3
 #undef M
+#endif
 }
 
 static void MulMatVec(const s16* M_, const s32 T[3], const s16 Vx, const s16 Vy, const s16 Vz, u8 shift, bool lm)
 {
+#if defined(CPU_ARCH_SSE) || defined(CPU_ARCH_NEON)
+  if (IsNonOverflowingTranslation(T))
+  {
+    MulMatVecSIMD(M_, T, Vx, Vy, Vz, shift, lm);
+    return;
+  }
+#endif
+
 #define M(i, j) M_[((i)*3) + (j)]
 #define dot3(i)                                                                                                        \
   TruncateAndSetMACAndIR<i + 1>(                                                                                       \
@@ -623,13 +733,18 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
   SignExtendMACResult<i + 1>(SignExtendMACResult<i + 1>((s64(REGS.TR[i]) << 12) + (s64(REGS.RT[i][0]) * s64(V[0]))) +  \
                              (s64(REGS.RT[i][1]) * s64(V[1]))) +                                                       \
     (s64(REGS.RT[i][2]) * s64(V[2]))
+#define dot3_no_overflow(i)                                                                                            \
+  ((s64(REGS.TR[i]) << 12) + (s64(REGS.RT[i][0]) * s64(V[0])) + (s64(REGS.RT[i][1]) * s64(V[1])) +                     \
+   (s64(REGS.RT[i][2]) * s64(V[2])))
 
   // IR1 = MAC1 = (TRX*1000h + RT11*VX0 + RT12*VY0 + RT13*VZ0) SAR (sf*12)
   // IR2 = MAC2 = (TRY*1000h + RT21*VX0 + RT22*VY0 + RT23*VZ0) SAR (sf*12)
   // IR3 = MAC3 = (TRZ*1000h + RT31*VX0 + RT32*VY0 + RT33*VZ0) SAR (sf*12)
-  const s64 x = dot3(0);
-  const s64 y = dot3(1);
-  const s64 z = dot3(2);
+  // The intermediate sums can only overflow with a huge translation, so skip checking them otherwise.
+  const bool can_overflow = !IsNonOverflowingTranslation(REGS.TR);
+  const s64 x = can_overflow ? dot3(0) : dot3_no_overflow(0);
+  const s64 y = can_overflow ? dot3(1) : dot3_no_overflow(1);
+  const s64 z = can_overflow ? dot3(2) : dot3_no_overflow(2);
   TruncateAndSetMAC<1>(x, shift);
   TruncateAndSetMAC<2>(y, shift);
   TruncateAndSetMAC<3>(z, shift);
@@ -641,6 +756,7 @@ static void RTPS(const s16 V[3], u8 shift, bool lm, bool last)
   // when "MAC3" exceeds -8000h..+7FFFh).
   TruncateAndSetIR<3>(s32(z >> 12), false);
   REGS.dr32[11] = std::clamp(REGS.MAC3, lm ? 0 : IR123_MIN_VALUE, IR123_MAX_VALUE);
+#undef dot3_no_overflow
 #undef dot3
 
   // SZ3 = MAC3 SAR ((1-sf)*12)                           ;ScreenZ FIFO 0..+FFFFh
@@ -41,6 +41,11 @@ union FLAGS
 
   static constexpr u32 WRITE_MASK = UINT32_C(0xFFFFF000);
 
+  // Flags set by MAC0/OTZ saturation, including the error bit, for generated code.
+  static constexpr u32 MAC0_OVERFLOW_BITS = (UINT32_C(1) << 31) | (UINT32_C(1) << 16);
+  static constexpr u32 MAC0_UNDERFLOW_BITS = (UINT32_C(1) << 31) | (UINT32_C(1) << 15);
+  static constexpr u32 OTZ_SATURATED_BITS = (UINT32_C(1) << 31) | (UINT32_C(1) << 18);
+
   ALWAYS_INLINE void Clear() { bits = 0; }
 
   // Bits 30..23, 18..13 OR'ed
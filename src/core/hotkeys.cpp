@@ -3,10 +3,12 @@
 
 #include "cpu_code_cache.h"
 #include "cpu_core.h"
+#include "cpu_profiler.h"
 #include "fullscreen_ui.h"
 #include "gpu.h"
 #include "host.h"
 #include "imgui_overlays.h"
+#include "input_movie.h"
 #include "pgxp.h"
 #include "settings.h"
 #include "spu.h"
@@ -18,6 +20,7 @@
 #include "util/postprocessing.h"
 
 #include "common/file_system.h"
+#include "common/trace_recorder.h"
 
 #include "IconsFontAwesome5.h"
 
@@ -160,6 +163,50 @@ DEFINE_HOTKEY("Screenshot", TRANSLATE_NOOP("Hotkeys", "General"), TRANSLATE_NOOP
                   System::SaveScreenshot();
               })
 
+DEFINE_HOTKEY("ToggleMediaCapture", TRANSLATE_NOOP("Hotkeys", "General"),
+              TRANSLATE_NOOP("Hotkeys", "Toggle Video Capture"), [](s32 pressed) {
+                if (pressed || !System::IsValid())
+                  return;
+
+                if (System::IsMediaCaptureActive())
+                  System::StopMediaCapture();
+                else
+                  System::StartMediaCapture();
+              })
+
+DEFINE_HOTKEY("ToggleGuestProfiler", TRANSLATE_NOOP("Hotkeys", "General"),
+              TRANSLATE_NOOP("Hotkeys", "Toggle Guest Profiler"), [](s32 pressed) {
+                if (pressed || !System::IsValid())
+                  return;
+
+                if (CPU::Profiler::IsActive())
+                  System::StopGuestProfiler();
+                else
+                  System::StartGuestProfiler();
+              })
+
+DEFINE_HOTKEY("ToggleTraceRecording", TRANSLATE_NOOP("Hotkeys", "General"),
+              TRANSLATE_NOOP("Hotkeys", "Toggle Trace Recording"), [](s32 pressed) {
+                if (pressed)
+                  return;
+
+                if (TraceRecorder::IsRecording())
+                  System::StopTraceRecording();
+                else
+                  System::StartTraceRecording();
+              })
+
+DEFINE_HOTKEY("ToggleInputMovieRecording", TRANSLATE_NOOP("Hotkeys", "General"),
+              TRANSLATE_NOOP("Hotkeys", "Toggle Input Movie Recording"), [](s32 pressed) {
+                if (pressed || !System::IsValid())
+                  return;
+
+                if (InputMovie::IsActive())
+                  System::StopInputMovie();
+                else
+                  System::StartInputMovieRecording();
+              })
+
 #if !defined(__ANDROID__)
 DEFINE_HOTKEY("OpenAchievements", TRANSLATE_NOOP("Hotkeys", "General"),
               TRANSLATE_NOOP("Hotkeys", "Open Achievement List"), [](s32 pressed) {
@@ -37,7 +37,9 @@
 #include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <span>
 #include <unordered_map>
@@ -45,10 +47,49 @@
 Log_SetChannel(ImGuiManager);
 
 namespace ImGuiManager {
+struct PerformanceOverlayCacheKey
+{
+  u32 font_generation;
+  float display_width;
+  u32 counters_update_count;
+  System::State state;
+  float target_speed;
+  bool show_fps;
+  bool show_speed;
+  bool show_resolution;
+  bool show_cpu;
+  bool show_gpu;
+  bool show_status_indicators;
+  bool fast_forward;
+  bool turbo;
+  bool rewinding;
+  bool fullscreen_ui_active;
+  CPUExecutionMode cpu_execution_mode;
+  u32 cpu_overclock_percent;
+  bool cpu_recompiler_icache;
+  bool cpu_recompiler_memory_exceptions;
+  bool runahead;
+  bool has_sw_thread;
+  u32 effective_width;
+  u32 effective_height;
+  bool interlaced;
+  bool pal;
+
+  bool operator==(const PerformanceOverlayCacheKey&) const = default;
+};
+
 static void FormatProcessorStat(SmallStringBase& text, double usage, double time);
 static void DrawPerformanceOverlay();
+static float DrawPerformanceOverlayText(ImDrawList* dl);
+static void DrawFrameTimesOverlay(float position_y);
+static PerformanceOverlayCacheKey GetPerformanceOverlayCacheKey();
+static void AppendCachedDrawList(ImDrawList* dl, const ImDrawList& cached);
 static void DrawEnhancementsOverlay();
 static void DrawInputsOverlay();
+
+static std::unique_ptr<ImDrawList> s_performance_overlay_draw_list;
+static PerformanceOverlayCacheKey s_performance_overlay_cache_key;
+static float s_performance_overlay_end_y = 0.0f;
 } // namespace ImGuiManager
 
 namespace SaveStateSelectorUI {
@@ -271,6 +312,89 @@ void ImGuiManager::DrawPerformanceOverlay()
     return;
   }
 
+  // The text only changes when the counters are updated, about once a second, so its geometry is kept and copied into
+  // the frame rather than laid out again every frame.
+  const PerformanceOverlayCacheKey key = GetPerformanceOverlayCacheKey();
+  if (!s_performance_overlay_draw_list || s_performance_overlay_draw_list->_Data != ImGui::GetDrawListSharedData() ||
+      key != s_performance_overlay_cache_key)
+  {
+    if (!s_performance_overlay_draw_list || s_performance_overlay_draw_list->_Data != ImGui::GetDrawListSharedData())
+      s_performance_overlay_draw_list = std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData());
+
+    ImDrawList* cache_dl = s_performance_overlay_draw_list.get();
+    cache_dl->_ResetForNewFrame();
+    cache_dl->PushTextureID(ImGui::GetIO().Fonts->TexID);
+    cache_dl->PushClipRectFullScreen();
+    s_performance_overlay_end_y = DrawPerformanceOverlayText(cache_dl);
+    s_performance_overlay_cache_key = key;
+  }
+
+  AppendCachedDrawList(ImGui::GetBackgroundDrawList(), *s_performance_overlay_draw_list);
+
+  if (System::GetState() == System::State::Running && g_settings.display_show_frame_times)
+    DrawFrameTimesOverlay(s_performance_overlay_end_y);
+}
+
+ImGuiManager::PerformanceOverlayCacheKey ImGuiManager::GetPerformanceOverlayCacheKey()
+{
+  PerformanceOverlayCacheKey key = {};
+  key.font_generation = ImGuiManager::GetFontGeneration();
+  key.display_width = ImGui::GetIO().DisplaySize.x;
+  key.counters_update_count = System::GetPerformanceCountersUpdateCount();
+  key.state = System::GetState();
+  key.target_speed = System::GetTargetSpeed();
+  key.show_fps = g_settings.display_show_fps;
+  key.show_speed = g_settings.display_show_speed;
+  key.show_resolution = g_settings.display_show_resolution;
+  key.show_cpu = g_settings.display_show_cpu;
+  key.show_gpu = g_settings.display_show_gpu && g_gpu_device->IsGPUTimingEnabled();
+  key.show_status_indicators = g_settings.display_show_status_indicators;
+  key.fast_forward = System::IsFastForwardEnabled();
+  key.turbo = System::IsTurboEnabled();
+  key.rewinding = System::IsRewinding();
+  key.fullscreen_ui_active = FullscreenUI::HasActiveWindow();
+  key.cpu_execution_mode = g_settings.cpu_execution_mode;
+  key.cpu_overclock_percent = g_settings.cpu_overclock_active ? g_settings.GetCPUOverclockPercent() : 0;
+  key.cpu_recompiler_icache = g_settings.cpu_recompiler_icache;
+  key.cpu_recompiler_memory_exceptions = g_settings.cpu_recompiler_memory_exceptions;
+  key.runahead = (g_settings.runahead_frames > 0);
+  key.has_sw_thread = (g_gpu && g_gpu->GetSWThread());
+  if (key.state == System::State::Running && key.show_resolution)
+  {
+    const auto [effective_width, effective_height] = g_gpu->GetEffectiveDisplayResolution();
+    key.effective_width = effective_width;
+    key.effective_height = effective_height;
+    key.interlaced = g_gpu->IsInterlacedDisplayEnabled();
+    key.pal = g_gpu->IsInPALMode();
+  }
+
+  return key;
+}
+
+void ImGuiManager::AppendCachedDrawList(ImDrawList* dl, const ImDrawList& cached)
+{
+  const int vtx_count = cached.VtxBuffer.Size;
+  const int idx_count = cached.IdxBuffer.Size;
+  if (vtx_count == 0)
+    return;
+
+  // Everything in the cached list is text, so it's all in a single command with the font texture.
+  dl->PushTextureID(ImGui::GetIO().Fonts->TexID);
+  dl->PrimReserve(idx_count, vtx_count);
+
+  const ImDrawIdx base_index = static_cast<ImDrawIdx>(dl->_VtxCurrentIdx);
+  std::memcpy(dl->_VtxWritePtr, cached.VtxBuffer.Data, sizeof(ImDrawVert) * static_cast<size_t>(vtx_count));
+  for (int i = 0; i < idx_count; i++)
+    dl->_IdxWritePtr[i] = static_cast<ImDrawIdx>(cached.IdxBuffer.Data[i] + base_index);
+
+  dl->_VtxWritePtr += vtx_count;
+  dl->_IdxWritePtr += idx_count;
+  dl->_VtxCurrentIdx += static_cast<unsigned int>(vtx_count);
+  dl->PopTextureID();
+}
+
+float ImGuiManager::DrawPerformanceOverlayText(ImDrawList* dl)
+{
   const float scale = ImGuiManager::GetGlobalScale();
   const float shadow_offset = std::ceil(1.0f * scale);
   const float margin = std::ceil(10.0f * scale);
@@ -279,7 +403,6 @@ void ImGuiManager::DrawPerformanceOverlay()
   ImFont* standard_font = ImGuiManager::GetStandardFont();
   float position_y = margin;
 
-  ImDrawList* dl = ImGui::GetBackgroundDrawList();
   SmallString text;
   ImVec2 text_size;
   bool first = true;
@@ -405,6 +528,13 @@ void ImGuiManager::DrawPerformanceOverlay()
         DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
       }
 
+      if (g_settings.runahead_frames > 0)
+      {
+        text.fmt("Runahead: {:.2f}ms save | {:.2f}ms load", System::GetRunaheadSaveTime(),
+                 System::GetRunaheadLoadTime());
+        DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+      }
+
 #if 0
       {
         AudioStream* stream = g_spu.GetOutputStream();
@@ -420,6 +550,19 @@ void ImGuiManager::DrawPerformanceOverlay()
       text.assign("GPU: ");
       FormatProcessorStat(text, System::GetGPUUsage(), System::GetGPUAverageTime());
       DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+
+      if (g_gpu_device->GetFeatures().gpu_timing_scopes)
+      {
+        for (u32 i = 0; i < GPUDevice::NUM_TIMING_SCOPES; i++)
+        {
+          const float scope_time = System::GetGPUScopeAverageTime(i);
+          if (scope_time <= 0.0f)
+            continue;
+
+          text.fmt("{}: {:.2f}ms", GPUDevice::GetTimingScopeName(static_cast<GPUDevice::TimingScope>(i)), scope_time);
+          DRAW_LINE(fixed_font, text, IM_COL32(255, 255, 255, 255));
+        }
+      }
     }
 
     if (g_settings.display_show_status_indicators)
@@ -431,67 +574,6 @@ void ImGuiManager::DrawPerformanceOverlay()
         DRAW_LINE(standard_font, text, IM_COL32(255, 255, 255, 255));
       }
     }
-
-    if (g_settings.display_show_frame_times)
-    {
-      const ImVec2 history_size(200.0f * scale, 50.0f * scale);
-      ImGui::SetNextWindowSize(ImVec2(history_size.x, history_size.y));
-      ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - margin - history_size.x, position_y));
-      ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 0.25f));
-      ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
-      ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-      ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
-      ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
-      ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
-      ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.0f, 0.0f));
-      ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 0.0f);
-      if (ImGui::Begin("##frame_times", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs))
-      {
-        ImGui::PushFont(fixed_font);
-
-        auto [min, max] = GetMinMax(System::GetFrameTimeHistory());
-
-        // add a little bit of space either side, so we're not constantly resizing
-        if ((max - min) < 4.0f)
-        {
-          min = min - std::fmod(min, 1.0f);
-          max = max - std::fmod(max, 1.0f) + 1.0f;
-          min = std::max(min - 2.0f, 0.0f);
-          max += 2.0f;
-        }
-
-        ImGui::PlotEx(
-          ImGuiPlotType_Lines, "##frame_times",
-          [](void*, int idx) -> float {
-            return System::GetFrameTimeHistory()[((System::GetFrameTimeHistoryPos() + idx) %
-                                                  System::NUM_FRAME_TIME_SAMPLES)];
-          },
-          nullptr, System::NUM_FRAME_TIME_SAMPLES, 0, nullptr, min, max, history_size);
-
-        ImDrawList* win_dl = ImGui::GetCurrentWindow()->DrawList;
-        const ImVec2 wpos(ImGui::GetCurrentWindow()->Pos);
-
-        text.fmt("{:.1f} ms", max);
-        text_size = fixed_font->CalcTextSizeA(fixed_font->FontSize, FLT_MAX, 0.0f, text.c_str(), text.end_ptr());
-        win_dl->AddText(ImVec2(wpos.x + history_size.x - text_size.x - spacing + shadow_offset, wpos.y + shadow_offset),
-                        IM_COL32(0, 0, 0, 100), text.c_str(), text.end_ptr());
-        win_dl->AddText(ImVec2(wpos.x + history_size.x - text_size.x - spacing, wpos.y), IM_COL32(255, 255, 255, 255),
-                        text.c_str(), text.end_ptr());
-
-        text.fmt("{:.1f} ms", min);
-        text_size = fixed_font->CalcTextSizeA(fixed_font->FontSize, FLT_MAX, 0.0f, text.c_str(), text.end_ptr());
-        win_dl->AddText(ImVec2(wpos.x + history_size.x - text_size.x - spacing + shadow_offset,
-                               wpos.y + history_size.y - fixed_font->FontSize + shadow_offset),
-                        IM_COL32(0, 0, 0, 100), text.c_str(), text.end_ptr());
-        win_dl->AddText(
-          ImVec2(wpos.x + history_size.x - text_size.x - spacing, wpos.y + history_size.y - fixed_font->FontSize),
-          IM_COL32(255, 255, 255, 255), text.c_str(), text.end_ptr());
-        ImGui::PopFont();
-      }
-      ImGui::End();
-      ImGui::PopStyleVar(5);
-      ImGui::PopStyleColor(3);
-    }
   }
   else if (g_settings.display_show_status_indicators && state == System::State::Paused &&
            !FullscreenUI::HasActiveWindow())
@@ -501,6 +583,77 @@ void ImGuiManager::DrawPerformanceOverlay()
   }
 
 #undef DRAW_LINE
+
+  return position_y;
+}
+
+void ImGuiManager::DrawFrameTimesOverlay(float position_y)
+{
+  const float scale = ImGuiManager::GetGlobalScale();
+  const float shadow_offset = std::ceil(1.0f * scale);
+  const float margin = std::ceil(10.0f * scale);
+  const float spacing = std::ceil(5.0f * scale);
+  ImFont* fixed_font = ImGuiManager::GetFixedFont();
+  SmallString text;
+  ImVec2 text_size;
+
+  const ImVec2 history_size(200.0f * scale, 50.0f * scale);
+  ImGui::SetNextWindowSize(ImVec2(history_size.x, history_size.y));
+  ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - margin - history_size.x, position_y));
+  ImGui::PushStyleColor(ImGuiCol_WindowBg, ImVec4(0.0f, 0.0f, 0.0f, 0.25f));
+  ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
+  ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowRounding, 0.0f);
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0.0f, 0.0f));
+  ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.0f);
+  ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.0f, 0.0f));
+  ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 0.0f);
+  if (ImGui::Begin("##frame_times", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs))
+  {
+    ImGui::PushFont(fixed_font);
+
+    auto [min, max] = GetMinMax(System::GetFrameTimeHistory());
+
+    // add a little bit of space either side, so we're not constantly resizing
+    if ((max - min) < 4.0f)
+    {
+      min = min - std::fmod(min, 1.0f);
+      max = max - std::fmod(max, 1.0f) + 1.0f;
+      min = std::max(min - 2.0f, 0.0f);
+      max += 2.0f;
+    }
+
+    ImGui::PlotEx(
+      ImGuiPlotType_Lines, "##frame_times",
+      [](void*, int idx) -> float {
+        return System::GetFrameTimeHistory()[((System::GetFrameTimeHistoryPos() + idx) %
+                                              System::NUM_FRAME_TIME_SAMPLES)];
+      },
+      nullptr, System::NUM_FRAME_TIME_SAMPLES, 0, nullptr, min, max, history_size);
+
+    ImDrawList* win_dl = ImGui::GetCurrentWindow()->DrawList;
+    const ImVec2 wpos(ImGui::GetCurrentWindow()->Pos);
+
+    text.fmt("{:.1f} ms", max);
+    text_size = fixed_font->CalcTextSizeA(fixed_font->FontSize, FLT_MAX, 0.0f, text.c_str(), text.end_ptr());
+    win_dl->AddText(ImVec2(wpos.x + history_size.x - text_size.x - spacing + shadow_offset, wpos.y + shadow_offset),
+                    IM_COL32(0, 0, 0, 100), text.c_str(), text.end_ptr());
+    win_dl->AddText(ImVec2(wpos.x + history_size.x - text_size.x - spacing, wpos.y), IM_COL32(255, 255, 255, 255),
+                    text.c_str(), text.end_ptr());
+
+    text.fmt("{:.1f} ms", min);
+    text_size = fixed_font->CalcTextSizeA(fixed_font->FontSize, FLT_MAX, 0.0f, text.c_str(), text.end_ptr());
+    win_dl->AddText(ImVec2(wpos.x + history_size.x - text_size.x - spacing + shadow_offset,
+                           wpos.y + history_size.y - fixed_font->FontSize + shadow_offset),
+                    IM_COL32(0, 0, 0, 100), text.c_str(), text.end_ptr());
+    win_dl->AddText(
+      ImVec2(wpos.x + history_size.x - text_size.x - spacing, wpos.y + history_size.y - fixed_font->FontSize),
+      IM_COL32(255, 255, 255, 255), text.c_str(), text.end_ptr());
+    ImGui::PopFont();
+  }
+  ImGui::End();
+  ImGui::PopStyleVar(5);
+  ImGui::PopStyleColor(3);
 }
 
 void ImGuiManager::DrawEnhancementsOverlay()
@@ -0,0 +1,450 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "input_movie.h"
+#include "controller.h"
+#include "netplay.h"
+#include "save_state_version.h"
+#include "settings.h"
+#include "spu.h"
+#include "system.h"
+
+#include "common/byte_stream.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/string_util.h"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <limits>
+#include <vector>
+
+Log_SetChannel(InputMovie);
+
+namespace InputMovie {
+namespace {
+enum class RecordType : u8
+{
+  Input,
+  Keyframe,
+  End,
+};
+
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 keyframe_interval;
+  u32 reserved;
+  char serial[32];
+};
+
+// Keyframe records are followed by size bytes of save state.
+struct Record
+{
+  u32 frame;
+  RecordType type;
+  u8 port;
+  u8 bind_index;
+  u8 reserved;
+  float value;
+  u32 size;
+};
+static_assert(sizeof(Record) == 16);
+
+struct InputEvent
+{
+  u32 frame;
+  u8 port;
+  u8 bind_index;
+  float value;
+};
+
+struct Keyframe
+{
+  u32 frame;
+  u32 size;
+  s64 offset;
+};
+} // namespace
+
+static constexpr u32 FILE_MAGIC = 0x564D5344; // DSMV
+static constexpr u32 FILE_VERSION = 1;
+static constexpr u32 NO_FRAME = std::numeric_limits<u32>::max();
+
+static bool WriteRecord(const Record& record, Error* error);
+static bool WriteKeyframe(Error* error);
+static bool ReadIndex(Error* error);
+static bool LoadKeyframe(const Keyframe& keyframe, Error* error);
+static void ApplyEvents(u32 frame);
+static void EndSeek();
+
+static FileSystem::ManagedCFilePtr s_file;
+static u32 s_keyframe_interval = 0;
+static u32 s_frame = 0;
+static u32 s_frame_count = 0;
+static u32 s_seek_target = NO_FRAME;
+
+// Only loaded for playback.
+static std::vector<InputEvent> s_events;
+static std::vector<Keyframe> s_keyframes;
+static size_t s_next_event = 0;
+} // namespace InputMovie
+
+bool InputMovie::Internal::g_recording = false;
+bool InputMovie::Internal::g_playing = false;
+
+bool InputMovie::WriteRecord(const Record& record, Error* error)
+{
+  if (std::fwrite(&record, sizeof(record), 1, s_file.get()) != 1)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  return true;
+}
+
+bool InputMovie::WriteKeyframe(Error* error)
+{
+  std::unique_ptr<GrowableMemoryByteStream> stream = ByteStream::CreateGrowableMemoryStream();
+  if (!System::SaveStateToStream(stream.get(), 0, SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD))
+  {
+    Error::SetString(error, "Failed to save state.");
+    return false;
+  }
+
+  const Record record = {s_frame, RecordType::Keyframe, 0, 0, 0, 0.0f, static_cast<u32>(stream->GetSize())};
+  if (!WriteRecord(record, error) ||
+      std::fwrite(stream->GetMemoryPointer(), record.size, 1, s_file.get()) != 1 || std::fflush(s_file.get()) != 0)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  // Flushed, so a movie of a session which crashes is still usable up to here.
+  Log_DevPrintf("Wrote %u byte keyframe for frame %u", record.size, s_frame);
+  return true;
+}
+
+bool InputMovie::StartRecording(const char* path, u32 keyframe_interval_seconds, Error* error)
+{
+  if (!System::IsValid() || Netplay::IsActive())
+  {
+    Error::SetString(error, "System is not running, or is in a netplay session.");
+    return false;
+  }
+
+  Stop();
+
+  s_file = FileSystem::OpenManagedCFile(path, "wb", error);
+  if (!s_file)
+    return false;
+
+  FileHeader header = {};
+  header.magic = FILE_MAGIC;
+  header.version = FILE_VERSION;
+  header.keyframe_interval = std::max<u32>(keyframe_interval_seconds, 1) * (System::IsPALRegion() ? 50 : 60);
+  StringUtil::Strlcpy(header.serial, System::GetGameSerial(), sizeof(header.serial));
+
+  s_keyframe_interval = header.keyframe_interval;
+  s_frame = 0;
+  s_frame_count = 0;
+  if (std::fwrite(&header, sizeof(header), 1, s_file.get()) != 1)
+  {
+    Error::SetErrno(error, errno);
+    s_file.reset();
+    return false;
+  }
+
+  // Replay starts from the exact state, including the controllers, so held input doesn't need to be recorded.
+  if (!WriteKeyframe(error))
+  {
+    s_file.reset();
+    return false;
+  }
+
+  Internal::g_recording = true;
+  Log_InfoPrintf("Recording input movie to '%s', with a keyframe every %u frames.", path, s_keyframe_interval);
+  return true;
+}
+
+bool InputMovie::ReadIndex(Error* error)
+{
+  FileHeader header;
+  if (std::fread(&header, sizeof(header), 1, s_file.get()) != 1 || header.magic != FILE_MAGIC)
+  {
+    Error::SetString(error, "Not an input movie.");
+    return false;
+  }
+  if (header.version != FILE_VERSION)
+  {
+    Error::SetString(error, fmt::format("Unsupported input movie version {}.", header.version));
+    return false;
+  }
+
+  header.serial[sizeof(header.serial) - 1] = 0;
+  if (System::GetGameSerial() != header.serial)
+  {
+    Error::SetString(error, fmt::format("Input movie was recorded with '{}', but '{}' is running.", header.serial,
+                                        System::GetGameSerial()));
+    return false;
+  }
+
+  s_keyframe_interval = header.keyframe_interval;
+  s_frame_count = 0;
+  s_events.clear();
+  s_keyframes.clear();
+
+  // A movie which was never finalized ends at its last complete record.
+  const s64 file_size = FileSystem::FSize64(s_file.get());
+  Record record;
+  while (std::fread(&record, sizeof(record), 1, s_file.get()) == 1)
+  {
+    if (record.type == RecordType::Input)
+    {
+      if (record.port >= NUM_CONTROLLER_AND_CARD_PORTS || record.bind_index >= MAX_BIND_STATES)
+        continue;
+
+      s_events.push_back(InputEvent{record.frame, record.port, record.bind_index, record.value});
+      s_frame_count = std::max(s_frame_count, record.frame + 1);
+    }
+    else if (record.type == RecordType::Keyframe)
+    {
+      const s64 offset = FileSystem::FTell64(s_file.get());
+      if (offset < 0 || (offset + record.size) > file_size ||
+          FileSystem::FSeek64(s_file.get(), record.size, SEEK_CUR) != 0)
+      {
+        break;
+      }
+
+      s_keyframes.push_back(Keyframe{record.frame, record.size, offset});
+      s_frame_count = std::max(s_frame_count, record.frame + 1);
+    }
+    else if (record.type == RecordType::End)
+    {
+      s_frame_count = record.frame;
+      break;
+    }
+  }
+
+  if (s_keyframes.empty() || s_keyframes.front().frame != 0)
+  {
+    Error::SetString(error, "Input movie has no starting state.");
+    return false;
+  }
+
+  return true;
+}
+
+bool InputMovie::LoadKeyframe(const Keyframe& keyframe, Error* error)
+{
+  std::vector<u8> data(keyframe.size);
+  if (FileSystem::FSeek64(s_file.get(), keyframe.offset, SEEK_SET) != 0 ||
+      std::fread(data.data(), data.size(), 1, s_file.get()) != 1)
+  {
+    Error::SetErrno(error, errno);
+    return false;
+  }
+
+  // The controllers and memory cards have to come from the keyframe too, or the input won't play back the same way.
+  const bool load_devices_from_save_states = g_settings.load_devices_from_save_states;
+  g_settings.load_devices_from_save_states = true;
+
+  std::unique_ptr<ReadOnlyMemoryByteStream> stream =
+    ByteStream::CreateReadOnlyMemoryStream(data.data(), static_cast<u32>(data.size()));
+  const bool result = System::LoadStateFromStream(stream.get(), true, true);
+  g_settings.load_devices_from_save_states = load_devices_from_save_states;
+  if (!result)
+  {
+    Error::SetString(error, fmt::format("Failed to load keyframe for frame {}.", keyframe.frame));
+    return false;
+  }
+
+  s_frame = keyframe.frame;
+  s_next_event = static_cast<size_t>(
+    std::lower_bound(s_events.begin(), s_events.end(), s_frame,
+                     [](const InputEvent& event, u32 frame) { return event.frame < frame; }) -
+    s_events.begin());
+  ApplyEvents(s_frame);
+  return true;
+}
+
+bool InputMovie::StartPlayback(const char* path, Error* error)
+{
+  if (!System::IsValid() || Netplay::IsActive())
+  {
+    Error::SetString(error, "System is not running, or is in a netplay session.");
+    return false;
+  }
+
+  Stop();
+
+  s_file = FileSystem::OpenManagedCFile(path, "rb", error);
+  if (!s_file)
+    return false;
+
+  if (!ReadIndex(error) || !LoadKeyframe(s_keyframes.front(), error))
+  {
+    s_file.reset();
+    s_events.clear();
+    s_keyframes.clear();
+    return false;
+  }
+
+  Internal::g_playing = true;
+  Log_InfoPrintf("Playing %u frame input movie '%s', with %zu input events and %zu keyframes.", s_frame_count, path,
+                 s_events.size(), s_keyframes.size());
+  return true;
+}
+
+void InputMovie::Stop()
+{
+  if (Internal::g_recording)
+  {
+    Error error;
+    const Record record = {s_frame, RecordType::End, 0, 0, 0, 0.0f, 0};
+    if (!WriteRecord(record, &error) || std::fflush(s_file.get()) != 0)
+      Log_ErrorPrintf("Failed to finalize input movie: %s", error.GetDescription().c_str());
+
+    Log_InfoPrintf("Input movie recording stopped after %u frames.", s_frame);
+    Internal::g_recording = false;
+  }
+  else if (Internal::g_playing)
+  {
+    EndSeek();
+    Log_InfoPrintf("Input movie playback stopped at frame %u of %u.", s_frame, s_frame_count);
+    Internal::g_playing = false;
+    s_events.clear();
+    s_keyframes.clear();
+  }
+
+  s_file.reset();
+}
+
+bool InputMovie::SetBindState(u32 pad, u32 bind_index, float value)
+{
+  if (Internal::g_playing)
+    return true;
+
+  if (Internal::g_recording && pad < NUM_CONTROLLER_AND_CARD_PORTS && bind_index < MAX_BIND_STATES)
+  {
+    // Recorded as it's sent, rather than read back from the controller, which can drop or rescale it.
+    Error error;
+    const Record record = {
+      s_frame, RecordType::Input, static_cast<u8>(pad), static_cast<u8>(bind_index), 0, value, 0};
+    if (!WriteRecord(record, &error))
+    {
+      Log_ErrorPrintf("Failed to write input movie, stopping recording: %s", error.GetDescription().c_str());
+      Stop();
+    }
+  }
+
+  return false;
+}
+
+void InputMovie::ApplyEvents(u32 frame)
+{
+  for (; s_next_event < s_events.size() && s_events[s_next_event].frame <= frame; s_next_event++)
+  {
+    const InputEvent& event = s_events[s_next_event];
+    if (Controller* controller = System::GetController(event.port))
+      controller->SetBindState(event.bind_index, event.value);
+  }
+}
+
+void InputMovie::EndSeek()
+{
+  if (s_seek_target == NO_FRAME)
+    return;
+
+  s_seek_target = NO_FRAME;
+  SPU::SetAudioOutputMuted(false);
+}
+
+bool InputMovie::SeekToFrame(u32 frame, Error* error)
+{
+  if (!Internal::g_playing)
+  {
+    Error::SetString(error, "Input movie is not playing.");
+    return false;
+  }
+  if (frame >= s_frame_count)
+  {
+    Error::SetString(error, fmt::format("Input movie is only {} frames long.", s_frame_count));
+    return false;
+  }
+
+  // Running forward from where playback already is beats loading a keyframe which is further back.
+  const auto iter = std::upper_bound(s_keyframes.begin(), s_keyframes.end(), frame,
+                                     [](u32 frame, const Keyframe& keyframe) { return frame < keyframe.frame; });
+  const Keyframe& keyframe = *(iter - 1);
+  if ((frame < s_frame || keyframe.frame > s_frame) && !LoadKeyframe(keyframe, error))
+  {
+    Stop();
+    return false;
+  }
+
+  EndSeek();
+  if (s_frame < frame)
+  {
+    Log_DevPrintf("Running %u frames from frame %u to reach frame %u", frame - s_frame, s_frame, frame);
+    s_seek_target = frame;
+    SPU::SetAudioOutputMuted(true);
+  }
+
+  return true;
+}
+
+bool InputMovie::FrameDone()
+{
+  s_frame++;
+
+  if (Internal::g_recording)
+  {
+    if ((s_frame % s_keyframe_interval) == 0)
+    {
+      Error error;
+      if (!WriteKeyframe(&error))
+      {
+        Log_ErrorPrintf("Failed to write input movie keyframe, stopping recording: %s",
+                        error.GetDescription().c_str());
+        Stop();
+      }
+    }
+
+    return false;
+  }
+
+  if (s_frame >= s_frame_count)
+  {
+    Log_InfoPrintf("Input movie finished after %u frames.", s_frame_count);
+    Stop();
+    return false;
+  }
+
+  ApplyEvents(s_frame);
+
+  if (s_seek_target != NO_FRAME)
+  {
+    if (s_frame < s_seek_target)
+      return true;
+
+    EndSeek();
+  }
+
+  return false;
+}
+
+u32 InputMovie::GetCurrentFrame()
+{
+  return s_frame;
+}
+
+u32 InputMovie::GetFrameCount()
+{
+  return Internal::g_recording ? s_frame : s_frame_count;
+}
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "types.h"
+
+class Error;
+
+/// Input movies, for replaying a session exactly. Every change to a controller's bind states is recorded with the
+/// frame it was seen in, and a full save state is embedded every few seconds as a keyframe. Seeking loads the nearest
+/// keyframe before the target, and runs the frames from there without presenting them, rather than replaying the
+/// whole movie from the start.
+namespace InputMovie {
+
+/// Bind states recorded per controller, enough for every controller type.
+static constexpr u32 MAX_BIND_STATES = 32;
+
+static constexpr u32 DEFAULT_KEYFRAME_INTERVAL_SECONDS = 30;
+
+namespace Internal {
+extern bool g_recording;
+extern bool g_playing;
+} // namespace Internal
+
+ALWAYS_INLINE static bool IsRecording()
+{
+  return Internal::g_recording;
+}
+
+ALWAYS_INLINE static bool IsPlaying()
+{
+  return Internal::g_playing;
+}
+
+ALWAYS_INLINE static bool IsActive()
+{
+  return (Internal::g_recording || Internal::g_playing);
+}
+
+/// Starts recording the running system to path. The current state is the first keyframe.
+bool StartRecording(const char* path, u32 keyframe_interval_seconds, Error* error);
+
+/// Loads the first keyframe of the movie at path and starts playing it. The movie's game has to be running already,
+/// input from the user is ignored until playback stops.
+bool StartPlayback(const char* path, Error* error);
+
+/// Stops recording or playback. Recorded movies are finalized, but remain playable if this is never called.
+void Stop();
+
+/// Records input for pad while recording, or drops it while playing. Returns true if the input is consumed.
+bool SetBindState(u32 pad, u32 bind_index, float value);
+
+/// Moves playback to the start of frame. Returns false if the movie isn't that long.
+bool SeekToFrame(u32 frame, Error* error);
+
+/// Called by the system at the end of each frame. Returns true while seeking, when the next frame shouldn't be
+/// presented. Only valid on the CPU thread.
+bool FrameDone();
+
+u32 GetCurrentFrame();
+u32 GetFrameCount();
+
+} // namespace InputMovie
@@ -6,6 +6,7 @@
 #include "dma.h"
 #include "host.h"
 #include "interrupt_controller.h"
+#include "mdec_kernels.h"
 #include "system.h"
 
 #include "util/imgui_manager.h"
@@ -102,6 +103,7 @@ static void Execute();
 static bool HandleDecodeMacroblockCommand();
 static void HandleSetQuantTableCommand();
 static void HandleSetScaleCommand();
+static void PopDataInFIFO(void* dst, u32 halfwords);
 
 static bool DecodeMonoMacroblock();
 static bool DecodeColoredMacroblock();
@@ -131,6 +133,7 @@ static std::array<u8, 64> s_iq_uv{};
 static std::array<u8, 64> s_iq_y{};
 
 static std::array<s16, 64> s_scale_table{};
+static Kernels::IDCTTable s_idct_table{};
 
 // blocks, for colour: 0 - Crblk, 1 - Cbblk, 2-5 - Y 1-4
 static std::array<std::array<s16, 64>, NUM_BLOCKS> s_blocks;
@@ -184,7 +187,10 @@ bool MDEC::DoState(StateWrapper& sw)
   bool block_copy_out_pending = HasPendingBlockCopyOut();
   sw.Do(&block_copy_out_pending);
   if (sw.IsReading())
+  {
     s_block_copy_out_event->SetState(block_copy_out_pending);
+    Kernels::BuildIDCTTable(&s_idct_table, s_scale_table.data());
+  }
 
   return !sw.HasError();
 }
@@ -595,40 +601,15 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
 
     case DataOutputDepth_24Bit:
     {
-      // pack tightly
-      u32 index = 0;
-      u32 state = 0;
-      u32 rgb = 0;
-      while (index < s_block_rgb.size())
+      // pack tightly, four pixels to three words: RGBR GBRG BRGB
+      std::array<u32, 192> words;
+      for (u32 i = 0, o = 0; i < static_cast<u32>(s_block_rgb.size()); i += 4, o += 3)
       {
-        switch (state)
-        {
-          case 0:
-            rgb = s_block_rgb[index++]; // RGB-
-            state = 1;
-            break;
-          case 1:
-            rgb |= (s_block_rgb[index] & 0xFF) << 24; // RGBR
-            s_data_out_fifo.Push(rgb);
-            rgb = s_block_rgb[index] >> 8; // GB--
-            index++;
-            state = 2;
-            break;
-          case 2:
-            rgb |= s_block_rgb[index] << 16; // GBRG
-            s_data_out_fifo.Push(rgb);
-            rgb = s_block_rgb[index] >> 16; // B---
-            index++;
-            state = 3;
-            break;
-          case 3:
-            rgb |= s_block_rgb[index] << 8; // BRGB
-            s_data_out_fifo.Push(rgb);
-            index++;
-            state = 0;
-            break;
-        }
+        words[o + 0] = s_block_rgb[i + 0] | ((s_block_rgb[i + 1] & 0xFF) << 24);
+        words[o + 1] = (s_block_rgb[i + 1] >> 8) | (s_block_rgb[i + 2] << 16);
+        words[o + 2] = (s_block_rgb[i + 2] >> 16) | (s_block_rgb[i + 3] << 8);
       }
+      s_data_out_fifo.PushRange(words.data(), static_cast<u32>(words.size()));
       break;
     }
 
@@ -656,25 +637,9 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
       }
       else
       {
-        const u32 a = ZeroExtend32(s_status.data_output_bit15.GetValue()) << 15;
-        for (u32 i = 0; i < static_cast<u32>(s_block_rgb.size());)
-        {
-#define E8TO5(color) (std::min<u32>((((color) + 4) >> 3), 0x1F))
-          u32 color = s_block_rgb[i++];
-          u32 r = E8TO5(color & 0xFFu);
-          u32 g = E8TO5((color >> 8) & 0xFFu);
-          u32 b = E8TO5((color >> 16) & 0xFFu);
-          const u32 color15a = r | (g << 5) | (b << 10) | a;
-
-          color = s_block_rgb[i++];
-          r = E8TO5(color & 0xFFu);
-          g = E8TO5((color >> 8) & 0xFFu);
-          b = E8TO5((color >> 16) & 0xFFu);
-          const u32 color15b = r | (g << 5) | (b << 10) | a;
-#undef E8TO5
-
-          s_data_out_fifo.Push(color15a | (color15b << 16));
-        }
+        alignas(16) std::array<u32, 128> words;
+        Kernels::PackRGB15(words.data(), s_block_rgb.data(), ZeroExtend32(s_status.data_output_bit15.GetValue()) << 15);
+        s_data_out_fifo.PushRange(words.data(), static_cast<u32>(words.size()));
       }
     }
     break;
@@ -777,29 +742,7 @@ void MDEC::IDCT(s16* blk)
 
 void MDEC::IDCT_New(s16* blk)
 {
-  std::array<s32, 64> temp;
-  for (u32 x = 0; x < 8; x++)
-  {
-    for (u32 y = 0; y < 8; y++)
-    {
-      // TODO: We could alter zigzag and invert scale_table to get these in row-major order,
-      // in which case we could do optimize this to a vector multiply.
-      s32 sum = 0;
-      for (u32 z = 0; z < 8; z++)
-        sum += s32(blk[y + z * 8]) * s32(s_scale_table[x + z * 8] / 8);
-      temp[x + y * 8] = static_cast<s32>((sum + 0xfff) / 0x2000);
-    }
-  }
-  for (u32 x = 0; x < 8; x++)
-  {
-    for (u32 y = 0; y < 8; y++)
-    {
-      s32 sum = 0;
-      for (u32 z = 0; z < 8; z++)
-        sum += temp[y + z * 8] * s32(s_scale_table[x + z * 8] / 8);
-      blk[x + y * 8] = static_cast<s16>(std::clamp<s32>((sum + 0xfff) / 0x2000, -128, 127));
-    }
-  }
+  Kernels::IDCT(blk, s_idct_table);
 }
 
 void MDEC::IDCT_Old(s16* blk)
@@ -833,27 +776,7 @@ void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const st
                       const std::array<s16, 64>& Yblk)
 {
   const s16 addval = s_status.data_output_signed ? 0 : 0x80;
-  for (u32 y = 0; y < 8; y++)
-  {
-    for (u32 x = 0; x < 8; x++)
-    {
-      s16 R = Crblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
-      s16 B = Cbblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
-      s16 G = static_cast<s16>((-0.3437f * static_cast<float>(B)) + (-0.7143f * static_cast<float>(R)));
-
-      R = static_cast<s16>(1.402f * static_cast<float>(R));
-      B = static_cast<s16>(1.772f * static_cast<float>(B));
-
-      s16 Y = Yblk[x + y * 8];
-      R = static_cast<s16>(std::clamp(static_cast<int>(Y) + R, -128, 127)) + addval;
-      G = static_cast<s16>(std::clamp(static_cast<int>(Y) + G, -128, 127)) + addval;
-      B = static_cast<s16>(std::clamp(static_cast<int>(Y) + B, -128, 127)) + addval;
-
-      s_block_rgb[(x + xx) + ((y + yy) * 16)] = ZeroExtend32(static_cast<u16>(R)) |
-                                                (ZeroExtend32(static_cast<u16>(G)) << 8) |
-                                                (ZeroExtend32(static_cast<u16>(B)) << 16);
-    }
-  }
+  Kernels::YUVToRGB(s_block_rgb.data(), xx, yy, Crblk.data(), Cbblk.data(), Yblk.data(), addval);
 }
 
 void MDEC::y_to_mono(const std::array<s16, 64>& Yblk)
@@ -868,22 +791,24 @@ void MDEC::y_to_mono(const std::array<s16, 64>& Yblk)
   }
 }
 
+void MDEC::PopDataInFIFO(void* dst, u32 halfwords)
+{
+  const auto [first, second] = s_data_in_fifo.PopSpans(halfwords);
+  std::memcpy(dst, first.data(), first.size_bytes());
+  std::memcpy(static_cast<u8*>(dst) + first.size_bytes(), second.data(), second.size_bytes());
+}
+
 void MDEC::HandleSetQuantTableCommand()
 {
   DebugAssert(s_remaining_halfwords >= 32);
 
-  // TODO: Remove extra copies..
-  std::array<u16, 32> packed_data;
-  s_data_in_fifo.PopRange(packed_data.data(), static_cast<u32>(packed_data.size()));
+  PopDataInFIFO(s_iq_y.data(), static_cast<u32>(s_iq_y.size() / sizeof(u16)));
   s_remaining_halfwords -= 32;
-  std::memcpy(s_iq_y.data(), packed_data.data(), s_iq_y.size());
 
   if (s_remaining_halfwords > 0)
   {
     DebugAssert(s_remaining_halfwords >= 32);
-
-    s_data_in_fifo.PopRange(packed_data.data(), static_cast<u32>(packed_data.size()));
-    std::memcpy(s_iq_uv.data(), packed_data.data(), s_iq_uv.size());
+    PopDataInFIFO(s_iq_uv.data(), static_cast<u32>(s_iq_uv.size() / sizeof(u16)));
   }
 }
 
@@ -891,11 +816,9 @@ void MDEC::HandleSetScaleCommand()
 {
   DebugAssert(s_remaining_halfwords == 64);
 
-  // TODO: Remove extra copies..
-  std::array<u16, 64> packed_data;
-  s_data_in_fifo.PopRange(packed_data.data(), static_cast<u32>(packed_data.size()));
+  PopDataInFIFO(s_scale_table.data(), static_cast<u32>(s_scale_table.size()));
   s_remaining_halfwords -= 32;
-  std::memcpy(s_scale_table.data(), packed_data.data(), s_scale_table.size() * sizeof(s16));
+  Kernels::BuildIDCTTable(&s_idct_table, s_scale_table.data());
 }
 
 void MDEC::DrawDebugStateWindow()
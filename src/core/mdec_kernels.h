@@ -0,0 +1,408 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/bitutils.h"
+#include "common/intrin.h"
+#include "common/types.h"
+
+#include <algorithm>
+#include <array>
+
+/// Block transforms used by the MDEC. Each has a scalar reference implementation, and a vectorized version which
+/// produces identical results and is what the MDEC actually uses. Kept free of any MDEC state so both can be tested.
+namespace MDEC::Kernels {
+
+/// Scale matrix in the form the IDCT consumes it. Rebuild whenever the scale table changes.
+struct IDCTTable
+{
+  // Scale table values divided by 8, row-major.
+  alignas(16) std::array<s16, 64> scale;
+
+  // Pairs of rows interleaved, [row 2n][x], [row 2n + 1][x]..., so two rows can be multiplied at once with madd.
+  alignas(16) std::array<s16, 64> interleaved;
+};
+
+ALWAYS_INLINE static void BuildIDCTTable(IDCTTable* table, const s16* scale_table)
+{
+  for (u32 i = 0; i < 64; i++)
+    table->scale[i] = static_cast<s16>(scale_table[i] / 8);
+
+  for (u32 row = 0; row < 8; row += 2)
+  {
+    for (u32 x = 0; x < 8; x++)
+    {
+      table->interleaved[row * 8 + x * 2 + 0] = table->scale[row * 8 + x];
+      table->interleaved[row * 8 + x * 2 + 1] = table->scale[(row + 1) * 8 + x];
+    }
+  }
+}
+
+/// Coefficients must be in the range produced by the run-length decoder, [-0x400, 0x3FF].
+ALWAYS_INLINE static void IDCTScalar(s16* blk, const IDCTTable& table)
+{
+  std::array<s32, 64> temp;
+  for (u32 x = 0; x < 8; x++)
+  {
+    for (u32 y = 0; y < 8; y++)
+    {
+      s32 sum = 0;
+      for (u32 z = 0; z < 8; z++)
+        sum += s32(blk[y + z * 8]) * s32(table.scale[x + z * 8]);
+      temp[x + y * 8] = static_cast<s32>((sum + 0xfff) / 0x2000);
+    }
+  }
+  for (u32 x = 0; x < 8; x++)
+  {
+    for (u32 y = 0; y < 8; y++)
+    {
+      s32 sum = 0;
+      for (u32 z = 0; z < 8; z++)
+        sum += temp[y + z * 8] * s32(table.scale[x + z * 8]);
+      blk[x + y * 8] = static_cast<s16>(std::clamp<s32>((sum + 0xfff) / 0x2000, -128, 127));
+    }
+  }
+}
+
+/// Inputs must be in the range produced by the IDCT, [-128, 127].
+ALWAYS_INLINE static void YUVToRGBScalar(u32* rgb, u32 xx, u32 yy, const s16* Crblk, const s16* Cbblk,
+                                         const s16* Yblk, s16 addval)
+{
+  for (u32 y = 0; y < 8; y++)
+  {
+    for (u32 x = 0; x < 8; x++)
+    {
+      s16 R = Crblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
+      s16 B = Cbblk[((x + xx) / 2) + ((y + yy) / 2) * 8];
+      s16 G = static_cast<s16>((-0.3437f * static_cast<float>(B)) + (-0.7143f * static_cast<float>(R)));
+
+      R = static_cast<s16>(1.402f * static_cast<float>(R));
+      B = static_cast<s16>(1.772f * static_cast<float>(B));
+
+      s16 Y = Yblk[x + y * 8];
+      R = static_cast<s16>(std::clamp(static_cast<int>(Y) + R, -128, 127)) + addval;
+      G = static_cast<s16>(std::clamp(static_cast<int>(Y) + G, -128, 127)) + addval;
+      B = static_cast<s16>(std::clamp(static_cast<int>(Y) + B, -128, 127)) + addval;
+
+      rgb[(x + xx) + ((y + yy) * 16)] = ZeroExtend32(static_cast<u16>(R)) | (ZeroExtend32(static_cast<u16>(G)) << 8) |
+                                        (ZeroExtend32(static_cast<u16>(B)) << 16);
+    }
+  }
+}
+
+/// Packs a 16x16 block to 15-bit colour, two pixels per word. alpha is the value for bit 15.
+ALWAYS_INLINE static void PackRGB15Scalar(u32* out, const u32* rgb, u32 alpha)
+{
+#define E8TO5(color) (std::min<u32>((((color) + 4) >> 3), 0x1F))
+  for (u32 i = 0; i < 256; i += 2)
+  {
+    u32 color = rgb[i];
+    u32 r = E8TO5(color & 0xFFu);
+    u32 g = E8TO5((color >> 8) & 0xFFu);
+    u32 b = E8TO5((color >> 16) & 0xFFu);
+    const u32 color15a = r | (g << 5) | (b << 10) | alpha;
+
+    color = rgb[i + 1];
+    r = E8TO5(color & 0xFFu);
+    g = E8TO5((color >> 8) & 0xFFu);
+    b = E8TO5((color >> 16) & 0xFFu);
+    const u32 color15b = r | (g << 5) | (b << 10) | alpha;
+
+    *(out++) = color15a | (color15b << 16);
+  }
+#undef E8TO5
+}
+
+#if defined(CPU_ARCH_SSE)
+
+namespace detail {
+
+// (value + 0xfff) / 0x2000, rounding towards zero like the scalar division.
+ALWAYS_INLINE static __m128i IDCTRound(__m128i sum)
+{
+  const __m128i value = _mm_add_epi32(sum, _mm_set1_epi32(0xfff));
+  return _mm_srai_epi32(_mm_add_epi32(value, _mm_srli_epi32(_mm_srai_epi32(value, 31), 19)), 13);
+}
+
+// Computes out[Y][x] = sum(in[z][Y] * scale[z][x]). pairs holds in[2n][y], in[2n + 1][y] for y 0-3 and 4-7.
+template<u32 Y>
+ALWAYS_INLINE static __m128i IDCTRow(const __m128i* pairs, const __m128i* scale)
+{
+  __m128i lo = _mm_setzero_si128();
+  __m128i hi = _mm_setzero_si128();
+  for (u32 n = 0; n < 4; n++)
+  {
+    const __m128i in = _mm_shuffle_epi32(pairs[n * 2 + (Y / 4)], _MM_SHUFFLE(Y % 4, Y % 4, Y % 4, Y % 4));
+    lo = _mm_add_epi32(lo, _mm_madd_epi16(in, scale[n * 2 + 0]));
+    hi = _mm_add_epi32(hi, _mm_madd_epi16(in, scale[n * 2 + 1]));
+  }
+
+  // Both passes stay well within 16 bits for coefficients in range, so the pack never saturates.
+  return _mm_packs_epi32(IDCTRound(lo), IDCTRound(hi));
+}
+
+ALWAYS_INLINE static void IDCTPass(__m128i* rows, const __m128i* scale)
+{
+  __m128i pairs[8];
+  for (u32 n = 0; n < 4; n++)
+  {
+    pairs[n * 2 + 0] = _mm_unpacklo_epi16(rows[n * 2], rows[n * 2 + 1]);
+    pairs[n * 2 + 1] = _mm_unpackhi_epi16(rows[n * 2], rows[n * 2 + 1]);
+  }
+
+  rows[0] = IDCTRow<0>(pairs, scale);
+  rows[1] = IDCTRow<1>(pairs, scale);
+  rows[2] = IDCTRow<2>(pairs, scale);
+  rows[3] = IDCTRow<3>(pairs, scale);
+  rows[4] = IDCTRow<4>(pairs, scale);
+  rows[5] = IDCTRow<5>(pairs, scale);
+  rows[6] = IDCTRow<6>(pairs, scale);
+  rows[7] = IDCTRow<7>(pairs, scale);
+}
+
+} // namespace detail
+
+ALWAYS_INLINE static void IDCT(s16* blk, const IDCTTable& table)
+{
+  __m128i scale[8];
+  for (u32 i = 0; i < 8; i++)
+    scale[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(&table.interleaved[i * 8]));
+
+  __m128i rows[8];
+  for (u32 i = 0; i < 8; i++)
+    rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[i * 8]));
+
+  detail::IDCTPass(rows, scale);
+  detail::IDCTPass(rows, scale);
+
+  const __m128i min = _mm_set1_epi16(-128);
+  const __m128i max = _mm_set1_epi16(127);
+  for (u32 i = 0; i < 8; i++)
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&blk[i * 8]), _mm_min_epi16(_mm_max_epi16(rows[i], min), max));
+}
+
+ALWAYS_INLINE static void YUVToRGB(u32* rgb, u32 xx, u32 yy, const s16* Crblk, const s16* Cbblk, const s16* Yblk,
+                                   s16 addval)
+{
+  const __m128i vaddval = _mm_set1_epi16(addval);
+  const __m128i min = _mm_set1_epi16(-128);
+  const __m128i max = _mm_set1_epi16(127);
+
+  // Each chroma row covers two rows of luma, and each chroma sample two pixels.
+  for (u32 cy = 0; cy < 4; cy++)
+  {
+    const u32 chroma_offset = (xx / 2) + ((yy / 2) + cy) * 8;
+    const __m128i cr = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&Crblk[chroma_offset]));
+    const __m128i cb = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&Cbblk[chroma_offset]));
+    const __m128 fr = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(cr, cr), 16));
+    const __m128 fb = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(cb, cb), 16));
+
+    // Same operations in the same order as the scalar version, no fused multiply-add.
+    const __m128i g4 = _mm_cvttps_epi32(
+      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.3437f), fb), _mm_mul_ps(_mm_set1_ps(-0.7143f), fr)));
+    const __m128i r4 = _mm_cvttps_epi32(_mm_mul_ps(_mm_set1_ps(1.402f), fr));
+    const __m128i b4 = _mm_cvttps_epi32(_mm_mul_ps(_mm_set1_ps(1.772f), fb));
+
+    // [c0, c0, c1, c1, c2, c2, c3, c3]
+    const __m128i r = _mm_packs_epi32(_mm_unpacklo_epi32(r4, r4), _mm_unpackhi_epi32(r4, r4));
+    const __m128i g = _mm_packs_epi32(_mm_unpacklo_epi32(g4, g4), _mm_unpackhi_epi32(g4, g4));
+    const __m128i b = _mm_packs_epi32(_mm_unpacklo_epi32(b4, b4), _mm_unpackhi_epi32(b4, b4));
+
+    for (u32 i = 0; i < 2; i++)
+    {
+      const u32 y = cy * 2 + i;
+      const __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Yblk[y * 8]));
+      const __m128i R = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(luma, r), min), max), vaddval);
+      const __m128i G = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(luma, g), min), max), vaddval);
+      const __m128i B = _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(luma, b), min), max), vaddval);
+
+      // Channels are zero extended from 16 bits and overlap when negative, same as the scalar version.
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i lo = _mm_or_si128(
+        _mm_or_si128(_mm_unpacklo_epi16(R, zero), _mm_slli_epi32(_mm_unpacklo_epi16(G, zero), 8)),
+        _mm_slli_epi32(_mm_unpacklo_epi16(B, zero), 16));
+      const __m128i hi = _mm_or_si128(
+        _mm_or_si128(_mm_unpackhi_epi16(R, zero), _mm_slli_epi32(_mm_unpackhi_epi16(G, zero), 8)),
+        _mm_slli_epi32(_mm_unpackhi_epi16(B, zero), 16));
+
+      u32* out = &rgb[xx + (y + yy) * 16];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), lo);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), hi);
+    }
+  }
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+namespace detail {
+
+ALWAYS_INLINE static int32x4_t IDCTRound(int32x4_t sum)
+{
+  const int32x4_t value = vaddq_s32(sum, vdupq_n_s32(0xfff));
+  const int32x4_t bias = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(value, 31)), 19));
+  return vshrq_n_s32(vaddq_s32(value, bias), 13);
+}
+
+ALWAYS_INLINE static void IDCTPass(s16* out, const s16* in, const int16x8_t* scale)
+{
+  for (u32 y = 0; y < 8; y++)
+  {
+    int32x4_t lo = vdupq_n_s32(0);
+    int32x4_t hi = vdupq_n_s32(0);
+    for (u32 z = 0; z < 8; z++)
+    {
+      const s16 value = in[y + z * 8];
+      lo = vmlal_n_s16(lo, vget_low_s16(scale[z]), value);
+      hi = vmlal_high_n_s16(hi, scale[z], value);
+    }
+
+    vst1q_s16(&out[y * 8], vcombine_s16(vmovn_s32(IDCTRound(lo)), vmovn_s32(IDCTRound(hi))));
+  }
+}
+
+} // namespace detail
+
+ALWAYS_INLINE static void IDCT(s16* blk, const IDCTTable& table)
+{
+  int16x8_t scale[8];
+  for (u32 i = 0; i < 8; i++)
+    scale[i] = vld1q_s16(&table.scale[i * 8]);
+
+  alignas(16) std::array<s16, 64> temp;
+  detail::IDCTPass(temp.data(), blk, scale);
+  detail::IDCTPass(blk, temp.data(), scale);
+
+  const int16x8_t min = vdupq_n_s16(-128);
+  const int16x8_t max = vdupq_n_s16(127);
+  for (u32 i = 0; i < 8; i++)
+    vst1q_s16(&blk[i * 8], vminq_s16(vmaxq_s16(vld1q_s16(&blk[i * 8]), min), max));
+}
+
+ALWAYS_INLINE static void YUVToRGB(u32* rgb, u32 xx, u32 yy, const s16* Crblk, const s16* Cbblk, const s16* Yblk,
+                                   s16 addval)
+{
+  const int16x8_t vaddval = vdupq_n_s16(addval);
+  const int16x8_t min = vdupq_n_s16(-128);
+  const int16x8_t max = vdupq_n_s16(127);
+
+  for (u32 cy = 0; cy < 4; cy++)
+  {
+    const u32 chroma_offset = (xx / 2) + ((yy / 2) + cy) * 8;
+    const float32x4_t fr = vcvtq_f32_s32(vmovl_s16(vld1_s16(&Crblk[chroma_offset])));
+    const float32x4_t fb = vcvtq_f32_s32(vmovl_s16(vld1_s16(&Cbblk[chroma_offset])));
+
+    // Separate multiplies and add rather than vfma, to match the scalar version.
+    const int32x4_t g4 = vcvtq_s32_f32(vaddq_f32(vmulq_n_f32(fb, -0.3437f), vmulq_n_f32(fr, -0.7143f)));
+    const int32x4_t r4 = vcvtq_s32_f32(vmulq_n_f32(fr, 1.402f));
+    const int32x4_t b4 = vcvtq_s32_f32(vmulq_n_f32(fb, 1.772f));
+
+    const int16x8_t r = vcombine_s16(vmovn_s32(vzip1q_s32(r4, r4)), vmovn_s32(vzip2q_s32(r4, r4)));
+    const int16x8_t g = vcombine_s16(vmovn_s32(vzip1q_s32(g4, g4)), vmovn_s32(vzip2q_s32(g4, g4)));
+    const int16x8_t b = vcombine_s16(vmovn_s32(vzip1q_s32(b4, b4)), vmovn_s32(vzip2q_s32(b4, b4)));
+
+    for (u32 i = 0; i < 2; i++)
+    {
+      const u32 y = cy * 2 + i;
+      const int16x8_t luma = vld1q_s16(&Yblk[y * 8]);
+      const uint16x8_t R =
+        vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(vaddq_s16(luma, r), min), max), vaddval));
+      const uint16x8_t G =
+        vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(vaddq_s16(luma, g), min), max), vaddval));
+      const uint16x8_t B =
+        vreinterpretq_u16_s16(vaddq_s16(vminq_s16(vmaxq_s16(vaddq_s16(luma, b), min), max), vaddval));
+
+      const uint32x4_t lo = vorrq_u32(vorrq_u32(vmovl_u16(vget_low_u16(R)), vshlq_n_u32(vmovl_u16(vget_low_u16(G)), 8)),
+                                      vshlq_n_u32(vmovl_u16(vget_low_u16(B)), 16));
+      const uint32x4_t hi = vorrq_u32(vorrq_u32(vmovl_high_u16(R), vshlq_n_u32(vmovl_high_u16(G), 8)),
+                                      vshlq_n_u32(vmovl_high_u16(B), 16));
+
+      u32* out = &rgb[xx + (y + yy) * 16];
+      vst1q_u32(out, lo);
+      vst1q_u32(out + 4, hi);
+    }
+  }
+}
+
+#else
+
+ALWAYS_INLINE static void IDCT(s16* blk, const IDCTTable& table)
+{
+  IDCTScalar(blk, table);
+}
+
+ALWAYS_INLINE static void YUVToRGB(u32* rgb, u32 xx, u32 yy, const s16* Crblk, const s16* Cbblk, const s16* Yblk,
+                                   s16 addval)
+{
+  YUVToRGBScalar(rgb, xx, yy, Crblk, Cbblk, Yblk, addval);
+}
+
+#endif
+
+#if defined(CPU_ARCH_SSE)
+
+namespace detail {
+
+// min((c + 4) >> 3, 0x1F) of each 8-bit channel. The result is at most 0x20, so subtracting bit 5 clamps it.
+ALWAYS_INLINE static __m128i PackRGB15Pixels(__m128i color, __m128i alpha)
+{
+  const __m128i mask = _mm_set1_epi32(0xFF);
+  const __m128i four = _mm_set1_epi32(4);
+  __m128i r = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(color, mask), four), 3);
+  __m128i g = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(_mm_srli_epi32(color, 8), mask), four), 3);
+  __m128i b = _mm_srli_epi32(_mm_add_epi32(_mm_and_si128(_mm_srli_epi32(color, 16), mask), four), 3);
+  r = _mm_sub_epi32(r, _mm_srli_epi32(r, 5));
+  g = _mm_sub_epi32(g, _mm_srli_epi32(g, 5));
+  b = _mm_sub_epi32(b, _mm_srli_epi32(b, 5));
+  const __m128i c15 = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 5)), _mm_or_si128(_mm_slli_epi32(b, 10), alpha));
+
+  // [p0 | p1 << 16, -, p2 | p3 << 16, -]
+  return _mm_or_si128(c15, _mm_srli_epi64(c15, 16));
+}
+
+} // namespace detail
+
+ALWAYS_INLINE static void PackRGB15(u32* out, const u32* rgb, u32 alpha)
+{
+  const __m128i valpha = _mm_set1_epi32(alpha);
+  for (u32 i = 0; i < 256; i += 8)
+  {
+    const __m128i lo = detail::PackRGB15Pixels(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&rgb[i])), valpha);
+    const __m128i hi = detail::PackRGB15Pixels(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&rgb[i + 4])), valpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i / 2]),
+                     _mm_unpacklo_epi64(_mm_shuffle_epi32(lo, _MM_SHUFFLE(3, 1, 2, 0)),
+                                        _mm_shuffle_epi32(hi, _MM_SHUFFLE(3, 1, 2, 0))));
+  }
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+ALWAYS_INLINE static void PackRGB15(u32* out, const u32* rgb, u32 alpha)
+{
+  const uint32x4_t mask = vdupq_n_u32(0xFF);
+  const uint32x4_t four = vdupq_n_u32(4);
+  const uint32x4_t max = vdupq_n_u32(0x1F);
+  const uint32x4_t valpha = vdupq_n_u32(alpha);
+  for (u32 i = 0; i < 256; i += 4)
+  {
+    const uint32x4_t color = vld1q_u32(&rgb[i]);
+    const uint32x4_t r = vminq_u32(vshrq_n_u32(vaddq_u32(vandq_u32(color, mask), four), 3), max);
+    const uint32x4_t g = vminq_u32(vshrq_n_u32(vaddq_u32(vandq_u32(vshrq_n_u32(color, 8), mask), four), 3), max);
+    const uint32x4_t b = vminq_u32(vshrq_n_u32(vaddq_u32(vandq_u32(vshrq_n_u32(color, 16), mask), four), 3), max);
+    const uint32x4_t c15 = vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 5)), vorrq_u32(vshlq_n_u32(b, 10), valpha));
+
+    // Even pixels in the low halves, odd pixels in the high halves.
+    vst1_u32(&out[i / 2], vreinterpret_u32_u16(vmovn_u32(c15)));
+  }
+}
+
+#else
+
+ALWAYS_INLINE static void PackRGB15(u32* out, const u32* rgb, u32 alpha)
+{
+  PackRGB15Scalar(out, rgb, alpha);
+}
+
+#endif
+
+} // namespace MDEC::Kernels
@@ -14,13 +14,40 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 
 #include "IconsFontAwesome5.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <mutex>
 
 Log_SetChannel(MemoryCard);
 
+namespace {
+struct PendingSave
+{
+  std::string filename;
+  std::unique_ptr<MemoryCardImage::DataArray> data;
+  bool display_osd_message;
+};
+} // namespace
+
+static void WritePendingSave(const PendingSave& save);
+
+// Slow storage makes a 128KB write long enough to hitch, so saves are written by a background thread. A save queued
+// while an older one for the same file is still waiting replaces it, since only the latest contents matter.
+static Threading::Thread s_save_thread;
+static std::mutex s_save_mutex;
+static std::condition_variable s_save_wake_cv;
+static std::condition_variable s_save_done_cv;
+static std::deque<PendingSave> s_save_queue;
+static std::string s_save_busy_filename;
+static bool s_save_shutdown = false;
+static bool s_save_thread_running = false;
+
 MemoryCard::MemoryCard()
 {
   m_FLAG.no_write_yet = true;
@@ -301,6 +328,8 @@ void MemoryCard::Format()
 
 bool MemoryCard::LoadFromFile()
 {
+  // The file may be reopened before a save from the previous instance has landed.
+  WaitForPendingSave(m_filename);
   return MemoryCardImage::LoadFromFile(&m_data, m_filename.c_str());
 }
 
@@ -316,35 +345,104 @@ bool MemoryCard::SaveIfChanged(bool display_osd_message)
   if (m_filename.empty())
     return false;
 
-  std::string osd_key;
-  std::string display_name;
-  if (display_osd_message)
+  StartSaveThread();
+
+  std::unique_lock lock(s_save_mutex);
+  auto iter = std::find_if(s_save_queue.begin(), s_save_queue.end(),
+                           [this](const PendingSave& save) { return (save.filename == m_filename); });
+  if (iter != s_save_queue.end())
   {
-    osd_key = fmt::format("memory_card_save_{}", m_filename);
-    display_name = FileSystem::GetDisplayNameFromPath(m_filename);
+    *iter->data = m_data;
+    iter->display_osd_message |= display_osd_message;
+    return true;
   }
 
-  if (!MemoryCardImage::SaveToFile(m_data, m_filename.c_str()))
+  s_save_queue.push_back(
+    PendingSave{m_filename, std::make_unique<MemoryCardImage::DataArray>(m_data), display_osd_message});
+  lock.unlock();
+  s_save_wake_cv.notify_one();
+  return true;
+}
+
+void MemoryCard::StartSaveThread()
+{
+  if (s_save_thread_running)
+    return;
+
+  s_save_shutdown = false;
+  s_save_thread_running = true;
+  s_save_thread.Start(&MemoryCard::SaveThreadEntryPoint);
+}
+
+void MemoryCard::StopSaveThread()
+{
+  if (!s_save_thread_running)
+    return;
+
   {
-    if (display_osd_message)
-    {
-      Host::AddIconOSDMessage(
-        std::move(osd_key), ICON_FA_SD_CARD,
-        fmt::format(TRANSLATE_FS("OSDMessage", "Failed to save memory card to '{}'."), Path::GetFileName(display_name)),
-        20.0f);
-    }
+    std::unique_lock lock(s_save_mutex);
+    s_save_shutdown = true;
+  }
+  s_save_wake_cv.notify_one();
+  s_save_thread.Join();
+  s_save_thread_running = false;
+}
 
-    return false;
+void MemoryCard::WaitForPendingSave(const std::string& filename)
+{
+  std::unique_lock lock(s_save_mutex);
+  s_save_done_cv.wait(lock, [&filename]() {
+    return (s_save_busy_filename != filename &&
+            std::none_of(s_save_queue.begin(), s_save_queue.end(),
+                         [&filename](const PendingSave& save) { return (save.filename == filename); }));
+  });
+}
+
+void MemoryCard::SaveThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Memory Card Writer");
+
+  std::unique_lock lock(s_save_mutex);
+  for (;;)
+  {
+    s_save_wake_cv.wait(lock, []() { return s_save_shutdown || !s_save_queue.empty(); });
+    if (s_save_queue.empty())
+      break;
+
+    PendingSave save = std::move(s_save_queue.front());
+    s_save_queue.pop_front();
+    s_save_busy_filename = save.filename;
+    lock.unlock();
+
+    WritePendingSave(save);
+
+    lock.lock();
+    s_save_busy_filename.clear();
+    s_save_done_cv.notify_all();
   }
+}
 
-  if (display_osd_message)
+void WritePendingSave(const PendingSave& save)
+{
+  // SaveToFile() writes to a temporary file and renames it over the card, so a crash never leaves a torn image.
+  const bool result = MemoryCardImage::SaveToFile(*save.data, save.filename.c_str());
+  if (!save.display_osd_message)
+    return;
+
+  std::string osd_key = fmt::format("memory_card_save_{}", save.filename);
+  const std::string display_name = FileSystem::GetDisplayNameFromPath(save.filename);
+  if (!result)
   {
     Host::AddIconOSDMessage(
       std::move(osd_key), ICON_FA_SD_CARD,
-      fmt::format(TRANSLATE_FS("OSDMessage", "Saved memory card to '{}'."), Path::GetFileName(display_name)), 5.0f);
+      fmt::format(TRANSLATE_FS("OSDMessage", "Failed to save memory card to '{}'."), Path::GetFileName(display_name)),
+      20.0f);
+    return;
   }
 
-  return true;
+  Host::AddIconOSDMessage(
+    std::move(osd_key), ICON_FA_SD_CARD,
+    fmt::format(TRANSLATE_FS("OSDMessage", "Saved memory card to '{}'."), Path::GetFileName(display_name)), 5.0f);
 }
 
 void MemoryCard::QueueFileSave()
@@ -38,6 +38,9 @@ public:
 
   void Format();
 
+  /// Waits for saves which are still being written in the background, and stops the writer thread.
+  static void StopSaveThread();
+
 private:
   enum : u32
   {
@@ -83,6 +86,10 @@ private:
 
   static TickCount GetSaveDelayInTicks();
 
+  static void StartSaveThread();
+  static void SaveThreadEntryPoint();
+  static void WaitForPendingSave(const std::string& filename);
+
   bool LoadFromFile();
   bool SaveIfChanged(bool display_osd_message);
   void QueueFileSave();
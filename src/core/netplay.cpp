@@ -0,0 +1,435 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "netplay.h"
+#include "controller.h"
+#include "spu.h"
+#include "system.h"
+
+#include "util/gpu_texture.h"
+
+#include "common/byte_stream.h"
+#include "common/log.h"
+
+#include "xxhash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+Log_SetChannel(Netplay);
+
+namespace Netplay {
+namespace {
+struct LogEntry
+{
+  u32 frame;
+  bool has_local;
+  bool has_remote;
+  bool applied;
+  FrameInput local;
+  FrameInput remote;
+  FrameInput applied_remote;
+};
+
+struct StateHash
+{
+  u32 frame;
+  u64 hash;
+};
+} // namespace
+
+static constexpr u32 NO_FRAME = std::numeric_limits<u32>::max();
+static constexpr u32 MAX_INPUT_DELAY = 16;
+static constexpr u32 MAX_ROLLBACK_FRAMES = 64;
+static constexpr u32 NUM_STATE_HASHES = 16;
+
+// How long to wait for a remote which has fallen outside the rollback window, before running on regardless.
+static constexpr auto STALL_TIMEOUT = std::chrono::milliseconds(100);
+
+static LogEntry& GetLogEntry(u32 frame);
+static FrameInput GetPredictedRemoteInput();
+static void ApplyInputToController(u32 port, const FrameInput& input);
+static void ApplyInputs(u32 frame);
+static bool SaveSnapshot(u32 frame);
+static bool LoadSnapshot(u32 frame);
+static void WaitForRemote();
+static void UpdateStateHashes();
+static void CheckStateHash(u32 frame);
+
+static u32 s_local_port = 0;
+static u32 s_remote_port = 1;
+static u32 s_input_delay = 0;
+static u32 s_max_rollback_frames = 0;
+
+// Only touched by the CPU thread.
+static u32 s_frame = 0;
+static u32 s_resimulate_until = NO_FRAME;
+static u32 s_next_hash_frame = 0;
+static u32 s_rollback_count = 0;
+static FrameInput s_live_input;
+static std::vector<System::MemorySaveState> s_snapshots;
+static std::vector<u32> s_snapshot_frames;
+
+// Shared with the transport.
+static std::mutex s_mutex;
+static std::condition_variable s_remote_cv;
+static std::array<LogEntry, INPUT_LOG_SIZE> s_log;
+static u32 s_next_remote_frame = 0;
+static u32 s_rollback_frame = NO_FRAME;
+static std::array<StateHash, NUM_STATE_HASHES> s_local_hashes;
+static std::array<StateHash, NUM_STATE_HASHES> s_remote_hashes;
+static bool s_desynced = false;
+} // namespace Netplay
+
+bool Netplay::Internal::g_active = false;
+
+bool Netplay::Start(u32 local_port, u32 remote_port, u32 input_delay, u32 max_rollback_frames)
+{
+  if (!System::IsValid() || local_port >= NUM_CONTROLLER_AND_CARD_PORTS ||
+      remote_port >= NUM_CONTROLLER_AND_CARD_PORTS || local_port == remote_port || input_delay > MAX_INPUT_DELAY ||
+      max_rollback_frames == 0 || max_rollback_frames > MAX_ROLLBACK_FRAMES)
+  {
+    Log_ErrorPrintf("Invalid netplay session parameters.");
+    return false;
+  }
+
+  Stop();
+
+  s_local_port = local_port;
+  s_remote_port = remote_port;
+  s_input_delay = input_delay;
+  s_max_rollback_frames = max_rollback_frames;
+  s_frame = 0;
+  s_resimulate_until = NO_FRAME;
+  s_next_hash_frame = 0;
+  s_rollback_count = 0;
+  s_live_input = {};
+  s_snapshots = std::vector<System::MemorySaveState>(max_rollback_frames + 1);
+  s_snapshot_frames = std::vector<u32>(max_rollback_frames + 1, NO_FRAME);
+
+  {
+    std::unique_lock lock(s_mutex);
+    for (LogEntry& entry : s_log)
+      entry = {NO_FRAME, false, false, false, {}, {}, {}};
+    s_local_hashes.fill(StateHash{NO_FRAME, 0});
+    s_remote_hashes.fill(StateHash{NO_FRAME, 0});
+    s_next_remote_frame = 0;
+    s_rollback_frame = NO_FRAME;
+    s_desynced = false;
+
+    // Nothing was pressed in the frames before the first delayed input arrives.
+    for (u32 i = 0; i < input_delay; i++)
+      GetLogEntry(i).has_local = true;
+
+    if (!SaveSnapshot(0))
+    {
+      s_snapshots.clear();
+      s_snapshot_frames.clear();
+      return false;
+    }
+
+    ApplyInputs(0);
+    Internal::g_active = true;
+  }
+
+  Log_InfoPrintf("Netplay started: local port %u, remote port %u, %u frames of input delay, %u frames of rollback.",
+                 local_port + 1, remote_port + 1, input_delay, max_rollback_frames);
+  return true;
+}
+
+void Netplay::Stop()
+{
+  if (!Internal::g_active)
+    return;
+
+  {
+    std::unique_lock lock(s_mutex);
+    Internal::g_active = false;
+  }
+  s_remote_cv.notify_all();
+
+  if (s_resimulate_until != NO_FRAME)
+  {
+    s_resimulate_until = NO_FRAME;
+    SPU::SetAudioOutputMuted(false);
+  }
+
+  s_snapshots.clear();
+  s_snapshot_frames.clear();
+  Log_InfoPrintf("Netplay stopped at frame %u after %u rollbacks.", s_frame, s_rollback_count);
+}
+
+bool Netplay::SetLocalBindState(u32 pad, u32 bind_index, float value)
+{
+  if (!Internal::g_active)
+    return false;
+
+  // Only the first pad is played locally. Input for the others is dropped, so it can't bypass the session.
+  if (pad == 0 && bind_index < MAX_BIND_STATES)
+    s_live_input.bind_states[bind_index] = value;
+
+  return true;
+}
+
+Netplay::LogEntry& Netplay::GetLogEntry(u32 frame)
+{
+  LogEntry& entry = s_log[frame & (INPUT_LOG_SIZE - 1)];
+  if (entry.frame != frame)
+    entry = {frame, false, false, false, {}, {}, {}};
+
+  return entry;
+}
+
+Netplay::FrameInput Netplay::GetPredictedRemoteInput()
+{
+  // The remote most likely holds whatever it held in the last frame it confirmed.
+  if (s_next_remote_frame == 0)
+    return {};
+
+  const LogEntry& entry = s_log[(s_next_remote_frame - 1) & (INPUT_LOG_SIZE - 1)];
+  return (entry.frame == (s_next_remote_frame - 1) && entry.has_remote) ? entry.remote : FrameInput{};
+}
+
+void Netplay::ApplyInputToController(u32 port, const FrameInput& input)
+{
+  Controller* controller = System::GetController(port);
+  if (!controller)
+    return;
+
+  const Controller::ControllerInfo* info = Controller::GetControllerInfo(controller->GetType());
+  if (!info)
+    return;
+
+  for (const Controller::ControllerBindingInfo& bi : info->bindings)
+  {
+    if ((bi.type == InputBindingInfo::Type::Button || bi.type == InputBindingInfo::Type::Axis ||
+         bi.type == InputBindingInfo::Type::HalfAxis) &&
+        bi.bind_index < MAX_BIND_STATES)
+    {
+      controller->SetBindState(bi.bind_index, input.bind_states[bi.bind_index]);
+    }
+  }
+}
+
+void Netplay::ApplyInputs(u32 frame)
+{
+  LogEntry& entry = GetLogEntry(frame);
+  entry.applied_remote = entry.has_remote ? entry.remote : GetPredictedRemoteInput();
+  entry.applied = true;
+
+  ApplyInputToController(s_local_port, entry.has_local ? entry.local : FrameInput{});
+  ApplyInputToController(s_remote_port, entry.applied_remote);
+}
+
+bool Netplay::SaveSnapshot(u32 frame)
+{
+  const u32 slot = frame % static_cast<u32>(s_snapshots.size());
+  if (!System::SaveMemoryState(&s_snapshots[slot]))
+  {
+    Log_ErrorPrintf("Failed to save snapshot for frame %u.", frame);
+    s_snapshot_frames[slot] = NO_FRAME;
+    return false;
+  }
+
+  s_snapshot_frames[slot] = frame;
+  return true;
+}
+
+bool Netplay::LoadSnapshot(u32 frame)
+{
+  const u32 slot = frame % static_cast<u32>(s_snapshots.size());
+  return (s_snapshot_frames[slot] == frame && System::LoadMemoryState(s_snapshots[slot]));
+}
+
+void Netplay::WaitForRemote()
+{
+  // Running further ahead would drop the snapshot a rollback to the oldest unconfirmed frame needs.
+  std::unique_lock lock(s_mutex);
+  if ((s_frame - s_next_remote_frame) <= s_max_rollback_frames)
+    return;
+
+  if (!s_remote_cv.wait_for(lock, STALL_TIMEOUT, []() {
+        return !Internal::g_active || (s_frame - s_next_remote_frame) <= s_max_rollback_frames;
+      }))
+  {
+    Log_WarningPrintf("Remote is %u frames behind at frame %u, running outside the rollback window.",
+                      s_frame - s_next_remote_frame, s_frame);
+  }
+}
+
+bool Netplay::FrameDone()
+{
+  s_frame++;
+
+  if (s_resimulate_until != NO_FRAME)
+  {
+    if (s_frame < s_resimulate_until)
+    {
+      SaveSnapshot(s_frame);
+      std::unique_lock lock(s_mutex);
+      ApplyInputs(s_frame);
+      return true;
+    }
+
+    s_resimulate_until = NO_FRAME;
+    SPU::SetAudioOutputMuted(false);
+  }
+  else
+  {
+    // Sampled now, played input_delay frames from now, which gives the transport that long to deliver it.
+    {
+      std::unique_lock lock(s_mutex);
+      LogEntry& entry = GetLogEntry(s_frame + s_input_delay);
+      entry.local = s_live_input;
+      entry.has_local = true;
+    }
+
+    WaitForRemote();
+  }
+
+  u32 rollback_frame;
+  {
+    std::unique_lock lock(s_mutex);
+    rollback_frame = s_rollback_frame;
+    s_rollback_frame = NO_FRAME;
+  }
+
+  if (rollback_frame < s_frame)
+  {
+    if (!LoadSnapshot(rollback_frame))
+    {
+      Log_ErrorPrintf("No snapshot for frame %u to roll back to, the session has desynced.", rollback_frame);
+      std::unique_lock lock(s_mutex);
+      s_desynced = true;
+    }
+    else
+    {
+      // Run the frames since with the corrected input, without the user seeing or hearing them.
+      Log_DevPrintf("Rolling back %u frames to frame %u", s_frame - rollback_frame, rollback_frame);
+      s_resimulate_until = s_frame;
+      s_frame = rollback_frame;
+      s_rollback_count++;
+      SPU::SetAudioOutputMuted(true);
+
+      std::unique_lock lock(s_mutex);
+      ApplyInputs(s_frame);
+      return true;
+    }
+  }
+
+  SaveSnapshot(s_frame);
+
+  std::unique_lock lock(s_mutex);
+  ApplyInputs(s_frame);
+  UpdateStateHashes();
+  return false;
+}
+
+void Netplay::UpdateStateHashes()
+{
+  // A snapshot is final once every input before it has been confirmed, and no rollback before it is pending.
+  while (s_next_hash_frame <= s_frame && s_next_hash_frame <= s_next_remote_frame &&
+         (s_rollback_frame == NO_FRAME || s_rollback_frame >= s_next_hash_frame))
+  {
+    const u32 frame = s_next_hash_frame;
+    s_next_hash_frame += STATE_HASH_INTERVAL;
+
+    const u32 slot = frame % static_cast<u32>(s_snapshots.size());
+    if (s_snapshot_frames[slot] != frame)
+      continue;
+
+    const GrowableMemoryByteStream* stream = s_snapshots[slot].state_stream.get();
+    const u64 hash = XXH64(stream->GetMemoryPointer(), static_cast<size_t>(stream->GetSize()), 0);
+    s_local_hashes[(frame / STATE_HASH_INTERVAL) % NUM_STATE_HASHES] = StateHash{frame, hash};
+    CheckStateHash(frame);
+  }
+}
+
+void Netplay::CheckStateHash(u32 frame)
+{
+  const StateHash& local = s_local_hashes[(frame / STATE_HASH_INTERVAL) % NUM_STATE_HASHES];
+  const StateHash& remote = s_remote_hashes[(frame / STATE_HASH_INTERVAL) % NUM_STATE_HASHES];
+  if (local.frame != frame || remote.frame != frame || local.hash == remote.hash || s_desynced)
+    return;
+
+  Log_ErrorPrintf("Desync detected at frame %u: local state %016llX, remote state %016llX.", frame,
+                  static_cast<unsigned long long>(local.hash), static_cast<unsigned long long>(remote.hash));
+  s_desynced = true;
+}
+
+std::optional<Netplay::FrameInput> Netplay::GetLocalInput(u32 frame)
+{
+  std::unique_lock lock(s_mutex);
+  const LogEntry& entry = s_log[frame & (INPUT_LOG_SIZE - 1)];
+  if (!Internal::g_active || entry.frame != frame || !entry.has_local)
+    return std::nullopt;
+
+  return entry.local;
+}
+
+void Netplay::AddRemoteInput(u32 frame, const FrameInput& input)
+{
+  std::unique_lock lock(s_mutex);
+
+  // Anything older than the confirmed frames, or far enough ahead to overwrite them in the log, is garbage.
+  if (!Internal::g_active || frame < s_next_remote_frame || (frame - s_next_remote_frame) >= (INPUT_LOG_SIZE / 2))
+    return;
+
+  LogEntry& entry = GetLogEntry(frame);
+  if (entry.has_remote)
+    return;
+
+  entry.remote = input;
+  entry.has_remote = true;
+  if (entry.applied && entry.applied_remote != input)
+    s_rollback_frame = std::min(s_rollback_frame, frame);
+
+  for (;;)
+  {
+    const LogEntry& next = s_log[s_next_remote_frame & (INPUT_LOG_SIZE - 1)];
+    if (next.frame != s_next_remote_frame || !next.has_remote)
+      break;
+
+    s_next_remote_frame++;
+  }
+
+  lock.unlock();
+  s_remote_cv.notify_one();
+}
+
+std::optional<u64> Netplay::GetLocalStateHash(u32 frame)
+{
+  std::unique_lock lock(s_mutex);
+  const StateHash& hash = s_local_hashes[(frame / STATE_HASH_INTERVAL) % NUM_STATE_HASHES];
+  return (hash.frame == frame) ? std::optional<u64>(hash.hash) : std::nullopt;
+}
+
+void Netplay::AddRemoteStateHash(u32 frame, u64 hash)
+{
+  if ((frame % STATE_HASH_INTERVAL) != 0)
+    return;
+
+  std::unique_lock lock(s_mutex);
+  s_remote_hashes[(frame / STATE_HASH_INTERVAL) % NUM_STATE_HASHES] = StateHash{frame, hash};
+  CheckStateHash(frame);
+}
+
+u32 Netplay::GetCurrentFrame()
+{
+  return s_frame;
+}
+
+u32 Netplay::GetRollbackCount()
+{
+  return s_rollback_count;
+}
+
+bool Netplay::HasDesynced()
+{
+  std::unique_lock lock(s_mutex);
+  return s_desynced;
+}
@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "types.h"
+
+#include <array>
+#include <optional>
+
+/// Rollback core for two player netplay. Each frame runs with the local input delayed by a few frames, and the remote
+/// input predicted from the last one received. When the real remote input for an earlier frame turns out to differ,
+/// the state from the start of that frame is restored from a memory save state, and the frames since are run again
+/// with the corrected input. Both sides hash their confirmed states, so a desync is noticed rather than silently
+/// diverging. Exchanging inputs and hashes is left to the transport, which can call in from any thread.
+namespace Netplay {
+
+/// Bind states recorded per controller and frame, enough for every controller type.
+static constexpr u32 MAX_BIND_STATES = 32;
+
+/// Frames of input kept in the log, must be a power of two larger than any rollback window plus the input delay.
+static constexpr u32 INPUT_LOG_SIZE = 256;
+
+/// Confirmed states are hashed every this many frames.
+static constexpr u32 STATE_HASH_INTERVAL = 30;
+
+struct FrameInput
+{
+  std::array<float, MAX_BIND_STATES> bind_states{};
+
+  bool operator==(const FrameInput& rhs) const = default;
+};
+
+namespace Internal {
+extern bool g_active;
+} // namespace Internal
+
+ALWAYS_INLINE static bool IsActive()
+{
+  return Internal::g_active;
+}
+
+/// Starts a session on the running system, which needs to be in the same state on both sides. The local player's
+/// input goes to local_port, the remote player's to remote_port. No more than max_rollback_frames can be resimulated,
+/// the emulator stalls when the remote falls further behind than that.
+bool Start(u32 local_port, u32 remote_port, u32 input_delay, u32 max_rollback_frames);
+void Stop();
+
+/// Routes input for pad 0 to the local player while a session is active. Returns false if the input isn't consumed.
+bool SetLocalBindState(u32 pad, u32 bind_index, float value);
+
+/// Called by the system at the end of each frame. Returns true when the next frame is a resimulation, which shouldn't
+/// be presented or polled for input. Only valid on the CPU thread.
+bool FrameDone();
+
+/// Input the transport should send to the remote, once it has been sampled.
+std::optional<FrameInput> GetLocalInput(u32 frame);
+
+/// Input received from the remote. Frames which have already run with a different prediction are rolled back.
+void AddRemoteInput(u32 frame, const FrameInput& input);
+
+/// State hashes are only produced for frames where STATE_HASH_INTERVAL divides the frame number.
+std::optional<u64> GetLocalStateHash(u32 frame);
+void AddRemoteStateHash(u32 frame, u64 hash);
+
+u32 GetCurrentFrame();
+u32 GetRollbackCount();
+bool HasDesynced();
+
+} // namespace Netplay
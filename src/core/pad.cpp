@@ -4,14 +4,17 @@
 #include "pad.h"
 #include "controller.h"
 #include "host.h"
+#include "input_movie.h"
 #include "interrupt_controller.h"
 #include "memory_card.h"
 #include "multitap.h"
+#include "netplay.h"
 #include "save_state_version.h"
 #include "system.h"
 #include "types.h"
 
 #include "util/imgui_manager.h"
+#include "util/input_manager.h"
 #include "util/state_wrapper.h"
 
 #include "common/bitfield.h"
@@ -99,7 +102,9 @@ static void SoftReset();
 static void UpdateJoyStat();
 static void TransferEvent(void*, TickCount ticks, TickCount ticks_late);
 static void BeginTransfer();
-static void DoTransfer(TickCount ticks_late);
+static TickCount DoTransfer();
+static void ReceiveTransfer();
+static void UpdateTransfer();
 static void DoACK();
 static void EndTransfer();
 static void ResetDeviceTransferState();
@@ -130,6 +135,12 @@ static u8 s_transmit_value = 0;
 static bool s_receive_buffer_full = false;
 static bool s_transmit_buffer_full = false;
 
+// The device's response, worked out when the transfer begins. The receive buffer isn't filled until the transfer
+// time has passed, and the same event then carries on to the ACK, so each byte only needs a single event.
+static u8 s_pending_receive_value = 0;
+static bool s_pending_ack = false;
+static TickCount s_pending_receive_ticks = 0;
+
 static u32 s_last_memory_card_transfer_frame = 0;
 static std::unique_ptr<GrowableMemoryByteStream> s_memory_card_backup;
 static std::unique_ptr<MemoryCard> s_dummy_card;
@@ -521,6 +532,21 @@ bool Pad::DoState(StateWrapper& sw, bool is_memory_state)
   sw.Do(&s_receive_buffer_full);
   sw.Do(&s_transmit_buffer_full);
 
+  if (sw.GetVersion() >= 64)
+  {
+    sw.Do(&s_pending_receive_value);
+    sw.Do(&s_pending_ack);
+    sw.Do(&s_pending_receive_ticks);
+  }
+  else if (sw.IsReading() && s_state == State::Transmitting)
+  {
+    // Older states hadn't sent the byte to the device yet. Their event only covers the transfer, so the ACK follows it
+    // straight away.
+    s_transmit_value = s_transmit_buffer;
+    DoTransfer();
+    s_pending_receive_ticks = 0;
+  }
+
   if (sw.IsReading() && IsTransmitting())
     s_transfer_event->Activate();
 
@@ -571,7 +597,7 @@ u32 Pad::ReadRegister(u32 offset)
     case 0x00: // JOY_DATA
     {
       if (IsTransmitting())
-        s_transfer_event->InvokeEarly();
+        UpdateTransfer();
 
       const u8 value = s_receive_buffer_full ? s_receive_buffer : 0xFF;
       Log_DebugPrintf("JOY_DATA (R) -> 0x%02X%s", ZeroExtend32(value), s_receive_buffer_full ? "" : "(EMPTY)");
@@ -585,7 +611,7 @@ u32 Pad::ReadRegister(u32 offset)
     case 0x04: // JOY_STAT
     {
       if (IsTransmitting())
-        s_transfer_event->InvokeEarly();
+        UpdateTransfer();
 
       const u32 bits = s_JOY_STAT.bits;
       s_JOY_STAT.ACKINPUT = false;
@@ -720,8 +746,8 @@ void Pad::UpdateJoyStat()
 void Pad::TransferEvent(void*, TickCount ticks, TickCount ticks_late)
 {
   if (s_state == State::Transmitting)
-    DoTransfer(ticks_late);
-  else
+    ReceiveTransfer();
+  if (s_state == State::WaitingForACK)
     DoACK();
 }
 
@@ -750,10 +776,13 @@ void Pad::BeginTransfer()
   // until after (4) and (5) have been completed.
 
   s_state = State::Transmitting;
-  s_transfer_event->SetPeriodAndSchedule(GetTransferTicks());
+  const TickCount ack_ticks = DoTransfer();
+
+  s_pending_receive_ticks = GetTransferTicks();
+  s_transfer_event->SetPeriodAndSchedule(s_pending_receive_ticks + ack_ticks);
 }
 
-void Pad::DoTransfer(TickCount ticks_late)
+TickCount Pad::DoTransfer()
 {
   Log_DebugPrintf("Transferring slot %d", s_JOY_CTRL.SLOT.GetValue());
 
@@ -773,6 +802,13 @@ void Pad::DoTransfer(TickCount ticks_late)
   {
     case ActiveDevice::None:
     {
+      // Sample input as late as possible, right as the game starts reading a controller. Runahead has already
+      // decided the input for the frames it replays, so it can't change here, and netplay and input movies only
+      // change input between frames.
+      if (data_out == 0x01 && g_settings.controller_late_input_polling && !g_settings.IsRunaheadEnabled() &&
+          !Netplay::IsActive() && !InputMovie::IsActive())
+        InputManager::PollSourcesForPadTransfer();
+
       if (s_multitaps[s_JOY_CTRL.SLOT].IsEnabled())
       {
         if ((ack = s_multitaps[s_JOY_CTRL.SLOT].Transfer(data_out, &data_in)) == true)
@@ -851,30 +887,47 @@ void Pad::DoTransfer(TickCount ticks_late)
     break;
   }
 
-  s_receive_buffer = data_in;
-  s_receive_buffer_full = true;
+  s_pending_receive_value = data_in;
+  s_pending_ack = ack;
 
   // device no longer active?
   if (!ack)
   {
     s_active_device = ActiveDevice::None;
-    EndTransfer();
+    return 0;
   }
-  else
-  {
-    const bool memcard_transfer =
-      s_active_device == ActiveDevice::MemoryCard ||
-      (s_active_device == ActiveDevice::Multitap && s_multitaps[s_JOY_CTRL.SLOT].IsReadingMemoryCard());
 
-    const TickCount ack_timer = GetACKTicks(memcard_transfer);
-    Log_DebugPrintf("Delaying ACK for %d ticks", ack_timer);
+  const bool memcard_transfer =
+    s_active_device == ActiveDevice::MemoryCard ||
+    (s_active_device == ActiveDevice::Multitap && s_multitaps[s_JOY_CTRL.SLOT].IsReadingMemoryCard());
+
+  const TickCount ack_timer = GetACKTicks(memcard_transfer);
+  Log_DebugPrintf("Delaying ACK for %d ticks", ack_timer);
+  return ack_timer;
+}
+
+void Pad::ReceiveTransfer()
+{
+  s_receive_buffer = s_pending_receive_value;
+  s_receive_buffer_full = true;
+
+  if (!s_pending_ack)
+    EndTransfer();
+  else
     s_state = State::WaitingForACK;
-    s_transfer_event->SetPeriodAndSchedule(ack_timer);
-  }
 
   UpdateJoyStat();
 }
 
+void Pad::UpdateTransfer()
+{
+  // The event only fires once the ACK is due, but the receive buffer is filled as soon as the transfer time has passed.
+  if (s_state == State::Transmitting && s_transfer_event->GetTicksSinceLastExecution() >= s_pending_receive_ticks)
+    ReceiveTransfer();
+
+  s_transfer_event->InvokeEarly();
+}
+
 void Pad::DoACK()
 {
   s_JOY_STAT.ACKINPUT = true;
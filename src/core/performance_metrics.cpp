@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "performance_metrics.h"
+#include "cpu_code_cache.h"
+#include "spu.h"
+#include "system.h"
+
+#include "util/audio_stream.h"
+
+#include "common/memmap.h"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+
+namespace PerformanceMetrics {
+namespace {
+struct Snapshot
+{
+  bool valid;
+  bool paused;
+  float fps;
+  float vps;
+  float speed;
+  float average_frame_time;
+  float minimum_frame_time;
+  float maximum_frame_time;
+  std::array<float, 4> frame_time_percentiles;
+  float cpu_thread_usage;
+  float cpu_thread_time;
+  float sw_thread_usage;
+  float sw_thread_time;
+  float gpu_usage;
+  float gpu_time;
+  u32 frames;
+  u32 throttle_misses;
+  u32 audio_underruns;
+  u32 jit_blocks;
+  u32 jit_compiled_blocks;
+  u32 jit_code_used;
+  u32 jit_code_size;
+  u32 jit_evicted_blocks;
+  u32 jit_write_toggles;
+};
+} // namespace
+
+static constexpr std::array<float, 4> FRAME_TIME_PERCENTILES = {{50.0f, 90.0f, 99.0f, 100.0f}};
+
+static Snapshot GetSnapshot();
+} // namespace PerformanceMetrics
+
+PerformanceMetrics::Snapshot PerformanceMetrics::GetSnapshot()
+{
+  Snapshot ss = {};
+  ss.valid = System::IsValid();
+  ss.paused = System::IsPaused();
+  ss.fps = System::GetFPS();
+  ss.vps = System::GetVPS();
+  ss.speed = System::GetEmulationSpeed();
+  ss.average_frame_time = System::GetAverageFrameTime();
+  ss.minimum_frame_time = System::GetMinimumFrameTime();
+  ss.maximum_frame_time = System::GetMaximumFrameTime();
+  ss.cpu_thread_usage = System::GetCPUThreadUsage();
+  ss.cpu_thread_time = System::GetCPUThreadAverageTime();
+  ss.sw_thread_usage = System::GetSWThreadUsage();
+  ss.sw_thread_time = System::GetSWThreadAverageTime();
+  ss.gpu_usage = System::GetGPUUsage();
+  ss.gpu_time = System::GetGPUAverageTime();
+  ss.frames = System::GetFrameNumber();
+  ss.throttle_misses = System::GetThrottleMissCount();
+  ss.jit_blocks = CPU::CodeCache::GetBlockCount();
+  ss.jit_compiled_blocks = CPU::CodeCache::GetCompiledBlockCount();
+  ss.jit_code_used = CPU::CodeCache::GetCodeBufferUsed();
+  ss.jit_code_size = CPU::CodeCache::GetCodeBufferSize();
+  ss.jit_evicted_blocks = CPU::CodeCache::GetEvictedBlockCount();
+  ss.jit_write_toggles = MemMap::GetCodeWriteToggleCount();
+
+  if (ss.valid)
+  {
+    if (const AudioStream* stream = SPU::GetOutputStream())
+      ss.audio_underruns = stream->GetUnderrunCount();
+  }
+
+  // Nearest-rank over the history, ignoring slots which haven't been filled since the system started.
+  System::FrameTimeHistory history = System::GetFrameTimeHistory();
+  const auto history_end = std::remove(history.begin(), history.end(), 0.0f);
+  const size_t count = static_cast<size_t>(std::distance(history.begin(), history_end));
+  if (count > 0)
+  {
+    std::sort(history.begin(), history_end);
+    for (size_t i = 0; i < FRAME_TIME_PERCENTILES.size(); i++)
+    {
+      const size_t rank = static_cast<size_t>(FRAME_TIME_PERCENTILES[i] * static_cast<float>(count - 1) / 100.0f);
+      ss.frame_time_percentiles[i] = history[rank];
+    }
+  }
+
+  return ss;
+}
+
+std::string PerformanceMetrics::FormatPrometheus()
+{
+  const Snapshot ss = GetSnapshot();
+  std::string ret;
+  auto out = std::back_inserter(ret);
+
+  const auto metric = [&out](const char* name, const char* type, const char* help, auto value) {
+    fmt::format_to(out, "# HELP duckstation_{0} {1}\n# TYPE duckstation_{0} {2}\nduckstation_{0} {3}\n", name, help,
+                   type, value);
+  };
+
+  metric("system_valid", "gauge", "Whether a system is running or paused.", ss.valid ? 1 : 0);
+  metric("system_paused", "gauge", "Whether the system is paused.", ss.paused ? 1 : 0);
+  metric("fps", "gauge", "Frames presented per second.", ss.fps);
+  metric("vps", "gauge", "Guest vertical blanks per second.", ss.vps);
+  metric("emulation_speed_percent", "gauge", "Emulation speed relative to the console.", ss.speed);
+  metric("frame_time_average_ms", "gauge", "Average host frame time.", ss.average_frame_time);
+  metric("frame_time_minimum_ms", "gauge", "Minimum host frame time in the last interval.", ss.minimum_frame_time);
+  metric("frame_time_maximum_ms", "gauge", "Maximum host frame time in the last interval.", ss.maximum_frame_time);
+
+  fmt::format_to(out, "# HELP duckstation_frame_time_ms Host frame time percentiles over the recent frames.\n"
+                      "# TYPE duckstation_frame_time_ms gauge\n");
+  for (size_t i = 0; i < FRAME_TIME_PERCENTILES.size(); i++)
+  {
+    fmt::format_to(out, "duckstation_frame_time_ms{{percentile=\"{}\"}} {}\n", FRAME_TIME_PERCENTILES[i],
+                   ss.frame_time_percentiles[i]);
+  }
+
+  metric("cpu_thread_usage_percent", "gauge", "CPU thread utilization.", ss.cpu_thread_usage);
+  metric("cpu_thread_time_ms", "gauge", "CPU thread time per frame.", ss.cpu_thread_time);
+  metric("sw_thread_usage_percent", "gauge", "Software renderer thread utilization.", ss.sw_thread_usage);
+  metric("sw_thread_time_ms", "gauge", "Software renderer thread time per frame.", ss.sw_thread_time);
+  metric("gpu_usage_percent", "gauge", "Host GPU utilization.", ss.gpu_usage);
+  metric("gpu_time_ms", "gauge", "Host GPU time per frame.", ss.gpu_time);
+  metric("frames_total", "counter", "Frames emulated since the system started.", ss.frames);
+  metric("throttle_misses_total", "counter", "Frames which finished after their deadline.", ss.throttle_misses);
+  metric("audio_underruns_total", "counter", "Times audio output ran dry.", ss.audio_underruns);
+  metric("jit_blocks", "gauge", "Blocks in the code cache.", ss.jit_blocks);
+  metric("jit_compiled_blocks_total", "counter", "Blocks compiled to host code.", ss.jit_compiled_blocks);
+  metric("jit_code_buffer_used_bytes", "gauge", "Host code in the code buffer.", ss.jit_code_used);
+  metric("jit_code_buffer_size_bytes", "gauge", "Capacity of the code buffer.", ss.jit_code_size);
+  metric("jit_evicted_blocks_total", "counter", "Blocks evicted to make room in the code buffer.",
+         ss.jit_evicted_blocks);
+  metric("jit_write_toggles_total", "counter", "Times JIT code was made writable, only counted on Apple Silicon.",
+         ss.jit_write_toggles);
+  return ret;
+}
+
+std::string PerformanceMetrics::FormatJSON()
+{
+  const Snapshot ss = GetSnapshot();
+  std::string ret;
+  auto out = std::back_inserter(ret);
+
+  fmt::format_to(out,
+                 "{{\"system_valid\":{},\"system_paused\":{},\"fps\":{},\"vps\":{},\"emulation_speed_percent\":{},"
+                 "\"frame_time_average_ms\":{},\"frame_time_minimum_ms\":{},\"frame_time_maximum_ms\":{},"
+                 "\"frame_time_percentiles_ms\":{{",
+                 ss.valid, ss.paused, ss.fps, ss.vps, ss.speed, ss.average_frame_time, ss.minimum_frame_time,
+                 ss.maximum_frame_time);
+  for (size_t i = 0; i < FRAME_TIME_PERCENTILES.size(); i++)
+  {
+    fmt::format_to(out, "{}\"{}\":{}", (i == 0) ? "" : ",", FRAME_TIME_PERCENTILES[i],
+                   ss.frame_time_percentiles[i]);
+  }
+  fmt::format_to(out,
+                 "}},\"cpu_thread_usage_percent\":{},\"cpu_thread_time_ms\":{},\"sw_thread_usage_percent\":{},"
+                 "\"sw_thread_time_ms\":{},\"gpu_usage_percent\":{},\"gpu_time_ms\":{},\"frames_total\":{},"
+                 "\"throttle_misses_total\":{},\"audio_underruns_total\":{},\"jit_blocks\":{},"
+                 "\"jit_compiled_blocks_total\":{},\"jit_code_buffer_used_bytes\":{},"
+                 "\"jit_code_buffer_size_bytes\":{},\"jit_evicted_blocks_total\":{},\"jit_write_toggles_total\":{}}}\n",
+                 ss.cpu_thread_usage, ss.cpu_thread_time, ss.sw_thread_usage, ss.sw_thread_time, ss.gpu_usage,
+                 ss.gpu_time, ss.frames, ss.throttle_misses, ss.audio_underruns, ss.jit_blocks,
+                 ss.jit_compiled_blocks, ss.jit_code_used, ss.jit_code_size, ss.jit_evicted_blocks,
+                 ss.jit_write_toggles);
+  return ret;
+}
@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include <string>
+
+/// Formats the emulator's performance counters for external monitoring, e.g. by a metrics endpoint.
+/// Must be called on the CPU thread.
+namespace PerformanceMetrics {
+
+/// Prometheus text exposition format.
+std::string FormatPrometheus();
+
+/// A single JSON object, with the same counters as above.
+std::string FormatJSON();
+
+} // namespace PerformanceMetrics
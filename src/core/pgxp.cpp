@@ -8,8 +8,10 @@
 
 #include "common/log.h"
 
+#include <array>
 #include <climits>
 #include <cmath>
+#include <cstddef>
 
 Log_SetChannel(PGXP);
 
@@ -19,9 +21,12 @@ enum : u32
 {
   VERTEX_CACHE_WIDTH = 0x800 * 2,
   VERTEX_CACHE_HEIGHT = 0x800 * 2,
-  VERTEX_CACHE_SIZE = VERTEX_CACHE_WIDTH * VERTEX_CACHE_HEIGHT,
   PGXP_MEM_SIZE = (static_cast<u32>(Bus::RAM_8MB_SIZE) + static_cast<u32>(CPU::SCRATCHPAD_SIZE)) / 4,
-  PGXP_MEM_SCRATCH_OFFSET = Bus::RAM_8MB_SIZE / 4
+  PGXP_MEM_SCRATCH_OFFSET = Bus::RAM_8MB_SIZE / 4,
+
+  // Shadow memory is only allocated for pages which have values written to them, one 4KB guest page at a time.
+  PGXP_MEM_PAGE_ENTRIES = 4096 / 4,
+  PGXP_MEM_NUM_PAGES = (PGXP_MEM_SIZE + PGXP_MEM_PAGE_ENTRIES - 1) / PGXP_MEM_PAGE_ENTRIES,
 };
 
 #define NONE 0
@@ -82,6 +87,9 @@ static double f16Sign(double in);
 static double f16Unsign(double in);
 static double f16Overflow(double in);
 
+static u32 GetMemIndex(u32 addr);
+static PGXP_value* AllocatePage(u32 num_entries);
+static void FreePages();
 static PGXP_value* GetPtr(u32 addr);
 static PGXP_value* ReadMem(u32 addr);
 
@@ -89,6 +97,9 @@ static const PGXP_value PGXP_value_invalid = {0.f, 0.f, 0.f, {0}, 0};
 static const PGXP_value PGXP_value_zero = {0.f, 0.f, 0.f, {VALID_ALL}, 0};
 
 static PGXP_value CPU_reg[34];
+static_assert(sizeof(PGXP_value) == CPU_REG_STATE_SIZE && offsetof(PGXP_value, flags) == CPU_REG_STATE_FLAGS_OFFSET &&
+              offsetof(PGXP_value, value) == CPU_REG_STATE_VALUE_OFFSET &&
+              INV_VALID_ALL == CPU_REG_STATE_INVALIDATE_MASK);
 static PGXP_value CP0_reg[32];
 #define CPU_Hi CPU_reg[32]
 #define CPU_Lo CPU_reg[33]
@@ -96,8 +107,13 @@ static PGXP_value CP0_reg[32];
 // GTE registers
 static PGXP_value GTE_regs[64];
 
-static PGXP_value* Mem = nullptr;
-static PGXP_value* vertexCache = nullptr;
+static std::array<PGXP_value*, PGXP_MEM_NUM_PAGES> s_mem_pages = {};
+
+// Reads from pages that have never been written see this. Validation only ever clears flags, so it stays zeroed.
+static PGXP_value s_unwritten_value = {};
+
+// Vertex cache is allocated a row at a time, a full cache is several hundred megabytes.
+static std::array<PGXP_value*, VERTEX_CACHE_HEIGHT> s_vertex_cache_rows = {};
 
 ALWAYS_INLINE_RELEASE void MakeValid(PGXP_value* pV, u32 psxV)
 {
@@ -140,26 +156,73 @@ ALWAYS_INLINE_RELEASE double f16Overflow(double in)
   return out;
 }
 
-ALWAYS_INLINE_RELEASE PGXP_value* GetPtr(u32 addr)
+ALWAYS_INLINE_RELEASE u32 GetMemIndex(u32 addr)
 {
   if ((addr & CPU::SCRATCHPAD_ADDR_MASK) == CPU::SCRATCHPAD_ADDR)
-    return &Mem[PGXP_MEM_SCRATCH_OFFSET + ((addr & CPU::SCRATCHPAD_OFFSET_MASK) >> 2)];
+    return PGXP_MEM_SCRATCH_OFFSET + ((addr & CPU::SCRATCHPAD_OFFSET_MASK) >> 2);
 
   const u32 paddr = (addr & CPU::PHYSICAL_MEMORY_ADDRESS_MASK);
   if (paddr < Bus::RAM_MIRROR_END)
-    return &Mem[(paddr & Bus::g_ram_mask) >> 2];
+    return (paddr & Bus::g_ram_mask) >> 2;
   else
+    return PGXP_MEM_SIZE;
+}
+
+PGXP_value* AllocatePage(u32 num_entries)
+{
+  PGXP_value* page = static_cast<PGXP_value*>(std::calloc(num_entries, sizeof(PGXP_value)));
+  if (!page)
+  {
+    std::fprintf(stderr, "Failed to allocate PGXP memory\n");
+    std::abort();
+  }
+
+  return page;
+}
+
+void FreePages()
+{
+  for (PGXP_value*& page : s_mem_pages)
+  {
+    std::free(page);
+    page = nullptr;
+  }
+
+  for (PGXP_value*& row : s_vertex_cache_rows)
+  {
+    std::free(row);
+    row = nullptr;
+  }
+}
+
+/// Returns the shadow value for writing, allocating its page if needed.
+ALWAYS_INLINE_RELEASE PGXP_value* GetPtr(u32 addr)
+{
+  const u32 index = GetMemIndex(addr);
+  if (index >= PGXP_MEM_SIZE)
     return nullptr;
+
+  PGXP_value*& page = s_mem_pages[index / PGXP_MEM_PAGE_ENTRIES];
+  if (!page) [[unlikely]]
+    page = AllocatePage(PGXP_MEM_PAGE_ENTRIES);
+
+  return &page[index % PGXP_MEM_PAGE_ENTRIES];
 }
 
+/// Returns the shadow value for reading, without allocating.
 ALWAYS_INLINE_RELEASE PGXP_value* ReadMem(u32 addr)
 {
-  return GetPtr(addr);
+  const u32 index = GetMemIndex(addr);
+  if (index >= PGXP_MEM_SIZE)
+    return nullptr;
+
+  PGXP_value* page = s_mem_pages[index / PGXP_MEM_PAGE_ENTRIES];
+  return page ? &page[index % PGXP_MEM_PAGE_ENTRIES] : &s_unwritten_value;
 }
 
 ALWAYS_INLINE_RELEASE void ValidateAndCopyMem(PGXP_value* dest, u32 addr, u32 value)
 {
-  PGXP_value* pMem = GetPtr(addr);
+  PGXP_value* pMem = ReadMem(addr);
   if (pMem)
   {
     Validate(pMem, value);
@@ -174,7 +237,7 @@ ALWAYS_INLINE_RELEASE static void ValidateAndCopyMem16(PGXP_value* dest, u32 add
 {
   u32 validMask = 0;
   psx_value val, mask;
-  PGXP_value* pMem = GetPtr(addr);
+  PGXP_value* pMem = ReadMem(addr);
   if (pMem)
   {
     mask.d = val.d = 0;
@@ -215,6 +278,10 @@ ALWAYS_INLINE_RELEASE static void ValidateAndCopyMem16(PGXP_value* dest, u32 add
 
 ALWAYS_INLINE_RELEASE void WriteMem(const PGXP_value* value, u32 addr)
 {
+  // Invalidating memory which was never written doesn't need a page, it already reads as invalid.
+  if (value == &PGXP_value_invalid && ReadMem(addr) == &s_unwritten_value)
+    return;
+
   PGXP_value* pMem = GetPtr(addr);
 
   if (pMem)
@@ -261,28 +328,7 @@ void Initialize()
 
   std::memset(GTE_regs, 0, sizeof(GTE_regs));
 
-  if (!Mem)
-  {
-    Mem = static_cast<PGXP_value*>(std::calloc(PGXP_MEM_SIZE, sizeof(PGXP_value)));
-    if (!Mem)
-    {
-      std::fprintf(stderr, "Failed to allocate PGXP memory\n");
-      std::abort();
-    }
-  }
-
-  if (g_settings.gpu_pgxp_vertex_cache && !vertexCache)
-  {
-    vertexCache = static_cast<PGXP_value*>(std::calloc(VERTEX_CACHE_SIZE, sizeof(PGXP_value)));
-    if (!vertexCache)
-    {
-      Log_ErrorPrint("Failed to allocate memory for vertex cache, disabling.");
-      g_settings.gpu_pgxp_vertex_cache = false;
-    }
-  }
-
-  if (vertexCache)
-    std::memset(vertexCache, 0, sizeof(PGXP_value) * VERTEX_CACHE_SIZE);
+  FreePages();
 }
 
 void Reset()
@@ -292,25 +338,12 @@ void Reset()
 
   std::memset(GTE_regs, 0, sizeof(GTE_regs));
 
-  if (Mem)
-    std::memset(Mem, 0, sizeof(PGXP_value) * PGXP_MEM_SIZE);
-
-  if (vertexCache)
-    std::memset(vertexCache, 0, sizeof(PGXP_value) * VERTEX_CACHE_SIZE);
+  FreePages();
 }
 
 void Shutdown()
 {
-  if (vertexCache)
-  {
-    std::free(vertexCache);
-    vertexCache = nullptr;
-  }
-  if (Mem)
-  {
-    std::free(Mem);
-    Mem = nullptr;
-  }
+  FreePages();
 
   std::memset(GTE_regs, 0, sizeof(GTE_regs));
 
@@ -459,7 +492,11 @@ ALWAYS_INLINE_RELEASE void PGXP_CacheVertex(s16 sx, s16 sy, const PGXP_value& ve
   if (sx >= -0x800 && sx <= 0x7ff && sy >= -0x800 && sy <= 0x7ff)
   {
     // Write vertex into cache
-    vertexCache[(sy + 0x800) * VERTEX_CACHE_WIDTH + (sx + 0x800)] = vertex;
+    PGXP_value*& row = s_vertex_cache_rows[sy + 0x800];
+    if (!row) [[unlikely]]
+      row = AllocatePage(VERTEX_CACHE_WIDTH);
+
+    row[sx + 0x800] = vertex;
   }
 }
 
@@ -467,8 +504,9 @@ static ALWAYS_INLINE_RELEASE PGXP_value* PGXP_GetCachedVertex(short sx, short sy
 {
   if (sx >= -0x800 && sx <= 0x7ff && sy >= -0x800 && sy <= 0x7ff)
   {
-    // Return pointer to cache entry
-    return &vertexCache[(sy + 0x800) * VERTEX_CACHE_WIDTH + (sx + 0x800)];
+    // Return pointer to cache entry, rows which haven't been written contain nothing valid
+    PGXP_value* row = s_vertex_cache_rows[sy + 0x800];
+    return row ? &row[sx + 0x800] : nullptr;
   }
 
   return nullptr;
@@ -589,6 +627,11 @@ void CPU_SW(u32 instr, u32 addr, u32 rtVal)
   WriteMem(val, addr);
 }
 
+u8* GetCPURegisterState(u32 index)
+{
+  return reinterpret_cast<u8*>(&CPU_reg[index]);
+}
+
 void CPU_MOVE(u32 rd_and_rs, u32 rsVal)
 {
   const u32 Rs = (rd_and_rs & 0xFFu);
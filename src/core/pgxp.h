@@ -36,6 +36,16 @@ void CPU_SH(u32 instr, u32 addr, u32 rtVal);
 void CPU_SW(u32 instr, u32 addr, u32 rtVal);
 void CPU_MOVE(u32 rd_and_rs, u32 rsVal);
 
+// Layout of the per-register state, so the recompilers can inline moves and invalidations without a call.
+enum : u32
+{
+  CPU_REG_STATE_SIZE = 20,
+  CPU_REG_STATE_FLAGS_OFFSET = 12,
+  CPU_REG_STATE_VALUE_OFFSET = 16,
+  CPU_REG_STATE_INVALIDATE_MASK = 0xFEFEFEFEu, // flags &= mask clears all valid bits
+};
+u8* GetCPURegisterState(u32 index);
+
 // Arithmetic with immediate value
 void CPU_ADDI(u32 instr, u32 rsVal);
 void CPU_ANDI(u32 instr, u32 rsVal);
@@ -42,6 +42,55 @@ std::optional<float> File::GetTagFloat(const char* tag_name) const
   return static_cast<float>(std::atof(it->second.c_str()));
 }
 
+std::optional<float> File::GetTagDuration(const char* tag_name) const
+{
+  auto it = m_tags.find(tag_name);
+  if (it == m_tags.end())
+    return std::nullopt;
+
+  // Each colon shifts what came before it up by a unit, some taggers use a comma for the fraction.
+  float seconds = 0.0f;
+  float part = 0.0f;
+  float fraction_scale = 0.0f;
+  bool has_digits = false;
+  for (const char ch : it->second)
+  {
+    if (ch >= '0' && ch <= '9')
+    {
+      const float digit = static_cast<float>(ch - '0');
+      if (fraction_scale > 0.0f)
+      {
+        part += digit * fraction_scale;
+        fraction_scale *= 0.1f;
+      }
+      else
+      {
+        part = (part * 10.0f) + digit;
+      }
+
+      has_digits = true;
+    }
+    else if (ch == ':' && fraction_scale == 0.0f)
+    {
+      seconds = (seconds + part) * 60.0f;
+      part = 0.0f;
+    }
+    else if ((ch == '.' || ch == ',') && fraction_scale == 0.0f)
+    {
+      fraction_scale = 0.1f;
+    }
+    else if (ch != ' ')
+    {
+      return std::nullopt;
+    }
+  }
+
+  if (!has_digits)
+    return std::nullopt;
+
+  return seconds + part;
+}
+
 std::string File::GetTagString(const char* tag_name, const char* default_value) const
 {
   std::optional<std::string> value(GetTagString(tag_name));
@@ -36,6 +36,9 @@ public:
   std::optional<int> GetTagInt(const char* tag_name) const;
   std::optional<float> GetTagFloat(const char* tag_name) const;
 
+  /// Parses a time tag such as "length" or "fade", in seconds. Accepts "[[h:]m:]s[.fraction]".
+  std::optional<float> GetTagDuration(const char* tag_name) const;
+
   std::string GetTagString(const char* tag_name, const char* default_value) const;
   int GetTagInt(const char* tag_name, int default_value) const;
   float GetTagFloat(const char* tag_name, float default_value) const;
@@ -5,7 +5,7 @@
 #include "types.h"
 
 static constexpr u32 SAVE_STATE_MAGIC = 0x43435544;
-static constexpr u32 SAVE_STATE_VERSION = 61;
+static constexpr u32 SAVE_STATE_VERSION = 64;
 static constexpr u32 SAVE_STATE_MINIMUM_VERSION = 42;
 
 static_assert(SAVE_STATE_VERSION >= SAVE_STATE_MINIMUM_VERSION);
@@ -21,6 +21,7 @@ struct SAVE_STATE_HEADER
     COMPRESSION_TYPE_NONE = 0,
     COMPRESSION_TYPE_ZLIB = 1,
     COMPRESSION_TYPE_ZSTD = 2,
+    COMPRESSION_TYPE_ZSTD_SECTIONS = 3,
   };
 
   u32 magic;
@@ -43,4 +44,26 @@ struct SAVE_STATE_HEADER
   u32 data_uncompressed_size;
   u32 offset_to_data;
 };
+
+// With COMPRESSION_TYPE_ZSTD_SECTIONS, the data starts with a u32 section count and a table of these, followed by
+// one zstd frame per section. Decompressing every section in order gives the same stream as the other types.
+struct SAVE_STATE_SECTION
+{
+  enum : u32
+  {
+    TYPE_SYSTEM = 0,
+    TYPE_RAM = 1,
+    TYPE_DEVICES = 2,
+    TYPE_VRAM = 3,
+    TYPE_SPU = 4,
+
+    MAX_SECTIONS = 32,
+  };
+
+  u32 type;
+  u32 uncompressed_offset;
+  u32 uncompressed_size;
+  u32 compressed_offset; // Relative to offset_to_data.
+  u32 compressed_size;
+};
 #pragma pack(pop)
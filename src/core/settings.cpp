@@ -140,6 +140,7 @@ void Settings::Load(SettingsInterface& si)
   turbo_speed = si.GetFloatValue("Main", "TurboSpeed", 0.0f);
   sync_to_host_refresh_rate = si.GetBoolValue("Main", "SyncToHostRefreshRate", false);
   increase_timer_resolution = si.GetBoolValue("Main", "IncreaseTimerResolution", true);
+  thread_core_placement = si.GetBoolValue("Main", "ThreadCorePlacement", false);
   inhibit_screensaver = si.GetBoolValue("Main", "InhibitScreensaver", true);
   start_paused = si.GetBoolValue("Main", "StartPaused", false);
   start_fullscreen = si.GetBoolValue("Main", "StartFullscreen", false);
@@ -157,6 +158,7 @@ void Settings::Load(SettingsInterface& si)
   rewind_enable = si.GetBoolValue("Main", "RewindEnable", false);
   rewind_save_frequency = si.GetFloatValue("Main", "RewindFrequency", 10.0f);
   rewind_save_slots = static_cast<u32>(si.GetIntValue("Main", "RewindSaveSlots", 10));
+  rewind_native_vram = si.GetBoolValue("Main", "RewindNativeVRAM", false);
   runahead_frames = static_cast<u32>(si.GetIntValue("Main", "RunaheadFrameCount", 0));
 
   cpu_execution_mode =
@@ -170,6 +172,10 @@ void Settings::Load(SettingsInterface& si)
   cpu_recompiler_memory_exceptions = si.GetBoolValue("CPU", "RecompilerMemoryExceptions", false);
   cpu_recompiler_block_linking = si.GetBoolValue("CPU", "RecompilerBlockLinking", true);
   cpu_recompiler_icache = si.GetBoolValue("CPU", "RecompilerICache", false);
+  cpu_recompiler_block_cache = si.GetBoolValue("CPU", "RecompilerBlockCache", false);
+  cpu_recompiler_block_profiling = si.GetBoolValue("CPU", "RecompilerBlockProfiling", false);
+  cpu_recompiler_deferred_compile = si.GetBoolValue("CPU", "RecompilerDeferredCompile", false);
+  cpu_recompiler_idle_loop_skipping = si.GetBoolValue("CPU", "RecompilerIdleLoopSkipping", false);
   cpu_fastmem_mode = ParseCPUFastmemMode(
                        si.GetStringValue("CPU", "FastmemMode", GetCPUFastmemModeName(DEFAULT_CPU_FASTMEM_MODE)).c_str())
                        .value_or(DEFAULT_CPU_FASTMEM_MODE);
@@ -179,11 +185,20 @@ void Settings::Load(SettingsInterface& si)
   gpu_adapter = si.GetStringValue("GPU", "Adapter", "");
   gpu_resolution_scale = static_cast<u32>(si.GetIntValue("GPU", "ResolutionScale", 1));
   gpu_multisamples = static_cast<u32>(si.GetIntValue("GPU", "Multisamples", 1));
+  gpu_dynamic_resolution = si.GetBoolValue("GPU", "DynamicResolution", false);
+  gpu_dynamic_resolution_target =
+    static_cast<u8>(std::clamp<int>(si.GetIntValue("GPU", "DynamicResolutionTarget", 85), 25, 100));
   gpu_use_debug_device = si.GetBoolValue("GPU", "UseDebugDevice", false);
+  gpu_use_null_device = si.GetBoolValue("GPU", "UseNullDevice", false);
   gpu_disable_shader_cache = si.GetBoolValue("GPU", "DisableShaderCache", false);
+  gpu_lazy_pipeline_compilation = si.GetBoolValue("GPU", "LazyPipelineCompilation", false);
+  gpu_use_ubershaders = si.GetBoolValue("GPU", "UseUbershaders", false);
   gpu_per_sample_shading = si.GetBoolValue("GPU", "PerSampleShading", false);
   gpu_use_thread = si.GetBoolValue("GPU", "UseThread", true);
   gpu_use_software_renderer_for_readbacks = si.GetBoolValue("GPU", "UseSoftwareRendererForReadbacks", false);
+  gpu_render_skip = si.GetBoolValue("GPU", "RenderSkip", false);
+  gpu_sw_worker_threads =
+    static_cast<u8>(std::clamp<int>(si.GetIntValue("GPU", "SoftwareRendererWorkerThreads", 0), 0, 16));
   gpu_threaded_presentation = si.GetBoolValue("GPU", "ThreadedPresentation", true);
   gpu_true_color = si.GetBoolValue("GPU", "TrueColor", true);
   gpu_scaled_dithering = si.GetBoolValue("GPU", "ScaledDithering", true);
@@ -250,6 +265,9 @@ void Settings::Load(SettingsInterface& si)
   display_show_inputs = si.GetBoolValue("Display", "ShowInputs", false);
   display_show_enhancements = si.GetBoolValue("Display", "ShowEnhancements", false);
   display_all_frames = si.GetBoolValue("Display", "DisplayAllFrames", false);
+  display_pre_frame_sleep = si.GetBoolValue("Display", "PreFrameSleep", false);
+  display_pre_frame_sleep_buffer =
+    std::clamp(si.GetFloatValue("Display", "PreFrameSleepBuffer", DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER), 0.0f, 16.0f);
   display_internal_resolution_screenshots = si.GetBoolValue("Display", "InternalResolutionScreenshots", false);
   display_stretch_vertically = si.GetBoolValue("Display", "StretchVertically", false);
   video_sync_enabled = si.GetBoolValue("Display", "VSync", DEFAULT_VSYNC_VALUE);
@@ -264,10 +282,13 @@ void Settings::Load(SettingsInterface& si)
       .value_or(DEFAULT_CDROM_MECHACON_VERSION);
   cdrom_region_check = si.GetBoolValue("CDROM", "RegionCheck", false);
   cdrom_load_image_to_ram = si.GetBoolValue("CDROM", "LoadImageToRAM", false);
+  cdrom_share_precache = si.GetBoolValue("CDROM", "SharePrecache", false);
   cdrom_load_image_patches = si.GetBoolValue("CDROM", "LoadImagePatches", false);
   cdrom_mute_cd_audio = si.GetBoolValue("CDROM", "MuteCDAudio", false);
   cdrom_read_speedup = si.GetIntValue("CDROM", "ReadSpeedup", 1);
   cdrom_seek_speedup = si.GetIntValue("CDROM", "SeekSpeedup", 1);
+  cdrom_chd_hunk_cache_size =
+    std::clamp<u32>(si.GetUIntValue("CDROM", "CHDHunkCacheSize", DEFAULT_CDROM_CHD_HUNK_CACHE_SIZE), 1, 256);
 
   audio_backend =
     ParseAudioBackend(si.GetStringValue("Audio", "Backend", GetAudioBackendName(DEFAULT_AUDIO_BACKEND)).c_str())
@@ -286,6 +307,13 @@ void Settings::Load(SettingsInterface& si)
   audio_output_muted = si.GetBoolValue("Audio", "OutputMuted", false);
   audio_dump_on_boot = si.GetBoolValue("Audio", "DumpOnBoot", false);
 
+  media_capture_backend =
+    MediaCapture::ParseBackendName(
+      si.GetStringValue("MediaCapture", "Backend", MediaCapture::GetBackendName(DEFAULT_MEDIA_CAPTURE_BACKEND)).c_str())
+      .value_or(DEFAULT_MEDIA_CAPTURE_BACKEND);
+  media_capture_quality = static_cast<u8>(
+    std::clamp<u32>(si.GetUIntValue("MediaCapture", "Quality", DEFAULT_MEDIA_CAPTURE_QUALITY), 1, 100));
+
   use_old_mdec_routines = si.GetBoolValue("Hacks", "UseOldMDECRoutines", false);
   pcdrv_enable = si.GetBoolValue("PCDrv", "Enabled", false);
   pcdrv_enable_writes = si.GetBoolValue("PCDrv", "EnableWrites", false);
@@ -303,6 +331,7 @@ void Settings::Load(SettingsInterface& si)
     ParseMultitapModeName(
       si.GetStringValue("ControllerPorts", "MultitapMode", GetMultitapModeName(DEFAULT_MULTITAP_MODE)).c_str())
       .value_or(DEFAULT_MULTITAP_MODE);
+  controller_late_input_polling = si.GetBoolValue("ControllerPorts", "LateInputPolling", false);
 
   controller_types[0] = ParseControllerTypeName(si.GetStringValue(Controller::GetSettingsSection(0).c_str(), "Type",
                                                                   GetControllerTypeName(DEFAULT_CONTROLLER_1_TYPE))
@@ -362,12 +391,18 @@ void Settings::Load(SettingsInterface& si)
   log_to_debug = si.GetBoolValue("Logging", "LogToDebug", false);
   log_to_window = si.GetBoolValue("Logging", "LogToWindow", false);
   log_to_file = si.GetBoolValue("Logging", "LogToFile", false);
+  log_async = si.GetBoolValue("Logging", "LogAsync", DEFAULT_LOG_ASYNC);
+  log_channel_rate_limit = si.GetUIntValue("Logging", "ChannelRateLimit", DEFAULT_LOG_CHANNEL_RATE_LIMIT);
 
   debugging.show_vram = si.GetBoolValue("Debug", "ShowVRAM");
   debugging.dump_cpu_to_vram_copies = si.GetBoolValue("Debug", "DumpCPUToVRAMCopies");
   debugging.dump_vram_to_cpu_copies = si.GetBoolValue("Debug", "DumpVRAMToCPUCopies");
+  debugging.dump_gpu_timings = si.GetBoolValue("Debug", "DumpGPUTimings");
   debugging.enable_gdb_server = si.GetBoolValue("Debug", "EnableGDBServer");
   debugging.gdb_server_port = static_cast<u16>(si.GetIntValue("Debug", "GDBServerPort"));
+  debugging.enable_metrics_server = si.GetBoolValue("Debug", "EnableMetricsServer");
+  debugging.metrics_server_port =
+    static_cast<u16>(si.GetUIntValue("Debug", "MetricsServerPort", DEFAULT_METRICS_SERVER_PORT));
   debugging.show_gpu_state = si.GetBoolValue("Debug", "ShowGPUState");
   debugging.show_cdrom_state = si.GetBoolValue("Debug", "ShowCDROMState");
   debugging.show_spu_state = si.GetBoolValue("Debug", "ShowSPUState");
@@ -378,6 +413,8 @@ void Settings::Load(SettingsInterface& si)
   texture_replacements.enable_vram_write_replacements =
     si.GetBoolValue("TextureReplacements", "EnableVRAMWriteReplacements", false);
   texture_replacements.preload_textures = si.GetBoolValue("TextureReplacements", "PreloadTextures", false);
+  texture_replacements.cache_size_mb =
+    si.GetUIntValue("TextureReplacements", "CacheSizeMB", DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB);
   texture_replacements.dump_vram_writes = si.GetBoolValue("TextureReplacements", "DumpVRAMWrites", false);
   texture_replacements.dump_vram_write_force_alpha_channel =
     si.GetBoolValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel", true);
@@ -403,6 +440,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetFloatValue("Main", "TurboSpeed", turbo_speed);
   si.SetBoolValue("Main", "SyncToHostRefreshRate", sync_to_host_refresh_rate);
   si.SetBoolValue("Main", "IncreaseTimerResolution", increase_timer_resolution);
+  si.SetBoolValue("Main", "ThreadCorePlacement", thread_core_placement);
   si.SetBoolValue("Main", "InhibitScreensaver", inhibit_screensaver);
   si.SetBoolValue("Main", "StartPaused", start_paused);
   si.SetBoolValue("Main", "StartFullscreen", start_fullscreen);
@@ -420,6 +458,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Main", "RewindEnable", rewind_enable);
   si.SetFloatValue("Main", "RewindFrequency", rewind_save_frequency);
   si.SetIntValue("Main", "RewindSaveSlots", rewind_save_slots);
+  si.SetBoolValue("Main", "RewindNativeVRAM", rewind_native_vram);
   si.SetIntValue("Main", "RunaheadFrameCount", runahead_frames);
 
   si.SetStringValue("CPU", "ExecutionMode", GetCPUExecutionModeName(cpu_execution_mode));
@@ -429,18 +468,29 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("CPU", "RecompilerMemoryExceptions", cpu_recompiler_memory_exceptions);
   si.SetBoolValue("CPU", "RecompilerBlockLinking", cpu_recompiler_block_linking);
   si.SetBoolValue("CPU", "RecompilerICache", cpu_recompiler_icache);
+  si.SetBoolValue("CPU", "RecompilerBlockCache", cpu_recompiler_block_cache);
+  si.SetBoolValue("CPU", "RecompilerBlockProfiling", cpu_recompiler_block_profiling);
+  si.SetBoolValue("CPU", "RecompilerDeferredCompile", cpu_recompiler_deferred_compile);
+  si.SetBoolValue("CPU", "RecompilerIdleLoopSkipping", cpu_recompiler_idle_loop_skipping);
   si.SetStringValue("CPU", "FastmemMode", GetCPUFastmemModeName(cpu_fastmem_mode));
 
   si.SetStringValue("GPU", "Renderer", GetRendererName(gpu_renderer));
   si.SetStringValue("GPU", "Adapter", gpu_adapter.c_str());
   si.SetIntValue("GPU", "ResolutionScale", static_cast<long>(gpu_resolution_scale));
   si.SetIntValue("GPU", "Multisamples", static_cast<long>(gpu_multisamples));
+  si.SetBoolValue("GPU", "DynamicResolution", gpu_dynamic_resolution);
+  si.SetIntValue("GPU", "DynamicResolutionTarget", gpu_dynamic_resolution_target);
   si.SetBoolValue("GPU", "UseDebugDevice", gpu_use_debug_device);
+  si.SetBoolValue("GPU", "UseNullDevice", gpu_use_null_device);
   si.SetBoolValue("GPU", "DisableShaderCache", gpu_disable_shader_cache);
+  si.SetBoolValue("GPU", "LazyPipelineCompilation", gpu_lazy_pipeline_compilation);
+  si.SetBoolValue("GPU", "UseUbershaders", gpu_use_ubershaders);
   si.SetBoolValue("GPU", "PerSampleShading", gpu_per_sample_shading);
   si.SetBoolValue("GPU", "UseThread", gpu_use_thread);
   si.SetBoolValue("GPU", "ThreadedPresentation", gpu_threaded_presentation);
   si.SetBoolValue("GPU", "UseSoftwareRendererForReadbacks", gpu_use_software_renderer_for_readbacks);
+  si.SetBoolValue("GPU", "RenderSkip", gpu_render_skip);
+  si.SetIntValue("GPU", "SoftwareRendererWorkerThreads", gpu_sw_worker_threads);
   si.SetBoolValue("GPU", "TrueColor", gpu_true_color);
   si.SetBoolValue("GPU", "ScaledDithering", gpu_scaled_dithering);
   si.SetStringValue("GPU", "TextureFilter", GetTextureFilterName(gpu_texture_filter));
@@ -484,6 +534,8 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Display", "ShowInputs", display_show_inputs);
   si.SetBoolValue("Display", "ShowEnhancements", display_show_enhancements);
   si.SetBoolValue("Display", "DisplayAllFrames", display_all_frames);
+  si.SetBoolValue("Display", "PreFrameSleep", display_pre_frame_sleep);
+  si.SetFloatValue("Display", "PreFrameSleepBuffer", display_pre_frame_sleep_buffer);
   si.SetBoolValue("Display", "InternalResolutionScreenshots", display_internal_resolution_screenshots);
   si.SetBoolValue("Display", "StretchVertically", display_stretch_vertically);
   si.SetBoolValue("Display", "VSync", video_sync_enabled);
@@ -494,10 +546,12 @@ void Settings::Save(SettingsInterface& si) const
   si.SetStringValue("CDROM", "MechaconVersion", GetCDROMMechVersionName(cdrom_mechacon_version));
   si.SetBoolValue("CDROM", "RegionCheck", cdrom_region_check);
   si.SetBoolValue("CDROM", "LoadImageToRAM", cdrom_load_image_to_ram);
+  si.SetBoolValue("CDROM", "SharePrecache", cdrom_share_precache);
   si.SetBoolValue("CDROM", "LoadImagePatches", cdrom_load_image_patches);
   si.SetBoolValue("CDROM", "MuteCDAudio", cdrom_mute_cd_audio);
   si.SetIntValue("CDROM", "ReadSpeedup", cdrom_read_speedup);
   si.SetIntValue("CDROM", "SeekSpeedup", cdrom_seek_speedup);
+  si.SetUIntValue("CDROM", "CHDHunkCacheSize", cdrom_chd_hunk_cache_size);
 
   si.SetStringValue("Audio", "Backend", GetAudioBackendName(audio_backend));
   si.SetStringValue("Audio", "Driver", audio_driver.c_str());
@@ -510,6 +564,9 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Audio", "OutputMuted", audio_output_muted);
   si.SetBoolValue("Audio", "DumpOnBoot", audio_dump_on_boot);
 
+  si.SetStringValue("MediaCapture", "Backend", MediaCapture::GetBackendName(media_capture_backend));
+  si.SetUIntValue("MediaCapture", "Quality", media_capture_quality);
+
   si.SetBoolValue("Hacks", "UseOldMDECRoutines", use_old_mdec_routines);
   si.SetIntValue("Hacks", "DMAMaxSliceTicks", dma_max_slice_ticks);
   si.SetIntValue("Hacks", "DMAHaltTicks", dma_halt_ticks);
@@ -541,6 +598,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("MemoryCards", "UsePlaylistTitle", memory_card_use_playlist_title);
 
   si.SetStringValue("ControllerPorts", "MultitapMode", GetMultitapModeName(multitap_mode));
+  si.SetBoolValue("ControllerPorts", "LateInputPolling", controller_late_input_polling);
 
   si.SetBoolValue("Cheevos", "Enabled", achievements_enabled);
   si.SetBoolValue("Cheevos", "ChallengeMode", achievements_hardcore_mode);
@@ -563,10 +621,15 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Logging", "LogToDebug", log_to_debug);
   si.SetBoolValue("Logging", "LogToWindow", log_to_window);
   si.SetBoolValue("Logging", "LogToFile", log_to_file);
+  si.SetBoolValue("Logging", "LogAsync", log_async);
+  si.SetUIntValue("Logging", "ChannelRateLimit", log_channel_rate_limit);
 
   si.SetBoolValue("Debug", "ShowVRAM", debugging.show_vram);
   si.SetBoolValue("Debug", "DumpCPUToVRAMCopies", debugging.dump_cpu_to_vram_copies);
   si.SetBoolValue("Debug", "DumpVRAMToCPUCopies", debugging.dump_vram_to_cpu_copies);
+  si.SetBoolValue("Debug", "DumpGPUTimings", debugging.dump_gpu_timings);
+  si.SetBoolValue("Debug", "EnableMetricsServer", debugging.enable_metrics_server);
+  si.SetUIntValue("Debug", "MetricsServerPort", debugging.metrics_server_port);
   si.SetBoolValue("Debug", "ShowGPUState", debugging.show_gpu_state);
   si.SetBoolValue("Debug", "ShowCDROMState", debugging.show_cdrom_state);
   si.SetBoolValue("Debug", "ShowSPUState", debugging.show_spu_state);
@@ -577,6 +640,7 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("TextureReplacements", "EnableVRAMWriteReplacements",
                   texture_replacements.enable_vram_write_replacements);
   si.SetBoolValue("TextureReplacements", "PreloadTextures", texture_replacements.preload_textures);
+  si.SetUIntValue("TextureReplacements", "CacheSizeMB", texture_replacements.cache_size_mb);
   si.SetBoolValue("TextureReplacements", "DumpVRAMWrites", texture_replacements.dump_vram_writes);
   si.SetBoolValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel",
                   texture_replacements.dump_vram_write_force_alpha_channel);
@@ -596,6 +660,7 @@ void Settings::FixIncompatibleSettings(bool display_osd_messages)
     g_settings.enable_8mb_ram = false;
     g_settings.gpu_resolution_scale = 1;
     g_settings.gpu_multisamples = 1;
+    g_settings.gpu_dynamic_resolution = false;
     g_settings.gpu_per_sample_shading = false;
     g_settings.gpu_true_color = false;
     g_settings.gpu_scaled_dithering = false;
@@ -710,6 +775,8 @@ void Settings::UpdateLogSettings()
   Log::SetLogFilter(log_filter);
   Log::SetConsoleOutputParams(log_to_console, log_timestamps);
   Log::SetDebugOutputParams(log_to_debug);
+  Log::SetChannelRateLimit(log_channel_rate_limit);
+  Log::SetAsyncOutputParams(log_async);
 
   if (log_to_file)
   {
@@ -1557,6 +1624,7 @@ bool EmuFolders::EnsureFoldersExist()
   result = FileSystem::EnsureDirectoryExists(Dumps.c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "audio").c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "textures").c_str(), false) && result;
+  result = FileSystem::EnsureDirectoryExists(Path::Combine(Dumps, "video").c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(GameSettings.c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(InputProfiles.c_str(), false) && result;
   result = FileSystem::EnsureDirectoryExists(MemoryCards.c_str(), false) && result;
@@ -1635,6 +1703,7 @@ static const char* s_log_filters[] = {
   "MainWindow",
   "MemoryArena",
   "MemoryCard",
+  "MetricsServer",
   "Multitap",
   "NoGUIHost",
   "PCDrv",
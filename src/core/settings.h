@@ -7,8 +7,10 @@
 #include "common/small_string.h"
 #include "types.h"
 #include "util/audio_stream.h"
+#include "util/media_capture.h"
 #include <array>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -64,6 +66,10 @@ struct Settings
   bool cpu_recompiler_memory_exceptions = false;
   bool cpu_recompiler_block_linking = true;
   bool cpu_recompiler_icache = false;
+  bool cpu_recompiler_block_cache = false;
+  bool cpu_recompiler_block_profiling = false;
+  bool cpu_recompiler_deferred_compile = false;
+  bool cpu_recompiler_idle_loop_skipping = false;
   CPUFastmemMode cpu_fastmem_mode = DEFAULT_CPU_FASTMEM_MODE;
 
   float emulation_speed = 1.0f;
@@ -71,6 +77,7 @@ struct Settings
   float turbo_speed = 0.0f;
   bool sync_to_host_refresh_rate = false;
   bool increase_timer_resolution = true;
+  bool thread_core_placement = false;
   bool inhibit_screensaver = true;
   bool start_paused = false;
   bool start_fullscreen = false;
@@ -89,17 +96,25 @@ struct Settings
   bool rewind_enable = false;
   float rewind_save_frequency = 10.0f;
   u32 rewind_save_slots = 10;
+  bool rewind_native_vram = false;
   u32 runahead_frames = 0;
 
   GPURenderer gpu_renderer = DEFAULT_GPU_RENDERER;
   std::string gpu_adapter;
   u32 gpu_resolution_scale = 1;
   u32 gpu_multisamples = 1;
+  bool gpu_dynamic_resolution = false;
+  u8 gpu_dynamic_resolution_target = 85;
   bool gpu_use_thread = true;
   bool gpu_use_software_renderer_for_readbacks = false;
+  bool gpu_render_skip = false;
+  u8 gpu_sw_worker_threads = 0;
   bool gpu_threaded_presentation = true;
   bool gpu_use_debug_device = false;
+  bool gpu_use_null_device = false;
   bool gpu_disable_shader_cache = false;
+  bool gpu_lazy_pipeline_compilation = false;
+  bool gpu_use_ubershaders = false;
   bool gpu_per_sample_shading = false;
   bool gpu_true_color = true;
   bool gpu_scaled_dithering = true;
@@ -141,11 +156,13 @@ struct Settings
   bool display_show_inputs = false;
   bool display_show_enhancements = false;
   bool display_all_frames = false;
+  bool display_pre_frame_sleep = false;
   bool display_internal_resolution_screenshots = false;
   bool display_stretch_vertically = false;
   bool video_sync_enabled = DEFAULT_VSYNC_VALUE;
   float display_osd_scale = 100.0f;
   float display_max_fps = DEFAULT_DISPLAY_MAX_FPS;
+  float display_pre_frame_sleep_buffer = DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER;
   float gpu_pgxp_tolerance = -1.0f;
   float gpu_pgxp_depth_clear_threshold = DEFAULT_GPU_PGXP_DEPTH_THRESHOLD / GPU_PGXP_DEPTH_THRESHOLD_SCALE;
 
@@ -153,10 +170,12 @@ struct Settings
   CDROMMechaconVersion cdrom_mechacon_version = DEFAULT_CDROM_MECHACON_VERSION;
   bool cdrom_region_check = false;
   bool cdrom_load_image_to_ram = false;
+  bool cdrom_share_precache = false;
   bool cdrom_load_image_patches = false;
   bool cdrom_mute_cd_audio = false;
   u32 cdrom_read_speedup = 1;
   u32 cdrom_seek_speedup = 1;
+  u32 cdrom_chd_hunk_cache_size = DEFAULT_CDROM_CHD_HUNK_CACHE_SIZE;
 
   AudioBackend audio_backend = DEFAULT_AUDIO_BACKEND;
   AudioStretchMode audio_stretch_mode = DEFAULT_AUDIO_STRETCH_MODE;
@@ -169,6 +188,9 @@ struct Settings
   bool audio_output_muted = false;
   bool audio_dump_on_boot = false;
 
+  MediaCaptureBackend media_capture_backend = DEFAULT_MEDIA_CAPTURE_BACKEND;
+  u8 media_capture_quality = DEFAULT_MEDIA_CAPTURE_QUALITY;
+
   bool use_old_mdec_routines = false;
   bool pcdrv_enable = false;
 
@@ -198,10 +220,14 @@ struct Settings
     bool show_vram = false;
     bool dump_cpu_to_vram_copies = false;
     bool dump_vram_to_cpu_copies = false;
+    bool dump_gpu_timings = false;
 
     bool enable_gdb_server = false;
     u16 gdb_server_port = 1234;
 
+    bool enable_metrics_server = false;
+    u16 metrics_server_port = DEFAULT_METRICS_SERVER_PORT;
+
     // Mutable because the imgui window can close itself.
     mutable bool show_gpu_state = false;
     mutable bool show_cdrom_state = false;
@@ -216,6 +242,7 @@ struct Settings
   {
     bool enable_vram_write_replacements = false;
     bool preload_textures = false;
+    u32 cache_size_mb = DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB;
 
     bool dump_vram_writes = false;
     bool dump_vram_write_force_alpha_channel = true;
@@ -236,6 +263,7 @@ struct Settings
 
   std::array<ControllerType, NUM_CONTROLLER_AND_CARD_PORTS> controller_types{};
   bool controller_disable_analog_mode_forcing = false;
+  bool controller_late_input_polling = false;
 
   std::array<MemoryCardType, NUM_CONTROLLER_AND_CARD_PORTS> memory_card_types{};
   std::array<std::string, NUM_CONTROLLER_AND_CARD_PORTS> memory_card_paths{};
@@ -253,6 +281,8 @@ struct Settings
   bool log_to_debug = false;
   bool log_to_window = false;
   bool log_to_file = false;
+  bool log_async = DEFAULT_LOG_ASYNC;
+  u32 log_channel_rate_limit = DEFAULT_LOG_CHANNEL_RATE_LIMIT;
 
   ALWAYS_INLINE bool IsUsingSoftwareRenderer() const { return (gpu_renderer == GPURenderer::Software); }
   ALWAYS_INLINE bool IsRunaheadEnabled() const { return (runahead_frames > 0); }
@@ -322,6 +352,7 @@ struct Settings
     DEFAULT_GPU_MAX_RUN_AHEAD = 128,
     DEFAULT_VRAM_WRITE_DUMP_WIDTH_THRESHOLD = 128,
     DEFAULT_VRAM_WRITE_DUMP_HEIGHT_THRESHOLD = 128,
+    DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB = 1024,
   };
 
   void Load(SettingsInterface& si);
@@ -449,8 +480,10 @@ struct Settings
   static constexpr DisplayAlignment DEFAULT_DISPLAY_ALIGNMENT = DisplayAlignment::Center;
   static constexpr DisplayScalingMode DEFAULT_DISPLAY_SCALING = DisplayScalingMode::BilinearSmooth;
   static constexpr float DEFAULT_OSD_SCALE = 100.0f;
+  static constexpr float DEFAULT_DISPLAY_PRE_FRAME_SLEEP_BUFFER = 2.0f;
 
   static constexpr u8 DEFAULT_CDROM_READAHEAD_SECTORS = 8;
+  static constexpr u32 DEFAULT_CDROM_CHD_HUNK_CACHE_SIZE = 16;
   static constexpr CDROMMechaconVersion DEFAULT_CDROM_MECHACON_VERSION = CDROMMechaconVersion::VC1A;
 
   static constexpr ControllerType DEFAULT_CONTROLLER_1_TYPE = ControllerType::AnalogController;
@@ -463,6 +496,9 @@ struct Settings
   static constexpr s32 DEFAULT_LEADERBOARD_NOTIFICATION_TIME = 10;
 
   static constexpr LOGLEVEL DEFAULT_LOG_LEVEL = LOGLEVEL_INFO;
+  static constexpr bool DEFAULT_LOG_ASYNC = true;
+  static constexpr u32 DEFAULT_LOG_CHANNEL_RATE_LIMIT = 1000;
+  static constexpr u16 DEFAULT_METRICS_SERVER_PORT = 9464;
 
 #ifndef __ANDROID__
   static constexpr u32 DEFAULT_AUDIO_BUFFER_MS = 50;
@@ -473,6 +509,9 @@ struct Settings
 #endif
   static constexpr AudioStretchMode DEFAULT_AUDIO_STRETCH_MODE = AudioStretchMode::TimeStretch;
 
+  static constexpr MediaCaptureBackend DEFAULT_MEDIA_CAPTURE_BACKEND = MediaCaptureBackend::MJPEG;
+  static constexpr u8 DEFAULT_MEDIA_CAPTURE_QUALITY = 90;
+
   // Enable console logging by default on Linux platforms.
 #if defined(__linux__) && !defined(__ANDROID__)
   static constexpr bool DEFAULT_LOG_TO_CONSOLE = true;
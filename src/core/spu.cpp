@@ -7,16 +7,19 @@
 #include "host.h"
 #include "imgui.h"
 #include "interrupt_controller.h"
+#include "netplay.h"
 #include "system.h"
 
 #include "util/audio_stream.h"
 #include "util/imgui_manager.h"
+#include "util/media_capture.h"
 #include "util/state_wrapper.h"
 #include "util/wav_writer.h"
 
 #include "common/bitfield.h"
 #include "common/bitutils.h"
 #include "common/fifo_queue.h"
+#include "common/intrin.h"
 #include "common/log.h"
 #include "common/path.h"
 
@@ -262,7 +265,6 @@ struct Voice
   void ForceOff();
 
   void DecodeBlock(const ADPCMBlock& block);
-  s32 Interpolate() const;
 
   // Switches to the specified phase, filling in target.
   void UpdateADSREnvelope();
@@ -322,21 +324,74 @@ static bool IsRAMIRQTriggerable();
 static bool CheckRAMIRQ(u32 address);
 static void TriggerRAMIRQ();
 static void CheckForLateRAMIRQs();
+static bool IsTickEventLimitedByRAMIRQ();
+static u32 GetFramesUntilNextRAMIRQCheck(u32 max_frames);
 
 static void WriteToCaptureBuffer(u32 index, s16 value);
 static void IncrementCaptureBufferPosition();
 
+/// Inputs and outputs for the voices in the current frame. Voice state stays in Voice, the parts of each frame which
+/// are the same for every voice (interpolation and volume) are done on all voices at once from here.
+struct VoiceMix
+{
+  alignas(16) std::array<s16, NUM_VOICES * 4> interp_coefficients;
+  alignas(16) std::array<s16, NUM_VOICES * 4> interp_samples;
+  alignas(16) std::array<s16, NUM_VOICES> adsr_volume;
+  alignas(16) std::array<s16, NUM_VOICES> left_level;
+  alignas(16) std::array<s16, NUM_VOICES> right_level;
+  alignas(16) std::array<s32, NUM_VOICES> volume;
+  alignas(16) std::array<s32, NUM_VOICES> left;
+  alignas(16) std::array<s32, NUM_VOICES> right;
+};
+
+enum : u32
+{
+  REVERB_TAP_IIR_SRC_A,
+  REVERB_TAP_IIR_SRC_B,
+  REVERB_TAP_IIR_DEST_A_PREV,
+  REVERB_TAP_IIR_DEST_B_PREV,
+  REVERB_TAP_IIR_DEST_A,
+  REVERB_TAP_IIR_DEST_B,
+  REVERB_TAP_ACC_SRC_A,
+  REVERB_TAP_ACC_SRC_B,
+  REVERB_TAP_ACC_SRC_C,
+  REVERB_TAP_ACC_SRC_D,
+  REVERB_TAP_FB_SRC_A,
+  REVERB_TAP_FB_SRC_B,
+  REVERB_TAP_MIX_DEST_A,
+  REVERB_TAP_MIX_DEST_B,
+  REVERB_TAP_PADDING_0,
+  REVERB_TAP_PADDING_1,
+  NUM_REVERB_TAPS
+};
+
+/// RAM byte addresses of every reverb tap for one tick, per channel.
+struct ReverbTapAddresses
+{
+  alignas(16) std::array<std::array<u32, NUM_REVERB_TAPS>, 2> addresses;
+};
+
 static void ReadADPCMBlock(u16 address, ADPCMBlock* block);
-static std::tuple<s32, s32> SampleVoice(u32 voice_index);
+static u32 PrepareVoices();
+static void PrepareVoice(u32 voice_index);
+static void MixVoiceVolumes();
+static void AdvanceVoice(u32 voice_index);
+static void MixVoiceOutputs();
 
 static void UpdateNoise();
 
 static u32 ReverbMemoryAddress(u32 address);
-static s16 ReverbRead(u32 address, s32 offset = 0);
-static void ReverbWrite(u32 address, s16 data);
+static void ComputeReverbTapAddresses(ReverbTapAddresses* taps);
+static s16 ReverbRead(u32 real_address);
+static void ReverbWrite(u32 real_address, s16 data);
 static void ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out);
 
 static void Execute(void* param, TickCount ticks, TickCount ticks_late);
+static bool ShouldReduceSynthesis();
+static void ExecuteReduced(u32 frames);
+static void ProcessKeyOnOff();
+static TickCount GetTickEventInterval();
+static void ScheduleTickEvent(TickCount interval_ticks);
 static void UpdateEventInterval();
 
 static void ExecuteFIFOWriteToRAM(TickCount& ticks);
@@ -398,6 +453,7 @@ static std::array<std::array<s16, 64>, 2> s_reverb_upsample_buffer;
 static s32 s_reverb_resample_buffer_position = 0;
 
 static std::array<Voice, NUM_VOICES> s_voices{};
+static VoiceMix s_voice_mix{};
 
 static InlineFIFOQueue<u16, FIFO_SIZE_IN_HALFWORDS> s_transfer_fifo;
 
@@ -563,26 +619,28 @@ bool SPU::DoState(StateWrapper& sw)
   for (u32 i = 0; i < 2; i++)
     sw.DoArray(s_reverb_upsample_buffer.data(), s_reverb_upsample_buffer.size());
   sw.Do(&s_reverb_resample_buffer_position);
-  for (u32 i = 0; i < NUM_VOICES; i++)
-  {
-    Voice& v = s_voices[i];
-    sw.Do(&v.current_address);
-    sw.DoArray(v.regs.index, NUM_VOICE_REGISTERS);
-    sw.Do(&v.counter.bits);
-    sw.Do(&v.current_block_flags.bits);
-    sw.DoEx(&v.is_first_block, 47, false);
-    sw.DoArray(&v.current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK], NUM_SAMPLES_PER_ADPCM_BLOCK);
-    sw.DoArray(&v.current_block_samples[0], NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK);
-    sw.Do(&v.adpcm_last_samples);
-    sw.Do(&v.last_volume);
-    sw.DoPOD(&v.left_volume);
-    sw.DoPOD(&v.right_volume);
-    sw.DoPOD(&v.adsr_envelope);
-    sw.Do(&v.adsr_phase);
-    sw.Do(&v.adsr_target);
-    sw.Do(&v.has_samples);
-    sw.Do(&v.ignore_loop_address);
-  }
+  sw.DoPODSection(&s_voices, 63, [&sw]() {
+    for (u32 i = 0; i < NUM_VOICES; i++)
+    {
+      Voice& v = s_voices[i];
+      sw.Do(&v.current_address);
+      sw.DoArray(v.regs.index, NUM_VOICE_REGISTERS);
+      sw.Do(&v.counter.bits);
+      sw.Do(&v.current_block_flags.bits);
+      sw.DoEx(&v.is_first_block, 47, false);
+      sw.DoArray(&v.current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK], NUM_SAMPLES_PER_ADPCM_BLOCK);
+      sw.DoArray(&v.current_block_samples[0], NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK);
+      sw.Do(&v.adpcm_last_samples);
+      sw.Do(&v.last_volume);
+      sw.DoPOD(&v.left_volume);
+      sw.DoPOD(&v.right_volume);
+      sw.DoPOD(&v.adsr_envelope);
+      sw.Do(&v.adsr_phase);
+      sw.Do(&v.adsr_target);
+      sw.Do(&v.has_samples);
+      sw.Do(&v.ignore_loop_address);
+    }
+  });
 
   sw.Do(&s_transfer_fifo);
   sw.DoBytes(s_ram.data(), RAM_SIZE);
@@ -763,6 +821,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       Log_DebugPrintf("SPU key on low <- 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
       s_key_on_register = (s_key_on_register & 0xFFFF0000) | ZeroExtend32(value);
+      UpdateEventInterval();
     }
     break;
 
@@ -771,6 +830,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       Log_DebugPrintf("SPU key on high <- 0x%04X", ZeroExtend32(value));
       GeneratePendingSamples();
       s_key_on_register = (s_key_on_register & 0x0000FFFF) | (ZeroExtend32(value) << 16);
+      UpdateEventInterval();
     }
     break;
 
@@ -795,6 +855,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       GeneratePendingSamples();
       s_pitch_modulation_enable_register = (s_pitch_modulation_enable_register & 0xFFFF0000) | ZeroExtend32(value);
       Log_DebugPrintf("SPU pitch modulation enable register <- 0x%08X", s_pitch_modulation_enable_register);
+      UpdateEventInterval();
     }
     break;
 
@@ -804,6 +865,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       s_pitch_modulation_enable_register =
         (s_pitch_modulation_enable_register & 0x0000FFFF) | (ZeroExtend32(value) << 16);
       Log_DebugPrintf("SPU pitch modulation enable register <- 0x%08X", s_pitch_modulation_enable_register);
+      UpdateEventInterval();
     }
     break;
 
@@ -858,6 +920,7 @@ void SPU::WriteRegister(u32 offset, u16 value)
       if (IsRAMIRQTriggerable())
         CheckForLateRAMIRQs();
 
+      UpdateEventInterval();
       return;
     }
 
@@ -1027,8 +1090,9 @@ void SPU::WriteVoiceRegister(u32 offset, u16 value)
   const u32 voice_index = (offset / 0x10);
   DebugAssert(voice_index < 24);
 
+  // Voices keep stepping while off when the IRQ is enabled, so the pitch has to be applied at the right time.
   Voice& voice = s_voices[voice_index];
-  if (voice.IsOn() || s_key_on_register & (1u << voice_index))
+  if (voice.IsOn() || s_key_on_register & (1u << voice_index) || IsTickEventLimitedByRAMIRQ())
     GeneratePendingSamples();
 
   switch (reg_index)
@@ -1053,6 +1117,7 @@ void SPU::WriteVoiceRegister(u32 offset, u16 value)
     {
       Log_DebugPrintf("SPU voice %u ADPCM sample rate <- 0x%04X", voice_index, value);
       voice.regs.adpcm_sample_rate = value;
+      UpdateEventInterval();
     }
     break;
 
@@ -1182,6 +1247,47 @@ void SPU::CheckForLateRAMIRQs()
   }
 }
 
+bool SPU::IsTickEventLimitedByRAMIRQ()
+{
+  return s_SPUCNT.enable && IsRAMIRQTriggerable();
+}
+
+u32 SPU::GetFramesUntilNextRAMIRQCheck(u32 max_frames)
+{
+  // Key on is applied after the first frame, so be conservative and stop there.
+  if (s_key_on_register != 0)
+    return 1;
+
+  // The capture buffers are written every frame, at the same offset in all four channels.
+  u32 frames = max_frames;
+  const u32 irq_address = ZeroExtend32(s_irq_address) * 8;
+  if (irq_address < (CAPTURE_BUFFER_SIZE_PER_CHANNEL * 4))
+  {
+    const u32 distance = (irq_address - ZeroExtend32(s_capture_buffer_position)) % CAPTURE_BUFFER_SIZE_PER_CHANNEL;
+    frames = std::min(frames, (distance / static_cast<u32>(sizeof(s16))) + 1);
+  }
+
+  // Voices only check the IRQ address when they read a new block. We don't know where the voice will jump to at the
+  // end of the block, but it can't get there any faster than the maximum step, so that's a safe lower bound.
+  for (u32 i = 0; i < NUM_VOICES; i++)
+  {
+    const Voice& voice = s_voices[i];
+    if (!voice.has_samples)
+      return 1;
+
+    const u32 max_step =
+      IsPitchModulationEnabled(i) ? 0x3FFFu : std::min<u32>(ZeroExtend32(voice.regs.adpcm_sample_rate), 0x3FFFu);
+    if (max_step == 0)
+      continue;
+
+    // The block ends on the frame where the counter steps past it, and the next block is read on the frame after.
+    const u32 remaining = (static_cast<u32>(NUM_SAMPLES_PER_ADPCM_BLOCK) << 12) - (voice.counter.bits & 0x1FFFFu);
+    frames = std::min(frames, ((remaining + max_step - 1) / max_step) + 1);
+  }
+
+  return frames;
+}
+
 void SPU::WriteToCaptureBuffer(u32 index, s16 value)
 {
   const u32 ram_address = (index * CAPTURE_BUFFER_SIZE_PER_CHANNEL) | ZeroExtend16(s_capture_buffer_position);
@@ -1480,7 +1586,8 @@ bool SPU::StartDumpingAudio(const char* filename)
 {
   s_dump_writer.reset();
   s_dump_writer = std::make_unique<Common::WAVWriter>();
-  if (!s_dump_writer->Open(filename, SAMPLE_RATE, 2))
+  // Written from a worker thread, the CPU thread may be running well ahead of real time.
+  if (!s_dump_writer->Open(filename, SAMPLE_RATE, 2, true))
   {
     Log_ErrorPrintf("Failed to open '%s'", filename);
     s_dump_writer.reset();
@@ -1796,11 +1903,42 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   const s32 filter_neg = filter_table_neg[filter_index];
   s16 last_samples[2] = {adpcm_last_samples[0], adpcm_last_samples[1]};
 
+  // extend 4-bit to 16-bit and apply shift from header, the filter is serial so only this part is vectorized
+  alignas(16) std::array<s16, 32> nibbles;
+#if defined(CPU_ARCH_SSE)
+  const __m128i bytes = _mm_srli_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&block)), 2);
+  const __m128i nibble_mask = _mm_set1_epi8(static_cast<char>(0xF0));
+  const __m128i low = _mm_and_si128(_mm_slli_epi16(bytes, 4), nibble_mask);
+  const __m128i high = _mm_and_si128(bytes, nibble_mask);
+  const __m128i nibbles0 = _mm_unpacklo_epi8(low, high);
+  const __m128i nibbles1 = _mm_unpackhi_epi8(low, high);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i vshift = _mm_cvtsi32_si128(shift);
+  _mm_store_si128(reinterpret_cast<__m128i*>(&nibbles[0]), _mm_sra_epi16(_mm_unpacklo_epi8(zero, nibbles0), vshift));
+  _mm_store_si128(reinterpret_cast<__m128i*>(&nibbles[8]), _mm_sra_epi16(_mm_unpackhi_epi8(zero, nibbles0), vshift));
+  _mm_store_si128(reinterpret_cast<__m128i*>(&nibbles[16]), _mm_sra_epi16(_mm_unpacklo_epi8(zero, nibbles1), vshift));
+  _mm_store_si128(reinterpret_cast<__m128i*>(&nibbles[24]), _mm_sra_epi16(_mm_unpackhi_epi8(zero, nibbles1), vshift));
+#elif defined(CPU_ARCH_NEON)
+  const uint8x16_t bytes = vextq_u8(vld1q_u8(reinterpret_cast<const u8*>(&block)), vdupq_n_u8(0), 2);
+  const uint8x16_t low = vshlq_n_u8(bytes, 4);
+  const uint8x16_t high = vandq_u8(bytes, vdupq_n_u8(0xF0));
+  const uint8x16_t nibbles0 = vzip1q_u8(low, high);
+  const uint8x16_t nibbles1 = vzip2q_u8(low, high);
+  const int16x8_t vshift = vdupq_n_s16(-static_cast<s16>(shift));
+  vst1q_s16(&nibbles[0], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(nibbles0), 8)), vshift));
+  vst1q_s16(&nibbles[8], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(nibbles0), 8)), vshift));
+  vst1q_s16(&nibbles[16], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(nibbles1), 8)), vshift));
+  vst1q_s16(&nibbles[24], vshlq_s16(vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(nibbles1), 8)), vshift));
+#else
+  for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
+    nibbles[i] = static_cast<s16>(ZeroExtend16(block.GetNibble(i)) << 12) >> shift;
+#endif
+
   // samples
   for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
   {
-    // extend 4-bit to 16-bit, apply shift from header and mix in previous samples
-    s32 sample = s32(static_cast<s16>(ZeroExtend16(block.GetNibble(i)) << 12) >> shift);
+    // mix in previous samples
+    s32 sample = s32(nibbles[i]);
     sample += (last_samples[0] * filter_pos) >> 6;
     sample += (last_samples[1] * filter_neg) >> 6;
 
@@ -1812,84 +1950,72 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   current_block_flags.bits = block.flags.bits;
 }
 
-s32 SPU::Voice::Interpolate() const
-{
-  static constexpr std::array<s16, 0x200> gauss = {{
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
-    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
-    0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
-    0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
-    0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
-    0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
-    0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
-    0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
-    0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
-    0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
-    0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
-    0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
-    0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
-    0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
-    0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
-    0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
-    0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
-    0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
-    0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
-    0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
-    0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
-    0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
-    0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
-    0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
-    0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
-    0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
-    0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
-    0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
-    0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
-    0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
-    0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
-    0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
-    0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
-    0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
-    0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
-    0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
-    0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
-    0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
-    0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
-    0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
-    0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
-    0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
-    0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
-    0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
-    0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
-    0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
-    0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
-    0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
-    0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
-    0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
-    0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
-    0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
-    0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
-    0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
-    0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
-    0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
-    0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
-    0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
-    0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
-    0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
-    0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
-    0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
-    0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
-  }};
-
-  const u8 i = counter.interpolation_index;
-  const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(counter.sample_index.GetValue());
-
-  s32 out = s32(gauss[0x0FF - i]) * s32(current_block_samples[s - 3]);
-  out += s32(gauss[0x1FF - i]) * s32(current_block_samples[s - 2]);
-  out += s32(gauss[0x100 + i]) * s32(current_block_samples[s - 1]);
-  out += s32(gauss[0x000 + i]) * s32(current_block_samples[s - 0]);
-  return out >> 15;
-}
+static constexpr std::array<s16, 0x200> s_gauss_table = {{
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, -0x001, //
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0001, //
+  0x0001, 0x0001, 0x0001, 0x0002, 0x0002, 0x0002, 0x0003, 0x0003, //
+  0x0003, 0x0004, 0x0004, 0x0005, 0x0005, 0x0006, 0x0007, 0x0007, //
+  0x0008, 0x0009, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, //
+  0x000F, 0x0010, 0x0011, 0x0012, 0x0013, 0x0015, 0x0016, 0x0018, // entry
+  0x0019, 0x001B, 0x001C, 0x001E, 0x0020, 0x0021, 0x0023, 0x0025, // 000..07F
+  0x0027, 0x0029, 0x002C, 0x002E, 0x0030, 0x0033, 0x0035, 0x0038, //
+  0x003A, 0x003D, 0x0040, 0x0043, 0x0046, 0x0049, 0x004D, 0x0050, //
+  0x0054, 0x0057, 0x005B, 0x005F, 0x0063, 0x0067, 0x006B, 0x006F, //
+  0x0074, 0x0078, 0x007D, 0x0082, 0x0087, 0x008C, 0x0091, 0x0096, //
+  0x009C, 0x00A1, 0x00A7, 0x00AD, 0x00B3, 0x00BA, 0x00C0, 0x00C7, //
+  0x00CD, 0x00D4, 0x00DB, 0x00E3, 0x00EA, 0x00F2, 0x00FA, 0x0101, //
+  0x010A, 0x0112, 0x011B, 0x0123, 0x012C, 0x0135, 0x013F, 0x0148, //
+  0x0152, 0x015C, 0x0166, 0x0171, 0x017B, 0x0186, 0x0191, 0x019C, //
+  0x01A8, 0x01B4, 0x01C0, 0x01CC, 0x01D9, 0x01E5, 0x01F2, 0x0200, //
+  0x020D, 0x021B, 0x0229, 0x0237, 0x0246, 0x0255, 0x0264, 0x0273, //
+  0x0283, 0x0293, 0x02A3, 0x02B4, 0x02C4, 0x02D6, 0x02E7, 0x02F9, //
+  0x030B, 0x031D, 0x0330, 0x0343, 0x0356, 0x036A, 0x037E, 0x0392, //
+  0x03A7, 0x03BC, 0x03D1, 0x03E7, 0x03FC, 0x0413, 0x042A, 0x0441, //
+  0x0458, 0x0470, 0x0488, 0x04A0, 0x04B9, 0x04D2, 0x04EC, 0x0506, //
+  0x0520, 0x053B, 0x0556, 0x0572, 0x058E, 0x05AA, 0x05C7, 0x05E4, // entry
+  0x0601, 0x061F, 0x063E, 0x065C, 0x067C, 0x069B, 0x06BB, 0x06DC, // 080..0FF
+  0x06FD, 0x071E, 0x0740, 0x0762, 0x0784, 0x07A7, 0x07CB, 0x07EF, //
+  0x0813, 0x0838, 0x085D, 0x0883, 0x08A9, 0x08D0, 0x08F7, 0x091E, //
+  0x0946, 0x096F, 0x0998, 0x09C1, 0x09EB, 0x0A16, 0x0A40, 0x0A6C, //
+  0x0A98, 0x0AC4, 0x0AF1, 0x0B1E, 0x0B4C, 0x0B7A, 0x0BA9, 0x0BD8, //
+  0x0C07, 0x0C38, 0x0C68, 0x0C99, 0x0CCB, 0x0CFD, 0x0D30, 0x0D63, //
+  0x0D97, 0x0DCB, 0x0E00, 0x0E35, 0x0E6B, 0x0EA1, 0x0ED7, 0x0F0F, //
+  0x0F46, 0x0F7F, 0x0FB7, 0x0FF1, 0x102A, 0x1065, 0x109F, 0x10DB, //
+  0x1116, 0x1153, 0x118F, 0x11CD, 0x120B, 0x1249, 0x1288, 0x12C7, //
+  0x1307, 0x1347, 0x1388, 0x13C9, 0x140B, 0x144D, 0x1490, 0x14D4, //
+  0x1517, 0x155C, 0x15A0, 0x15E6, 0x162C, 0x1672, 0x16B9, 0x1700, //
+  0x1747, 0x1790, 0x17D8, 0x1821, 0x186B, 0x18B5, 0x1900, 0x194B, //
+  0x1996, 0x19E2, 0x1A2E, 0x1A7B, 0x1AC8, 0x1B16, 0x1B64, 0x1BB3, //
+  0x1C02, 0x1C51, 0x1CA1, 0x1CF1, 0x1D42, 0x1D93, 0x1DE5, 0x1E37, //
+  0x1E89, 0x1EDC, 0x1F2F, 0x1F82, 0x1FD6, 0x202A, 0x207F, 0x20D4, //
+  0x2129, 0x217F, 0x21D5, 0x222C, 0x2282, 0x22DA, 0x2331, 0x2389, // entry
+  0x23E1, 0x2439, 0x2492, 0x24EB, 0x2545, 0x259E, 0x25F8, 0x2653, // 100..17F
+  0x26AD, 0x2708, 0x2763, 0x27BE, 0x281A, 0x2876, 0x28D2, 0x292E, //
+  0x298B, 0x29E7, 0x2A44, 0x2AA1, 0x2AFF, 0x2B5C, 0x2BBA, 0x2C18, //
+  0x2C76, 0x2CD4, 0x2D33, 0x2D91, 0x2DF0, 0x2E4F, 0x2EAE, 0x2F0D, //
+  0x2F6C, 0x2FCC, 0x302B, 0x308B, 0x30EA, 0x314A, 0x31AA, 0x3209, //
+  0x3269, 0x32C9, 0x3329, 0x3389, 0x33E9, 0x3449, 0x34A9, 0x3509, //
+  0x3569, 0x35C9, 0x3629, 0x3689, 0x36E8, 0x3748, 0x37A8, 0x3807, //
+  0x3867, 0x38C6, 0x3926, 0x3985, 0x39E4, 0x3A43, 0x3AA2, 0x3B00, //
+  0x3B5F, 0x3BBD, 0x3C1B, 0x3C79, 0x3CD7, 0x3D35, 0x3D92, 0x3DEF, //
+  0x3E4C, 0x3EA9, 0x3F05, 0x3F62, 0x3FBD, 0x4019, 0x4074, 0x40D0, //
+  0x412A, 0x4185, 0x41DF, 0x4239, 0x4292, 0x42EB, 0x4344, 0x439C, //
+  0x43F4, 0x444C, 0x44A3, 0x44FA, 0x4550, 0x45A6, 0x45FC, 0x4651, //
+  0x46A6, 0x46FA, 0x474E, 0x47A1, 0x47F4, 0x4846, 0x4898, 0x48E9, //
+  0x493A, 0x498A, 0x49D9, 0x4A29, 0x4A77, 0x4AC5, 0x4B13, 0x4B5F, //
+  0x4BAC, 0x4BF7, 0x4C42, 0x4C8D, 0x4CD7, 0x4D20, 0x4D68, 0x4DB0, //
+  0x4DF7, 0x4E3E, 0x4E84, 0x4EC9, 0x4F0E, 0x4F52, 0x4F95, 0x4FD7, // entry
+  0x5019, 0x505A, 0x509A, 0x50DA, 0x5118, 0x5156, 0x5194, 0x51D0, // 180..1FF
+  0x520C, 0x5247, 0x5281, 0x52BA, 0x52F3, 0x532A, 0x5361, 0x5397, //
+  0x53CC, 0x5401, 0x5434, 0x5467, 0x5499, 0x54CA, 0x54FA, 0x5529, //
+  0x5558, 0x5585, 0x55B2, 0x55DE, 0x5609, 0x5632, 0x565B, 0x5684, //
+  0x56AB, 0x56D1, 0x56F6, 0x571B, 0x573E, 0x5761, 0x5782, 0x57A3, //
+  0x57C3, 0x57E2, 0x57FF, 0x581C, 0x5838, 0x5853, 0x586D, 0x5886, //
+  0x589E, 0x58B5, 0x58CB, 0x58E0, 0x58F4, 0x5907, 0x5919, 0x592A, //
+  0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, //
+  0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3  //
+}};
 
 void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
 {
@@ -1918,24 +2044,30 @@ void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
   }
 }
 
-ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
+u32 SPU::PrepareVoices()
 {
-  Voice& voice = s_voices[voice_index];
-  if (!voice.IsOn() && !s_SPUCNT.irq9_enable)
+  // Voices which are off still need to be sampled when IRQs are enabled, since reading blocks can trigger them.
+  u32 active_voices = 0;
+  for (u32 voice_index = 0; voice_index < NUM_VOICES; voice_index++)
   {
-    voice.last_volume = 0;
-
-#ifdef SPU_DUMP_ALL_VOICES
-    if (s_voice_dump_writers[voice_index])
+    if (s_voices[voice_index].IsOn() || s_SPUCNT.irq9_enable)
     {
-      const s16 dump_samples[2] = {0, 0};
-      s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
+      PrepareVoice(voice_index);
+      active_voices |= (1u << voice_index);
+    }
+    else
+    {
+      // zero volume mutes the voice regardless of what's left in the interpolation inputs
+      s_voice_mix.adsr_volume[voice_index] = 0;
     }
-#endif
-
-    return {};
   }
 
+  return active_voices;
+}
+
+ALWAYS_INLINE_RELEASE void SPU::PrepareVoice(u32 voice_index)
+{
+  Voice& voice = s_voices[voice_index];
   if (!voice.has_samples)
   {
     ADPCMBlock block;
@@ -1950,26 +2082,111 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
     }
   }
 
-  // skip interpolation when the volume is muted anyway
-  s32 volume;
-  if (voice.regs.adsr_volume != 0)
+  s16* coefficients = &s_voice_mix.interp_coefficients[voice_index * 4];
+  s16* samples = &s_voice_mix.interp_samples[voice_index * 4];
+  if (IsVoiceNoiseEnabled(voice_index))
   {
-    // interpolate/sample and apply ADSR volume
-    s32 sample;
-    if (IsVoiceNoiseEnabled(voice_index))
-      sample = GetVoiceNoiseLevel();
-    else
-      sample = voice.Interpolate();
-
-    volume = ApplyVolume(sample, voice.regs.adsr_volume);
+    // (noise * 0x4000 + noise * 0x4000) >> 15 is exactly the noise level
+    const s16 noise = GetVoiceNoiseLevel();
+    coefficients[0] = 0x4000;
+    coefficients[1] = 0x4000;
+    coefficients[2] = 0;
+    coefficients[3] = 0;
+    samples[0] = noise;
+    samples[1] = noise;
+    samples[2] = 0;
+    samples[3] = 0;
   }
   else
   {
-    volume = 0;
+    const u8 i = voice.counter.interpolation_index;
+    const u32 s = NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + ZeroExtend32(voice.counter.sample_index.GetValue());
+    coefficients[0] = s_gauss_table[0x0FF - i];
+    coefficients[1] = s_gauss_table[0x1FF - i];
+    coefficients[2] = s_gauss_table[0x100 + i];
+    coefficients[3] = s_gauss_table[0x000 + i];
+    samples[0] = voice.current_block_samples[s - 3];
+    samples[1] = voice.current_block_samples[s - 2];
+    samples[2] = voice.current_block_samples[s - 1];
+    samples[3] = voice.current_block_samples[s - 0];
+  }
+
+  s_voice_mix.adsr_volume[voice_index] = voice.regs.adsr_volume;
+}
+
+#if defined(CPU_ARCH_SSE)
+
+// Multiplies s32 lanes which are known to fit in 16 bits by s16 volumes, and shifts the products down. madd() against
+// the volumes zero extended to 32 bits gives the exact product, since the upper half of each pair is zero.
+ALWAYS_INLINE static __m128i ApplyVolume4(__m128i samples, const s16* volumes)
+{
+  const __m128i vvolumes =
+    _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(volumes)), _mm_setzero_si128());
+  return _mm_srai_epi32(_mm_madd_epi16(samples, vvolumes), 15);
+}
+
+#elif defined(CPU_ARCH_NEON)
+
+ALWAYS_INLINE static int32x4_t ApplyVolume4(int32x4_t samples, const s16* volumes)
+{
+  return vshrq_n_s32(vmull_s16(vmovn_s32(samples), vld1_s16(volumes)), 15);
+}
+
+#endif
+
+void SPU::MixVoiceVolumes()
+{
+  // Interpolated samples always fit in 16 bits, the gaussian table sums to less than 0x8000.
+  VoiceMix& vm = s_voice_mix;
+#if defined(CPU_ARCH_SSE)
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const __m128i x = _mm_madd_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(&vm.interp_coefficients[i * 4])),
+                                     _mm_load_si128(reinterpret_cast<const __m128i*>(&vm.interp_samples[i * 4])));
+    const __m128i y =
+      _mm_madd_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(&vm.interp_coefficients[i * 4 + 8])),
+                     _mm_load_si128(reinterpret_cast<const __m128i*>(&vm.interp_samples[i * 4 + 8])));
+    const __m128 xf = _mm_castsi128_ps(x);
+    const __m128 yf = _mm_castsi128_ps(y);
+    const __m128i sum = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(xf, yf, _MM_SHUFFLE(2, 0, 2, 0))),
+                                      _mm_castps_si128(_mm_shuffle_ps(xf, yf, _MM_SHUFFLE(3, 1, 3, 1))));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&vm.volume[i]),
+                    ApplyVolume4(_mm_srai_epi32(sum, 15), &vm.adsr_volume[i]));
+  }
+#elif defined(CPU_ARCH_NEON)
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const int32x4_t p0 = vmull_s16(vld1_s16(&vm.interp_coefficients[i * 4]), vld1_s16(&vm.interp_samples[i * 4]));
+    const int32x4_t p1 =
+      vmull_s16(vld1_s16(&vm.interp_coefficients[i * 4 + 4]), vld1_s16(&vm.interp_samples[i * 4 + 4]));
+    const int32x4_t p2 =
+      vmull_s16(vld1_s16(&vm.interp_coefficients[i * 4 + 8]), vld1_s16(&vm.interp_samples[i * 4 + 8]));
+    const int32x4_t p3 =
+      vmull_s16(vld1_s16(&vm.interp_coefficients[i * 4 + 12]), vld1_s16(&vm.interp_samples[i * 4 + 12]));
+    const int32x4_t sum = vpaddq_s32(vpaddq_s32(p0, p1), vpaddq_s32(p2, p3));
+    vst1q_s32(&vm.volume[i], ApplyVolume4(vshrq_n_s32(sum, 15), &vm.adsr_volume[i]));
+  }
+#else
+  for (u32 i = 0; i < NUM_VOICES; i++)
+  {
+    const s16* coefficients = &vm.interp_coefficients[i * 4];
+    const s16* samples = &vm.interp_samples[i * 4];
+    s32 out = s32(coefficients[0]) * s32(samples[0]);
+    out += s32(coefficients[1]) * s32(samples[1]);
+    out += s32(coefficients[2]) * s32(samples[2]);
+    out += s32(coefficients[3]) * s32(samples[3]);
+    vm.volume[i] = ApplyVolume(out >> 15, vm.adsr_volume[i]);
   }
+#endif
 
-  voice.last_volume = volume;
+  // needed by pitch modulation of the next voice and the capture buffers
+  for (u32 i = 0; i < NUM_VOICES; i++)
+    s_voices[i].last_volume = vm.volume[i];
+}
 
+ALWAYS_INLINE_RELEASE void SPU::AdvanceVoice(u32 voice_index)
+{
+  Voice& voice = s_voices[voice_index];
   if (voice.adsr_phase != ADSRPhase::Off)
     voice.TickADSR();
 
@@ -2014,21 +2231,37 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
     }
   }
 
-  // apply per-channel volume
-  const s32 left = ApplyVolume(volume, voice.left_volume.current_level);
-  const s32 right = ApplyVolume(volume, voice.right_volume.current_level);
+  // per-channel volume is applied with the other voices, using the level from before the sweep
+  s_voice_mix.left_level[voice_index] = voice.left_volume.current_level;
+  s_voice_mix.right_level[voice_index] = voice.right_volume.current_level;
   voice.left_volume.Tick();
   voice.right_volume.Tick();
+}
 
-#ifdef SPU_DUMP_ALL_VOICES
-  if (s_voice_dump_writers[voice_index])
+void SPU::MixVoiceOutputs()
+{
+  VoiceMix& vm = s_voice_mix;
+#if defined(CPU_ARCH_SSE)
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
+  {
+    const __m128i volume = _mm_load_si128(reinterpret_cast<const __m128i*>(&vm.volume[i]));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&vm.left[i]), ApplyVolume4(volume, &vm.left_level[i]));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&vm.right[i]), ApplyVolume4(volume, &vm.right_level[i]));
+  }
+#elif defined(CPU_ARCH_NEON)
+  for (u32 i = 0; i < NUM_VOICES; i += 4)
   {
-    const s16 dump_samples[2] = {static_cast<s16>(Clamp16(left)), static_cast<s16>(Clamp16(right))};
-    s_voice_dump_writers[voice_index]->WriteFrames(dump_samples, 1);
+    const int32x4_t volume = vld1q_s32(&vm.volume[i]);
+    vst1q_s32(&vm.left[i], ApplyVolume4(volume, &vm.left_level[i]));
+    vst1q_s32(&vm.right[i], ApplyVolume4(volume, &vm.right_level[i]));
+  }
+#else
+  for (u32 i = 0; i < NUM_VOICES; i++)
+  {
+    vm.left[i] = ApplyVolume(vm.volume[i], vm.left_level[i]);
+    vm.right[i] = ApplyVolume(vm.volume[i], vm.right_level[i]);
   }
 #endif
-
-  return std::make_tuple(left, right);
 }
 
 void SPU::UpdateNoise()
@@ -2071,20 +2304,73 @@ u32 SPU::ReverbMemoryAddress(u32 address)
   return (offset & MASK) * 2u;
 }
 
-s16 SPU::ReverbRead(u32 address, s32 offset)
+void SPU::ComputeReverbTapAddresses(ReverbTapAddresses* taps)
 {
-  // TODO: This should check interrupts.
-  const u32 real_address = ReverbMemoryAddress((address << 2) + offset);
+  // Word offsets of each tap, relative to the current address.
+  for (u32 lr = 0; lr < 2; lr++)
+  {
+    u32* addr = taps->addresses[lr].data();
+    addr[REVERB_TAP_IIR_SRC_A] = ZeroExtend32(s_reverb_registers.IIR_SRC_A[lr ^ 0]) << 2;
+    addr[REVERB_TAP_IIR_SRC_B] = ZeroExtend32(s_reverb_registers.IIR_SRC_B[lr ^ 1]) << 2;
+    addr[REVERB_TAP_IIR_DEST_A_PREV] = (ZeroExtend32(s_reverb_registers.IIR_DEST_A[lr]) << 2) - 1;
+    addr[REVERB_TAP_IIR_DEST_B_PREV] = (ZeroExtend32(s_reverb_registers.IIR_DEST_B[lr]) << 2) - 1;
+    addr[REVERB_TAP_IIR_DEST_A] = ZeroExtend32(s_reverb_registers.IIR_DEST_A[lr]) << 2;
+    addr[REVERB_TAP_IIR_DEST_B] = ZeroExtend32(s_reverb_registers.IIR_DEST_B[lr]) << 2;
+    addr[REVERB_TAP_ACC_SRC_A] = ZeroExtend32(s_reverb_registers.ACC_SRC_A[lr]) << 2;
+    addr[REVERB_TAP_ACC_SRC_B] = ZeroExtend32(s_reverb_registers.ACC_SRC_B[lr]) << 2;
+    addr[REVERB_TAP_ACC_SRC_C] = ZeroExtend32(s_reverb_registers.ACC_SRC_C[lr]) << 2;
+    addr[REVERB_TAP_ACC_SRC_D] = ZeroExtend32(s_reverb_registers.ACC_SRC_D[lr]) << 2;
+    addr[REVERB_TAP_FB_SRC_A] =
+      static_cast<u32>(s_reverb_registers.MIX_DEST_A[lr] - s_reverb_registers.FB_SRC_A) << 2;
+    addr[REVERB_TAP_FB_SRC_B] =
+      static_cast<u32>(s_reverb_registers.MIX_DEST_B[lr] - s_reverb_registers.FB_SRC_B) << 2;
+    addr[REVERB_TAP_MIX_DEST_A] = ZeroExtend32(s_reverb_registers.MIX_DEST_A[lr]) << 2;
+    addr[REVERB_TAP_MIX_DEST_B] = ZeroExtend32(s_reverb_registers.MIX_DEST_B[lr]) << 2;
+    addr[REVERB_TAP_PADDING_0] = 0;
+    addr[REVERB_TAP_PADDING_1] = 0;
+  }
+
+  // Then wrap them all into the work area in one go, same as ReverbMemoryAddress().
+  static constexpr u32 MASK = (RAM_SIZE - 1) / 2;
+  u32* addr = taps->addresses[0].data();
+#if defined(CPU_ARCH_SSE)
+  const __m128i mask = _mm_set1_epi32(MASK);
+  const __m128i current = _mm_set1_epi32(s_reverb_current_address);
+  const __m128i base = _mm_set1_epi32(s_reverb_base_address);
+  for (u32 i = 0; i < NUM_REVERB_TAPS * 2; i += 4)
+  {
+    __m128i offset = _mm_add_epi32(current, _mm_and_si128(_mm_load_si128(reinterpret_cast<__m128i*>(&addr[i])), mask));
+    offset = _mm_add_epi32(offset, _mm_and_si128(base, _mm_srai_epi32(_mm_slli_epi32(offset, 13), 31)));
+    _mm_store_si128(reinterpret_cast<__m128i*>(&addr[i]), _mm_slli_epi32(_mm_and_si128(offset, mask), 1));
+  }
+#elif defined(CPU_ARCH_NEON)
+  const uint32x4_t mask = vdupq_n_u32(MASK);
+  const uint32x4_t current = vdupq_n_u32(s_reverb_current_address);
+  const uint32x4_t base = vdupq_n_u32(s_reverb_base_address);
+  for (u32 i = 0; i < NUM_REVERB_TAPS * 2; i += 4)
+  {
+    uint32x4_t offset = vaddq_u32(current, vandq_u32(vld1q_u32(&addr[i]), mask));
+    offset = vaddq_u32(
+      offset, vandq_u32(base, vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(vshlq_n_u32(offset, 13)), 31))));
+    vst1q_u32(&addr[i], vshlq_n_u32(vandq_u32(offset, mask), 1));
+  }
+#else
+  for (u32 i = 0; i < NUM_REVERB_TAPS * 2; i++)
+    addr[i] = ReverbMemoryAddress(addr[i]);
+#endif
+}
 
+s16 SPU::ReverbRead(u32 real_address)
+{
+  // TODO: This should check interrupts.
   s16 data;
   std::memcpy(&data, &s_ram[real_address], sizeof(data));
   return data;
 }
 
-void SPU::ReverbWrite(u32 address, s16 data)
+void SPU::ReverbWrite(u32 real_address, s16 data)
 {
   // TODO: This should check interrupts.
-  const u32 real_address = ReverbMemoryAddress(address << 2);
   std::memcpy(&s_ram[real_address], &data, sizeof(data));
 }
 
@@ -2092,19 +2378,63 @@ void SPU::ReverbWrite(u32 address, s16 data)
 static constexpr std::array<s16, 20> s_reverb_resample_coefficients = {
   -1, 2, -10, 35, -103, 266, -616, 1332, -2960, 10246, 10246, -2960, 1332, -616, 266, -103, 35, -10, 2, -1,
 };
+
+// Same coefficients, expanded back out so the filters can run as plain dot products. The downsampler reads every
+// other input with the middle tap, the upsampler's odd phase only uses the middle tap so it is left out. Both are
+// padded with zeroes to a multiple of 8 taps; the buffers are doubled so reading past the window is still in bounds.
+static constexpr std::array<s16, 40> s_reverb_downsample_coefficients = []() {
+  std::array<s16, 40> ret = {};
+  for (u32 i = 0; i < 20; i++)
+    ret[i * 2] = s_reverb_resample_coefficients[i];
+  ret[19] = 0x4000;
+  return ret;
+}();
+static constexpr std::array<s16, 24> s_reverb_upsample_coefficients = []() {
+  std::array<s16, 24> ret = {};
+  for (u32 i = 0; i < 20; i++)
+    ret[i] = s_reverb_resample_coefficients[i];
+  return ret;
+}();
+
 static s16 s_last_reverb_input[2];
 static s32 s_last_reverb_output[2];
 
-ALWAYS_INLINE static s32 Reverb4422(const s16* src)
+// Sums never overflow 32 bits: the absolute coefficients add up to less than 0xC000.
+template<size_t NUM_TAPS>
+ALWAYS_INLINE static s32 ReverbFilter(const s16* src, const std::array<s16, NUM_TAPS>& coefficients)
 {
-  s32 out = 0; // 32-bits is adequate(it won't overflow)
-  for (u32 i = 0; i < 20; i++)
-    out += s_reverb_resample_coefficients[i] * src[i * 2];
+  static_assert((NUM_TAPS % 8) == 0);
+#if defined(CPU_ARCH_SSE)
+  __m128i sum = _mm_setzero_si128();
+  for (size_t i = 0; i < NUM_TAPS; i += 8)
+  {
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&src[i])),
+                                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(&coefficients[i]))));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+#elif defined(CPU_ARCH_NEON)
+  int32x4_t sum = vdupq_n_s32(0);
+  for (size_t i = 0; i < NUM_TAPS; i += 8)
+  {
+    const int16x8_t s = vld1q_s16(&src[i]);
+    const int16x8_t c = vld1q_s16(&coefficients[i]);
+    sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(c));
+    sum = vmlal_high_s16(sum, s, c);
+  }
+  return vaddvq_s32(sum);
+#else
+  s32 out = 0;
+  for (size_t i = 0; i < NUM_TAPS; i++)
+    out += s32(coefficients[i]) * s32(src[i]);
+  return out;
+#endif
+}
 
-  // Middle non-zero
-  out += 0x4000 * src[19];
-  out >>= 15;
-  return std::clamp<s32>(out, -32768, 32767);
+ALWAYS_INLINE static s32 Reverb4422(const s16* src)
+{
+  return std::clamp<s32>(ReverbFilter(src, s_reverb_downsample_coefficients) >> 15, -32768, 32767);
 }
 
 template<bool phase>
@@ -2118,11 +2448,7 @@ ALWAYS_INLINE static s32 Reverb2244(const s16* src)
   }
   else
   {
-    out = 0;
-    for (u32 i = 0; i < 20; i++)
-      out += s_reverb_resample_coefficients[i] * src[i];
-
-    out >>= 14;
+    out = ReverbFilter(src, s_reverb_upsample_coefficients) >> 14;
     out = std::clamp<s32>(out, -32768, 32767);
   }
 
@@ -2171,38 +2497,43 @@ void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out
     for (unsigned lr = 0; lr < 2; lr++)
       downsampled[lr] = Reverb4422(&s_reverb_downsample_buffer[lr][(s_reverb_resample_buffer_position - 38) & 0x3F]);
 
+    // Addresses only depend on the registers and the current address, so they can all be wrapped up front.
+    ReverbTapAddresses tap_addresses;
+    ComputeReverbTapAddresses(&tap_addresses);
+
     for (unsigned lr = 0; lr < 2; lr++)
     {
+      const u32* taps = tap_addresses.addresses[lr].data();
       if (s_SPUCNT.reverb_master_enable)
       {
         const s16 IIR_INPUT_A =
-          ReverbSat((((ReverbRead(s_reverb_registers.IIR_SRC_A[lr ^ 0]) * s_reverb_registers.IIR_COEF) >> 14) +
+          ReverbSat((((ReverbRead(taps[REVERB_TAP_IIR_SRC_A]) * s_reverb_registers.IIR_COEF) >> 14) +
                      ((downsampled[lr] * s_reverb_registers.IN_COEF[lr]) >> 14)) >>
                     1);
         const s16 IIR_INPUT_B =
-          ReverbSat((((ReverbRead(s_reverb_registers.IIR_SRC_B[lr ^ 1]) * s_reverb_registers.IIR_COEF) >> 14) +
+          ReverbSat((((ReverbRead(taps[REVERB_TAP_IIR_SRC_B]) * s_reverb_registers.IIR_COEF) >> 14) +
                      ((downsampled[lr] * s_reverb_registers.IN_COEF[lr]) >> 14)) >>
                     1);
         const s16 IIR_A =
           ReverbSat((((IIR_INPUT_A * s_reverb_registers.IIR_ALPHA) >> 14) +
-                     (IIASM(s_reverb_registers.IIR_ALPHA, ReverbRead(s_reverb_registers.IIR_DEST_A[lr], -1)) >> 14)) >>
+                     (IIASM(s_reverb_registers.IIR_ALPHA, ReverbRead(taps[REVERB_TAP_IIR_DEST_A_PREV])) >> 14)) >>
                     1);
         const s16 IIR_B =
           ReverbSat((((IIR_INPUT_B * s_reverb_registers.IIR_ALPHA) >> 14) +
-                     (IIASM(s_reverb_registers.IIR_ALPHA, ReverbRead(s_reverb_registers.IIR_DEST_B[lr], -1)) >> 14)) >>
+                     (IIASM(s_reverb_registers.IIR_ALPHA, ReverbRead(taps[REVERB_TAP_IIR_DEST_B_PREV])) >> 14)) >>
                     1);
 
-        ReverbWrite(s_reverb_registers.IIR_DEST_A[lr], IIR_A);
-        ReverbWrite(s_reverb_registers.IIR_DEST_B[lr], IIR_B);
+        ReverbWrite(taps[REVERB_TAP_IIR_DEST_A], IIR_A);
+        ReverbWrite(taps[REVERB_TAP_IIR_DEST_B], IIR_B);
       }
 
-      const s32 ACC = ((ReverbRead(s_reverb_registers.ACC_SRC_A[lr]) * s_reverb_registers.ACC_COEF_A) >> 14) +
-                      ((ReverbRead(s_reverb_registers.ACC_SRC_B[lr]) * s_reverb_registers.ACC_COEF_B) >> 14) +
-                      ((ReverbRead(s_reverb_registers.ACC_SRC_C[lr]) * s_reverb_registers.ACC_COEF_C) >> 14) +
-                      ((ReverbRead(s_reverb_registers.ACC_SRC_D[lr]) * s_reverb_registers.ACC_COEF_D) >> 14);
+      const s32 ACC = ((ReverbRead(taps[REVERB_TAP_ACC_SRC_A]) * s_reverb_registers.ACC_COEF_A) >> 14) +
+                      ((ReverbRead(taps[REVERB_TAP_ACC_SRC_B]) * s_reverb_registers.ACC_COEF_B) >> 14) +
+                      ((ReverbRead(taps[REVERB_TAP_ACC_SRC_C]) * s_reverb_registers.ACC_COEF_C) >> 14) +
+                      ((ReverbRead(taps[REVERB_TAP_ACC_SRC_D]) * s_reverb_registers.ACC_COEF_D) >> 14);
 
-      const s16 FB_A = ReverbRead(s_reverb_registers.MIX_DEST_A[lr] - s_reverb_registers.FB_SRC_A);
-      const s16 FB_B = ReverbRead(s_reverb_registers.MIX_DEST_B[lr] - s_reverb_registers.FB_SRC_B);
+      const s16 FB_A = ReverbRead(taps[REVERB_TAP_FB_SRC_A]);
+      const s16 FB_B = ReverbRead(taps[REVERB_TAP_FB_SRC_B]);
       const s16 MDA = ReverbSat((ACC + ((FB_A * ReverbNeg(s_reverb_registers.FB_ALPHA)) >> 14)) >> 1);
       const s16 MDB = ReverbSat(
         FB_A +
@@ -2211,8 +2542,8 @@ void SPU::ProcessReverb(s16 left_in, s16 right_in, s32* left_out, s32* right_out
 
       if (s_SPUCNT.reverb_master_enable)
       {
-        ReverbWrite(s_reverb_registers.MIX_DEST_A[lr], MDA);
-        ReverbWrite(s_reverb_registers.MIX_DEST_B[lr], MDB);
+        ReverbWrite(taps[REVERB_TAP_MIX_DEST_A], MDA);
+        ReverbWrite(taps[REVERB_TAP_MIX_DEST_B], MDB);
       }
 
       s_reverb_upsample_buffer[lr][(s_reverb_resample_buffer_position >> 1) | 0x20] =
@@ -2264,6 +2595,12 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
     s_ticks_carry = (ticks + s_ticks_carry) % SYSCLK_TICKS_PER_SPU_TICK;
   }
 
+  if (ShouldReduceSynthesis())
+  {
+    ExecuteReduced(remaining_frames);
+    remaining_frames = 0;
+  }
+
   AudioStream* output_stream = s_audio_output_muted ? s_null_audio_stream.get() : s_audio_stream.get();
 
   while (remaining_frames > 0)
@@ -2283,9 +2620,17 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
 
       u32 reverb_on_register = s_reverb_on_register;
 
+      // Voices which are off contribute nothing, their volume is zero.
+      const u32 active_voices = PrepareVoices();
+      MixVoiceVolumes();
+      for (u32 bits = active_voices; bits != 0; bits &= (bits - 1))
+        AdvanceVoice(CountTrailingZeros(bits));
+      MixVoiceOutputs();
+
       for (u32 voice = 0; voice < NUM_VOICES; voice++)
       {
-        const auto [left, right] = SampleVoice(voice);
+        const s32 left = (active_voices & (1u << voice)) ? s_voice_mix.left[voice] : 0;
+        const s32 right = (active_voices & (1u << voice)) ? s_voice_mix.right[voice] : 0;
         left_sum += left;
         right_sum += right;
 
@@ -2295,6 +2640,14 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
           reverb_in_right += right;
         }
         reverb_on_register >>= 1;
+
+#ifdef SPU_DUMP_ALL_VOICES
+        if (s_voice_dump_writers[voice])
+        {
+          const s16 dump_samples[2] = {static_cast<s16>(Clamp16(left)), static_cast<s16>(Clamp16(right))};
+          s_voice_dump_writers[voice]->WriteFrames(dump_samples, 1);
+        }
+#endif
       }
 
       if (!s_SPUCNT.mute_n)
@@ -2346,53 +2699,108 @@ void SPU::Execute(void* param, TickCount ticks, TickCount ticks_late)
       IncrementCaptureBufferPosition();
 
       // Key off/on voices after the first frame.
-      if (i == 0 && (s_key_off_register != 0 || s_key_on_register != 0))
-      {
-        u32 key_off_register = s_key_off_register;
-        s_key_off_register = 0;
-
-        u32 key_on_register = s_key_on_register;
-        s_key_on_register = 0;
-
-        for (u32 voice = 0; voice < NUM_VOICES; voice++)
-        {
-          if (key_off_register & 1u)
-            s_voices[voice].KeyOff();
-          key_off_register >>= 1;
-
-          if (key_on_register & 1u)
-          {
-            s_endx_register &= ~(1u << voice);
-            s_voices[voice].KeyOn();
-          }
-          key_on_register >>= 1;
-        }
-      }
+      if (i == 0)
+        ProcessKeyOnOff();
     }
 
     if (s_dump_writer)
       s_dump_writer->WriteFrames(output_frame_start, frames_in_this_batch);
 
+    // Runahead replays are muted, and their frames aren't captured either.
+    if (MediaCapture* cap = System::GetMediaCapture(); cap && !s_audio_output_muted)
+      cap->DeliverAudioFrames(output_frame_start, frames_in_this_batch);
+
     output_stream->EndWrite(frames_in_this_batch);
     remaining_frames -= frames_in_this_batch;
   }
+
+  // The next slice depends on where the voices ended up if the IRQ can fire, otherwise go back to full slices.
+  const TickCount interval_ticks = GetTickEventInterval();
+  if (IsTickEventLimitedByRAMIRQ() || s_tick_event->GetInterval() != interval_ticks)
+    ScheduleTickEvent(interval_ticks);
 }
 
-void SPU::UpdateEventInterval()
+bool SPU::ShouldReduceSynthesis()
+{
+  // Runahead and rollback replays are muted as well, but the state they end in is kept, and the reverb work area in SPU
+  // RAM has to carry on from it. So only output nobody can hear qualifies, and never while the state has to match a
+  // netplay peer's, or something is recording the output.
+  return (s_audio_stream->GetOutputVolume() == 0 || System::GetTargetSpeed() == 0.0f) && !s_dump_writer &&
+         !System::GetMediaCapture() && !Netplay::IsActive();
+}
+
+void SPU::ExecuteReduced(u32 frames)
+{
+  // Only what the game can observe is run: voice addresses, ENDX, envelopes, volume sweeps, IRQs, and the capture
+  // buffers. Voice volumes are still interpolated, pitch modulation and the capture buffers depend on them, but the
+  // mix, CD audio volume and reverb are skipped, and nothing is written to the output stream.
+  for (u32 i = 0; i < frames; i++)
+  {
+    const u32 active_voices = PrepareVoices();
+    MixVoiceVolumes();
+    for (u32 bits = active_voices; bits != 0; bits &= (bits - 1))
+      AdvanceVoice(CountTrailingZeros(bits));
+
+    UpdateNoise();
+
+    // Still consumed, the CD-ROM's audio FIFO would overflow otherwise.
+    const auto [cd_audio_left, cd_audio_right] = CDROM::GetAudioFrame();
+
+    s_main_volume_left.Tick();
+    s_main_volume_right.Tick();
+
+    WriteToCaptureBuffer(0, cd_audio_left);
+    WriteToCaptureBuffer(1, cd_audio_right);
+    WriteToCaptureBuffer(2, static_cast<s16>(Clamp16(s_voices[1].last_volume)));
+    WriteToCaptureBuffer(3, static_cast<s16>(Clamp16(s_voices[3].last_volume)));
+    IncrementCaptureBufferPosition();
+
+    if (i == 0)
+      ProcessKeyOnOff();
+  }
+}
+
+void SPU::ProcessKeyOnOff()
+{
+  if (s_key_off_register == 0 && s_key_on_register == 0)
+    return;
+
+  u32 key_off_register = s_key_off_register;
+  s_key_off_register = 0;
+
+  u32 key_on_register = s_key_on_register;
+  s_key_on_register = 0;
+
+  for (u32 voice = 0; voice < NUM_VOICES; voice++)
+  {
+    if (key_off_register & 1u)
+      s_voices[voice].KeyOff();
+    key_off_register >>= 1;
+
+    if (key_on_register & 1u)
+    {
+      s_endx_register &= ~(1u << voice);
+      s_voices[voice].KeyOn();
+    }
+    key_on_register >>= 1;
+  }
+}
+
+TickCount SPU::GetTickEventInterval()
 {
   // Don't generate more than the audio buffer since in a single slice, otherwise we'll both overflow the buffers when
   // we do write it, and the audio thread will underflow since it won't have enough data it the game isn't messing with
   // the SPU state.
   const u32 max_slice_frames = s_audio_stream->GetBufferSize();
 
-  // TODO: Make this predict how long until the interrupt will be hit instead...
-  const u32 interval = (s_SPUCNT.enable && s_SPUCNT.irq9_enable) ? 1 : max_slice_frames;
-  const TickCount interval_ticks = static_cast<TickCount>(interval) * s_cpu_ticks_per_spu_tick;
-  if (s_tick_event->IsActive() && s_tick_event->GetInterval() == interval_ticks)
-    return;
+  // While the RAM IRQ can fire, end the slice on the first frame which could raise it, so it's not delivered late.
+  const u32 interval =
+    IsTickEventLimitedByRAMIRQ() ? GetFramesUntilNextRAMIRQCheck(max_slice_frames) : max_slice_frames;
+  return static_cast<TickCount>(interval) * s_cpu_ticks_per_spu_tick;
+}
 
-  // Ensure all pending ticks have been executed, since we won't get them back after rescheduling.
-  s_tick_event->InvokeEarly(true);
+void SPU::ScheduleTickEvent(TickCount interval_ticks)
+{
   s_tick_event->SetInterval(interval_ticks);
 
   TickCount downcount = interval_ticks;
@@ -2402,6 +2810,20 @@ void SPU::UpdateEventInterval()
   s_tick_event->Schedule(downcount);
 }
 
+void SPU::UpdateEventInterval()
+{
+  // The IRQ-limited interval is relative to the current voice state, so it always has to be rescheduled.
+  if (s_tick_event->IsActive() && !IsTickEventLimitedByRAMIRQ() &&
+      s_tick_event->GetInterval() == GetTickEventInterval())
+  {
+    return;
+  }
+
+  // Ensure all pending ticks have been executed, since we won't get them back after rescheduling.
+  s_tick_event->InvokeEarly(true);
+  ScheduleTickEvent(GetTickEventInterval());
+}
+
 void SPU::DrawDebugStateWindow()
 {
   static const ImVec4 active_color{1.0f, 1.0f, 1.0f, 1.0f};
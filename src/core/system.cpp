@@ -11,18 +11,22 @@
 #include "controller.h"
 #include "cpu_code_cache.h"
 #include "cpu_core.h"
+#include "cpu_profiler.h"
 #include "dma.h"
 #include "fullscreen_ui.h"
 #include "game_database.h"
 #include "game_list.h"
 #include "gpu.h"
+#include "gpu_dump.h"
 #include "gte.h"
 #include "host.h"
 #include "host_interface_progress_callback.h"
 #include "imgui_overlays.h"
+#include "input_movie.h"
 #include "interrupt_controller.h"
 #include "mdec.h"
 #include "memory_card.h"
+#include "netplay.h"
 #include "multitap.h"
 #include "pad.h"
 #include "pcdrv.h"
@@ -41,30 +45,42 @@
 #include "util/ini_settings_interface.h"
 #include "util/input_manager.h"
 #include "util/iso_reader.h"
+#include "util/media_capture.h"
 #include "util/platform_misc.h"
 #include "util/postprocessing.h"
 #include "util/state_wrapper.h"
 
+#include "common/align.h"
 #include "common/error.h"
 #include "common/file_system.h"
+#include "common/image.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
 #include "common/string_util.h"
 #include "common/threading.h"
+#include "common/trace_recorder.h"
 
+#include "cpuinfo.h"
 #include "fmt/chrono.h"
 #include "fmt/format.h"
 #include "imgui.h"
 #include "xxhash.h"
 
+#include <array>
 #include <cctype>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
 #include <deque>
 #include <fstream>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 
 Log_SetChannel(System);
 
@@ -91,8 +107,16 @@ SystemBootParameters::SystemBootParameters(std::string filename_) : filename(std
 
 SystemBootParameters::~SystemBootParameters() = default;
 
+namespace {
+struct SaveStateBuffer;
+struct SaveStateJob;
+} // namespace
+
 namespace System {
 static std::optional<ExtendedSaveStateInfo> InternalGetExtendedSaveStateInfo(ByteStream* stream);
+static std::string GetSaveStateIndexFileName(const std::string_view& state_path);
+static std::optional<ExtendedSaveStateInfo> GetIndexedSaveStateInfo(const char* path, const FILESYSTEM_STAT_DATA& sd);
+static void UpdateSaveStateIndex(const char* path, const FILESYSTEM_STAT_DATA& sd, const ExtendedSaveStateInfo& ssi);
 
 static bool LoadEXE(const char* filename);
 
@@ -105,17 +129,53 @@ static void InternalReset();
 static void ClearRunningGame();
 static void DestroySystem();
 static std::string GetMediaPathFromSaveState(const char* path);
-static bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state);
+static bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state,
+                    std::vector<SAVE_STATE_SECTION>* sections = nullptr);
+static bool ReadSaveStateSections(ByteStream* state, const SAVE_STATE_HEADER& header,
+                                  GrowableMemoryByteStream* out_stream);
+static bool WriteSaveStateSections(ByteStream* state, SaveStateBuffer& buffer);
 static bool CreateGPU(GPURenderer renderer, bool is_switching);
 static bool SaveUndoLoadState();
+static bool LoadStateFromFile(const char* filename, bool update_display);
+static bool InternalLoadState(ByteStream* state, const u8* state_memory, bool update_display, bool ignore_media);
+static bool QueueSaveState(const char* filename, bool backup_existing_save, u32 compression_method);
+
+static bool CaptureSaveState(SaveStateBuffer* buffer, u32 screenshot_size, bool ignore_media);
+static bool WriteSaveStateBuffer(ByteStream* state, SaveStateBuffer& buffer, u32 compression_method);
+static std::unique_ptr<GrowableMemoryByteStream> AcquireSaveStateStream();
+static void ReleaseSaveStateStream(std::unique_ptr<GrowableMemoryByteStream> stream);
+static void WriteSaveStateJob(SaveStateJob& job);
+static void StartSaveStateThread();
+static void StopSaveStateThread();
+static void WaitForSaveStateWrites();
+static void SaveStateThreadEntryPoint();
+static void StartImageWriteThreads();
+static void StopImageWriteThreads();
+static void ImageWriteThreadEntryPoint();
 
 /// Throttles the system, i.e. sleeps until it's time to execute the next frame.
 static void Throttle();
+static bool ShouldRenderSkipFrame();
+
+/// Appends the last performance counter update to the GPU timings CSV, creating it if needed.
+static void WriteGPUTimings();
+static void CloseGPUTimingsFile();
+
+/// Sleeps until there's just enough time left to run the next frame before it's due, so input is polled later.
+static void PreFrameSleep();
 
 static void SetRewinding(bool enabled);
 static bool SaveRewindState();
 static void DoRewind();
 
+static bool SaveMemoryStateToStream(GrowableMemoryByteStream* stream, std::unique_ptr<GPUTexture>* vram_texture);
+static bool LoadMemoryStateFromStream(GrowableMemoryByteStream* stream, GPUTexture* vram_texture);
+
+static void StartRewindCompressionThread();
+static void StopRewindCompressionThread();
+static void WaitForRewindCompression();
+static void RewindCompressionThreadEntryPoint();
+
 static void SaveRunaheadState();
 static bool DoRunahead();
 
@@ -131,6 +191,16 @@ static void UpdateSessionTime(const std::string& prev_serial);
 
 static void SetTimerResolutionIncreased(bool enabled);
 
+namespace {
+struct ThreadCoreMasks
+{
+  u64 performance;
+  u64 efficiency;
+};
+} // namespace
+
+static const ThreadCoreMasks& GetThreadCoreMasks();
+
 #ifdef ENABLE_DISCORD_PRESENCE
 static void InitializeDiscordPresence();
 static void ShutdownDiscordPresence();
@@ -170,6 +240,17 @@ static Common::Timer::Value s_frame_period = 0;
 static Common::Timer::Value s_next_frame_time = 0;
 static bool s_last_frame_skipped = false;
 
+// Frames which aren't rendered while fast forwarding, the counter picks which of them is.
+static constexpr u32 MAX_RENDER_SKIP_INTERVAL = 10;
+static bool s_render_skipping = false;
+static u32 s_render_skip_counter = 0;
+
+// Time spent running each of the last few frames, to predict how long the next one will take.
+static constexpr u32 NUM_FRAME_RUN_TIME_SAMPLES = 10;
+static std::array<Common::Timer::Value, NUM_FRAME_RUN_TIME_SAMPLES> s_frame_run_times = {};
+static u32 s_frame_run_time_pos = 0;
+static Common::Timer::Value s_frame_start_time = 0;
+
 static bool s_system_executing = false;
 static bool s_system_interrupted = false;
 static bool s_frame_step_request = false;
@@ -178,6 +259,7 @@ static bool s_turbo_enabled = false;
 static bool s_throttler_enabled = true;
 static bool s_display_all_frames = true;
 static bool s_syncing_to_host = false;
+static bool s_pre_frame_sleep = false;
 
 static float s_average_frame_time_accumulator = 0.0f;
 static float s_minimum_frame_time_accumulator = 0.0f;
@@ -196,14 +278,19 @@ static float s_sw_thread_time = 0.0f;
 static float s_average_gpu_time = 0.0f;
 static float s_accumulated_gpu_time = 0.0f;
 static float s_gpu_usage = 0.0f;
+static GPUDevice::TimingScopeTimes s_average_gpu_scope_times = {};
+static GPUDevice::TimingScopeTimes s_accumulated_gpu_scope_times = {};
+static std::FILE* s_gpu_timings_file = nullptr;
 static System::FrameTimeHistory s_frame_time_history;
 static u32 s_frame_time_history_pos = 0;
+static u32 s_throttle_miss_count = 0;
 static u32 s_last_frame_number = 0;
 static u32 s_last_internal_frame_number = 0;
 static u32 s_last_global_tick_counter = 0;
 static u64 s_last_cpu_time = 0;
 static u64 s_last_sw_time = 0;
 static u32 s_presents_since_last_update = 0;
+static u32 s_performance_counters_update_count = 0;
 static Common::Timer s_fps_timer;
 static Common::Timer s_frame_timer;
 static Threading::ThreadHandle s_cpu_thread_handle;
@@ -215,7 +302,142 @@ static std::unique_ptr<ByteStream> m_undo_load_state;
 
 static bool s_memory_saves_enabled = false;
 
-static std::deque<System::MemorySaveState> s_rewind_states;
+namespace {
+struct RewindVRAMTile
+{
+  u64 hash;
+  std::array<u16, 64 * 64> data;
+};
+
+struct RewindState
+{
+  std::unique_ptr<GPUTexture> vram_texture;
+
+  // Where VRAM sits in the state, if it's saved there rather than in the texture. It's cut out of the state before
+  // compressing and kept as tiles shared with every other state which has the same contents.
+  u32 vram_offset = 0;
+  std::vector<std::shared_ptr<const RewindVRAMTile>> vram_tiles;
+
+  // Keyframe which this state is XORed against before compressing, null if this state is a keyframe.
+  std::shared_ptr<const RewindState> keyframe;
+
+  // Written by the compression thread, only safe to read after WaitForRewindCompression().
+  DynamicHeapArray<u8> compressed_data;
+  u32 uncompressed_size = 0;
+};
+
+struct RewindCompressionJob
+{
+  std::shared_ptr<RewindState> state;
+  std::unique_ptr<GrowableMemoryByteStream> stream;
+};
+} // namespace
+
+static constexpr u32 REWIND_KEYFRAME_INTERVAL = 16;
+static constexpr u32 REWIND_VRAM_TILE_SIZE = 64;
+static constexpr u32 REWIND_VRAM_TILES_X = VRAM_WIDTH / REWIND_VRAM_TILE_SIZE;
+static constexpr u32 REWIND_VRAM_TILES_Y = VRAM_HEIGHT / REWIND_VRAM_TILE_SIZE;
+static constexpr u32 REWIND_VRAM_MIN_PRUNE_SIZE = 1024;
+static constexpr int REWIND_COMPRESSION_LEVEL = 1;
+
+// Used for estimating memory usage, deltas are typically well under this fraction of a full state.
+static constexpr u32 REWIND_DELTA_SIZE_DIVIDER = 8;
+
+static std::deque<std::shared_ptr<RewindState>> s_rewind_states;
+static std::shared_ptr<const RewindState> s_rewind_keyframe;
+static u32 s_rewind_states_since_keyframe = 0;
+static std::unique_ptr<GrowableMemoryByteStream> s_rewind_load_stream;
+static std::vector<u8> s_rewind_load_keyframe;
+
+static Threading::Thread s_rewind_compression_thread;
+static std::mutex s_rewind_compression_mutex;
+static std::condition_variable s_rewind_compression_wake_cv;
+static std::condition_variable s_rewind_compression_done_cv;
+static std::deque<RewindCompressionJob> s_rewind_compression_queue;
+static std::vector<std::unique_ptr<GrowableMemoryByteStream>> s_rewind_free_streams;
+static std::vector<u8> s_rewind_compression_keyframe;
+static std::unordered_map<u64, std::weak_ptr<const RewindVRAMTile>> s_rewind_vram_tiles;
+static size_t s_rewind_vram_tiles_prune_size = 0;
+static bool s_rewind_compression_busy = false;
+static bool s_rewind_compression_shutdown = false;
+static bool s_rewind_compression_thread_running = false;
+
+namespace {
+struct SaveStateBuffer
+{
+  SAVE_STATE_HEADER header = {};
+  std::string media_filename;
+
+  // Converted to RGBA8 when the state is written.
+  std::vector<u32> screenshot_buffer;
+  u32 screenshot_stride = 0;
+  GPUTexture::Format screenshot_format = GPUTexture::Format::Unknown;
+  bool flip_screenshot = false;
+
+  // Raw, uncompressed state data, and where each section starts within it.
+  std::unique_ptr<GrowableMemoryByteStream> state_stream;
+  std::vector<SAVE_STATE_SECTION> sections;
+};
+
+struct SaveStateJob
+{
+  std::string filename;
+  bool backup_existing_save;
+  u32 compression_method;
+  SaveStateBuffer buffer;
+};
+} // namespace
+
+// Only a couple of saves are ever in flight at once, there's no need to keep more buffers than that around.
+static constexpr u32 MAX_FREE_SAVE_STATE_STREAMS = 2;
+
+namespace {
+struct SaveStateIndexEntry
+{
+  std::string filename;
+  u64 modification_time;
+  u64 size;
+  ExtendedSaveStateInfo info;
+};
+
+struct SaveStateIndex
+{
+  std::string path;
+  std::vector<SaveStateIndexEntry> entries;
+};
+} // namespace
+
+static constexpr u32 SAVE_STATE_INDEX_MAGIC = 0x58495353; // SSIX
+static constexpr u32 SAVE_STATE_INDEX_VERSION = 1;
+
+// The save state menus look at the per-game and global indices, there's no point keeping any more than that.
+static constexpr u32 MAX_CACHED_SAVE_STATE_INDICES = 2;
+
+static std::mutex s_save_state_index_mutex;
+static std::deque<SaveStateIndex> s_save_state_index_cache;
+
+static Threading::Thread s_save_state_thread;
+static std::mutex s_save_state_mutex;
+static std::condition_variable s_save_state_wake_cv;
+static std::condition_variable s_save_state_done_cv;
+static std::deque<SaveStateJob> s_save_state_queue;
+static std::vector<std::unique_ptr<GrowableMemoryByteStream>> s_save_state_free_streams;
+static bool s_save_state_busy = false;
+static bool s_save_state_shutdown = false;
+static bool s_save_state_thread_running = false;
+
+static std::unique_ptr<MediaCapture> s_media_capture;
+
+static constexpr u32 MAX_IMAGE_WRITE_THREADS = 4;
+static std::array<Threading::Thread, MAX_IMAGE_WRITE_THREADS> s_image_write_threads;
+static std::mutex s_image_write_mutex;
+static std::condition_variable s_image_write_wake_cv;
+static std::condition_variable s_image_write_done_cv;
+static std::deque<std::function<void()>> s_image_write_queue;
+static u32 s_image_write_thread_count = 0;
+static u32 s_image_write_busy = 0;
+static bool s_image_write_shutdown = false;
+
 static s32 s_rewind_load_frequency = -1;
 static s32 s_rewind_load_counter = -1;
 static s32 s_rewind_save_frequency = -1;
@@ -226,6 +448,8 @@ static std::deque<System::MemorySaveState> s_runahead_states;
 static bool s_runahead_replay_pending = false;
 static u32 s_runahead_frames = 0;
 static u32 s_runahead_replay_frames = 0;
+static float s_runahead_save_time = 0.0f;
+static float s_runahead_load_time = 0.0f;
 
 // Used to track play time. We use a monotonic timer here, in case of clock changes.
 static u64 s_session_start_time = 0;
@@ -241,6 +465,8 @@ static TinyString GetTimestampStringForFileName()
 
 void System::Internal::ProcessStartup()
 {
+  TRACE_SCOPE("System::ProcessStartup");
+
   if (!Bus::AllocateMemory())
     Panic("Failed to allocate memory for emulated bus.");
 
@@ -249,6 +475,9 @@ void System::Internal::ProcessStartup()
   // This will call back to Host::LoadSettings() -> ReloadSources().
   LoadSettings(false);
 
+  // Nothing else here needs the game database, so it can load while the rest of startup and the first boot run.
+  GameDatabase::StartBackgroundLoad();
+
 #ifdef ENABLE_RAINTEGRATION
   if (Host::GetBaseBoolSettingValue("Cheevos", "UseRAIntegration", false))
     Achievements::SwitchToRAIntegration();
@@ -272,8 +501,20 @@ void System::Internal::ProcessShutdown()
 
   InputManager::CloseSources();
 
+  // Don't lose a trace which was started from the command line.
+  StopTraceRecording();
+
+  // Queued saves still need to make it to disk.
+  StopSaveStateThread();
+  StopImageWriteThreads();
+  MemoryCard::StopSaveThread();
+  GameDatabase::Unload();
+
   CPU::CodeCache::ProcessShutdown();
   Bus::ReleaseMemory();
+
+  // Anything logged from here on is written synchronously.
+  Log::SetAsyncOutputParams(false);
 }
 
 void System::Internal::IdlePollUpdate()
@@ -440,6 +681,11 @@ const BIOS::Hash& System::GetBIOSHash()
   return s_bios_hash;
 }
 
+u32 System::GetPerformanceCountersUpdateCount()
+{
+  return s_performance_counters_update_count;
+}
+
 float System::GetFPS()
 {
   return s_fps;
@@ -492,6 +738,18 @@ float System::GetGPUAverageTime()
 {
   return s_average_gpu_time;
 }
+float System::GetGPUScopeAverageTime(u32 scope)
+{
+  return s_average_gpu_scope_times[scope];
+}
+float System::GetRunaheadSaveTime()
+{
+  return s_runahead_save_time;
+}
+float System::GetRunaheadLoadTime()
+{
+  return s_runahead_load_time;
+}
 const System::FrameTimeHistory& System::GetFrameTimeHistory()
 {
   return s_frame_time_history;
@@ -500,6 +758,10 @@ u32 System::GetFrameTimeHistoryPos()
 {
   return s_frame_time_history_pos;
 }
+u32 System::GetThrottleMissCount()
+{
+  return s_throttle_miss_count;
+}
 
 bool System::IsExeFileName(const std::string_view& path)
 {
@@ -515,10 +777,10 @@ bool System::IsPsfFileName(const std::string_view& path)
 bool System::IsLoadableFilename(const std::string_view& path)
 {
   static constexpr const std::array extensions = {
-    ".bin", ".cue",     ".img",    ".iso", ".chd", ".ecm", ".mds", // discs
-    ".exe", ".psexe",   ".ps-exe",                                 // exes
-    ".psf", ".minipsf",                                            // psf
-    ".m3u",                                                        // playlists
+    ".bin", ".cue",     ".img",    ".iso", ".chd", ".ecm", ".mds", ".zcd", // discs
+    ".exe", ".psexe",   ".ps-exe",                                         // exes
+    ".psf", ".minipsf",                                                    // psf
+    ".m3u",                                                                // playlists
     ".pbp",
   };
 
@@ -884,9 +1146,13 @@ bool System::RecreateGPU(GPURenderer renderer, bool force_recreate_device, bool
   ClearMemorySaveStates();
   g_gpu->RestoreDeviceContext();
 
-  // save current state
-  std::unique_ptr<ByteStream> state_stream = ByteStream::CreateGrowableMemoryStream();
-  StateWrapper sw(state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  // save current state, straight into a buffer which is already large enough for VRAM
+  std::unique_ptr<GrowableMemoryByteStream> state_stream = AcquireSaveStateStream();
+  if (state_stream->GetMemorySize() < MAX_SAVE_STATE_SIZE)
+    state_stream->ResizeMemory(MAX_SAVE_STATE_SIZE);
+
+  StateWrapper sw(state_stream->GetMemoryPointer(), state_stream->GetMemorySize(), StateWrapper::Mode::Write,
+                  SAVE_STATE_VERSION);
   const bool state_valid = g_gpu->DoState(sw, nullptr, false) && TimingEvents::DoState(sw);
   if (!state_valid)
     Log_ErrorPrintf("Failed to save old GPU state when switching renderers");
@@ -901,19 +1167,22 @@ bool System::RecreateGPU(GPURenderer renderer, bool force_recreate_device, bool
     if (!IsStartupCancelled())
       Host::ReportErrorAsync("Error", "Failed to recreate GPU.");
 
+    ReleaseSaveStateStream(std::move(state_stream));
     DestroySystem();
     return false;
   }
 
   if (state_valid)
   {
-    state_stream->SeekAbsolute(0);
-    sw.SetMode(StateWrapper::Mode::Read);
+    StateWrapper read_sw(state_stream->GetMemoryPointer(), static_cast<size_t>(sw.GetPosition()),
+                         StateWrapper::Mode::Read, SAVE_STATE_VERSION);
     g_gpu->RestoreDeviceContext();
-    g_gpu->DoState(sw, nullptr, update_display);
-    TimingEvents::DoState(sw);
+    g_gpu->DoState(read_sw, nullptr, update_display);
+    TimingEvents::DoState(read_sw);
   }
 
+  ReleaseSaveStateStream(std::move(state_stream));
+
   // fix up vsync etc
   UpdateSpeedLimiterState();
   return true;
@@ -939,6 +1208,8 @@ void System::LoadSettings(bool display_osd_messages)
   }
 
   g_settings.FixIncompatibleSettings(display_osd_messages);
+
+  CDImage::SetCHDHunkCacheSize(g_settings.cdrom_chd_hunk_cache_size);
 }
 
 void System::SetDefaultSettings(SettingsInterface& si)
@@ -1141,8 +1412,10 @@ bool System::LoadState(const char* filename)
 
   Common::Timer load_timer;
 
-  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
+  // The state could still be being written, e.g. quick load straight after quick save.
+  WaitForSaveStateWrites();
+
+  if (!FileSystem::FileExists(filename))
     return false;
 
   Log_InfoPrintf("Loading state from '%s'...", filename);
@@ -1156,7 +1429,7 @@ bool System::LoadState(const char* filename)
 
   SaveUndoLoadState();
 
-  if (!LoadStateFromStream(stream.get(), true))
+  if (!LoadStateFromFile(filename, true))
   {
     Host::ReportFormattedErrorAsync("Load State Error",
                                     TRANSLATE("OSDMessage", "Loading state from '%s' failed. Resetting."), filename);
@@ -1174,34 +1447,93 @@ bool System::LoadState(const char* filename)
   return true;
 }
 
+bool System::LoadStateFromFile(const char* filename, bool update_display)
+{
+  // Map the file, so that an uncompressed state can be used in place rather than being read into a buffer first.
+  size_t mapping_size;
+  if (void* mapping = MemMap::MapFileReadOnly(filename, &mapping_size);
+      mapping && mapping_size <= std::numeric_limits<u32>::max())
+  {
+    ReadOnlyMemoryByteStream stream(mapping, static_cast<u32>(mapping_size));
+    const bool result = InternalLoadState(&stream, static_cast<const u8*>(mapping), update_display, false);
+    MemMap::UnmapFile(mapping, mapping_size);
+    return result;
+  }
+  else if (mapping)
+  {
+    MemMap::UnmapFile(mapping, mapping_size);
+  }
+
+  std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(filename, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open save state '%s'", filename);
+    return false;
+  }
+
+  return InternalLoadState(stream.get(), nullptr, update_display, false);
+}
+
 bool System::SaveState(const char* filename, bool backup_existing_save)
 {
-  if (backup_existing_save && FileSystem::FileExists(filename))
+  return QueueSaveState(filename, backup_existing_save,
+                        g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD_SECTIONS :
+                                                          SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
+}
+
+bool System::QueueSaveState(const char* filename, bool backup_existing_save, u32 compression_method)
+{
+  Common::Timer save_timer;
+
+  // Only the capture happens on the CPU thread, compression and writing the file are done by the save state thread.
+  SaveStateJob job;
+  job.filename = filename;
+  job.backup_existing_save = backup_existing_save;
+  job.compression_method = compression_method;
+  if (!CaptureSaveState(&job.buffer, 256, false))
+  {
+    if (job.buffer.state_stream)
+      ReleaseSaveStateStream(std::move(job.buffer.state_stream));
+
+    Host::ReportFormattedErrorAsync(TRANSLATE("OSDMessage", "Save State"),
+                                    TRANSLATE("OSDMessage", "Saving state to '%s' failed."), filename);
+    return false;
+  }
+
+  Log_VerbosePrintf("Capturing state took %.2f msec", save_timer.GetTimeMilliseconds());
+
+  StartSaveStateThread();
+  {
+    std::unique_lock lock(s_save_state_mutex);
+    s_save_state_queue.push_back(std::move(job));
+  }
+  s_save_state_wake_cv.notify_one();
+  return true;
+}
+
+void System::WriteSaveStateJob(SaveStateJob& job)
+{
+  Common::Timer write_timer;
+
+  const char* filename = job.filename.c_str();
+  if (job.backup_existing_save && FileSystem::FileExists(filename))
   {
     const std::string backup_filename(Path::ReplaceExtension(filename, "bak"));
     if (!FileSystem::RenamePath(filename, backup_filename.c_str()))
       Log_ErrorPrintf("Failed to rename save state backup '%s'", backup_filename.c_str());
   }
 
-  Common::Timer save_timer;
+  Log_InfoPrintf("Saving state to '%s'...", filename);
 
   std::unique_ptr<ByteStream> stream =
     ByteStream::OpenFile(filename, BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
                                      BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
-  if (!stream)
-    return false;
-
-  Log_InfoPrintf("Saving state to '%s'...", filename);
-
-  const u32 screenshot_size = 256;
-  const bool result = SaveStateToStream(stream.get(), screenshot_size,
-                                        g_settings.compress_save_states ? SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD :
-                                                                          SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
-  if (!result)
+  if (!stream || !WriteSaveStateBuffer(stream.get(), job.buffer, job.compression_method))
   {
     Host::ReportFormattedErrorAsync(TRANSLATE("OSDMessage", "Save State"),
                                     TRANSLATE("OSDMessage", "Saving state to '%s' failed."), filename);
-    stream->Discard();
+    if (stream)
+      stream->Discard();
   }
   else
   {
@@ -1210,10 +1542,187 @@ bool System::SaveState(const char* filename, bool backup_existing_save)
       "save_state", ICON_FA_SAVE,
       fmt::format(TRANSLATE_FS("OSDMessage", "State saved to '{}'."), Path::GetFileName(display_name)), 5.0f);
     stream->Commit();
+    stream.reset();
+
+    // Keep the index in step, so the save state menus don't need to open the state to show it.
+    FILESYSTEM_STAT_DATA sd;
+    if (FileSystem::StatFile(filename, &sd))
+    {
+      const SAVE_STATE_HEADER& header = job.buffer.header;
+      ExtendedSaveStateInfo ssi;
+      ssi.title = header.title;
+      ssi.serial = header.serial;
+      ssi.media_path = std::move(job.buffer.media_filename);
+      ssi.timestamp = sd.ModificationTime;
+      ssi.screenshot_width = header.screenshot_width;
+      ssi.screenshot_height = header.screenshot_height;
+      if (header.screenshot_width > 0)
+      {
+        ssi.screenshot_data = std::move(job.buffer.screenshot_buffer);
+        ssi.screenshot_data.resize(header.screenshot_width * header.screenshot_height);
+      }
+      UpdateSaveStateIndex(filename, sd, ssi);
+    }
   }
 
-  Log_VerbosePrintf("Saving state took %.2f msec", save_timer.GetTimeMilliseconds());
-  return result;
+  Log_VerbosePrintf("Writing state took %.2f msec", write_timer.GetTimeMilliseconds());
+}
+
+std::unique_ptr<GrowableMemoryByteStream> System::AcquireSaveStateStream()
+{
+  {
+    std::unique_lock lock(s_save_state_mutex);
+    if (!s_save_state_free_streams.empty())
+    {
+      std::unique_ptr<GrowableMemoryByteStream> stream = std::move(s_save_state_free_streams.back());
+      s_save_state_free_streams.pop_back();
+      return stream;
+    }
+  }
+
+  return std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+}
+
+void System::ReleaseSaveStateStream(std::unique_ptr<GrowableMemoryByteStream> stream)
+{
+  std::unique_lock lock(s_save_state_mutex);
+  if (s_save_state_free_streams.size() < MAX_FREE_SAVE_STATE_STREAMS)
+    s_save_state_free_streams.push_back(std::move(stream));
+}
+
+void System::StartSaveStateThread()
+{
+  if (s_save_state_thread_running)
+    return;
+
+  s_save_state_shutdown = false;
+  s_save_state_thread_running = true;
+  s_save_state_thread.Start(&System::SaveStateThreadEntryPoint);
+}
+
+void System::StopSaveStateThread()
+{
+  if (s_save_state_thread_running)
+  {
+    {
+      std::unique_lock lock(s_save_state_mutex);
+      s_save_state_shutdown = true;
+    }
+    s_save_state_wake_cv.notify_one();
+    s_save_state_thread.Join();
+    s_save_state_thread_running = false;
+  }
+
+  // Streams are also pooled for synchronous saves, which don't need the thread.
+  s_save_state_free_streams.clear();
+}
+
+void System::WaitForSaveStateWrites()
+{
+  std::unique_lock lock(s_save_state_mutex);
+  s_save_state_done_cv.wait(lock, []() { return s_save_state_queue.empty() && !s_save_state_busy; });
+}
+
+void System::SaveStateThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Save State Writer");
+  ApplyThreadCorePlacement(false);
+
+  std::unique_lock lock(s_save_state_mutex);
+  for (;;)
+  {
+    s_save_state_wake_cv.wait(lock, []() { return s_save_state_shutdown || !s_save_state_queue.empty(); });
+    if (s_save_state_queue.empty())
+      break;
+
+    SaveStateJob job = std::move(s_save_state_queue.front());
+    s_save_state_queue.pop_front();
+    s_save_state_busy = true;
+    lock.unlock();
+
+    WriteSaveStateJob(job);
+    ReleaseSaveStateStream(std::move(job.buffer.state_stream));
+
+    lock.lock();
+    s_save_state_busy = false;
+    s_save_state_done_cv.notify_all();
+  }
+}
+
+void System::StartImageWriteThreads()
+{
+  if (s_image_write_thread_count > 0)
+    return;
+
+  s_image_write_shutdown = false;
+  s_image_write_thread_count = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_IMAGE_WRITE_THREADS);
+  for (u32 i = 0; i < s_image_write_thread_count; i++)
+    s_image_write_threads[i].Start(&System::ImageWriteThreadEntryPoint);
+}
+
+void System::StopImageWriteThreads()
+{
+  if (s_image_write_thread_count == 0)
+    return;
+
+  {
+    std::unique_lock lock(s_image_write_mutex);
+    s_image_write_shutdown = true;
+  }
+  s_image_write_wake_cv.notify_all();
+  for (u32 i = 0; i < s_image_write_thread_count; i++)
+    s_image_write_threads[i].Join();
+  s_image_write_thread_count = 0;
+}
+
+void System::QueueImageWrite(std::function<void()> job)
+{
+  StartImageWriteThreads();
+  {
+    std::unique_lock lock(s_image_write_mutex);
+    s_image_write_queue.push_back(std::move(job));
+  }
+  s_image_write_wake_cv.notify_one();
+}
+
+void System::QueueImageWrite(std::string filename, Common::RGBA8Image image, int quality)
+{
+  QueueImageWrite([filename = std::move(filename), image = std::move(image), quality]() {
+    if (!image.SaveToFile(filename.c_str(), quality))
+      Log_ErrorPrintf("Failed to save %ux%u image to '%s'", image.GetWidth(), image.GetHeight(), filename.c_str());
+  });
+}
+
+void System::WaitForImageWrites()
+{
+  std::unique_lock lock(s_image_write_mutex);
+  s_image_write_done_cv.wait(lock, []() { return s_image_write_queue.empty() && s_image_write_busy == 0; });
+}
+
+void System::ImageWriteThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Image Writer");
+  ApplyThreadCorePlacement(false);
+
+  std::unique_lock lock(s_image_write_mutex);
+  for (;;)
+  {
+    s_image_write_wake_cv.wait(lock, []() { return s_image_write_shutdown || !s_image_write_queue.empty(); });
+    if (s_image_write_queue.empty())
+      break;
+
+    std::function<void()> job = std::move(s_image_write_queue.front());
+    s_image_write_queue.pop_front();
+    s_image_write_busy++;
+    lock.unlock();
+
+    job();
+    job = {};
+
+    lock.lock();
+    s_image_write_busy--;
+    s_image_write_done_cv.notify_all();
+  }
 }
 
 bool System::SaveResumeState()
@@ -1221,12 +1730,17 @@ bool System::SaveResumeState()
   if (s_running_game_serial.empty())
     return false;
 
+  // Resume states are written on exit and read on the next start, so leave them uncompressed. Both are then bound by
+  // I/O rather than zstd, and loading can use the mapped file without copying it.
   const std::string path(GetGameSaveStateFileName(s_running_game_serial, -1));
-  return SaveState(path.c_str(), false);
+  return QueueSaveState(path.c_str(), false, SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
 }
 
 bool System::BootSystem(SystemBootParameters parameters)
 {
+  TRACE_SCOPE("System::BootSystem");
+  Common::Timer boot_timer;
+
   if (!parameters.save_state.empty())
   {
     // loading a state, so pull the media path from the save state to avoid a double change
@@ -1274,7 +1788,10 @@ bool System::BootSystem(SystemBootParameters parameters)
     else
     {
       Log_InfoPrintf("Loading CD image '%s'...", parameters.filename.c_str());
-      disc = CDImage::Open(parameters.filename.c_str(), g_settings.cdrom_load_image_patches, &error);
+      {
+        TRACE_SCOPE("CDImage::Open");
+        disc = CDImage::Open(parameters.filename.c_str(), g_settings.cdrom_load_image_patches, &error);
+      }
       if (!disc)
       {
         Host::ReportErrorAsync("Error", fmt::format("Failed to load CD image '{}': {}",
@@ -1417,6 +1934,8 @@ bool System::BootSystem(SystemBootParameters parameters)
     }
   }
 
+  CPU::CodeCache::PrecompileCachedBlocks();
+
   // Good to go.
   s_state = State::Running;
   SPU::GetOutputStream()->SetPaused(false);
@@ -1431,9 +1950,7 @@ bool System::BootSystem(SystemBootParameters parameters)
   // try to load the state, if it fails, bail out
   if (!parameters.save_state.empty())
   {
-    std::unique_ptr<ByteStream> stream =
-      ByteStream::OpenFile(parameters.save_state.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
-    if (!stream)
+    if (!FileSystem::FileExists(parameters.save_state.c_str()))
     {
       Host::ReportErrorAsync(
         TRANSLATE("System", "Error"),
@@ -1442,7 +1959,7 @@ bool System::BootSystem(SystemBootParameters parameters)
       return false;
     }
 
-    if (!LoadStateFromStream(stream.get(), true))
+    if (!LoadStateFromFile(parameters.save_state.c_str(), true))
     {
       DestroySystem();
       return false;
@@ -1465,11 +1982,16 @@ bool System::BootSystem(SystemBootParameters parameters)
   if (IsRunning())
     UpdateSpeedLimiterState();
 
+  Log_InfoPrintf("System booted in %.2f ms", boot_timer.GetTimeMilliseconds());
   return true;
 }
 
 bool System::Initialize(bool force_software_renderer)
 {
+  TRACE_SCOPE("System::Initialize");
+
+  ApplyThreadCorePlacement(true);
+
   g_ticks_per_second = ScaleTicksToOverclock(MASTER_CLOCK);
   s_max_slice_ticks = ScaleTicksToOverclock(MASTER_CLOCK / 10);
   s_frame_number = 1;
@@ -1490,6 +2012,9 @@ bool System::Initialize(bool force_software_renderer)
   s_minimum_frame_time_accumulator = 0.0f;
   s_maximum_frame_time_accumulator = 0.0f;
 
+  s_render_skipping = false;
+  s_render_skip_counter = 0;
+
   s_vps = 0.0f;
   s_fps = 0.0f;
   s_speed = 0.0f;
@@ -1503,6 +2028,8 @@ bool System::Initialize(bool force_software_renderer)
   s_average_gpu_time = 0.0f;
   s_accumulated_gpu_time = 0.0f;
   s_gpu_usage = 0.0f;
+  s_average_gpu_scope_times = {};
+  s_accumulated_gpu_scope_times = {};
   s_last_frame_number = 0;
   s_last_internal_frame_number = 0;
   s_last_global_tick_counter = 0;
@@ -1623,10 +2150,17 @@ void System::DestroySystem()
     PlatformMisc::ResumeScreensaver();
 
   SetTimerResolutionIncreased(false);
+  CloseGPUTimingsFile();
+  StopMediaCapture();
+  StopGuestProfiler();
 
   s_cpu_thread_usage = {};
 
+  InputMovie::Stop();
+  Netplay::Stop();
+  GPUDump::Stop();
   ClearMemorySaveStates();
+  StopRewindCompressionThread();
 
   g_texture_replacements.Shutdown();
 
@@ -1678,6 +2212,9 @@ void System::ClearRunningGame()
   s_running_game_entry = nullptr;
   s_running_game_hash = 0;
 
+  if (g_gpu_device)
+    g_gpu_device->SetShaderCacheProfile({});
+
   Host::OnGameChanged(s_running_game_path, s_running_game_serial, s_running_game_title);
 
   Achievements::GameChanged(s_running_game_path, nullptr);
@@ -1722,6 +2259,8 @@ void System::Execute()
 
         if (s_rewind_load_counter >= 0)
           DoRewind();
+        else if (GPUDump::IsPlaying())
+          GPUDump::ExecuteFrame();
         else
           CPU::Execute();
 
@@ -1744,11 +2283,16 @@ void System::Execute()
 
 void System::FrameDone()
 {
+  // Execute() only returns when the system pauses, so frames are marked instead of timed.
+  TraceRecorder::RecordInstant("System::FrameDone");
+
   s_frame_number++;
 
   // Vertex buffer is shared, need to flush what we have.
   g_gpu->FlushRender();
 
+  GPUDump::FrameDone();
+
   // Generate any pending samples from the SPU before sleeping, this way we reduce the chances of underruns.
   // TODO: when running ahead, we can skip this (and the flush above)
   SPU::GeneratePendingSamples();
@@ -1769,8 +2313,29 @@ void System::FrameDone()
     PauseSystem(true);
   }
 
-  // Save states for rewind and runahead.
-  if (s_rewind_save_counter >= 0)
+  // Save states for rewind and runahead. Netplay rolls back with the same states, so it takes their place. Input
+  // movies count frames, which rewinding or running ahead would throw off.
+  if (Netplay::IsActive())
+  {
+    if (Netplay::FrameDone())
+    {
+      // resimulating, nobody sees these frames
+      return;
+    }
+  }
+  else if (InputMovie::IsActive())
+  {
+    if (InputMovie::FrameDone())
+    {
+      // seeking, get there as soon as possible
+      return;
+    }
+  }
+  else if (GPUDump::IsPlaying())
+  {
+    // Dump playback doesn't run the CPU, so there's nothing to rewind or run ahead.
+  }
+  else if (s_rewind_save_counter >= 0)
   {
     if (s_rewind_save_counter == 0)
     {
@@ -1811,8 +2376,23 @@ void System::FrameDone()
     SaveRunaheadState();
   }
 
+  // Runahead replay frames never get here, so each captured frame is one the user actually saw.
+  if (s_media_capture)
+    g_gpu->SendDisplayToMediaCapture(s_media_capture.get());
+
   const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
-  if (current_time < s_next_frame_time || s_display_all_frames || s_last_frame_skipped)
+  if (s_pre_frame_sleep)
+  {
+    s_frame_run_times[s_frame_run_time_pos] = current_time - s_frame_start_time;
+    s_frame_run_time_pos = (s_frame_run_time_pos + 1) % NUM_FRAME_RUN_TIME_SAMPLES;
+  }
+
+  if (s_render_skipping)
+  {
+    // Nothing was drawn, presenting would show a stale frame.
+    s_last_frame_skipped = true;
+  }
+  else if (current_time < s_next_frame_time || s_display_all_frames || s_last_frame_skipped)
   {
     s_last_frame_skipped = !PresentDisplay(true);
   }
@@ -1823,10 +2403,14 @@ void System::FrameDone()
   }
 
   if (s_throttler_enabled && !IsExecutionInterrupted())
+  {
     Throttle();
+    if (s_pre_frame_sleep)
+      PreFrameSleep();
+  }
 
   // Input poll already done above
-  if (s_runahead_frames == 0)
+  if (s_runahead_frames == 0 || Netplay::IsActive() || InputMovie::IsActive() || GPUDump::IsPlaying())
   {
     Host::PumpMessagesOnCPUThread();
     InputManager::PollSources();
@@ -1834,11 +2418,17 @@ void System::FrameDone()
     if (IsExecutionInterrupted())
     {
       s_system_interrupted = false;
-      CPU::ExitExecution();
+
+      // Dump playback returns to Execute() after every frame anyway.
+      if (!GPUDump::IsPlaying())
+        CPU::ExitExecution();
+
       return;
     }
   }
 
+  s_render_skipping = ShouldRenderSkipFrame();
+  g_gpu->SetRenderSkip(s_render_skipping);
   g_gpu->RestoreDeviceContext();
 
   // Update perf counters *after* throttling, we want to measure from start-of-frame
@@ -1874,7 +2464,8 @@ void System::UpdateThrottlePeriod()
 
 void System::ResetThrottler()
 {
-  s_next_frame_time = Common::Timer::GetCurrentValue() + s_frame_period;
+  s_frame_start_time = Common::Timer::GetCurrentValue();
+  s_next_frame_time = s_frame_start_time + s_frame_period;
 }
 
 void System::Throttle()
@@ -1885,6 +2476,7 @@ void System::Throttle()
   Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
   if (current_time > s_next_frame_time)
   {
+    s_throttle_miss_count++;
     const Common::Timer::Value diff = static_cast<s64>(current_time) - static_cast<s64>(s_next_frame_time);
     s_next_frame_time += (diff / s_frame_period) * s_frame_period + s_frame_period;
     return;
@@ -1908,6 +2500,22 @@ void System::Throttle()
   s_next_frame_time += s_frame_period;
 }
 
+void System::PreFrameSleep()
+{
+  // Throttle() has already moved on to when the frame we're about to run is due. Use the slowest recent frame as the
+  // estimate, plus some headroom for the present, so a spike doesn't make us miss the deadline.
+  Common::Timer::Value run_time = 0;
+  for (const Common::Timer::Value sample : s_frame_run_times)
+    run_time = std::max(run_time, sample);
+  run_time += Common::Timer::ConvertMillisecondsToValue(g_settings.display_pre_frame_sleep_buffer);
+
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  if ((s_next_frame_time - current_time) > run_time)
+    Common::Timer::SleepUntil(s_next_frame_time - run_time, false);
+
+  s_frame_start_time = Common::Timer::GetCurrentValue();
+}
+
 void System::SingleStepCPU()
 {
   s_frame_timer.Reset();
@@ -1968,7 +2576,12 @@ void System::RecreateSystem()
 
 bool System::CreateGPU(GPURenderer renderer, bool is_switching)
 {
-  const RenderAPI api = Settings::GetRenderAPIForRenderer(renderer);
+  TRACE_SCOPE("System::CreateGPU");
+
+  // The software renderer only needs somewhere to put the display texture, so headless runs can skip the host GPU.
+  const RenderAPI api = (renderer == GPURenderer::Software && g_settings.gpu_use_null_device) ?
+                          RenderAPI::None :
+                          Settings::GetRenderAPIForRenderer(renderer);
 
   if (!g_gpu_device ||
       (renderer != GPURenderer::Software && !GPUDevice::IsSameRenderAPI(g_gpu_device->GetRenderAPI(), api)))
@@ -1991,6 +2604,9 @@ bool System::CreateGPU(GPURenderer renderer, bool is_switching)
       PostProcessing::Initialize();
   }
 
+  // start loading the shaders this game used last time, while the renderer is being created
+  g_gpu_device->SetShaderCacheProfile(s_running_game_serial);
+
   if (renderer == GPURenderer::Software)
     g_gpu = GPU::CreateSoftwareRenderer();
   else
@@ -2020,8 +2636,16 @@ bool System::CreateGPU(GPURenderer renderer, bool is_switching)
   return true;
 }
 
-bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state)
+bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display, bool is_memory_state,
+                     std::vector<SAVE_STATE_SECTION>* sections /* = nullptr */)
 {
+  // Sections are only recorded when writing, the sizes are filled in by the caller.
+  const auto begin_section = [&sw, sections](u32 type) {
+    if (sections)
+      sections->push_back(SAVE_STATE_SECTION{type, static_cast<u32>(sw.GetPosition()), 0, 0, 0});
+  };
+
+  begin_section(SAVE_STATE_SECTION::TYPE_SYSTEM);
   if (!sw.DoMarker("System"))
     return false;
 
@@ -2049,32 +2673,32 @@ bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   if (!sw.DoMarker("CPU") || !CPU::DoState(sw))
     return false;
 
-  if (sw.IsReading())
-  {
-    if (is_memory_state)
-      CPU::CodeCache::InvalidateAllRAMBlocks();
-    else
-      CPU::CodeCache::Reset();
-  }
+  // Memory states invalidate the blocks affected by the RAM contents in Bus::DoState().
+  if (sw.IsReading() && !is_memory_state)
+    CPU::CodeCache::Reset();
 
   // only reset pgxp if we're not runahead-rollbacking. the value checks will save us from broken rendering, and it
   // saves using imprecise values for a frame in 30fps games.
   if (sw.IsReading() && g_settings.gpu_pgxp_enable && !is_memory_state)
     PGXP::Reset();
 
-  if (!sw.DoMarker("Bus") || !Bus::DoState(sw))
+  begin_section(SAVE_STATE_SECTION::TYPE_RAM);
+  if (!sw.DoMarker("Bus") || !Bus::DoState(sw, is_memory_state))
     return false;
 
+  begin_section(SAVE_STATE_SECTION::TYPE_DEVICES);
   if (!sw.DoMarker("DMA") || !DMA::DoState(sw))
     return false;
 
   if (!sw.DoMarker("InterruptController") || !InterruptController::DoState(sw))
     return false;
 
+  begin_section(SAVE_STATE_SECTION::TYPE_VRAM);
   g_gpu->RestoreDeviceContext();
   if (!sw.DoMarker("GPU") || !g_gpu->DoState(sw, host_texture, update_display))
     return false;
 
+  begin_section(SAVE_STATE_SECTION::TYPE_DEVICES);
   if (!sw.DoMarker("CDROM") || !CDROM::DoState(sw))
     return false;
 
@@ -2084,9 +2708,11 @@ bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
   if (!sw.DoMarker("Timers") || !Timers::DoState(sw))
     return false;
 
+  begin_section(SAVE_STATE_SECTION::TYPE_SPU);
   if (!sw.DoMarker("SPU") || !SPU::DoState(sw))
     return false;
 
+  begin_section(SAVE_STATE_SECTION::TYPE_DEVICES);
   if (!sw.DoMarker("MDEC") || !MDEC::DoState(sw))
     return false;
 
@@ -2141,8 +2767,11 @@ bool System::DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_di
 
 bool System::LoadBIOS(const std::string& override_bios_path)
 {
-  std::optional<BIOS::Image> bios_image(
-    override_bios_path.empty() ? BIOS::GetBIOSImage(s_region) : FileSystem::ReadBinaryFile(override_bios_path.c_str()));
+  TRACE_SCOPE("System::LoadBIOS");
+  BIOS::Hash bios_hash = {};
+  std::optional<BIOS::Image> bios_image(override_bios_path.empty() ?
+                                          BIOS::GetBIOSImage(s_region, &bios_hash) :
+                                          FileSystem::ReadBinaryFile(override_bios_path.c_str()));
   if (!bios_image.has_value())
   {
     Host::ReportFormattedErrorAsync("Error", TRANSLATE("System", "Failed to load %s BIOS."),
@@ -2156,7 +2785,7 @@ bool System::LoadBIOS(const std::string& override_bios_path)
     return false;
   }
 
-  s_bios_hash = BIOS::GetImageHash(bios_image.value());
+  s_bios_hash = override_bios_path.empty() ? bios_hash : BIOS::GetImageHash(bios_image.value());
   s_bios_image_info = BIOS::GetInfoForImage(bios_image.value(), s_bios_hash);
   if (s_bios_image_info)
     Log_InfoPrintf("Using BIOS: %s", s_bios_image_info->description);
@@ -2223,6 +2852,11 @@ std::string System::GetMediaPathFromSaveState(const char* path)
 }
 
 bool System::LoadStateFromStream(ByteStream* state, bool update_display, bool ignore_media)
+{
+  return InternalLoadState(state, nullptr, update_display, ignore_media);
+}
+
+bool System::InternalLoadState(ByteStream* state, const u8* state_memory, bool update_display, bool ignore_media)
 {
   Assert(IsValid());
 
@@ -2344,18 +2978,71 @@ bool System::LoadStateFromStream(ByteStream* state, bool update_display, bool ig
   if (!state->SeekAbsolute(header.offset_to_data))
     return false;
 
-  if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
+  if (state_memory && header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE &&
+      (static_cast<u64>(header.offset_to_data) + header.data_uncompressed_size) <= state->GetSize())
   {
-    StateWrapper sw(state, StateWrapper::Mode::Read, header.version);
+    // The stream is backed by memory, so the data can be used where it is. Reading never writes to it.
+    StateWrapper sw(const_cast<u8*>(state_memory + header.offset_to_data), header.data_uncompressed_size,
+                    StateWrapper::Mode::Read, header.version);
     if (!DoState(sw, nullptr, update_display, false))
       return false;
   }
-  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
+  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE ||
+           header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
   {
-    std::unique_ptr<ByteStream> dstream(ByteStream::CreateZstdDecompressStream(state, header.data_compressed_size));
-    StateWrapper sw(dstream.get(), StateWrapper::Mode::Read, header.version);
-    if (!DoState(sw, nullptr, update_display, false))
+    std::unique_ptr<ByteStream> zstream;
+    ByteStream* dstream = state;
+    if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
+    {
+      zstream = ByteStream::CreateZstdDecompressStream(state, header.data_compressed_size);
+      dstream = zstream.get();
+    }
+
+    // Read the data with a single call where the size is known, rather than going through the stream for every field.
+    if (header.data_uncompressed_size > 0 && header.data_uncompressed_size <= MAX_SAVE_STATE_SIZE)
+    {
+      std::unique_ptr<GrowableMemoryByteStream> mstream = AcquireSaveStateStream();
+      mstream->Resize(header.data_uncompressed_size);
+      bool result = dstream->Read2(mstream->GetMemoryPointer(), header.data_uncompressed_size);
+      if (result)
+      {
+        StateWrapper sw(mstream->GetMemoryPointer(), header.data_uncompressed_size, StateWrapper::Mode::Read,
+                        header.version);
+        result = DoState(sw, nullptr, update_display, false);
+      }
+
+      ReleaseSaveStateStream(std::move(mstream));
+      if (!result)
+        return false;
+    }
+    else
+    {
+      StateWrapper sw(dstream, StateWrapper::Mode::Read, header.version);
+      if (!DoState(sw, nullptr, update_display, false))
+        return false;
+    }
+  }
+  else if (header.data_compression_type == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD_SECTIONS)
+  {
+    std::unique_ptr<GrowableMemoryByteStream> dstream = AcquireSaveStateStream();
+    const bool result = ReadSaveStateSections(state, header, dstream.get());
+    if (result)
+    {
+      StateWrapper sw(dstream->GetMemoryPointer(), header.data_uncompressed_size, StateWrapper::Mode::Read,
+                      header.version);
+      if (!DoState(sw, nullptr, update_display, false))
+      {
+        ReleaseSaveStateStream(std::move(dstream));
+        return false;
+      }
+    }
+
+    ReleaseSaveStateStream(std::move(dstream));
+    if (!result)
+    {
+      Host::ReportFormattedErrorAsync("Error", "Failed to decompress save state.");
       return false;
+    }
   }
   else
   {
@@ -2363,6 +3050,8 @@ bool System::LoadStateFromStream(ByteStream* state, bool update_display, bool ig
     return false;
   }
 
+  CPU::CodeCache::PrecompileCachedBlocks();
+
   if (s_state == State::Starting)
     s_state = State::Running;
 
@@ -2371,20 +3060,118 @@ bool System::LoadStateFromStream(ByteStream* state, bool update_display, bool ig
   return true;
 }
 
-bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 */,
-                               u32 compression_method /* = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE*/,
-                               bool ignore_media /* = false*/)
+bool System::ReadSaveStateSections(ByteStream* state, const SAVE_STATE_HEADER& header,
+                                   GrowableMemoryByteStream* out_stream)
 {
-  if (IsShutdown())
+  u32 num_sections;
+  if (!state->Read2(&num_sections, sizeof(num_sections)) || num_sections == 0 ||
+      num_sections > SAVE_STATE_SECTION::MAX_SECTIONS || header.data_uncompressed_size > MAX_SAVE_STATE_SIZE)
+  {
     return false;
+  }
 
-  SAVE_STATE_HEADER header = {};
+  std::vector<SAVE_STATE_SECTION> sections(num_sections);
+  if (!state->Read2(sections.data(), num_sections * sizeof(SAVE_STATE_SECTION)))
+    return false;
 
-  const u64 header_position = state->GetPosition();
-  if (!state->Write2(&header, sizeof(header)))
+  // Pull the whole compressed region in with one read, the sections are then independent of the file.
+  const u32 toc_size = sizeof(num_sections) + num_sections * sizeof(SAVE_STATE_SECTION);
+  if (header.data_compressed_size < toc_size)
+    return false;
+
+  std::vector<u8> compressed_data(header.data_compressed_size - toc_size);
+  if (!state->Read2(compressed_data.data(), static_cast<u32>(compressed_data.size())))
+    return false;
+
+  for (const SAVE_STATE_SECTION& section : sections)
+  {
+    if (section.compressed_offset < toc_size ||
+        (static_cast<u64>(section.compressed_offset) + section.compressed_size - toc_size) > compressed_data.size() ||
+        (static_cast<u64>(section.uncompressed_offset) + section.uncompressed_size) > header.data_uncompressed_size)
+    {
+      return false;
+    }
+  }
+
+  out_stream->Resize(header.data_uncompressed_size);
+  u8* out_data = out_stream->GetMemoryPointer();
+
+  // Each section is its own zstd frame, so they can all be decompressed at once.
+  std::vector<u8> section_results(num_sections, 0);
+  const auto decompress_section = [&sections, &compressed_data, &section_results, toc_size, out_data](u32 index) {
+    const SAVE_STATE_SECTION& section = sections[index];
+    std::unique_ptr<ReadOnlyMemoryByteStream> src_stream = ByteStream::CreateReadOnlyMemoryStream(
+      &compressed_data[section.compressed_offset - toc_size], section.compressed_size);
+    std::unique_ptr<ByteStream> dstream =
+      ByteStream::CreateZstdDecompressStream(src_stream.get(), section.compressed_size);
+    section_results[index] =
+      BoolToUInt8(dstream->Read2(out_data + section.uncompressed_offset, section.uncompressed_size));
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_sections - 1);
+  for (u32 i = 1; i < num_sections; i++)
+    threads.emplace_back(decompress_section, i);
+  decompress_section(0);
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return std::all_of(section_results.begin(), section_results.end(), [](u8 result) { return result != 0; });
+}
+
+bool System::WriteSaveStateSections(ByteStream* state, SaveStateBuffer& buffer)
+{
+  std::vector<SAVE_STATE_SECTION>& sections = buffer.sections;
+  const u32 num_sections = static_cast<u32>(sections.size());
+  if (num_sections == 0 || num_sections > SAVE_STATE_SECTION::MAX_SECTIONS)
+    return false;
+
+  // Table of contents is written again once the compressed sizes are known.
+  const u64 toc_position = state->GetPosition();
+  if (!state->Write2(&num_sections, sizeof(num_sections)) ||
+      !state->Write2(sections.data(), num_sections * sizeof(SAVE_STATE_SECTION)))
+  {
+    return false;
+  }
+
+  const u8* data = buffer.state_stream->GetMemoryPointer();
+  for (SAVE_STATE_SECTION& section : sections)
+  {
+    const u64 section_position = state->GetPosition();
+    std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(state, 0));
+    if (!cstream->Write2(data + section.uncompressed_offset, section.uncompressed_size) || !cstream->Commit())
+      return false;
+
+    section.compressed_offset = static_cast<u32>(section_position - toc_position);
+    section.compressed_size = static_cast<u32>(state->GetPosition() - section_position);
+  }
+
+  const u64 end_position = state->GetPosition();
+  return (state->SeekAbsolute(toc_position + sizeof(num_sections)) &&
+          state->Write2(sections.data(), num_sections * sizeof(SAVE_STATE_SECTION)) &&
+          state->SeekAbsolute(end_position));
+}
+
+bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 */,
+                               u32 compression_method /* = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE*/,
+                               bool ignore_media /* = false*/)
+{
+  SaveStateBuffer buffer;
+  const bool result =
+    CaptureSaveState(&buffer, screenshot_size, ignore_media) && WriteSaveStateBuffer(state, buffer, compression_method);
+  if (buffer.state_stream)
+    ReleaseSaveStateStream(std::move(buffer.state_stream));
+
+  return result;
+}
+
+bool System::CaptureSaveState(SaveStateBuffer* buffer, u32 screenshot_size, bool ignore_media)
+{
+  if (IsShutdown())
     return false;
 
   // fill in header
+  SAVE_STATE_HEADER& header = buffer->header;
   header.magic = SAVE_STATE_MAGIC;
   header.version = SAVE_STATE_VERSION;
   StringUtil::Strlcpy(header.title, s_running_game_title.c_str(), sizeof(header.title));
@@ -2392,15 +3179,12 @@ bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 *
 
   if (CDROM::HasMedia() && !ignore_media)
   {
-    const std::string& media_filename = CDROM::GetMediaFileName();
-    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
-    header.media_filename_length = static_cast<u32>(media_filename.length());
+    buffer->media_filename = CDROM::GetMediaFileName();
+    header.media_filename_length = static_cast<u32>(buffer->media_filename.length());
     header.media_subimage_index = CDROM::GetMedia()->HasSubImages() ? CDROM::GetMedia()->GetCurrentSubImage() : 0;
-    if (!media_filename.empty() && !state->Write2(media_filename.data(), header.media_filename_length))
-      return false;
   }
 
-  // save screenshot
+  // render screenshot, conversion is left to whoever writes the state
   if (screenshot_size > 0)
   {
     // assume this size is the width
@@ -2411,63 +3195,119 @@ bool System::SaveStateToStream(ByteStream* state, u32 screenshot_size /* = 256 *
                                     ((display_aspect_ratio > 0.0f) ? display_aspect_ratio : 1.0f)));
     Log_VerbosePrintf("Saving %ux%u screenshot for state", screenshot_width, screenshot_height);
 
-    std::vector<u32> screenshot_buffer;
-    u32 screenshot_stride;
-    GPUTexture::Format screenshot_format;
     if (g_gpu->RenderScreenshotToBuffer(screenshot_width, screenshot_height,
                                         Common::Rectangle<s32>::FromExtents(0, 0, screenshot_width, screenshot_height),
-                                        false, &screenshot_buffer, &screenshot_stride, &screenshot_format) &&
-        GPUTexture::ConvertTextureDataToRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride,
-                                              screenshot_format))
+                                        false, &buffer->screenshot_buffer, &buffer->screenshot_stride,
+                                        &buffer->screenshot_format))
     {
-      if (screenshot_stride != (screenshot_width * sizeof(u32)))
-      {
-        Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to incorrect stride(%u)",
-                          screenshot_width, screenshot_height, screenshot_stride);
-      }
-      else
-      {
-        if (g_gpu_device->UsesLowerLeftOrigin())
-        {
-          GPUTexture::FlipTextureDataRGBA8(screenshot_width, screenshot_height, screenshot_buffer, screenshot_stride);
-        }
+      header.screenshot_width = screenshot_width;
+      header.screenshot_height = screenshot_height;
+      buffer->flip_screenshot = g_gpu_device->UsesLowerLeftOrigin();
+    }
+    else
+    {
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to render failure", screenshot_width,
+                        screenshot_height);
+    }
+  }
 
-        header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
-        header.screenshot_width = screenshot_width;
-        header.screenshot_height = screenshot_height;
-        header.screenshot_size = static_cast<u32>(screenshot_buffer.size() * sizeof(u32));
-        if (!state->Write2(screenshot_buffer.data(), header.screenshot_size))
-          return false;
-      }
+  // write data straight into the stream's buffer, which is preallocated to the maximum state size
+  buffer->state_stream = AcquireSaveStateStream();
+  GrowableMemoryByteStream* stream = buffer->state_stream.get();
+  if (stream->GetMemorySize() < MAX_SAVE_STATE_SIZE)
+    stream->ResizeMemory(MAX_SAVE_STATE_SIZE);
+
+  g_gpu->RestoreDeviceContext();
+
+  StateWrapper sw(stream->GetMemoryPointer(), stream->GetMemorySize(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  if (!DoState(sw, nullptr, false, false, &buffer->sections))
+    return false;
+
+  const u32 size = static_cast<u32>(sw.GetPosition());
+  stream->Resize(size);
+  stream->SeekAbsolute(size);
+
+  // Each section runs up to the start of the next one.
+  for (size_t i = 0; i < buffer->sections.size(); i++)
+  {
+    const u32 end = (i + 1 < buffer->sections.size()) ? buffer->sections[i + 1].uncompressed_offset : size;
+    buffer->sections[i].uncompressed_size = end - buffer->sections[i].uncompressed_offset;
+  }
+
+  return true;
+}
+
+bool System::WriteSaveStateBuffer(ByteStream* state, SaveStateBuffer& buffer, u32 compression_method)
+{
+  SAVE_STATE_HEADER& header = buffer.header;
+
+  const u64 header_position = state->GetPosition();
+  if (!state->Write2(&header, sizeof(header)))
+    return false;
+
+  if (header.media_filename_length > 0)
+  {
+    header.offset_to_media_filename = static_cast<u32>(state->GetPosition());
+    if (!state->Write2(buffer.media_filename.data(), header.media_filename_length))
+      return false;
+  }
+
+  if (header.screenshot_width > 0)
+  {
+    const u32 screenshot_width = header.screenshot_width;
+    const u32 screenshot_height = header.screenshot_height;
+    if (!GPUTexture::ConvertTextureDataToRGBA8(screenshot_width, screenshot_height, buffer.screenshot_buffer,
+                                               buffer.screenshot_stride, buffer.screenshot_format))
+    {
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to conversion failure", screenshot_width,
+                        screenshot_height);
+      header.screenshot_width = 0;
+      header.screenshot_height = 0;
+    }
+    else if (buffer.screenshot_stride != (screenshot_width * sizeof(u32)))
+    {
+      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to incorrect stride(%u)", screenshot_width,
+                        screenshot_height, buffer.screenshot_stride);
+      header.screenshot_width = 0;
+      header.screenshot_height = 0;
     }
     else
     {
-      Log_WarningPrintf("Failed to save %ux%u screenshot for save state due to render/conversion failure",
-                        screenshot_width, screenshot_height);
+      if (buffer.flip_screenshot)
+      {
+        GPUTexture::FlipTextureDataRGBA8(screenshot_width, screenshot_height, buffer.screenshot_buffer,
+                                         buffer.screenshot_stride);
+      }
+
+      header.offset_to_screenshot = static_cast<u32>(state->GetPosition());
+      header.screenshot_size = static_cast<u32>(buffer.screenshot_buffer.size() * sizeof(u32));
+      if (!state->Write2(buffer.screenshot_buffer.data(), header.screenshot_size))
+        return false;
     }
   }
 
   // write data
   {
+    const u8* data = buffer.state_stream->GetMemoryPointer();
+    const u32 data_size = static_cast<u32>(buffer.state_stream->GetSize());
     header.offset_to_data = static_cast<u32>(state->GetPosition());
-
-    g_gpu->RestoreDeviceContext();
-
     header.data_compression_type = compression_method;
+    header.data_uncompressed_size = data_size;
 
     bool result = false;
     if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE)
     {
-      StateWrapper sw(state, StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false);
-      header.data_uncompressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+      result = state->Write2(data, data_size);
     }
     else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD)
     {
       std::unique_ptr<ByteStream> cstream(ByteStream::CreateZstdCompressStream(state, 0));
-      StateWrapper sw(cstream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
-      result = DoState(sw, nullptr, false, false) && cstream->Commit();
-      header.data_uncompressed_size = static_cast<u32>(cstream->GetPosition());
+      result = cstream->Write2(data, data_size) && cstream->Commit();
+      header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
+    }
+    else if (compression_method == SAVE_STATE_HEADER::COMPRESSION_TYPE_ZSTD_SECTIONS)
+    {
+      result = WriteSaveStateSections(state, buffer);
       header.data_compressed_size = static_cast<u32>(state->GetPosition() - header.offset_to_data);
     }
 
@@ -2548,18 +3388,64 @@ void System::UpdatePerformanceCounters()
 
   if (g_gpu_device->IsGPUTimingEnabled())
   {
-    s_average_gpu_time = s_accumulated_gpu_time / static_cast<float>(std::max(s_presents_since_last_update, 1u));
+    const float presents = static_cast<float>(std::max(s_presents_since_last_update, 1u));
+    s_average_gpu_time = s_accumulated_gpu_time / presents;
     s_gpu_usage = s_accumulated_gpu_time / (time * 10.0f);
+    for (u32 i = 0; i < GPUDevice::NUM_TIMING_SCOPES; i++)
+      s_average_gpu_scope_times[i] = s_accumulated_gpu_scope_times[i] / presents;
   }
   s_accumulated_gpu_time = 0.0f;
+  s_accumulated_gpu_scope_times = {};
   s_presents_since_last_update = 0;
 
+  if (g_settings.debugging.dump_gpu_timings && g_gpu_device->IsGPUTimingEnabled())
+    WriteGPUTimings();
+  else if (s_gpu_timings_file)
+    CloseGPUTimingsFile();
+
   Log_VerbosePrintf("FPS: %.2f VPS: %.2f CPU: %.2f GPU: %.2f Average: %.2fms Min: %.2fms Max: %.2f ms", s_fps, s_vps,
                     s_cpu_thread_usage, s_gpu_usage, s_average_frame_time, s_minimum_frame_time, s_maximum_frame_time);
 
+  s_performance_counters_update_count++;
   Host::OnPerformanceCountersUpdated();
 }
 
+void System::WriteGPUTimings()
+{
+  if (!s_gpu_timings_file)
+  {
+    const std::string path = Path::Combine(
+      EmuFolders::Dumps, fmt::format("gpu_timings_{}{}{}.csv", s_running_game_serial,
+                                     s_running_game_serial.empty() ? "" : "_", GetTimestampStringForFileName()));
+    s_gpu_timings_file = FileSystem::OpenCFile(path.c_str(), "wb");
+    if (!s_gpu_timings_file)
+    {
+      Log_ErrorPrintf("Failed to open '%s' for writing GPU timings", path.c_str());
+      return;
+    }
+
+    Log_InfoPrintf("Writing GPU timings to '%s'", path.c_str());
+    std::fprintf(s_gpu_timings_file, "Frame,FPS,GPU Usage,GPU Time");
+    for (u32 i = 0; i < GPUDevice::NUM_TIMING_SCOPES; i++)
+      std::fprintf(s_gpu_timings_file, ",%s", GPUDevice::GetTimingScopeName(static_cast<GPUDevice::TimingScope>(i)));
+    std::fprintf(s_gpu_timings_file, "\n");
+  }
+
+  std::fprintf(s_gpu_timings_file, "%u,%.2f,%.2f,%.3f", s_frame_number, s_fps, s_gpu_usage, s_average_gpu_time);
+  for (u32 i = 0; i < GPUDevice::NUM_TIMING_SCOPES; i++)
+    std::fprintf(s_gpu_timings_file, ",%.3f", s_average_gpu_scope_times[i]);
+  std::fprintf(s_gpu_timings_file, "\n");
+}
+
+void System::CloseGPUTimingsFile()
+{
+  if (!s_gpu_timings_file)
+    return;
+
+  std::fclose(s_gpu_timings_file);
+  s_gpu_timings_file = nullptr;
+}
+
 void System::ResetPerformanceCounters()
 {
   s_last_frame_number = s_frame_number;
@@ -2579,6 +3465,23 @@ void System::ResetPerformanceCounters()
   ResetThrottler();
 }
 
+bool System::ShouldRenderSkipFrame()
+{
+  // Captures and netplay peers need every frame.
+  if (!g_settings.gpu_render_skip || !IsRunningAtNonStandardSpeed() || s_media_capture || Netplay::IsActive())
+  {
+    s_render_skip_counter = 0;
+    return false;
+  }
+
+  // Render about as many frames as the console would at normal speed, so slow motion never skips. Unlimited speed
+  // goes by the current rate.
+  const float speed = (s_target_speed > 0.0f) ? s_target_speed : (s_fps / GetThrottleFrequency());
+  const u32 interval = std::clamp<u32>(static_cast<u32>(speed), 1, MAX_RENDER_SKIP_INTERVAL);
+  s_render_skip_counter = (s_render_skip_counter + 1) % interval;
+  return (s_render_skip_counter != 0);
+}
+
 void System::UpdateSpeedLimiterState()
 {
   const float old_target_speed = s_target_speed;
@@ -2587,6 +3490,7 @@ void System::UpdateSpeedLimiterState()
                      (s_fast_forward_enabled ? g_settings.fast_forward_speed : g_settings.emulation_speed);
   s_throttler_enabled = (s_target_speed != 0.0f);
   s_display_all_frames = !s_throttler_enabled || g_settings.display_all_frames;
+  s_pre_frame_sleep = s_throttler_enabled && g_settings.display_pre_frame_sleep;
 
   s_syncing_to_host = false;
   if (g_settings.sync_to_host_refresh_rate && (g_settings.audio_stretch_mode != AudioStretchMode::Off) &&
@@ -2609,6 +3513,7 @@ void System::UpdateSpeedLimiterState()
   {
     Log_InfoPrintf("Using host vsync for throttling.");
     s_throttler_enabled = false;
+    s_pre_frame_sleep = false;
   }
 
   Log_VerbosePrintf("Target speed: %f%%", s_target_speed * 100.0f);
@@ -3283,6 +4188,8 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
   if (!booting && s_running_game_path == path)
     return;
 
+  TRACE_SCOPE("System::UpdateRunningGame");
+
   const std::string prev_serial = std::move(s_running_game_serial);
 
   s_running_game_path.clear();
@@ -3327,6 +4234,8 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
   }
 
   g_texture_replacements.SetGameID(s_running_game_serial);
+  if (g_gpu_device)
+    g_gpu_device->SetShaderCacheProfile(s_running_game_serial);
 
   if (booting)
     Achievements::ResetHardcoreMode();
@@ -3557,6 +4466,8 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
          g_settings.cpu_recompiler_block_linking != old_settings.cpu_recompiler_block_linking ||
          g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache ||
+         g_settings.cpu_recompiler_block_profiling != old_settings.cpu_recompiler_block_profiling ||
+         g_settings.cpu_recompiler_idle_loop_skipping != old_settings.cpu_recompiler_idle_loop_skipping ||
          g_settings.bios_tty_logging != old_settings.bios_tty_logging))
     {
       Host::AddIconOSDMessage("CPUFlushAllBlocks", ICON_FA_MICROCHIP,
@@ -3573,9 +4484,13 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
 
     if (g_settings.gpu_resolution_scale != old_settings.gpu_resolution_scale ||
         g_settings.gpu_multisamples != old_settings.gpu_multisamples ||
+        g_settings.gpu_dynamic_resolution != old_settings.gpu_dynamic_resolution ||
+        g_settings.gpu_dynamic_resolution_target != old_settings.gpu_dynamic_resolution_target ||
         g_settings.gpu_per_sample_shading != old_settings.gpu_per_sample_shading ||
         g_settings.gpu_use_thread != old_settings.gpu_use_thread ||
         g_settings.gpu_use_software_renderer_for_readbacks != old_settings.gpu_use_software_renderer_for_readbacks ||
+        g_settings.gpu_render_skip != old_settings.gpu_render_skip ||
+        g_settings.gpu_sw_worker_threads != old_settings.gpu_sw_worker_threads ||
         g_settings.gpu_fifo_size != old_settings.gpu_fifo_size ||
         g_settings.gpu_max_run_ahead != old_settings.gpu_max_run_ahead ||
         g_settings.gpu_true_color != old_settings.gpu_true_color ||
@@ -3592,6 +4507,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         g_settings.display_alignment != old_settings.display_alignment ||
         g_settings.display_scaling != old_settings.display_scaling ||
         g_settings.display_show_gpu != old_settings.display_show_gpu ||
+        g_settings.debugging.dump_gpu_timings != old_settings.debugging.dump_gpu_timings ||
         g_settings.gpu_pgxp_enable != old_settings.gpu_pgxp_enable ||
         g_settings.gpu_pgxp_texture_correction != old_settings.gpu_pgxp_texture_correction ||
         g_settings.gpu_pgxp_color_correction != old_settings.gpu_pgxp_color_correction ||
@@ -3643,6 +4559,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     if (g_settings.rewind_enable != old_settings.rewind_enable ||
         g_settings.rewind_save_frequency != old_settings.rewind_save_frequency ||
         g_settings.rewind_save_slots != old_settings.rewind_save_slots ||
+        g_settings.rewind_native_vram != old_settings.rewind_native_vram ||
         g_settings.runahead_frames != old_settings.runahead_frames)
     {
       UpdateMemorySaveStateSettings();
@@ -3650,7 +4567,8 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
 
     if (g_settings.texture_replacements.enable_vram_write_replacements !=
           old_settings.texture_replacements.enable_vram_write_replacements ||
-        g_settings.texture_replacements.preload_textures != old_settings.texture_replacements.preload_textures)
+        g_settings.texture_replacements.preload_textures != old_settings.texture_replacements.preload_textures ||
+        g_settings.texture_replacements.cache_size_mb != old_settings.texture_replacements.cache_size_mb)
     {
       g_texture_replacements.Reload();
     }
@@ -3658,6 +4576,15 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     DMA::SetMaxSliceTicks(g_settings.dma_max_slice_ticks);
     DMA::SetHaltTicks(g_settings.dma_halt_ticks);
 
+    // Other threads pick the option up when they're next started.
+    if (g_settings.thread_core_placement != old_settings.thread_core_placement)
+    {
+      if (g_settings.thread_core_placement)
+        ApplyThreadCorePlacement(true);
+      else
+        Threading::ThreadHandle::GetForCallingThread().SetAffinity(0);
+    }
+
     if (g_settings.audio_backend != old_settings.audio_backend ||
         g_settings.video_sync_enabled != old_settings.video_sync_enabled ||
         g_settings.increase_timer_resolution != old_settings.increase_timer_resolution ||
@@ -3665,6 +4592,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         g_settings.fast_forward_speed != old_settings.fast_forward_speed ||
         g_settings.display_max_fps != old_settings.display_max_fps ||
         g_settings.display_all_frames != old_settings.display_all_frames ||
+        g_settings.display_pre_frame_sleep != old_settings.display_pre_frame_sleep ||
         g_settings.sync_to_host_refresh_rate != old_settings.sync_to_host_refresh_rate)
     {
       UpdateSpeedLimiterState();
@@ -3727,22 +4655,35 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
       g_settings.log_timestamps != old_settings.log_timestamps ||
       g_settings.log_to_console != old_settings.log_to_console ||
       g_settings.log_to_debug != old_settings.log_to_debug || g_settings.log_to_window != old_settings.log_to_window ||
-      g_settings.log_to_file != old_settings.log_to_file)
+      g_settings.log_to_file != old_settings.log_to_file || g_settings.log_async != old_settings.log_async ||
+      g_settings.log_channel_rate_limit != old_settings.log_channel_rate_limit)
   {
     g_settings.UpdateLogSettings();
   }
 }
 
-void System::CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage)
+void System::CalculateRewindMemoryUsage(u32 num_saves, bool native_vram, u64* ram_usage, u64* vram_usage)
 {
-  *ram_usage = MAX_SAVE_STATE_SIZE * static_cast<u64>(num_saves);
+  // Keyframes are counted at their uncompressed size, to err on the side of caution.
+  const u64 num_keyframes = (num_saves + REWIND_KEYFRAME_INTERVAL) / (REWIND_KEYFRAME_INTERVAL + 1);
+  *ram_usage = (MAX_SAVE_STATE_SIZE * num_keyframes) +
+               ((MAX_SAVE_STATE_SIZE / REWIND_DELTA_SIZE_DIVIDER) * (static_cast<u64>(num_saves) - num_keyframes));
+  if (native_vram && g_settings.gpu_multisamples == 1)
+  {
+    *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(num_saves);
+    return;
+  }
+
   *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(std::max(g_settings.gpu_resolution_scale, 1u)) *
                 static_cast<u64>(g_settings.gpu_multisamples) * static_cast<u64>(num_saves);
 }
 
 void System::ClearMemorySaveStates()
 {
+  WaitForRewindCompression();
   s_rewind_states.clear();
+  s_rewind_keyframe.reset();
+  s_rewind_states_since_keyframe = 0;
   s_runahead_states.clear();
 }
 
@@ -3756,9 +4697,10 @@ void System::UpdateMemorySaveStateSettings()
   {
     s_rewind_save_frequency = static_cast<s32>(std::ceil(g_settings.rewind_save_frequency * s_throttle_frequency));
     s_rewind_save_counter = 0;
+    StartRewindCompressionThread();
 
     u64 ram_usage, vram_usage;
-    CalculateRewindMemoryUsage(g_settings.rewind_save_slots, &ram_usage, &vram_usage);
+    CalculateRewindMemoryUsage(g_settings.rewind_save_slots, g_settings.rewind_native_vram, &ram_usage, &vram_usage);
     Log_InfoPrintf(
       "Rewind is enabled, saving every %d frames, with %u slots and %" PRIu64 "MB RAM and %" PRIu64 "MB VRAM usage",
       std::max(s_rewind_save_frequency, 1), g_settings.rewind_save_slots, ram_usage / 1048576, vram_usage / 1048576);
@@ -3767,6 +4709,7 @@ void System::UpdateMemorySaveStateSettings()
   {
     s_rewind_save_frequency = -1;
     s_rewind_save_counter = -1;
+    StopRewindCompressionThread();
   }
 
   s_rewind_load_frequency = -1;
@@ -3780,10 +4723,15 @@ void System::UpdateMemorySaveStateSettings()
 
 bool System::LoadMemoryState(const MemorySaveState& mss)
 {
-  mss.state_stream->SeekAbsolute(0);
+  return LoadMemoryStateFromStream(mss.state_stream.get(), mss.vram_texture.get());
+}
 
-  StateWrapper sw(mss.state_stream.get(), StateWrapper::Mode::Read, SAVE_STATE_VERSION);
-  GPUTexture* host_texture = mss.vram_texture.get();
+bool System::LoadMemoryStateFromStream(GrowableMemoryByteStream* stream, GPUTexture* vram_texture)
+{
+  // read straight out of the stream's buffer, going through the stream for each value is slow
+  StateWrapper sw(stream->GetMemoryPointer(), static_cast<size_t>(stream->GetSize()), StateWrapper::Mode::Read,
+                  SAVE_STATE_VERSION);
+  GPUTexture* host_texture = vram_texture;
   if (!DoState(sw, &host_texture, true, true))
   {
     Host::ReportErrorAsync("Error", "Failed to load memory save state, resetting.");
@@ -3798,11 +4746,18 @@ bool System::SaveMemoryState(MemorySaveState* mss)
 {
   if (!mss->state_stream)
     mss->state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
-  else
-    mss->state_stream->SeekAbsolute(0);
 
-  GPUTexture* host_texture = mss->vram_texture.release();
-  StateWrapper sw(mss->state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  return SaveMemoryStateToStream(mss->state_stream.get(), &mss->vram_texture);
+}
+
+bool System::SaveMemoryStateToStream(GrowableMemoryByteStream* stream, std::unique_ptr<GPUTexture>* vram_texture)
+{
+  // write straight into the stream's buffer, which is preallocated to the maximum state size
+  if (stream->GetMemorySize() < MAX_SAVE_STATE_SIZE)
+    stream->ResizeMemory(MAX_SAVE_STATE_SIZE);
+
+  GPUTexture* host_texture = vram_texture->release();
+  StateWrapper sw(stream->GetMemoryPointer(), stream->GetMemorySize(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
   if (!DoState(sw, &host_texture, false, true))
   {
     Log_ErrorPrint("Failed to create rewind state.");
@@ -3810,7 +4765,11 @@ bool System::SaveMemoryState(MemorySaveState* mss)
     return false;
   }
 
-  mss->vram_texture.reset(host_texture);
+  vram_texture->reset(host_texture);
+
+  const u32 size = static_cast<u32>(sw.GetPosition());
+  stream->Resize(size);
+  stream->SeekAbsolute(size);
   return true;
 }
 
@@ -3820,28 +4779,167 @@ bool System::SaveRewindState()
   Common::Timer save_timer;
 #endif
 
-  // try to reuse the frontmost slot
+  // try to reuse the frontmost slot's texture, the keyframe doesn't need it to decode later states
   const u32 save_slots = g_settings.rewind_save_slots;
-  MemorySaveState mss;
+  std::unique_ptr<GPUTexture> vram_texture;
   while (s_rewind_states.size() >= save_slots)
   {
-    mss = std::move(s_rewind_states.front());
+    vram_texture = std::move(s_rewind_states.front()->vram_texture);
     s_rewind_states.pop_front();
   }
 
-  if (!SaveMemoryState(&mss))
+  // A native resolution texture tells the GPU to downscale into it, and upscale again when rewinding.
+  if (!vram_texture && g_settings.rewind_native_vram && g_gpu->IsHardwareRenderer())
+  {
+    vram_texture = g_gpu_device->CreateTexture(VRAM_WIDTH, VRAM_HEIGHT, 1, 1, 1, GPUTexture::Type::RenderTarget,
+                                               GPUTexture::Format::RGBA8, nullptr, 0, false);
+  }
+
+  std::unique_ptr<GrowableMemoryByteStream> stream;
+  {
+    std::unique_lock lock(s_rewind_compression_mutex);
+    if (!s_rewind_free_streams.empty())
+    {
+      stream = std::move(s_rewind_free_streams.back());
+      s_rewind_free_streams.pop_back();
+    }
+  }
+  if (!stream)
+    stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+
+  if (!SaveMemoryStateToStream(stream.get(), &vram_texture))
+  {
+    std::unique_lock lock(s_rewind_compression_mutex);
+    s_rewind_free_streams.push_back(std::move(stream));
     return false;
+  }
+
+  std::shared_ptr<RewindState> state = std::make_shared<RewindState>();
+  state->vram_texture = std::move(vram_texture);
+  state->uncompressed_size = static_cast<u32>(stream->GetPosition());
+  const u32 vram_offset = g_gpu->GetStateVRAMOffset();
+  if (vram_offset != 0 && (vram_offset + VRAM_SIZE) <= state->uncompressed_size)
+    state->vram_offset = vram_offset;
+  if (!s_rewind_keyframe || s_rewind_states_since_keyframe >= REWIND_KEYFRAME_INTERVAL)
+  {
+    s_rewind_keyframe = state;
+    s_rewind_states_since_keyframe = 0;
+  }
+  else
+  {
+    state->keyframe = s_rewind_keyframe;
+    s_rewind_states_since_keyframe++;
+  }
+
+  {
+    std::unique_lock lock(s_rewind_compression_mutex);
+    s_rewind_compression_queue.push_back(RewindCompressionJob{state, std::move(stream)});
+  }
+  s_rewind_compression_wake_cv.notify_one();
 
-  s_rewind_states.push_back(std::move(mss));
+  s_rewind_states.push_back(std::move(state));
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
-  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, took %.4f ms)", s_rewind_states.back().state_stream->GetSize(),
+  Log_DevPrintf("Saved rewind state (%u bytes, took %.4f ms)", s_rewind_states.back()->uncompressed_size,
                 save_timer.GetTimeMilliseconds());
 #endif
 
   return true;
 }
 
+static void StoreRewindVRAMTiles(RewindState* state, u8* vram)
+{
+  static constexpr u32 row_size = REWIND_VRAM_TILE_SIZE * sizeof(u16);
+  static constexpr u32 pitch = VRAM_WIDTH * sizeof(u16);
+
+  state->vram_tiles.clear();
+  state->vram_tiles.reserve(REWIND_VRAM_TILES_X * REWIND_VRAM_TILES_Y);
+
+  std::array<u16, REWIND_VRAM_TILE_SIZE * REWIND_VRAM_TILE_SIZE> tile_data;
+  for (u32 ty = 0; ty < REWIND_VRAM_TILES_Y; ty++)
+  {
+    for (u32 tx = 0; tx < REWIND_VRAM_TILES_X; tx++)
+    {
+      const u8* src = vram + (ty * REWIND_VRAM_TILE_SIZE * pitch) + (tx * row_size);
+      for (u32 row = 0; row < REWIND_VRAM_TILE_SIZE; row++)
+        std::memcpy(&tile_data[row * REWIND_VRAM_TILE_SIZE], src + (row * pitch), row_size);
+
+      const u64 hash = XXH64(tile_data.data(), sizeof(tile_data), 0);
+      std::shared_ptr<const RewindVRAMTile> tile;
+      auto iter = s_rewind_vram_tiles.find(hash);
+      if (iter != s_rewind_vram_tiles.end())
+      {
+        tile = iter->second.lock();
+        if (tile && std::memcmp(tile->data.data(), tile_data.data(), sizeof(tile_data)) != 0)
+        {
+          // Collision, keep this one private rather than replacing the shared one.
+          std::shared_ptr<RewindVRAMTile> new_tile = std::make_shared<RewindVRAMTile>();
+          new_tile->hash = hash;
+          new_tile->data = tile_data;
+          state->vram_tiles.push_back(std::move(new_tile));
+          continue;
+        }
+      }
+
+      if (!tile)
+      {
+        std::shared_ptr<RewindVRAMTile> new_tile = std::make_shared<RewindVRAMTile>();
+        new_tile->hash = hash;
+        new_tile->data = tile_data;
+        s_rewind_vram_tiles[hash] = new_tile;
+        tile = std::move(new_tile);
+      }
+
+      state->vram_tiles.push_back(std::move(tile));
+    }
+  }
+
+  // Zeros cost next to nothing once XORed and compressed.
+  std::memset(vram, 0, VRAM_SIZE);
+
+  // Tiles are freed along with the last state using them, which leaves their entries behind.
+  if (s_rewind_vram_tiles.size() > s_rewind_vram_tiles_prune_size)
+  {
+    for (auto it = s_rewind_vram_tiles.begin(); it != s_rewind_vram_tiles.end();)
+    {
+      if (it->second.expired())
+        it = s_rewind_vram_tiles.erase(it);
+      else
+        ++it;
+    }
+
+    s_rewind_vram_tiles_prune_size = std::max<size_t>(s_rewind_vram_tiles.size() * 2, REWIND_VRAM_MIN_PRUNE_SIZE);
+  }
+}
+
+static void RestoreRewindVRAMTiles(const RewindState& state, u8* vram)
+{
+  static constexpr u32 row_size = REWIND_VRAM_TILE_SIZE * sizeof(u16);
+  static constexpr u32 pitch = VRAM_WIDTH * sizeof(u16);
+  if (state.vram_tiles.size() != (REWIND_VRAM_TILES_X * REWIND_VRAM_TILES_Y))
+    return;
+
+  for (u32 ty = 0; ty < REWIND_VRAM_TILES_Y; ty++)
+  {
+    for (u32 tx = 0; tx < REWIND_VRAM_TILES_X; tx++)
+    {
+      const RewindVRAMTile& tile = *state.vram_tiles[ty * REWIND_VRAM_TILES_X + tx];
+      u8* dst = vram + (ty * REWIND_VRAM_TILE_SIZE * pitch) + (tx * row_size);
+      for (u32 row = 0; row < REWIND_VRAM_TILE_SIZE; row++)
+        std::memcpy(dst + (row * pitch), &tile.data[row * REWIND_VRAM_TILE_SIZE], row_size);
+    }
+  }
+}
+
+static bool DecompressRewindData(const DynamicHeapArray<u8>& compressed_data, void* dst, u32 size)
+{
+  std::unique_ptr<ReadOnlyMemoryByteStream> src_stream =
+    ByteStream::CreateReadOnlyMemoryStream(compressed_data.data(), static_cast<u32>(compressed_data.size()));
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::CreateZstdDecompressStream(src_stream.get(), static_cast<u32>(compressed_data.size()));
+  return stream->Read2(dst, size);
+}
+
 bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true */)
 {
   while (skip_saves > 0 && !s_rewind_states.empty())
@@ -3857,12 +4955,47 @@ bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true
   Common::Timer load_timer;
 #endif
 
-  if (!LoadMemoryState(s_rewind_states.back()))
+  WaitForRewindCompression();
+
+  const RewindState& state = *s_rewind_states.back();
+  if (!s_rewind_load_stream)
+    s_rewind_load_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+  s_rewind_load_stream->Resize(state.uncompressed_size);
+
+  u8* data = s_rewind_load_stream->GetMemoryPointer();
+  if (!DecompressRewindData(state.compressed_data, data, state.uncompressed_size))
+  {
+    Log_ErrorPrint("Failed to decompress rewind state.");
+    return false;
+  }
+
+  if (state.keyframe)
+  {
+    const RewindState& keyframe = *state.keyframe;
+    s_rewind_load_keyframe.resize(keyframe.uncompressed_size);
+    if (!DecompressRewindData(keyframe.compressed_data, s_rewind_load_keyframe.data(), keyframe.uncompressed_size))
+    {
+      Log_ErrorPrint("Failed to decompress rewind keyframe.");
+      return false;
+    }
+
+    const u32 delta_size = std::min(state.uncompressed_size, keyframe.uncompressed_size);
+    for (u32 i = 0; i < delta_size; i++)
+      data[i] ^= s_rewind_load_keyframe[i];
+  }
+
+  if (state.vram_offset != 0)
+    RestoreRewindVRAMTiles(state, data + state.vram_offset);
+
+  if (!LoadMemoryStateFromStream(s_rewind_load_stream.get(), state.vram_texture.get()))
     return false;
 
   if (consume_state)
     s_rewind_states.pop_back();
 
+  // Later saves start from a new keyframe, older ones are unlikely to resemble the states from here on.
+  s_rewind_keyframe.reset();
+
 #ifdef PROFILE_MEMORY_SAVE_STATES
   Log_DevPrintf("Rewind load took %.4f ms", load_timer.GetTimeMilliseconds());
 #endif
@@ -3870,6 +5003,111 @@ bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true
   return true;
 }
 
+void System::StartRewindCompressionThread()
+{
+  if (s_rewind_compression_thread_running)
+    return;
+
+  s_rewind_compression_shutdown = false;
+  s_rewind_compression_thread_running = true;
+  s_rewind_compression_thread.Start(&System::RewindCompressionThreadEntryPoint);
+}
+
+void System::StopRewindCompressionThread()
+{
+  if (!s_rewind_compression_thread_running)
+    return;
+
+  {
+    std::unique_lock lock(s_rewind_compression_mutex);
+    s_rewind_compression_shutdown = true;
+  }
+  s_rewind_compression_wake_cv.notify_one();
+  s_rewind_compression_thread.Join();
+  s_rewind_compression_thread_running = false;
+
+  s_rewind_free_streams.clear();
+  s_rewind_compression_keyframe = std::vector<u8>();
+  s_rewind_vram_tiles = {};
+  s_rewind_vram_tiles_prune_size = 0;
+  s_rewind_load_stream.reset();
+  s_rewind_load_keyframe = std::vector<u8>();
+}
+
+void System::WaitForRewindCompression()
+{
+  std::unique_lock lock(s_rewind_compression_mutex);
+  s_rewind_compression_done_cv.wait(
+    lock, []() { return s_rewind_compression_queue.empty() && !s_rewind_compression_busy; });
+}
+
+void System::RewindCompressionThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Rewind Compression");
+  ApplyThreadCorePlacement(false);
+
+  std::unique_lock lock(s_rewind_compression_mutex);
+  for (;;)
+  {
+    s_rewind_compression_wake_cv.wait(
+      lock, []() { return s_rewind_compression_shutdown || !s_rewind_compression_queue.empty(); });
+    if (s_rewind_compression_queue.empty())
+      break;
+
+    RewindCompressionJob job = std::move(s_rewind_compression_queue.front());
+    s_rewind_compression_queue.pop_front();
+    s_rewind_compression_busy = true;
+    lock.unlock();
+
+#ifdef PROFILE_MEMORY_SAVE_STATES
+    Common::Timer compress_timer;
+#endif
+
+    // Jobs are processed in order, so the keyframe for any delta has always been seen first.
+    RewindState& state = *job.state;
+    u8* data = job.stream->GetMemoryPointer();
+    if (state.vram_offset != 0)
+      StoreRewindVRAMTiles(&state, data + state.vram_offset);
+    if (!state.keyframe)
+    {
+      s_rewind_compression_keyframe.assign(data, data + state.uncompressed_size);
+    }
+    else
+    {
+      const u32 delta_size =
+        std::min(state.uncompressed_size, static_cast<u32>(s_rewind_compression_keyframe.size()));
+      for (u32 i = 0; i < delta_size; i++)
+        data[i] ^= s_rewind_compression_keyframe[i];
+    }
+
+    std::unique_ptr<GrowableMemoryByteStream> compressed_stream = ByteStream::CreateGrowableMemoryStream();
+    std::unique_ptr<ByteStream> stream =
+      ByteStream::CreateZstdCompressStream(compressed_stream.get(), REWIND_COMPRESSION_LEVEL);
+    if (stream->Write2(data, state.uncompressed_size) && stream->Commit())
+    {
+      state.compressed_data = DynamicHeapArray<u8>(compressed_stream->GetMemoryPointer(),
+                                                   static_cast<size_t>(compressed_stream->GetSize()));
+    }
+    else
+    {
+      Log_ErrorPrint("Failed to compress rewind state.");
+    }
+
+#ifdef PROFILE_MEMORY_SAVE_STATES
+    Log_DevPrintf("Compressed rewind %s (%u -> %zu bytes, took %.4f ms)", state.keyframe ? "delta" : "keyframe",
+                  state.uncompressed_size, state.compressed_data.size(), compress_timer.GetTimeMilliseconds());
+#endif
+
+    lock.lock();
+    s_rewind_free_streams.push_back(std::move(job.stream));
+    if (s_rewind_compression_queue.empty())
+    {
+      s_rewind_compression_busy = false;
+      s_rewind_compression_done_cv.notify_all();
+    }
+  }
+}
+
 bool System::IsRewinding()
 {
   return (s_rewind_load_frequency >= 0);
@@ -3930,12 +5168,14 @@ void System::SaveRunaheadState()
     s_runahead_states.pop_front();
   }
 
+  Common::Timer save_timer;
   if (!SaveMemoryState(&mss))
   {
     Log_ErrorPrint("Failed to save runahead state.");
     return;
   }
 
+  s_runahead_save_time = static_cast<float>(save_timer.GetTimeMilliseconds());
   s_runahead_states.push_back(std::move(mss));
 }
 
@@ -3954,11 +5194,13 @@ bool System::DoRunahead()
 
     // we need to replay and catch up - load the state,
     s_runahead_replay_pending = false;
+    Common::Timer load_timer;
     if (s_runahead_states.empty() || !LoadMemoryState(s_runahead_states.front()))
     {
       s_runahead_states.clear();
       return false;
     }
+    s_runahead_load_time = static_cast<float>(load_timer.GetTimeMilliseconds());
 
     // figure out how many frames we need to run to catch up
     s_runahead_replay_frames = static_cast<u32>(s_runahead_states.size());
@@ -4160,6 +5402,238 @@ void System::StopDumpingAudio()
   Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Stopped dumping audio."), 5.0f);
 }
 
+bool System::IsMediaCaptureActive()
+{
+  return static_cast<bool>(s_media_capture);
+}
+
+MediaCapture* System::GetMediaCapture()
+{
+  return s_media_capture.get();
+}
+
+bool System::StartMediaCapture(const char* filename)
+{
+  if (!IsValid() || s_media_capture)
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const char* extension = MediaCapture::GetFileExtension(g_settings.media_capture_backend);
+    const auto& serial = System::GetGameSerial();
+    if (serial.empty())
+    {
+      auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("video" FS_OSPATH_SEPARATOR_STR "{}.{}",
+                                                                   GetTimestampStringForFileName(), extension));
+    }
+    else
+    {
+      auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("video" FS_OSPATH_SEPARATOR_STR "{}_{}.{}", serial,
+                                                                   GetTimestampStringForFileName(), extension));
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  // The emulated display is captured, not the window, so the size only depends on the aspect ratio.
+  static constexpr u32 VIDEO_HEIGHT = 480;
+  const float aspect_ratio = std::clamp(g_gpu->GetDisplayAspectRatio(), 0.5f, 4.0f);
+  const u32 video_width =
+    Common::AlignUpPow2(static_cast<u32>(static_cast<float>(VIDEO_HEIGHT) * aspect_ratio + 0.5f), 2);
+
+  Error error;
+  std::unique_ptr<MediaCapture> cap = MediaCapture::Create(g_settings.media_capture_backend);
+  if (!cap || !cap->BeginCapture(filename, video_width, VIDEO_HEIGHT, g_gpu->ComputeVerticalFrequency(),
+                                 SPU::SAMPLE_RATE, g_settings.media_capture_quality, &error))
+  {
+    Log_ErrorPrintf("Failed to start capture to '%s': %s", filename, error.GetDescription().c_str());
+    Host::AddFormattedOSDMessage(10.0f, TRANSLATE("OSDMessage", "Failed to start video capture to '%s'."), filename);
+    return false;
+  }
+
+  s_media_capture = std::move(cap);
+  Host::AddFormattedOSDMessage(5.0f, TRANSLATE("OSDMessage", "Started video capture to '%s'."), filename);
+  return true;
+}
+
+void System::StopMediaCapture()
+{
+  if (!s_media_capture)
+    return;
+
+  Error error;
+  const bool result = s_media_capture->EndCapture(&error);
+  const std::string path = s_media_capture->GetPath();
+  s_media_capture.reset();
+  if (!result)
+  {
+    Log_ErrorPrintf("Failed to finish capture: %s", error.GetDescription().c_str());
+    Host::AddFormattedOSDMessage(10.0f, TRANSLATE("OSDMessage", "Failed to finish video capture to '%s'."),
+                                 path.c_str());
+    return;
+  }
+
+  Host::AddFormattedOSDMessage(5.0f, TRANSLATE("OSDMessage", "Stopped video capture to '%s'."), path.c_str());
+}
+
+void System::StartGuestProfiler()
+{
+  if (!IsValid() || CPU::Profiler::IsActive())
+    return;
+
+  CPU::Profiler::Start();
+  Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Started guest profiler."), 5.0f);
+}
+
+bool System::StopGuestProfiler(const char* filename)
+{
+  if (!CPU::Profiler::IsActive())
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const auto& serial = System::GetGameSerial();
+    if (serial.empty())
+    {
+      auto_filename =
+        Path::Combine(EmuFolders::Dumps, fmt::format("profile_{}.folded", GetTimestampStringForFileName()));
+    }
+    else
+    {
+      auto_filename =
+        Path::Combine(EmuFolders::Dumps, fmt::format("profile_{}_{}.folded", serial, GetTimestampStringForFileName()));
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  Error error;
+  const u32 sample_count = CPU::Profiler::GetSampleCount();
+  if (!CPU::Profiler::Stop(filename, &error))
+  {
+    Log_ErrorPrintf("Failed to write profile to '%s': %s", filename, error.GetDescription().c_str());
+    Host::AddFormattedOSDMessage(10.0f, TRANSLATE("OSDMessage", "Failed to write guest profile to '%s'."), filename);
+    return false;
+  }
+
+  Host::AddFormattedOSDMessage(5.0f, TRANSLATE("OSDMessage", "Wrote %u guest profile samples to '%s'."), sample_count,
+                               filename);
+  return true;
+}
+
+void System::StartTraceRecording()
+{
+  if (TraceRecorder::IsRecording())
+    return;
+
+  TraceRecorder::Start();
+  Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Started recording trace events."), 5.0f);
+}
+
+bool System::StopTraceRecording(const char* filename)
+{
+  if (!TraceRecorder::IsRecording())
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("trace_{}.json", GetTimestampStringForFileName()));
+    filename = auto_filename.c_str();
+  }
+
+  Error error;
+  if (!TraceRecorder::Stop(filename, &error))
+  {
+    Log_ErrorPrintf("Failed to write trace to '%s': %s", filename, error.GetDescription().c_str());
+    Host::AddFormattedOSDMessage(10.0f, TRANSLATE("OSDMessage", "Failed to write trace to '%s'."), filename);
+    return false;
+  }
+
+  Host::AddFormattedOSDMessage(5.0f, TRANSLATE("OSDMessage", "Trace events written to '%s'."), filename);
+  return true;
+}
+
+bool System::StartInputMovieRecording(const char* filename)
+{
+  if (!IsValid())
+    return false;
+
+  std::string auto_filename;
+  if (!filename)
+  {
+    const auto& serial = System::GetGameSerial();
+    if (serial.empty())
+    {
+      auto_filename = Path::Combine(EmuFolders::Dumps, fmt::format("movie_{}.dsm", GetTimestampStringForFileName()));
+    }
+    else
+    {
+      auto_filename =
+        Path::Combine(EmuFolders::Dumps, fmt::format("movie_{}_{}.dsm", serial, GetTimestampStringForFileName()));
+    }
+
+    filename = auto_filename.c_str();
+  }
+
+  Error error;
+  if (!InputMovie::StartRecording(filename, InputMovie::DEFAULT_KEYFRAME_INTERVAL_SECONDS, &error))
+  {
+    Log_ErrorPrintf("Failed to record input movie to '%s': %s", filename, error.GetDescription().c_str());
+    Host::AddFormattedOSDMessage(10.0f, TRANSLATE("OSDMessage", "Failed to record input movie to '%s'."), filename);
+    return false;
+  }
+
+  Host::AddFormattedOSDMessage(5.0f, TRANSLATE("OSDMessage", "Recording input movie to '%s'."), filename);
+  return true;
+}
+
+bool System::PlayInputMovie(const char* filename)
+{
+  if (!IsValid())
+    return false;
+
+  Error error;
+  if (!InputMovie::StartPlayback(filename, &error))
+  {
+    Log_ErrorPrintf("Failed to play input movie '%s': %s", filename, error.GetDescription().c_str());
+    Host::AddFormattedOSDMessage(10.0f, TRANSLATE("OSDMessage", "Failed to play input movie '%s': %s"), filename,
+                                 error.GetDescription().c_str());
+    return false;
+  }
+
+  ResetThrottler();
+  Host::AddFormattedOSDMessage(5.0f, TRANSLATE("OSDMessage", "Playing input movie '%s'."), filename);
+  return true;
+}
+
+bool System::SeekInputMovie(u32 frame)
+{
+  Error error;
+  if (!InputMovie::SeekToFrame(frame, &error))
+  {
+    Log_ErrorPrintf("Failed to seek input movie to frame %u: %s", frame, error.GetDescription().c_str());
+    return false;
+  }
+
+  ResetThrottler();
+  return true;
+}
+
+void System::StopInputMovie()
+{
+  if (!InputMovie::IsActive())
+    return;
+
+  const bool recording = InputMovie::IsRecording();
+  InputMovie::Stop();
+  Host::AddOSDMessage(recording ? TRANSLATE_STR("OSDMessage", "Stopped recording input movie.") :
+                                  TRANSLATE_STR("OSDMessage", "Stopped playing input movie."),
+                      5.0f);
+}
+
 bool System::SaveScreenshot(const char* filename /* = nullptr */, bool full_resolution /* = true */,
                             bool apply_aspect_ratio /* = true */, bool compress_on_thread /* = true */)
 {
@@ -4260,21 +5734,170 @@ std::optional<SaveStateInfo> System::GetSaveStateInfo(const char* serial, s32 sl
 
 std::optional<ExtendedSaveStateInfo> System::GetExtendedSaveStateInfo(const char* path)
 {
+  // Don't pick up the previous version of a state which is still being written.
+  WaitForSaveStateWrites();
+
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path, &sd))
     return std::nullopt;
 
+  std::optional<ExtendedSaveStateInfo> ssi = GetIndexedSaveStateInfo(path, sd);
+  if (ssi.has_value())
+    return ssi;
+
   std::unique_ptr<ByteStream> stream = ByteStream::OpenFile(path, BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_SEEKABLE);
   if (!stream)
     return std::nullopt;
 
-  std::optional<ExtendedSaveStateInfo> ssi(InternalGetExtendedSaveStateInfo(stream.get()));
+  ssi = InternalGetExtendedSaveStateInfo(stream.get());
   if (ssi)
+  {
+    // States from before the index existed, or changed behind our back. Next time it'll come from the index.
     ssi->timestamp = sd.ModificationTime;
+    UpdateSaveStateIndex(path, sd, ssi.value());
+  }
 
   return ssi;
 }
 
+std::string System::GetSaveStateIndexFileName(const std::string_view& state_path)
+{
+  // States are named <serial>_<slot>.sav or savestate_<slot>.sav, so each game and the global slots get one index.
+  const std::string_view filename = Path::GetFileTitle(state_path);
+  const std::string_view::size_type pos = filename.rfind('_');
+  const std::string_view prefix = (pos != std::string_view::npos) ? filename.substr(0, pos) : filename;
+  return Path::Combine(Path::GetDirectory(state_path), fmt::format("{}.idx", prefix));
+}
+
+static SaveStateIndex& GetSaveStateIndex(const std::string& index_path)
+{
+  for (SaveStateIndex& index : s_save_state_index_cache)
+  {
+    if (index.path == index_path)
+      return index;
+  }
+
+  if (s_save_state_index_cache.size() >= MAX_CACHED_SAVE_STATE_INDICES)
+    s_save_state_index_cache.pop_front();
+
+  SaveStateIndex& index = s_save_state_index_cache.emplace_back();
+  index.path = index_path;
+
+  const std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(index_path.c_str());
+  if (!data.has_value())
+    return index;
+
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::CreateReadOnlyMemoryStream(data->data(), static_cast<u32>(data->size()));
+  u32 magic, version, count;
+  if (!stream->ReadU32(&magic) || !stream->ReadU32(&version) || !stream->ReadU32(&count) ||
+      magic != SAVE_STATE_INDEX_MAGIC || version != SAVE_STATE_INDEX_VERSION)
+  {
+    Log_WarningPrintf("Ignoring invalid save state index '%s'", index_path.c_str());
+    return index;
+  }
+
+  for (u32 i = 0; i < count; i++)
+  {
+    SaveStateIndexEntry entry;
+    ExtendedSaveStateInfo& ssi = entry.info;
+    if (!stream->ReadSizePrefixedString(&entry.filename) || !stream->ReadU64(&entry.modification_time) ||
+        !stream->ReadU64(&entry.size) || !stream->ReadSizePrefixedString(&ssi.title) ||
+        !stream->ReadSizePrefixedString(&ssi.serial) || !stream->ReadSizePrefixedString(&ssi.media_path) ||
+        !stream->ReadU32(&ssi.screenshot_width) || !stream->ReadU32(&ssi.screenshot_height) ||
+        (static_cast<u64>(ssi.screenshot_width) * ssi.screenshot_height * sizeof(u32)) >
+          (stream->GetSize() - stream->GetPosition()))
+    {
+      Log_WarningPrintf("Truncated save state index '%s'", index_path.c_str());
+      index.entries.clear();
+      return index;
+    }
+
+    ssi.timestamp = static_cast<std::time_t>(entry.modification_time);
+    ssi.screenshot_data.resize(ssi.screenshot_width * ssi.screenshot_height);
+    if (!ssi.screenshot_data.empty() &&
+        !stream->Read2(ssi.screenshot_data.data(), static_cast<u32>(ssi.screenshot_data.size() * sizeof(u32))))
+    {
+      index.entries.clear();
+      return index;
+    }
+
+    index.entries.push_back(std::move(entry));
+  }
+
+  return index;
+}
+
+static void WriteSaveStateIndex(const SaveStateIndex& index)
+{
+  std::unique_ptr<GrowableMemoryByteStream> memory_stream = ByteStream::CreateGrowableMemoryStream();
+  ByteStream* stream = memory_stream.get();
+  bool result = stream->WriteU32(SAVE_STATE_INDEX_MAGIC) && stream->WriteU32(SAVE_STATE_INDEX_VERSION) &&
+                stream->WriteU32(static_cast<u32>(index.entries.size()));
+  for (const SaveStateIndexEntry& entry : index.entries)
+  {
+    // The dimensions aren't set when there's no screenshot.
+    const ExtendedSaveStateInfo& ssi = entry.info;
+    const bool has_screenshot =
+      !ssi.screenshot_data.empty() && ssi.screenshot_data.size() == (ssi.screenshot_width * ssi.screenshot_height);
+    result = result && stream->WriteSizePrefixedString(entry.filename) && stream->WriteU64(entry.modification_time) &&
+             stream->WriteU64(entry.size) && stream->WriteSizePrefixedString(ssi.title) &&
+             stream->WriteSizePrefixedString(ssi.serial) && stream->WriteSizePrefixedString(ssi.media_path) &&
+             stream->WriteU32(has_screenshot ? ssi.screenshot_width : 0) &&
+             stream->WriteU32(has_screenshot ? ssi.screenshot_height : 0) &&
+             (!has_screenshot ||
+              stream->Write2(ssi.screenshot_data.data(), static_cast<u32>(ssi.screenshot_data.size() * sizeof(u32))));
+  }
+
+  if (!result ||
+      !FileSystem::WriteBinaryFile(index.path.c_str(), memory_stream->GetMemoryPointer(),
+                                   static_cast<size_t>(memory_stream->GetSize())))
+  {
+    Log_ErrorPrintf("Failed to write save state index '%s'", index.path.c_str());
+  }
+}
+
+std::optional<ExtendedSaveStateInfo> System::GetIndexedSaveStateInfo(const char* path, const FILESYSTEM_STAT_DATA& sd)
+{
+  const std::string_view filename = Path::GetFileName(path);
+
+  std::unique_lock lock(s_save_state_index_mutex);
+  const SaveStateIndex& index = GetSaveStateIndex(GetSaveStateIndexFileName(path));
+  for (const SaveStateIndexEntry& entry : index.entries)
+  {
+    if (entry.filename != filename)
+      continue;
+
+    // Anything other than our own writes changing the state means the entry can't be trusted.
+    if (entry.modification_time != static_cast<u64>(sd.ModificationTime) || entry.size != static_cast<u64>(sd.Size))
+      return std::nullopt;
+
+    return entry.info;
+  }
+
+  return std::nullopt;
+}
+
+void System::UpdateSaveStateIndex(const char* path, const FILESYSTEM_STAT_DATA& sd, const ExtendedSaveStateInfo& ssi)
+{
+  const std::string_view filename = Path::GetFileName(path);
+
+  std::unique_lock lock(s_save_state_index_mutex);
+  SaveStateIndex& index = GetSaveStateIndex(GetSaveStateIndexFileName(path));
+  auto iter = std::find_if(index.entries.begin(), index.entries.end(),
+                           [&filename](const SaveStateIndexEntry& entry) { return entry.filename == filename; });
+  if (iter == index.entries.end())
+  {
+    iter = index.entries.emplace(index.entries.end());
+    iter->filename = filename;
+  }
+
+  iter->modification_time = static_cast<u64>(sd.ModificationTime);
+  iter->size = static_cast<u64>(sd.Size);
+  iter->info = ssi;
+  WriteSaveStateIndex(index);
+}
+
 std::optional<ExtendedSaveStateInfo> System::InternalGetExtendedSaveStateInfo(ByteStream* stream)
 {
   SAVE_STATE_HEADER header;
@@ -4617,7 +6240,13 @@ void System::HostDisplayResized()
 
 bool System::PresentDisplay(bool allow_skip_present)
 {
-  const bool skip_present = allow_skip_present && g_gpu_device->ShouldSkipDisplayingFrame();
+  TRACE_SCOPE("System::PresentDisplay");
+
+  // If the present thread is still busy with the last frame, drop this one rather than waiting on the swap chain.
+  // Composition, post-processing and the OSD would be wasted on it anyway.
+  const bool skip_present =
+    allow_skip_present && ((!s_display_all_frames && g_gpu_device->IsPresentPending()) ||
+                           g_gpu_device->ShouldSkipDisplayingFrame());
 
   Host::BeginPresentFrame();
 
@@ -4648,11 +6277,20 @@ bool System::PresentDisplay(bool allow_skip_present)
   {
     g_gpu_device->RenderImGui();
     g_gpu_device->EndPresent();
+    g_gpu_device->TrimTexturePool();
 
     if (g_gpu_device->IsGPUTimingEnabled())
     {
-      s_accumulated_gpu_time += g_gpu_device->GetAndResetAccumulatedGPUTime();
+      const float gpu_time = g_gpu_device->GetAndResetAccumulatedGPUTime();
+      s_accumulated_gpu_time += gpu_time;
+      const GPUDevice::TimingScopeTimes scope_times = g_gpu_device->GetAndResetAccumulatedScopeTimes();
+      for (u32 i = 0; i < GPUDevice::NUM_TIMING_SCOPES; i++)
+        s_accumulated_gpu_scope_times[i] += scope_times[i];
       s_presents_since_last_update++;
+
+      // Presents while paused only redraw the last frame, and would make the GPU look idle.
+      if (g_gpu && s_state == State::Running && g_settings.gpu_dynamic_resolution)
+        g_gpu->UpdateDynamicResolution(gpu_time);
     }
   }
   else
@@ -4690,6 +6328,70 @@ void System::SetTimerResolutionIncreased(bool enabled)
 #endif
 }
 
+const System::ThreadCoreMasks& System::GetThreadCoreMasks()
+{
+  // Worked out once, by whichever thread gets here first.
+  static const ThreadCoreMasks masks = []() {
+    ThreadCoreMasks ret = {};
+#if defined(_WIN32) || defined(__linux__)
+    if (!cpuinfo_initialize())
+    {
+      Log_WarningPrint("Failed to initialize cpuinfo, threads won't be placed on specific cores.");
+      return ret;
+    }
+
+    // The cores with the highest clock are taken to be the performance cores. Where cpuinfo can't get the clock,
+    // every core looks the same, and the threads are left where the OS puts them.
+    u64 max_frequency = 0;
+    for (u32 i = 0; i < cpuinfo_get_cores_count(); i++)
+      max_frequency = std::max(max_frequency, cpuinfo_get_core(i)->frequency);
+
+    for (u32 i = 0; i < cpuinfo_get_processors_count(); i++)
+    {
+      const cpuinfo_processor* processor = cpuinfo_get_processor(i);
+#if defined(_WIN32)
+      // SetAffinity() only works within the first processor group.
+      if (processor->windows_group_id != 0)
+        continue;
+      const u32 id = processor->windows_processor_id;
+#else
+      const u32 id = static_cast<u32>(processor->linux_id);
+#endif
+      if (id >= 64)
+        continue;
+
+      u64& mask = (processor->core->frequency == max_frequency) ? ret.performance : ret.efficiency;
+      mask |= (static_cast<u64>(1) << id);
+    }
+
+    if (ret.performance != 0 && ret.efficiency != 0)
+    {
+      Log_InfoFmt("Performance core mask: {:016X}, efficiency core mask: {:016X}", ret.performance, ret.efficiency);
+    }
+    else
+    {
+      Log_InfoPrint("No separate performance and efficiency cores found.");
+      ret = {};
+    }
+#endif
+
+    return ret;
+  }();
+
+  return masks;
+}
+
+void System::ApplyThreadCorePlacement(bool performance_cores)
+{
+  if (!g_settings.thread_core_placement)
+    return;
+
+  const ThreadCoreMasks& masks = GetThreadCoreMasks();
+  const u64 mask = performance_cores ? masks.performance : masks.efficiency;
+  if (mask != 0 && !Threading::ThreadHandle::GetForCallingThread().SetAffinity(mask))
+    Log_WarningFmt("Failed to set thread affinity to {:016X}", mask);
+}
+
 void System::UpdateSessionTime(const std::string& prev_serial)
 {
   const u64 ctime = Common::Timer::GetCurrentValue();
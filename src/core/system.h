@@ -6,6 +6,7 @@
 #include "settings.h"
 #include "timing_event.h"
 #include "types.h"
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -21,6 +22,11 @@ class CheatList;
 
 class GPUTexture;
 class GrowableMemoryByteStream;
+class MediaCapture;
+
+namespace Common {
+class RGBA8Image;
+}
 
 namespace BIOS {
 struct ImageInfo;
@@ -212,6 +218,9 @@ const BIOS::Hash& GetBIOSHash();
 static constexpr u32 NUM_FRAME_TIME_SAMPLES = 150;
 using FrameTimeHistory = std::array<float, NUM_FRAME_TIME_SAMPLES>;
 
+/// Incremented each time the counters below are recalculated, so displays of them know when to refresh.
+u32 GetPerformanceCountersUpdateCount();
+
 float GetFPS();
 float GetVPS();
 float GetEmulationSpeed();
@@ -225,9 +234,15 @@ float GetSWThreadUsage();
 float GetSWThreadAverageTime();
 float GetGPUUsage();
 float GetGPUAverageTime();
+float GetGPUScopeAverageTime(u32 scope); // GPUDevice::TimingScope
+float GetRunaheadSaveTime();
+float GetRunaheadLoadTime();
 const FrameTimeHistory& GetFrameTimeHistory();
 u32 GetFrameTimeHistoryPos();
 
+/// Returns the number of frames which finished after their throttle deadline, since startup.
+u32 GetThrottleMissCount();
+
 /// Loads global settings (i.e. EmuConfig).
 void LoadSettings(bool display_osd_messages);
 void SetDefaultSettings(SettingsInterface& si);
@@ -244,6 +259,9 @@ void ResetSystem();
 
 /// Loads state from the specified filename.
 bool LoadState(const char* filename);
+
+/// Captures the state and queues it to be compressed and written in the background. Failures to write the file are
+/// reported through the OSD, not the return value.
 bool SaveState(const char* filename, bool backup_existing_save);
 bool SaveResumeState();
 
@@ -414,10 +432,65 @@ bool StartDumpingAudio(const char* filename = nullptr);
 /// Stops dumping audio to file if it has been started.
 void StopDumpingAudio();
 
+/// Returns true if the display and audio are being recorded to a video file.
+bool IsMediaCaptureActive();
+
+/// Returns the capture in progress, or null.
+MediaCapture* GetMediaCapture();
+
+/// Starts recording the display and audio to the specified file. If no file name is provided, one will be generated
+/// automatically.
+bool StartMediaCapture(const char* filename = nullptr);
+
+/// Stops recording, once all frames which are still being encoded have been written.
+void StopMediaCapture();
+
+/// Starts sampling the guest PC and call stack, to find which game code is slow.
+void StartGuestProfiler();
+
+/// Stops sampling, and writes the samples as folded stacks for flame graph tools. If no file name is provided, one
+/// will be generated automatically.
+bool StopGuestProfiler(const char* filename = nullptr);
+
+/// Starts recording trace events from all threads. Only the most recent events are kept, so recording can be left on
+/// until after a stutter happens.
+void StartTraceRecording();
+
+/// Stops recording trace events, and writes them to the specified file. If no file name is provided, one will be
+/// generated automatically.
+bool StopTraceRecording(const char* filename = nullptr);
+
+/// Starts recording input to an input movie, starting from the current state. If no file name is provided, one will
+/// be generated automatically.
+bool StartInputMovieRecording(const char* filename = nullptr);
+
+/// Starts playing an input movie recorded with the running game, from its first frame.
+bool PlayInputMovie(const char* filename);
+
+/// Moves input movie playback to the specified frame, from the nearest keyframe before it.
+bool SeekInputMovie(u32 frame);
+
+/// Stops recording or playing an input movie.
+void StopInputMovie();
+
 /// Saves a screenshot to the specified file. IF no file name is provided, one will be generated automatically.
 bool SaveScreenshot(const char* filename = nullptr, bool full_resolution = true, bool apply_aspect_ratio = true,
                     bool compress_on_thread = true);
 
+/// Restricts the calling thread to the host's performance cores, or its efficiency cores for background work, when
+/// thread core placement is enabled. Does nothing on hosts where all cores look the same.
+void ApplyThreadCorePlacement(bool performance_cores);
+
+/// Runs an image encode/write on the image writer threads, so screenshots and dumps don't stall emulation.
+/// Jobs are drained, not dropped, at shutdown.
+void QueueImageWrite(std::function<void()> job);
+
+/// Saves the image on the image writer threads. Failures are logged, since the caller has moved on by then.
+void QueueImageWrite(std::string filename, Common::RGBA8Image image, int quality);
+
+/// Blocks until all queued image writes have completed.
+void WaitForImageWrites();
+
 /// Loads the cheat list from the specified file.
 bool LoadCheatList(const char* filename);
 
@@ -471,7 +544,7 @@ void InvalidateDisplay();
 //////////////////////////////////////////////////////////////////////////
 // Memory Save States (Rewind and Runahead)
 //////////////////////////////////////////////////////////////////////////
-void CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage);
+void CalculateRewindMemoryUsage(u32 num_saves, bool native_vram, u64* ram_usage, u64* vram_usage);
 void ClearMemorySaveStates();
 void UpdateMemorySaveStateSettings();
 bool LoadRewindState(u32 skip_saves = 0, bool consume_state = true);
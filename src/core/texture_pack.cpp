@@ -0,0 +1,584 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "texture_pack.h"
+
+#include "common/assert.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/memmap.h"
+#include "common/string_util.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <tuple>
+
+Log_SetChannel(TexturePack);
+
+namespace TexturePack {
+namespace {
+class BlockBitWriter
+{
+public:
+  void Write(u32 value, u32 bits)
+  {
+    for (u32 i = 0; i < bits; i++, m_pos++)
+      m_bits[m_pos >> 6] |= static_cast<u64>((value >> i) & 1u) << (m_pos & 63);
+  }
+
+  void Store(u8* dst) const { std::memcpy(dst, m_bits, sizeof(m_bits)); }
+
+private:
+  u64 m_bits[2] = {};
+  u32 m_pos = 0;
+};
+
+class BlockBitReader
+{
+public:
+  explicit BlockBitReader(const u8* src) { std::memcpy(m_bits, src, sizeof(m_bits)); }
+
+  u32 Read(u32 bits)
+  {
+    u32 value = 0;
+    for (u32 i = 0; i < bits; i++, m_pos++)
+      value |= static_cast<u32>((m_bits[m_pos >> 6] >> (m_pos & 63)) & 1u) << i;
+    return value;
+  }
+
+private:
+  u64 m_bits[2];
+  u32 m_pos = 0;
+};
+} // namespace
+
+static constexpr u32 BC7_BLOCK_SIZE = 16;
+static constexpr u32 BC7_MODE6 = 1u << 6;
+static constexpr std::array<u32, 16> BC7_WEIGHTS4 = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+/// Number of textures loaded and encoded at once when writing a pack.
+static constexpr u32 WRITE_BATCH_SIZE = 64;
+
+static u32 InterpolateBC7(u32 e0, u32 e1, u32 weight)
+{
+  return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+static void EncodeBC7Block(const u8 pixels[16][4], u8* dst)
+{
+  // Fit a line through the block's colours, using the principal axis of the covariance.
+  float mean[4] = {};
+  for (u32 i = 0; i < 16; i++)
+  {
+    for (u32 c = 0; c < 4; c++)
+      mean[c] += static_cast<float>(pixels[i][c]);
+  }
+  for (u32 c = 0; c < 4; c++)
+    mean[c] /= 16.0f;
+
+  float cov[4][4] = {};
+  for (u32 i = 0; i < 16; i++)
+  {
+    float d[4];
+    for (u32 c = 0; c < 4; c++)
+      d[c] = static_cast<float>(pixels[i][c]) - mean[c];
+    for (u32 r = 0; r < 4; r++)
+    {
+      for (u32 c = 0; c < 4; c++)
+        cov[r][c] += d[r] * d[c];
+    }
+  }
+
+  float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+  for (u32 iter = 0; iter < 8; iter++)
+  {
+    float next[4] = {};
+    for (u32 r = 0; r < 4; r++)
+    {
+      for (u32 c = 0; c < 4; c++)
+        next[r] += cov[r][c] * axis[c];
+    }
+
+    const float len = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+    if (len < 1e-6f)
+      break;
+
+    for (u32 c = 0; c < 4; c++)
+      axis[c] = next[c] / len;
+  }
+
+  float tmin = 0.0f, tmax = 0.0f;
+  for (u32 i = 0; i < 16; i++)
+  {
+    float t = 0.0f;
+    for (u32 c = 0; c < 4; c++)
+      t += (static_cast<float>(pixels[i][c]) - mean[c]) * axis[c];
+    tmin = std::min(tmin, t);
+    tmax = std::max(tmax, t);
+  }
+
+  float ends[2][4];
+  for (u32 c = 0; c < 4; c++)
+  {
+    ends[0][c] = std::clamp(mean[c] + axis[c] * tmin, 0.0f, 255.0f);
+    ends[1][c] = std::clamp(mean[c] + axis[c] * tmax, 0.0f, 255.0f);
+  }
+
+  // Endpoints are 7 bits plus a shared low bit per endpoint, try each combination of those bits.
+  u32 best_error = std::numeric_limits<u32>::max();
+  u32 best_q[2][4] = {};
+  u32 best_p[2] = {};
+  u8 best_indices[16] = {};
+  for (u32 p0 = 0; p0 < 2; p0++)
+  {
+    for (u32 p1 = 0; p1 < 2; p1++)
+    {
+      const u32 p[2] = {p0, p1};
+      u32 q[2][4];
+      u32 e[2][4];
+      for (u32 i = 0; i < 2; i++)
+      {
+        for (u32 c = 0; c < 4; c++)
+        {
+          q[i][c] = static_cast<u32>(std::clamp(std::lround((ends[i][c] - static_cast<float>(p[i])) / 2.0f), 0l, 127l));
+          e[i][c] = (q[i][c] << 1) | p[i];
+        }
+      }
+
+      u32 palette[16][4];
+      for (u32 i = 0; i < 16; i++)
+      {
+        for (u32 c = 0; c < 4; c++)
+          palette[i][c] = InterpolateBC7(e[0][c], e[1][c], BC7_WEIGHTS4[i]);
+      }
+
+      u32 error = 0;
+      u8 indices[16];
+      for (u32 i = 0; i < 16; i++)
+      {
+        u32 best_pixel_error = std::numeric_limits<u32>::max();
+        for (u32 j = 0; j < 16; j++)
+        {
+          u32 pixel_error = 0;
+          for (u32 c = 0; c < 4; c++)
+          {
+            const s32 diff = static_cast<s32>(palette[j][c]) - static_cast<s32>(pixels[i][c]);
+            pixel_error += static_cast<u32>(diff * diff);
+          }
+          if (pixel_error < best_pixel_error)
+          {
+            best_pixel_error = pixel_error;
+            indices[i] = static_cast<u8>(j);
+          }
+        }
+        error += best_pixel_error;
+      }
+
+      if (error < best_error)
+      {
+        best_error = error;
+        std::memcpy(best_q, q, sizeof(q));
+        std::memcpy(best_p, p, sizeof(p));
+        std::memcpy(best_indices, indices, sizeof(indices));
+      }
+    }
+  }
+
+  // The anchor index has an implicit zero high bit, so flip the endpoints if the first pixel needs it.
+  if (best_indices[0] & 8)
+  {
+    for (u32 c = 0; c < 4; c++)
+      std::swap(best_q[0][c], best_q[1][c]);
+    std::swap(best_p[0], best_p[1]);
+    for (u32 i = 0; i < 16; i++)
+      best_indices[i] = static_cast<u8>(15 - best_indices[i]);
+  }
+
+  BlockBitWriter bw;
+  bw.Write(BC7_MODE6, 7);
+  for (u32 c = 0; c < 4; c++)
+  {
+    bw.Write(best_q[0][c], 7);
+    bw.Write(best_q[1][c], 7);
+  }
+  bw.Write(best_p[0], 1);
+  bw.Write(best_p[1], 1);
+  bw.Write(best_indices[0], 3);
+  for (u32 i = 1; i < 16; i++)
+    bw.Write(best_indices[i], 4);
+  bw.Store(dst);
+}
+
+static void DecodeBC7Block(const u8* src, u32 out[16])
+{
+  BlockBitReader br(src);
+  if (br.Read(7) != BC7_MODE6)
+  {
+    std::fill_n(out, 16, 0u);
+    return;
+  }
+
+  u32 e[2][4];
+  for (u32 c = 0; c < 4; c++)
+  {
+    e[0][c] = br.Read(7) << 1;
+    e[1][c] = br.Read(7) << 1;
+  }
+
+  const u32 p0 = br.Read(1);
+  const u32 p1 = br.Read(1);
+  for (u32 c = 0; c < 4; c++)
+  {
+    e[0][c] |= p0;
+    e[1][c] |= p1;
+  }
+
+  for (u32 i = 0; i < 16; i++)
+  {
+    const u32 weight = BC7_WEIGHTS4[br.Read((i == 0) ? 3 : 4)];
+    u32 color = 0;
+    for (u32 c = 0; c < 4; c++)
+      color |= InterpolateBC7(e[0][c], e[1][c], weight) << (c * 8);
+    out[i] = color;
+  }
+}
+
+} // namespace TexturePack
+
+const char* TexturePack::GetFormatName(Format format)
+{
+  static constexpr std::array<const char*, static_cast<u32>(Format::MaxCount)> names = {{"rgba8", "bc7"}};
+  return names[static_cast<u32>(format)];
+}
+
+std::optional<TexturePack::Format> TexturePack::ParseFormatName(const char* name)
+{
+  for (u32 i = 0; i < static_cast<u32>(Format::MaxCount); i++)
+  {
+    if (StringUtil::Strcasecmp(name, GetFormatName(static_cast<Format>(i))) == 0)
+      return static_cast<Format>(i);
+  }
+
+  return std::nullopt;
+}
+
+u32 TexturePack::GetLevelWidth(u32 width, u32 level)
+{
+  return std::max(width >> level, 1u);
+}
+
+u32 TexturePack::GetLevelHeight(u32 height, u32 level)
+{
+  return std::max(height >> level, 1u);
+}
+
+size_t TexturePack::GetLevelSize(Format format, u32 width, u32 height)
+{
+  if (format == Format::BC7)
+    return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * BC7_BLOCK_SIZE;
+  else
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * sizeof(u32);
+}
+
+void TexturePack::EncodeBC7(const Common::RGBA8Image& image, u8* blocks)
+{
+  const u32 width = image.GetWidth();
+  const u32 height = image.GetHeight();
+  for (u32 by = 0; by < height; by += 4)
+  {
+    for (u32 bx = 0; bx < width; bx += 4)
+    {
+      // Partial blocks are padded by repeating the edge pixels.
+      u8 pixels[16][4];
+      for (u32 i = 0; i < 16; i++)
+      {
+        const u32 rgba = image.GetPixel(std::min(bx + (i % 4), width - 1), std::min(by + (i / 4), height - 1));
+        for (u32 c = 0; c < 4; c++)
+          pixels[i][c] = static_cast<u8>(rgba >> (c * 8));
+      }
+
+      EncodeBC7Block(pixels, blocks);
+      blocks += BC7_BLOCK_SIZE;
+    }
+  }
+}
+
+void TexturePack::DecodeBC7(const u8* blocks, u32 width, u32 height, Common::RGBA8Image* image)
+{
+  image->SetSize(width, height);
+  for (u32 by = 0; by < height; by += 4)
+  {
+    for (u32 bx = 0; bx < width; bx += 4)
+    {
+      u32 pixels[16];
+      DecodeBC7Block(blocks, pixels);
+      blocks += BC7_BLOCK_SIZE;
+
+      const u32 block_width = std::min(width - bx, 4u);
+      const u32 block_height = std::min(height - by, 4u);
+      for (u32 y = 0; y < block_height; y++)
+      {
+        for (u32 x = 0; x < block_width; x++)
+          image->SetPixel(bx + x, by + y, pixels[y * 4 + x]);
+      }
+    }
+  }
+}
+
+bool TexturePack::WritePack(const char* path, Format format, u32 max_levels, std::vector<SourceTexture> textures)
+{
+  std::sort(textures.begin(), textures.end(), [](const SourceTexture& lhs, const SourceTexture& rhs) {
+    return std::tie(lhs.hash_low, lhs.hash_high) < std::tie(rhs.hash_low, rhs.hash_high);
+  });
+  textures.erase(std::unique(textures.begin(), textures.end(),
+                             [](const SourceTexture& lhs, const SourceTexture& rhs) {
+                               return (lhs.hash_low == rhs.hash_low && lhs.hash_high == rhs.hash_high);
+                             }),
+                 textures.end());
+
+  auto fp = FileSystem::OpenManagedCFile(path, "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", path);
+    return false;
+  }
+
+  // Sizes aren't known until each texture is loaded, so the entry table gets written last.
+  std::vector<Entry> entries;
+  entries.reserve(textures.size());
+  u64 offset = sizeof(Header) + sizeof(Entry) * textures.size();
+  if (FileSystem::FSeek64(fp.get(), static_cast<s64>(offset), SEEK_SET) != 0)
+    return false;
+
+  struct EncodedTexture
+  {
+    u32 width;
+    u32 height;
+    u32 num_levels;
+    std::vector<u8> data;
+  };
+
+  const u32 num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<EncodedTexture> batch;
+  for (size_t batch_start = 0; batch_start < textures.size(); batch_start += WRITE_BATCH_SIZE)
+  {
+    const size_t batch_count = std::min<size_t>(textures.size() - batch_start, WRITE_BATCH_SIZE);
+    batch.clear();
+    batch.resize(batch_count);
+
+    std::atomic<size_t> next_index{0};
+    auto worker = [&]() {
+      for (;;)
+      {
+        const size_t index = next_index.fetch_add(1);
+        if (index >= batch_count)
+          break;
+
+        const SourceTexture& src = textures[batch_start + index];
+        EncodedTexture& dst = batch[index];
+        Common::RGBA8Image image;
+        if (!image.LoadFromFile(src.path.c_str()))
+        {
+          Log_ErrorPrintf("Failed to load '%s', skipping", src.path.c_str());
+          continue;
+        }
+
+        dst.width = image.GetWidth();
+        dst.height = image.GetHeight();
+        dst.num_levels = 0;
+        for (u32 level = 0; level < max_levels; level++)
+        {
+          const size_t pos = dst.data.size();
+          dst.data.resize(pos + GetLevelSize(format, image.GetWidth(), image.GetHeight()));
+          if (format == Format::BC7)
+            EncodeBC7(image, dst.data.data() + pos);
+          else
+            std::memcpy(dst.data.data() + pos, image.GetPixels(), image.GetPitch() * image.GetHeight());
+          dst.num_levels++;
+
+          if (image.GetWidth() == 1 && image.GetHeight() == 1)
+            break;
+
+          Common::RGBA8Image next;
+          next.Resize(&image, std::max(image.GetWidth() / 2, 1u), std::max(image.GetHeight() / 2, 1u));
+          image = std::move(next);
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (u32 i = 1; i < num_threads; i++)
+      threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+      thread.join();
+
+    for (size_t i = 0; i < batch_count; i++)
+    {
+      const EncodedTexture& et = batch[i];
+      if (et.num_levels == 0)
+        continue;
+
+      // Keep level data aligned, decoding reads whole blocks.
+      static constexpr u8 padding[BC7_BLOCK_SIZE] = {};
+      const u64 aligned_offset = (offset + (BC7_BLOCK_SIZE - 1)) & ~static_cast<u64>(BC7_BLOCK_SIZE - 1);
+      if ((aligned_offset != offset && std::fwrite(padding, aligned_offset - offset, 1, fp.get()) != 1) ||
+          std::fwrite(et.data.data(), et.data.size(), 1, fp.get()) != 1)
+      {
+        Log_ErrorPrintf("Failed to write texture data to '%s'", path);
+        return false;
+      }
+
+      const SourceTexture& src = textures[batch_start + i];
+      Entry& entry = entries.emplace_back();
+      entry.hash_low = src.hash_low;
+      entry.hash_high = src.hash_high;
+      entry.format = static_cast<u32>(format);
+      entry.width = et.width;
+      entry.height = et.height;
+      entry.num_levels = et.num_levels;
+      entry.offset = aligned_offset;
+      entry.size = et.data.size();
+      entry.source_width = src.source_width;
+      entry.source_height = src.source_height;
+      offset = aligned_offset + et.data.size();
+    }
+
+    Log_InfoPrintf("Encoded %zu of %zu textures", batch_start + batch_count, textures.size());
+  }
+
+  // Skipped textures leave a gap after the table, which is harmless.
+  Header header = {};
+  header.magic = MAGIC;
+  header.version = VERSION;
+  header.num_entries = static_cast<u32>(entries.size());
+  if (FileSystem::FSeek64(fp.get(), 0, SEEK_SET) != 0 || std::fwrite(&header, sizeof(header), 1, fp.get()) != 1 ||
+      (!entries.empty() && std::fwrite(entries.data(), sizeof(Entry) * entries.size(), 1, fp.get()) != 1))
+  {
+    Log_ErrorPrintf("Failed to write pack header to '%s'", path);
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %zu textures (%s) to '%s'", entries.size(), GetFormatName(format), path);
+  return true;
+}
+
+TexturePack::File::File() = default;
+
+TexturePack::File::~File()
+{
+  Close();
+}
+
+bool TexturePack::File::Open(const char* path)
+{
+  Close();
+
+  size_t size;
+  const u8* data = static_cast<const u8*>(MemMap::MapFileReadOnly(path, &size));
+  if (!data)
+    return false;
+
+  Header header;
+  if (size < sizeof(header))
+  {
+    MemMap::UnmapFile(const_cast<u8*>(data), size);
+    return false;
+  }
+
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != MAGIC || header.version != VERSION ||
+      (size - sizeof(header)) / sizeof(Entry) < header.num_entries)
+  {
+    Log_ErrorPrintf("'%s' is not a valid texture pack", path);
+    MemMap::UnmapFile(const_cast<u8*>(data), size);
+    return false;
+  }
+
+  // Check everything up front, so lookups don't have to.
+  const Entry* entries = reinterpret_cast<const Entry*>(data + sizeof(header));
+  bool has_source_sizes = true;
+  for (u32 i = 0; i < header.num_entries; i++)
+  {
+    const Entry& entry = entries[i];
+    has_source_sizes &= (entry.source_width != 0 && entry.source_height != 0);
+    size_t expected_size = 0;
+    if (entry.format < static_cast<u32>(Format::MaxCount) && entry.num_levels > 0 && entry.num_levels <= MAX_LEVELS)
+    {
+      for (u32 level = 0; level < entry.num_levels; level++)
+      {
+        expected_size += GetLevelSize(static_cast<Format>(entry.format), GetLevelWidth(entry.width, level),
+                                      GetLevelHeight(entry.height, level));
+      }
+    }
+
+    if (expected_size == 0 || entry.size != expected_size || entry.offset > size || (size - entry.offset) < entry.size)
+    {
+      Log_ErrorPrintf("Texture pack '%s' has a corrupted entry %u", path, i);
+      MemMap::UnmapFile(const_cast<u8*>(data), size);
+      return false;
+    }
+  }
+
+  m_data = data;
+  m_size = size;
+  m_entries = entries;
+  m_num_entries = header.num_entries;
+  m_has_source_sizes = has_source_sizes;
+  Log_InfoPrintf("Opened texture pack '%s' with %u textures", path, m_num_entries);
+  return true;
+}
+
+void TexturePack::File::Close()
+{
+  if (!m_data)
+    return;
+
+  MemMap::UnmapFile(const_cast<u8*>(m_data), m_size);
+  m_data = nullptr;
+  m_size = 0;
+  m_entries = nullptr;
+  m_num_entries = 0;
+  m_has_source_sizes = false;
+}
+
+const TexturePack::Entry* TexturePack::File::FindEntry(u64 hash_low, u64 hash_high) const
+{
+  const Entry* end = m_entries + m_num_entries;
+  const Entry* it = std::lower_bound(m_entries, end, std::tie(hash_low, hash_high),
+                                     [](const Entry& entry, const auto& hash) {
+                                       return std::tie(entry.hash_low, entry.hash_high) < hash;
+                                     });
+  return (it != end && it->hash_low == hash_low && it->hash_high == hash_high) ? it : nullptr;
+}
+
+bool TexturePack::File::ReadLevel(const Entry& entry, u32 level, Common::RGBA8Image* image) const
+{
+  if (level >= entry.num_levels)
+    return false;
+
+  const Format format = static_cast<Format>(entry.format);
+  const u8* data = m_data + entry.offset;
+  for (u32 i = 0; i < level; i++)
+    data += GetLevelSize(format, GetLevelWidth(entry.width, i), GetLevelHeight(entry.height, i));
+
+  const u32 width = GetLevelWidth(entry.width, level);
+  const u32 height = GetLevelHeight(entry.height, level);
+  if (format == Format::BC7)
+  {
+    DecodeBC7(data, width, height, image);
+  }
+  else
+  {
+    std::vector<u32> pixels(static_cast<size_t>(width) * height);
+    std::memcpy(pixels.data(), data, pixels.size() * sizeof(u32));
+    image->SetPixels(width, height, std::move(pixels));
+  }
+
+  return true;
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/image.h"
+#include "common/types.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Pre-baked replacement texture pack. Textures are stored with their full mip chain, optionally block compressed,
+/// and indexed by replacement hash so they can be read straight out of a mapping of the file without any decoding of
+/// image containers. Only depends on common, so that the converter tool doesn't need to pull in the rest of core.
+namespace TexturePack {
+
+static constexpr u32 MAGIC = 0x4B415054; // TPAK
+static constexpr u32 VERSION = 2;
+static constexpr u32 MAX_LEVELS = 16;
+
+enum class Format : u32
+{
+  RGBA8,
+  BC7,
+  MaxCount
+};
+
+#pragma pack(push, 4)
+struct Header
+{
+  u32 magic;
+  u32 version;
+  u32 num_entries;
+  u32 reserved;
+};
+
+/// Entries are sorted by hash. Level data is stored consecutively from offset, largest level first.
+/// Source size is the size of the VRAM write being replaced, or zero if it wasn't known when the pack was built.
+struct Entry
+{
+  u64 hash_low;
+  u64 hash_high;
+  u32 format;
+  u32 width;
+  u32 height;
+  u32 num_levels;
+  u64 offset;
+  u64 size;
+  u16 source_width;
+  u16 source_height;
+  u32 reserved;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(Header) == 16 && sizeof(Entry) == 56);
+
+const char* GetFormatName(Format format);
+std::optional<Format> ParseFormatName(const char* name);
+
+u32 GetLevelWidth(u32 width, u32 level);
+u32 GetLevelHeight(u32 height, u32 level);
+size_t GetLevelSize(Format format, u32 width, u32 height);
+
+/// Compresses/decompresses a whole image to BC7. Only mode 6 is used, so other blocks decode as transparent black.
+void EncodeBC7(const Common::RGBA8Image& image, u8* blocks);
+void DecodeBC7(const u8* blocks, u32 width, u32 height, Common::RGBA8Image* image);
+
+struct SourceTexture
+{
+  u64 hash_low;
+  u64 hash_high;
+  u16 source_width;
+  u16 source_height;
+  std::string path;
+};
+
+/// Writes a pack with a full mip chain (up to max_levels) for each texture. Textures are loaded and encoded in
+/// parallel, a batch at a time, so the whole set never has to fit in memory.
+bool WritePack(const char* path, Format format, u32 max_levels, std::vector<SourceTexture> textures);
+
+class File
+{
+public:
+  File();
+  ~File();
+
+  ALWAYS_INLINE bool IsOpen() const { return (m_data != nullptr); }
+  ALWAYS_INLINE u32 GetEntryCount() const { return m_num_entries; }
+  ALWAYS_INLINE const Entry& GetEntry(u32 index) const { return m_entries[index]; }
+
+  /// Returns true if every entry has its source size, so uploads of other sizes can be skipped without hashing.
+  ALWAYS_INLINE bool HasSourceSizes() const { return m_has_source_sizes; }
+
+  bool Open(const char* path);
+  void Close();
+
+  const Entry* FindEntry(u64 hash_low, u64 hash_high) const;
+
+  /// Expands a level of an entry into an RGBA8 image. Safe to call from multiple threads.
+  bool ReadLevel(const Entry& entry, u32 level, Common::RGBA8Image* image) const;
+
+private:
+  const u8* m_data = nullptr;
+  size_t m_size = 0;
+  const Entry* m_entries = nullptr;
+  u32 m_num_entries = 0;
+  bool m_has_source_sizes = false;
+};
+
+} // namespace TexturePack
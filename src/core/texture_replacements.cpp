@@ -4,13 +4,14 @@
 #include "texture_replacements.h"
 #include "host.h"
 #include "settings.h"
+#include "system.h"
 
 #include "common/bitutils.h"
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
-#include "common/timer.h"
+#include "common/threading.h"
 
 #include "fmt/format.h"
 #include "xxhash.h"
@@ -18,10 +19,13 @@
 #include "xxh_x86dispatch.h"
 #endif
 
+#include <algorithm>
 #include <cinttypes>
 
 Log_SetChannel(TextureReplacements);
 
+static constexpr const char* TEXTURE_PACK_FILENAME = "textures.pack";
+
 TextureReplacements g_texture_replacements;
 
 static constexpr u32 VRAMRGBA5551ToRGBA8888(u16 color)
@@ -62,7 +66,10 @@ bool TextureReplacementHash::ParseString(const std::string_view& sv)
 
 TextureReplacements::TextureReplacements() = default;
 
-TextureReplacements::~TextureReplacements() = default;
+TextureReplacements::~TextureReplacements()
+{
+  StopDecodeThreads();
+}
 
 void TextureReplacements::SetGameID(std::string game_id)
 {
@@ -73,13 +80,21 @@ void TextureReplacements::SetGameID(std::string game_id)
   Reload();
 }
 
-const TextureReplacementTexture* TextureReplacements::GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels)
+const TextureReplacementTexture* TextureReplacements::GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels,
+                                                                             u32 scale)
 {
+  // Most uploads have no replacement, so avoid hashing them where possible.
+  if (m_vram_write_replacements.empty() && !m_pack.IsOpen())
+    return nullptr;
+  if (m_vram_write_size_filter && !m_vram_write_sizes.test(GetVRAMWriteSizeIndex(width, height)))
+    return nullptr;
+
   const TextureReplacementHash hash = GetVRAMWriteHash(width, height, pixels);
 
+  // Loose files take priority over the pack, so individual textures can still be tweaked.
   const auto it = m_vram_write_replacements.find(hash);
   if (it == m_vram_write_replacements.end())
-    return nullptr;
+    return m_pack.IsOpen() ? LoadPackTexture(hash, width, height, scale) : nullptr;
 
   return LoadTexture(it->second);
 }
@@ -114,14 +129,23 @@ void TextureReplacements::DumpVRAMWrite(u32 width, u32 height, const void* pixel
   }
 
   Log_InfoPrintf("Dumping %ux%u VRAM write to '%s'", width, height, filename.c_str());
-  if (!image.SaveToFile(filename.c_str()))
-    Log_ErrorPrintf("Failed to dump %ux%u VRAM write to '%s'", width, height, filename.c_str());
+  System::QueueImageWrite(std::move(filename), std::move(image), Common::RGBA8Image::FAST_SAVE_QUALITY);
 }
 
 void TextureReplacements::Shutdown()
 {
-  m_texture_cache.clear();
+  StopDecodeThreads();
+  m_decode_queue.clear();
+  m_preload_queue.clear();
+  m_pending_decodes.clear();
+  m_decoded_textures.clear();
+
+  m_texture_cache.Clear();
+  m_texture_cache_size = 0;
+  m_failed_textures.clear();
   m_vram_write_replacements.clear();
+  m_pack.Close();
+  m_vram_write_size_filter = false;
   m_game_id.clear();
 }
 
@@ -161,29 +185,40 @@ std::string TextureReplacements::GetVRAMWriteDumpFilename(u32 width, u32 height,
 
 void TextureReplacements::Reload()
 {
+  // Threads have to be idle before the pack is unmapped, they get started again on demand.
+  CancelDecodes();
+  StopDecodeThreads();
+  m_texture_cache.Clear();
+  m_texture_cache_size = 0;
+  m_failed_textures.clear();
   m_vram_write_replacements.clear();
+  m_pack.Close();
 
   if (g_settings.texture_replacements.AnyReplacementsEnabled())
-    FindTextures(GetSourceDirectory());
-
-  if (g_settings.texture_replacements.preload_textures)
-    PreloadTextures();
+  {
+    const std::string source_dir = GetSourceDirectory();
+    FindTextures(source_dir);
 
-  PurgeUnreferencedTexturesFromCache();
-}
+    const std::string pack_path = Path::Combine(source_dir, TEXTURE_PACK_FILENAME);
+    if (FileSystem::FileExists(pack_path.c_str()))
+      m_pack.Open(pack_path.c_str());
+  }
 
-void TextureReplacements::PurgeUnreferencedTexturesFromCache()
-{
-  TextureCache old_map = std::move(m_texture_cache);
-  for (const auto& it : m_vram_write_replacements)
+  // Loose files don't record the size of the write they replace, so only packs can be filtered.
+  m_vram_write_sizes.reset();
+  m_vram_write_size_filter = (m_vram_write_replacements.empty() && m_pack.IsOpen() && m_pack.HasSourceSizes());
+  if (m_vram_write_size_filter)
   {
-    auto it2 = old_map.find(it.second);
-    if (it2 != old_map.end())
+    for (u32 i = 0; i < m_pack.GetEntryCount(); i++)
     {
-      m_texture_cache[it.second] = std::move(it2->second);
-      old_map.erase(it2);
+      const TexturePack::Entry& entry = m_pack.GetEntry(i);
+      if (entry.source_width <= VRAM_WIDTH && entry.source_height <= VRAM_HEIGHT)
+        m_vram_write_sizes.set(GetVRAMWriteSizeIndex(entry.source_width, entry.source_height));
     }
   }
+
+  if (g_settings.texture_replacements.preload_textures)
+    PreloadTextures();
 }
 
 bool TextureReplacements::ParseReplacementFilename(const std::string& filename,
@@ -270,45 +305,208 @@ void TextureReplacements::FindTextures(const std::string& dir)
 
 const TextureReplacementTexture* TextureReplacements::LoadTexture(const std::string& filename)
 {
-  auto it = m_texture_cache.find(filename);
-  if (it != m_texture_cache.end())
-    return &it->second;
+  CollectDecodedTextures();
 
-  Common::RGBA8Image image;
-  if (!image.LoadFromFile(filename.c_str()))
-  {
-    Log_ErrorPrintf("Failed to load '%s'", filename.c_str());
+  if (const TextureReplacementTexture* texture = m_texture_cache.Lookup(filename))
+    return texture;
+
+  // Decode in the background, the original texture gets used until it's ready.
+  if (m_failed_textures.find(filename) == m_failed_textures.end())
+    QueueDecode(filename, true);
+
+  return nullptr;
+}
+
+const TextureReplacementTexture* TextureReplacements::LoadPackTexture(const TextureReplacementHash& hash, u32 width,
+                                                                     u32 height, u32 scale)
+{
+  const TexturePack::Entry* entry = m_pack.FindEntry(hash.low, hash.high);
+  if (!entry)
     return nullptr;
+
+  // Use the smallest level which still covers the area being drawn to.
+  const u32 target_width = width * scale;
+  const u32 target_height = height * scale;
+  u32 level = 0;
+  while ((level + 1) < entry->num_levels && TexturePack::GetLevelWidth(entry->width, level + 1) >= target_width &&
+         TexturePack::GetLevelHeight(entry->height, level + 1) >= target_height)
+  {
+    level++;
   }
 
-  Log_InfoPrintf("Loaded '%s': %ux%u", filename.c_str(), image.GetWidth(), image.GetHeight());
-  it = m_texture_cache.emplace(filename, std::move(image)).first;
-  return &it->second;
+  const std::string key = fmt::format("{}@{}", hash.ToString(), level);
+  CollectDecodedTextures();
+
+  if (const TextureReplacementTexture* texture = m_texture_cache.Lookup(key))
+    return texture;
+
+  if (m_failed_textures.find(key) == m_failed_textures.end())
+    QueueDecode(key, true, entry, level);
+
+  return nullptr;
 }
 
-void TextureReplacements::PreloadTextures()
+void TextureReplacements::InsertTexture(std::string filename, TextureReplacementTexture texture)
 {
-  static constexpr float UPDATE_INTERVAL = 1.0f;
-
-  Common::Timer last_update_time;
-  u32 num_textures_loaded = 0;
-  const u32 total_textures = static_cast<u32>(m_vram_write_replacements.size());
-
-#define UPDATE_PROGRESS()                                                                                              \
-  if (last_update_time.GetTimeSeconds() >= UPDATE_INTERVAL)                                                            \
-  {                                                                                                                    \
-    Host::DisplayLoadingScreen("Preloading replacement textures...", 0, static_cast<int>(total_textures),              \
-                               static_cast<int>(num_textures_loaded));                                                 \
-    last_update_time.Reset();                                                                                          \
+  const size_t budget = static_cast<size_t>(g_settings.texture_replacements.cache_size_mb) * 1048576;
+  m_texture_cache_size += texture.GetPitch() * texture.GetHeight();
+  m_texture_cache.Insert(std::move(filename), std::move(texture));
+
+  // Always keep the texture which was just inserted, even if it's bigger than the whole budget.
+  while (m_texture_cache_size > budget && m_texture_cache.GetSize() > 1)
+  {
+    m_texture_cache.EvictOldest([this](const std::string& evicted_filename, const TextureReplacementTexture& evicted) {
+      Log_DevPrintf("Evicting '%s' from replacement cache", evicted_filename.c_str());
+      m_texture_cache_size -= evicted.GetPitch() * evicted.GetHeight();
+    });
   }
+}
 
+void TextureReplacements::PreloadTextures()
+{
+  // Everything is queued behind textures which are actually needed, so this doesn't hold up starting the game.
   for (const auto& it : m_vram_write_replacements)
+    QueueDecode(it.second, false);
+
+  Log_InfoPrintf("Queued %zu replacement textures for preloading", m_vram_write_replacements.size());
+}
+
+void TextureReplacements::QueueDecode(const std::string& filename, bool high_priority,
+                                      const TexturePack::Entry* pack_entry, u32 pack_level)
+{
+  std::unique_lock lock(m_decode_mutex);
+  auto iter = m_pending_decodes.find(filename);
+  if (iter != m_pending_decodes.end())
+  {
+    // Already decoding, or waiting for the CPU thread to pick it up.
+    if (iter->second || !high_priority)
+      return;
+
+    // Waiting behind the preload queue, jump ahead. The stale preload request is skipped by the decode thread.
+  }
+  else
+  {
+    m_pending_decodes.emplace(filename, false);
+  }
+
+  (high_priority ? m_decode_queue : m_preload_queue)
+    .push_back(DecodeRequest{filename, pack_entry, pack_level, m_decode_generation});
+  lock.unlock();
+
+  StartDecodeThreads();
+  m_decode_cv.notify_one();
+}
+
+void TextureReplacements::CancelDecodes()
+{
+  std::unique_lock lock(m_decode_mutex);
+  m_decode_generation++;
+  m_decode_queue.clear();
+  m_preload_queue.clear();
+  m_pending_decodes.clear();
+  m_decoded_textures.clear();
+}
+
+void TextureReplacements::CollectDecodedTextures()
+{
+  std::vector<DecodeResult> results;
   {
-    UPDATE_PROGRESS();
+    std::unique_lock lock(m_decode_mutex);
+    if (m_decoded_textures.empty())
+      return;
+
+    results.swap(m_decoded_textures);
+    for (const DecodeResult& result : results)
+    {
+      if (result.generation == m_decode_generation)
+        m_pending_decodes.erase(result.filename);
+    }
+  }
+
+  for (DecodeResult& result : results)
+  {
+    if (result.generation != m_decode_generation)
+      continue;
+
+    if (result.success)
+      InsertTexture(std::move(result.filename), std::move(result.texture));
+    else
+      m_failed_textures.insert(std::move(result.filename));
+  }
+}
+
+void TextureReplacements::StartDecodeThreads()
+{
+  if (!m_decode_threads.empty())
+    return;
+
+  // Leave some cores for the CPU and GPU threads.
+  const u32 num_threads = std::clamp<u32>(std::thread::hardware_concurrency() / 2, 1, 4);
+  Log_DevPrintf("Starting %u replacement texture decode threads", num_threads);
+
+  m_decode_shutdown = false;
+  for (u32 i = 0; i < num_threads; i++)
+    m_decode_threads.emplace_back(&TextureReplacements::DecodeThreadEntryPoint, this);
+}
+
+void TextureReplacements::StopDecodeThreads()
+{
+  if (m_decode_threads.empty())
+    return;
 
-    LoadTexture(it.second);
-    num_textures_loaded++;
+  {
+    std::unique_lock lock(m_decode_mutex);
+    m_decode_shutdown = true;
   }
+  m_decode_cv.notify_all();
+
+  for (std::thread& thread : m_decode_threads)
+    thread.join();
+  m_decode_threads.clear();
+}
+
+void TextureReplacements::DecodeThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Texture Decode");
+
+  std::unique_lock lock(m_decode_mutex);
+  for (;;)
+  {
+    m_decode_cv.wait(lock,
+                     [this]() { return m_decode_shutdown || !m_decode_queue.empty() || !m_preload_queue.empty(); });
+    if (m_decode_shutdown)
+      break;
 
-#undef UPDATE_PROGRESS
+    std::deque<DecodeRequest>& queue = m_decode_queue.empty() ? m_preload_queue : m_decode_queue;
+    DecodeRequest request = std::move(queue.front());
+    queue.pop_front();
+
+    // Skip requests which were cancelled, or already picked up through the other queue.
+    auto iter = m_pending_decodes.find(request.filename);
+    if (request.generation != m_decode_generation || iter == m_pending_decodes.end() || iter->second)
+      continue;
+
+    iter->second = true;
+    lock.unlock();
+
+    DecodeResult result;
+    result.success = request.pack_entry ?
+                       m_pack.ReadLevel(*request.pack_entry, request.pack_level, &result.texture) :
+                       result.texture.LoadFromFile(request.filename.c_str());
+    if (result.success)
+    {
+      Log_DevPrintf("Decoded '%s': %ux%u", request.filename.c_str(), result.texture.GetWidth(),
+                    result.texture.GetHeight());
+    }
+    else
+    {
+      Log_ErrorPrintf("Failed to load '%s'", request.filename.c_str());
+    }
+
+    result.filename = std::move(request.filename);
+    result.generation = request.generation;
+
+    lock.lock();
+    m_decoded_textures.push_back(std::move(result));
+  }
 }
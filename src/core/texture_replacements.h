@@ -4,10 +4,20 @@
 #pragma once
 #include "common/hash_combine.h"
 #include "common/image.h"
+#include "common/lru_cache.h"
+#include "gpu_types.h"
+#include "texture_pack.h"
 #include "types.h"
+#include <bitset>
+#include <condition_variable>
+#include <limits>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 struct TextureReplacementHash
@@ -54,7 +64,9 @@ public:
 
   void Reload();
 
-  const TextureReplacementTexture* GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels);
+  /// Returns null if there's no replacement, or it hasn't finished decoding yet. Scale is what the texture will be
+  /// drawn at, and picks the mip level to use from texture packs.
+  const TextureReplacementTexture* GetVRAMWriteReplacement(u32 width, u32 height, const void* pixels, u32 scale);
   void DumpVRAMWrite(u32 width, u32 height, const void* pixels);
 
   void Shutdown();
@@ -66,7 +78,24 @@ private:
   };
 
   using VRAMWriteReplacementMap = std::unordered_map<TextureReplacementHash, std::string>;
-  using TextureCache = std::unordered_map<std::string, TextureReplacementTexture>;
+  using TextureCache = LRUCache<std::string, TextureReplacementTexture>;
+
+  /// Filename is the cache key. For texture pack entries, it's the hash and level instead of a path.
+  struct DecodeRequest
+  {
+    std::string filename;
+    const TexturePack::Entry* pack_entry;
+    u32 pack_level;
+    u32 generation;
+  };
+
+  struct DecodeResult
+  {
+    std::string filename;
+    TextureReplacementTexture texture;
+    u32 generation;
+    bool success;
+  };
 
   static bool ParseReplacementFilename(const std::string& filename, TextureReplacementHash* replacement_hash,
                                        ReplacmentType* replacement_type);
@@ -74,20 +103,50 @@ private:
   std::string GetSourceDirectory() const;
   std::string GetDumpDirectory() const;
 
+  static u32 GetVRAMWriteSizeIndex(u32 width, u32 height) { return (height - 1) * VRAM_WIDTH + (width - 1); }
   TextureReplacementHash GetVRAMWriteHash(u32 width, u32 height, const void* pixels) const;
   std::string GetVRAMWriteDumpFilename(u32 width, u32 height, const void* pixels) const;
 
   void FindTextures(const std::string& dir);
 
   const TextureReplacementTexture* LoadTexture(const std::string& filename);
+  const TextureReplacementTexture* LoadPackTexture(const TextureReplacementHash& hash, u32 width, u32 height,
+                                                   u32 scale);
   void PreloadTextures();
-  void PurgeUnreferencedTexturesFromCache();
+  void InsertTexture(std::string filename, TextureReplacementTexture texture);
+
+  void QueueDecode(const std::string& filename, bool high_priority, const TexturePack::Entry* pack_entry = nullptr,
+                   u32 pack_level = 0);
+  void CancelDecodes();
+  void CollectDecodedTextures();
+  void StartDecodeThreads();
+  void StopDecodeThreads();
+  void DecodeThreadEntryPoint();
 
   std::string m_game_id;
 
-  TextureCache m_texture_cache;
+  // Only touched on the CPU thread. Size is tracked in bytes against the configured budget.
+  TextureCache m_texture_cache{std::numeric_limits<std::size_t>::max(), true};
+  size_t m_texture_cache_size = 0;
+  std::unordered_set<std::string> m_failed_textures;
 
   VRAMWriteReplacementMap m_vram_write_replacements;
+  TexturePack::File m_pack;
+
+  // Sizes of VRAM writes which have a replacement. Only known when everything comes from a pack with source sizes.
+  std::bitset<VRAM_WIDTH * VRAM_HEIGHT> m_vram_write_sizes;
+  bool m_vram_write_size_filter = false;
+
+  // Textures the CPU thread is waiting on are decoded before anything queued by preloading.
+  std::vector<std::thread> m_decode_threads;
+  std::mutex m_decode_mutex;
+  std::condition_variable m_decode_cv;
+  std::deque<DecodeRequest> m_decode_queue;
+  std::deque<DecodeRequest> m_preload_queue;
+  std::unordered_map<std::string, bool> m_pending_decodes; // filename -> started
+  std::vector<DecodeResult> m_decoded_textures;
+  u32 m_decode_generation = 0;
+  bool m_decode_shutdown = false;
 };
 
 extern TextureReplacements g_texture_replacements;
\ No newline at end of file
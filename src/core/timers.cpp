@@ -60,6 +60,7 @@ struct CounterState
   bool irq_done;
 };
 
+static bool IsIRQArmed(const CounterState& cs);
 static void UpdateCountingEnabled(CounterState& cs);
 static void CheckForIRQ(u32 index, u32 old_counter);
 static void UpdateIRQ(u32 index);
@@ -148,7 +149,7 @@ bool Timers::IsSyncEnabled(u32 timer)
 bool Timers::IsExternalIRQEnabled(u32 timer)
 {
   const CounterState& cs = s_states[timer];
-  return (cs.external_counting_enabled && (cs.mode.bits & ((1u << 4) | (1u << 5))) != 0);
+  return (cs.external_counting_enabled && IsIRQArmed(cs));
 }
 
 void Timers::SetGate(u32 timer, bool state)
@@ -190,12 +191,14 @@ void Timers::SetGate(u32 timer, bool state)
 TickCount Timers::GetTicksUntilIRQ(u32 timer)
 {
   const CounterState& cs = s_states[timer];
-  if (!cs.counting_enabled)
+  if (!cs.counting_enabled || !IsIRQArmed(cs))
     return std::numeric_limits<TickCount>::max();
 
   TickCount ticks_until_irq = std::numeric_limits<TickCount>::max();
   if (cs.mode.irq_at_target && cs.counter < cs.target)
     ticks_until_irq = static_cast<TickCount>(cs.target - cs.counter);
+  else if (cs.mode.irq_at_target && cs.counter > cs.target)
+    ticks_until_irq = static_cast<TickCount>((0xFFFFu - cs.counter) + cs.target);
   if (cs.mode.irq_on_overflow)
     ticks_until_irq = std::min(ticks_until_irq, static_cast<TickCount>(0xFFFFu - cs.counter));
 
@@ -334,8 +337,9 @@ void Timers::WriteRegister(u32 offset, u32 value)
   }
 
   CounterState& cs = s_states[timer_index];
+  const bool was_external = cs.external_counting_enabled;
 
-  if (timer_index < 2 && cs.external_counting_enabled)
+  if (timer_index < 2 && was_external)
   {
     // timers 0/1 depend on the GPU
     if (timer_index == 0 || g_gpu->IsCRTCScanlinePending())
@@ -389,6 +393,18 @@ void Timers::WriteRegister(u32 offset, u32 value)
       Log_ErrorPrintf("Write unknown register in timer %u (offset 0x%02X, value 0x%X)", timer_index, offset, value);
       break;
   }
+
+  // The CRTC event only runs when one of these timers can raise an IRQ, so it has to know about the new one.
+  if (timer_index < 2 && (was_external || cs.external_counting_enabled))
+    g_gpu->UpdateCRTCTimerIRQ();
+}
+
+bool Timers::IsIRQArmed(const CounterState& cs)
+{
+  // One-shot IRQs can't be raised again until the mode is written. In toggle mode the request bit still changes on
+  // every hit though, and that can be read back.
+  return ((cs.mode.irq_at_target || cs.mode.irq_on_overflow) &&
+          (cs.mode.irq_repeat || !cs.irq_done || cs.mode.irq_pulse_n));
 }
 
 void Timers::UpdateCountingEnabled(CounterState& cs)
@@ -437,11 +453,8 @@ TickCount Timers::GetTicksUntilNextInterrupt()
   for (u32 i = 0; i < NUM_TIMERS; i++)
   {
     const CounterState& cs = s_states[i];
-    if (!cs.counting_enabled || (i < 2 && cs.external_counting_enabled) ||
-        (!cs.mode.irq_at_target && !cs.mode.irq_on_overflow && (cs.mode.irq_repeat || !cs.irq_done)))
-    {
+    if (!cs.counting_enabled || (i < 2 && cs.external_counting_enabled) || !IsIRQArmed(cs))
       continue;
-    }
 
     if (cs.mode.irq_at_target)
     {
@@ -4,19 +4,34 @@
 #include "timing_event.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/trace_recorder.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
+#include "cpu_profiler.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
 Log_SetChannel(TimingEvents);
 
 namespace TimingEvents {
 
-static TimingEvent* s_active_events_head;
-static TimingEvent* s_active_events_tail;
+static bool IsEventBefore(const TimingEvent* lhs, const TimingEvent* rhs);
+static void SiftEventUp(TimingEvent* event);
+static void SiftEventDown(TimingEvent* event);
+static void SortEvent(TimingEvent* event);
+static void AddActiveEvent(TimingEvent* event);
+static void RemoveActiveEvent(TimingEvent* event);
+static void SortEvents();
+static TimingEvent* FindActiveEvent(const char* name);
+
+// Binary min-heap of active events, with the next due event at the front.
+static std::vector<TimingEvent*> s_active_events;
 static TimingEvent* s_current_event = nullptr;
-static u32 s_active_event_count = 0;
 static u32 s_global_tick_counter = 0;
+static u32 s_event_order_counter = 0;
 static bool s_frame_done = false;
 
 u32 GetGlobalTickCounter()
@@ -36,14 +51,13 @@ void Reset()
 
 void Shutdown()
 {
-  Assert(s_active_event_count == 0);
+  Assert(s_active_events.empty());
 }
 
-std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
+std::unique_ptr<TimingEvent> CreateTimingEvent(const char* name, TickCount period, TickCount interval,
                                                TimingEventCallback callback, void* callback_param, bool activate)
 {
-  std::unique_ptr<TimingEvent> event =
-    std::make_unique<TimingEvent>(std::move(name), period, interval, callback, callback_param);
+  std::unique_ptr<TimingEvent> event = std::make_unique<TimingEvent>(name, period, interval, callback, callback_param);
   if (activate)
     event->Activate();
 
@@ -52,217 +66,125 @@ std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount perio
 
 void UpdateCPUDowncount()
 {
-  const u32 event_downcount = s_active_events_head->GetDowncount();
+  const u32 event_downcount = s_active_events.front()->GetDowncount();
   CPU::g_state.downcount = CPU::HasPendingInterrupt() ? 0 : event_downcount;
 }
 
-TimingEvent** GetHeadEventPtr()
+bool IsEventBefore(const TimingEvent* lhs, const TimingEvent* rhs)
 {
-  return &s_active_events_head;
+  // Events due at the same time run in the order they were scheduled.
+  const s32 diff = static_cast<s32>(lhs->m_next_run_time - rhs->m_next_run_time);
+  return (diff < 0 || (diff == 0 && static_cast<s32>(lhs->m_order - rhs->m_order) < 0));
 }
 
-static void SortEvent(TimingEvent* event)
+void SiftEventUp(TimingEvent* event)
 {
-  const TickCount event_downcount = event->m_downcount;
-
-  if (event->prev && event->prev->m_downcount > event_downcount)
+  u32 index = event->m_heap_index;
+  while (index > 0)
   {
-    // move backwards
-    TimingEvent* current = event->prev;
-    while (current && current->m_downcount > event_downcount)
-      current = current->prev;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert after current
-    if (current)
-    {
-      event->next = current->next;
-      if (current->next)
-        current->next->prev = event;
-      else
-        s_active_events_tail = event;
-
-      event->prev = current;
-      current->next = event;
-    }
-    else
-    {
-      // insert at front
-      DebugAssert(s_active_events_head);
-      s_active_events_head->prev = event;
-      event->prev = nullptr;
-      event->next = s_active_events_head;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
+    const u32 parent_index = (index - 1) / 2;
+    TimingEvent* parent = s_active_events[parent_index];
+    if (!IsEventBefore(event, parent))
+      break;
+
+    s_active_events[index] = parent;
+    parent->m_heap_index = index;
+    index = parent_index;
   }
-  else if (event->next && event_downcount > event->next->m_downcount)
-  {
-    // move forwards
-    TimingEvent* current = event->next;
-    while (current && event_downcount > current->m_downcount)
-      current = current->next;
 
-    // unlink
-    if (event->prev)
-    {
-      event->prev->next = event->next;
-    }
-    else
-    {
-      s_active_events_head = event->next;
-      UpdateCPUDowncount();
-    }
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert before current
-    if (current)
-    {
-      event->next = current;
-      event->prev = current->prev;
-
-      if (current->prev)
-      {
-        current->prev->next = event;
-      }
-      else
-      {
-        s_active_events_head = event;
-        UpdateCPUDowncount();
-      }
-
-      current->prev = event;
-    }
-    else
-    {
-      // insert at back
-      DebugAssert(s_active_events_tail);
-      s_active_events_tail->next = event;
-      event->next = nullptr;
-      event->prev = s_active_events_tail;
-      s_active_events_tail = event;
-    }
-  }
+  s_active_events[index] = event;
+  event->m_heap_index = index;
 }
 
-static void AddActiveEvent(TimingEvent* event)
+void SiftEventDown(TimingEvent* event)
 {
-  DebugAssert(!event->prev && !event->next);
-  s_active_event_count++;
-
-  TimingEvent* current = nullptr;
-  TimingEvent* next = s_active_events_head;
-  while (next && event->m_downcount > next->m_downcount)
+  const u32 count = static_cast<u32>(s_active_events.size());
+  u32 index = event->m_heap_index;
+  for (;;)
   {
-    current = next;
-    next = next->next;
+    u32 child_index = (index * 2) + 1;
+    if (child_index >= count)
+      break;
+    if ((child_index + 1) < count && IsEventBefore(s_active_events[child_index + 1], s_active_events[child_index]))
+      child_index++;
+
+    TimingEvent* child = s_active_events[child_index];
+    if (!IsEventBefore(child, event))
+      break;
+
+    s_active_events[index] = child;
+    child->m_heap_index = index;
+    index = child_index;
   }
 
-  if (!next)
-  {
-    // new tail
-    event->prev = s_active_events_tail;
-    if (s_active_events_tail)
-    {
-      s_active_events_tail->next = event;
-      s_active_events_tail = event;
-    }
-    else
-    {
-      // first event
-      s_active_events_tail = event;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (!current)
-  {
-    // new head
-    event->next = s_active_events_head;
-    s_active_events_head->prev = event;
-    s_active_events_head = event;
-    UpdateCPUDowncount();
-  }
-  else
-  {
-    // inbetween current < event > next
-    event->prev = current;
-    event->next = next;
-    current->next = event;
-    next->prev = event;
-  }
+  s_active_events[index] = event;
+  event->m_heap_index = index;
 }
 
-static void RemoveActiveEvent(TimingEvent* event)
+void SortEvent(TimingEvent* event)
 {
-  DebugAssert(s_active_event_count > 0);
+  const bool was_head = (event->m_heap_index == 0);
+  event->m_order = s_event_order_counter++;
 
-  if (event->next)
-  {
-    event->next->prev = event->prev;
-  }
+  if (event->m_heap_index > 0 && IsEventBefore(event, s_active_events[(event->m_heap_index - 1) / 2]))
+    SiftEventUp(event);
   else
-  {
-    s_active_events_tail = event->prev;
-  }
+    SiftEventDown(event);
 
-  if (event->prev)
-  {
-    event->prev->next = event->next;
-  }
-  else
-  {
-    s_active_events_head = event->next;
-    if (s_active_events_head)
-      UpdateCPUDowncount();
-  }
+  if (was_head || event->m_heap_index == 0)
+    UpdateCPUDowncount();
+}
 
-  event->prev = nullptr;
-  event->next = nullptr;
+void AddActiveEvent(TimingEvent* event)
+{
+  event->m_order = s_event_order_counter++;
+  event->m_heap_index = static_cast<u32>(s_active_events.size());
+  s_active_events.push_back(event);
+  SiftEventUp(event);
 
-  s_active_event_count--;
+  if (event->m_heap_index == 0)
+    UpdateCPUDowncount();
 }
 
-static void SortEvents()
+void RemoveActiveEvent(TimingEvent* event)
 {
-  std::vector<TimingEvent*> events;
-  events.reserve(s_active_event_count);
+  DebugAssert(!s_active_events.empty() && s_active_events[event->m_heap_index] == event);
 
-  TimingEvent* next = s_active_events_head;
-  while (next)
+  // move the last event into the hole, and let it find its place
+  const u32 index = event->m_heap_index;
+  TimingEvent* last = s_active_events.back();
+  s_active_events.pop_back();
+  if (last != event)
   {
-    TimingEvent* current = next;
-    events.push_back(current);
-    next = current->next;
-    current->prev = nullptr;
-    current->next = nullptr;
+    last->m_heap_index = index;
+    s_active_events[index] = last;
+    if (index > 0 && IsEventBefore(last, s_active_events[(index - 1) / 2]))
+      SiftEventUp(last);
+    else
+      SiftEventDown(last);
   }
 
-  s_active_events_head = nullptr;
-  s_active_events_tail = nullptr;
-  s_active_event_count = 0;
+  if (index == 0 && !s_active_events.empty())
+    UpdateCPUDowncount();
+}
+
+void SortEvents()
+{
+  const u32 count = static_cast<u32>(s_active_events.size());
+  for (u32 i = 0; i < count; i++)
+    s_active_events[i]->m_heap_index = i;
+  for (u32 i = count / 2; i > 0; i--)
+    SiftEventDown(s_active_events[i - 1]);
 
-  for (TimingEvent* event : events)
-    AddActiveEvent(event);
+  if (count > 0)
+    UpdateCPUDowncount();
 }
 
-static TimingEvent* FindActiveEvent(const char* name)
+TimingEvent* FindActiveEvent(const char* name)
 {
-  for (TimingEvent* event = s_active_events_head; event; event = event->next)
+  for (TimingEvent* event : s_active_events)
   {
-    if (event->GetName().compare(name) == 0)
+    if (std::strcmp(event->GetName(), name) == 0)
       return event;
   }
 
@@ -282,44 +204,40 @@ void SetFrameDone()
 
 void RunEvents()
 {
+  TRACE_SCOPE("TimingEvents::RunEvents");
   DebugAssert(!s_current_event);
 
+  CPU::Profiler::Update();
+
   do
   {
     if (CPU::HasPendingInterrupt())
       CPU::DispatchInterrupt();
 
     TickCount pending_ticks = CPU::GetPendingTicks();
-    if (pending_ticks >= s_active_events_head->GetDowncount())
+    if (pending_ticks >= s_active_events.front()->GetDowncount())
     {
       CPU::ResetPendingTicks();
 
       do
       {
-        const TickCount time = std::min(pending_ticks, s_active_events_head->GetDowncount());
+        // Event timestamps are absolute, so only the global counter needs to move forward.
+        // Late events will end up with a negative downcount.
+        const TickCount time = std::min(pending_ticks, s_active_events.front()->GetDowncount());
         s_global_tick_counter += static_cast<u32>(time);
         pending_ticks -= time;
 
-        // Apply downcount to all events.
-        // This will result in a negative downcount for those events which are late.
-        for (TimingEvent* event = s_active_events_head; event; event = event->next)
-        {
-          event->m_downcount -= time;
-          event->m_time_since_last_run += time;
-        }
-
         // Now we can actually run the callbacks.
-        while (s_active_events_head->m_downcount <= 0)
+        while (s_active_events.front()->GetDowncount() <= 0)
         {
-          // move it to the end, since that'll likely be its new position
-          TimingEvent* event = s_active_events_head;
+          TimingEvent* event = s_active_events.front();
           s_current_event = event;
 
           // Factor late time into the time for the next invocation.
-          const TickCount ticks_late = -event->m_downcount;
-          const TickCount ticks_to_execute = event->m_time_since_last_run;
-          event->m_downcount += event->m_interval;
-          event->m_time_since_last_run = 0;
+          const TickCount ticks_late = -event->GetDowncount();
+          const TickCount ticks_to_execute = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
+          event->m_next_run_time += static_cast<u32>(event->m_interval);
+          event->m_last_run_time = s_global_tick_counter;
 
           // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
           event->m_callback(event->m_callback_param, ticks_to_execute, ticks_late);
@@ -372,8 +290,8 @@ bool DoState(StateWrapper& sw)
       }
 
       // Using reschedule is safe here since we call sort afterwards.
-      event->m_downcount = downcount;
-      event->m_time_since_last_run = time_since_last_run;
+      event->m_next_run_time = s_global_tick_counter + static_cast<u32>(downcount);
+      event->m_last_run_time = s_global_tick_counter - static_cast<u32>(time_since_last_run);
       event->m_period = period;
       event->m_interval = interval;
     }
@@ -389,19 +307,22 @@ bool DoState(StateWrapper& sw)
   }
   else
   {
+    u32 event_count = static_cast<u32>(s_active_events.size());
+    sw.Do(&event_count);
 
-    sw.Do(&s_active_event_count);
-
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
+    for (TimingEvent* event : s_active_events)
     {
-      sw.Do(&event->m_name);
-      sw.Do(&event->m_downcount);
-      sw.Do(&event->m_time_since_last_run);
+      std::string event_name = event->GetName();
+      TickCount downcount = event->GetDowncount();
+      TickCount time_since_last_run = static_cast<TickCount>(s_global_tick_counter - event->m_last_run_time);
+      sw.Do(&event_name);
+      sw.Do(&downcount);
+      sw.Do(&time_since_last_run);
       sw.Do(&event->m_period);
       sw.Do(&event->m_interval);
     }
 
-    Log_DebugPrintf("Wrote %u events to save state.", s_active_event_count);
+    Log_DebugPrintf("Wrote %u events to save state.", event_count);
   }
 
   return !sw.HasError();
@@ -409,10 +330,10 @@ bool DoState(StateWrapper& sw)
 
 } // namespace TimingEvents
 
-TimingEvent::TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback,
+TimingEvent::TimingEvent(const char* name, TickCount period, TickCount interval, TimingEventCallback callback,
                          void* callback_param)
   : m_callback(callback), m_callback_param(callback_param), m_downcount(interval), m_time_since_last_run(0),
-    m_period(period), m_interval(interval), m_name(std::move(name))
+    m_period(period), m_interval(interval), m_name(name)
 {
 }
 
@@ -422,14 +343,21 @@ TimingEvent::~TimingEvent()
     TimingEvents::RemoveActiveEvent(this);
 }
 
+TickCount TimingEvent::GetDowncount() const
+{
+  return m_active ? static_cast<TickCount>(m_next_run_time - TimingEvents::s_global_tick_counter) : m_downcount;
+}
+
 TickCount TimingEvent::GetTicksSinceLastExecution() const
 {
-  return CPU::GetPendingTicks() + m_time_since_last_run;
+  const TickCount time_since_last_run =
+    m_active ? static_cast<TickCount>(TimingEvents::s_global_tick_counter - m_last_run_time) : m_time_since_last_run;
+  return CPU::GetPendingTicks() + time_since_last_run;
 }
 
 TickCount TimingEvent::GetTicksUntilNextExecution() const
 {
-  return std::max(m_downcount - CPU::GetPendingTicks(), static_cast<TickCount>(0));
+  return std::max(GetDowncount() - CPU::GetPendingTicks(), static_cast<TickCount>(0));
 }
 
 void TimingEvent::Delay(TickCount ticks)
@@ -440,23 +368,21 @@ void TimingEvent::Delay(TickCount ticks)
     return;
   }
 
-  m_downcount += ticks;
+  m_next_run_time += static_cast<u32>(ticks);
 
   DebugAssert(TimingEvents::s_current_event != this);
   TimingEvents::SortEvent(this);
-  if (TimingEvents::s_active_events_head == this)
-    TimingEvents::UpdateCPUDowncount();
 }
 
 void TimingEvent::Schedule(TickCount ticks)
 {
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount = pending_ticks + ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<u32>(ticks);
 
   if (!m_active)
   {
     // Event is going active, so we want it to only execute ticks from the current timestamp.
-    m_time_since_last_run = -pending_ticks;
+    m_last_run_time = current_time;
     m_active = true;
     TimingEvents::AddActiveEvent(this);
   }
@@ -465,11 +391,7 @@ void TimingEvent::Schedule(TickCount ticks)
     // Event is already active, so we leave the time since last run alone, and just modify the downcount.
     // If this is a call from an IO handler for example, re-sort the event queue.
     if (TimingEvents::s_current_event != this)
-    {
       TimingEvents::SortEvent(this);
-      if (TimingEvents::s_active_events_head == this)
-        TimingEvents::UpdateCPUDowncount();
-    }
   }
 }
 
@@ -491,14 +413,10 @@ void TimingEvent::Reset()
   if (!m_active)
     return;
 
-  m_downcount = m_interval;
-  m_time_since_last_run = 0;
+  m_next_run_time = TimingEvents::s_global_tick_counter + static_cast<u32>(m_interval);
+  m_last_run_time = TimingEvents::s_global_tick_counter;
   if (TimingEvents::s_current_event != this)
-  {
     TimingEvents::SortEvent(this);
-    if (TimingEvents::s_active_events_head == this)
-      TimingEvents::UpdateCPUDowncount();
-  }
 }
 
 void TimingEvent::InvokeEarly(bool force /* = false */)
@@ -507,19 +425,18 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
     return;
 
   const TickCount pending_ticks = CPU::GetPendingTicks();
-  const TickCount ticks_to_execute = m_time_since_last_run + pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(pending_ticks);
+  const TickCount ticks_to_execute = static_cast<TickCount>(current_time - m_last_run_time);
   if ((!force && ticks_to_execute < m_period) || ticks_to_execute <= 0)
     return;
 
-  m_downcount = pending_ticks + m_interval;
-  m_time_since_last_run -= ticks_to_execute;
+  m_next_run_time = current_time + static_cast<u32>(m_interval);
+  m_last_run_time = current_time;
   m_callback(m_callback_param, ticks_to_execute, 0);
 
   // Since we've changed the downcount, we need to re-sort the events.
   DebugAssert(TimingEvents::s_current_event != this);
   TimingEvents::SortEvent(this);
-  if (TimingEvents::s_active_events_head == this)
-    TimingEvents::UpdateCPUDowncount();
 }
 
 void TimingEvent::Activate()
@@ -528,9 +445,9 @@ void TimingEvent::Activate()
     return;
 
   // leave the downcount intact
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount += pending_ticks;
-  m_time_since_last_run -= pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_next_run_time = current_time + static_cast<u32>(m_downcount);
+  m_last_run_time = current_time - static_cast<u32>(m_time_since_last_run);
 
   m_active = true;
   TimingEvents::AddActiveEvent(this);
@@ -541,9 +458,9 @@ void TimingEvent::Deactivate()
   if (!m_active)
     return;
 
-  const TickCount pending_ticks = CPU::GetPendingTicks();
-  m_downcount -= pending_ticks;
-  m_time_since_last_run += pending_ticks;
+  const u32 current_time = TimingEvents::s_global_tick_counter + static_cast<u32>(CPU::GetPendingTicks());
+  m_downcount = static_cast<TickCount>(m_next_run_time - current_time);
+  m_time_since_last_run = static_cast<TickCount>(current_time - m_last_run_time);
 
   m_active = false;
   TimingEvents::RemoveActiveEvent(this);
@@ -2,10 +2,7 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #pragma once
-#include <functional>
 #include <memory>
-#include <string>
-#include <vector>
 
 #include "types.h"
 
@@ -17,17 +14,19 @@ using TimingEventCallback = void (*)(void* param, TickCount ticks, TickCount tic
 class TimingEvent
 {
 public:
-  TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback,
+  TimingEvent(const char* name, TickCount period, TickCount interval, TimingEventCallback callback,
               void* callback_param);
   ~TimingEvent();
 
-  ALWAYS_INLINE const std::string& GetName() const { return m_name; }
+  ALWAYS_INLINE const char* GetName() const { return m_name; }
   ALWAYS_INLINE bool IsActive() const { return m_active; }
 
   // Returns the number of ticks between each event.
   ALWAYS_INLINE TickCount GetPeriod() const { return m_period; }
   ALWAYS_INLINE TickCount GetInterval() const { return m_interval; }
-  ALWAYS_INLINE TickCount GetDowncount() const { return m_downcount; }
+
+  // Ticks from the global tick counter until the event is due, excluding pending time.
+  TickCount GetDowncount() const;
 
   // Includes pending time.
   TickCount GetTicksSinceLastExecution() const;
@@ -63,8 +62,13 @@ public:
   void SetInterval(TickCount interval) { m_interval = interval; }
   void SetPeriod(TickCount period) { m_period = period; }
 
-  TimingEvent* prev = nullptr;
-  TimingEvent* next = nullptr;
+  // While active, the event is kept in a heap ordered by m_next_run_time. Both times are values of the global tick
+  // counter, so advancing time doesn't need to touch every event. Inactive events instead keep their downcount and
+  // time since last run relative, since they don't move with the counter.
+  u32 m_next_run_time = 0;
+  u32 m_last_run_time = 0;
+  u32 m_heap_index = 0;
+  u32 m_order = 0;
 
   TimingEventCallback m_callback;
   void* m_callback_param;
@@ -75,7 +79,7 @@ public:
   TickCount m_interval;
   bool m_active = false;
 
-  std::string m_name;
+  const char* m_name;
 };
 
 namespace TimingEvents {
@@ -87,7 +91,7 @@ void Reset();
 void Shutdown();
 
 /// Creates a new event.
-std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
+std::unique_ptr<TimingEvent> CreateTimingEvent(const char* name, TickCount period, TickCount interval,
                                                TimingEventCallback callback, void* callback_param, bool activate);
 
 /// Serialization.
@@ -99,6 +103,4 @@ void RunEvents();
 
 void UpdateCPUDowncount();
 
-TimingEvent** GetHeadEventPtr();
-
 } // namespace TimingEvents
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "core/achievements.h"
 #include "core/controller.h"
 #include "core/fullscreen_ui.h"
+#include "core/game_database.h"
 #include "core/game_list.h"
 #include "core/gpu.h"
 #include "core/host.h"
@@ -16,11 +17,13 @@
 #include "core/settings.h"
 #include "core/system.h"
 
+#include "util/cd_image_converter.h"
 #include "util/gpu_device.h"
 #include "util/imgui_manager.h"
 #include "util/ini_settings_interface.h"
 #include "util/input_manager.h"
 #include "util/platform_misc.h"
+#include "util/resource_pack.h"
 
 #include "imgui.h"
 #include "imgui_internal.h"
@@ -29,12 +32,16 @@
 #include "common/assert.h"
 #include "common/byte_stream.h"
 #include "common/crash_handler.h"
+#include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/path.h"
+#include "common/progress_callback.h"
 #include "common/string_util.h"
 #include "common/threading.h"
+#include "common/trace_recorder.h"
 
+#include <cerrno>
 #include <cinttypes>
 #include <cmath>
 #include <condition_variable>
@@ -47,6 +54,11 @@ Log_SetChannel(NoGUIHost);
 #include "common/windows_headers.h"
 #include <ShlObj.h>
 #include <shellapi.h>
+#else
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
 #endif
 
 static constexpr u32 SETTINGS_VERSION = 3;
@@ -62,6 +74,8 @@ namespace NoGUIHost {
 /// Starts the virtual machine.
 static void StartSystem(SystemBootParameters params);
 
+static std::optional<int> RunSupervisorIfRequested(int argc, char* argv[]);
+static std::optional<int> RunConverterIfRequested(int argc, char* argv[]);
 static bool ParseCommandLineParametersAndInitializeConfig(int argc, char* argv[],
                                                           std::optional<SystemBootParameters>& autoboot);
 static void PrintCommandLineVersion();
@@ -162,6 +176,8 @@ void NoGUIHost::SetResourcesDirectory()
   // On macOS, this is in the bundle resources directory.
   EmuFolders::Resources = Path::Canonicalize(Path::Combine(EmuFolders::AppRoot, "../Resources"));
 #endif
+
+  ResourcePack::SetPath(Path::Combine(EmuFolders::Resources, ResourcePack::FILENAME));
 }
 
 void NoGUIHost::SetDataDirectory()
@@ -352,6 +368,9 @@ s32 Host::Internal::GetTranslatedStringImpl(const std::string_view& context, con
 
 std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
 {
+  if (std::optional<std::vector<u8>> packed = ResourcePack::ReadFile(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   std::optional<std::vector<u8>> ret(FileSystem::ReadBinaryFile(path.c_str()));
   if (!ret.has_value())
@@ -361,6 +380,9 @@ std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
 
 std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
 {
+  if (std::optional<std::string> packed = ResourcePack::ReadFileToString(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   std::optional<std::string> ret(FileSystem::ReadFileToString(path.c_str()));
   if (!ret.has_value())
@@ -370,6 +392,9 @@ std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
 
 std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
 {
+  if (std::optional<std::time_t> packed = ResourcePack::GetFileTimestamp(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path.c_str(), &sd))
@@ -1003,12 +1028,179 @@ void NoGUIHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -settings <filename>: Loads a custom settings configuration from the\n"
                        "    specified filename. Default settings applied if file not found.\n");
   std::fprintf(stderr, "  -earlyconsole: Creates console as early as possible, for logging.\n");
+  std::fprintf(stderr, "  -trace: Records trace events from startup. Stop with the hotkey, or exit, to write\n"
+                       "    them to the dumps directory.\n");
+  std::fprintf(stderr, "  -instances <count>: Runs count copies of the emulator with the remaining arguments,\n"
+                       "    and exits once they all have. The copies share the data directory, so read-only\n"
+                       "    data such as the game database cache and precached discs is only kept in memory\n"
+                       "    once. Must be the first argument.\n");
+  std::fprintf(stderr, "  -convert <path> [path...]: Converts disc images to ZCD alongside the originals,\n"
+                       "    verifies them, and exits. Directories are searched recursively, and images which\n"
+                       "    already have a converted copy are skipped. Must be the first argument.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
                        "    spaces or starts with a dash.\n");
   std::fprintf(stderr, "\n");
 }
 
+std::optional<int> NoGUIHost::RunSupervisorIfRequested(int argc, char* argv[])
+{
+  if (argc < 3 || std::strcmp(argv[1], "-instances") != 0)
+    return std::nullopt;
+
+  const std::optional<u32> count = StringUtil::FromChars<u32>(argv[2]);
+  if (!count.has_value() || count.value() == 0)
+  {
+    std::fprintf(stderr, "Invalid instance count: %s\n", argv[2]);
+    return EXIT_FAILURE;
+  }
+
+  // Each instance is its own process, since the emulator state is global. Sharing comes from mapping the same files.
+  const std::string program_path = FileSystem::GetProgramPath();
+  u32 failed = 0;
+
+#ifdef _WIN32
+  // Quote every argument so that CommandLineToArgvW() splits them back out the same way.
+  std::wstring command_line;
+  for (int i = 0; i < argc; i++)
+  {
+    if (i == 1 || i == 2)
+      continue;
+
+    const std::wstring arg = StringUtil::UTF8StringToWideString((i == 0) ? program_path : std::string(argv[i]));
+    if (!command_line.empty())
+      command_line += L' ';
+    command_line += L'"';
+    u32 backslashes = 0;
+    for (const wchar_t ch : arg)
+    {
+      if (ch == L'\\')
+      {
+        backslashes++;
+        continue;
+      }
+
+      command_line.append((ch == L'"') ? (backslashes * 2 + 1) : backslashes, L'\\');
+      command_line += ch;
+      backslashes = 0;
+    }
+    command_line.append(backslashes * 2, L'\\');
+    command_line += L'"';
+  }
+
+  std::vector<HANDLE> processes;
+  for (u32 i = 0; i < count.value(); i++)
+  {
+    STARTUPINFOW si = {};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {};
+    std::wstring mutable_command_line = command_line;
+    if (!CreateProcessW(nullptr, mutable_command_line.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &si, &pi))
+    {
+      std::fprintf(stderr, "Failed to start instance %u: %u\n", i, static_cast<unsigned>(GetLastError()));
+      failed++;
+      continue;
+    }
+
+    CloseHandle(pi.hThread);
+    processes.push_back(pi.hProcess);
+  }
+
+  for (HANDLE process : processes)
+  {
+    DWORD exit_code = EXIT_FAILURE;
+    WaitForSingleObject(process, INFINITE);
+    GetExitCodeProcess(process, &exit_code);
+    failed += static_cast<u32>(exit_code != EXIT_SUCCESS);
+    CloseHandle(process);
+  }
+#else
+  std::vector<char*> child_argv;
+  child_argv.reserve(static_cast<size_t>(argc) - 1);
+  child_argv.push_back(const_cast<char*>(program_path.c_str()));
+  for (int i = 3; i < argc; i++)
+    child_argv.push_back(argv[i]);
+  child_argv.push_back(nullptr);
+
+  std::vector<pid_t> processes;
+  for (u32 i = 0; i < count.value(); i++)
+  {
+    pid_t pid;
+    const int res = posix_spawn(&pid, program_path.c_str(), nullptr, nullptr, child_argv.data(), environ);
+    if (res != 0)
+    {
+      std::fprintf(stderr, "Failed to start instance %u: %d\n", i, res);
+      failed++;
+      continue;
+    }
+
+    processes.push_back(pid);
+  }
+
+  for (const pid_t pid : processes)
+  {
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+      ;
+    failed += static_cast<u32>(!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS);
+  }
+#endif
+
+  std::fprintf(stderr, "%u of %u instances exited successfully.\n", count.value() - failed, count.value());
+  return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+std::optional<int> NoGUIHost::RunConverterIfRequested(int argc, char* argv[])
+{
+  if (argc < 3 || std::strcmp(argv[1], "-convert") != 0)
+    return std::nullopt;
+
+  InitializeEarlyConsole();
+
+  const CDImageConverter::Options options;
+  ConsoleProgressCallback progress;
+  u32 converted = 0;
+  u32 failed = 0;
+  for (int i = 2; i < argc; i++)
+  {
+    FILESYSTEM_STAT_DATA sd;
+    if (!FileSystem::StatFile(argv[i], &sd))
+    {
+      Log_ErrorPrintf("'%s' does not exist.", argv[i]);
+      failed++;
+      continue;
+    }
+
+    if (sd.Attributes & FILESYSTEM_FILE_ATTRIBUTE_DIRECTORY)
+    {
+      u32 directory_failed = 0;
+      converted += CDImageConverter::ConvertDirectory(argv[i], true, options, &progress, &directory_failed);
+      failed += directory_failed;
+      continue;
+    }
+
+    Error error;
+    const std::string output_path = CDImageConverter::GetOutputPath(argv[i]);
+    if (FileSystem::FileExists(output_path.c_str()))
+    {
+      Log_ErrorPrintf("'%s' already exists.", output_path.c_str());
+      failed++;
+    }
+    else if (!CDImageConverter::ConvertImage(argv[i], output_path.c_str(), options, &progress, &error))
+    {
+      Log_ErrorPrintf("Failed to convert '%s': %s", argv[i], error.GetDescription().c_str());
+      failed++;
+    }
+    else
+    {
+      converted++;
+    }
+  }
+
+  std::fprintf(stderr, "%u images converted, %u failed.\n", converted, failed);
+  return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 std::optional<SystemBootParameters>& AutoBoot(std::optional<SystemBootParameters>& autoboot)
 {
   if (!autoboot)
@@ -1128,6 +1320,11 @@ bool NoGUIHost::ParseCommandLineParametersAndInitializeConfig(int argc, char* ar
         InitializeEarlyConsole();
         continue;
       }
+      else if (CHECK_ARG("-trace"))
+      {
+        TraceRecorder::Start();
+        continue;
+      }
       else if (CHECK_ARG("--"))
       {
         no_more_args = true;
@@ -1202,6 +1399,11 @@ int main(int argc, char* argv[])
 {
   CrashHandler::Install();
 
+  if (const std::optional<int> supervisor_result = NoGUIHost::RunSupervisorIfRequested(argc, argv))
+    return supervisor_result.value();
+  if (const std::optional<int> converter_result = NoGUIHost::RunConverterIfRequested(argc, argv))
+    return converter_result.value();
+
   g_nogui_window = NoGUIHost::CreatePlatform();
   if (!g_nogui_window)
     return EXIT_FAILURE;
@@ -1210,6 +1412,9 @@ int main(int argc, char* argv[])
   if (!NoGUIHost::ParseCommandLineParametersAndInitializeConfig(argc, argv, autoboot))
     return EXIT_FAILURE;
 
+  // Creating the window doesn't need the game database, so load it while the CPU thread starts up.
+  GameDatabase::StartBackgroundLoad();
+
   // the rest of initialization happens on the CPU thread.
   NoGUIHost::HookSignals();
   NoGUIHost::StartCPUThread();
@@ -306,6 +306,14 @@ void AdvancedSettingsWidget::addTweakOptions()
                         "RecompilerMemoryExceptions", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Linking"), "CPU",
                         "RecompilerBlockLinking", true);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Cache"), "CPU",
+                        "RecompilerBlockCache", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Profiling"), "CPU",
+                        "RecompilerBlockProfiling", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Deferred Compilation"), "CPU",
+                        "RecompilerDeferredCompile", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Idle Loop Skipping"), "CPU",
+                        "RecompilerIdleLoopSkipping", false);
   addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Fast Memory Access"), "CPU",
                        "FastmemMode", Settings::ParseCPUFastmemMode, Settings::GetCPUFastmemModeName,
                        Settings::GetCPUFastmemModeDisplayName, static_cast<u32>(CPUFastmemMode::Count),
@@ -317,6 +325,9 @@ void AdvancedSettingsWidget::addTweakOptions()
                         "TextureReplacements", "EnableVRAMWriteReplacements", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Preload Texture Replacements"), "TextureReplacements",
                         "PreloadTextures", false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Texture Replacement Cache Size (MB)"),
+                         "TextureReplacements", "CacheSizeMB", 64, 16384,
+                         Settings::DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Dump Replaceable VRAM Writes"), "TextureReplacements",
                         "DumpVRAMWrites", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Set Dumped VRAM Write Alpha Channel"),
@@ -340,12 +351,20 @@ void AdvancedSettingsWidget::addTweakOptions()
                         false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Disable Shader Cache"), "GPU", "DisableShaderCache",
                         false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Lazy Pipeline Compilation"), "GPU",
+                        "LazyPipelineCompilation", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use Ubershaders While Compiling"), "GPU",
+                        "UseUbershaders", false);
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Stretch Display Vertically"), "Display",
                         "StretchVertically", false);
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Increase Timer Resolution"), "Main",
                         "IncreaseTimerResolution", true);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Thread Core Placement"), "Main", "ThreadCorePlacement",
+                        false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Poll Input On Controller Reads"), "ControllerPorts",
+                        "LateInputPolling", false);
 
   addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("CD-ROM Mechacon Version"), "CDROM", "MechaconVersion",
                        Settings::ParseCDROMMechVersionName, Settings::GetCDROMMechVersionName,
@@ -353,10 +372,30 @@ void AdvancedSettingsWidget::addTweakOptions()
                        Settings::DEFAULT_CDROM_MECHACON_VERSION);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Allow Booting Without SBI File"), "CDROM",
                         "AllowBootingWithoutSBIFile", false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("CHD Hunk Cache Size"), "CDROM", "CHDHunkCacheSize", 1,
+                         256, Settings::DEFAULT_CDROM_CHD_HUNK_CACHE_SIZE);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Share Preloaded Images Between Instances"), "CDROM",
+                        "SharePrecache", false);
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Create Save State Backups"), "General",
                         "CreateSaveStateBackups", false);
 
+  addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Video Capture Format"), "MediaCapture", "Backend",
+                       MediaCapture::ParseBackendName, MediaCapture::GetBackendName,
+                       MediaCapture::GetBackendDisplayName, static_cast<u32>(MediaCaptureBackend::Count),
+                       Settings::DEFAULT_MEDIA_CAPTURE_BACKEND);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Video Capture Quality"), "MediaCapture", "Quality", 1,
+                         100, Settings::DEFAULT_MEDIA_CAPTURE_QUALITY);
+
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Log Asynchronously"), "Logging", "LogAsync",
+                        Settings::DEFAULT_LOG_ASYNC);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Log Channel Rate Limit"), "Logging", "ChannelRateLimit",
+                         0, 100000, Settings::DEFAULT_LOG_CHANNEL_RATE_LIMIT);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Metrics Server"), "Debug", "EnableMetricsServer",
+                        false);
+  addIntRangeTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Metrics Server Port"), "Debug", "MetricsServerPort", 1,
+                         65535, Settings::DEFAULT_METRICS_SERVER_PORT);
+
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable PCDrv"), "PCDrv", "Enabled", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable PCDrv Writes"), "PCDrv", "EnableWrites", false);
   addDirectoryOption(m_dialog, m_ui.tweakOptionTable, tr("PCDrv Root Directory"), "PCDrv", "Root");
@@ -381,10 +420,16 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                              Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD); // PGXP depth clear threshold
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler memory exceptions
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);              // Recompiler block linking
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler block cache
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler block profiling
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler deferred compilation
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler idle loop skipping
     setChoiceTweakOption(m_ui.tweakOptionTable, i++, Settings::DEFAULT_CPU_FASTMEM_MODE); // Recompiler fastmem mode
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                             // Use Old MDEC Routines
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // VRAM write texture replacement
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Preload texture replacements
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           Settings::DEFAULT_TEXTURE_REPLACEMENT_CACHE_SIZE_MB); // Texture replacement cache size
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Dump replacable VRAM writes
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);  // Set dumped VRAM write alpha channel
     setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
@@ -401,12 +446,29 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                            static_cast<int>(Settings::DEFAULT_GPU_MAX_RUN_AHEAD)); // GPU max run-ahead
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Use debug host GPU device
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Disable Shader Cache
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Lazy Pipeline Compilation
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Use Ubershaders While Compiling
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Stretch Display Vertically
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);                       // Increase Timer Resolution
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Thread Core Placement
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                      // Poll input on controller reads
     setChoiceTweakOption(m_ui.tweakOptionTable, i++,
                          Settings::DEFAULT_CDROM_MECHACON_VERSION); // CDROM Mechacon Version
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);       // Allow booting without SBI file
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           static_cast<int>(Settings::DEFAULT_CDROM_CHD_HUNK_CACHE_SIZE)); // CHD hunk cache size
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);       // Share precache
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);       // Create save state backups
+    setChoiceTweakOption(m_ui.tweakOptionTable, i++,
+                         Settings::DEFAULT_MEDIA_CAPTURE_BACKEND); // Video capture format
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           Settings::DEFAULT_MEDIA_CAPTURE_QUALITY); // Video capture quality
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, Settings::DEFAULT_LOG_ASYNC); // Log asynchronously
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           static_cast<int>(Settings::DEFAULT_LOG_CHANNEL_RATE_LIMIT)); // Log channel rate limit
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                             // Enable metrics server
+    setIntRangeTweakOption(m_ui.tweakOptionTable, i++,
+                           static_cast<int>(Settings::DEFAULT_METRICS_SERVER_PORT)); // Metrics server port
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);       // Enable PCDRV
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);       // Enable PCDRV Writes
     setDirectoryOption(m_ui.tweakOptionTable, i++, "");             // PCDrv Root Directory
@@ -434,9 +496,14 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("GPU", "PGXPDepthClearThreshold");
   sif->DeleteValue("CPU", "RecompilerMemoryExceptions");
   sif->DeleteValue("CPU", "RecompilerBlockLinking");
+  sif->DeleteValue("CPU", "RecompilerBlockCache");
+  sif->DeleteValue("CPU", "RecompilerBlockProfiling");
+  sif->DeleteValue("CPU", "RecompilerDeferredCompile");
+  sif->DeleteValue("CPU", "RecompilerIdleLoopSkipping");
   sif->DeleteValue("CPU", "FastmemMode");
   sif->DeleteValue("TextureReplacements", "EnableVRAMWriteReplacements");
   sif->DeleteValue("TextureReplacements", "PreloadTextures");
+  sif->DeleteValue("TextureReplacements", "CacheSizeMB");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWrites");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWriteForceAlphaChannel");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWriteWidthThreshold");
@@ -447,11 +514,23 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("Hacks", "GPUFIFOSize");
   sif->DeleteValue("Hacks", "GPUMaxRunAhead");
   sif->DeleteValue("GPU", "UseDebugDevice");
+  sif->DeleteValue("GPU", "LazyPipelineCompilation");
+  sif->DeleteValue("GPU", "UseUbershaders");
   sif->DeleteValue("Display", "StretchVertically");
   sif->DeleteValue("Main", "IncreaseTimerResolution");
+  sif->DeleteValue("Main", "ThreadCorePlacement");
+  sif->DeleteValue("ControllerPorts", "LateInputPolling");
   sif->DeleteValue("CDROM", "MechaconVersion");
   sif->DeleteValue("CDROM", "AllowBootingWithoutSBIFile");
+  sif->DeleteValue("CDROM", "CHDHunkCacheSize");
+  sif->DeleteValue("CDROM", "SharePrecache");
   sif->DeleteValue("General", "CreateSaveStateBackups");
+  sif->DeleteValue("MediaCapture", "Backend");
+  sif->DeleteValue("MediaCapture", "Quality");
+  sif->DeleteValue("Logging", "LogAsync");
+  sif->DeleteValue("Logging", "ChannelRateLimit");
+  sif->DeleteValue("Debug", "EnableMetricsServer");
+  sif->DeleteValue("Debug", "MetricsServerPort");
   sif->DeleteValue("PCDrv", "Enabled");
   sif->DeleteValue("PCDrv", "EnableWrites");
   sif->DeleteValue("PCDrv", "Root");
@@ -3,7 +3,9 @@
 
 #include "debuggerwindow.h"
 #include "common/assert.h"
+#include "common/path.h"
 #include "core/cpu_core_private.h"
+#include "core/settings.h"
 #include "debuggermodels.h"
 #include "qthost.h"
 #include "qtutils.h"
@@ -130,17 +132,18 @@ void DebuggerWindow::onDumpAddressTriggered()
 
 void DebuggerWindow::onTraceTriggered()
 {
+  const QString path = QString::fromStdString(Path::Combine(EmuFolders::Dumps, CPU::TRACE_FILENAME));
   if (!CPU::IsTraceEnabled())
   {
     QMessageBox::critical(
       this, windowTitle(),
-      tr("Trace logging started to cpu_log.txt.\nThis file can be several gigabytes, so be aware of SSD wear."));
+      tr("Trace logging started to %1.\nThis file can be several gigabytes, so be aware of SSD wear.").arg(path));
     CPU::StartTrace();
   }
   else
   {
     CPU::StopTrace();
-    QMessageBox::critical(this, windowTitle(), tr("Trace logging to cpu_log.txt stopped."));
+    QMessageBox::critical(this, windowTitle(), tr("Trace logging to %1 stopped.").arg(path));
   }
 }
 
@@ -48,6 +48,7 @@ DisplaySettingsWidget::DisplaySettingsWidget(SettingsWindow* dialog, QWidget* pa
                                                "InternalResolutionScreenshots", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.vsync, "Display", "VSync", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.gpuThread, "GPU", "UseThread", true);
+  SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.swWorkerThreads, "GPU", "SoftwareRendererWorkerThreads", 0);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.threadedPresentation, "GPU", "ThreadedPresentation", true);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.showOSDMessages, "Display", "ShowOSDMessages", true);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.showFPS, "Display", "ShowFPS", false);
@@ -114,6 +115,9 @@ DisplaySettingsWidget::DisplaySettingsWidget(SettingsWindow* dialog, QWidget* pa
   dialog->registerWidgetHelp(m_ui.gpuThread, tr("Threaded Rendering"), tr("Checked"),
                              tr("Uses a second thread for drawing graphics. Currently only available for the software "
                                 "renderer, but can provide a significant speed improvement, and is safe to use."));
+  dialog->registerWidgetHelp(m_ui.swWorkerThreads, tr("Rasterizer Threads"), tr("Disabled"),
+                             tr("Splits the screen into tiles which are drawn in parallel by additional threads. Only "
+                                "available for the software renderer. Output is identical to single-threaded drawing."));
   dialog->registerWidgetHelp(m_ui.showOSDMessages, tr("Show OSD Messages"), tr("Checked"),
                              tr("Shows on-screen-display messages when events occur such as save states being "
                                 "created/loaded, screenshots being taken, etc."));
@@ -256,6 +260,7 @@ void DisplaySettingsWidget::populateGPUAdaptersAndResolutions()
   }
 
   m_ui.gpuThread->setEnabled(thread_supported);
+  m_ui.swWorkerThreads->setEnabled(thread_supported);
   m_ui.threadedPresentation->setEnabled(threaded_presentation_supported);
 }
 
@@ -18,9 +18,12 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsWindow* dialog, QWidget
 
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.syncToHostRefreshRate, "Main", "SyncToHostRefreshRate", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.displayAllFrames, "Display", "DisplayAllFrames", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.preFrameSleep, "Display", "PreFrameSleep", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.renderSkip, "GPU", "RenderSkip", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.rewindEnable, "Main", "RewindEnable", false);
   SettingWidgetBinder::BindWidgetToFloatSetting(sif, m_ui.rewindSaveFrequency, "Main", "RewindFrequency", 10.0f);
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.rewindSaveSlots, "Main", "RewindSaveSlots", 10);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.rewindNativeVRAM, "Main", "RewindNativeVRAM", false);
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.runaheadFrames, "Main", "RunaheadFrameCount", 0);
 
   const float effective_emulation_speed = m_dialog->getEffectiveFloatValue("Main", "EmulationSpeed", 1.0f);
@@ -73,6 +76,7 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsWindow* dialog, QWidget
           &EmulationSettingsWidget::updateRewind);
   connect(m_ui.rewindSaveSlots, QOverload<int>::of(&QSpinBox::valueChanged), this,
           &EmulationSettingsWidget::updateRewind);
+  connect(m_ui.rewindNativeVRAM, &QCheckBox::stateChanged, this, &EmulationSettingsWidget::updateRewind);
   connect(m_ui.runaheadFrames, QOverload<int>::of(&QComboBox::currentIndexChanged), this,
           &EmulationSettingsWidget::updateRewind);
 
@@ -98,6 +102,15 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsWindow* dialog, QWidget
                              tr("Enable this option will ensure every frame the console renders is displayed to the "
                                 "screen, for optimal frame pacing. If you are having difficulties maintaining full "
                                 "speed, or are getting audio glitches, try disabling this option."));
+  dialog->registerWidgetHelp(m_ui.preFrameSleep, tr("Reduce Input Latency"), tr("Unchecked"),
+                             tr("Delays the start of each frame until just before it is needed, based on how long "
+                                "recent frames took to run, so that input is read as late as possible. Has no effect "
+                                "when VSync is used for throttling. If you get stutter, try disabling this option."));
+  dialog->registerWidgetHelp(m_ui.renderSkip, tr("Skip Rendering When Fast Forwarding"), tr("Unchecked"),
+                             tr("Only draws the frames which are displayed while fast forwarding or using turbo, "
+                                "which is much faster when the GPU is the bottleneck. Runs the software renderer in "
+                                "parallel to fill in what wasn't drawn, at native resolution. Only applies to the "
+                                "hardware renderers."));
   dialog->registerWidgetHelp(
     m_ui.rewindEnable, tr("Rewinding"), tr("Unchecked"),
     tr("<b>Enable Rewinding:</b> Saves state periodically so you can rewind any mistakes while playing.<br> "
@@ -105,6 +118,11 @@ EmulationSettingsWidget::EmulationSettingsWidget(SettingsWindow* dialog, QWidget
        "requirements.<br> "
        "<b>Rewind Buffer Size:</b> How many saves will be kept for rewinding. Higher values have greater memory "
        "requirements."));
+  dialog->registerWidgetHelp(
+    m_ui.rewindNativeVRAM, tr("Store Rewind VRAM At Native Resolution"), tr("Unchecked"),
+    tr("Keeps each rewind save's copy of VRAM at native resolution, instead of the internal resolution. Greatly "
+       "reduces the GPU memory needed at high resolution scales, but the first frame after rewinding is upscaled from "
+       "native resolution. Has no effect with multisampling."));
   dialog->registerWidgetHelp(
     m_ui.runaheadFrames, tr("Runahead"), tr("Disabled"),
     tr(
@@ -189,7 +207,8 @@ void EmulationSettingsWidget::updateRewind()
       ((frequency <= std::numeric_limits<float>::epsilon()) ? (1.0f / 60.0f) : frequency) * static_cast<float>(frames);
 
     u64 ram_usage, vram_usage;
-    System::CalculateRewindMemoryUsage(frames, &ram_usage, &vram_usage);
+    System::CalculateRewindMemoryUsage(frames, m_dialog->getEffectiveBoolValue("Main", "RewindNativeVRAM", false),
+                                       &ram_usage, &vram_usage);
 
     m_ui.rewindSummary->setText(
       tr("Rewind for %n frame(s), lasting %1 second(s) will require up to %2MB of RAM and %3MB of VRAM.", "", frames)
@@ -198,6 +217,7 @@ void EmulationSettingsWidget::updateRewind()
         .arg(vram_usage / 1048576));
     m_ui.rewindSaveFrequency->setEnabled(true);
     m_ui.rewindSaveSlots->setEnabled(true);
+    m_ui.rewindNativeVRAM->setEnabled(true);
   }
   else
   {
@@ -213,5 +233,6 @@ void EmulationSettingsWidget::updateRewind()
     }
     m_ui.rewindSaveFrequency->setEnabled(false);
     m_ui.rewindSaveSlots->setEnabled(false);
+    m_ui.rewindNativeVRAM->setEnabled(false);
   }
 }
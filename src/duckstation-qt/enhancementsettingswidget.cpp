@@ -17,6 +17,7 @@ EnhancementSettingsWidget::EnhancementSettingsWidget(SettingsWindow* dialog, QWi
   setupAdditionalUi();
 
   SettingWidgetBinder::BindWidgetToIntSetting(sif, m_ui.resolutionScale, "GPU", "ResolutionScale", 1);
+  SettingWidgetBinder::BindWidgetToBoolSetting(sif, m_ui.dynamicResolution, "GPU", "DynamicResolution", false);
   SettingWidgetBinder::BindWidgetToEnumSetting(sif, m_ui.gpuDownsampleMode, "GPU", "DownsampleMode",
                                                &Settings::ParseDownsampleModeName, &Settings::GetDownsampleModeName,
                                                Settings::DEFAULT_GPU_DOWNSAMPLE_MODE);
@@ -73,6 +74,11 @@ EnhancementSettingsWidget::EnhancementSettingsWidget(SettingsWindow* dialog, QWi
     tr("Setting this beyond 1x will enhance the resolution of rendered 3D polygons and lines. Only applies "
        "to the hardware backends. <br>This option is usually safe, with most games looking fine at "
        "higher resolutions. Higher resolutions require a more powerful GPU."));
+  dialog->registerWidgetHelp(
+    m_ui.dynamicResolution, tr("Dynamic Resolution"), tr("Unchecked"),
+    tr("Measures how long the GPU takes to render each frame, and lowers the resolution scale in demanding scenes "
+       "so the game stays at full speed. The scale is raised again, up to the selected one, once there is time to "
+       "spare. <br>Each change briefly pauses rendering while the VRAM is copied to the new resolution."));
   dialog->registerWidgetHelp(
     m_ui.trueColor, tr("True Color Rendering (24-bit, disables dithering)"), tr("Unchecked"),
     tr("Forces the precision of colours output to the console's framebuffer to use the full 8 bits of precision per "
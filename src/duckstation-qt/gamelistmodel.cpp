@@ -5,10 +5,13 @@
 #include "common/file_system.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "core/settings.h"
 #include "core/system.h"
 #include "qthost.h"
 #include "qtutils.h"
+#include "fmt/format.h"
 #include <QtConcurrent/QtConcurrent>
+#include <QtCore/QCryptographicHash>
 #include <QtCore/QDate>
 #include <QtCore/QDateTime>
 #include <QtCore/QFuture>
@@ -16,6 +19,8 @@
 #include <QtGui/QGuiApplication>
 #include <QtGui/QIcon>
 #include <QtGui/QPainter>
+#include <algorithm>
+#include <cctype>
 
 static constexpr std::array<const char*, GameListModel::Column_Count> s_column_names = {
   {"Type", "Serial", "Title", "File Title", "Developer", "Publisher", "Genre", "Year", "Players", "Time Played",
@@ -26,6 +31,9 @@ static constexpr int COVER_ART_HEIGHT = 512;
 static constexpr int COVER_ART_SPACING = 32;
 static constexpr int MIN_COVER_CACHE_SIZE = 256;
 
+// Sizes of the thumbnails kept in the cache directory, in pixels on the longest side.
+static constexpr std::array<int, 3> COVER_THUMBNAIL_SIZES = {{128, 256, 512}};
+
 static int DPRScale(int size, float dpr)
 {
   return static_cast<int>(static_cast<float>(size) * dpr);
@@ -36,53 +44,53 @@ static int DPRUnscale(int size, float dpr)
   return static_cast<int>(static_cast<float>(size) / dpr);
 }
 
-static void resizeAndPadPixmap(QPixmap* pm, int expected_width, int expected_height, float dpr)
+static void resizeAndPadImage(QImage* image, int expected_width, int expected_height, float dpr)
 {
   const int dpr_expected_width = DPRScale(expected_width, dpr);
   const int dpr_expected_height = DPRScale(expected_height, dpr);
-  if (pm->width() == dpr_expected_width && pm->height() == dpr_expected_height)
+  if (image->width() == dpr_expected_width && image->height() == dpr_expected_height)
     return;
 
-  *pm = pm->scaled(dpr_expected_width, dpr_expected_height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-  if (pm->width() == dpr_expected_width && pm->height() == dpr_expected_height)
+  *image = image->scaled(dpr_expected_width, dpr_expected_height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+  image->setDevicePixelRatio(dpr);
+  if (image->width() == dpr_expected_width && image->height() == dpr_expected_height)
     return;
 
   // QPainter works in unscaled coordinates.
   int xoffs = 0;
   int yoffs = 0;
-  if (pm->width() < dpr_expected_width)
-    xoffs = DPRUnscale((dpr_expected_width - pm->width()) / 2, dpr);
-  if (pm->height() < dpr_expected_height)
-    yoffs = DPRUnscale((dpr_expected_height - pm->height()) / 2, dpr);
+  if (image->width() < dpr_expected_width)
+    xoffs = DPRUnscale((dpr_expected_width - image->width()) / 2, dpr);
+  if (image->height() < dpr_expected_height)
+    yoffs = DPRUnscale((dpr_expected_height - image->height()) / 2, dpr);
 
-  QPixmap padded_image(dpr_expected_width, dpr_expected_height);
+  QImage padded_image(dpr_expected_width, dpr_expected_height, QImage::Format_ARGB32_Premultiplied);
   padded_image.setDevicePixelRatio(dpr);
   padded_image.fill(Qt::transparent);
   QPainter painter;
   if (painter.begin(&padded_image))
   {
     painter.setCompositionMode(QPainter::CompositionMode_Source);
-    painter.drawPixmap(xoffs, yoffs, *pm);
+    painter.drawImage(xoffs, yoffs, *image);
     painter.setCompositionMode(QPainter::CompositionMode_Destination);
     painter.fillRect(padded_image.rect(), QColor(0, 0, 0, 0));
     painter.end();
   }
 
-  *pm = padded_image;
+  *image = padded_image;
 }
 
-static QPixmap createPlaceholderImage(const QPixmap& placeholder_pixmap, int width, int height, float scale,
-                                      const std::string& title)
+static QImage createPlaceholderImage(const QImage& placeholder_image, int width, int height, float scale,
+                                     const std::string& title, float dpr)
 {
-  const float dpr = qApp->devicePixelRatio();
-  QPixmap pm(placeholder_pixmap.copy());
-  pm.setDevicePixelRatio(dpr);
-  if (pm.isNull())
-    return QPixmap();
+  QImage image(placeholder_image.copy());
+  image.setDevicePixelRatio(dpr);
+  if (image.isNull())
+    return QImage();
 
-  resizeAndPadPixmap(&pm, width, height, dpr);
+  resizeAndPadImage(&image, width, height, dpr);
   QPainter painter;
-  if (painter.begin(&pm))
+  if (painter.begin(&image))
   {
     QFont font;
     font.setPointSize(std::max(static_cast<int>(32.0f * scale), 1));
@@ -95,7 +103,60 @@ static QPixmap createPlaceholderImage(const QPixmap& placeholder_pixmap, int wid
     painter.end();
   }
 
-  return pm;
+  return image;
+}
+
+/// Thumbnails are keyed on the source's size and modification time, so replacing a cover invalidates them.
+static std::string getCoverThumbnailPath(const std::string& cover_path, int size)
+{
+  FILESYSTEM_STAT_DATA sd;
+  if (!FileSystem::StatFile(cover_path.c_str(), &sd))
+    return {};
+
+  const QByteArray key = QByteArray::fromStdString(fmt::format("{}|{}|{}", cover_path, sd.Size, sd.ModificationTime));
+  const QByteArray hash = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+  return Path::Combine(EmuFolders::Cache, fmt::format("covers" FS_OSPATH_SEPARATOR_STR "{}_{}.png",
+                                                      std::string_view(hash.constData(), hash.size()), size));
+}
+
+/// Loads a cover at least size pixels on its longest side, from the thumbnail cache if possible. When the source has
+/// to be decoded, every thumbnail size is written from that one decode, so zooming doesn't have to decode it again.
+static QImage loadCoverImage(const std::string& cover_path, int size)
+{
+  const auto thumbnail_size = std::find_if(COVER_THUMBNAIL_SIZES.begin(), COVER_THUMBNAIL_SIZES.end(),
+                                           [size](int thumbnail_size) { return (thumbnail_size >= size); });
+  if (thumbnail_size == COVER_THUMBNAIL_SIZES.end())
+    return QImage(QString::fromStdString(cover_path));
+
+  QImage image;
+  const std::string thumbnail_path = getCoverThumbnailPath(cover_path, *thumbnail_size);
+  if (thumbnail_path.empty())
+    return image;
+  if (image.load(QString::fromStdString(thumbnail_path)))
+    return image;
+  if (!image.load(QString::fromStdString(cover_path)))
+    return image;
+
+  const std::string cache_dir = Path::Combine(EmuFolders::Cache, "covers");
+  if (!FileSystem::EnsureDirectoryExists(cache_dir.c_str(), false))
+    return image;
+
+  QImage ret;
+  for (const int save_size : COVER_THUMBNAIL_SIZES)
+  {
+    const QImage thumbnail = (std::max(image.width(), image.height()) > save_size) ?
+                               image.scaled(save_size, save_size, Qt::KeepAspectRatio, Qt::SmoothTransformation) :
+                               image;
+    // Failing to save isn't a problem, it'll just be decoded from the source again next time.
+    const std::string save_path = getCoverThumbnailPath(cover_path, save_size);
+    if (!save_path.empty() && !FileSystem::FileExists(save_path.c_str()))
+      thumbnail.save(QString::fromStdString(save_path), "PNG");
+
+    if (save_size == *thumbnail_size)
+      ret = thumbnail;
+  }
+
+  return ret;
 }
 
 std::optional<GameListModel::Column> GameListModel::getColumnIdForName(std::string_view name)
@@ -121,13 +182,19 @@ GameListModel::GameListModel(float cover_scale, bool show_cover_titles, QObject*
   setCoverScale(cover_scale);
   setColumnDisplayNames();
 }
-GameListModel::~GameListModel() = default;
+GameListModel::~GameListModel()
+{
+  // Loads capture the model, so they have to finish before it goes away.
+  m_cover_load_pool.clear();
+  m_cover_load_pool.waitForDone();
+}
 
 void GameListModel::setCoverScale(float scale)
 {
   if (m_cover_scale == scale)
     return;
 
+  cancelCoverLoads();
   m_cover_pixmap_cache.Clear();
   m_cover_scale = scale;
   m_loading_pixmap = QPixmap(getCoverArtWidth(), getCoverArtHeight());
@@ -138,6 +205,7 @@ void GameListModel::setCoverScale(float scale)
 
 void GameListModel::refreshCovers()
 {
+  cancelCoverLoads();
   m_cover_pixmap_cache.Clear();
   refresh();
 }
@@ -158,33 +226,45 @@ void GameListModel::reloadThemeSpecificImages()
   refresh();
 }
 
+void GameListModel::cancelCoverLoads()
+{
+  // Anything already running is dropped when it completes, since the generation won't match.
+  m_cover_load_pool.clear();
+  m_cover_load_generation++;
+}
+
 void GameListModel::loadOrGenerateCover(const GameList::Entry* ge)
 {
-  QFuture<QPixmap> future =
-    QtConcurrent::run([this, path = ge->path, title = ge->title, serial = ge->serial]() -> QPixmap {
-      QPixmap image;
+  // Only QImage is safe to use off the UI thread, it's converted to a pixmap when it's inserted into the cache.
+  QFuture<QImage> future =
+    QtConcurrent::run(&m_cover_load_pool, [path = ge->path, title = ge->title, serial = ge->serial,
+                                           placeholder = m_placeholder_image, width = getCoverArtWidth(),
+                                           height = getCoverArtHeight(), scale = m_cover_scale,
+                                           dpr = static_cast<float>(qApp->devicePixelRatio())]() -> QImage {
+      QImage image;
       const std::string cover_path(GameList::GetCoverImagePath(path, serial, title));
       if (!cover_path.empty())
       {
-        const float dpr = qApp->devicePixelRatio();
-        image = QPixmap(QString::fromStdString(cover_path));
+        image = loadCoverImage(cover_path, DPRScale(std::max(width, height), dpr));
         if (!image.isNull())
         {
           image.setDevicePixelRatio(dpr);
-          resizeAndPadPixmap(&image, getCoverArtWidth(), getCoverArtHeight(), dpr);
+          resizeAndPadImage(&image, width, height, dpr);
         }
       }
 
       if (image.isNull())
-        image =
-          createPlaceholderImage(m_placeholder_pixmap, getCoverArtWidth(), getCoverArtHeight(), m_cover_scale, title);
+        image = createPlaceholderImage(placeholder, width, height, scale, title, dpr);
 
       return image;
     });
 
   // Context must be 'this' so we run on the UI thread.
-  future.then(this, [this, path = ge->path](QPixmap pm) {
-    m_cover_pixmap_cache.Insert(std::move(path), std::move(pm));
+  future.then(this, [this, path = ge->path, generation = m_cover_load_generation](QImage image) {
+    if (generation != m_cover_load_generation)
+      return;
+
+    m_cover_pixmap_cache.Insert(path, QPixmap::fromImage(std::move(image)));
     invalidateCoverForPath(path);
   });
 }
@@ -436,20 +516,69 @@ QVariant GameListModel::headerData(int section, Qt::Orientation orientation, int
 void GameListModel::refresh()
 {
   beginResetModel();
+  m_sort_keys_valid = false;
   endResetModel();
 }
 
+std::string GameListModel::makeSortKey(std::string_view str)
+{
+  // Lowercased bytes compare the same way Strcasecmp() did.
+  std::string ret(str);
+  std::transform(ret.begin(), ret.end(), ret.begin(), [](char ch) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+  });
+  return ret;
+}
+
+void GameListModel::ensureSortKeys() const
+{
+  if (m_sort_keys_valid)
+    return;
+
+  const auto lock = GameList::GetLock();
+  const u32 count = GameList::GetEntryCount();
+  m_sort_keys.resize(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    const GameList::Entry* ge = GameList::GetEntryByIndex(i);
+    SortKeys& keys = m_sort_keys[i];
+    keys.title = makeSortKey(ge->title);
+    keys.serial = makeSortKey(ge->serial);
+    keys.file_title = makeSortKey(Path::GetFileTitle(ge->path));
+    keys.genre = makeSortKey(ge->genre);
+    keys.developer = makeSortKey(ge->developer);
+    keys.publisher = makeSortKey(ge->publisher);
+    keys.search_title = QString::fromStdString(ge->title).toCaseFolded();
+    keys.total_size = ge->total_size;
+    keys.release_date = ge->release_date;
+    keys.type = ge->type;
+    keys.region = ge->region;
+    keys.compatibility = ge->compatibility;
+    keys.players = static_cast<u8>((ge->min_players << 4) + ge->max_players);
+  }
+
+  m_sort_keys_valid = true;
+}
+
 bool GameListModel::titlesLessThan(int left_row, int right_row) const
 {
-  if (left_row < 0 || left_row >= static_cast<int>(GameList::GetEntryCount()) || right_row < 0 ||
-      right_row >= static_cast<int>(GameList::GetEntryCount()))
+  ensureSortKeys();
+  if (left_row < 0 || left_row >= static_cast<int>(m_sort_keys.size()) || right_row < 0 ||
+      right_row >= static_cast<int>(m_sort_keys.size()))
   {
     return false;
   }
 
-  const GameList::Entry* left = GameList::GetEntryByIndex(left_row);
-  const GameList::Entry* right = GameList::GetEntryByIndex(right_row);
-  return (StringUtil::Strcasecmp(left->title.c_str(), right->title.c_str()) < 0);
+  return (m_sort_keys[left_row].title < m_sort_keys[right_row].title);
+}
+
+bool GameListModel::titleContains(int row, const QString& folded_search) const
+{
+  ensureSortKeys();
+  if (row < 0 || row >= static_cast<int>(m_sort_keys.size()))
+    return false;
+
+  return m_sort_keys[row].search_title.contains(folded_search, Qt::CaseSensitive);
 }
 
 bool GameListModel::lessThan(const QModelIndex& left_index, const QModelIndex& right_index, int column) const
@@ -457,129 +586,127 @@ bool GameListModel::lessThan(const QModelIndex& left_index, const QModelIndex& r
   if (!left_index.isValid() || !right_index.isValid())
     return false;
 
+  ensureSortKeys();
   const int left_row = left_index.row();
   const int right_row = right_index.row();
-  if (left_row < 0 || left_row >= static_cast<int>(GameList::GetEntryCount()) || right_row < 0 ||
-      right_row >= static_cast<int>(GameList::GetEntryCount()))
+  if (left_row < 0 || left_row >= static_cast<int>(m_sort_keys.size()) || right_row < 0 ||
+      right_row >= static_cast<int>(m_sort_keys.size()))
   {
     return false;
   }
 
-  const auto lock = GameList::GetLock();
-  const GameList::Entry* left = GameList::GetEntryByIndex(left_row);
-  const GameList::Entry* right = GameList::GetEntryByIndex(right_row);
-  if (!left || !right)
-    return false;
+  const SortKeys& left = m_sort_keys[left_row];
+  const SortKeys& right = m_sort_keys[right_row];
 
   switch (column)
   {
     case Column_Type:
     {
-      if (left->type == right->type)
-        return titlesLessThan(left_row, right_row);
+      if (left.type == right.type)
+        return (left.title < right.title);
 
-      return (static_cast<int>(left->type) < static_cast<int>(right->type));
+      return (static_cast<int>(left.type) < static_cast<int>(right.type));
     }
 
     case Column_Serial:
     {
-      if (left->serial == right->serial)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->serial.c_str(), right->serial.c_str()) < 0);
+      if (left.serial == right.serial)
+        return (left.title < right.title);
+      return (left.serial < right.serial);
     }
 
     case Column_Title:
     {
-      return titlesLessThan(left_row, right_row);
+      return (left.title < right.title);
     }
 
     case Column_FileTitle:
     {
-      const std::string_view file_title_left(Path::GetFileTitle(left->path));
-      const std::string_view file_title_right(Path::GetFileTitle(right->path));
-      if (file_title_left == file_title_right)
-        return titlesLessThan(left_row, right_row);
+      if (left.file_title == right.file_title)
+        return (left.title < right.title);
 
-      const std::size_t smallest = std::min(file_title_left.size(), file_title_right.size());
-      return (StringUtil::Strncasecmp(file_title_left.data(), file_title_right.data(), smallest) < 0);
+      const std::size_t smallest = std::min(left.file_title.size(), right.file_title.size());
+      return (left.file_title.compare(0, smallest, right.file_title, 0, smallest) < 0);
     }
 
     case Column_Region:
     {
-      if (left->region == right->region)
-        return titlesLessThan(left_row, right_row);
-      return (static_cast<int>(left->region) < static_cast<int>(right->region));
+      if (left.region == right.region)
+        return (left.title < right.title);
+      return (static_cast<int>(left.region) < static_cast<int>(right.region));
     }
 
     case Column_Compatibility:
     {
-      if (left->compatibility == right->compatibility)
-        return titlesLessThan(left_row, right_row);
+      if (left.compatibility == right.compatibility)
+        return (left.title < right.title);
 
-      return (static_cast<int>(left->compatibility) < static_cast<int>(right->compatibility));
+      return (static_cast<int>(left.compatibility) < static_cast<int>(right.compatibility));
     }
 
     case Column_Size:
     {
-      if (left->total_size == right->total_size)
-        return titlesLessThan(left_row, right_row);
+      if (left.total_size == right.total_size)
+        return (left.title < right.title);
 
-      return (left->total_size < right->total_size);
+      return (left.total_size < right.total_size);
     }
 
     case Column_Genre:
     {
-      if (left->genre == right->genre)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->genre.c_str(), right->genre.c_str()) < 0);
+      if (left.genre == right.genre)
+        return (left.title < right.title);
+      return (left.genre < right.genre);
     }
 
     case Column_Developer:
     {
-      if (left->developer == right->developer)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->developer.c_str(), right->developer.c_str()) < 0);
+      if (left.developer == right.developer)
+        return (left.title < right.title);
+      return (left.developer < right.developer);
     }
 
     case Column_Publisher:
     {
-      if (left->publisher == right->publisher)
-        return titlesLessThan(left_row, right_row);
-      return (StringUtil::Strcasecmp(left->publisher.c_str(), right->publisher.c_str()) < 0);
+      if (left.publisher == right.publisher)
+        return (left.title < right.title);
+      return (left.publisher < right.publisher);
     }
 
     case Column_Year:
     {
-      if (left->release_date == right->release_date)
-        return titlesLessThan(left_row, right_row);
+      if (left.release_date == right.release_date)
+        return (left.title < right.title);
 
-      return (left->release_date < right->release_date);
+      return (left.release_date < right.release_date);
     }
 
     case Column_TimePlayed:
-    {
-      if (left->total_played_time == right->total_played_time)
-        return titlesLessThan(left_row, right_row);
-
-      return (left->total_played_time < right->total_played_time);
-    }
-
     case Column_LastPlayed:
     {
-      if (left->last_played_time == right->last_played_time)
-        return titlesLessThan(left_row, right_row);
-
-      return (left->last_played_time < right->last_played_time);
+      // Played times change while the list is shown without a refresh, so these are read from the entries.
+      const auto lock = GameList::GetLock();
+      const GameList::Entry* left_entry = GameList::GetEntryByIndex(left_row);
+      const GameList::Entry* right_entry = GameList::GetEntryByIndex(right_row);
+      if (!left_entry || !right_entry)
+        return false;
+
+      const std::time_t left_time =
+        (column == Column_TimePlayed) ? left_entry->total_played_time : left_entry->last_played_time;
+      const std::time_t right_time =
+        (column == Column_TimePlayed) ? right_entry->total_played_time : right_entry->last_played_time;
+      if (left_time == right_time)
+        return (left.title < right.title);
+
+      return (left_time < right_time);
     }
 
     case Column_Players:
     {
-      u8 left_players = (left->min_players << 4) + left->max_players;
-      u8 right_players = (right->min_players << 4) + right->max_players;
-      if (left_players == right_players)
-        return titlesLessThan(left_row, right_row);
+      if (left.players == right.players)
+        return (left.title < right.title);
 
-      return (left_players < right_players);
+      return (left.players < right.players);
     }
 
     default:
@@ -606,7 +733,7 @@ void GameListModel::loadCommonImages()
       QtUtils::GetIconForCompatibility(static_cast<GameDatabase::CompatibilityRating>(i)).pixmap(96, 24);
   }
 
-  m_placeholder_pixmap.load(QStringLiteral("%1/images/cover-placeholder.png").arg(QtHost::GetResourcesBasePath()));
+  m_placeholder_image.load(QStringLiteral("%1/images/cover-placeholder.png").arg(QtHost::GetResourcesBasePath()));
 }
 
 void GameListModel::setColumnDisplayNames()
@@ -11,10 +11,15 @@
 #include "common/lru_cache.h"
 
 #include <QtCore/QAbstractTableModel>
+#include <QtCore/QThreadPool>
+#include <QtGui/QImage>
 #include <QtGui/QPixmap>
 #include <algorithm>
 #include <array>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 class GameListModel final : public QAbstractTableModel
 {
@@ -62,6 +67,9 @@ public:
 
   bool lessThan(const QModelIndex& left_index, const QModelIndex& right_index, int column) const;
 
+  /// Returns true if the row's title contains the search string, which must already be case folded.
+  bool titleContains(int row, const QString& folded_search) const;
+
   bool getShowCoverTitles() const { return m_show_titles_for_covers; }
   void setShowCoverTitles(bool enabled) { m_show_titles_for_covers = enabled; }
 
@@ -77,9 +85,32 @@ Q_SIGNALS:
   void coverScaleChanged();
 
 private:
+  /// Copies of the entry fields used for sorting and filtering, normalized once per refresh, so comparisons don't need
+  /// the game list lock or any case conversion.
+  struct SortKeys
+  {
+    std::string title;
+    std::string serial;
+    std::string file_title;
+    std::string genre;
+    std::string developer;
+    std::string publisher;
+    QString search_title;
+    u64 total_size;
+    u64 release_date;
+    GameList::EntryType type;
+    DiscRegion region;
+    GameDatabase::CompatibilityRating compatibility;
+    u8 players;
+  };
+
+  void ensureSortKeys() const;
+  static std::string makeSortKey(std::string_view str);
+
   void loadCommonImages();
   void loadThemeSpecificImages();
   void setColumnDisplayNames();
+  void cancelCoverLoads();
   void loadOrGenerateCover(const GameList::Entry* ge);
   void invalidateCoverForPath(const std::string& path);
 
@@ -91,8 +122,14 @@ private:
   std::array<QPixmap, static_cast<int>(DiscRegion::Count)> m_region_pixmaps;
   std::array<QPixmap, static_cast<int>(GameDatabase::CompatibilityRating::Count)> m_compatibility_pixmaps;
 
-  QPixmap m_placeholder_pixmap;
+  QImage m_placeholder_image;
   QPixmap m_loading_pixmap;
 
   mutable LRUCache<std::string, QPixmap> m_cover_pixmap_cache;
+
+  mutable std::vector<SortKeys> m_sort_keys;
+  mutable bool m_sort_keys_valid = false;
+
+  QThreadPool m_cover_load_pool;
+  u32 m_cover_load_generation = 0;
 };
\ No newline at end of file
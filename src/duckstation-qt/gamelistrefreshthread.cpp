@@ -92,7 +92,13 @@ void AsyncRefreshProgressCallback::fireUpdate()
 }
 
 GameListRefreshThread::GameListRefreshThread(bool invalidate_cache)
-  : QThread(), m_progress(this), m_invalidate_cache(invalidate_cache)
+  : QThread(), m_progress(this), m_invalidate_cache(invalidate_cache), m_incremental(false)
+{
+}
+
+GameListRefreshThread::GameListRefreshThread(std::vector<std::string> changed_dirs, std::vector<std::string> known_dirs)
+  : QThread(), m_progress(this), m_changed_dirs(std::move(changed_dirs)), m_known_dirs(std::move(known_dirs)),
+    m_invalidate_cache(false), m_incremental(true)
 {
 }
 
@@ -105,6 +111,10 @@ void GameListRefreshThread::cancel()
 
 void GameListRefreshThread::run()
 {
-  GameList::Refresh(m_invalidate_cache, false, &m_progress);
+  if (m_incremental)
+    m_watch_dirs = GameList::RefreshDirectories(m_changed_dirs, m_known_dirs, &m_progress);
+  else
+    GameList::Refresh(m_invalidate_cache, false, &m_progress, &m_watch_dirs);
+
   emit refreshComplete();
 }
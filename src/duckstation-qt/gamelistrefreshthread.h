@@ -9,6 +9,9 @@
 #include "common/progress_callback.h"
 #include "common/timer.h"
 
+#include <string>
+#include <vector>
+
 class GameListRefreshThread;
 
 class AsyncRefreshProgressCallback : public BaseProgressCallback
@@ -46,8 +49,17 @@ class GameListRefreshThread final : public QThread
 
 public:
   GameListRefreshThread(bool invalidate_cache);
+
+  /// Only rescans directories which have changed. known_dirs are the directories already being watched.
+  GameListRefreshThread(std::vector<std::string> changed_dirs, std::vector<std::string> known_dirs);
+
   ~GameListRefreshThread();
 
+  ALWAYS_INLINE bool isIncremental() const { return m_incremental; }
+
+  /// Directories which should be watched for changes, once the refresh has completed.
+  ALWAYS_INLINE const std::vector<std::string>& getWatchDirectories() const { return m_watch_dirs; }
+
   void cancel();
 
 Q_SIGNALS:
@@ -59,5 +71,9 @@ protected:
 
 private:
   AsyncRefreshProgressCallback m_progress;
+  std::vector<std::string> m_changed_dirs;
+  std::vector<std::string> m_known_dirs;
+  std::vector<std::string> m_watch_dirs;
   bool m_invalidate_cache;
+  bool m_incremental;
 };
@@ -12,8 +12,10 @@
 #include "core/settings.h"
 
 #include "common/assert.h"
+#include "common/log.h"
 #include "common/string_util.h"
 
+#include <QtCore/QDir>
 #include <QtCore/QSortFilterProxyModel>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QPixmap>
@@ -22,15 +24,21 @@
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QScrollBar>
 
+Log_SetChannel(GameListWidget);
+
 static constexpr float MIN_SCALE = 0.1f;
 static constexpr float MAX_SCALE = 2.0f;
 
+// Copying a game raises a burst of changes, so wait for them to settle before rescanning.
+static constexpr int DIRECTORY_CHANGE_DELAY_MS = 1000;
+
 static const char* SUPPORTED_FORMATS_STRING =
   QT_TRANSLATE_NOOP(GameListWidget, ".cue (Cue Sheets)\n"
                                     ".iso/.img (Single Track Image)\n"
                                     ".ecm (Error Code Modeling Image)\n"
                                     ".mds (Media Descriptor Sidecar)\n"
                                     ".chd (Compressed Hunks of Data)\n"
+                                    ".zcd (Seekable Zstandard Compressed Disc)\n"
                                     ".pbp (PlayStation Portable, Only Decrypted)");
 
 class GameListSortModel final : public QSortFilterProxyModel
@@ -50,13 +58,13 @@ public:
   }
   void setFilterName(const QString& name)
   {
-    m_filter_name = name;
+    m_filter_name = name.toCaseFolded();
     invalidateRowsFilter();
   }
 
   bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override
   {
-    if (m_filter_type != GameList::EntryType::Count || m_filter_region != DiscRegion::Count || !m_filter_name.isEmpty())
+    if (m_filter_type != GameList::EntryType::Count || m_filter_region != DiscRegion::Count)
     {
       const auto lock = GameList::GetLock();
       const GameList::Entry* entry = GameList::GetEntryByIndex(source_row);
@@ -64,11 +72,12 @@ public:
         return false;
       if (m_filter_region != DiscRegion::Count && entry->region != m_filter_region)
         return false;
-      if (!m_filter_name.isEmpty() &&
-          !QString::fromStdString(entry->title).contains(m_filter_name, Qt::CaseInsensitive))
-        return false;
     }
 
+    // Titles are folded once per refresh, rather than converted for every row on every keystroke.
+    if (!m_filter_name.isEmpty() && !m_model->titleContains(source_row, m_filter_name))
+      return false;
+
     return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
   }
 
@@ -191,6 +200,13 @@ void GameListWidget::initialize()
   connect(m_empty_ui.scanForNewGames, &QPushButton::clicked, this, [this]() { refresh(false); });
   m_ui.stack->insertWidget(2, m_empty_widget);
 
+  m_directory_watcher = new QFileSystemWatcher(this);
+  connect(m_directory_watcher, &QFileSystemWatcher::directoryChanged, this, &GameListWidget::onDirectoryChanged);
+  m_directory_change_timer = new QTimer(this);
+  m_directory_change_timer->setSingleShot(true);
+  m_directory_change_timer->setInterval(DIRECTORY_CHANGE_DELAY_MS);
+  connect(m_directory_change_timer, &QTimer::timeout, this, &GameListWidget::onDirectoryChangeTimerExpired);
+
   if (Host::GetBaseBoolSettingValue("UI", "GameListGridView", false))
     m_ui.stack->setCurrentIndex(1);
   else
@@ -219,6 +235,9 @@ void GameListWidget::refresh(bool invalidate_cache)
 {
   cancelRefresh();
 
+  // The directories might have changed, the full scan will tell us what to watch afterwards.
+  stopWatchingDirectories();
+
   m_refresh_thread = new GameListRefreshThread(invalidate_cache);
   connect(m_refresh_thread, &GameListRefreshThread::refreshProgress, this, &GameListWidget::onRefreshProgress,
           Qt::QueuedConnection);
@@ -255,17 +274,87 @@ void GameListWidget::onRefreshProgress(const QString& status, int current, int t
 
 void GameListWidget::onRefreshComplete()
 {
-  m_model->refresh();
-  emit refreshComplete();
-
   AssertMsg(m_refresh_thread, "Has a refresh thread");
   m_refresh_thread->wait();
+
+  const bool incremental = m_refresh_thread->isIncremental();
+  watchDirectories(m_refresh_thread->getWatchDirectories());
   delete m_refresh_thread;
   m_refresh_thread = nullptr;
 
+  m_model->refresh();
+  if (!incremental)
+    emit refreshComplete();
+
   // if we still had no games, switch to the helper widget
   if (m_model->rowCount() == 0)
     m_ui.stack->setCurrentIndex(2);
+  else if (m_ui.stack->currentIndex() == 2)
+    m_ui.stack->setCurrentIndex(Host::GetBaseBoolSettingValue("UI", "GameListGridView", false) ? 1 : 0);
+}
+
+void GameListWidget::watchDirectories(const std::vector<std::string>& dirs)
+{
+  if (dirs.empty())
+    return;
+
+  QStringList paths;
+  paths.reserve(static_cast<qsizetype>(dirs.size()));
+  for (const std::string& dir : dirs)
+    paths.append(QString::fromStdString(dir));
+
+  // Most likely hit the system's watch limit. Changes in directories which aren't watched would be missed, so only
+  // picking up some of them would be more confusing than not at all, manual refreshes still work as before.
+  const QStringList failed_paths = m_directory_watcher->addPaths(paths);
+  if (!failed_paths.isEmpty())
+  {
+    Log_WarningPrintf("Failed to watch %d of %zu game directories, changes will not be picked up automatically.",
+                      static_cast<int>(failed_paths.size()), dirs.size());
+    stopWatchingDirectories();
+  }
+}
+
+void GameListWidget::stopWatchingDirectories()
+{
+  const QStringList watched_paths = m_directory_watcher->directories();
+  if (!watched_paths.isEmpty())
+    m_directory_watcher->removePaths(watched_paths);
+
+  m_directory_change_timer->stop();
+  m_changed_directories.clear();
+}
+
+void GameListWidget::onDirectoryChanged(const QString& path)
+{
+  std::string dir = QDir::toNativeSeparators(path).toStdString();
+  if (std::find(m_changed_directories.begin(), m_changed_directories.end(), dir) == m_changed_directories.end())
+    m_changed_directories.push_back(std::move(dir));
+
+  m_directory_change_timer->start();
+}
+
+void GameListWidget::onDirectoryChangeTimerExpired()
+{
+  if (m_changed_directories.empty())
+    return;
+
+  // Try again once the current refresh has finished.
+  if (m_refresh_thread)
+  {
+    m_directory_change_timer->start();
+    return;
+  }
+
+  std::vector<std::string> known_dirs;
+  for (const QString& path : m_directory_watcher->directories())
+    known_dirs.push_back(QDir::toNativeSeparators(path).toStdString());
+
+  Log_DevPrintf("Rescanning %zu changed game directories", m_changed_directories.size());
+  m_refresh_thread = new GameListRefreshThread(std::move(m_changed_directories), std::move(known_dirs));
+  m_changed_directories = {};
+  connect(m_refresh_thread, &GameListRefreshThread::refreshComplete, this, &GameListWidget::onRefreshComplete,
+          Qt::QueuedConnection);
+  m_refresh_thread->start();
 }
 
 void GameListWidget::onSelectionModelCurrentChanged(const QModelIndex& current, const QModelIndex& previous)
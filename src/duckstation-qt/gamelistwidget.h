@@ -7,6 +7,8 @@
 
 #include "core/game_list.h"
 
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QTimer>
 #include <QtWidgets/QListView>
 #include <QtWidgets/QTableView>
 
@@ -68,6 +70,8 @@ Q_SIGNALS:
 private Q_SLOTS:
   void onRefreshProgress(const QString& status, int current, int total);
   void onRefreshComplete();
+  void onDirectoryChanged(const QString& path);
+  void onDirectoryChangeTimerExpired();
 
   void onSelectionModelCurrentChanged(const QModelIndex& current, const QModelIndex& previous);
   void onTableViewItemActivated(const QModelIndex& index);
@@ -98,6 +102,8 @@ private:
   void saveTableViewColumnSortSettings();
   void listZoom(float delta);
   void updateToolbar();
+  void watchDirectories(const std::vector<std::string>& dirs);
+  void stopWatchingDirectories();
 
   Ui::GameListWidget m_ui;
 
@@ -110,4 +116,9 @@ private:
   Ui::EmptyGameListWidget m_empty_ui;
 
   GameListRefreshThread* m_refresh_thread = nullptr;
+
+  // Changes are batched up, then only the affected directories are rescanned.
+  QFileSystemWatcher* m_directory_watcher = nullptr;
+  QTimer* m_directory_change_timer = nullptr;
+  std::vector<std::string> m_changed_directories;
 };
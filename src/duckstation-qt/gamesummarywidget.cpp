@@ -233,25 +233,16 @@ void GameSummaryWidget::onComputeHashClicked()
   track_hashes.reserve(image->GetTrackCount());
 
   // Calculate hashes
-  bool calculate_hash_success = true;
-  for (u8 track = 1; track <= image->GetTrackCount(); track++)
+  progress_callback.PushState();
+  const bool calculate_hash_success = CDImageHasher::GetTrackHashes(image.get(), &track_hashes, &progress_callback);
+  progress_callback.PopState();
+  if (calculate_hash_success)
   {
-    progress_callback.SetProgressValue(track - 1);
-    progress_callback.PushState();
-
-    CDImageHasher::Hash hash;
-    if (!CDImageHasher::GetTrackHash(image.get(), track, &hash, &progress_callback))
+    for (size_t i = 0; i < track_hashes.size(); i++)
     {
-      progress_callback.PopState();
-      calculate_hash_success = false;
-      break;
+      QTableWidgetItem* item = m_ui.tracks->item(static_cast<int>(i), 4);
+      item->setText(QString::fromStdString(CDImageHasher::HashToString(track_hashes[i])));
     }
-    track_hashes.emplace_back(hash);
-
-    QTableWidgetItem* item = m_ui.tracks->item(track - 1, 4);
-    item->setText(QString::fromStdString(CDImageHasher::HashToString(hash)));
-
-    progress_callback.PopState();
   }
 
   // Verify hashes against gamedb
@@ -9,7 +9,6 @@
 #include "util/host.h"
 
 #include <QtCore/QLatin1StringView>
-#include <QtCore/QUtf8StringView>
 #include <QtGui/QIcon>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QScrollBar>
@@ -17,13 +16,19 @@
 LogWindow* g_log_window;
 
 LogWindow::LogWindow(bool attach_to_main)
-  : QMainWindow(), m_filter_names(Settings::GetLogFilters()), m_attached_to_main_window(attach_to_main)
+  : QMainWindow(), m_filter_names(Settings::GetLogFilters()),
+    m_pending_messages(std::make_unique<std::array<PendingMessage, PENDING_MESSAGE_COUNT>>()),
+    m_attached_to_main_window(attach_to_main)
 {
   // TODO: probably should save the size..
   resize(700, 400);
 
   createUi();
 
+  m_flush_timer = new QTimer(this);
+  connect(m_flush_timer, &QTimer::timeout, this, &LogWindow::flushPendingMessages);
+  m_flush_timer->start(FLUSH_INTERVAL_MS);
+
   Log::RegisterCallback(&LogWindow::logCallback, this);
 }
 
@@ -164,6 +169,7 @@ void LogWindow::createUi()
   m_text->setUndoRedoEnabled(false);
   m_text->setTextInteractionFlags(Qt::TextSelectableByKeyboard);
   m_text->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+  m_text->setMaximumBlockCount(MAX_LINES);
 
 #ifndef _WIN32
   QFont font("Monospace");
@@ -242,6 +248,9 @@ void LogWindow::setChannelFiltered(size_t index, bool enabled)
 
 void LogWindow::onClearTriggered()
 {
+  // Anything still waiting would have been logged before the clear, so it goes too.
+  m_pending_read_pos.store(m_pending_write_pos.load(std::memory_order_acquire), std::memory_order_release);
+  m_dropped_messages.store(0, std::memory_order_relaxed);
   m_text->clear();
 }
 
@@ -258,10 +267,14 @@ void LogWindow::onSaveTriggered()
     return;
   }
 
+  flushPendingMessages();
   file.write(m_text->toPlainText().toUtf8());
   file.close();
 
-  appendMessage(QLatin1StringView("LogWindow"), LOGLEVEL_INFO, tr("Log was written to %1.\n").arg(path));
+  QTextCursor cursor(m_text->document());
+  cursor.movePosition(QTextCursor::End);
+  appendMessage(cursor, "LogWindow", LOGLEVEL_INFO, Log::GetCurrentMessageTime(),
+                tr("Log was written to %1.\n").arg(path).toStdString());
 }
 
 void LogWindow::logCallback(void* pUserParam, const char* channelName, const char* functionName, LOGLEVEL level,
@@ -269,26 +282,22 @@ void LogWindow::logCallback(void* pUserParam, const char* channelName, const cha
 {
   LogWindow* this_ptr = static_cast<LogWindow*>(pUserParam);
 
-  // TODO: Split message based on lines.
-  // I don't like the memory allocations here either...
-
-  QString qmessage;
-  qmessage.reserve(message.length() + 1);
-  qmessage.append(QUtf8StringView(message.data(), message.length()));
-  qmessage.append(QChar('\n'));
-
-  const QLatin1StringView qchannel((level <= LOGLEVEL_PERF) ? functionName : channelName);
-
-  if (g_emu_thread->isOnUIThread())
+  // Drop rather than wait when the UI can't keep up, the count is reported with the next flush.
+  const u32 write_pos = this_ptr->m_pending_write_pos.load(std::memory_order_relaxed);
+  if ((write_pos - this_ptr->m_pending_read_pos.load(std::memory_order_acquire)) >= PENDING_MESSAGE_COUNT)
   {
-    this_ptr->appendMessage(qchannel, level, qmessage);
-  }
-  else
-  {
-    QMetaObject::invokeMethod(this_ptr, "appendMessage", Qt::QueuedConnection,
-                              Q_ARG(const QLatin1StringView&, qchannel), Q_ARG(quint32, static_cast<u32>(level)),
-                              Q_ARG(const QString&, qmessage));
+    this_ptr->m_dropped_messages.fetch_add(1, std::memory_order_relaxed);
+    return;
   }
+
+  // Channel and function names are static strings, and the message strings keep their capacity once the ring wraps.
+  PendingMessage& pm = (*this_ptr->m_pending_messages)[write_pos % PENDING_MESSAGE_COUNT];
+  pm.channel = (level <= LOGLEVEL_PERF) ? functionName : channelName;
+  pm.level = level;
+  pm.time = Log::GetCurrentMessageTime();
+  pm.message.assign(message);
+  pm.message.push_back('\n');
+  this_ptr->m_pending_write_pos.store(write_pos + 1, std::memory_order_release);
 }
 
 void LogWindow::closeEvent(QCloseEvent* event)
@@ -297,56 +306,39 @@ void LogWindow::closeEvent(QCloseEvent* event)
   QMainWindow::closeEvent(event);
 }
 
-void LogWindow::appendMessage(const QLatin1StringView& channel, quint32 level, const QString& message)
+void LogWindow::flushPendingMessages()
 {
+  const u32 write_pos = m_pending_write_pos.load(std::memory_order_acquire);
+  u32 read_pos = m_pending_read_pos.load(std::memory_order_relaxed);
+  const u32 dropped = m_dropped_messages.exchange(0, std::memory_order_relaxed);
+  if (read_pos == write_pos && dropped == 0)
+    return;
+
   QTextCursor temp_cursor = m_text->textCursor();
   QScrollBar* scrollbar = m_text->verticalScrollBar();
   const bool cursor_at_end = temp_cursor.atEnd();
   const bool scroll_at_end = scrollbar->sliderPosition() == scrollbar->maximum();
 
+  // One edit block for the whole batch, so the document only lays out and repaints once per flush.
   temp_cursor.movePosition(QTextCursor::End);
+  temp_cursor.beginEditBlock();
 
+  for (; read_pos != write_pos; read_pos++)
   {
-    static constexpr const QChar level_characters[LOGLEVEL_COUNT] = {'X', 'E', 'W', 'P', 'I', 'V', 'D', 'R', 'B', 'T'};
-    static constexpr const QColor level_colors[LOGLEVEL_COUNT] = {
-      QColor(255, 255, 255),    // NONE
-      QColor(0xE7, 0x48, 0x56), // ERROR, Red Intensity
-      QColor(0xF9, 0xF1, 0xA5), // WARNING, Yellow Intensity
-      QColor(0xB4, 0x00, 0x9E), // PERF, Purple Intensity
-      QColor(0xF2, 0xF2, 0xF2), // INFO, White Intensity
-      QColor(0x16, 0xC6, 0x0C), // VERBOSE, Green Intensity
-      QColor(0xCC, 0xCC, 0xCC), // DEV, White
-      QColor(0x61, 0xD6, 0xD6), // PROFILE, Cyan Intensity
-      QColor(0x13, 0xA1, 0x0E), // DEBUG, Green
-      QColor(0x00, 0x37, 0xDA), // TRACE, Blue
-    };
-    static constexpr const QColor timestamp_color = QColor(0xcc, 0xcc, 0xcc);
-    static constexpr const QColor channel_color = QColor(0xf2, 0xf2, 0xf2);
-
-    QTextCharFormat format = temp_cursor.charFormat();
-
-    if (g_settings.log_timestamps)
-    {
-      const float message_time = Log::GetCurrentMessageTime();
-      const QString qtimestamp = QStringLiteral("[%1] ").arg(message_time, 10, 'f', 4);
-      format.setForeground(QBrush(timestamp_color));
-      temp_cursor.setCharFormat(format);
-      temp_cursor.insertText(qtimestamp);
-    }
+    const PendingMessage& pm = (*m_pending_messages)[read_pos % PENDING_MESSAGE_COUNT];
+    appendMessage(temp_cursor, pm.channel, pm.level, pm.time, pm.message);
+  }
+  m_pending_read_pos.store(read_pos, std::memory_order_release);
 
-    const QString qchannel = (level <= LOGLEVEL_PERF) ?
-                               QStringLiteral("%1(%2): ").arg(level_characters[level]).arg(channel) :
-                               QStringLiteral("%1/%2: ").arg(level_characters[level]).arg(channel);
-    format.setForeground(QBrush(channel_color));
-    temp_cursor.setCharFormat(format);
-    temp_cursor.insertText(qchannel);
-
-    // message has \n already
-    format.setForeground(QBrush(level_colors[level]));
-    temp_cursor.setCharFormat(format);
-    temp_cursor.insertText(message);
+  if (dropped > 0)
+  {
+    const QString qmessage =
+      tr("%n message(s) were dropped because the log window could not keep up.\n", "", static_cast<int>(dropped));
+    appendMessage(temp_cursor, "LogWindow", LOGLEVEL_WARNING, Log::GetCurrentMessageTime(), qmessage.toStdString());
   }
 
+  temp_cursor.endEditBlock();
+
   if (cursor_at_end)
   {
     if (scroll_at_end)
@@ -363,3 +355,46 @@ void LogWindow::appendMessage(const QLatin1StringView& channel, quint32 level, c
     }
   }
 }
+
+void LogWindow::appendMessage(QTextCursor& cursor, const char* channel, LOGLEVEL level, float time,
+                              const std::string_view& message)
+{
+  static constexpr const QChar level_characters[LOGLEVEL_COUNT] = {'X', 'E', 'W', 'P', 'I', 'V', 'D', 'R', 'B', 'T'};
+  static constexpr const QColor level_colors[LOGLEVEL_COUNT] = {
+    QColor(255, 255, 255),    // NONE
+    QColor(0xE7, 0x48, 0x56), // ERROR, Red Intensity
+    QColor(0xF9, 0xF1, 0xA5), // WARNING, Yellow Intensity
+    QColor(0xB4, 0x00, 0x9E), // PERF, Purple Intensity
+    QColor(0xF2, 0xF2, 0xF2), // INFO, White Intensity
+    QColor(0x16, 0xC6, 0x0C), // VERBOSE, Green Intensity
+    QColor(0xCC, 0xCC, 0xCC), // DEV, White
+    QColor(0x61, 0xD6, 0xD6), // PROFILE, Cyan Intensity
+    QColor(0x13, 0xA1, 0x0E), // DEBUG, Green
+    QColor(0x00, 0x37, 0xDA), // TRACE, Blue
+  };
+  static constexpr const QColor timestamp_color = QColor(0xcc, 0xcc, 0xcc);
+  static constexpr const QColor channel_color = QColor(0xf2, 0xf2, 0xf2);
+
+  QTextCharFormat format = cursor.charFormat();
+
+  if (g_settings.log_timestamps)
+  {
+    const QString qtimestamp = QStringLiteral("[%1] ").arg(time, 10, 'f', 4);
+    format.setForeground(QBrush(timestamp_color));
+    cursor.setCharFormat(format);
+    cursor.insertText(qtimestamp);
+  }
+
+  const QLatin1StringView qchannel_name(channel);
+  const QString qchannel = (level <= LOGLEVEL_PERF) ?
+                             QStringLiteral("%1(%2): ").arg(level_characters[level]).arg(qchannel_name) :
+                             QStringLiteral("%1/%2: ").arg(level_characters[level]).arg(qchannel_name);
+  format.setForeground(QBrush(channel_color));
+  cursor.setCharFormat(format);
+  cursor.insertText(qchannel);
+
+  // message has \n already
+  format.setForeground(QBrush(level_colors[level]));
+  cursor.setCharFormat(format);
+  cursor.insertText(QString::fromUtf8(message.data(), static_cast<qsizetype>(message.size())));
+}
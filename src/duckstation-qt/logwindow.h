@@ -5,9 +5,14 @@
 
 #include "common/log.h"
 
+#include <QtCore/QTimer>
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QPlainTextEdit>
+#include <array>
+#include <atomic>
+#include <memory>
 #include <span>
+#include <string>
 
 class LogWindow : public QMainWindow
 {
@@ -25,6 +30,20 @@ public:
   void updateWindowTitle();
 
 private:
+  /// Messages from the log callback wait here until the next flush. The callback is only ever run by one thread at a
+  /// time, under the log lock, so a single producer ring is enough, and the emulation thread never waits on the UI.
+  static constexpr u32 PENDING_MESSAGE_COUNT = 4096;
+  static constexpr int FLUSH_INTERVAL_MS = 100;
+  static constexpr int MAX_LINES = 10000;
+
+  struct PendingMessage
+  {
+    const char* channel;
+    LOGLEVEL level;
+    float time;
+    std::string message;
+  };
+
   void createUi();
   void updateLogLevelUi();
   void setLogLevel(LOGLEVEL level);
@@ -40,13 +59,22 @@ protected:
 private Q_SLOTS:
   void onClearTriggered();
   void onSaveTriggered();
-  void appendMessage(const QLatin1StringView& channel, quint32 level, const QString& message);
+  void flushPendingMessages();
 
 private:
+  void appendMessage(QTextCursor& cursor, const char* channel, LOGLEVEL level, float time,
+                     const std::string_view& message);
+
   QPlainTextEdit* m_text;
   QMenu* m_level_menu;
+  QTimer* m_flush_timer;
   std::span<const char*> m_filter_names;
 
+  std::unique_ptr<std::array<PendingMessage, PENDING_MESSAGE_COUNT>> m_pending_messages;
+  std::atomic<u32> m_pending_write_pos{0};
+  std::atomic<u32> m_pending_read_pos{0};
+  std::atomic<u32> m_dropped_messages{0};
+
   bool m_attached_to_main_window = true;
 };
 
@@ -15,6 +15,7 @@
 #include "logwindow.h"
 #include "memorycardeditordialog.h"
 #include "qthost.h"
+#include "qtprogresscallback.h"
 #include "qtutils.h"
 #include "settingswindow.h"
 #include "settingwidgetbinder.h"
@@ -27,9 +28,11 @@
 #include "core/system.h"
 
 #include "util/cd_image.h"
+#include "util/cd_image_converter.h"
 #include "util/gpu_device.h"
 
 #include "common/assert.h"
+#include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
 
@@ -61,9 +64,10 @@ Log_SetChannel(MainWindow);
 
 static constexpr char DISC_IMAGE_FILTER[] = QT_TRANSLATE_NOOP(
   "MainWindow",
-  "All File Types (*.bin *.img *.iso *.cue *.chd *.ecm *.mds *.pbp *.exe *.psexe *.ps-exe *.psf *.minipsf "
+  "All File Types (*.bin *.img *.iso *.cue *.chd *.zcd *.ecm *.mds *.pbp *.exe *.psexe *.ps-exe *.psf *.minipsf "
   "*.m3u);;Single-Track "
-  "Raw Images (*.bin *.img *.iso);;Cue Sheets (*.cue);;MAME CHD Images (*.chd);;Error Code Modeler Images "
+  "Raw Images (*.bin *.img *.iso);;Cue Sheets (*.cue);;MAME CHD Images (*.chd);;Zstandard Compressed Disc Images "
+  "(*.zcd);;Error Code Modeler Images "
   "(*.ecm);;Media Descriptor Sidecar Images (*.mds);;PlayStation EBOOTs (*.pbp *.PBP);;PlayStation Executables (*.exe "
   "*.psexe *.ps-exe);;Portable Sound Format Files (*.psf *.minipsf);;Playlists (*.m3u)");
 
@@ -1403,6 +1407,12 @@ void MainWindow::onGameListEntryContextMenuRequested(const QPoint& point)
     connect(menu.addAction(tr("Set Cover Image...")), &QAction::triggered,
             [this, entry]() { setGameListEntryCoverImage(entry); });
 
+    if (entry->type == GameList::EntryType::Disc && CDImageConverter::IsConvertibleImage(entry->path))
+    {
+      connect(menu.addAction(tr("Convert to ZCD...")), &QAction::triggered,
+              [this, path = entry->path]() { convertGameListEntry(path); });
+    }
+
     menu.addSeparator();
 
     if (!s_system_valid)
@@ -1457,6 +1467,9 @@ void MainWindow::onGameListEntryContextMenuRequested(const QPoint& point)
   connect(menu.addAction(tr("Add Search Directory...")), &QAction::triggered,
           [this]() { getSettingsDialog()->getGameListSettingsWidget()->addSearchDirectory(this); });
 
+  connect(menu.addAction(tr("Convert Directory to ZCD...")), &QAction::triggered,
+          [this]() { convertGameListDirectory(); });
+
   menu.exec(point);
 }
 
@@ -1521,6 +1534,63 @@ void MainWindow::clearGameListEntryPlayTime(const GameList::Entry* entry)
   m_game_list_widget->refresh(false);
 }
 
+void MainWindow::convertGameListEntry(const std::string& path)
+{
+  const std::string output_path = CDImageConverter::GetOutputPath(path);
+  if (FileSystem::FileExists(output_path.c_str()))
+  {
+    QMessageBox::critical(this, tr("Conversion Error"),
+                          tr("'%1' already exists.").arg(QString::fromStdString(output_path)));
+    return;
+  }
+
+  QtModalProgressCallback progress(this);
+  progress.SetTitle(tr("Converting Disc Image").toUtf8().constData());
+  progress.SetCancellable(true);
+
+  Error error;
+  if (!CDImageConverter::ConvertImage(path.c_str(), output_path.c_str(), CDImageConverter::Options(), &progress,
+                                      &error))
+  {
+    if (!progress.IsCancelled())
+    {
+      QMessageBox::critical(this, tr("Conversion Error"),
+                            tr("Failed to convert '%1':\n%2")
+                              .arg(QString::fromStdString(path))
+                              .arg(QString::fromStdString(error.GetDescription())));
+    }
+
+    return;
+  }
+
+  QMessageBox::information(this, tr("Conversion Complete"),
+                           tr("'%1' was converted and verified, the original image can now be removed.")
+                             .arg(QString::fromStdString(output_path)));
+  refreshGameList(false);
+}
+
+void MainWindow::convertGameListDirectory()
+{
+  const QString dir =
+    QDir::toNativeSeparators(QFileDialog::getExistingDirectory(this, tr("Select Directory To Convert")));
+  if (dir.isEmpty())
+    return;
+
+  QtModalProgressCallback progress(this);
+  progress.SetTitle(tr("Converting Disc Images").toUtf8().constData());
+  progress.SetCancellable(true);
+
+  u32 failed = 0;
+  const u32 converted = CDImageConverter::ConvertDirectory(dir.toUtf8().constData(), true, CDImageConverter::Options(),
+                                                           &progress, &failed);
+
+  QMessageBox::information(this, tr("Conversion Complete"),
+                           tr("%1 images were converted, %2 failed. Failures are listed in the log.")
+                             .arg(converted)
+                             .arg(failed));
+  refreshGameList(false);
+}
+
 void MainWindow::setupAdditionalUi()
 {
   const bool status_bar_visible = Host::GetBaseBoolSettingValue("UI", "ShowStatusBar", true);
@@ -2064,12 +2134,20 @@ void MainWindow::connectSignals()
                                                "DumpCPUToVRAMCopies", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(nullptr, m_ui.actionDebugDumpVRAMtoCPUCopies, "Debug",
                                                "DumpVRAMToCPUCopies", false);
+  SettingWidgetBinder::BindWidgetToBoolSetting(nullptr, m_ui.actionDebugDumpGPUTimings, "Debug", "DumpGPUTimings",
+                                               false);
   connect(m_ui.actionDumpAudio, &QAction::toggled, [](bool checked) {
     if (checked)
       g_emu_thread->startDumpingAudio();
     else
       g_emu_thread->stopDumpingAudio();
   });
+  connect(m_ui.actionCaptureVideo, &QAction::toggled, [](bool checked) {
+    if (checked)
+      g_emu_thread->startMediaCapture();
+    else
+      g_emu_thread->stopMediaCapture();
+  });
   connect(m_ui.actionDumpRAM, &QAction::triggered, [this]() {
     const QString filename =
       QFileDialog::getSaveFileName(this, tr("Destination File"), QString(), tr("Binary Files (*.bin)"));
@@ -239,6 +239,8 @@ private:
   std::string getDeviceDiscPath(const QString& title);
   void setGameListEntryCoverImage(const GameList::Entry* entry);
   void clearGameListEntryPlayTime(const GameList::Entry* entry);
+  void convertGameListEntry(const std::string& path);
+  void convertGameListDirectory();
   void setTheme(const QString& theme);
   void updateTheme();
   void reloadThemeSpecificImages();
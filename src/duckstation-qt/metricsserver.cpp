@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "metricsserver.h"
+#include "common/log.h"
+#include "core/performance_metrics.h"
+#include <QtNetwork/QTcpSocket>
+Log_SetChannel(MetricsServer);
+
+// Requests are a single line with a few headers, anything larger isn't a scrape.
+static constexpr qint64 MAX_REQUEST_SIZE = 8192;
+
+MetricsServer::MetricsServer(QObject* parent) : QTcpServer(parent)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+  stop();
+}
+
+void MetricsServer::start(quint16 port)
+{
+  if (isListening())
+    return;
+
+  if (!listen(QHostAddress::LocalHost, port))
+  {
+    Log_ErrorPrintf("Failed to listen on TCP port %u for metrics server: %s", port,
+                    errorString().toUtf8().constData());
+    return;
+  }
+
+  Log_InfoPrintf("Metrics server listening on TCP port %u", port);
+}
+
+void MetricsServer::stop()
+{
+  if (isListening())
+  {
+    close();
+    Log_InfoPrint("Metrics server stopped");
+  }
+
+  for (QObject* connection : children())
+    connection->deleteLater();
+}
+
+void MetricsServer::incomingConnection(qintptr descriptor)
+{
+  QTcpSocket* socket = new QTcpSocket(this);
+  if (!socket->setSocketDescriptor(descriptor))
+  {
+    Log_ErrorPrintf("Failed to set socket descriptor: %s", socket->errorString().toUtf8().constData());
+    socket->deleteLater();
+    return;
+  }
+
+  connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleRequest(socket); });
+  connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+}
+
+void MetricsServer::handleRequest(QTcpSocket* socket)
+{
+  // Wait for the end of the headers, the request line is all that matters.
+  if (socket->property("responded").toBool())
+    return;
+
+  QByteArray request = socket->peek(MAX_REQUEST_SIZE);
+  if (!request.contains("\r\n\r\n") && !request.contains("\n\n"))
+  {
+    if (request.size() >= MAX_REQUEST_SIZE)
+      socket->abort();
+    return;
+  }
+
+  socket->readAll();
+  socket->setProperty("responded", true);
+
+  const QList<QByteArray> request_line = request.left(request.indexOf('\n')).trimmed().split(' ');
+  const QByteArray method = request_line.value(0);
+  const QByteArray path = request_line.value(1);
+
+  QByteArray status = "200 OK";
+  QByteArray content_type;
+  std::string body;
+  if (method != "GET")
+  {
+    status = "405 Method Not Allowed";
+    content_type = "text/plain";
+    body = "Method not allowed\n";
+  }
+  else if (path == "/metrics")
+  {
+    content_type = "text/plain; version=0.0.4";
+    body = PerformanceMetrics::FormatPrometheus();
+  }
+  else if (path == "/metrics.json")
+  {
+    content_type = "application/json";
+    body = PerformanceMetrics::FormatJSON();
+  }
+  else
+  {
+    status = "404 Not Found";
+    content_type = "text/plain";
+    body = "Not found\n";
+  }
+
+  QByteArray response;
+  response.append("HTTP/1.0 ");
+  response.append(status);
+  response.append("\r\nContent-Type: ");
+  response.append(content_type);
+  response.append("\r\nContent-Length: ");
+  response.append(QByteArray::number(static_cast<qulonglong>(body.size())));
+  response.append("\r\nConnection: close\r\n\r\n");
+  response.append(body.data(), static_cast<qsizetype>(body.size()));
+  socket->write(response);
+  socket->disconnectFromHost();
+}
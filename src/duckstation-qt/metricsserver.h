@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "core/types.h"
+#include <QtNetwork/QTcpServer>
+
+class QTcpSocket;
+
+/// Serves the performance counters over HTTP on localhost, for scraping by Prometheus or similar tools.
+/// GET /metrics returns the Prometheus text format, and GET /metrics.json a JSON object. Lives on the emu thread,
+/// since that's where the counters are updated.
+class MetricsServer : public QTcpServer
+{
+  Q_OBJECT
+
+public:
+  MetricsServer(QObject* parent = nullptr);
+  ~MetricsServer();
+
+public Q_SLOTS:
+  void start(quint16 port);
+  void stop();
+
+protected:
+  void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+  void handleRequest(QTcpSocket* socket);
+};
@@ -30,6 +30,7 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/trace_recorder.h"
 
 #include "util/audio_stream.h"
 #include "util/imgui_manager.h"
@@ -37,6 +38,7 @@
 #include "util/input_manager.h"
 #include "util/platform_misc.h"
 #include "util/postprocessing.h"
+#include "util/resource_pack.h"
 
 #include "scmversion/scmversion.h"
 
@@ -108,6 +110,7 @@ static bool s_run_setup_wizard = false;
 
 EmuThread* g_emu_thread;
 GDBServer* g_gdb_server;
+MetricsServer* g_metrics_server;
 
 EmuThread::EmuThread(QThread* ui_thread) : QThread(), m_ui_thread(ui_thread)
 {
@@ -266,6 +269,8 @@ void QtHost::SetResourcesDirectory()
   // On macOS, this is in the bundle resources directory.
   EmuFolders::Resources = Path::Canonicalize(Path::Combine(EmuFolders::AppRoot, "../Resources"));
 #endif
+
+  ResourcePack::SetPath(Path::Combine(EmuFolders::Resources, ResourcePack::FILENAME));
 }
 
 void QtHost::SetDataDirectory()
@@ -340,6 +345,14 @@ void EmuThread::loadSettings(SettingsInterface& si)
   //
 }
 
+void EmuThread::updateMetricsServer()
+{
+  if (g_settings.debugging.enable_metrics_server && !g_metrics_server->isListening())
+    g_metrics_server->start(g_settings.debugging.metrics_server_port);
+  else if (!g_settings.debugging.enable_metrics_server && g_metrics_server->isListening())
+    g_metrics_server->stop();
+}
+
 void EmuThread::setInitialState(std::optional<bool> override_fullscreen)
 {
   m_is_fullscreen = override_fullscreen.value_or(Host::GetBaseBoolSettingValue("Main", "StartFullscreen", false));
@@ -349,6 +362,13 @@ void EmuThread::setInitialState(std::optional<bool> override_fullscreen)
 
 void EmuThread::checkForSettingsChanges(const Settings& old_settings)
 {
+  if (g_settings.debugging.enable_metrics_server != old_settings.debugging.enable_metrics_server ||
+      g_settings.debugging.metrics_server_port != old_settings.debugging.metrics_server_port)
+  {
+    g_metrics_server->stop();
+    updateMetricsServer();
+  }
+
   if (g_main_window)
   {
     QMetaObject::invokeMethod(g_main_window, &MainWindow::checkForSettingChanges, Qt::QueuedConnection);
@@ -1136,6 +1156,28 @@ void EmuThread::stopDumpingAudio()
   System::StopDumpingAudio();
 }
 
+void EmuThread::startMediaCapture()
+{
+  if (!isOnThread())
+  {
+    QMetaObject::invokeMethod(this, "startMediaCapture", Qt::QueuedConnection);
+    return;
+  }
+
+  System::StartMediaCapture();
+}
+
+void EmuThread::stopMediaCapture()
+{
+  if (!isOnThread())
+  {
+    QMetaObject::invokeMethod(this, "stopMediaCapture", Qt::QueuedConnection);
+    return;
+  }
+
+  System::StopMediaCapture();
+}
+
 void EmuThread::singleStepCPU()
 {
   if (!isOnThread())
@@ -1293,6 +1335,8 @@ void EmuThread::start()
   g_emu_thread = new EmuThread(QThread::currentThread());
   g_gdb_server = new GDBServer();
   g_gdb_server->moveToThread(g_emu_thread);
+  g_metrics_server = new MetricsServer();
+  g_metrics_server->moveToThread(g_emu_thread);
   g_emu_thread->QThread::start();
   g_emu_thread->m_started_semaphore.acquire();
   g_emu_thread->moveToThread(g_emu_thread);
@@ -1328,6 +1372,9 @@ void EmuThread::run()
   createBackgroundControllerPollTimer();
   startBackgroundControllerPollTimer();
 
+  // metrics are wanted whether or not a game is running, unlike the debugger
+  updateMetricsServer();
+
   // main loop
   while (!m_shutdown_flag)
   {
@@ -1359,6 +1406,7 @@ void EmuThread::run()
   if (System::IsValid())
     System::ShutdownSystem(false);
 
+  g_metrics_server->stop();
   destroyBackgroundControllerPollTimer();
   System::Internal::ProcessShutdown();
 
@@ -1443,6 +1491,9 @@ void Host::OnInputDeviceDisconnected(const std::string_view& identifier)
 
 std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
 {
+  if (std::optional<std::vector<u8>> packed = ResourcePack::ReadFile(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   std::optional<std::vector<u8>> ret(FileSystem::ReadBinaryFile(path.c_str()));
   if (!ret.has_value())
@@ -1452,6 +1503,9 @@ std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
 
 std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
 {
+  if (std::optional<std::string> packed = ResourcePack::ReadFileToString(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   std::optional<std::string> ret(FileSystem::ReadFileToString(path.c_str()));
   if (!ret.has_value())
@@ -1461,6 +1515,9 @@ std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
 
 std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
 {
+  if (std::optional<std::time_t> packed = ResourcePack::GetFileTimestamp(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path.c_str(), &sd))
@@ -1762,6 +1819,8 @@ void QtHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -settings <filename>: Loads a custom settings configuration from the\n"
                        "    specified filename. Default settings applied if file not found.\n");
   std::fprintf(stderr, "  -earlyconsole: Creates console as early as possible, for logging.\n");
+  std::fprintf(stderr, "  -trace: Records trace events from startup. Stop with the hotkey, or exit, to write\n"
+                       "    them to the dumps directory.\n");
 #ifdef ENABLE_RAINTEGRATION
   std::fprintf(stderr, "  -raintegration: Use RAIntegration instead of built-in achievement support.\n");
 #endif
@@ -1903,6 +1962,11 @@ bool QtHost::ParseCommandLineParametersAndInitializeConfig(QApplication& app,
         InitializeEarlyConsole();
         continue;
       }
+      else if (CHECK_ARG("-trace"))
+      {
+        TraceRecorder::Start();
+        continue;
+      }
       else if (CHECK_ARG("-updatecleanup"))
       {
         if (AutoUpdaterDialog::isSupported())
@@ -2030,6 +2094,9 @@ int main(int argc, char* argv[])
   if (!QtHost::ParseCommandLineParametersAndInitializeConfig(app, autoboot))
     return EXIT_FAILURE;
 
+  // Showing the window doesn't need the game database, so load it while the emu thread and windows are created.
+  GameDatabase::StartBackgroundLoad();
+
   // Set theme before creating any windows.
   MainWindow::updateApplicationTheme();
 
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "gdbserver.h"
+#include "metricsserver.h"
 #include "qtutils.h"
 
 #include "core/game_list.h"
@@ -177,6 +178,8 @@ public Q_SLOTS:
   void setAudioOutputMuted(bool muted);
   void startDumpingAudio();
   void stopDumpingAudio();
+  void startMediaCapture();
+  void stopMediaCapture();
   void singleStepCPU();
   void dumpRAM(const QString& filename);
   void dumpVRAM(const QString& filename);
@@ -213,6 +216,7 @@ private:
 
   void createBackgroundControllerPollTimer();
   void destroyBackgroundControllerPollTimer();
+  void updateMetricsServer();
   void setInitialState(std::optional<bool> override_fullscreen);
 
   QThread* m_ui_thread;
@@ -242,6 +246,7 @@ private:
 
 extern EmuThread* g_emu_thread;
 extern GDBServer* g_gdb_server;
+extern MetricsServer* g_metrics_server;
 
 namespace QtHost {
 /// Sets batch mode (exit after game shutdown).
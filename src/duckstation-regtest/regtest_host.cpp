@@ -2,9 +2,14 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "core/achievements.h"
+#include "core/bios.h"
+#include "core/cpu_code_cache.h"
+#include "core/game_database.h"
 #include "core/game_list.h"
 #include "core/gpu.h"
+#include "core/gpu_dump.h"
 #include "core/host.h"
+#include "core/psf_loader.h"
 #include "core/system.h"
 
 #include "scmversion/scmversion.h"
@@ -13,17 +18,34 @@
 #include "util/imgui_manager.h"
 #include "util/input_manager.h"
 #include "util/platform_misc.h"
+#include "util/resource_pack.h"
 
 #include "common/assert.h"
 #include "common/crash_handler.h"
+#include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/memory_settings_interface.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/timer.h"
 
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include <algorithm>
+#include <cmath>
 #include <csignal>
 #include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include "common/windows_headers.h"
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
 
 Log_SetChannel(RegTestHost);
 
@@ -36,15 +58,88 @@ static void InitializeEarlyConsole();
 static void HookSignals();
 static bool SetFolders();
 static std::string GetFrameDumpFilename(u32 frame);
+static std::string GetFrameHashesFilename(const std::string& game_directory);
+static void LoadBaselineFrameHashes(const std::string& game_name);
+static void DumpFrame(u32 frame);
+static bool WriteFrameHashes();
+static void BeginBenchmarkRun();
+static void UpdateBenchmarkRun();
+static u64 GetPeakResidentSetSize();
+static bool WriteBenchmarkResults(const std::string& path);
+static bool LoadManifest(const std::string& path, std::vector<std::string>* game_paths);
+static void ResolveBIOSImages();
+static void RecordCheckpoint();
+static bool WriteGameResults();
+static std::string GetAudioDumpFilename(const std::string& game_path);
+static void GetPSFPlayLength(const std::string& path, u32* frames, float* fade_seconds);
+static bool ApplyAudioFadeOut(const std::string& path, float fade_seconds);
 } // namespace RegTestHost
 
+namespace {
+struct BenchmarkRun
+{
+  std::vector<float> frame_times;
+  std::vector<float> cpu_thread_times;
+  std::vector<float> sw_thread_times;
+  std::vector<float> gpu_times;
+  Common::Timer::Value start_time = 0;
+  Common::Timer::Value end_time = 0;
+  u32 start_frame_number = 0;
+  u32 end_frame_number = 0;
+  u32 start_internal_frame_number = 0;
+  u32 end_internal_frame_number = 0;
+  u32 start_compiled_blocks = 0;
+  u32 end_compiled_blocks = 0;
+};
+
+struct GameResult
+{
+  std::string path;
+  std::string serial;
+  std::string title;
+  std::vector<std::pair<u32, u64>> checkpoints;
+  double elapsed_seconds = 0.0;
+  u32 frames_executed = 0;
+  u32 frame_hash_mismatches = 0;
+  bool booted = false;
+};
+} // namespace
+
 static std::unique_ptr<MemorySettingsInterface> s_base_settings_interface;
 
 static u32 s_frames_to_run = 60 * 60;
+static u32 s_frames_remaining = 0;
 static u32 s_frame_dump_interval = 0;
 static std::string s_dump_base_directory;
 static std::string s_dump_game_directory;
 
+static bool s_frame_hash_mode = false;
+static std::string s_frame_hash_baseline_directory;
+static std::vector<std::pair<u32, u64>> s_frame_hashes;
+static std::unordered_map<u32, u64> s_baseline_frame_hashes;
+
+static bool s_benchmark_mode = false;
+static u32 s_benchmark_warmup_frames = 0;
+static u32 s_benchmark_repeat_count = 1;
+static std::string s_benchmark_output_path;
+static std::vector<BenchmarkRun> s_benchmark_runs;
+static Common::Timer s_benchmark_frame_timer;
+static bool s_benchmark_measuring = false;
+static std::string s_benchmark_game_serial;
+static std::string s_benchmark_game_title;
+static float s_benchmark_frame_rate = 0.0f;
+
+static std::string s_manifest_path;
+static std::string s_results_path;
+static u32 s_checkpoint_interval = 0;
+
+static std::string s_audio_dump_path;
+static float s_audio_fade_seconds = 0.0f;
+
+static std::string s_gpu_dump_path;
+static std::string s_gpu_dump_record_path;
+static std::vector<GameResult> s_game_results;
+
 bool RegTestHost::SetFolders()
 {
   std::string program_path(FileSystem::GetProgramPath());
@@ -61,6 +156,8 @@ bool RegTestHost::SetFolders()
   EmuFolders::Resources = Path::Canonicalize(Path::Combine(EmuFolders::AppRoot, "../Resources"));
 #endif
 
+  ResourcePack::SetPath(Path::Combine(EmuFolders::Resources, ResourcePack::FILENAME));
+
   Log_DevPrintf("AppRoot Directory: %s", EmuFolders::AppRoot.c_str());
   Log_DevPrintf("DataRoot Directory: %s", EmuFolders::DataRoot.c_str());
   Log_DevPrintf("Resources Directory: %s", EmuFolders::Resources.c_str());
@@ -171,6 +268,9 @@ void Host::CommitBaseSettingChanges()
 
 std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
 {
+  if (std::optional<std::vector<u8>> packed = ResourcePack::ReadFile(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   std::optional<std::vector<u8>> ret(FileSystem::ReadBinaryFile(path.c_str()));
   if (!ret.has_value())
@@ -180,6 +280,9 @@ std::optional<std::vector<u8>> Host::ReadResourceFile(const char* filename)
 
 std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
 {
+  if (std::optional<std::string> packed = ResourcePack::ReadFileToString(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   std::optional<std::string> ret(FileSystem::ReadFileToString(path.c_str()));
   if (!ret.has_value())
@@ -189,6 +292,9 @@ std::optional<std::string> Host::ReadResourceFileToString(const char* filename)
 
 std::optional<std::time_t> Host::GetResourceFileTimestamp(const char* filename)
 {
+  if (std::optional<std::time_t> packed = ResourcePack::GetFileTimestamp(filename); packed.has_value())
+    return packed;
+
   const std::string path(Path::Combine(EmuFolders::Resources, filename));
   FILESYSTEM_STAT_DATA sd;
   if (!FileSystem::StatFile(path.c_str(), &sd))
@@ -227,7 +333,13 @@ void Host::OnSystemResumed()
 
 void Host::OnPerformanceCountersUpdated()
 {
-  //
+  if (!s_benchmark_measuring)
+    return;
+
+  BenchmarkRun& run = s_benchmark_runs.back();
+  run.cpu_thread_times.push_back(System::GetCPUThreadAverageTime());
+  run.sw_thread_times.push_back(System::GetSWThreadAverageTime());
+  run.gpu_times.push_back(System::GetGPUAverageTime());
 }
 
 void Host::OnGameChanged(const std::string& disc_path, const std::string& game_serial, const std::string& game_name)
@@ -236,6 +348,12 @@ void Host::OnGameChanged(const std::string& disc_path, const std::string& game_s
   Log_InfoPrintf("Game Serial: %s", game_serial.c_str());
   Log_InfoPrintf("Game Name: %s", game_name.c_str());
 
+  if (!s_game_results.empty())
+  {
+    s_game_results.back().serial = game_serial;
+    s_game_results.back().title = game_name;
+  }
+
   if (!s_dump_base_directory.empty())
   {
     s_dump_game_directory = Path::Combine(s_dump_base_directory, game_name);
@@ -247,13 +365,22 @@ void Host::OnGameChanged(const std::string& disc_path, const std::string& game_s
     }
 
     Log_InfoPrintf("Dumping frames to '%s'...", s_dump_game_directory.c_str());
+
+    if (!s_frame_hash_baseline_directory.empty())
+      RegTestHost::LoadBaselineFrameHashes(game_name);
   }
 }
 
 void Host::PumpMessagesOnCPUThread()
 {
-  s_frames_to_run--;
-  if (s_frames_to_run == 0)
+  if (s_benchmark_mode)
+    RegTestHost::UpdateBenchmarkRun();
+  if (!s_results_path.empty())
+    RegTestHost::RecordCheckpoint();
+
+  s_game_results.back().frames_executed++;
+  s_frames_remaining--;
+  if (s_frames_remaining == 0)
     System::ShutdownSystem(false);
 }
 
@@ -304,10 +431,7 @@ void Host::BeginPresentFrame()
 {
   const u32 frame = System::GetFrameNumber();
   if (s_frame_dump_interval > 0 && (s_frame_dump_interval == 1 || (frame % s_frame_dump_interval) == 0))
-  {
-    std::string dump_filename(RegTestHost::GetFrameDumpFilename(frame));
-    g_gpu->WriteDisplayTextureToFile(std::move(dump_filename));
-  }
+    RegTestHost::DumpFrame(frame);
 }
 
 void Host::OpenURL(const std::string_view& url)
@@ -431,9 +555,28 @@ void RegTestHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -version: Displays version information and exits.\n");
   std::fprintf(stderr, "  -dumpdir: Set frame dump base directory (will be dumped to basedir/gametitle).\n");
   std::fprintf(stderr, "  -dumpinterval: Dumps every N frames.\n");
+  std::fprintf(stderr, "  -dumphashes: Writes a hash of the displayed VRAM area instead of an image for dumps.\n");
+  std::fprintf(stderr, "  -baseline <dir>: Compares dump hashes against a previous -dumphashes run in this\n"
+                       "    directory, and writes an image for each frame which differs.\n");
   std::fprintf(stderr, "  -frames: Sets the number of frames to execute.\n");
   std::fprintf(stderr, "  -log <level>: Sets the log level. Defaults to verbose.\n");
   std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Default to software.\n");
+  std::fprintf(stderr, "  -nulldevice: Runs the software renderer without creating a host GPU device.\n");
+  std::fprintf(stderr, "  -cpu <mode>: Sets the CPU execution mode.\n");
+  std::fprintf(stderr, "  -upscale <scale>: Sets the resolution scale for hardware renderers.\n");
+  std::fprintf(stderr, "  -benchmark: Measures performance and writes the results as JSON.\n");
+  std::fprintf(stderr, "  -benchmarkout <path>: Writes benchmark results to this file instead of stdout.\n");
+  std::fprintf(stderr, "  -warmup <frames>: Runs this many frames before measuring in benchmark mode.\n");
+  std::fprintf(stderr, "  -repeat <count>: Boots and measures the game this many times in benchmark mode.\n");
+  std::fprintf(stderr, "  -manifest <path>: Runs every game listed in this file, one path per line.\n");
+  std::fprintf(stderr, "  -results <path>: Writes per-game results and VRAM hashes as JSON to this file.\n");
+  std::fprintf(stderr, "  -checkpointinterval <frames>: Hashes VRAM every N frames, as well as the last frame.\n");
+  std::fprintf(stderr, "  -gpudump <path>: Plays a GPU dump instead of running the CPU, looping at the end. The\n"
+                       "    boot filename is optional.\n");
+  std::fprintf(stderr, "  -recordgpudump <path>: Records a GPU dump of the frames which are run.\n");
+  std::fprintf(stderr, "  -audiodump <path>: Writes the SPU output to this WAV file, or to a file per game in this\n"
+                       "    directory with a manifest. PSFs with a length tag run for their length and fade.\n");
+  std::fprintf(stderr, "  -fade <seconds>: Fades out the end of audio dumps, unless a PSF has a fade tag.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
                        "    spaces or starts with a dash.\n");
@@ -490,6 +633,23 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
 
         continue;
       }
+      else if (CHECK_ARG("-dumphashes"))
+      {
+        s_frame_hash_mode = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-baseline"))
+      {
+        s_frame_hash_mode = true;
+        s_frame_hash_baseline_directory = argv[++i];
+        if (s_frame_hash_baseline_directory.empty())
+        {
+          Log_ErrorPrintf("Invalid baseline directory specified.");
+          return false;
+        }
+
+        continue;
+      }
       else if (CHECK_ARG_PARAM("-frames"))
       {
         s_frames_to_run = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
@@ -526,6 +686,154 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
         s_base_settings_interface->SetStringValue("GPU", "Renderer", Settings::GetRendererName(renderer.value()));
         continue;
       }
+      else if (CHECK_ARG("-nulldevice"))
+      {
+        s_base_settings_interface->SetBoolValue("GPU", "UseNullDevice", true);
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-cpu"))
+      {
+        std::optional<CPUExecutionMode> mode = Settings::ParseCPUExecutionMode(argv[++i]);
+        if (!mode.has_value())
+        {
+          Log_ErrorPrintf("Invalid CPU execution mode specified.");
+          return false;
+        }
+
+        s_base_settings_interface->SetStringValue("CPU", "ExecutionMode",
+                                                  Settings::GetCPUExecutionModeName(mode.value()));
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-upscale"))
+      {
+        const u32 scale = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+        if (scale == 0)
+        {
+          Log_ErrorPrintf("Invalid resolution scale specified: %s", argv[i]);
+          return false;
+        }
+
+        s_base_settings_interface->SetIntValue("GPU", "ResolutionScale", static_cast<s32>(scale));
+        continue;
+      }
+      else if (CHECK_ARG("-benchmark"))
+      {
+        s_benchmark_mode = true;
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-benchmarkout"))
+      {
+        s_benchmark_mode = true;
+        s_benchmark_output_path = argv[++i];
+        if (s_benchmark_output_path.empty())
+        {
+          Log_ErrorPrintf("Invalid benchmark output path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-warmup"))
+      {
+        const std::optional<u32> frames = StringUtil::FromChars<u32>(argv[++i]);
+        if (!frames.has_value())
+        {
+          Log_ErrorPrintf("Invalid warmup frame count specified: %s", argv[i]);
+          return false;
+        }
+
+        s_benchmark_warmup_frames = frames.value();
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-repeat"))
+      {
+        s_benchmark_repeat_count = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+        if (s_benchmark_repeat_count == 0)
+        {
+          Log_ErrorPrintf("Invalid repeat count specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-manifest"))
+      {
+        s_manifest_path = argv[++i];
+        if (s_manifest_path.empty())
+        {
+          Log_ErrorPrintf("Invalid manifest path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-results"))
+      {
+        s_results_path = argv[++i];
+        if (s_results_path.empty())
+        {
+          Log_ErrorPrintf("Invalid results path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-checkpointinterval"))
+      {
+        s_checkpoint_interval = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+        if (s_checkpoint_interval == 0)
+        {
+          Log_ErrorPrintf("Invalid checkpoint interval specified: %s", argv[i]);
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-gpudump"))
+      {
+        s_gpu_dump_path = argv[++i];
+        if (s_gpu_dump_path.empty())
+        {
+          Log_ErrorPrintf("Invalid GPU dump path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-recordgpudump"))
+      {
+        s_gpu_dump_record_path = argv[++i];
+        if (s_gpu_dump_record_path.empty())
+        {
+          Log_ErrorPrintf("Invalid GPU dump path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-audiodump"))
+      {
+        s_audio_dump_path = argv[++i];
+        if (s_audio_dump_path.empty())
+        {
+          Log_ErrorPrintf("Invalid audio dump path specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-fade"))
+      {
+        const std::optional<float> fade = StringUtil::FromChars<float>(argv[++i]);
+        if (!fade.has_value() || fade.value() < 0.0f)
+        {
+          Log_ErrorPrintf("Invalid fade length specified: %s", argv[i]);
+          return false;
+        }
+
+        s_audio_fade_seconds = fade.value();
+        continue;
+      }
       else if (CHECK_ARG("--"))
       {
         no_more_args = true;
@@ -554,6 +862,486 @@ std::string RegTestHost::GetFrameDumpFilename(u32 frame)
   return Path::Combine(s_dump_game_directory, fmt::format("frame_{:05d}.png", frame));
 }
 
+std::string RegTestHost::GetFrameHashesFilename(const std::string& game_directory)
+{
+  return Path::Combine(game_directory, "frame_hashes.txt");
+}
+
+void RegTestHost::LoadBaselineFrameHashes(const std::string& game_name)
+{
+  s_baseline_frame_hashes.clear();
+
+  const std::string filename(GetFrameHashesFilename(Path::Combine(s_frame_hash_baseline_directory, game_name)));
+  const std::optional<std::string> data = FileSystem::ReadFileToString(filename.c_str());
+  if (!data.has_value())
+  {
+    Log_WarningPrintf("No baseline hashes found at '%s', every dumped frame will be written.", filename.c_str());
+    return;
+  }
+
+  // One "<frame> <hash>" pair per line, as written by WriteFrameHashes().
+  std::string_view remaining(data.value());
+  while (!remaining.empty())
+  {
+    const std::string_view::size_type pos = remaining.find('\n');
+    const std::string_view line = StringUtil::StripWhitespace(remaining.substr(0, pos));
+    remaining = (pos != std::string_view::npos) ? remaining.substr(pos + 1) : std::string_view();
+
+    const std::string_view::size_type sep = line.find(' ');
+    const std::optional<u32> frame = StringUtil::FromChars<u32>(line.substr(0, sep));
+    const std::optional<u64> hash = (sep != std::string_view::npos) ?
+                                      StringUtil::FromChars<u64>(StringUtil::StripWhitespace(line.substr(sep)), 16) :
+                                      std::nullopt;
+    if (frame.has_value() && hash.has_value())
+      s_baseline_frame_hashes.emplace(frame.value(), hash.value());
+  }
+
+  Log_InfoPrintf("Loaded %zu baseline hashes from '%s'.", s_baseline_frame_hashes.size(), filename.c_str());
+}
+
+void RegTestHost::DumpFrame(u32 frame)
+{
+  if (!s_frame_hash_mode)
+  {
+    g_gpu->WriteDisplayTextureToFile(GetFrameDumpFilename(frame), true, true, true);
+    return;
+  }
+
+  // Hashing is much cheaper than encoding a PNG, so only write the image when it's needed to see what changed.
+  const u64 hash = g_gpu->GetDisplayedVRAMHash();
+  s_frame_hashes.emplace_back(frame, hash);
+  if (s_frame_hash_baseline_directory.empty())
+    return;
+
+  const auto iter = s_baseline_frame_hashes.find(frame);
+  if (iter != s_baseline_frame_hashes.end() && iter->second == hash)
+    return;
+
+  if (iter == s_baseline_frame_hashes.end())
+    Log_WarningPrintf("Frame %u is not in the baseline.", frame);
+  else
+    Log_WarningFmt("Frame {} hash mismatch: expected {:016x}, got {:016x}.", frame, iter->second, hash);
+
+  if (!s_game_results.empty())
+    s_game_results.back().frame_hash_mismatches++;
+
+  g_gpu->WriteDisplayTextureToFile(GetFrameDumpFilename(frame), true, true, true);
+}
+
+bool RegTestHost::WriteFrameHashes()
+{
+  if (s_dump_game_directory.empty())
+    return false;
+
+  std::string data;
+  for (const auto& [frame, hash] : s_frame_hashes)
+    fmt::format_to(std::back_inserter(data), "{} {:016x}\n", frame, hash);
+
+  const std::string filename(GetFrameHashesFilename(s_dump_game_directory));
+  if (!FileSystem::WriteStringToFile(filename.c_str(), data))
+  {
+    Log_ErrorPrintf("Failed to write frame hashes to '%s'.", filename.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %zu frame hashes to '%s'.", s_frame_hashes.size(), filename.c_str());
+  return true;
+}
+
+void RegTestHost::BeginBenchmarkRun()
+{
+  s_benchmark_runs.emplace_back().frame_times.reserve(s_frames_to_run);
+  s_benchmark_measuring = false;
+  s_benchmark_frame_timer.Reset();
+}
+
+void RegTestHost::UpdateBenchmarkRun()
+{
+  BenchmarkRun& run = s_benchmark_runs.back();
+  if (s_benchmark_measuring)
+  {
+    run.frame_times.push_back(static_cast<float>(s_benchmark_frame_timer.GetTimeMillisecondsAndReset()));
+
+    // This is the last frame, so grab the counters before the system shuts down.
+    if (s_frames_remaining == 1)
+    {
+      run.end_time = Common::Timer::GetCurrentValue();
+      run.end_frame_number = System::GetFrameNumber();
+      run.end_internal_frame_number = System::GetInternalFrameNumber();
+      run.end_compiled_blocks = CPU::CodeCache::GetCompiledBlockCount();
+      s_benchmark_measuring = false;
+    }
+
+    return;
+  }
+
+  // Frames remaining includes this one, so measurement starts from the next frame.
+  if (s_frames_remaining > (s_frames_to_run + 1))
+    return;
+
+  s_benchmark_game_serial = System::GetGameSerial();
+  s_benchmark_game_title = System::GetGameTitle();
+  s_benchmark_frame_rate = System::GetThrottleFrequency();
+
+  run.start_time = Common::Timer::GetCurrentValue();
+  run.start_frame_number = System::GetFrameNumber();
+  run.start_internal_frame_number = System::GetInternalFrameNumber();
+  run.start_compiled_blocks = CPU::CodeCache::GetCompiledBlockCount();
+  s_benchmark_measuring = true;
+  s_benchmark_frame_timer.Reset();
+
+  // Don't let the warmup frames leak into the thread time averages.
+  System::ResetPerformanceCounters();
+}
+
+bool RegTestHost::LoadManifest(const std::string& path, std::vector<std::string>* game_paths)
+{
+  const std::optional<std::string> data = FileSystem::ReadFileToString(path.c_str());
+  if (!data.has_value())
+  {
+    Log_ErrorPrintf("Failed to read manifest '%s'.", path.c_str());
+    return false;
+  }
+
+  // One path per line, blank lines and lines starting with # are ignored.
+  std::string_view remaining(data.value());
+  while (!remaining.empty())
+  {
+    const std::string_view::size_type pos = remaining.find('\n');
+    const std::string_view line = StringUtil::StripWhitespace(remaining.substr(0, pos));
+    remaining = (pos != std::string_view::npos) ? remaining.substr(pos + 1) : std::string_view();
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    game_paths->emplace_back(line);
+  }
+
+  if (game_paths->empty())
+  {
+    Log_ErrorPrintf("Manifest '%s' does not contain any games.", path.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+std::string RegTestHost::GetAudioDumpFilename(const std::string& game_path)
+{
+  if (s_manifest_path.empty())
+    return s_audio_dump_path;
+
+  return Path::Combine(s_audio_dump_path, fmt::format("{}.wav", Path::GetFileTitle(game_path)));
+}
+
+void RegTestHost::GetPSFPlayLength(const std::string& path, u32* frames, float* fade_seconds)
+{
+  // PSF lengths are up to the point the song would loop, the fade is played on top of that.
+  PSFLoader::File file;
+  if (!file.Load(path.c_str()))
+    return;
+
+  const std::optional<float> length = file.GetTagDuration("length");
+  if (!length.has_value() || length.value() <= 0.0f)
+  {
+    Log_WarningPrintf("'%s' has no length tag, running for %u frames.", path.c_str(), *frames);
+    return;
+  }
+
+  *fade_seconds = file.GetTagDuration("fade").value_or(*fade_seconds);
+  *frames = static_cast<u32>(std::ceil((length.value() + *fade_seconds) * System::GetThrottleFrequency()));
+  Log_InfoPrintf("PSF length is %.2f seconds plus %.2f seconds fade, %u frames.", length.value(), *fade_seconds,
+                 *frames);
+}
+
+bool RegTestHost::ApplyAudioFadeOut(const std::string& path, float fade_seconds)
+{
+  // The SPU always dumps 44100Hz 16-bit stereo, after WAVWriter's plain 44 byte header.
+  static constexpr u32 HEADER_SIZE = 44;
+  static constexpr u32 FRAME_SIZE = sizeof(s16) * 2;
+  static constexpr u32 SAMPLE_RATE = 44100;
+
+  auto fp = FileSystem::OpenManagedCFile(path.c_str(), "r+b");
+  const s64 file_size = fp ? FileSystem::FSize64(fp.get()) : -1;
+  if (file_size < HEADER_SIZE)
+  {
+    Log_ErrorPrintf("Failed to open audio dump '%s' to fade out.", path.c_str());
+    return false;
+  }
+
+  const u32 total_frames = static_cast<u32>((file_size - HEADER_SIZE) / FRAME_SIZE);
+  const u32 fade_frames = std::min(total_frames, static_cast<u32>(fade_seconds * SAMPLE_RATE));
+  if (fade_frames == 0)
+    return true;
+
+  std::vector<s16> samples(fade_frames * 2);
+  const s64 fade_offset = HEADER_SIZE + static_cast<s64>(total_frames - fade_frames) * FRAME_SIZE;
+  if (FileSystem::FSeek64(fp.get(), fade_offset, SEEK_SET) != 0 ||
+      std::fread(samples.data(), FRAME_SIZE, fade_frames, fp.get()) != fade_frames)
+  {
+    Log_ErrorPrintf("Failed to read audio dump '%s' to fade out.", path.c_str());
+    return false;
+  }
+
+  for (u32 i = 0; i < fade_frames; i++)
+  {
+    const float volume = static_cast<float>(fade_frames - i) / static_cast<float>(fade_frames);
+    samples[i * 2 + 0] = static_cast<s16>(static_cast<float>(samples[i * 2 + 0]) * volume);
+    samples[i * 2 + 1] = static_cast<s16>(static_cast<float>(samples[i * 2 + 1]) * volume);
+  }
+
+  if (FileSystem::FSeek64(fp.get(), fade_offset, SEEK_SET) != 0 ||
+      std::fwrite(samples.data(), FRAME_SIZE, fade_frames, fp.get()) != fade_frames)
+  {
+    Log_ErrorPrintf("Failed to write faded audio to '%s'.", path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Faded out the last %.2f seconds of '%s'.", fade_seconds, path.c_str());
+  return true;
+}
+
+void RegTestHost::ResolveBIOSImages()
+{
+  // Auto-detection hashes every file in the BIOS directory on each boot. Do it once up front instead, and pin the
+  // images found, so running a whole manifest doesn't pay for it again for every game.
+  static constexpr const std::tuple<ConsoleRegion, const char*> regions[] = {
+    {ConsoleRegion::NTSC_U, "PathNTSCU"}, {ConsoleRegion::NTSC_J, "PathNTSCJ"}, {ConsoleRegion::PAL, "PathPAL"}};
+
+  const auto images = BIOS::FindBIOSImagesInDirectory(EmuFolders::Bios.c_str());
+  for (const auto& [region, key] : regions)
+  {
+    if (!s_base_settings_interface->GetStringValue("BIOS", key).empty())
+      continue;
+
+    for (const auto& [filename, info] : images)
+    {
+      if (info && BIOS::IsValidBIOSForRegion(region, info->region))
+      {
+        Log_InfoPrintf("Using '%s' for %s games.", filename.c_str(), Settings::GetConsoleRegionName(region));
+        s_base_settings_interface->SetStringValue("BIOS", key, filename.c_str());
+        break;
+      }
+    }
+  }
+}
+
+void RegTestHost::RecordCheckpoint()
+{
+  const u32 frame = System::GetFrameNumber();
+  if (s_frames_remaining != 1 && (s_checkpoint_interval == 0 || (frame % s_checkpoint_interval) != 0))
+    return;
+
+  s_game_results.back().checkpoints.emplace_back(frame, g_gpu->GetVRAMHash());
+}
+
+bool RegTestHost::WriteGameResults()
+{
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+  writer.StartObject();
+  writer.Key("version");
+  writer.String(g_scm_tag_str);
+  writer.Key("renderer");
+  writer.String(Settings::GetRendererName(g_settings.gpu_renderer));
+  writer.Key("frames");
+  writer.Uint(s_frames_to_run);
+  writer.Key("games");
+  writer.StartArray();
+  for (const GameResult& result : s_game_results)
+  {
+    writer.StartObject();
+    writer.Key("path");
+    writer.String(result.path.c_str());
+    writer.Key("serial");
+    writer.String(result.serial.c_str());
+    writer.Key("title");
+    writer.String(result.title.c_str());
+    writer.Key("booted");
+    writer.Bool(result.booted);
+    writer.Key("frames_executed");
+    writer.Uint(result.frames_executed);
+    writer.Key("elapsed_seconds");
+    writer.Double(result.elapsed_seconds);
+    if (s_frame_hash_mode)
+    {
+      writer.Key("frame_hash_mismatches");
+      writer.Uint(result.frame_hash_mismatches);
+    }
+    writer.Key("checkpoints");
+    writer.StartArray();
+    for (const auto& [frame, hash] : result.checkpoints)
+    {
+      writer.StartObject();
+      writer.Key("frame");
+      writer.Uint(frame);
+      writer.Key("vram_hash");
+      writer.String(fmt::format("{:016x}", hash).c_str());
+      writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+
+  if (!FileSystem::WriteStringToFile(s_results_path.c_str(), std::string_view(buffer.GetString(), buffer.GetSize())))
+  {
+    Log_ErrorPrintf("Failed to write results to '%s'.", s_results_path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Results written to '%s'.", s_results_path.c_str());
+  return true;
+}
+
+u64 RegTestHost::GetPeakResidentSetSize()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc = {};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return 0;
+
+  return static_cast<u64>(pmc.PeakWorkingSetSize);
+#else
+  struct rusage usage = {};
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+
+#ifdef __APPLE__
+  // macOS reports in bytes, everyone else uses kilobytes.
+  return static_cast<u64>(usage.ru_maxrss);
+#else
+  return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+bool RegTestHost::WriteBenchmarkResults(const std::string& path)
+{
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+
+  static constexpr auto mean = [](const std::vector<float>& values) {
+    double sum = 0.0;
+    for (const float value : values)
+      sum += value;
+    return values.empty() ? 0.0 : (sum / static_cast<double>(values.size()));
+  };
+
+  // Nearest-rank percentile, values must be sorted.
+  static constexpr auto percentile = [](const std::vector<float>& values, u32 pct) {
+    if (values.empty())
+      return 0.0;
+
+    const size_t rank = (values.size() * pct + 99) / 100;
+    return static_cast<double>(values[std::clamp<size_t>(rank, 1, values.size()) - 1]);
+  };
+
+  writer.StartObject();
+  writer.Key("version");
+  writer.String(g_scm_tag_str);
+  writer.Key("path");
+  writer.String(path.c_str());
+  writer.Key("game_serial");
+  writer.String(s_benchmark_game_serial.c_str());
+  writer.Key("game_title");
+  writer.String(s_benchmark_game_title.c_str());
+  writer.Key("renderer");
+  writer.String(Settings::GetRendererName(g_settings.gpu_renderer));
+  writer.Key("cpu_execution_mode");
+  writer.String(Settings::GetCPUExecutionModeName(g_settings.cpu_execution_mode));
+  writer.Key("resolution_scale");
+  writer.Uint(g_settings.gpu_resolution_scale);
+  writer.Key("frame_rate");
+  writer.Double(s_benchmark_frame_rate);
+  writer.Key("warmup_frames");
+  writer.Uint(s_benchmark_warmup_frames);
+  writer.Key("frames");
+  writer.Uint(s_frames_to_run);
+
+  double total_vps = 0.0;
+  double total_fps = 0.0;
+  writer.Key("runs");
+  writer.StartArray();
+  for (BenchmarkRun& run : s_benchmark_runs)
+  {
+    const double elapsed = Common::Timer::ConvertValueToSeconds(run.end_time - run.start_time);
+    const double rate_divider = (elapsed > 0.0) ? (1.0 / elapsed) : 0.0;
+    const double vps = static_cast<double>(run.end_frame_number - run.start_frame_number) * rate_divider;
+    const double fps =
+      static_cast<double>(run.end_internal_frame_number - run.start_internal_frame_number) * rate_divider;
+    total_vps += vps;
+    total_fps += fps;
+
+    std::sort(run.frame_times.begin(), run.frame_times.end());
+
+    writer.StartObject();
+    writer.Key("elapsed_seconds");
+    writer.Double(elapsed);
+    writer.Key("fps");
+    writer.Double(fps);
+    writer.Key("vps");
+    writer.Double(vps);
+    writer.Key("frame_time_ms");
+    writer.StartObject();
+    writer.Key("min");
+    writer.Double(run.frame_times.empty() ? 0.0 : static_cast<double>(run.frame_times.front()));
+    writer.Key("mean");
+    writer.Double(mean(run.frame_times));
+    writer.Key("p50");
+    writer.Double(percentile(run.frame_times, 50));
+    writer.Key("p90");
+    writer.Double(percentile(run.frame_times, 90));
+    writer.Key("p95");
+    writer.Double(percentile(run.frame_times, 95));
+    writer.Key("p99");
+    writer.Double(percentile(run.frame_times, 99));
+    writer.Key("max");
+    writer.Double(run.frame_times.empty() ? 0.0 : static_cast<double>(run.frame_times.back()));
+    writer.EndObject();
+    writer.Key("cpu_thread_time_ms");
+    writer.Double(mean(run.cpu_thread_times));
+    writer.Key("sw_thread_time_ms");
+    writer.Double(mean(run.sw_thread_times));
+    writer.Key("gpu_time_ms");
+    writer.Double(mean(run.gpu_times));
+    writer.Key("jit_blocks_compiled");
+    writer.Uint(run.end_compiled_blocks - run.start_compiled_blocks);
+    writer.Key("jit_blocks_compiled_total");
+    writer.Uint(run.end_compiled_blocks);
+    writer.EndObject();
+  }
+  writer.EndArray();
+
+  const double num_runs = static_cast<double>(std::max<size_t>(s_benchmark_runs.size(), 1));
+  writer.Key("mean_fps");
+  writer.Double(total_fps / num_runs);
+  writer.Key("mean_vps");
+  writer.Double(total_vps / num_runs);
+  writer.Key("peak_rss_bytes");
+  writer.Uint64(GetPeakResidentSetSize());
+  writer.EndObject();
+
+  const std::string_view json(buffer.GetString(), buffer.GetSize());
+  if (s_benchmark_output_path.empty())
+  {
+    std::fwrite(json.data(), json.size(), 1, stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);
+    return true;
+  }
+
+  if (!FileSystem::WriteStringToFile(s_benchmark_output_path.c_str(), json))
+  {
+    Log_ErrorPrintf("Failed to write benchmark results to '%s'.", s_benchmark_output_path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Benchmark results written to '%s'.", s_benchmark_output_path.c_str());
+  return true;
+}
+
 int main(int argc, char* argv[])
 {
   RegTestHost::InitializeEarlyConsole();
@@ -565,21 +1353,42 @@ int main(int argc, char* argv[])
   if (!RegTestHost::ParseCommandLineParameters(argc, argv, autoboot))
     return EXIT_FAILURE;
 
-  if (!autoboot || autoboot->filename.empty())
+  std::vector<std::string> game_paths;
+  if (!s_manifest_path.empty())
+  {
+    if (autoboot && !autoboot->filename.empty())
+    {
+      Log_ErrorPrintf("A boot path can't be used with a manifest.");
+      return EXIT_FAILURE;
+    }
+    else if (s_benchmark_mode)
+    {
+      Log_ErrorPrintf("Benchmark mode only supports a single game.");
+      return EXIT_FAILURE;
+    }
+    else if (!s_gpu_dump_path.empty() || !s_gpu_dump_record_path.empty())
+    {
+      Log_ErrorPrintf("GPU dumps can't be used with a manifest.");
+      return EXIT_FAILURE;
+    }
+
+    if (!RegTestHost::LoadManifest(s_manifest_path, &game_paths))
+      return EXIT_FAILURE;
+  }
+  else if ((!autoboot || autoboot->filename.empty()) && s_gpu_dump_path.empty())
   {
     Log_ErrorPrintf("No boot path specified.");
     return EXIT_FAILURE;
   }
-
-  System::Internal::ProcessStartup();
-  RegTestHost::HookSignals();
-
-  int result = -1;
-  Log_InfoPrintf("Trying to boot '%s'...", autoboot->filename.c_str());
-  if (!System::BootSystem(std::move(autoboot.value())))
+  else if (!s_gpu_dump_path.empty() && !s_gpu_dump_record_path.empty())
   {
-    Log_ErrorPrintf("Failed to boot system.");
-    goto cleanup;
+    Log_ErrorPrintf("A GPU dump can't be recorded while playing one.");
+    return EXIT_FAILURE;
+  }
+  else
+  {
+    // Dumps don't need a game, the BIOS is enough to get a GPU.
+    game_paths.push_back(autoboot ? std::move(autoboot->filename) : std::string());
   }
 
   if (s_frame_dump_interval > 0)
@@ -587,14 +1396,120 @@ int main(int argc, char* argv[])
     if (s_dump_base_directory.empty())
     {
       Log_ErrorPrint("Dump directory not specified.");
-      goto cleanup;
+      return EXIT_FAILURE;
     }
 
     Log_InfoPrintf("Dumping every %dth frame to '%s'.", s_frame_dump_interval, s_dump_base_directory.c_str());
   }
+  else if (s_frame_hash_mode)
+  {
+    Log_ErrorPrint("Frame hashes require a dump interval.");
+    return EXIT_FAILURE;
+  }
+
+  // GPU times are only collected when the statistics are shown.
+  if (s_benchmark_mode)
+    s_base_settings_interface->SetBoolValue("Display", "ShowGPU", true);
+
+  System::Internal::ProcessStartup();
+  RegTestHost::HookSignals();
 
-  Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
-  System::Execute();
+  // Shared by every game in the manifest, so only load these once.
+  GameDatabase::EnsureLoaded();
+  if (!s_manifest_path.empty())
+    RegTestHost::ResolveBIOSImages();
+
+  int result = -1;
+  bool all_booted = true;
+  const u32 num_runs = s_benchmark_mode ? s_benchmark_repeat_count : 1;
+  for (const std::string& path : game_paths)
+  {
+    s_game_results.emplace_back().path = path;
+
+    for (u32 run = 0; run < num_runs; run++)
+    {
+      Log_InfoPrintf("Trying to boot '%s'...", path.c_str());
+      const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+      if (!System::BootSystem(SystemBootParameters(path)))
+      {
+        Log_ErrorPrintf("Failed to boot system.");
+        all_booted = false;
+        break;
+      }
+
+      s_game_results.back().booted = true;
+
+      Error error;
+      if (!s_gpu_dump_path.empty() && !GPUDump::StartPlayback(s_gpu_dump_path.c_str(), &error))
+      {
+        Log_ErrorPrintf("Failed to play GPU dump: %s", error.GetDescription().c_str());
+        System::ShutdownSystem(false);
+        all_booted = false;
+        break;
+      }
+      else if (!s_gpu_dump_record_path.empty() &&
+               !GPUDump::StartRecording(s_gpu_dump_record_path.c_str(), 0, &error))
+      {
+        Log_ErrorPrintf("Failed to record GPU dump: %s", error.GetDescription().c_str());
+        System::ShutdownSystem(false);
+        all_booted = false;
+        break;
+      }
+
+      std::string audio_dump_filename;
+      float fade_seconds = s_audio_fade_seconds;
+      if (!s_audio_dump_path.empty())
+      {
+        audio_dump_filename = RegTestHost::GetAudioDumpFilename(path);
+        if (!System::StartDumpingAudio(audio_dump_filename.c_str()))
+        {
+          Log_ErrorPrintf("Failed to dump audio to '%s'.", audio_dump_filename.c_str());
+          System::ShutdownSystem(false);
+          all_booted = false;
+          break;
+        }
+      }
+
+      if (s_benchmark_mode)
+      {
+        // One extra frame, so there's a start point for the first measured frame time.
+        Log_InfoPrintf("Benchmark run %u/%u: %u warmup frames, %u measured frames...", run + 1, num_runs,
+                       s_benchmark_warmup_frames, s_frames_to_run);
+        s_frames_remaining = s_benchmark_warmup_frames + s_frames_to_run + 1;
+        RegTestHost::BeginBenchmarkRun();
+      }
+      else
+      {
+        u32 frames_to_run = s_frames_to_run;
+        if (!audio_dump_filename.empty() && System::IsPsfFileName(path))
+          RegTestHost::GetPSFPlayLength(path, &frames_to_run, &fade_seconds);
+
+        Log_InfoPrintf("Running for %u frames...", frames_to_run);
+        s_frames_remaining = frames_to_run;
+      }
+
+      s_frame_hashes.clear();
+      System::Execute();
+      s_game_results.back().elapsed_seconds +=
+        Common::Timer::ConvertValueToSeconds(Common::Timer::GetCurrentValue() - start_time);
+
+      if (s_frame_hash_mode)
+        RegTestHost::WriteFrameHashes();
+
+      // The dump was closed when the system shut down, so it can be edited in place.
+      if (!audio_dump_filename.empty() && fade_seconds > 0.0f)
+        RegTestHost::ApplyAudioFadeOut(audio_dump_filename, fade_seconds);
+    }
+  }
+
+  if (!s_results_path.empty() && !RegTestHost::WriteGameResults())
+    goto cleanup;
+
+  if (!all_booted)
+    goto cleanup;
+
+  if (s_benchmark_mode && !RegTestHost::WriteBenchmarkResults(game_paths.front()))
+    goto cleanup;
 
   Log_InfoPrintf("Exiting with success.");
   result = 0;
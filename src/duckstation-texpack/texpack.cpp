@@ -0,0 +1,176 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "core/texture_pack.h"
+
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/path.h"
+#include "common/string_util.h"
+
+#include "fmt/format.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+Log_SetChannel(TexturePackTool);
+
+static void PrintCommandLineHelp(const char* progname)
+{
+  std::fprintf(stderr, "DuckStation Texture Pack Converter\n");
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "Usage: %s [parameters] <texture directory> <output pack>\n", progname);
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "  -help: Displays this information and exits.\n");
+  std::fprintf(stderr, "  -format <bc7|rgba8>: Format to store textures in. Defaults to bc7.\n");
+  std::fprintf(stderr, "  -levels <count>: Maximum number of mip levels to generate. Defaults to %u.\n",
+               TexturePack::MAX_LEVELS);
+  std::fprintf(stderr, "  -dumps <directory>: Directory of the original VRAM write dumps. Recording the size of the\n"
+                       "    writes lets uploads which can't match be skipped without hashing them.\n");
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "The output should be named textures.pack, and placed in the game's texture directory.\n");
+  std::fprintf(stderr, "Loose replacement files in the same directory take priority over the pack.\n");
+}
+
+static bool ParseReplacementFilename(const std::string& filename, u64* hash_low, u64* hash_high)
+{
+  const std::string_view title = Path::GetFileTitle(filename);
+  if (!StringUtil::StartsWithNoCase(title, "vram-write-") || title.length() != (11 + 32))
+    return false;
+
+  const std::string_view extension = Path::GetExtension(filename);
+  bool valid_extension = false;
+  for (const char* test_extension : {"png", "jpg", "tga", "bmp"})
+    valid_extension |= StringUtil::EqualNoCase(extension, test_extension);
+  if (!valid_extension)
+    return false;
+
+  const std::optional<u64> high = StringUtil::FromChars<u64>(title.substr(11, 16), 16);
+  const std::optional<u64> low = StringUtil::FromChars<u64>(title.substr(27, 16), 16);
+  if (!high.has_value() || !low.has_value())
+    return false;
+
+  *hash_low = low.value();
+  *hash_high = high.value();
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, false);
+
+  TexturePack::Format format = TexturePack::Format::BC7;
+  u32 max_levels = TexturePack::MAX_LEVELS;
+  std::vector<const char*> paths;
+  std::string dump_directory;
+
+  for (int i = 1; i < argc; i++)
+  {
+#define CHECK_ARG(str) !std::strcmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) (!std::strcmp(argv[i], str) && ((i + 1) < argc))
+
+    if (CHECK_ARG("-help"))
+    {
+      PrintCommandLineHelp(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    else if (CHECK_ARG_PARAM("-format"))
+    {
+      const std::optional<TexturePack::Format> parsed = TexturePack::ParseFormatName(argv[++i]);
+      if (!parsed.has_value())
+      {
+        Log_ErrorPrintf("Invalid format specified: %s", argv[i]);
+        return EXIT_FAILURE;
+      }
+
+      format = parsed.value();
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-levels"))
+    {
+      max_levels = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+      if (max_levels == 0 || max_levels > TexturePack::MAX_LEVELS)
+      {
+        Log_ErrorPrintf("Invalid level count specified: %s", argv[i]);
+        return EXIT_FAILURE;
+      }
+
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-dumps"))
+    {
+      dump_directory = argv[++i];
+      continue;
+    }
+    else if (argv[i][0] == '-')
+    {
+      Log_ErrorPrintf("Unknown parameter: '%s'", argv[i]);
+      return EXIT_FAILURE;
+    }
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+
+    paths.push_back(argv[i]);
+  }
+
+  if (paths.size() != 2)
+  {
+    PrintCommandLineHelp(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  FileSystem::FindResultsArray files;
+  FileSystem::FindFiles(paths[0], "vram-write-*", FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_RECURSIVE, &files);
+
+  std::vector<TexturePack::SourceTexture> textures;
+  u32 missing_dumps = 0;
+  for (FILESYSTEM_FIND_DATA& fd : files)
+  {
+    u64 hash_low, hash_high;
+    if (!ParseReplacementFilename(fd.FileName, &hash_low, &hash_high))
+    {
+      Log_WarningPrintf("Skipping '%s', not a replacement texture", fd.FileName.c_str());
+      continue;
+    }
+
+    // The dump is at the original size, the replacement usually isn't.
+    u16 source_width = 0, source_height = 0;
+    if (!dump_directory.empty())
+    {
+      const std::string dump_path =
+        Path::Combine(dump_directory, fmt::format("{}.png", Path::GetFileTitle(fd.FileName)));
+      Common::RGBA8Image dump;
+      if (FileSystem::FileExists(dump_path.c_str()) && dump.LoadFromFile(dump_path.c_str()))
+      {
+        source_width = static_cast<u16>(dump.GetWidth());
+        source_height = static_cast<u16>(dump.GetHeight());
+      }
+      else
+      {
+        missing_dumps++;
+      }
+    }
+
+    textures.push_back(
+      TexturePack::SourceTexture{hash_low, hash_high, source_width, source_height, std::move(fd.FileName)});
+  }
+
+  if (missing_dumps > 0)
+  {
+    Log_WarningPrintf("%u textures have no dump, uploads will be hashed regardless of size when using this pack.",
+                      missing_dumps);
+  }
+
+  if (textures.empty())
+  {
+    Log_ErrorPrintf("No replacement textures found in '%s'", paths[0]);
+    return EXIT_FAILURE;
+  }
+
+  Log_InfoPrintf("Converting %zu textures from '%s'", textures.size(), paths[0]);
+  return TexturePack::WritePack(paths[1], format, max_levels, std::move(textures)) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "util/cd_image.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/progress_callback.h"
+#include "common/string_util.h"
+
+#include "zstd.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+Log_SetChannel(ZCDConverter);
+
+static constexpr int DEFAULT_COMPRESSION_LEVEL = 19;
+
+static void PrintCommandLineHelp(const char* progname)
+{
+  std::fprintf(stderr, "DuckStation ZCD Disc Image Converter\n");
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "Usage: %s [parameters] <input image> <output zcd>\n", progname);
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "  -help: Displays this information and exits.\n");
+  std::fprintf(stderr, "  -level <level>: zstd compression level, 1 to %d. Defaults to %d.\n", ZSTD_maxCLevel(),
+               DEFAULT_COMPRESSION_LEVEL);
+  std::fprintf(stderr, "  -frame-sectors <count>: Number of sectors compressed together. Defaults to %u.\n",
+               static_cast<u32>(CDImage::DEFAULT_ZCD_SECTORS_PER_FRAME));
+  std::fprintf(stderr, "  -dictionary <path>: Dictionary to compress with, stored in the output. Can be one\n"
+                       "    trained by zstd --train, or raw content such as another disc from the same series.\n");
+  std::fprintf(stderr, "\n");
+  std::fprintf(stderr, "Larger frames compress better, smaller frames decompress less data for each seek.\n");
+  std::fprintf(stderr, "All cores are used to compress, decompression speed barely depends on the level.\n");
+}
+
+int main(int argc, char* argv[])
+{
+  Log::SetConsoleOutputParams(true, false);
+
+  int level = DEFAULT_COMPRESSION_LEVEL;
+  u32 sectors_per_frame = CDImage::DEFAULT_ZCD_SECTORS_PER_FRAME;
+  std::vector<u8> dictionary;
+  std::vector<const char*> paths;
+
+  for (int i = 1; i < argc; i++)
+  {
+#define CHECK_ARG(str) !std::strcmp(argv[i], str)
+#define CHECK_ARG_PARAM(str) (!std::strcmp(argv[i], str) && ((i + 1) < argc))
+
+    if (CHECK_ARG("-help"))
+    {
+      PrintCommandLineHelp(argv[0]);
+      return EXIT_SUCCESS;
+    }
+    else if (CHECK_ARG_PARAM("-level"))
+    {
+      level = StringUtil::FromChars<int>(argv[++i]).value_or(0);
+      if (level < 1 || level > ZSTD_maxCLevel())
+      {
+        Log_ErrorPrintf("Invalid compression level specified: %s", argv[i]);
+        return EXIT_FAILURE;
+      }
+
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-frame-sectors"))
+    {
+      sectors_per_frame = StringUtil::FromChars<u32>(argv[++i]).value_or(0);
+      if (sectors_per_frame == 0)
+      {
+        Log_ErrorPrintf("Invalid frame size specified: %s", argv[i]);
+        return EXIT_FAILURE;
+      }
+
+      continue;
+    }
+    else if (CHECK_ARG_PARAM("-dictionary"))
+    {
+      Error error;
+      std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(argv[++i], &error);
+      if (!data.has_value() || data->empty())
+      {
+        Log_ErrorPrintf("Failed to read dictionary '%s': %s", argv[i], error.GetDescription().c_str());
+        return EXIT_FAILURE;
+      }
+
+      dictionary = std::move(data.value());
+      continue;
+    }
+    else if (argv[i][0] == '-')
+    {
+      Log_ErrorPrintf("Unknown parameter: '%s'", argv[i]);
+      return EXIT_FAILURE;
+    }
+
+#undef CHECK_ARG
+#undef CHECK_ARG_PARAM
+
+    paths.push_back(argv[i]);
+  }
+
+  if (paths.size() != 2)
+  {
+    PrintCommandLineHelp(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Error error;
+  std::unique_ptr<CDImage> image = CDImage::Open(paths[0], false, &error);
+  if (!image)
+  {
+    Log_ErrorPrintf("Failed to open '%s': %s", paths[0], error.GetDescription().c_str());
+    return EXIT_FAILURE;
+  }
+
+  Log_InfoPrintf("Converting '%s' (%u tracks, %u sectors) at level %d, %u sectors per frame", paths[0],
+                 image->GetTrackCount(), image->GetLBACount(), level, sectors_per_frame);
+
+  ConsoleProgressCallback progress;
+  if (!CDImage::WriteZCDImage(image.get(), paths[1], sectors_per_frame, level, dictionary, &progress, &error))
+  {
+    Log_ErrorPrintf("Failed to write '%s': %s", paths[1], error.GetDescription().c_str());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
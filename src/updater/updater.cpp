@@ -9,14 +9,19 @@
 #include "common/minizip_helpers.h"
 #include "common/path.h"
 #include "common/progress_callback.h"
+#include "common/sha1_digest.h"
 #include "common/string_util.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef _WIN32
@@ -30,6 +35,12 @@
 #include "common/cocoa_tools.h"
 #endif
 
+// Lists the files a delta package was built against, and the files it removes. Each line is either
+// "base <sha1> <path>" or "remove <path>", with paths relative to the installation and using forward slashes.
+static constexpr const char* DELTA_MANIFEST_FILENAME = "update_delta.txt";
+
+static constexpr u32 MAX_EXTRACT_THREADS = 8;
+
 Updater::Updater(ProgressCallback* progress) : m_progress(progress)
 {
   progress->SetTitle("DuckStation Update Installer");
@@ -56,8 +67,9 @@ bool Updater::OpenUpdateZip(const char* path)
   if (!m_zf)
     return false;
 
+  m_zip_path = path;
   m_progress->SetStatusText("Parsing update zip...");
-  return ParseZip();
+  return ParseZip() && ParseDeltaManifest();
 }
 
 bool Updater::RecursiveDeleteDirectory(const char* path, bool remove_dir)
@@ -155,7 +167,8 @@ bool Updater::ParseZip()
       const char* filename_to_add = zip_filename_buffer;
 #ifdef _WIN32
       // skip updater itself, since it was already pre-extracted.
-      process_file = process_file && (StringUtil::Strcasecmp(zip_filename_buffer, "updater.exe") != 0);
+      process_file = process_file && (StringUtil::Strcasecmp(zip_filename_buffer, "updater.exe") != 0) &&
+                     (std::strcmp(zip_filename_buffer, DELTA_MANIFEST_FILENAME) != 0);
 #elif defined(__APPLE__)
       // on MacOS, we want to remove the DuckStation.app prefix.
       static constexpr const char* PREFIX_PATH = "DuckStation.app/";
@@ -181,7 +194,8 @@ bool Updater::ParseZip()
     }
   }
 
-  if (m_update_paths.empty())
+  // A delta which only removes files is still valid.
+  if (m_update_paths.empty() && unzLocateFile(m_zf, DELTA_MANIFEST_FILENAME, 0) != UNZ_OK)
   {
     m_progress->ModalError("No files found in update zip.");
     return false;
@@ -211,6 +225,115 @@ bool Updater::ParseZip()
   return true;
 }
 
+bool Updater::ParseDeltaManifest()
+{
+  if (unzLocateFile(m_zf, DELTA_MANIFEST_FILENAME, 0) != UNZ_OK)
+    return true;
+
+  std::string manifest;
+  if (!ReadCurrentZipFile(m_zf, &manifest))
+  {
+    m_progress->ModalError("Failed to read delta manifest from update zip.");
+    return false;
+  }
+
+  m_is_delta = true;
+  m_progress->DisplayFormattedInformation("Update is a delta package with %zu files.", m_update_paths.size());
+
+  for (const std::string_view& line : StringUtil::SplitString(manifest, '\n'))
+  {
+    const std::string_view stripped_line = StringUtil::StripWhitespace(line);
+    if (stripped_line.empty())
+      continue;
+
+    const std::string_view::size_type command_end = stripped_line.find(' ');
+    const std::string_view command = stripped_line.substr(0, command_end);
+    const std::string_view args =
+      (command_end != std::string_view::npos) ? StringUtil::StripWhitespace(stripped_line.substr(command_end)) : "";
+
+    std::string filename;
+    if (command == "base")
+    {
+      const std::string_view::size_type hash_end = args.find(' ');
+      if (hash_end == std::string_view::npos)
+      {
+        m_progress->DisplayFormattedModalError("Invalid line in delta manifest: '%.*s'",
+                                               static_cast<int>(stripped_line.size()), stripped_line.data());
+        return false;
+      }
+
+      filename = StringUtil::StripWhitespace(args.substr(hash_end));
+      std::replace(filename.begin(), filename.end(), '/', FS_OSPATH_SEPARATOR_CHARACTER);
+      if (!CheckDeltaBaseFile(filename, std::string(args.substr(0, hash_end))))
+        return false;
+    }
+    else if (command == "remove" && !args.empty())
+    {
+      filename = args;
+      std::replace(filename.begin(), filename.end(), '/', FS_OSPATH_SEPARATOR_CHARACTER);
+      m_progress->DisplayFormattedInformation("Delta removes '%s'", filename.c_str());
+      m_delta_removed_files.push_back(std::move(filename));
+    }
+    else
+    {
+      m_progress->DisplayFormattedModalError("Invalid line in delta manifest: '%.*s'",
+                                             static_cast<int>(stripped_line.size()), stripped_line.data());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool Updater::CheckDeltaBaseFile(const std::string& filename, const std::string& expected_hash)
+{
+  // Unchanged files are kept from the installation, so applying a delta to any other version would mix the two.
+  const std::string path = Path::Combine(m_destination_directory, filename);
+  auto fp = FileSystem::OpenManagedCFile(path.c_str(), "rb");
+  if (!fp)
+  {
+    m_progress->DisplayFormattedModalError(
+      "'%s' is missing from your installation, this delta update cannot be applied. Please download the full update.",
+      filename.c_str());
+    return false;
+  }
+
+  SHA1Digest digest;
+  std::vector<u8> buffer(64 * 1024);
+  size_t bytes_read;
+  while ((bytes_read = std::fread(buffer.data(), 1, buffer.size(), fp.get())) > 0)
+    digest.Update(buffer.data(), static_cast<u32>(bytes_read));
+
+  u8 hash[SHA1Digest::DIGEST_SIZE];
+  digest.Final(hash);
+  const std::string hash_str = SHA1Digest::DigestToString(hash);
+  if (!StringUtil::EqualNoCase(hash_str, expected_hash))
+  {
+    m_progress->DisplayFormattedModalError(
+      "'%s' does not match the version this delta update was built for (%s, expected %s). Please download the full "
+      "update.",
+      filename.c_str(), hash_str.c_str(), expected_hash.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+bool Updater::ReadCurrentZipFile(unzFile zf, std::string* out)
+{
+  unz_file_info64 file_info;
+  if (unzGetCurrentFileInfo64(zf, &file_info, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK ||
+      unzOpenCurrentFile(zf) != UNZ_OK)
+  {
+    return false;
+  }
+
+  out->resize(static_cast<size_t>(file_info.uncompressed_size));
+  const int byte_count = unzReadCurrentFile(zf, out->data(), static_cast<unsigned>(out->size()));
+  unzCloseCurrentFile(zf);
+  return (byte_count >= 0 && static_cast<size_t>(byte_count) == out->size());
+}
+
 bool Updater::PrepareStagingDirectory()
 {
   if (FileSystem::DirectoryExists(m_staging_directory.c_str()))
@@ -246,88 +369,165 @@ bool Updater::PrepareStagingDirectory()
   return true;
 }
 
-bool Updater::StageUpdate()
+bool Updater::ExtractFile(unzFile zf, const std::string& staging_directory, const FileToUpdate& ftu,
+                          std::string* error)
 {
-  m_progress->SetProgressRange(static_cast<u32>(m_update_paths.size()));
-  m_progress->SetProgressValue(0);
+  if (unzLocateFile(zf, ftu.original_zip_filename.c_str(), 0) != UNZ_OK)
+  {
+    *error = StringUtil::StdStringFromFormat("Unable to locate file '%s' in zip", ftu.original_zip_filename.c_str());
+    return false;
+  }
+  else if (unzOpenCurrentFile(zf) != UNZ_OK)
+  {
+    *error = StringUtil::StdStringFromFormat("Failed to open file '%s' in zip", ftu.original_zip_filename.c_str());
+    return false;
+  }
 
-  for (const FileToUpdate& ftu : m_update_paths)
+  const std::string destination_file = StringUtil::StdStringFromFormat(
+    "%s" FS_OSPATH_SEPARATOR_STR "%s", staging_directory.c_str(), ftu.destination_filename.c_str());
+  std::FILE* fp = FileSystem::OpenCFile(destination_file.c_str(), "wb");
+  if (!fp)
   {
-    m_progress->SetFormattedStatusText("Extracting '%s' (mode %o)...", ftu.original_zip_filename.c_str(),
-                                       ftu.file_mode);
+    *error = StringUtil::StdStringFromFormat("Failed to open staging output file '%s'", destination_file.c_str());
+    unzCloseCurrentFile(zf);
+    return false;
+  }
 
-    if (unzLocateFile(m_zf, ftu.original_zip_filename.c_str(), 0) != UNZ_OK)
+  static constexpr u32 CHUNK_SIZE = 64 * 1024;
+  std::unique_ptr<u8[]> buffer = std::make_unique<u8[]>(CHUNK_SIZE);
+  for (;;)
+  {
+    int byte_count = unzReadCurrentFile(zf, buffer.get(), CHUNK_SIZE);
+    if (byte_count < 0)
     {
-      m_progress->DisplayFormattedModalError("Unable to locate file '%s' in zip", ftu.original_zip_filename.c_str());
+      *error = StringUtil::StdStringFromFormat("Failed to read file '%s' from zip", ftu.original_zip_filename.c_str());
+      std::fclose(fp);
+      FileSystem::DeleteFile(destination_file.c_str());
+      unzCloseCurrentFile(zf);
       return false;
     }
-    else if (unzOpenCurrentFile(m_zf) != UNZ_OK)
+    else if (byte_count == 0)
     {
-      m_progress->DisplayFormattedModalError("Failed to open file '%s' in zip", ftu.original_zip_filename.c_str());
-      return false;
+      // end of file
+      break;
     }
 
-    m_progress->DisplayFormattedInformation("Extracting '%s'...", ftu.destination_filename.c_str());
+    if (std::fwrite(buffer.get(), static_cast<size_t>(byte_count), 1, fp) != 1)
+    {
+      *error = StringUtil::StdStringFromFormat("Failed to write to file '%s'", destination_file.c_str());
+      std::fclose(fp);
+      FileSystem::DeleteFile(destination_file.c_str());
+      unzCloseCurrentFile(zf);
+      return false;
+    }
+  }
 
-    const std::string destination_file = StringUtil::StdStringFromFormat(
-      "%s" FS_OSPATH_SEPARATOR_STR "%s", m_staging_directory.c_str(), ftu.destination_filename.c_str());
-    std::FILE* fp = FileSystem::OpenCFile(destination_file.c_str(), "wb");
-    if (!fp)
+#ifndef _WIN32
+  if (ftu.file_mode != 0)
+  {
+    const int fd = fileno(fp);
+    const int res = (fd >= 0) ? fchmod(fd, ftu.file_mode) : -1;
+    if (res < 0)
     {
-      m_progress->DisplayFormattedModalError("Failed to open staging output file '%s'", destination_file.c_str());
-      unzCloseCurrentFile(m_zf);
+      *error = StringUtil::StdStringFromFormat("Failed to set mode for file '%s' (fd %d) to %u: errno %d",
+                                               destination_file.c_str(), fd, res, errno);
+      std::fclose(fp);
+      FileSystem::DeleteFile(destination_file.c_str());
+      unzCloseCurrentFile(zf);
       return false;
     }
+  }
+#endif
 
-    static constexpr u32 CHUNK_SIZE = 4096;
-    u8 buffer[CHUNK_SIZE];
-    for (;;)
+  std::fclose(fp);
+  unzCloseCurrentFile(zf);
+  return true;
+}
+
+bool Updater::StageUpdate()
+{
+  const u32 file_count = static_cast<u32>(m_update_paths.size());
+  m_progress->SetProgressRange(file_count);
+  m_progress->SetProgressValue(0);
+  m_progress->SetStatusText("Extracting update...");
+  for (const FileToUpdate& ftu : m_update_paths)
+    m_progress->DisplayFormattedInformation("Extracting '%s' (mode %o)...", ftu.original_zip_filename.c_str(),
+                                            ftu.file_mode);
+
+  const u32 thread_count = std::min(std::min(std::thread::hardware_concurrency(), file_count), MAX_EXTRACT_THREADS);
+  if (thread_count <= 1)
+  {
+    std::string error;
+    for (const FileToUpdate& ftu : m_update_paths)
     {
-      int byte_count = unzReadCurrentFile(m_zf, buffer, CHUNK_SIZE);
-      if (byte_count < 0)
+      if (!ExtractFile(m_zf, m_staging_directory, ftu, &error))
       {
-        m_progress->DisplayFormattedModalError("Failed to read file '%s' from zip", ftu.original_zip_filename.c_str());
-        std::fclose(fp);
-        FileSystem::DeleteFile(destination_file.c_str());
-        unzCloseCurrentFile(m_zf);
+        m_progress->ModalError(error.c_str());
         return false;
       }
-      else if (byte_count == 0)
-      {
-        // end of file
+
+      m_progress->IncrementProgressValue();
+    }
+
+    return true;
+  }
+
+  // minizip handles can't be shared, so each thread opens the zip for itself and takes files until they run out.
+  // Progress is only reported from this thread, since the progress callbacks drive the UI.
+  std::atomic<u32> next_file{0};
+  std::atomic<u32> files_done{0};
+  std::atomic_bool failed{false};
+  std::mutex error_mutex;
+  std::string error;
+
+  auto extract_files = [this, &next_file, &files_done, &failed, &error_mutex, &error](unzFile zf) {
+    std::string file_error;
+    for (;;)
+    {
+      const u32 index = next_file.fetch_add(1, std::memory_order_relaxed);
+      if (index >= m_update_paths.size() || failed.load(std::memory_order_relaxed))
         break;
-      }
 
-      if (std::fwrite(buffer, static_cast<size_t>(byte_count), 1, fp) != 1)
+      if (!zf || !ExtractFile(zf, m_staging_directory, m_update_paths[index], &file_error))
       {
-        m_progress->DisplayFormattedModalError("Failed to write to file '%s'", destination_file.c_str());
-        std::fclose(fp);
-        FileSystem::DeleteFile(destination_file.c_str());
-        unzCloseCurrentFile(m_zf);
-        return false;
+        std::unique_lock lock(error_mutex);
+        if (!failed.exchange(true))
+          error = zf ? std::move(file_error) : std::string("Failed to reopen update zip");
+        break;
       }
+
+      files_done.fetch_add(1, std::memory_order_release);
     }
 
-#ifndef _WIN32
-    if (ftu.file_mode != 0)
+    if (zf)
+      unzClose(zf);
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count);
+  for (u32 i = 0; i < thread_count; i++)
+    threads.emplace_back(extract_files, MinizipHelpers::OpenUnzFile(m_zip_path.c_str()));
+
+  u32 files_reported = 0;
+  while (files_reported < file_count && !failed.load(std::memory_order_relaxed))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    const u32 done = files_done.load(std::memory_order_acquire);
+    if (done != files_reported)
     {
-      const int fd = fileno(fp);
-      const int res = (fd >= 0) ? fchmod(fd, ftu.file_mode) : -1;
-      if (res < 0)
-      {
-        m_progress->DisplayFormattedModalError("Failed to set mode for file '%s' (fd %d) to %u: errno %d",
-                                               destination_file.c_str(), fd, res, errno);
-        std::fclose(fp);
-        FileSystem::DeleteFile(destination_file.c_str());
-        unzCloseCurrentFile(m_zf);
-        return false;
-      }
+      files_reported = done;
+      m_progress->SetProgressValue(done);
     }
-#endif
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
 
-    std::fclose(fp);
-    unzCloseCurrentFile(m_zf);
-    m_progress->IncrementProgressValue();
+  if (failed.load(std::memory_order_relaxed))
+  {
+    m_progress->ModalError(error.c_str());
+    return false;
   }
 
   return true;
@@ -379,6 +579,17 @@ bool Updater::CommitUpdate()
     }
   }
 
+  for (const std::string& filename : m_delta_removed_files)
+  {
+    const std::string dest_file_name = Path::Combine(m_destination_directory, filename);
+    if (!FileSystem::FileExists(dest_file_name.c_str()))
+      continue;
+
+    m_progress->DisplayFormattedInformation("Removing '%s'", dest_file_name.c_str());
+    if (!FileSystem::DeleteFile(dest_file_name.c_str()))
+      m_progress->DisplayFormattedWarning("Failed to remove '%s'", dest_file_name.c_str());
+  }
+
   return true;
 }
 
@@ -391,5 +602,9 @@ void Updater::CleanupStagingDirectory()
 
 bool Updater::ClearDestinationDirectory()
 {
+  // Deltas keep the unchanged files, the ones they drop are removed by CommitUpdate() instead.
+  if (m_is_delta)
+    return true;
+
   return RecursiveDeleteDirectory(m_destination_directory.c_str(), false);
 }
@@ -33,13 +33,23 @@ private:
   };
 
   bool ParseZip();
+  bool ParseDeltaManifest();
+  bool CheckDeltaBaseFile(const std::string& filename, const std::string& expected_hash);
+  static bool ReadCurrentZipFile(unzFile zf, std::string* out);
+  static bool ExtractFile(unzFile zf, const std::string& staging_directory, const FileToUpdate& ftu,
+                          std::string* error);
 
+  std::string m_zip_path;
   std::string m_staging_directory;
   std::string m_destination_directory;
 
   std::vector<FileToUpdate> m_update_paths;
   std::vector<std::string> m_update_directories;
 
+  // Delta packages only contain the files which changed since the version they were built against.
+  std::vector<std::string> m_delta_removed_files;
+  bool m_is_delta = false;
+
   ProgressCallback* m_progress;
   unzFile m_zf = nullptr;
 };
@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "common/intrin.h"
 #include "common/log.h"
+#include "common/threading.h"
 #include "common/timer.h"
 
 #include "SoundTouch.h"
@@ -27,6 +28,7 @@ AudioStream::AudioStream(u32 sample_rate, u32 channels, u32 buffer_ms, AudioStre
 
 AudioStream::~AudioStream()
 {
+  StretchDestroy();
   DestroyBuffer();
 }
 
@@ -89,9 +91,32 @@ u32 AudioStream::GetBufferedFramesRelaxed() const
   return (wpos + m_buffer_size - rpos) % m_buffer_size;
 }
 
+u32 AudioStream::GetReadableFrames() const
+{
+  // acquire on the writer's position, so the frames it published are visible
+  const u32 rpos = m_rpos.load(std::memory_order_relaxed);
+  const u32 wpos = m_wpos.load(std::memory_order_acquire);
+  return (wpos + m_buffer_size - rpos) % m_buffer_size;
+}
+
+u32 AudioStream::GetWritableFrames() const
+{
+  // acquire on the reader's position, so it's finished with the frames before they're overwritten
+  const u32 rpos = m_rpos.load(std::memory_order_acquire);
+  const u32 wpos = m_wpos.load(std::memory_order_relaxed);
+  return m_buffer_size - ((wpos + m_buffer_size - rpos) % m_buffer_size);
+}
+
 void AudioStream::ReadFrames(s16* bData, u32 nFrames)
 {
-  const u32 available_frames = GetBufferedFramesRelaxed();
+  // Overruns are resolved here, since only the reader can move the read position.
+  if (m_discard_frames.load(std::memory_order_relaxed) > 0)
+  {
+    const u32 discard = std::min(m_discard_frames.exchange(0, std::memory_order_acquire), GetReadableFrames());
+    m_rpos.store((m_rpos.load(std::memory_order_relaxed) + discard) % m_buffer_size, std::memory_order_release);
+  }
+
+  const u32 available_frames = GetReadableFrames();
   u32 frames_to_read = nFrames;
   u32 silence_frames = 0;
 
@@ -117,6 +142,7 @@ void AudioStream::ReadFrames(s16* bData, u32 nFrames)
     silence_frames = frames_to_read - available_frames;
     frames_to_read = available_frames;
     m_filling = true;
+    m_underrun_count.fetch_add(1, std::memory_order_relaxed);
 
     if (m_stretch_mode == AudioStretchMode::TimeStretch)
       StretchUnderrun();
@@ -124,7 +150,7 @@ void AudioStream::ReadFrames(s16* bData, u32 nFrames)
 
   if (frames_to_read > 0)
   {
-    u32 rpos = m_rpos.load(std::memory_order_acquire);
+    u32 rpos = m_rpos.load(std::memory_order_relaxed);
 
     u32 end = m_buffer_size - rpos;
     if (end > frames_to_read)
@@ -186,18 +212,15 @@ void AudioStream::ReadFrames(s16* bData, u32 nFrames)
 
 void AudioStream::InternalWriteFrames(s32* bData, u32 nSamples)
 {
-  const u32 free = m_buffer_size - GetBufferedFramesRelaxed();
+  const u32 free = GetWritableFrames();
   if (free <= nSamples)
   {
     if (m_stretch_mode == AudioStretchMode::TimeStretch)
-    {
       StretchOverrun();
-    }
     else
-    {
       Log_DebugPrintf("Buffer overrun, chunk dropped");
-      return;
-    }
+
+    return;
   }
 
   u32 wpos = m_wpos.load(std::memory_order_acquire);
@@ -256,9 +279,15 @@ void AudioStream::EmptyBuffer()
 {
   if (m_stretch_mode != AudioStretchMode::Off)
   {
+    // Holding the lock keeps the stretch thread out, so it's safe to drop its input and output.
+    std::unique_lock lock(m_stretch_mutex);
+    m_stretch_input_rpos.store(m_stretch_input_wpos.load(std::memory_order_relaxed), std::memory_order_relaxed);
     m_soundtouch->clear();
     if (m_stretch_mode == AudioStretchMode::TimeStretch)
       m_soundtouch->setTempo(m_nominal_rate);
+
+    m_wpos.store(m_rpos.load(std::memory_order_acquire), std::memory_order_release);
+    return;
   }
 
   m_wpos.store(m_rpos.load(std::memory_order_acquire), std::memory_order_release);
@@ -266,6 +295,7 @@ void AudioStream::EmptyBuffer()
 
 void AudioStream::SetNominalRate(float tempo)
 {
+  std::unique_lock lock(m_stretch_mutex);
   m_nominal_rate = tempo;
   if (m_stretch_mode == AudioStretchMode::Resample)
     m_soundtouch->setRate(tempo);
@@ -276,6 +306,8 @@ void AudioStream::UpdateTargetTempo(float tempo)
   if (m_stretch_mode != AudioStretchMode::TimeStretch)
     return;
 
+  std::unique_lock lock(m_stretch_mutex);
+
   // undo sqrt()
   if (tempo)
     tempo *= tempo;
@@ -300,8 +332,8 @@ void AudioStream::SetStretchMode(AudioStretchMode mode)
   if (!paused)
     SetPaused(true);
 
-  DestroyBuffer();
   StretchDestroy();
+  DestroyBuffer();
   m_stretch_mode = mode;
 
   AllocateBuffer();
@@ -348,7 +380,7 @@ void AudioStream::EndWrite(u32 num_frames)
   m_staging_buffer_pos = 0;
 
   if (m_stretch_mode != AudioStretchMode::Off)
-    StretchWrite();
+    StretchQueueChunk();
   else
     InternalWriteFrames(m_staging_buffer.data(), CHUNK_SIZE);
 }
@@ -522,24 +554,79 @@ void AudioStream::StretchAllocate()
   m_average_available = 0;
 
   m_staging_buffer_pos = 0;
+
+  m_stretch_input = std::make_unique<std::array<s32, CHUNK_SIZE>[]>(STRETCH_INPUT_CHUNKS);
+  m_stretch_input_rpos.store(0, std::memory_order_relaxed);
+  m_stretch_input_wpos.store(0, std::memory_order_relaxed);
+  m_stretch_underruns.store(0, std::memory_order_relaxed);
+  m_stretch_thread_shutdown.store(false, std::memory_order_relaxed);
+  m_stretch_sema = std::make_unique<Threading::KernelSemaphore>();
+  m_stretch_thread = std::thread(&AudioStream::StretchThreadEntryPoint, this);
 }
 
 void AudioStream::StretchDestroy()
 {
+  if (m_stretch_thread.joinable())
+  {
+    m_stretch_thread_shutdown.store(true, std::memory_order_release);
+    m_stretch_sema->Post();
+    m_stretch_thread.join();
+  }
+
+  m_stretch_sema.reset();
+  m_stretch_input.reset();
   m_soundtouch.reset();
 }
 
-void AudioStream::StretchWrite()
+void AudioStream::StretchQueueChunk()
+{
+  // Stretching can take a while, especially when catching up, so it's done off the emulation thread. If the
+  // stretcher has fallen this far behind, the output has already underrun, so dropping input won't make it worse.
+  const u32 wpos = m_stretch_input_wpos.load(std::memory_order_relaxed);
+  const u32 next_wpos = (wpos + 1) % STRETCH_INPUT_CHUNKS;
+  if (next_wpos == m_stretch_input_rpos.load(std::memory_order_acquire))
+  {
+    Log_DebugPrintf("Stretch queue full, chunk dropped");
+    return;
+  }
+
+  std::memcpy(m_stretch_input[wpos].data(), m_staging_buffer.data(), sizeof(m_staging_buffer));
+  m_stretch_input_wpos.store(next_wpos, std::memory_order_release);
+  m_stretch_sema->Post();
+}
+
+void AudioStream::StretchThreadEntryPoint()
 {
-  S16ChunkToFloat(m_staging_buffer.data(), m_float_buffer.data());
+  Threading::SetNameOfCurrentThread("Audio Stretch");
+
+  for (;;)
+  {
+    m_stretch_sema->Wait();
+    if (m_stretch_thread_shutdown.load(std::memory_order_acquire))
+      break;
+
+    std::unique_lock lock(m_stretch_mutex);
+    u32 rpos = m_stretch_input_rpos.load(std::memory_order_relaxed);
+    while (rpos != m_stretch_input_wpos.load(std::memory_order_acquire))
+    {
+      StretchWrite(m_stretch_input[rpos].data());
+      rpos = (rpos + 1) % STRETCH_INPUT_CHUNKS;
+      m_stretch_input_rpos.store(rpos, std::memory_order_release);
+    }
+  }
+}
+
+void AudioStream::StretchWrite(const s32* chunk)
+{
+  S16ChunkToFloat(chunk, m_float_buffer.data());
 
   m_soundtouch->putSamples(m_float_buffer.data(), CHUNK_SIZE);
 
   int tempProgress;
   while (tempProgress = m_soundtouch->receiveSamples((float*)m_float_buffer.data(), CHUNK_SIZE), tempProgress != 0)
   {
-    FloatChunkToS16(m_staging_buffer.data(), m_float_buffer.data(), tempProgress);
-    InternalWriteFrames(m_staging_buffer.data(), tempProgress);
+    FloatChunkToS16(m_stretch_output_buffer.data(), m_float_buffer.data(), tempProgress);
+    InternalWriteFrames(m_stretch_output_buffer.data(), tempProgress);
   }
 
   if (m_stretch_mode == AudioStretchMode::TimeStretch)
@@ -580,6 +667,9 @@ void AudioStream::UpdateStretchTempo()
 
   float base_target_usage = static_cast<float>(m_target_buffer_size) * m_nominal_rate;
 
+  // underruns are counted on the backend thread
+  m_stretch_reset += m_stretch_underruns.exchange(0, std::memory_order_relaxed);
+
   // state vars
   if (m_stretch_reset >= STRETCH_RESET_THRESHOLD)
   {
@@ -662,8 +752,8 @@ void AudioStream::UpdateStretchTempo()
 
 void AudioStream::StretchUnderrun()
 {
-  // Didn't produce enough frames in time.
-  m_stretch_reset++;
+  // Didn't produce enough frames in time. Called from the backend thread, picked up on the next tempo update.
+  m_stretch_underruns.fetch_add(1, std::memory_order_relaxed);
 }
 
 void AudioStream::StretchOverrun()
@@ -671,7 +761,7 @@ void AudioStream::StretchOverrun()
   // Produced more frames than can fit in the buffer.
   m_stretch_reset++;
 
-  // Drop two packets to give the time stretcher a bit more time to slow things down.
-  const u32 discard = CHUNK_SIZE * 2;
-  m_rpos.store((m_rpos.load(std::memory_order_acquire) + discard) % m_buffer_size, std::memory_order_release);
+  // Drop two packets to give the time stretcher a bit more time to slow things down. The reader does the actual
+  // discarding, since it owns the read position.
+  m_discard_frames.store(CHUNK_SIZE * 2, std::memory_order_release);
 }
@@ -6,8 +6,10 @@
 #include <array>
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifdef _MSC_VER
@@ -19,6 +21,10 @@ namespace soundtouch {
 class SoundTouch;
 }
 
+namespace Threading {
+class KernelSemaphore;
+}
+
 enum class AudioStretchMode : u8
 {
   Off,
@@ -57,6 +63,9 @@ public:
   ALWAYS_INLINE float GetNominalTempo() const { return m_nominal_rate; }
   ALWAYS_INLINE bool IsPaused() const { return m_paused; }
 
+  /// Number of times the backend has run out of frames and played silence, since the stream was created.
+  ALWAYS_INLINE u32 GetUnderrunCount() const { return m_underrun_count.load(std::memory_order_relaxed); }
+
   u32 GetBufferedFramesRelaxed() const;
 
   /// Temporarily pauses the stream, preventing it from requesting data.
@@ -113,16 +122,22 @@ private:
     AVERAGING_WINDOW = 50,
     STRETCH_RESET_THRESHOLD = 5,
     TARGET_IPS = 691,
+    STRETCH_INPUT_CHUNKS = 32,
   };
 
   void AllocateBuffer();
   void DestroyBuffer();
 
+  u32 GetReadableFrames() const;
+  u32 GetWritableFrames() const;
+
   void InternalWriteFrames(s32* bData, u32 nFrames);
 
   void StretchAllocate();
   void StretchDestroy();
-  void StretchWrite();
+  void StretchQueueChunk();
+  void StretchThreadEntryPoint();
+  void StretchWrite(const s32* chunk);
   void StretchUnderrun();
   void StretchOverrun();
 
@@ -132,10 +147,24 @@ private:
   u32 m_buffer_size = 0;
   std::unique_ptr<s32[]> m_buffer;
 
+  // Output ring. Written by the emulation thread, or the stretch thread when stretching, and read by the backend.
+  // Each position is only ever stored by one side; the other side requests discards/reports underruns instead.
   std::atomic<u32> m_rpos{0};
   std::atomic<u32> m_wpos{0};
+  std::atomic<u32> m_discard_frames{0};
+  std::atomic<u32> m_stretch_underruns{0};
+  std::atomic<u32> m_underrun_count{0};
 
+  // Stretching runs on its own thread, fed by a ring of chunks from the emulation thread. The mutex protects
+  // SoundTouch and the tempo state, and is only contended when the emulation thread changes the rate.
   std::unique_ptr<soundtouch::SoundTouch> m_soundtouch;
+  std::unique_ptr<std::array<s32, CHUNK_SIZE>[]> m_stretch_input;
+  std::atomic<u32> m_stretch_input_rpos{0};
+  std::atomic<u32> m_stretch_input_wpos{0};
+  std::atomic_bool m_stretch_thread_shutdown{false};
+  std::unique_ptr<Threading::KernelSemaphore> m_stretch_sema;
+  std::thread m_stretch_thread;
+  std::mutex m_stretch_mutex;
 
   u32 m_target_buffer_size = 0;
   u32 m_stretch_reset = STRETCH_RESET_THRESHOLD;
@@ -150,8 +179,9 @@ private:
 
   std::array<float, AVERAGING_BUFFER_SIZE> m_average_fullness = {};
 
-  // temporary staging buffer, used for timestretching
+  // staging buffer for writes, and output of the stretcher
   alignas(16) std::array<s32, CHUNK_SIZE> m_staging_buffer;
+  alignas(16) std::array<s32, CHUNK_SIZE> m_stretch_output_buffer;
 
   // float buffer, soundtouch only accepts float samples as input
   alignas(16) std::array<float, CHUNK_SIZE * MAX_CHANNELS> m_float_buffer;
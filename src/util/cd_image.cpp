@@ -9,6 +9,7 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include <algorithm>
 #include <array>
 Log_SetChannel(CDImage);
 
@@ -93,6 +94,10 @@ std::unique_ptr<CDImage> CDImage::Open(const char* filename, bool allow_patches,
   {
     image = OpenPBPImage(filename, error);
   }
+  else if (StringUtil::Strcasecmp(extension, ".zcd") == 0)
+  {
+    image = OpenZCDImage(filename, error);
+  }
   else if (StringUtil::Strcasecmp(extension, ".m3u") == 0)
   {
     image = OpenM3uImage(filename, allow_patches, error);
@@ -334,6 +339,32 @@ bool CDImage::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_
   return true;
 }
 
+void CDImage::Readahead(u32 sector_count)
+{
+  if (!m_current_index)
+    return;
+
+  // Runs on into the following indices, as long as they have data in a file.
+  const Index* const indices_end = m_indices.data() + m_indices.size();
+  LBA lba_in_index = m_position_in_index;
+  for (const Index* index = m_current_index; index != indices_end && sector_count > 0; index++)
+  {
+    if (lba_in_index < index->length)
+    {
+      const u32 count = std::min(sector_count, index->length - lba_in_index);
+      if (index->file_sector_size > 0)
+        ReadaheadIndex(*index, lba_in_index, count);
+      sector_count -= count;
+    }
+
+    lba_in_index = 0;
+  }
+}
+
+void CDImage::ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count)
+{
+}
+
 bool CDImage::HasNonStandardSubchannel() const
 {
   return false;
@@ -34,6 +34,8 @@ public:
     SUBCHANNEL_BYTES_PER_FRAME = 12,
     LEAD_OUT_SECTOR_COUNT = 6750,
     ALL_SUBCODE_SIZE = 96,
+    DEFAULT_CHD_HUNK_CACHE_SIZE = 16,
+    DEFAULT_ZCD_SECTORS_PER_FRAME = 16,
   };
 
   enum : u8
@@ -239,6 +241,9 @@ public:
   /// Returns true if the specified filename is a CD-ROM device name.
   static bool IsDeviceName(const char* filename);
 
+  /// Sets the number of decompressed hunks kept in memory for CHD images opened after this call.
+  static void SetCHDHunkCacheSize(u32 hunks);
+
   // Opening disc image.
   static std::unique_ptr<CDImage> Open(const char* filename, bool allow_patches, Error* error);
   static std::unique_ptr<CDImage> OpenBinImage(const char* filename, Error* error);
@@ -247,13 +252,23 @@ public:
   static std::unique_ptr<CDImage> OpenEcmImage(const char* filename, Error* error);
   static std::unique_ptr<CDImage> OpenMdsImage(const char* filename, Error* error);
   static std::unique_ptr<CDImage> OpenPBPImage(const char* filename, Error* error);
+  static std::unique_ptr<CDImage> OpenZCDImage(const char* filename, Error* error);
   static std::unique_ptr<CDImage> OpenM3uImage(const char* filename, bool apply_patches, Error* error);
   static std::unique_ptr<CDImage> OpenDeviceImage(const char* filename, Error* error);
-  static std::unique_ptr<CDImage>
-  CreateMemoryImage(CDImage* image, ProgressCallback* progress = ProgressCallback::NullProgressCallback);
+  /// Copies the whole image into memory. When shared, the copy is placed in named shared memory, so other instances
+  /// precaching the same disc use the same copy rather than making and holding their own.
+  static std::unique_ptr<CDImage> CreateMemoryImage(CDImage* image,
+                                                    ProgressCallback* progress = ProgressCallback::NullProgressCallback,
+                                                    bool shared = false);
   static std::unique_ptr<CDImage> OverlayPPFPatch(const char* filename, std::unique_ptr<CDImage> parent_image,
                                                   ProgressCallback* progress = ProgressCallback::NullProgressCallback);
 
+  /// Writes an image as ZCD, a seekable zstd image. Sectors are compressed independently in frames of
+  /// sectors_per_frame, spread across all cores. The dictionary can be empty, otherwise it's stored in the image, and
+  /// can be a trained zstd dictionary or raw content.
+  static bool WriteZCDImage(CDImage* image, const char* path, u32 sectors_per_frame, int compression_level,
+                            const std::vector<u8>& dictionary, ProgressCallback* progress, Error* error);
+
   // Accessors.
   const std::string& GetFileName() const { return m_filename; }
   LBA GetPositionOnDisc() const { return m_position_on_disc; }
@@ -297,6 +312,10 @@ public:
   // Read a single raw sector, and subchannel from the current LBA.
   bool ReadRawSector(void* buffer, SubChannelQ* subq);
 
+  // Hints that the sectors following the current LBA are about to be read, so the backing file can start fetching
+  // them in the background. Doesn't change the position.
+  void Readahead(u32 sector_count);
+
   // Reads sub-channel Q for the specified index+LBA.
   virtual bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index);
 
@@ -306,6 +325,9 @@ public:
   // Reads a single sector from an index.
   virtual bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) = 0;
 
+  // Hints that a run of sectors from an index will be read soon. Only file-backed images do anything with it.
+  virtual void ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count);
+
   // Retrieve image metadata.
   virtual std::string GetMetadata(const std::string_view& type) const;
 
@@ -6,7 +6,10 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
 Log_SetChannel(CDImageBin);
 
 class CDImageBin : public CDImage
@@ -22,11 +25,16 @@ public:
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  void ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count) override;
 
 private:
   std::FILE* m_fp = nullptr;
   u64 m_file_position = 0;
 
+  // Reads come straight out of the mapping when it's available, the file is only used as a fallback.
+  const u8* m_mapping = nullptr;
+  size_t m_mapping_size = 0;
+
   CDSubChannelReplacement m_sbi;
 };
 
@@ -34,6 +42,8 @@ CDImageBin::CDImageBin() = default;
 
 CDImageBin::~CDImageBin()
 {
+  if (m_mapping)
+    MemMap::UnmapFile(const_cast<u8*>(m_mapping), m_mapping_size);
   if (m_fp)
     std::fclose(m_fp);
 }
@@ -59,6 +69,13 @@ bool CDImageBin::Open(const char* filename, Error* error)
 
   m_lba_count = file_size / track_sector_size;
 
+#if defined(CPU_ARCH_X64) || defined(CPU_ARCH_ARM64) || defined(CPU_ARCH_RISCV64)
+  // Only on 64-bit hosts, mapping a whole disc would eat too much address space otherwise.
+  m_mapping = static_cast<const u8*>(MemMap::MapFileReadOnly(filename, &m_mapping_size));
+  if (!m_mapping)
+    Log_WarningPrintf("Failed to map '%s', falling back to buffered reads", filename);
+#endif
+
   SubChannelQ::Control control = {};
   TrackMode mode = TrackMode::Mode2Raw;
   control.data = mode != TrackMode::Audio;
@@ -120,6 +137,15 @@ bool CDImageBin::HasNonStandardSubchannel() const
 bool CDImageBin::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
 {
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (m_mapping)
+  {
+    if (file_position > m_mapping_size || (m_mapping_size - file_position) < index.file_sector_size)
+      return false;
+
+    std::memcpy(buffer, m_mapping + file_position, index.file_sector_size);
+    return true;
+  }
+
   if (m_file_position != file_position)
   {
     if (std::fseek(m_fp, static_cast<long>(file_position), SEEK_SET) != 0)
@@ -138,6 +164,24 @@ bool CDImageBin::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   return true;
 }
 
+void CDImageBin::ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count)
+{
+  const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  const u64 size = static_cast<u64>(sector_count) * index.file_sector_size;
+  if (m_mapping)
+  {
+    if (file_position < m_mapping_size)
+    {
+      MemMap::Readahead(m_mapping + file_position,
+                        static_cast<size_t>(std::min<u64>(size, m_mapping_size - file_position)));
+    }
+  }
+  else
+  {
+    FileSystem::FReadahead64(m_fp, static_cast<s64>(file_position), static_cast<s64>(size));
+  }
+}
+
 std::unique_ptr<CDImage> CDImage::OpenBinImage(const char* filename, Error* error)
 {
   std::unique_ptr<CDImageBin> image = std::make_unique<CDImageBin>();
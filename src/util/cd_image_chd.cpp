@@ -14,6 +14,7 @@
 #include "common/log.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 
 #include "fmt/format.h"
 #include "libchdr/cdrom.h"
@@ -21,11 +22,13 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <limits>
 #include <mutex>
 #include <optional>
+#include <thread>
 
 Log_SetChannel(CDImageCHD);
 
@@ -53,6 +56,7 @@ static std::optional<CDImage::TrackMode> ParseTrackModeString(const char* str)
 
 static std::vector<std::pair<std::string, chd_header>> s_chd_hash_cache; // <filename, header>
 static std::recursive_mutex s_chd_hash_cache_mutex;
+static u32 s_chd_hunk_cache_size = CDImage::DEFAULT_CHD_HUNK_CACHE_SIZE;
 
 namespace {
 class CDImageCHD : public CDImage
@@ -75,20 +79,58 @@ private:
   static constexpr u32 CHD_CD_SECTOR_DATA_SIZE = 2352 + 96;
   static constexpr u32 CHD_CD_TRACK_ALIGNMENT = 4;
   static constexpr u32 MAX_PARENTS = 32; // Surely someone wouldn't be insane enough to go beyond this...
+  static constexpr u32 INVALID_HUNK = static_cast<u32>(-1);
+
+  struct CachedHunk
+  {
+    u32 hunk_index;
+    u32 last_used;
+  };
 
   chd_file* OpenCHD(std::string_view filename, FileSystem::ManagedCFilePtr fp, Error* error, u32 recursion_level);
   bool UpdateHunkBuffer(const Index& index, LBA lba_in_index, u32& hunk_offset);
 
+  u32 FindCachedHunk(u32 hunk_index) const;
+  u32 GetHunkCacheEvictionSlot() const;
+  bool ReadHunk(u32 hunk_index, u32 slot);
+  void QueuePrefetch(u32 hunk_index);
+  void StartPrefetchThread();
+  void StopPrefetchThread();
+  void PrefetchThreadEntryPoint();
+
   static void CopyAndSwap(void* dst_ptr, const u8* src_ptr);
 
   chd_file* m_chd = nullptr;
   u32 m_hunk_size = 0;
+  u32 m_hunk_count = 0;
   u32 m_sectors_per_hunk = 0;
 
+  // Decompressed hunks, one slot of m_hunk_size bytes per cache entry. The slot containing the current hunk is only
+  // accessed by the reading thread, the prefetch thread never evicts it.
   DynamicHeapArray<u8, 16> m_hunk_buffer;
-  u32 m_current_hunk_index = static_cast<u32>(-1);
+  std::vector<CachedHunk> m_hunk_cache;
+  u32 m_current_hunk_index = INVALID_HUNK;
+  u32 m_current_hunk_slot = INVALID_HUNK;
+  u32 m_hunk_use_counter = 0;
+  bool m_reading_backwards = false;
   bool m_precached = false;
 
+  u32 m_hunk_cache_hits = 0;
+  u32 m_hunk_cache_misses = 0;
+  u32 m_hunk_cache_prefetches = 0;
+
+  // libchdr isn't thread safe, so all access to the file goes through m_chd_mutex. m_hunk_cache_mutex protects the
+  // cache entries and the prefetch state below.
+  std::mutex m_chd_mutex;
+  std::mutex m_hunk_cache_mutex;
+  std::condition_variable m_prefetch_cv;
+  std::condition_variable m_prefetch_done_cv;
+  std::thread m_prefetch_thread;
+  u32 m_prefetch_request_hunk = INVALID_HUNK;
+  u32 m_prefetch_busy_hunk = INVALID_HUNK;
+  u32 m_prefetch_busy_slot = INVALID_HUNK;
+  bool m_prefetch_thread_shutdown = false;
+
   CDSubChannelReplacement m_sbi;
 };
 } // namespace
@@ -97,6 +139,14 @@ CDImageCHD::CDImageCHD() = default;
 
 CDImageCHD::~CDImageCHD()
 {
+  StopPrefetchThread();
+
+  if (m_hunk_cache_hits > 0 || m_hunk_cache_misses > 0)
+  {
+    Log_DevFmt("Hunk cache: {} hits, {} misses, {} prefetched", m_hunk_cache_hits, m_hunk_cache_misses,
+               m_hunk_cache_prefetches);
+  }
+
   if (m_chd)
     chd_close(m_chd);
 }
@@ -258,8 +308,12 @@ bool CDImageCHD::Open(const char* filename, Error* error)
     return false;
   }
 
+  m_hunk_count = header->totalhunks;
   m_sectors_per_hunk = m_hunk_size / CHD_CD_SECTOR_DATA_SIZE;
-  m_hunk_buffer.resize(m_hunk_size);
+
+  const u32 hunk_cache_size = std::clamp<u32>(s_chd_hunk_cache_size, 1, std::max<u32>(m_hunk_count, 1));
+  m_hunk_buffer.resize(m_hunk_size * hunk_cache_size);
+  m_hunk_cache.resize(hunk_cache_size, CachedHunk{INVALID_HUNK, 0});
   m_filename = filename;
 
   u32 disc_lba = 0;
@@ -415,6 +469,10 @@ bool CDImageCHD::Open(const char* filename, Error* error)
 
   m_sbi.LoadSBIFromImagePath(filename);
 
+  // Need somewhere to put the prefetched hunk besides the current one.
+  if (m_hunk_cache.size() > 1)
+    StartPrefetchThread();
+
   return Seek(1, Position{0, 0, 0});
 }
 
@@ -463,6 +521,7 @@ CDImage::PrecacheResult CDImageCHD::Precache(ProgressCallback* progress)
     static_cast<ProgressCallback*>(param)->SetProgressValue(std::min<u32>(percent, 100));
   };
 
+  std::unique_lock lock(m_chd_mutex);
   if (chd_precache_progress(m_chd, callback, progress) != CHDERR_NONE)
     return CDImage::PrecacheResult::ReadError;
 
@@ -554,22 +613,195 @@ ALWAYS_INLINE_RELEASE bool CDImageCHD::UpdateHunkBuffer(const Index& index, LBA
   DebugAssert((m_hunk_size - hunk_offset) >= CHD_CD_SECTOR_DATA_SIZE);
 
   if (m_current_hunk_index == hunk_index)
+  {
+    hunk_offset += m_current_hunk_slot * m_hunk_size;
     return true;
+  }
 
-  const chd_error err = chd_read(m_chd, hunk_index, m_hunk_buffer.data());
-  if (err != CHDERR_NONE)
+  std::unique_lock lock(m_hunk_cache_mutex);
+
+  u32 slot;
+  for (;;)
   {
-    Log_ErrorFmt("chd_read({}) failed: %s", hunk_index, chd_error_string(err));
+    slot = FindCachedHunk(hunk_index);
+    if (slot != INVALID_HUNK)
+    {
+      m_hunk_cache_hits++;
+      break;
+    }
 
-    // data might have been partially written
-    m_current_hunk_index = static_cast<u32>(-1);
-    return false;
+    // prefetch thread is already decompressing it, no point doing it twice
+    if (m_prefetch_busy_hunk == hunk_index)
+    {
+      m_prefetch_done_cv.wait(lock);
+      continue;
+    }
+
+    m_hunk_cache_misses++;
+    slot = GetHunkCacheEvictionSlot();
+    DebugAssert(slot != INVALID_HUNK);
+    m_hunk_cache[slot].hunk_index = INVALID_HUNK;
+
+    // keep the prefetch thread away from the slot while we're filling it
+    m_current_hunk_index = INVALID_HUNK;
+    m_current_hunk_slot = slot;
+
+    lock.unlock();
+    const bool result = ReadHunk(hunk_index, slot);
+    lock.lock();
+
+    if (!result)
+      return false;
+
+    m_hunk_cache[slot].hunk_index = hunk_index;
+    break;
   }
 
+  m_hunk_cache[slot].last_used = ++m_hunk_use_counter;
+  if (m_current_hunk_index != INVALID_HUNK)
+    m_reading_backwards = (hunk_index < m_current_hunk_index);
+
   m_current_hunk_index = hunk_index;
+  m_current_hunk_slot = slot;
+  hunk_offset += slot * m_hunk_size;
+
+  if (m_prefetch_thread.joinable())
+  {
+    if (!m_reading_backwards && (hunk_index + 1) < m_hunk_count)
+      QueuePrefetch(hunk_index + 1);
+    else if (m_reading_backwards && hunk_index > 0)
+      QueuePrefetch(hunk_index - 1);
+  }
+
   return true;
 }
 
+u32 CDImageCHD::FindCachedHunk(u32 hunk_index) const
+{
+  for (u32 i = 0; i < static_cast<u32>(m_hunk_cache.size()); i++)
+  {
+    if (m_hunk_cache[i].hunk_index == hunk_index)
+      return i;
+  }
+
+  return INVALID_HUNK;
+}
+
+u32 CDImageCHD::GetHunkCacheEvictionSlot() const
+{
+  // least recently used, skipping the slots currently in use by either thread
+  u32 slot = INVALID_HUNK;
+  u32 slot_last_used = std::numeric_limits<u32>::max();
+  for (u32 i = 0; i < static_cast<u32>(m_hunk_cache.size()); i++)
+  {
+    if (i == m_current_hunk_slot || i == m_prefetch_busy_slot)
+      continue;
+
+    const CachedHunk& ch = m_hunk_cache[i];
+    if (ch.hunk_index == INVALID_HUNK)
+      return i;
+
+    if (ch.last_used < slot_last_used)
+    {
+      slot = i;
+      slot_last_used = ch.last_used;
+    }
+  }
+
+  // current slot is always available to the reading thread if there's nothing else
+  return (slot != INVALID_HUNK) ? slot : m_current_hunk_slot;
+}
+
+bool CDImageCHD::ReadHunk(u32 hunk_index, u32 slot)
+{
+  std::unique_lock lock(m_chd_mutex);
+  const chd_error err = chd_read(m_chd, hunk_index, &m_hunk_buffer[slot * m_hunk_size]);
+  if (err != CHDERR_NONE)
+  {
+    Log_ErrorFmt("chd_read({}) failed: {}", hunk_index, chd_error_string(err));
+    return false;
+  }
+
+  return true;
+}
+
+void CDImageCHD::QueuePrefetch(u32 hunk_index)
+{
+  // caller holds the cache lock
+  if (m_prefetch_busy_hunk == hunk_index || FindCachedHunk(hunk_index) != INVALID_HUNK)
+    return;
+
+  m_prefetch_request_hunk = hunk_index;
+  m_prefetch_cv.notify_one();
+}
+
+void CDImageCHD::StartPrefetchThread()
+{
+  m_prefetch_thread_shutdown = false;
+  m_prefetch_thread = std::thread(&CDImageCHD::PrefetchThreadEntryPoint, this);
+}
+
+void CDImageCHD::StopPrefetchThread()
+{
+  if (!m_prefetch_thread.joinable())
+    return;
+
+  {
+    std::unique_lock lock(m_hunk_cache_mutex);
+    m_prefetch_thread_shutdown = true;
+    m_prefetch_cv.notify_one();
+  }
+
+  m_prefetch_thread.join();
+}
+
+void CDImageCHD::PrefetchThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("CHD Prefetch");
+
+  std::unique_lock lock(m_hunk_cache_mutex);
+  for (;;)
+  {
+    m_prefetch_cv.wait(lock,
+                       [this]() { return (m_prefetch_thread_shutdown || m_prefetch_request_hunk != INVALID_HUNK); });
+    if (m_prefetch_thread_shutdown)
+      break;
+
+    const u32 hunk_index = m_prefetch_request_hunk;
+    m_prefetch_request_hunk = INVALID_HUNK;
+    if (FindCachedHunk(hunk_index) != INVALID_HUNK)
+      continue;
+
+    const u32 slot = GetHunkCacheEvictionSlot();
+    if (slot == INVALID_HUNK || slot == m_current_hunk_slot)
+      continue;
+
+    m_hunk_cache[slot].hunk_index = INVALID_HUNK;
+    m_prefetch_busy_hunk = hunk_index;
+    m_prefetch_busy_slot = slot;
+
+    lock.unlock();
+    const bool result = ReadHunk(hunk_index, slot);
+    lock.lock();
+
+    if (result)
+    {
+      m_hunk_cache[slot].hunk_index = hunk_index;
+      m_hunk_cache[slot].last_used = ++m_hunk_use_counter;
+      m_hunk_cache_prefetches++;
+    }
+
+    m_prefetch_busy_hunk = INVALID_HUNK;
+    m_prefetch_busy_slot = INVALID_HUNK;
+    m_prefetch_done_cv.notify_all();
+  }
+}
+
+void CDImage::SetCHDHunkCacheSize(u32 hunks)
+{
+  s_chd_hunk_cache_size = std::max<u32>(hunks, 1);
+}
+
 std::unique_ptr<CDImage> CDImage::OpenCHDImage(const char* filename, Error* error)
 {
   std::unique_ptr<CDImageCHD> image = std::make_unique<CDImageCHD>();
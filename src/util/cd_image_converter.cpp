@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "cd_image_converter.h"
+#include "cd_image.h"
+#include "cd_image_hasher.h"
+#include "cue_parser.h"
+
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/path.h"
+#include "common/string_util.h"
+
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <vector>
+
+Log_SetChannel(CDImageConverter);
+
+namespace CDImageConverter {
+static bool VerifyImage(CDImage* source, CDImage* converted, ProgressCallback* progress, Error* error);
+static void GetCueSheetFiles(const std::string& cue_path, std::vector<std::string>* files);
+} // namespace CDImageConverter
+
+bool CDImageConverter::IsConvertibleImage(const std::string_view& path)
+{
+  static constexpr const std::array extensions = {".bin", ".cue", ".img", ".iso", ".chd", ".ecm", ".mds", ".pbp"};
+  for (const char* extension : extensions)
+  {
+    if (StringUtil::EndsWithNoCase(path, extension))
+      return true;
+  }
+
+  return false;
+}
+
+std::string CDImageConverter::GetOutputPath(const std::string_view& path)
+{
+  return Path::ReplaceExtension(path, "zcd");
+}
+
+bool CDImageConverter::VerifyImage(CDImage* source, CDImage* converted, ProgressCallback* progress, Error* error)
+{
+  if (source->GetTrackCount() != converted->GetTrackCount() || source->GetLBACount() != converted->GetLBACount())
+  {
+    Error::SetString(error, "Converted image has a different layout to the source.");
+    return false;
+  }
+
+  std::vector<CDImageHasher::Hash> source_hashes, converted_hashes;
+  if (!CDImageHasher::GetTrackHashes(source, &source_hashes, progress) ||
+      !CDImageHasher::GetTrackHashes(converted, &converted_hashes, progress))
+  {
+    Error::SetString(error, progress->IsCancelled() ? "Cancelled." : "Failed to hash images.");
+    return false;
+  }
+
+  for (size_t i = 0; i < source_hashes.size(); i++)
+  {
+    if (source_hashes[i] != converted_hashes[i])
+    {
+      Error::SetString(error, fmt::format("Track {} differs after conversion ({} vs {}).", i + 1,
+                                          CDImageHasher::HashToString(source_hashes[i]),
+                                          CDImageHasher::HashToString(converted_hashes[i])));
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool CDImageConverter::ConvertImage(const char* input_path, const char* output_path, const Options& options,
+                                    ProgressCallback* progress, Error* error)
+{
+  std::unique_ptr<CDImage> image = CDImage::Open(input_path, false, error);
+  if (!image)
+    return false;
+
+  // Only the first disc would be written, and the rest silently lost.
+  if (image->HasSubImages() && image->GetSubImageCount() > 1)
+  {
+    Error::SetString(error, "Multi-disc images can't be converted.");
+    return false;
+  }
+
+  const std::string temp_path = fmt::format("{}.tmp", output_path);
+  if (!CDImage::WriteZCDImage(image.get(), temp_path.c_str(), options.sectors_per_frame, options.compression_level,
+                              {}, progress, error))
+  {
+    return false;
+  }
+
+  if (options.verify)
+  {
+    // Opened directly, the temporary file's extension isn't one CDImage::Open() knows.
+    std::unique_ptr<CDImage> converted = CDImage::OpenZCDImage(temp_path.c_str(), error);
+    if (!converted || !VerifyImage(image.get(), converted.get(), progress, error))
+    {
+      converted.reset();
+      FileSystem::DeleteFile(temp_path.c_str());
+      return false;
+    }
+  }
+
+  if (!FileSystem::RenamePath(temp_path.c_str(), output_path))
+  {
+    Error::SetString(error, fmt::format("Failed to rename '{}' to '{}'.", temp_path, output_path));
+    FileSystem::DeleteFile(temp_path.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Converted '%s' to '%s'.", input_path, output_path);
+  return true;
+}
+
+void CDImageConverter::GetCueSheetFiles(const std::string& cue_path, std::vector<std::string>* files)
+{
+  std::FILE* fp = FileSystem::OpenCFile(cue_path.c_str(), "rb");
+  if (!fp)
+    return;
+
+  CueParser::File parser;
+  const bool parsed = parser.Parse(fp, nullptr);
+  std::fclose(fp);
+  if (!parsed)
+    return;
+
+  for (u32 track_num = CueParser::MIN_TRACK_NUMBER; track_num <= CueParser::MAX_TRACK_NUMBER; track_num++)
+  {
+    const CueParser::Track* track = parser.GetTrack(track_num);
+    if (!track)
+      break;
+
+    files->push_back(Path::IsAbsolute(track->file) ? track->file : Path::BuildRelativePath(cue_path, track->file));
+  }
+
+  // Same fallback as the cue sheet loader, for sheets which reference a renamed file.
+  files->push_back(Path::ReplaceExtension(cue_path, "bin"));
+}
+
+u32 CDImageConverter::ConvertDirectory(const char* path, bool recursive, const Options& options,
+                                       ProgressCallback* progress, u32* out_failed)
+{
+  FileSystem::FindResultsArray results;
+  FileSystem::FindFiles(path, "*",
+                        recursive ? (FILESYSTEM_FIND_FILES | FILESYSTEM_FIND_RECURSIVE) : FILESYSTEM_FIND_FILES,
+                        &results);
+
+  // Track files are part of their cue sheet's image, converting them by themselves would lose the cue sheet's layout.
+  std::vector<std::string> cue_files;
+  for (const FILESYSTEM_FIND_DATA& fd : results)
+  {
+    if (StringUtil::EndsWithNoCase(fd.FileName, ".cue"))
+      GetCueSheetFiles(fd.FileName, &cue_files);
+  }
+
+  std::vector<std::string> inputs;
+  for (const FILESYSTEM_FIND_DATA& fd : results)
+  {
+    if (!IsConvertibleImage(fd.FileName) ||
+        std::any_of(cue_files.begin(), cue_files.end(),
+                    [&fd](const std::string& file) { return Path::Canonicalize(file) == fd.FileName; }) ||
+        FileSystem::FileExists(GetOutputPath(fd.FileName).c_str()))
+    {
+      continue;
+    }
+
+    inputs.push_back(fd.FileName);
+  }
+
+  std::sort(inputs.begin(), inputs.end());
+  Log_InfoPrintf("Converting %zu images in '%s'.", inputs.size(), path);
+
+  u32 converted = 0;
+  u32 failed = 0;
+  for (size_t i = 0; i < inputs.size() && !progress->IsCancelled(); i++)
+  {
+    const std::string& input = inputs[i];
+    const std::string output = GetOutputPath(input);
+
+    // Another format of the same game may have been converted earlier in the batch.
+    if (FileSystem::FileExists(output.c_str()))
+      continue;
+
+    progress->PushState();
+    progress->SetFormattedStatusText("Converting %s (%zu of %zu)...", Path::GetFileName(input).data(), i + 1,
+                                     inputs.size());
+
+    Error error;
+    if (ConvertImage(input.c_str(), output.c_str(), options, progress, &error))
+    {
+      converted++;
+    }
+    else if (!progress->IsCancelled())
+    {
+      Log_ErrorPrintf("Failed to convert '%s': %s", input.c_str(), error.GetDescription().c_str());
+      failed++;
+    }
+
+    progress->PopState();
+  }
+
+  Log_InfoPrintf("%u images converted, %u failed.", converted, failed);
+  if (out_failed)
+    *out_failed = failed;
+
+  return converted;
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+#include "cd_image.h"
+
+#include "common/progress_callback.h"
+#include "common/types.h"
+
+#include <string>
+#include <string_view>
+
+class Error;
+
+namespace CDImageConverter {
+
+enum : s32
+{
+  DEFAULT_COMPRESSION_LEVEL = 19,
+};
+
+struct Options
+{
+  u32 sectors_per_frame = CDImage::DEFAULT_ZCD_SECTORS_PER_FRAME;
+  s32 compression_level = DEFAULT_COMPRESSION_LEVEL;
+
+  /// Hashes every track of both images after converting, and discards the output if any differ.
+  bool verify = true;
+};
+
+/// Returns true if the file is a disc image which can be converted. Playlists and ZCD images are not.
+bool IsConvertibleImage(const std::string_view& path);
+
+/// Returns the path a converted image is written to, alongside the original.
+std::string GetOutputPath(const std::string_view& path);
+
+/// Converts a single image to ZCD. The output is written to a temporary file first, and only renamed to output_path
+/// once it has been verified, so a failed or cancelled conversion never leaves a broken image behind.
+bool ConvertImage(const char* input_path, const char* output_path, const Options& options,
+                  ProgressCallback* progress, Error* error);
+
+/// Converts every image in a directory which doesn't already have a converted copy. Files referenced by a cue sheet
+/// are converted through the cue sheet. Failures are logged and don't stop the rest of the batch. Returns the number of
+/// images converted, and the number which failed in out_failed.
+u32 ConvertDirectory(const char* path, bool recursive, const Options& options, ProgressCallback* progress,
+                     u32* out_failed);
+
+} // namespace CDImageConverter
@@ -9,14 +9,25 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
+#include "common/threading.h"
 
 #include "fmt/format.h"
 
+// libchdr builds the implementation without stdio, so decoders are opened through callbacks.
+#define DR_FLAC_NO_STDIO
+#include "dr_libs/dr_flac.h"
+
 #include <algorithm>
 #include <cerrno>
 #include <cinttypes>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
 #include <map>
+#include <mutex>
+#include <thread>
 
 Log_SetChannel(CDImageCueSheet);
 
@@ -33,24 +44,95 @@ public:
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  void ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count) override;
 
 private:
+  // FLAC tracks are decoded a second at a time, which is enough to cover a sector read batch.
+  static constexpr u32 FLAC_CHUNK_SECTORS = FRAMES_PER_SECOND;
+  static constexpr u32 FLAC_CHUNK_SIZE = FLAC_CHUNK_SECTORS * RAW_SECTOR_SIZE;
+  static constexpr u32 FLAC_CHUNK_CACHE_SIZE = 8;
+  static constexpr u32 FLAC_BYTES_PER_FRAME = 4;
+  static constexpr u32 INVALID_SLOT = std::numeric_limits<u32>::max();
+  static constexpr u64 INVALID_CHUNK = std::numeric_limits<u64>::max();
+
   struct TrackFile
   {
     std::string filename;
     std::FILE* file;
     u64 file_position;
+
+    // Reads come straight out of the mapping when it's available, the file is only used as a fallback.
+    const u8* mapping;
+    size_t mapping_size;
+
+    // Compressed audio files are read as if they were raw 16-bit stereo PCM.
+    drflac* flac;
+    u64 flac_size;
+    u64 flac_next_frame;
+  };
+
+  struct DecodedChunk
+  {
+    u64 chunk;
+    u32 last_used;
   };
 
+  static size_t FLACReadCallback(void* user_data, void* buffer, size_t bytes);
+  static drflac_bool32 FLACSeekCallback(void* user_data, int offset, drflac_seek_origin origin);
+
+  bool OpenFLAC(TrackFile& tf, const std::string& path, Error* error);
+  bool ReadFLACSector(void* buffer, u32 file_index, u64 file_position, u32 size);
+  u32 GetFLACChunkSlot(u64 chunk);
+  u32 FindDecodedChunk(u64 chunk) const;
+  u32 GetChunkEvictionSlot() const;
+  bool DecodeFLACChunk(u64 chunk, u32 slot);
+  void QueueDecodeAhead(u64 chunk);
+  void StartDecodeThread();
+  void StopDecodeThread();
+  void DecodeThreadEntryPoint();
+
+  ALWAYS_INLINE static u64 MakeChunkKey(u32 file_index, u64 file_position)
+  {
+    return (static_cast<u64>(file_index) << 32) | (file_position / FLAC_CHUNK_SIZE);
+  }
+
   std::vector<TrackFile> m_files;
   CDSubChannelReplacement m_sbi;
+
+  // Decoded FLAC chunks, the same scheme as the CHD hunk cache. The decode thread stays one chunk ahead of the reading
+  // thread, and never evicts the chunk being read from.
+  std::vector<u8> m_chunk_buffer;
+  std::vector<DecodedChunk> m_chunk_cache;
+  u64 m_current_chunk = INVALID_CHUNK;
+  u32 m_current_chunk_slot = INVALID_SLOT;
+  u32 m_chunk_use_counter = 0;
+
+  // dr_flac isn't thread safe, so decoders are only used with m_flac_mutex held. m_chunk_cache_mutex protects the
+  // cache entries and the decode-ahead state below.
+  std::mutex m_flac_mutex;
+  std::mutex m_chunk_cache_mutex;
+  std::condition_variable m_decode_cv;
+  std::condition_variable m_decode_done_cv;
+  std::thread m_decode_thread;
+  u64 m_decode_request_chunk = INVALID_CHUNK;
+  u64 m_decode_busy_chunk = INVALID_CHUNK;
+  u32 m_decode_busy_slot = INVALID_SLOT;
+  bool m_decode_thread_shutdown = false;
 };
 
 CDImageCueSheet::CDImageCueSheet() = default;
 
 CDImageCueSheet::~CDImageCueSheet()
 {
-  std::for_each(m_files.begin(), m_files.end(), [](TrackFile& t) { std::fclose(t.file); });
+  StopDecodeThread();
+
+  std::for_each(m_files.begin(), m_files.end(), [](TrackFile& t) {
+    if (t.flac)
+      drflac_close(t.flac);
+    if (t.mapping)
+      MemMap::UnmapFile(const_cast<u8*>(t.mapping), t.mapping_size);
+    std::fclose(t.file);
+  });
 }
 
 bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
@@ -97,7 +179,7 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
     }
     if (track_file_index == m_files.size())
     {
-      const std::string track_full_filename(
+      std::string track_full_filename(
         !Path::IsAbsolute(track_filename) ? Path::BuildRelativePath(m_filename, track_filename) : track_filename);
       Error track_error;
       std::FILE* track_fp = FileSystem::OpenCFile(track_full_filename.c_str(), "rb", &track_error);
@@ -111,6 +193,7 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
         {
           Log_WarningPrintf("Your cue sheet references an invalid file '%s', but this was found at '%s' instead.",
                             track_filename.c_str(), alternative_filename.c_str());
+          track_full_filename = alternative_filename;
         }
       }
 
@@ -124,7 +207,37 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
         return false;
       }
 
-      m_files.push_back(TrackFile{std::move(track_filename), track_fp, 0});
+      TrackFile& tf =
+        m_files.emplace_back(TrackFile{std::move(track_filename), track_fp, 0, nullptr, 0, nullptr, 0, 0});
+
+      // Detected by content, since some sheets list compressed files as BINARY.
+      char magic[4];
+      const bool is_flac = (std::fread(magic, sizeof(magic), 1, track_fp) == 1 && std::memcmp(magic, "fLaC", 4) == 0);
+      std::rewind(track_fp);
+      if (is_flac)
+      {
+        if (!OpenFLAC(tf, track_full_filename, error))
+          return false;
+      }
+      else if (track->file_type == CueParser::FileType::Wave)
+      {
+        Log_ErrorPrintf("Track file '%s' is not FLAC, only FLAC-compressed WAVE files are supported",
+                        track_full_filename.c_str());
+        Error::SetString(error,
+                         fmt::format("Track file '{}' is not FLAC, only FLAC-compressed WAVE files are supported",
+                                     track_full_filename));
+        return false;
+      }
+
+#if defined(CPU_ARCH_X64) || defined(CPU_ARCH_ARM64) || defined(CPU_ARCH_RISCV64)
+      // Only on 64-bit hosts, mapping whole tracks would eat too much address space otherwise.
+      if (!tf.flac)
+      {
+        tf.mapping = static_cast<const u8*>(MemMap::MapFileReadOnly(track_full_filename.c_str(), &tf.mapping_size));
+        if (!tf.mapping)
+          Log_WarningPrintf("Failed to map '%s', falling back to buffered reads", track_full_filename.c_str());
+      }
+#endif
     }
 
     // data type determines the sector size
@@ -142,9 +255,14 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
     LBA track_length;
     if (!track->length.has_value())
     {
-      FileSystem::FSeek64(m_files[track_file_index].file, 0, SEEK_END);
-      u64 file_size = static_cast<u64>(FileSystem::FTell64(m_files[track_file_index].file));
-      FileSystem::FSeek64(m_files[track_file_index].file, 0, SEEK_SET);
+      TrackFile& tf = m_files[track_file_index];
+      u64 file_size = tf.flac_size;
+      if (!tf.flac)
+      {
+        FileSystem::FSeek64(tf.file, 0, SEEK_END);
+        file_size = static_cast<u64>(FileSystem::FTell64(tf.file));
+        FileSystem::FSeek64(tf.file, 0, SEEK_SET);
+      }
 
       file_size /= track_sector_size;
       if (track_start >= file_size)
@@ -295,9 +413,51 @@ bool CDImageCueSheet::OpenAndParse(const char* filename, Error* error)
 
   m_sbi.LoadSBIFromImagePath(filename);
 
+  if (std::any_of(m_files.begin(), m_files.end(), [](const TrackFile& tf) { return (tf.flac != nullptr); }))
+  {
+    m_chunk_buffer.resize(FLAC_CHUNK_CACHE_SIZE * FLAC_CHUNK_SIZE);
+    m_chunk_cache.resize(FLAC_CHUNK_CACHE_SIZE, DecodedChunk{INVALID_CHUNK, 0});
+    StartDecodeThread();
+  }
+
   return Seek(1, Position{0, 0, 0});
 }
 
+size_t CDImageCueSheet::FLACReadCallback(void* user_data, void* buffer, size_t bytes)
+{
+  return std::fread(buffer, 1, bytes, static_cast<std::FILE*>(user_data));
+}
+
+drflac_bool32 CDImageCueSheet::FLACSeekCallback(void* user_data, int offset, drflac_seek_origin origin)
+{
+  return (FileSystem::FSeek64(static_cast<std::FILE*>(user_data), offset,
+                              (origin == drflac_seek_origin_start) ? SEEK_SET : SEEK_CUR) == 0);
+}
+
+bool CDImageCueSheet::OpenFLAC(TrackFile& tf, const std::string& path, Error* error)
+{
+  // Seeks use the seek table when the file has one, and are sample accurate either way.
+  tf.flac = drflac_open(FLACReadCallback, FLACSeekCallback, tf.file, nullptr);
+  if (!tf.flac)
+  {
+    Log_ErrorPrintf("Failed to open FLAC track file '%s'", path.c_str());
+    Error::SetString(error, fmt::format("Failed to open FLAC track file '{}'", path));
+    return false;
+  }
+
+  if (tf.flac->channels != 2 || tf.flac->sampleRate != 44100 || tf.flac->bitsPerSample != 16)
+  {
+    Log_ErrorPrintf("FLAC track file '%s' is %uch/%uHz/%ubit, it must be 2ch/44100Hz/16bit", path.c_str(),
+                    static_cast<u32>(tf.flac->channels), tf.flac->sampleRate, static_cast<u32>(tf.flac->bitsPerSample));
+    Error::SetString(error, fmt::format("FLAC track file '{}' is not 16-bit stereo at 44100Hz", path));
+    return false;
+  }
+
+  tf.flac_size = tf.flac->totalPCMFrameCount * FLAC_BYTES_PER_FRAME;
+  Log_DevPrintf("Opened FLAC track file '%s', %" PRIu64 " decoded bytes", path.c_str(), tf.flac_size);
+  return true;
+}
+
 bool CDImageCueSheet::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   if (m_sbi.GetReplacementSubChannelQ(index.start_lba_on_disc + lba_in_index, subq))
@@ -317,6 +477,18 @@ bool CDImageCueSheet::ReadSectorFromIndex(void* buffer, const Index& index, LBA
 
   TrackFile& tf = m_files[index.file_index];
   const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  if (tf.flac)
+    return ReadFLACSector(buffer, index.file_index, file_position, index.file_sector_size);
+
+  if (tf.mapping)
+  {
+    if (file_position > tf.mapping_size || (tf.mapping_size - file_position) < index.file_sector_size)
+      return false;
+
+    std::memcpy(buffer, tf.mapping + file_position, index.file_sector_size);
+    return true;
+  }
+
   if (tf.file_position != file_position)
   {
     if (std::fseek(tf.file, static_cast<long>(file_position), SEEK_SET) != 0)
@@ -335,6 +507,255 @@ bool CDImageCueSheet::ReadSectorFromIndex(void* buffer, const Index& index, LBA
   return true;
 }
 
+void CDImageCueSheet::ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count)
+{
+  DebugAssert(index.file_index < m_files.size());
+
+  const TrackFile& tf = m_files[index.file_index];
+  const u64 file_position = index.file_offset + (static_cast<u64>(lba_in_index) * index.file_sector_size);
+  const u64 size = static_cast<u64>(sector_count) * index.file_sector_size;
+  if (tf.flac)
+  {
+    // Starts decoding the first chunk now, sequential reads keep the decoder going from there.
+    std::unique_lock lock(m_chunk_cache_mutex);
+    QueueDecodeAhead(MakeChunkKey(index.file_index, file_position));
+  }
+  else if (tf.mapping)
+  {
+    if (file_position < tf.mapping_size)
+    {
+      MemMap::Readahead(tf.mapping + file_position,
+                        static_cast<size_t>(std::min<u64>(size, tf.mapping_size - file_position)));
+    }
+  }
+  else
+  {
+    FileSystem::FReadahead64(tf.file, static_cast<s64>(file_position), static_cast<s64>(size));
+  }
+}
+
+bool CDImageCueSheet::ReadFLACSector(void* buffer, u32 file_index, u64 file_position, u32 size)
+{
+  const TrackFile& tf = m_files[file_index];
+  if (file_position > tf.flac_size || (tf.flac_size - file_position) < size)
+    return false;
+
+  // Sectors only cross chunks for track modes which aren't a multiple of the raw sector size.
+  u8* dst = static_cast<u8*>(buffer);
+  while (size > 0)
+  {
+    const u32 slot = GetFLACChunkSlot(MakeChunkKey(file_index, file_position));
+    if (slot == INVALID_SLOT)
+      return false;
+
+    const u32 offset_in_chunk = static_cast<u32>(file_position % FLAC_CHUNK_SIZE);
+    const u32 copy_size = std::min(size, FLAC_CHUNK_SIZE - offset_in_chunk);
+    std::memcpy(dst, &m_chunk_buffer[(slot * FLAC_CHUNK_SIZE) + offset_in_chunk], copy_size);
+    dst += copy_size;
+    file_position += copy_size;
+    size -= copy_size;
+  }
+
+  return true;
+}
+
+u32 CDImageCueSheet::GetFLACChunkSlot(u64 chunk)
+{
+  if (m_current_chunk == chunk)
+    return m_current_chunk_slot;
+
+  std::unique_lock lock(m_chunk_cache_mutex);
+
+  u32 slot;
+  for (;;)
+  {
+    slot = FindDecodedChunk(chunk);
+    if (slot != INVALID_SLOT)
+      break;
+
+    // decode thread is already on it
+    if (m_decode_busy_chunk == chunk)
+    {
+      m_decode_done_cv.wait(lock);
+      continue;
+    }
+
+    slot = GetChunkEvictionSlot();
+    DebugAssert(slot != INVALID_SLOT);
+    m_chunk_cache[slot].chunk = INVALID_CHUNK;
+
+    // keep the decode thread away from the slot while we're filling it
+    m_current_chunk = INVALID_CHUNK;
+    m_current_chunk_slot = slot;
+
+    lock.unlock();
+    const bool result = DecodeFLACChunk(chunk, slot);
+    lock.lock();
+
+    if (!result)
+      return INVALID_SLOT;
+
+    m_chunk_cache[slot].chunk = chunk;
+    break;
+  }
+
+  m_chunk_cache[slot].last_used = ++m_chunk_use_counter;
+  m_current_chunk = chunk;
+  m_current_chunk_slot = slot;
+
+  // Chunks past the end of the file fail to decode, and are simply not cached.
+  QueueDecodeAhead(chunk + 1);
+  return slot;
+}
+
+u32 CDImageCueSheet::FindDecodedChunk(u64 chunk) const
+{
+  for (u32 i = 0; i < static_cast<u32>(m_chunk_cache.size()); i++)
+  {
+    if (m_chunk_cache[i].chunk == chunk)
+      return i;
+  }
+
+  return INVALID_SLOT;
+}
+
+u32 CDImageCueSheet::GetChunkEvictionSlot() const
+{
+  // least recently used, skipping the slots currently in use by either thread
+  u32 slot = INVALID_SLOT;
+  u32 slot_last_used = std::numeric_limits<u32>::max();
+  for (u32 i = 0; i < static_cast<u32>(m_chunk_cache.size()); i++)
+  {
+    if (i == m_current_chunk_slot || i == m_decode_busy_slot)
+      continue;
+
+    const DecodedChunk& dc = m_chunk_cache[i];
+    if (dc.chunk == INVALID_CHUNK)
+      return i;
+
+    if (dc.last_used < slot_last_used)
+    {
+      slot = i;
+      slot_last_used = dc.last_used;
+    }
+  }
+
+  // current slot is always available to the reading thread if there's nothing else
+  return (slot != INVALID_SLOT) ? slot : m_current_chunk_slot;
+}
+
+bool CDImageCueSheet::DecodeFLACChunk(u64 chunk, u32 slot)
+{
+  std::unique_lock lock(m_flac_mutex);
+
+  TrackFile& tf = m_files[static_cast<u32>(chunk >> 32)];
+  const u64 start_frame = (chunk & 0xFFFFFFFFu) * (FLAC_CHUNK_SIZE / FLAC_BYTES_PER_FRAME);
+  if (start_frame >= tf.flac->totalPCMFrameCount)
+    return false;
+
+  // Sequential chunks carry on from where the decoder is, anything else needs a seek.
+  if (tf.flac_next_frame != start_frame)
+  {
+    if (!drflac_seek_to_pcm_frame(tf.flac, start_frame))
+    {
+      Log_ErrorPrintf("Failed to seek to frame %" PRIu64 " in '%s'", start_frame, tf.filename.c_str());
+      tf.flac_next_frame = std::numeric_limits<u64>::max();
+      return false;
+    }
+
+    tf.flac_next_frame = start_frame;
+  }
+
+  // Decoded samples are little endian interleaved stereo, the same layout as the raw sectors.
+  u8* dst = &m_chunk_buffer[slot * FLAC_CHUNK_SIZE];
+  const u64 frame_count =
+    std::min<u64>(FLAC_CHUNK_SIZE / FLAC_BYTES_PER_FRAME, tf.flac->totalPCMFrameCount - start_frame);
+  const u64 frames_read = drflac_read_pcm_frames_s16(tf.flac, frame_count, reinterpret_cast<drflac_int16*>(dst));
+  tf.flac_next_frame = start_frame + frames_read;
+  if (frames_read != frame_count)
+  {
+    Log_ErrorPrintf("Failed to decode frames %" PRIu64 "-%" PRIu64 " in '%s'", start_frame,
+                    start_frame + frame_count - 1, tf.filename.c_str());
+    return false;
+  }
+
+  if (frame_count < (FLAC_CHUNK_SIZE / FLAC_BYTES_PER_FRAME))
+    std::memset(dst + (frame_count * FLAC_BYTES_PER_FRAME), 0, FLAC_CHUNK_SIZE - (frame_count * FLAC_BYTES_PER_FRAME));
+
+  return true;
+}
+
+void CDImageCueSheet::QueueDecodeAhead(u64 chunk)
+{
+  // caller holds the cache lock
+  if (!m_decode_thread.joinable() || m_decode_busy_chunk == chunk || FindDecodedChunk(chunk) != INVALID_SLOT)
+    return;
+
+  m_decode_request_chunk = chunk;
+  m_decode_cv.notify_one();
+}
+
+void CDImageCueSheet::StartDecodeThread()
+{
+  m_decode_thread_shutdown = false;
+  m_decode_thread = std::thread(&CDImageCueSheet::DecodeThreadEntryPoint, this);
+}
+
+void CDImageCueSheet::StopDecodeThread()
+{
+  if (!m_decode_thread.joinable())
+    return;
+
+  {
+    std::unique_lock lock(m_chunk_cache_mutex);
+    m_decode_thread_shutdown = true;
+    m_decode_cv.notify_one();
+  }
+
+  m_decode_thread.join();
+}
+
+void CDImageCueSheet::DecodeThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("FLAC Decode");
+
+  std::unique_lock lock(m_chunk_cache_mutex);
+  for (;;)
+  {
+    m_decode_cv.wait(lock,
+                     [this]() { return (m_decode_thread_shutdown || m_decode_request_chunk != INVALID_CHUNK); });
+    if (m_decode_thread_shutdown)
+      break;
+
+    const u64 chunk = m_decode_request_chunk;
+    m_decode_request_chunk = INVALID_CHUNK;
+    if (FindDecodedChunk(chunk) != INVALID_SLOT)
+      continue;
+
+    const u32 slot = GetChunkEvictionSlot();
+    if (slot == INVALID_SLOT || slot == m_current_chunk_slot)
+      continue;
+
+    m_chunk_cache[slot].chunk = INVALID_CHUNK;
+    m_decode_busy_chunk = chunk;
+    m_decode_busy_slot = slot;
+
+    lock.unlock();
+    const bool result = DecodeFLACChunk(chunk, slot);
+    lock.lock();
+
+    if (result)
+    {
+      m_chunk_cache[slot].chunk = chunk;
+      m_chunk_cache[slot].last_used = ++m_chunk_use_counter;
+    }
+
+    m_decode_busy_chunk = INVALID_CHUNK;
+    m_decode_busy_slot = INVALID_SLOT;
+    m_decode_done_cv.notify_all();
+  }
+}
+
 std::unique_ptr<CDImage> CDImage::OpenCueSheetImage(const char* filename, Error* error)
 {
   std::unique_ptr<CDImageCueSheet> image = std::make_unique<CDImageCueSheet>();
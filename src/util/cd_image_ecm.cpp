@@ -7,9 +7,11 @@
 #include "common/error.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include <algorithm>
 #include <array>
 #include <cerrno>
-#include <map>
+#include <limits>
+#include <vector>
 Log_SetChannel(CDImageEcm);
 
 // unecm.c by Neill Corlett (c) 2002, GPL licensed
@@ -38,22 +40,28 @@ static constexpr std::array<u8, 256> ComputeECCBLUT()
   return ecc_lut;
 }
 
-static constexpr std::array<u32, 256> ComputeEDCLUT()
+// Slicing-by-4, table k advances the EDC over a byte followed by k zero bytes.
+static constexpr std::array<std::array<u32, 256>, 4> ComputeEDCLUT()
 {
-  std::array<u32, 256> edc_lut{};
+  std::array<std::array<u32, 256>, 4> edc_lut{};
   for (u32 i = 0; i < 256; i++)
   {
     u32 edc = i;
     for (u32 k = 0; k < 8; k++)
       edc = (edc >> 1) ^ (edc & 1 ? 0xD8018001 : 0);
-    edc_lut[i] = edc;
+    edc_lut[0][i] = edc;
+  }
+  for (u32 k = 1; k < 4; k++)
+  {
+    for (u32 i = 0; i < 256; i++)
+      edc_lut[k][i] = (edc_lut[k - 1][i] >> 8) ^ edc_lut[0][edc_lut[k - 1][i] & 0xFF];
   }
   return edc_lut;
 }
 
 static constexpr std::array<u8, 256> ecc_f_lut = ComputeECCFLUT();
 static constexpr std::array<u8, 256> ecc_b_lut = ComputeECCBLUT();
-static constexpr std::array<u32, 256> edc_lut = ComputeEDCLUT();
+static constexpr std::array<std::array<u32, 256>, 4> edc_lut = ComputeEDCLUT();
 
 /***************************************************************************/
 /*
@@ -61,8 +69,15 @@ static constexpr std::array<u32, 256> edc_lut = ComputeEDCLUT();
 */
 static u32 edc_partial_computeblock(u32 edc, const u8* src, u16 size)
 {
+  for (; size >= 4; size -= 4, src += 4)
+  {
+    edc ^= static_cast<u32>(src[0]) | (static_cast<u32>(src[1]) << 8) | (static_cast<u32>(src[2]) << 16) |
+           (static_cast<u32>(src[3]) << 24);
+    edc = edc_lut[3][edc & 0xFF] ^ edc_lut[2][(edc >> 8) & 0xFF] ^ edc_lut[1][(edc >> 16) & 0xFF] ^
+          edc_lut[0][edc >> 24];
+  }
   while (size--)
-    edc = (edc >> 8) ^ edc_lut[(edc ^ (*src++)) & 0xFF];
+    edc = (edc >> 8) ^ edc_lut[0][(edc ^ (*src++)) & 0xFF];
   return edc;
 }
 
@@ -173,10 +188,6 @@ protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
 
 private:
-  bool ReadChunks(u32 disc_offset, u32 size);
-
-  std::FILE* m_fp = nullptr;
-
   enum class SectorType : u32
   {
     Raw = 0x00,
@@ -200,16 +211,25 @@ private:
     2336, // mode2form2
   };
 
-  struct SectorEntry
+  // One entry per ECM record, i.e. a run of sectors of the same type, rather than per sector. Sectors in a run have a
+  // fixed size on disc and in the file, so any of them can be located without walking the stream.
+  struct SectorRun
   {
+    u32 disc_offset;
     u32 file_offset;
-    u32 chunk_size;
+    u32 size; // Bytes on disc
     SectorType type;
   };
 
-  using DataMap = std::map<u32, SectorEntry>;
+  using RunList = std::vector<SectorRun>;
 
-  DataMap m_data_map;
+  RunList::const_iterator FindRun(u32 disc_offset) const;
+  bool ReadChunks(u32 disc_offset, u32 size);
+  bool DecodeSector(const SectorRun& run, u32 sector_in_run, u8* dst);
+
+  std::FILE* m_fp = nullptr;
+
+  RunList m_runs;
   std::vector<u8> m_chunk_buffer;
   u32 m_chunk_start = 0;
 
@@ -266,8 +286,8 @@ bool CDImageEcm::Open(const char* filename, Error* error)
     int bits = std::fgetc(m_fp);
     if (bits == EOF)
     {
-      Log_ErrorPrintf("Unexpected EOF after %zu chunks", m_data_map.size());
-      Error::SetString(error, fmt::format("Unexpected EOF after {} chunks", m_data_map.size()));
+      Log_ErrorPrintf("Unexpected EOF after %zu chunks", m_runs.size());
+      Error::SetString(error, fmt::format("Unexpected EOF after {} chunks", m_runs.size()));
       return false;
     }
 
@@ -280,8 +300,8 @@ bool CDImageEcm::Open(const char* filename, Error* error)
       bits = std::fgetc(m_fp);
       if (bits == EOF)
       {
-        Log_ErrorPrintf("Unexpected EOF after %zu chunks", m_data_map.size());
-        Error::SetString(error, fmt::format("Unexpected EOF after {} chunks", m_data_map.size()));
+        Log_ErrorPrintf("Unexpected EOF after %zu chunks", m_runs.size());
+        Error::SetString(error, fmt::format("Unexpected EOF after {} chunks", m_runs.size()));
         return false;
       }
 
@@ -298,56 +318,44 @@ bool CDImageEcm::Open(const char* filename, Error* error)
 
     if (count >= 0x80000000u)
     {
-      Log_ErrorPrintf("Corrupted header after %zu chunks", m_data_map.size());
-      Error::SetString(error, fmt::format("Corrupted header after {} chunks", m_data_map.size()));
+      Log_ErrorPrintf("Corrupted header after %zu chunks", m_runs.size());
+      Error::SetString(error, fmt::format("Corrupted header after {} chunks", m_runs.size()));
       return false;
     }
 
-    if (type == SectorType::Raw)
+    // Raw records are stored as-is, the others have a fixed size per sector.
+    const u64 run_disc_size =
+      (type == SectorType::Raw) ? count : (static_cast<u64>(count) * s_chunk_sizes[static_cast<u32>(type)]);
+    const u64 run_file_size =
+      (type == SectorType::Raw) ? count : (static_cast<u64>(count) * s_sector_sizes[static_cast<u32>(type)]);
+    if ((disc_offset + run_disc_size) > std::numeric_limits<u32>::max() ||
+        (file_offset + run_file_size) > std::numeric_limits<u32>::max())
     {
-      while (count > 0)
-      {
-        const u32 size = std::min<u32>(count, 2352);
-        m_data_map.emplace(disc_offset, SectorEntry{file_offset, size, type});
-        disc_offset += size;
-        file_offset += size;
-        count -= size;
-
-        if (static_cast<s64>(file_offset) > file_size)
-        {
-          Log_ErrorPrintf("Out of file bounds after %zu chunks", m_data_map.size());
-          Error::SetString(error, fmt::format("Out of file bounds after {} chunks", m_data_map.size()));
-        }
-      }
+      Log_ErrorPrintf("Corrupted header after %zu chunks", m_runs.size());
+      Error::SetString(error, fmt::format("Corrupted header after {} chunks", m_runs.size()));
+      return false;
     }
-    else
+
+    m_runs.push_back(SectorRun{disc_offset, file_offset, static_cast<u32>(run_disc_size), type});
+    disc_offset += static_cast<u32>(run_disc_size);
+    file_offset += static_cast<u32>(run_file_size);
+
+    if (static_cast<s64>(file_offset) > file_size)
     {
-      const u32 size = s_sector_sizes[static_cast<u32>(type)];
-      const u32 chunk_size = s_chunk_sizes[static_cast<u32>(type)];
-      for (u32 i = 0; i < count; i++)
-      {
-        m_data_map.emplace(disc_offset, SectorEntry{file_offset, chunk_size, type});
-        disc_offset += chunk_size;
-        file_offset += size;
-
-        if (static_cast<s64>(file_offset) > file_size)
-        {
-          Log_ErrorPrintf("Out of file bounds after %zu chunks", m_data_map.size());
-          Error::SetString(error, fmt::format("Out of file bounds after {} chunks", m_data_map.size()));
-        }
-      }
+      Log_ErrorPrintf("Out of file bounds after %zu chunks", m_runs.size());
+      Error::SetString(error, fmt::format("Out of file bounds after {} chunks", m_runs.size()));
     }
 
     if (std::fseek(m_fp, file_offset, SEEK_SET) != 0)
     {
-      Log_ErrorPrintf("Failed to seek to offset %u after %zu chunks", file_offset, m_data_map.size());
+      Log_ErrorPrintf("Failed to seek to offset %u after %zu chunks", file_offset, m_runs.size());
       Error::SetString(error,
-                       fmt::format("Failed to seek to offset {} after {} chunks", file_offset, m_data_map.size()));
+                       fmt::format("Failed to seek to offset {} after {} chunks", file_offset, m_runs.size()));
       return false;
     }
   }
 
-  if (m_data_map.empty())
+  if (m_runs.empty())
   {
     Log_ErrorPrintf("No data in image '%s'", filename);
     Error::SetString(error, fmt::format("No data in image '{}'", filename));
@@ -406,102 +414,136 @@ bool CDImageEcm::Open(const char* filename, Error* error)
   return Seek(1, Position{0, 0, 0});
 }
 
-bool CDImageEcm::ReadChunks(u32 disc_offset, u32 size)
+CDImageEcm::RunList::const_iterator CDImageEcm::FindRun(u32 disc_offset) const
 {
-  DataMap::iterator next =
-    m_data_map.lower_bound((disc_offset > RAW_SECTOR_SIZE) ? (disc_offset - RAW_SECTOR_SIZE) : 0);
-  DataMap::iterator current = m_data_map.begin();
-  while (next != m_data_map.end() && next->first <= disc_offset)
-    current = next++;
-
-  // extra bytes if we need to buffer some at the start
-  m_chunk_start = current->first;
-  m_chunk_buffer.clear();
-  if (m_chunk_start < disc_offset)
-    size += (disc_offset - current->first);
+  RunList::const_iterator iter =
+    std::upper_bound(m_runs.begin(), m_runs.end(), disc_offset,
+                     [](u32 offset, const SectorRun& run) { return offset < run.disc_offset; });
+  if (iter == m_runs.begin())
+    return m_runs.end();
+
+  --iter;
+  return (disc_offset < (iter->disc_offset + iter->size)) ? iter : m_runs.end();
+}
+
+bool CDImageEcm::DecodeSector(const SectorRun& run, u32 sector_in_run, u8* dst)
+{
+  const u32 file_offset = run.file_offset + (sector_in_run * s_sector_sizes[static_cast<u32>(run.type)]);
+  if (std::fseek(m_fp, file_offset, SEEK_SET) != 0)
+    return false;
+
+  u8 sector[RAW_SECTOR_SIZE];
 
-  u32 total_bytes_read = 0;
-  while (total_bytes_read < size)
+  // TODO: needed?
+  std::memset(sector, 0, RAW_SECTOR_SIZE);
+  std::memset(sector + 1, 0xFF, 10);
+
+  u32 skip;
+  switch (run.type)
   {
-    if (current == m_data_map.end() || std::fseek(m_fp, current->second.file_offset, SEEK_SET) != 0)
-      return false;
+    case SectorType::Mode1:
+    {
+      sector[0x0F] = 0x01;
+      if (std::fread(sector + 0x00C, 0x003, 1, m_fp) != 1 || std::fread(sector + 0x010, 0x800, 1, m_fp) != 1)
+        return false;
 
-    const u32 chunk_size = current->second.chunk_size;
-    const u32 chunk_start = static_cast<u32>(m_chunk_buffer.size());
-    m_chunk_buffer.resize(chunk_start + chunk_size);
+      eccedc_generate(sector, 1);
+      skip = 0;
+    }
+    break;
 
-    if (current->second.type == SectorType::Raw)
+    case SectorType::Mode2Form1:
     {
-      if (std::fread(&m_chunk_buffer[chunk_start], chunk_size, 1, m_fp) != 1)
+      sector[0x0F] = 0x02;
+      if (std::fread(sector + 0x014, 0x804, 1, m_fp) != 1)
         return false;
 
-      total_bytes_read += chunk_size;
+      sector[0x10] = sector[0x14];
+      sector[0x11] = sector[0x15];
+      sector[0x12] = sector[0x16];
+      sector[0x13] = sector[0x17];
+
+      eccedc_generate(sector, 2);
+      skip = 0x10;
     }
-    else
+    break;
+
+    case SectorType::Mode2Form2:
     {
-      // u8* sector = &m_chunk_buffer[chunk_start];
-      u8 sector[RAW_SECTOR_SIZE];
+      sector[0x0F] = 0x02;
+      if (std::fread(sector + 0x014, 0x918, 1, m_fp) != 1)
+        return false;
+
+      sector[0x10] = sector[0x14];
+      sector[0x11] = sector[0x15];
+      sector[0x12] = sector[0x16];
+      sector[0x13] = sector[0x17];
 
-      // TODO: needed?
-      std::memset(sector, 0, RAW_SECTOR_SIZE);
-      std::memset(sector + 1, 0xFF, 10);
+      eccedc_generate(sector, 3);
+      skip = 0x10;
+    }
+    break;
+
+    default:
+      UnreachableCode();
+      return false;
+  }
 
-      u32 skip;
-      switch (current->second.type)
+  std::memcpy(dst, sector + skip, s_chunk_sizes[static_cast<u32>(run.type)]);
+  return true;
+}
+
+bool CDImageEcm::ReadChunks(u32 disc_offset, u32 size)
+{
+  RunList::const_iterator current = FindRun(disc_offset);
+  if (current == m_runs.end())
+    return false;
+
+  // Encoded sectors have to be decoded whole, so the buffer may start before the requested offset.
+  if (current->type == SectorType::Raw)
+  {
+    m_chunk_start = disc_offset;
+  }
+  else
+  {
+    const u32 chunk_size = s_chunk_sizes[static_cast<u32>(current->type)];
+    m_chunk_start = current->disc_offset + (((disc_offset - current->disc_offset) / chunk_size) * chunk_size);
+  }
+
+  m_chunk_buffer.clear();
+  const u32 end_offset = disc_offset + size;
+  u32 offset = m_chunk_start;
+  while (offset < end_offset)
+  {
+    if (current == m_runs.end())
+      return false;
+
+    const u32 offset_in_run = offset - current->disc_offset;
+    const u32 chunk_start = static_cast<u32>(m_chunk_buffer.size());
+    if (current->type == SectorType::Raw)
+    {
+      const u32 read_size = std::min(current->size - offset_in_run, end_offset - offset);
+      m_chunk_buffer.resize(chunk_start + read_size);
+      if (std::fseek(m_fp, current->file_offset + offset_in_run, SEEK_SET) != 0 ||
+          std::fread(&m_chunk_buffer[chunk_start], read_size, 1, m_fp) != 1)
       {
-        case SectorType::Mode1:
-        {
-          sector[0x0F] = 0x01;
-          if (std::fread(sector + 0x00C, 0x003, 1, m_fp) != 1 || std::fread(sector + 0x010, 0x800, 1, m_fp) != 1)
-            return false;
-
-          eccedc_generate(sector, 1);
-          skip = 0;
-        }
-        break;
-
-        case SectorType::Mode2Form1:
-        {
-          sector[0x0F] = 0x02;
-          if (std::fread(sector + 0x014, 0x804, 1, m_fp) != 1)
-            return false;
-
-          sector[0x10] = sector[0x14];
-          sector[0x11] = sector[0x15];
-          sector[0x12] = sector[0x16];
-          sector[0x13] = sector[0x17];
-
-          eccedc_generate(sector, 2);
-          skip = 0x10;
-        }
-        break;
-
-        case SectorType::Mode2Form2:
-        {
-          sector[0x0F] = 0x02;
-          if (std::fread(sector + 0x014, 0x918, 1, m_fp) != 1)
-            return false;
-
-          sector[0x10] = sector[0x14];
-          sector[0x11] = sector[0x15];
-          sector[0x12] = sector[0x16];
-          sector[0x13] = sector[0x17];
-
-          eccedc_generate(sector, 3);
-          skip = 0x10;
-        }
-        break;
-
-        default:
-          UnreachableCode();
-          return false;
+        return false;
       }
 
-      std::memcpy(&m_chunk_buffer[chunk_start], sector + skip, chunk_size);
-      total_bytes_read += chunk_size;
+      offset += read_size;
+    }
+    else
+    {
+      const u32 chunk_size = s_chunk_sizes[static_cast<u32>(current->type)];
+      m_chunk_buffer.resize(chunk_start + chunk_size);
+      if (!DecodeSector(*current, offset_in_run / chunk_size, &m_chunk_buffer[chunk_start]))
+        return false;
+
+      offset += chunk_size;
     }
 
-    ++current;
+    if (offset >= (current->disc_offset + current->size))
+      ++current;
   }
 
   return true;
@@ -4,80 +4,290 @@
 #include "cd_image_hasher.h"
 #include "cd_image.h"
 #include "common/md5_digest.h"
+#include "common/path.h"
 #include "common/string_util.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace CDImageHasher {
 
-static bool ReadIndex(CDImage* image, u8 track, u8 index, MD5Digest* digest, ProgressCallback* progress_callback)
+namespace {
+
+struct Chunk
+{
+  CDImage::LBA start;
+  u32 count;
+  u32 digest_index;
+};
+
+/// Sectors are read (and decompressed) by one or more reader threads, each with their own instance of the image, and
+/// hashed in order on another thread. Readers work ahead across track boundaries, so tracks overlap.
+class HashPipeline
 {
-  const CDImage::LBA index_start = image->GetTrackIndexPosition(track, index);
-  const u32 index_length = image->GetTrackIndexLength(track, index);
-  const u32 update_interval = std::max<u32>(index_length / 100u, 1u);
+public:
+  HashPipeline(CDImage* image, u32 num_digests);
+  ~HashPipeline();
+
+  /// Adds the indices of a track which make up its hash, to the digest at the specified index.
+  void AddTrack(u8 track, u32 digest_index);
+
+  bool Run(ProgressCallback* progress_callback);
+
+  void GetHash(u32 digest_index, Hash* out_hash);
 
-  progress_callback->SetFormattedStatusText("Computing hash for track %u/index %u...", track, index);
-  progress_callback->SetProgressRange(index_length);
+private:
+  static constexpr u32 CHUNK_SECTORS = 128;
+  static constexpr u32 MAX_READERS = 4;
+  static constexpr u32 SLOTS_PER_READER = 2;
+  static constexpr u32 NO_CHUNK = 0xFFFFFFFFu;
 
-  if (!image->Seek(index_start))
+  struct Slot
   {
-    progress_callback->DisplayFormattedModalError("Failed to seek to sector %u for track %u index %u", index_start,
-                                                  track, index);
-    return false;
-  }
+    std::unique_ptr<u8[]> data;
+    u32 chunk = NO_CHUNK;
+    bool ready = false;
+  };
+
+  static bool IsCompressedImage(const CDImage* image);
+  std::unique_ptr<CDImage> OpenReaderImage() const;
+
+  void ReaderThread(CDImage* image);
+  void HashThread();
+  void SetError(std::string error);
+
+  CDImage* m_image;
+  std::vector<Chunk> m_chunks;
+  std::vector<MD5Digest> m_digests;
+  std::vector<Slot> m_slots;
+  u32 m_total_sectors = 0;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  u32 m_next_chunk = 0;
+  u32 m_chunks_hashed = 0;
+  u32 m_sectors_hashed = 0;
+  bool m_hash_done = false;
+  bool m_failed = false;
+  std::string m_error;
+};
 
-  std::array<u8, CDImage::RAW_SECTOR_SIZE> sector;
-  for (u32 lba = 0; lba < index_length; lba++)
+} // namespace
+
+HashPipeline::HashPipeline(CDImage* image, u32 num_digests) : m_image(image), m_digests(num_digests)
+{
+}
+
+HashPipeline::~HashPipeline() = default;
+
+void HashPipeline::AddTrack(u8 track, u32 digest_index)
+{
+  static constexpr u8 INDICES_TO_READ = 2;
+
+  for (u8 index = 0; index < INDICES_TO_READ; index++)
   {
-    if ((lba % update_interval) == 0)
-      progress_callback->SetProgressValue(lba);
+    // skip index 0 if data track
+    if (track == 1 && index == 0)
+      continue;
 
-    if (!image->ReadRawSector(sector.data(), nullptr))
+    const CDImage::LBA index_start = m_image->GetTrackIndexPosition(track, index);
+    const u32 index_length = m_image->GetTrackIndexLength(track, index);
+    for (u32 offset = 0; offset < index_length; offset += CHUNK_SECTORS)
     {
-      progress_callback->DisplayFormattedModalError("Failed to read sector %u from image", image->GetPositionOnDisc());
-      return false;
+      const u32 count = std::min(index_length - offset, CHUNK_SECTORS);
+      m_chunks.push_back(Chunk{index_start + offset, count, digest_index});
+      m_total_sectors += count;
     }
+  }
+}
+
+bool HashPipeline::IsCompressedImage(const CDImage* image)
+{
+  // Uncompressed images are I/O bound already, and more readers would just make the disk seek between tracks.
+  const std::string_view extension = Path::GetExtension(image->GetFileName());
+  return (StringUtil::EqualNoCase(extension, "chd") || StringUtil::EqualNoCase(extension, "pbp") ||
+          StringUtil::EqualNoCase(extension, "zcd"));
+}
 
-    digest->Update(sector.data(), static_cast<u32>(sector.size()));
+std::unique_ptr<CDImage> HashPipeline::OpenReaderImage() const
+{
+  std::unique_ptr<CDImage> image = CDImage::Open(m_image->GetFileName().c_str(), false, nullptr);
+  if (!image)
+    return {};
+
+  if (m_image->HasSubImages() && image->GetCurrentSubImage() != m_image->GetCurrentSubImage() &&
+      !image->SwitchSubImage(m_image->GetCurrentSubImage(), nullptr))
+  {
+    return {};
   }
 
-  progress_callback->SetProgressValue(index_length);
-  return true;
+  // Shouldn't happen, but don't risk hashing something different.
+  if (image->GetLBACount() != m_image->GetLBACount() || image->GetTrackCount() != m_image->GetTrackCount())
+    return {};
+
+  return image;
 }
 
-static bool ReadTrack(CDImage* image, u8 track, MD5Digest* digest, ProgressCallback* progress_callback)
+bool HashPipeline::Run(ProgressCallback* progress_callback)
 {
-  static constexpr u8 INDICES_TO_READ = 2;
+  progress_callback->SetStatusText("Computing hash...");
+  progress_callback->SetProgressRange(std::max<u32>(m_total_sectors, 1));
+  progress_callback->SetProgressValue(0);
 
-  progress_callback->PushState();
+  std::vector<std::unique_ptr<CDImage>> extra_images;
+  if (IsCompressedImage(m_image) && !m_image->IsPrecached())
+  {
+    const u32 max_readers = std::clamp<u32>(std::thread::hardware_concurrency(), 2, MAX_READERS + 1) - 1;
+    const u32 num_readers = std::clamp<u32>(static_cast<u32>(m_chunks.size()), 1, max_readers);
+    for (u32 i = 1; i < num_readers; i++)
+    {
+      std::unique_ptr<CDImage> image = OpenReaderImage();
+      if (!image)
+        break;
 
-  const bool dataTrack = track == 1;
-  progress_callback->SetProgressRange(dataTrack ? 1 : 2);
+      extra_images.push_back(std::move(image));
+    }
+  }
 
-  u8 progress = 0;
-  for (u8 index = 0; index < INDICES_TO_READ; index++)
+  const u32 num_readers = static_cast<u32>(extra_images.size()) + 1;
+  m_slots.resize(num_readers * SLOTS_PER_READER);
+  for (Slot& slot : m_slots)
+    slot.data = std::make_unique<u8[]>(CHUNK_SECTORS * CDImage::RAW_SECTOR_SIZE);
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_readers + 1);
+  threads.emplace_back(&HashPipeline::HashThread, this);
+  threads.emplace_back(&HashPipeline::ReaderThread, this, m_image);
+  for (const std::unique_ptr<CDImage>& image : extra_images)
+    threads.emplace_back(&HashPipeline::ReaderThread, this, image.get());
+
+  // The callback isn't thread safe, so progress is reported from here.
+  std::unique_lock lock(m_mutex);
+  while (!m_hash_done && !m_failed)
   {
-    progress_callback->SetProgressValue(progress);
+    m_cv.wait_for(lock, std::chrono::milliseconds(50));
 
-    // skip index 0 if data track
-    if (dataTrack && index == 0)
-      continue;
+    const u32 sectors_hashed = m_sectors_hashed;
+    lock.unlock();
+    progress_callback->SetProgressValue(sectors_hashed);
+    const bool cancelled = progress_callback->IsCancelled();
+    lock.lock();
 
-    progress++;
-    progress_callback->PushState();
-    if (!ReadIndex(image, track, index, digest, progress_callback))
+    if (cancelled && !m_failed)
     {
-      progress_callback->PopState();
-      progress_callback->PopState();
-      return false;
+      m_failed = true;
+      m_cv.notify_all();
     }
+  }
+
+  lock.unlock();
+  for (std::thread& thread : threads)
+    thread.join();
 
-    progress_callback->PopState();
+  if (m_failed)
+  {
+    if (!m_error.empty())
+      progress_callback->DisplayFormattedModalError("%s", m_error.c_str());
+
+    return false;
   }
 
-  progress_callback->SetProgressValue(progress);
-  progress_callback->PopState();
+  progress_callback->SetProgressValue(m_total_sectors);
   return true;
 }
 
+void HashPipeline::GetHash(u32 digest_index, Hash* out_hash)
+{
+  m_digests[digest_index].Final(out_hash->data());
+}
+
+void HashPipeline::ReaderThread(CDImage* image)
+{
+  std::unique_lock lock(m_mutex);
+  for (;;)
+  {
+    if (m_failed || m_next_chunk == m_chunks.size())
+      return;
+
+    // The slot is free once the chunk placed in it before this one has been hashed. Checking the slot alone isn't
+    // enough, a reader further ahead could take it first, and then wait for this chunk to be hashed.
+    const u32 chunk_index = m_next_chunk++;
+    Slot& slot = m_slots[chunk_index % m_slots.size()];
+    m_cv.wait(lock, [this, chunk_index]() {
+      return (m_failed || chunk_index < (m_chunks_hashed + static_cast<u32>(m_slots.size())));
+    });
+    if (m_failed)
+      return;
+
+    slot.chunk = chunk_index;
+    slot.ready = false;
+    lock.unlock();
+
+    const Chunk& chunk = m_chunks[chunk_index];
+    if (!image->Seek(chunk.start))
+    {
+      SetError(fmt::format("Failed to seek to sector {} in image", chunk.start));
+      return;
+    }
+
+    for (u32 i = 0; i < chunk.count; i++)
+    {
+      if (!image->ReadRawSector(&slot.data[i * CDImage::RAW_SECTOR_SIZE], nullptr))
+      {
+        SetError(fmt::format("Failed to read sector {} from image", image->GetPositionOnDisc()));
+        return;
+      }
+    }
+
+    lock.lock();
+    slot.ready = true;
+    m_cv.notify_all();
+  }
+}
+
+void HashPipeline::HashThread()
+{
+  std::unique_lock lock(m_mutex);
+  for (u32 chunk_index = 0; chunk_index < m_chunks.size(); chunk_index++)
+  {
+    Slot& slot = m_slots[chunk_index % m_slots.size()];
+    m_cv.wait(lock, [this, &slot, chunk_index]() { return (m_failed || (slot.chunk == chunk_index && slot.ready)); });
+    if (m_failed)
+      return;
+
+    lock.unlock();
+
+    const Chunk& chunk = m_chunks[chunk_index];
+    m_digests[chunk.digest_index].Update(slot.data.get(), chunk.count * CDImage::RAW_SECTOR_SIZE);
+
+    lock.lock();
+    slot.chunk = NO_CHUNK;
+    slot.ready = false;
+    m_chunks_hashed++;
+    m_sectors_hashed += chunk.count;
+    m_cv.notify_all();
+  }
+
+  m_hash_done = true;
+  m_cv.notify_all();
+}
+
+void HashPipeline::SetError(std::string error)
+{
+  std::unique_lock lock(m_mutex);
+  if (!m_failed)
+  {
+    m_failed = true;
+    m_error = std::move(error);
+  }
+
+  m_cv.notify_all();
+}
+
 std::string HashToString(const Hash& hash)
 {
   return fmt::format("{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
@@ -100,35 +310,44 @@ std::optional<Hash> HashFromString(const std::string_view& str)
 bool GetImageHash(CDImage* image, Hash* out_hash,
                   ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
 {
-  MD5Digest digest;
-
-  progress_callback->SetProgressRange(image->GetTrackCount());
-  progress_callback->SetProgressValue(0);
-  progress_callback->PushState();
-
+  HashPipeline pipeline(image, 1);
   for (u32 i = 1; i <= image->GetTrackCount(); i++)
-  {
-    progress_callback->SetProgressValue(i - 1);
-    if (!ReadTrack(image, static_cast<u8>(i), &digest, progress_callback))
-    {
-      progress_callback->PopState();
-      return false;
-    }
-  }
+    pipeline.AddTrack(static_cast<u8>(i), 0);
+
+  if (!pipeline.Run(progress_callback))
+    return false;
 
-  progress_callback->SetProgressValue(image->GetTrackCount());
-  digest.Final(out_hash->data());
+  pipeline.GetHash(0, out_hash);
   return true;
 }
 
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
                   ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
 {
-  MD5Digest digest;
-  if (!ReadTrack(image, track, &digest, progress_callback))
+  HashPipeline pipeline(image, 1);
+  pipeline.AddTrack(track, 0);
+  if (!pipeline.Run(progress_callback))
+    return false;
+
+  pipeline.GetHash(0, out_hash);
+  return true;
+}
+
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback /*= ProgressCallback::NullProgressCallback*/)
+{
+  const u32 track_count = image->GetTrackCount();
+  HashPipeline pipeline(image, track_count);
+  for (u32 i = 1; i <= track_count; i++)
+    pipeline.AddTrack(static_cast<u8>(i), i - 1);
+
+  if (!pipeline.Run(progress_callback))
     return false;
 
-  digest.Final(out_hash->data());
+  out_hashes->resize(track_count);
+  for (u32 i = 0; i < track_count; i++)
+    pipeline.GetHash(i, &(*out_hashes)[i]);
+
   return true;
 }
 
@@ -7,6 +7,7 @@
 #include <array>
 #include <optional>
 #include <string>
+#include <vector>
 
 class CDImage;
 
@@ -21,4 +22,9 @@ bool GetImageHash(CDImage* image, Hash* out_hash,
 bool GetTrackHash(CDImage* image, u8 track, Hash* out_hash,
                   ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
 
+/// Hashes every track in one pass. Compressed images are decompressed on several threads, which reopen the image from
+/// its file (without patches), so this is considerably faster than hashing each track in turn.
+bool GetTrackHashes(CDImage* image, std::vector<Hash>* out_hashes,
+                    ProgressCallback* progress_callback = ProgressCallback::NullProgressCallback);
+
 } // namespace CDImageHasher
\ No newline at end of file
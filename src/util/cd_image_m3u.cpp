@@ -11,7 +11,9 @@
 #include <algorithm>
 #include <cerrno>
 #include <map>
+#include <mutex>
 #include <sstream>
+#include <thread>
 Log_SetChannel(CDImageMemory);
 
 class CDImageM3u : public CDImage
@@ -33,6 +35,7 @@ public:
 
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  void ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count) override;
 
 private:
   struct Entry
@@ -42,15 +45,30 @@ private:
     std::string title;
   };
 
+  void StartPreparingSubImage(u32 index);
+  std::unique_ptr<CDImage> TakePreparedSubImage(u32 index);
+
   std::vector<Entry> m_entries;
   std::unique_ptr<CDImage> m_current_image;
   u32 m_current_image_index = UINT32_C(0xFFFFFFFF);
   bool m_apply_patches = false;
+
+  // The disc after the current one is opened in the background, so a swap doesn't stall on opening a large image.
+  // Only one is kept, and it isn't precached, so the cost is bounded to one open image's headers and buffers.
+  std::thread m_prepare_thread;
+  std::mutex m_prepare_mutex;
+  std::unique_ptr<CDImage> m_prepared_image;
+  u32 m_prepared_image_index = UINT32_C(0xFFFFFFFF);
+  bool m_prepare_next_image = false;
 };
 
 CDImageM3u::CDImageM3u() = default;
 
-CDImageM3u::~CDImageM3u() = default;
+CDImageM3u::~CDImageM3u()
+{
+  if (m_prepare_thread.joinable())
+    m_prepare_thread.join();
+}
 
 bool CDImageM3u::Open(const char* path, bool apply_patches, Error* error)
 {
@@ -135,11 +153,15 @@ bool CDImageM3u::SwitchSubImage(u32 index, Error* error)
     return true;
 
   const Entry& entry = m_entries[index];
-  std::unique_ptr<CDImage> new_image = CDImage::Open(entry.filename.c_str(), m_apply_patches, error);
+  std::unique_ptr<CDImage> new_image = TakePreparedSubImage(index);
   if (!new_image)
   {
-    Log_ErrorPrintf("Failed to load subimage %u (%s)", index, entry.filename.c_str());
-    return false;
+    new_image = CDImage::Open(entry.filename.c_str(), m_apply_patches, error);
+    if (!new_image)
+    {
+      Log_ErrorPrintf("Failed to load subimage %u (%s)", index, entry.filename.c_str());
+      return false;
+    }
   }
 
   CopyTOC(new_image.get());
@@ -148,9 +170,63 @@ bool CDImageM3u::SwitchSubImage(u32 index, Error* error)
   if (!Seek(1, Position{0, 0, 0}))
     Panic("Failed to seek to start after sub-image change.");
 
+  // Games almost always ask for the discs in order. Waits for the first readahead, which only comes from the emulated
+  // drive, so images opened just to be scanned don't start opening the next disc.
+  m_prepare_next_image = ((index + 1) < m_entries.size());
   return true;
 }
 
+void CDImageM3u::StartPreparingSubImage(u32 index)
+{
+  if (m_prepare_thread.joinable())
+    m_prepare_thread.join();
+
+  {
+    std::unique_lock lock(m_prepare_mutex);
+    if (m_prepared_image && m_prepared_image_index == index)
+      return;
+
+    // Drop whatever was prepared for a different disc before opening another, so there's never more than one.
+    m_prepared_image.reset();
+    m_prepared_image_index = index;
+  }
+
+  m_prepare_thread = std::thread([this, index, filename = m_entries[index].filename]() {
+    Error error;
+    std::unique_ptr<CDImage> image = CDImage::Open(filename.c_str(), m_apply_patches, &error);
+    if (!image)
+    {
+      // Not fatal, the swap will try again and report the error then.
+      Log_WarningPrintf("Failed to prepare subimage %u (%s): %s", index, filename.c_str(),
+                        error.GetDescription().c_str());
+      return;
+    }
+
+    Log_DevPrintf("Prepared subimage %u (%s)", index, filename.c_str());
+    std::unique_lock lock(m_prepare_mutex);
+    if (m_prepared_image_index == index)
+      m_prepared_image = std::move(image);
+  });
+}
+
+std::unique_ptr<CDImage> CDImageM3u::TakePreparedSubImage(u32 index)
+{
+  std::unique_lock lock(m_prepare_mutex);
+  if (m_prepared_image_index != index)
+    return {};
+
+  // Still opening, waiting for it is never slower than starting over.
+  if (m_prepare_thread.joinable())
+  {
+    lock.unlock();
+    m_prepare_thread.join();
+    lock.lock();
+  }
+
+  m_prepared_image_index = UINT32_C(0xFFFFFFFF);
+  return std::move(m_prepared_image);
+}
+
 std::string CDImageM3u::GetSubImageMetadata(u32 index, const std::string_view& type) const
 {
   if (index > m_entries.size())
@@ -169,6 +245,17 @@ bool CDImageM3u::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   return m_current_image->ReadSectorFromIndex(buffer, index, lba_in_index);
 }
 
+void CDImageM3u::ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count)
+{
+  m_current_image->ReadaheadIndex(index, lba_in_index, sector_count);
+
+  if (m_prepare_next_image)
+  {
+    m_prepare_next_image = false;
+    StartPreparingSubImage(m_current_image_index + 1);
+  }
+}
+
 bool CDImageM3u::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   return m_current_image->ReadSubChannelQ(subq, index, lba_in_index);
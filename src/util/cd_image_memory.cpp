@@ -6,18 +6,57 @@
 #include "common/assert.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/memmap.h"
 #include "common/path.h"
+#include "common/sha1_digest.h"
+#include "common/timer.h"
+
+#include "fmt/format.h"
+
 #include <algorithm>
+#include <atomic>
 #include <cerrno>
+#include <thread>
 Log_SetChannel(CDImageMemory);
 
+#ifndef __ANDROID__
+#define SHARED_PRECACHE_SUPPORTED 1
+#endif
+
+namespace {
+
+/// Placed ahead of the sector data in a shared precache. The data is only valid once state is READY.
+struct SharedPrecacheHeader
+{
+  enum : u32
+  {
+    FILLING,
+    READY,
+    FAILED,
+  };
+
+  u32 magic;
+  u32 num_sectors;
+  std::atomic<u32> state;
+  std::atomic<u32> ref_count;
+  std::atomic<u32> sectors_filled;
+};
+
+static constexpr u32 SHARED_PRECACHE_MAGIC = 0x48435044; // DPCH
+static constexpr size_t SHARED_PRECACHE_DATA_OFFSET = 64;
+
+/// How long to wait for the instance filling a shared precache to make progress before giving up on it.
+static constexpr double SHARED_PRECACHE_STALL_TIMEOUT = 10.0;
+
+} // namespace
+
 class CDImageMemory : public CDImage
 {
 public:
   CDImageMemory();
   ~CDImageMemory() override;
 
-  bool CopyImage(CDImage* image, ProgressCallback* progress);
+  bool CopyImage(CDImage* image, ProgressCallback* progress, bool shared);
 
   bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
   bool HasNonStandardSubchannel() const override;
@@ -28,20 +67,166 @@ protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
 
 private:
+#ifdef SHARED_PRECACHE_SUPPORTED
+  static std::string GetSharedMemoryName(CDImage* image);
+
+  /// Returns true if another instance has already filled the shared memory.
+  bool OpenSharedMemory(CDImage* image, ProgressCallback* progress);
+  void CloseSharedMemory();
+
+  ALWAYS_INLINE SharedPrecacheHeader* GetSharedHeader() const
+  {
+    return reinterpret_cast<SharedPrecacheHeader*>(m_shared_memory);
+  }
+#endif
+
   u8* m_memory = nullptr;
   u32 m_memory_sectors = 0;
   CDSubChannelReplacement m_sbi;
+
+#ifdef SHARED_PRECACHE_SUPPORTED
+  u8* m_shared_memory = nullptr;
+  size_t m_shared_memory_size = 0;
+  std::string m_shared_memory_name;
+#endif
 };
 
 CDImageMemory::CDImageMemory() = default;
 
 CDImageMemory::~CDImageMemory()
 {
+#ifdef SHARED_PRECACHE_SUPPORTED
+  if (m_shared_memory)
+  {
+    CloseSharedMemory();
+    return;
+  }
+#endif
+
   if (m_memory)
     std::free(m_memory);
 }
 
-bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress)
+#ifdef SHARED_PRECACHE_SUPPORTED
+
+std::string CDImageMemory::GetSharedMemoryName(CDImage* image)
+{
+  // Hashing the whole image would take about as long as reading it in the first place. The layout, plus the start of
+  // each track (which covers the volume descriptor and root directory of the data track) is enough to tell discs apart.
+  static constexpr u32 SECTORS_PER_INDEX = 32;
+
+  SHA1Digest digest;
+  u8 sector[RAW_SECTOR_SIZE];
+  for (u32 i = 0; i < image->GetIndexCount(); i++)
+  {
+    const Index& index = image->GetIndex(i);
+    const u32 layout[] = {index.start_lba_on_disc, index.length,           index.track_number,
+                          index.index_number,      index.file_sector_size, static_cast<u32>(index.mode)};
+    digest.Update(layout, sizeof(layout));
+
+    if (index.file_sector_size == 0)
+      continue;
+
+    for (u32 lba = 0; lba < std::min(index.length, SECTORS_PER_INDEX); lba++)
+    {
+      if (image->ReadSectorFromIndex(sector, index, lba))
+        digest.Update(sector, sizeof(sector));
+    }
+  }
+
+  u8 hash[SHA1Digest::DIGEST_SIZE];
+  digest.Final(hash);
+
+  // Kept short, macOS limits shared memory names to 31 characters.
+  return fmt::format("dsprecache_{}", SHA1Digest::DigestToString(hash).substr(0, 16));
+}
+
+bool CDImageMemory::OpenSharedMemory(CDImage* image, ProgressCallback* progress)
+{
+  std::string name = GetSharedMemoryName(image);
+  const size_t size = SHARED_PRECACHE_DATA_OFFSET + static_cast<size_t>(RAW_SECTOR_SIZE) * m_memory_sectors;
+  bool created;
+  u8* base = static_cast<u8*>(MemMap::MapNamedSharedMemory(name.c_str(), size, &created));
+  if (!base)
+  {
+    Log_WarningPrintf("Failed to open shared precache '%s', using a private copy", name.c_str());
+    return false;
+  }
+
+  m_shared_memory = base;
+  m_shared_memory_size = size;
+  m_shared_memory_name = std::move(name);
+  m_memory = base + SHARED_PRECACHE_DATA_OFFSET;
+
+  // New objects are zero filled, so this is safe even if another instance opened it before we got here.
+  SharedPrecacheHeader* header = GetSharedHeader();
+  header->ref_count.fetch_add(1, std::memory_order_acq_rel);
+  if (created)
+  {
+    Log_InfoPrintf("Created shared precache '%s'", m_shared_memory_name.c_str());
+    header->magic = SHARED_PRECACHE_MAGIC;
+    header->num_sectors = m_memory_sectors;
+    return false;
+  }
+
+  progress->SetStatusText("Waiting for another instance to preload the CD image...");
+  progress->SetProgressRange(m_memory_sectors);
+  progress->SetProgressValue(0);
+
+  Common::Timer stall_timer;
+  u32 last_sectors_filled = 0;
+  for (;;)
+  {
+    const u32 state = header->state.load(std::memory_order_acquire);
+    if (state == SharedPrecacheHeader::READY && header->magic == SHARED_PRECACHE_MAGIC &&
+        header->num_sectors == m_memory_sectors)
+    {
+      Log_InfoPrintf("Using shared precache '%s'", m_shared_memory_name.c_str());
+      return true;
+    }
+    else if (state != SharedPrecacheHeader::FILLING || progress->IsCancelled())
+    {
+      break;
+    }
+
+    const u32 sectors_filled = header->sectors_filled.load(std::memory_order_relaxed);
+    if (sectors_filled != last_sectors_filled)
+    {
+      last_sectors_filled = sectors_filled;
+      progress->SetProgressValue(sectors_filled);
+      stall_timer.Reset();
+    }
+    else if (stall_timer.GetTimeSeconds() >= SHARED_PRECACHE_STALL_TIMEOUT)
+    {
+      // Probably crashed part way through.
+      Log_WarningPrintf("Shared precache '%s' isn't being filled", m_shared_memory_name.c_str());
+      break;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  Log_WarningPrintf("Shared precache '%s' is unusable, using a private copy", m_shared_memory_name.c_str());
+  CloseSharedMemory();
+  return false;
+}
+
+void CDImageMemory::CloseSharedMemory()
+{
+  // Last one out removes the name, the memory itself goes away with the last mapping.
+  if (GetSharedHeader()->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    MemMap::RemoveNamedSharedMemory(m_shared_memory_name.c_str());
+
+  MemMap::UnmapFile(m_shared_memory, m_shared_memory_size);
+  m_shared_memory = nullptr;
+  m_shared_memory_size = 0;
+  m_shared_memory_name = {};
+  m_memory = nullptr;
+}
+
+#endif
+
+bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress, bool shared)
 {
   // figure out the total number of sectors (not including blank pregaps)
   m_memory_sectors = 0;
@@ -59,40 +244,73 @@ bool CDImageMemory::CopyImage(CDImage* image, ProgressCallback* progress)
     return false;
   }
 
-  progress->SetFormattedStatusText("Allocating memory for %u sectors...", m_memory_sectors);
+  bool filled = false;
+#ifdef SHARED_PRECACHE_SUPPORTED
+  if (shared)
+    filled = OpenSharedMemory(image, progress);
+#endif
 
-  m_memory =
-    static_cast<u8*>(std::malloc(static_cast<size_t>(RAW_SECTOR_SIZE) * static_cast<size_t>(m_memory_sectors)));
   if (!m_memory)
   {
-    progress->DisplayFormattedModalError("Failed to allocate memory for %u sectors", m_memory_sectors);
-    return false;
-  }
+    progress->SetFormattedStatusText("Allocating memory for %u sectors...", m_memory_sectors);
 
-  progress->SetStatusText("Preloading CD image to RAM...");
-  progress->SetProgressRange(m_memory_sectors);
-  progress->SetProgressValue(0);
+    m_memory =
+      static_cast<u8*>(std::malloc(static_cast<size_t>(RAW_SECTOR_SIZE) * static_cast<size_t>(m_memory_sectors)));
+    if (!m_memory)
+    {
+      progress->DisplayFormattedModalError("Failed to allocate memory for %u sectors", m_memory_sectors);
+      return false;
+    }
+  }
 
-  u8* memory_ptr = m_memory;
-  u32 sectors_read = 0;
-  for (u32 i = 0; i < image->GetIndexCount(); i++)
+  if (!filled)
   {
-    const Index& index = image->GetIndex(i);
-    if (index.file_sector_size == 0)
-      continue;
+    progress->SetStatusText("Preloading CD image to RAM...");
+    progress->SetProgressRange(m_memory_sectors);
+    progress->SetProgressValue(0);
+
+#ifdef SHARED_PRECACHE_SUPPORTED
+    SharedPrecacheHeader* shared_header = GetSharedHeader();
+#endif
 
-    for (u32 lba = 0; lba < index.length; lba++)
+    u8* memory_ptr = m_memory;
+    u32 sectors_read = 0;
+    for (u32 i = 0; i < image->GetIndexCount(); i++)
     {
-      if (!image->ReadSectorFromIndex(memory_ptr, index, lba))
+      const Index& index = image->GetIndex(i);
+      if (index.file_sector_size == 0)
+        continue;
+
+      for (u32 lba = 0; lba < index.length; lba++)
       {
-        Log_ErrorPrintf("Failed to read LBA %u in index %u", lba, i);
-        return false;
-      }
+        if (!image->ReadSectorFromIndex(memory_ptr, index, lba))
+        {
+          Log_ErrorPrintf("Failed to read LBA %u in index %u", lba, i);
+#ifdef SHARED_PRECACHE_SUPPORTED
+          if (shared_header)
+          {
+            shared_header->state.store(SharedPrecacheHeader::FAILED, std::memory_order_release);
+            CloseSharedMemory();
+          }
+#endif
+          return false;
+        }
+
+        progress->SetProgressValue(sectors_read);
+        memory_ptr += RAW_SECTOR_SIZE;
+        sectors_read++;
 
-      progress->SetProgressValue(sectors_read);
-      memory_ptr += RAW_SECTOR_SIZE;
-      sectors_read++;
+#ifdef SHARED_PRECACHE_SUPPORTED
+        if (shared_header)
+          shared_header->sectors_filled.store(sectors_read, std::memory_order_relaxed);
+#endif
+      }
     }
+
+#ifdef SHARED_PRECACHE_SUPPORTED
+    if (shared_header)
+      shared_header->state.store(SharedPrecacheHeader::READY, std::memory_order_release);
+#endif
   }
 
   for (u32 i = 1; i <= image->GetTrackCount(); i++)
@@ -152,10 +370,11 @@ bool CDImageMemory::ReadSectorFromIndex(void* buffer, const Index& index, LBA lb
 }
 
 std::unique_ptr<CDImage>
-CDImage::CreateMemoryImage(CDImage* image, ProgressCallback* progress /* = ProgressCallback::NullProgressCallback */)
+CDImage::CreateMemoryImage(CDImage* image, ProgressCallback* progress /* = ProgressCallback::NullProgressCallback */,
+                           bool shared /* = false */)
 {
   std::unique_ptr<CDImageMemory> memory_image = std::make_unique<CDImageMemory>();
-  if (!memory_image->CopyImage(image, progress))
+  if (!memory_image->CopyImage(image, progress, shared))
     return {};
 
   return memory_image;
@@ -12,8 +12,14 @@
 #include "pbp_types.h"
 #include "string.h"
 #include "zlib.h"
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
 #include <vector>
 Log_SetChannel(CDImagePBP);
 
@@ -39,16 +45,29 @@ public:
   std::string GetMetadata(const std::string_view& type) const override;
   std::string GetSubImageMetadata(u32 index, const std::string_view& type) const override;
 
+  PrecacheResult Precache(ProgressCallback* progress) override;
+  bool IsPrecached() const override;
+
 protected:
   bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
 
 private:
+  static constexpr u32 BLOCK_CACHE_SIZE = 4;
+  static constexpr u32 MAX_PRECACHE_THREADS = 8;
+
   struct BlockInfo
   {
     u32 offset; // Absolute offset from start of file
     u16 size;
   };
 
+  struct CachedBlock
+  {
+    u32 index;
+    u32 last_used;
+    std::array<u8, DECOMPRESSED_BLOCK_SIZE> data;
+  };
+
 #if _DEBUG
   static void PrintPBPHeaderInfo(const PBPHeader& pbp_header);
   static void PrintSFOHeaderInfo(const SFOHeader& sfo_header);
@@ -64,7 +83,11 @@ private:
   bool IsValidEboot(Error* error);
 
   bool InitDecompressionStream();
-  bool DecompressBlock(const BlockInfo& block_info);
+  static bool InflateBlock(z_stream* stream, const u8* src, u32 src_size, u8* dst);
+  bool DecompressBlock(const BlockInfo& block_info, u8* dst);
+  const u8* GetDecompressedBlock(u32 block_index);
+  void ClearBlockCache();
+  void FreePrecachedData();
 
   bool OpenDisc(u32 index, Error* error);
 
@@ -86,12 +109,17 @@ private:
 
   std::array<TOCEntry, TOC_NUM_ENTRIES> m_toc;
 
-  u32 m_current_block = static_cast<u32>(-1);
-  std::array<u8, DECOMPRESSED_BLOCK_SIZE> m_decompressed_block;
+  // Most recently used blocks, so seeking back and forth between neighbours doesn't inflate them again.
+  std::array<CachedBlock, BLOCK_CACHE_SIZE> m_block_cache;
+  u32 m_block_cache_counter = 0;
   std::vector<u8> m_compressed_block;
 
   z_stream m_inflate_stream;
 
+  // Every block of the current disc, once precached.
+  u8* m_precached_data = nullptr;
+  u32 m_precached_blocks = 0;
+
   CDSubChannelReplacement m_sbi;
 };
 
@@ -128,6 +156,7 @@ CDImagePBP::~CDImagePBP()
     fclose(m_file);
 
   inflateEnd(&m_inflate_stream);
+  FreePrecachedData();
 }
 
 bool CDImagePBP::LoadPBPHeader()
@@ -441,10 +470,10 @@ bool CDImagePBP::OpenDisc(u32 index, Error* error)
     return false;
   }
 
-  m_current_block = static_cast<u32>(-1);
+  ClearBlockCache();
+  FreePrecachedData();
   m_blockinfo_table.fill({});
   m_toc.fill({});
-  m_decompressed_block.fill(0x00);
   m_compressed_block.clear();
 
   // Go to ISO header
@@ -705,39 +734,207 @@ bool CDImagePBP::InitDecompressionStream()
   return ret == Z_OK;
 }
 
-bool CDImagePBP::DecompressBlock(const BlockInfo& block_info)
+bool CDImagePBP::InflateBlock(z_stream* stream, const u8* src, u32 src_size, u8* dst)
 {
-  if (FSeek64(m_file, block_info.offset, SEEK_SET) != 0)
+  stream->next_in = const_cast<u8*>(src);
+  stream->avail_in = static_cast<uInt>(src_size);
+  stream->next_out = dst;
+  stream->avail_out = static_cast<uInt>(DECOMPRESSED_BLOCK_SIZE);
+
+  if (inflateReset(stream) != Z_OK)
     return false;
 
-  // Compression level 0 has compressed size == decompressed size.
-  if (block_info.size == m_decompressed_block.size())
+  int err = inflate(stream, Z_FINISH);
+  if (err != Z_STREAM_END)
   {
-    return (fread(m_decompressed_block.data(), sizeof(u8), m_decompressed_block.size(), m_file) ==
-            m_decompressed_block.size());
+    Log_ErrorPrintf("Inflate error %d", err);
+    return false;
   }
 
+  return true;
+}
+
+bool CDImagePBP::DecompressBlock(const BlockInfo& block_info, u8* dst)
+{
+  if (FSeek64(m_file, block_info.offset, SEEK_SET) != 0)
+    return false;
+
+  // Compression level 0 has compressed size == decompressed size.
+  if (block_info.size == DECOMPRESSED_BLOCK_SIZE)
+    return (fread(dst, sizeof(u8), DECOMPRESSED_BLOCK_SIZE, m_file) == DECOMPRESSED_BLOCK_SIZE);
+
   m_compressed_block.resize(block_info.size);
 
   if (fread(m_compressed_block.data(), sizeof(u8), m_compressed_block.size(), m_file) != m_compressed_block.size())
     return false;
 
-  m_inflate_stream.next_in = m_compressed_block.data();
-  m_inflate_stream.avail_in = static_cast<uInt>(m_compressed_block.size());
-  m_inflate_stream.next_out = m_decompressed_block.data();
-  m_inflate_stream.avail_out = static_cast<uInt>(m_decompressed_block.size());
+  return InflateBlock(&m_inflate_stream, m_compressed_block.data(), block_info.size, dst);
+}
 
-  if (inflateReset(&m_inflate_stream) != Z_OK)
-    return false;
+const u8* CDImagePBP::GetDecompressedBlock(u32 block_index)
+{
+  if (block_index < m_precached_blocks)
+    return m_precached_data + (static_cast<size_t>(block_index) * DECOMPRESSED_BLOCK_SIZE);
 
-  int err = inflate(&m_inflate_stream, Z_FINISH);
-  if (err != Z_STREAM_END)
+  CachedBlock* lru = &m_block_cache[0];
+  for (CachedBlock& cb : m_block_cache)
   {
-    Log_ErrorPrintf("Inflate error %d", err);
-    return false;
+    if (cb.index == block_index)
+    {
+      cb.last_used = ++m_block_cache_counter;
+      return cb.data.data();
+    }
+
+    if (cb.last_used < lru->last_used)
+      lru = &cb;
   }
 
-  return true;
+  // Don't leave a partially decompressed block behind if it fails.
+  lru->index = static_cast<u32>(-1);
+  lru->last_used = 0;
+  if (!DecompressBlock(m_blockinfo_table[block_index], lru->data.data()))
+    return nullptr;
+
+  lru->index = block_index;
+  lru->last_used = ++m_block_cache_counter;
+  return lru->data.data();
+}
+
+void CDImagePBP::ClearBlockCache()
+{
+  for (CachedBlock& cb : m_block_cache)
+  {
+    cb.index = static_cast<u32>(-1);
+    cb.last_used = 0;
+  }
+
+  m_block_cache_counter = 0;
+}
+
+void CDImagePBP::FreePrecachedData()
+{
+  std::free(m_precached_data);
+  m_precached_data = nullptr;
+  m_precached_blocks = 0;
+}
+
+CDImage::PrecacheResult CDImagePBP::Precache(ProgressCallback* progress)
+{
+  if (m_precached_data)
+    return CDImage::PrecacheResult::Success;
+
+  u32 num_blocks = BLOCK_TABLE_NUM_ENTRIES;
+  while (num_blocks > 0 && m_blockinfo_table[num_blocks - 1].size == 0)
+    num_blocks--;
+  if (num_blocks == 0)
+    return CDImage::PrecacheResult::ReadError;
+
+  progress->SetStatusText(fmt::format("Precaching {}...", FileSystem::GetDisplayNameFromPath(m_filename)).c_str());
+  progress->SetProgressRange(num_blocks);
+  progress->SetProgressValue(0);
+
+  u8* data = static_cast<u8*>(std::calloc(num_blocks, DECOMPRESSED_BLOCK_SIZE));
+  if (!data)
+  {
+    progress->DisplayFormattedModalError("Failed to allocate memory for %u blocks", num_blocks);
+    return CDImage::PrecacheResult::ReadError;
+  }
+
+  // Blocks are independent, so each thread inflates with its own stream. Reads share the file, and are serialized.
+  std::mutex mutex;
+  std::condition_variable cv;
+  u32 next_block = 0;
+  u32 blocks_done = 0;
+  bool failed = false;
+
+  const auto worker = [this, data, num_blocks, &mutex, &cv, &next_block, &blocks_done, &failed]() {
+    z_stream stream = {};
+    const bool stream_okay = (inflateInit2(&stream, -MAX_WBITS) == Z_OK);
+    std::vector<u8> compressed;
+
+    std::unique_lock lock(mutex);
+    failed |= !stream_okay;
+    while (!failed && next_block < num_blocks)
+    {
+      const u32 block_index = next_block++;
+      const BlockInfo& bi = m_blockinfo_table[block_index];
+      u8* dst = data + (static_cast<size_t>(block_index) * DECOMPRESSED_BLOCK_SIZE);
+
+      // Missing blocks are left zeroed, ReadSectorFromIndex() rejects them anyway.
+      bool okay = true;
+      if (bi.size == DECOMPRESSED_BLOCK_SIZE)
+      {
+        okay = (FSeek64(m_file, bi.offset, SEEK_SET) == 0 &&
+                fread(dst, sizeof(u8), DECOMPRESSED_BLOCK_SIZE, m_file) == DECOMPRESSED_BLOCK_SIZE);
+      }
+      else if (bi.size != 0)
+      {
+        compressed.resize(bi.size);
+        okay = (FSeek64(m_file, bi.offset, SEEK_SET) == 0 &&
+                fread(compressed.data(), sizeof(u8), compressed.size(), m_file) == compressed.size());
+        if (okay)
+        {
+          lock.unlock();
+          okay = InflateBlock(&stream, compressed.data(), bi.size, dst);
+          lock.lock();
+        }
+      }
+
+      if (!okay)
+      {
+        Log_ErrorPrintf("Failed to decompress block %u", block_index);
+        failed = true;
+      }
+
+      if (++blocks_done == num_blocks || failed)
+        cv.notify_one();
+    }
+
+    lock.unlock();
+    if (stream_okay)
+      inflateEnd(&stream);
+  };
+
+  const u32 num_threads = std::clamp<u32>(std::thread::hardware_concurrency(), 1, MAX_PRECACHE_THREADS);
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (u32 i = 0; i < num_threads; i++)
+    threads.emplace_back(worker);
+
+  // The callback isn't thread safe, so progress is reported from here.
+  std::unique_lock lock(mutex);
+  while (!failed && blocks_done < num_blocks)
+  {
+    cv.wait_for(lock, std::chrono::milliseconds(50));
+
+    const u32 current_blocks_done = blocks_done;
+    lock.unlock();
+    progress->SetProgressValue(current_blocks_done);
+    const bool cancelled = progress->IsCancelled();
+    lock.lock();
+
+    failed |= cancelled;
+  }
+
+  lock.unlock();
+  for (std::thread& thread : threads)
+    thread.join();
+
+  if (failed)
+  {
+    std::free(data);
+    return CDImage::PrecacheResult::ReadError;
+  }
+
+  m_precached_data = data;
+  m_precached_blocks = num_blocks;
+  progress->SetProgressValue(num_blocks);
+  return CDImage::PrecacheResult::Success;
+}
+
+bool CDImagePBP::IsPrecached() const
+{
+  return (m_precached_data != nullptr);
 }
 
 bool CDImagePBP::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
@@ -767,13 +964,14 @@ bool CDImagePBP::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
     return false;
   }
 
-  if (m_current_block != requested_block && !DecompressBlock(bi))
+  const u8* block = GetDecompressedBlock(requested_block);
+  if (!block)
   {
     Log_ErrorPrintf("Failed to decompress block %u", requested_block);
     return false;
   }
 
-  std::memcpy(buffer, &m_decompressed_block[offset_in_block], RAW_SECTOR_SIZE);
+  std::memcpy(buffer, block + offset_in_block, RAW_SECTOR_SIZE);
   return true;
 }
 
@@ -9,7 +9,7 @@
 #include <algorithm>
 #include <cerrno>
 #include <map>
-#include <unordered_map>
+#include <vector>
 Log_SetChannel(CDImagePPF);
 
 enum : u32
@@ -43,11 +43,27 @@ private:
   bool ReadV3Patch(std::FILE* fp);
   u32 ReadFileIDDiz(std::FILE* fp, u32 version);
 
+  struct ReplacementSector
+  {
+    u32 sector;
+    u32 data_offset;
+  };
+
   bool AddPatch(u64 offset, const u8* patch, u32 patch_size);
+  u32 GetOrCreateReplacementSector(u32 sector_index);
+
+  ALWAYS_INLINE bool IsSectorPatched(u32 sector_index) const
+  {
+    return (sector_index < (m_patched_sector_bitmap.size() * 64) &&
+            (m_patched_sector_bitmap[sector_index / 64] & (u64(1) << (sector_index % 64))) != 0);
+  }
 
   std::unique_ptr<CDImage> m_parent_image;
   std::vector<u8> m_replacement_data;
-  std::unordered_map<u32, u32> m_replacement_map;
+
+  // Sorted by sector. The bitmap lets unpatched sectors skip the search entirely.
+  std::vector<ReplacementSector> m_replacement_sectors;
+  std::vector<u64> m_patched_sector_bitmap;
   u32 m_replacement_offset = 0;
 };
 
@@ -80,6 +96,7 @@ bool CDImagePPF::Open(const char* filename, std::unique_ptr<CDImage> parent_imag
   m_filename = parent_image->GetFileName();
   m_tracks = parent_image->GetTracks();
   m_indices = parent_image->GetIndices();
+  m_patched_sector_bitmap.resize((parent_image->GetLBACount() + 63) / 64);
   m_parent_image = std::move(parent_image);
 
   if (magic == 0x33465050) // PPF3
@@ -180,7 +197,7 @@ bool CDImagePPF::ReadV1Patch(std::FILE* fp)
     count -= sizeof(offset) + sizeof(chunk_size) + chunk_size;
   }
 
-  Log_InfoPrintf("Loaded %zu replacement sectors from version 1 PPF", m_replacement_map.size());
+  Log_InfoPrintf("Loaded %zu replacement sectors from version 1 PPF", m_replacement_sectors.size());
   return true;
 }
 
@@ -269,7 +286,7 @@ bool CDImagePPF::ReadV2Patch(std::FILE* fp)
     count -= sizeof(offset) + sizeof(chunk_size) + chunk_size;
   }
 
-  Log_InfoPrintf("Loaded %zu replacement sectors from version 2 PPF", m_replacement_map.size());
+  Log_InfoPrintf("Loaded %zu replacement sectors from version 2 PPF", m_replacement_sectors.size());
   return true;
 }
 
@@ -349,7 +366,7 @@ bool CDImagePPF::ReadV3Patch(std::FILE* fp)
     count -= sizeof(offset) + sizeof(chunk_size) + chunk_size;
   }
 
-  Log_InfoPrintf("Loaded %zu replacement sectors from version 3 PPF", m_replacement_map.size());
+  Log_InfoPrintf("Loaded %zu replacement sectors from version 3 PPF", m_replacement_sectors.size());
   return true;
 }
 
@@ -369,24 +386,16 @@ bool CDImagePPF::AddPatch(u64 offset, const u8* patch, u32 patch_size)
 
     const u32 bytes_to_patch = std::min(patch_size, RAW_SECTOR_SIZE - sector_offset);
 
-    auto iter = m_replacement_map.find(sector_index);
-    if (iter == m_replacement_map.end())
+    const u32 data_offset = GetOrCreateReplacementSector(sector_index);
+    if (data_offset == static_cast<u32>(-1))
     {
-      const u32 replacement_buffer_start = static_cast<u32>(m_replacement_data.size());
-      m_replacement_data.resize(m_replacement_data.size() + RAW_SECTOR_SIZE);
-      if (!m_parent_image->Seek(sector_index) ||
-          !m_parent_image->ReadRawSector(&m_replacement_data[replacement_buffer_start], nullptr))
-      {
-        Log_ErrorPrintf("Failed to read sector %u from parent image", sector_index);
-        return false;
-      }
-
-      iter = m_replacement_map.emplace(sector_index, replacement_buffer_start).first;
+      Log_ErrorPrintf("Failed to read sector %u from parent image", sector_index);
+      return false;
     }
 
     // patch it!
     Log_DebugPrintf("  Patching %u bytes at sector %u offset %u", bytes_to_patch, sector_index, sector_offset);
-    std::memcpy(&m_replacement_data[iter->second + sector_offset], patch, bytes_to_patch);
+    std::memcpy(&m_replacement_data[data_offset + sector_offset], patch, bytes_to_patch);
     offset += bytes_to_patch;
     patch += bytes_to_patch;
     patch_size -= bytes_to_patch;
@@ -395,6 +404,28 @@ bool CDImagePPF::AddPatch(u64 offset, const u8* patch, u32 patch_size)
   return true;
 }
 
+u32 CDImagePPF::GetOrCreateReplacementSector(u32 sector_index)
+{
+  // Patches are usually in offset order, so new sectors are normally appended.
+  auto iter = m_replacement_sectors.end();
+  if (!m_replacement_sectors.empty() && m_replacement_sectors.back().sector >= sector_index)
+  {
+    iter = std::lower_bound(m_replacement_sectors.begin(), m_replacement_sectors.end(), sector_index,
+                            [](const ReplacementSector& rs, u32 sector) { return rs.sector < sector; });
+    if (iter->sector == sector_index)
+      return iter->data_offset;
+  }
+
+  const u32 data_offset = static_cast<u32>(m_replacement_data.size());
+  m_replacement_data.resize(m_replacement_data.size() + RAW_SECTOR_SIZE);
+  if (!m_parent_image->Seek(sector_index) || !m_parent_image->ReadRawSector(&m_replacement_data[data_offset], nullptr))
+    return static_cast<u32>(-1);
+
+  m_replacement_sectors.insert(iter, ReplacementSector{sector_index, data_offset});
+  m_patched_sector_bitmap[sector_index / 64] |= u64(1) << (sector_index % 64);
+  return data_offset;
+}
+
 bool CDImagePPF::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
 {
   return m_parent_image->ReadSubChannelQ(subq, index, lba_in_index);
@@ -430,11 +461,13 @@ bool CDImagePPF::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   DebugAssert(index.file_index == 0);
 
   const u32 sector_number = index.start_lba_on_disc + lba_in_index;
-  const auto it = m_replacement_map.find(sector_number);
-  if (it == m_replacement_map.end())
+  if (!IsSectorPatched(sector_number))
     return m_parent_image->ReadSectorFromIndex(buffer, index, lba_in_index);
 
-  std::memcpy(buffer, &m_replacement_data[it->second], RAW_SECTOR_SIZE);
+  const auto it = std::lower_bound(m_replacement_sectors.begin(), m_replacement_sectors.end(), sector_number,
+                                   [](const ReplacementSector& rs, u32 sector) { return rs.sector < sector; });
+  DebugAssert(it != m_replacement_sectors.end() && it->sector == sector_number);
+  std::memcpy(buffer, &m_replacement_data[it->data_offset], RAW_SECTOR_SIZE);
   return true;
 }
 
@@ -0,0 +1,648 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "cd_image.h"
+#include "cd_subchannel_replacement.h"
+
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/scoped_guard.h"
+
+#include "fmt/format.h"
+#include "zstd.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+Log_SetChannel(CDImageZCD);
+
+// ZCD is a seekable zstd disc image. Sectors are stored raw, in groups (frames) which are compressed independently, so
+// any sector can be read by decompressing only its frame. The file is laid out as:
+//
+//   ZCDHeader
+//   ZCDTrack[num_tracks]
+//   ZCDIndex[num_indices]
+//   u8 dictionary[dictionary_size]
+//   u64 frame_offsets[num_frames + 1]  (absolute, the last one is the end of the final frame)
+//   frame data
+//
+// Only indices with data in the source are stored, implicit pregaps stay implicit. Each frame decompresses to the raw
+// sector data of its sectors, followed by their subchannel Q when ZCD_FLAG_SUBCHANNEL_Q is set.
+
+namespace {
+#pragma pack(push, 4)
+struct ZCDHeader
+{
+  u32 magic;
+  u32 version;
+  u32 flags;
+  u32 sectors_per_frame;
+  u32 lba_count;
+  u32 num_sectors;
+  u32 num_frames;
+  u32 num_tracks;
+  u32 num_indices;
+  u32 dictionary_size;
+};
+
+struct ZCDTrack
+{
+  u32 track_number;
+  u32 start_lba;
+  u32 first_index;
+  u32 length;
+  u8 mode;
+  u8 control;
+  u8 reserved[2];
+};
+
+struct ZCDIndex
+{
+  u32 start_lba_on_disc;
+  u32 start_lba_in_track;
+  u32 length;
+  u32 first_sector;
+  u8 track_number;
+  u8 index_number;
+  u8 mode;
+  u8 control;
+  u8 is_pregap;
+  u8 has_data;
+  u8 reserved[2];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(ZCDHeader) == 40 && sizeof(ZCDTrack) == 20 && sizeof(ZCDIndex) == 24);
+} // namespace
+
+static constexpr u32 ZCD_MAGIC = 0x4944435A; // ZCDI
+static constexpr u32 ZCD_VERSION = 1;
+static constexpr u32 ZCD_FLAG_SUBCHANNEL_Q = (1u << 0);
+static constexpr u32 ZCD_MAX_SECTORS_PER_FRAME = 1024;
+static constexpr u32 ZCD_MAX_DICTIONARY_SIZE = 16 * 1024 * 1024;
+
+/// Number of frames read from the source and compressed at once when writing an image.
+static constexpr u32 ZCD_WRITE_BATCH_FRAMES = 256;
+
+namespace {
+class CDImageZCD : public CDImage
+{
+public:
+  CDImageZCD();
+  ~CDImageZCD() override;
+
+  bool Open(const char* filename, Error* error);
+
+  bool ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index) override;
+  bool HasNonStandardSubchannel() const override;
+
+protected:
+  bool ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index) override;
+  void ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count) override;
+
+private:
+  static constexpr u32 INVALID_FRAME = static_cast<u32>(-1);
+
+  u32 GetFrameSectorCount(u32 frame) const;
+  bool LoadFrame(u32 frame);
+
+  FileSystem::ManagedCFilePtr m_fp;
+  ZSTD_DCtx* m_dctx = nullptr;
+  ZSTD_DDict* m_ddict = nullptr;
+
+  std::vector<u64> m_frame_offsets;
+  std::vector<u8> m_compressed_buffer;
+  std::vector<u8> m_frame_buffer;
+  u32 m_sectors_per_frame = 0;
+  u32 m_num_sectors = 0;
+  u32 m_current_frame = INVALID_FRAME;
+  bool m_has_subchannel_q = false;
+
+  CDSubChannelReplacement m_sbi;
+};
+} // namespace
+
+static u32 GetZCDStoredSectorSize(bool has_subchannel_q)
+{
+  return CDImage::RAW_SECTOR_SIZE + (has_subchannel_q ? CDImage::SUBCHANNEL_BYTES_PER_FRAME : 0);
+}
+
+CDImageZCD::CDImageZCD() = default;
+
+CDImageZCD::~CDImageZCD()
+{
+  if (m_ddict)
+    ZSTD_freeDDict(m_ddict);
+  if (m_dctx)
+    ZSTD_freeDCtx(m_dctx);
+}
+
+bool CDImageZCD::Open(const char* filename, Error* error)
+{
+  m_fp = FileSystem::OpenManagedSharedCFile(filename, "rb", FileSystem::FileShareMode::DenyWrite, error);
+  if (!m_fp)
+  {
+    Log_ErrorPrintf("Failed to open ZCD '%s': errno %d", filename, errno);
+    return false;
+  }
+
+  const s64 file_size = FileSystem::FSize64(m_fp.get());
+  ZCDHeader header;
+  if (std::fread(&header, sizeof(header), 1, m_fp.get()) != 1 || header.magic != ZCD_MAGIC)
+  {
+    Log_ErrorPrintf("'%s' is not a ZCD image", filename);
+    Error::SetString(error, "Not a ZCD image.");
+    return false;
+  }
+  else if (header.version != ZCD_VERSION)
+  {
+    Log_ErrorPrintf("ZCD '%s' has unsupported version %u", filename, header.version);
+    Error::SetString(error, fmt::format("Unsupported ZCD version {}.", header.version));
+    return false;
+  }
+
+  if (header.sectors_per_frame == 0 || header.sectors_per_frame > ZCD_MAX_SECTORS_PER_FRAME ||
+      header.num_frames != ((header.num_sectors + header.sectors_per_frame - 1) / header.sectors_per_frame) ||
+      header.num_tracks == 0 || header.num_indices == 0 || header.dictionary_size > ZCD_MAX_DICTIONARY_SIZE)
+  {
+    Log_ErrorPrintf("ZCD '%s' has an invalid header", filename);
+    Error::SetString(error, "Invalid ZCD header.");
+    return false;
+  }
+
+  std::vector<ZCDTrack> tracks(header.num_tracks);
+  std::vector<ZCDIndex> indices(header.num_indices);
+  std::vector<u8> dictionary(header.dictionary_size);
+  m_frame_offsets.resize(header.num_frames + 1);
+  if (std::fread(tracks.data(), sizeof(ZCDTrack) * tracks.size(), 1, m_fp.get()) != 1 ||
+      std::fread(indices.data(), sizeof(ZCDIndex) * indices.size(), 1, m_fp.get()) != 1 ||
+      (!dictionary.empty() && std::fread(dictionary.data(), dictionary.size(), 1, m_fp.get()) != 1) ||
+      std::fread(m_frame_offsets.data(), sizeof(u64) * m_frame_offsets.size(), 1, m_fp.get()) != 1)
+  {
+    Log_ErrorPrintf("Failed to read ZCD table of contents from '%s'", filename);
+    Error::SetString(error, "Failed to read table of contents.");
+    return false;
+  }
+
+  m_sectors_per_frame = header.sectors_per_frame;
+  m_num_sectors = header.num_sectors;
+  m_has_subchannel_q = ((header.flags & ZCD_FLAG_SUBCHANNEL_Q) != 0);
+
+  // Checked once here so reads don't need to, every frame has to fit in the buffers.
+  const size_t frame_size = static_cast<size_t>(m_sectors_per_frame) * GetZCDStoredSectorSize(m_has_subchannel_q);
+  const size_t max_compressed_size = ZSTD_compressBound(frame_size);
+  for (u32 i = 0; i < header.num_frames; i++)
+  {
+    if (m_frame_offsets[i] > m_frame_offsets[i + 1] || (m_frame_offsets[i + 1] - m_frame_offsets[i]) == 0 ||
+        (m_frame_offsets[i + 1] - m_frame_offsets[i]) > max_compressed_size)
+    {
+      Log_ErrorPrintf("ZCD '%s' has an invalid size for frame %u", filename, i);
+      Error::SetString(error, fmt::format("Invalid size for frame {}.", i));
+      return false;
+    }
+  }
+  if (file_size >= 0 && m_frame_offsets.back() > static_cast<u64>(file_size))
+  {
+    Log_ErrorPrintf("ZCD '%s' is truncated", filename);
+    Error::SetString(error, "File is truncated.");
+    return false;
+  }
+
+  m_compressed_buffer.resize(max_compressed_size);
+  m_frame_buffer.resize(frame_size);
+
+  m_dctx = ZSTD_createDCtx();
+  if (!m_dctx)
+  {
+    Error::SetString(error, "Failed to create decompression context.");
+    return false;
+  }
+  if (!dictionary.empty())
+  {
+    m_ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (!m_ddict)
+    {
+      Log_ErrorPrintf("ZCD '%s' has an invalid dictionary", filename);
+      Error::SetString(error, "Invalid dictionary.");
+      return false;
+    }
+  }
+
+  for (const ZCDIndex& zi : indices)
+  {
+    if (zi.has_data && (zi.first_sector > m_num_sectors || zi.length > (m_num_sectors - zi.first_sector)))
+    {
+      Log_ErrorPrintf("ZCD '%s' has an index outside of the stored sectors", filename);
+      Error::SetString(error, "Index is outside of the stored sectors.");
+      return false;
+    }
+
+    Index index = {};
+    index.file_index = 0;
+    index.file_offset = zi.has_data ? zi.first_sector : 0;
+    index.file_sector_size = zi.has_data ? RAW_SECTOR_SIZE : 0;
+    index.start_lba_on_disc = zi.start_lba_on_disc;
+    index.track_number = zi.track_number;
+    index.index_number = zi.index_number;
+    index.start_lba_in_track = zi.start_lba_in_track;
+    index.length = zi.length;
+    index.mode = static_cast<TrackMode>(zi.mode);
+    index.submode = SubchannelMode::None;
+    index.control.bits = zi.control;
+    index.is_pregap = (zi.is_pregap != 0);
+    m_indices.push_back(index);
+  }
+
+  for (const ZCDTrack& zt : tracks)
+  {
+    if (zt.first_index >= header.num_indices)
+    {
+      Log_ErrorPrintf("ZCD '%s' has a track with an invalid index", filename);
+      Error::SetString(error, "Track has an invalid index.");
+      return false;
+    }
+
+    m_tracks.push_back(Track{zt.track_number, zt.start_lba, zt.first_index, zt.length, static_cast<TrackMode>(zt.mode),
+                             SubchannelMode::None, SubChannelQ::Control(zt.control)});
+  }
+
+  m_filename = filename;
+  m_lba_count = header.lba_count;
+  AddLeadOutIndex();
+
+  m_sbi.LoadSBIFromImagePath(filename);
+
+  return Seek(1, Position{0, 0, 0});
+}
+
+u32 CDImageZCD::GetFrameSectorCount(u32 frame) const
+{
+  return std::min(m_sectors_per_frame, m_num_sectors - (frame * m_sectors_per_frame));
+}
+
+bool CDImageZCD::LoadFrame(u32 frame)
+{
+  if (m_current_frame == frame)
+    return true;
+
+  const u64 offset = m_frame_offsets[frame];
+  const size_t compressed_size = static_cast<size_t>(m_frame_offsets[frame + 1] - offset);
+  if (FileSystem::FSeek64(m_fp.get(), static_cast<s64>(offset), SEEK_SET) != 0 ||
+      std::fread(m_compressed_buffer.data(), compressed_size, 1, m_fp.get()) != 1)
+  {
+    Log_ErrorPrintf("Failed to read ZCD frame %u", frame);
+    m_current_frame = INVALID_FRAME;
+    return false;
+  }
+
+  const size_t expected_size =
+    static_cast<size_t>(GetFrameSectorCount(frame)) * GetZCDStoredSectorSize(m_has_subchannel_q);
+  const size_t result =
+    m_ddict ? ZSTD_decompress_usingDDict(m_dctx, m_frame_buffer.data(), m_frame_buffer.size(),
+                                         m_compressed_buffer.data(), compressed_size, m_ddict) :
+              ZSTD_decompressDCtx(m_dctx, m_frame_buffer.data(), m_frame_buffer.size(), m_compressed_buffer.data(),
+                                  compressed_size);
+  if (ZSTD_isError(result) || result != expected_size)
+  {
+    Log_ErrorPrintf("Failed to decompress ZCD frame %u: %s", frame,
+                    ZSTD_isError(result) ? ZSTD_getErrorName(result) : "Size mismatch");
+    m_current_frame = INVALID_FRAME;
+    return false;
+  }
+
+  m_current_frame = frame;
+  return true;
+}
+
+bool CDImageZCD::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_in_index)
+{
+  const u32 sector = static_cast<u32>(index.file_offset) + lba_in_index;
+  if (sector >= m_num_sectors)
+    return false;
+
+  const u32 frame = sector / m_sectors_per_frame;
+  if (!LoadFrame(frame))
+    return false;
+
+  const u32 sector_in_frame = sector % m_sectors_per_frame;
+  std::memcpy(buffer, &m_frame_buffer[sector_in_frame * RAW_SECTOR_SIZE], RAW_SECTOR_SIZE);
+  return true;
+}
+
+bool CDImageZCD::ReadSubChannelQ(SubChannelQ* subq, const Index& index, LBA lba_in_index)
+{
+  if (m_sbi.GetReplacementSubChannelQ(index.start_lba_on_disc + lba_in_index, subq))
+    return true;
+
+  if (!m_has_subchannel_q || index.file_sector_size == 0)
+    return CDImage::ReadSubChannelQ(subq, index, lba_in_index);
+
+  const u32 sector = static_cast<u32>(index.file_offset) + lba_in_index;
+  if (sector >= m_num_sectors)
+    return false;
+
+  const u32 frame = sector / m_sectors_per_frame;
+  if (!LoadFrame(frame))
+    return false;
+
+  // Q data follows all of the frame's sectors.
+  const u32 sector_in_frame = sector % m_sectors_per_frame;
+  const u32 q_offset = (GetFrameSectorCount(frame) * RAW_SECTOR_SIZE) + (sector_in_frame * SUBCHANNEL_BYTES_PER_FRAME);
+  std::memcpy(subq->data.data(), &m_frame_buffer[q_offset], SUBCHANNEL_BYTES_PER_FRAME);
+  return true;
+}
+
+bool CDImageZCD::HasNonStandardSubchannel() const
+{
+  return (m_has_subchannel_q || m_sbi.GetReplacementSectorCount() > 0);
+}
+
+void CDImageZCD::ReadaheadIndex(const Index& index, LBA lba_in_index, u32 sector_count)
+{
+  const u32 first_sector = static_cast<u32>(index.file_offset) + lba_in_index;
+  if (first_sector >= m_num_sectors)
+    return;
+
+  const u32 last_sector = std::min(first_sector + sector_count, m_num_sectors) - 1;
+  const u32 first_frame = first_sector / m_sectors_per_frame;
+  const u32 last_frame = last_sector / m_sectors_per_frame;
+  const u64 offset = m_frame_offsets[first_frame];
+  FileSystem::FReadahead64(m_fp.get(), static_cast<s64>(offset),
+                           static_cast<s64>(m_frame_offsets[last_frame + 1] - offset));
+}
+
+std::unique_ptr<CDImage> CDImage::OpenZCDImage(const char* filename, Error* error)
+{
+  std::unique_ptr<CDImageZCD> image = std::make_unique<CDImageZCD>();
+  if (!image->Open(filename, error))
+    return {};
+
+  return image;
+}
+
+bool CDImage::WriteZCDImage(CDImage* image, const char* path, u32 sectors_per_frame, int compression_level,
+                            const std::vector<u8>& dictionary, ProgressCallback* progress, Error* error)
+{
+  if (sectors_per_frame == 0 || sectors_per_frame > ZCD_MAX_SECTORS_PER_FRAME)
+  {
+    Error::SetString(error, fmt::format("Sectors per frame must be between 1 and {}.", ZCD_MAX_SECTORS_PER_FRAME));
+    return false;
+  }
+  else if (dictionary.size() > ZCD_MAX_DICTIONARY_SIZE)
+  {
+    Error::SetString(error, fmt::format("Dictionary is larger than {} bytes.", ZCD_MAX_DICTIONARY_SIZE));
+    return false;
+  }
+
+  // The lead-out is synthesized when the image is opened, so it isn't stored.
+  std::vector<ZCDIndex> indices;
+  std::vector<const Index*> stored_indices;
+  u32 num_sectors = 0;
+  for (const Index& index : image->GetIndices())
+  {
+    if (index.track_number == LEAD_OUT_TRACK_NUMBER)
+      continue;
+
+    ZCDIndex& zi = indices.emplace_back();
+    std::memset(&zi, 0, sizeof(zi));
+    zi.start_lba_on_disc = index.start_lba_on_disc;
+    zi.start_lba_in_track = index.start_lba_in_track;
+    zi.length = index.length;
+    zi.track_number = static_cast<u8>(index.track_number);
+    zi.index_number = static_cast<u8>(index.index_number);
+    zi.mode = static_cast<u8>(index.mode);
+    zi.control = index.control.bits;
+    zi.is_pregap = index.is_pregap;
+    if (index.file_sector_size > 0)
+    {
+      zi.has_data = 1;
+      zi.first_sector = num_sectors;
+      num_sectors += index.length;
+      stored_indices.push_back(&index);
+    }
+  }
+
+  std::vector<ZCDTrack> tracks;
+  for (const Track& track : image->GetTracks())
+  {
+    ZCDTrack& zt = tracks.emplace_back();
+    std::memset(&zt, 0, sizeof(zt));
+    zt.track_number = track.track_number;
+    zt.start_lba = track.start_lba;
+    zt.first_index = track.first_index;
+    zt.length = track.length;
+    zt.mode = static_cast<u8>(track.mode);
+    zt.control = track.control.bits;
+  }
+
+  if (indices.empty() || tracks.empty() || num_sectors == 0)
+  {
+    Error::SetString(error, "Image contains no sectors.");
+    return false;
+  }
+
+  const bool has_subchannel_q = image->HasNonStandardSubchannel();
+  const u32 stored_sector_size = GetZCDStoredSectorSize(has_subchannel_q);
+  const u32 num_frames = (num_sectors + sectors_per_frame - 1) / sectors_per_frame;
+
+  ZCDHeader header = {};
+  header.magic = ZCD_MAGIC;
+  header.version = ZCD_VERSION;
+  header.flags = has_subchannel_q ? ZCD_FLAG_SUBCHANNEL_Q : 0;
+  header.sectors_per_frame = sectors_per_frame;
+  header.lba_count = image->GetLBACount();
+  header.num_sectors = num_sectors;
+  header.num_frames = num_frames;
+  header.num_tracks = static_cast<u32>(tracks.size());
+  header.num_indices = static_cast<u32>(indices.size());
+  header.dictionary_size = static_cast<u32>(dictionary.size());
+
+  auto fp = FileSystem::OpenManagedCFile(path, "wb", error);
+  if (!fp)
+    return false;
+
+  // Don't leave a half-written image behind, it would fail to open anyway.
+  ScopedGuard delete_output([&fp, path]() {
+    fp.reset();
+    FileSystem::DeleteFile(path);
+  });
+
+  // Frame sizes aren't known until they're compressed, so the frame table gets written last.
+  std::vector<u64> frame_offsets;
+  frame_offsets.reserve(num_frames + 1);
+  const u64 frame_table_offset = sizeof(ZCDHeader) + (sizeof(ZCDTrack) * tracks.size()) +
+                                 (sizeof(ZCDIndex) * indices.size()) + dictionary.size();
+  u64 offset = frame_table_offset + (sizeof(u64) * (num_frames + 1));
+  if (std::fwrite(&header, sizeof(header), 1, fp.get()) != 1 ||
+      std::fwrite(tracks.data(), sizeof(ZCDTrack) * tracks.size(), 1, fp.get()) != 1 ||
+      std::fwrite(indices.data(), sizeof(ZCDIndex) * indices.size(), 1, fp.get()) != 1 ||
+      (!dictionary.empty() && std::fwrite(dictionary.data(), dictionary.size(), 1, fp.get()) != 1) ||
+      FileSystem::FSeek64(fp.get(), static_cast<s64>(offset), SEEK_SET) != 0)
+  {
+    Error::SetString(error, fmt::format("Failed to write header to '{}'.", path));
+    return false;
+  }
+
+  // Digesting the dictionary is the slow part, so it's done once and shared by all of the workers.
+  ZSTD_CDict* cdict = nullptr;
+  if (!dictionary.empty())
+  {
+    cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), compression_level);
+    if (!cdict)
+    {
+      Error::SetString(error, "Failed to load dictionary.");
+      return false;
+    }
+  }
+  ScopedGuard free_cdict([cdict]() { ZSTD_freeCDict(cdict); });
+
+  struct CompressedFrame
+  {
+    std::vector<u8> data;
+    size_t size;
+  };
+
+  const size_t frame_size = static_cast<size_t>(sectors_per_frame) * stored_sector_size;
+  const u32 num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<u8> batch_data;
+  std::vector<CompressedFrame> batch_frames(std::min(num_frames, ZCD_WRITE_BATCH_FRAMES));
+  for (CompressedFrame& cf : batch_frames)
+    cf.data.resize(ZSTD_compressBound(frame_size));
+
+  progress->SetStatusText(fmt::format("Compressing {}...", FileSystem::GetDisplayNameFromPath(path)).c_str());
+  progress->SetProgressRange(num_frames);
+  progress->SetProgressValue(0);
+
+  u32 read_index = 0;
+  u32 read_lba = 0;
+  for (u32 batch_start = 0; batch_start < num_frames; batch_start += ZCD_WRITE_BATCH_FRAMES)
+  {
+    if (progress->IsCancelled())
+    {
+      Error::SetString(error, "Cancelled.");
+      return false;
+    }
+
+    // The source image can only be read from one thread, so the batch is read up front.
+    const u32 batch_count = std::min(num_frames - batch_start, ZCD_WRITE_BATCH_FRAMES);
+    const u32 batch_first_sector = batch_start * sectors_per_frame;
+    const u32 batch_sectors = std::min(batch_count * sectors_per_frame, num_sectors - batch_first_sector);
+    batch_data.resize(static_cast<size_t>(batch_count) * frame_size);
+    for (u32 i = 0; i < batch_sectors; i++)
+    {
+      while (read_lba == stored_indices[read_index]->length)
+      {
+        read_index++;
+        read_lba = 0;
+      }
+
+      const Index& index = *stored_indices[read_index];
+      const u32 frame_in_batch = i / sectors_per_frame;
+      const u32 sector_in_frame = i % sectors_per_frame;
+      const u32 frame_sectors =
+        std::min(sectors_per_frame, num_sectors - (batch_first_sector + frame_in_batch * sectors_per_frame));
+      u8* frame_ptr = &batch_data[frame_in_batch * frame_size];
+      if (!image->ReadSectorFromIndex(frame_ptr + sector_in_frame * RAW_SECTOR_SIZE, index, read_lba))
+      {
+        Error::SetString(error, fmt::format("Failed to read LBA {}.", index.start_lba_on_disc + read_lba));
+        return false;
+      }
+
+      if (has_subchannel_q)
+      {
+        SubChannelQ subq;
+        if (!image->ReadSubChannelQ(&subq, index, read_lba))
+        {
+          Error::SetString(error,
+                           fmt::format("Failed to read subchannel Q of LBA {}.", index.start_lba_on_disc + read_lba));
+          return false;
+        }
+
+        std::memcpy(frame_ptr + (frame_sectors * RAW_SECTOR_SIZE) + (sector_in_frame * SUBCHANNEL_BYTES_PER_FRAME),
+                    subq.data.data(), SUBCHANNEL_BYTES_PER_FRAME);
+      }
+
+      read_lba++;
+    }
+
+    std::atomic<u32> next_frame{0};
+    std::atomic_bool compress_failed{false};
+    auto worker = [&]() {
+      ZSTD_CCtx* cctx = ZSTD_createCCtx();
+      if (!cctx)
+      {
+        compress_failed.store(true);
+        return;
+      }
+
+      for (;;)
+      {
+        const u32 frame_in_batch = next_frame.fetch_add(1);
+        if (frame_in_batch >= batch_count)
+          break;
+
+        const u32 first_sector = batch_first_sector + (frame_in_batch * sectors_per_frame);
+        const size_t size =
+          static_cast<size_t>(std::min(sectors_per_frame, num_sectors - first_sector)) * stored_sector_size;
+        const u8* src = &batch_data[frame_in_batch * frame_size];
+        CompressedFrame& dst = batch_frames[frame_in_batch];
+        dst.size = cdict ? ZSTD_compress_usingCDict(cctx, dst.data.data(), dst.data.size(), src, size, cdict) :
+                           ZSTD_compressCCtx(cctx, dst.data.data(), dst.data.size(), src, size, compression_level);
+        if (ZSTD_isError(dst.size))
+        {
+          Log_ErrorPrintf("Failed to compress frame %u: %s", batch_start + frame_in_batch,
+                          ZSTD_getErrorName(dst.size));
+          compress_failed.store(true);
+        }
+      }
+
+      ZSTD_freeCCtx(cctx);
+    };
+
+    std::vector<std::thread> threads;
+    for (u32 i = 1; i < std::min(num_threads, batch_count); i++)
+      threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+      thread.join();
+
+    if (compress_failed.load())
+    {
+      Error::SetString(error, "Failed to compress sectors.");
+      return false;
+    }
+
+    for (u32 i = 0; i < batch_count; i++)
+    {
+      const CompressedFrame& cf = batch_frames[i];
+      if (std::fwrite(cf.data.data(), cf.size, 1, fp.get()) != 1)
+      {
+        Error::SetString(error, fmt::format("Failed to write frame data to '{}'.", path));
+        return false;
+      }
+
+      frame_offsets.push_back(offset);
+      offset += cf.size;
+    }
+
+    progress->SetProgressValue(batch_start + batch_count);
+  }
+
+  frame_offsets.push_back(offset);
+  if (FileSystem::FSeek64(fp.get(), static_cast<s64>(frame_table_offset), SEEK_SET) != 0 ||
+      std::fwrite(frame_offsets.data(), sizeof(u64) * frame_offsets.size(), 1, fp.get()) != 1 ||
+      std::fflush(fp.get()) != 0)
+  {
+    Error::SetString(error, fmt::format("Failed to write frame table to '{}'.", path));
+    return false;
+  }
+
+  Log_InfoFmt("Wrote {} sectors in {} frames to '{}', {} bytes", num_sectors, num_frames, path, offset);
+  delete_output.Cancel();
+  return true;
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "cd_subchannel_replacement.h"
+#include "common/assert.h"
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/path.h"
@@ -80,9 +81,19 @@ bool CDSubChannelReplacement::LoadSBI(const char* path)
     subq.data[10] = Truncate8(crc);
     subq.data[11] = Truncate8(crc >> 8);
 
-    m_replacement_subq.emplace(lba, subq);
+    m_replacement_subq.push_back(ReplacementEntry{lba, subq});
   }
 
+  // Sectors listed more than once keep their first entry.
+  std::stable_sort(m_replacement_subq.begin(), m_replacement_subq.end(),
+                   [](const ReplacementEntry& lhs, const ReplacementEntry& rhs) { return lhs.lba < rhs.lba; });
+  m_replacement_subq.erase(std::unique(m_replacement_subq.begin(), m_replacement_subq.end(),
+                                       [](const ReplacementEntry& lhs, const ReplacementEntry& rhs) {
+                                         return lhs.lba == rhs.lba;
+                                       }),
+                           m_replacement_subq.end());
+  UpdatePresenceBitmap();
+
   Log_InfoPrintf("Loaded %zu replacement sectors from '%s'", m_replacement_subq.size(), path);
   return true;
 }
@@ -92,13 +103,39 @@ bool CDSubChannelReplacement::LoadSBIFromImagePath(const char* image_path)
   return LoadSBI(Path::ReplaceExtension(image_path, "sbi").c_str());
 }
 
+void CDSubChannelReplacement::UpdatePresenceBitmap()
+{
+  m_presence_bitmap.clear();
+  if (m_replacement_subq.empty())
+  {
+    m_first_lba = 0;
+    m_lba_count = 0;
+    return;
+  }
+
+  m_first_lba = m_replacement_subq.front().lba;
+  m_lba_count = m_replacement_subq.back().lba - m_first_lba + 1;
+  m_presence_bitmap.resize((m_lba_count + 63) / 64);
+  for (const ReplacementEntry& entry : m_replacement_subq)
+  {
+    const u32 bit = entry.lba - m_first_lba;
+    m_presence_bitmap[bit / 64] |= (u64(1) << (bit % 64));
+  }
+}
+
 void CDSubChannelReplacement::AddReplacementSubChannelQ(u32 lba, const CDImage::SubChannelQ& subq)
 {
-  auto iter = m_replacement_subq.find(lba);
-  if (iter != m_replacement_subq.end())
-    iter->second.data = subq.data;
-  else
-    m_replacement_subq.emplace(lba, subq);
+  const auto iter =
+    std::lower_bound(m_replacement_subq.begin(), m_replacement_subq.end(), lba,
+                     [](const ReplacementEntry& entry, u32 value) { return entry.lba < value; });
+  if (iter != m_replacement_subq.end() && iter->lba == lba)
+  {
+    iter->subq.data = subq.data;
+    return;
+  }
+
+  m_replacement_subq.insert(iter, ReplacementEntry{lba, subq});
+  UpdatePresenceBitmap();
 }
 
 bool CDSubChannelReplacement::GetReplacementSubChannelQ(u8 minute_bcd, u8 second_bcd, u8 frame_bcd,
@@ -109,10 +146,14 @@ bool CDSubChannelReplacement::GetReplacementSubChannelQ(u8 minute_bcd, u8 second
 
 bool CDSubChannelReplacement::GetReplacementSubChannelQ(u32 lba, CDImage::SubChannelQ* subq) const
 {
-  const auto iter = m_replacement_subq.find(lba);
-  if (iter == m_replacement_subq.cend())
+  const u32 bit = lba - m_first_lba;
+  if (bit >= m_lba_count || (m_presence_bitmap[bit / 64] & (u64(1) << (bit % 64))) == 0)
     return false;
 
-  *subq = iter->second;
+  const auto iter =
+    std::lower_bound(m_replacement_subq.cbegin(), m_replacement_subq.cend(), lba,
+                     [](const ReplacementEntry& entry, u32 value) { return entry.lba < value; });
+  DebugAssert(iter != m_replacement_subq.cend() && iter->lba == lba);
+  *subq = iter->subq;
   return true;
 }
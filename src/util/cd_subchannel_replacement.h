@@ -6,7 +6,7 @@
 #include "common/types.h"
 #include <array>
 #include <cstdio>
-#include <unordered_map>
+#include <vector>
 
 class CDSubChannelReplacement
 {
@@ -29,7 +29,19 @@ public:
   bool GetReplacementSubChannelQ(u32 lba, CDImage::SubChannelQ* subq) const;
 
 private:
-  using ReplacementMap = std::unordered_map<u32, CDImage::SubChannelQ>;
-
-  ReplacementMap m_replacement_subq;
+  struct ReplacementEntry
+  {
+    u32 lba;
+    CDImage::SubChannelQ subq;
+  };
+
+  /// Rebuilds the presence bitmap from the sorted replacement list.
+  void UpdatePresenceBitmap();
+
+  // Sorted by LBA. Most sectors don't have a replacement, so the bitmap over the range between the first and last
+  // replaced sector lets those lookups return without searching.
+  std::vector<ReplacementEntry> m_replacement_subq;
+  std::vector<u64> m_presence_bitmap;
+  u32 m_first_lba = 0;
+  u32 m_lba_count = 0;
 };
@@ -3,6 +3,9 @@
 
 #include "cd_xa.h"
 #include "cd_image.h"
+
+#include "common/intrin.h"
+
 #include <algorithm>
 #include <array>
 
@@ -10,6 +13,72 @@ namespace CDXA {
 static constexpr std::array<s32, 4> s_xa_adpcm_filter_table_pos = {{0, 60, 115, 98}};
 static constexpr std::array<s32, 4> s_xa_adpcm_filter_table_neg = {{0, 0, -52, -55}};
 
+/// Moves the nibble (or byte) for each block in each word to the upper bits of a s16, laid out as [word][block], so
+/// that the filter only needs to shift each sample. Only the low four bits of 8-bit samples are used, same as before.
+template<bool IS_8BIT>
+static void ExpandXA_ADPCMWords(const u8* words_ptr, s16* out)
+{
+  constexpr u32 NUM_BYTES = 28 * sizeof(u32);
+
+#if defined(CPU_ARCH_SSE)
+  const __m128i low_mask = _mm_set1_epi8(static_cast<char>(0xF0));
+  const __m128i zero = _mm_setzero_si128();
+  for (u32 i = 0; i < NUM_BYTES; i += 16)
+  {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&words_ptr[i]));
+    const __m128i low = _mm_and_si128(_mm_slli_epi16(bytes, 4), low_mask);
+    if constexpr (IS_8BIT)
+    {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(zero, low));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(zero, low));
+      out += 16;
+    }
+    else
+    {
+      const __m128i high = _mm_and_si128(bytes, low_mask);
+      const __m128i nibbles0 = _mm_unpacklo_epi8(low, high);
+      const __m128i nibbles1 = _mm_unpackhi_epi8(low, high);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(zero, nibbles0));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(zero, nibbles0));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpacklo_epi8(zero, nibbles1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 24), _mm_unpackhi_epi8(zero, nibbles1));
+      out += 32;
+    }
+  }
+#elif defined(CPU_ARCH_NEON)
+  for (u32 i = 0; i < NUM_BYTES; i += 16)
+  {
+    const uint8x16_t bytes = vld1q_u8(&words_ptr[i]);
+    const uint8x16_t low = vshlq_n_u8(bytes, 4);
+    if constexpr (IS_8BIT)
+    {
+      vst1q_s16(out, vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(low), 8)));
+      vst1q_s16(out + 8, vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(low), 8)));
+      out += 16;
+    }
+    else
+    {
+      const uint8x16_t high = vandq_u8(bytes, vdupq_n_u8(0xF0));
+      const uint8x16_t nibbles0 = vzip1q_u8(low, high);
+      const uint8x16_t nibbles1 = vzip2q_u8(low, high);
+      vst1q_s16(out, vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(nibbles0), 8)));
+      vst1q_s16(out + 8, vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(nibbles0), 8)));
+      vst1q_s16(out + 16, vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(nibbles1), 8)));
+      vst1q_s16(out + 24, vreinterpretq_s16_u16(vshll_n_u8(vget_high_u8(nibbles1), 8)));
+      out += 32;
+    }
+  }
+#else
+  for (u32 i = 0; i < NUM_BYTES; i++)
+  {
+    const u8 byte = words_ptr[i];
+    *(out++) = static_cast<s16>(static_cast<u16>(byte) << 12);
+    if constexpr (!IS_8BIT)
+      *(out++) = static_cast<s16>(static_cast<u16>(byte & 0xF0) << 8);
+  }
+#endif
+}
+
 template<bool IS_STEREO, bool IS_8BIT>
 static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_samples)
 {
@@ -21,6 +90,10 @@ static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_sam
   const u8* headers_ptr = chunk_ptr + 4;
   const u8* words_ptr = chunk_ptr + 16;
 
+  // NOTE: assumes LE
+  std::array<s16, WORDS_PER_BLOCK * NUM_BLOCKS> expanded;
+  ExpandXA_ADPCMWords<IS_8BIT>(words_ptr, expanded.data());
+
   for (u32 block = 0; block < NUM_BLOCKS; block++)
   {
     const XA_ADPCMBlockHeader block_header{headers_ptr[block]};
@@ -33,27 +106,26 @@ static void DecodeXA_ADPCMChunk(const u8* chunk_ptr, s16* samples, s32* last_sam
       IS_STEREO ? &samples[(block / 2) * (WORDS_PER_BLOCK * 2) + (block % 2)] : &samples[block * WORDS_PER_BLOCK];
     constexpr u32 out_samples_increment = IS_STEREO ? 2 : 1;
 
-    for (u32 word = 0; word < 28; word++)
-    {
-      // NOTE: assumes LE
-      u32 word_data;
-      std::memcpy(&word_data, &words_ptr[word * sizeof(u32)], sizeof(word_data));
+    // the filter is serial, so keep the previous values in registers
+    s32* prev = IS_STEREO ? &last_samples[(block & 1) * 2] : last_samples;
+    s32 prev0 = prev[0];
+    s32 prev1 = prev[1];
 
-      // extract nibble from block
-      const u32 nibble = IS_8BIT ? ((word_data >> (block * 8)) & 0xFF) : ((word_data >> (block * 4)) & 0x0F);
-      const s16 sample = static_cast<s16>(Truncate16(nibble << 12)) >> shift;
+    for (u32 word = 0; word < WORDS_PER_BLOCK; word++)
+    {
+      const s16 sample = expanded[word * NUM_BLOCKS + block] >> shift;
 
       // mix in previous values
-      s32* prev = IS_STEREO ? &last_samples[(block & 1) * 2] : last_samples;
-      const s32 interp_sample = s32(sample) + ((prev[0] * filter_pos) + (prev[1] * filter_neg) + 32) / 64;
-
-      // update previous values
-      prev[1] = prev[0];
-      prev[0] = interp_sample;
+      const s32 interp_sample = s32(sample) + ((prev0 * filter_pos) + (prev1 * filter_neg) + 32) / 64;
+      prev1 = prev0;
+      prev0 = interp_sample;
 
       *out_samples_ptr = static_cast<s16>(std::clamp<s32>(interp_sample, -0x8000, 0x7FFF));
       out_samples_ptr += out_samples_increment;
     }
+
+    prev[0] = prev0;
+    prev[1] = prev1;
   }
 }
 
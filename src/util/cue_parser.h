@@ -34,11 +34,18 @@ enum class TrackFlag : u32
   SerialCopyManagement = (1 << 3),
 };
 
+enum class FileType : u8
+{
+  Binary,
+  Wave, ///< Only FLAC-compressed audio is supported.
+};
+
 struct Track
 {
   u32 number;
   u32 flags;
   std::string file;
+  FileType file_type;
   std::vector<std::pair<u32, MSF>> indices;
   TrackMode mode;
   MSF start;
@@ -83,6 +90,7 @@ private:
 
   std::vector<Track> m_tracks;
   std::optional<std::string> m_current_file;
+  FileType m_current_file_type = FileType::Binary;
   std::optional<Track> m_current_track;
 };
 
@@ -179,6 +179,7 @@ void D3D11Device::SetFeatures()
   m_features.gpu_timing = true;
   m_features.shader_cache = true;
   m_features.pipeline_cache = false;
+  m_features.threaded_pipeline_creation = false;
 }
 
 bool D3D11Device::CreateSwapChain()
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "d3d11_stream_buffer.h"
+#include "gpu_device.h"
 
 #include "common/align.h"
 #include "common/assert.h"
@@ -78,6 +79,8 @@ D3D11StreamBuffer::MappingResult D3D11StreamBuffer::Map(ID3D11DeviceContext1* co
   if ((m_position + min_size) >= m_size || !m_use_map_no_overwrite)
   {
     // wrap around
+    if (m_use_map_no_overwrite)
+      GPUDevice::s_stats.num_stream_buffer_wraps++;
     m_position = 0;
   }
 
@@ -1183,6 +1183,9 @@ void D3D12Device::SetFeatures()
   m_features.shader_cache = true;
   m_features.pipeline_cache = true;
 
+  // ID3D12Device and ID3D12PipelineLibrary are free-threaded, and CreatePipeline() only reads other device state.
+  m_features.threaded_pipeline_creation = true;
+
   BOOL allow_tearing_supported = false;
   HRESULT hr = m_dxgi_factory->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allow_tearing_supported,
                                                    sizeof(allow_tearing_supported));
@@ -0,0 +1,302 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "gpu_command_list.h"
+
+#include "common/align.h"
+#include "common/assert.h"
+
+#include <cstring>
+
+GPUCommandList::GPUCommandList()
+{
+  Clear();
+}
+
+GPUCommandList::~GPUCommandList() = default;
+
+void GPUCommandList::Clear()
+{
+  m_commands.clear();
+  m_data.clear();
+  std::memset(&m_state, 0, sizeof(m_state));
+  m_map_offset = 0;
+  m_draw_count = 0;
+  m_filtered_count = 0;
+}
+
+GPUCommandList::Command& GPUCommandList::AddCommand(CommandType type)
+{
+  Command& cmd = m_commands.emplace_back();
+  cmd.type = type;
+  cmd.slot = 0;
+  return cmd;
+}
+
+u32 GPUCommandList::AllocateData(u32 size)
+{
+  // Vertices are written through their struct types, so keep everything aligned to the largest of them.
+  const u32 offset = Common::AlignUpPow2(static_cast<u32>(m_data.size()), 16);
+  m_data.resize(offset + size);
+  return offset;
+}
+
+void GPUCommandList::SetFramebuffer(GPUFramebuffer* fb)
+{
+  if (m_state.has_framebuffer && m_state.framebuffer == fb)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  m_state.framebuffer = fb;
+  m_state.has_framebuffer = true;
+
+  // Backends unbind textures which are about to be rendered to, so binding them again afterwards isn't redundant.
+  if (fb)
+  {
+    for (u32 i = 0; i < GPUDevice::MAX_TEXTURE_SAMPLERS; i++)
+    {
+      if (m_state.textures[i] && (m_state.textures[i] == fb->GetRT() || m_state.textures[i] == fb->GetDS()))
+        m_state.texture_mask &= ~(1u << i);
+    }
+  }
+
+  AddCommand(CommandType::SetFramebuffer).framebuffer = fb;
+}
+
+void GPUCommandList::SetPipeline(GPUPipeline* pipeline)
+{
+  if (m_state.has_pipeline && m_state.pipeline == pipeline)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  m_state.pipeline = pipeline;
+  m_state.has_pipeline = true;
+  AddCommand(CommandType::SetPipeline).pipeline = pipeline;
+}
+
+void GPUCommandList::SetTextureSampler(u32 slot, GPUTexture* texture, GPUSampler* sampler)
+{
+  DebugAssert(slot < GPUDevice::MAX_TEXTURE_SAMPLERS);
+  if ((m_state.texture_mask & (1u << slot)) && m_state.textures[slot] == texture && m_state.samplers[slot] == sampler)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  m_state.textures[slot] = texture;
+  m_state.samplers[slot] = sampler;
+  m_state.texture_mask |= (1u << slot);
+
+  Command& cmd = AddCommand(CommandType::SetTextureSampler);
+  cmd.slot = static_cast<u8>(slot);
+  cmd.texture_sampler.texture = texture;
+  cmd.texture_sampler.sampler = sampler;
+}
+
+void GPUCommandList::SetTextureBuffer(u32 slot, GPUTextureBuffer* buffer)
+{
+  // Backends only have the one texture buffer binding, which shares the sampler slot.
+  if (m_state.has_texture_buffer && m_state.texture_buffer == buffer)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  m_state.texture_buffer = buffer;
+  m_state.has_texture_buffer = true;
+
+  Command& cmd = AddCommand(CommandType::SetTextureBuffer);
+  cmd.slot = static_cast<u8>(slot);
+  cmd.texture_buffer = buffer;
+}
+
+void GPUCommandList::SetViewport(s32 x, s32 y, s32 width, s32 height)
+{
+  const Rect rect = {x, y, width, height};
+  if (m_state.has_viewport && m_state.viewport == rect)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  m_state.viewport = rect;
+  m_state.has_viewport = true;
+  AddCommand(CommandType::SetViewport).rect = rect;
+}
+
+void GPUCommandList::SetScissor(s32 x, s32 y, s32 width, s32 height)
+{
+  const Rect rect = {x, y, width, height};
+  if (m_state.has_scissor && m_state.scissor == rect)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  m_state.scissor = rect;
+  m_state.has_scissor = true;
+  AddCommand(CommandType::SetScissor).rect = rect;
+}
+
+void GPUCommandList::SetViewportAndScissor(s32 x, s32 y, s32 width, s32 height)
+{
+  SetViewport(x, y, width, height);
+  SetScissor(x, y, width, height);
+}
+
+void GPUCommandList::PushUniformBuffer(const void* data, u32 data_size)
+{
+  // Uniforms are small, and most batches push the same block as the last, so comparing is cheaper than replaying.
+  if (m_state.has_uniforms && m_state.uniform_size == data_size &&
+      std::memcmp(m_data.data() + m_state.uniform_offset, data, data_size) == 0)
+  {
+    m_filtered_count++;
+    return;
+  }
+
+  const u32 offset = AllocateData(data_size);
+  std::memcpy(m_data.data() + offset, data, data_size);
+  m_state.uniform_offset = offset;
+  m_state.uniform_size = data_size;
+  m_state.has_uniforms = true;
+
+  Command& cmd = AddCommand(CommandType::PushUniformBuffer);
+  cmd.data.offset = offset;
+  cmd.data.size = data_size;
+  cmd.data.count = 1;
+}
+
+void* GPUCommandList::MapVertexBuffer(u32 vertex_size, u32 vertex_count, u32* map_base_vertex)
+{
+  m_map_offset = AllocateData(vertex_size * vertex_count);
+  *map_base_vertex = 0;
+  return m_data.data() + m_map_offset;
+}
+
+void GPUCommandList::UnmapVertexBuffer(u32 vertex_size, u32 vertex_count)
+{
+  const u32 size = vertex_size * vertex_count;
+  DebugAssert((m_map_offset + size) <= m_data.size());
+  m_data.resize(m_map_offset + size);
+
+  Command& cmd = AddCommand(CommandType::UploadVertices);
+  cmd.data.offset = m_map_offset;
+  cmd.data.size = vertex_size;
+  cmd.data.count = vertex_count;
+}
+
+void GPUCommandList::UploadVertexBuffer(const void* vertices, u32 vertex_size, u32 vertex_count, u32* base_vertex)
+{
+  void* map = MapVertexBuffer(vertex_size, vertex_count, base_vertex);
+  std::memcpy(map, vertices, vertex_size * vertex_count);
+  UnmapVertexBuffer(vertex_size, vertex_count);
+}
+
+GPUDevice::DrawIndex* GPUCommandList::MapIndexBuffer(u32 index_count, u32* map_base_index)
+{
+  m_map_offset = AllocateData(index_count * sizeof(GPUDevice::DrawIndex));
+  *map_base_index = 0;
+  return reinterpret_cast<GPUDevice::DrawIndex*>(m_data.data() + m_map_offset);
+}
+
+void GPUCommandList::UnmapIndexBuffer(u32 used_count)
+{
+  const u32 size = used_count * sizeof(GPUDevice::DrawIndex);
+  DebugAssert((m_map_offset + size) <= m_data.size());
+  m_data.resize(m_map_offset + size);
+
+  Command& cmd = AddCommand(CommandType::UploadIndices);
+  cmd.data.offset = m_map_offset;
+  cmd.data.size = sizeof(GPUDevice::DrawIndex);
+  cmd.data.count = used_count;
+}
+
+void GPUCommandList::UploadIndexBuffer(const GPUDevice::DrawIndex* indices, u32 index_count, u32* base_index)
+{
+  GPUDevice::DrawIndex* map = MapIndexBuffer(index_count, base_index);
+  std::memcpy(map, indices, index_count * sizeof(GPUDevice::DrawIndex));
+  UnmapIndexBuffer(index_count);
+}
+
+void GPUCommandList::Draw(u32 vertex_count, u32 base_vertex)
+{
+  Command& cmd = AddCommand(CommandType::Draw);
+  cmd.draw.count = vertex_count;
+  cmd.draw.base_index = 0;
+  cmd.draw.base_vertex = base_vertex;
+  m_draw_count++;
+}
+
+void GPUCommandList::DrawIndexed(u32 index_count, u32 base_index, u32 base_vertex)
+{
+  Command& cmd = AddCommand(CommandType::DrawIndexed);
+  cmd.draw.count = index_count;
+  cmd.draw.base_index = base_index;
+  cmd.draw.base_vertex = base_vertex;
+  m_draw_count++;
+}
+
+void GPUCommandList::Replay(GPUDevice* device) const
+{
+  // Where the most recent uploads landed in the device's stream buffers.
+  u32 device_base_vertex = 0;
+  u32 device_base_index = 0;
+
+  for (const Command& cmd : m_commands)
+  {
+    switch (cmd.type)
+    {
+      case CommandType::SetFramebuffer:
+        device->SetFramebuffer(cmd.framebuffer);
+        break;
+
+      case CommandType::SetPipeline:
+        device->SetPipeline(cmd.pipeline);
+        break;
+
+      case CommandType::SetTextureSampler:
+        device->SetTextureSampler(cmd.slot, cmd.texture_sampler.texture, cmd.texture_sampler.sampler);
+        break;
+
+      case CommandType::SetTextureBuffer:
+        device->SetTextureBuffer(cmd.slot, cmd.texture_buffer);
+        break;
+
+      case CommandType::SetViewport:
+        device->SetViewport(cmd.rect.x, cmd.rect.y, cmd.rect.width, cmd.rect.height);
+        break;
+
+      case CommandType::SetScissor:
+        device->SetScissor(cmd.rect.x, cmd.rect.y, cmd.rect.width, cmd.rect.height);
+        break;
+
+      case CommandType::PushUniformBuffer:
+        device->PushUniformBuffer(m_data.data() + cmd.data.offset, cmd.data.size);
+        break;
+
+      case CommandType::UploadVertices:
+        device->UploadVertexBuffer(m_data.data() + cmd.data.offset, cmd.data.size, cmd.data.count, &device_base_vertex);
+        break;
+
+      case CommandType::UploadIndices:
+        device->UploadIndexBuffer(reinterpret_cast<const GPUDevice::DrawIndex*>(m_data.data() + cmd.data.offset),
+                                  cmd.data.count, &device_base_index);
+        break;
+
+      case CommandType::Draw:
+        device->Draw(cmd.draw.count, device_base_vertex + cmd.draw.base_vertex);
+        break;
+
+      case CommandType::DrawIndexed:
+        device->DrawIndexed(cmd.draw.count, device_base_index + cmd.draw.base_index,
+                            device_base_vertex + cmd.draw.base_vertex);
+        break;
+
+        DefaultCaseIsUnreachable();
+    }
+  }
+}
@@ -0,0 +1,146 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "gpu_device.h"
+
+#include "common/types.h"
+
+#include <array>
+#include <vector>
+
+/// Records draw state changes and draws, to be replayed into the device later, which can be on another thread. Vertex,
+/// index and uniform data is copied into the list, so the recording thread never touches the device's buffers, and the
+/// objects referenced must stay alive until the list has been replayed.
+///
+/// State which is already current in the list is dropped while recording. A list starts with no state, so the first
+/// change of each is always kept, and a list never relies on what the previous one left bound. Device calls which
+/// aren't recorded, such as copies and clears, should go between lists rather than while one is being recorded.
+class GPUCommandList
+{
+public:
+  GPUCommandList();
+  ~GPUCommandList();
+
+  ALWAYS_INLINE bool IsEmpty() const { return m_commands.empty(); }
+  ALWAYS_INLINE u32 GetCommandCount() const { return static_cast<u32>(m_commands.size()); }
+  ALWAYS_INLINE u32 GetDrawCount() const { return m_draw_count; }
+  ALWAYS_INLINE u32 GetFilteredCount() const { return m_filtered_count; }
+  ALWAYS_INLINE size_t GetDataSize() const { return m_data.size(); }
+
+  /// Empties the list and forgets the recorded state. Keeps the allocations for the next frame.
+  void Clear();
+
+  void SetFramebuffer(GPUFramebuffer* fb);
+  void SetPipeline(GPUPipeline* pipeline);
+  void SetTextureSampler(u32 slot, GPUTexture* texture, GPUSampler* sampler);
+  void SetTextureBuffer(u32 slot, GPUTextureBuffer* buffer);
+  void SetViewport(s32 x, s32 y, s32 width, s32 height);
+  void SetScissor(s32 x, s32 y, s32 width, s32 height);
+  void SetViewportAndScissor(s32 x, s32 y, s32 width, s32 height);
+  void PushUniformBuffer(const void* data, u32 data_size);
+
+  /// Returns space in the list for vertices. The base vertex of draws is relative to the most recent upload, like the
+  /// device's, so the same draw code works with either.
+  void* MapVertexBuffer(u32 vertex_size, u32 vertex_count, u32* map_base_vertex);
+  void UnmapVertexBuffer(u32 vertex_size, u32 vertex_count);
+  void UploadVertexBuffer(const void* vertices, u32 vertex_size, u32 vertex_count, u32* base_vertex);
+
+  GPUDevice::DrawIndex* MapIndexBuffer(u32 index_count, u32* map_base_index);
+  void UnmapIndexBuffer(u32 used_count);
+  void UploadIndexBuffer(const GPUDevice::DrawIndex* indices, u32 index_count, u32* base_index);
+
+  void Draw(u32 vertex_count, u32 base_vertex);
+  void DrawIndexed(u32 index_count, u32 base_index, u32 base_vertex);
+
+  /// Issues the recorded commands to the device. Must be called on the thread which owns the device.
+  void Replay(GPUDevice* device) const;
+
+private:
+  enum class CommandType : u8
+  {
+    SetFramebuffer,
+    SetPipeline,
+    SetTextureSampler,
+    SetTextureBuffer,
+    SetViewport,
+    SetScissor,
+    PushUniformBuffer,
+    UploadVertices,
+    UploadIndices,
+    Draw,
+    DrawIndexed,
+  };
+
+  struct Rect
+  {
+    s32 x, y, width, height;
+
+    ALWAYS_INLINE bool operator==(const Rect& r) const
+    {
+      return (x == r.x && y == r.y && width == r.width && height == r.height);
+    }
+  };
+
+  /// Fixed size, so the list is a flat array. Anything variable sized lives in m_data.
+  struct Command
+  {
+    CommandType type;
+    u8 slot;
+    union
+    {
+      GPUFramebuffer* framebuffer;
+      GPUPipeline* pipeline;
+      GPUTextureBuffer* texture_buffer;
+      struct
+      {
+        GPUTexture* texture;
+        GPUSampler* sampler;
+      } texture_sampler;
+      Rect rect;
+      struct
+      {
+        u32 offset;
+        u32 size;
+        u32 count;
+      } data;
+      struct
+      {
+        u32 count;
+        u32 base_index;
+        u32 base_vertex;
+      } draw;
+    };
+  };
+
+  struct State
+  {
+    GPUFramebuffer* framebuffer;
+    GPUPipeline* pipeline;
+    std::array<GPUTexture*, GPUDevice::MAX_TEXTURE_SAMPLERS> textures;
+    std::array<GPUSampler*, GPUDevice::MAX_TEXTURE_SAMPLERS> samplers;
+    GPUTextureBuffer* texture_buffer;
+    Rect viewport;
+    Rect scissor;
+    u32 uniform_offset;
+    u32 uniform_size;
+    u32 texture_mask; ///< Bit per slot which has been set in this list, binding null counts as a change too.
+    bool has_framebuffer;
+    bool has_pipeline;
+    bool has_texture_buffer;
+    bool has_viewport;
+    bool has_scissor;
+    bool has_uniforms;
+  };
+
+  Command& AddCommand(CommandType type);
+  u32 AllocateData(u32 size);
+
+  std::vector<Command> m_commands;
+  std::vector<u8> m_data;
+  State m_state;
+  u32 m_map_offset = 0;
+  u32 m_draw_count = 0;
+  u32 m_filtered_count = 0;
+};
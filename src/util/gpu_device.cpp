@@ -4,6 +4,7 @@
 #include "gpu_device.h"
 #include "core/host.h"     // TODO: Remove, needed for getting fullscreen mode.
 #include "core/settings.h" // TODO: Remove, needed for dump directory.
+#include "null_device.h"
 #include "shadergen.h"
 
 #include "common/assert.h"
@@ -29,12 +30,20 @@ Log_SetChannel(GPUDevice);
 #include "opengl_device.h"
 #endif
 
+#if defined(ENABLE_VULKAN) || defined(__APPLE__)
+#include "spirv_compiler.h"
+#endif
+
 #ifdef ENABLE_VULKAN
 #include "vulkan_device.h"
 #endif
 
+#include <algorithm>
+
 std::unique_ptr<GPUDevice> g_gpu_device;
 
+GPUDevice::Statistics GPUDevice::s_stats = {};
+
 static std::string s_pipeline_cache_path;
 
 GPUFramebuffer::GPUFramebuffer(GPUTexture* rt, GPUTexture* ds, u32 width, u32 height)
@@ -298,6 +307,16 @@ void GPUDevice::OpenShaderCache(const std::string_view& base_path, u32 version)
     m_shader_cache.Open(std::string_view(), version);
   }
 
+#if defined(ENABLE_VULKAN) || defined(__APPLE__)
+  const RenderAPI api = GetRenderAPI();
+  if (m_features.shader_cache && !base_path.empty() && (api == RenderAPI::Vulkan || api == RenderAPI::Metal))
+  {
+    const std::string filename = Path::Combine(base_path, "spirv_shaders");
+    if (!m_spirv_cache.Open(filename.c_str(), version) && !m_spirv_cache.Create())
+      Log_ErrorPrintf("Failed to create SPIR-V shader cache.");
+  }
+#endif
+
   s_pipeline_cache_path = {};
   if (m_features.pipeline_cache && !base_path.empty())
   {
@@ -310,9 +329,20 @@ void GPUDevice::OpenShaderCache(const std::string_view& base_path, u32 version)
   }
 }
 
+void GPUDevice::SetShaderCacheProfile(const std::string_view& name)
+{
+  if (!m_shader_cache.IsOpen())
+    return;
+
+  m_shader_cache.SetProfile(
+    name.empty() ? std::string() :
+                   fmt::format("{}.{}.profile", m_shader_cache.GetBaseFilename(), Path::SanitizeFileName(name)));
+}
+
 void GPUDevice::CloseShaderCache()
 {
   m_shader_cache.Close();
+  m_spirv_cache.Close();
 
   if (!s_pipeline_cache_path.empty())
   {
@@ -391,6 +421,11 @@ bool GPUDevice::GetPipelineCacheData(DynamicHeapArray<u8>* data)
   return false;
 }
 
+bool GPUDevice::WaitForPipelineCompiles()
+{
+  return true;
+}
+
 bool GPUDevice::AcquireWindow(bool recreate_window)
 {
   std::optional<WindowInfo> wi = Host::AcquireRenderWindow(recreate_window);
@@ -458,6 +493,8 @@ bool GPUDevice::CreateResources()
 
 void GPUDevice::DestroyResources()
 {
+  PurgeTexturePool();
+
   m_imgui_font_texture.reset();
   m_imgui_pipeline.reset();
 
@@ -469,14 +506,72 @@ void GPUDevice::DestroyResources()
   m_shader_cache.Close();
 }
 
+std::unique_ptr<GPUTexture> GPUDevice::FetchTexture(u32 width, u32 height, u32 layers, u32 levels, u32 samples,
+                                                    GPUTexture::Type type, GPUTexture::Format format,
+                                                    const void* data, u32 data_stride)
+{
+  const TexturePoolKey key = {static_cast<u16>(width), static_cast<u16>(height), static_cast<u8>(layers),
+                              static_cast<u8>(levels), static_cast<u8>(samples), type, format};
+
+  // Work which still uses the old contents was recorded earlier, so it's ordered before anything drawn to it now.
+  for (auto it = m_texture_pool.begin(); it != m_texture_pool.end(); ++it)
+  {
+    if (it->key != key)
+      continue;
+
+    std::unique_ptr<GPUTexture> texture = std::move(it->texture);
+    m_texture_pool.erase(it);
+
+    if (data && !texture->Update(0, 0, width, height, data, data_stride))
+      break;
+
+    return texture;
+  }
+
+  return CreateTexture(width, height, layers, levels, samples, type, format, data, data_stride);
+}
+
+void GPUDevice::RecycleTexture(std::unique_ptr<GPUTexture> texture)
+{
+  if (!texture)
+    return;
+
+  if (m_texture_pool.size() >= MAX_TEXTURE_POOL_SIZE)
+    m_texture_pool.erase(m_texture_pool.begin());
+
+  const TexturePoolKey key = {static_cast<u16>(texture->GetWidth()),  static_cast<u16>(texture->GetHeight()),
+                              static_cast<u8>(texture->GetLayers()),  static_cast<u8>(texture->GetLevels()),
+                              static_cast<u8>(texture->GetSamples()), texture->GetType(),
+                              texture->GetFormat()};
+  m_texture_pool.push_back(TexturePoolEntry{std::move(texture), m_texture_pool_frame, key});
+}
+
+void GPUDevice::TrimTexturePool()
+{
+  m_texture_pool_frame++;
+
+  // The backends defer the actual release until the GPU is done with the texture.
+  m_texture_pool.erase(std::remove_if(m_texture_pool.begin(), m_texture_pool.end(),
+                                      [this](const TexturePoolEntry& entry) {
+                                        return ((m_texture_pool_frame - entry.recycle_frame) >= MAX_TEXTURE_POOL_AGE);
+                                      }),
+                       m_texture_pool.end());
+}
+
+void GPUDevice::PurgeTexturePool()
+{
+  m_texture_pool.clear();
+}
+
 void GPUDevice::RenderImGui()
 {
   GL_SCOPE("RenderImGui");
 
   ImGui::Render();
 
+  // Windows which are open but have nothing to draw still leave empty lists behind.
   const ImDrawData* draw_data = ImGui::GetDrawData();
-  if (draw_data->CmdListsCount == 0)
+  if (draw_data->CmdListsCount == 0 || draw_data->TotalVtxCount == 0)
     return;
 
   SetPipeline(m_imgui_pipeline.get());
@@ -577,17 +672,23 @@ std::unique_ptr<GPUShader> GPUDevice::CreateShader(GPUShaderStage stage, const s
     return shader;
   }
 
+  // Only the cache itself needs the lock, compiling happens outside it, so shaders can be compiled on several threads
+  // when the device allows it.
   const GPUShaderCache::CacheIndexKey key = m_shader_cache.GetCacheKey(stage, source, entry_point);
   DynamicHeapArray<u8> binary;
+  std::unique_lock lock(m_shader_cache_mutex);
   if (m_shader_cache.Lookup(key, &binary))
   {
+    lock.unlock();
     shader = CreateShaderFromBinary(stage, binary);
     if (shader)
       return shader;
 
     Log_ErrorPrintf("Failed to create shader from binary (driver changed?). Clearing cache.");
+    lock.lock();
     m_shader_cache.Clear();
   }
+  lock.unlock();
 
   shader = CreateShaderFromSource(stage, source, entry_point, &binary);
   if (!shader)
@@ -596,13 +697,45 @@ std::unique_ptr<GPUShader> GPUDevice::CreateShader(GPUShaderStage stage, const s
   // Don't insert empty shaders into the cache...
   if (!binary.empty())
   {
-    if (!m_shader_cache.Insert(key, binary.data(), static_cast<u32>(binary.size())))
+    lock.lock();
+    if (m_shader_cache.IsOpen() && !m_shader_cache.Insert(key, binary.data(), static_cast<u32>(binary.size())))
       m_shader_cache.Close();
   }
 
   return shader;
 }
 
+#if defined(ENABLE_VULKAN) || defined(__APPLE__)
+
+bool GPUDevice::CompileGLSLToSPIRV(GPUShaderStage stage, const std::string_view& source, u32 options,
+                                   DynamicHeapArray<u8>* spirv)
+{
+  // Options change the output, so they're part of the key in place of the entry point, which is always main.
+  const TinyString options_str = TinyString::from_fmt("main:{}", options);
+  GPUShaderCache::CacheIndexKey key = {};
+  if (m_spirv_cache.IsOpen())
+  {
+    key = GPUShaderCache::GetCacheKey(stage, source, options_str);
+    if (m_spirv_cache.Lookup(key, spirv) && !spirv->empty())
+      return true;
+  }
+
+  std::optional<SPIRVCompiler::SPIRVCodeVector> code = SPIRVCompiler::CompileShader(stage, source, options);
+  if (!code.has_value())
+    return false;
+
+  const size_t size = code->size() * sizeof(SPIRVCompiler::SPIRVCodeType);
+  spirv->resize(size);
+  std::memcpy(spirv->data(), code->data(), size);
+
+  if (m_spirv_cache.IsOpen() && !m_spirv_cache.Insert(key, spirv->data(), static_cast<u32>(size)))
+    m_spirv_cache.Close();
+
+  return true;
+}
+
+#endif
+
 bool GPUDevice::GetRequestedExclusiveFullscreenMode(u32* width, u32* height, float* refresh_rate)
 {
   const std::string mode = Host::GetBaseStringSettingValue("GPU", "FullscreenMode", "");
@@ -688,10 +821,11 @@ bool GPUDevice::UpdateImGuiFontTexture()
   }
 
   std::unique_ptr<GPUTexture> new_font =
-    CreateTexture(width, height, 1, 1, 1, GPUTexture::Type::Texture, GPUTexture::Format::RGBA8, pixels, pitch);
+    FetchTexture(width, height, 1, 1, 1, GPUTexture::Type::Texture, GPUTexture::Format::RGBA8, pixels, pitch);
   if (!new_font)
     return false;
 
+  RecycleTexture(std::move(m_imgui_font_texture));
   m_imgui_font_texture = std::move(new_font);
   io.Fonts->SetTexID(m_imgui_font_texture.get());
   return true;
@@ -722,6 +856,11 @@ bool GPUDevice::ShouldSkipDisplayingFrame()
   return false;
 }
 
+bool GPUDevice::IsPresentPending() const
+{
+  return false;
+}
+
 void GPUDevice::ThrottlePresentation()
 {
   const float throttle_rate = (m_window_info.surface_refresh_rate > 0.0f) ? m_window_info.surface_refresh_rate : 60.0f;
@@ -761,6 +900,47 @@ float GPUDevice::GetAndResetAccumulatedGPUTime()
   return 0.0f;
 }
 
+const char* GPUDevice::GetTimingScopeName(TimingScope scope)
+{
+  static constexpr std::array<const char*, NUM_TIMING_SCOPES> names = {
+    {"Draw", "VRAM Transfer", "Readback", "Downsample", "Display", "Post-Processing"}};
+  return names[static_cast<u32>(scope)];
+}
+
+void GPUDevice::BeginTimingScope(TimingScope scope)
+{
+  if (!m_gpu_timing_enabled || !m_features.gpu_timing_scopes || m_current_timing_scope == scope)
+    return;
+
+  if (m_current_timing_scope != TimingScope::None)
+    WriteTimingScopeEnd();
+
+  m_current_timing_scope = scope;
+  WriteTimingScopeBegin(scope);
+}
+
+void GPUDevice::EndTimingScope()
+{
+  if (m_current_timing_scope == TimingScope::None)
+    return;
+
+  WriteTimingScopeEnd();
+  m_current_timing_scope = TimingScope::None;
+}
+
+GPUDevice::TimingScopeTimes GPUDevice::GetAndResetAccumulatedScopeTimes()
+{
+  return std::exchange(m_accumulated_scope_times, {});
+}
+
+void GPUDevice::WriteTimingScopeBegin(TimingScope scope)
+{
+}
+
+void GPUDevice::WriteTimingScopeEnd()
+{
+}
+
 std::unique_ptr<GPUDevice> GPUDevice::CreateDeviceForAPI(RenderAPI api)
 {
   switch (api)
@@ -789,6 +969,9 @@ std::unique_ptr<GPUDevice> GPUDevice::CreateDeviceForAPI(RenderAPI api)
       return WrapNewMetalDevice();
 #endif
 
+    case RenderAPI::None:
+      return std::make_unique<NullDevice>();
+
     default:
       return {};
   }
@@ -13,7 +13,9 @@
 #include "common/small_string.h"
 #include "common/types.h"
 
+#include <array>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
@@ -453,8 +455,10 @@ public:
     bool geometry_shaders : 1;
     bool partial_msaa_resolve : 1;
     bool gpu_timing : 1;
+    bool gpu_timing_scopes : 1;
     bool shader_cache : 1;
     bool pipeline_cache : 1;
+    bool threaded_pipeline_creation : 1; ///< CreatePipeline() and CreateShader() can be called from several threads.
   };
 
   struct AdapterAndModeList
@@ -463,9 +467,38 @@ public:
     std::vector<std::string> fullscreen_modes;
   };
 
+  /// Stream buffer counters, accumulated until the owner of the statistics display resets them.
+  struct Statistics
+  {
+    u32 num_stream_buffer_wraps;  // allocation restarted at the start of the buffer
+    u32 num_stream_buffer_stalls; // CPU had to wait for the GPU to release space
+  };
+
+  /// Parts of the frame which can be timed separately when GPU timing is enabled.
+  enum class TimingScope : u8
+  {
+    Draw,
+    VRAMTransfer,
+    Readback,
+    Downsample,
+    Display,
+    PostProcessing,
+    MaxCount,
+    None = MaxCount
+  };
+  static constexpr u32 NUM_TIMING_SCOPES = static_cast<u32>(TimingScope::MaxCount);
+  using TimingScopeTimes = std::array<float, NUM_TIMING_SCOPES>;
+
   static constexpr u32 MAX_TEXTURE_SAMPLERS = 8;
   static constexpr u32 MIN_TEXEL_BUFFER_ELEMENTS = 4 * 1024 * 512;
 
+  static constexpr u32 MAX_TEXTURE_POOL_SIZE = 64;
+  static constexpr u32 MAX_TEXTURE_POOL_AGE = 300; ///< Presented frames before an unused pooled texture is destroyed.
+
+  static Statistics s_stats;
+
+  static const char* GetTimingScopeName(TimingScope scope);
+
   virtual ~GPUDevice();
 
   /// Returns the default/preferred API for the system.
@@ -551,6 +584,21 @@ public:
                                                     const void* data = nullptr, u32 data_stride = 0,
                                                     bool dynamic = false) = 0;
   virtual std::unique_ptr<GPUSampler> CreateSampler(const GPUSampler::Config& config) = 0;
+
+  /// Returns a recycled texture if there's one with the same config, otherwise creates one. Pooled textures keep
+  /// whatever they last contained, data replaces the first level and layer when it's given.
+  std::unique_ptr<GPUTexture> FetchTexture(u32 width, u32 height, u32 layers, u32 levels, u32 samples,
+                                           GPUTexture::Type type, GPUTexture::Format format,
+                                           const void* data = nullptr, u32 data_stride = 0);
+
+  /// Gives a texture back to the pool instead of destroying it. Any framebuffers using it must be destroyed first, and
+  /// dynamic textures shouldn't be recycled, since fetching never asks for one.
+  void RecycleTexture(std::unique_ptr<GPUTexture> texture);
+
+  /// Destroys pooled textures which haven't been fetched for a while. Call once per presented frame.
+  void TrimTexturePool();
+  void PurgeTexturePool();
+
   virtual std::unique_ptr<GPUTextureBuffer> CreateTextureBuffer(GPUTextureBuffer::Format format,
                                                                 u32 size_in_elements) = 0;
 
@@ -570,8 +618,15 @@ public:
   /// Shader abstraction.
   std::unique_ptr<GPUShader> CreateShader(GPUShaderStage stage, const std::string_view& source,
                                           const char* entry_point = "main");
+
+  /// Records which shaders are used under the given name (e.g. a game serial), and preloads the ones used last time.
+  void SetShaderCacheProfile(const std::string_view& name);
   virtual std::unique_ptr<GPUPipeline> CreatePipeline(const GPUPipeline::GraphicsConfig& config) = 0;
 
+  /// Waits for any pipelines which are still being compiled by the driver. Devices which compile pipelines in
+  /// CreatePipeline() have nothing to wait for, others only report failures here. Returns false if any failed.
+  virtual bool WaitForPipelineCompiles();
+
   /// Debug messaging.
   virtual void PushDebugGroup(const char* name) = 0;
   virtual void PopDebugGroup() = 0;
@@ -624,6 +679,9 @@ public:
   bool ShouldSkipDisplayingFrame();
   void ThrottlePresentation();
 
+  /// Returns true if the previous frame is still being presented on another thread, i.e. presenting now would block.
+  virtual bool IsPresentPending() const;
+
   virtual bool SupportsTextureFormat(GPUTexture::Format format) const = 0;
 
   virtual bool GetHostRefreshRate(float* refresh_rate);
@@ -634,6 +692,14 @@ public:
   /// Returns the amount of GPU time utilized since the last time this method was called.
   virtual float GetAndResetAccumulatedGPUTime();
 
+  /// Attributes GPU work recorded from now on to the scope, ending the current scope if there is one.
+  /// Scopes don't nest. Does nothing if GPU timing is disabled or the backend can't time scopes.
+  void BeginTimingScope(TimingScope scope);
+  void EndTimingScope();
+
+  /// Returns the GPU time spent in each scope since the last time this method was called, in milliseconds.
+  TimingScopeTimes GetAndResetAccumulatedScopeTimes();
+
 protected:
   virtual bool CreateDevice(const std::string_view& adapter, bool threaded_presentation) = 0;
   virtual void DestroyDevice() = 0;
@@ -642,11 +708,20 @@ protected:
   virtual bool ReadPipelineCache(const std::string& filename);
   virtual bool GetPipelineCacheData(DynamicHeapArray<u8>* data);
 
+  virtual void WriteTimingScopeBegin(TimingScope scope);
+  virtual void WriteTimingScopeEnd();
+
   virtual std::unique_ptr<GPUShader> CreateShaderFromBinary(GPUShaderStage stage, std::span<const u8> data) = 0;
   virtual std::unique_ptr<GPUShader> CreateShaderFromSource(GPUShaderStage stage, const std::string_view& source,
                                                             const char* entry_point,
                                                             DynamicHeapArray<u8>* out_binary) = 0;
 
+#if defined(ENABLE_VULKAN) || defined(__APPLE__)
+  /// Compiles GLSL to SPIR-V with glslang, going through the SPIR-V cache. Options are SPIRVCompiler::CompileOptions.
+  bool CompileGLSLToSPIRV(GPUShaderStage stage, const std::string_view& source, u32 options,
+                          DynamicHeapArray<u8>* spirv);
+#endif
+
   bool AcquireWindow(bool recreate_window);
 
   Features m_features = {};
@@ -656,6 +731,11 @@ protected:
   WindowInfo m_window_info;
 
   GPUShaderCache m_shader_cache;
+  std::mutex m_shader_cache_mutex;
+
+  // SPIR-V doesn't depend on the driver, so it's cached separately from the backend binaries, and is shared by the
+  // backends which translate from it. Clearing the backend cache after a driver update doesn't recompile with glslang.
+  GPUShaderCache m_spirv_cache;
 
   std::unique_ptr<GPUSampler> m_nearest_sampler;
   std::unique_ptr<GPUSampler> m_linear_sampler;
@@ -664,6 +744,9 @@ protected:
   bool m_vsync_enabled = false;
   bool m_debug_device = false;
 
+  TimingScope m_current_timing_scope = TimingScope::None;
+  TimingScopeTimes m_accumulated_scope_times = {};
+
 private:
   void OpenShaderCache(const std::string_view& base_path, u32 version);
   void CloseShaderCache();
@@ -676,6 +759,34 @@ private:
 
   std::unique_ptr<GPUPipeline> m_imgui_pipeline;
   std::unique_ptr<GPUTexture> m_imgui_font_texture;
+
+  struct TexturePoolKey
+  {
+    u16 width;
+    u16 height;
+    u8 layers;
+    u8 levels;
+    u8 samples;
+    GPUTexture::Type type;
+    GPUTexture::Format format;
+
+    ALWAYS_INLINE bool operator==(const TexturePoolKey& rhs) const
+    {
+      return (width == rhs.width && height == rhs.height && layers == rhs.layers && levels == rhs.levels &&
+              samples == rhs.samples && type == rhs.type && format == rhs.format);
+    }
+  };
+
+  struct TexturePoolEntry
+  {
+    std::unique_ptr<GPUTexture> texture;
+    u32 recycle_frame;
+    TexturePoolKey key;
+  };
+
+  // Oldest first. Small enough that searching it is cheaper than creating a texture.
+  std::vector<TexturePoolEntry> m_texture_pool;
+  u32 m_texture_pool_frame = 0;
 };
 
 extern std::unique_ptr<GPUDevice> g_gpu_device;
@@ -8,14 +8,27 @@
 #include "common/heap_array.h"
 #include "common/log.h"
 #include "common/md5_digest.h"
+#include "common/memmap.h"
+#include "common/threading.h"
 
 #include "fmt/format.h"
 
 #include "zstd.h"
 #include "zstd_errors.h"
 
+#include <algorithm>
+
 Log_SetChannel(GPUShaderCache);
 
+static constexpr u32 PROFILE_SIGNATURE = 0x46505347; // GSPF
+
+// Past this, the oldest shaders are dropped until the cache is down to half the size.
+static constexpr u32 MAX_BLOB_FILE_SIZE = 128 * 1024 * 1024;
+
+// Blobs which no index entry refers to are left behind by duplicate inserts and failed writes. They're only
+// reclaimed once there's a worthwhile amount of them.
+static constexpr u32 MIN_COMPACT_WASTED_SIZE = 4 * 1024 * 1024;
+
 #pragma pack(push, 1)
 struct CacheIndexEntry
 {
@@ -78,6 +91,15 @@ bool GPUShaderCache::Create()
 
 void GPUShaderCache::Close()
 {
+  StopPrefetch();
+  SaveProfile();
+
+  if (m_blob_map)
+  {
+    MemMap::UnmapFile(const_cast<u8*>(m_blob_map), m_blob_map_size);
+    m_blob_map = nullptr;
+    m_blob_map_size = 0;
+  }
   if (m_index_file)
   {
     std::fclose(m_index_file);
@@ -207,13 +229,132 @@ bool GPUShaderCache::ReadExisting(const std::string& index_filename, const std::
     m_index.emplace(key, data);
   }
 
+  u32 referenced_size = 0;
+  for (const auto& it : m_index)
+    referenced_size += it.second.compressed_size;
+
+  const u32 wasted_size = blob_file_size - std::min(referenced_size, blob_file_size);
+  if ((blob_file_size > MAX_BLOB_FILE_SIZE ||
+       (wasted_size >= MIN_COMPACT_WASTED_SIZE && wasted_size > (blob_file_size / 4))) &&
+      !Compact(index_filename, blob_filename, blob_file_size))
+  {
+    return false;
+  }
+
   // ensure we don't write before seeking
   std::fseek(m_index_file, 0, SEEK_END);
 
+  // Lookups read from here from now on, the file handle is only used to append.
+  m_blob_map = static_cast<const u8*>(MemMap::MapFileReadOnly(blob_filename.c_str(), &m_blob_map_size));
+
   Log_DevPrintf("Read %zu entries from '%s'", m_index.size(), index_filename.c_str());
   return true;
 }
 
+bool GPUShaderCache::Compact(const std::string& index_filename, const std::string& blob_filename, u32 blob_file_size)
+{
+  std::fclose(m_blob_file);
+  m_blob_file = nullptr;
+  std::fclose(m_index_file);
+  m_index_file = nullptr;
+
+  // The files are only ever appended to, so the offset is the order the shaders were inserted in.
+  std::vector<std::pair<CacheIndexKey, CacheIndexData>> entries(m_index.begin(), m_index.end());
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& lhs, const auto& rhs) { return (lhs.second.file_offset > rhs.second.file_offset); });
+
+  const u32 max_size = (blob_file_size > MAX_BLOB_FILE_SIZE) ? (MAX_BLOB_FILE_SIZE / 2) : blob_file_size;
+  u32 kept_size = 0;
+  size_t kept_count = 0;
+  for (; kept_count < entries.size(); kept_count++)
+  {
+    if ((kept_size + entries[kept_count].second.compressed_size) > max_size)
+      break;
+
+    kept_size += entries[kept_count].second.compressed_size;
+  }
+  entries.resize(kept_count);
+  std::reverse(entries.begin(), entries.end());
+  m_index.clear();
+
+  size_t map_size;
+  const u8* map = static_cast<const u8*>(MemMap::MapFileReadOnly(blob_filename.c_str(), &map_size));
+  if (!map)
+  {
+    Log_ErrorPrintf("Failed to map blob file '%s' for compaction", blob_filename.c_str());
+    return false;
+  }
+
+  const std::string index_temp_filename = fmt::format("{}.tmp", index_filename);
+  const std::string blob_temp_filename = fmt::format("{}.tmp", blob_filename);
+  std::FILE* index_fp = FileSystem::OpenCFile(index_temp_filename.c_str(), "wb");
+  std::FILE* blob_fp = FileSystem::OpenCFile(blob_temp_filename.c_str(), "wb");
+  bool result = (index_fp && blob_fp && std::fwrite(&m_version, sizeof(m_version), 1, index_fp) == 1);
+
+  u32 offset = 0;
+  for (const auto& [key, data] : entries)
+  {
+    if (!result)
+      break;
+
+    CacheIndexEntry entry = {};
+    entry.shader_type = key.shader_type;
+    entry.source_length = key.source_length;
+    entry.source_hash_low = key.source_hash_low;
+    entry.source_hash_high = key.source_hash_high;
+    entry.entry_point_low = key.entry_point_low;
+    entry.entry_point_high = key.entry_point_high;
+    entry.file_offset = offset;
+    entry.compressed_size = data.compressed_size;
+    entry.uncompressed_size = data.uncompressed_size;
+
+    result = (std::fwrite(map + data.file_offset, data.compressed_size, 1, blob_fp) == 1 &&
+              std::fwrite(&entry, sizeof(entry), 1, index_fp) == 1);
+    m_index.emplace(key, CacheIndexData{offset, data.compressed_size, data.uncompressed_size});
+    offset += data.compressed_size;
+  }
+
+  MemMap::UnmapFile(const_cast<u8*>(map), map_size);
+  if (blob_fp)
+    result = (std::fclose(blob_fp) == 0) && result;
+  if (index_fp)
+    result = (std::fclose(index_fp) == 0) && result;
+
+  if (!result || !FileSystem::RenamePath(blob_temp_filename.c_str(), blob_filename.c_str()) ||
+      !FileSystem::RenamePath(index_temp_filename.c_str(), index_filename.c_str()))
+  {
+    Log_ErrorPrintf("Failed to compact shader cache '%s'", blob_filename.c_str());
+    FileSystem::DeleteFile(blob_temp_filename.c_str());
+    FileSystem::DeleteFile(index_temp_filename.c_str());
+    m_index.clear();
+    return false;
+  }
+
+  Log_InfoPrintf("Compacted shader cache from %u to %u bytes, keeping %zu shaders", blob_file_size, offset,
+                 m_index.size());
+
+  m_index_file = FileSystem::OpenCFile(index_filename.c_str(), "r+b");
+  m_blob_file = FileSystem::OpenCFile(blob_filename.c_str(), "a+b");
+  if (!m_index_file || !m_blob_file)
+  {
+    Log_ErrorPrintf("Failed to reopen compacted shader cache '%s'", blob_filename.c_str());
+    if (m_blob_file)
+    {
+      std::fclose(m_blob_file);
+      m_blob_file = nullptr;
+    }
+    if (m_index_file)
+    {
+      std::fclose(m_index_file);
+      m_index_file = nullptr;
+    }
+    m_index.clear();
+    return false;
+  }
+
+  return true;
+}
+
 GPUShaderCache::CacheIndexKey GPUShaderCache::GetCacheKey(GPUShaderStage stage, const std::string_view& shader_code,
                                                           const std::string_view& entry_point)
 {
@@ -252,14 +393,50 @@ bool GPUShaderCache::Lookup(const CacheIndexKey& key, ShaderBinary* binary)
   if (iter == m_index.end())
     return false;
 
-  binary->resize(iter->second.uncompressed_size);
+  {
+    std::unique_lock lock(m_prefetch_mutex);
+    auto pf_iter = m_prefetched_binaries.find(key);
+    if (pf_iter != m_prefetched_binaries.end())
+    {
+      *binary = std::move(pf_iter->second);
+      m_prefetched_binaries.erase(pf_iter);
+      lock.unlock();
+      RecordProfileKey(key);
+      return true;
+    }
+  }
+
+  if (!ReadBlob(m_blob_file, key, iter->second, binary))
+    return false;
+
+  RecordProfileKey(key);
+  return true;
+}
 
-  DynamicHeapArray<u8> compressed_data(iter->second.compressed_size);
+bool GPUShaderCache::ReadBlob(std::FILE* fp, const CacheIndexKey& key, const CacheIndexData& data,
+                              ShaderBinary* binary)
+{
+  binary->resize(data.uncompressed_size);
 
-  if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
-      std::fread(compressed_data.data(), iter->second.compressed_size, 1, m_blob_file) != 1)
+  if (m_blob_map && (static_cast<size_t>(data.file_offset) + data.compressed_size) <= m_blob_map_size)
   {
-    Log_ErrorPrintf("Read %u byte %s shader from file failed", iter->second.compressed_size,
+    const size_t decompress_result =
+      ZSTD_decompress(binary->data(), binary->size(), m_blob_map + data.file_offset, data.compressed_size);
+    if (ZSTD_isError(decompress_result))
+    {
+      Log_ErrorPrintf("Failed to decompress shader: %s", ZSTD_getErrorName(decompress_result));
+      return false;
+    }
+
+    return true;
+  }
+
+  DynamicHeapArray<u8> compressed_data(data.compressed_size);
+
+  if (std::fseek(fp, data.file_offset, SEEK_SET) != 0 ||
+      std::fread(compressed_data.data(), data.compressed_size, 1, fp) != 1)
+  {
+    Log_ErrorPrintf("Read %u byte %s shader from file failed", data.compressed_size,
                     GPUShader::GetStageName(static_cast<GPUShaderStage>(key.shader_type)));
     return false;
   }
@@ -316,5 +493,149 @@ bool GPUShaderCache::Insert(const CacheIndexKey& key, const void* data, u32 data
                 GPUShader::GetStageName(static_cast<GPUShaderStage>(key.shader_type)), data_size,
                 static_cast<u32>(compress_result));
   m_index.emplace(key, idata);
+  RecordProfileKey(key);
   return true;
 }
+
+void GPUShaderCache::SetProfile(std::string filename)
+{
+  if (m_profile_filename == filename)
+    return;
+
+  StopPrefetch();
+  SaveProfile();
+
+  m_profile_filename = std::move(filename);
+  m_profile_keys.clear();
+  m_profile_dirty = false;
+  if (m_profile_filename.empty())
+    return;
+
+  LoadProfile();
+  StartPrefetch();
+}
+
+void GPUShaderCache::RecordProfileKey(const CacheIndexKey& key)
+{
+  if (!m_profile_filename.empty() && m_profile_keys.insert(key).second)
+    m_profile_dirty = true;
+}
+
+void GPUShaderCache::LoadProfile()
+{
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(m_profile_filename.c_str());
+  if (!data.has_value())
+    return;
+
+  u32 header[3];
+  if (data->size() < sizeof(header))
+  {
+    Log_WarningPrintf("Shader profile '%s' is corrupted", m_profile_filename.c_str());
+    return;
+  }
+
+  std::memcpy(header, data->data(), sizeof(header));
+  if (header[0] != PROFILE_SIGNATURE || header[1] != m_version ||
+      data->size() != (sizeof(header) + (static_cast<size_t>(header[2]) * sizeof(CacheIndexKey))))
+  {
+    Log_WarningPrintf("Shader profile '%s' is corrupted or out of date", m_profile_filename.c_str());
+    return;
+  }
+
+  m_profile_keys.reserve(header[2]);
+  for (u32 i = 0; i < header[2]; i++)
+  {
+    CacheIndexKey key;
+    std::memcpy(&key, data->data() + sizeof(header) + (i * sizeof(CacheIndexKey)), sizeof(key));
+    m_profile_keys.insert(key);
+  }
+
+  Log_DevPrintf("Loaded %zu shaders from profile '%s'", m_profile_keys.size(), m_profile_filename.c_str());
+}
+
+void GPUShaderCache::SaveProfile()
+{
+  if (!m_profile_dirty || m_profile_filename.empty())
+    return;
+
+  m_profile_dirty = false;
+
+  const u32 header[3] = {PROFILE_SIGNATURE, m_version, static_cast<u32>(m_profile_keys.size())};
+  std::vector<u8> data(sizeof(header) + (m_profile_keys.size() * sizeof(CacheIndexKey)));
+  std::memcpy(data.data(), header, sizeof(header));
+
+  size_t offset = sizeof(header);
+  for (const CacheIndexKey& key : m_profile_keys)
+  {
+    std::memcpy(data.data() + offset, &key, sizeof(key));
+    offset += sizeof(key);
+  }
+
+  if (!FileSystem::WriteBinaryFile(m_profile_filename.c_str(), data.data(), data.size()))
+    Log_ErrorPrintf("Failed to write shader profile '%s'", m_profile_filename.c_str());
+}
+
+void GPUShaderCache::StartPrefetch()
+{
+  if (!IsOpen())
+    return;
+
+  std::vector<std::pair<CacheIndexKey, CacheIndexData>> entries;
+  entries.reserve(m_profile_keys.size());
+  for (const CacheIndexKey& key : m_profile_keys)
+  {
+    const auto iter = m_index.find(key);
+    if (iter != m_index.end())
+      entries.emplace_back(key, iter->second);
+  }
+  if (entries.empty())
+    return;
+
+  // read in file order, so it's mostly sequential
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& lhs, const auto& rhs) { return (lhs.second.file_offset < rhs.second.file_offset); });
+
+  m_prefetch_cancel.store(false, std::memory_order_relaxed);
+  m_prefetch_thread = std::thread(&GPUShaderCache::PrefetchThreadEntryPoint, this, std::move(entries));
+}
+
+void GPUShaderCache::StopPrefetch()
+{
+  if (m_prefetch_thread.joinable())
+  {
+    m_prefetch_cancel.store(true, std::memory_order_relaxed);
+    m_prefetch_thread.join();
+  }
+
+  std::unique_lock lock(m_prefetch_mutex);
+  m_prefetched_binaries.clear();
+}
+
+void GPUShaderCache::PrefetchThreadEntryPoint(std::vector<std::pair<CacheIndexKey, CacheIndexData>> entries)
+{
+  Threading::SetNameOfCurrentThread("Shader Prefetch");
+
+  // uses its own handle, so it doesn't disturb the position of the one which is written to
+  const std::string blob_filename = fmt::format("{}.bin", m_base_filename);
+  std::FILE* fp = FileSystem::OpenCFile(blob_filename.c_str(), "rb");
+  if (!fp)
+    return;
+
+  u32 count = 0;
+  for (const auto& [key, data] : entries)
+  {
+    if (m_prefetch_cancel.load(std::memory_order_relaxed))
+      break;
+
+    ShaderBinary binary;
+    if (!ReadBlob(fp, key, data, &binary))
+      continue;
+
+    std::unique_lock lock(m_prefetch_mutex);
+    m_prefetched_binaries.emplace(key, std::move(binary));
+    count++;
+  }
+
+  std::fclose(fp);
+  Log_DevPrintf("Prefetched %u of %zu shaders", count, entries.size());
+}
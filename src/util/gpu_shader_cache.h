@@ -7,9 +7,13 @@
 #include "common/heap_array.h"
 #include "common/types.h"
 
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 enum class GPUShaderStage : u8;
@@ -57,6 +61,11 @@ public:
   bool Insert(const CacheIndexKey& key, const void* data, u32 data_size);
   void Clear();
 
+  /// Switches the usage profile, which records the shaders looked up while it's active. The shaders which were
+  /// recorded last time are read and decompressed in the background, so they're ready when they're requested.
+  /// An empty filename stops recording.
+  void SetProfile(std::string filename);
+
 private:
   struct CacheIndexData
   {
@@ -66,15 +75,40 @@ private:
   };
 
   using CacheIndex = std::unordered_map<CacheIndexKey, CacheIndexData, CacheIndexEntryHash>;
+  using KeySet = std::unordered_set<CacheIndexKey, CacheIndexEntryHash>;
+  using BinaryMap = std::unordered_map<CacheIndexKey, ShaderBinary, CacheIndexEntryHash>;
 
   bool CreateNew(const std::string& index_filename, const std::string& blob_filename);
   bool ReadExisting(const std::string& index_filename, const std::string& blob_filename);
+  bool Compact(const std::string& index_filename, const std::string& blob_filename, u32 blob_file_size);
+  bool ReadBlob(std::FILE* fp, const CacheIndexKey& key, const CacheIndexData& data, ShaderBinary* binary);
+
+  void LoadProfile();
+  void SaveProfile();
+  void StartPrefetch();
+  void StopPrefetch();
+  void PrefetchThreadEntryPoint(std::vector<std::pair<CacheIndexKey, CacheIndexData>> entries);
+  void RecordProfileKey(const CacheIndexKey& key);
 
   CacheIndex m_index;
 
+  std::string m_profile_filename;
+  KeySet m_profile_keys;
+  bool m_profile_dirty = false;
+
+  std::thread m_prefetch_thread;
+  std::mutex m_prefetch_mutex;
+  std::atomic_bool m_prefetch_cancel{false};
+  BinaryMap m_prefetched_binaries;
+
   std::string m_base_filename;
   u32 m_version;
 
   std::FILE* m_index_file = nullptr;
   std::FILE* m_blob_file = nullptr;
+
+  // Blobs which were in the file when it was opened are decompressed straight out of the mapping. Anything inserted
+  // since is past the end of it, and read through the file.
+  const u8* m_blob_map = nullptr;
+  size_t m_blob_map_size = 0;
 };
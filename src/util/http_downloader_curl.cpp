@@ -65,6 +65,10 @@ bool HTTPDownloaderCurl::Initialize(const char* user_agent)
     return false;
   }
 
+  // Connections are kept in the multi handle's cache between requests. Requests to the same host share a single
+  // HTTP/2 connection where the server supports it, so badge and cover batches don't each pay for a TLS handshake.
+  curl_multi_setopt(m_multi_handle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
   m_user_agent = user_agent;
   return true;
 }
@@ -162,6 +166,10 @@ bool HTTPDownloaderCurl::StartRequest(HTTPDownloader::Request* request)
   curl_easy_setopt(req->handle, CURLOPT_WRITEDATA, req);
   curl_easy_setopt(req->handle, CURLOPT_NOSIGNAL, 1);
   curl_easy_setopt(req->handle, CURLOPT_PRIVATE, req);
+  curl_easy_setopt(req->handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+  curl_easy_setopt(req->handle, CURLOPT_PIPEWAIT, 1L);
+  curl_easy_setopt(req->handle, CURLOPT_TCP_KEEPALIVE, 1L);
+  curl_easy_setopt(req->handle, CURLOPT_ACCEPT_ENCODING, "");
 
   if (request->type == Request::Type::Post)
   {
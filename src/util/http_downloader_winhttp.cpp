@@ -46,6 +46,11 @@ bool HTTPDownloaderWinHttp::Initialize(const char* user_agent)
     return false;
   }
 
+  // Connections are already reused within the session. HTTP/2 needs Windows 10 1607 or newer, so failing is fine.
+  DWORD http2_flags = WINHTTP_PROTOCOL_FLAG_HTTP2;
+  if (!WinHttpSetOption(m_hSession, WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL, &http2_flags, sizeof(http2_flags)))
+    Log_DevPrintf("WinHttpSetOption(WINHTTP_OPTION_ENABLE_HTTP_PROTOCOL) failed: %u", GetLastError());
+
   const DWORD notification_flags = WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_REQUEST_ERROR |
                                    WINHTTP_CALLBACK_FLAG_HANDLES | WINHTTP_CALLBACK_FLAG_SECURE_FAILURE;
   if (WinHttpSetStatusCallback(m_hSession, HTTPStatusCallback, notification_flags, NULL) ==
@@ -21,10 +21,12 @@
 #include "imgui_internal.h"
 #include "imgui_stdlib.h"
 
+#include <algorithm>
 #include <array>
 #include <cmath>
 #include <condition_variable>
 #include <deque>
+#include <limits>
 #include <mutex>
 #include <thread>
 #include <variant>
@@ -36,6 +38,7 @@ using MessageDialogCallbackVariant = std::variant<InfoMessageDialogCallback, Con
 
 static std::optional<Common::RGBA8Image> LoadTextureImage(const char* path);
 static std::shared_ptr<GPUTexture> UploadTexture(const char* path, const Common::RGBA8Image& image);
+static size_t GetTextureMemorySize(const std::shared_ptr<GPUTexture>& texture);
 static void TextureLoaderThread();
 
 static void DrawFileSelector();
@@ -82,14 +85,23 @@ static u32 s_close_button_state = 0;
 static bool s_focus_reset_queued = false;
 static bool s_light_theme = false;
 
-static LRUCache<std::string, std::shared_ptr<GPUTexture>> s_texture_cache(128, true);
+// Bounded by memory rather than count, a screen of achievement badges is tiny next to a screen of covers. Eviction
+// only happens in BeginLayout(), so the cache's own capacity is never reached, and the size stays accounted for.
+static LRUCache<std::string, std::shared_ptr<GPUTexture>> s_texture_cache(std::numeric_limits<size_t>::max(), true);
+static size_t s_texture_cache_size = 0;
 static std::shared_ptr<GPUTexture> s_placeholder_texture;
 static std::atomic_bool s_texture_load_thread_quit{false};
 static std::mutex s_texture_load_mutex;
 static std::condition_variable s_texture_load_cv;
 static std::deque<std::string> s_texture_load_queue;
 static std::deque<std::pair<std::string, Common::RGBA8Image>> s_texture_upload_queue;
-static std::thread s_texture_load_thread;
+static std::vector<std::thread> s_texture_load_threads;
+
+// Decoding is spread over a few threads, uploads are spread over frames so a burst of them doesn't hitch.
+static constexpr u32 MAX_TEXTURE_LOAD_THREADS = 4;
+static constexpr double TEXTURE_UPLOAD_BUDGET_MS = 2.0;
+static constexpr size_t TEXTURE_CACHE_BUDGET = 64 * 1024 * 1024;
+static constexpr size_t MAX_TEXTURE_CACHE_ENTRIES = 4096; // placeholders for images which don't exist cost nothing
 
 static bool s_choice_dialog_open = false;
 static bool s_choice_dialog_checkable = false;
@@ -197,22 +209,27 @@ bool ImGuiFullscreen::Initialize(const char* placeholder_image_path)
   }
 
   s_texture_load_thread_quit.store(false, std::memory_order_release);
-  s_texture_load_thread = std::thread(TextureLoaderThread);
+  const u32 num_load_threads = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_TEXTURE_LOAD_THREADS);
+  for (u32 i = 0; i < num_load_threads; i++)
+    s_texture_load_threads.emplace_back(TextureLoaderThread);
   return true;
 }
 
 void ImGuiFullscreen::Shutdown()
 {
-  if (s_texture_load_thread.joinable())
+  if (!s_texture_load_threads.empty())
   {
     {
       std::unique_lock lock(s_texture_load_mutex);
       s_texture_load_thread_quit.store(true, std::memory_order_release);
-      s_texture_load_cv.notify_one();
+      s_texture_load_cv.notify_all();
     }
-    s_texture_load_thread.join();
+    for (std::thread& thread : s_texture_load_threads)
+      thread.join();
+    s_texture_load_threads.clear();
   }
 
+  s_texture_load_queue.clear();
   s_texture_upload_queue.clear();
   s_placeholder_texture.reset();
   g_standard_font = nullptr;
@@ -220,6 +237,7 @@ void ImGuiFullscreen::Shutdown()
   g_large_font = nullptr;
 
   s_texture_cache.Clear();
+  s_texture_cache_size = 0;
 
   s_notifications.clear();
   s_background_progress_dialogs.clear();
@@ -288,6 +306,15 @@ std::shared_ptr<GPUTexture> ImGuiFullscreen::UploadTexture(const char* path, con
   return std::shared_ptr<GPUTexture>(std::move(texture));
 }
 
+size_t ImGuiFullscreen::GetTextureMemorySize(const std::shared_ptr<GPUTexture>& texture)
+{
+  // The placeholder is shared by every pending entry, and isn't freed by evicting them.
+  if (!texture || texture == s_placeholder_texture)
+    return 0;
+
+  return static_cast<size_t>(texture->GetWidth()) * texture->GetHeight() * texture->GetPixelSize();
+}
+
 std::shared_ptr<GPUTexture> ImGuiFullscreen::LoadTexture(const std::string_view& path)
 {
   std::string path_str(path);
@@ -308,6 +335,7 @@ GPUTexture* ImGuiFullscreen::GetCachedTexture(const std::string_view& name)
   if (!tex_ptr)
   {
     std::shared_ptr<GPUTexture> tex(LoadTexture(name));
+    s_texture_cache_size += GetTextureMemorySize(tex);
     tex_ptr = s_texture_cache.Insert(std::string(name), std::move(tex));
   }
 
@@ -333,11 +361,18 @@ GPUTexture* ImGuiFullscreen::GetCachedTextureAsync(const std::string_view& name)
 
 bool ImGuiFullscreen::InvalidateCachedTexture(const std::string& path)
 {
+  std::shared_ptr<GPUTexture>* tex_ptr = s_texture_cache.Lookup(path);
+  if (!tex_ptr)
+    return false;
+
+  s_texture_cache_size -= GetTextureMemorySize(*tex_ptr);
   return s_texture_cache.Remove(path);
 }
 
 void ImGuiFullscreen::UploadAsyncTextures()
 {
+  // Always make progress, even if the first upload blows the budget.
+  Common::Timer timer;
   std::unique_lock lock(s_texture_load_mutex);
   while (!s_texture_upload_queue.empty())
   {
@@ -345,11 +380,21 @@ void ImGuiFullscreen::UploadAsyncTextures()
     s_texture_upload_queue.pop_front();
     lock.unlock();
 
-    std::shared_ptr<GPUTexture> tex = UploadTexture(it.first.c_str(), it.second);
-    if (tex)
-      s_texture_cache.Insert(std::move(it.first), std::move(tex));
+    // Skip anything which was evicted or invalidated while it was loading, e.g. covers which were scrolled past.
+    std::shared_ptr<GPUTexture>* tex_ptr = s_texture_cache.Lookup(it.first);
+    if (tex_ptr && *tex_ptr == s_placeholder_texture)
+    {
+      std::shared_ptr<GPUTexture> tex = UploadTexture(it.first.c_str(), it.second);
+      if (tex)
+      {
+        s_texture_cache_size += GetTextureMemorySize(tex);
+        *tex_ptr = std::move(tex);
+      }
+    }
 
     lock.lock();
+    if (timer.GetTimeMilliseconds() >= TEXTURE_UPLOAD_BUDGET_MS)
+      break;
   }
 }
 
@@ -382,8 +427,6 @@ void ImGuiFullscreen::TextureLoaderThread()
         s_texture_upload_queue.emplace_back(std::move(path), std::move(image.value()));
     }
   }
-
-  s_texture_load_queue.clear();
 }
 
 bool ImGuiFullscreen::UpdateLayoutScale()
@@ -451,7 +494,13 @@ void ImGuiFullscreen::BeginLayout()
 {
   // we evict from the texture cache at the start of the frame, in case we go over mid-frame,
   // we need to keep all those textures alive until the end of the frame
-  s_texture_cache.ManualEvict();
+  while ((s_texture_cache_size > TEXTURE_CACHE_BUDGET || s_texture_cache.GetSize() > MAX_TEXTURE_CACHE_ENTRIES) &&
+         s_texture_cache.GetSize() > 1)
+  {
+    s_texture_cache.EvictOldest([](const std::string&, const std::shared_ptr<GPUTexture>& evicted) {
+      s_texture_cache_size -= GetTextureMemorySize(evicted);
+    });
+  }
   PushResetLayout();
 }
 
@@ -2545,7 +2594,8 @@ void ImGuiFullscreen::DrawNotifications(ImVec2& position, float spacing)
     const ImVec2 badge_max(badge_min.x + badge_size, badge_min.y + badge_size);
     if (!notif.badge_path.empty())
     {
-      GPUTexture* tex = GetCachedTexture(notif.badge_path.c_str());
+      // Notifications pop up mid-game, decoding the badge right here would drop a frame.
+      GPUTexture* tex = GetCachedTextureAsync(notif.badge_path.c_str());
       if (tex)
       {
         dl->AddImage(tex, badge_min, badge_max, ImVec2(0.0f, 0.0f), ImVec2(1.0f, 1.0f),
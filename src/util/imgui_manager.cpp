@@ -13,6 +13,7 @@
 #include "common/image.h"
 #include "common/log.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 #include "common/timer.h"
 
 #include "IconsFontAwesome5.h"
@@ -25,6 +26,7 @@
 #include <cmath>
 #include <deque>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
 
 Log_SetChannel(ImGuiManager);
@@ -41,13 +43,30 @@ struct SoftwareCursor
   std::pair<float, float> pos;
 };
 
+struct FontAtlasBuild
+{
+  ImFontAtlas* atlas;
+  ImFont* standard_font;
+  ImFont* fixed_font;
+  ImFont* medium_font;
+  ImFont* large_font;
+};
+
 static void SetStyle();
 static void SetKeyMap();
 static bool LoadFontData();
-static bool AddImGuiFonts(bool fullscreen_fonts);
-static ImFont* AddTextFont(float size);
-static ImFont* AddFixedFont(float size);
-static bool AddIconFonts(float size);
+static bool AddImGuiFonts(bool fullscreen_fonts, bool full_text_range = true);
+static ImFont* AddTextFont(ImFontAtlas* atlas, float size, bool full_text_range);
+static ImFont* AddFixedFont(ImFontAtlas* atlas, float size);
+static bool AddIconFonts(ImFontAtlas* atlas, float size);
+static bool BuildFontAtlas(FontAtlasBuild* build, bool fullscreen_fonts, float standard_font_size,
+                           float medium_font_size, float large_font_size, bool full_text_range);
+static void InstallFontAtlas(FontAtlasBuild* build);
+static void GetFontSizes(bool fullscreen_fonts, float* standard_font_size, float* medium_font_size,
+                         float* large_font_size);
+static void StartFontAtlasBuild(bool fullscreen_fonts);
+static void FinishFontAtlasBuild();
+static void CancelFontAtlasBuild();
 static void AcquirePendingOSDMessages(Common::Timer::Value current_time);
 static void DrawOSDMessages(Common::Timer::Value current_time);
 static void CreateSoftwareCursorTextures();
@@ -71,6 +90,15 @@ static std::vector<u8> s_standard_font_data;
 static std::vector<u8> s_fixed_font_data;
 static std::vector<u8> s_icon_font_data;
 
+// Atlases for scale changes are built on a worker, and swapped in at the start of a frame once they're done. The
+// current atlas keeps being drawn with until then.
+static std::thread s_font_build_thread;
+static std::atomic_bool s_font_build_done{false};
+static bool s_font_build_result = false;
+static bool s_font_build_stale = false;
+static ImGuiManager::FontAtlasBuild s_font_build = {};
+static u32 s_font_generation = 0;
+
 static float s_window_width;
 static float s_window_height;
 static Common::Timer s_last_render_time;
@@ -106,12 +134,15 @@ static std::array<ImGuiManager::SoftwareCursor, InputManager::MAX_SOFTWARE_CURSO
 
 void ImGuiManager::SetFontPath(std::string path)
 {
+  // the worker reads the font data directly
+  CancelFontAtlasBuild();
   s_font_path = std::move(path);
   s_standard_font_data = {};
 }
 
 void ImGuiManager::SetFontRange(const u16* range)
 {
+  CancelFontAtlasBuild();
   s_font_range = range;
   s_standard_font_data = {};
 }
@@ -170,7 +201,9 @@ bool ImGuiManager::Initialize(float global_scale, bool show_osd_messages)
   SetKeyMap();
   SetStyle();
 
-  if (!AddImGuiFonts(false) || !g_gpu_device->UpdateImGuiFontTexture())
+  // Large ranges such as CJK take a while to rasterize, so start with only the default range, and build the full
+  // range in the background. Until it's done, characters outside the default range draw as the fallback glyph.
+  if (!AddImGuiFonts(false, !s_font_range) || !g_gpu_device->UpdateImGuiFontTexture())
   {
     Panic("Failed to create ImGui font text");
     ImGui::DestroyContext();
@@ -180,6 +213,9 @@ bool ImGuiManager::Initialize(float global_scale, bool show_osd_messages)
   // don't need the font data anymore, save some memory
   ImGui::GetIO().Fonts->ClearTexData();
 
+  if (s_font_range)
+    StartFontAtlasBuild(false);
+
   NewFrame();
 
   CreateSoftwareCursorTextures();
@@ -188,6 +224,7 @@ bool ImGuiManager::Initialize(float global_scale, bool show_osd_messages)
 
 void ImGuiManager::Shutdown()
 {
+  CancelFontAtlasBuild();
   DestroySoftwareCursorTextures();
 
   if (ImGui::GetCurrentContext())
@@ -242,11 +279,8 @@ void ImGuiManager::UpdateScale()
   SetStyle();
   ImGui::GetStyle().ScaleAllSizes(scale);
 
-  if (!AddImGuiFonts(HasFullscreenFonts()))
-    Panic("Failed to create ImGui font text");
-
-  if (!g_gpu_device->UpdateImGuiFontTexture())
-    Panic("Failed to recreate font texture after scale+resize");
+  // Rebuilding takes long enough to drop frames, so keep drawing with the old fonts until the new ones are ready.
+  StartFontAtlasBuild(HasFullscreenFonts());
 }
 
 void ImGuiManager::NewFrame()
@@ -260,6 +294,9 @@ void ImGuiManager::NewFrame()
     UpdateScale();
   }
 
+  if (s_font_build_done.load(std::memory_order_acquire))
+    FinishFontAtlasBuild();
+
   ImGui::NewFrame();
 
   // Disable nav input on the implicit (Debug##Default) window. Otherwise we end up requesting keyboard
@@ -487,7 +524,7 @@ bool ImGuiManager::LoadFontData()
   return true;
 }
 
-ImFont* ImGuiManager::AddTextFont(float size)
+ImFont* ImGuiManager::AddTextFont(ImFontAtlas* atlas, float size, bool full_text_range)
 {
   static const ImWchar default_ranges[] = {
     // Basic Latin + Latin Supplement + Central European diacritics
@@ -511,20 +548,19 @@ ImFont* ImGuiManager::AddTextFont(float size)
 
   ImFontConfig cfg;
   cfg.FontDataOwnedByAtlas = false;
-  return ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_standard_font_data.data(),
-                                                    static_cast<int>(s_standard_font_data.size()), size, &cfg,
-                                                    s_font_range ? s_font_range : default_ranges);
+  return atlas->AddFontFromMemoryTTF(s_standard_font_data.data(), static_cast<int>(s_standard_font_data.size()), size,
+                                     &cfg, (s_font_range && full_text_range) ? s_font_range : default_ranges);
 }
 
-ImFont* ImGuiManager::AddFixedFont(float size)
+ImFont* ImGuiManager::AddFixedFont(ImFontAtlas* atlas, float size)
 {
   ImFontConfig cfg;
   cfg.FontDataOwnedByAtlas = false;
-  return ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_fixed_font_data.data(),
-                                                    static_cast<int>(s_fixed_font_data.size()), size, &cfg, nullptr);
+  return atlas->AddFontFromMemoryTTF(s_fixed_font_data.data(), static_cast<int>(s_fixed_font_data.size()), size, &cfg,
+                                     nullptr);
 }
 
-bool ImGuiManager::AddIconFonts(float size)
+bool ImGuiManager::AddIconFonts(ImFontAtlas* atlas, float size)
 {
   static constexpr ImWchar range_fa[] = {
     0xf002, 0xf002, 0xf005, 0xf005, 0xf007, 0xf007, 0xf00c, 0xf00e, 0xf011, 0xf011, 0xf013, 0xf013, 0xf017, 0xf017,
@@ -548,46 +584,147 @@ bool ImGuiManager::AddIconFonts(float size)
   cfg.GlyphMaxAdvanceX = size;
   cfg.FontDataOwnedByAtlas = false;
 
-  return (ImGui::GetIO().Fonts->AddFontFromMemoryTTF(s_icon_font_data.data(), static_cast<int>(s_icon_font_data.size()),
-                                                     size * 0.75f, &cfg, range_fa) != nullptr);
+  return (atlas->AddFontFromMemoryTTF(s_icon_font_data.data(), static_cast<int>(s_icon_font_data.size()),
+                                      size * 0.75f, &cfg, range_fa) != nullptr);
 }
 
-bool ImGuiManager::AddImGuiFonts(bool fullscreen_fonts)
+void ImGuiManager::GetFontSizes(bool fullscreen_fonts, float* standard_font_size, float* medium_font_size,
+                                float* large_font_size)
 {
-  const float standard_font_size = std::ceil(15.0f * s_global_scale);
+  *standard_font_size = std::ceil(15.0f * s_global_scale);
+  *medium_font_size =
+    fullscreen_fonts ? std::ceil(ImGuiFullscreen::LayoutScale(ImGuiFullscreen::LAYOUT_MEDIUM_FONT_SIZE)) : 0.0f;
+  *large_font_size =
+    fullscreen_fonts ? std::ceil(ImGuiFullscreen::LayoutScale(ImGuiFullscreen::LAYOUT_LARGE_FONT_SIZE)) : 0.0f;
+}
 
-  ImGuiIO& io = ImGui::GetIO();
-  io.Fonts->Clear();
+bool ImGuiManager::BuildFontAtlas(FontAtlasBuild* build, bool fullscreen_fonts, float standard_font_size,
+                                  float medium_font_size, float large_font_size, bool full_text_range)
+{
+  // Doesn't touch the context, so this can run on any thread.
+  ImFontAtlas* atlas = IM_NEW(ImFontAtlas)();
+  *build = {};
+  build->atlas = atlas;
 
-  s_standard_font = AddTextFont(standard_font_size);
-  if (!s_standard_font || !AddIconFonts(standard_font_size))
+  build->standard_font = AddTextFont(atlas, standard_font_size, full_text_range);
+  if (!build->standard_font || !AddIconFonts(atlas, standard_font_size))
     return false;
 
-  s_fixed_font = AddFixedFont(standard_font_size);
-  if (!s_fixed_font)
+  build->fixed_font = AddFixedFont(atlas, standard_font_size);
+  if (!build->fixed_font)
     return false;
 
   if (fullscreen_fonts)
   {
-    const float medium_font_size = std::ceil(ImGuiFullscreen::LayoutScale(ImGuiFullscreen::LAYOUT_MEDIUM_FONT_SIZE));
-    s_medium_font = AddTextFont(medium_font_size);
-    if (!s_medium_font || !AddIconFonts(medium_font_size))
+    build->medium_font = AddTextFont(atlas, medium_font_size, full_text_range);
+    if (!build->medium_font || !AddIconFonts(atlas, medium_font_size))
       return false;
 
-    const float large_font_size = std::ceil(ImGuiFullscreen::LayoutScale(ImGuiFullscreen::LAYOUT_LARGE_FONT_SIZE));
-    s_large_font = AddTextFont(large_font_size);
-    if (!s_large_font || !AddIconFonts(large_font_size))
+    build->large_font = AddTextFont(atlas, large_font_size, full_text_range);
+    if (!build->large_font || !AddIconFonts(atlas, large_font_size))
       return false;
   }
-  else
+
+  // Rasterizes now, so the owning thread only has to upload it.
+  unsigned char* pixels;
+  int width, height;
+  atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+  return (pixels != nullptr);
+}
+
+void ImGuiManager::InstallFontAtlas(FontAtlasBuild* build)
+{
+  // The context owns its atlas, so the new one is deleted along with the context.
+  ImGuiIO& io = ImGui::GetIO();
+  IM_DELETE(io.Fonts);
+  io.Fonts = build->atlas;
+
+  s_standard_font = build->standard_font;
+  s_fixed_font = build->fixed_font;
+  s_medium_font = build->medium_font;
+  s_large_font = build->large_font;
+  ImGuiFullscreen::SetFonts(s_standard_font, s_medium_font, s_large_font);
+  s_font_generation++;
+  *build = {};
+}
+
+bool ImGuiManager::AddImGuiFonts(bool fullscreen_fonts, bool full_text_range)
+{
+  // Whatever is being built in the background is out of date now.
+  CancelFontAtlasBuild();
+
+  float standard_font_size, medium_font_size, large_font_size;
+  GetFontSizes(fullscreen_fonts, &standard_font_size, &medium_font_size, &large_font_size);
+
+  FontAtlasBuild build;
+  if (!BuildFontAtlas(&build, fullscreen_fonts, standard_font_size, medium_font_size, large_font_size,
+                      full_text_range))
   {
-    s_medium_font = nullptr;
-    s_large_font = nullptr;
+    IM_DELETE(build.atlas);
+    return false;
   }
 
-  ImGuiFullscreen::SetFonts(s_standard_font, s_medium_font, s_large_font);
+  InstallFontAtlas(&build);
+  return true;
+}
+
+void ImGuiManager::StartFontAtlasBuild(bool fullscreen_fonts)
+{
+  // If a build is already running, it was started with the old scale, so do it again when it's done.
+  if (s_font_build_thread.joinable())
+  {
+    s_font_build_stale = true;
+    return;
+  }
 
-  return io.Fonts->Build();
+  float standard_font_size, medium_font_size, large_font_size;
+  GetFontSizes(fullscreen_fonts, &standard_font_size, &medium_font_size, &large_font_size);
+
+  s_font_build_done.store(false, std::memory_order_relaxed);
+  s_font_build_stale = false;
+  s_font_build_thread = std::thread([fullscreen_fonts, standard_font_size, medium_font_size, large_font_size]() {
+    Threading::SetNameOfCurrentThread("ImGui Font Builder");
+    s_font_build_result =
+      BuildFontAtlas(&s_font_build, fullscreen_fonts, standard_font_size, medium_font_size, large_font_size, true);
+    s_font_build_done.store(true, std::memory_order_release);
+  });
+}
+
+void ImGuiManager::FinishFontAtlasBuild()
+{
+  s_font_build_thread.join();
+  s_font_build_done.store(false, std::memory_order_relaxed);
+
+  // Fullscreen fonts could have been added or dropped since the build started, which restarts it as well.
+  const bool fullscreen_fonts = HasFullscreenFonts();
+  if (s_font_build_stale || !s_font_build_result || (s_font_build.medium_font != nullptr) != fullscreen_fonts)
+  {
+    if (!s_font_build_result)
+      Log_ErrorPrint("Failed to build font atlas in the background.");
+
+    IM_DELETE(s_font_build.atlas);
+    s_font_build = {};
+    if (s_font_build_result)
+      StartFontAtlasBuild(fullscreen_fonts);
+
+    return;
+  }
+
+  InstallFontAtlas(&s_font_build);
+  if (!g_gpu_device->UpdateImGuiFontTexture())
+    Panic("Failed to recreate font texture after scale+resize");
+}
+
+void ImGuiManager::CancelFontAtlasBuild()
+{
+  if (!s_font_build_thread.joinable())
+    return;
+
+  s_font_build_thread.join();
+  s_font_build_done.store(false, std::memory_order_relaxed);
+  s_font_build_stale = false;
+  IM_DELETE(s_font_build.atlas);
+  s_font_build = {};
 }
 
 bool ImGuiManager::AddFullscreenFontsIfMissing()
@@ -838,6 +975,11 @@ ImFont* ImGuiManager::GetFixedFont()
   return s_fixed_font;
 }
 
+u32 ImGuiManager::GetFontGeneration()
+{
+  return s_font_generation;
+}
+
 ImFont* ImGuiManager::GetMediumFont()
 {
   AddFullscreenFontsIfMissing();
@@ -981,8 +1123,9 @@ void ImGuiManager::UpdateSoftwareCursorTexture(u32 index)
     Log_ErrorPrintf("Failed to load software cursor %u image '%s'", index, sc.image_path.c_str());
     return;
   }
-  sc.texture = g_gpu_device->CreateTexture(image.GetWidth(), image.GetHeight(), 1, 1, 1, GPUTexture::Type::Texture,
-                                           GPUTexture::Format::RGBA8, image.GetPixels(), image.GetPitch());
+  g_gpu_device->RecycleTexture(std::move(sc.texture));
+  sc.texture = g_gpu_device->FetchTexture(image.GetWidth(), image.GetHeight(), 1, 1, 1, GPUTexture::Type::Texture,
+                                          GPUTexture::Format::RGBA8, image.GetPixels(), image.GetPitch());
   if (!sc.texture)
   {
     Log_ErrorPrintf("Failed to upload %ux%u software cursor %u image '%s'", image.GetWidth(), image.GetHeight(), index,
@@ -61,6 +61,9 @@ ImFont* GetStandardFont();
 /// Returns the fixed-width font for external drawing.
 ImFont* GetFixedFont();
 
+/// Incremented whenever the font atlas is replaced, which invalidates any geometry built with the old fonts.
+u32 GetFontGeneration();
+
 /// Returns the medium font for external drawing, scaled by ImGuiFullscreen.
 /// This font is allocated on demand.
 ImFont* GetMediumFont();
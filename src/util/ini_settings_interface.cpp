@@ -61,6 +61,7 @@ bool INISettingsInterface::Load()
   if (fp)
     err = m_ini.LoadFile(fp.get());
 
+  m_change_counter++;
   return (err == SI_OK);
 }
 
@@ -104,6 +105,7 @@ bool INISettingsInterface::Save()
 void INISettingsInterface::Clear()
 {
   m_ini.Reset();
+  m_change_counter++;
 }
 
 bool INISettingsInterface::GetIntValue(const char* section, const char* key, s32* value) const
@@ -189,36 +191,42 @@ bool INISettingsInterface::GetStringValue(const char* section, const char* key,
 void INISettingsInterface::SetIntValue(const char* section, const char* key, s32 value)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetValue(section, key, StringUtil::ToChars(value).c_str(), nullptr, true);
 }
 
 void INISettingsInterface::SetUIntValue(const char* section, const char* key, u32 value)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetValue(section, key, StringUtil::ToChars(value).c_str(), nullptr, true);
 }
 
 void INISettingsInterface::SetFloatValue(const char* section, const char* key, float value)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetValue(section, key, StringUtil::ToChars(value).c_str(), nullptr, true);
 }
 
 void INISettingsInterface::SetDoubleValue(const char* section, const char* key, double value)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetValue(section, key, StringUtil::ToChars(value).c_str(), nullptr, true);
 }
 
 void INISettingsInterface::SetBoolValue(const char* section, const char* key, bool value)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetBoolValue(section, key, value, nullptr, true);
 }
 
 void INISettingsInterface::SetStringValue(const char* section, const char* key, const char* value)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetValue(section, key, value, nullptr, true);
 }
 
@@ -230,12 +238,14 @@ bool INISettingsInterface::ContainsValue(const char* section, const char* key) c
 void INISettingsInterface::DeleteValue(const char* section, const char* key)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.Delete(section, key);
 }
 
 void INISettingsInterface::ClearSection(const char* section)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.Delete(section, nullptr);
   m_ini.SetValue(section, nullptr, nullptr);
 }
@@ -256,6 +266,7 @@ std::vector<std::string> INISettingsInterface::GetStringList(const char* section
 void INISettingsInterface::SetStringList(const char* section, const char* key, const std::vector<std::string>& items)
 {
   m_dirty = true;
+  m_change_counter++;
   m_ini.Delete(section, key);
 
   for (const std::string& sv : items)
@@ -265,6 +276,7 @@ void INISettingsInterface::SetStringList(const char* section, const char* key, c
 bool INISettingsInterface::RemoveFromStringList(const char* section, const char* key, const char* item)
 {
   m_dirty = true;
+  m_change_counter++;
   return m_ini.DeleteValue(section, key, item, true);
 }
 
@@ -279,6 +291,7 @@ bool INISettingsInterface::AddToStringList(const char* section, const char* key,
   }
 
   m_dirty = true;
+  m_change_counter++;
   m_ini.SetValue(section, key, item, nullptr, false);
   return true;
 }
@@ -315,6 +328,7 @@ std::vector<std::pair<std::string, std::string>> INISettingsInterface::GetKeyVal
 void INISettingsInterface::SetKeyValueList(const char* section,
                                            const std::vector<std::pair<std::string, std::string>>& items)
 {
+  m_change_counter++;
   m_ini.Delete(section, nullptr);
   for (const std::pair<std::string, std::string>& item : items)
     m_ini.SetValue(section, item.first.c_str(), item.second.c_str(), nullptr, false);
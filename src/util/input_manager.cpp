@@ -10,6 +10,8 @@
 #include "common/timer.h"
 #include "core/controller.h"
 #include "core/host.h"
+#include "core/input_movie.h"
+#include "core/netplay.h"
 #include "core/system.h"
 #include "imgui_manager.h"
 #include "input_source.h"
@@ -20,6 +22,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <span>
 #include <sstream>
 #include <unordered_map>
 #include <variant>
@@ -88,6 +91,27 @@ struct MacroButton
   bool trigger_state;       ///< Whether the macro button is active.
 };
 
+// ------------------------------------------------------------------------
+// Dispatch Table
+// ------------------------------------------------------------------------
+// Flattened copy of the binding map, rebuilt when bindings change. Events
+// look up their key in an open-addressed hash table, which points to a
+// contiguous run of entries, one per binding using the key.
+
+struct DispatchEntry
+{
+  InputBinding* binding;
+  u8 key_index; ///< Which key of the chord this is.
+  bool is_axis;
+};
+
+struct DispatchSlot
+{
+  u64 key_bits = 0;
+  u32 first_entry = 0;
+  u32 num_entries = 0; ///< Zero for empty slots.
+};
+
 // ------------------------------------------------------------------------
 // Forward Declarations (for static qualifier)
 // ------------------------------------------------------------------------
@@ -114,6 +138,12 @@ static void GenerateRelativeMouseEvents();
 static bool DoEventHook(InputBindingKey key, float value);
 static bool PreprocessEvent(InputBindingKey key, float value, GenericInputBinding generic_key);
 static bool ProcessEvent(InputBindingKey key, float value, bool skip_button_handlers);
+static void CompileBindings();
+static u32 GetDispatchSlotIndex(u64 key_bits);
+static std::span<const DispatchEntry> GetDispatchEntries(InputBindingKey masked_key);
+static void ProcessAxisEvent(InputBindingKey key, float value);
+static float GetBindingValue(const InputBindingKey& binding_key, float value);
+static void InvokeDeferredEvents();
 
 static void LoadMacroButtonConfig(SettingsInterface& si, const std::string& section, u32 pad,
                                   const Controller::ControllerInfo* cinfo);
@@ -135,6 +165,11 @@ static BindingMap s_binding_map;
 static VibrationBindingArray s_pad_vibration_array;
 static std::mutex s_binding_map_write_lock;
 
+static std::vector<DispatchSlot> s_dispatch_slots;
+static std::vector<DispatchEntry> s_dispatch_entries;
+static u32 s_dispatch_shift = 64;
+static bool s_dispatch_table_dirty = true;
+
 // Hooks/intercepting (for setting bindings)
 static std::mutex m_event_intercept_mutex;
 static InputInterceptHook::Callback m_event_intercept_callback;
@@ -142,6 +177,19 @@ static InputInterceptHook::Callback m_event_intercept_callback;
 // Input sources. Keyboard/mouse don't exist here.
 static std::array<std::unique_ptr<InputSource>, static_cast<u32>(InputSourceType::Count)> s_input_sources;
 
+// Events from polls part way through a frame, which are fully processed at the end of the frame.
+namespace {
+struct DeferredEvent
+{
+  InputBindingKey key;
+  float value;
+  GenericInputBinding generic_key;
+};
+} // namespace
+static std::vector<DeferredEvent> s_deferred_events;
+static bool s_deferring_events = false;
+static Common::Timer::Value s_last_poll_time = 0;
+
 // Macro buttons.
 static std::array<std::array<MacroButton, InputManager::NUM_MACRO_BUTTONS_PER_CONTROLLER>,
                   NUM_CONTROLLER_AND_CARD_PORTS>
@@ -409,6 +457,7 @@ void InputManager::AddBinding(const std::string_view& binding, const InputEventH
   // plop it in the input map for all the keys
   for (u32 i = 0; i < ibinding->num_keys; i++)
     s_binding_map.emplace(ibinding->keys[i].MaskDirection(), ibinding);
+  s_dispatch_table_dirty = true;
 }
 
 void InputManager::AddVibrationBinding(u32 pad_index, const InputBindingKey* motor_0_binding,
@@ -712,7 +761,8 @@ void InputManager::AddPadBindings(SettingsInterface& si, const std::string& sect
         if (!bindings.empty())
         {
           AddBindings(bindings, InputAxisEventHandler{[pad_index, bind_index = bi.bind_index](float value) {
-                        if (!System::IsValid())
+                        if (!System::IsValid() || Netplay::SetLocalBindState(pad_index, bind_index, value) ||
+                            InputMovie::SetBindState(pad_index, bind_index, value))
                           return;
 
                         Controller* c = System::GetController(pad_index);
@@ -840,6 +890,17 @@ bool InputManager::IsAxisHandler(const InputEventHandler& handler)
 
 bool InputManager::InvokeEvents(InputBindingKey key, float value, GenericInputBinding generic_key)
 {
+  // Part way through a frame, only controller state can change. Everything else, e.g. hotkeys which load states,
+  // waits until the end of the frame.
+  if (s_deferring_events) [[unlikely]]
+  {
+    s_deferred_events.push_back(DeferredEvent{key, value, generic_key});
+    if (!HasHook())
+      ProcessAxisEvent(key, value);
+
+    return true;
+  }
+
   if (DoEventHook(key, value))
     return true;
 
@@ -848,118 +909,207 @@ bool InputManager::InvokeEvents(InputBindingKey key, float value, GenericInputBi
   return ProcessEvent(key, value, skip_button_handlers);
 }
 
+void InputManager::CompileBindings()
+{
+  // One entry per key of each binding, grouped by key.
+  std::vector<std::pair<u64, DispatchEntry>> pairs;
+  pairs.reserve(s_binding_map.size());
+  for (const auto& [key, binding] : s_binding_map)
+  {
+    for (u32 i = 0; i < binding->num_keys; i++)
+    {
+      // we shouldn't have the same key twice in the chord
+      if (binding->keys[i].MaskDirection() == key)
+      {
+        pairs.emplace_back(key.bits, DispatchEntry{binding.get(), static_cast<u8>(i), IsAxisHandler(binding->handler)});
+        break;
+      }
+    }
+  }
+  std::stable_sort(pairs.begin(), pairs.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+  u32 num_keys = 0;
+  for (size_t i = 0; i < pairs.size(); i++)
+    num_keys += static_cast<u32>(i == 0 || pairs[i].first != pairs[i - 1].first);
+
+  // Keep the table at most half full, so probes stay short and always reach an empty slot.
+  s_dispatch_shift = 64;
+  u32 num_slots = 1;
+  while (num_slots < (num_keys * 2))
+  {
+    num_slots *= 2;
+    s_dispatch_shift--;
+  }
+
+  s_dispatch_entries.clear();
+  s_dispatch_entries.reserve(pairs.size());
+  s_dispatch_slots.assign(num_slots, DispatchSlot{});
+  for (size_t i = 0; i < pairs.size();)
+  {
+    const u64 key_bits = pairs[i].first;
+    const u32 first_entry = static_cast<u32>(s_dispatch_entries.size());
+    for (; i < pairs.size() && pairs[i].first == key_bits; i++)
+      s_dispatch_entries.push_back(pairs[i].second);
+
+    u32 pos = GetDispatchSlotIndex(key_bits);
+    while (s_dispatch_slots[pos].num_entries != 0)
+      pos = (pos + 1) & (num_slots - 1);
+
+    const u32 num_entries = static_cast<u32>(s_dispatch_entries.size()) - first_entry;
+    s_dispatch_slots[pos] = DispatchSlot{key_bits, first_entry, num_entries};
+  }
+
+  s_dispatch_table_dirty = false;
+}
+
+u32 InputManager::GetDispatchSlotIndex(u64 key_bits)
+{
+  // Fibonacci hashing, the top bits are the best mixed.
+  return (s_dispatch_shift == 64) ? 0 : static_cast<u32>((key_bits * 0x9E3779B97F4A7C15ULL) >> s_dispatch_shift);
+}
+
+std::span<const DispatchEntry> InputManager::GetDispatchEntries(InputBindingKey masked_key)
+{
+  if (s_dispatch_table_dirty) [[unlikely]]
+    CompileBindings();
+
+  const u32 mask = static_cast<u32>(s_dispatch_slots.size()) - 1;
+  for (u32 pos = GetDispatchSlotIndex(masked_key.bits);; pos = (pos + 1) & mask)
+  {
+    const DispatchSlot& slot = s_dispatch_slots[pos];
+    if (slot.num_entries == 0)
+      return {};
+    else if (slot.key_bits == masked_key.bits)
+      return std::span<const DispatchEntry>(&s_dispatch_entries[slot.first_entry], slot.num_entries);
+  }
+}
+
 bool InputManager::ProcessEvent(InputBindingKey key, float value, bool skip_button_handlers)
 {
   // find all the bindings associated with this key
   const InputBindingKey masked_key = key.MaskDirection();
-  const auto range = s_binding_map.equal_range(masked_key);
-  if (range.first == s_binding_map.end())
+  const std::span<const DispatchEntry> entries = GetDispatchEntries(masked_key);
+  if (entries.empty())
     return false;
 
   // Now we can actually fire/activate bindings.
   u32 min_num_keys = 0;
-  for (auto it = range.first; it != range.second; ++it)
+  for (const DispatchEntry& entry : entries)
   {
-    InputBinding* binding = it->second.get();
-
-    // find the key which matches us
-    for (u32 i = 0; i < binding->num_keys; i++)
-    {
-      if (binding->keys[i].MaskDirection() != masked_key)
-        continue;
-
-      const u8 bit = static_cast<u8>(1) << i;
-      const bool negative = binding->keys[i].modifier == InputModifier::Negate;
-      const bool new_state = (negative ? (value < 0.0f) : (value > 0.0f));
-
-      float value_to_pass = 0.0f;
-      switch (binding->keys[i].modifier)
-      {
-        case InputModifier::None:
-          if (value > 0.0f)
-            value_to_pass = value;
-          break;
-        case InputModifier::Negate:
-          if (value < 0.0f)
-            value_to_pass = -value;
-          break;
-        case InputModifier::FullAxis:
-          value_to_pass = value * 0.5f + 0.5f;
-          break;
-      }
+    InputBinding* binding = entry.binding;
+    const u32 i = entry.key_index;
 
-      // handle inverting, needed for some wheels.
-      value_to_pass = binding->keys[i].invert ? (1.0f - value_to_pass) : value_to_pass;
+    const u8 bit = static_cast<u8>(1) << i;
+    const bool negative = binding->keys[i].modifier == InputModifier::Negate;
+    const bool new_state = (negative ? (value < 0.0f) : (value > 0.0f));
+    const float value_to_pass = GetBindingValue(binding->keys[i], value);
 
-      // axes are fired regardless of a state change, unless they're zero
-      // (but going from not-zero to zero will still fire, because of the full state)
-      // for buttons, we can use the state of the last chord key, because it'll be 1 on press,
-      // and 0 on release (when the full state changes).
-      if (IsAxisHandler(binding->handler))
-      {
-        if (value_to_pass >= 0.0f)
-          std::get<InputAxisEventHandler>(binding->handler)(value_to_pass);
-      }
-      else if (binding->num_keys >= min_num_keys)
+    // axes are fired regardless of a state change, unless they're zero
+    // (but going from not-zero to zero will still fire, because of the full state)
+    // for buttons, we can use the state of the last chord key, because it'll be 1 on press,
+    // and 0 on release (when the full state changes).
+    if (entry.is_axis)
+    {
+      if (value_to_pass >= 0.0f)
+        std::get<InputAxisEventHandler>(binding->handler)(value_to_pass);
+    }
+    else if (binding->num_keys >= min_num_keys)
+    {
+      // update state based on whether the whole chord was activated
+      const u8 new_mask = (new_state ? (binding->current_mask | bit) : (binding->current_mask & ~bit));
+      const bool prev_full_state = (binding->current_mask == binding->full_mask);
+      const bool new_full_state = (new_mask == binding->full_mask);
+      binding->current_mask = new_mask;
+
+      // Workaround for multi-key bindings that share the same keys.
+      if (binding->num_keys > 1 && new_full_state && prev_full_state != new_full_state)
       {
-        // update state based on whether the whole chord was activated
-        const u8 new_mask = (new_state ? (binding->current_mask | bit) : (binding->current_mask & ~bit));
-        const bool prev_full_state = (binding->current_mask == binding->full_mask);
-        const bool new_full_state = (new_mask == binding->full_mask);
-        binding->current_mask = new_mask;
-
-        // Workaround for multi-key bindings that share the same keys.
-        if (binding->num_keys > 1 && new_full_state && prev_full_state != new_full_state && range.first != range.second)
+        // Because the binding map isn't ordered, we could iterate in the order of Shift+F1 and then
+        // F1, which would mean that F1 wouldn't get cancelled and still activate. So, to handle this
+        // case, we skip activating any future bindings with a fewer number of keys.
+        min_num_keys = std::max<u32>(min_num_keys, binding->num_keys);
+
+        // Basically, if we bind say, F1 and Shift+F1, and press shift and then F1, we'll fire bindings
+        // for both F1 and Shift+F1, when we really only want to fire the binding for Shift+F1. So,
+        // when we activate a multi-key chord (key press), we go through the binding map for all the
+        // other keys in the chord, and cancel them if they have a shorter chord. If they're longer,
+        // they could still activate and take precedence over us, so we leave them alone.
+        for (u32 j = 0; j < binding->num_keys; j++)
         {
-          // Because the binding map isn't ordered, we could iterate in the order of Shift+F1 and then
-          // F1, which would mean that F1 wouldn't get cancelled and still activate. So, to handle this
-          // case, we skip activating any future bindings with a fewer number of keys.
-          min_num_keys = std::max<u32>(min_num_keys, binding->num_keys);
-
-          // Basically, if we bind say, F1 and Shift+F1, and press shift and then F1, we'll fire bindings
-          // for both F1 and Shift+F1, when we really only want to fire the binding for Shift+F1. So,
-          // when we activate a multi-key chord (key press), we go through the binding map for all the
-          // other keys in the chord, and cancel them if they have a shorter chord. If they're longer,
-          // they could still activate and take precedence over us, so we leave them alone.
-          for (u32 j = 0; j < binding->num_keys; j++)
+          for (const DispatchEntry& other_entry : GetDispatchEntries(binding->keys[j].MaskDirection()))
           {
-            const auto range2 = s_binding_map.equal_range(binding->keys[j].MaskDirection());
-            for (auto it2 = range2.first; it2 != range2.second; ++it2)
-            {
-              InputBinding* other_binding = it2->second.get();
-              if (other_binding == binding || IsAxisHandler(other_binding->handler) ||
-                  other_binding->num_keys >= binding->num_keys)
-              {
-                continue;
-              }
-
-              // We only need to cancel the binding if it was fully active before. Which in the above
-              // case of Shift+F1 / F1, it will be.
-              if (other_binding->current_mask == other_binding->full_mask)
-                std::get<InputButtonEventHandler>(other_binding->handler)(-1);
-
-              // Zero out the current bits so that we don't release this binding, if the other part
-              // of the chord releases first.
-              other_binding->current_mask = 0;
-            }
-          }
-        }
+            InputBinding* other_binding = other_entry.binding;
+            if (other_binding == binding || other_entry.is_axis || other_binding->num_keys >= binding->num_keys)
+              continue;
 
-        if (prev_full_state != new_full_state && binding->num_keys >= min_num_keys)
-        {
-          const s32 pressed = skip_button_handlers ? -1 : static_cast<s32>(value_to_pass > 0.0f);
-          std::get<InputButtonEventHandler>(binding->handler)(pressed);
+            // We only need to cancel the binding if it was fully active before. Which in the above
+            // case of Shift+F1 / F1, it will be.
+            if (other_binding->current_mask == other_binding->full_mask)
+              std::get<InputButtonEventHandler>(other_binding->handler)(-1);
+
+            // Zero out the current bits so that we don't release this binding, if the other part
+            // of the chord releases first.
+            other_binding->current_mask = 0;
+          }
         }
       }
 
-      // bail out, since we shouldn't have the same key twice in the chord
-      break;
+      if (prev_full_state != new_full_state && binding->num_keys >= min_num_keys)
+      {
+        const s32 pressed = skip_button_handlers ? -1 : static_cast<s32>(value_to_pass > 0.0f);
+        std::get<InputButtonEventHandler>(binding->handler)(pressed);
+      }
     }
   }
 
   return true;
 }
 
+float InputManager::GetBindingValue(const InputBindingKey& binding_key, float value)
+{
+  float value_to_pass = 0.0f;
+  switch (binding_key.modifier)
+  {
+    case InputModifier::None:
+      if (value > 0.0f)
+        value_to_pass = value;
+      break;
+    case InputModifier::Negate:
+      if (value < 0.0f)
+        value_to_pass = -value;
+      break;
+    case InputModifier::FullAxis:
+      value_to_pass = value * 0.5f + 0.5f;
+      break;
+  }
+
+  // handle inverting, needed for some wheels.
+  return binding_key.invert ? (1.0f - value_to_pass) : value_to_pass;
+}
+
+void InputManager::ProcessAxisEvent(InputBindingKey key, float value)
+{
+  // Axis handlers don't track chord state, so firing them again when the event is replayed is harmless.
+  for (const DispatchEntry& entry : GetDispatchEntries(key.MaskDirection()))
+  {
+    if (!entry.is_axis)
+      continue;
+
+    const float value_to_pass = GetBindingValue(entry.binding->keys[entry.key_index], value);
+    if (value_to_pass >= 0.0f)
+      std::get<InputAxisEventHandler>(entry.binding->handler)(value_to_pass);
+  }
+}
+
+void InputManager::InvokeDeferredEvents()
+{
+  // Handlers can reload bindings or poll again, so take the list first.
+  std::vector<DeferredEvent> events;
+  events.swap(s_deferred_events);
+  for (const DeferredEvent& event : events)
+    InvokeEvents(event.key, event.value, event.generic_key);
+}
+
 void InputManager::ClearBindStateFromSource(InputBindingKey key)
 {
   // Why are we doing it this way? Because any of the bindings could cause a reload and invalidate our iterators :(.
@@ -1535,7 +1685,10 @@ void InputManager::ApplyMacroButton(u32 pad, const MacroButton& mb)
 
   const float value = mb.toggle_state ? 1.0f : 0.0f;
   for (const u32 btn : mb.buttons)
-    controller->SetBindState(btn, value);
+  {
+    if (!Netplay::SetLocalBindState(pad, btn, value) && !InputMovie::SetBindState(pad, btn, value))
+      controller->SetBindState(btn, value);
+  }
 }
 
 void InputManager::UpdateMacroButtons()
@@ -1608,6 +1761,7 @@ void InputManager::ReloadBindings(SettingsInterface& si, SettingsInterface& bind
   std::unique_lock lock(s_binding_map_write_lock);
 
   s_binding_map.clear();
+  s_dispatch_table_dirty = true;
   s_pad_vibration_array.clear();
   s_pointer_move_callbacks.clear();
 
@@ -1832,12 +1986,17 @@ void InputManager::CloseSources()
 
 void InputManager::PollSources()
 {
+  if (!s_deferred_events.empty())
+    InvokeDeferredEvents();
+
   for (u32 i = FIRST_EXTERNAL_INPUT_SOURCE; i < LAST_EXTERNAL_INPUT_SOURCE; i++)
   {
     if (s_input_sources[i])
       s_input_sources[i]->PollEvents();
   }
 
+  s_last_poll_time = Common::Timer::GetCurrentValue();
+
   GenerateRelativeMouseEvents();
 
   if (System::GetState() == System::State::Running)
@@ -1848,6 +2007,25 @@ void InputManager::PollSources()
   }
 }
 
+void InputManager::PollSourcesForPadTransfer()
+{
+  const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+  if (s_deferring_events ||
+      Common::Timer::ConvertValueToMilliseconds(current_time - s_last_poll_time) < MIN_PAD_TRANSFER_POLL_INTERVAL_MS)
+  {
+    return;
+  }
+
+  s_last_poll_time = current_time;
+  s_deferring_events = true;
+  for (u32 i = FIRST_EXTERNAL_INPUT_SOURCE; i < LAST_EXTERNAL_INPUT_SOURCE; i++)
+  {
+    if (s_input_sources[i])
+      s_input_sources[i]->PollEvents();
+  }
+  s_deferring_events = false;
+}
+
 std::vector<std::pair<std::string, std::string>> InputManager::EnumerateDevices()
 {
   std::vector<std::pair<std::string, std::string>> ret;
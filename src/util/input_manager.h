@@ -172,6 +172,9 @@ namespace InputManager {
 /// Minimum interval between vibration updates when the effect is continuous.
 static constexpr double VIBRATION_UPDATE_INTERVAL_SECONDS = 0.5; // 500ms
 
+/// Minimum time between polls when polling for controller reads, i.e. at most 1kHz.
+static constexpr double MIN_PAD_TRANSFER_POLL_INTERVAL_MS = 1.0;
+
 /// Maximum number of host mouse devices.
 static constexpr u32 MAX_POINTER_DEVICES = 1;
 static constexpr u32 MAX_POINTER_BUTTONS = 3;
@@ -264,6 +267,10 @@ void CloseSources();
 /// Polls input sources for events (e.g. external controllers).
 void PollSources();
 
+/// Polls input sources just before the game reads a controller. Only controller bindings are updated, the events are
+/// fully processed by the next PollSources(). Does nothing if sources were polled within the last millisecond.
+void PollSourcesForPadTransfer();
+
 /// Returns true if any bindings exist for the specified key.
 /// Can be safely called on another thread.
 bool HasAnyBindingsForKey(InputBindingKey key);
@@ -7,18 +7,6 @@
 #include <cctype>
 Log_SetChannel(ISOReader);
 
-static bool FilenamesEqual(const char* a, const char* b, u32 length)
-{
-  u32 pos = 0;
-  for (; pos < length && *a != '\0' && *b != '\0'; pos++)
-  {
-    if (std::tolower(*(a++)) != std::tolower(*(b++)))
-      return false;
-  }
-
-  return true;
-}
-
 ISOReader::ISOReader() = default;
 
 ISOReader::~ISOReader() = default;
@@ -63,8 +51,6 @@ bool ISOReader::ReadPVD()
 
 std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* path)
 {
-  u8 sector_buffer[SECTOR_SIZE];
-
   const ISODirectoryEntry* root_de = reinterpret_cast<const ISODirectoryEntry*>(m_pvd.root_directory_entry);
   if (*path == '\0' || std::strcmp(path, "/") == 0)
   {
@@ -73,47 +59,82 @@ std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* pa
   }
 
   // start at the root directory
-  return LocateFile(path, sector_buffer, root_de->location_le, root_de->length_le);
-}
-
-std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* path, u8* sector_buffer,
-                                                                  u32 directory_record_lba, u32 directory_record_size)
-{
-  if (directory_record_size == 0)
+  std::string current_path;
+  ISODirectoryEntry current_de = *root_de;
+  const char* path_component_start = path;
+  for (;;)
   {
-    Log_ErrorPrintf("Directory entry record size 0 while looking for '%s'", path);
-    return std::nullopt;
+    // strip any leading slashes
+    while (*path_component_start == '/' || *path_component_start == '\\')
+      path_component_start++;
+
+    const char* path_component_end = path_component_start;
+    while (*path_component_end != '\0' && *path_component_end != '/' && *path_component_end != '\\')
+      path_component_end++;
+
+    if (!(current_de.flags & ISODirectoryEntryFlag_Directory) && !current_path.empty())
+    {
+      // we're looking for a directory but got a file
+      Log_ErrorPrintf("Looking for directory but got file");
+      return std::nullopt;
+    }
+
+    if (!IndexDirectory(current_path, current_de.location_le, current_de.length_le))
+      return std::nullopt;
+
+    if (!current_path.empty())
+      current_path.push_back('/');
+    for (const char* ch = path_component_start; ch != path_component_end; ch++)
+      current_path.push_back(static_cast<char>(std::tolower(*ch)));
+
+    const auto iter = m_directory_index.find(current_path);
+    if (iter == m_directory_index.end())
+    {
+      std::string temp(path_component_start, path_component_end - path_component_start);
+      Log_ErrorPrintf("Path component '%s' not found", temp.c_str());
+      return std::nullopt;
+    }
+
+    // found it. is this the file we're looking for?
+    current_de = iter->second;
+    path_component_start = path_component_end;
+    while (*path_component_start == '/' || *path_component_start == '\\')
+      path_component_start++;
+    if (*path_component_start == '\0')
+      return current_de;
   }
+}
 
-  // strip any leading slashes
-  const char* path_component_start = path;
-  while (*path_component_start == '/' || *path_component_start == '\\')
-    path_component_start++;
+bool ISOReader::IndexDirectory(const std::string& path, u32 directory_record_lba, u32 directory_record_size)
+{
+  if (m_indexed_directories.contains(path))
+    return true;
 
-  u32 path_component_length = 0;
-  const char* path_component_end = path_component_start;
-  while (*path_component_end != '\0' && *path_component_end != '/' && *path_component_end != '\\')
+  if (directory_record_size == 0)
   {
-    path_component_length++;
-    path_component_end++;
+    Log_ErrorPrintf("Directory entry record size 0 for '%s'", path.c_str());
+    return false;
   }
 
-  // start reading directory entries
+  // read the whole directory in one request, rather than a sector at a time
   const u32 num_sectors = (directory_record_size + (SECTOR_SIZE - 1)) / SECTOR_SIZE;
   if (!m_image->Seek(m_track_number, directory_record_lba))
   {
     Log_ErrorPrintf("Seek to LBA %u failed", directory_record_lba);
-    return std::nullopt;
+    return false;
   }
 
-  for (u32 i = 0; i < num_sectors; i++)
+  std::vector<u8> buffer(num_sectors * static_cast<size_t>(SECTOR_SIZE));
+  if (m_image->Read(CDImage::ReadMode::DataOnly, num_sectors, buffer.data()) != num_sectors)
   {
-    if (m_image->Read(CDImage::ReadMode::DataOnly, 1, sector_buffer) != 1)
-    {
-      Log_ErrorPrintf("Failed to read LBA %u", directory_record_lba + i);
-      return std::nullopt;
-    }
+    Log_ErrorPrintf("Failed to read LBA %u", directory_record_lba);
+    return false;
+  }
 
+  std::string entry_path;
+  for (u32 i = 0; i < num_sectors; i++)
+  {
+    const u8* sector_buffer = &buffer[i * SECTOR_SIZE];
     u32 sector_offset = 0;
     while ((sector_offset + sizeof(ISODirectoryEntry)) < SECTOR_SIZE)
     {
@@ -132,49 +153,46 @@ std::optional<ISOReader::ISODirectoryEntry> ISOReader::LocateFile(const char* pa
       if (de->filename_length == 1 && (*de_filename == '\x0' || *de_filename == '\x1'))
         continue;
 
-      // check filename length
-      if (de->filename_length < path_component_length)
+      // strip off terminator/file version, directories don't have one
+      std::string_view filename(de_filename, de->filename_length);
+      const std::string_view::size_type pos = filename.rfind(';');
+      if (pos != std::string_view::npos)
+        filename = filename.substr(0, pos);
+      else if (!(de->flags & ISODirectoryEntryFlag_Directory))
         continue;
 
-      if (de->flags & ISODirectoryEntryFlag_Directory)
-      {
-        // directories don't have the version? so check the length instead
-        if (de->filename_length != path_component_length ||
-            !FilenamesEqual(de_filename, path_component_start, path_component_length))
-        {
-          continue;
-        }
-      }
-      else
-      {
-        // compare filename
-        if (!FilenamesEqual(de_filename, path_component_start, path_component_length) ||
-            de_filename[path_component_length] != ';')
-        {
-          continue;
-        }
-      }
-
-      // found it. is this the file we're looking for?
-      if (*path_component_end == '\0')
-        return *de;
+      if (filename.empty())
+        continue;
 
-      // if it is a directory, recurse into it
-      if (de->flags & ISODirectoryEntryFlag_Directory)
-        return LocateFile(path_component_end, sector_buffer, de->location_le, de->length_le);
+      entry_path = path;
+      if (!entry_path.empty())
+        entry_path.push_back('/');
+      for (const char ch : filename)
+        entry_path.push_back(static_cast<char>(std::tolower(ch)));
 
-      // we're looking for a directory but got a file
-      Log_ErrorPrintf("Looking for directory but got file");
-      return std::nullopt;
+      // first entry wins, like a linear search would
+      m_directory_index.emplace(entry_path, *de);
     }
   }
 
-  std::string temp(path_component_start, path_component_length);
-  Log_ErrorPrintf("Path component '%s' not found", temp.c_str());
-  return std::nullopt;
+  m_indexed_directories.insert(path);
+  return true;
 }
 
 std::vector<std::string> ISOReader::GetFilesInDirectory(const char* path)
+{
+  std::vector<std::pair<std::string, ISODirectoryEntry>> entries = GetEntriesInDirectory(path);
+  std::vector<std::string> files;
+  files.reserve(entries.size());
+  for (auto& it : entries)
+  {
+    if (!(it.second.flags & ISODirectoryEntryFlag_Directory))
+      files.push_back(std::move(it.first));
+  }
+  return files;
+}
+
+std::vector<std::pair<std::string, ISOReader::ISODirectoryEntry>> ISOReader::GetEntriesInDirectory(const char* path)
 {
   std::string base_path = path;
   u32 directory_record_lba;
@@ -216,7 +234,7 @@ std::vector<std::string> ISOReader::GetFilesInDirectory(const char* path)
     return {};
   }
 
-  std::vector<std::string> files;
+  std::vector<std::pair<std::string, ISODirectoryEntry>> files;
   u8 sector_buffer[SECTOR_SIZE];
   for (u32 i = 0; i < num_sectors; i++)
   {
@@ -244,18 +262,21 @@ std::vector<std::string> ISOReader::GetFilesInDirectory(const char* path)
       if (de->filename_length == 1 && (*de_filename == '\x0' || *de_filename == '\x1'))
         continue;
 
-      // strip off terminator/file version
+      // strip off terminator/file version, directories don't have one
       std::string filename(de_filename, de->filename_length);
       std::string::size_type pos = filename.rfind(';');
-      if (pos == std::string::npos)
+      if (pos != std::string::npos)
+      {
+        filename.erase(pos);
+      }
+      else if (!(de->flags & ISODirectoryEntryFlag_Directory))
       {
         Log_ErrorPrintf("Invalid filename '%s'", filename.c_str());
         continue;
       }
-      filename.erase(pos);
 
       if (!filename.empty())
-        files.push_back(base_path + filename);
+        files.emplace_back(base_path + filename, *de);
     }
   }
 
@@ -6,6 +6,9 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 class CDImage;
@@ -141,6 +144,7 @@ public:
   bool Open(CDImage* image, u32 track_number);
 
   std::vector<std::string> GetFilesInDirectory(const char* path);
+  std::vector<std::pair<std::string, ISODirectoryEntry>> GetEntriesInDirectory(const char* path);
 
   bool ReadFile(const char* path, std::vector<u8>* data);
   bool FileExists(const char* path);
@@ -149,11 +153,15 @@ private:
   bool ReadPVD();
 
   std::optional<ISODirectoryEntry> LocateFile(const char* path);
-  std::optional<ISODirectoryEntry> LocateFile(const char* path, u8* sector_buffer, u32 directory_record_lba,
-                                              u32 directory_record_size);
+  bool IndexDirectory(const std::string& path, u32 directory_record_lba, u32 directory_record_size);
 
   CDImage* m_image;
   u32 m_track_number;
 
   ISOPrimaryVolumeDescriptor m_pvd = {};
+
+  // Entries of every directory which has been searched, keyed by their lower-case path without the file version, so
+  // repeated lookups don't read the directories again.
+  std::unordered_map<std::string, ISODirectoryEntry> m_directory_index;
+  std::unordered_set<std::string> m_indexed_directories;
 };
\ No newline at end of file
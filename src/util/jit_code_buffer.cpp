@@ -19,6 +19,13 @@ Log_SetChannel(JitCodeBuffer);
 #include <sys/mman.h>
 #endif
 
+// Blocks and the links between them are spread over the whole buffer, so fewer, larger TLB entries help.
+static void AdviseHugePagesForBuffer(void* ptr, u32 size)
+{
+  const bool result = MemMap::AdviseHugePages(ptr, size);
+  Log_InfoPrintf("Huge pages %s for %u KB code buffer", result ? "requested" : "not available", size / 1024);
+}
+
 JitCodeBuffer::JitCodeBuffer() = default;
 
 JitCodeBuffer::JitCodeBuffer(u32 size, u32 far_code_size)
@@ -71,14 +78,17 @@ bool JitCodeBuffer::Allocate(u32 size /* = 64 * 1024 * 1024 */, u32 far_code_siz
   m_free_code_ptr = m_code_ptr;
   m_code_size = size;
   m_code_used = 0;
+  m_code_limit = size;
 
   m_far_code_ptr = static_cast<u8*>(m_code_ptr) + size;
   m_free_far_code_ptr = m_far_code_ptr;
   m_far_code_size = far_code_size;
   m_far_code_used = 0;
+  m_far_code_limit = far_code_size;
 
   m_old_protection = 0;
   m_owns_buffer = true;
+  AdviseHugePagesForBuffer(m_code_ptr, m_total_size);
   return true;
 }
 
@@ -142,14 +152,17 @@ bool JitCodeBuffer::Initialize(void* buffer, u32 size, u32 far_code_size /* = 0
   m_free_code_ptr = m_code_ptr + guard_size;
   m_code_size = size - far_code_size - (guard_size * 2);
   m_code_used = 0;
+  m_code_limit = m_code_size;
 
   m_far_code_ptr = static_cast<u8*>(m_code_ptr) + m_code_size;
   m_free_far_code_ptr = m_far_code_ptr;
   m_far_code_size = far_code_size - guard_size;
   m_far_code_used = 0;
+  m_far_code_limit = m_far_code_size;
 
   m_guard_size = guard_size;
   m_owns_buffer = false;
+  AdviseHugePagesForBuffer(m_free_code_ptr, m_code_size + m_far_code_size);
   return true;
 }
 
@@ -182,10 +195,12 @@ void JitCodeBuffer::Destroy()
   m_code_size = 0;
   m_code_reserve_size = 0;
   m_code_used = 0;
+  m_code_limit = 0;
   m_far_code_ptr = nullptr;
   m_free_far_code_ptr = nullptr;
   m_far_code_size = 0;
   m_far_code_used = 0;
+  m_far_code_limit = 0;
   m_total_size = 0;
   m_guard_size = 0;
   m_old_protection = 0;
@@ -200,6 +215,7 @@ void JitCodeBuffer::ReserveCode(u32 size)
   m_code_reserve_size += size;
   m_free_code_ptr += size;
   m_code_size -= size;
+  m_code_limit = m_code_size;
 }
 
 void JitCodeBuffer::CommitCode(u32 length)
@@ -212,7 +228,7 @@ void JitCodeBuffer::CommitCode(u32 length)
   FlushInstructionCache(m_free_code_ptr, length);
 #endif
 
-  Assert(length <= (m_code_size - m_code_used));
+  Assert(length <= (m_code_limit - m_code_used));
   m_free_code_ptr += length;
   m_code_used += length;
 }
@@ -227,17 +243,36 @@ void JitCodeBuffer::CommitFarCode(u32 length)
   FlushInstructionCache(m_free_far_code_ptr, length);
 #endif
 
-  Assert(length <= (m_far_code_size - m_far_code_used));
+  Assert(length <= (m_far_code_limit - m_far_code_used));
   m_free_far_code_ptr += length;
   m_far_code_used += length;
 }
 
+void JitCodeBuffer::SetCodeRange(u32 offset, u32 size)
+{
+  Assert(size <= m_code_size && offset <= (m_code_size - size));
+
+  m_free_code_ptr = m_code_ptr + m_guard_size + m_code_reserve_size + offset;
+  m_code_used = offset;
+  m_code_limit = offset + size;
+}
+
+void JitCodeBuffer::SetFarCodeRange(u32 offset, u32 size)
+{
+  Assert(size <= m_far_code_size && offset <= (m_far_code_size - size));
+
+  m_free_far_code_ptr = m_far_code_ptr + offset;
+  m_far_code_used = offset;
+  m_far_code_limit = offset + size;
+}
+
 void JitCodeBuffer::Reset()
 {
   MemMap::BeginCodeWrite();
 
   m_free_code_ptr = m_code_ptr + m_guard_size + m_code_reserve_size;
   m_code_used = 0;
+  m_code_limit = m_code_size;
   std::memset(m_free_code_ptr, 0, m_code_size);
   FlushInstructionCache(m_free_code_ptr, m_code_size);
 
@@ -245,6 +280,7 @@ void JitCodeBuffer::Reset()
   {
     m_free_far_code_ptr = m_far_code_ptr;
     m_far_code_used = 0;
+    m_far_code_limit = m_far_code_size;
     std::memset(m_free_far_code_ptr, 0, m_far_code_size);
     FlushInstructionCache(m_free_far_code_ptr, m_far_code_size);
   }
@@ -0,0 +1,623 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "media_capture.h"
+#include "gpu_device.h"
+#include "host.h"
+
+#include "common/align.h"
+#include "common/assert.h"
+#include "common/error.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/path.h"
+
+#include "fmt/format.h"
+#include "stb_image_resize.h"
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+Log_SetChannel(MediaCapture);
+
+static constexpr const std::array s_backend_names = {"MJPEG"};
+static constexpr const std::array s_backend_display_names = {TRANSLATE_NOOP("MediaCapture", "Motion JPEG (AVI)")};
+static constexpr const std::array s_backend_extensions = {"avi"};
+
+namespace {
+
+/// Motion JPEG video and PCM audio in an AVI, which needs nothing beyond what's already linked. Every frame is a
+/// keyframe, so files are large but cut cleanly anywhere, and any editor can read them.
+class MediaCaptureMJPEG final : public MediaCapture
+{
+public:
+  MediaCaptureMJPEG();
+  ~MediaCaptureMJPEG() override;
+
+protected:
+  bool OpenOutput(const std::string& path, Error* error) override;
+  bool WriteFrame(const u32* pixels, const s16* audio_frames, u32 num_audio_frames) override;
+  bool CloseOutput(Error* error) override;
+
+private:
+  // AVI 1.0 offsets are 32-bit, and plenty of readers give up past 2GB, so long captures are split into parts.
+  static constexpr u64 MAX_FILE_SIZE = 0x7F000000;
+  static constexpr u32 HEADER_SIZE = 324;
+  static constexpr u32 AVIF_HASINDEX = 0x10;
+  static constexpr u32 AVIF_ISINTERLEAVED = 0x100;
+  static constexpr u32 AVIIF_KEYFRAME = 0x10;
+
+  struct IndexEntry
+  {
+    u32 chunk_id;
+    u32 flags;
+    u32 offset;
+    u32 size;
+  };
+
+  static constexpr u32 MakeFourCC(char a, char b, char c, char d)
+  {
+    return static_cast<u32>(static_cast<u8>(a)) | (static_cast<u32>(static_cast<u8>(b)) << 8) |
+           (static_cast<u32>(static_cast<u8>(c)) << 16) | (static_cast<u32>(static_cast<u8>(d)) << 24);
+  }
+
+  std::string GetPartPath() const;
+  std::vector<u8> BuildHeaders(u32 riff_size) const;
+  bool OpenFile(Error* error);
+  bool FinishFile(Error* error);
+  void WriteChunk(u32 chunk_id, u32 flags, const void* data, u32 size);
+
+  std::string m_base_path;
+  std::FILE* m_fp = nullptr;
+  u32 m_part = 0;
+
+  // Per part, since each is a complete file.
+  std::vector<IndexEntry> m_index;
+  u64 m_movi_size = 0;
+  u32 m_file_video_frames = 0;
+  u64 m_file_audio_frames = 0;
+  u32 m_max_chunk_size = 0;
+
+  std::vector<u8> m_jpeg_buffer;
+  bool m_write_error = false;
+};
+
+} // namespace
+
+MediaCapture::MediaCapture() = default;
+
+MediaCapture::~MediaCapture()
+{
+  DebugAssert(!m_capturing);
+}
+
+const char* MediaCapture::GetBackendName(MediaCaptureBackend backend)
+{
+  return (static_cast<u32>(backend) < s_backend_names.size()) ? s_backend_names[static_cast<u32>(backend)] : "";
+}
+
+const char* MediaCapture::GetBackendDisplayName(MediaCaptureBackend backend)
+{
+  return (static_cast<u32>(backend) < s_backend_display_names.size()) ?
+           Host::TranslateToCString("MediaCapture", s_backend_display_names[static_cast<u32>(backend)]) :
+           "";
+}
+
+std::optional<MediaCaptureBackend> MediaCapture::ParseBackendName(const char* name)
+{
+  for (u8 i = 0; i < static_cast<u8>(MediaCaptureBackend::Count); i++)
+  {
+    if (std::strcmp(name, s_backend_names[i]) == 0)
+      return static_cast<MediaCaptureBackend>(i);
+  }
+
+  return std::nullopt;
+}
+
+const char* MediaCapture::GetFileExtension(MediaCaptureBackend backend)
+{
+  return (static_cast<u32>(backend) < s_backend_extensions.size()) ? s_backend_extensions[static_cast<u32>(backend)] :
+                                                                      "";
+}
+
+std::unique_ptr<MediaCapture> MediaCapture::Create(MediaCaptureBackend backend)
+{
+  switch (backend)
+  {
+    case MediaCaptureBackend::MJPEG:
+      return std::make_unique<MediaCaptureMJPEG>();
+
+    default:
+      return {};
+  }
+}
+
+bool MediaCapture::BeginCapture(std::string path, u32 video_width, u32 video_height, float frame_rate, u32 sample_rate,
+                                int quality, Error* error)
+{
+  DebugAssert(!m_capturing);
+  if (video_width == 0 || video_height == 0 || frame_rate <= 0.0f || sample_rate == 0)
+  {
+    Error::SetString(error, fmt::format("Invalid capture parameters: {}x{} at {} FPS, {} Hz audio", video_width,
+                                        video_height, frame_rate, sample_rate));
+    return false;
+  }
+
+  m_path = std::move(path);
+  m_video_width = video_width;
+  m_video_height = video_height;
+  m_frame_rate = frame_rate;
+  m_sample_rate = sample_rate;
+  m_quality = std::clamp(quality, 1, 100);
+  m_frame_count = 0;
+  m_pending_audio.clear();
+  m_encoder_failed = false;
+  if (!OpenOutput(m_path, error))
+    return false;
+
+  Log_InfoPrintf("Capturing %ux%u at %.2f FPS to '%s'", video_width, video_height, frame_rate, m_path.c_str());
+  m_capturing = true;
+  StartEncoderThread();
+  return true;
+}
+
+bool MediaCapture::DeliverVideoFrame(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, bool flip_y)
+{
+  DebugAssert(m_capturing);
+
+  PendingFrame frame = {};
+  {
+    std::unique_lock lock(m_mutex);
+    if (!m_free_frames.empty())
+    {
+      frame = std::move(m_free_frames.back());
+      m_free_frames.pop_back();
+    }
+  }
+
+  frame.has_video = true;
+  frame.flip_y = flip_y;
+  if (texture && width > 0 && height > 0)
+  {
+    frame.width = width;
+    frame.height = height;
+    frame.format = texture->GetFormat();
+    frame.stride = Common::AlignUpPow2(GPUTexture::GetPixelSize(frame.format) * width, 4);
+    frame.pixels.resize((frame.stride / sizeof(u32)) * height);
+    if (!g_gpu_device->DownloadTexture(texture, x, y, width, height, frame.pixels.data(), frame.stride))
+    {
+      Log_ErrorPrintf("Failed to download %ux%u frame for capture", width, height);
+      frame.pixels.clear();
+    }
+  }
+  else
+  {
+    frame.pixels.clear();
+  }
+
+  frame.audio.swap(m_pending_audio);
+  m_pending_audio.clear();
+  QueueFrame(std::move(frame));
+  m_frame_count++;
+  return true;
+}
+
+void MediaCapture::DeliverAudioFrames(const s16* frames, u32 num_frames)
+{
+  DebugAssert(m_capturing);
+  m_pending_audio.insert(m_pending_audio.end(), frames, frames + (num_frames * 2));
+}
+
+bool MediaCapture::EndCapture(Error* error)
+{
+  if (!m_capturing)
+    return true;
+
+  if (!m_pending_audio.empty())
+  {
+    PendingFrame frame = {};
+    frame.audio = std::move(m_pending_audio);
+    QueueFrame(std::move(frame));
+  }
+
+  StopEncoderThread();
+  m_capturing = false;
+  m_pending_audio = {};
+  m_free_frames.clear();
+  m_scaled_pixels = {};
+
+  const bool closed = CloseOutput(error);
+  if (m_encoder_failed)
+  {
+    Error::SetString(error, fmt::format("Failed to encode frames to '{}'", m_path));
+    return false;
+  }
+
+  Log_InfoPrintf("Captured %u frames to '%s'", m_frame_count, m_path.c_str());
+  return closed;
+}
+
+void MediaCapture::StartEncoderThread()
+{
+  m_encoder_shutdown = false;
+  m_encoder_thread.Start([this]() { EncoderThreadEntryPoint(); });
+}
+
+void MediaCapture::StopEncoderThread()
+{
+  {
+    std::unique_lock lock(m_mutex);
+    m_encoder_shutdown = true;
+  }
+  m_wake_cv.notify_one();
+  m_encoder_thread.Join();
+}
+
+void MediaCapture::QueueFrame(PendingFrame frame)
+{
+  std::unique_lock lock(m_mutex);
+  if (m_queue.size() >= MAX_PENDING_FRAMES)
+  {
+    Log_DevPrintf("Capture encoder is %zu frames behind, waiting", m_queue.size());
+    m_done_cv.wait(lock, [this]() { return m_queue.size() < MAX_PENDING_FRAMES; });
+  }
+
+  m_queue.push_back(std::move(frame));
+  lock.unlock();
+  m_wake_cv.notify_one();
+}
+
+void MediaCapture::EncoderThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Media Capture Encoder");
+
+  std::unique_lock lock(m_mutex);
+  for (;;)
+  {
+    m_wake_cv.wait(lock, [this]() { return m_encoder_shutdown || !m_queue.empty(); });
+    if (m_queue.empty())
+      break;
+
+    PendingFrame frame = std::move(m_queue.front());
+    m_queue.pop_front();
+    const bool failed = m_encoder_failed;
+    lock.unlock();
+
+    // Keep draining after a failure, so that the CPU thread never waits on a dead encoder.
+    if (!failed && !EncodeFrame(frame))
+    {
+      Log_ErrorPrintf("Failed to encode frame, no further frames will be written to '%s'", m_path.c_str());
+      lock.lock();
+      m_encoder_failed = true;
+      lock.unlock();
+    }
+
+    frame.audio.clear();
+    lock.lock();
+    m_free_frames.push_back(std::move(frame));
+    m_done_cv.notify_all();
+  }
+}
+
+bool MediaCapture::EncodeFrame(PendingFrame& frame)
+{
+  const u32 num_audio_frames = static_cast<u32>(frame.audio.size() / 2);
+  if (!frame.has_video)
+    return WriteFrame(nullptr, frame.audio.data(), num_audio_frames);
+
+  const u32 video_pixels = m_video_width * m_video_height;
+  if (frame.pixels.empty())
+  {
+    m_scaled_pixels.assign(video_pixels, 0xFF000000u);
+    return WriteFrame(m_scaled_pixels.data(), frame.audio.data(), num_audio_frames);
+  }
+
+  if (!GPUTexture::ConvertTextureDataToRGBA8(frame.width, frame.height, frame.pixels, frame.stride, frame.format))
+    return false;
+  if (frame.flip_y)
+    GPUTexture::FlipTextureDataRGBA8(frame.width, frame.height, frame.pixels, frame.stride);
+
+  if (frame.width == m_video_width && frame.height == m_video_height && frame.stride == (sizeof(u32) * frame.width))
+    return WriteFrame(frame.pixels.data(), frame.audio.data(), num_audio_frames);
+
+  m_scaled_pixels.resize(video_pixels);
+  if (!stbir_resize_uint8(reinterpret_cast<const u8*>(frame.pixels.data()), frame.width, frame.height, frame.stride,
+                          reinterpret_cast<u8*>(m_scaled_pixels.data()), m_video_width, m_video_height,
+                          sizeof(u32) * m_video_width, 4))
+  {
+    Log_ErrorPrintf("Failed to scale frame from %ux%u to %ux%u", frame.width, frame.height, m_video_width,
+                    m_video_height);
+    return false;
+  }
+
+  return WriteFrame(m_scaled_pixels.data(), frame.audio.data(), num_audio_frames);
+}
+
+MediaCaptureMJPEG::MediaCaptureMJPEG() = default;
+
+MediaCaptureMJPEG::~MediaCaptureMJPEG()
+{
+  if (m_fp)
+    std::fclose(m_fp);
+}
+
+std::string MediaCaptureMJPEG::GetPartPath() const
+{
+  if (m_part == 0)
+    return m_base_path;
+
+  return fmt::format("{}_{}.avi", Path::StripExtension(m_base_path), m_part + 1);
+}
+
+std::vector<u8> MediaCaptureMJPEG::BuildHeaders(u32 riff_size) const
+{
+  std::vector<u8> buf;
+  buf.reserve(HEADER_SIZE);
+
+  const auto put_u16 = [&buf](u16 value) {
+    buf.push_back(static_cast<u8>(value));
+    buf.push_back(static_cast<u8>(value >> 8));
+  };
+  const auto put_u32 = [&buf](u32 value) {
+    for (u32 i = 0; i < 4; i++)
+      buf.push_back(static_cast<u8>(value >> (i * 8)));
+  };
+  const auto begin_chunk = [&buf, &put_u32](u32 id) {
+    put_u32(id);
+    const size_t offset = buf.size();
+    put_u32(0);
+    return offset;
+  };
+  const auto end_chunk = [&buf](size_t offset) {
+    const u32 size = static_cast<u32>(buf.size() - offset - sizeof(u32));
+    std::memcpy(&buf[offset], &size, sizeof(size));
+  };
+
+  // Rate/scale in thousandths keeps the odd NTSC and PAL rates close enough to not drift from the audio.
+  const u32 rate_scale = 1000;
+  const u32 rate = static_cast<u32>(m_frame_rate * static_cast<float>(rate_scale) + 0.5f);
+  const u32 image_size = m_video_width * m_video_height * 3;
+
+  put_u32(MakeFourCC('R', 'I', 'F', 'F'));
+  put_u32(riff_size);
+  put_u32(MakeFourCC('A', 'V', 'I', ' '));
+
+  const size_t hdrl = begin_chunk(MakeFourCC('L', 'I', 'S', 'T'));
+  put_u32(MakeFourCC('h', 'd', 'r', 'l'));
+  {
+    const size_t avih = begin_chunk(MakeFourCC('a', 'v', 'i', 'h'));
+    put_u32(static_cast<u32>(1000000.0f / m_frame_rate)); // dwMicroSecPerFrame
+    put_u32(0);                                             // dwMaxBytesPerSec
+    put_u32(0);                                             // dwPaddingGranularity
+    put_u32(AVIF_HASINDEX | AVIF_ISINTERLEAVED);            // dwFlags
+    put_u32(m_file_video_frames);                           // dwTotalFrames
+    put_u32(0);                                             // dwInitialFrames
+    put_u32(2);                                             // dwStreams
+    put_u32(m_max_chunk_size);                              // dwSuggestedBufferSize
+    put_u32(m_video_width);
+    put_u32(m_video_height);
+    for (u32 i = 0; i < 4; i++)
+      put_u32(0);
+    end_chunk(avih);
+
+    const size_t vstrl = begin_chunk(MakeFourCC('L', 'I', 'S', 'T'));
+    put_u32(MakeFourCC('s', 't', 'r', 'l'));
+    {
+      const size_t strh = begin_chunk(MakeFourCC('s', 't', 'r', 'h'));
+      put_u32(MakeFourCC('v', 'i', 'd', 's'));
+      put_u32(MakeFourCC('M', 'J', 'P', 'G'));
+      put_u32(0); // dwFlags
+      put_u16(0); // wPriority
+      put_u16(0); // wLanguage
+      put_u32(0); // dwInitialFrames
+      put_u32(rate_scale);
+      put_u32(rate);
+      put_u32(0); // dwStart
+      put_u32(m_file_video_frames);
+      put_u32(m_max_chunk_size);
+      put_u32(0xFFFFFFFFu); // dwQuality
+      put_u32(0);           // dwSampleSize
+      put_u16(0);
+      put_u16(0);
+      put_u16(static_cast<u16>(m_video_width));
+      put_u16(static_cast<u16>(m_video_height));
+      end_chunk(strh);
+
+      const size_t strf = begin_chunk(MakeFourCC('s', 't', 'r', 'f'));
+      put_u32(40); // biSize
+      put_u32(m_video_width);
+      put_u32(m_video_height);
+      put_u16(1);  // biPlanes
+      put_u16(24); // biBitCount
+      put_u32(MakeFourCC('M', 'J', 'P', 'G'));
+      put_u32(image_size);
+      for (u32 i = 0; i < 4; i++)
+        put_u32(0);
+      end_chunk(strf);
+    }
+    end_chunk(vstrl);
+
+    const size_t astrl = begin_chunk(MakeFourCC('L', 'I', 'S', 'T'));
+    put_u32(MakeFourCC('s', 't', 'r', 'l'));
+    {
+      const size_t strh = begin_chunk(MakeFourCC('s', 't', 'r', 'h'));
+      put_u32(MakeFourCC('a', 'u', 'd', 's'));
+      put_u32(0); // fccHandler
+      put_u32(0); // dwFlags
+      put_u16(0); // wPriority
+      put_u16(0); // wLanguage
+      put_u32(0); // dwInitialFrames
+      put_u32(1);
+      put_u32(m_sample_rate);
+      put_u32(0); // dwStart
+      put_u32(static_cast<u32>(m_file_audio_frames));
+      put_u32(m_sample_rate * 4);
+      put_u32(0xFFFFFFFFu); // dwQuality
+      put_u32(4);           // dwSampleSize
+      for (u32 i = 0; i < 4; i++)
+        put_u16(0);
+      end_chunk(strh);
+
+      const size_t strf = begin_chunk(MakeFourCC('s', 't', 'r', 'f'));
+      put_u16(1); // WAVE_FORMAT_PCM
+      put_u16(2); // nChannels
+      put_u32(m_sample_rate);
+      put_u32(m_sample_rate * 4); // nAvgBytesPerSec
+      put_u16(4);                 // nBlockAlign
+      put_u16(16);                // wBitsPerSample
+      end_chunk(strf);
+    }
+    end_chunk(astrl);
+  }
+  end_chunk(hdrl);
+
+  put_u32(MakeFourCC('L', 'I', 'S', 'T'));
+  put_u32(static_cast<u32>(sizeof(u32) + m_movi_size));
+  put_u32(MakeFourCC('m', 'o', 'v', 'i'));
+
+  DebugAssert(buf.size() == HEADER_SIZE);
+  return buf;
+}
+
+bool MediaCaptureMJPEG::OpenOutput(const std::string& path, Error* error)
+{
+  m_base_path = path;
+  m_part = 0;
+  m_write_error = false;
+  return OpenFile(error);
+}
+
+bool MediaCaptureMJPEG::OpenFile(Error* error)
+{
+  const std::string path = GetPartPath();
+  m_fp = FileSystem::OpenCFile(path.c_str(), "wb", error);
+  if (!m_fp)
+    return false;
+
+  m_index.clear();
+  m_movi_size = 0;
+  m_file_video_frames = 0;
+  m_file_audio_frames = 0;
+  m_max_chunk_size = 0;
+
+  // Sizes and counts are filled in when the file is finished.
+  const std::vector<u8> headers = BuildHeaders(0);
+  if (std::fwrite(headers.data(), headers.size(), 1, m_fp) != 1)
+  {
+    Error::SetErrno(error, errno);
+    std::fclose(m_fp);
+    m_fp = nullptr;
+    return false;
+  }
+
+  return true;
+}
+
+void MediaCaptureMJPEG::WriteChunk(u32 chunk_id, u32 flags, const void* data, u32 size)
+{
+  // Index offsets are relative to the 'movi' fourcc.
+  m_index.push_back(IndexEntry{chunk_id, flags, static_cast<u32>(sizeof(u32) + m_movi_size), size});
+  m_max_chunk_size = std::max(m_max_chunk_size, size);
+
+  static constexpr u8 padding = 0;
+  const u32 header[2] = {chunk_id, size};
+  m_write_error |= (std::fwrite(header, sizeof(header), 1, m_fp) != 1);
+  m_write_error |= (size > 0 && std::fwrite(data, size, 1, m_fp) != 1);
+  m_write_error |= ((size & 1) != 0 && std::fwrite(&padding, 1, 1, m_fp) != 1);
+  m_movi_size += sizeof(header) + Common::AlignUpPow2(size, 2);
+}
+
+bool MediaCaptureMJPEG::WriteFrame(const u32* pixels, const s16* audio_frames, u32 num_audio_frames)
+{
+  if (!m_fp)
+    return false;
+
+  u32 video_size = 0;
+  if (pixels)
+  {
+    m_jpeg_buffer.clear();
+    const auto write_func = [](void* context, void* data, int size) {
+      std::vector<u8>* buffer = static_cast<std::vector<u8>*>(context);
+      buffer->insert(buffer->end(), static_cast<const u8*>(data), static_cast<const u8*>(data) + size);
+    };
+    if (stbi_write_jpg_to_func(write_func, &m_jpeg_buffer, m_video_width, m_video_height, 4, pixels, m_quality) == 0)
+      return false;
+
+    video_size = static_cast<u32>(m_jpeg_buffer.size());
+  }
+
+  const u32 audio_size = num_audio_frames * sizeof(s16) * 2;
+  const u64 projected_size = HEADER_SIZE + m_movi_size + (sizeof(u32) * 2 * 2) + video_size + audio_size + 2 +
+                             (sizeof(u32) * 2) + ((m_index.size() + 2) * sizeof(IndexEntry));
+  if (pixels && projected_size > MAX_FILE_SIZE && m_file_video_frames > 0)
+  {
+    Error error;
+    if (!FinishFile(&error))
+    {
+      Log_ErrorPrintf("Failed to finish '%s': %s", GetPartPath().c_str(), error.GetDescription().c_str());
+      return false;
+    }
+
+    m_part++;
+    if (!OpenFile(&error))
+    {
+      Log_ErrorPrintf("Failed to open '%s': %s", GetPartPath().c_str(), error.GetDescription().c_str());
+      return false;
+    }
+
+    Log_InfoPrintf("Continuing capture in '%s'", GetPartPath().c_str());
+  }
+
+  if (pixels)
+  {
+    WriteChunk(MakeFourCC('0', '0', 'd', 'c'), AVIIF_KEYFRAME, m_jpeg_buffer.data(), video_size);
+    m_file_video_frames++;
+  }
+
+  if (num_audio_frames > 0)
+  {
+    WriteChunk(MakeFourCC('0', '1', 'w', 'b'), AVIIF_KEYFRAME, audio_frames, audio_size);
+    m_file_audio_frames += num_audio_frames;
+  }
+
+  return !m_write_error;
+}
+
+bool MediaCaptureMJPEG::FinishFile(Error* error)
+{
+  const u32 idx1[2] = {MakeFourCC('i', 'd', 'x', '1'), static_cast<u32>(m_index.size() * sizeof(IndexEntry))};
+  m_write_error |= (std::fwrite(idx1, sizeof(idx1), 1, m_fp) != 1);
+  m_write_error |= (!m_index.empty() && std::fwrite(m_index.data(), sizeof(IndexEntry), m_index.size(), m_fp) !=
+                                          m_index.size());
+
+  const s64 file_size = FileSystem::FTell64(m_fp);
+  const std::vector<u8> headers = BuildHeaders(static_cast<u32>(file_size - 8));
+  m_write_error |= (FileSystem::FSeek64(m_fp, 0, SEEK_SET) != 0 ||
+                    std::fwrite(headers.data(), headers.size(), 1, m_fp) != 1);
+
+  m_write_error |= (std::fclose(m_fp) != 0);
+  m_fp = nullptr;
+  m_index = {};
+
+  if (m_write_error)
+  {
+    Error::SetString(error, fmt::format("Failed to write '{}'", GetPartPath()));
+    return false;
+  }
+
+  return true;
+}
+
+bool MediaCaptureMJPEG::CloseOutput(Error* error)
+{
+  if (!m_fp)
+  {
+    Error::SetString(error, fmt::format("'{}' was not completed", GetPartPath()));
+    return false;
+  }
+
+  return FinishFile(error);
+}
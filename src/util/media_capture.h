@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "gpu_texture.h"
+
+#include "common/threading.h"
+#include "common/types.h"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+class Error;
+
+enum class MediaCaptureBackend : u8
+{
+  MJPEG,
+  Count
+};
+
+/// Records video frames and audio to a file. Frames are read back on the calling thread, then converted, scaled,
+/// encoded and muxed by the backend on a worker thread, so the only cost to emulation is the readback itself.
+class MediaCapture
+{
+public:
+  /// Frames the encoder can fall behind by before delivering another one blocks.
+  static constexpr u32 MAX_PENDING_FRAMES = 8;
+
+  virtual ~MediaCapture();
+
+  static const char* GetBackendName(MediaCaptureBackend backend);
+  static const char* GetBackendDisplayName(MediaCaptureBackend backend);
+  static std::optional<MediaCaptureBackend> ParseBackendName(const char* name);
+
+  /// Container extension written by the backend, without the dot.
+  static const char* GetFileExtension(MediaCaptureBackend backend);
+
+  static std::unique_ptr<MediaCapture> Create(MediaCaptureBackend backend);
+
+  ALWAYS_INLINE bool IsCapturing() const { return m_capturing; }
+  ALWAYS_INLINE const std::string& GetPath() const { return m_path; }
+  ALWAYS_INLINE u32 GetVideoWidth() const { return m_video_width; }
+  ALWAYS_INLINE u32 GetVideoHeight() const { return m_video_height; }
+  ALWAYS_INLINE u32 GetFrameCount() const { return m_frame_count; }
+
+  /// The video size is fixed for the whole capture, frames of other sizes are scaled to fit it.
+  /// Audio is interleaved 16-bit stereo at sample_rate. Quality ranges from 1 to 100.
+  bool BeginCapture(std::string path, u32 video_width, u32 video_height, float frame_rate, u32 sample_rate,
+                    int quality, Error* error);
+
+  /// Reads back a region of a texture and queues it for encoding, along with the audio delivered since the previous
+  /// frame. A null texture queues a black frame, so that video stays in step with audio. Must be called on the thread
+  /// which owns the GPU device, and blocks if the encoder has fallen too far behind.
+  bool DeliverVideoFrame(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, bool flip_y);
+
+  void DeliverAudioFrames(const s16* frames, u32 num_frames);
+
+  /// Encodes everything still queued, and finalizes the file.
+  bool EndCapture(Error* error);
+
+protected:
+  MediaCapture();
+
+  /// Backend interface. OpenOutput() is called on the thread which began the capture, the others on the encoder
+  /// thread. Pixels are RGBA8 at the video size, and are null for the audio which trails the last frame.
+  virtual bool OpenOutput(const std::string& path, Error* error) = 0;
+  virtual bool WriteFrame(const u32* pixels, const s16* audio_frames, u32 num_audio_frames) = 0;
+  virtual bool CloseOutput(Error* error) = 0;
+
+  u32 m_video_width = 0;
+  u32 m_video_height = 0;
+  float m_frame_rate = 0.0f;
+  u32 m_sample_rate = 0;
+  int m_quality = 0;
+
+private:
+  struct PendingFrame
+  {
+    u32 width;
+    u32 height;
+    u32 stride;
+    GPUTexture::Format format;
+    bool flip_y;
+    bool has_video;
+    std::vector<u32> pixels;
+    std::vector<s16> audio;
+  };
+
+  void StartEncoderThread();
+  void StopEncoderThread();
+  void EncoderThreadEntryPoint();
+  void QueueFrame(PendingFrame frame);
+  bool EncodeFrame(PendingFrame& frame);
+
+  std::string m_path;
+  u32 m_frame_count = 0;
+  bool m_capturing = false;
+
+  std::vector<s16> m_pending_audio;
+
+  Threading::Thread m_encoder_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wake_cv;
+  std::condition_variable m_done_cv;
+  std::deque<PendingFrame> m_queue;
+  std::vector<PendingFrame> m_free_frames;
+  bool m_encoder_shutdown = false;
+  bool m_encoder_failed = false;
+
+  // Only touched by the encoder thread.
+  std::vector<u32> m_scaled_pixels;
+};
@@ -24,6 +24,7 @@
 #include "common/timer.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -344,6 +345,7 @@ private:
   MTLRenderPassDescriptor* m_layer_pass_desc = nil;
 
   std::mutex m_fence_mutex;
+  std::condition_variable m_fence_cv;
   u64 m_current_fence_counter = 0;
   std::atomic<u64> m_completed_fence_counter{0};
   std::deque<std::pair<u64, id>> m_cleanup_objects; // [fence_counter, object]
@@ -220,6 +220,7 @@ void MetalDevice::SetFeatures()
   m_features.partial_msaa_resolve = false;
   m_features.shader_cache = true;
   m_features.pipeline_cache = false;
+  m_features.threaded_pipeline_creation = false;
 }
 
 bool MetalDevice::LoadShaders()
@@ -622,14 +623,17 @@ std::unique_ptr<GPUShader> MetalDevice::CreateShaderFromSource(GPUShaderStage st
     return {};
   }
 
-  std::optional<SPIRVCompiler::SPIRVCodeVector> spirv = SPIRVCompiler::CompileShader(stage, source, options);
-  if (!spirv.has_value())
+  DynamicHeapArray<u8> spirv;
+  if (!CompileGLSLToSPIRV(stage, source, options, &spirv))
   {
     Log_ErrorPrintf("Failed to compile shader to SPIR-V.");
     return {};
   }
 
-  std::optional<std::string> msl = SPIRVCompiler::CompileSPIRVToMSL(spirv.value());
+  const std::span<const SPIRVCompiler::SPIRVCodeType> spirv_code(
+    reinterpret_cast<const SPIRVCompiler::SPIRVCodeType*>(spirv.data()),
+    spirv.size() / sizeof(SPIRVCompiler::SPIRVCodeType));
+  std::optional<std::string> msl = SPIRVCompiler::CompileSPIRVToMSL(spirv_code);
   if (!msl.has_value())
   {
     Log_ErrorPrintf("Failed to compile SPIR-V to MSL.");
@@ -2073,6 +2077,8 @@ void MetalDevice::CommandBufferCompletedOffThread(id<MTLCommandBuffer> buffer, u
       m_last_gpu_time_end = end;
     }
   }
+
+  m_fence_cv.notify_all();
 }
 
 void MetalDevice::SubmitCommandBuffer(bool wait_for_completion)
@@ -2121,14 +2127,10 @@ void MetalDevice::WaitForFenceCounter(u64 counter)
   if (m_completed_fence_counter.load(std::memory_order_relaxed) >= counter)
     return;
 
-  // TODO: There has to be a better way to do this..
+  // Woken by the completion handler, rather than spinning on the counter.
   std::unique_lock lock(m_fence_mutex);
-  while (m_completed_fence_counter.load(std::memory_order_acquire) < counter)
-  {
-    lock.unlock();
-    pthread_yield_np();
-    lock.lock();
-  }
+  m_fence_cv.wait(lock,
+                  [this, counter]() { return m_completed_fence_counter.load(std::memory_order_acquire) >= counter; });
 
   CleanupObjects();
 }
@@ -0,0 +1,411 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "null_device.h"
+
+#include "common/assert.h"
+#include "common/log.h"
+
+#include <cstring>
+
+Log_SetChannel(NullDevice);
+
+namespace {
+
+static constexpr u32 SCRATCH_BUFFER_SIZE = 1024 * 1024;
+
+class NullTexture final : public GPUTexture
+{
+public:
+  NullTexture(u32 width, u32 height, u32 layers, u32 levels, u32 samples, Type type, Format format)
+    : GPUTexture(static_cast<u16>(width), static_cast<u16>(height), static_cast<u8>(layers), static_cast<u8>(levels),
+                 static_cast<u8>(samples), type, format)
+  {
+    m_planes.resize(static_cast<size_t>(layers) * static_cast<size_t>(levels));
+    for (u32 layer = 0; layer < layers; layer++)
+    {
+      for (u32 level = 0; level < levels; level++)
+        GetPlane(layer, level).resize(GetPlaneStride(level) * GetMipHeight(level));
+    }
+  }
+
+  ALWAYS_INLINE u32 GetPlaneStride(u32 level) const { return GetMipWidth(level) * GetPixelSize(); }
+  ALWAYS_INLINE std::vector<u8>& GetPlane(u32 layer, u32 level) { return m_planes[layer * m_levels + level]; }
+
+  u8* GetPixelPointer(u32 x, u32 y, u32 layer, u32 level)
+  {
+    CommitClear();
+    return GetPlane(layer, level).data() + (y * GetPlaneStride(level)) + (x * GetPixelSize());
+  }
+
+  // Clears are deferred through the texture state, apply them before the data is accessed.
+  void CommitClear()
+  {
+    if (m_state == State::Dirty)
+      return;
+
+    const bool fill = (m_state == State::Cleared && GetPixelSize() == sizeof(u32));
+    for (std::vector<u8>& plane : m_planes)
+    {
+      if (fill)
+      {
+        for (size_t i = 0; i < plane.size(); i += sizeof(u32))
+          std::memcpy(&plane[i], &m_clear_value.color, sizeof(u32));
+      }
+      else
+      {
+        std::memset(plane.data(), 0, plane.size());
+      }
+    }
+
+    m_state = State::Dirty;
+  }
+
+  bool IsValid() const override { return !m_planes.empty(); }
+
+  bool Update(u32 x, u32 y, u32 width, u32 height, const void* data, u32 pitch, u32 layer = 0,
+              u32 level = 0) override
+  {
+    DebugAssert(layer < m_layers && level < m_levels);
+    DebugAssert((x + width) <= GetMipWidth(level) && (y + height) <= GetMipHeight(level));
+
+    const u32 copy_size = width * GetPixelSize();
+    const u32 dst_stride = GetPlaneStride(level);
+    const u8* src = static_cast<const u8*>(data);
+    u8* dst = GetPixelPointer(x, y, layer, level);
+    for (u32 row = 0; row < height; row++)
+    {
+      std::memcpy(dst, src, copy_size);
+      src += pitch;
+      dst += dst_stride;
+    }
+
+    return true;
+  }
+
+  bool Map(void** map, u32* map_stride, u32 x, u32 y, u32 width, u32 height, u32 layer = 0, u32 level = 0) override
+  {
+    DebugAssert(layer < m_layers && level < m_levels);
+    DebugAssert((x + width) <= GetMipWidth(level) && (y + height) <= GetMipHeight(level));
+
+    *map = GetPixelPointer(x, y, layer, level);
+    *map_stride = GetPlaneStride(level);
+    return true;
+  }
+
+  void Unmap() override {}
+
+  void SetDebugName(const std::string_view& name) override {}
+
+private:
+  std::vector<std::vector<u8>> m_planes;
+};
+
+class NullSampler final : public GPUSampler
+{
+public:
+  void SetDebugName(const std::string_view& name) override {}
+};
+
+class NullShader final : public GPUShader
+{
+public:
+  NullShader(GPUShaderStage stage) : GPUShader(stage) {}
+
+  void SetDebugName(const std::string_view& name) override {}
+};
+
+class NullPipeline final : public GPUPipeline
+{
+public:
+  void SetDebugName(const std::string_view& name) override {}
+};
+
+class NullFramebuffer final : public GPUFramebuffer
+{
+public:
+  NullFramebuffer(GPUTexture* rt, GPUTexture* ds, u32 width, u32 height) : GPUFramebuffer(rt, ds, width, height) {}
+
+  void SetDebugName(const std::string_view& name) override {}
+};
+
+class NullTextureBuffer final : public GPUTextureBuffer
+{
+public:
+  NullTextureBuffer(Format format, u32 size_in_elements)
+    : GPUTextureBuffer(format, size_in_elements), m_data(GetSizeInBytes())
+  {
+  }
+
+  void* Map(u32 required_elements) override
+  {
+    DebugAssert(required_elements <= m_size_in_elements);
+    if ((m_current_position + required_elements) > m_size_in_elements)
+      m_current_position = 0;
+
+    return m_data.data() + (m_current_position * GetElementSize(m_format));
+  }
+
+  void Unmap(u32 used_elements) override { m_current_position += used_elements; }
+
+  void SetDebugName(const std::string_view& name) override {}
+
+private:
+  std::vector<u8> m_data;
+};
+
+} // namespace
+
+NullDevice::NullDevice() = default;
+
+NullDevice::~NullDevice() = default;
+
+RenderAPI NullDevice::GetRenderAPI() const
+{
+  return RenderAPI::None;
+}
+
+bool NullDevice::HasSurface() const
+{
+  return false;
+}
+
+void NullDevice::DestroySurface()
+{
+}
+
+bool NullDevice::UpdateWindow()
+{
+  return true;
+}
+
+void NullDevice::ResizeWindow(s32 new_window_width, s32 new_window_height, float new_window_scale)
+{
+  m_window_info.surface_width = static_cast<u32>(new_window_width);
+  m_window_info.surface_height = static_cast<u32>(new_window_height);
+  m_window_info.surface_scale = new_window_scale;
+}
+
+std::string NullDevice::GetDriverInfo() const
+{
+  return "Null device, no rendering or presentation.";
+}
+
+GPUDevice::AdapterAndModeList NullDevice::GetAdapterAndModeList()
+{
+  return {};
+}
+
+bool NullDevice::CreateDevice(const std::string_view& adapter, bool threaded_presentation)
+{
+  m_max_texture_size = 16384;
+  m_max_multisamples = 1;
+  m_scratch_buffer.resize(SCRATCH_BUFFER_SIZE);
+  Log_InfoPrintf("Created null device, nothing will be rendered.");
+  return true;
+}
+
+void NullDevice::DestroyDevice()
+{
+  m_scratch_buffer = {};
+}
+
+std::unique_ptr<GPUTexture> NullDevice::CreateTexture(u32 width, u32 height, u32 layers, u32 levels, u32 samples,
+                                                      GPUTexture::Type type, GPUTexture::Format format,
+                                                      const void* data /* = nullptr */, u32 data_stride /* = 0 */,
+                                                      bool dynamic /* = false */)
+{
+  if (!GPUTexture::ValidateConfig(width, height, layers, levels, samples, type, format))
+    return {};
+
+  std::unique_ptr<NullTexture> tex =
+    std::make_unique<NullTexture>(width, height, layers, levels, samples, type, format);
+  if (data)
+    tex->Update(0, 0, width, height, data, data_stride);
+
+  return tex;
+}
+
+std::unique_ptr<GPUSampler> NullDevice::CreateSampler(const GPUSampler::Config& config)
+{
+  return std::make_unique<NullSampler>();
+}
+
+std::unique_ptr<GPUTextureBuffer> NullDevice::CreateTextureBuffer(GPUTextureBuffer::Format format,
+                                                                  u32 size_in_elements)
+{
+  return std::make_unique<NullTextureBuffer>(format, size_in_elements);
+}
+
+bool NullDevice::DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
+                                 u32 out_data_stride)
+{
+  NullTexture* tex = static_cast<NullTexture*>(texture);
+  const u32 copy_size = width * tex->GetPixelSize();
+  const u32 src_stride = tex->GetPlaneStride(0);
+  const u8* src = tex->GetPixelPointer(x, y, 0, 0);
+  u8* dst = static_cast<u8*>(out_data);
+  for (u32 row = 0; row < height; row++)
+  {
+    std::memcpy(dst, src, copy_size);
+    src += src_stride;
+    dst += out_data_stride;
+  }
+
+  return true;
+}
+
+bool NullDevice::SupportsTextureFormat(GPUTexture::Format format) const
+{
+  return true;
+}
+
+void NullDevice::CopyTextureRegion(GPUTexture* dst, u32 dst_x, u32 dst_y, u32 dst_layer, u32 dst_level,
+                                   GPUTexture* src, u32 src_x, u32 src_y, u32 src_layer, u32 src_level, u32 width,
+                                   u32 height)
+{
+  NullTexture* const src_tex = static_cast<NullTexture*>(src);
+  NullTexture* const dst_tex = static_cast<NullTexture*>(dst);
+  DebugAssert(src_tex->GetPixelSize() == dst_tex->GetPixelSize());
+
+  const u32 copy_size = width * src_tex->GetPixelSize();
+  const u32 src_stride = src_tex->GetPlaneStride(src_level);
+  const u32 dst_stride = dst_tex->GetPlaneStride(dst_level);
+  const u8* src_ptr = src_tex->GetPixelPointer(src_x, src_y, src_layer, src_level);
+  u8* dst_ptr = dst_tex->GetPixelPointer(dst_x, dst_y, dst_layer, dst_level);
+  for (u32 row = 0; row < height; row++)
+  {
+    std::memmove(dst_ptr, src_ptr, copy_size);
+    src_ptr += src_stride;
+    dst_ptr += dst_stride;
+  }
+}
+
+void NullDevice::ResolveTextureRegion(GPUTexture* dst, u32 dst_x, u32 dst_y, u32 dst_layer, u32 dst_level,
+                                      GPUTexture* src, u32 src_x, u32 src_y, u32 width, u32 height)
+{
+  // Multisampling isn't supported, so the "resolve" is just a copy.
+  CopyTextureRegion(dst, dst_x, dst_y, dst_layer, dst_level, src, src_x, src_y, 0, 0, width, height);
+}
+
+std::unique_ptr<GPUFramebuffer> NullDevice::CreateFramebuffer(GPUTexture* rt_or_ds, GPUTexture* ds /* = nullptr */)
+{
+  GPUTexture* rt = (rt_or_ds && rt_or_ds->IsDepthStencil()) ? nullptr : rt_or_ds;
+  ds = (rt_or_ds && rt_or_ds->IsDepthStencil()) ? rt_or_ds : ds;
+  GPUTexture* size_tex = rt ? rt : ds;
+  return std::make_unique<NullFramebuffer>(rt, ds, size_tex ? size_tex->GetWidth() : 0,
+                                           size_tex ? size_tex->GetHeight() : 0);
+}
+
+std::unique_ptr<GPUShader> NullDevice::CreateShaderFromBinary(GPUShaderStage stage, std::span<const u8> data)
+{
+  return std::make_unique<NullShader>(stage);
+}
+
+std::unique_ptr<GPUShader> NullDevice::CreateShaderFromSource(GPUShaderStage stage, const std::string_view& source,
+                                                              const char* entry_point,
+                                                              DynamicHeapArray<u8>* out_binary)
+{
+  return std::make_unique<NullShader>(stage);
+}
+
+std::unique_ptr<GPUPipeline> NullDevice::CreatePipeline(const GPUPipeline::GraphicsConfig& config)
+{
+  return std::make_unique<NullPipeline>();
+}
+
+void NullDevice::PushDebugGroup(const char* name)
+{
+}
+
+void NullDevice::PopDebugGroup()
+{
+}
+
+void NullDevice::InsertDebugMessage(const char* msg)
+{
+}
+
+void NullDevice::MapVertexBuffer(u32 vertex_size, u32 vertex_count, void** map_ptr, u32* map_space,
+                                 u32* map_base_vertex)
+{
+  *map_ptr = m_scratch_buffer.data();
+  *map_space = SCRATCH_BUFFER_SIZE / vertex_size;
+  *map_base_vertex = 0;
+}
+
+void NullDevice::UnmapVertexBuffer(u32 vertex_size, u32 vertex_count)
+{
+}
+
+void NullDevice::MapIndexBuffer(u32 index_count, DrawIndex** map_ptr, u32* map_space, u32* map_base_index)
+{
+  *map_ptr = reinterpret_cast<DrawIndex*>(m_scratch_buffer.data());
+  *map_space = SCRATCH_BUFFER_SIZE / sizeof(DrawIndex);
+  *map_base_index = 0;
+}
+
+void NullDevice::UnmapIndexBuffer(u32 used_index_count)
+{
+}
+
+void NullDevice::PushUniformBuffer(const void* data, u32 data_size)
+{
+}
+
+void* NullDevice::MapUniformBuffer(u32 size)
+{
+  DebugAssert(size <= SCRATCH_BUFFER_SIZE);
+  return m_scratch_buffer.data();
+}
+
+void NullDevice::UnmapUniformBuffer(u32 size)
+{
+}
+
+void NullDevice::SetFramebuffer(GPUFramebuffer* fb)
+{
+}
+
+void NullDevice::SetPipeline(GPUPipeline* pipeline)
+{
+}
+
+void NullDevice::SetTextureSampler(u32 slot, GPUTexture* texture, GPUSampler* sampler)
+{
+}
+
+void NullDevice::SetTextureBuffer(u32 slot, GPUTextureBuffer* buffer)
+{
+}
+
+void NullDevice::SetViewport(s32 x, s32 y, s32 width, s32 height)
+{
+}
+
+void NullDevice::SetScissor(s32 x, s32 y, s32 width, s32 height)
+{
+}
+
+void NullDevice::Draw(u32 vertex_count, u32 base_vertex)
+{
+}
+
+void NullDevice::DrawIndexed(u32 index_count, u32 base_index, u32 base_vertex)
+{
+}
+
+void NullDevice::SetVSync(bool enabled)
+{
+  m_vsync_enabled = enabled;
+}
+
+bool NullDevice::BeginPresent(bool skip_present)
+{
+  // Nothing to present to, so the frame is always skipped.
+  return false;
+}
+
+void NullDevice::EndPresent()
+{
+}
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "gpu_device.h"
+
+#include <memory>
+#include <vector>
+
+/// Device which doesn't render or present anything. Textures are kept in system memory, so uploads and downloads
+/// still work, which is all the software renderer needs. Used for headless runs where there's no GPU at all.
+class NullDevice final : public GPUDevice
+{
+public:
+  NullDevice();
+  ~NullDevice();
+
+  RenderAPI GetRenderAPI() const override;
+
+  bool HasSurface() const override;
+  void DestroySurface() override;
+
+  bool UpdateWindow() override;
+  void ResizeWindow(s32 new_window_width, s32 new_window_height, float new_window_scale) override;
+
+  std::string GetDriverInfo() const override;
+
+  AdapterAndModeList GetAdapterAndModeList() override;
+
+  std::unique_ptr<GPUTexture> CreateTexture(u32 width, u32 height, u32 layers, u32 levels, u32 samples,
+                                            GPUTexture::Type type, GPUTexture::Format format,
+                                            const void* data = nullptr, u32 data_stride = 0,
+                                            bool dynamic = false) override;
+  std::unique_ptr<GPUSampler> CreateSampler(const GPUSampler::Config& config) override;
+  std::unique_ptr<GPUTextureBuffer> CreateTextureBuffer(GPUTextureBuffer::Format format, u32 size_in_elements) override;
+
+  bool DownloadTexture(GPUTexture* texture, u32 x, u32 y, u32 width, u32 height, void* out_data,
+                       u32 out_data_stride) override;
+  bool SupportsTextureFormat(GPUTexture::Format format) const override;
+  void CopyTextureRegion(GPUTexture* dst, u32 dst_x, u32 dst_y, u32 dst_layer, u32 dst_level, GPUTexture* src,
+                         u32 src_x, u32 src_y, u32 src_layer, u32 src_level, u32 width, u32 height) override;
+  void ResolveTextureRegion(GPUTexture* dst, u32 dst_x, u32 dst_y, u32 dst_layer, u32 dst_level, GPUTexture* src,
+                            u32 src_x, u32 src_y, u32 width, u32 height) override;
+
+  std::unique_ptr<GPUFramebuffer> CreateFramebuffer(GPUTexture* rt_or_ds, GPUTexture* ds = nullptr) override;
+
+  std::unique_ptr<GPUShader> CreateShaderFromBinary(GPUShaderStage stage, std::span<const u8> data) override;
+  std::unique_ptr<GPUShader> CreateShaderFromSource(GPUShaderStage stage, const std::string_view& source,
+                                                    const char* entry_point, DynamicHeapArray<u8>* out_binary) override;
+  std::unique_ptr<GPUPipeline> CreatePipeline(const GPUPipeline::GraphicsConfig& config) override;
+
+  void PushDebugGroup(const char* name) override;
+  void PopDebugGroup() override;
+  void InsertDebugMessage(const char* msg) override;
+
+  void MapVertexBuffer(u32 vertex_size, u32 vertex_count, void** map_ptr, u32* map_space,
+                       u32* map_base_vertex) override;
+  void UnmapVertexBuffer(u32 vertex_size, u32 vertex_count) override;
+  void MapIndexBuffer(u32 index_count, DrawIndex** map_ptr, u32* map_space, u32* map_base_index) override;
+  void UnmapIndexBuffer(u32 used_index_count) override;
+  void PushUniformBuffer(const void* data, u32 data_size) override;
+  void* MapUniformBuffer(u32 size) override;
+  void UnmapUniformBuffer(u32 size) override;
+  void SetFramebuffer(GPUFramebuffer* fb) override;
+  void SetPipeline(GPUPipeline* pipeline) override;
+  void SetTextureSampler(u32 slot, GPUTexture* texture, GPUSampler* sampler) override;
+  void SetTextureBuffer(u32 slot, GPUTextureBuffer* buffer) override;
+  void SetViewport(s32 x, s32 y, s32 width, s32 height) override;
+  void SetScissor(s32 x, s32 y, s32 width, s32 height) override;
+  void Draw(u32 vertex_count, u32 base_vertex) override;
+  void DrawIndexed(u32 index_count, u32 base_index, u32 base_vertex) override;
+
+  void SetVSync(bool enabled) override;
+
+  bool BeginPresent(bool skip_present) override;
+  void EndPresent() override;
+
+protected:
+  bool CreateDevice(const std::string_view& adapter, bool threaded_presentation) override;
+  void DestroyDevice() override;
+
+private:
+  // Draws are discarded, so the same scratch memory can back every mapping.
+  std::vector<u8> m_scratch_buffer;
+};
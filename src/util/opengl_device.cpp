@@ -403,12 +403,13 @@ bool OpenGLDevice::CheckFeatures(bool* buggy_pbo)
     vendor_id_powervr = true;
   }
 
-  // Don't use PBOs when we don't have ARB_buffer_storage, orphaning buffers probably ends up worse than just
-  // using the normal texture update routines and letting the driver take care of it. PBOs are also completely
-  // broken on mobile drivers.
+  // Don't use PBOs when the stream buffer would have to orphan, that probably ends up worse than just using the normal
+  // texture update routines and letting the driver take care of it. Desktop GL without ARB_buffer_storage can still
+  // map unsynchronized. PBOs are also completely broken on mobile drivers.
   const bool is_shitty_mobile_driver = (vendor_id_powervr || vendor_id_qualcomm || vendor_id_arm);
-  const bool is_buggy_pbo =
-    (!GLAD_GL_VERSION_4_4 && !GLAD_GL_ARB_buffer_storage && !GLAD_GL_EXT_buffer_storage) || is_shitty_mobile_driver;
+  const bool is_buggy_pbo = (!GLAD_GL_VERSION_4_4 && !GLAD_GL_ARB_buffer_storage && !GLAD_GL_EXT_buffer_storage &&
+                             !GLAD_GL_VERSION_3_0) ||
+                            is_shitty_mobile_driver;
   *buggy_pbo = is_buggy_pbo;
   if (is_buggy_pbo && !is_shitty_mobile_driver)
     Log_WarningPrint("Not using PBOs for texture uploads because buffer_storage is unavailable.");
@@ -513,6 +514,19 @@ bool OpenGLDevice::CheckFeatures(bool* buggy_pbo)
                       "startup will be slow due to compiling shaders.");
   }
 
+  m_features.threaded_pipeline_creation = false;
+
+  // Let the driver use as many threads as it wants, pipelines are created in batches so there's plenty to overlap.
+  m_parallel_shader_compile = (GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile);
+  if (m_parallel_shader_compile)
+  {
+    if (GLAD_GL_KHR_parallel_shader_compile)
+      glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    else
+      glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+  }
+  Log_InfoPrintf("Parallel shader compile is %s", m_parallel_shader_compile ? "supported" : "NOT supported");
+
   return true;
 }
 
@@ -15,6 +15,7 @@
 #include <cstdio>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 class OpenGLFramebuffer;
 class OpenGLPipeline;
@@ -36,6 +37,9 @@ public:
 
   ALWAYS_INLINE GL::Context* GetGLContext() const { return m_gl_context.get(); }
 
+  /// Shaders and programs are compiled on driver threads, and their status is only checked when they're needed.
+  ALWAYS_INLINE bool UsesParallelShaderCompile() const { return m_parallel_shader_compile; }
+
   RenderAPI GetRenderAPI() const override;
 
   bool HasSurface() const override;
@@ -72,6 +76,7 @@ public:
   std::unique_ptr<GPUShader> CreateShaderFromSource(GPUShaderStage stage, const std::string_view& source,
                                                     const char* entry_point, DynamicHeapArray<u8>* out_binary) override;
   std::unique_ptr<GPUPipeline> CreatePipeline(const GPUPipeline::GraphicsConfig& config) override;
+  bool WaitForPipelineCompiles() override;
 
   void PushDebugGroup(const char* name) override;
   void PopDebugGroup() override;
@@ -107,7 +112,7 @@ public:
 
   GLuint LookupProgramCache(const OpenGLPipeline::ProgramCacheKey& key, const GPUPipeline::GraphicsConfig& plconfig);
   GLuint CompileProgram(const GPUPipeline::GraphicsConfig& plconfig);
-  void PostLinkProgram(const GPUPipeline::GraphicsConfig& plconfig, GLuint program_id);
+  void PostLinkProgram(GPUPipeline::Layout layout, GLuint program_id);
   void UnrefProgram(const OpenGLPipeline::ProgramCacheKey& key);
 
   GLuint LookupVAOCache(const OpenGLPipeline::VertexArrayCacheKey& key);
@@ -138,6 +143,15 @@ private:
   static constexpr u32 UNIFORM_BUFFER_SIZE = 2 * 1024 * 1024;
   static constexpr u32 TEXTURE_STREAM_BUFFER_SIZE = 16 * 1024 * 1024;
 
+  /// Program which has been linked, but not checked yet.
+  struct PendingProgram
+  {
+    OpenGLPipeline::ProgramCacheKey key;
+    GLuint program_id;
+    GPUPipeline::Layout layout;
+    std::array<GLuint, 3> shader_ids;
+  };
+
   bool CheckFeatures(bool* buggy_pbo);
   bool CreateBuffers(bool buggy_pbo);
   void DestroyBuffers();
@@ -154,6 +168,10 @@ private:
   void PopTimestampQuery();
   void KickTimestampQuery();
 
+  static bool CheckProgramLinkStatus(GLuint program_id);
+  bool FinishProgram(const PendingProgram& pp);
+  void FinishPendingProgram(GLuint program_id);
+
   GLuint CreateProgramFromPipelineCache(const OpenGLPipeline::ProgramCacheItem& it,
                                         const GPUPipeline::GraphicsConfig& plconfig);
   void AddToPipelineCache(OpenGLPipeline::ProgramCacheItem* it);
@@ -175,6 +193,8 @@ private:
   // TODO: pass in file instead of blob for pipeline cache
   OpenGLPipeline::VertexArrayCache m_vao_cache;
   OpenGLPipeline::ProgramCache m_program_cache;
+  std::vector<PendingProgram> m_pending_programs;
+  bool m_parallel_shader_compile = false;
 
   // VAO cache - fixed max as key
   GPUPipeline::BlendState m_last_blend_state = {};
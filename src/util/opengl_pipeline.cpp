@@ -57,6 +57,22 @@ static GLenum GetGLShaderType(GPUShaderStage stage)
   return mapping[static_cast<u32>(stage)];
 }
 
+static void LogShaderCompileErrors(GLuint shader)
+{
+  GLint status = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+  if (status == GL_TRUE)
+    return;
+
+  GLint info_log_length = 0;
+  glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &info_log_length);
+
+  std::string info_log;
+  info_log.resize(info_log_length + 1);
+  glGetShaderInfoLog(shader, info_log_length, &info_log_length, &info_log[0]);
+  Log_ErrorPrintf("Shader failed to compile:\n%s", info_log.c_str());
+}
+
 static void FillFooter(PipelineDiskCacheFooter* footer, u32 version)
 {
   footer->version = version;
@@ -120,6 +136,29 @@ bool OpenGLShader::Compile()
   glShaderSource(shader, 1, &string, &length);
   glCompileShader(shader);
 
+  // Querying the status waits for the compile, so with parallel compiles it's only checked if a program fails to link.
+  if (!OpenGLDevice::GetInstance().UsesParallelShaderCompile() && !CheckCompileStatus(shader))
+  {
+    glDeleteShader(shader);
+    return false;
+  }
+
+  m_id = shader;
+
+#ifdef _DEBUG
+  if (glObjectLabel && !m_debug_name.empty())
+  {
+    glObjectLabel(GL_SHADER, shader, static_cast<GLsizei>(m_debug_name.length()),
+                  static_cast<const GLchar*>(m_debug_name.data()));
+    m_debug_name = {};
+  }
+#endif
+
+  return true;
+}
+
+bool OpenGLShader::CheckCompileStatus(GLuint shader)
+{
   GLint status = GL_FALSE;
   glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
 
@@ -149,22 +188,10 @@ bool OpenGLShader::Compile()
         std::fwrite(info_log.c_str(), info_log_length, 1, fp.get());
       }
 
-      glDeleteShader(shader);
       return false;
     }
   }
 
-  m_id = shader;
-
-#ifdef _DEBUG
-  if (glObjectLabel && !m_debug_name.empty())
-  {
-    glObjectLabel(GL_SHADER, shader, static_cast<GLsizei>(m_debug_name.length()),
-                  static_cast<const GLchar*>(m_debug_name.data()));
-    m_debug_name = {};
-  }
-#endif
-
   return true;
 }
 
@@ -304,8 +331,20 @@ GLuint OpenGLDevice::LookupProgramCache(const OpenGLPipeline::ProgramCacheKey& k
   item.file_offset = 0;
   item.file_uncompressed_size = 0;
   item.file_compressed_size = 0;
-  if (m_pipeline_disk_cache_file)
+  if (m_parallel_shader_compile)
+  {
+    // Binding the pipeline or WaitForPipelineCompiles() finishes it, and adds it to the disk cache.
+    const OpenGLShader* geometry_shader = static_cast<const OpenGLShader*>(plconfig.geometry_shader);
+    m_pending_programs.push_back(
+      PendingProgram{key, program_id, plconfig.layout,
+                     {static_cast<const OpenGLShader*>(plconfig.vertex_shader)->GetGLId(),
+                      static_cast<const OpenGLShader*>(plconfig.fragment_shader)->GetGLId(),
+                      geometry_shader ? geometry_shader->GetGLId() : 0}});
+  }
+  else if (m_pipeline_disk_cache_file)
+  {
     AddToPipelineCache(&item);
+  }
 
   m_program_cache.emplace(key, item);
   return item.program_id;
@@ -377,6 +416,23 @@ GLuint OpenGLDevice::CompileProgram(const GPUPipeline::GraphicsConfig& plconfig)
 
   glLinkProgram(program_id);
 
+  // Checked by FinishPendingProgram() instead, so the driver can link several programs at once.
+  if (m_parallel_shader_compile)
+    return program_id;
+
+  if (!CheckProgramLinkStatus(program_id))
+  {
+    glDeleteProgram(program_id);
+    return 0;
+  }
+
+  PostLinkProgram(plconfig.layout, program_id);
+
+  return program_id;
+}
+
+bool OpenGLDevice::CheckProgramLinkStatus(GLuint program_id)
+{
   GLint status = GL_FALSE;
   glGetProgramiv(program_id, GL_LINK_STATUS, &status);
 
@@ -396,17 +452,14 @@ GLuint OpenGLDevice::CompileProgram(const GPUPipeline::GraphicsConfig& plconfig)
     else
     {
       Log_ErrorPrintf("Program failed to link:\n%s", info_log.c_str());
-      glDeleteProgram(program_id);
-      return 0;
+      return false;
     }
   }
 
-  PostLinkProgram(plconfig, program_id);
-
-  return program_id;
+  return true;
 }
 
-void OpenGLDevice::PostLinkProgram(const GPUPipeline::GraphicsConfig& plconfig, GLuint program_id)
+void OpenGLDevice::PostLinkProgram(GPUPipeline::Layout layout, GLuint program_id)
 {
   if (!ShaderGen::UseGLSLBindingLayout())
   {
@@ -417,7 +470,7 @@ void OpenGLDevice::PostLinkProgram(const GPUPipeline::GraphicsConfig& plconfig,
     glUseProgram(program_id);
 
     // Texture buffer is zero here, so we have to bump it.
-    const u32 num_textures = std::max<u32>(GetActiveTexturesForLayout(plconfig.layout), 1);
+    const u32 num_textures = std::max<u32>(GetActiveTexturesForLayout(layout), 1);
     for (u32 i = 0; i < num_textures; i++)
     {
       location = glGetUniformLocation(program_id, TinyString::from_fmt("samp{}", i));
@@ -437,6 +490,16 @@ void OpenGLDevice::UnrefProgram(const OpenGLPipeline::ProgramCacheKey& key)
   if ((--it->second.reference_count) > 0)
     return;
 
+  // Never used, so there's no need to wait for it.
+  for (auto pit = m_pending_programs.begin(); pit != m_pending_programs.end(); ++pit)
+  {
+    if (pit->program_id == it->second.program_id)
+    {
+      m_pending_programs.erase(pit);
+      break;
+    }
+  }
+
   if (m_last_program == it->second.program_id)
   {
     m_last_program = 0;
@@ -451,6 +514,85 @@ void OpenGLDevice::UnrefProgram(const OpenGLPipeline::ProgramCacheKey& key)
     m_program_cache.erase(it);
 }
 
+bool OpenGLDevice::FinishProgram(const PendingProgram& pp)
+{
+  if (!CheckProgramLinkStatus(pp.program_id))
+  {
+    // Shader statuses weren't checked when they were compiled. The program is left for the pipelines using it.
+    for (const GLuint shader_id : pp.shader_ids)
+    {
+      if (shader_id != 0)
+        LogShaderCompileErrors(shader_id);
+    }
+
+    return false;
+  }
+
+  PostLinkProgram(pp.layout, pp.program_id);
+
+  if (m_pipeline_disk_cache_file)
+  {
+    const auto it = m_program_cache.find(pp.key);
+    if (it != m_program_cache.end() && it->second.program_id == pp.program_id &&
+        it->second.file_uncompressed_size == 0)
+    {
+      AddToPipelineCache(&it->second);
+    }
+  }
+
+  return true;
+}
+
+void OpenGLDevice::FinishPendingProgram(GLuint program_id)
+{
+  for (auto it = m_pending_programs.begin(); it != m_pending_programs.end(); ++it)
+  {
+    if (it->program_id == program_id)
+    {
+      const PendingProgram pp = *it;
+      m_pending_programs.erase(it);
+      if (!FinishProgram(pp))
+        Log_ErrorPrintf("Program %u failed to link, draws using it will be skipped.", program_id);
+
+      return;
+    }
+  }
+}
+
+bool OpenGLDevice::WaitForPipelineCompiles()
+{
+  // Programs are finished in whichever order the driver completes them. If none are done yet, wait on the oldest.
+  bool result = true;
+  while (!m_pending_programs.empty())
+  {
+    bool finished_any = false;
+    for (size_t i = 0; i < m_pending_programs.size();)
+    {
+      GLint completed = GL_FALSE;
+      glGetProgramiv(m_pending_programs[i].program_id, GL_COMPLETION_STATUS_KHR, &completed);
+      if (completed == GL_FALSE)
+      {
+        i++;
+        continue;
+      }
+
+      const PendingProgram pp = m_pending_programs[i];
+      m_pending_programs.erase(m_pending_programs.begin() + i);
+      result = FinishProgram(pp) && result;
+      finished_any = true;
+    }
+
+    if (!finished_any)
+    {
+      const PendingProgram pp = m_pending_programs.front();
+      m_pending_programs.erase(m_pending_programs.begin());
+      result = FinishProgram(pp) && result;
+    }
+  }
+
+  return result;
+}
+
 GLuint OpenGLDevice::LookupVAOCache(const OpenGLPipeline::VertexArrayCacheKey& key)
 {
   auto it = m_vao_cache.find(key);
@@ -709,6 +851,9 @@ void OpenGLDevice::SetPipeline(GPUPipeline* pipeline)
   OpenGLPipeline* const P = static_cast<OpenGLPipeline*>(pipeline);
   m_current_pipeline = P;
 
+  if (!m_pending_programs.empty()) [[unlikely]]
+    FinishPendingProgram(P->GetProgram());
+
   ApplyRasterizationState(P->GetRasterizationState());
   ApplyDepthState(P->GetDepthState());
   ApplyBlendState(P->GetBlendState());
@@ -871,7 +1016,7 @@ GLuint OpenGLDevice::CreateProgramFromPipelineCache(const OpenGLPipeline::Progra
     return 0;
   }
 
-  PostLinkProgram(plconfig, prog);
+  PostLinkProgram(plconfig.layout, prog);
 
   return prog;
 }
@@ -26,6 +26,8 @@ public:
 private:
   OpenGLShader(GPUShaderStage stage, const GPUShaderCache::CacheIndexKey& key, std::string source);
 
+  bool CheckCompileStatus(GLuint shader);
+
   GPUShaderCache::CacheIndexKey m_key;
   std::string m_source;
   std::optional<GLuint> m_id;
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #include "opengl_stream_buffer.h"
+#include "gpu_device.h"
 
 #include "common/align.h"
 #include "common/assert.h"
@@ -188,7 +189,12 @@ protected:
 
   ALWAYS_INLINE void WaitForSync(GLsync& sync)
   {
-    glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    // poll first, so we only count the waits which actually block
+    if (glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+    {
+      GPUDevice::s_stats.num_stream_buffer_stalls++;
+      glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+    }
     glDeleteSync(sync);
     sync = nullptr;
   }
@@ -219,6 +225,7 @@ protected:
 
       // rewind, and try again
       m_position = 0;
+      GPUDevice::s_stats.num_stream_buffer_wraps++;
 
       // wait for the sync at the start of the buffer
       WaitForSync(m_sync_objects[0]);
@@ -323,6 +330,77 @@ private:
   bool m_coherent;
 };
 
+// Maps each allocation with GL_MAP_UNSYNCHRONIZED_BIT, relying on the sync objects instead of the driver to avoid
+// overwriting data which is still in use. Used on desktop drivers without buffer_storage, e.g. macOS.
+class MapAndSyncStreamBuffer final : public SyncingStreamBuffer
+{
+public:
+  ~MapAndSyncStreamBuffer() override = default;
+
+  MappingResult Map(u32 alignment, u32 min_size) override
+  {
+    if (m_position > 0)
+      m_position = Common::AlignUp(m_position, alignment);
+
+    AllocateSpace(min_size);
+    DebugAssert((m_position + min_size) <= (m_available_block_index * m_bytes_per_block));
+
+    const u32 free_space_in_block = (std::min(m_available_block_index * m_bytes_per_block, m_size) - m_position);
+    glBindBuffer(m_target, m_buffer_id);
+    void* mapped_ptr = glMapBufferRange(m_target, m_position, free_space_in_block,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                          GL_MAP_FLUSH_EXPLICIT_BIT);
+    AssertMsg(mapped_ptr, "Stream buffer was mapped");
+    RestoreBinding();
+
+    return MappingResult{mapped_ptr, m_position, m_position / alignment, free_space_in_block / alignment};
+  }
+
+  u32 Unmap(u32 used_size) override
+  {
+    DebugAssert((m_position + used_size) <= m_size);
+    glBindBuffer(m_target, m_buffer_id);
+    if (used_size > 0)
+      glFlushMappedBufferRange(m_target, 0, used_size);
+    glUnmapBuffer(m_target);
+    RestoreBinding();
+
+    const u32 prev_position = m_position;
+    m_position += used_size;
+    return prev_position;
+  }
+
+  static std::unique_ptr<OpenGLStreamBuffer> Create(GLenum target, u32 size)
+  {
+    glGetError();
+
+    GLuint buffer_id;
+    glGenBuffers(1, &buffer_id);
+    glBindBuffer(target, buffer_id);
+    glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+
+    GLenum err = glGetError();
+    if (err != GL_NO_ERROR)
+    {
+      glBindBuffer(target, 0);
+      glDeleteBuffers(1, &buffer_id);
+      return {};
+    }
+
+    return std::unique_ptr<OpenGLStreamBuffer>(new MapAndSyncStreamBuffer(target, buffer_id, size));
+  }
+
+private:
+  MapAndSyncStreamBuffer(GLenum target, GLuint buffer_id, u32 size) : SyncingStreamBuffer(target, buffer_id, size) {}
+
+  // Client-memory texture uploads would read from a bound unpack buffer.
+  ALWAYS_INLINE void RestoreBinding()
+  {
+    if (m_target == GL_PIXEL_UNPACK_BUFFER)
+      glBindBuffer(m_target, 0);
+  }
+};
+
 } // namespace
 
 std::unique_ptr<OpenGLStreamBuffer> OpenGLStreamBuffer::Create(GLenum target, u32 size)
@@ -335,6 +413,14 @@ std::unique_ptr<OpenGLStreamBuffer> OpenGLStreamBuffer::Create(GLenum target, u3
       return buf;
   }
 
+  // Only desktop GL, mobile drivers are better off orphaning.
+  if (GLAD_GL_VERSION_3_0)
+  {
+    buf = MapAndSyncStreamBuffer::Create(target, size);
+    if (buf)
+      return buf;
+  }
+
   // BufferSubData is slower on all drivers except NVIDIA...
 #if 0
   const char* vendor = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
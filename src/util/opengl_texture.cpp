@@ -211,7 +211,9 @@ bool OpenGLTexture::Update(u32 x, u32 y, u32 width, u32 height, const void* data
   OpenGLDevice::BindUpdateTextureUnit();
   glBindTexture(target, m_id);
 
-  if (!sb || map_size > sb->GetChunkSize())
+  // Uploads larger than a chunk wait on more than one sync object, but that's still cheaper than the driver copying
+  // from client memory, which stalls on full VRAM updates. Only very large updates bypass the PBO.
+  if (!sb || map_size > (sb->GetSize() / 2))
   {
     GL_INS_FMT("Not using PBO for map size {}", map_size);
     glPixelStorei(GL_UNPACK_ROW_LENGTH, pitch / GetPixelSize());
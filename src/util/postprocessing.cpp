@@ -8,6 +8,7 @@
 #include "postprocessing_shader.h"
 #include "postprocessing_shader_fx.h"
 #include "postprocessing_shader_glsl.h"
+#include "shadergen.h"
 
 // TODO: Remove me
 #include "core/host.h"
@@ -21,9 +22,12 @@
 #include "common/path.h"
 #include "common/small_string.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 #include "common/timer.h"
 #include "fmt/format.h"
 
+#include <thread>
+
 Log_SetChannel(PostProcessing);
 
 // TODO: ProgressCallbacks for shader compiling, it can be a bit slow.
@@ -43,6 +47,8 @@ static void ClearStagesWithError(const Error& error);
 static SettingsInterface& GetLoadSettingsInterface();
 static void LoadStages();
 static void DestroyTextures();
+static bool IsOutputCacheable();
+static bool CheckCachedOutput(GPUTexture::Format format, u32 width, u32 height);
 
 static std::vector<std::unique_ptr<PostProcessing::Shader>> s_stages;
 static bool s_enabled = false;
@@ -58,6 +64,13 @@ static std::unique_ptr<GPUFramebuffer> s_input_framebuffer;
 static std::unique_ptr<GPUTexture> s_output_texture;
 static std::unique_ptr<GPUFramebuffer> s_output_framebuffer;
 
+// Output of the last run of the chain, for presenting again while the input doesn't change.
+static std::unique_ptr<GPUTexture> s_cached_output_texture;
+static std::unique_ptr<GPUFramebuffer> s_cached_output_framebuffer;
+static std::unique_ptr<GPUPipeline> s_cached_output_pipeline;
+static GPUTexture::Format s_cached_output_pipeline_format = GPUTexture::Format::Unknown;
+static bool s_cached_output_valid = false;
+
 static std::unordered_map<u64, std::unique_ptr<GPUSampler>> s_samplers;
 static std::unique_ptr<GPUTexture> s_dummy_texture;
 } // namespace PostProcessing
@@ -356,6 +369,7 @@ bool PostProcessing::IsEnabled()
 void PostProcessing::SetEnabled(bool enabled)
 {
   s_enabled = enabled;
+  s_cached_output_valid = false;
 }
 
 std::unique_ptr<PostProcessing::Shader> PostProcessing::TryLoadingShader(const std::string& shader_name,
@@ -440,6 +454,7 @@ void PostProcessing::LoadStages()
   SettingsInterface& si = GetLoadSettingsInterface();
 
   s_enabled = si.GetBoolValue("PostProcessing", "Enabled", false);
+  s_cached_output_valid = false;
 
   const u32 stage_count = Config::GetStageCount(si);
   if (stage_count == 0)
@@ -484,6 +499,7 @@ void PostProcessing::UpdateSettings()
   SettingsInterface& si = GetLoadSettingsInterface();
 
   s_enabled = si.GetBoolValue("PostProcessing", "Enabled", false);
+  s_cached_output_valid = false;
 
   const u32 stage_count = Config::GetStageCount(si);
   if (stage_count == 0)
@@ -511,9 +527,7 @@ void PostProcessing::UpdateSettings()
       if (i < s_stages.size())
         s_stages[i].reset();
 
-      // Force recompile.
-      s_target_format = GPUTexture::Format::Unknown;
-
+      // The new shader gets compiled on the next CheckTargets(), the other stages and the targets are kept.
       lock.unlock();
 
       std::unique_ptr<Shader> shader = TryLoadingShader(stage_name, false, &error);
@@ -557,6 +571,7 @@ void PostProcessing::Toggle()
                                         TRANSLATE_STR("OSDMessage", "Post-processing is now disabled."),
                           Host::OSD_QUICK_DURATION);
   s_enabled = new_enabled;
+  s_cached_output_valid = false;
   if (s_enabled)
     s_timer.Reset();
 }
@@ -587,6 +602,8 @@ void PostProcessing::Shutdown()
   s_enabled = false;
   decltype(s_stages)().swap(s_stages);
   DestroyTextures();
+  s_cached_output_pipeline.reset();
+  s_cached_output_pipeline_format = GPUTexture::Format::Unknown;
 }
 
 GPUTexture* PostProcessing::GetInputTexture()
@@ -634,28 +651,75 @@ GPUTexture* PostProcessing::GetDummyTexture()
 
 bool PostProcessing::CheckTargets(GPUTexture::Format target_format, u32 target_width, u32 target_height)
 {
-  if (s_target_format == target_format && s_target_width == target_width && s_target_height == target_height)
-    return true;
+  if (s_target_format != target_format || s_target_width != target_width || s_target_height != target_height)
+  {
+    // In case any allocs fail. Window resizes go back and forth between sizes, so keep the old targets around.
+    s_output_framebuffer.reset();
+    s_input_framebuffer.reset();
+    g_gpu_device->RecycleTexture(std::move(s_output_texture));
+    g_gpu_device->RecycleTexture(std::move(s_input_texture));
+    DestroyTextures();
+
+    if (!(s_input_texture = g_gpu_device->FetchTexture(target_width, target_height, 1, 1, 1,
+                                                       GPUTexture::Type::RenderTarget, target_format)) ||
+        !(s_input_framebuffer = g_gpu_device->CreateFramebuffer(s_input_texture.get())))
+    {
+      return false;
+    }
 
-  // In case any allocs fail.
-  DestroyTextures();
+    s_target_format = target_format;
+    s_target_width = target_width;
+    s_target_height = target_height;
+  }
 
-  if (!(s_input_texture = g_gpu_device->CreateTexture(target_width, target_height, 1, 1, 1,
-                                                      GPUTexture::Type::RenderTarget, target_format)) ||
-      !(s_input_framebuffer = g_gpu_device->CreateFramebuffer(s_input_texture.get())))
+  // Intermediate target is only needed to ping-pong between stages, the last one always draws to the final target.
+  if (s_stages.size() > 1)
   {
-    return false;
+    if (!s_output_texture)
+    {
+      if (!(s_output_texture = g_gpu_device->FetchTexture(target_width, target_height, 1, 1, 1,
+                                                          GPUTexture::Type::RenderTarget, target_format)) ||
+          !(s_output_framebuffer = g_gpu_device->CreateFramebuffer(s_output_texture.get())))
+      {
+        s_output_texture.reset();
+        return false;
+      }
+    }
+  }
+  else if (s_output_texture)
+  {
+    s_output_framebuffer.reset();
+    g_gpu_device->RecycleTexture(std::move(s_output_texture));
   }
 
-  if (!(s_output_texture = g_gpu_device->CreateTexture(target_width, target_height, 1, 1, 1,
-                                                       GPUTexture::Type::RenderTarget, target_format)) ||
-      !(s_output_framebuffer = g_gpu_device->CreateFramebuffer(s_output_texture.get())))
+  // Parse the stages which need rebuilding in parallel, creating the GPU objects has to stay on this thread.
+  std::vector<Shader*> stages_to_compile;
+  for (auto& shader : s_stages)
   {
-    return false;
+    if (!shader->IsCompiledFor(target_format, target_width, target_height))
+      stages_to_compile.push_back(shader.get());
+  }
+  if (stages_to_compile.size() > 1)
+  {
+    std::vector<std::thread> threads;
+    threads.reserve(stages_to_compile.size() - 1);
+    for (size_t i = 1; i < stages_to_compile.size(); i++)
+    {
+      threads.emplace_back([shader = stages_to_compile[i], target_width, target_height]() {
+        Threading::SetNameOfCurrentThread("Post-Processing Compiler");
+        shader->PrepareCompile(target_width, target_height);
+      });
+    }
+    stages_to_compile[0]->PrepareCompile(target_width, target_height);
+    for (std::thread& thread : threads)
+      thread.join();
   }
 
   for (auto& shader : s_stages)
   {
+    if (shader->IsCompiledFor(target_format, target_width, target_height))
+      continue;
+
     if (!shader->CompilePipeline(target_format, target_width, target_height) ||
         !shader->ResizeOutput(target_format, target_width, target_height))
     {
@@ -666,11 +730,20 @@ bool PostProcessing::CheckTargets(GPUTexture::Format target_format, u32 target_w
       s_enabled = false;
       return false;
     }
+
+    shader->SetCompiledFor(target_format, target_width, target_height);
+    s_cached_output_valid = false;
+  }
+
+  if (!g_gpu_device->WaitForPipelineCompiles())
+  {
+    Log_ErrorPrintf("Failed to link one or more post-processing shaders, disabling.");
+    Host::AddIconOSDMessage("PostProcessLoadFail", ICON_FA_EXCLAMATION_TRIANGLE,
+                            "Failed to compile post-processing shaders. Disabling post-processing.");
+    s_enabled = false;
+    return false;
   }
 
-  s_target_format = target_format;
-  s_target_width = target_width;
-  s_target_height = target_height;
   return true;
 }
 
@@ -685,10 +758,81 @@ void PostProcessing::DestroyTextures()
 
   s_input_framebuffer.reset();
   s_input_texture.reset();
+
+  s_cached_output_framebuffer.reset();
+  s_cached_output_texture.reset();
+  s_cached_output_valid = false;
+}
+
+bool PostProcessing::IsOutputCacheable()
+{
+  for (const std::unique_ptr<Shader>& stage : s_stages)
+  {
+    if (stage->IsTimeDependent())
+      return false;
+  }
+
+  return true;
+}
+
+bool PostProcessing::CheckCachedOutput(GPUTexture::Format format, u32 width, u32 height)
+{
+  if (s_cached_output_texture && (s_cached_output_texture->GetFormat() != format ||
+                                  s_cached_output_texture->GetWidth() != width ||
+                                  s_cached_output_texture->GetHeight() != height))
+  {
+    s_cached_output_framebuffer.reset();
+    g_gpu_device->RecycleTexture(std::move(s_cached_output_texture));
+  }
+
+  if (!s_cached_output_texture)
+  {
+    if (!(s_cached_output_texture =
+            g_gpu_device->FetchTexture(width, height, 1, 1, 1, GPUTexture::Type::RenderTarget, format)) ||
+        !(s_cached_output_framebuffer = g_gpu_device->CreateFramebuffer(s_cached_output_texture.get())))
+    {
+      s_cached_output_texture.reset();
+      return false;
+    }
+  }
+
+  if (s_cached_output_pipeline_format != format)
+  {
+    s_cached_output_pipeline.reset();
+    s_cached_output_pipeline_format = GPUTexture::Format::Unknown;
+
+    ShaderGen shadergen(g_gpu_device->GetRenderAPI(), g_gpu_device->GetFeatures().dual_source_blend);
+    std::unique_ptr<GPUShader> vs =
+      g_gpu_device->CreateShader(GPUShaderStage::Vertex, shadergen.GenerateScreenQuadVertexShader());
+    std::unique_ptr<GPUShader> fs =
+      g_gpu_device->CreateShader(GPUShaderStage::Fragment, shadergen.GenerateCopyFragmentShader());
+    if (!vs || !fs)
+      return false;
+
+    GPUPipeline::GraphicsConfig plconfig;
+    plconfig.layout = GPUPipeline::Layout::SingleTextureAndPushConstants;
+    plconfig.primitive = GPUPipeline::Primitive::Triangles;
+    plconfig.color_format = format;
+    plconfig.depth_format = GPUTexture::Format::Unknown;
+    plconfig.rasterization = GPUPipeline::RasterizationState::GetNoCullState();
+    plconfig.depth = GPUPipeline::DepthState::GetNoTestsState();
+    plconfig.blend = GPUPipeline::BlendState::GetNoBlendingState();
+    plconfig.samples = 1;
+    plconfig.per_sample_shading = false;
+    plconfig.vertex_shader = vs.get();
+    plconfig.fragment_shader = fs.get();
+    plconfig.geometry_shader = nullptr;
+    if (!(s_cached_output_pipeline = g_gpu_device->CreatePipeline(plconfig)))
+      return false;
+
+    s_cached_output_pipeline_format = format;
+  }
+
+  return true;
 }
 
 bool PostProcessing::Apply(GPUFramebuffer* final_target, s32 final_left, s32 final_top, s32 final_width,
-                           s32 final_height, s32 orig_width, s32 orig_height)
+                           s32 final_height, s32 orig_width, s32 orig_height, bool cache_output)
 {
   GL_SCOPE("PostProcessing Apply");
 
@@ -699,19 +843,31 @@ bool PostProcessing::Apply(GPUFramebuffer* final_target, s32 final_left, s32 fin
   if (!CheckTargets(target_format, target_width, target_height))
     return false;
 
+  // The final stage draws to the kept output instead of the swap chain, which is then copied over.
+  s_cached_output_valid = false;
+  GPUFramebuffer* stages_target = final_target;
+  if (cache_output && !final_target && IsOutputCacheable() &&
+      CheckCachedOutput(target_format, target_width, target_height))
+  {
+    stages_target = s_cached_output_framebuffer.get();
+    g_gpu_device->ClearRenderTarget(s_cached_output_texture.get(), 0);
+  }
+
   GPUTexture* input = s_input_texture.get();
   GPUFramebuffer* input_fb = s_input_framebuffer.get();
   GPUTexture* output = s_output_texture.get();
   GPUFramebuffer* output_fb = s_output_framebuffer.get();
   input->MakeReadyForSampling();
+  g_gpu_device->BeginTimingScope(GPUDevice::TimingScope::PostProcessing);
 
   for (const std::unique_ptr<Shader>& stage : s_stages)
   {
     const bool is_final = (stage.get() == s_stages.back().get());
 
-    if (!stage->Apply(input, is_final ? final_target : output_fb, final_left, final_top, final_width, final_height,
+    if (!stage->Apply(input, is_final ? stages_target : output_fb, final_left, final_top, final_width, final_height,
                       orig_width, orig_height, s_target_width, s_target_height))
     {
+      g_gpu_device->EndTimingScope();
       return false;
     }
 
@@ -723,5 +879,36 @@ bool PostProcessing::Apply(GPUFramebuffer* final_target, s32 final_left, s32 fin
     }
   }
 
+  g_gpu_device->EndTimingScope();
+
+  if (stages_target == final_target)
+    return true;
+
+  s_cached_output_valid = true;
+  return PresentCachedOutput();
+}
+
+bool PostProcessing::HasCachedOutput()
+{
+  return s_cached_output_valid;
+}
+
+bool PostProcessing::PresentCachedOutput()
+{
+  GL_SCOPE("PostProcessing Present Cached Output");
+  DebugAssert(s_cached_output_valid);
+
+  if (!g_gpu_device->BeginPresent(false))
+    return false;
+
+  const u32 width = s_cached_output_texture->GetWidth();
+  const u32 height = s_cached_output_texture->GetHeight();
+  const float uniforms[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+  s_cached_output_texture->MakeReadyForSampling();
+  g_gpu_device->SetPipeline(s_cached_output_pipeline.get());
+  g_gpu_device->SetTextureSampler(0, s_cached_output_texture.get(), g_gpu_device->GetNearestSampler());
+  g_gpu_device->SetViewportAndScissor(0, 0, width, height);
+  g_gpu_device->PushUniformBuffer(uniforms, sizeof(uniforms));
+  g_gpu_device->Draw(3, 0);
   return true;
 }
@@ -125,8 +125,16 @@ const Common::Timer& GetTimer();
 
 bool CheckTargets(GPUTexture::Format target_format, u32 target_width, u32 target_height);
 
+/// Runs the chain. When cache_output is set, drawing to the swap chain, and no stage depends on time, the output is
+/// also kept so that later frames with the same input can present it with PresentCachedOutput() instead.
 bool Apply(GPUFramebuffer* final_target, s32 final_left, s32 final_top, s32 final_width, s32 final_height,
-           s32 orig_width, s32 orig_height);
+           s32 orig_width, s32 orig_height, bool cache_output = false);
+
+/// Returns true if the output of the last Apply() was kept, and nothing which would change it has happened since.
+bool HasCachedOutput();
+
+/// Begins presentation and draws the kept output to the swap chain, without running any of the stages.
+bool PresentCachedOutput();
 
 GPUSampler* GetSampler(const GPUSampler::Config& config);
 GPUTexture* GetDummyTexture();
@@ -130,3 +130,7 @@ PostProcessing::ShaderOption* PostProcessing::Shader::GetOptionByName(const std:
 void PostProcessing::Shader::OnOptionChanged(const ShaderOption& option)
 {
 }
+
+void PostProcessing::Shader::PrepareCompile(u32 width, u32 height)
+{
+}
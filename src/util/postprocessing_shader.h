@@ -37,6 +37,10 @@ public:
 
   virtual bool IsValid() const = 0;
 
+  /// Returns true if the output can change while the input stays the same, e.g. from the timer, frame count or
+  /// textures carried over from the previous frame. Chains containing these stages can't reuse their last output.
+  virtual bool IsTimeDependent() const = 0;
+
   std::vector<ShaderOption> TakeOptions();
   void LoadOptions(const SettingsInterface& si, const char* section);
 
@@ -45,11 +49,27 @@ public:
 
   virtual bool ResizeOutput(GPUTexture::Format format, u32 width, u32 height) = 0;
 
+  /// Does the part of CompilePipeline() which doesn't need the GPU device ahead of time. Stages in a chain are
+  /// prepared concurrently on worker threads, so this must not touch any state shared with other shaders.
+  virtual void PrepareCompile(u32 width, u32 height);
+
   virtual bool CompilePipeline(GPUTexture::Format format, u32 width, u32 height) = 0;
 
   virtual bool Apply(GPUTexture* input, GPUFramebuffer* final_target, s32 final_left, s32 final_top, s32 final_width,
                      s32 final_height, s32 orig_width, s32 orig_height, u32 target_width, u32 target_height) = 0;
 
+  /// Target the pipeline and outputs were last built for, so stages which haven't changed aren't rebuilt.
+  ALWAYS_INLINE bool IsCompiledFor(GPUTexture::Format format, u32 width, u32 height) const
+  {
+    return (m_compiled_format == format && m_compiled_width == width && m_compiled_height == height);
+  }
+  ALWAYS_INLINE void SetCompiledFor(GPUTexture::Format format, u32 width, u32 height)
+  {
+    m_compiled_format = format;
+    m_compiled_width = width;
+    m_compiled_height = height;
+  }
+
 protected:
   static void ParseKeyValue(const std::string_view& line, std::string_view* key, std::string_view* value);
 
@@ -57,6 +77,11 @@ protected:
 
   std::string m_name;
   std::vector<ShaderOption> m_options;
+
+private:
+  GPUTexture::Format m_compiled_format = GPUTexture::Format::Unknown;
+  u32 m_compiled_width = 0;
+  u32 m_compiled_height = 0;
 };
 
 } // namespace PostProcessing
\ No newline at end of file
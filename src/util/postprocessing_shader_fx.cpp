@@ -14,6 +14,7 @@
 #include "common/file_system.h"
 #include "common/image.h"
 #include "common/log.h"
+#include "common/md5_digest.h"
 #include "common/path.h"
 #include "common/string_util.h"
 
@@ -27,13 +28,33 @@
 #include <cctype>
 #include <cmath>
 #include <cstring>
+#include <deque>
+#include <mutex>
 #include <sstream>
+#include <unordered_map>
 
 Log_SetChannel(ReShadeFXShader);
 
 static constexpr s32 DEFAULT_BUFFER_WIDTH = 3840;
 static constexpr s32 DEFAULT_BUFFER_HEIGHT = 2160;
 
+namespace {
+struct CachedModule
+{
+  std::array<u8, 16> source_hash;
+  RenderAPI api;
+  bool debug_info;
+  reshadefx::module mod;
+};
+} // namespace
+
+// Parsing and code generation are the slow part of loading an effect, and the same effect gets rebuilt each time the
+// chain is reloaded or the output is resized. Modules are cached by their preprocessed source, which includes the
+// buffer size and everything included by the effect, so a changed file or size can't hit a stale entry.
+static constexpr u32 MAX_CACHED_MODULES = 16;
+static std::mutex s_module_cache_mutex;
+static std::deque<CachedModule> s_module_cache;
+
 static RenderAPI GetRenderAPI()
 {
   return g_gpu_device ? g_gpu_device->GetRenderAPI() : RenderAPI::D3D11;
@@ -317,6 +338,47 @@ bool PostProcessing::ReShadeFXShader::IsValid() const
   return m_valid;
 }
 
+bool PostProcessing::ReShadeFXShader::IsTimeDependent() const
+{
+  for (const SourceOption& so : m_source_options)
+  {
+    switch (so.source)
+    {
+      case SourceOptionType::Timer:
+      case SourceOptionType::FrameTime:
+      case SourceOptionType::FrameCount:
+      case SourceOptionType::FrameCountF:
+      case SourceOptionType::PingPong:
+      case SourceOptionType::MousePoint:
+      case SourceOptionType::Random:
+      case SourceOptionType::RandomF:
+        return true;
+
+      default:
+        break;
+    }
+  }
+
+  // Render targets which are sampled before any pass draws to them still hold what the last frame left behind. Images
+  // loaded from files never change, so they count as written.
+  std::vector<bool> written(m_textures.size());
+  for (size_t i = 0; i < m_textures.size(); i++)
+    written[i] = (m_textures[i].rt_scale == 0.0f);
+  for (const Pass& pass : m_passes)
+  {
+    for (const Sampler& sampler : pass.samplers)
+    {
+      if (sampler.texture_id >= 0 && !written[static_cast<size_t>(sampler.texture_id)])
+        return true;
+    }
+
+    if (pass.render_target >= 0)
+      written[static_cast<size_t>(pass.render_target)] = true;
+  }
+
+  return false;
+}
+
 bool PostProcessing::ReShadeFXShader::CreateModule(s32 buffer_width, s32 buffer_height, reshadefx::module* mod,
                                                    Error* error)
 {
@@ -356,12 +418,38 @@ bool PostProcessing::ReShadeFXShader::CreateModule(s32 buffer_width, s32 buffer_
     return false;
   }
 
+  const std::string& source = pp.output();
+  const RenderAPI api = GetRenderAPI();
+  const bool debug_info = g_gpu_device ? g_gpu_device->IsDebugDevice() : false;
+  std::array<u8, 16> source_hash;
+  MD5Digest digest;
+  digest.Update(source.data(), static_cast<u32>(source.size()));
+  digest.Final(source_hash.data());
+
+  {
+    std::unique_lock lock(s_module_cache_mutex);
+    for (auto it = s_module_cache.begin(); it != s_module_cache.end(); ++it)
+    {
+      if (it->source_hash == source_hash && it->api == api && it->debug_info == debug_info)
+      {
+        *mod = it->mod;
+        if (it != s_module_cache.begin())
+        {
+          CachedModule entry = std::move(*it);
+          s_module_cache.erase(it);
+          s_module_cache.push_front(std::move(entry));
+        }
+        return true;
+      }
+    }
+  }
+
   std::unique_ptr<reshadefx::codegen> cg = CreateRFXCodegen();
   if (!cg)
     return false;
 
   reshadefx::parser parser;
-  if (!parser.parse(pp.output(), cg.get()))
+  if (!parser.parse(source, cg.get()))
   {
     Error::SetString(error, fmt::format("Failed to parse:\n{}", parser.errors()));
     return false;
@@ -369,6 +457,13 @@ bool PostProcessing::ReShadeFXShader::CreateModule(s32 buffer_width, s32 buffer_
 
   cg->write_result(*mod);
 
+  {
+    std::unique_lock lock(s_module_cache_mutex);
+    if (s_module_cache.size() >= MAX_CACHED_MODULES)
+      s_module_cache.pop_back();
+    s_module_cache.push_front(CachedModule{source_hash, api, debug_info, *mod});
+  }
+
   // FileSystem::WriteBinaryFile("D:\\out.txt", mod->code.data(), mod->code.size());
   return true;
 }
@@ -1004,6 +1099,18 @@ GPUFramebuffer* PostProcessing::ReShadeFXShader::GetFramebufferByID(TextureID id
   return tex.framebuffer.get();
 }
 
+void PostProcessing::ReShadeFXShader::PrepareCompile(u32 width, u32 height)
+{
+  // Errors are reported by CompilePipeline(), which tries again.
+  std::unique_ptr<reshadefx::module> mod = std::make_unique<reshadefx::module>();
+  if (!CreateModule(width, height, mod.get(), nullptr))
+    mod.reset();
+
+  m_prepared_module = std::move(mod);
+  m_prepared_width = width;
+  m_prepared_height = height;
+}
+
 bool PostProcessing::ReShadeFXShader::CompilePipeline(GPUTexture::Format format, u32 width, u32 height)
 {
   const RenderAPI api = g_gpu_device->GetRenderAPI();
@@ -1015,8 +1122,14 @@ bool PostProcessing::ReShadeFXShader::CompilePipeline(GPUTexture::Format format,
 
   Error error;
   reshadefx::module mod;
-  if (!CreateModule(width, height, &mod, &error))
+  if (m_prepared_module && m_prepared_width == width && m_prepared_height == height)
   {
+    mod = std::move(*m_prepared_module);
+    m_prepared_module.reset();
+  }
+  else if (!CreateModule(width, height, &mod, &error))
+  {
+    m_prepared_module.reset();
     Log_ErrorPrintf("Failed to create module for '%s': %s", m_name.c_str(), error.GetDescription().c_str());
     return false;
   }
@@ -1031,8 +1144,10 @@ bool PostProcessing::ReShadeFXShader::CompilePipeline(GPUTexture::Format format,
 
   const std::string_view code(mod.code.data(), mod.code.size());
 
-  auto get_shader = [needs_main_defn, &code](const std::string& name, const std::vector<Sampler>& samplers,
-                                             GPUShaderStage stage) {
+  // Passes usually share a vertex shader, so each unique shader is only created once per pipeline build.
+  std::unordered_map<std::string, std::unique_ptr<GPUShader>> shaders;
+  auto get_shader = [needs_main_defn, &code, &shaders](const std::string& name, const std::vector<Sampler>& samplers,
+                                                       GPUShaderStage stage) -> GPUShader* {
     std::string real_code;
     if (needs_main_defn)
     {
@@ -1067,12 +1182,19 @@ bool PostProcessing::ReShadeFXShader::CompilePipeline(GPUTexture::Format format,
 
     // FileSystem::WriteStringToFile("D:\\foo.txt", real_code);
 
+    std::string key = fmt::format("{}:{}\n{}", static_cast<u32>(stage), name, real_code);
+    if (const auto it = shaders.find(key); it != shaders.end())
+      return it->second.get();
+
     std::unique_ptr<GPUShader> sshader =
       g_gpu_device->CreateShader(stage, real_code, needs_main_defn ? "main" : name.c_str());
     if (!sshader)
+    {
       Log_ErrorPrintf("Failed to compile function '%s'", name.c_str());
+      return nullptr;
+    }
 
-    return sshader;
+    return shaders.emplace(std::move(key), std::move(sshader)).first->second.get();
   };
 
   GPUPipeline::GraphicsConfig plconfig;
@@ -1093,16 +1215,16 @@ bool PostProcessing::ReShadeFXShader::CompilePipeline(GPUTexture::Format format,
       DebugAssert(passnum < m_passes.size());
       Pass& pass = m_passes[passnum++];
 
-      auto vs = get_shader(info.vs_entry_point, pass.samplers, GPUShaderStage::Vertex);
-      auto fs = get_shader(info.ps_entry_point, pass.samplers, GPUShaderStage::Fragment);
+      GPUShader* vs = get_shader(info.vs_entry_point, pass.samplers, GPUShaderStage::Vertex);
+      GPUShader* fs = get_shader(info.ps_entry_point, pass.samplers, GPUShaderStage::Fragment);
       if (!vs || !fs)
         return false;
 
       plconfig.color_format = (pass.render_target >= 0) ? m_textures[pass.render_target].format : format;
       plconfig.blend = MapBlendState(info);
       plconfig.primitive = MapPrimitive(info.topology);
-      plconfig.vertex_shader = vs.get();
-      plconfig.fragment_shader = fs.get();
+      plconfig.vertex_shader = vs;
+      plconfig.fragment_shader = fs;
       plconfig.geometry_shader = nullptr;
       if (!plconfig.vertex_shader || !plconfig.fragment_shader)
         return false;
@@ -1130,11 +1252,11 @@ bool PostProcessing::ReShadeFXShader::ResizeOutput(GPUTexture::Format format, u3
       continue;
 
     tex.framebuffer.reset();
-    tex.texture.reset();
+    g_gpu_device->RecycleTexture(std::move(tex.texture));
 
     const u32 t_width = std::max(static_cast<u32>(static_cast<float>(width) * tex.rt_scale), 1u);
     const u32 t_height = std::max(static_cast<u32>(static_cast<float>(height) * tex.rt_scale), 1u);
-    tex.texture = g_gpu_device->CreateTexture(t_width, t_height, 1, 1, 1, GPUTexture::Type::RenderTarget, tex.format);
+    tex.texture = g_gpu_device->FetchTexture(t_width, t_height, 1, 1, 1, GPUTexture::Type::RenderTarget, tex.format);
     if (!tex.texture)
     {
       Log_ErrorPrintf("Failed to create %ux%u texture", t_width, t_height);
@@ -10,6 +10,7 @@
 // reshadefx
 #include "effect_module.hpp"
 
+#include <memory>
 #include <random>
 
 class Error;
@@ -23,10 +24,12 @@ public:
   ~ReShadeFXShader();
 
   bool IsValid() const override;
+  bool IsTimeDependent() const override;
 
   bool LoadFromFile(std::string name, const char* filename, bool only_config, Error* error);
 
   bool ResizeOutput(GPUTexture::Format format, u32 width, u32 height) override;
+  void PrepareCompile(u32 width, u32 height) override;
   bool CompilePipeline(GPUTexture::Format format, u32 width, u32 height) override;
   bool Apply(GPUTexture* input, GPUFramebuffer* final_target, s32 final_left, s32 final_top, s32 final_width,
              s32 final_height, s32 orig_width, s32 orig_height, u32 target_width, u32 target_height) override;
@@ -115,6 +118,12 @@ private:
 
   std::vector<Pass> m_passes;
   std::vector<Texture> m_textures;
+
+  // Module generated by PrepareCompile(), consumed by the next CompilePipeline() for the same size.
+  std::unique_ptr<reshadefx::module> m_prepared_module;
+  u32 m_prepared_width = 0;
+  u32 m_prepared_height = 0;
+
   std::vector<SourceOption> m_source_options;
   u32 m_uniforms_size = 0;
   bool m_valid = false;
@@ -62,6 +62,13 @@ bool PostProcessing::GLSLShader::IsValid() const
   return !m_name.empty() && !m_code.empty();
 }
 
+bool PostProcessing::GLSLShader::IsTimeDependent() const
+{
+  // The time is always in the uniform block, so it depends on whether the code reads it. Matching any mention of it
+  // errs on the side of running the shader.
+  return (m_code.find("GetTime") != std::string::npos || m_code.find("time") != std::string::npos);
+}
+
 u32 PostProcessing::GLSLShader::GetUniformsSize() const
 {
   // lazy packing. todo improve.
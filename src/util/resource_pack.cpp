@@ -0,0 +1,320 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#include "resource_pack.h"
+
+#include "common/file_system.h"
+#include "common/heterogeneous_containers.h"
+#include "common/log.h"
+#include "common/memmap.h"
+
+#include "zlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+
+Log_SetChannel(ResourcePack);
+
+namespace ResourcePack {
+struct Entry
+{
+  u32 header_offset;
+  u32 compressed_size;
+  u32 uncompressed_size;
+  u32 crc;
+  u16 method;
+};
+
+// Only the parts of the zip format which can be read straight out of the mapping, no zip64 or encryption.
+static constexpr u32 LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static constexpr u32 LOCAL_HEADER_SIZE = 30;
+static constexpr u32 CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static constexpr u32 CENTRAL_HEADER_SIZE = 46;
+static constexpr u32 END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
+static constexpr u32 END_OF_CENTRAL_DIRECTORY_SIZE = 22;
+static constexpr u32 MAX_COMMENT_SIZE = 0xFFFF;
+static constexpr u16 METHOD_STORED = 0;
+static constexpr u16 METHOD_DEFLATED = 8;
+
+template<typename T>
+static T ReadValue(const u8* ptr);
+
+static bool EnsureOpen();
+static bool Open();
+static bool ReadIndex();
+static const Entry* FindEntry(const char* name);
+template<typename T>
+static std::optional<T> ReadEntry(const char* name);
+
+static std::mutex s_open_mutex;
+static std::atomic_bool s_open_attempted{false};
+static std::string s_path;
+static u8* s_data = nullptr;
+static size_t s_data_size = 0;
+static std::time_t s_timestamp = 0;
+static PreferUnorderedStringMap<Entry> s_entries;
+} // namespace ResourcePack
+
+template<typename T>
+T ResourcePack::ReadValue(const u8* ptr)
+{
+  T value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+void ResourcePack::SetPath(std::string path)
+{
+  Close();
+
+  std::unique_lock lock(s_open_mutex);
+  s_path = std::move(path);
+}
+
+void ResourcePack::Close()
+{
+  std::unique_lock lock(s_open_mutex);
+  if (s_data)
+  {
+    MemMap::UnmapFile(s_data, s_data_size);
+    s_data = nullptr;
+    s_data_size = 0;
+  }
+
+  s_entries.clear();
+  s_timestamp = 0;
+  s_open_attempted.store(false, std::memory_order_release);
+}
+
+bool ResourcePack::EnsureOpen()
+{
+  // The index never changes once it has been read, so lookups after the first don't need the lock.
+  if (s_open_attempted.load(std::memory_order_acquire))
+    return (s_data != nullptr);
+
+  std::unique_lock lock(s_open_mutex);
+  if (!s_open_attempted.load(std::memory_order_relaxed))
+  {
+    Open();
+    s_open_attempted.store(true, std::memory_order_release);
+  }
+
+  return (s_data != nullptr);
+}
+
+bool ResourcePack::Open()
+{
+  FILESYSTEM_STAT_DATA sd;
+  if (s_path.empty() || !FileSystem::StatFile(s_path.c_str(), &sd))
+  {
+    Log_DevPrintf("No resource pack, using loose resource files.");
+    return false;
+  }
+
+  s_data = static_cast<u8*>(MemMap::MapFileReadOnly(s_path.c_str(), &s_data_size));
+  if (!s_data)
+  {
+    Log_ErrorPrintf("Failed to map resource pack '%s'", s_path.c_str());
+    return false;
+  }
+
+  if (!ReadIndex())
+  {
+    Log_ErrorPrintf("Resource pack '%s' is corrupted, using loose resource files.", s_path.c_str());
+    MemMap::UnmapFile(s_data, s_data_size);
+    s_data = nullptr;
+    s_data_size = 0;
+    s_entries.clear();
+    return false;
+  }
+
+  s_timestamp = sd.ModificationTime;
+  Log_InfoPrintf("Mapped resource pack with %zu resources.", s_entries.size());
+  return true;
+}
+
+bool ResourcePack::ReadIndex()
+{
+  if (s_data_size < END_OF_CENTRAL_DIRECTORY_SIZE)
+    return false;
+
+  // The end of central directory record is followed by a variable length comment, so it has to be searched for.
+  const size_t search_end = s_data_size - END_OF_CENTRAL_DIRECTORY_SIZE;
+  const size_t search_start = (search_end > MAX_COMMENT_SIZE) ? (search_end - MAX_COMMENT_SIZE) : 0;
+  const u8* eocd = nullptr;
+  for (size_t pos = search_end + 1; pos-- > search_start;)
+  {
+    if (ReadValue<u32>(s_data + pos) == END_OF_CENTRAL_DIRECTORY_SIGNATURE)
+    {
+      eocd = s_data + pos;
+      break;
+    }
+  }
+  if (!eocd)
+    return false;
+
+  const u16 entry_count = ReadValue<u16>(eocd + 10);
+  const u32 directory_size = ReadValue<u32>(eocd + 12);
+  const u32 directory_offset = ReadValue<u32>(eocd + 16);
+  if ((static_cast<size_t>(directory_offset) + directory_size) > s_data_size)
+    return false;
+
+  const u8* ptr = s_data + directory_offset;
+  const u8* const end = ptr + directory_size;
+  s_entries.reserve(entry_count);
+  for (u32 i = 0; i < entry_count; i++)
+  {
+    if (static_cast<size_t>(end - ptr) < CENTRAL_HEADER_SIZE || ReadValue<u32>(ptr) != CENTRAL_HEADER_SIGNATURE)
+      return false;
+
+    const u16 flags = ReadValue<u16>(ptr + 8);
+    const u16 name_length = ReadValue<u16>(ptr + 28);
+    const u16 extra_length = ReadValue<u16>(ptr + 30);
+    const u16 comment_length = ReadValue<u16>(ptr + 32);
+    const size_t header_size = CENTRAL_HEADER_SIZE + name_length + extra_length + comment_length;
+    if (static_cast<size_t>(end - ptr) < header_size)
+      return false;
+
+    Entry entry;
+    entry.method = ReadValue<u16>(ptr + 10);
+    entry.crc = ReadValue<u32>(ptr + 16);
+    entry.compressed_size = ReadValue<u32>(ptr + 20);
+    entry.uncompressed_size = ReadValue<u32>(ptr + 24);
+    entry.header_offset = ReadValue<u32>(ptr + 42);
+
+    const std::string_view name(reinterpret_cast<const char*>(ptr + CENTRAL_HEADER_SIZE), name_length);
+    ptr += header_size;
+
+    // Directories don't need an entry, and encrypted or unusually compressed files can't be read.
+    if (name.empty() || name.back() == '/')
+      continue;
+    if ((flags & 1) != 0 || (entry.method != METHOD_STORED && entry.method != METHOD_DEFLATED))
+    {
+      Log_WarningPrintf("Unsupported resource '%.*s' in pack", static_cast<int>(name.size()), name.data());
+      continue;
+    }
+
+    s_entries.emplace(name, entry);
+  }
+
+  return true;
+}
+
+const ResourcePack::Entry* ResourcePack::FindEntry(const char* name)
+{
+  if (!EnsureOpen())
+    return nullptr;
+
+  // Callers build some names with the native separator, the pack always uses forward slashes.
+  std::string_view lookup_name(name);
+  std::string normalized_name;
+  if (lookup_name.find('\\') != std::string_view::npos)
+  {
+    normalized_name = lookup_name;
+    std::replace(normalized_name.begin(), normalized_name.end(), '\\', '/');
+    lookup_name = normalized_name;
+  }
+
+  const auto iter = s_entries.find(lookup_name);
+  return (iter != s_entries.end()) ? &iter->second : nullptr;
+}
+
+template<typename T>
+std::optional<T> ResourcePack::ReadEntry(const char* name)
+{
+  std::optional<T> ret;
+  const Entry* entry = FindEntry(name);
+  if (!entry)
+    return ret;
+
+  // Local headers can carry different extra data to the central directory, so the data offset is only known here.
+  const size_t header_offset = entry->header_offset;
+  if ((header_offset + LOCAL_HEADER_SIZE) > s_data_size ||
+      ReadValue<u32>(s_data + header_offset) != LOCAL_HEADER_SIGNATURE)
+  {
+    Log_ErrorPrintf("Invalid local header for resource '%s'", name);
+    return ret;
+  }
+
+  const size_t data_offset = header_offset + LOCAL_HEADER_SIZE + ReadValue<u16>(s_data + header_offset + 26) +
+                             ReadValue<u16>(s_data + header_offset + 28);
+  if ((data_offset + entry->compressed_size) > s_data_size)
+  {
+    Log_ErrorPrintf("Resource '%s' is truncated", name);
+    return ret;
+  }
+
+  // Decompressing straight from the mapping only touches the pages of this resource, and needs no lock.
+  const u8* compressed = s_data + data_offset;
+  ret.emplace();
+  ret->resize(entry->uncompressed_size);
+  if (entry->method == METHOD_STORED)
+  {
+    if (entry->compressed_size != entry->uncompressed_size)
+    {
+      Log_ErrorPrintf("Size mismatch for stored resource '%s'", name);
+      ret.reset();
+      return ret;
+    }
+
+    std::memcpy(ret->data(), compressed, entry->uncompressed_size);
+  }
+  else
+  {
+    z_stream zs = {};
+    if (inflateInit2(&zs, -MAX_WBITS) != Z_OK)
+    {
+      Log_ErrorPrintf("inflateInit2() failed for resource '%s'", name);
+      ret.reset();
+      return ret;
+    }
+
+    zs.next_in = const_cast<Bytef*>(compressed);
+    zs.avail_in = entry->compressed_size;
+    zs.next_out = reinterpret_cast<Bytef*>(ret->data());
+    zs.avail_out = entry->uncompressed_size;
+    const int res = inflate(&zs, Z_FINISH);
+    const uLong decompressed_size = zs.total_out;
+    inflateEnd(&zs);
+    if (res != Z_STREAM_END || decompressed_size != entry->uncompressed_size)
+    {
+      Log_ErrorPrintf("Failed to decompress resource '%s': %d", name, res);
+      ret.reset();
+      return ret;
+    }
+  }
+
+  if (crc32(0, reinterpret_cast<const Bytef*>(ret->data()), static_cast<uInt>(ret->size())) != entry->crc)
+  {
+    Log_ErrorPrintf("CRC mismatch for resource '%s'", name);
+    ret.reset();
+  }
+
+  return ret;
+}
+
+bool ResourcePack::HasFile(const char* name)
+{
+  return (FindEntry(name) != nullptr);
+}
+
+std::optional<std::vector<u8>> ResourcePack::ReadFile(const char* name)
+{
+  return ReadEntry<std::vector<u8>>(name);
+}
+
+std::optional<std::string> ResourcePack::ReadFileToString(const char* name)
+{
+  return ReadEntry<std::string>(name);
+}
+
+std::optional<std::time_t> ResourcePack::GetFileTimestamp(const char* name)
+{
+  if (!FindEntry(name))
+    return std::nullopt;
+
+  return s_timestamp;
+}
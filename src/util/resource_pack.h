@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2019-2023 Connor McLaughlin <stenzek@gmail.com>
+// SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
+
+#pragma once
+
+#include "common/types.h"
+
+#include <ctime>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Built-in resources packed into a single zip archive, which is mapped rather than read, and only decompressed one
+/// resource at a time as they are requested. Resources which aren't in the pack, or an installation without one, fall
+/// back to the loose files in the resources directory.
+namespace ResourcePack {
+
+/// Name of the pack in the resources directory. Built by scripts/pack_resources.py.
+static constexpr const char* FILENAME = "resources.zip";
+
+/// Sets the path the pack will be opened from. Nothing is opened until the first lookup.
+void SetPath(std::string path);
+
+/// Unmaps the pack. Must not be called while other threads could be reading resources.
+void Close();
+
+/// Returns true if the pack exists and contains the resource. Names are relative to the resources directory.
+bool HasFile(const char* name);
+
+/// Decompresses a resource from the pack, or returns nullopt if it isn't packed.
+std::optional<std::vector<u8>> ReadFile(const char* name);
+std::optional<std::string> ReadFileToString(const char* name);
+
+/// Returns the modification time of the pack, if it contains the resource.
+std::optional<std::time_t> GetFileTimestamp(const char* name);
+
+} // namespace ResourcePack
@@ -24,6 +24,11 @@ public:
   };
 
   StateWrapper(ByteStream* stream, Mode mode, u32 version);
+
+  /// Reads/writes directly from/to a memory buffer, bypassing the stream. Used for memory save states, where the
+  /// per-call overhead of the virtual stream methods is significant.
+  StateWrapper(void* memory, size_t memory_size, Mode mode, u32 version);
+
   StateWrapper(const StateWrapper&) = delete;
   ~StateWrapper();
 
@@ -35,19 +40,22 @@ public:
   void SetMode(Mode mode) { m_mode = mode; }
   u32 GetVersion() const { return m_version; }
 
+  /// Returns the current offset from the start of the stream/buffer.
+  u64 GetPosition() const { return m_stream ? m_stream->GetPosition() : static_cast<u64>(m_memory_position); }
+
   /// Overload for integral or floating-point types. Writes bytes as-is.
   template<typename T, std::enable_if_t<std::is_integral_v<T> || std::is_floating_point_v<T>, int> = 0>
   void Do(T* value_ptr)
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (m_error || (m_error |= !ReadData(value_ptr, sizeof(T))) == true)
         *value_ptr = static_cast<T>(0);
     }
     else
     {
       if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+        m_error |= !WriteData(value_ptr, sizeof(T));
     }
   }
 
@@ -59,7 +67,7 @@ public:
     if (m_mode == Mode::Read)
     {
       TType temp;
-      if (m_error || (m_error |= !m_stream->Read2(&temp, sizeof(TType))) == true)
+      if (m_error || (m_error |= !ReadData(&temp, sizeof(TType))) == true)
         temp = static_cast<TType>(0);
 
       *value_ptr = static_cast<T>(temp);
@@ -69,7 +77,7 @@ public:
       TType temp;
       std::memcpy(&temp, value_ptr, sizeof(TType));
       if (!m_error)
-        m_error |= !m_stream->Write2(&temp, sizeof(TType));
+        m_error |= !WriteData(&temp, sizeof(TType));
     }
   }
 
@@ -79,28 +87,58 @@ public:
   {
     if (m_mode == Mode::Read)
     {
-      if (m_error || (m_error |= !m_stream->Read2(value_ptr, sizeof(T))) == true)
+      if (m_error || (m_error |= !ReadData(value_ptr, sizeof(T))) == true)
         std::memset(value_ptr, 0, sizeof(*value_ptr));
     }
     else
     {
       if (!m_error)
-        m_error |= !m_stream->Write2(value_ptr, sizeof(T));
+        m_error |= !WriteData(value_ptr, sizeof(T));
     }
   }
 
+  /// Copies a block of plain data, such as a device's register file, in a single operation, rather than field by field.
+  /// The block is tagged with its size, so a layout which differs between builds fails to load instead of being
+  /// misread. States older than version_introduced stored the fields individually, and are read by calling legacy().
+  /// Any change to the layout of T requires a new state version.
+  template<typename T, typename F>
+  void DoPODSection(T* block, u32 version_introduced, const F& legacy)
+  {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (m_mode == Mode::Read && m_version < version_introduced)
+    {
+      legacy();
+      return;
+    }
+
+    u32 size = static_cast<u32>(sizeof(T));
+    Do(&size);
+    if (m_mode == Mode::Read && size != sizeof(T))
+      m_error = true;
+
+    DoBytes(block, sizeof(T));
+  }
+
   template<typename T>
   void DoArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      Do(&values[i]);
+    // integral/floating-point elements are written as-is, so the whole array can be copied at once
+    if constexpr ((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>)
+    {
+      DoBytes(values, sizeof(T) * count);
+    }
+    else
+    {
+      for (size_t i = 0; i < count; i++)
+        Do(&values[i]);
+    }
   }
 
   template<typename T>
   void DoPODArray(T* values, size_t count)
   {
-    for (size_t i = 0; i < count; i++)
-      DoPOD(&values[i]);
+    static_assert(std::is_standard_layout_v<T> && std::is_trivial_v<T>);
+    DoBytes(values, sizeof(T) * count);
   }
 
   void DoBytes(void* data, size_t length);
@@ -192,6 +230,16 @@ public:
     Do(data);
   }
 
+  /// Returns the next length bytes when reading from memory, without consuming them. Null for streams, or if there
+  /// aren't enough bytes left.
+  const u8* PeekBytes(size_t length) const
+  {
+    if (m_mode != Mode::Read || m_stream || m_error || length > (m_memory_size - m_memory_position))
+      return nullptr;
+
+    return m_memory + m_memory_position;
+  }
+
   void SkipBytes(size_t count)
   {
     if (m_mode != Mode::Read)
@@ -200,12 +248,52 @@ public:
       return;
     }
 
-    if (!m_error)
+    if (m_error)
+      return;
+
+    if (m_stream)
+    {
       m_error = !m_stream->SeekRelative(static_cast<s64>(count));
+    }
+    else
+    {
+      m_error = (count > (m_memory_size - m_memory_position));
+      if (!m_error)
+        m_memory_position += count;
+    }
   }
 
 private:
-  ByteStream* m_stream;
+  ALWAYS_INLINE bool ReadData(void* data, size_t length)
+  {
+    if (m_stream)
+      return m_stream->Read2(data, static_cast<u32>(length));
+
+    if (length > (m_memory_size - m_memory_position))
+      return false;
+
+    std::memcpy(data, m_memory + m_memory_position, length);
+    m_memory_position += length;
+    return true;
+  }
+
+  ALWAYS_INLINE bool WriteData(const void* data, size_t length)
+  {
+    if (m_stream)
+      return m_stream->Write2(data, static_cast<u32>(length));
+
+    if (length > (m_memory_size - m_memory_position))
+      return false;
+
+    std::memcpy(m_memory + m_memory_position, data, length);
+    m_memory_position += length;
+    return true;
+  }
+
+  ByteStream* m_stream = nullptr;
+  u8* m_memory = nullptr;
+  size_t m_memory_size = 0;
+  size_t m_memory_position = 0;
   Mode m_mode;
   u32 m_version;
   bool m_error = false;
@@ -293,6 +293,39 @@ VkPipeline Vulkan::GraphicsPipelineBuilder::Create(VkDevice device, VkPipelineCa
   return pipeline;
 }
 
+VkPipeline Vulkan::GraphicsPipelineBuilder::CreateLibrary(VkDevice device, VkPipelineCache pipeline_cache,
+                                                          VkGraphicsPipelineLibraryFlagsEXT parts)
+{
+  // Other state is skipped for parts it doesn't belong to, but stages for another part are an error.
+  std::array<VkPipelineShaderStageCreateInfo, MAX_SHADER_STAGES> stages;
+  u32 num_stages = 0;
+  for (u32 i = 0; i < m_ci.stageCount; i++)
+  {
+    const bool fragment = (m_shader_stages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT);
+    if (parts & (fragment ? VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT :
+                            VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT))
+      stages[num_stages++] = m_shader_stages[i];
+  }
+
+  VkGraphicsPipelineLibraryCreateInfoEXT library_info = {VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+                                                         m_ci.pNext, parts};
+  VkGraphicsPipelineCreateInfo ci = m_ci;
+  ci.pNext = &library_info;
+  ci.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+  ci.stageCount = num_stages;
+  ci.pStages = (num_stages > 0) ? stages.data() : nullptr;
+
+  VkPipeline pipeline;
+  VkResult res = vkCreateGraphicsPipelines(device, pipeline_cache, 1, &ci, nullptr, &pipeline);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkCreateGraphicsPipelines() failed for library: ");
+    return VK_NULL_HANDLE;
+  }
+
+  return pipeline;
+}
+
 void Vulkan::GraphicsPipelineBuilder::SetShaderStage(VkShaderStageFlagBits stage, VkShaderModule module,
                                                      const char* entry_point)
 {
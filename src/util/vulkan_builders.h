@@ -89,6 +89,10 @@ public:
 
   VkPipeline Create(VkDevice device, VkPipelineCache pipeline_cache = VK_NULL_HANDLE, bool clear = true);
 
+  /// Creates a pipeline library from the state for the given parts, the rest of the state is ignored.
+  /// The builder isn't cleared, so each part of a pipeline can be created from the same state.
+  VkPipeline CreateLibrary(VkDevice device, VkPipelineCache pipeline_cache, VkGraphicsPipelineLibraryFlagsEXT parts);
+
   void SetShaderStage(VkShaderStageFlagBits stage, VkShaderModule module, const char* entry_point);
   void SetVertexShader(VkShaderModule module) { SetShaderStage(VK_SHADER_STAGE_VERTEX_BIT, module, "main"); }
   void SetGeometryShader(VkShaderModule module) { SetShaderStage(VK_SHADER_STAGE_GEOMETRY_BIT, module, "main"); }
@@ -356,6 +356,9 @@ bool VulkanDevice::SelectDeviceExtensions(ExtensionList* extension_list, bool en
     SupportsExtension(VK_EXT_ATTACHMENT_FEEDBACK_LOOP_LAYOUT_EXTENSION_NAME, false);
   m_optional_extensions.vk_khr_driver_properties = SupportsExtension(VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME, false);
   m_optional_extensions.vk_khr_push_descriptor = SupportsExtension(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME, false);
+  m_optional_extensions.vk_ext_graphics_pipeline_library =
+    SupportsExtension(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, false) &&
+    SupportsExtension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, false);
 
 #ifdef _WIN32
   m_optional_extensions.vk_ext_full_screen_exclusive =
@@ -446,6 +449,23 @@ bool VulkanDevice::CreateDevice(VkSurfaceKHR surface, bool enable_validation_lay
     return false;
   }
 
+  // A compute-only family is what runs alongside the graphics queue on the hardware, rather than being interleaved.
+  // Nothing is submitted to it yet, the device can't create compute pipelines.
+  m_compute_queue_family_index = INVALID_QUEUE_FAMILY_INDEX;
+  for (u32 i = 0; i < queue_family_count; i++)
+  {
+    if ((queue_family_properties[i].queueFlags & (VK_QUEUE_COMPUTE_BIT | VK_QUEUE_GRAPHICS_BIT)) ==
+        VK_QUEUE_COMPUTE_BIT)
+    {
+      m_compute_queue_family_index = i;
+      break;
+    }
+  }
+  if (m_compute_queue_family_index != INVALID_QUEUE_FAMILY_INDEX)
+    Log_DevPrintf("Dedicated compute queue family: %u", m_compute_queue_family_index);
+  else
+    Log_DevPrintf("No dedicated compute queue family");
+
   VkDeviceCreateInfo device_info = {};
   device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
   device_info.pNext = nullptr;
@@ -501,11 +521,15 @@ bool VulkanDevice::CreateDevice(VkSurfaceKHR surface, bool enable_validation_lay
     VK_FALSE};
   VkPhysicalDeviceAttachmentFeedbackLoopLayoutFeaturesEXT attachment_feedback_loop_feature = {
     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ATTACHMENT_FEEDBACK_LOOP_LAYOUT_FEATURES_EXT, nullptr, VK_TRUE};
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_feature = {
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT, nullptr, VK_TRUE};
 
   if (m_optional_extensions.vk_ext_rasterization_order_attachment_access)
     Vulkan::AddPointerToChain(&device_info, &rasterization_order_access_feature);
   if (m_optional_extensions.vk_ext_attachment_feedback_loop_layout)
     Vulkan::AddPointerToChain(&device_info, &attachment_feedback_loop_feature);
+  if (m_optional_extensions.vk_ext_graphics_pipeline_library)
+    Vulkan::AddPointerToChain(&device_info, &graphics_pipeline_library_feature);
 
   VkResult res = vkCreateDevice(m_physical_device, &device_info, nullptr, &m_device);
   if (res != VK_SUCCESS)
@@ -531,6 +555,7 @@ bool VulkanDevice::CreateDevice(VkSurfaceKHR surface, bool enable_validation_lay
                 static_cast<u32>(m_device_properties.limits.timestampComputeAndGraphics),
                 queue_family_properties[m_graphics_queue_family_index].timestampValidBits,
                 m_device_properties.limits.timestampPeriod);
+  m_features.gpu_timing_scopes = m_features.gpu_timing;
 
   ProcessDeviceExtensions();
   return true;
@@ -545,12 +570,16 @@ void VulkanDevice::ProcessDeviceExtensions()
     VK_FALSE};
   VkPhysicalDeviceAttachmentFeedbackLoopLayoutFeaturesEXT attachment_feedback_loop_feature = {
     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ATTACHMENT_FEEDBACK_LOOP_LAYOUT_FEATURES_EXT, nullptr, VK_FALSE};
+  VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_feature = {
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT, nullptr, VK_FALSE};
 
   // add in optional feature structs
   if (m_optional_extensions.vk_ext_rasterization_order_attachment_access)
     Vulkan::AddPointerToChain(&features2, &rasterization_order_access_feature);
   if (m_optional_extensions.vk_ext_attachment_feedback_loop_layout)
     Vulkan::AddPointerToChain(&features2, &attachment_feedback_loop_feature);
+  if (m_optional_extensions.vk_ext_graphics_pipeline_library)
+    Vulkan::AddPointerToChain(&features2, &graphics_pipeline_library_feature);
 
   // query
   vkGetPhysicalDeviceFeatures2(m_physical_device, &features2);
@@ -560,10 +589,14 @@ void VulkanDevice::ProcessDeviceExtensions()
     (rasterization_order_access_feature.rasterizationOrderColorAttachmentAccess == VK_TRUE);
   m_optional_extensions.vk_ext_attachment_feedback_loop_layout &=
     (attachment_feedback_loop_feature.attachmentFeedbackLoopLayout == VK_TRUE);
+  m_optional_extensions.vk_ext_graphics_pipeline_library &=
+    (graphics_pipeline_library_feature.graphicsPipelineLibrary == VK_TRUE);
 
   VkPhysicalDeviceProperties2 properties2 = {VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, nullptr, {}};
   VkPhysicalDevicePushDescriptorPropertiesKHR push_descriptor_properties = {
     VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR, nullptr, 0u};
+  VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphics_pipeline_library_properties = {
+    VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT, nullptr, VK_FALSE, VK_FALSE};
 
   if (m_optional_extensions.vk_khr_driver_properties)
   {
@@ -572,12 +605,18 @@ void VulkanDevice::ProcessDeviceExtensions()
   }
   if (m_optional_extensions.vk_khr_push_descriptor)
     Vulkan::AddPointerToChain(&properties2, &push_descriptor_properties);
+  if (m_optional_extensions.vk_ext_graphics_pipeline_library)
+    Vulkan::AddPointerToChain(&properties2, &graphics_pipeline_library_properties);
 
   // query
   vkGetPhysicalDeviceProperties2(m_physical_device, &properties2);
 
   m_optional_extensions.vk_khr_push_descriptor &= (push_descriptor_properties.maxPushDescriptors >= 1);
 
+  // Without fast linking, linking libraries on demand would stutter as much as creating pipelines directly.
+  m_optional_extensions.vk_ext_graphics_pipeline_library &=
+    (graphics_pipeline_library_properties.graphicsPipelineLibraryFastLinking == VK_TRUE);
+
   Log_InfoPrintf("VK_EXT_memory_budget is %s",
                  m_optional_extensions.vk_ext_memory_budget ? "supported" : "NOT supported");
   Log_InfoPrintf("VK_EXT_rasterization_order_attachment_access is %s",
@@ -586,6 +625,8 @@ void VulkanDevice::ProcessDeviceExtensions()
                  m_optional_extensions.vk_ext_attachment_feedback_loop_layout ? "supported" : "NOT supported");
   Log_InfoPrintf("VK_KHR_push_descriptor is %s",
                  m_optional_extensions.vk_khr_push_descriptor ? "supported" : "NOT supported");
+  Log_InfoPrintf("VK_EXT_graphics_pipeline_library is %s",
+                 m_optional_extensions.vk_ext_graphics_pipeline_library ? "supported" : "NOT supported");
 }
 
 bool VulkanDevice::CreateAllocator()
@@ -772,12 +813,14 @@ bool VulkanDevice::CreatePersistentDescriptorPool()
   if (m_features.gpu_timing)
   {
     const VkQueryPoolCreateInfo query_create_info = {
-      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0, VK_QUERY_TYPE_TIMESTAMP, NUM_COMMAND_BUFFERS * 4, 0};
+      VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, nullptr, 0, VK_QUERY_TYPE_TIMESTAMP,
+      GetTimingScopeQueryIndex(NUM_COMMAND_BUFFERS, 0), 0};
     res = vkCreateQueryPool(m_device, &query_create_info, nullptr, &m_timestamp_query_pool);
     if (res != VK_SUCCESS)
     {
       LOG_VULKAN_ERROR(res, "vkCreateQueryPool failed: ");
       m_features.gpu_timing = false;
+      m_features.gpu_timing_scopes = false;
       return false;
     }
   }
@@ -939,6 +982,63 @@ bool VulkanDevice::SetGPUTimingEnabled(bool enabled)
   return (enabled == m_gpu_timing_enabled);
 }
 
+u32 VulkanDevice::GetTimingScopeQueryIndex(u32 command_buffer_index, u32 scope_index) const
+{
+  // Whole-command-buffer timestamps come first.
+  return (NUM_COMMAND_BUFFERS * 2) + ((command_buffer_index * MAX_TIMING_SCOPES_PER_COMMAND_BUFFER) + scope_index) * 2;
+}
+
+void VulkanDevice::WriteTimingScopeBegin(TimingScope scope)
+{
+  // Queries are only reset when timing was enabled at the start of the command buffer.
+  CommandBuffer& resources = m_frame_resources[m_current_frame];
+  if (!resources.timestamp_written || resources.num_timing_scopes == MAX_TIMING_SCOPES_PER_COMMAND_BUFFER)
+    return;
+
+  vkCmdWriteTimestamp(m_current_command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool,
+                      GetTimingScopeQueryIndex(m_current_frame, resources.num_timing_scopes));
+  resources.timing_scopes[resources.num_timing_scopes] = scope;
+  resources.timing_scope_open = true;
+}
+
+void VulkanDevice::WriteTimingScopeEnd()
+{
+  CommandBuffer& resources = m_frame_resources[m_current_frame];
+  if (!resources.timing_scope_open)
+    return;
+
+  vkCmdWriteTimestamp(m_current_command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool,
+                      GetTimingScopeQueryIndex(m_current_frame, resources.num_timing_scopes) + 1);
+  resources.num_timing_scopes++;
+  resources.timing_scope_open = false;
+}
+
+void VulkanDevice::ReadTimingScopeQueries(u32 command_buffer_index)
+{
+  const CommandBuffer& resources = m_frame_resources[command_buffer_index];
+  if (resources.num_timing_scopes == 0)
+    return;
+
+  std::array<u64, MAX_TIMING_SCOPES_PER_COMMAND_BUFFER * 2> timestamps;
+  const u32 count = resources.num_timing_scopes * 2;
+  const VkResult res =
+    vkGetQueryPoolResults(m_device, m_timestamp_query_pool, GetTimingScopeQueryIndex(command_buffer_index, 0), count,
+                          sizeof(u64) * count, timestamps.data(), sizeof(u64), VK_QUERY_RESULT_64_BIT);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkGetQueryPoolResults failed: ");
+    return;
+  }
+
+  const double ms_per_tick = static_cast<double>(m_device_properties.limits.timestampPeriod) / 1000000.0;
+  for (u32 i = 0; i < resources.num_timing_scopes; i++)
+  {
+    const u64 diff = (timestamps[i * 2 + 1] > timestamps[i * 2]) ? (timestamps[i * 2 + 1] - timestamps[i * 2]) : 0;
+    m_accumulated_scope_times[static_cast<u32>(resources.timing_scopes[i])] +=
+      static_cast<float>(static_cast<double>(diff) * ms_per_tick);
+  }
+}
+
 void VulkanDevice::WaitForCommandBufferCompletion(u32 index)
 {
   // Wait for this command buffer to be completed.
@@ -981,6 +1081,8 @@ void VulkanDevice::WaitForCommandBufferCompletion(u32 index)
       {
         LOG_VULKAN_ERROR(res, "vkGetQueryPoolResults failed: ");
       }
+
+      ReadTimingScopeQueries(cleanup_index);
     }
 
     cleanup_index = (cleanup_index + 1) % NUM_COMMAND_BUFFERS;
@@ -1017,6 +1119,10 @@ void VulkanDevice::SubmitCommandBuffer(VulkanSwapChain* present_swap_chain /* =
     }
   }
 
+  // Scopes can't span command buffers, so split it. BeginCommandBuffer() will reopen it in the next one.
+  if (resources.timing_scope_open)
+    WriteTimingScopeEnd();
+
   if (m_gpu_timing_enabled && resources.timestamp_written)
   {
     vkCmdWriteTimestamp(m_current_command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool,
@@ -1115,6 +1221,11 @@ void VulkanDevice::DoPresent(VulkanSwapChain* present_swap_chain)
   present_swap_chain->AcquireNextImage();
 }
 
+bool VulkanDevice::IsPresentPending() const
+{
+  return !m_present_done.load();
+}
+
 void VulkanDevice::WaitForPresentComplete()
 {
   if (m_present_done.load())
@@ -1216,6 +1327,8 @@ void VulkanDevice::BeginCommandBuffer(u32 index)
   if (m_gpu_timing_enabled)
   {
     vkCmdResetQueryPool(resources.command_buffers[1], m_timestamp_query_pool, index * 2, 2);
+    vkCmdResetQueryPool(resources.command_buffers[1], m_timestamp_query_pool, GetTimingScopeQueryIndex(index, 0),
+                        MAX_TIMING_SCOPES_PER_COMMAND_BUFFER * 2);
     vkCmdWriteTimestamp(resources.command_buffers[1], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, m_timestamp_query_pool,
                         index * 2);
   }
@@ -1223,10 +1336,15 @@ void VulkanDevice::BeginCommandBuffer(u32 index)
   resources.fence_counter = m_next_fence_counter++;
   resources.init_buffer_used = false;
   resources.timestamp_written = m_gpu_timing_enabled;
+  resources.num_timing_scopes = 0;
+  resources.timing_scope_open = false;
 
   m_current_frame = index;
   m_current_command_buffer = resources.command_buffers[1];
 
+  if (m_current_timing_scope != TimingScope::None)
+    WriteTimingScopeBegin(m_current_timing_scope);
+
   // using the lower 32 bits of the fence index should be sufficient here, I hope...
   vmaSetCurrentFrameIndex(m_allocator, static_cast<u32>(m_next_fence_counter));
 }
@@ -1716,6 +1834,8 @@ bool VulkanDevice::CreateDevice(const std::string_view& adapter, bool threaded_p
 
   if (threaded_presentation)
     StartPresentThread();
+  if (m_optional_extensions.vk_ext_graphics_pipeline_library)
+    StartPipelineOptimizerThread();
 
   if (surface != VK_NULL_HANDLE)
   {
@@ -1760,6 +1880,7 @@ void VulkanDevice::DestroyDevice()
     WaitForGPUIdle();
 
   StopPresentThread();
+  StopPipelineOptimizerThread();
   m_swap_chain.reset();
 
   if (m_null_texture)
@@ -1780,6 +1901,8 @@ void VulkanDevice::DestroyDevice()
   DestroyCommandBuffers();
   DestroyAllocator();
 
+  DestroyPipelineLibraries();
+
   for (auto& it : m_render_pass_cache)
     vkDestroyRenderPass(m_device, it.second, nullptr);
   m_render_pass_cache.clear();
@@ -2222,6 +2345,7 @@ bool VulkanDevice::CheckFeatures()
   m_features.partial_msaa_resolve = true;
   m_features.shader_cache = true;
   m_features.pipeline_cache = true;
+  m_features.threaded_pipeline_creation = false;
 
   return true;
 }
@@ -2346,28 +2470,29 @@ void VulkanDevice::ResolveTextureRegion(GPUTexture* dst, u32 dst_x, u32 dst_y, u
                                     D->GetLayout());
 }
 
+// Clearing or invalidating an attachment of the active pass doesn't end it. Restarting the pass would store the
+// attachments and load them again, which tilers pay for in bandwidth, and desktop GPUs in barriers.
 void VulkanDevice::ClearRenderTarget(GPUTexture* t, u32 c)
 {
   GPUDevice::ClearRenderTarget(t, c);
-  if (InRenderPass() && m_current_framebuffer && m_current_framebuffer->GetRT() == t)
-    EndRenderPass();
+  if (IsAttachmentOfCurrentRenderPass(t))
+    ClearAttachmentInRenderPass(static_cast<VulkanTexture*>(t));
 }
 
 void VulkanDevice::ClearDepth(GPUTexture* t, float d)
 {
   GPUDevice::ClearDepth(t, d);
-  if (InRenderPass() && m_current_framebuffer && m_current_framebuffer->GetDS() == t)
-    EndRenderPass();
+  if (IsAttachmentOfCurrentRenderPass(t))
+    ClearAttachmentInRenderPass(static_cast<VulkanTexture*>(t));
 }
 
 void VulkanDevice::InvalidateRenderTarget(GPUTexture* t)
 {
   GPUDevice::InvalidateRenderTarget(t);
-  if (InRenderPass() && m_current_framebuffer &&
-      (m_current_framebuffer->GetRT() == t || m_current_framebuffer->GetDS() == t))
-  {
-    EndRenderPass();
-  }
+
+  // Keeping the old contents is a valid result of invalidation.
+  if (IsAttachmentOfCurrentRenderPass(t))
+    t->SetState(GPUTexture::State::Dirty);
 }
 
 bool VulkanDevice::CreateBuffers()
@@ -2519,7 +2644,10 @@ bool VulkanDevice::CreatePipelineLayouts()
     Vulkan::SetObjectName(m_device, m_ubo_ds_layout, "UBO Descriptor Set Layout");
   }
 
+  // With push descriptors, all texture sets are pushed at draw time, and only the UBO set is allocated.
   {
+    if (m_optional_extensions.vk_khr_push_descriptor)
+      dslb.SetPushFlag();
     dslb.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
     if ((m_single_texture_ds_layout = dslb.Create(m_device)) == VK_NULL_HANDLE)
       return false;
@@ -2527,6 +2655,8 @@ bool VulkanDevice::CreatePipelineLayouts()
   }
 
   {
+    if (m_optional_extensions.vk_khr_push_descriptor)
+      dslb.SetPushFlag();
     dslb.AddBinding(0,
                     m_features.texture_buffers_emulated_with_ssbo ? VK_DESCRIPTOR_TYPE_STORAGE_BUFFER :
                                                                     VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
@@ -2667,12 +2797,7 @@ void VulkanDevice::RenderBlankFrame()
 
 void VulkanDevice::SetFramebuffer(GPUFramebuffer* fb)
 {
-  if (m_current_framebuffer == fb)
-    return;
-
-  if (InRenderPass())
-    EndRenderPass();
-
+  // The render pass is ended by the next draw, if it's to a different target.
   m_current_framebuffer = static_cast<VulkanFramebuffer*>(fb);
 }
 
@@ -2779,6 +2904,7 @@ void VulkanDevice::BeginRenderPass()
     }
 
     bi.framebuffer = m_current_framebuffer->GetFramebuffer();
+    m_current_render_pass_framebuffer = m_current_framebuffer;
     bi.renderPass = m_current_render_pass =
       GetRenderPass(rt_format, ds_format, samples, rt_load_op, rt_store_op, ds_load_op, ds_store_op);
     bi.renderArea.extent = {m_current_framebuffer->GetWidth(), m_current_framebuffer->GetHeight()};
@@ -2787,6 +2913,7 @@ void VulkanDevice::BeginRenderPass()
   {
     // Re-rendering to swap chain.
     bi.framebuffer = m_swap_chain->GetCurrentFramebuffer();
+    m_current_render_pass_framebuffer = nullptr;
     bi.renderPass = m_current_render_pass =
       GetRenderPass(m_swap_chain->GetImageFormat(), VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT,
                     VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_STORE);
@@ -2840,6 +2967,7 @@ void VulkanDevice::BeginSwapChainRenderPass()
   vkCmdBeginRenderPass(GetCurrentCommandBuffer(), &rp, VK_SUBPASS_CONTENTS_INLINE);
   m_current_render_pass = render_pass;
   m_current_framebuffer = nullptr;
+  m_current_render_pass_framebuffer = nullptr;
 
   // Clear pipeline, it's likely incompatible.
   m_current_pipeline = nullptr;
@@ -2856,31 +2984,53 @@ void VulkanDevice::EndRenderPass()
 
   // TODO: stats
   m_current_render_pass = VK_NULL_HANDLE;
+  m_current_render_pass_framebuffer = nullptr;
 
   vkCmdEndRenderPass(GetCurrentCommandBuffer());
 }
 
-void VulkanDevice::UnbindFramebuffer(VulkanFramebuffer* fb)
+bool VulkanDevice::IsAttachmentOfCurrentRenderPass(const GPUTexture* t) const
 {
-  if (m_current_framebuffer != fb)
-    return;
+  return (m_current_render_pass != VK_NULL_HANDLE && m_current_render_pass_framebuffer &&
+          (m_current_render_pass_framebuffer->GetRT() == t || m_current_render_pass_framebuffer->GetDS() == t));
+}
 
-  if (InRenderPass())
+void VulkanDevice::ClearAttachmentInRenderPass(VulkanTexture* t)
+{
+  VkClearAttachment ca = {};
+  if (t->IsDepthStencil())
+  {
+    ca.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    ca.clearValue.depthStencil = {t->GetClearDepth(), 0u};
+  }
+  else
+  {
+    ca.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    ca.colorAttachment = 0;
+    std::memcpy(ca.clearValue.color.float32, t->GetUNormClearColor().data(), sizeof(ca.clearValue.color.float32));
+  }
+
+  const VkClearRect rc = {
+    {{0, 0}, {m_current_render_pass_framebuffer->GetWidth(), m_current_render_pass_framebuffer->GetHeight()}}, 0u, 1u};
+  vkCmdClearAttachments(GetCurrentCommandBuffer(), 1, &ca, 1, &rc);
+  t->SetState(GPUTexture::State::Dirty);
+}
+
+void VulkanDevice::UnbindFramebuffer(VulkanFramebuffer* fb)
+{
+  if (InRenderPass() && m_current_render_pass_framebuffer == fb)
     EndRenderPass();
-  m_current_framebuffer = nullptr;
+  if (m_current_framebuffer == fb)
+    m_current_framebuffer = nullptr;
 }
 
 void VulkanDevice::UnbindFramebuffer(VulkanTexture* tex)
 {
-  if (!m_current_framebuffer)
-    return;
-
-  if (m_current_framebuffer->GetRT() != tex && m_current_framebuffer->GetDS() != tex)
-    return;
-
-  if (InRenderPass())
+  if (IsAttachmentOfCurrentRenderPass(tex))
     EndRenderPass();
-  m_current_framebuffer = nullptr;
+
+  if (m_current_framebuffer && (m_current_framebuffer->GetRT() == tex || m_current_framebuffer->GetDS() == tex))
+    m_current_framebuffer = nullptr;
 }
 
 void VulkanDevice::SetPipeline(GPUPipeline* pipeline)
@@ -2901,6 +3051,7 @@ void VulkanDevice::SetPipeline(GPUPipeline* pipeline)
   }
 
   m_current_pipeline = static_cast<VulkanPipeline*>(pipeline);
+  m_current_pipeline->UpdateOptimizedPipeline();
 
   vkCmdBindPipeline(m_current_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_current_pipeline->GetPipeline());
 
@@ -2923,6 +3074,7 @@ void VulkanDevice::InvalidateCachedState()
 {
   m_dirty_flags = ALL_DIRTY_STATE;
   m_current_render_pass = VK_NULL_HANDLE;
+  m_current_render_pass_framebuffer = nullptr;
   m_current_framebuffer = nullptr;
   m_current_pipeline = nullptr;
 }
@@ -2943,6 +3095,7 @@ void VulkanDevice::SetInitialPipelineState()
   vkCmdBindIndexBuffer(cmdbuf, m_index_buffer.GetBuffer(), 0, VK_INDEX_TYPE_UINT16);
 
   m_current_pipeline_layout = m_current_pipeline->GetLayout();
+  m_current_pipeline->UpdateOptimizedPipeline();
   vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_current_pipeline->GetPipeline());
 
   const VkViewport vp = {static_cast<float>(m_current_viewport.left),
@@ -3064,6 +3217,8 @@ void VulkanDevice::PreDrawCheck()
     }
   }
 
+  if (InRenderPass() && m_current_render_pass_framebuffer != m_current_framebuffer)
+    EndRenderPass();
   if (!InRenderPass())
     BeginRenderPass();
 }
@@ -3088,11 +3243,45 @@ bool VulkanDevice::UpdateDescriptorSetsForLayout(bool new_layout, bool new_dynam
                 layout == GPUPipeline::Layout::SingleTextureAndPushConstants)
   {
     DebugAssert(m_current_textures[0] && m_current_samplers[0] != VK_NULL_HANDLE);
-    ds[num_ds++] = m_current_textures[0]->GetDescriptorSetWithSampler(m_current_samplers[0]);
+    if (m_optional_extensions.vk_khr_push_descriptor)
+    {
+      Vulkan::DescriptorSetUpdateBuilder dsub;
+      dsub.AddCombinedImageSamplerDescriptorWrite(VK_NULL_HANDLE, 0, m_current_textures[0]->GetView(),
+                                                  m_current_samplers[0], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+      const u32 set = (layout == GPUPipeline::Layout::SingleTextureAndUBO) ? 1 : 0;
+      dsub.PushUpdate(GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      m_pipeline_layouts[static_cast<u8>(m_current_pipeline_layout)], set);
+      if (num_ds == 0)
+        return true;
+    }
+    else
+    {
+      ds[num_ds++] = m_current_textures[0]->GetDescriptorSetWithSampler(m_current_samplers[0]);
+    }
   }
   else if constexpr (layout == GPUPipeline::Layout::SingleTextureBufferAndPushConstants)
   {
     DebugAssert(m_current_texture_buffer);
+    if (m_optional_extensions.vk_khr_push_descriptor)
+    {
+      Vulkan::DescriptorSetUpdateBuilder dsub;
+      if (m_features.texture_buffers_emulated_with_ssbo)
+      {
+        dsub.AddBufferDescriptorWrite(VK_NULL_HANDLE, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                      m_current_texture_buffer->GetBuffer(), 0,
+                                      m_current_texture_buffer->GetSizeInBytes());
+      }
+      else
+      {
+        dsub.AddBufferViewDescriptorWrite(VK_NULL_HANDLE, 0, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
+                                          m_current_texture_buffer->GetBufferView());
+      }
+      dsub.PushUpdate(GetCurrentCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      m_pipeline_layouts[static_cast<u8>(m_current_pipeline_layout)], 0);
+      return true;
+    }
+
     ds[num_ds++] = m_current_texture_buffer->GetDescriptorSet();
   }
   else if constexpr (layout == GPUPipeline::Layout::MultiTextureAndUBO ||
@@ -22,20 +22,29 @@
 
 class VulkanFramebuffer;
 class VulkanPipeline;
+class VulkanShader;
 class VulkanSwapChain;
 class VulkanTexture;
 class VulkanTextureBuffer;
 
 struct VK_PIPELINE_CACHE_HEADER;
 
+namespace Vulkan {
+class GraphicsPipelineBuilder;
+}
+
 class VulkanDevice final : public GPUDevice
 {
 public:
+  friend VulkanPipeline;
+  friend VulkanShader;
   friend VulkanTexture;
 
   enum : u32
   {
     NUM_COMMAND_BUFFERS = 3,
+    MAX_TIMING_SCOPES_PER_COMMAND_BUFFER = 64,
+    INVALID_QUEUE_FAMILY_INDEX = 0xFFFFFFFFu,
   };
 
   struct OptionalExtensions
@@ -46,6 +55,7 @@ public:
     bool vk_ext_full_screen_exclusive : 1;
     bool vk_khr_driver_properties : 1;
     bool vk_khr_push_descriptor : 1;
+    bool vk_ext_graphics_pipeline_library : 1;
   };
 
   static GPUTexture::Format GetFormatForVkFormat(VkFormat format);
@@ -123,6 +133,8 @@ public:
   bool BeginPresent(bool skip_present) override;
   void EndPresent() override;
 
+  bool IsPresentPending() const override;
+
   // Global state accessors
   ALWAYS_INLINE static VulkanDevice& GetInstance() { return *static_cast<VulkanDevice*>(g_gpu_device.get()); }
   ALWAYS_INLINE VkInstance GetVulkanInstance() const { return m_instance; }
@@ -131,6 +143,7 @@ public:
   ALWAYS_INLINE VkPhysicalDevice GetVulkanPhysicalDevice() const { return m_physical_device; }
   ALWAYS_INLINE u32 GetGraphicsQueueFamilyIndex() const { return m_graphics_queue_family_index; }
   ALWAYS_INLINE u32 GetPresentQueueFamilyIndex() const { return m_present_queue_family_index; }
+  ALWAYS_INLINE u32 GetComputeQueueFamilyIndex() const { return m_compute_queue_family_index; }
   ALWAYS_INLINE const OptionalExtensions& GetOptionalExtensions() const { return m_optional_extensions; }
 
   /// Returns true if Vulkan is suitable as a default for the devices in the system.
@@ -269,6 +282,48 @@ private:
     bool init_buffer_used = false;
     bool needs_fence_wait = false;
     bool timestamp_written = false;
+
+    // Scopes which have both timestamps written, and the one currently open, if any.
+    u32 num_timing_scopes = 0;
+    bool timing_scope_open = false;
+    std::array<TimingScope, MAX_TIMING_SCOPES_PER_COMMAND_BUFFER> timing_scopes;
+  };
+
+  // Vertex input, pre-rasterization, fragment shader and fragment output.
+  static constexpr u32 NUM_PIPELINE_LIBRARY_PARTS = 4;
+  using PipelineLibraryArray = std::array<VkPipeline, NUM_PIPELINE_LIBRARY_PARTS>;
+
+  /// State which goes into one part of a pipeline, fields for the other parts are left zeroed.
+  struct PipelineLibraryKey
+  {
+    VkGraphicsPipelineLibraryFlagsEXT part;
+    u32 vertex_stride;
+    u32 num_vertex_attributes;
+    std::array<u32, GPUPipeline::VertexAttribute::MaxAttributes> vertex_attributes;
+    VkShaderModule vertex_shader;
+    VkShaderModule geometry_shader;
+    VkShaderModule fragment_shader;
+    VkPipelineLayout layout;
+    VkRenderPass render_pass;
+    u64 blend;
+    u8 primitive;
+    u8 cull_mode;
+    u8 depth;
+    u8 samples;
+    bool per_sample_shading;
+
+    bool operator==(const PipelineLibraryKey& rhs) const;
+  };
+  struct PipelineLibraryKeyHash
+  {
+    size_t operator()(const PipelineLibraryKey& key) const;
+  };
+
+  struct OptimizePipelineRequest
+  {
+    VulkanPipeline* pipeline;
+    VkPipelineLayout layout;
+    PipelineLibraryArray libraries;
   };
 
   using CleanupObjectFunction = void (*)(VulkanDevice& dev, void* obj);
@@ -345,6 +400,8 @@ private:
   void BeginRenderPass();
   void BeginSwapChainRenderPass();
   void EndRenderPass();
+  bool IsAttachmentOfCurrentRenderPass(const GPUTexture* t) const;
+  void ClearAttachmentInRenderPass(VulkanTexture* t);
   bool InRenderPass();
 
   VkRenderPass CreateCachedRenderPass(RenderPassCacheKey key);
@@ -353,12 +410,30 @@ private:
   void WaitForCommandBufferCompletion(u32 index);
 
   void DoSubmitCommandBuffer(u32 index, VulkanSwapChain* present_swap_chain);
+
+  void WriteTimingScopeBegin(TimingScope scope) override;
+  void WriteTimingScopeEnd() override;
+  u32 GetTimingScopeQueryIndex(u32 command_buffer_index, u32 scope_index) const;
+  void ReadTimingScopeQueries(u32 command_buffer_index);
   void DoPresent(VulkanSwapChain* present_swap_chain);
   void WaitForPresentComplete(std::unique_lock<std::mutex>& lock);
   void PresentThread();
   void StartPresentThread();
   void StopPresentThread();
 
+  std::unique_ptr<GPUPipeline> CreatePipelineFromLibraries(const GPUPipeline::GraphicsConfig& config,
+                                                           Vulkan::GraphicsPipelineBuilder& gpb,
+                                                           VkRenderPass render_pass);
+  VkPipeline GetPipelineLibrary(const PipelineLibraryKey& key, Vulkan::GraphicsPipelineBuilder& gpb);
+  VkPipeline LinkPipelineLibraries(const PipelineLibraryArray& libraries, VkPipelineLayout layout, bool optimize);
+  void DestroyPipelineLibrariesForShader(VkShaderModule module);
+  void DestroyRetiredPipelineLibraries();
+  void DestroyPipelineLibraries();
+  void CancelOptimizePipeline(VulkanPipeline* pipeline);
+  void PipelineOptimizerThread();
+  void StartPipelineOptimizerThread();
+  void StopPipelineOptimizerThread();
+
   VkInstance m_instance = VK_NULL_HANDLE;
   VkPhysicalDevice m_physical_device = VK_NULL_HANDLE;
   VkDevice m_device = VK_NULL_HANDLE;
@@ -372,6 +447,7 @@ private:
   VkQueue m_present_queue = VK_NULL_HANDLE;
   u32 m_graphics_queue_family_index = 0;
   u32 m_present_queue_family_index = 0;
+  u32 m_compute_queue_family_index = INVALID_QUEUE_FAMILY_INDEX;
 
   VkQueryPool m_timestamp_query_pool = VK_NULL_HANDLE;
   float m_accumulated_gpu_time = 0.0f;
@@ -402,6 +478,18 @@ private:
   std::unordered_map<u32, VkRenderPass> m_render_pass_cache;
   VkPipelineCache m_pipeline_cache = VK_NULL_HANDLE;
 
+  // Pipeline libraries are only looked up on the main thread. Libraries for destroyed shaders are retired, and
+  // destroyed once no optimize requests are outstanding, since those still link against them.
+  std::unordered_map<PipelineLibraryKey, VkPipeline, PipelineLibraryKeyHash> m_pipeline_libraries;
+  std::mutex m_optimizer_mutex;
+  std::condition_variable m_optimizer_queued_cv;
+  std::condition_variable m_optimizer_done_cv;
+  std::deque<OptimizePipelineRequest> m_optimizer_queue;
+  std::vector<VkPipeline> m_retired_pipeline_libraries;
+  VulkanPipeline* m_optimizer_current_pipeline = nullptr;
+  std::thread m_optimizer_thread;
+  bool m_optimizer_thread_done = false;
+
   // TODO: Move to static?
   VkDebugUtilsMessengerEXT m_debug_messenger_callback = VK_NULL_HANDLE;
 
@@ -440,6 +528,10 @@ private:
   VulkanFramebuffer* m_current_framebuffer = nullptr;
   VkRenderPass m_current_render_pass = VK_NULL_HANDLE;
 
+  // Target of the active render pass, null for the swap chain. Lags behind m_current_framebuffer until something is
+  // drawn to the new target, so that switching away and back without drawing doesn't split the pass.
+  VulkanFramebuffer* m_current_render_pass_framebuffer = nullptr;
+
   VulkanPipeline* m_current_pipeline = nullptr;
   GPUPipeline::Layout m_current_pipeline_layout = GPUPipeline::Layout::SingleTextureAndPushConstants;
 
@@ -8,6 +8,9 @@
 
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/threading.h"
+
+#include <cstring>
 
 Log_SetChannel(VulkanDevice);
 
@@ -17,7 +20,10 @@ VulkanShader::VulkanShader(GPUShaderStage stage, VkShaderModule mod) : GPUShader
 
 VulkanShader::~VulkanShader()
 {
-  vkDestroyShaderModule(VulkanDevice::GetInstance().GetVulkanDevice(), m_module, nullptr);
+  // The module handle can be reused after this, so libraries keyed on it have to go.
+  VulkanDevice& dev = VulkanDevice::GetInstance();
+  dev.DestroyPipelineLibrariesForShader(m_module);
+  vkDestroyShaderModule(dev.GetVulkanDevice(), m_module, nullptr);
 }
 
 void VulkanShader::SetDebugName(const std::string_view& name)
@@ -53,21 +59,16 @@ std::unique_ptr<GPUShader> VulkanDevice::CreateShaderFromSource(GPUShaderStage s
 
   const u32 options = (m_debug_device ? SPIRVCompiler::DebugInfo : 0) | SPIRVCompiler::VulkanRules;
 
-  std::optional<SPIRVCompiler::SPIRVCodeVector> spirv = SPIRVCompiler::CompileShader(stage, source, options);
-  if (!spirv.has_value())
+  // SPIR-V is the binary for Vulkan, so it can go straight to the caller.
+  DynamicHeapArray<u8> local_spirv;
+  DynamicHeapArray<u8>* spirv = out_binary ? out_binary : &local_spirv;
+  if (!CompileGLSLToSPIRV(stage, source, options, spirv))
   {
     Log_ErrorPrintf("Failed to compile shader to SPIR-V.");
     return {};
   }
 
-  const size_t spirv_size = spirv->size() * sizeof(SPIRVCompiler::SPIRVCodeType);
-  if (out_binary)
-  {
-    out_binary->resize(spirv_size);
-    std::memcpy(out_binary->data(), spirv->data(), spirv_size);
-  }
-
-  return CreateShaderFromBinary(stage, std::span<const u8>(reinterpret_cast<const u8*>(spirv->data()), spirv_size));
+  return CreateShaderFromBinary(stage, std::span<const u8>(spirv->data(), spirv->size()));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -79,7 +80,23 @@ VulkanPipeline::VulkanPipeline(VkPipeline pipeline, Layout layout)
 
 VulkanPipeline::~VulkanPipeline()
 {
+  VulkanDevice& dev = VulkanDevice::GetInstance();
+  if (m_optimize_queued)
+  {
+    // Never bound, so it doesn't have to wait for the GPU.
+    dev.CancelOptimizePipeline(this);
+    if (const VkPipeline optimized = m_optimized_pipeline.load(std::memory_order_acquire); optimized != VK_NULL_HANDLE)
+      vkDestroyPipeline(dev.GetVulkanDevice(), optimized, nullptr);
+  }
+
+  dev.DeferPipelineDestruction(m_pipeline);
+}
+
+void VulkanPipeline::SwapToOptimizedPipeline()
+{
+  // The fast linked pipeline may still be in use by submitted command buffers.
   VulkanDevice::GetInstance().DeferPipelineDestruction(m_pipeline);
+  m_pipeline = m_optimized_pipeline.exchange(VK_NULL_HANDLE, std::memory_order_acquire);
 }
 
 void VulkanPipeline::SetDebugName(const std::string_view& name)
@@ -205,9 +222,240 @@ std::unique_ptr<GPUPipeline> VulkanDevice::CreatePipeline(const GPUPipeline::Gra
   DebugAssert(render_pass);
   gpb.SetRenderPass(render_pass, 0);
 
+  if (m_optional_extensions.vk_ext_graphics_pipeline_library)
+  {
+    std::unique_ptr<GPUPipeline> pipeline = CreatePipelineFromLibraries(config, gpb, render_pass);
+    if (pipeline)
+      return pipeline;
+
+    Log_WarningPrintf("Failed to link pipeline from libraries, creating it directly.");
+  }
+
   const VkPipeline pipeline = gpb.Create(m_device, m_pipeline_cache, false);
   if (!pipeline)
     return {};
 
   return std::unique_ptr<GPUPipeline>(new VulkanPipeline(pipeline, config.layout));
 }
+
+bool VulkanDevice::PipelineLibraryKey::operator==(const PipelineLibraryKey& rhs) const
+{
+  return (std::memcmp(this, &rhs, sizeof(*this)) == 0);
+}
+
+size_t VulkanDevice::PipelineLibraryKeyHash::operator()(const PipelineLibraryKey& key) const
+{
+  return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(&key), sizeof(key)));
+}
+
+std::unique_ptr<GPUPipeline> VulkanDevice::CreatePipelineFromLibraries(const GPUPipeline::GraphicsConfig& config,
+                                                                       Vulkan::GraphicsPipelineBuilder& gpb,
+                                                                       VkRenderPass render_pass)
+{
+  // Batch pipelines share most of their shaders and state, so each part is only compiled the first time it's seen,
+  // and linking the parts is cheap. Keys are compared bytewise, so padding has to be zeroed too.
+  const VkPipelineLayout layout = m_pipeline_layouts[static_cast<u8>(config.layout)];
+  PipelineLibraryArray libraries;
+  PipelineLibraryKey key;
+
+  std::memset(&key, 0, sizeof(key));
+  key.part = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+  key.vertex_stride = config.input_layout.vertex_stride;
+  key.num_vertex_attributes = static_cast<u32>(config.input_layout.vertex_attributes.size());
+  for (u32 i = 0; i < key.num_vertex_attributes; i++)
+    key.vertex_attributes[i] = config.input_layout.vertex_attributes[i].key;
+  key.primitive = static_cast<u8>(config.primitive);
+  libraries[0] = GetPipelineLibrary(key, gpb);
+  if (libraries[0] == VK_NULL_HANDLE)
+    return {};
+
+  std::memset(&key, 0, sizeof(key));
+  key.part = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+  key.vertex_shader = static_cast<const VulkanShader*>(config.vertex_shader)->GetModule();
+  if (config.geometry_shader)
+    key.geometry_shader = static_cast<const VulkanShader*>(config.geometry_shader)->GetModule();
+  key.layout = layout;
+  key.render_pass = render_pass;
+  key.cull_mode = config.rasterization.key;
+  libraries[1] = GetPipelineLibrary(key, gpb);
+  if (libraries[1] == VK_NULL_HANDLE)
+    return {};
+
+  std::memset(&key, 0, sizeof(key));
+  key.part = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+  key.fragment_shader = static_cast<const VulkanShader*>(config.fragment_shader)->GetModule();
+  key.layout = layout;
+  key.render_pass = render_pass;
+  key.depth = config.depth.key;
+  key.samples = static_cast<u8>(config.samples);
+  key.per_sample_shading = config.per_sample_shading;
+  libraries[2] = GetPipelineLibrary(key, gpb);
+  if (libraries[2] == VK_NULL_HANDLE)
+    return {};
+
+  std::memset(&key, 0, sizeof(key));
+  key.part = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+  key.render_pass = render_pass;
+  key.blend = config.blend.key;
+  key.samples = static_cast<u8>(config.samples);
+  key.per_sample_shading = config.per_sample_shading;
+  libraries[3] = GetPipelineLibrary(key, gpb);
+  if (libraries[3] == VK_NULL_HANDLE)
+    return {};
+
+  const VkPipeline pipeline = LinkPipelineLibraries(libraries, layout, false);
+  if (pipeline == VK_NULL_HANDLE)
+    return {};
+
+  // Fast linked pipelines can run slower than monolithic ones, so link an optimized version in the background.
+  VulkanPipeline* pl = new VulkanPipeline(pipeline, config.layout);
+  pl->m_optimize_queued = true;
+  {
+    std::unique_lock lock(m_optimizer_mutex);
+    m_optimizer_queue.push_back(OptimizePipelineRequest{pl, layout, libraries});
+  }
+  m_optimizer_queued_cv.notify_one();
+
+  return std::unique_ptr<GPUPipeline>(pl);
+}
+
+VkPipeline VulkanDevice::GetPipelineLibrary(const PipelineLibraryKey& key, Vulkan::GraphicsPipelineBuilder& gpb)
+{
+  const auto it = m_pipeline_libraries.find(key);
+  if (it != m_pipeline_libraries.end())
+    return it->second;
+
+  const VkPipeline library = gpb.CreateLibrary(m_device, m_pipeline_cache, key.part);
+  if (library != VK_NULL_HANDLE)
+    m_pipeline_libraries.emplace(key, library);
+
+  return library;
+}
+
+VkPipeline VulkanDevice::LinkPipelineLibraries(const PipelineLibraryArray& libraries, VkPipelineLayout layout,
+                                               bool optimize)
+{
+  const VkPipelineLibraryCreateInfoKHR library_info = {VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR, nullptr,
+                                                       static_cast<u32>(libraries.size()), libraries.data()};
+  VkGraphicsPipelineCreateInfo ci = {};
+  ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+  ci.pNext = &library_info;
+  ci.flags = optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+  ci.layout = layout;
+  ci.basePipelineIndex = -1;
+
+  VkPipeline pipeline;
+  const VkResult res = vkCreateGraphicsPipelines(m_device, m_pipeline_cache, 1, &ci, nullptr, &pipeline);
+  if (res != VK_SUCCESS)
+  {
+    LOG_VULKAN_ERROR(res, "vkCreateGraphicsPipelines() failed to link libraries: ");
+    return VK_NULL_HANDLE;
+  }
+
+  return pipeline;
+}
+
+void VulkanDevice::DestroyPipelineLibrariesForShader(VkShaderModule module)
+{
+  if (!m_optional_extensions.vk_ext_graphics_pipeline_library)
+    return;
+
+  std::unique_lock lock(m_optimizer_mutex);
+  for (auto it = m_pipeline_libraries.begin(); it != m_pipeline_libraries.end();)
+  {
+    if (it->first.vertex_shader == module || it->first.geometry_shader == module || it->first.fragment_shader == module)
+    {
+      m_retired_pipeline_libraries.push_back(it->second);
+      it = m_pipeline_libraries.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  if (m_optimizer_queue.empty() && !m_optimizer_current_pipeline)
+    DestroyRetiredPipelineLibraries();
+}
+
+void VulkanDevice::DestroyRetiredPipelineLibraries()
+{
+  for (const VkPipeline library : m_retired_pipeline_libraries)
+    vkDestroyPipeline(m_device, library, nullptr);
+  m_retired_pipeline_libraries.clear();
+}
+
+void VulkanDevice::DestroyPipelineLibraries()
+{
+  DebugAssert(!m_optimizer_thread.joinable());
+  DestroyRetiredPipelineLibraries();
+  for (const auto& it : m_pipeline_libraries)
+    vkDestroyPipeline(m_device, it.second, nullptr);
+  m_pipeline_libraries.clear();
+}
+
+void VulkanDevice::CancelOptimizePipeline(VulkanPipeline* pipeline)
+{
+  std::unique_lock lock(m_optimizer_mutex);
+  for (auto it = m_optimizer_queue.begin(); it != m_optimizer_queue.end(); ++it)
+  {
+    if (it->pipeline == pipeline)
+    {
+      m_optimizer_queue.erase(it);
+      break;
+    }
+  }
+
+  // If it's being linked right now, the result has to be written before the pipeline goes away.
+  m_optimizer_done_cv.wait(lock, [this, pipeline]() { return (m_optimizer_current_pipeline != pipeline); });
+}
+
+void VulkanDevice::PipelineOptimizerThread()
+{
+  Threading::SetNameOfCurrentThread("Vulkan Pipeline Optimizer");
+
+  std::unique_lock lock(m_optimizer_mutex);
+  for (;;)
+  {
+    m_optimizer_queued_cv.wait(lock, [this]() { return (!m_optimizer_queue.empty() || m_optimizer_thread_done); });
+    if (m_optimizer_thread_done)
+      break;
+
+    const OptimizePipelineRequest request = m_optimizer_queue.front();
+    m_optimizer_queue.pop_front();
+    m_optimizer_current_pipeline = request.pipeline;
+    lock.unlock();
+
+    // Failure isn't fatal, the fast linked pipeline keeps being used.
+    const VkPipeline pipeline = LinkPipelineLibraries(request.libraries, request.layout, true);
+
+    lock.lock();
+    request.pipeline->m_optimized_pipeline.store(pipeline, std::memory_order_release);
+    m_optimizer_current_pipeline = nullptr;
+    if (m_optimizer_queue.empty())
+      DestroyRetiredPipelineLibraries();
+    m_optimizer_done_cv.notify_all();
+  }
+}
+
+void VulkanDevice::StartPipelineOptimizerThread()
+{
+  DebugAssert(!m_optimizer_thread.joinable());
+  m_optimizer_thread_done = false;
+  m_optimizer_thread = std::thread(&VulkanDevice::PipelineOptimizerThread, this);
+}
+
+void VulkanDevice::StopPipelineOptimizerThread()
+{
+  if (!m_optimizer_thread.joinable())
+    return;
+
+  {
+    std::unique_lock lock(m_optimizer_mutex);
+    m_optimizer_thread_done = true;
+    m_optimizer_queue.clear();
+  }
+
+  m_optimizer_queued_cv.notify_one();
+  m_optimizer_thread.join();
+}
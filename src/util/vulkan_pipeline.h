@@ -4,6 +4,8 @@
 #include "gpu_device.h"
 #include "vulkan_loader.h"
 
+#include <atomic>
+
 class VulkanDevice;
 
 class VulkanShader final : public GPUShader
@@ -33,11 +35,24 @@ public:
   ALWAYS_INLINE VkPipeline GetPipeline() const { return m_pipeline; }
   ALWAYS_INLINE Layout GetLayout() const { return m_layout; }
 
+  /// Switches from the fast linked pipeline to the optimized one, if it has been linked since. Call before binding.
+  ALWAYS_INLINE void UpdateOptimizedPipeline()
+  {
+    if (m_optimized_pipeline.load(std::memory_order_relaxed) != VK_NULL_HANDLE) [[unlikely]]
+      SwapToOptimizedPipeline();
+  }
+
   void SetDebugName(const std::string_view& name) override;
 
 private:
   VulkanPipeline(VkPipeline pipeline, Layout layout);
 
+  void SwapToOptimizedPipeline();
+
   VkPipeline m_pipeline;
   Layout m_layout;
+  bool m_optimize_queued = false;
+
+  // Written by the optimizer thread when a pipeline linked from libraries has been optimized.
+  std::atomic<VkPipeline> m_optimized_pipeline{VK_NULL_HANDLE};
 };
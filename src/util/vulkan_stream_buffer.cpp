@@ -143,6 +143,7 @@ bool VulkanStreamBuffer::ReserveMemory(u32 num_bytes, u32 alignment)
     {
       // Reset offset to zero, since we're allocating behind the gpu now
       m_current_offset = 0;
+      GPUDevice::s_stats.num_stream_buffer_wraps++;
       m_current_space = m_current_gpu_position - 1;
       return true;
     }
@@ -302,6 +303,9 @@ bool VulkanStreamBuffer::WaitForClearSpace(u32 num_bytes)
 
   // Wait until this fence is signaled. This will fire the callback, updating the GPU position.
   VulkanDevice::GetInstance().WaitForFenceCounter(iter->first);
+  GPUDevice::s_stats.num_stream_buffer_stalls++;
+  if (new_offset < m_current_offset)
+    GPUDevice::s_stats.num_stream_buffer_wraps++;
   m_tracked_fences.erase(m_tracked_fences.begin(), m_current_offset == iter->second ? m_tracked_fences.end() : ++iter);
   m_current_offset = new_offset;
   m_current_space = new_space;
@@ -223,7 +223,8 @@ VkCommandBuffer VulkanTexture::GetCommandBufferForUpdate()
   if (m_type != Type::Texture || m_use_fence_counter == dev.GetCurrentFenceCounter())
   {
     // Console.WriteLn("Texture update within frame, can't use do beforehand");
-    dev.EndRenderPass();
+    if (dev.InRenderPass())
+      dev.EndRenderPass();
     return dev.GetCurrentCommandBuffer();
   }
 
@@ -689,7 +690,9 @@ VkDescriptorSet VulkanTexture::GetDescriptorSetWithSampler(VkSampler sampler)
       return it.second;
   }
 
+  // Only used without push descriptors, the layout can't be allocated from otherwise.
   VulkanDevice& dev = VulkanDevice::GetInstance();
+  DebugAssert(!dev.m_optional_extensions.vk_khr_push_descriptor);
   VkDescriptorSet ds = dev.AllocatePersistentDescriptorSet(dev.m_single_texture_ds_layout);
   if (ds == VK_NULL_HANDLE)
     Panic("Failed to allocate persistent descriptor set.");
@@ -1082,6 +1085,22 @@ std::unique_ptr<GPUTextureBuffer> VulkanDevice::CreateTextureBuffer(GPUTextureBu
   if (!tb->CreateBuffer(ssbo))
     return {};
 
+  if (!ssbo)
+  {
+    Vulkan::BufferViewBuilder bvb;
+    bvb.Set(tb->GetBuffer(), format_mapping[static_cast<u8>(format)], 0, tb->GetSizeInBytes());
+    if ((tb->m_buffer_view = bvb.Create(m_device, false)) == VK_NULL_HANDLE)
+    {
+      Log_ErrorPrintf("Failed to create buffer view for texture buffer.");
+      tb->Destroy(false);
+      return {};
+    }
+  }
+
+  // The descriptor is pushed at draw time when push descriptors are available.
+  if (m_optional_extensions.vk_khr_push_descriptor)
+    return tb;
+
   tb->m_descriptor_set = AllocatePersistentDescriptorSet(m_single_texture_buffer_ds_layout);
   if (tb->m_descriptor_set == VK_NULL_HANDLE)
   {
@@ -1098,15 +1117,6 @@ std::unique_ptr<GPUTextureBuffer> VulkanDevice::CreateTextureBuffer(GPUTextureBu
   }
   else
   {
-    Vulkan::BufferViewBuilder bvb;
-    bvb.Set(tb->GetBuffer(), format_mapping[static_cast<u8>(format)], 0, tb->GetSizeInBytes());
-    if ((tb->m_buffer_view = bvb.Create(m_device, false)) == VK_NULL_HANDLE)
-    {
-      Log_ErrorPrintf("Failed to create buffer view for texture buffer.");
-      tb->Destroy(false);
-      return {};
-    }
-
     dsub.AddBufferViewDescriptorWrite(tb->m_descriptor_set, 0, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,
                                       tb->m_buffer_view);
   }
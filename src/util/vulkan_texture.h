@@ -154,6 +154,7 @@ public:
   ~VulkanTextureBuffer() override;
 
   ALWAYS_INLINE VkBuffer GetBuffer() const { return m_buffer.GetBuffer(); }
+  ALWAYS_INLINE VkBufferView GetBufferView() const { return m_buffer_view; }
   ALWAYS_INLINE VkDescriptorSet GetDescriptorSet() const { return m_descriptor_set; }
 
   bool CreateBuffer(bool ssbo);
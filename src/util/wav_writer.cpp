@@ -4,6 +4,7 @@
 #include "wav_writer.h"
 #include "common/file_system.h"
 #include "common/log.h"
+#include "common/threading.h"
 Log_SetChannel(WAVWriter);
 
 #pragma pack(push, 1)
@@ -43,7 +44,7 @@ WAVWriter::~WAVWriter()
     Close();
 }
 
-bool WAVWriter::Open(const char* filename, u32 sample_rate, u32 num_channels)
+bool WAVWriter::Open(const char* filename, u32 sample_rate, u32 num_channels, bool async /* = false */)
 {
   if (IsOpen())
     Close();
@@ -65,6 +66,12 @@ bool WAVWriter::Open(const char* filename, u32 sample_rate, u32 num_channels)
     return false;
   }
 
+  if (async)
+  {
+    m_writer_shutdown = false;
+    m_writer_thread = std::thread(&WAVWriter::WriterThreadEntryPoint, this);
+  }
+
   return true;
 }
 
@@ -73,6 +80,27 @@ void WAVWriter::Close()
   if (!IsOpen())
     return;
 
+  if (m_writer_thread.joinable())
+  {
+    {
+      std::unique_lock lock(m_writer_mutex);
+      m_writer_shutdown = true;
+      m_writer_cv.notify_one();
+    }
+
+    m_writer_thread.join();
+    m_pending_samples = {};
+    m_async_samples = {};
+
+    // The header has to agree with what's actually in the file.
+    if (m_frames_lost > 0)
+    {
+      Log_ErrorPrintf("Failed to write %u frames to output file", m_frames_lost);
+      m_num_frames -= m_frames_lost;
+      m_frames_lost = 0;
+    }
+  }
+
   if (std::fseek(m_file, 0, SEEK_SET) != 0 || !WriteHeader())
     Log_ErrorPrintf("Failed to re-write header on file, file may be unplayable");
 
@@ -85,12 +113,52 @@ void WAVWriter::Close()
 
 void WAVWriter::WriteFrames(const s16* samples, u32 num_frames)
 {
-  const u32 num_frames_written =
-    static_cast<u32>(std::fwrite(samples, sizeof(s16) * m_num_channels, num_frames, m_file));
-  if (num_frames_written != num_frames)
-    Log_ErrorPrintf("Only wrote %u of %u frames to output file", num_frames_written, num_frames);
+  if (!m_writer_thread.joinable())
+  {
+    const u32 num_frames_written = WriteFramesToFile(samples, num_frames);
+    if (num_frames_written != num_frames)
+      Log_ErrorPrintf("Only wrote %u of %u frames to output file", num_frames_written, num_frames);
+
+    m_num_frames += num_frames_written;
+    return;
+  }
 
-  m_num_frames += num_frames_written;
+  std::unique_lock lock(m_writer_mutex);
+  m_pending_samples.insert(m_pending_samples.end(), samples, samples + (num_frames * m_num_channels));
+  m_num_frames += num_frames;
+  if (m_pending_samples.size() >= ASYNC_BATCH_SAMPLES)
+    m_writer_cv.notify_one();
+}
+
+u32 WAVWriter::WriteFramesToFile(const s16* samples, u32 num_frames)
+{
+  return static_cast<u32>(std::fwrite(samples, sizeof(SampleType) * m_num_channels, num_frames, m_file));
+}
+
+void WAVWriter::WriterThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("WAV Writer");
+
+  std::unique_lock lock(m_writer_mutex);
+  for (;;)
+  {
+    m_writer_cv.wait(lock,
+                     [this]() { return (m_writer_shutdown || m_pending_samples.size() >= ASYNC_BATCH_SAMPLES); });
+
+    // Swapping keeps both buffers' storage around, after the first few batches nothing is allocated.
+    const bool shutdown = m_writer_shutdown;
+    m_async_samples.clear();
+    m_async_samples.swap(m_pending_samples);
+    lock.unlock();
+
+    const u32 num_frames = static_cast<u32>(m_async_samples.size() / m_num_channels);
+    const u32 num_frames_written = (num_frames > 0) ? WriteFramesToFile(m_async_samples.data(), num_frames) : 0;
+
+    lock.lock();
+    m_frames_lost += num_frames - num_frames_written;
+    if (shutdown)
+      break;
+  }
 }
 
 bool WAVWriter::WriteHeader()
@@ -3,7 +3,11 @@
 
 #pragma once
 #include "common/types.h"
+#include <condition_variable>
 #include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Common {
 
@@ -18,7 +22,8 @@ public:
   ALWAYS_INLINE u32 GetNumFrames() const { return m_num_frames; }
   ALWAYS_INLINE bool IsOpen() const { return (m_file != nullptr); }
 
-  bool Open(const char* filename, u32 sample_rate, u32 num_channels);
+  /// With async set, frames are buffered and written by a worker thread, so the caller never waits on the disk.
+  bool Open(const char* filename, u32 sample_rate, u32 num_channels, bool async = false);
   void Close();
 
   void WriteFrames(const s16* samples, u32 num_frames);
@@ -26,12 +31,25 @@ public:
 private:
   using SampleType = s16;
 
+  // Frames are handed to the writer thread once this many samples have built up.
+  static constexpr u32 ASYNC_BATCH_SAMPLES = 64 * 1024;
+
   bool WriteHeader();
+  u32 WriteFramesToFile(const s16* samples, u32 num_frames);
+  void WriterThreadEntryPoint();
 
   std::FILE* m_file = nullptr;
   u32 m_sample_rate = 0;
   u32 m_num_channels = 0;
   u32 m_num_frames = 0;
+
+  std::thread m_writer_thread;
+  std::mutex m_writer_mutex;
+  std::condition_variable m_writer_cv;
+  std::vector<SampleType> m_pending_samples;
+  std::vector<SampleType> m_async_samples;
+  u32 m_frames_lost = 0;
+  bool m_writer_shutdown = false;
 };
 
 } // namespace Common
\ No newline at end of file